@@ -1643,7 +1643,8 @@ got_client (GObject *source_object, GAsyncResult *res, gpointer user_data)
 	NmCli *nmc = call->nmc;
 
 	nmc->should_wait--;
-	nmc->client = nm_client_new_finish (res, &error);
+	nmc->client = (NMClient *) g_async_initable_new_finish (G_ASYNC_INITABLE (source_object),
+	                                                        res, &error);
 
 	if (!nmc->client) {
 		g_simple_async_result_set_error (call->simple, NMCLI_ERROR, NMC_RESULT_ERROR_UNKNOWN,
@@ -1651,6 +1652,12 @@ got_client (GObject *source_object, GAsyncResult *res, gpointer user_data)
 		g_error_free (error);
 		g_simple_async_result_complete (call->simple);
 	} else {
+		/* The settings of all connections are requested in one call,
+		 * instead of with one call for each connection while
+		 * initializing the client. */
+		if (nmc->complete)
+			nm_client_fetch_connection_settings (nmc->client, NULL, NULL, NULL);
+		nm_vpn_helpers_set_client (nmc->client);
 		call_cmd (nmc, call->simple, call->cmd, call->argc, call->argv);
 	}
 
@@ -1680,7 +1687,10 @@ call_cmd (NmCli *nmc, GSimpleAsyncResult *simple, const NMCCommand *cmd, int arg
 		call->argc = argc;
 		call->argv = argv;
 		call->simple = simple;
-		nm_client_new_async (NULL, got_client, call);
+		g_async_initable_new_async (NM_TYPE_CLIENT, G_PRIORITY_DEFAULT,
+		                            NULL, got_client, call,
+		                            NM_CLIENT_LAZY_SETTINGS, nmc->complete,
+		                            NULL);
 	}
 }
 
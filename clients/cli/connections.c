@@ -184,6 +184,7 @@ NmcOutputField nmc_fields_settings_names[] = {
 	SETTING_FIELD (NM_SETTING_VXLAN_SETTING_NAME,             nmc_fields_setting_vxlan + 1),             /* 29 */
 	SETTING_FIELD (NM_SETTING_PROXY_SETTING_NAME,             nmc_fields_setting_proxy + 1),             /* 30 */
 	SETTING_FIELD (NM_SETTING_DUMMY_SETTING_NAME,             nmc_fields_setting_dummy + 1),             /* 31 */
+	SETTING_FIELD (NM_SETTING_ETHTOOL_SETTING_NAME,           nmc_fields_setting_ethtool + 1),           /* 32 */
 	{NULL, NULL, 0, NULL, NULL, FALSE, FALSE, 0}
 };
 #define NMC_FIELDS_SETTINGS_NAMES_ALL_X  NM_SETTING_CONNECTION_SETTING_NAME","\
@@ -215,7 +216,8 @@ NmcOutputField nmc_fields_settings_names[] = {
                                          NM_SETTING_MACSEC_SETTING_NAME"," \
                                          NM_SETTING_MACVLAN_SETTING_NAME"," \
                                          NM_SETTING_VXLAN_SETTING_NAME"," \
-                                         NM_SETTING_PROXY_SETTING_NAME
+                                         NM_SETTING_PROXY_SETTING_NAME"," \
+                                         NM_SETTING_ETHTOOL_SETTING_NAME
 #define NMC_FIELDS_SETTINGS_NAMES_ALL    NMC_FIELDS_SETTINGS_NAMES_ALL_X
 
 /* Active connection data */
@@ -348,6 +350,11 @@ usage_connection_up (void)
 	              "Activate a connection on a device. The profile to activate is identified by its\n"
 	              "name, UUID or D-Bus path.\n"
 	              "\n"
+	              "ARGUMENTS := [id | uuid | path] <ID> [id | uuid | path] <ID> ... [--parallel <num>] [passwd-file <file with passwords>]\n"
+	              "\n"
+	              "Activate several connections at once and wait for all of them. With --parallel,\n"
+	              "at most <num> activations are in progress at the same time.\n"
+	              "\n"
 	              "ARGUMENTS := ifname <ifname> [ap <BSSID>] [nsp <name>] [passwd-file <file with passwords>]\n"
 	              "\n"
 	              "Activate a device with a connection. The connection profile is selected\n"
@@ -356,7 +363,8 @@ usage_connection_up (void)
 	              "ifname      - specifies the device to active the connection on\n"
 	              "ap          - specifies AP to connect to (only valid for Wi-Fi)\n"
 	              "nsp         - specifies NSP to connect to (only valid for WiMAX)\n"
-	              "passwd-file - file with password(s) required to activate the connection\n\n"));
+	              "passwd-file - file with password(s) required to activate the connection\n"
+	              "--parallel  - maximum number of connections activated at the same time\n\n"));
 }
 
 static void
@@ -555,11 +563,12 @@ usage_connection_monitor (void)
 {
 	g_printerr (_("Usage: nmcli connection monitor { ARGUMENTS | help }\n"
 	              "\n"
-	              "ARGUMENTS := [id | uuid | path] <ID> ...\n"
+	              "ARGUMENTS := [--json] [id | uuid | path] <ID> ...\n"
 	              "\n"
 	              "Monitor connection profile activity.\n"
 	              "This command prints a line whenever the specified connection changes.\n"
-	              "Monitors all connection profiles in case none is specified.\n\n"));
+	              "Monitors all connection profiles in case none is specified.\n"
+	              "With --json, each line is a JSON object with the changed property.\n\n"));
 }
 
 static void
@@ -970,7 +979,7 @@ fill_output_connection (NMConnection *connection, NmCli *nmc, gboolean active_on
 	set_val_strc (arr, 12, ac_path);
 	set_val_strc (arr, 13, nm_setting_connection_get_slave_type (s_con));
 
-	g_ptr_array_add (nmc->output_data, arr);
+	nmc_output_data_add (nmc, arr);
 }
 
 static void
@@ -1007,7 +1016,7 @@ fill_output_connection_for_invisible (NMActiveConnection *ac, NmCli *nmc)
 
 	set_val_color_fmt_all (arr, NMC_TERM_FORMAT_DIM);
 
-	g_ptr_array_add (nmc->output_data, arr);
+	nmc_output_data_add (nmc, arr);
 }
 
 static void
@@ -1805,7 +1814,7 @@ do_connections_show (NmCli *nmc, int argc, char **argv)
 		nmc->print_fields.header_name = active_only ? _("NetworkManager active profiles") :
 		                                              _("NetworkManager connection profiles");
 		arr = nmc_dup_fields_array (tmpl, tmpl_len, NMC_OF_FLAG_MAIN_HEADER_ADD | NMC_OF_FLAG_FIELD_NAMES);
-		g_ptr_array_add (nmc->output_data, arr);
+		nmc_output_data_add (nmc, arr);
 
 		/* There might be active connections not present in connection list
 		 * (e.g. private connections of a different user). Show them as well. */
@@ -2111,10 +2120,30 @@ find_device_for_connection (NmCli *nmc,
 	}
 }
 
+/* Tracks the activations started by one "connection up" command. At most
+ * @parallel activations are in flight at the same time, the next one is
+ * started when one of them finishes. */
+typedef struct {
+	NmCli *nmc;
+	GPtrArray *connections;
+	const char *ifname;
+	const char *ap;
+	const char *nsp;
+	const char *pwds;
+	guint parallel;
+	guint next;
+	guint pending;
+	guint n_failed;
+	NMCResultCode result;
+} ActivateConnectionsData;
+
 typedef struct {
 	NmCli *nmc;
+	ActivateConnectionsData *data;
+	NMConnection *connection;
 	NMDevice *device;
 	NMActiveConnection *active;
+	guint timeout_id;
 } ActivateConnectionInfo;
 
 static void activate_connection_info_finish (ActivateConnectionInfo *info);
@@ -2255,6 +2284,7 @@ activate_connection_timeout_cb (gpointer user_data)
 	ActivateConnectionInfo *info = user_data;
 
 	/* Time expired -> exit nmcli */
+	info->timeout_id = 0;
 	set_nmc_error_timeout (info->nmc);
 	activate_connection_info_finish (info);
 	return FALSE;
@@ -2299,9 +2329,29 @@ progress_active_connection_cb (gpointer user_data)
 	return TRUE;
 }
 
+static gboolean
+progress_activate_connections_cb (gpointer user_data)
+{
+	ActivateConnectionsData *data = user_data;
+	gs_free char *str = NULL;
+
+	str = g_strdup_printf (_("activating (%u/%u done)"),
+	                       data->next - data->pending, data->connections->len);
+	nmc_terminal_show_progress (str);
+
+	return TRUE;
+}
+
+static void activate_connections_continue (ActivateConnectionsData *data);
+
 static void
 activate_connection_info_finish (ActivateConnectionInfo *info)
 {
+	ActivateConnectionsData *data = info->data;
+	NmCli *nmc = info->nmc;
+
+	nm_clear_g_source (&info->timeout_id);
+
 	if (info->device) {
 		g_signal_handlers_disconnect_by_func (info->device, G_CALLBACK (device_state_cb), info);
 		g_object_unref (info->device);
@@ -2312,8 +2362,30 @@ activate_connection_info_finish (ActivateConnectionInfo *info)
 		g_object_unref (info->active);
 	}
 
+	if (!data) {
+		g_free (info);
+		quit ();
+		return;
+	}
+
+	if (nmc->return_value != NMC_RESULT_SUCCESS) {
+		/* Remember the result of the first failure and report each one,
+		 * so that the remaining activations are tracked independently. */
+		if (data->connections->len > 1) {
+			if (nmc->print_output == NMC_PRINT_PRETTY)
+				nmc_terminal_erase_line ();
+			g_printerr ("%s: %s\n", nm_connection_get_id (info->connection),
+			            nmc->return_text->str);
+		}
+		if (data->n_failed++ == 0)
+			data->result = nmc->return_value;
+		nmc->return_value = NMC_RESULT_SUCCESS;
+	}
+
+	g_clear_object (&info->connection);
 	g_free (info);
-	quit ();
+	data->pending--;
+	activate_connections_continue (data);
 }
 
 static void
@@ -2357,25 +2429,24 @@ activate_connection_cb (GObject *client, GAsyncResult *result, gpointer user_dat
 		} else {
 			/* Monitor the active connection state state */
 			g_signal_connect (G_OBJECT (active), "state-changed", G_CALLBACK (active_connection_state_cb), info);
-			active_connection_state_cb (active,
-			                            nm_active_connection_get_state (active),
-			                            nm_active_connection_get_state_reason (active),
-			                            info);
-
-			if (device) {
+			if (device)
 				g_signal_connect (device, "notify::" NM_DEVICE_STATE, G_CALLBACK (device_state_cb), info);
-				device_state_cb (device, NULL, info);
-			}
 
-			/* Start progress indication showing VPN states */
-			if (nmc->print_output == NMC_PRINT_PRETTY) {
+			/* Start progress indication showing VPN states. When several
+			 * connections are activated, the shared progress of all of them
+			 * is shown instead. */
+			if (   nmc->print_output == NMC_PRINT_PRETTY
+			    && (!info->data || info->data->connections->len == 1)) {
 				if (progress_id)
 					g_source_remove (progress_id);
 				progress_id = g_timeout_add (120, progress_active_connection_cb, active);
 			}
 
 			/* Start timer not to loop forever when signals are not emitted */
-			g_timeout_add_seconds (nmc->timeout, activate_connection_timeout_cb, info);
+			info->timeout_id = g_timeout_add_seconds (nmc->timeout, activate_connection_timeout_cb, info);
+
+			/* Check the current state last, as it may already finish @info. */
+			check_activated (info);
 		}
 	}
 }
@@ -2472,6 +2543,7 @@ nmc_activate_connection (NmCli *nmc,
                          const char *ap,
                          const char *nsp,
                          const char *pwds,
+                         ActivateConnectionsData *data,
                          GAsyncReadyCallback callback,
                          GError **error)
 {
@@ -2520,21 +2592,27 @@ nmc_activate_connection (NmCli *nmc,
 		g_hash_table_destroy (nmc->pwds_hash);
 	nmc->pwds_hash = pwds_hash;
 
-	/* Create secret agent */
-	nmc->secret_agent = nm_secret_agent_simple_new ("nmcli-connect");
-	if (nmc->secret_agent) {
-		g_signal_connect (nmc->secret_agent,
-		                  NM_SECRET_AGENT_SIMPLE_REQUEST_SECRETS,
-		                  G_CALLBACK (nmc_secrets_requested),
-		                  nmc);
-		if (connection) {
-			nm_secret_agent_simple_enable (NM_SECRET_AGENT_SIMPLE (nmc->secret_agent),
-			                               nm_object_get_path (NM_OBJECT (connection)));
+	/* Create secret agent, unless one was already created for a
+	 * previous activation. */
+	if (!nmc->secret_agent) {
+		nmc->secret_agent = nm_secret_agent_simple_new ("nmcli-connect");
+		if (nmc->secret_agent) {
+			g_signal_connect (nmc->secret_agent,
+			                  NM_SECRET_AGENT_SIMPLE_REQUEST_SECRETS,
+			                  G_CALLBACK (nmc_secrets_requested),
+			                  nmc);
 		}
 	}
+	if (nmc->secret_agent && connection) {
+		nm_secret_agent_simple_enable (NM_SECRET_AGENT_SIMPLE (nmc->secret_agent),
+		                               nm_object_get_path (NM_OBJECT (connection)));
+	}
 
 	info = g_malloc0 (sizeof (ActivateConnectionInfo));
 	info->nmc = nmc;
+	info->data = data;
+	if (data && connection)
+		info->connection = g_object_ref (connection);
 	if (device)
 		info->device = g_object_ref (device);
 
@@ -2548,19 +2626,80 @@ nmc_activate_connection (NmCli *nmc,
 	return TRUE;
 }
 
+static void
+activate_connections_start (ActivateConnectionsData *data)
+{
+	NmCli *nmc = data->nmc;
+
+	while (   data->next < data->connections->len
+	       && (!data->parallel || data->pending < data->parallel)) {
+		NMConnection *connection = data->connections->pdata[data->next++];
+		gs_free_error GError *error = NULL;
+
+		if (nmc_activate_connection (nmc, connection, data->ifname, data->ap, data->nsp,
+		                             data->pwds, data, activate_connection_cb, &error)) {
+			data->pending++;
+			continue;
+		}
+
+		if (data->connections->len > 1) {
+			g_printerr (_("%s: Error: %s.\n"), nm_connection_get_id (connection),
+			            error->message);
+		}
+		g_string_printf (nmc->return_text, _("Error: %s."), error->message);
+		if (data->n_failed++ == 0)
+			data->result = error->code;
+	}
+}
+
+static void
+activate_connections_done (ActivateConnectionsData *data)
+{
+	NmCli *nmc = data->nmc;
+
+	if (data->n_failed) {
+		nmc->return_value = data->result;
+		if (data->connections->len > 1) {
+			g_string_printf (nmc->return_text, _("Error: %u of %u connections failed to activate."),
+			                 data->n_failed, data->connections->len);
+		}
+	}
+
+	g_ptr_array_unref (data->connections);
+	g_free (data);
+}
+
+static void
+activate_connections_continue (ActivateConnectionsData *data)
+{
+	NmCli *nmc = data->nmc;
+
+	activate_connections_start (data);
+	if (data->pending)
+		return;
+
+	activate_connections_done (data);
+	nmc->should_wait--;
+	quit ();
+}
+
 static NMCResultCode
 do_connection_up (NmCli *nmc, int argc, char **argv)
 {
-	NMConnection *connection = NULL;
+	gs_unref_ptrarray GPtrArray *connections = NULL;
+	ActivateConnectionsData *data;
+	NMConnection *connection;
 	const char *ifname = NULL;
 	const char *ap = NULL;
 	const char *nsp = NULL;
 	const char *pwds = NULL;
+	guint parallel = 0;
 	gs_free_error GError *error = NULL;
 	char **arg_arr = NULL;
 	int arg_num;
 	char ***argv_ptr = &argv;
 	int *argc_ptr = &argc;
+	guint i;
 
 	/*
 	 * Set default timeout for connection activation.
@@ -2582,17 +2721,35 @@ do_connection_up (NmCli *nmc, int argc, char **argv)
 		argc_ptr = &arg_num;
 	}
 
-	if (argc > 0 && strcmp (*argv, "ifname") != 0) {
+	/* Collect the profiles to activate, up to the first option. */
+	connections = g_ptr_array_new_with_free_func (nm_g_object_unref);
+	while (   *argc_ptr > 0
+	       && !NM_IN_STRSET (**argv_ptr, "ifname", "ap", "passwd-file")
+	       && !nmc_arg_is_option (**argv_ptr, "parallel")) {
+		if (connections->len && *argc_ptr == 1 && nmc->complete)
+			nmc_complete_strings (**argv_ptr, "ifname", "ap", "passwd-file", "--parallel", NULL);
+
 		connection = get_connection (nmc, argc_ptr, argv_ptr, NULL, &error);
 		if (!connection) {
+			if (nmc->complete)
+				return nmc->return_value;
 			g_string_printf (nmc->return_text, _("Error: %s."), error->message);
 			return error->code;
 		}
+
+		/* Activating the same profile twice would only make the first
+		 * activation fail. */
+		for (i = 0; i < connections->len; i++) {
+			if (connections->pdata[i] == connection)
+				break;
+		}
+		if (i == connections->len)
+			g_ptr_array_add (connections, g_object_ref (connection));
 	}
 
 	while (argc > 0) {
 		if (argc == 1 && nmc->complete)
-			nmc_complete_strings (*argv, "ifname", "ap", "passwd-file", NULL);
+			nmc_complete_strings (*argv, "ifname", "ap", "passwd-file", "--parallel", NULL);
 
 		if (strcmp (*argv, "ifname") == 0) {
 			argc--;
@@ -2631,6 +2788,23 @@ do_connection_up (NmCli *nmc, int argc, char **argv)
 
 			pwds = *argv;
 		}
+		else if (nmc_arg_is_option (*argv, "parallel")) {
+			unsigned long value;
+
+			argc--;
+			argv++;
+			if (!argc) {
+				g_string_printf (nmc->return_text, _("Error: %s argument is missing."), *(argv-1));
+				return NMC_RESULT_ERROR_USER_INPUT;
+			}
+
+			if (!nmc_string_to_uint (*argv, TRUE, 1, G_MAXUINT, &value)) {
+				g_string_printf (nmc->return_text, _("Error: '%s' is not a valid number of parallel activations."),
+				                 *argv);
+				return NMC_RESULT_ERROR_USER_INPUT;
+			}
+			parallel = value;
+		}
 		else if (!nmc->complete) {
 			g_printerr (_("Unknown parameter: %s\n"), *argv);
 		}
@@ -2641,23 +2815,46 @@ do_connection_up (NmCli *nmc, int argc, char **argv)
 	if (nmc->complete)
 		return nmc->return_value;
 
+	if (connections->len > 1 && (ifname || ap || nsp)) {
+		g_string_printf (nmc->return_text, _("Error: 'ifname' and 'ap' can only be used with a single connection."));
+		return NMC_RESULT_ERROR_USER_INPUT;
+	}
+
+	/* Without a profile, a device given by 'ifname' is activated. */
+	if (!connections->len)
+		g_ptr_array_add (connections, NULL);
+
 	/* Use nowait_flag instead of should_wait because exiting has to be postponed till
 	 * active_connection_state_cb() is called. That gives NM time to check our permissions
 	 * and we can follow activation progress.
 	 */
 	nmc->nowait_flag = (nmc->timeout == 0);
-	nmc->should_wait++;
 
-	if (!nmc_activate_connection (nmc, connection, ifname, ap, nsp, pwds, activate_connection_cb, &error)) {
-		g_string_printf (nmc->return_text, _("Error: %s."),
-		                 error->message);
-		nmc->should_wait--;
-		return error->code;
+	data = g_new0 (ActivateConnectionsData, 1);
+	data->nmc = nmc;
+	data->connections = g_steal_pointer (&connections);
+	data->ifname = ifname;
+	data->ap = ap;
+	data->nsp = nsp;
+	data->pwds = pwds;
+	data->parallel = parallel;
+
+	activate_connections_start (data);
+	if (!data->pending) {
+		/* Nothing is in flight, thus every activation failed to start. */
+		activate_connections_done (data);
+		return nmc->return_value;
 	}
 
+	nmc->should_wait++;
+
 	/* Start progress indication */
-	if (nmc->print_output == NMC_PRINT_PRETTY)
-		progress_id = g_timeout_add (120, progress_cb, _("preparing"));
+	if (nmc->print_output == NMC_PRINT_PRETTY) {
+		if (data->connections->len > 1)
+			progress_id = g_timeout_add (120, progress_activate_connections_cb, data);
+		else
+			progress_id = g_timeout_add (120, progress_cb, _("preparing"));
+	}
 
 	return nmc->return_value;
 }
@@ -2876,6 +3073,7 @@ static const NameItem nmc_ethernet_settings [] = {
 	{ NM_SETTING_WIRED_SETTING_NAME,      "ethernet", NULL, TRUE  },
 	{ NM_SETTING_802_1X_SETTING_NAME,     NULL,       NULL, FALSE },
 	{ NM_SETTING_DCB_SETTING_NAME,        NULL,       NULL, FALSE },
+	{ NM_SETTING_ETHTOOL_SETTING_NAME,    NULL,       NULL, FALSE },
 	{ NULL, NULL, NULL, FALSE }
 };
 
@@ -4876,6 +5074,8 @@ setting_name_to_name (const char *name)
 		return _("IPv6 protocol");
 	if (strcmp (name, NM_SETTING_PROXY_SETTING_NAME) == 0)
 		return _("Proxy");
+	if (strcmp (name, NM_SETTING_ETHTOOL_SETTING_NAME) == 0)
+		return _("Hardware tuning");
 
 	/* Should not happen; but let's still try to be somewhat sensible. */
 	return name;
@@ -7600,7 +7800,7 @@ editor_menu_main (NmCli *nmc, NMConnection *connection, const char *connection_t
 			nmc->nowait_flag = FALSE;
 			nmc->should_wait++;
 			nmc->print_output = NMC_PRINT_PRETTY;
-			if (!nmc_activate_connection (nmc, NM_CONNECTION (rem_con), ifname, ap_nsp, ap_nsp, NULL,
+			if (!nmc_activate_connection (nmc, NM_CONNECTION (rem_con), ifname, ap_nsp, ap_nsp, NULL, NULL,
 			                              activate_connection_editor_cb, &tmp_err)) {
 				g_print (_("Error: Cannot activate connection: %s.\n"), tmp_err->message);
 				g_clear_error (&tmp_err);
@@ -8397,7 +8597,16 @@ finish:
 static void
 connection_changed (NMConnection *connection, NmCli *nmc)
 {
-	g_print (_("%s: connection profile changed\n"), nm_connection_get_id (connection));
+	if (nmc->monitor_json)
+		nmc_monitor_json_print ("updated", G_OBJECT (connection), NULL);
+	else
+		g_print (_("%s: connection profile changed\n"), nm_connection_get_id (connection));
+}
+
+static void
+connection_notify_json (NMConnection *connection, GParamSpec *pspec, NmCli *nmc)
+{
+	nmc_monitor_json_print ("changed", G_OBJECT (connection), pspec);
 }
 
 static void
@@ -8405,11 +8614,14 @@ connection_watch (NmCli *nmc, NMConnection *connection)
 {
 	nmc->should_wait++;
 	g_signal_connect (connection, NM_CONNECTION_CHANGED, G_CALLBACK (connection_changed), nmc);
+	if (nmc->monitor_json)
+		g_signal_connect (connection, "notify", G_CALLBACK (connection_notify_json), nmc);
 }
 
 static void
 connection_unwatch (NmCli *nmc, NMConnection *connection)
 {
+	g_signal_handlers_disconnect_by_func (connection, G_CALLBACK (connection_notify_json), nmc);
 	if (g_signal_handlers_disconnect_by_func (connection, G_CALLBACK (connection_changed), nmc))
 		nmc->should_wait--;
 
@@ -8423,7 +8635,10 @@ connection_added (NMClient *client, NMRemoteConnection *con, NmCli *nmc)
 {
 	NMConnection *connection = NM_CONNECTION (con);
 
-	g_print (_("%s: connection profile created\n"), nm_connection_get_id (connection));
+	if (nmc->monitor_json)
+		nmc_monitor_json_print ("added", G_OBJECT (con), NULL);
+	else
+		g_print (_("%s: connection profile created\n"), nm_connection_get_id (connection));
 	connection_watch (nmc, connection);
 }
 
@@ -8432,7 +8647,10 @@ connection_removed (NMClient *client, NMRemoteConnection *con, NmCli *nmc)
 {
 	NMConnection *connection = NM_CONNECTION (con);
 
-	g_print (_("%s: connection profile removed\n"), nm_connection_get_id (connection));
+	if (nmc->monitor_json)
+		nmc_monitor_json_print ("removed", G_OBJECT (con), NULL);
+	else
+		g_print (_("%s: connection profile removed\n"), nm_connection_get_id (connection));
 	connection_unwatch (nmc, connection);
 }
 
@@ -8441,6 +8659,15 @@ do_connection_monitor (NmCli *nmc, int argc, char **argv)
 {
 	GError *error = NULL;
 
+	if (argc == 1 && nmc->complete)
+		nmc_complete_strings (*argv, "--json", NULL);
+	if (argc > 0 && nmc_arg_is_option (*argv, "json")) {
+		nmc->monitor_json = TRUE;
+		next_arg (nmc, &argc, &argv);
+	}
+	if (argc == 0 && nmc->complete)
+		return nmc->return_value;
+
 	if (argc == 0) {
 		/* No connections specified. Monitor all. */
 		const GPtrArray *connections;
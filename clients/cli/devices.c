@@ -423,11 +423,12 @@ usage_device_monitor (void)
 {
 	g_printerr (_("Usage: nmcli device monitor { ARGUMENTS | help }\n"
 	              "\n"
-	              "ARGUMENTS := [<ifname>] ...\n"
+	              "ARGUMENTS := [--json] [<ifname>] ...\n"
 	              "\n"
 	              "Monitor device activity.\n"
 	              "This command prints a line whenever the specified devices change state.\n"
-	              "Monitors all devices in case no interface is specified.\n\n"));
+	              "Monitors all devices in case no interface is specified.\n"
+	              "With --json, each line is a JSON object with the changed property.\n\n"));
 }
 
 static void
@@ -1475,7 +1476,7 @@ fill_output_device_status (NMDevice *device, NmCli *nmc)
 	set_val_strc (arr, 5, ac ? nm_active_connection_get_uuid (ac) : NULL);
 	set_val_strc (arr, 6, ac ? nm_object_get_path (NM_OBJECT (ac)) : NULL);
 
-	g_ptr_array_add (nmc->output_data, arr);
+	nmc_output_data_add (nmc, arr);
 }
 
 static NMCResultCode
@@ -1519,7 +1520,7 @@ do_devices_status (NmCli *nmc, int argc, char **argv)
 	/* Add headers */
 	nmc->print_fields.header_name = _("Status of devices");
 	arr = nmc_dup_fields_array (tmpl, tmpl_len, NMC_OF_FLAG_MAIN_HEADER_ADD | NMC_OF_FLAG_FIELD_NAMES);
-	g_ptr_array_add (nmc->output_data, arr);
+	nmc_output_data_add (nmc, arr);
 
 	devices = nmc_get_devices_sorted (nmc->client);
 	for (i = 0; devices[i]; i++)
@@ -2398,10 +2399,20 @@ device_ac (NMDevice *device, GParamSpec *pspec, NmCli *nmc)
 	g_print (_("%s: using connection '%s'\n"), nm_device_get_iface (device), id);
 }
 
+static void
+device_notify_json (NMDevice *device, GParamSpec *pspec, NmCli *nmc)
+{
+	nmc_monitor_json_print ("changed", G_OBJECT (device), pspec);
+}
+
 static void
 device_watch (NmCli *nmc, NMDevice *device)
 {
 	nmc->should_wait++;
+	if (nmc->monitor_json) {
+		g_signal_connect (device, "notify", G_CALLBACK (device_notify_json), nmc);
+		return;
+	}
 	g_signal_connect (device, "notify::" NM_DEVICE_STATE, G_CALLBACK (device_state), nmc);
 	g_signal_connect (device, "notify::" NM_DEVICE_ACTIVE_CONNECTION, G_CALLBACK (device_ac), nmc);
 }
@@ -2410,7 +2421,8 @@ static void
 device_unwatch (NmCli *nmc, NMDevice *device)
 {
 	g_signal_handlers_disconnect_by_func (device, device_state, nmc);
-	if (g_signal_handlers_disconnect_by_func (device, device_ac, nmc))
+	if (   g_signal_handlers_disconnect_by_func (device, device_ac, nmc)
+	    || g_signal_handlers_disconnect_by_func (device, device_notify_json, nmc))
 		nmc->should_wait--;
 
 	/* Terminate if all the watched devices disappeared. */
@@ -2421,23 +2433,38 @@ device_unwatch (NmCli *nmc, NMDevice *device)
 static void
 device_added (NMClient *client, NMDevice *device, NmCli *nmc)
 {
-	g_print (_("%s: device created\n"), nm_device_get_iface (device));
+	if (nmc->monitor_json)
+		nmc_monitor_json_print ("added", G_OBJECT (device), NULL);
+	else
+		g_print (_("%s: device created\n"), nm_device_get_iface (device));
 	device_watch (nmc, NM_DEVICE (device));
 }
 
 static void
 device_removed (NMClient *client, NMDevice *device, NmCli *nmc)
 {
-	g_print (_("%s: device removed\n"), nm_device_get_iface (device));
+	if (nmc->monitor_json)
+		nmc_monitor_json_print ("removed", G_OBJECT (device), NULL);
+	else
+		g_print (_("%s: device removed\n"), nm_device_get_iface (device));
 	device_unwatch (nmc, device);
 }
 
 static NMCResultCode
 do_devices_monitor (NmCli *nmc, int argc, char **argv)
 {
-	GSList *queue = get_device_list (nmc, argc, argv);
+	GSList *queue;
 	GSList *iter;
 
+	if (argc == 1 && nmc->complete)
+		nmc_complete_strings (*argv, "--json", NULL);
+	if (argc > 0 && nmc_arg_is_option (*argv, "json")) {
+		nmc->monitor_json = TRUE;
+		next_arg (nmc, &argc, &argv);
+	}
+
+	queue = get_device_list (nmc, argc, argv);
+
 	if (nmc->complete)
 		return nmc->return_value;
 
@@ -77,6 +77,25 @@ static NmcOutputField nmc_fields_nm_logging[] = {
 #define NMC_FIELDS_NM_LOGGING_ALL     "LEVEL,DOMAINS"
 #define NMC_FIELDS_NM_LOGGING_COMMON  "LEVEL,DOMAINS"
 
+/* Available fields for 'general statistics' */
+static NmcOutputField nmc_fields_nm_statistics[] = {
+	{"NAME",  N_("NAME")},   /* 0 */
+	{"VALUE", N_("VALUE")},  /* 1 */
+	{NULL, NULL}
+};
+#define NMC_FIELDS_NM_STATISTICS_ALL     "NAME,VALUE"
+#define NMC_FIELDS_NM_STATISTICS_COMMON  "NAME,VALUE"
+
+/* Available fields for 'general memory' */
+static NmcOutputField nmc_fields_nm_memory[] = {
+	{"NAME",    N_("NAME")},     /* 0 */
+	{"OBJECTS", N_("OBJECTS")},  /* 1 */
+	{"BYTES",   N_("BYTES")},    /* 2 */
+	{NULL, NULL}
+};
+#define NMC_FIELDS_NM_MEMORY_ALL     "NAME,OBJECTS,BYTES"
+#define NMC_FIELDS_NM_MEMORY_COMMON  "NAME,OBJECTS,BYTES"
+
 
 /* glib main loop variable - defined in nmcli.c */
 extern GMainLoop *loop;
@@ -86,11 +105,13 @@ static void
 usage_general (void)
 {
 	g_printerr (_("Usage: nmcli general { COMMAND | help }\n\n"
-	              "COMMAND := { status | hostname | permissions | logging }\n\n"
+	              "COMMAND := { status | hostname | permissions | logging | statistics | memory }\n\n"
 	              "  status\n\n"
 	              "  hostname [<hostname>]\n\n"
 	              "  permissions\n\n"
-	              "  logging [level <log level>] [domains <log domains>]\n\n"));
+	              "  logging [level <log level>] [domains <log domains>]\n\n"
+	              "  statistics\n\n"
+	              "  memory\n\n"));
 }
 
 static void
@@ -135,6 +156,24 @@ usage_general_logging (void)
 	              "for the list of possible logging domains.\n\n"));
 }
 
+static void
+usage_general_statistics (void)
+{
+	g_printerr (_("Usage: nmcli general statistics { help }\n"
+	              "\n"
+	              "Show internal counters of NetworkManager, like the number of netlink\n"
+	              "messages and kernel object changes it processed.\n\n"));
+}
+
+static void
+usage_general_memory (void)
+{
+	g_printerr (_("Usage: nmcli general memory { help }\n"
+	              "\n"
+	              "Show an estimate of the memory used by NetworkManager, broken down by\n"
+	              "its owners, like the cache of kernel objects or the connection profiles.\n\n"));
+}
+
 static void
 usage_networking (void)
 {
@@ -215,10 +254,11 @@ usage_radio_wwan (void)
 static void
 usage_monitor (void)
 {
-	g_printerr (_("Usage: nmcli monitor\n"
+	g_printerr (_("Usage: nmcli monitor [--json]\n"
 	              "\n"
 	              "Monitor NetworkManager changes.\n"
-	              "Prints a line whenever a change occurs in NetworkManager\n\n"));
+	              "Prints a line whenever a change occurs in NetworkManager\n"
+	              "With --json, each line is a JSON object with the changed property.\n\n"));
 }
 
 /* quit main loop */
@@ -618,6 +658,113 @@ show_general_logging (NmCli *nmc)
 	return TRUE;
 }
 
+static NMCResultCode
+do_general_statistics (NmCli *nmc, int argc, char **argv)
+{
+	gs_free_error GError *error = NULL;
+	gs_unref_variant GVariant *statistics = NULL;
+	GVariantIter iter;
+	const char *fields_str;
+	const char *name;
+	guint64 value;
+	NmcOutputField *tmpl, *arr;
+	size_t tmpl_len;
+
+	if (nmc->complete)
+		return nmc->return_value;
+
+	if (!nmc->required_fields || strcasecmp (nmc->required_fields, "common") == 0)
+		fields_str = NMC_FIELDS_NM_STATISTICS_COMMON;
+	else if (strcasecmp (nmc->required_fields, "all") == 0)
+		fields_str = NMC_FIELDS_NM_STATISTICS_ALL;
+	else
+		fields_str = nmc->required_fields;
+
+	tmpl = nmc_fields_nm_statistics;
+	tmpl_len = sizeof (nmc_fields_nm_statistics);
+	nmc->print_fields.indices = parse_output_fields (fields_str, tmpl, FALSE, NULL, &error);
+	if (error) {
+		g_string_printf (nmc->return_text, _("Error: 'general statistics': %s"), error->message);
+		return NMC_RESULT_ERROR_USER_INPUT;
+	}
+
+	statistics = nm_client_get_platform_statistics (nmc->client, &error);
+	if (!statistics) {
+		g_string_printf (nmc->return_text, _("Error: %s."), error->message);
+		return NMC_RESULT_ERROR_UNKNOWN;
+	}
+
+	nmc->print_fields.header_name = _("NetworkManager statistics");
+	arr = nmc_dup_fields_array (tmpl, tmpl_len, NMC_OF_FLAG_MAIN_HEADER_ADD | NMC_OF_FLAG_FIELD_NAMES);
+	g_ptr_array_add (nmc->output_data, arr);
+
+	g_variant_iter_init (&iter, statistics);
+	while (g_variant_iter_next (&iter, "{&st}", &name, &value)) {
+		arr = nmc_dup_fields_array (tmpl, tmpl_len, 0);
+		set_val_strc (arr, 0, name);
+		set_val_str (arr, 1, g_strdup_printf ("%"G_GUINT64_FORMAT, value));
+		g_ptr_array_add (nmc->output_data, arr);
+	}
+
+	print_data (nmc);  /* Print all data */
+
+	return nmc->return_value;
+}
+
+static NMCResultCode
+do_general_memory (NmCli *nmc, int argc, char **argv)
+{
+	gs_free_error GError *error = NULL;
+	gs_unref_variant GVariant *usage = NULL;
+	GVariantIter iter;
+	const char *fields_str;
+	const char *name;
+	guint64 n_objects, bytes;
+	NmcOutputField *tmpl, *arr;
+	size_t tmpl_len;
+
+	if (nmc->complete)
+		return nmc->return_value;
+
+	if (!nmc->required_fields || strcasecmp (nmc->required_fields, "common") == 0)
+		fields_str = NMC_FIELDS_NM_MEMORY_COMMON;
+	else if (strcasecmp (nmc->required_fields, "all") == 0)
+		fields_str = NMC_FIELDS_NM_MEMORY_ALL;
+	else
+		fields_str = nmc->required_fields;
+
+	tmpl = nmc_fields_nm_memory;
+	tmpl_len = sizeof (nmc_fields_nm_memory);
+	nmc->print_fields.indices = parse_output_fields (fields_str, tmpl, FALSE, NULL, &error);
+	if (error) {
+		g_string_printf (nmc->return_text, _("Error: 'general memory': %s"), error->message);
+		return NMC_RESULT_ERROR_USER_INPUT;
+	}
+
+	usage = nm_client_get_memory_usage (nmc->client, &error);
+	if (!usage) {
+		g_string_printf (nmc->return_text, _("Error: %s."), error->message);
+		return NMC_RESULT_ERROR_UNKNOWN;
+	}
+
+	nmc->print_fields.header_name = _("NetworkManager memory usage");
+	arr = nmc_dup_fields_array (tmpl, tmpl_len, NMC_OF_FLAG_MAIN_HEADER_ADD | NMC_OF_FLAG_FIELD_NAMES);
+	g_ptr_array_add (nmc->output_data, arr);
+
+	g_variant_iter_init (&iter, usage);
+	while (g_variant_iter_next (&iter, "{&s(tt)}", &name, &n_objects, &bytes)) {
+		arr = nmc_dup_fields_array (tmpl, tmpl_len, 0);
+		set_val_strc (arr, 0, name);
+		set_val_str (arr, 1, g_strdup_printf ("%"G_GUINT64_FORMAT, n_objects));
+		set_val_str (arr, 2, g_strdup_printf ("%"G_GUINT64_FORMAT, bytes));
+		g_ptr_array_add (nmc->output_data, arr);
+	}
+
+	print_data (nmc);  /* Print all data */
+
+	return nmc->return_value;
+}
+
 static void
 nmc_complete_strings_nocase (const char *prefix, ...)
 {
@@ -753,6 +900,8 @@ static const NMCCommand general_cmds[] = {
 	{ "hostname",     do_general_hostname,     usage_general_hostname,     TRUE,   TRUE },
 	{ "permissions",  do_general_permissions,  usage_general_permissions,  TRUE,   TRUE },
 	{ "logging",      do_general_logging,      usage_general_logging,      TRUE,   TRUE },
+	{ "statistics",   do_general_statistics,   usage_general_statistics,   TRUE,   TRUE },
+	{ "memory",       do_general_memory,       usage_general_memory,       TRUE,   TRUE },
 	{ NULL,           do_general_status,       usage_general,              TRUE,   TRUE },
 };
 
@@ -1070,6 +1219,12 @@ client_state (NMClient *client, GParamSpec *param, NmCli *nmc)
 }
 
 
+static void
+client_notify_json (NMClient *client, GParamSpec *pspec, NmCli *nmc)
+{
+	nmc_monitor_json_print ("changed", G_OBJECT (client), pspec);
+}
+
 static void
 device_overview (NmCli *nmc, NMDevice *device)
 {
@@ -1319,6 +1474,11 @@ do_monitor (NmCli *nmc, int argc, char **argv)
 	if (nmc->complete)
 		return nmc->return_value;
 
+	if (argc > 0 && nmc_arg_is_option (*argv, "json")) {
+		nmc->monitor_json = TRUE;
+		next_arg (nmc, &argc, &argv);
+	}
+
 	if (argc > 0) {
 		if (!nmc_arg_is_help (*argv)) {
 			g_string_printf (nmc->return_text, _("Error: 'monitor' command '%s' is not valid."), *argv);
@@ -1329,6 +1489,12 @@ do_monitor (NmCli *nmc, int argc, char **argv)
 		return nmc->return_value;
 	}
 
+	if (nmc->monitor_json) {
+		g_signal_connect (nmc->client, "notify",
+		                  G_CALLBACK (client_notify_json), nmc);
+		goto watch;
+	}
+
 	if (!nm_client_get_nm_running (nmc->client)) {
 		char *str;
 
@@ -1349,6 +1515,7 @@ do_monitor (NmCli *nmc, int argc, char **argv)
 	g_signal_connect (nmc->client, "notify::" NM_CLIENT_STATE,
 	                  G_CALLBACK (client_state), nmc);
 
+watch:
 	nmc->should_wait++;
 
 	monitor_devices (nmc);
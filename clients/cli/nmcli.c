@@ -24,6 +24,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <errno.h>
 #include <signal.h>
 #include <termios.h>
 #include <unistd.h>
@@ -61,6 +62,7 @@ typedef struct {
 
 /* --- Global variables --- */
 GMainLoop *loop = NULL;
+static const char *batch_file = NULL;
 struct termios termios_orig;
 
 NM_CACHED_QUARK_FCN ("nmcli-error-quark", nmcli_error_quark)
@@ -159,6 +161,7 @@ complete_fields (const char *prefix)
 	complete_field (h, "ip-tunnel", nmc_fields_setting_ip_tunnel);
 	complete_field (h, "macvlan", nmc_fields_setting_macvlan);
 	complete_field (h, "vxlan", nmc_fields_setting_vxlan);
+	complete_field (h, "ethtool", nmc_fields_setting_ethtool);
 
 	g_hash_table_foreach (h, complete_one, (gpointer) prefix);
 	g_hash_table_destroy (h);
@@ -181,6 +184,7 @@ usage (void)
 	              "  -a[sk]                                         ask for missing parameters\n"
 	              "  -s[how-secrets]                                allow displaying passwords\n"
 	              "  -w[ait] <seconds>                              set timeout waiting for finishing operations\n"
+	              "  -b[atch] <file>|-                              run the commands in the file, one per line\n"
 	              "  -v[ersion]                                     show program version\n"
 	              "  -h[elp]                                        print this help\n"
 	              "\n"
@@ -232,7 +236,7 @@ process_command_line (NmCli *nmc, int argc, char **argv)
 		if (argc == 1 && nmc->complete) {
 			nmc_complete_strings (opt, "--terse", "--pretty", "--mode", "--colors", "--escape",
 			                           "--fields", "--nocheck", "--get-values",
-			                            "--wait", "--version", "--help", NULL);
+			                            "--wait", "--batch", "--version", "--help", NULL);
 		}
 
 		if (opt[1] == '-') {
@@ -377,6 +381,15 @@ process_command_line (NmCli *nmc, int argc, char **argv)
 				return FALSE;
 			}
 			nmc->timeout = (int) timeout;
+		} else if (matches (opt, "-batch")) {
+			argc--;
+			argv++;
+			if (!argc) {
+				g_string_printf (nmc->return_text, _("Error: missing argument for '%s' option."), opt);
+				nmc->return_value = NMC_RESULT_ERROR_USER_INPUT;
+				return FALSE;
+			}
+			batch_file = argv[0];
 		} else if (matches (opt, "-version")) {
 			if (!nmc->complete)
 				g_print (_("nmcli tool, version %s\n"), NMCLI_VERSION);
@@ -393,6 +406,16 @@ process_command_line (NmCli *nmc, int argc, char **argv)
 		next_arg (nmc, &argc, &argv);
 	}
 
+	if (batch_file) {
+		/* the commands are read from the file by process_batch() */
+		if (argc) {
+			g_string_printf (nmc->return_text, _("Error: no command is allowed with '--batch'."));
+			nmc->return_value = NMC_RESULT_ERROR_USER_INPUT;
+			return FALSE;
+		}
+		return TRUE;
+	}
+
 	/* Now run the requested command */
 	nmc_do_cmd (nmc, nmcli_cmds, *argv, argc, argv);
 
@@ -400,6 +423,97 @@ process_command_line (NmCli *nmc, int argc, char **argv)
 }
 
 static gboolean nmcli_sigint = FALSE;
+static gboolean nmcli_interrupted = FALSE;
+
+/*
+ * Run the commands of @batch_file, one per line, like
+ * "connection add type ethernet ifname eth0". Empty lines and lines
+ * starting with '#' are skipped. All commands share the same NMClient,
+ * which is created only once for the first command that needs it, and
+ * the global options. Failures are reported with the line number, and
+ * the processing goes on with the next line. The result is the one of
+ * the first failed command.
+ */
+static void
+process_batch (NmCli *nmc)
+{
+	gs_unref_ptrarray GPtrArray *cmd_argvs = NULL;
+	gs_free char *required_fields = g_strdup (nmc->required_fields);
+	const NMCPrintOutput print_output = nmc->print_output;
+	const gboolean multiline_output = nmc->multiline_output;
+	const int timeout = nmc->timeout;
+	NMCResultCode result = NMC_RESULT_SUCCESS;
+	guint line_num = 0, n_cmds = 0, n_failed = 0;
+	char *line = NULL;
+	size_t line_size = 0;
+	FILE *f;
+
+	if (nm_streq (batch_file, "-"))
+		f = stdin;
+	else {
+		f = fopen (batch_file, "re");
+		if (!f) {
+			g_string_printf (nmc->return_text, _("Error: failed to open '%s': %s."),
+			                 batch_file, g_strerror (errno));
+			nmc->return_value = NMC_RESULT_ERROR_USER_INPUT;
+			return;
+		}
+	}
+
+	/* nmc_do_cmd() requires the arguments to stay around. */
+	cmd_argvs = g_ptr_array_new_with_free_func ((GDestroyNotify) g_strfreev);
+
+	while (!nmcli_interrupted && getline (&line, &line_size, f) >= 0) {
+		gs_free_error GError *error = NULL;
+		char **cmd_argv;
+		int cmd_argc;
+
+		line_num++;
+		g_strstrip (line);
+		if (!line[0] || line[0] == '#')
+			continue;
+
+		n_cmds++;
+		nmc->return_value = NMC_RESULT_SUCCESS;
+		g_string_assign (nmc->return_text, _("Success"));
+		nmc->should_wait = 0;
+
+		/* commands modify the options to apply their defaults. */
+		g_free (nmc->required_fields);
+		nmc->required_fields = g_strdup (required_fields);
+		nmc->print_output = print_output;
+		nmc->multiline_output = multiline_output;
+		nmc->timeout = timeout;
+
+		if (!g_shell_parse_argv (line, &cmd_argc, &cmd_argv, &error)) {
+			g_string_printf (nmc->return_text, _("Error: %s."), error->message);
+			nmc->return_value = NMC_RESULT_ERROR_USER_INPUT;
+		} else {
+			g_ptr_array_add (cmd_argvs, cmd_argv);
+			nmc_do_cmd (nmc, nmcli_cmds, cmd_argv[0], cmd_argc, cmd_argv);
+			g_main_loop_run (loop);
+			nmc_empty_output_fields (nmc);
+		}
+
+		if (nmc->return_value != NMC_RESULT_SUCCESS) {
+			g_printerr ("%s:%u: %s\n", batch_file, line_num, nmc->return_text->str);
+			if (result == NMC_RESULT_SUCCESS)
+				result = nmc->return_value;
+			n_failed++;
+		}
+	}
+
+	free (line);
+	if (f != stdin)
+		fclose (f);
+
+	nmc->return_value = result;
+	if (n_failed) {
+		g_string_printf (nmc->return_text, _("Error: %u of %u commands failed."),
+		                 n_failed, n_cmds);
+	} else
+		g_string_assign (nmc->return_text, _("Success"));
+}
 
 gboolean
 nmc_seen_sigint (void)
@@ -433,6 +547,7 @@ signal_handler (gpointer user_data)
 			g_print (_("Error: nmcli terminated by signal %s (%d)\n"),
 			         strsignal (signo),
 			         signo);
+			nmcli_interrupted = TRUE;
 			g_main_loop_quit (loop);
 		}
 		break;
@@ -554,6 +669,7 @@ nmc_init (NmCli *nmc)
 	memset (&nmc->print_fields, '\0', sizeof (NmcPrintFields));
 	nmc->ask = FALSE;
 	nmc->complete = FALSE;
+	nmc->monitor_json = FALSE;
 	nmc->show_secrets = FALSE;
 	nmc->use_colors = NMC_USE_COLOR_AUTO;
 	nmc->in_editor = FALSE;
@@ -610,8 +726,12 @@ main (int argc, char *argv[])
 
 	nmc_init (&nm_cli);
 	loop = g_main_loop_new (NULL, FALSE);
-	if (process_command_line (&nm_cli, argc, argv))
-		g_main_loop_run (loop);
+	if (process_command_line (&nm_cli, argc, argv)) {
+		if (batch_file)
+			process_batch (&nm_cli);
+		else
+			g_main_loop_run (loop);
+	}
 
 	if (nm_cli.complete) {
 		/* Remove error statuses from command completion runs. */
@@ -274,6 +274,8 @@ NmcOutputField nmc_fields_setting_wireless_security[] = {
 	SETTING_FIELD (NM_SETTING_WIRELESS_SECURITY_PSK_FLAGS),            /* 15 */
 	SETTING_FIELD (NM_SETTING_WIRELESS_SECURITY_LEAP_PASSWORD),        /* 16 */
 	SETTING_FIELD (NM_SETTING_WIRELESS_SECURITY_LEAP_PASSWORD_FLAGS),  /* 17 */
+	SETTING_FIELD (NM_SETTING_WIRELESS_SECURITY_FT),                   /* 18 */
+	SETTING_FIELD (NM_SETTING_WIRELESS_SECURITY_OKC),                  /* 19 */
 	{NULL, NULL, 0, NULL, FALSE, FALSE, 0}
 };
 #define NMC_FIELDS_SETTING_WIRELESS_SECURITY_ALL     "name"","\
@@ -293,11 +295,13 @@ NmcOutputField nmc_fields_setting_wireless_security[] = {
                                                      NM_SETTING_WIRELESS_SECURITY_PSK","\
                                                      NM_SETTING_WIRELESS_SECURITY_PSK_FLAGS","\
                                                      NM_SETTING_WIRELESS_SECURITY_LEAP_PASSWORD","\
-                                                     NM_SETTING_WIRELESS_SECURITY_LEAP_PASSWORD_FLAGS
+                                                     NM_SETTING_WIRELESS_SECURITY_LEAP_PASSWORD_FLAGS","\
+                                                     NM_SETTING_WIRELESS_SECURITY_FT","\
+                                                     NM_SETTING_WIRELESS_SECURITY_OKC
 
 /* Available fields for NM_SETTING_IP4_CONFIG_SETTING_NAME */
 NmcOutputField nmc_fields_setting_ip4_config[] = {
-	SETTING_FIELD ("name"),                                   /* 0 */
+	SETTING_FIELD ("name"),                                    /* 0 */
 	SETTING_FIELD (NM_SETTING_IP_CONFIG_METHOD),              /* 1 */
 	SETTING_FIELD (NM_SETTING_IP_CONFIG_DNS),                 /* 2 */
 	SETTING_FIELD (NM_SETTING_IP_CONFIG_DNS_SEARCH),          /* 3 */
@@ -342,7 +346,7 @@ NmcOutputField nmc_fields_setting_ip4_config[] = {
 
 /* Available fields for NM_SETTING_IP6_CONFIG_SETTING_NAME */
 NmcOutputField nmc_fields_setting_ip6_config[] = {
-	SETTING_FIELD ("name"),                                   /* 0 */
+	SETTING_FIELD ("name"),                                    /* 0 */
 	SETTING_FIELD (NM_SETTING_IP_CONFIG_METHOD),              /* 1 */
 	SETTING_FIELD (NM_SETTING_IP_CONFIG_DNS),                 /* 2 */
 	SETTING_FIELD (NM_SETTING_IP_CONFIG_DNS_SEARCH),          /* 3 */
@@ -724,6 +728,35 @@ NmcOutputField nmc_fields_setting_dummy[] = {
 };
 #define NMC_FIELDS_SETTING_DUMMY_ALL       "name"
 
+/* Available fields for NM_SETTING_ETHTOOL_SETTING_NAME */
+NmcOutputField nmc_fields_setting_ethtool[] = {
+	SETTING_FIELD ("name"),                                    /* 0 */
+	SETTING_FIELD (NM_SETTING_ETHTOOL_RING_RX),                /* 1 */
+	SETTING_FIELD (NM_SETTING_ETHTOOL_RING_TX),                /* 2 */
+	SETTING_FIELD (NM_SETTING_ETHTOOL_CHANNELS_COMBINED),      /* 3 */
+	SETTING_FIELD (NM_SETTING_ETHTOOL_COALESCE_RX_USECS),      /* 4 */
+	SETTING_FIELD (NM_SETTING_ETHTOOL_COALESCE_TX_USECS),      /* 5 */
+	SETTING_FIELD (NM_SETTING_ETHTOOL_OFFLOAD_GRO),            /* 6 */
+	SETTING_FIELD (NM_SETTING_ETHTOOL_OFFLOAD_TSO),            /* 7 */
+	SETTING_FIELD (NM_SETTING_ETHTOOL_OFFLOAD_LRO),            /* 8 */
+	SETTING_FIELD (NM_SETTING_ETHTOOL_RPS_CPUS),               /* 9 */
+	SETTING_FIELD (NM_SETTING_ETHTOOL_XPS_CPUS),               /* 10 */
+	SETTING_FIELD (NM_SETTING_ETHTOOL_IRQ_AFFINITY),           /* 11 */
+	{NULL, NULL, 0, NULL, FALSE, FALSE, 0}
+};
+#define NMC_FIELDS_SETTING_ETHTOOL_ALL       "name"","\
+                                             NM_SETTING_ETHTOOL_RING_RX","\
+                                             NM_SETTING_ETHTOOL_RING_TX","\
+                                             NM_SETTING_ETHTOOL_CHANNELS_COMBINED","\
+                                             NM_SETTING_ETHTOOL_COALESCE_RX_USECS","\
+                                             NM_SETTING_ETHTOOL_COALESCE_TX_USECS","\
+                                             NM_SETTING_ETHTOOL_OFFLOAD_GRO","\
+                                             NM_SETTING_ETHTOOL_OFFLOAD_TSO","\
+                                             NM_SETTING_ETHTOOL_OFFLOAD_LRO","\
+                                             NM_SETTING_ETHTOOL_RPS_CPUS","\
+                                             NM_SETTING_ETHTOOL_XPS_CPUS","\
+                                             NM_SETTING_ETHTOOL_IRQ_AFFINITY
+
 /* Available fields for NM_SETTING_TUN_SETTING_NAME */
 NmcOutputField nmc_fields_setting_tun[] = {
 	SETTING_FIELD ("name"),                                /* 0 */
@@ -4527,6 +4560,19 @@ DEFINE_GETTER (nmc_property_pppoe_get_password, NM_SETTING_PPPOE_PASSWORD)
 DEFINE_SECRET_FLAGS_GETTER (nmc_property_pppoe_get_password_flags, NM_SETTING_PPPOE_PASSWORD_FLAGS)
 
 
+/* --- NM_SETTING_ETHTOOL_SETTING_NAME property functions --- */
+DEFINE_GETTER (nmc_property_ethtool_get_ring_rx, NM_SETTING_ETHTOOL_RING_RX)
+DEFINE_GETTER (nmc_property_ethtool_get_ring_tx, NM_SETTING_ETHTOOL_RING_TX)
+DEFINE_GETTER (nmc_property_ethtool_get_channels_combined, NM_SETTING_ETHTOOL_CHANNELS_COMBINED)
+DEFINE_GETTER (nmc_property_ethtool_get_coalesce_rx_usecs, NM_SETTING_ETHTOOL_COALESCE_RX_USECS)
+DEFINE_GETTER (nmc_property_ethtool_get_coalesce_tx_usecs, NM_SETTING_ETHTOOL_COALESCE_TX_USECS)
+DEFINE_GETTER (nmc_property_ethtool_get_offload_gro, NM_SETTING_ETHTOOL_OFFLOAD_GRO)
+DEFINE_GETTER (nmc_property_ethtool_get_offload_tso, NM_SETTING_ETHTOOL_OFFLOAD_TSO)
+DEFINE_GETTER (nmc_property_ethtool_get_offload_lro, NM_SETTING_ETHTOOL_OFFLOAD_LRO)
+DEFINE_GETTER (nmc_property_ethtool_get_rps_cpus, NM_SETTING_ETHTOOL_RPS_CPUS)
+DEFINE_GETTER (nmc_property_ethtool_get_xps_cpus, NM_SETTING_ETHTOOL_XPS_CPUS)
+DEFINE_GETTER (nmc_property_ethtool_get_irq_affinity, NM_SETTING_ETHTOOL_IRQ_AFFINITY)
+
 /* --- NM_SETTING_PROXY_SETTING_NAME property functions --- */
 DEFINE_GETTER (nmc_property_proxy_get_browser_only, NM_SETTING_PROXY_BROWSER_ONLY)
 DEFINE_GETTER (nmc_property_proxy_get_pac_url, NM_SETTING_PROXY_PAC_URL)
@@ -5453,6 +5499,8 @@ DEFINE_GETTER (nmc_property_wifi_sec_get_psk, NM_SETTING_WIRELESS_SECURITY_PSK)
 DEFINE_SECRET_FLAGS_GETTER (nmc_property_wifi_sec_get_psk_flags, NM_SETTING_WIRELESS_SECURITY_PSK_FLAGS)
 DEFINE_GETTER (nmc_property_wifi_sec_get_leap_password, NM_SETTING_WIRELESS_SECURITY_LEAP_PASSWORD)
 DEFINE_SECRET_FLAGS_GETTER (nmc_property_wifi_sec_get_leap_password_flags, NM_SETTING_WIRELESS_SECURITY_LEAP_PASSWORD_FLAGS)
+DEFINE_GETTER (nmc_property_wifi_sec_get_ft, NM_SETTING_WIRELESS_SECURITY_FT)
+DEFINE_GETTER (nmc_property_wifi_sec_get_okc, NM_SETTING_WIRELESS_SECURITY_OKC)
 
 static char *
 nmc_property_wifi_sec_get_wep_key0 (NMSetting *setting, NmcPropertyGetType get_type)
@@ -8000,6 +8048,20 @@ nmc_properties_init (void)
 	                    NULL,
 	                    NULL,
 	                    NULL);
+	nmc_add_prop_funcs (GLUE (WIRELESS_SECURITY, FT),
+	                    nmc_property_wifi_sec_get_ft,
+	                    nmc_property_set_trilean,
+	                    NULL,
+	                    NULL,
+	                    NULL,
+	                    NULL);
+	nmc_add_prop_funcs (GLUE (WIRELESS_SECURITY, OKC),
+	                    nmc_property_wifi_sec_get_okc,
+	                    nmc_property_set_trilean,
+	                    NULL,
+	                    NULL,
+	                    NULL,
+	                    NULL);
 
 	/* Add editable properties for NM_SETTING_TUN_SETTING_NAME */
 	nmc_add_prop_funcs (GLUE (TUN, MODE),
@@ -8362,6 +8424,85 @@ nmc_properties_init (void)
 	                    NULL,
 	                    NULL,
 	                    NULL);
+
+	/* Add editable properties for NM_SETTING_ETHTOOL_SETTING_NAME */
+	nmc_add_prop_funcs (GLUE (ETHTOOL, RING_RX),
+	                    nmc_property_ethtool_get_ring_rx,
+	                    nmc_property_set_uint,
+	                    NULL,
+	                    NULL,
+	                    NULL,
+	                    NULL);
+	nmc_add_prop_funcs (GLUE (ETHTOOL, RING_TX),
+	                    nmc_property_ethtool_get_ring_tx,
+	                    nmc_property_set_uint,
+	                    NULL,
+	                    NULL,
+	                    NULL,
+	                    NULL);
+	nmc_add_prop_funcs (GLUE (ETHTOOL, CHANNELS_COMBINED),
+	                    nmc_property_ethtool_get_channels_combined,
+	                    nmc_property_set_uint,
+	                    NULL,
+	                    NULL,
+	                    NULL,
+	                    NULL);
+	nmc_add_prop_funcs (GLUE (ETHTOOL, COALESCE_RX_USECS),
+	                    nmc_property_ethtool_get_coalesce_rx_usecs,
+	                    nmc_property_set_int,
+	                    NULL,
+	                    NULL,
+	                    NULL,
+	                    NULL);
+	nmc_add_prop_funcs (GLUE (ETHTOOL, COALESCE_TX_USECS),
+	                    nmc_property_ethtool_get_coalesce_tx_usecs,
+	                    nmc_property_set_int,
+	                    NULL,
+	                    NULL,
+	                    NULL,
+	                    NULL);
+	nmc_add_prop_funcs (GLUE (ETHTOOL, OFFLOAD_GRO),
+	                    nmc_property_ethtool_get_offload_gro,
+	                    nmc_property_set_trilean,
+	                    NULL,
+	                    NULL,
+	                    NULL,
+	                    NULL);
+	nmc_add_prop_funcs (GLUE (ETHTOOL, OFFLOAD_TSO),
+	                    nmc_property_ethtool_get_offload_tso,
+	                    nmc_property_set_trilean,
+	                    NULL,
+	                    NULL,
+	                    NULL,
+	                    NULL);
+	nmc_add_prop_funcs (GLUE (ETHTOOL, OFFLOAD_LRO),
+	                    nmc_property_ethtool_get_offload_lro,
+	                    nmc_property_set_trilean,
+	                    NULL,
+	                    NULL,
+	                    NULL,
+	                    NULL);
+	nmc_add_prop_funcs (GLUE (ETHTOOL, RPS_CPUS),
+	                    nmc_property_ethtool_get_rps_cpus,
+	                    nmc_property_set_string,
+	                    NULL,
+	                    NULL,
+	                    NULL,
+	                    NULL);
+	nmc_add_prop_funcs (GLUE (ETHTOOL, XPS_CPUS),
+	                    nmc_property_ethtool_get_xps_cpus,
+	                    nmc_property_set_string,
+	                    NULL,
+	                    NULL,
+	                    NULL,
+	                    NULL);
+	nmc_add_prop_funcs (GLUE (ETHTOOL, IRQ_AFFINITY),
+	                    nmc_property_ethtool_get_irq_affinity,
+	                    nmc_property_set_string,
+	                    NULL,
+	                    NULL,
+	                    NULL,
+	                    NULL);
 }
 
 void
@@ -8900,6 +9041,8 @@ setting_wireless_security_details (NMSetting *setting,
 	set_val_str (arr, 15, nmc_property_wifi_sec_get_psk_flags (setting, type));
 	set_val_str (arr, 16, GET_SECRET (secrets, setting, nmc_property_wifi_sec_get_leap_password, type));
 	set_val_str (arr, 17, nmc_property_wifi_sec_get_leap_password_flags (setting, type));
+	set_val_str (arr, 18, nmc_property_wifi_sec_get_ft (setting, type));
+	set_val_str (arr, 19, nmc_property_wifi_sec_get_okc (setting, type));
 	g_ptr_array_add (nmc->output_data, arr);
 
 	print_data (nmc);  /* Print all data */
@@ -9851,6 +9994,46 @@ setting_proxy_details (NMSetting *setting,
 	return TRUE;
 }
 
+static gboolean
+setting_ethtool_details (NMSetting *setting,
+                         NmCli *nmc,
+                         const char *one_prop,
+                         gboolean secrets,
+                         NmcPropertyGetType type)
+{
+	NMSettingEthtool *s_ethtool = NM_SETTING_ETHTOOL (setting);
+	NmcOutputField *tmpl, *arr;
+	size_t tmpl_len;
+
+	g_return_val_if_fail (NM_IS_SETTING_ETHTOOL (s_ethtool), FALSE);
+
+	tmpl = nmc_fields_setting_ethtool;
+	tmpl_len = sizeof (nmc_fields_setting_ethtool);
+	nmc->print_fields.indices = parse_output_fields (one_prop ? one_prop : NMC_FIELDS_SETTING_ETHTOOL_ALL,
+	                                                 tmpl, FALSE, NULL, NULL);
+	arr = nmc_dup_fields_array (tmpl, tmpl_len, NMC_OF_FLAG_FIELD_NAMES);
+	g_ptr_array_add (nmc->output_data, arr);
+
+	arr = nmc_dup_fields_array (tmpl, tmpl_len, NMC_OF_FLAG_SECTION_PREFIX);
+	set_val_str (arr, 0, g_strdup (nm_setting_get_name (setting)));
+	set_val_str (arr, 1, nmc_property_ethtool_get_ring_rx (setting, type));
+	set_val_str (arr, 2, nmc_property_ethtool_get_ring_tx (setting, type));
+	set_val_str (arr, 3, nmc_property_ethtool_get_channels_combined (setting, type));
+	set_val_str (arr, 4, nmc_property_ethtool_get_coalesce_rx_usecs (setting, type));
+	set_val_str (arr, 5, nmc_property_ethtool_get_coalesce_tx_usecs (setting, type));
+	set_val_str (arr, 6, nmc_property_ethtool_get_offload_gro (setting, type));
+	set_val_str (arr, 7, nmc_property_ethtool_get_offload_tso (setting, type));
+	set_val_str (arr, 8, nmc_property_ethtool_get_offload_lro (setting, type));
+	set_val_str (arr, 9, nmc_property_ethtool_get_rps_cpus (setting, type));
+	set_val_str (arr, 10, nmc_property_ethtool_get_xps_cpus (setting, type));
+	set_val_str (arr, 11, nmc_property_ethtool_get_irq_affinity (setting, type));
+	g_ptr_array_add (nmc->output_data, arr);
+
+	print_data (nmc);  /* Print all data */
+
+	return TRUE;
+}
+
 typedef struct {
 	const char *sname;
 	gboolean (*func) (NMSetting *setting,
@@ -9892,6 +10075,7 @@ static const SettingDetails detail_printers[] = {
 	{ NM_SETTING_MACVLAN_SETTING_NAME,           setting_macvlan_details },
 	{ NM_SETTING_VXLAN_SETTING_NAME,             setting_vxlan_details },
 	{ NM_SETTING_PROXY_SETTING_NAME,             setting_proxy_details },
+	{ NM_SETTING_ETHTOOL_SETTING_NAME,           setting_ethtool_details },
 	{ NULL },
 };
 
@@ -96,5 +96,6 @@ extern NmcOutputField nmc_fields_setting_macsec[];
 extern NmcOutputField nmc_fields_setting_vxlan[];
 extern NmcOutputField nmc_fields_setting_proxy[];
 extern NmcOutputField nmc_fields_setting_dummy[];
+extern NmcOutputField nmc_fields_setting_ethtool[];
 
 #endif /* NMC_SETTINGS_H */
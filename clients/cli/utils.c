@@ -1223,6 +1223,41 @@ print_required_fields (NmCli *nmc, const NmcOutputField field_values[])
 	g_string_free (str, TRUE);
 }
 
+/*
+ * Add a row to nmc->output_data for print_data().
+ *
+ * Only the tabular output of normal and pretty mode aligns the columns to
+ * the widest value, which requires all rows. In terse and multiline mode,
+ * the row is printed right away and freed instead, so that long listings
+ * are neither buffered nor delayed until the last row. The rows before
+ * the first one printed that way are printed first, to keep the order.
+ * nmc->print_fields must be set up before adding the first row.
+ */
+void
+nmc_output_data_add (NmCli *nmc, NmcOutputField *row)
+{
+	guint i;
+
+	if (   nmc->print_output != NMC_PRINT_TERSE
+	    && !nmc->multiline_output) {
+		g_ptr_array_add (nmc->output_data, row);
+		return;
+	}
+
+	for (i = 0; i < nmc->output_data->len; i++) {
+		NmcOutputField *fld_arr = g_ptr_array_index (nmc->output_data, i);
+
+		print_required_fields (nmc, fld_arr);
+		nmc_free_output_field_values (fld_arr);
+	}
+	if (nmc->output_data->len > 0)
+		g_ptr_array_remove_range (nmc->output_data, 0, nmc->output_data->len);
+
+	print_required_fields (nmc, row);
+	nmc_free_output_field_values (row);
+	g_free (row);
+}
+
 /*
  * Print nmc->output_data
  *
@@ -1276,3 +1311,157 @@ print_data (NmCli *nmc)
 	}
 }
 
+
+/*****************************************************************************/
+
+static void
+_json_append_string (GString *str, const char *s)
+{
+	if (!s) {
+		g_string_append (str, "null");
+		return;
+	}
+
+	g_string_append_c (str, '"');
+	for (; *s; s++) {
+		switch (*s) {
+		case '"':
+			g_string_append (str, "\\\"");
+			break;
+		case '\\':
+			g_string_append (str, "\\\\");
+			break;
+		case '\n':
+			g_string_append (str, "\\n");
+			break;
+		case '\t':
+			g_string_append (str, "\\t");
+			break;
+		default:
+			if ((guchar) *s < 0x20)
+				g_string_append_printf (str, "\\u%04x", (guint) (guchar) *s);
+			else
+				g_string_append_c (str, *s);
+			break;
+		}
+	}
+	g_string_append_c (str, '"');
+}
+
+static void
+_json_append_object_path (GString *str, gpointer object)
+{
+	_json_append_string (str, NM_IS_OBJECT (object) ? nm_object_get_path (object) : NULL);
+}
+
+static void
+_json_append_value (GString *str, GParamSpec *pspec, const GValue *value)
+{
+	GType type = G_VALUE_TYPE (value);
+	guint i;
+
+	if (type == G_TYPE_STRING)
+		_json_append_string (str, g_value_get_string (value));
+	else if (type == G_TYPE_BOOLEAN)
+		g_string_append (str, g_value_get_boolean (value) ? "true" : "false");
+	else if (type == G_TYPE_INT)
+		g_string_append_printf (str, "%d", g_value_get_int (value));
+	else if (type == G_TYPE_UINT)
+		g_string_append_printf (str, "%u", g_value_get_uint (value));
+	else if (type == G_TYPE_UCHAR)
+		g_string_append_printf (str, "%u", (guint) g_value_get_uchar (value));
+	else if (type == G_TYPE_INT64)
+		g_string_append_printf (str, "%" G_GINT64_FORMAT, g_value_get_int64 (value));
+	else if (type == G_TYPE_UINT64)
+		g_string_append_printf (str, "%" G_GUINT64_FORMAT, g_value_get_uint64 (value));
+	else if (G_VALUE_HOLDS_ENUM (value))
+		g_string_append_printf (str, "%d", g_value_get_enum (value));
+	else if (G_VALUE_HOLDS_FLAGS (value))
+		g_string_append_printf (str, "%u", g_value_get_flags (value));
+	else if (G_VALUE_HOLDS_OBJECT (value))
+		_json_append_object_path (str, g_value_get_object (value));
+	else if (type == G_TYPE_STRV) {
+		const char *const *strv = g_value_get_boxed (value);
+
+		g_string_append_c (str, '[');
+		for (i = 0; strv && strv[i]; i++) {
+			if (i > 0)
+				g_string_append_c (str, ',');
+			_json_append_string (str, strv[i]);
+		}
+		g_string_append_c (str, ']');
+	} else if (   type == G_TYPE_PTR_ARRAY
+	           && !NM_IN_STRSET (pspec->name,
+	                             NM_DEVICE_LLDP_NEIGHBORS,
+	                             NM_CLIENT_DNS_CONFIGURATION)) {
+		/* libnm uses pointer arrays for lists of NMObjects. The two
+		 * exceptions above hold boxed types instead. */
+		const GPtrArray *arr = g_value_get_boxed (value);
+
+		g_string_append_c (str, '[');
+		for (i = 0; arr && i < arr->len; i++) {
+			if (i > 0)
+				g_string_append_c (str, ',');
+			_json_append_object_path (str, arr->pdata[i]);
+		}
+		g_string_append_c (str, ']');
+	} else
+		g_string_append (str, "null");
+}
+
+/**
+ * nmc_monitor_json_print:
+ * @event: the kind of event, like "changed", "added" or "removed"
+ * @object: the #NMClient or #NMObject the event is about
+ * @pspec: (allow-none): for "changed", the property that changed
+ *
+ * Prints one line with a JSON object describing the event, for
+ * "nmcli monitor --json". Only the changed property is read, so the
+ * output follows the signals of libnm without fetching any other state.
+ * Enum and flag values are printed as numbers, objects as their D-Bus
+ * paths and properties of other types as null.
+ */
+void
+nmc_monitor_json_print (const char *event, GObject *object, GParamSpec *pspec)
+{
+	GString *str;
+
+	str = g_string_sized_new (128);
+	g_string_append_printf (str, "{\"timestamp-us\":%" G_GINT64_FORMAT ",\"event\":",
+	                        g_get_real_time ());
+	_json_append_string (str, event);
+	g_string_append (str, ",\"type\":");
+	_json_append_string (str, G_OBJECT_TYPE_NAME (object));
+	g_string_append (str, ",\"path\":");
+	_json_append_string (str, NM_IS_OBJECT (object) ? nm_object_get_path (NM_OBJECT (object)) : NM_DBUS_PATH);
+
+	if (NM_IS_DEVICE (object)) {
+		g_string_append (str, ",\"iface\":");
+		_json_append_string (str, nm_device_get_iface (NM_DEVICE (object)));
+	} else if (NM_IS_CONNECTION (object)) {
+		g_string_append (str, ",\"id\":");
+		_json_append_string (str, nm_connection_get_id (NM_CONNECTION (object)));
+		g_string_append (str, ",\"uuid\":");
+		_json_append_string (str, nm_connection_get_uuid (NM_CONNECTION (object)));
+	}
+
+	if (pspec) {
+		GValue value = G_VALUE_INIT;
+
+		g_value_init (&value, pspec->value_type);
+		g_object_get_property (object, pspec->name, &value);
+
+		g_string_append (str, ",\"property\":");
+		_json_append_string (str, pspec->name);
+		g_string_append (str, ",\"value\":");
+		_json_append_value (str, pspec, &value);
+		g_value_unset (&value);
+	}
+
+	g_string_append (str, "}\n");
+
+	/* the output usually goes to a pipe, which is block buffered. */
+	fputs (str->str, stdout);
+	fflush (stdout);
+	g_string_free (str, TRUE);
+}
@@ -101,5 +101,7 @@ NmcOutputField *nmc_dup_fields_array (NmcOutputField fields[], size_t size, guin
 void nmc_empty_output_fields (NmCli *nmc);
 void print_required_fields (NmCli *nmc, const NmcOutputField field_values[]);
 void print_data (NmCli *nmc);
+void nmc_output_data_add (NmCli *nmc, NmcOutputField *row);
+void nmc_monitor_json_print (const char *event, GObject *object, GParamSpec *pspec);
 
 #endif /* NMC_UTILS_H */
@@ -76,15 +76,45 @@ nm_vpn_get_editor_plugin (const char *service_type, GError **error)
 	return plugin;
 }
 
+static NMClient *plugins_client;
+
+/**
+ * nm_vpn_helpers_set_client:
+ * @client: (allow-none): the client to ask for the VPN plugins
+ *
+ * Lets nm_vpn_get_plugin_infos() take the plugins from the index kept by
+ * NetworkManager, instead of scanning the plugin directories. Without a
+ * client, or if NetworkManager can't tell, the directories are scanned.
+ */
+void
+nm_vpn_helpers_set_client (NMClient *client)
+{
+	g_return_if_fail (!client || NM_IS_CLIENT (client));
+
+	if (plugins_client)
+		g_object_remove_weak_pointer (G_OBJECT (plugins_client), (gpointer *) &plugins_client);
+	plugins_client = client;
+	if (plugins_client)
+		g_object_add_weak_pointer (G_OBJECT (plugins_client), (gpointer *) &plugins_client);
+}
+
 GSList *
 nm_vpn_get_plugin_infos (void)
 {
 	static bool plugins_loaded;
 	static GSList *plugins = NULL;
+	gs_free_error GError *error = NULL;
 
 	if (G_LIKELY (plugins_loaded))
 		return plugins;
 	plugins_loaded = TRUE;
+
+	if (plugins_client) {
+		plugins = nm_client_get_vpn_plugin_infos (plugins_client, &error);
+		if (plugins || !error)
+			return plugins;
+	}
+
 	plugins = nm_vpn_plugin_info_list_load ();
 	return plugins;
 }
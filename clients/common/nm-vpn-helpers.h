@@ -26,6 +26,8 @@ typedef struct {
 	const char *ui_name;
 } VpnPasswordName;
 
+void nm_vpn_helpers_set_client (NMClient *client);
+
 GSList *nm_vpn_get_plugin_infos (void);
 
 NMVpnEditorPlugin *nm_vpn_get_editor_plugin (const char *service_type, GError **error);
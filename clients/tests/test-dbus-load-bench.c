@@ -0,0 +1,419 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright 2017 Red Hat, Inc.
+ */
+
+/* D-Bus load generator for a running NetworkManager.
+ *
+ * This is not run by "make check". Run it by hand against the daemon on
+ * the system bus, or against another one by setting
+ * DBUS_SYSTEM_BUS_ADDRESS (for example a daemon using the fake platform,
+ * or tools/test-networkmanager-service.py).
+ *
+ * For each operation, the given number of clients, each with its own bus
+ * connection and thread, issue synchronous calls for the given duration.
+ * The operations are
+ *
+ *   get-devices       GetDevices() on the manager
+ *   get-property      Get() of the manager's "State" property
+ *   get-properties    GetAll() on the devices, round robin
+ *   get-settings      GetSettings() on the connections, round robin
+ *   activate          ActivateConnection() of --activate-connection
+ *
+ * "activate" disrupts the network and is only run when requested. Each
+ * operation prints one line
+ *
+ *   bench<TAB>dbus<TAB>operation<TAB>clients<TAB>calls<TAB>errors<TAB>calls-per-s<TAB>p50-us<TAB>p99-us<TAB>p999-us<TAB>max-us<TAB>daemon-cpu-us-per-call
+ *
+ * to stdout, similar to src/tests/test-scale-bench. The daemon CPU time
+ * is taken from /proc and is -1 if the daemon is not local. */
+
+#include "nm-default.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "nm-dbus-interface.h"
+
+/*****************************************************************************/
+
+typedef enum {
+	OP_GET_DEVICES,
+	OP_GET_PROPERTY,
+	OP_GET_PROPERTIES,
+	OP_GET_SETTINGS,
+	OP_ACTIVATE,
+	_OP_NUM,
+} Op;
+
+static const char *const op_names[_OP_NUM] = {
+	[OP_GET_DEVICES]    = "get-devices",
+	[OP_GET_PROPERTY]   = "get-property",
+	[OP_GET_PROPERTIES] = "get-properties",
+	[OP_GET_SETTINGS]   = "get-settings",
+	[OP_ACTIVATE]       = "activate",
+};
+
+typedef struct {
+	Op op;
+	char *address;
+	char **paths;
+	guint n_paths;
+	const char *activate_path;
+	gint64 end_at;
+	guint offset;
+
+	GArray *latencies;
+	guint errors;
+} Client;
+
+static int opt_clients = 8;
+static int opt_duration = 5;
+static char *opt_ops = NULL;
+static char *opt_activate_connection = NULL;
+
+static GOptionEntry entries[] = {
+	{ "clients", 'c', 0, G_OPTION_ARG_INT, &opt_clients, "Number of concurrent clients (default 8)", "N" },
+	{ "duration", 'd', 0, G_OPTION_ARG_INT, &opt_duration, "Seconds to run each operation (default 5)", "SECONDS" },
+	{ "ops", 'o', 0, G_OPTION_ARG_STRING, &opt_ops, "Comma separated operations (default: all but activate)", "OPS" },
+	{ "activate-connection", 'a', 0, G_OPTION_ARG_STRING, &opt_activate_connection, "D-Bus path of the connection for \"activate\"", "PATH" },
+	{ NULL }
+};
+
+/*****************************************************************************/
+
+static GVariant *
+_call (GDBusConnection *bus,
+       const char *path,
+       const char *interface,
+       const char *method,
+       GVariant *parameters,
+       const GVariantType *reply_type,
+       GError **error)
+{
+	return g_dbus_connection_call_sync (bus,
+	                                    NM_DBUS_SERVICE,
+	                                    path,
+	                                    interface,
+	                                    method,
+	                                    parameters,
+	                                    reply_type,
+	                                    G_DBUS_CALL_FLAGS_NONE,
+	                                    -1,
+	                                    NULL,
+	                                    error);
+}
+
+static char **
+_get_paths (GDBusConnection *bus,
+            const char *path,
+            const char *interface,
+            const char *method)
+{
+	gs_unref_variant GVariant *ret = NULL;
+	gs_free_error GError *error = NULL;
+	char **paths = NULL;
+
+	ret = _call (bus, path, interface, method, NULL, G_VARIANT_TYPE ("(ao)"), &error);
+	if (!ret) {
+		g_printerr ("%s() failed: %s\n", method, error->message);
+		return NULL;
+	}
+	g_variant_get (ret, "(^ao)", &paths);
+	return paths;
+}
+
+static gint64
+_daemon_cpu_us (guint32 pid)
+{
+	gs_free char *filename = NULL;
+	gs_free char *contents = NULL;
+	gs_strfreev char **fields = NULL;
+	const char *s;
+
+	if (!pid)
+		return -1;
+
+	filename = g_strdup_printf ("/proc/%u/stat", (guint) pid);
+	if (!g_file_get_contents (filename, &contents, NULL, NULL))
+		return -1;
+
+	/* skip "pid (comm)", as comm may contain spaces. utime and stime
+	 * are the 14th and 15th field, that is the 12th and 13th after it. */
+	s = strrchr (contents, ')');
+	if (!s)
+		return -1;
+	fields = g_strsplit (s + 2, " ", 14);
+	if (g_strv_length (fields) < 13)
+		return -1;
+
+	return (g_ascii_strtoll (fields[11], NULL, 10) + g_ascii_strtoll (fields[12], NULL, 10))
+	       * G_USEC_PER_SEC / sysconf (_SC_CLK_TCK);
+}
+
+static guint32
+_daemon_pid (GDBusConnection *bus)
+{
+	gs_unref_variant GVariant *ret = NULL;
+	guint32 pid = 0;
+
+	ret = g_dbus_connection_call_sync (bus,
+	                                   "org.freedesktop.DBus",
+	                                   "/org/freedesktop/DBus",
+	                                   "org.freedesktop.DBus",
+	                                   "GetConnectionUnixProcessID",
+	                                   g_variant_new ("(s)", NM_DBUS_SERVICE),
+	                                   G_VARIANT_TYPE ("(u)"),
+	                                   G_DBUS_CALL_FLAGS_NONE,
+	                                   -1,
+	                                   NULL,
+	                                   NULL);
+	if (ret)
+		g_variant_get (ret, "(u)", &pid);
+	return pid;
+}
+
+/*****************************************************************************/
+
+static gboolean
+_client_call (Client *client, GDBusConnection *bus, guint i)
+{
+	gs_unref_variant GVariant *ret = NULL;
+	const char *path = NULL;
+
+	if (client->n_paths)
+		path = client->paths[(client->offset + i) % client->n_paths];
+
+	switch (client->op) {
+	case OP_GET_DEVICES:
+		ret = _call (bus, NM_DBUS_PATH, NM_DBUS_INTERFACE, "GetDevices",
+		             NULL, G_VARIANT_TYPE ("(ao)"), NULL);
+		break;
+	case OP_GET_PROPERTY:
+		ret = _call (bus, NM_DBUS_PATH, "org.freedesktop.DBus.Properties", "Get",
+		             g_variant_new ("(ss)", NM_DBUS_INTERFACE, "State"),
+		             G_VARIANT_TYPE ("(v)"), NULL);
+		break;
+	case OP_GET_PROPERTIES:
+		ret = _call (bus, path, "org.freedesktop.DBus.Properties", "GetAll",
+		             g_variant_new ("(s)", NM_DBUS_INTERFACE_DEVICE),
+		             G_VARIANT_TYPE ("(a{sv})"), NULL);
+		break;
+	case OP_GET_SETTINGS:
+		ret = _call (bus, path, NM_DBUS_INTERFACE_SETTINGS_CONNECTION, "GetSettings",
+		             NULL, G_VARIANT_TYPE ("(a{sa{sv}})"), NULL);
+		break;
+	case OP_ACTIVATE:
+		ret = _call (bus, NM_DBUS_PATH, NM_DBUS_INTERFACE, "ActivateConnection",
+		             g_variant_new ("(ooo)", client->activate_path, "/", "/"),
+		             G_VARIANT_TYPE ("(o)"), NULL);
+		break;
+	default:
+		g_assert_not_reached ();
+	}
+
+	return !!ret;
+}
+
+static gpointer
+_client_thread (gpointer user_data)
+{
+	Client *client = user_data;
+	gs_unref_object GDBusConnection *bus = NULL;
+	gs_free_error GError *error = NULL;
+	guint i;
+
+	/* a connection of its own, so that the clients are separate peers
+	 * for the daemon and don't share one socket. */
+	bus = g_dbus_connection_new_for_address_sync (client->address,
+	                                              G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT
+	                                              | G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+	                                              NULL, NULL, &error);
+	if (!bus) {
+		g_printerr ("cannot connect to %s: %s\n", client->address, error->message);
+		return NULL;
+	}
+
+	for (i = 0; g_get_monotonic_time () < client->end_at; i++) {
+		gint64 start = g_get_monotonic_time ();
+		gint64 latency;
+
+		if (!_client_call (client, bus, i))
+			client->errors++;
+		latency = g_get_monotonic_time () - start;
+		g_array_append_val (client->latencies, latency);
+	}
+
+	return NULL;
+}
+
+static int
+_cmp_gint64 (gconstpointer a, gconstpointer b)
+{
+	gint64 va = *((const gint64 *) a);
+	gint64 vb = *((const gint64 *) b);
+
+	return va < vb ? -1 : (va > vb ? 1 : 0);
+}
+
+static gint64
+_percentile (GArray *sorted, guint permille)
+{
+	if (!sorted->len)
+		return 0;
+	return g_array_index (sorted, gint64, MIN ((guint64) sorted->len * permille / 1000, sorted->len - 1));
+}
+
+static void
+_run_op (Op op, const char *address, char **paths, guint32 pid)
+{
+	gs_unref_array GArray *all = NULL;
+	Client *clients;
+	GThread **threads;
+	gint64 start, elapsed, cpu_start, cpu_end;
+	guint errors = 0;
+	int i;
+
+	clients = g_new0 (Client, opt_clients);
+	threads = g_new0 (GThread *, opt_clients);
+
+	cpu_start = _daemon_cpu_us (pid);
+	start = g_get_monotonic_time ();
+
+	for (i = 0; i < opt_clients; i++) {
+		clients[i].op = op;
+		clients[i].address = (char *) address;
+		clients[i].paths = paths;
+		clients[i].n_paths = g_strv_length (paths);
+		clients[i].activate_path = opt_activate_connection;
+		clients[i].end_at = start + (gint64) opt_duration * G_USEC_PER_SEC;
+		clients[i].offset = i;
+		clients[i].latencies = g_array_new (FALSE, FALSE, sizeof (gint64));
+		threads[i] = g_thread_new (op_names[op], _client_thread, &clients[i]);
+	}
+
+	all = g_array_new (FALSE, FALSE, sizeof (gint64));
+	for (i = 0; i < opt_clients; i++) {
+		g_thread_join (threads[i]);
+		g_array_append_vals (all, clients[i].latencies->data, clients[i].latencies->len);
+		errors += clients[i].errors;
+		g_array_unref (clients[i].latencies);
+	}
+
+	elapsed = g_get_monotonic_time () - start;
+	cpu_end = _daemon_cpu_us (pid);
+
+	g_array_sort (all, _cmp_gint64);
+
+	g_print ("bench\tdbus\t%s\t%d\t%u\t%u\t%.0f\t%"G_GINT64_FORMAT"\t%"G_GINT64_FORMAT"\t%"G_GINT64_FORMAT"\t%"G_GINT64_FORMAT"\t%.1f\n",
+	         op_names[op],
+	         opt_clients,
+	         all->len,
+	         errors,
+	         (double) all->len * G_USEC_PER_SEC / MAX (elapsed, 1),
+	         _percentile (all, 500),
+	         _percentile (all, 990),
+	         _percentile (all, 999),
+	         all->len ? g_array_index (all, gint64, all->len - 1) : 0,
+	         cpu_start >= 0 && cpu_end >= 0
+	             ? (double) (cpu_end - cpu_start) / MAX (all->len, 1u)
+	             : -1.0);
+
+	g_free (threads);
+	g_free (clients);
+}
+
+/*****************************************************************************/
+
+int
+main (int argc, char **argv)
+{
+	gs_unref_object GDBusConnection *bus = NULL;
+	gs_free_error GError *error = NULL;
+	gs_free char *address = NULL;
+	gs_strfreev char **devices = NULL;
+	gs_strfreev char **connections = NULL;
+	gs_strfreev char **ops = NULL;
+	GOptionContext *context;
+	guint32 pid;
+	Op op;
+	int i;
+
+	context = g_option_context_new ("- generate D-Bus load on NetworkManager");
+	g_option_context_add_main_entries (context, entries, NULL);
+	if (!g_option_context_parse (context, &argc, &argv, &error)) {
+		g_printerr ("%s\n", error->message);
+		return EXIT_FAILURE;
+	}
+	g_option_context_free (context);
+
+	if (opt_clients < 1 || opt_duration < 1) {
+		g_printerr ("--clients and --duration must be positive\n");
+		return EXIT_FAILURE;
+	}
+
+	ops = g_strsplit (opt_ops ?: "get-devices,get-property,get-properties,get-settings", ",", -1);
+
+	address = g_dbus_address_get_for_bus_sync (G_BUS_TYPE_SYSTEM, NULL, &error);
+	if (!address) {
+		g_printerr ("cannot get the system bus address: %s\n", error->message);
+		return EXIT_FAILURE;
+	}
+
+	bus = g_bus_get_sync (G_BUS_TYPE_SYSTEM, NULL, &error);
+	if (!bus) {
+		g_printerr ("cannot connect to the system bus: %s\n", error->message);
+		return EXIT_FAILURE;
+	}
+
+	pid = _daemon_pid (bus);
+	devices = _get_paths (bus, NM_DBUS_PATH, NM_DBUS_INTERFACE, "GetDevices");
+	connections = _get_paths (bus, NM_DBUS_PATH_SETTINGS, NM_DBUS_INTERFACE_SETTINGS, "ListConnections");
+	if (!devices || !connections)
+		return EXIT_FAILURE;
+
+	for (i = 0; ops[i]; i++) {
+		for (op = 0; op < _OP_NUM; op++) {
+			if (nm_streq (ops[i], op_names[op]))
+				break;
+		}
+		if (op == _OP_NUM) {
+			g_printerr ("unknown operation \"%s\"\n", ops[i]);
+			return EXIT_FAILURE;
+		}
+
+		if (op == OP_ACTIVATE && !opt_activate_connection) {
+			g_printerr ("\"activate\" requires --activate-connection\n");
+			return EXIT_FAILURE;
+		}
+		if (op == OP_GET_PROPERTIES && !devices[0]) {
+			g_printerr ("skip \"%s\": no devices\n", ops[i]);
+			continue;
+		}
+		if (op == OP_GET_SETTINGS && !connections[0]) {
+			g_printerr ("skip \"%s\": no connections\n", ops[i]);
+			continue;
+		}
+
+		_run_op (op, address,
+		         op == OP_GET_SETTINGS ? connections : devices,
+		         pid);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -381,9 +381,12 @@ nmt_newt_listbox_build_component (NmtNewtComponent *component,
 	co = newtListbox (-1, -1, priv->height, convert_flags (priv->flags));
 	newtComponentAddCallback (co, selection_changed_callback, component);
 
-	for (i = 0; i < priv->entries->len; i++) {
-		newtListboxAppendEntry (co, priv->entries->pdata[i], GUINT_TO_POINTER (i));
-		if (active == -1 && priv->keys->pdata[i] == priv->active_key)
+	/* newtListboxAppendEntry() walks the whole list to find its end, which
+	 * is quadratic for long lists. Inserting at the head is not, so add the
+	 * rows backwards. */
+	for (i = priv->entries->len - 1; i >= 0; i--) {
+		newtListboxInsertEntry (co, priv->entries->pdata[i], GUINT_TO_POINTER (i), NULL);
+		if (priv->keys->pdata[i] == priv->active_key && priv->active == -1)
 			active = i;
 	}
 
@@ -58,6 +58,8 @@ typedef struct {
 
 typedef struct {
 	GSList *nmt_devices;
+
+	guint rebuild_id;
 } NmtConnectConnectionListPrivate;
 
 /**
@@ -471,6 +473,8 @@ nmt_connect_connection_list_rebuild (NmtConnectConnectionList *list)
 	NmtConnectDevice *nmtdev;
 	NmtConnectConnection *nmtconn;
 
+	nm_clear_g_source (&priv->rebuild_id);
+
 	g_slist_free_full (priv->nmt_devices, (GDestroyNotify) nmt_connect_device_free);
 	priv->nmt_devices = NULL;
 	nmt_newt_listbox_clear (listbox);
@@ -545,12 +549,26 @@ nmt_connect_connection_list_rebuild (NmtConnectConnectionList *list)
 	g_object_notify (G_OBJECT (listbox), "active-key");
 }
 
+static gboolean
+rebuild_idle_cb (gpointer list)
+{
+	NmtConnectConnectionListPrivate *priv = NMT_CONNECT_CONNECTION_LIST_GET_PRIVATE (list);
+
+	priv->rebuild_id = 0;
+	nmt_connect_connection_list_rebuild (list);
+	return G_SOURCE_REMOVE;
+}
+
 static void
 rebuild_on_property_changed (GObject    *object,
                              GParamSpec *spec,
                              gpointer    list)
 {
-	nmt_connect_connection_list_rebuild (list);
+	NmtConnectConnectionListPrivate *priv = NMT_CONNECT_CONNECTION_LIST_GET_PRIVATE (list);
+
+	/* coalesce bursts of changes into a single rebuild. */
+	if (!priv->rebuild_id)
+		priv->rebuild_id = g_idle_add (rebuild_idle_cb, list);
 }
 
 static void
@@ -575,6 +593,7 @@ nmt_connect_connection_list_finalize (GObject *object)
 {
 	NmtConnectConnectionListPrivate *priv = NMT_CONNECT_CONNECTION_LIST_GET_PRIVATE (object);
 
+	nm_clear_g_source (&priv->rebuild_id);
 	g_slist_free_full (priv->nmt_devices, (GDestroyNotify) nmt_connect_device_free);
 
 	g_signal_handlers_disconnect_by_func (nm_client, G_CALLBACK (rebuild_on_property_changed), object);
@@ -51,6 +51,8 @@ typedef struct {
 	NmtNewtWidget *edit;
 	NmtNewtWidget *delete;
 	NmtNewtWidget *extra;
+
+	guint rebuild_id;
 } NmtEditConnectionListPrivate;
 
 enum {
@@ -135,11 +137,32 @@ sort_by_timestamp (gconstpointer  a,
 
 static void nmt_edit_connection_list_rebuild (NmtEditConnectionList *list);
 
+static gboolean
+rebuild_idle_cb (gpointer list)
+{
+	NmtEditConnectionListPrivate *priv = NMT_EDIT_CONNECTION_LIST_GET_PRIVATE (list);
+
+	priv->rebuild_id = 0;
+	nmt_edit_connection_list_rebuild (list);
+	return G_SOURCE_REMOVE;
+}
+
+/* Changes tend to come in bursts, for example when loading many
+ * connections at once. Rebuild the list only once for all of them. */
+static void
+schedule_rebuild (NmtEditConnectionList *list)
+{
+	NmtEditConnectionListPrivate *priv = NMT_EDIT_CONNECTION_LIST_GET_PRIVATE (list);
+
+	if (!priv->rebuild_id)
+		priv->rebuild_id = g_idle_add (rebuild_idle_cb, list);
+}
+
 static void
 rebuild_on_connection_changed (NMRemoteConnection *connection,
                                gpointer            list)
 {
-	nmt_edit_connection_list_rebuild (list);
+	schedule_rebuild (list);
 }
 
 static void
@@ -170,6 +193,8 @@ nmt_edit_connection_list_rebuild (NmtEditConnectionList *list)
 	NMConnection *conn, *selected_conn;
 	int i, row, selected_row;
 
+	nm_clear_g_source (&priv->rebuild_id);
+
 	selected_row = nmt_newt_listbox_get_active (priv->listbox);
 	selected_conn = nmt_newt_listbox_get_active_key (priv->listbox);
 
@@ -261,7 +286,7 @@ rebuild_on_connections_changed (GObject    *object,
                                 GParamSpec *pspec,
                                 gpointer    list)
 {
-	nmt_edit_connection_list_rebuild (list);
+	schedule_rebuild (list);
 }
 
 static void
@@ -351,6 +376,9 @@ nmt_edit_connection_list_finalize (GObject *object)
 {
 	NmtEditConnectionListPrivate *priv = NMT_EDIT_CONNECTION_LIST_GET_PRIVATE (object);
 
+	nm_clear_g_source (&priv->rebuild_id);
+	g_signal_handlers_disconnect_by_func (nm_client, G_CALLBACK (rebuild_on_connections_changed), object);
+
 	free_connections (NMT_EDIT_CONNECTION_LIST (object));
 	g_clear_object (&priv->extra);
 
@@ -34,6 +34,7 @@
 
 #include "nmt-newt.h"
 #include "nm-editor-bindings.h"
+#include "nm-vpn-helpers.h"
 
 #include "nmtui.h"
 #include "nmtui-edit.h"
@@ -256,6 +257,7 @@ main (int argc, char **argv)
 		g_printerr ("%s\n", _("NetworkManager is not running."));
 		exit (1);
 	}
+	nm_vpn_helpers_set_client (nm_client);
 
 	if (sleep_on_startup)
 		sleep (5);
@@ -116,6 +116,7 @@ typedef struct {
 	gboolean dispatched;
 	guint watch_id;
 	guint timeout_id;
+	gint64 start_time;
 } ScriptInfo;
 
 struct Request {
@@ -128,6 +129,7 @@ struct Request {
 	char *iface;
 	char **envp;
 	gboolean debug;
+	gint64 start_time;
 
 	GPtrArray *scripts;  /* list of ScriptInfo */
 	guint idx;
@@ -303,7 +305,9 @@ complete_request (Request *request)
 	ret = g_variant_new ("(a(sus))", &results);
 	g_dbus_method_invocation_return_value (request->context, ret);
 
-	_LOG_R_D (request, "completed (%u scripts)", request->scripts->len);
+	_LOG_R_D (request, "completed (%u scripts) in %"G_GINT64_FORMAT" ms",
+	          request->scripts->len,
+	          (g_get_monotonic_time () - request->start_time) / 1000);
 
 	if (handler->current_request == request)
 		handler->current_request = NULL;
@@ -325,51 +329,29 @@ complete_script (ScriptInfo *script)
 	gboolean wait = script->wait;
 
 	request = script->request;
+	handler = request->handler;
 
-	if (wait) {
-		/* for "wait" scripts, try to schedule the next blocking script.
-		 * If that is successful, return (as we must wait for its completion). */
-		if (dispatch_one_script (request))
-			return;
+	if (!wait) {
+		/* this was a "no-wait" script. They don't block other scripts,
+		 * so there is nothing to schedule. Just try to complete the
+		 * request. */
+		complete_request (request);
+		return;
 	}
 
-	handler = request->handler;
-
-	nm_assert (!wait || handler->current_request == request);
+	/* for "wait" scripts, try to schedule the next blocking script.
+	 * If that is successful, return (as we must wait for its completion). */
+	if (dispatch_one_script (request))
+		return;
 
-	/* Try to complete the request. @request will be possibly free'd,
-	 * making @script and @request a dangling pointer. */
+	/* we just completed the last "wait" script of @request. It no longer
+	 * blocks the following requests, even if some of its "no-wait" scripts
+	 * are still running. Try to complete it, @request will be possibly
+	 * free'd, making @script and @request a dangling pointer. */
+	nm_assert (handler->current_request == request);
+	handler->current_request = NULL;
 	complete_request (request);
 
-	if (!wait) {
-		/* this was a "no-wait" script. We either completed the request,
-		 * or there is nothing to do. Especially, there is no need to
-		 * queue the next_request() -- because no-wait scripts don't block
-		 * requests. However, if this was the last "no-wait" script and
-		 * there are "wait" scripts ready to run, launch them.
-		 */
-		if (   handler->current_request == request
-		    && handler->current_request->num_scripts_nowait == 0) {
-
-			if (dispatch_one_script (handler->current_request))
-				return;
-
-			complete_request (handler->current_request);
-		} else
-			return;
-	} else {
-		/* if the script is a "wait" script, we already tried above to
-		 * dispatch the next script. As we didn't do that, it means we
-		 * just completed the last script of @request and we can continue
-		 * with the next request...
-		 *
-		 * Also, it cannot be that there is another request currently being
-		 * processed because only requests with "wait" scripts can become
-		 * @current_request. As there can only be one "wait" script running
-		 * at any time, it means complete_request() above completed @request. */
-		nm_assert (!handler->current_request);
-	}
-
 	while (next_request (handler, NULL)) {
 		request = handler->current_request;
 
@@ -378,6 +360,7 @@ complete_script (ScriptInfo *script)
 
 		/* Try to complete the request. It will be either completed
 		 * now, or when all pending "no-wait" scripts return. */
+		handler->current_request = NULL;
 		complete_request (request);
 
 		/* We can immediately start next_request(), because our current
@@ -420,7 +403,8 @@ script_watch_cb (GPid pid, gint status, gpointer user_data)
 	}
 
 	if (script->result == DISPATCH_RESULT_SUCCESS) {
-		_LOG_S_D (script, "complete");
+		_LOG_S_D (script, "complete (%"G_GINT64_FORMAT" ms)",
+		          (g_get_monotonic_time () - script->start_time) / 1000);
 	} else {
 		script->result = DISPATCH_RESULT_FAILED;
 		_LOG_S_W (script, "complete: failed with %s", script->error);
@@ -545,6 +529,8 @@ script_dispatch (ScriptInfo *script)
 
 	_LOG_S_D (script, "run script%s", script->wait ? "" : " (no-wait)");
 
+	script->start_time = g_get_monotonic_time ();
+
 	if (g_spawn_async ("/", argv, request->envp, G_SPAWN_DO_NOT_REAP_CHILD, NULL, NULL, &script->pid, &error)) {
 		script->watch_id = g_child_watch_add (script->pid, (GChildWatchFunc) script_watch_cb, script);
 		script->timeout_id = g_timeout_add_seconds (SCRIPT_TIMEOUT, script_timeout_cb, script);
@@ -561,12 +547,20 @@ script_dispatch (ScriptInfo *script)
 	}
 }
 
+/**
+ * dispatch_one_script:
+ * @request: the request
+ *
+ * Starts the next "wait" script of @request. The "no-wait" scripts
+ * were already started by handle_action() and don't block the ordered
+ * scripts.
+ *
+ * Returns: %TRUE, if a script was started and we must wait for its
+ * completion.
+ */
 static gboolean
 dispatch_one_script (Request *request)
 {
-	if (request->num_scripts_nowait > 0)
-		return TRUE;
-
 	while (request->idx < request->scripts->len) {
 		ScriptInfo *script;
 
@@ -577,34 +571,166 @@ dispatch_one_script (Request *request)
 	return FALSE;
 }
 
-static GSList *
-find_scripts (const char *str_action)
+static gboolean
+script_must_wait (const char *path)
+{
+	gs_free char *link = NULL;
+	gs_free char *dir = NULL;
+	gs_free char *real = NULL;
+	char *tmp;
+
+	link = g_file_read_link (path, NULL);
+	if (link) {
+		if (!g_path_is_absolute (link)) {
+			dir = g_path_get_dirname (path);
+			tmp = g_build_path ("/", dir, link, NULL);
+			g_free (link);
+			g_free (dir);
+			link = tmp;
+		}
+
+		dir = g_path_get_dirname (link);
+		real = realpath (dir, NULL);
+
+		if (real && !strcmp (real, NMD_SCRIPT_DIR_NO_WAIT))
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+/*****************************************************************************/
+
+typedef struct {
+	char *path;
+	gboolean wait;
+
+	/* the target of a symlink is not watched by the monitor of the
+	 * directory, so its times tell whether it changed. */
+	bool is_link:1;
+	struct timespec target_mtime;
+	struct timespec target_ctime;
+} ScriptEntry;
+
+typedef struct {
+	const char *dirname;
+
+	/* the valid scripts of the directory, sorted by path. This is only
+	 * cached while @monitor watches the directory for changes. */
+	GPtrArray *scripts;
+	GFileMonitor *monitor;
+} ScriptDir;
+
+static ScriptDir script_dirs[] = {
+	{ .dirname = NMD_SCRIPT_DIR_DEFAULT, },
+	{ .dirname = NMD_SCRIPT_DIR_PRE_UP, },
+	{ .dirname = NMD_SCRIPT_DIR_PRE_DOWN, },
+};
+
+/* the scripts of the other directories may be symlinks into the no-wait
+ * directory. Its changes invalidate all lists. */
+static GFileMonitor *no_wait_monitor;
+
+static void
+script_entry_free (gpointer ptr)
+{
+	ScriptEntry *entry = ptr;
+
+	g_free (entry->path);
+	g_slice_free (ScriptEntry, entry);
+}
+
+static int
+script_entry_cmp (gconstpointer a, gconstpointer b)
+{
+	const ScriptEntry *entry_a = *((const ScriptEntry **) a);
+	const ScriptEntry *entry_b = *((const ScriptEntry **) b);
+
+	return strcmp (entry_a->path, entry_b->path);
+}
+
+static void
+script_dir_changed (GFileMonitor *monitor,
+                    GFile *file,
+                    GFile *other_file,
+                    GFileMonitorEvent event_type,
+                    gpointer user_data)
+{
+	ScriptDir *script_dir = user_data;
+
+	/* any change in the directory, including the permissions of the scripts
+	 * and symlinks into the no-wait directory, invalidates the list. */
+	g_clear_pointer (&script_dir->scripts, g_ptr_array_unref);
+}
+
+static void
+script_dir_no_wait_changed (GFileMonitor *monitor,
+                            GFile *file,
+                            GFile *other_file,
+                            GFileMonitorEvent event_type,
+                            gpointer user_data)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (script_dirs); i++)
+		g_clear_pointer (&script_dirs[i].scripts, g_ptr_array_unref);
+}
+
+static gboolean
+script_dir_links_changed (GPtrArray *scripts)
+{
+	struct stat st;
+	guint i;
+
+	for (i = 0; i < scripts->len; i++) {
+		const ScriptEntry *entry = scripts->pdata[i];
+
+		if (!entry->is_link)
+			continue;
+		if (   stat (entry->path, &st) != 0
+		    || st.st_mtim.tv_sec != entry->target_mtime.tv_sec
+		    || st.st_mtim.tv_nsec != entry->target_mtime.tv_nsec
+		    || st.st_ctim.tv_sec != entry->target_ctime.tv_sec
+		    || st.st_ctim.tv_nsec != entry->target_ctime.tv_nsec)
+			return TRUE;
+	}
+	return FALSE;
+}
+
+static GFileMonitor *
+script_dir_monitor_new (const char *dirname, GCallback callback, gpointer user_data)
+{
+	gs_unref_object GFile *file = NULL;
+	GFileMonitor *monitor;
+
+	file = g_file_new_for_path (dirname);
+	monitor = g_file_monitor_directory (file, G_FILE_MONITOR_NONE, NULL, NULL);
+	if (monitor)
+		g_signal_connect (monitor, "changed", callback, user_data);
+	return monitor;
+}
+
+static GPtrArray *
+script_dir_scan (const char *dirname)
 {
 	GDir *dir;
 	const char *filename;
-	GSList *sorted = NULL;
+	GPtrArray *scripts;
 	GError *error = NULL;
-	const char *dirname;
 
-	if (   strcmp (str_action, NMD_ACTION_PRE_UP) == 0
-	    || strcmp (str_action, NMD_ACTION_VPN_PRE_UP) == 0)
-		dirname = NMD_SCRIPT_DIR_PRE_UP;
-	else if (   strcmp (str_action, NMD_ACTION_PRE_DOWN) == 0
-	         || strcmp (str_action, NMD_ACTION_VPN_PRE_DOWN) == 0)
-		dirname = NMD_SCRIPT_DIR_PRE_DOWN;
-	else
-		dirname = NMD_SCRIPT_DIR_DEFAULT;
+	scripts = g_ptr_array_new_with_free_func (script_entry_free);
 
 	if (!(dir = g_dir_open (dirname, 0, &error))) {
 		g_message ("find-scripts: Failed to open dispatcher directory '%s': %s",
 		           dirname, error->message);
 		g_error_free (error);
-		return NULL;
+		return scripts;
 	}
 
 	while ((filename = g_dir_read_name (dir))) {
 		char *path;
 		struct stat	st;
+		struct stat	lst;
 		int err;
 		const char *err_msg = NULL;
 
@@ -622,42 +748,96 @@ find_scripts (const char *str_action)
 			g_warning ("find-scripts: Cannot execute '%s': %s", path, err_msg);
 		else {
 			/* success */
-			sorted = g_slist_insert_sorted (sorted, path, (GCompareFunc) g_strcmp0);
+			ScriptEntry *entry;
+
+			entry = g_slice_new (ScriptEntry);
+			entry->path = path;
+			entry->wait = script_must_wait (path);
+			entry->is_link = lstat (path, &lst) == 0 && S_ISLNK (lst.st_mode);
+			entry->target_mtime = st.st_mtim;
+			entry->target_ctime = st.st_ctim;
+			g_ptr_array_add (scripts, entry);
 			path = NULL;
 		}
 		g_free (path);
 	}
 	g_dir_close (dir);
 
-	return sorted;
+	g_ptr_array_sort (scripts, script_entry_cmp);
+	return scripts;
 }
 
-static gboolean
-script_must_wait (const char *path)
+/**
+ * find_scripts:
+ * @str_action: the dispatcher action
+ *
+ * Returns: (transfer full): the scripts to run for @str_action, as
+ * #ScriptEntry sorted by path. The directory listing is cached and
+ * invalidated by file monitors on the directory and on the no-wait
+ * directory, or when the target of a symlink changed, so that frequent
+ * events don't rescan the directory each time.
+ */
+static GPtrArray *
+find_scripts (const char *str_action)
 {
-	gs_free char *link = NULL;
-	gs_free char *dir = NULL;
-	gs_free char *real = NULL;
-	char *tmp;
+	ScriptDir *script_dir;
 
-	link = g_file_read_link (path, NULL);
-	if (link) {
-		if (!g_path_is_absolute (link)) {
-			dir = g_path_get_dirname (path);
-			tmp = g_build_path ("/", dir, link, NULL);
-			g_free (link);
-			g_free (dir);
-			link = tmp;
-		}
+	if (   strcmp (str_action, NMD_ACTION_PRE_UP) == 0
+	    || strcmp (str_action, NMD_ACTION_VPN_PRE_UP) == 0)
+		script_dir = &script_dirs[1];
+	else if (   strcmp (str_action, NMD_ACTION_PRE_DOWN) == 0
+	         || strcmp (str_action, NMD_ACTION_VPN_PRE_DOWN) == 0)
+		script_dir = &script_dirs[2];
+	else
+		script_dir = &script_dirs[0];
 
-		dir = g_path_get_dirname (link);
-		real = realpath (dir, NULL);
+	if (script_dir->scripts) {
+		if (!script_dir_links_changed (script_dir->scripts))
+			return g_ptr_array_ref (script_dir->scripts);
+		g_clear_pointer (&script_dir->scripts, g_ptr_array_unref);
+	}
 
-		if (real && !strcmp (real, NMD_SCRIPT_DIR_NO_WAIT))
-			return FALSE;
+	if (!no_wait_monitor) {
+		no_wait_monitor = script_dir_monitor_new (NMD_SCRIPT_DIR_NO_WAIT,
+		                                          G_CALLBACK (script_dir_no_wait_changed),
+		                                          NULL);
+	}
+	if (!script_dir->monitor) {
+		script_dir->monitor = script_dir_monitor_new (script_dir->dirname,
+		                                              G_CALLBACK (script_dir_changed),
+		                                              script_dir);
 	}
 
-	return TRUE;
+	/* the monitors must be set up before scanning, so that we don't miss
+	 * changes in between. Without monitors, scan each time. */
+	if (!script_dir->monitor || !no_wait_monitor)
+		return script_dir_scan (script_dir->dirname);
+
+	script_dir->scripts = script_dir_scan (script_dir->dirname);
+	return g_ptr_array_ref (script_dir->scripts);
+}
+
+static void
+script_dirs_clear (void)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (script_dirs); i++) {
+		ScriptDir *script_dir = &script_dirs[i];
+
+		g_clear_pointer (&script_dir->scripts, g_ptr_array_unref);
+		if (script_dir->monitor) {
+			g_signal_handlers_disconnect_by_data (script_dir->monitor, script_dir);
+			g_file_monitor_cancel (script_dir->monitor);
+			g_clear_object (&script_dir->monitor);
+		}
+	}
+
+	if (no_wait_monitor) {
+		g_signal_handlers_disconnect_by_func (no_wait_monitor, script_dir_no_wait_changed, NULL);
+		g_file_monitor_cancel (no_wait_monitor);
+		g_clear_object (&no_wait_monitor);
+	}
 }
 
 static gboolean
@@ -681,8 +861,7 @@ handle_action (NMDBusDispatcher *dbus_dispatcher,
                gpointer user_data)
 {
 	Handler *h = user_data;
-	GSList *sorted_scripts = NULL;
-	GSList *iter;
+	gs_unref_ptrarray GPtrArray *sorted_scripts = NULL;
 	Request *request;
 	char **p;
 	guint i, num_nowait = 0;
@@ -692,6 +871,7 @@ handle_action (NMDBusDispatcher *dbus_dispatcher,
 
 	request = g_slice_new0 (Request);
 	request->request_id = ++request_id_counter;
+	request->start_time = g_get_monotonic_time ();
 	request->handler = h;
 	request->debug = request_debug || debug;
 	request->context = context;
@@ -714,17 +894,17 @@ handle_action (NMDBusDispatcher *dbus_dispatcher,
 	                                                    &request->iface,
 	                                                    &error_message);
 
-	request->scripts = g_ptr_array_new_full (5, script_info_free);
-	for (iter = sorted_scripts; iter; iter = g_slist_next (iter)) {
+	request->scripts = g_ptr_array_new_full (sorted_scripts->len, script_info_free);
+	for (i = 0; i < sorted_scripts->len; i++) {
+		const ScriptEntry *entry = g_ptr_array_index (sorted_scripts, i);
 		ScriptInfo *s;
 
 		s = g_slice_new0 (ScriptInfo);
 		s->request = request;
-		s->script = iter->data;
-		s->wait = script_must_wait (s->script);
+		s->script = g_strdup (entry->path);
+		s->wait = entry->wait;
 		g_ptr_array_add (request->scripts, s);
 	}
-	g_slist_free (sorted_scripts);
 
 	_LOG_R_I (request, "new request (%u scripts)", request->scripts->len);
 	if (   _LOG_R_D_enabled (request)
@@ -969,6 +1149,8 @@ main (int argc, char **argv)
 	g_queue_free (handler->requests_waiting);
 	g_object_unref (handler);
 
+	script_dirs_clear ();
+
 	if (!debug)
 		logging_shutdown ();
 
@@ -27,6 +27,7 @@
 #include <strings.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <sys/stat.h>
 
 #include "crypto.h"
 #include "nm-errors.h"
@@ -319,6 +320,128 @@ file_to_g_byte_array (const char *filename, GError **error)
 	return array;
 }
 
+/*****************************************************************************/
+
+/* Verifying certificates and keys means parsing them, which is costly for
+ * large CA bundles, and the same files get verified over and over again, for
+ * example each time a connection is verified. Remember the outcome per file,
+ * as long as the file doesn't change.
+ *
+ * Only checks that don't involve a password are cached. A cached result
+ * must never let a wrong password pass. */
+
+#define VERIFY_CACHE_MAX 64
+
+typedef enum {
+	VERIFY_CACHE_CERT,
+	VERIFY_CACHE_PKCS12,
+	VERIFY_CACHE_KEY,
+} VerifyCacheKind;
+
+typedef struct {
+	dev_t dev;
+	ino_t ino;
+	off_t size;
+	gint64 mtime_nsec;
+	int result;
+	bool is_encrypted;
+	GError *error;
+} VerifyCacheEntry;
+
+static struct {
+	GMutex lock;
+	GHashTable *entries;
+} verify_cache;
+
+static void
+_verify_cache_entry_free (gpointer data)
+{
+	VerifyCacheEntry *entry = data;
+
+	if (entry->error)
+		g_error_free (entry->error);
+	g_slice_free (VerifyCacheEntry, entry);
+}
+
+static char *
+_verify_cache_key (VerifyCacheKind kind, const char *filename)
+{
+	return g_strdup_printf ("%d:%s", (int) kind, filename);
+}
+
+static gboolean
+_verify_cache_stat (const char *filename, struct stat *st)
+{
+	return    stat (filename, st) == 0
+	       && S_ISREG (st->st_mode);
+}
+
+static gboolean
+_verify_cache_lookup (VerifyCacheKind kind,
+                      const char *filename,
+                      const struct stat *st,
+                      int *out_result,
+                      gboolean *out_is_encrypted,
+                      GError **error)
+{
+	gs_free char *key = NULL;
+	const VerifyCacheEntry *entry;
+	gboolean found = FALSE;
+
+	key = _verify_cache_key (kind, filename);
+
+	g_mutex_lock (&verify_cache.lock);
+	entry = verify_cache.entries ? g_hash_table_lookup (verify_cache.entries, key) : NULL;
+	if (   entry
+	    && entry->dev == st->st_dev
+	    && entry->ino == st->st_ino
+	    && entry->size == st->st_size
+	    && entry->mtime_nsec == (gint64) st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec) {
+		*out_result = entry->result;
+		if (out_is_encrypted)
+			*out_is_encrypted = entry->is_encrypted;
+		if (entry->error)
+			g_propagate_error (error, g_error_copy (entry->error));
+		found = TRUE;
+	}
+	g_mutex_unlock (&verify_cache.lock);
+	return found;
+}
+
+static void
+_verify_cache_add (VerifyCacheKind kind,
+                   const char *filename,
+                   const struct stat *st,
+                   int result,
+                   gboolean is_encrypted,
+                   const GError *error)
+{
+	VerifyCacheEntry *entry;
+
+	entry = g_slice_new0 (VerifyCacheEntry);
+	entry->dev = st->st_dev;
+	entry->ino = st->st_ino;
+	entry->size = st->st_size;
+	entry->mtime_nsec = (gint64) st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+	entry->result = result;
+	entry->is_encrypted = is_encrypted;
+	entry->error = error ? g_error_copy (error) : NULL;
+
+	g_mutex_lock (&verify_cache.lock);
+	if (!verify_cache.entries) {
+		verify_cache.entries = g_hash_table_new_full (g_str_hash, g_str_equal,
+		                                              g_free, _verify_cache_entry_free);
+	} else if (g_hash_table_size (verify_cache.entries) >= VERIFY_CACHE_MAX) {
+		/* a process doesn't deal with that many files normally. Just
+		 * start over. */
+		g_hash_table_remove_all (verify_cache.entries);
+	}
+	g_hash_table_insert (verify_cache.entries, _verify_cache_key (kind, filename), entry);
+	g_mutex_unlock (&verify_cache.lock);
+}
+
+/*****************************************************************************/
+
 /*
  * Convert a hex string into bytes.
  */
@@ -593,6 +716,10 @@ crypto_load_and_verify_certificate (const char *file,
                                     GError **error)
 {
 	GByteArray *array, *contents;
+	struct stat st;
+	gboolean st_valid;
+	int cached;
+	GError *local = NULL;
 
 	g_return_val_if_fail (file != NULL, NULL);
 	g_return_val_if_fail (out_file_format != NULL, NULL);
@@ -601,6 +728,17 @@ crypto_load_and_verify_certificate (const char *file,
 	if (!crypto_init (error))
 		return NULL;
 
+	st_valid = _verify_cache_stat (file, &st);
+	if (   st_valid
+	    && _verify_cache_lookup (VERIFY_CACHE_CERT, file, &st, &cached, NULL, error)) {
+		if (cached == NM_CRYPTO_FILE_FORMAT_UNKNOWN)
+			return NULL;
+		contents = file_to_g_byte_array (file, error);
+		if (contents)
+			*out_file_format = cached;
+		return contents;
+	}
+
 	contents = file_to_g_byte_array (file, error);
 	if (!contents)
 		return NULL;
@@ -608,28 +746,32 @@ crypto_load_and_verify_certificate (const char *file,
 	/* Check for PKCS#12 */
 	if (crypto_is_pkcs12_data (contents->data, contents->len, NULL)) {
 		*out_file_format = NM_CRYPTO_FILE_FORMAT_PKCS12;
+		if (st_valid)
+			_verify_cache_add (VERIFY_CACHE_CERT, file, &st, *out_file_format, FALSE, NULL);
 		return contents;
 	}
 
 	/* Check for plain DER format */
 	if (contents->len > 2 && contents->data[0] == 0x30 && contents->data[1] == 0x82) {
-		*out_file_format = crypto_verify_cert (contents->data, contents->len, error);
+		*out_file_format = crypto_verify_cert (contents->data, contents->len, &local);
 	} else {
-		array = extract_pem_cert_data (contents, error);
-		if (!array) {
-			g_byte_array_free (contents, TRUE);
-			return NULL;
+		array = extract_pem_cert_data (contents, &local);
+		if (array) {
+			*out_file_format = crypto_verify_cert (array->data, array->len, &local);
+			g_byte_array_free (array, TRUE);
 		}
-
-		*out_file_format = crypto_verify_cert (array->data, array->len, error);
-		g_byte_array_free (array, TRUE);
 	}
 
 	if (*out_file_format != NM_CRYPTO_FILE_FORMAT_X509) {
+		*out_file_format = NM_CRYPTO_FILE_FORMAT_UNKNOWN;
 		g_byte_array_free (contents, TRUE);
 		contents = NULL;
 	}
 
+	if (st_valid)
+		_verify_cache_add (VERIFY_CACHE_CERT, file, &st, *out_file_format, FALSE, local);
+	if (local)
+		g_propagate_error (error, local);
 	return contents;
 }
 
@@ -668,16 +810,29 @@ crypto_is_pkcs12_file (const char *file, GError **error)
 {
 	GByteArray *contents;
 	gboolean success = FALSE;
+	struct stat st;
+	gboolean st_valid;
+	int cached;
+	GError *local = NULL;
 
 	g_return_val_if_fail (file != NULL, FALSE);
 
 	if (!crypto_init (error))
 		return FALSE;
 
+	st_valid = _verify_cache_stat (file, &st);
+	if (   st_valid
+	    && _verify_cache_lookup (VERIFY_CACHE_PKCS12, file, &st, &cached, NULL, error))
+		return cached;
+
 	contents = file_to_g_byte_array (file, error);
 	if (contents) {
-		success = crypto_is_pkcs12_data (contents->data, contents->len, error);
+		success = crypto_is_pkcs12_data (contents->data, contents->len, &local);
 		g_byte_array_free (contents, TRUE);
+		if (st_valid)
+			_verify_cache_add (VERIFY_CACHE_PKCS12, file, &st, success, FALSE, local);
+		if (local)
+			g_propagate_error (error, local);
 	}
 	return success;
 }
@@ -748,16 +903,36 @@ crypto_verify_private_key (const char *filename,
 {
 	GByteArray *contents;
 	NMCryptoFileFormat format = NM_CRYPTO_FILE_FORMAT_UNKNOWN;
+	struct stat st;
+	gboolean st_valid = FALSE;
+	gboolean is_encrypted = FALSE;
+	int cached;
+	GError *local = NULL;
 
 	g_return_val_if_fail (filename != NULL, NM_CRYPTO_FILE_FORMAT_UNKNOWN);
+	g_return_val_if_fail (out_is_encrypted == NULL || *out_is_encrypted == FALSE, NM_CRYPTO_FILE_FORMAT_UNKNOWN);
 
 	if (!crypto_init (error))
 		return NM_CRYPTO_FILE_FORMAT_UNKNOWN;
 
+	/* with a password, the result depends on more than the file. */
+	if (!password) {
+		st_valid = _verify_cache_stat (filename, &st);
+		if (   st_valid
+		    && _verify_cache_lookup (VERIFY_CACHE_KEY, filename, &st, &cached, out_is_encrypted, error))
+			return cached;
+	}
+
 	contents = file_to_g_byte_array (filename, error);
 	if (contents) {
-		format = crypto_verify_private_key_data (contents->data, contents->len, password, out_is_encrypted, error);
+		format = crypto_verify_private_key_data (contents->data, contents->len, password, &is_encrypted, &local);
 		g_byte_array_free (contents, TRUE);
+		if (st_valid)
+			_verify_cache_add (VERIFY_CACHE_KEY, filename, &st, format, is_encrypted, local);
+		if (out_is_encrypted)
+			*out_is_encrypted = is_encrypted;
+		if (local)
+			g_propagate_error (error, local);
 	}
 	return format;
 }
@@ -33,23 +33,34 @@
 
 #define SALT_LEN 8
 
-static gboolean initialized = FALSE;
+/* crypto_init() is also called from worker threads, for example when
+ * the settings plugins read connections in parallel. */
+static volatile int initialized = FALSE;
+G_LOCK_DEFINE_STATIC (init_lock);
 
 gboolean
 crypto_init (GError **error)
 {
-	if (initialized)
+	if (g_atomic_int_get (&initialized))
 		return TRUE;
 
+	G_LOCK (init_lock);
+	if (initialized) {
+		G_UNLOCK (init_lock);
+		return TRUE;
+	}
+
 	if (gnutls_global_init() != 0) {
 		gnutls_global_deinit();
 		g_set_error_literal (error, NM_CRYPTO_ERROR,
 		                     NM_CRYPTO_ERROR_FAILED,
 		                     _("Failed to initialize the crypto engine."));
+		G_UNLOCK (init_lock);
 		return FALSE;
 	}
 
-	initialized = TRUE;
+	g_atomic_int_set (&initialized, TRUE);
+	G_UNLOCK (init_lock);
 	return TRUE;
 }
 
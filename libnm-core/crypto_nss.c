@@ -36,16 +36,25 @@
 #include "crypto.h"
 #include "nm-errors.h"
 
-static gboolean initialized = FALSE;
+/* crypto_init() is also called from worker threads, for example when
+ * the settings plugins read connections in parallel. */
+static volatile int initialized = FALSE;
+G_LOCK_DEFINE_STATIC (init_lock);
 
 gboolean
 crypto_init (GError **error)
 {
 	SECStatus ret;
 
-	if (initialized)
+	if (g_atomic_int_get (&initialized))
 		return TRUE;
 
+	G_LOCK (init_lock);
+	if (initialized) {
+		G_UNLOCK (init_lock);
+		return TRUE;
+	}
+
 	PR_Init(PR_USER_THREAD, PR_PRIORITY_NORMAL, 1);
 	ret = NSS_NoDB_Init (NULL);
 	if (ret != SECSuccess) {
@@ -54,6 +63,7 @@ crypto_init (GError **error)
 		             _("Failed to initialize the crypto engine: %d."),
 		             PR_GetError ());
 		PR_Cleanup ();
+		G_UNLOCK (init_lock);
 		return FALSE;
 	}
 
@@ -65,7 +75,8 @@ crypto_init (GError **error)
 	SEC_PKCS12EnableCipher(PKCS12_DES_EDE3_168, 1);
 	SEC_PKCS12SetPreferredCipher(PKCS12_DES_EDE3_168, 1);
 
-	initialized = TRUE;
+	g_atomic_int_set (&initialized, TRUE);
+	G_UNLOCK (init_lock);
 	return TRUE;
 }
 
@@ -55,12 +55,26 @@ typedef struct {
 
 	GHashTable *settings;
 
+	/* the same settings as in @settings, by the slot of their type,
+	 * for direct lookups. See _nm_setting_type_get_slot(). */
+	NMSetting *slots[_NM_SETTING_SLOT_MAX];
+
+	/* whether the last _nm_connection_verify() succeeded and no setting
+	 * was added, removed or notified a change since. Only used by
+	 * _nm_connection_verify_cached(). */
+	bool verified:1;
+
 	/* D-Bus path of the connection, if any */
 	char *path;
+
+	/* called once on the next access to the settings, see
+	 * _nm_connection_set_lazy_load(). */
+	NMConnectionLazyLoadFunc lazy_load;
 } NMConnectionPrivate;
 
 static NMConnectionPrivate *nm_connection_get_private (NMConnection *connection);
-#define NM_CONNECTION_GET_PRIVATE(o) (nm_connection_get_private ((NMConnection *)o))
+static NMConnectionPrivate *nm_connection_get_private_loaded (NMConnection *connection);
+#define NM_CONNECTION_GET_PRIVATE(o) (nm_connection_get_private_loaded ((NMConnection *)o))
 
 G_DEFINE_INTERFACE (NMConnection, nm_connection, G_TYPE_OBJECT)
 
@@ -75,17 +89,28 @@ static guint signals[LAST_SIGNAL] = { 0 };
 
 /*****************************************************************************/
 
+static void
+_emit_changed (NMConnection *self)
+{
+	nm_connection_get_private (self)->verified = FALSE;
+	g_signal_emit (self, signals[CHANGED], 0);
+}
+
 static void
 setting_changed_cb (NMSetting *setting,
                     GParamSpec *pspec,
                     NMConnection *self)
 {
-	g_signal_emit (self, signals[CHANGED], 0);
+	_emit_changed (self);
 }
 
 static gboolean
 _setting_release (gpointer key, gpointer value, gpointer user_data)
 {
+	NMConnectionPrivate *priv = nm_connection_get_private (user_data);
+
+	priv->slots[_nm_setting_get_slot (value)] = NULL;
+	priv->verified = FALSE;
 	g_signal_handlers_disconnect_by_func (user_data, setting_changed_cb, value);
 	return TRUE;
 }
@@ -100,6 +125,8 @@ _nm_connection_add_setting (NMConnection *connection, NMSetting *setting)
 	if ((s_old = g_hash_table_lookup (priv->settings, (gpointer) name)))
 		g_signal_handlers_disconnect_by_func (s_old, setting_changed_cb, connection);
 	g_hash_table_insert (priv->settings, (gpointer) name, setting);
+	priv->slots[_nm_setting_get_slot (setting)] = setting;
+	priv->verified = FALSE;
 	/* Listen for property changes so we can emit the 'changed' signal */
 	g_signal_connect (setting, "notify", (GCallback) setting_changed_cb, connection);
 }
@@ -121,7 +148,7 @@ nm_connection_add_setting (NMConnection *connection, NMSetting *setting)
 	g_return_if_fail (NM_IS_SETTING (setting));
 
 	_nm_connection_add_setting (connection, setting);
-	g_signal_emit (connection, signals[CHANGED], 0);
+	_emit_changed (connection);
 }
 
 gboolean
@@ -139,8 +166,10 @@ _nm_connection_remove_setting (NMConnection *connection, GType setting_type)
 	setting = g_hash_table_lookup (priv->settings, setting_name);
 	if (setting) {
 		g_signal_handlers_disconnect_by_func (setting, setting_changed_cb, connection);
+		priv->slots[_nm_setting_get_slot (setting)] = NULL;
+		priv->verified = FALSE;
 		g_hash_table_remove (priv->settings, setting_name);
-		g_signal_emit (connection, signals[CHANGED], 0);
+		_emit_changed (connection);
 		return TRUE;
 	}
 	return FALSE;
@@ -174,11 +203,15 @@ nm_connection_remove_setting (NMConnection *connection, GType setting_type)
 NMSetting *
 nm_connection_get_setting (NMConnection *connection, GType setting_type)
 {
+	int slot;
+
 	g_return_val_if_fail (NM_IS_CONNECTION (connection), NULL);
 	g_return_val_if_fail (g_type_is_a (setting_type, NM_TYPE_SETTING), NULL);
 
-	return (NMSetting *) g_hash_table_lookup (NM_CONNECTION_GET_PRIVATE (connection)->settings,
-	                                          g_type_name (setting_type));
+	slot = _nm_setting_type_get_slot (setting_type);
+	if (slot < 0)
+		return NULL;
+	return NM_CONNECTION_GET_PRIVATE (connection)->slots[slot];
 }
 
 /**
@@ -360,7 +393,7 @@ _nm_connection_replace_settings (NMConnection *connection,
 		success = TRUE;
 
 	if (changed)
-		g_signal_emit (connection, signals[CHANGED], 0);
+		_emit_changed (connection);
 	return success;
 }
 
@@ -429,7 +462,7 @@ nm_connection_replace_settings_from_connection (NMConnection *connection,
 	}
 
 	if (changed)
-		g_signal_emit (connection, signals[CHANGED], 0);
+		_emit_changed (connection);
 }
 
 /**
@@ -449,7 +482,7 @@ nm_connection_clear_settings (NMConnection *connection)
 
 	if (g_hash_table_size (priv->settings) > 0) {
 		g_hash_table_foreach_remove (priv->settings, _setting_release, connection);
-		g_signal_emit (connection, signals[CHANGED], 0);
+		_emit_changed (connection);
 	}
 }
 
@@ -1071,6 +1104,8 @@ _nm_connection_verify (NMConnection *connection, GError **error)
 
 	priv = NM_CONNECTION_GET_PRIVATE (connection);
 
+	priv->verified = FALSE;
+
 	/* First, make sure there's at least 'connection' setting */
 	s_con = nm_connection_get_setting_connection (connection);
 	if (!s_con) {
@@ -1178,9 +1213,26 @@ _nm_connection_verify (NMConnection *connection, GError **error)
 		return normalizable_error_type;
 	}
 
+	priv->verified = TRUE;
 	return NM_SETTING_VERIFY_SUCCESS;
 }
 
+/* Like _nm_connection_verify(), but returns success right away if the last
+ * verification succeeded and no setting was added, removed or notified a
+ * change since. Changes that don't notify the setting, like modifying
+ * an NMIPAddress of the setting in place or changes while notifications
+ * are frozen, are not seen. Only use it for connections that are not
+ * modified that way, like the ones owned by the settings of the daemon. */
+NMSettingVerifyResult
+_nm_connection_verify_cached (NMConnection *connection, GError **error)
+{
+	g_return_val_if_fail (NM_IS_CONNECTION (connection), NM_SETTING_VERIFY_ERROR);
+
+	if (NM_CONNECTION_GET_PRIVATE (connection)->verified)
+		return NM_SETTING_VERIFY_SUCCESS;
+	return _nm_connection_verify (connection, error);
+}
+
 /**
  * nm_connection_verify_secrets:
  * @connection: the #NMConnection to verify in
@@ -1419,7 +1471,7 @@ nm_connection_update_secrets (NMConnection *connection,
 
 	if (updated) {
 		g_signal_emit (connection, signals[SECRETS_UPDATED], 0, setting_name);
-		g_signal_emit (connection, signals[CHANGED], 0);
+		_emit_changed (connection);
 	}
 
 	return success;
@@ -1511,7 +1563,7 @@ nm_connection_clear_secrets (NMConnection *connection)
 
 	g_signal_emit (connection, signals[SECRETS_CLEARED], 0);
 	if (changed)
-		g_signal_emit (connection, signals[CHANGED], 0);
+		_emit_changed (connection);
 }
 
 /**
@@ -1543,7 +1595,7 @@ nm_connection_clear_secrets_with_flags (NMConnection *connection,
 
 	g_signal_emit (connection, signals[SECRETS_CLEARED], 0);
 	if (changed)
-		g_signal_emit (connection, signals[CHANGED], 0);
+		_emit_changed (connection);
 }
 
 /**
@@ -1730,7 +1782,7 @@ nm_connection_set_path (NMConnection *connection, const char *path)
 
 	g_return_if_fail (NM_IS_CONNECTION (connection));
 
-	priv = NM_CONNECTION_GET_PRIVATE (connection);
+	priv = nm_connection_get_private (connection);
 
 	g_free (priv->path);
 	priv->path = NULL;
@@ -1753,7 +1805,7 @@ nm_connection_get_path (NMConnection *connection)
 {
 	g_return_val_if_fail (NM_IS_CONNECTION (connection), NULL);
 
-	return NM_CONNECTION_GET_PRIVATE (connection)->path;
+	return nm_connection_get_private (connection)->path;
 }
 
 /**
@@ -2111,6 +2163,24 @@ nm_connection_get_setting_dummy (NMConnection *connection)
 	return (NMSettingDummy *) nm_connection_get_setting (connection, NM_TYPE_SETTING_DUMMY);
 }
 
+/**
+ * nm_connection_get_setting_ethtool:
+ * @connection: the #NMConnection
+ *
+ * A shortcut to return any #NMSettingEthtool the connection might contain.
+ *
+ * Returns: (transfer none): an #NMSettingEthtool if the connection contains one, otherwise %NULL
+ *
+ * Since: 1.10
+ **/
+NMSettingEthtool *
+nm_connection_get_setting_ethtool (NMConnection *connection)
+{
+	g_return_val_if_fail (NM_IS_CONNECTION (connection), NULL);
+
+	return (NMSettingEthtool *) nm_connection_get_setting (connection, NM_TYPE_SETTING_ETHTOOL);
+}
+
 /**
  * nm_connection_get_setting_generic:
  * @connection: the #NMConnection
@@ -2538,6 +2608,56 @@ nm_connection_get_private (NMConnection *connection)
 	return priv;
 }
 
+static NMConnectionPrivate *
+nm_connection_get_private_loaded (NMConnection *connection)
+{
+	NMConnectionPrivate *priv;
+	NMConnectionLazyLoadFunc lazy_load;
+
+	priv = nm_connection_get_private (connection);
+	if (G_UNLIKELY (priv->lazy_load)) {
+		/* clear it first, the loader sets the settings and must not recurse. */
+		lazy_load = priv->lazy_load;
+		priv->lazy_load = NULL;
+		lazy_load (connection);
+	}
+	return priv;
+}
+
+/**
+ * _nm_connection_set_lazy_load:
+ * @connection: the #NMConnection
+ * @lazy_load: (allow-none): the function that loads the settings
+ *
+ * Defers loading the settings of @connection. @lazy_load is called before
+ * the next access to the settings, but not for the path of @connection.
+ * It is called at most once, unless set again. Pass %NULL to cancel a
+ * pending load.
+ */
+void
+_nm_connection_set_lazy_load (NMConnection *connection,
+                              NMConnectionLazyLoadFunc lazy_load)
+{
+	g_return_if_fail (NM_IS_CONNECTION (connection));
+
+	nm_connection_get_private (connection)->lazy_load = lazy_load;
+}
+
+/**
+ * _nm_connection_get_lazy_load_pending:
+ * @connection: the #NMConnection
+ *
+ * Returns: whether a load set by _nm_connection_set_lazy_load() didn't
+ *   happen yet.
+ */
+gboolean
+_nm_connection_get_lazy_load_pending (NMConnection *connection)
+{
+	g_return_val_if_fail (NM_IS_CONNECTION (connection), FALSE);
+
+	return !!nm_connection_get_private (connection)->lazy_load;
+}
+
 static void
 nm_connection_default_init (NMConnectionInterface *iface)
 {
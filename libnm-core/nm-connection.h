@@ -201,6 +201,8 @@ NMSettingConnection *      nm_connection_get_setting_connection        (NMConnec
 NMSettingDcb *             nm_connection_get_setting_dcb               (NMConnection *connection);
 NM_AVAILABLE_IN_1_8
 NMSettingDummy *           nm_connection_get_setting_dummy             (NMConnection *connection);
+NM_AVAILABLE_IN_1_10
+NMSettingEthtool *         nm_connection_get_setting_ethtool           (NMConnection *connection);
 NMSettingGeneric *         nm_connection_get_setting_generic           (NMConnection *connection);
 NMSettingGsm *             nm_connection_get_setting_gsm               (NMConnection *connection);
 NMSettingInfiniband *      nm_connection_get_setting_infiniband        (NMConnection *connection);
@@ -46,6 +46,7 @@
 #include "nm-setting-connection.h"
 #include "nm-setting-dcb.h"
 #include "nm-setting-dummy.h"
+#include "nm-setting-ethtool.h"
 #include "nm-setting-generic.h"
 #include "nm-setting-gsm.h"
 #include "nm-setting-infiniband.h"
@@ -118,6 +119,12 @@ gboolean _nm_connection_replace_settings (NMConnection *connection,
                                           NMSettingParseFlags parse_flags,
                                           GError **error);
 
+typedef void (*NMConnectionLazyLoadFunc) (NMConnection *connection);
+
+void _nm_connection_set_lazy_load (NMConnection *connection,
+                                   NMConnectionLazyLoadFunc lazy_load);
+gboolean _nm_connection_get_lazy_load_pending (NMConnection *connection);
+
 /**
  * NMSettingVerifyResult:
  * @NM_SETTING_VERIFY_SUCCESS: the setting verifies successfully
@@ -135,6 +142,7 @@ typedef enum {
 } NMSettingVerifyResult;
 
 NMSettingVerifyResult _nm_connection_verify (NMConnection *connection, GError **error);
+NMSettingVerifyResult _nm_connection_verify_cached (NMConnection *connection, GError **error);
 
 gboolean _nm_connection_remove_setting (NMConnection *connection, GType setting_type);
 
@@ -144,8 +152,16 @@ NMConnection *_nm_simple_connection_new_from_dbus (GVariant      *dict,
 
 guint32 _nm_setting_get_setting_priority (NMSetting *setting);
 
+/* the maximum number of setting types. */
+#define _NM_SETTING_SLOT_MAX 64
+
+int _nm_setting_type_get_slot (GType type);
+int _nm_setting_get_slot (NMSetting *setting);
+
 gboolean _nm_setting_get_property (NMSetting *setting, const char *name, GValue *value);
 
+GParamSpec **_nm_setting_list_properties_sorted (NMSetting *setting, guint *out_len);
+
 #define NM_UTILS_HWADDR_LEN_MAX_STR (NM_UTILS_HWADDR_LEN_MAX * 3)
 
 guint8 *_nm_utils_hwaddr_aton (const char *asc, gpointer buffer, gsize buffer_length, gsize *out_length);
@@ -842,4 +842,19 @@ typedef enum { /*< skip >*/
 	NM_ROLLBACK_RESULT_ERR_FAILED           = 3,
 } NMRollbackResult;
 
+/**
+ * NMSettingsApplyFlags:
+ * @NM_SETTINGS_APPLY_FLAG_NONE: no flags
+ * @NM_SETTINGS_APPLY_FLAG_IN_MEMORY: keep added and updated connections
+ *   in memory only, like AddConnectionUnsaved() and UpdateUnsaved() do.
+ *
+ * The flags for the ApplyConnections call
+ *
+ * Since: 1.10
+ */
+typedef enum { /*< skip >*/
+	NM_SETTINGS_APPLY_FLAG_NONE                           = 0,
+	NM_SETTINGS_APPLY_FLAG_IN_MEMORY                      = 0x01,
+} NMSettingsApplyFlags;
+
 #endif /* __NM_DBUS_INTERFACE_H__ */
@@ -1410,14 +1410,12 @@ set_default_for_missing_key (NMSetting *setting, const char *property)
 }
 
 static void
-read_one_setting_value (NMSetting *setting,
-                        const char *key,
-                        const GValue *value,
-                        GParamFlags flags,
-                        gpointer user_data)
+read_one_setting_value (KeyfileReaderInfo *info,
+                        NMSetting *setting,
+                        const GParamSpec *pspec)
 {
-	KeyfileReaderInfo *info = user_data;
 	GKeyFile *keyfile = info->keyfile;
+	const char *key = pspec->name;
 	const char *setting_name;
 	int errsv;
 	GType type;
@@ -1429,7 +1427,7 @@ read_one_setting_value (NMSetting *setting,
 		return;
 
 	/* Property is not writable */
-	if (!(flags & G_PARAM_WRITABLE))
+	if (!(pspec->flags & G_PARAM_WRITABLE))
 		return;
 
 	/* Setting name gets picked up from the keyfile's section name instead */
@@ -1487,7 +1485,7 @@ read_one_setting_value (NMSetting *setting,
 		return;
 	}
 
-	type = G_VALUE_TYPE (value);
+	type = G_PARAM_SPEC_VALUE_TYPE (pspec);
 
 	if (type == G_TYPE_STRING) {
 		char *str_val;
@@ -1594,7 +1592,7 @@ read_one_setting_value (NMSetting *setting,
 		read_hash_of_string (keyfile, setting, key);
 	} else if (type == G_TYPE_ARRAY) {
 		read_array_of_uint (keyfile, setting, key);
-	} else if (G_VALUE_HOLDS_FLAGS (value)) {
+	} else if (G_TYPE_IS_FLAGS (type)) {
 		guint64 uint_val;
 
 		/* Flags are guint but GKeyFile has no uint reader, just uint64 */
@@ -1605,11 +1603,11 @@ read_one_setting_value (NMSetting *setting,
 			else {
 				if (!handle_warn (info, key, NM_KEYFILE_WARN_SEVERITY_WARN,
 				                  _("too large FLAGS property '%s' (%llu)"),
-				                  G_VALUE_TYPE_NAME (value), (unsigned long long) uint_val))
+				                  g_type_name (type), (unsigned long long) uint_val))
 					goto out_error;
 			}
 		}
-	} else if (G_VALUE_HOLDS_ENUM (value)) {
+	} else if (G_TYPE_IS_ENUM (type)) {
 		gint int_val;
 
 		int_val = nm_keyfile_plugin_kf_get_integer (keyfile, setting_name, key, &err);
@@ -1618,7 +1616,7 @@ read_one_setting_value (NMSetting *setting,
 	} else {
 		if (!handle_warn (info, key, NM_KEYFILE_WARN_SEVERITY_WARN,
 		                 _("unhandled setting property type '%s'"),
-		                 G_VALUE_TYPE_NAME (value)))
+		                 g_type_name (type)))
 			goto out_error;
 	}
 out_error:
@@ -1638,9 +1636,17 @@ read_setting (KeyfileReaderInfo *info)
 	type = nm_setting_lookup_type (alias);
 	if (type) {
 		NMSetting *setting = g_object_new (type, NULL);
+		gs_free GParamSpec **property_specs = NULL;
+		guint i, n_property_specs;
+
+		/* Only the types of the properties matter for reading, so don't
+		 * use nm_setting_enumerate_values(), which copies the default value
+		 * of each property first. */
+		property_specs = _nm_setting_list_properties_sorted (setting, &n_property_specs);
 
 		info->setting = setting;
-		nm_setting_enumerate_values (setting, read_one_setting_value, info);
+		for (i = 0; i < n_property_specs && !info->error; i++)
+			read_one_setting_value (info, setting, property_specs[i]);
 		info->setting = NULL;
 		if (!info->error)
 			return setting;
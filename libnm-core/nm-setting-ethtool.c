@@ -0,0 +1,607 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ * Copyright 2017 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include <string.h>
+
+#include "nm-setting-ethtool.h"
+#include "nm-setting-private.h"
+
+/**
+ * SECTION:nm-setting-ethtool
+ * @short_description: Describes hardware tuning of a network interface
+ *
+ * The #NMSettingEthtool object is a #NMSetting subclass that describes
+ * driver parameters like ring sizes, channels, interrupt coalescing,
+ * offload features and the CPUs used for packet steering and interrupt
+ * handling, which are set on the interface when the connection is
+ * activated.
+ *
+ * Each property has a default value that leaves the corresponding
+ * driver parameter untouched.
+ *
+ * Only the CPU masks are restored when the device is deactivated. Ring
+ * sizes, channels, interrupt coalescing and offload features keep the
+ * values set by the connection until the driver is reloaded or they are
+ * changed otherwise.
+ **/
+
+G_DEFINE_TYPE_WITH_CODE (NMSettingEthtool, nm_setting_ethtool, NM_TYPE_SETTING,
+                         _nm_register_setting (ETHTOOL, 2))
+NM_SETTING_REGISTER_TYPE (NM_TYPE_SETTING_ETHTOOL)
+
+#define NM_SETTING_ETHTOOL_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), NM_TYPE_SETTING_ETHTOOL, NMSettingEthtoolPrivate))
+
+typedef struct {
+	guint32 ring_rx;
+	guint32 ring_tx;
+	guint32 channels_combined;
+	gint32 coalesce_rx_usecs;
+	gint32 coalesce_tx_usecs;
+	int offload_gro;
+	int offload_tso;
+	int offload_lro;
+	char *rps_cpus;
+	char *xps_cpus;
+	char *irq_affinity;
+} NMSettingEthtoolPrivate;
+
+enum {
+	PROP_0,
+	PROP_RING_RX,
+	PROP_RING_TX,
+	PROP_CHANNELS_COMBINED,
+	PROP_COALESCE_RX_USECS,
+	PROP_COALESCE_TX_USECS,
+	PROP_OFFLOAD_GRO,
+	PROP_OFFLOAD_TSO,
+	PROP_OFFLOAD_LRO,
+	PROP_RPS_CPUS,
+	PROP_XPS_CPUS,
+	PROP_IRQ_AFFINITY,
+	LAST_PROP
+};
+
+/**
+ * nm_setting_ethtool_new:
+ *
+ * Creates a new #NMSettingEthtool object with default values.
+ *
+ * Returns: (transfer full): the new empty #NMSettingEthtool object
+ *
+ * Since: 1.10
+ **/
+NMSetting *
+nm_setting_ethtool_new (void)
+{
+	return (NMSetting *) g_object_new (NM_TYPE_SETTING_ETHTOOL, NULL);
+}
+
+/**
+ * nm_setting_ethtool_get_ring_rx:
+ * @setting: the #NMSettingEthtool
+ *
+ * Returns: the #NMSettingEthtool:ring-rx property of the setting
+ *
+ * Since: 1.10
+ **/
+guint32
+nm_setting_ethtool_get_ring_rx (NMSettingEthtool *setting)
+{
+	g_return_val_if_fail (NM_IS_SETTING_ETHTOOL (setting), 0);
+	return NM_SETTING_ETHTOOL_GET_PRIVATE (setting)->ring_rx;
+}
+
+/**
+ * nm_setting_ethtool_get_ring_tx:
+ * @setting: the #NMSettingEthtool
+ *
+ * Returns: the #NMSettingEthtool:ring-tx property of the setting
+ *
+ * Since: 1.10
+ **/
+guint32
+nm_setting_ethtool_get_ring_tx (NMSettingEthtool *setting)
+{
+	g_return_val_if_fail (NM_IS_SETTING_ETHTOOL (setting), 0);
+	return NM_SETTING_ETHTOOL_GET_PRIVATE (setting)->ring_tx;
+}
+
+/**
+ * nm_setting_ethtool_get_channels_combined:
+ * @setting: the #NMSettingEthtool
+ *
+ * Returns: the #NMSettingEthtool:channels-combined property of the setting
+ *
+ * Since: 1.10
+ **/
+guint32
+nm_setting_ethtool_get_channels_combined (NMSettingEthtool *setting)
+{
+	g_return_val_if_fail (NM_IS_SETTING_ETHTOOL (setting), 0);
+	return NM_SETTING_ETHTOOL_GET_PRIVATE (setting)->channels_combined;
+}
+
+/**
+ * nm_setting_ethtool_get_coalesce_rx_usecs:
+ * @setting: the #NMSettingEthtool
+ *
+ * Returns: the #NMSettingEthtool:coalesce-rx-usecs property of the setting
+ *
+ * Since: 1.10
+ **/
+gint32
+nm_setting_ethtool_get_coalesce_rx_usecs (NMSettingEthtool *setting)
+{
+	g_return_val_if_fail (NM_IS_SETTING_ETHTOOL (setting), -1);
+	return NM_SETTING_ETHTOOL_GET_PRIVATE (setting)->coalesce_rx_usecs;
+}
+
+/**
+ * nm_setting_ethtool_get_coalesce_tx_usecs:
+ * @setting: the #NMSettingEthtool
+ *
+ * Returns: the #NMSettingEthtool:coalesce-tx-usecs property of the setting
+ *
+ * Since: 1.10
+ **/
+gint32
+nm_setting_ethtool_get_coalesce_tx_usecs (NMSettingEthtool *setting)
+{
+	g_return_val_if_fail (NM_IS_SETTING_ETHTOOL (setting), -1);
+	return NM_SETTING_ETHTOOL_GET_PRIVATE (setting)->coalesce_tx_usecs;
+}
+
+/**
+ * nm_setting_ethtool_get_offload_gro:
+ * @setting: the #NMSettingEthtool
+ *
+ * Returns: the #NMSettingEthtool:offload-gro property of the setting
+ *
+ * Since: 1.10
+ **/
+int
+nm_setting_ethtool_get_offload_gro (NMSettingEthtool *setting)
+{
+	g_return_val_if_fail (NM_IS_SETTING_ETHTOOL (setting), -1);
+	return NM_SETTING_ETHTOOL_GET_PRIVATE (setting)->offload_gro;
+}
+
+/**
+ * nm_setting_ethtool_get_offload_tso:
+ * @setting: the #NMSettingEthtool
+ *
+ * Returns: the #NMSettingEthtool:offload-tso property of the setting
+ *
+ * Since: 1.10
+ **/
+int
+nm_setting_ethtool_get_offload_tso (NMSettingEthtool *setting)
+{
+	g_return_val_if_fail (NM_IS_SETTING_ETHTOOL (setting), -1);
+	return NM_SETTING_ETHTOOL_GET_PRIVATE (setting)->offload_tso;
+}
+
+/**
+ * nm_setting_ethtool_get_offload_lro:
+ * @setting: the #NMSettingEthtool
+ *
+ * Returns: the #NMSettingEthtool:offload-lro property of the setting
+ *
+ * Since: 1.10
+ **/
+int
+nm_setting_ethtool_get_offload_lro (NMSettingEthtool *setting)
+{
+	g_return_val_if_fail (NM_IS_SETTING_ETHTOOL (setting), -1);
+	return NM_SETTING_ETHTOOL_GET_PRIVATE (setting)->offload_lro;
+}
+
+/**
+ * nm_setting_ethtool_get_rps_cpus:
+ * @setting: the #NMSettingEthtool
+ *
+ * Returns: the #NMSettingEthtool:rps-cpus property of the setting
+ *
+ * Since: 1.10
+ **/
+const char *
+nm_setting_ethtool_get_rps_cpus (NMSettingEthtool *setting)
+{
+	g_return_val_if_fail (NM_IS_SETTING_ETHTOOL (setting), NULL);
+	return NM_SETTING_ETHTOOL_GET_PRIVATE (setting)->rps_cpus;
+}
+
+/**
+ * nm_setting_ethtool_get_xps_cpus:
+ * @setting: the #NMSettingEthtool
+ *
+ * Returns: the #NMSettingEthtool:xps-cpus property of the setting
+ *
+ * Since: 1.10
+ **/
+const char *
+nm_setting_ethtool_get_xps_cpus (NMSettingEthtool *setting)
+{
+	g_return_val_if_fail (NM_IS_SETTING_ETHTOOL (setting), NULL);
+	return NM_SETTING_ETHTOOL_GET_PRIVATE (setting)->xps_cpus;
+}
+
+/**
+ * nm_setting_ethtool_get_irq_affinity:
+ * @setting: the #NMSettingEthtool
+ *
+ * Returns: the #NMSettingEthtool:irq-affinity property of the setting
+ *
+ * Since: 1.10
+ **/
+const char *
+nm_setting_ethtool_get_irq_affinity (NMSettingEthtool *setting)
+{
+	g_return_val_if_fail (NM_IS_SETTING_ETHTOOL (setting), NULL);
+	return NM_SETTING_ETHTOOL_GET_PRIVATE (setting)->irq_affinity;
+}
+
+static void
+nm_setting_ethtool_init (NMSettingEthtool *setting)
+{
+}
+
+static gboolean
+verify_cpus (const char *cpus, const char *property, GError **error)
+{
+	if (   !cpus
+	    || nm_streq (cpus, NM_SETTING_ETHTOOL_CPUS_NUMA))
+		return TRUE;
+
+	/* the format of the kernel's cpumask files: hexadecimal
+	 * words, optionally separated by commas. */
+	if (   !cpus[0]
+	    || strspn (cpus, "0123456789abcdefABCDEF,") != strlen (cpus)) {
+		g_set_error (error,
+		             NM_CONNECTION_ERROR,
+		             NM_CONNECTION_ERROR_INVALID_PROPERTY,
+		             _("'%s' is not a valid CPU mask"), cpus);
+		g_prefix_error (error, "%s.%s: ", NM_SETTING_ETHTOOL_SETTING_NAME, property);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static gboolean
+verify (NMSetting *setting, NMConnection *connection, GError **error)
+{
+	NMSettingEthtoolPrivate *priv = NM_SETTING_ETHTOOL_GET_PRIVATE (setting);
+
+	if (!verify_cpus (priv->rps_cpus, NM_SETTING_ETHTOOL_RPS_CPUS, error))
+		return FALSE;
+	if (!verify_cpus (priv->xps_cpus, NM_SETTING_ETHTOOL_XPS_CPUS, error))
+		return FALSE;
+	if (!verify_cpus (priv->irq_affinity, NM_SETTING_ETHTOOL_IRQ_AFFINITY, error))
+		return FALSE;
+
+	return TRUE;
+}
+
+static void
+set_property (GObject *object, guint prop_id,
+              const GValue *value, GParamSpec *pspec)
+{
+	NMSettingEthtoolPrivate *priv = NM_SETTING_ETHTOOL_GET_PRIVATE (object);
+
+	switch (prop_id) {
+	case PROP_RING_RX:
+		priv->ring_rx = g_value_get_uint (value);
+		break;
+	case PROP_RING_TX:
+		priv->ring_tx = g_value_get_uint (value);
+		break;
+	case PROP_CHANNELS_COMBINED:
+		priv->channels_combined = g_value_get_uint (value);
+		break;
+	case PROP_COALESCE_RX_USECS:
+		priv->coalesce_rx_usecs = g_value_get_int (value);
+		break;
+	case PROP_COALESCE_TX_USECS:
+		priv->coalesce_tx_usecs = g_value_get_int (value);
+		break;
+	case PROP_OFFLOAD_GRO:
+		priv->offload_gro = g_value_get_int (value);
+		break;
+	case PROP_OFFLOAD_TSO:
+		priv->offload_tso = g_value_get_int (value);
+		break;
+	case PROP_OFFLOAD_LRO:
+		priv->offload_lro = g_value_get_int (value);
+		break;
+	case PROP_RPS_CPUS:
+		g_free (priv->rps_cpus);
+		priv->rps_cpus = g_value_dup_string (value);
+		break;
+	case PROP_XPS_CPUS:
+		g_free (priv->xps_cpus);
+		priv->xps_cpus = g_value_dup_string (value);
+		break;
+	case PROP_IRQ_AFFINITY:
+		g_free (priv->irq_affinity);
+		priv->irq_affinity = g_value_dup_string (value);
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+		break;
+	}
+}
+
+static void
+get_property (GObject *object, guint prop_id,
+              GValue *value, GParamSpec *pspec)
+{
+	NMSettingEthtoolPrivate *priv = NM_SETTING_ETHTOOL_GET_PRIVATE (object);
+
+	switch (prop_id) {
+	case PROP_RING_RX:
+		g_value_set_uint (value, priv->ring_rx);
+		break;
+	case PROP_RING_TX:
+		g_value_set_uint (value, priv->ring_tx);
+		break;
+	case PROP_CHANNELS_COMBINED:
+		g_value_set_uint (value, priv->channels_combined);
+		break;
+	case PROP_COALESCE_RX_USECS:
+		g_value_set_int (value, priv->coalesce_rx_usecs);
+		break;
+	case PROP_COALESCE_TX_USECS:
+		g_value_set_int (value, priv->coalesce_tx_usecs);
+		break;
+	case PROP_OFFLOAD_GRO:
+		g_value_set_int (value, priv->offload_gro);
+		break;
+	case PROP_OFFLOAD_TSO:
+		g_value_set_int (value, priv->offload_tso);
+		break;
+	case PROP_OFFLOAD_LRO:
+		g_value_set_int (value, priv->offload_lro);
+		break;
+	case PROP_RPS_CPUS:
+		g_value_set_string (value, priv->rps_cpus);
+		break;
+	case PROP_XPS_CPUS:
+		g_value_set_string (value, priv->xps_cpus);
+		break;
+	case PROP_IRQ_AFFINITY:
+		g_value_set_string (value, priv->irq_affinity);
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+		break;
+	}
+}
+
+static void
+finalize (GObject *object)
+{
+	NMSettingEthtoolPrivate *priv = NM_SETTING_ETHTOOL_GET_PRIVATE (object);
+
+	g_free (priv->rps_cpus);
+	g_free (priv->xps_cpus);
+	g_free (priv->irq_affinity);
+
+	G_OBJECT_CLASS (nm_setting_ethtool_parent_class)->finalize (object);
+}
+
+static void
+nm_setting_ethtool_class_init (NMSettingEthtoolClass *setting_class)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (setting_class);
+	NMSettingClass *parent_class = NM_SETTING_CLASS (setting_class);
+
+	g_type_class_add_private (setting_class, sizeof (NMSettingEthtoolPrivate));
+
+	/* virtual methods */
+	object_class->set_property = set_property;
+	object_class->get_property = get_property;
+	object_class->finalize     = finalize;
+	parent_class->verify       = verify;
+
+	/* Properties */
+	/**
+	 * NMSettingEthtool:ring-rx:
+	 *
+	 * The number of entries of the receive ring. Zero leaves the
+	 * driver setting unchanged.
+	 *
+	 * Since: 1.10
+	 */
+	g_object_class_install_property
+		(object_class, PROP_RING_RX,
+		 g_param_spec_uint (NM_SETTING_ETHTOOL_RING_RX, "", "",
+		                    0, G_MAXUINT32, 0,
+		                    G_PARAM_READWRITE |
+		                    G_PARAM_CONSTRUCT |
+		                    G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * NMSettingEthtool:ring-tx:
+	 *
+	 * The number of entries of the transmit ring. Zero leaves the
+	 * driver setting unchanged.
+	 *
+	 * Since: 1.10
+	 */
+	g_object_class_install_property
+		(object_class, PROP_RING_TX,
+		 g_param_spec_uint (NM_SETTING_ETHTOOL_RING_TX, "", "",
+		                    0, G_MAXUINT32, 0,
+		                    G_PARAM_READWRITE |
+		                    G_PARAM_CONSTRUCT |
+		                    G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * NMSettingEthtool:channels-combined:
+	 *
+	 * The number of combined receive/transmit channels (queues) of the
+	 * interface. Zero leaves the driver setting unchanged.
+	 *
+	 * Since: 1.10
+	 */
+	g_object_class_install_property
+		(object_class, PROP_CHANNELS_COMBINED,
+		 g_param_spec_uint (NM_SETTING_ETHTOOL_CHANNELS_COMBINED, "", "",
+		                    0, G_MAXUINT32, 0,
+		                    G_PARAM_READWRITE |
+		                    G_PARAM_CONSTRUCT |
+		                    G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * NMSettingEthtool:coalesce-rx-usecs:
+	 *
+	 * How many microseconds to delay a receive interrupt after a packet
+	 * arrives. -1 leaves the driver setting unchanged.
+	 *
+	 * Since: 1.10
+	 */
+	g_object_class_install_property
+		(object_class, PROP_COALESCE_RX_USECS,
+		 g_param_spec_int (NM_SETTING_ETHTOOL_COALESCE_RX_USECS, "", "",
+		                   -1, G_MAXINT32, -1,
+		                   G_PARAM_READWRITE |
+		                   G_PARAM_CONSTRUCT |
+		                   G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * NMSettingEthtool:coalesce-tx-usecs:
+	 *
+	 * How many microseconds to delay a transmit interrupt after a packet
+	 * is sent. -1 leaves the driver setting unchanged.
+	 *
+	 * Since: 1.10
+	 */
+	g_object_class_install_property
+		(object_class, PROP_COALESCE_TX_USECS,
+		 g_param_spec_int (NM_SETTING_ETHTOOL_COALESCE_TX_USECS, "", "",
+		                   -1, G_MAXINT32, -1,
+		                   G_PARAM_READWRITE |
+		                   G_PARAM_CONSTRUCT |
+		                   G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * NMSettingEthtool:offload-gro:
+	 *
+	 * Whether generic receive offload is enabled (1) or disabled (0).
+	 * -1 leaves the driver setting unchanged.
+	 *
+	 * Since: 1.10
+	 */
+	g_object_class_install_property
+		(object_class, PROP_OFFLOAD_GRO,
+		 g_param_spec_int (NM_SETTING_ETHTOOL_OFFLOAD_GRO, "", "",
+		                   -1, 1, -1,
+		                   G_PARAM_READWRITE |
+		                   G_PARAM_CONSTRUCT |
+		                   G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * NMSettingEthtool:offload-tso:
+	 *
+	 * Whether TCP segmentation offload is enabled (1) or disabled (0).
+	 * -1 leaves the driver setting unchanged.
+	 *
+	 * Since: 1.10
+	 */
+	g_object_class_install_property
+		(object_class, PROP_OFFLOAD_TSO,
+		 g_param_spec_int (NM_SETTING_ETHTOOL_OFFLOAD_TSO, "", "",
+		                   -1, 1, -1,
+		                   G_PARAM_READWRITE |
+		                   G_PARAM_CONSTRUCT |
+		                   G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * NMSettingEthtool:offload-lro:
+	 *
+	 * Whether large receive offload is enabled (1) or disabled (0).
+	 * -1 leaves the driver setting unchanged.
+	 *
+	 * Since: 1.10
+	 */
+	g_object_class_install_property
+		(object_class, PROP_OFFLOAD_LRO,
+		 g_param_spec_int (NM_SETTING_ETHTOOL_OFFLOAD_LRO, "", "",
+		                   -1, 1, -1,
+		                   G_PARAM_READWRITE |
+		                   G_PARAM_CONSTRUCT |
+		                   G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * NMSettingEthtool:rps-cpus:
+	 *
+	 * The CPUs that process packets of each receive queue (Receive
+	 * Packet Steering), as a hexadecimal CPU mask like in
+	 * /sys/class/net/<interface>/queues/rx-<n>/rps_cpus. The value
+	 * %NM_SETTING_ETHTOOL_CPUS_NUMA selects the CPUs of the NUMA node
+	 * of the device. If unset, the kernel setting is left unchanged.
+	 *
+	 * The original masks are restored when the device is deactivated.
+	 *
+	 * Since: 1.10
+	 */
+	g_object_class_install_property
+		(object_class, PROP_RPS_CPUS,
+		 g_param_spec_string (NM_SETTING_ETHTOOL_RPS_CPUS, "", "",
+		                      NULL,
+		                      G_PARAM_READWRITE |
+		                      G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * NMSettingEthtool:xps-cpus:
+	 *
+	 * The CPUs that may transmit on each transmit queue (Transmit
+	 * Packet Steering), in the same format as #NMSettingEthtool:rps-cpus.
+	 * If unset, the kernel setting is left unchanged.
+	 *
+	 * Since: 1.10
+	 */
+	g_object_class_install_property
+		(object_class, PROP_XPS_CPUS,
+		 g_param_spec_string (NM_SETTING_ETHTOOL_XPS_CPUS, "", "",
+		                      NULL,
+		                      G_PARAM_READWRITE |
+		                      G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * NMSettingEthtool:irq-affinity:
+	 *
+	 * The CPUs that handle the MSI interrupts of the device, in the same
+	 * format as #NMSettingEthtool:rps-cpus. If unset, the interrupt
+	 * affinity is left unchanged.
+	 *
+	 * Since: 1.10
+	 */
+	g_object_class_install_property
+		(object_class, PROP_IRQ_AFFINITY,
+		 g_param_spec_string (NM_SETTING_ETHTOOL_IRQ_AFFINITY, "", "",
+		                      NULL,
+		                      G_PARAM_READWRITE |
+		                      G_PARAM_STATIC_STRINGS));
+}
@@ -173,6 +173,140 @@ valid_metric (gint64 metric, GError **error)
 	return TRUE;
 }
 
+/*****************************************************************************/
+
+/* The attributes of addresses and routes. Most entries have none, and those
+ * that do have only a few, so rather than a hash table each entry keeps a
+ * small array sorted by name. */
+typedef struct {
+	char *name;
+	GVariant *value;
+} IPAttr;
+
+static void
+_ip_attrs_clear (IPAttr **p_attrs, guint *p_n_attrs)
+{
+	guint i;
+
+	for (i = 0; i < *p_n_attrs; i++) {
+		g_free ((*p_attrs)[i].name);
+		g_variant_unref ((*p_attrs)[i].value);
+	}
+	nm_clear_g_free (p_attrs);
+	*p_n_attrs = 0;
+}
+
+static gboolean
+_ip_attrs_find (const IPAttr *attrs, guint n_attrs, const char *name, guint *out_idx)
+{
+	guint lo = 0, hi = n_attrs;
+
+	while (lo < hi) {
+		guint mid = lo + (hi - lo) / 2;
+		int c = strcmp (attrs[mid].name, name);
+
+		if (c == 0) {
+			*out_idx = mid;
+			return TRUE;
+		}
+		if (c < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	*out_idx = lo;
+	return FALSE;
+}
+
+static GVariant *
+_ip_attrs_get (const IPAttr *attrs, guint n_attrs, const char *name)
+{
+	guint idx;
+
+	if (_ip_attrs_find (attrs, n_attrs, name, &idx))
+		return attrs[idx].value;
+	return NULL;
+}
+
+static void
+_ip_attrs_set (IPAttr **p_attrs, guint *p_n_attrs, const char *name, GVariant *value)
+{
+	IPAttr *attrs = *p_attrs;
+	guint idx;
+
+	if (_ip_attrs_find (attrs, *p_n_attrs, name, &idx)) {
+		if (value) {
+			g_variant_ref_sink (value);
+			g_variant_unref (attrs[idx].value);
+			attrs[idx].value = value;
+			return;
+		}
+		g_free (attrs[idx].name);
+		g_variant_unref (attrs[idx].value);
+		(*p_n_attrs)--;
+		memmove (&attrs[idx], &attrs[idx + 1], (*p_n_attrs - idx) * sizeof (IPAttr));
+		if (!*p_n_attrs)
+			nm_clear_g_free (p_attrs);
+		return;
+	}
+
+	if (!value)
+		return;
+
+	attrs = g_renew (IPAttr, attrs, *p_n_attrs + 1);
+	memmove (&attrs[idx + 1], &attrs[idx], (*p_n_attrs - idx) * sizeof (IPAttr));
+	attrs[idx].name = g_strdup (name);
+	attrs[idx].value = g_variant_ref_sink (value);
+	(*p_n_attrs)++;
+	*p_attrs = attrs;
+}
+
+static IPAttr *
+_ip_attrs_dup (const IPAttr *attrs, guint n_attrs)
+{
+	IPAttr *copy;
+	guint i;
+
+	if (!n_attrs)
+		return NULL;
+
+	copy = g_new (IPAttr, n_attrs);
+	for (i = 0; i < n_attrs; i++) {
+		copy[i].name = g_strdup (attrs[i].name);
+		copy[i].value = g_variant_ref (attrs[i].value);
+	}
+	return copy;
+}
+
+static gboolean
+_ip_attrs_equal (const IPAttr *a, guint n_a, const IPAttr *b, guint n_b)
+{
+	guint i;
+
+	/* both are sorted by name, so they can be compared in order. */
+	if (n_a != n_b)
+		return FALSE;
+	for (i = 0; i < n_a; i++) {
+		if (   !nm_streq (a[i].name, b[i].name)
+		    || !g_variant_equal (a[i].value, b[i].value))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static char **
+_ip_attrs_get_names (const IPAttr *attrs, guint n_attrs)
+{
+	char **names;
+	guint i;
+
+	names = g_new (char *, n_attrs + 1);
+	for (i = 0; i < n_attrs; i++)
+		names[i] = g_strdup (attrs[i].name);
+	names[i] = NULL;
+	return names;
+}
+
 /*****************************************************************************
  * NMIPAddress
  *****************************************************************************/
@@ -185,7 +319,8 @@ struct NMIPAddress {
 	char *address;
 	int prefix, family;
 
-	GHashTable *attributes;
+	IPAttr *attrs;
+	guint n_attrs;
 };
 
 /**
@@ -293,8 +428,7 @@ nm_ip_address_unref (NMIPAddress *address)
 	address->refcount--;
 	if (address->refcount == 0) {
 		g_free (address->address);
-		if (address->attributes)
-			g_hash_table_unref (address->attributes);
+		_ip_attrs_clear (&address->attrs, &address->n_attrs);
 		g_slice_free (NMIPAddress, address);
 	}
 }
@@ -322,26 +456,9 @@ _nm_ip_address_equal (NMIPAddress *address, NMIPAddress *other, gboolean conside
 	    || address->prefix != other->prefix
 	    || strcmp (address->address, other->address) != 0)
 		return FALSE;
-	if (consider_attributes) {
-		GHashTableIter iter;
-		const char *key;
-		GVariant *value, *value2;
-		guint n;
-
-		n = address->attributes ? g_hash_table_size (address->attributes) : 0;
-		if (n != (other->attributes ? g_hash_table_size (other->attributes) : 0))
-			return FALSE;
-		if (n) {
-			g_hash_table_iter_init (&iter, address->attributes);
-			while (g_hash_table_iter_next (&iter, (gpointer *) &key, (gpointer *) &value)) {
-				value2 = g_hash_table_lookup (other->attributes, key);
-				if (!value2)
-					return FALSE;
-				if (!g_variant_equal (value, value2))
-					return FALSE;
-			}
-		}
-	}
+	if (   consider_attributes
+	    && !_ip_attrs_equal (address->attrs, address->n_attrs, other->attrs, other->n_attrs))
+		return FALSE;
 	return TRUE;
 }
 
@@ -377,18 +494,14 @@ nm_ip_address_dup (NMIPAddress *address)
 	g_return_val_if_fail (address != NULL, NULL);
 	g_return_val_if_fail (address->refcount > 0, NULL);
 
-	copy = nm_ip_address_new (address->family,
-	                          address->address, address->prefix,
-	                          NULL);
-	if (address->attributes) {
-		GHashTableIter iter;
-		const char *key;
-		GVariant *value;
-
-		g_hash_table_iter_init (&iter, address->attributes);
-		while (g_hash_table_iter_next (&iter, (gpointer *) &key, (gpointer *) &value))
-			nm_ip_address_set_attribute (copy, key, value);
-	}
+	/* @address is valid and canonical already, no need to parse it again. */
+	copy = g_slice_new (NMIPAddress);
+	copy->refcount = 1;
+	copy->family = address->family;
+	copy->address = g_strdup (address->address);
+	copy->prefix = address->prefix;
+	copy->attrs = _ip_attrs_dup (address->attrs, address->n_attrs);
+	copy->n_attrs = address->n_attrs;
 
 	return copy;
 }
@@ -537,22 +650,9 @@ nm_ip_address_set_prefix (NMIPAddress *address,
 char **
 nm_ip_address_get_attribute_names (NMIPAddress *address)
 {
-	GHashTableIter iter;
-	const char *key;
-	GPtrArray *names;
-
 	g_return_val_if_fail (address != NULL, NULL);
 
-	names = g_ptr_array_new ();
-
-	if (address->attributes) {
-		g_hash_table_iter_init (&iter, address->attributes);
-		while (g_hash_table_iter_next (&iter, (gpointer *) &key, NULL))
-			g_ptr_array_add (names, g_strdup (key));
-	}
-	g_ptr_array_add (names, NULL);
-
-	return (char **) g_ptr_array_free (names, FALSE);
+	return _ip_attrs_get_names (address->attrs, address->n_attrs);
 }
 
 /**
@@ -571,10 +671,7 @@ nm_ip_address_get_attribute (NMIPAddress *address, const char *name)
 	g_return_val_if_fail (address != NULL, NULL);
 	g_return_val_if_fail (name != NULL && *name != '\0', NULL);
 
-	if (address->attributes)
-		return g_hash_table_lookup (address->attributes, name);
-	else
-		return NULL;
+	return _ip_attrs_get (address->attrs, address->n_attrs, name);
 }
 
 /**
@@ -592,15 +689,7 @@ nm_ip_address_set_attribute (NMIPAddress *address, const char *name, GVariant *v
 	g_return_if_fail (name != NULL && *name != '\0');
 	g_return_if_fail (strcmp (name, "address") != 0 && strcmp (name, "prefix") != 0);
 
-	if (!address->attributes) {
-		address->attributes = g_hash_table_new_full (g_str_hash, g_str_equal,
-		                                             g_free, (GDestroyNotify) g_variant_unref);
-	}
-
-	if (value)
-		g_hash_table_insert (address->attributes, g_strdup (name), g_variant_ref_sink (value));
-	else
-		g_hash_table_remove (address->attributes, name);
+	_ip_attrs_set (&address->attrs, &address->n_attrs, name, value);
 }
 
 /*****************************************************************************
@@ -618,7 +707,8 @@ struct NMIPRoute {
 	char *next_hop;
 	gint64 metric;
 
-	GHashTable *attributes;
+	IPAttr *attrs;
+	guint n_attrs;
 };
 
 /**
@@ -746,8 +836,7 @@ nm_ip_route_unref (NMIPRoute *route)
 	if (route->refcount == 0) {
 		g_free (route->dest);
 		g_free (route->next_hop);
-		if (route->attributes)
-			g_hash_table_unref (route->attributes);
+		_ip_attrs_clear (&route->attrs, &route->n_attrs);
 		g_slice_free (NMIPRoute, route);
 	}
 }
@@ -777,26 +866,9 @@ _nm_ip_route_equal (NMIPRoute *route, NMIPRoute *other, gboolean consider_attrib
 	    || strcmp (route->dest, other->dest) != 0
 	    || g_strcmp0 (route->next_hop, other->next_hop) != 0)
 		return FALSE;
-	if (consider_attributes) {
-		GHashTableIter iter;
-		const char *key;
-		GVariant *value, *value2;
-		guint n;
-
-		n = route->attributes ? g_hash_table_size (route->attributes) : 0;
-		if (n != (other->attributes ? g_hash_table_size (other->attributes) : 0))
-			return FALSE;
-		if (n) {
-			g_hash_table_iter_init (&iter, route->attributes);
-			while (g_hash_table_iter_next (&iter, (gpointer *) &key, (gpointer *) &value)) {
-				value2 = g_hash_table_lookup (other->attributes, key);
-				if (!value2)
-					return FALSE;
-				if (!g_variant_equal (value, value2))
-					return FALSE;
-			}
-		}
-	}
+	if (   consider_attributes
+	    && !_ip_attrs_equal (route->attrs, route->n_attrs, other->attrs, other->n_attrs))
+		return FALSE;
 	return TRUE;
 }
 
@@ -832,19 +904,16 @@ nm_ip_route_dup (NMIPRoute *route)
 	g_return_val_if_fail (route != NULL, NULL);
 	g_return_val_if_fail (route->refcount > 0, NULL);
 
-	copy = nm_ip_route_new (route->family,
-	                        route->dest, route->prefix,
-	                        route->next_hop, route->metric,
-	                        NULL);
-	if (route->attributes) {
-		GHashTableIter iter;
-		const char *key;
-		GVariant *value;
-
-		g_hash_table_iter_init (&iter, route->attributes);
-		while (g_hash_table_iter_next (&iter, (gpointer *) &key, (gpointer *) &value))
-			nm_ip_route_set_attribute (copy, key, value);
-	}
+	/* @route is valid and canonical already, no need to parse it again. */
+	copy = g_slice_new (NMIPRoute);
+	copy->refcount = 1;
+	copy->family = route->family;
+	copy->dest = g_strdup (route->dest);
+	copy->prefix = route->prefix;
+	copy->next_hop = g_strdup (route->next_hop);
+	copy->metric = route->metric;
+	copy->attrs = _ip_attrs_dup (route->attrs, route->n_attrs);
+	copy->n_attrs = route->n_attrs;
 
 	return copy;
 }
@@ -1115,22 +1184,9 @@ nm_ip_route_set_metric (NMIPRoute *route,
 char **
 nm_ip_route_get_attribute_names (NMIPRoute *route)
 {
-	GHashTableIter iter;
-	const char *key;
-	GPtrArray *names;
-
 	g_return_val_if_fail (route != NULL, NULL);
 
-	names = g_ptr_array_new ();
-
-	if (route->attributes) {
-		g_hash_table_iter_init (&iter, route->attributes);
-		while (g_hash_table_iter_next (&iter, (gpointer *) &key, NULL))
-			g_ptr_array_add (names, g_strdup (key));
-	}
-	g_ptr_array_add (names, NULL);
-
-	return (char **) g_ptr_array_free (names, FALSE);
+	return _ip_attrs_get_names (route->attrs, route->n_attrs);
 }
 
 /**
@@ -1149,10 +1205,7 @@ nm_ip_route_get_attribute (NMIPRoute *route, const char *name)
 	g_return_val_if_fail (route != NULL, NULL);
 	g_return_val_if_fail (name != NULL && *name != '\0', NULL);
 
-	if (route->attributes)
-		return g_hash_table_lookup (route->attributes, name);
-	else
-		return NULL;
+	return _ip_attrs_get (route->attrs, route->n_attrs, name);
 }
 
 /**
@@ -1171,15 +1224,7 @@ nm_ip_route_set_attribute (NMIPRoute *route, const char *name, GVariant *value)
 	g_return_if_fail (   strcmp (name, "dest") != 0 && strcmp (name, "prefix") != 0
 	                  && strcmp (name, "next-hop") != 0 && strcmp (name, "metric") != 0);
 
-	if (!route->attributes) {
-		route->attributes = g_hash_table_new_full (g_str_hash, g_str_equal,
-		                                           g_free, (GDestroyNotify) g_variant_unref);
-	}
-
-	if (value)
-		g_hash_table_insert (route->attributes, g_strdup (name), g_variant_ref_sink (value));
-	else
-		g_hash_table_remove (route->attributes, name);
+	_ip_attrs_set (&route->attrs, &route->n_attrs, name, value);
 }
 
 #define ATTR_SPEC_PTR(name, type, v4, v6, str_type) \
@@ -59,12 +59,14 @@ NM_SETTING_REGISTER_TYPE (NM_TYPE_SETTING_IP4_CONFIG)
 typedef struct {
 	char *dhcp_client_id;
 	char *dhcp_fqdn;
+	guint32 route_weight;
 } NMSettingIP4ConfigPrivate;
 
 enum {
 	PROP_0,
 	PROP_DHCP_CLIENT_ID,
 	PROP_DHCP_FQDN,
+	PROP_ROUTE_WEIGHT,
 
 	LAST_PROP
 };
@@ -119,6 +121,25 @@ nm_setting_ip4_config_get_dhcp_fqdn (NMSettingIP4Config *setting)
 	return NM_SETTING_IP4_CONFIG_GET_PRIVATE (setting)->dhcp_fqdn;
 }
 
+/**
+ * nm_setting_ip4_config_get_route_weight:
+ * @setting: the #NMSettingIP4Config
+ *
+ * Returns the value contained in the #NMSettingIP4Config:route-weight
+ * property.
+ *
+ * Returns: the weight of the default route in a multipath route
+ *
+ * Since: 1.10
+ **/
+guint32
+nm_setting_ip4_config_get_route_weight (NMSettingIP4Config *setting)
+{
+	g_return_val_if_fail (NM_IS_SETTING_IP4_CONFIG (setting), 0);
+
+	return NM_SETTING_IP4_CONFIG_GET_PRIVATE (setting)->route_weight;
+}
+
 static gboolean
 verify (NMSetting *setting, NMConnection *connection, GError **error)
 {
@@ -285,6 +306,9 @@ set_property (GObject *object, guint prop_id,
 		g_free (priv->dhcp_fqdn);
 		priv->dhcp_fqdn = g_value_dup_string (value);
 		break;
+	case PROP_ROUTE_WEIGHT:
+		priv->route_weight = g_value_get_uint (value);
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
@@ -304,6 +328,9 @@ get_property (GObject *object, guint prop_id,
 	case PROP_DHCP_FQDN:
 		g_value_set_string (value, nm_setting_ip4_config_get_dhcp_fqdn (s_ip4));
 		break;
+	case PROP_ROUTE_WEIGHT:
+		g_value_set_uint (value, nm_setting_ip4_config_get_route_weight (s_ip4));
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
@@ -754,6 +781,29 @@ nm_setting_ip4_config_class_init (NMSettingIP4ConfigClass *ip4_class)
 		                      G_PARAM_READWRITE |
 		                      G_PARAM_STATIC_STRINGS));
 
+	/**
+	 * NMSettingIP4Config:route-weight:
+	 *
+	 * The weight of the default route of this connection when it is
+	 * combined with others into an equal-cost multipath route.
+	 *
+	 * If set to a value between 1 and 256, the default routes of all
+	 * active connections that have a weight and the same
+	 * #NMSettingIPConfig:route-metric are merged into a single multipath
+	 * default route, and traffic is spread across the uplinks in
+	 * proportion to their weights. The default value 0 disables this and
+	 * the connection gets a default route of its own.
+	 *
+	 * Since: 1.10
+	 */
+	g_object_class_install_property
+		(object_class, PROP_ROUTE_WEIGHT,
+		 g_param_spec_uint (NM_SETTING_IP4_CONFIG_ROUTE_WEIGHT, "", "",
+		                    0, 256, 0,
+		                    G_PARAM_READWRITE |
+		                    G_PARAM_CONSTRUCT |
+		                    G_PARAM_STATIC_STRINGS));
+
 	/* IP4-specific property overrides */
 
 	/* ---dbus---
@@ -42,6 +42,7 @@ G_BEGIN_DECLS
 
 #define NM_SETTING_IP4_CONFIG_DHCP_CLIENT_ID     "dhcp-client-id"
 #define NM_SETTING_IP4_CONFIG_DHCP_FQDN          "dhcp-fqdn"
+#define NM_SETTING_IP4_CONFIG_ROUTE_WEIGHT       "route-weight"
 
 /**
  * NM_SETTING_IP4_CONFIG_METHOD_AUTO:
@@ -110,6 +111,8 @@ NMSetting *nm_setting_ip4_config_new (void);
 const char *nm_setting_ip4_config_get_dhcp_client_id     (NMSettingIP4Config *setting);
 NM_AVAILABLE_IN_1_2
 const char *nm_setting_ip4_config_get_dhcp_fqdn          (NMSettingIP4Config *setting);
+NM_AVAILABLE_IN_1_10
+guint32     nm_setting_ip4_config_get_route_weight       (NMSettingIP4Config *setting);
 
 G_END_DECLS
 
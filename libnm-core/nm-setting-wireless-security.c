@@ -83,6 +83,10 @@ typedef struct {
 	/* WPA-PSK */
 	char *psk;
 	NMSettingSecretFlags psk_flags;
+
+	/* Roaming */
+	int ft;
+	int okc;
 } NMSettingWirelessSecurityPrivate;
 
 enum {
@@ -104,6 +108,8 @@ enum {
 	PROP_PSK_FLAGS,
 	PROP_LEAP_PASSWORD,
 	PROP_LEAP_PASSWORD_FLAGS,
+	PROP_FT,
+	PROP_OKC,
 
 	LAST_PROP
 };
@@ -645,6 +651,38 @@ nm_setting_wireless_security_get_leap_password_flags (NMSettingWirelessSecurity
 	return NM_SETTING_WIRELESS_SECURITY_GET_PRIVATE (setting)->leap_password_flags;
 }
 
+/**
+ * nm_setting_wireless_security_get_ft:
+ * @setting: the #NMSettingWirelessSecurity
+ *
+ * Returns: the #NMSettingWirelessSecurity:ft property of the setting
+ *
+ * Since: 1.10
+ **/
+int
+nm_setting_wireless_security_get_ft (NMSettingWirelessSecurity *setting)
+{
+	g_return_val_if_fail (NM_IS_SETTING_WIRELESS_SECURITY (setting), -1);
+
+	return NM_SETTING_WIRELESS_SECURITY_GET_PRIVATE (setting)->ft;
+}
+
+/**
+ * nm_setting_wireless_security_get_okc:
+ * @setting: the #NMSettingWirelessSecurity
+ *
+ * Returns: the #NMSettingWirelessSecurity:okc property of the setting
+ *
+ * Since: 1.10
+ **/
+int
+nm_setting_wireless_security_get_okc (NMSettingWirelessSecurity *setting)
+{
+	g_return_val_if_fail (NM_IS_SETTING_WIRELESS_SECURITY (setting), -1);
+
+	return NM_SETTING_WIRELESS_SECURITY_GET_PRIVATE (setting)->okc;
+}
+
 /**
  * nm_setting_wireless_security_get_wep_key:
  * @setting: the #NMSettingWirelessSecurity
@@ -1000,6 +1038,18 @@ verify (NMSetting *setting, NMConnection *connection, GError **error)
 		return FALSE;
 	}
 
+	if (   priv->ft == 1
+	    && !NM_IN_STRSET (priv->key_mgmt, "wpa-psk", "wpa-eap")) {
+		g_set_error (error,
+		             NM_CONNECTION_ERROR,
+		             NM_CONNECTION_ERROR_INVALID_PROPERTY,
+		             _("can only be enabled with '%s=%s' or '%s=%s'"),
+		             NM_SETTING_WIRELESS_SECURITY_KEY_MGMT, "wpa-psk",
+		             NM_SETTING_WIRELESS_SECURITY_KEY_MGMT, "wpa-eap");
+		g_prefix_error (error, "%s.%s: ", NM_SETTING_WIRELESS_SECURITY_SETTING_NAME, NM_SETTING_WIRELESS_SECURITY_FT);
+		return FALSE;
+	}
+
 	/* Shared Key auth can only be used with WEP */
 	if (priv->auth_alg && !strcmp (priv->auth_alg, "shared")) {
 		if (priv->key_mgmt && strcmp (priv->key_mgmt, "none")) {
@@ -1235,6 +1285,12 @@ set_property (GObject *object, guint prop_id,
 	case PROP_LEAP_PASSWORD_FLAGS:
 		priv->leap_password_flags = g_value_get_flags (value);
 		break;
+	case PROP_FT:
+		priv->ft = g_value_get_int (value);
+		break;
+	case PROP_OKC:
+		priv->okc = g_value_get_int (value);
+		break;
 	case PROP_WEP_KEY_TYPE:
 		priv->wep_key_type = g_value_get_enum (value);
 		break;
@@ -1300,6 +1356,12 @@ get_property (GObject *object, guint prop_id,
 	case PROP_LEAP_PASSWORD_FLAGS:
 		g_value_set_flags (value, priv->leap_password_flags);
 		break;
+	case PROP_FT:
+		g_value_set_int (value, priv->ft);
+		break;
+	case PROP_OKC:
+		g_value_set_int (value, priv->okc);
+		break;
 	case PROP_WEP_KEY_TYPE:
 		g_value_set_enum (value, priv->wep_key_type);
 		break;
@@ -1676,6 +1738,46 @@ nm_setting_wireless_security_class_init (NMSettingWirelessSecurityClass *setting
 		                     G_PARAM_READWRITE |
 		                     G_PARAM_STATIC_STRINGS));
 
+	/**
+	 * NMSettingWirelessSecurity:ft:
+	 *
+	 * Whether to allow IEEE 802.11r Fast BSS Transition when roaming between
+	 * access points of the same network. When enabled, the FT variant of the
+	 * WPA-PSK or WPA-EAP key management is offered in addition to the plain
+	 * one, so access points without 802.11r support can still be used.
+	 * It can only be enabled with the "wpa-psk" and "wpa-eap" key
+	 * management. 1 enables, 0 disables, -1 uses the default, which is
+	 * disabled.
+	 *
+	 * Since: 1.10
+	 **/
+	g_object_class_install_property
+		(object_class, PROP_FT,
+		 g_param_spec_int (NM_SETTING_WIRELESS_SECURITY_FT, "", "",
+		                   -1, 1, -1,
+		                   G_PARAM_READWRITE |
+		                   G_PARAM_CONSTRUCT |
+		                   G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * NMSettingWirelessSecurity:okc:
+	 *
+	 * Whether to use Opportunistic Key Caching (also called Proactive Key
+	 * Caching) for WPA-EAP, which lets cached PMKSA entries be reused with
+	 * other access points of the same network to avoid a full EAP exchange
+	 * when roaming. 1 enables, 0 disables, -1 uses the default, which is
+	 * enabled.
+	 *
+	 * Since: 1.10
+	 **/
+	g_object_class_install_property
+		(object_class, PROP_OKC,
+		 g_param_spec_int (NM_SETTING_WIRELESS_SECURITY_OKC, "", "",
+		                   -1, 1, -1,
+		                   G_PARAM_READWRITE |
+		                   G_PARAM_CONSTRUCT |
+		                   G_PARAM_STATIC_STRINGS));
+
 	/**
 	 * NMSettingWirelessSecurity:wep-key-type:
 	 *
@@ -88,6 +88,8 @@ typedef enum {
 #define NM_SETTING_WIRELESS_SECURITY_PSK_FLAGS "psk-flags"
 #define NM_SETTING_WIRELESS_SECURITY_LEAP_PASSWORD "leap-password"
 #define NM_SETTING_WIRELESS_SECURITY_LEAP_PASSWORD_FLAGS "leap-password-flags"
+#define NM_SETTING_WIRELESS_SECURITY_FT "ft"
+#define NM_SETTING_WIRELESS_SECURITY_OKC "okc"
 
 /**
  * NMSettingWirelessSecurity:
@@ -147,6 +149,11 @@ const char *nm_setting_wireless_security_get_auth_alg      (NMSettingWirelessSec
 NMSettingSecretFlags nm_setting_wireless_security_get_wep_key_flags (NMSettingWirelessSecurity *setting);
 NMWepKeyType nm_setting_wireless_security_get_wep_key_type (NMSettingWirelessSecurity *setting);
 
+NM_AVAILABLE_IN_1_10
+int         nm_setting_wireless_security_get_ft            (NMSettingWirelessSecurity *setting);
+NM_AVAILABLE_IN_1_10
+int         nm_setting_wireless_security_get_okc           (NMSettingWirelessSecurity *setting);
+
 G_END_DECLS
 
 #endif /* __NM_SETTING_WIRELESS_SECURITY_H__ */
@@ -61,6 +61,7 @@ typedef struct {
 	const char *name;
 	GType type;
 	guint32 priority;
+	guint slot;
 } SettingInfo;
 
 typedef struct {
@@ -78,6 +79,7 @@ enum {
 
 static GHashTable *registered_settings = NULL;
 static GHashTable *registered_settings_by_type = NULL;
+static guint registered_settings_slots = 0;
 
 static gboolean
 _nm_gtype_equal (gconstpointer v1, gconstpointer v2)
@@ -174,10 +176,15 @@ void
 	if (priority == 0)
 		g_assert_cmpstr (name, ==, NM_SETTING_CONNECTION_SETTING_NAME);
 
+	/* registering happens while the type gets registered, that is,
+	 * under GLib's type lock. */
+	g_assert (registered_settings_slots < _NM_SETTING_SLOT_MAX);
+
 	info = g_slice_new0 (SettingInfo);
 	info->type = type;
 	info->priority = priority;
 	info->name = name;
+	info->slot = registered_settings_slots++;
 	g_hash_table_insert (registered_settings, (void *) info->name, info);
 	g_hash_table_insert (registered_settings_by_type, &info->type, info);
 }
@@ -189,6 +196,44 @@ _nm_setting_lookup_setting_by_type (GType type)
 	return g_hash_table_lookup (registered_settings_by_type, &type);
 }
 
+/**
+ * _nm_setting_type_get_slot:
+ * @type: the #GType of a setting
+ *
+ * Each registered setting type gets a small number, below
+ * %_NM_SETTING_SLOT_MAX and unique within the process, so that
+ * #NMConnection can keep its settings in an array.
+ *
+ * Returns: the slot of @type, or -1 if @type is not a registered
+ *   setting type.
+ */
+int
+_nm_setting_type_get_slot (GType type)
+{
+	const SettingInfo *info;
+
+	info = _nm_setting_lookup_setting_by_type (type);
+	return info ? (int) info->slot : -1;
+}
+
+/**
+ * _nm_setting_get_slot:
+ * @setting: the #NMSetting
+ *
+ * Returns: the slot of the type of @setting, see _nm_setting_type_get_slot().
+ */
+int
+_nm_setting_get_slot (NMSetting *setting)
+{
+	NMSettingPrivate *priv;
+
+	nm_assert (NM_IS_SETTING (setting));
+
+	priv = NM_SETTING_GET_PRIVATE (setting);
+	_ensure_setting_info (setting, priv);
+	return priv->info->slot;
+}
+
 static guint32
 _get_setting_type_priority (GType type)
 {
@@ -303,10 +348,15 @@ typedef struct {
 
 	NMSettingPropertyTransformToFunc to_dbus;
 	NMSettingPropertyTransformFromFunc from_dbus;
+
+	/* whether compare_property() can compare the GObject values directly,
+	 * instead of converting them to D-Bus first. */
+	bool compare_direct;
 } NMSettingProperty;
 
 static NM_CACHED_QUARK_FCN ("nm-setting-property-overrides", setting_property_overrides_quark)
 static NM_CACHED_QUARK_FCN ("nm-setting-properties", setting_properties_quark)
+static NM_CACHED_QUARK_FCN ("nm-setting-properties-index", setting_properties_index_quark)
 
 static NMSettingProperty *
 find_property (GArray *properties, const char *name)
@@ -528,6 +578,7 @@ nm_setting_class_ensure_properties (NMSettingClass *setting_class)
 	GType type = G_TYPE_FROM_CLASS (setting_class), otype;
 	NMSettingProperty property, *override;
 	GArray *overrides, *type_overrides, *properties;
+	GHashTable *index;
 	GParamSpec **property_specs;
 	guint n_property_specs, i;
 
@@ -561,6 +612,32 @@ nm_setting_class_ensure_properties (NMSettingClass *setting_class)
 	}
 	g_free (property_specs);
 
+	for (i = 0; i < properties->len; i++) {
+		NMSettingProperty *p = &g_array_index (properties, NMSettingProperty, i);
+		GType value_type;
+
+		if (   !p->param_spec
+		    || p->get_func
+		    || p->synth_func
+		    || p->to_dbus
+		    || p->dbus_type)
+			continue;
+
+		value_type = G_TYPE_FUNDAMENTAL (p->param_spec->value_type);
+		p->compare_direct = NM_IN_SET (value_type,
+		                               G_TYPE_BOOLEAN,
+		                               G_TYPE_CHAR,
+		                               G_TYPE_UCHAR,
+		                               G_TYPE_INT,
+		                               G_TYPE_UINT,
+		                               G_TYPE_INT64,
+		                               G_TYPE_UINT64,
+		                               G_TYPE_DOUBLE,
+		                               G_TYPE_ENUM,
+		                               G_TYPE_FLAGS,
+		                               G_TYPE_STRING);
+	}
+
 	/* Add any remaining overrides not corresponding to GObject properties */
 	for (i = 0; i < overrides->len; i++) {
 		override = &g_array_index (overrides, NMSettingProperty, i);
@@ -569,10 +646,29 @@ nm_setting_class_ensure_properties (NMSettingClass *setting_class)
 	}
 	g_array_unref (overrides);
 
+	/* map the property names to their position + 1, so that looking up
+	 * the keys of a setting dictionary doesn't scan all properties. */
+	index = g_hash_table_new (g_str_hash, g_str_equal);
+	for (i = 0; i < properties->len; i++) {
+		g_hash_table_insert (index,
+		                     (gpointer) g_array_index (properties, NMSettingProperty, i).name,
+		                     GUINT_TO_POINTER (i + 1));
+	}
+
+	g_type_set_qdata (type, setting_properties_index_quark (), index);
 	g_type_set_qdata (type, setting_properties_quark (), properties);
 	return properties;
 }
 
+/* returns a hash of the property names to the position of the property
+ * in nm_setting_class_get_properties() + 1. */
+static GHashTable *
+nm_setting_class_get_properties_index (NMSettingClass *setting_class)
+{
+	nm_setting_class_ensure_properties (setting_class);
+	return g_type_get_qdata (G_TYPE_FROM_CLASS (setting_class), setting_properties_index_quark ());
+}
+
 static const NMSettingProperty *
 nm_setting_class_get_properties (NMSettingClass *setting_class, guint *n_properties)
 {
@@ -588,9 +684,12 @@ static const NMSettingProperty *
 nm_setting_class_find_property (NMSettingClass *setting_class, const char *property_name)
 {
 	GArray *properties;
+	guint idx;
 
 	properties = nm_setting_class_ensure_properties (setting_class);
-	return find_property (properties, property_name);
+	idx = GPOINTER_TO_UINT (g_hash_table_lookup (nm_setting_class_get_properties_index (setting_class),
+	                                             property_name));
+	return idx ? &g_array_index (properties, NMSettingProperty, idx - 1) : NULL;
 }
 
 /*****************************************************************************/
@@ -768,6 +867,13 @@ _nm_setting_to_dbus (NMSetting *setting, NMConnection *connection, NMConnectionS
 	return g_variant_builder_end (&builder);
 }
 
+static void
+_variant_unref0 (gpointer value)
+{
+	if (value)
+		g_variant_unref (value);
+}
+
 /**
  * _nm_setting_new_from_dbus:
  * @setting_type: the #NMSetting type which the hash contains properties for
@@ -797,8 +903,13 @@ _nm_setting_new_from_dbus (GType setting_type,
 {
 	gs_unref_object NMSetting *setting = NULL;
 	gs_unref_hashtable GHashTable *keys = NULL;
+	gs_unref_ptrarray GPtrArray *values = NULL;
 	const NMSettingProperty *properties;
+	GHashTable *properties_index;
 	guint i, n_properties;
+	GVariantIter dict_iter;
+	const char *dict_key;
+	GVariant *dict_value;
 
 	g_return_val_if_fail (G_TYPE_IS_INSTANTIATABLE (setting_type), NULL);
 	g_return_val_if_fail (g_variant_is_of_type (setting_dict, NM_VARIANT_TYPE_SETTING), NULL);
@@ -843,16 +954,33 @@ _nm_setting_new_from_dbus (GType setting_type,
 	}
 
 	properties = nm_setting_class_get_properties (NM_SETTING_GET_CLASS (setting), &n_properties);
+	properties_index = nm_setting_class_get_properties_index (NM_SETTING_GET_CLASS (setting));
+
+	/* sort the values of @setting_dict by property with a single pass,
+	 * instead of searching the dictionary for each property. Like
+	 * g_variant_lookup_value(), the first of duplicate keys wins. */
+	values = g_ptr_array_new_full (n_properties, _variant_unref0);
+	g_ptr_array_set_size (values, n_properties);
+	g_variant_iter_init (&dict_iter, setting_dict);
+	while (g_variant_iter_next (&dict_iter, "{&sv}", &dict_key, &dict_value)) {
+		guint idx = GPOINTER_TO_UINT (g_hash_table_lookup (properties_index, dict_key));
+
+		if (idx && !values->pdata[idx - 1])
+			values->pdata[idx - 1] = dict_value;
+		else
+			g_variant_unref (dict_value);
+	}
+
 	for (i = 0; i < n_properties; i++) {
 		const NMSettingProperty *property = &properties[i];
 		gs_unref_variant GVariant *value = NULL;
 		gs_free_error GError *local = NULL;
 
+		value = g_steal_pointer (&values->pdata[i]);
+
 		if (property->param_spec && !(property->param_spec->flags & G_PARAM_WRITABLE))
 			continue;
 
-		value = g_variant_lookup_value (setting_dict, property->name, NULL);
-
 		if (value && keys)
 			g_hash_table_remove (keys, property->name);
 
@@ -1180,6 +1308,22 @@ compare_property (NMSetting *setting,
 	property = nm_setting_class_find_property (NM_SETTING_GET_CLASS (setting), prop_spec->name);
 	g_return_val_if_fail (property != NULL, FALSE);
 
+	if (property->compare_direct) {
+		GValue v1 = G_VALUE_INIT;
+		GValue v2 = G_VALUE_INIT;
+
+		/* Plain values compare the same as their D-Bus form. Skip
+		 * building the GVariants. */
+		g_value_init (&v1, prop_spec->value_type);
+		g_value_init (&v2, prop_spec->value_type);
+		g_object_get_property (G_OBJECT (setting), prop_spec->name, &v1);
+		g_object_get_property (G_OBJECT (other), prop_spec->name, &v2);
+		cmp = g_param_values_cmp ((GParamSpec *) prop_spec, &v1, &v2);
+		g_value_unset (&v1);
+		g_value_unset (&v2);
+		return cmp == 0;
+	}
+
 	value1 = get_property_for_dbus (setting, property, TRUE);
 	value2 = get_property_for_dbus (other, property, TRUE);
 
@@ -1210,8 +1354,8 @@ nm_setting_compare (NMSetting *a,
                     NMSetting *b,
                     NMSettingCompareFlags flags)
 {
-	GParamSpec **property_specs;
-	guint n_property_specs;
+	const NMSettingProperty *properties;
+	guint n_properties;
 	gint same = TRUE;
 	guint i;
 
@@ -1223,9 +1367,12 @@ nm_setting_compare (NMSetting *a,
 		return FALSE;
 
 	/* And now all properties */
-	property_specs = g_object_class_list_properties (G_OBJECT_GET_CLASS (a), &n_property_specs);
-	for (i = 0; i < n_property_specs && same; i++) {
-		GParamSpec *prop_spec = property_specs[i];
+	properties = nm_setting_class_get_properties (NM_SETTING_GET_CLASS (a), &n_properties);
+	for (i = 0; i < n_properties && same; i++) {
+		GParamSpec *prop_spec = properties[i].param_spec;
+
+		if (!prop_spec)
+			continue;
 
 		/* Fuzzy compare ignores secrets and properties defined with the FUZZY_IGNORE flag */
 		if (   NM_FLAGS_HAS (flags, NM_SETTING_COMPARE_FLAG_FUZZY)
@@ -1246,7 +1393,6 @@ nm_setting_compare (NMSetting *a,
 
 		same = NM_SETTING_GET_CLASS (a)->compare_property (a, b, prop_spec, flags);
 	}
-	g_free (property_specs);
 
 	return same;
 }
@@ -1335,8 +1481,8 @@ nm_setting_diff (NMSetting *a,
                  gboolean invert_results,
                  GHashTable **results)
 {
-	GParamSpec **property_specs;
-	guint n_property_specs;
+	const NMSettingProperty *properties;
+	guint n_properties;
 	guint i;
 	NMSettingDiffResult a_result = NM_SETTING_DIFF_RESULT_IN_A;
 	NMSettingDiffResult b_result = NM_SETTING_DIFF_RESULT_IN_B;
@@ -1379,12 +1525,15 @@ nm_setting_diff (NMSetting *a,
 	}
 
 	/* And now all properties */
-	property_specs = g_object_class_list_properties (G_OBJECT_GET_CLASS (a), &n_property_specs);
+	properties = nm_setting_class_get_properties (NM_SETTING_GET_CLASS (a), &n_properties);
 
-	for (i = 0; i < n_property_specs; i++) {
-		GParamSpec *prop_spec = property_specs[i];
+	for (i = 0; i < n_properties; i++) {
+		GParamSpec *prop_spec = properties[i].param_spec;
 		NMSettingDiffResult r = NM_SETTING_DIFF_RESULT_UNKNOWN;
 
+		if (!prop_spec)
+			continue;
+
 		/* Handle compare flags */
 		if (!should_compare_prop (a, prop_spec->name, flags, prop_spec->flags))
 			continue;
@@ -1446,7 +1595,6 @@ nm_setting_diff (NMSetting *a,
 				g_hash_table_insert (*results, g_strdup (prop_spec->name), GUINT_TO_POINTER (r));
 		}
 	}
-	g_free (property_specs);
 
 	/* Don't return an empty hash table */
 	if (results_created && !g_hash_table_size (*results)) {
@@ -1484,6 +1632,33 @@ _enumerate_values_sort (GParamSpec **p_a, GParamSpec **p_b, GType *p_type)
 }
 #undef CMP_AND_RETURN
 
+/**
+ * _nm_setting_list_properties_sorted:
+ * @setting: the #NMSetting
+ * @out_len: (out): the number of properties
+ *
+ * Returns: (transfer container): the property specs of @setting in the
+ *   order in which nm_setting_enumerate_values() visits them. Unlike
+ *   the latter, this doesn't fetch the value of each property, which
+ *   is wasted effort when only the types matter.
+ */
+GParamSpec **
+_nm_setting_list_properties_sorted (NMSetting *setting, guint *out_len)
+{
+	GParamSpec **property_specs;
+	GType type;
+
+	g_return_val_if_fail (NM_IS_SETTING (setting), NULL);
+	g_return_val_if_fail (out_len, NULL);
+
+	property_specs = g_object_class_list_properties (G_OBJECT_GET_CLASS (setting), out_len);
+
+	type = G_OBJECT_TYPE (setting);
+	g_qsort_with_data (property_specs, *out_len, sizeof (gpointer),
+	                   (GCompareDataFunc) _enumerate_values_sort, &type);
+	return property_specs;
+}
+
 /**
  * nm_setting_enumerate_values:
  * @setting: the #NMSetting
@@ -1501,18 +1676,13 @@ nm_setting_enumerate_values (NMSetting *setting,
 	GParamSpec **property_specs;
 	guint n_property_specs;
 	int i;
-	GType type;
 
 	g_return_if_fail (NM_IS_SETTING (setting));
 	g_return_if_fail (func != NULL);
 
-	property_specs = g_object_class_list_properties (G_OBJECT_GET_CLASS (setting), &n_property_specs);
-
 	/* sort the properties. This has an effect on the order in which keyfile
 	 * prints them. */
-	type = G_OBJECT_TYPE (setting);
-	g_qsort_with_data (property_specs, n_property_specs, sizeof (gpointer),
-	                   (GCompareDataFunc) _enumerate_values_sort, &type);
+	property_specs = _nm_setting_list_properties_sorted (setting, &n_property_specs);
 
 	for (i = 0; i < n_property_specs; i++) {
 		GParamSpec *prop_spec = property_specs[i];
@@ -2969,6 +2969,16 @@ nm_utils_hwaddr_len (int type)
 	g_return_val_if_reached (0);
 }
 
+/* the value of each hexadecimal digit plus one, zero for all other
+ * characters. That way, a single lookup both checks and converts
+ * a character. */
+static const guint8 _hexval1[256] = {
+	['0'] =  1, ['1'] =  2, ['2'] =  3, ['3'] =  4, ['4'] =  5,
+	['5'] =  6, ['6'] =  7, ['7'] =  8, ['8'] =  9, ['9'] = 10,
+	['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16,
+	['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16,
+};
+
 static guint8 *
 _str2bin (const char *asc,
           gboolean delimiter_required,
@@ -2988,25 +2998,25 @@ _str2bin (const char *asc,
 	nm_assert (out_len);
 
 	while (TRUE) {
-		const guint8 d1 = in[0];
+		const guint8 v1 = _hexval1[(guint8) in[0]];
+		guint8 v2;
 		guint8 d2;
 
-		if (!g_ascii_isxdigit (d1))
+		if (!v1)
 			return NULL;
 
-#define HEXVAL(c) ((c) <= '9' ? (c) - '0' : ((c) & 0x4F) - ('A' - 10))
-
 		/* If there's no leading zero (ie "aa:b:cc") then fake it */
 		d2 = in[1];
-		if (d2 && g_ascii_isxdigit (d2)) {
-			*out++ = (HEXVAL (d1) << 4) + HEXVAL (d2);
+		v2 = _hexval1[d2];
+		if (v2) {
+			*out++ = ((v1 - 1) << 4) + (v2 - 1);
 			d2 = in[2];
 			if (!d2)
 				break;
 			in += 2;
 		} else {
 			/* Fake leading zero */
-			*out++ = HEXVAL (d1);
+			*out++ = v1 - 1;
 			if (!d2) {
 				if (!delimiter_has) {
 					/* when using no delimiter, there must be pairs of hex chars */
@@ -3789,6 +3799,101 @@ nm_utils_is_uuid (const char *str)
 
 static char _nm_utils_inet_ntop_buffer[NM_UTILS_INET_ADDRSTRLEN];
 
+/* Format the addresses by hand instead of calling inet_ntop(), which
+ * goes through sprintf() for every octet and word. The output is
+ * identical to glibc's. */
+static char *
+_inet4_fmt (const guint8 *a, char *p)
+{
+	guint i;
+
+	for (i = 0; i < 4; i++) {
+		guint v = a[i];
+
+		if (i > 0)
+			*p++ = '.';
+		if (v >= 100) {
+			*p++ = '0' + (v / 100);
+			v %= 100;
+			*p++ = '0' + (v / 10);
+			v %= 10;
+		} else if (v >= 10) {
+			*p++ = '0' + (v / 10);
+			v %= 10;
+		}
+		*p++ = '0' + v;
+	}
+	*p = '\0';
+	return p;
+}
+
+static void
+_inet6_fmt (const guint8 *a, char *p)
+{
+	static const char HEX[] = "0123456789abcdef";
+	guint16 words[8];
+	int best_base = -1, best_len = 0;
+	int cur_base = -1, cur_len = 0;
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		words[i] = (((guint16) a[2 * i]) << 8) | a[2 * i + 1];
+		if (words[i] == 0) {
+			if (cur_base == -1) {
+				cur_base = i;
+				cur_len = 1;
+			} else
+				cur_len++;
+		} else if (cur_base != -1) {
+			if (cur_len > best_len) {
+				best_base = cur_base;
+				best_len = cur_len;
+			}
+			cur_base = -1;
+		}
+	}
+	if (   cur_base != -1
+	    && cur_len > best_len) {
+		best_base = cur_base;
+		best_len = cur_len;
+	}
+	if (best_len < 2)
+		best_base = -1;
+
+	for (i = 0; i < 8; i++) {
+		guint16 w = words[i];
+		int shift;
+
+		if (   best_base != -1
+		    && i >= best_base
+		    && i < best_base + best_len) {
+			if (i == best_base)
+				*p++ = ':';
+			continue;
+		}
+		if (i > 0)
+			*p++ = ':';
+
+		/* IPv4-compatible and IPv4-mapped addresses */
+		if (   i == 6
+		    && best_base == 0
+		    && (   best_len == 6
+		        || (best_len == 5 && words[5] == 0xffff))) {
+			_inet4_fmt (&a[12], p);
+			return;
+		}
+
+		for (shift = 12; shift > 0 && !(w >> shift); shift -= 4)
+			;
+		for (; shift >= 0; shift -= 4)
+			*p++ = HEX[(w >> shift) & 0xF];
+	}
+	if (   best_base != -1
+	    && best_base + best_len == 8)
+		*p++ = ':';
+	*p = '\0';
+}
+
 /**
  * nm_utils_inet4_ntop: (skip)
  * @inaddr: the address that should be converted to string.
@@ -3801,7 +3906,7 @@ static char _nm_utils_inet_ntop_buffer[NM_UTILS_INET_ADDRSTRLEN];
  *  using the internal buffer is not thread safe. When in doubt, pass your own
  *  @dst buffer to avoid these issues.
  *
- * Wrapper for inet_ntop.
+ * Like inet_ntop() for %AF_INET.
  *
  * Returns: the input buffer @dst, or a pointer to an
  *  internal, static buffer. This function cannot fail.
@@ -3809,8 +3914,10 @@ static char _nm_utils_inet_ntop_buffer[NM_UTILS_INET_ADDRSTRLEN];
 const char *
 nm_utils_inet4_ntop (in_addr_t inaddr, char *dst)
 {
-	return inet_ntop (AF_INET, &inaddr, dst ? dst : _nm_utils_inet_ntop_buffer,
-	                  INET_ADDRSTRLEN);
+	if (!dst)
+		dst = _nm_utils_inet_ntop_buffer;
+	_inet4_fmt ((const guint8 *) &inaddr, dst);
+	return dst;
 }
 
 /**
@@ -3825,7 +3932,7 @@ nm_utils_inet4_ntop (in_addr_t inaddr, char *dst)
  *  using the internal buffer is not thread safe. When in doubt, pass your own
  *  @dst buffer to avoid these issues.
  *
- * Wrapper for inet_ntop.
+ * Like inet_ntop() for %AF_INET6.
  *
  * Returns: the input buffer @dst, or a pointer to an
  *  internal, static buffer. %NULL is not allowed as @in6addr,
@@ -3835,8 +3942,11 @@ const char *
 nm_utils_inet6_ntop (const struct in6_addr *in6addr, char *dst)
 {
 	g_return_val_if_fail (in6addr, NULL);
-	return inet_ntop (AF_INET6, in6addr, dst ? dst : _nm_utils_inet_ntop_buffer,
-	                  INET6_ADDRSTRLEN);
+
+	if (!dst)
+		dst = _nm_utils_inet_ntop_buffer;
+	_inet6_fmt ((const guint8 *) in6addr, dst);
+	return dst;
 }
 
 /**
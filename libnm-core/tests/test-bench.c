@@ -0,0 +1,328 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright 2017 Red Hat, Inc.
+ */
+
+/* Microbenchmarks for the common operations on connections.
+ *
+ * This is not run by "make check". Run it by hand, optionally with
+ * NMTST_BENCH_ITERATIONS set. Each benchmark prints one line
+ *
+ *   bench<TAB>profile<TAB>operation<TAB>iterations<TAB>ns-per-op
+ *
+ * to stdout, so that the results can be collected and compared. */
+
+#include "nm-default.h"
+
+#include "nm-core-internal.h"
+#include "nm-keyfile-internal.h"
+#include "nm-simple-connection.h"
+#include "nm-setting-connection.h"
+
+#include "nm-utils/nm-test-utils.h"
+
+/*****************************************************************************/
+
+typedef struct {
+	const char *name;
+	const char *keyfile_str;
+
+	/* the setting that "setting-duplicate" measures */
+	const char *setting_name;
+} BenchProfile;
+
+static char *
+_profile_many_routes (void)
+{
+	GString *str;
+	guint i;
+
+	str = g_string_new ("[connection]\n"
+	                    "id=many-routes\n"
+	                    "uuid=7a7b6d1e-5c1d-4f12-9c51-3b8ff5b2a6a4\n"
+	                    "type=ethernet\n"
+	                    "interface-name=eth0\n"
+	                    "[ipv4]\n"
+	                    "method=manual\n"
+	                    "address1=192.168.1.5/24,192.168.1.1\n");
+	for (i = 1; i <= 256; i++)
+		g_string_append_printf (str, "route%u=10.%u.%u.0/24,192.168.1.1,%u\n", i, i / 256, i % 256, i);
+	g_string_append (str,
+	                 "[ipv6]\n"
+	                 "method=auto\n");
+	return g_string_free (str, FALSE);
+}
+
+static const BenchProfile profiles[] = {
+	{
+		.name = "bond",
+		.setting_name = NM_SETTING_BOND_SETTING_NAME,
+		.keyfile_str = "[connection]\n"
+		               "id=bond0\n"
+		               "uuid=2b0fa0d8-3c3e-4a4b-8e71-9d7a2c7b4e10\n"
+		               "type=bond\n"
+		               "interface-name=bond0\n"
+		               "[bond]\n"
+		               "mode=802.3ad\n"
+		               "miimon=100\n"
+		               "lacp_rate=fast\n"
+		               "xmit_hash_policy=layer3+4\n"
+		               "[ipv4]\n"
+		               "method=auto\n"
+		               "[ipv6]\n"
+		               "method=auto\n",
+	},
+	{
+		.name = "team",
+		.setting_name = NM_SETTING_TEAM_SETTING_NAME,
+		.keyfile_str = "[connection]\n"
+		               "id=team0\n"
+		               "uuid=5d8b3c3e-7b6f-4e5a-9a1c-1f2e3d4c5b6a\n"
+		               "type=team\n"
+		               "interface-name=team0\n"
+		               "[team]\n"
+		               "config={\"runner\": {\"name\": \"activebackup\"}, \"link_watch\": {\"name\": \"ethtool\"}}\n"
+		               "[ipv4]\n"
+		               "method=auto\n"
+		               "[ipv6]\n"
+		               "method=auto\n",
+	},
+	{
+		.name = "8021x",
+		.setting_name = NM_SETTING_802_1X_SETTING_NAME,
+		.keyfile_str = "[connection]\n"
+		               "id=corp-wired\n"
+		               "uuid=9e1f3a2b-4c5d-4e6f-8a7b-0c1d2e3f4a5b\n"
+		               "type=ethernet\n"
+		               "[ethernet]\n"
+		               "mac-address=00:11:22:33:44:55\n"
+		               "[802-1x]\n"
+		               "eap=ttls;peap;\n"
+		               "identity=user@example.com\n"
+		               "anonymous-identity=anonymous@example.com\n"
+		               "phase2-auth=mschapv2\n"
+		               "password=secret\n"
+		               "[ipv4]\n"
+		               "method=auto\n"
+		               "[ipv6]\n"
+		               "method=auto\n",
+	},
+	{
+		.name = "many-routes",
+		.keyfile_str = NULL,
+		.setting_name = NM_SETTING_IP4_CONFIG_SETTING_NAME,
+	},
+};
+
+/*****************************************************************************/
+
+#define BENCH(profile, op, stmt) \
+	G_STMT_START { \
+		const guint _iterations = nmtst_bench_iterations (1000, G_MAXINT32); \
+		gint64 _start; \
+		guint _i; \
+		\
+		_start = g_get_monotonic_time (); \
+		for (_i = 0; _i < _iterations; _i++) { \
+			stmt; \
+		} \
+		nmtst_bench_report ((profile), (op), _iterations, _start); \
+	} G_STMT_END
+
+static void
+_enumerate_values_noop (NMSetting *setting,
+                        const char *key,
+                        const GValue *value,
+                        GParamFlags flags,
+                        gpointer user_data)
+{
+}
+
+static void
+test_bench_profile (gconstpointer test_data)
+{
+	const BenchProfile *profile = test_data;
+	gs_free char *keyfile_str_free = NULL;
+	gs_unref_object NMConnection *con = NULL;
+	gs_unref_object NMConnection *con2 = NULL;
+	gs_unref_variant GVariant *dict = NULL;
+	gs_unref_keyfile GKeyFile *keyfile = NULL;
+	NMSetting *setting;
+
+	if (!profile->keyfile_str)
+		keyfile_str_free = _profile_many_routes ();
+
+	con = nmtst_create_connection_from_keyfile (profile->keyfile_str ?: keyfile_str_free,
+	                                            "/test_bench", NULL);
+	con2 = nmtst_clone_connection (con);
+	dict = nm_connection_to_dbus (con, NM_CONNECTION_SERIALIZE_ALL);
+	g_variant_ref_sink (dict);
+	keyfile = nm_keyfile_write (con, NULL, NULL, NULL);
+	g_assert (keyfile);
+	setting = nm_connection_get_setting_by_name (con, profile->setting_name);
+	g_assert (setting);
+
+	BENCH (profile->name, "new-from-dbus", ({
+		gs_unref_object NMConnection *c = NULL;
+
+		c = nm_simple_connection_new_from_dbus (dict, NULL);
+		g_assert (c);
+	}));
+
+	BENCH (profile->name, "to-dbus", ({
+		gs_unref_variant GVariant *v = NULL;
+
+		v = nm_connection_to_dbus (con, NM_CONNECTION_SERIALIZE_ALL);
+		g_variant_ref_sink (v);
+	}));
+
+	BENCH (profile->name, "verify", ({
+		g_assert (nm_connection_verify (con, NULL));
+	}));
+
+	BENCH (profile->name, "normalize", ({
+		g_assert (nm_connection_normalize (con2, NULL, NULL, NULL));
+	}));
+
+	BENCH (profile->name, "compare", ({
+		g_assert (nm_connection_compare (con, con2, NM_SETTING_COMPARE_FLAG_EXACT));
+	}));
+
+	BENCH (profile->name, "diff", ({
+		gs_unref_hashtable GHashTable *diffs = NULL;
+
+		g_assert (nm_connection_diff (con, con2, NM_SETTING_COMPARE_FLAG_EXACT, &diffs));
+	}));
+
+	BENCH (profile->name, "keyfile-read", ({
+		gs_unref_object NMConnection *c = NULL;
+
+		c = nm_keyfile_read (keyfile, "/test_bench", NULL, NULL, NULL, NULL);
+		g_assert (c);
+	}));
+
+	BENCH (profile->name, "keyfile-write", ({
+		gs_unref_keyfile GKeyFile *kf = NULL;
+
+		kf = nm_keyfile_write (con, NULL, NULL, NULL);
+		g_assert (kf);
+	}));
+
+	/* the keyfile reader walks the property specs of each setting it
+	 * reads. Compare with fetching every value, as it did before. */
+	BENCH (profile->name, "setting-list-properties", ({
+		gs_free GParamSpec **specs = NULL;
+		guint n;
+
+		specs = _nm_setting_list_properties_sorted (setting, &n);
+		g_assert (specs);
+	}));
+
+	BENCH (profile->name, "setting-enumerate-values", ({
+		nm_setting_enumerate_values (setting, _enumerate_values_noop, NULL);
+	}));
+
+	BENCH (profile->name, "setting-duplicate", ({
+		gs_unref_object NMSetting *s = NULL;
+
+		s = nm_setting_duplicate (setting);
+		g_assert (s);
+	}));
+}
+
+/*****************************************************************************/
+
+static void
+test_bench_utils (void)
+{
+	static const char *const hwaddrs[] = {
+		"00:11:22:33:44:55",
+		"AA:BB:CC:DD:EE:FF",
+		"0:1:2:3:4:5",
+		"00-1b-21-3c-9d-f8",
+		"80:00:02:08:fe:80:00:00:00:00:00:00:00:02:c9:03:00:11:22:33",
+	};
+	struct in6_addr in6[4];
+	in_addr_t in4[4];
+	guint8 bin[G_N_ELEMENTS (hwaddrs)][NM_UTILS_HWADDR_LEN_MAX];
+	gsize bin_len[G_N_ELEMENTS (hwaddrs)];
+	char buf[NM_UTILS_HWADDR_LEN_MAX * 3];
+	char addr_buf[NM_UTILS_INET_ADDRSTRLEN];
+	guint j;
+
+	for (j = 0; j < G_N_ELEMENTS (hwaddrs); j++)
+		g_assert (_nm_utils_hwaddr_aton (hwaddrs[j], bin[j], sizeof (bin[j]), &bin_len[j]));
+
+	in4[0] = nmtst_inet4_from_string ("192.168.1.1");
+	in4[1] = nmtst_inet4_from_string ("10.0.0.254");
+	in4[2] = nmtst_inet4_from_string ("8.8.4.4");
+	in4[3] = nmtst_inet4_from_string ("255.255.255.0");
+	in6[0] = *nmtst_inet6_from_string ("fe80::211:22ff:fe33:4455");
+	in6[1] = *nmtst_inet6_from_string ("2001:db8:85a3::8a2e:370:7334");
+	in6[2] = *nmtst_inet6_from_string ("::1");
+	in6[3] = *nmtst_inet6_from_string ("::ffff:192.168.1.1");
+
+	BENCH ("utils", "hwaddr-aton", ({
+		for (j = 0; j < G_N_ELEMENTS (hwaddrs); j++) {
+			gsize l;
+
+			g_assert (_nm_utils_hwaddr_aton (hwaddrs[j], buf, sizeof (buf), &l));
+		}
+	}));
+
+	BENCH ("utils", "hwaddr-ntoa", ({
+		for (j = 0; j < G_N_ELEMENTS (hwaddrs); j++)
+			nm_utils_hwaddr_ntoa_buf (bin[j], bin_len[j], TRUE, buf, sizeof (buf));
+	}));
+
+	BENCH ("utils", "hwaddr-matches", ({
+		for (j = 0; j < G_N_ELEMENTS (hwaddrs); j++) {
+			g_assert (nm_utils_hwaddr_matches (hwaddrs[j], -1, bin[j], bin_len[j]));
+			g_assert (nm_utils_hwaddr_matches (bin[j], bin_len[j], bin[j], bin_len[j]));
+		}
+	}));
+
+	BENCH ("utils", "inet4-ntop", ({
+		for (j = 0; j < G_N_ELEMENTS (in4); j++)
+			nm_utils_inet4_ntop (in4[j], addr_buf);
+	}));
+
+	BENCH ("utils", "inet6-ntop", ({
+		for (j = 0; j < G_N_ELEMENTS (in6); j++)
+			nm_utils_inet6_ntop (&in6[j], addr_buf);
+	}));
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE ();
+
+int main (int argc, char **argv)
+{
+	guint i;
+
+	nmtst_init (&argc, &argv, TRUE);
+
+	for (i = 0; i < G_N_ELEMENTS (profiles); i++) {
+		gs_free char *path = g_strdup_printf ("/core/bench/%s", profiles[i].name);
+
+		g_test_add_data_func (path, &profiles[i], test_bench_profile);
+	}
+	g_test_add_func ("/core/bench/utils", test_bench_utils);
+
+	return g_test_run ();
+}
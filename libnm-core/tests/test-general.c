@@ -40,6 +40,7 @@
 #include "nm-setting-bridge-port.h"
 #include "nm-setting-cdma.h"
 #include "nm-setting-connection.h"
+#include "nm-setting-ethtool.h"
 #include "nm-setting-generic.h"
 #include "nm-setting-gsm.h"
 #include "nm-setting-infiniband.h"
@@ -795,6 +796,121 @@ test_setting_gsm_sim_operator_id (void)
 	                                   NM_CONNECTION_ERROR_INVALID_PROPERTY);
 }
 
+static void
+test_setting_ethtool_defaults (void)
+{
+	gs_unref_object NMSettingEthtool *s_ethtool = NULL;
+
+	s_ethtool = (NMSettingEthtool *) nm_setting_ethtool_new ();
+
+	/* the defaults leave the driver untouched */
+	g_assert_cmpuint (nm_setting_ethtool_get_ring_rx (s_ethtool), ==, 0);
+	g_assert_cmpuint (nm_setting_ethtool_get_ring_tx (s_ethtool), ==, 0);
+	g_assert_cmpuint (nm_setting_ethtool_get_channels_combined (s_ethtool), ==, 0);
+	g_assert_cmpint (nm_setting_ethtool_get_coalesce_rx_usecs (s_ethtool), ==, -1);
+	g_assert_cmpint (nm_setting_ethtool_get_coalesce_tx_usecs (s_ethtool), ==, -1);
+	g_assert_cmpint (nm_setting_ethtool_get_offload_gro (s_ethtool), ==, -1);
+	g_assert_cmpint (nm_setting_ethtool_get_offload_tso (s_ethtool), ==, -1);
+	g_assert_cmpint (nm_setting_ethtool_get_offload_lro (s_ethtool), ==, -1);
+	g_assert_cmpstr (nm_setting_ethtool_get_rps_cpus (s_ethtool), ==, NULL);
+	g_assert_cmpstr (nm_setting_ethtool_get_xps_cpus (s_ethtool), ==, NULL);
+	g_assert_cmpstr (nm_setting_ethtool_get_irq_affinity (s_ethtool), ==, NULL);
+
+	nmtst_assert_setting_verifies (NM_SETTING (s_ethtool));
+}
+
+static void
+test_setting_ethtool_verify (void)
+{
+	gs_unref_object NMSettingEthtool *s_ethtool = NULL;
+
+	s_ethtool = (NMSettingEthtool *) nm_setting_ethtool_new ();
+
+	g_object_set (s_ethtool,
+	              NM_SETTING_ETHTOOL_RPS_CPUS, "ff,0000000f",
+	              NM_SETTING_ETHTOOL_XPS_CPUS, "A0",
+	              NM_SETTING_ETHTOOL_IRQ_AFFINITY, NM_SETTING_ETHTOOL_CPUS_NUMA,
+	              NULL);
+	nmtst_assert_setting_verifies (NM_SETTING (s_ethtool));
+
+	g_object_set (s_ethtool, NM_SETTING_ETHTOOL_RPS_CPUS, "", NULL);
+	nmtst_assert_setting_verify_fails (NM_SETTING (s_ethtool), NM_CONNECTION_ERROR,
+	                                   NM_CONNECTION_ERROR_INVALID_PROPERTY);
+
+	g_object_set (s_ethtool, NM_SETTING_ETHTOOL_RPS_CPUS, NULL, NULL);
+	g_object_set (s_ethtool, NM_SETTING_ETHTOOL_XPS_CPUS, "0-3", NULL);
+	nmtst_assert_setting_verify_fails (NM_SETTING (s_ethtool), NM_CONNECTION_ERROR,
+	                                   NM_CONNECTION_ERROR_INVALID_PROPERTY);
+
+	g_object_set (s_ethtool, NM_SETTING_ETHTOOL_XPS_CPUS, NULL, NULL);
+	g_object_set (s_ethtool, NM_SETTING_ETHTOOL_IRQ_AFFINITY, "NUMA", NULL);
+	nmtst_assert_setting_verify_fails (NM_SETTING (s_ethtool), NM_CONNECTION_ERROR,
+	                                   NM_CONNECTION_ERROR_INVALID_PROPERTY);
+}
+
+static void
+test_setting_ethtool_dbus (void)
+{
+	gs_unref_object NMConnection *connection = NULL;
+	gs_unref_object NMConnection *connection2 = NULL;
+	gs_unref_variant GVariant *dict = NULL;
+	NMSettingEthtool *s_ethtool;
+	GError *error = NULL;
+
+	connection = nmtst_create_minimal_connection ("test-ethtool", NULL, NM_SETTING_WIRED_SETTING_NAME, NULL);
+	s_ethtool = (NMSettingEthtool *) nm_setting_ethtool_new ();
+	nm_connection_add_setting (connection, NM_SETTING (s_ethtool));
+	g_object_set (s_ethtool,
+	              NM_SETTING_ETHTOOL_RING_RX, 1024,
+	              NM_SETTING_ETHTOOL_RING_TX, 512,
+	              NM_SETTING_ETHTOOL_COALESCE_TX_USECS, 0,
+	              NM_SETTING_ETHTOOL_OFFLOAD_TSO, 0,
+	              NM_SETTING_ETHTOOL_XPS_CPUS, "3",
+	              NULL);
+	nmtst_connection_normalize (connection);
+
+	dict = nm_connection_to_dbus (connection, NM_CONNECTION_SERIALIZE_ALL);
+	g_variant_ref_sink (dict);
+	connection2 = _connection_new_from_dbus (dict, &error);
+	g_assert_no_error (error);
+
+	nmtst_assert_connection_equals (connection, FALSE, connection2, FALSE);
+
+	s_ethtool = nm_connection_get_setting_ethtool (connection2);
+	g_assert (s_ethtool);
+	g_assert_cmpuint (nm_setting_ethtool_get_ring_rx (s_ethtool), ==, 1024);
+	g_assert_cmpuint (nm_setting_ethtool_get_ring_tx (s_ethtool), ==, 512);
+	g_assert_cmpint (nm_setting_ethtool_get_coalesce_rx_usecs (s_ethtool), ==, -1);
+	g_assert_cmpint (nm_setting_ethtool_get_coalesce_tx_usecs (s_ethtool), ==, 0);
+	g_assert_cmpint (nm_setting_ethtool_get_offload_tso (s_ethtool), ==, 0);
+	g_assert_cmpstr (nm_setting_ethtool_get_xps_cpus (s_ethtool), ==, "3");
+}
+
+static void
+test_setting_wireless_security_ft (void)
+{
+	gs_unref_object NMSettingWirelessSecurity *s_wsec = NULL;
+
+	s_wsec = (NMSettingWirelessSecurity *) nm_setting_wireless_security_new ();
+	g_assert_cmpint (nm_setting_wireless_security_get_ft (s_wsec), ==, -1);
+	g_assert_cmpint (nm_setting_wireless_security_get_okc (s_wsec), ==, -1);
+
+	g_object_set (s_wsec,
+	              NM_SETTING_WIRELESS_SECURITY_KEY_MGMT, "wpa-psk",
+	              NM_SETTING_WIRELESS_SECURITY_FT, 1,
+	              NM_SETTING_WIRELESS_SECURITY_OKC, 0,
+	              NULL);
+	nmtst_assert_setting_verifies (NM_SETTING (s_wsec));
+
+	g_object_set (s_wsec, NM_SETTING_WIRELESS_SECURITY_KEY_MGMT, "wpa-none", NULL);
+	nmtst_assert_setting_verify_fails (NM_SETTING (s_wsec), NM_CONNECTION_ERROR,
+	                                   NM_CONNECTION_ERROR_INVALID_PROPERTY);
+
+	/* only enabling FT depends on the key management */
+	g_object_set (s_wsec, NM_SETTING_WIRELESS_SECURITY_FT, 0, NULL);
+	nmtst_assert_setting_verifies (NM_SETTING (s_wsec));
+}
+
 static NMSettingWirelessSecurity *
 make_test_wsec_setting (const char *detail)
 {
@@ -2822,6 +2938,39 @@ test_hwaddr_canonical (void)
 	g_free (canonical);
 }
 
+static void
+test_inet_ntop (void)
+{
+	static const char *const addrs6[] = {
+		"::", "::1", "::2", "1::", "fe80::1", "1:0:0:2::3", "1::2:0:0:3",
+		"::ffff:192.168.1.1", "::192.168.1.1", "::fffe:102:304", "::ffff:0:102:304",
+		"2001:db8:85a3::8a2e:370:7334", "1:2:3:4:5:6:7:8", "1:0:2:0:3:0:4:0",
+	};
+	char buf[NM_UTILS_INET_ADDRSTRLEN];
+	char buf_libc[NM_UTILS_INET_ADDRSTRLEN];
+	guint i, j;
+
+	for (i = 0; i < G_N_ELEMENTS (addrs6); i++) {
+		const struct in6_addr *a6 = nmtst_inet6_from_string (addrs6[i]);
+
+		g_assert_cmpstr (inet_ntop (AF_INET6, a6, buf_libc, sizeof (buf_libc)), ==, addrs6[i]);
+		g_assert_cmpstr (nm_utils_inet6_ntop (a6, buf), ==, addrs6[i]);
+	}
+
+	for (i = 0; i < 10000; i++) {
+		struct in6_addr a6;
+		in_addr_t a4;
+
+		/* sparse addresses, so that runs of zeros are common */
+		for (j = 0; j < sizeof (a6); j++)
+			a6.s6_addr[j] = nmtst_get_rand_int () % 3 ? 0 : nmtst_get_rand_int ();
+		memcpy (&a4, &a6, sizeof (a4));
+
+		g_assert_cmpstr (nm_utils_inet6_ntop (&a6, buf), ==, inet_ntop (AF_INET6, &a6, buf_libc, sizeof (buf_libc)));
+		g_assert_cmpstr (nm_utils_inet4_ntop (a4, buf), ==, inet_ntop (AF_INET, &a4, buf_libc, sizeof (buf_libc)));
+	}
+}
+
 static void
 test_connection_changed_cb (NMConnection *connection, gboolean *data)
 {
@@ -3378,6 +3527,47 @@ test_connection_normalize_uuid (void)
 	nmtst_assert_connection_verifies_after_normalization (con, NM_CONNECTION_ERROR, NM_CONNECTION_ERROR_MISSING_PROPERTY);
 }
 
+static void
+test_connection_verify_cached (void)
+{
+	gs_unref_object NMConnection *con = NULL;
+	NMSettingConnection *s_con;
+	GError *error = NULL;
+
+	con = nmtst_create_minimal_connection ("test1", NULL, NM_SETTING_WIRED_SETTING_NAME, &s_con);
+	nmtst_connection_normalize (con);
+
+	g_assert (nm_connection_verify (con, NULL));
+	g_assert_cmpint (_nm_connection_verify_cached (con, NULL), ==, NM_SETTING_VERIFY_SUCCESS);
+
+	/* modifying a setting must invalidate the previous result */
+	g_object_set (s_con, NM_SETTING_CONNECTION_UUID, "not-a-uuid", NULL);
+	g_assert_cmpint (_nm_connection_verify_cached (con, &error), ==, NM_SETTING_VERIFY_ERROR);
+	g_assert_error (error, NM_CONNECTION_ERROR, NM_CONNECTION_ERROR_INVALID_PROPERTY);
+	g_clear_error (&error);
+
+	g_object_set (s_con, NM_SETTING_CONNECTION_UUID, nm_utils_uuid_generate_a (), NULL);
+	g_assert_cmpint (_nm_connection_verify_cached (con, NULL), ==, NM_SETTING_VERIFY_SUCCESS);
+
+	/* ... and so must removing one */
+	nm_connection_remove_setting (con, NM_TYPE_SETTING_WIRED);
+	g_assert_cmpint (_nm_connection_verify_cached (con, &error), ==, NM_SETTING_VERIFY_ERROR);
+	g_clear_error (&error);
+	nm_connection_add_setting (con, nm_setting_wired_new ());
+	g_assert_cmpint (_nm_connection_verify_cached (con, NULL), ==, NM_SETTING_VERIFY_SUCCESS);
+
+	/* changes that are not notified are only missed by the shortcut,
+	 * the public functions always verify anew. */
+	g_object_freeze_notify (G_OBJECT (s_con));
+	g_object_set (s_con, NM_SETTING_CONNECTION_UUID, "not-a-uuid", NULL);
+	g_assert_cmpint (_nm_connection_verify_cached (con, NULL), ==, NM_SETTING_VERIFY_SUCCESS);
+	g_assert (!nm_connection_verify (con, &error));
+	g_assert_error (error, NM_CONNECTION_ERROR, NM_CONNECTION_ERROR_INVALID_PROPERTY);
+	g_clear_error (&error);
+	g_assert_cmpint (_nm_connection_verify_cached (con, NULL), ==, NM_SETTING_VERIFY_ERROR);
+	g_object_thaw_notify (G_OBJECT (s_con));
+}
+
 /*****************************************************************************/
 
 /*
@@ -5618,6 +5808,10 @@ int main (int argc, char **argv)
 	g_test_add_func ("/core/general/test_setting_gsm_apn_underscore", test_setting_gsm_apn_underscore);
 	g_test_add_func ("/core/general/test_setting_gsm_without_number", test_setting_gsm_without_number);
 	g_test_add_func ("/core/general/test_setting_gsm_sim_operator_id", test_setting_gsm_sim_operator_id);
+	g_test_add_func ("/core/general/test_setting_ethtool_defaults", test_setting_ethtool_defaults);
+	g_test_add_func ("/core/general/test_setting_ethtool_verify", test_setting_ethtool_verify);
+	g_test_add_func ("/core/general/test_setting_ethtool_dbus", test_setting_ethtool_dbus);
+	g_test_add_func ("/core/general/test_setting_wireless_security_ft", test_setting_wireless_security_ft);
 	g_test_add_func ("/core/general/test_setting_to_dbus_all", test_setting_to_dbus_all);
 	g_test_add_func ("/core/general/test_setting_to_dbus_no_secrets", test_setting_to_dbus_no_secrets);
 	g_test_add_func ("/core/general/test_setting_to_dbus_only_secrets", test_setting_to_dbus_only_secrets);
@@ -5655,6 +5849,7 @@ int main (int argc, char **argv)
 	g_test_add_func ("/core/general/test_connection_new_from_dbus", test_connection_new_from_dbus);
 	g_test_add_func ("/core/general/test_connection_normalize_virtual_iface_name", test_connection_normalize_virtual_iface_name);
 	g_test_add_func ("/core/general/test_connection_normalize_uuid", test_connection_normalize_uuid);
+	g_test_add_func ("/core/general/test_connection_verify_cached", test_connection_verify_cached);
 	g_test_add_func ("/core/general/test_connection_normalize_type", test_connection_normalize_type);
 	g_test_add_func ("/core/general/test_connection_normalize_slave_type_1", test_connection_normalize_slave_type_1);
 	g_test_add_func ("/core/general/test_connection_normalize_slave_type_2", test_connection_normalize_slave_type_2);
@@ -5686,6 +5881,7 @@ int main (int argc, char **argv)
 	g_test_add_func ("/core/general/test_hwaddr_aton_malformed", test_hwaddr_aton_malformed);
 	g_test_add_func ("/core/general/test_hwaddr_equal", test_hwaddr_equal);
 	g_test_add_func ("/core/general/test_hwaddr_canonical", test_hwaddr_canonical);
+	g_test_add_func ("/core/general/test_inet_ntop", test_inet_ntop);
 
 	g_test_add_func ("/core/general/test_ip4_prefix_to_netmask", test_ip4_prefix_to_netmask);
 	g_test_add_func ("/core/general/test_ip4_netmask_to_prefix", test_ip4_netmask_to_prefix);
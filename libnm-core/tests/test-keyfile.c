@@ -26,7 +26,10 @@
 #include "nm-simple-connection.h"
 #include "nm-setting-connection.h"
 #include "nm-setting-wired.h"
+#include "nm-setting-wireless.h"
+#include "nm-setting-wireless-security.h"
 #include "nm-setting-8021x.h"
+#include "nm-setting-ethtool.h"
 #include "nm-setting-team.h"
 #include "nm-setting-proxy.h"
 
@@ -581,6 +584,86 @@ test_team_conf_read_invalid (void)
 #endif
 }
 
+static void
+test_wifi_roaming (void)
+{
+	GKeyFile *keyfile = NULL;
+	gs_unref_object NMConnection *con = NULL;
+	NMSettingWireless *s_wifi;
+	NMSettingWirelessSecurity *s_wsec;
+	gs_unref_bytes GBytes *ssid = NULL;
+
+	con = nmtst_create_minimal_connection ("test-roaming", NULL, NM_SETTING_WIRELESS_SETTING_NAME, NULL);
+	s_wifi = nm_connection_get_setting_wireless (con);
+	ssid = g_bytes_new ("roam", 4);
+	g_object_set (s_wifi, NM_SETTING_WIRELESS_SSID, ssid, NULL);
+
+	s_wsec = (NMSettingWirelessSecurity *) nm_setting_wireless_security_new ();
+	nm_connection_add_setting (con, NM_SETTING (s_wsec));
+	g_object_set (s_wsec,
+	              NM_SETTING_WIRELESS_SECURITY_KEY_MGMT, "wpa-psk",
+	              NM_SETTING_WIRELESS_SECURITY_PSK, "roaming passphrase",
+	              NM_SETTING_WIRELESS_SECURITY_FT, 1,
+	              NM_SETTING_WIRELESS_SECURITY_OKC, 0,
+	              NULL);
+	nmtst_connection_normalize (con);
+
+	_keyfile_convert (&con, &keyfile, NULL, NULL, NULL, NULL, NULL, NULL, FALSE);
+
+	g_assert_cmpint (g_key_file_get_integer (keyfile, "wifi-security", "ft", NULL), ==, 1);
+	g_assert_cmpint (g_key_file_get_integer (keyfile, "wifi-security", "okc", NULL), ==, 0);
+
+	CLEAR (&con, &keyfile);
+}
+
+static void
+test_ethtool (void)
+{
+	GKeyFile *keyfile = NULL;
+	gs_unref_object NMConnection *con = NULL;
+	NMSettingEthtool *s_ethtool;
+
+	con = nmtst_create_minimal_connection ("test-ethtool", NULL, NM_SETTING_WIRED_SETTING_NAME, NULL);
+	s_ethtool = (NMSettingEthtool *) nm_setting_ethtool_new ();
+	nm_connection_add_setting (con, NM_SETTING (s_ethtool));
+	g_object_set (s_ethtool,
+	              NM_SETTING_ETHTOOL_CHANNELS_COMBINED, 4,
+	              NM_SETTING_ETHTOOL_COALESCE_RX_USECS, 50,
+	              NM_SETTING_ETHTOOL_OFFLOAD_GRO, 1,
+	              NM_SETTING_ETHTOOL_RPS_CPUS, NM_SETTING_ETHTOOL_CPUS_NUMA,
+	              NULL);
+	nmtst_connection_normalize (con);
+
+	_keyfile_convert (&con, &keyfile, NULL, NULL, NULL, NULL, NULL, NULL, FALSE);
+
+	g_assert_cmpint (g_key_file_get_uint64 (keyfile, "ethtool", "channels-combined", NULL), ==, 4);
+	g_assert_cmpint (g_key_file_get_integer (keyfile, "ethtool", "coalesce-rx-usecs", NULL), ==, 50);
+	g_assert_cmpint (g_key_file_get_integer (keyfile, "ethtool", "offload-gro", NULL), ==, 1);
+	g_assert (!g_key_file_has_key (keyfile, "ethtool", "ring-rx", NULL));
+	g_assert (!g_key_file_has_key (keyfile, "ethtool", "offload-tso", NULL));
+
+	CLEAR (&con, &keyfile);
+
+	con = nmtst_create_connection_from_keyfile (
+	      "[connection]\n"
+	      "type=ethernet\n"
+	      "[ethtool]\n"
+	      "ring-tx=256\n"
+	      "offload-lro=0\n"
+	      "irq-affinity=f\n",
+	      "/test_ethtool", NULL);
+
+	s_ethtool = nm_connection_get_setting_ethtool (con);
+	g_assert (s_ethtool);
+	g_assert_cmpuint (nm_setting_ethtool_get_ring_rx (s_ethtool), ==, 0);
+	g_assert_cmpuint (nm_setting_ethtool_get_ring_tx (s_ethtool), ==, 256);
+	g_assert_cmpint (nm_setting_ethtool_get_offload_lro (s_ethtool), ==, 0);
+	g_assert_cmpint (nm_setting_ethtool_get_offload_gro (s_ethtool), ==, -1);
+	g_assert_cmpstr (nm_setting_ethtool_get_irq_affinity (s_ethtool), ==, "f");
+
+	CLEAR (&con, &keyfile);
+}
+
 /*****************************************************************************/
 
 NMTST_DEFINE ();
@@ -593,6 +676,8 @@ int main (int argc, char **argv)
 	g_test_add_func ("/core/keyfile/test_8021x_cert_read", test_8021x_cert_read);
 	g_test_add_func ("/core/keyfile/test_team_conf_read/valid", test_team_conf_read_valid);
 	g_test_add_func ("/core/keyfile/test_team_conf_read/invalid", test_team_conf_read_invalid);
+	g_test_add_func ("/core/keyfile/test_wifi_roaming", test_wifi_roaming);
+	g_test_add_func ("/core/keyfile/test_ethtool", test_ethtool);
 
 	return g_test_run ();
 }
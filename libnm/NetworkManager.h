@@ -63,6 +63,7 @@
 #include "nm-setting-connection.h"
 #include "nm-setting-dcb.h"
 #include "nm-setting-dummy.h"
+#include "nm-setting-ethtool.h"
 #include "nm-setting-generic.h"
 #include "nm-setting-gsm.h"
 #include "nm-setting-infiniband.h"
@@ -90,6 +91,7 @@
 #include "nm-setting-wireless-security.h"
 #include "nm-setting.h"
 #include "nm-simple-connection.h"
+#include "nm-snapshot.h"
 #include "nm-utils.h"
 #include "nm-version.h"
 #include "nm-vpn-connection.h"
@@ -22,6 +22,7 @@
 #include "nm-default.h"
 
 #include <string.h>
+#include <unistd.h>
 #include <libudev.h>
 
 #include "nm-utils.h"
@@ -35,9 +36,11 @@
 #include "nm-active-connection.h"
 #include "nm-vpn-connection.h"
 #include "nm-remote-connection.h"
+#include "nm-remote-connection-private.h"
 #include "nm-dbus-helpers.h"
 #include "nm-wimax-nsp.h"
 #include "nm-object-private.h"
+#include "nm-snapshot.h"
 
 #include "introspection/org.freedesktop.NetworkManager.h"
 #include "introspection/org.freedesktop.NetworkManager.Device.Wireless.h"
@@ -97,7 +100,11 @@ typedef struct {
 	NMDnsManager *dns_manager;
 	GDBusObjectManager *object_manager;
 	GCancellable *new_object_manager_cancellable;
+	/* the connection of @object_manager, if it is the private socket. */
+	GDBusConnection *private_connection;
 	struct udev *udev;
+	NMSnapshot *snapshot;
+	bool lazy_settings;
 } NMClientPrivate;
 
 enum {
@@ -126,6 +133,7 @@ enum {
 	PROP_DNS_MODE,
 	PROP_DNS_RC_MANAGER,
 	PROP_DNS_CONFIGURATION,
+	PROP_LAZY_SETTINGS,
 
 	LAST_PROP
 };
@@ -517,6 +525,124 @@ nm_client_set_logging (NMClient *client, const char *level, const char *domains,
 	                               level, domains, error);
 }
 
+/**
+ * nm_client_get_platform_statistics:
+ * @client: a #NMClient
+ * @error: (allow-none): return location for a #GError, or %NULL
+ *
+ * Gets the counters of NetworkManager's platform layer, like the number
+ * of netlink messages received per message type or the changes to the
+ * cache of kernel objects. The names of the counters are not stable.
+ *
+ * Returns: (transfer full): a #GVariant of type "a{st}" that maps the
+ *   name of each counter to its value, or %NULL on error.
+ *
+ * Since: 1.10
+ **/
+GVariant *
+nm_client_get_platform_statistics (NMClient *client, GError **error)
+{
+	g_return_val_if_fail (NM_IS_CLIENT (client), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	if (!_nm_client_check_nm_running (client, error))
+		return NULL;
+
+	return nm_manager_get_platform_statistics (NM_CLIENT_GET_PRIVATE (client)->manager,
+	                                           error);
+}
+
+/**
+ * nm_client_get_memory_usage:
+ * @client: a #NMClient
+ * @error: (allow-none): return location for a #GError, or %NULL
+ *
+ * Gets an estimate of the memory used by NetworkManager, broken down
+ * by the owners of the memory, like the cache of kernel objects or the
+ * connection profiles. The names of the entries are not stable.
+ *
+ * Returns: (transfer full): a #GVariant of type "a{s(tt)}" that maps the
+ *   name of each owner to the number of its objects and the bytes they
+ *   use, or %NULL on error.
+ *
+ * Since: 1.10
+ **/
+GVariant *
+nm_client_get_memory_usage (NMClient *client, GError **error)
+{
+	g_return_val_if_fail (NM_IS_CLIENT (client), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	if (!_nm_client_check_nm_running (client, error))
+		return NULL;
+
+	return nm_manager_get_memory_usage (NM_CLIENT_GET_PRIVATE (client)->manager,
+	                                    error);
+}
+
+/**
+ * nm_client_get_vpn_plugin_infos:
+ * @client: a #NMClient
+ * @error: (allow-none): return location for a #GError, or %NULL
+ *
+ * Gets the VPN plugins installed on the system from NetworkManager,
+ * which keeps an index of them up to date. This avoids scanning and
+ * parsing the plugin directories, like nm_vpn_plugin_info_list_load()
+ * does. Plugins from the directory in the NM_VPN_PLUGIN_DIR environment
+ * variable are still loaded locally and take precedence.
+ *
+ * Returns: (element-type NMVpnPluginInfo) (transfer full): the list
+ *   of plugins, or %NULL on error. Note that an empty list is %NULL
+ *   too, in which case @error is not set.
+ *
+ * Since: 1.10
+ **/
+GSList *
+nm_client_get_vpn_plugin_infos (NMClient *client, GError **error)
+{
+	gs_unref_variant GVariant *plugins = NULL;
+	GVariantIter iter;
+	const char *filename, *contents;
+	const char *dir_user;
+	GSList *list = NULL;
+
+	g_return_val_if_fail (NM_IS_CLIENT (client), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	if (!_nm_client_check_nm_running (client, error))
+		return NULL;
+
+	plugins = nm_manager_get_vpn_plugins (NM_CLIENT_GET_PRIVATE (client)->manager,
+	                                      error);
+	if (!plugins)
+		return NULL;
+
+	dir_user = _nm_vpn_plugin_info_get_default_dir_user ();
+	if (dir_user) {
+		GSList *infos, *info;
+
+		infos = _nm_vpn_plugin_info_list_load_dir (dir_user, TRUE, getuid (), NULL, NULL);
+		for (info = infos; info; info = info->next)
+			nm_vpn_plugin_info_list_add (&list, info->data, NULL);
+		g_slist_free_full (infos, g_object_unref);
+	}
+
+	g_variant_iter_init (&iter, plugins);
+	while (g_variant_iter_next (&iter, "(&s&s)", &filename, &contents)) {
+		gs_unref_keyfile GKeyFile *keyfile = NULL;
+		gs_unref_object NMVpnPluginInfo *plugin_info = NULL;
+
+		keyfile = g_key_file_new ();
+		if (!g_key_file_load_from_data (keyfile, contents, -1, G_KEY_FILE_NONE, NULL))
+			continue;
+		plugin_info = nm_vpn_plugin_info_new_with_data (filename, keyfile, NULL);
+		if (plugin_info)
+			nm_vpn_plugin_info_list_add (&list, plugin_info, NULL);
+	}
+
+	return list;
+}
+
 /**
  * nm_client_get_permission_result:
  * @client: a #NMClient
@@ -1309,6 +1435,45 @@ nm_client_get_connections (NMClient *client)
 	return nm_remote_settings_get_connections (NM_CLIENT_GET_PRIVATE (client)->settings);
 }
 
+/**
+ * nm_client_get_snapshot:
+ * @client: the %NMClient
+ *
+ * Creates an immutable copy of the devices, active connections and
+ * connection profiles of @client. Must be called from the thread that owns
+ * the main context of @client, but the returned #NMSnapshot can be read and
+ * unreferenced from any thread.
+ *
+ * Entries of objects that did not change since the previous call are
+ * shared with the previous snapshot, and if nothing changed the previous
+ * snapshot itself is returned.
+ *
+ * With #NMClient:lazy-settings, this loads the settings of all connections
+ * that are not loaded yet; see nm_client_fetch_connection_settings().
+ *
+ * Returns: (transfer full): the snapshot. Unref with nm_snapshot_unref().
+ *
+ * Since: 1.10
+ **/
+NMSnapshot *
+nm_client_get_snapshot (NMClient *client)
+{
+	NMClientPrivate *priv;
+	NMSnapshot *snapshot;
+
+	g_return_val_if_fail (NM_IS_CLIENT (client), NULL);
+
+	priv = NM_CLIENT_GET_PRIVATE (client);
+
+	snapshot = _nm_snapshot_new (client, priv->snapshot);
+	if (snapshot != priv->snapshot) {
+		if (priv->snapshot)
+			nm_snapshot_unref (priv->snapshot);
+		priv->snapshot = nm_snapshot_ref (snapshot);
+	}
+	return snapshot;
+}
+
 /**
  * nm_client_get_connection_by_id:
  * @client: the %NMClient
@@ -1641,6 +1806,47 @@ nm_client_reload_connections (NMClient *client,
 	                                              cancellable, error);
 }
 
+/**
+ * nm_client_fetch_connection_settings:
+ * @client: the #NMClient
+ * @connections: (element-type NMRemoteConnection) (allow-none): the
+ *   connections to fetch the settings of, or %NULL for all connections
+ * @cancellable: a #GCancellable, or %NULL
+ * @error: return location for #GError
+ *
+ * With #NMClient:lazy-settings, requests the settings of all @connections
+ * that are not loaded yet at once, and waits for them. This is much faster
+ * than accessing the settings of each connection one after another, and
+ * takes a single D-Bus call if NetworkManager supports it.
+ * Without #NMClient:lazy-settings, there is nothing to do.
+ *
+ * Connections that turn out not to be visible to the user get removed
+ * from nm_client_get_connections() later, from the main loop.
+ *
+ * Return value: %TRUE on success, %FALSE if @cancellable got cancelled
+ *
+ * Since: 1.10
+ **/
+gboolean
+nm_client_fetch_connection_settings (NMClient *client,
+                                     const GPtrArray *connections,
+                                     GCancellable *cancellable,
+                                     GError **error)
+{
+	g_return_val_if_fail (NM_IS_CLIENT (client), FALSE);
+
+	if (!NM_CLIENT_GET_PRIVATE (client)->lazy_settings)
+		return TRUE;
+
+	if (!connections)
+		connections = nm_client_get_connections (client);
+
+	return nm_remote_settings_fetch_connection_settings (NM_CLIENT_GET_PRIVATE (client)->settings,
+	                                                     connections,
+	                                                     cancellable,
+	                                                     error);
+}
+
 static void
 reload_connections_cb (GObject *object, GAsyncResult *result, gpointer user_data)
 {
@@ -2114,11 +2320,14 @@ obj_nm_for_gdbus_object (NMClient *self, GDBusObject *object, GDBusObjectManager
 	                       NM_OBJECT_DBUS_OBJECT, object,
 	                       NM_OBJECT_DBUS_OBJECT_MANAGER, object_manager,
 	                       NULL);
+	priv = NM_CLIENT_GET_PRIVATE (self);
 	if (NM_IS_DEVICE (obj_nm)) {
-		priv = NM_CLIENT_GET_PRIVATE (self);
 		if (!priv->udev)
 			priv->udev = udev_new ();
 		_nm_device_set_udev (NM_DEVICE (obj_nm), priv->udev);
+	} else if (NM_IS_REMOTE_CONNECTION (obj_nm)) {
+		if (priv->lazy_settings)
+			_nm_remote_connection_set_lazy_settings (NM_REMOTE_CONNECTION (obj_nm));
 	}
 	g_object_set_qdata_full (G_OBJECT (object), _nm_object_obj_nm_quark (),
 	                         obj_nm, g_object_unref);
@@ -2263,6 +2472,52 @@ objects_created (NMClient *client, GDBusObjectManager *object_manager, GError **
 	return TRUE;
 }
 
+static gboolean
+object_manager_has_owner (GDBusObjectManager *object_manager)
+{
+	GDBusObjectManagerClient *client = G_DBUS_OBJECT_MANAGER_CLIENT (object_manager);
+	gs_free char *name_owner = NULL;
+
+	/* a peer-to-peer connection has no name owner, the daemon is at the
+	 * other end of it. */
+	if (_nm_dbus_is_connection_private (g_dbus_object_manager_client_get_connection (client)))
+		return TRUE;
+
+	name_owner = g_dbus_object_manager_client_get_name_owner (client);
+	return !!name_owner;
+}
+
+static void private_connection_closed (GDBusConnection *connection,
+                                       gboolean remote_peer_vanished,
+                                       GError *error,
+                                       gpointer user_data);
+
+static void
+hook_private_connection (NMClient *self)
+{
+	NMClientPrivate *priv = NM_CLIENT_GET_PRIVATE (self);
+	GDBusConnection *connection;
+
+	connection = g_dbus_object_manager_client_get_connection (G_DBUS_OBJECT_MANAGER_CLIENT (priv->object_manager));
+	if (!_nm_dbus_is_connection_private (connection))
+		return;
+
+	priv->private_connection = g_object_ref (connection);
+	g_signal_connect (connection, "closed",
+	                  G_CALLBACK (private_connection_closed), self);
+}
+
+static void
+unhook_private_connection (NMClient *self)
+{
+	NMClientPrivate *priv = NM_CLIENT_GET_PRIVATE (self);
+
+	if (priv->private_connection) {
+		g_signal_handlers_disconnect_by_data (priv->private_connection, self);
+		g_clear_object (&priv->private_connection);
+	}
+}
+
 /* Synchronous initialization. */
 
 static void name_owner_changed (GObject *object, GParamSpec *pspec, gpointer user_data);
@@ -2272,26 +2527,57 @@ init_sync (GInitable *initable, GCancellable *cancellable, GError **error)
 {
 	NMClient *client = NM_CLIENT (initable);
 	NMClientPrivate *priv = NM_CLIENT_GET_PRIVATE (client);
+	gs_unref_ptrarray GPtrArray *connections = NULL;
 	GList *objects, *iter;
-	gchar *name_owner;
+	gs_unref_object GDBusConnection *private_connection = NULL;
+
+	/* prefer the private socket of the daemon, if we may use it. */
+	private_connection = _nm_dbus_new_private_connection (cancellable);
+	if (private_connection) {
+		priv->object_manager = g_dbus_object_manager_client_new_sync (private_connection,
+		                                                              G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_NONE,
+		                                                              NULL,
+		                                                              "/org/freedesktop",
+		                                                              proxy_type, NULL, NULL,
+		                                                              cancellable, NULL);
+	}
 
-	priv->object_manager = g_dbus_object_manager_client_new_for_bus_sync (_nm_dbus_bus_type (),
-	                                                                      G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_DO_NOT_AUTO_START,
-	                                                                      "org.freedesktop.NetworkManager",
-	                                                                      "/org/freedesktop",
-	                                                                      proxy_type, NULL, NULL,
-	                                                                      cancellable, error);
+	if (!priv->object_manager) {
+		priv->object_manager = g_dbus_object_manager_client_new_for_bus_sync (_nm_dbus_bus_type (),
+		                                                                      G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_DO_NOT_AUTO_START,
+		                                                                      "org.freedesktop.NetworkManager",
+		                                                                      "/org/freedesktop",
+		                                                                      proxy_type, NULL, NULL,
+		                                                                      cancellable, error);
+	}
 
 	if (!priv->object_manager)
 		return FALSE;
 
-	name_owner = g_dbus_object_manager_client_get_name_owner (G_DBUS_OBJECT_MANAGER_CLIENT (priv->object_manager));
-	if (name_owner) {
-		g_free (name_owner);
+	hook_private_connection (client);
+
+	if (object_manager_has_owner (priv->object_manager)) {
 		if (!objects_created (client, priv->object_manager, error))
 			return FALSE;
 
 		objects = g_dbus_object_manager_get_objects (priv->object_manager);
+
+		/* The properties of all objects came with the reply of GetManagedObjects,
+		 * but each remote connection also needs its settings. Request them all
+		 * at once instead of one after another. With lazy-settings, they
+		 * are requested on first access. */
+		connections = g_ptr_array_new ();
+		for (iter = priv->lazy_settings ? NULL : objects; iter; iter = iter->next) {
+			NMObject *obj_nm;
+
+			obj_nm = g_object_get_qdata (iter->data, _nm_object_obj_nm_quark ());
+			if (NM_IS_REMOTE_CONNECTION (obj_nm))
+				g_ptr_array_add (connections, obj_nm);
+		}
+		_nm_remote_connection_prefetch_settings ((NMRemoteConnection *const*) connections->pdata,
+		                                         connections->len,
+		                                         cancellable);
+
 		for (iter = objects; iter; iter = iter->next) {
 			NMObject *obj_nm;
 
@@ -2418,11 +2704,12 @@ got_object_manager (GObject *object, GAsyncResult *result, gpointer user_data)
 	NMClient *client;
 	NMClientPrivate *priv;
 	GList *objects, *iter;
-	gchar *name_owner;
 	GError *error = NULL;
 	GDBusObjectManager *object_manager;
 
-	object_manager = g_dbus_object_manager_client_new_for_bus_finish (result, &error);
+	/* the object manager on the private connection is created with
+	 * g_dbus_object_manager_client_new(), which finishes the same way. */
+	object_manager = g_dbus_object_manager_client_new_finish (result, &error);
 	if (object_manager == NULL) {
 		if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
 			g_simple_async_result_take_error (init_data->result, error);
@@ -2435,9 +2722,9 @@ got_object_manager (GObject *object, GAsyncResult *result, gpointer user_data)
 	priv = NM_CLIENT_GET_PRIVATE (client);
 	priv->object_manager = object_manager;
 
-	name_owner = g_dbus_object_manager_client_get_name_owner (G_DBUS_OBJECT_MANAGER_CLIENT (priv->object_manager));
-	if (name_owner) {
-		g_free (name_owner);
+	hook_private_connection (client);
+
+	if (object_manager_has_owner (priv->object_manager)) {
 		if (!objects_created (client, priv->object_manager, &error)) {
 			g_simple_async_result_take_error (init_data->result, error);
 			init_async_complete (init_data);
@@ -2466,8 +2753,44 @@ got_object_manager (GObject *object, GAsyncResult *result, gpointer user_data)
 	                  G_CALLBACK (name_owner_changed), client);
 }
 
+static void
+prepare_object_manager_for_bus (NMClientInitData *init_data)
+{
+	g_dbus_object_manager_client_new_for_bus (_nm_dbus_bus_type (),
+	                                          G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_DO_NOT_AUTO_START,
+	                                          "org.freedesktop.NetworkManager",
+	                                          "/org/freedesktop",
+	                                          proxy_type, NULL, NULL,
+	                                          init_data->cancellable,
+	                                          got_object_manager,
+	                                          init_data);
+}
+
+static void
+got_private_connection (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+	NMClientInitData *init_data = user_data;
+	gs_unref_object GDBusConnection *connection = NULL;
+
+	connection = _nm_dbus_new_private_connection_finish (result);
+	if (!connection) {
+		prepare_object_manager_for_bus (init_data);
+		return;
+	}
+
+	g_dbus_object_manager_client_new (connection,
+	                                  G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_NONE,
+	                                  NULL,
+	                                  "/org/freedesktop",
+	                                  proxy_type, NULL, NULL,
+	                                  init_data->cancellable,
+	                                  got_object_manager,
+	                                  init_data);
+}
+
 static void
 prepare_object_manager (NMClient *client,
+                        gboolean try_private,
                         GCancellable *cancellable,
                         GAsyncReadyCallback callback,
                         gpointer user_data)
@@ -2481,14 +2804,34 @@ prepare_object_manager (NMClient *client,
 	                                               user_data, init_async);
 	g_simple_async_result_set_op_res_gboolean (init_data->result, TRUE);
 
-	g_dbus_object_manager_client_new_for_bus (_nm_dbus_bus_type (),
-	                                          G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_DO_NOT_AUTO_START,
-	                                          "org.freedesktop.NetworkManager",
-	                                          "/org/freedesktop",
-	                                          proxy_type, NULL, NULL,
-	                                          init_data->cancellable,
-	                                          got_object_manager,
-	                                          init_data);
+	if (try_private) {
+		_nm_dbus_new_private_connection_async (init_data->cancellable,
+		                                       got_private_connection,
+		                                       init_data);
+	} else
+		prepare_object_manager_for_bus (init_data);
+}
+
+static void
+private_connection_closed (GDBusConnection *connection,
+                           gboolean remote_peer_vanished,
+                           GError *error,
+                           gpointer user_data)
+{
+	NMClient *self = user_data;
+	NMClientPrivate *priv = NM_CLIENT_GET_PRIVATE (self);
+
+	/* The daemon went away. Unlike on the bus, we cannot see it come back
+	 * on the private socket, so continue on the bus. */
+	unhook_private_connection (self);
+	unhook_om (self);
+	g_signal_handlers_disconnect_by_data (priv->object_manager, self);
+	g_clear_object (&priv->object_manager);
+
+	nm_clear_g_cancellable (&priv->new_object_manager_cancellable);
+	priv->new_object_manager_cancellable = g_cancellable_new ();
+	prepare_object_manager (self, FALSE, priv->new_object_manager_cancellable,
+	                        new_object_manager, self);
 }
 
 static void
@@ -2506,7 +2849,7 @@ name_owner_changed (GObject *object, GParamSpec *pspec, gpointer user_data)
 		if (priv->new_object_manager_cancellable)
 			g_cancellable_cancel (priv->new_object_manager_cancellable);
 		priv->new_object_manager_cancellable = g_cancellable_new ();
-		prepare_object_manager (self, priv->new_object_manager_cancellable,
+		prepare_object_manager (self, FALSE, priv->new_object_manager_cancellable,
 		                        new_object_manager, user_data);
 	} else {
 		g_signal_handlers_disconnect_by_func (object_manager, object_added, self);
@@ -2519,7 +2862,7 @@ init_async (GAsyncInitable *initable, int io_priority,
             GCancellable *cancellable, GAsyncReadyCallback callback,
             gpointer user_data)
 {
-	prepare_object_manager (NM_CLIENT (initable), cancellable, callback, user_data);
+	prepare_object_manager (NM_CLIENT (initable), TRUE, cancellable, callback, user_data);
 }
 
 static gboolean
@@ -2540,6 +2883,8 @@ dispose (GObject *object)
 
 	nm_clear_g_cancellable (&priv->new_object_manager_cancellable);
 
+	unhook_private_connection (NM_CLIENT (object));
+
 	if (priv->manager) {
 		g_signal_handlers_disconnect_by_data (priv->manager, object);
 		g_clear_object (&priv->manager);
@@ -2568,6 +2913,8 @@ dispose (GObject *object)
 		g_clear_object (&priv->object_manager);
 	}
 
+	g_clear_pointer (&priv->snapshot, nm_snapshot_unref);
+
 	G_OBJECT_CLASS (nm_client_parent_class)->dispose (object);
 
 	if (priv->udev) {
@@ -2590,6 +2937,10 @@ set_property (GObject *object, guint prop_id,
 		if (priv->manager)
 			g_object_set_property (G_OBJECT (priv->manager), pspec->name, value);
 		break;
+	case PROP_LAZY_SETTINGS:
+		/* construct-only */
+		priv->lazy_settings = g_value_get_boolean (value);
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
@@ -2711,6 +3062,9 @@ get_property (GObject *object, guint prop_id,
 		} else
 			g_value_take_boxed (value, NULL);
 		break;
+	case PROP_LAZY_SETTINGS:
+		g_value_set_boolean (value, priv->lazy_settings);
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
@@ -3050,6 +3404,29 @@ nm_client_class_init (NMClientClass *client_class)
 		                     G_PARAM_READABLE |
 		                     G_PARAM_STATIC_STRINGS));
 
+	/**
+	 * NMClient:lazy-settings:
+	 *
+	 * If %TRUE, the settings of the connections are not requested when
+	 * the client is created or a connection changes, but on the first
+	 * access to the settings of each connection. That access blocks
+	 * on a D-Bus call; use nm_client_fetch_connection_settings() to
+	 * request the settings of many connections at once.
+	 *
+	 * Until its settings are loaded, a connection is assumed to be
+	 * visible to the user. This is useful for clients that are mainly
+	 * interested in the state of the devices.
+	 *
+	 * Since: 1.10
+	 **/
+	g_object_class_install_property
+		(object_class, PROP_LAZY_SETTINGS,
+		 g_param_spec_boolean (NM_CLIENT_LAZY_SETTINGS, "", "",
+		                       FALSE,
+		                       G_PARAM_READWRITE |
+		                       G_PARAM_CONSTRUCT_ONLY |
+		                       G_PARAM_STATIC_STRINGS));
+
 	/* signals */
 
 	/**
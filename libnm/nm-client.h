@@ -61,6 +61,7 @@ G_BEGIN_DECLS
 #define NM_CLIENT_DNS_MODE "dns-mode"
 #define NM_CLIENT_DNS_RC_MANAGER "dns-rc-manager"
 #define NM_CLIENT_DNS_CONFIGURATION "dns-configuration"
+#define NM_CLIENT_LAZY_SETTINGS "lazy-settings"
 
 #define NM_CLIENT_DEVICE_ADDED "device-added"
 #define NM_CLIENT_DEVICE_REMOVED "device-removed"
@@ -258,6 +259,18 @@ gboolean nm_client_set_logging (NMClient *client,
                                 const char *domains,
                                 GError **error);
 
+NM_AVAILABLE_IN_1_10
+GVariant *nm_client_get_platform_statistics (NMClient *client,
+                                             GError **error);
+
+NM_AVAILABLE_IN_1_10
+GVariant *nm_client_get_memory_usage (NMClient *client,
+                                      GError **error);
+
+NM_AVAILABLE_IN_1_10
+GSList *nm_client_get_vpn_plugin_infos (NMClient *client,
+                                        GError **error);
+
 NMClientPermissionResult nm_client_get_permission_result (NMClient *client,
                                                           NMClientPermission permission);
 
@@ -381,6 +394,15 @@ gboolean nm_client_reload_connections_finish (NMClient *client,
                                               GAsyncResult *result,
                                               GError **error);
 
+NM_AVAILABLE_IN_1_10
+NMSnapshot *nm_client_get_snapshot (NMClient *client);
+
+NM_AVAILABLE_IN_1_10
+gboolean nm_client_fetch_connection_settings (NMClient *client,
+                                              const GPtrArray *connections,
+                                              GCancellable *cancellable,
+                                              GError **error);
+
 NM_AVAILABLE_IN_1_6
 const char *nm_client_get_dns_mode            (NMClient *client);
 NM_AVAILABLE_IN_1_6
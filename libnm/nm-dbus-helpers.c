@@ -23,6 +23,7 @@
 #include "nm-dbus-helpers.h"
 
 #include <string.h>
+#include <unistd.h>
 
 #include "nm-dbus-interface.h"
 
@@ -92,6 +93,86 @@ _nm_dbus_new_connection_finish (GAsyncResult *result,
 	return g_object_ref (g_simple_async_result_get_op_res_gpointer (simple));
 }
 
+/* The peer-to-peer socket on which the daemon exports its objects to root,
+ * if "private-socket" is enabled in NetworkManager.conf. Keep in sync with
+ * src/main.c. */
+#define PRIVATE_SOCKET_PATH NMRUNDIR "/private"
+
+static gboolean
+_private_socket_usable (void)
+{
+	return    _nm_dbus_bus_type () == G_BUS_TYPE_SYSTEM
+	       && geteuid () == 0
+	       && access (PRIVATE_SOCKET_PATH, F_OK) == 0;
+}
+
+/**
+ * _nm_dbus_new_private_connection:
+ * @cancellable: a #GCancellable
+ *
+ * Connects to the private socket of the daemon, which spares the round
+ * trip through the message bus daemon. It is only available to root and
+ * if the daemon enabled it.
+ *
+ * Returns: (transfer full): the peer-to-peer connection or %NULL if it is
+ *   not available. The caller should fall back to the bus in that case.
+ */
+GDBusConnection *
+_nm_dbus_new_private_connection (GCancellable *cancellable)
+{
+	if (!_private_socket_usable ())
+		return NULL;
+
+	return g_dbus_connection_new_for_address_sync ("unix:path=" PRIVATE_SOCKET_PATH,
+	                                               G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT,
+	                                               NULL, cancellable, NULL);
+}
+
+static void
+new_private_connection_async_cb (GObject *source, GAsyncResult *result, gpointer user_data)
+{
+	GSimpleAsyncResult *simple = user_data;
+	GDBusConnection *connection;
+
+	connection = g_dbus_connection_new_for_address_finish (result, NULL);
+	if (connection)
+		g_simple_async_result_set_op_res_gpointer (simple, connection, g_object_unref);
+
+	g_simple_async_result_complete (simple);
+	g_object_unref (simple);
+}
+
+void
+_nm_dbus_new_private_connection_async (GCancellable *cancellable,
+                                       GAsyncReadyCallback callback,
+                                       gpointer user_data)
+{
+	GSimpleAsyncResult *simple;
+
+	simple = g_simple_async_result_new (NULL, callback, user_data, _nm_dbus_new_private_connection_async);
+
+	if (!_private_socket_usable ()) {
+		g_simple_async_result_complete_in_idle (simple);
+		g_object_unref (simple);
+		return;
+	}
+
+	g_dbus_connection_new_for_address ("unix:path=" PRIVATE_SOCKET_PATH,
+	                                   G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT,
+	                                   NULL, cancellable,
+	                                   new_private_connection_async_cb, simple);
+}
+
+/* Returns: (transfer full): the connection, or %NULL if it is not available. */
+GDBusConnection *
+_nm_dbus_new_private_connection_finish (GAsyncResult *result)
+{
+	GDBusConnection *connection;
+
+	connection = g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (result));
+	return connection ? g_object_ref (connection) : NULL;
+}
+
 gboolean
 _nm_dbus_is_connection_private (GDBusConnection *connection)
 {
@@ -115,6 +196,10 @@ _nm_dbus_proxy_replace_match (GDBusProxy *proxy)
 	static unsigned match_counter = 1024;
 	gchar *match;
 
+	/* there are no match rules on peer-to-peer connections. */
+	if (_nm_dbus_is_connection_private (connection))
+		return;
+
 	if (match_counter == 1) {
 		/* If we hit the low matches watermark, install a
 		 * less granular one. */
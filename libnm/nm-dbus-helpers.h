@@ -34,6 +34,13 @@ void             _nm_dbus_new_connection_async  (GCancellable *cancellable,
 GDBusConnection *_nm_dbus_new_connection_finish (GAsyncResult *result,
                                                  GError **error);
 
+GDBusConnection *_nm_dbus_new_private_connection        (GCancellable *cancellable);
+
+void             _nm_dbus_new_private_connection_async  (GCancellable *cancellable,
+                                                         GAsyncReadyCallback callback,
+                                                         gpointer user_data);
+GDBusConnection *_nm_dbus_new_private_connection_finish (GAsyncResult *result);
+
 gboolean         _nm_dbus_is_connection_private (GDBusConnection *connection);
 
 void             _nm_dbus_proxy_replace_match   (GDBusProxy *proxy);
@@ -61,6 +61,14 @@ typedef struct {
 	GPtrArray *all_devices;
 	GPtrArray *active_connections;
 	NMConnectivityState connectivity;
+
+	/* indexes of @devices by path and by interface name, built on the
+	 * first lookup. @devices is never modified but replaced on change, so
+	 * the indexes are valid as long as @devices_idx_array is @devices. It
+	 * keeps a reference, so that a new array cannot get its address. */
+	GPtrArray *devices_idx_array;
+	GHashTable *devices_idx_path;
+	GHashTable *devices_idx_iface;
 	NMActiveConnection *primary_connection;
 	NMActiveConnection *activating_connection;
 	NMMetered metered;
@@ -543,6 +551,60 @@ nm_manager_set_logging (NMManager *manager, const char *level, const char *domai
 	return ret;
 }
 
+GVariant *
+nm_manager_get_platform_statistics (NMManager *manager, GError **error)
+{
+	GVariant *statistics = NULL;
+
+	g_return_val_if_fail (NM_IS_MANAGER (manager), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	if (!nmdbus_manager_call_get_platform_statistics_sync (NM_MANAGER_GET_PRIVATE (manager)->proxy,
+	                                                       &statistics,
+	                                                       NULL, error)) {
+		if (error && *error)
+			g_dbus_error_strip_remote_error (*error);
+		return NULL;
+	}
+	return statistics;
+}
+
+GVariant *
+nm_manager_get_memory_usage (NMManager *manager, GError **error)
+{
+	GVariant *usage = NULL;
+
+	g_return_val_if_fail (NM_IS_MANAGER (manager), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	if (!nmdbus_manager_call_get_memory_usage_sync (NM_MANAGER_GET_PRIVATE (manager)->proxy,
+	                                                &usage,
+	                                                NULL, error)) {
+		if (error && *error)
+			g_dbus_error_strip_remote_error (*error);
+		return NULL;
+	}
+	return usage;
+}
+
+GVariant *
+nm_manager_get_vpn_plugins (NMManager *manager, GError **error)
+{
+	GVariant *plugins = NULL;
+
+	g_return_val_if_fail (NM_IS_MANAGER (manager), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	if (!nmdbus_manager_call_get_vpn_plugins_sync (NM_MANAGER_GET_PRIVATE (manager)->proxy,
+	                                               &plugins,
+	                                               NULL, error)) {
+		if (error && *error)
+			g_dbus_error_strip_remote_error (*error);
+		return NULL;
+	}
+	return plugins;
+}
+
 NMClientPermissionResult
 nm_manager_get_permission_result (NMManager *manager, NMClientPermission permission)
 {
@@ -662,48 +724,94 @@ nm_manager_get_all_devices (NMManager *manager)
 	return NM_MANAGER_GET_PRIVATE (manager)->all_devices;
 }
 
+static void
+devices_idx_clear (NMManagerPrivate *priv)
+{
+	g_clear_pointer (&priv->devices_idx_array, g_ptr_array_unref);
+	g_clear_pointer (&priv->devices_idx_path, g_hash_table_unref);
+	g_clear_pointer (&priv->devices_idx_iface, g_hash_table_unref);
+}
+
+static void
+devices_idx_ensure (NMManagerPrivate *priv)
+{
+	guint i;
+
+	if (   priv->devices_idx_array
+	    && priv->devices_idx_array == priv->devices)
+		return;
+
+	devices_idx_clear (priv);
+	if (!priv->devices)
+		return;
+
+	/* the first device wins, like with a linear search. */
+	priv->devices_idx_array = g_ptr_array_ref (priv->devices);
+	priv->devices_idx_path = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	priv->devices_idx_iface = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	for (i = 0; i < priv->devices->len; i++) {
+		NMDevice *device = priv->devices->pdata[i];
+		const char *str;
+
+		str = nm_object_get_path (NM_OBJECT (device));
+		if (str && !g_hash_table_contains (priv->devices_idx_path, str))
+			g_hash_table_insert (priv->devices_idx_path, g_strdup (str), device);
+		str = nm_device_get_iface (device);
+		if (str && !g_hash_table_contains (priv->devices_idx_iface, str))
+			g_hash_table_insert (priv->devices_idx_iface, g_strdup (str), device);
+	}
+}
+
 NMDevice *
 nm_manager_get_device_by_path (NMManager *manager, const char *object_path)
 {
-	const GPtrArray *devices;
-	int i;
-	NMDevice *device = NULL;
+	NMManagerPrivate *priv;
 
 	g_return_val_if_fail (NM_IS_MANAGER (manager), NULL);
 	g_return_val_if_fail (object_path, NULL);
 
-	devices = nm_manager_get_devices (manager);
-	for (i = 0; i < devices->len; i++) {
-		NMDevice *candidate = g_ptr_array_index (devices, i);
-		if (!strcmp (nm_object_get_path (NM_OBJECT (candidate)), object_path)) {
-			device = candidate;
-			break;
-		}
-	}
-
-	return device;
+	priv = NM_MANAGER_GET_PRIVATE (manager);
+	devices_idx_ensure (priv);
+	return priv->devices_idx_path ? g_hash_table_lookup (priv->devices_idx_path, object_path) : NULL;
 }
 
 NMDevice *
 nm_manager_get_device_by_iface (NMManager *manager, const char *iface)
 {
+	NMManagerPrivate *priv;
 	const GPtrArray *devices;
 	int i;
-	NMDevice *device = NULL;
+	NMDevice *device;
 
 	g_return_val_if_fail (NM_IS_MANAGER (manager), NULL);
 	g_return_val_if_fail (iface, NULL);
 
-	devices = nm_manager_get_devices (manager);
+	priv = NM_MANAGER_GET_PRIVATE (manager);
+	devices_idx_ensure (priv);
+	if (!priv->devices_idx_iface)
+		return NULL;
+
+	/* the interface name of a device can change without replacing the
+	 * array. Verify a hit, and fall back to searching on a stale one. */
+	device = g_hash_table_lookup (priv->devices_idx_iface, iface);
+	if (device && !g_strcmp0 (nm_device_get_iface (device), iface))
+		return device;
+
+	devices = priv->devices;
 	for (i = 0; i < devices->len; i++) {
 		NMDevice *candidate = g_ptr_array_index (devices, i);
-		if (!strcmp (nm_device_get_iface (candidate), iface)) {
-			device = candidate;
-			break;
-		}
+		if (!g_strcmp0 (nm_device_get_iface (candidate), iface))
+			return candidate;
 	}
 
-	return device;
+	return NULL;
+}
+
+static void
+devices_changed_cb (NMManager *manager, GParamSpec *pspec, gpointer user_data)
+{
+	/* don't keep removed devices alive until the next lookup. */
+	devices_idx_clear (NM_MANAGER_GET_PRIVATE (manager));
 }
 
 /*****************************************************************************/
@@ -1165,6 +1273,8 @@ constructed (GObject *object)
 
 	g_signal_connect (object, "notify::" NM_MANAGER_WIRELESS_ENABLED,
 	                  G_CALLBACK (wireless_enabled_cb), NULL);
+	g_signal_connect (object, "notify::" NM_MANAGER_DEVICES,
+	                  G_CALLBACK (devices_changed_cb), NULL);
 }
 
 static gboolean
@@ -1276,6 +1386,7 @@ dispose (GObject *object)
 
 	nm_clear_g_cancellable (&priv->perm_call_cancellable);
 
+	devices_idx_clear (priv);
 	if (priv->devices) {
 		g_ptr_array_unref (priv->devices);
 		priv->devices = NULL;
@@ -106,6 +106,13 @@ gboolean nm_manager_set_logging (NMManager *manager,
                                  const char *domains,
                                  GError **error);
 
+GVariant *nm_manager_get_platform_statistics (NMManager *manager,
+                                              GError **error);
+GVariant *nm_manager_get_memory_usage (NMManager *manager,
+                                       GError **error);
+GVariant *nm_manager_get_vpn_plugins (NMManager *manager,
+                                     GError **error);
+
 NMClientPermissionResult nm_manager_get_permission_result (NMManager *manager,
                                                            NMClientPermission permission);
 
@@ -41,6 +41,8 @@ void _nm_object_register_properties (NMObject *object,
 
 void _nm_object_queue_notify (NMObject *object, const char *property);
 
+gboolean _nm_object_has_pending_notify (NMObject *object);
+
 GDBusObjectManager *_nm_object_get_dbus_object_manager (NMObject *object);
 
 GQuark _nm_object_obj_nm_quark (void);
@@ -59,4 +61,6 @@ GDBusProxy *_nm_object_get_proxy (NMObject   *object,
 struct udev;
 void _nm_device_set_udev (NMDevice *device, struct udev *udev);
 
+NMSnapshot *_nm_snapshot_new (NMClient *client, NMSnapshot *previous);
+
 #endif /* __NM_OBJECT_PRIVATE_H__ */
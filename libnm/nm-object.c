@@ -323,6 +323,15 @@ _nm_object_queue_notify (NMObject *object, const char *property)
 	_nm_object_queue_notify_full (object, property, NULL, FALSE, NULL);
 }
 
+/* Whether property changes of @object are not yet notified. */
+gboolean
+_nm_object_has_pending_notify (NMObject *object)
+{
+	g_return_val_if_fail (NM_IS_OBJECT (object), FALSE);
+
+	return !!NM_OBJECT_GET_PRIVATE (object)->notify_items;
+}
+
 typedef struct {
 	NMObject *self;
 	PropertyInfo *pi;
@@ -368,30 +377,40 @@ wincaps_to_dash (const char *caps)
 	return g_string_free (str, FALSE);
 }
 
-/* Adds object to array if it's not already there */
+/* Adds object to array if it's not already in @set, and to @set */
 static void
-add_to_object_array_unique (GPtrArray *array, GObject *obj)
+add_to_object_array_unique (GPtrArray *array, GHashTable *set, GObject *obj)
 {
-	guint i;
-
 	g_return_if_fail (array != NULL);
 
 	if (obj != NULL) {
-		for (i = 0; i < array->len; i++) {
-			if (g_ptr_array_index (array, i) == obj) {
-				g_object_unref (obj);
-				return;
-			}
+		if (g_hash_table_contains (set, obj)) {
+			g_object_unref (obj);
+			return;
 		}
+		g_hash_table_add (set, obj);
 		g_ptr_array_add (array, obj);
 	}
 }
 
-/* Places items from 'needles' that are not in 'haystack' into 'diff' */
+static GHashTable *
+array_to_set (GPtrArray *array)
+{
+	GHashTable *set;
+	guint i;
+
+	set = g_hash_table_new (g_direct_hash, g_direct_equal);
+	for (i = 0; i < array->len; i++)
+		g_hash_table_add (set, g_ptr_array_index (array, i));
+	return set;
+}
+
+/* Places items from 'needles' that are not in 'haystack' into 'diff',
+ * in the order of 'needles' */
 static void
-array_diff (GPtrArray *needles, GPtrArray *haystack, GPtrArray *diff)
+array_diff (GPtrArray *needles, GHashTable *haystack, GPtrArray *diff)
 {
-	guint i, j;
+	guint i;
 	GObject *obj;
 
 	g_assert (needles);
@@ -400,13 +419,7 @@ array_diff (GPtrArray *needles, GPtrArray *haystack, GPtrArray *diff)
 
 	for (i = 0; i < needles->len; i++) {
 		obj = g_ptr_array_index (needles, i);
-
-		for (j = 0; j < haystack->len; j++) {
-			if (g_ptr_array_index (haystack, j) == obj)
-				break;
-		}
-
-		if (j == haystack->len)
+		if (!g_hash_table_contains (haystack, obj))
 			g_ptr_array_add (diff, obj);
 	}
 }
@@ -479,11 +492,13 @@ object_property_maybe_complete (NMObject *self)
 		if (odata->array) {
 			GPtrArray *old = *((GPtrArray **) pi->field);
 			GPtrArray *new;
+			gs_unref_hashtable GHashTable *new_set = NULL;
 
 			/* Build up new array */
 			new = g_ptr_array_new_full (odata->length, g_object_unref);
+			new_set = g_hash_table_new (g_direct_hash, g_direct_equal);
 			for (i = 0; i < odata->length; i++)
-				add_to_object_array_unique (new, odata->objects[i]);
+				add_to_object_array_unique (new, new_set, odata->objects[i]);
 
 			*((GPtrArray **) pi->field) = new;
 
@@ -492,11 +507,13 @@ object_property_maybe_complete (NMObject *self)
 				GPtrArray *removed = g_ptr_array_sized_new (3);
 
 				if (old) {
+					gs_unref_hashtable GHashTable *old_set = array_to_set (old);
+
 					/* Find objects in 'old' that do not exist in 'new' */
-					array_diff (old, new, removed);
+					array_diff (old, new_set, removed);
 
 					/* Find objects in 'new' that do not exist in old */
-					array_diff (new, old, added);
+					array_diff (new, old_set, added);
 				} else {
 					for (i = 0; i < new->len; i++)
 						g_ptr_array_add (added, g_ptr_array_index (new, i));
@@ -30,4 +30,18 @@ typedef enum {
 	NM_REMOTE_CONNECTION_INIT_RESULT_INVISIBLE,
 } NMRemoteConnectionInitResult;
 
+void _nm_remote_connection_prefetch_settings (NMRemoteConnection *const*connections,
+                                              guint len,
+                                              GCancellable *cancellable);
+
+void _nm_remote_connection_set_lazy_settings (NMRemoteConnection *self);
+
+gboolean _nm_remote_connection_fetch_settings (NMRemoteConnection *const*connections,
+                                               guint len,
+                                               GCancellable *cancellable,
+                                               GError **error);
+
+void _nm_remote_connection_apply_fetched_settings (NMRemoteConnection *self,
+                                                   GVariant *settings);
+
 #endif  /* __NM_REMOTE_CONNECTION_PRIVATE__ */
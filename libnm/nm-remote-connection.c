@@ -61,6 +61,15 @@ typedef struct {
 	gboolean unsaved;
 
 	gboolean visible;
+
+	/* the reply of _nm_remote_connection_prefetch_settings(), consumed
+	 * by init_sync(). %NULL with @prefetched set means invisible. */
+	GVariant *prefetched_settings;
+	bool prefetched;
+
+	/* the settings are only requested on first access, see
+	 * _nm_remote_connection_set_lazy_settings(). */
+	bool lazy_settings;
 } NMRemoteConnectionPrivate;
 
 #define NM_REMOTE_CONNECTION_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), NM_TYPE_REMOTE_CONNECTION, NMRemoteConnectionPrivate))
@@ -571,6 +580,45 @@ replace_settings (NMRemoteConnection *self, GVariant *new_settings)
 		g_clear_error (&error);
 }
 
+static void
+lazy_settings_apply (NMRemoteConnection *self, GVariant *settings)
+{
+	NMRemoteConnectionPrivate *priv = NM_REMOTE_CONNECTION_GET_PRIVATE (self);
+	gboolean visible;
+
+	if (settings) {
+		replace_settings (self, settings);
+		g_variant_unref (settings);
+		visible = TRUE;
+	} else {
+		/* Connection is not visible to this user. */
+		nm_connection_clear_settings (NM_CONNECTION (self));
+		visible = FALSE;
+	}
+
+	if (visible != priv->visible) {
+		priv->visible = visible;
+		/* this may run from within a getter of the caller, don't
+		 * modify the visible connections of NMClient under it. */
+		_nm_object_queue_notify (NM_OBJECT (self), NM_REMOTE_CONNECTION_VISIBLE);
+	}
+}
+
+static void
+lazy_settings_load (NMConnection *connection)
+{
+	NMRemoteConnectionPrivate *priv = NM_REMOTE_CONNECTION_GET_PRIVATE (connection);
+	GVariant *settings = NULL;
+
+	if (priv->proxy) {
+		nmdbus_settings_connection_call_get_settings_sync (priv->proxy,
+		                                                   &settings,
+		                                                   NULL,
+		                                                   NULL);
+	}
+	lazy_settings_apply (NM_REMOTE_CONNECTION (connection), settings);
+}
+
 static void
 updated_get_settings_cb (GObject *proxy,
                          GAsyncResult *result,
@@ -608,6 +656,16 @@ updated_cb (NMDBusSettingsConnection *proxy, gpointer user_data)
 	NMRemoteConnection *self = NM_REMOTE_CONNECTION (user_data);
 	NMRemoteConnectionPrivate *priv = NM_REMOTE_CONNECTION_GET_PRIVATE (self);
 
+	if (priv->lazy_settings) {
+		/* Request the replacement settings on the next access. Emit
+		 * "changed" for users that cache the settings. */
+		if (!_nm_connection_get_lazy_load_pending (NM_CONNECTION (self))) {
+			_nm_connection_set_lazy_load (NM_CONNECTION (self), lazy_settings_load);
+			g_signal_emit_by_name (self, NM_CONNECTION_CHANGED);
+		}
+		return;
+	}
+
 	/* The connection got updated; request the replacement settings */
 	nmdbus_settings_connection_call_get_settings (priv->proxy,
 	                                              NULL,
@@ -633,20 +691,209 @@ init_dbus (NMObject *object)
 	                                property_info);
 }
 
+typedef struct {
+	NMRemoteConnection *self;
+	guint *pending;
+} PrefetchData;
+
+static void
+prefetch_get_settings_cb (GObject *proxy,
+                          GAsyncResult *result,
+                          gpointer user_data)
+{
+	PrefetchData *data = user_data;
+	NMRemoteConnectionPrivate *priv = NM_REMOTE_CONNECTION_GET_PRIVATE (data->self);
+	GVariant *settings;
+	GError *error = NULL;
+
+	if (nmdbus_settings_connection_call_get_settings_finish (NMDBUS_SETTINGS_CONNECTION (proxy),
+	                                                         &settings, result, &error)) {
+		g_clear_pointer (&priv->prefetched_settings, g_variant_unref);
+		priv->prefetched_settings = settings;
+		priv->prefetched = TRUE;
+	} else if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		/* not visible */
+		g_clear_pointer (&priv->prefetched_settings, g_variant_unref);
+		priv->prefetched = TRUE;
+	}
+	g_clear_error (&error);
+
+	(*data->pending)--;
+	g_object_unref (data->self);
+	g_slice_free (PrefetchData, data);
+}
+
+/**
+ * _nm_remote_connection_prefetch_settings:
+ * @connections: (array length=len): the connections that are about to
+ *   be initialized with g_initable_init()
+ * @len: the number of @connections
+ * @cancellable: a #GCancellable, or %NULL
+ *
+ * Requests the settings of all @connections at once, and waits for
+ * the replies. Initializing the connections one after another would
+ * otherwise take a round-trip to the daemon for each connection.
+ */
+void
+_nm_remote_connection_prefetch_settings (NMRemoteConnection *const*connections,
+                                         guint len,
+                                         GCancellable *cancellable)
+{
+	GMainContext *context;
+	guint pending = 0;
+	guint i;
+
+	if (len == 0)
+		return;
+
+	context = g_main_context_new ();
+	g_main_context_push_thread_default (context);
+
+	for (i = 0; i < len; i++) {
+		gs_unref_object GDBusProxy *proxy = NULL;
+		PrefetchData *data;
+
+		g_return_if_fail (NM_IS_REMOTE_CONNECTION (connections[i]));
+
+		proxy = _nm_object_get_proxy (NM_OBJECT (connections[i]), NM_DBUS_INTERFACE_SETTINGS_CONNECTION);
+		if (!proxy)
+			continue;
+
+		data = g_slice_new (PrefetchData);
+		data->self = g_object_ref (connections[i]);
+		data->pending = &pending;
+		pending++;
+		nmdbus_settings_connection_call_get_settings (NMDBUS_SETTINGS_CONNECTION (proxy),
+		                                              cancellable,
+		                                              prefetch_get_settings_cb,
+		                                              data);
+	}
+
+	while (pending > 0)
+		g_main_context_iteration (context, TRUE);
+
+	g_main_context_pop_thread_default (context);
+	g_main_context_unref (context);
+}
+
+/**
+ * _nm_remote_connection_set_lazy_settings:
+ * @self: the #NMRemoteConnection, not yet initialized
+ *
+ * Don't request the settings during initialization and on updates, but
+ * on the first access to the settings. Until then, the connection is
+ * assumed to be visible.
+ */
+void
+_nm_remote_connection_set_lazy_settings (NMRemoteConnection *self)
+{
+	g_return_if_fail (NM_IS_REMOTE_CONNECTION (self));
+
+	NM_REMOTE_CONNECTION_GET_PRIVATE (self)->lazy_settings = TRUE;
+}
+
+/**
+ * _nm_remote_connection_fetch_settings:
+ * @connections: (array length=len): the connections
+ * @len: the number of @connections
+ * @cancellable: a #GCancellable, or %NULL
+ * @error: location for a #GError, or %NULL
+ *
+ * Requests the settings of all @connections, whose settings are not
+ * loaded yet, at once.
+ *
+ * Returns: %FALSE if @cancellable got cancelled.
+ */
+gboolean
+_nm_remote_connection_fetch_settings (NMRemoteConnection *const*connections,
+                                      guint len,
+                                      GCancellable *cancellable,
+                                      GError **error)
+{
+	gs_unref_ptrarray GPtrArray *pending = NULL;
+	guint i;
+
+	pending = g_ptr_array_new_full (len, g_object_unref);
+	for (i = 0; i < len; i++) {
+		g_return_val_if_fail (NM_IS_REMOTE_CONNECTION (connections[i]), FALSE);
+
+		if (_nm_connection_get_lazy_load_pending (NM_CONNECTION (connections[i])))
+			g_ptr_array_add (pending, g_object_ref (connections[i]));
+	}
+
+	_nm_remote_connection_prefetch_settings ((NMRemoteConnection *const*) pending->pdata,
+	                                         pending->len,
+	                                         cancellable);
+
+	for (i = 0; i < pending->len; i++) {
+		NMRemoteConnection *self = pending->pdata[i];
+		NMRemoteConnectionPrivate *priv = NM_REMOTE_CONNECTION_GET_PRIVATE (self);
+		GVariant *settings;
+
+		if (!priv->prefetched)
+			continue;
+
+		settings = priv->prefetched_settings;
+		priv->prefetched_settings = NULL;
+		priv->prefetched = FALSE;
+
+		_nm_remote_connection_apply_fetched_settings (self, settings);
+		if (settings)
+			g_variant_unref (settings);
+	}
+
+	return !g_cancellable_set_error_if_cancelled (cancellable, error);
+}
+
+/**
+ * _nm_remote_connection_apply_fetched_settings:
+ * @self: the #NMRemoteConnection
+ * @settings: (allow-none): the settings of @self, or %NULL if it is not
+ *   visible
+ *
+ * Sets the settings of a connection whose settings are not loaded yet,
+ * after they were requested together with those of other connections.
+ */
+void
+_nm_remote_connection_apply_fetched_settings (NMRemoteConnection *self,
+                                              GVariant *settings)
+{
+	g_return_if_fail (NM_IS_REMOTE_CONNECTION (self));
+
+	/* an access to the settings in between loaded them already,
+	 * or the connection got updated again. */
+	if (!_nm_connection_get_lazy_load_pending (NM_CONNECTION (self)))
+		return;
+
+	_nm_connection_set_lazy_load (NM_CONNECTION (self), NULL);
+	lazy_settings_apply (self, settings ? g_variant_ref (settings) : NULL);
+}
+
 static gboolean
 init_sync (GInitable *initable, GCancellable *cancellable, GError **error)
 {
 	NMRemoteConnection *self = NM_REMOTE_CONNECTION (initable);
 	NMRemoteConnectionPrivate *priv = NM_REMOTE_CONNECTION_GET_PRIVATE (initable);
-	GVariant *settings;
+	GVariant *settings = NULL;
 
 	priv->proxy = NMDBUS_SETTINGS_CONNECTION (_nm_object_get_proxy (NM_OBJECT (initable), NM_DBUS_INTERFACE_SETTINGS_CONNECTION));
 	g_signal_connect (priv->proxy, "updated", G_CALLBACK (updated_cb), initable);
 
-	if (nmdbus_settings_connection_call_get_settings_sync (priv->proxy,
-	                                                       &settings,
-	                                                       cancellable,
-	                                                       NULL)) {
+	if (priv->lazy_settings) {
+		priv->visible = TRUE;
+		_nm_connection_set_lazy_load (NM_CONNECTION (self), lazy_settings_load);
+	} else if (priv->prefetched) {
+		settings = priv->prefetched_settings;
+		priv->prefetched_settings = NULL;
+		priv->prefetched = FALSE;
+	} else {
+		nmdbus_settings_connection_call_get_settings_sync (priv->proxy,
+		                                                   &settings,
+		                                                   cancellable,
+		                                                   NULL);
+	}
+
+	if (settings) {
 		priv->visible = TRUE;
 		replace_settings (self, settings);
 		g_variant_unref (settings);
@@ -733,6 +980,14 @@ init_async (GAsyncInitable *initable, int io_priority,
 	g_signal_connect (priv->proxy, "updated",
 	                  G_CALLBACK (updated_cb), initable);
 
+	if (priv->lazy_settings) {
+		priv->visible = TRUE;
+		_nm_connection_set_lazy_load (NM_CONNECTION (initable), lazy_settings_load);
+		nm_remote_connection_parent_async_initable_iface->
+			init_async (initable, io_priority, init_data->cancellable, init_async_parent_inited, init_data);
+		return;
+	}
+
 	nmdbus_settings_connection_call_get_settings (NM_REMOTE_CONNECTION_GET_PRIVATE (init_data->initable)->proxy,
 	                                              init_data->cancellable,
 	                                              init_get_settings_cb, init_data);
@@ -774,7 +1029,9 @@ dispose (GObject *object)
 {
 	NMRemoteConnectionPrivate *priv = NM_REMOTE_CONNECTION_GET_PRIVATE (object);
 
+	_nm_connection_set_lazy_load (NM_CONNECTION (object), NULL);
 	g_clear_object (&priv->proxy);
+	g_clear_pointer (&priv->prefetched_settings, g_variant_unref);
 
 	G_OBJECT_CLASS (nm_remote_connection_parent_class)->dispose (object);
 }
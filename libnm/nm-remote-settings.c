@@ -39,6 +39,13 @@
 
 G_DEFINE_TYPE (NMRemoteSettings, nm_remote_settings, NM_TYPE_OBJECT)
 
+typedef enum {
+	CONNECTION_IDX_ID,
+	CONNECTION_IDX_UUID,
+	CONNECTION_IDX_PATH,
+	_CONNECTION_IDX_NUM,
+} ConnectionIdxType;
+
 #define NM_REMOTE_SETTINGS_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), NM_TYPE_REMOTE_SETTINGS, NMRemoteSettingsPrivate))
 
 typedef struct {
@@ -46,6 +53,11 @@ typedef struct {
 	GPtrArray *all_connections;
 	GPtrArray *visible_connections;
 
+	/* indexes of visible_connections by id, uuid and path. They are
+	 * built on the first lookup and dropped whenever visible_connections
+	 * or one of the connections changes. */
+	GHashTable *idx[_CONNECTION_IDX_NUM];
+
 	/* AddConnectionInfo objects that are waiting for the connection to become initialized */
 	GSList *add_list;
 
@@ -123,24 +135,46 @@ add_connection_info_complete (NMRemoteSettings *self,
 
 typedef const char * (*ConnectionStringGetter) (NMConnection *);
 
+static void
+idx_clear (NMRemoteSettings *self)
+{
+	NMRemoteSettingsPrivate *priv = NM_REMOTE_SETTINGS_GET_PRIVATE (self);
+	guint i;
+
+	for (i = 0; i < _CONNECTION_IDX_NUM; i++)
+		g_clear_pointer (&priv->idx[i], g_hash_table_unref);
+}
+
 static NMRemoteConnection *
 get_connection_by_string (NMRemoteSettings *settings,
                           const char *string,
+                          ConnectionIdxType idx_type,
                           ConnectionStringGetter get_comparison_string)
 {
 	NMRemoteSettingsPrivate *priv;
+	GHashTable *idx;
 	NMConnection *candidate;
+	const char *str;
 	int i;
 
 	priv = NM_REMOTE_SETTINGS_GET_PRIVATE (settings);
 
-	for (i = 0; i < priv->visible_connections->len; i++) {
-		candidate = priv->visible_connections->pdata[i];
-		if (!g_strcmp0 (string, get_comparison_string (candidate)))
-			return NM_REMOTE_CONNECTION (candidate);
+	idx = priv->idx[idx_type];
+	if (!idx) {
+		/* the keys are cloned, because a change of the connection frees them
+		 * before we get the "changed" signal. Ids are not unique, the first
+		 * connection wins like before. */
+		idx = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+		for (i = 0; i < priv->visible_connections->len; i++) {
+			candidate = priv->visible_connections->pdata[i];
+			str = get_comparison_string (candidate);
+			if (str && !g_hash_table_contains (idx, str))
+				g_hash_table_insert (idx, g_strdup (str), candidate);
+		}
+		priv->idx[idx_type] = idx;
 	}
 
-	return NULL;
+	return g_hash_table_lookup (idx, string);
 }
 
 NMRemoteConnection *
@@ -149,7 +183,7 @@ nm_remote_settings_get_connection_by_id (NMRemoteSettings *settings, const char
 	g_return_val_if_fail (NM_IS_REMOTE_SETTINGS (settings), NULL);
 	g_return_val_if_fail (id != NULL, NULL);
 
-	return get_connection_by_string (settings, id, nm_connection_get_id);
+	return get_connection_by_string (settings, id, CONNECTION_IDX_ID, nm_connection_get_id);
 }
 
 NMRemoteConnection *
@@ -158,7 +192,7 @@ nm_remote_settings_get_connection_by_path (NMRemoteSettings *settings, const cha
 	g_return_val_if_fail (NM_IS_REMOTE_SETTINGS (settings), NULL);
 	g_return_val_if_fail (path != NULL, NULL);
 
-	return get_connection_by_string (settings, path, nm_connection_get_path);
+	return get_connection_by_string (settings, path, CONNECTION_IDX_PATH, nm_connection_get_path);
 }
 
 NMRemoteConnection *
@@ -167,7 +201,13 @@ nm_remote_settings_get_connection_by_uuid (NMRemoteSettings *settings, const cha
 	g_return_val_if_fail (NM_IS_REMOTE_SETTINGS (settings), NULL);
 	g_return_val_if_fail (uuid != NULL, NULL);
 
-	return get_connection_by_string (settings, uuid, nm_connection_get_uuid);
+	return get_connection_by_string (settings, uuid, CONNECTION_IDX_UUID, nm_connection_get_uuid);
+}
+
+static void
+connection_changed (NMConnection *connection, gpointer user_data)
+{
+	idx_clear (user_data);
 }
 
 static void
@@ -189,6 +229,7 @@ cleanup_connection (NMRemoteSettings *self,
                     NMRemoteConnection *remote)
 {
 	g_signal_handlers_disconnect_by_func (remote, G_CALLBACK (connection_visible_changed), self);
+	g_signal_handlers_disconnect_by_func (remote, G_CALLBACK (connection_changed), self);
 }
 
 static void
@@ -211,7 +252,9 @@ connection_removed (NMRemoteSettings *self,
 		cleanup_connection (self, remote);
 
 	/* Allow the signal to propagate if and only if @remote was in visible_connections */
-	if (!g_ptr_array_remove (priv->visible_connections, remote))
+	if (g_ptr_array_remove (priv->visible_connections, remote))
+		idx_clear (self);
+	else
 		g_signal_stop_emission (self, signals[CONNECTION_REMOVED], 0);
 }
 
@@ -229,11 +272,16 @@ connection_added (NMRemoteSettings *self,
 		                  "notify::" NM_REMOTE_CONNECTION_VISIBLE,
 		                  G_CALLBACK (connection_visible_changed),
 		                  self);
+		g_signal_connect (remote,
+		                  NM_CONNECTION_CHANGED,
+		                  G_CALLBACK (connection_changed),
+		                  self);
 	}
 
-	if (nm_remote_connection_get_visible (remote))
+	if (nm_remote_connection_get_visible (remote)) {
 		g_ptr_array_add (priv->visible_connections, remote);
-	else
+		idx_clear (self);
+	} else
 		g_signal_stop_emission (self, signals[CONNECTION_ADDED], 0);
 
 	path = nm_connection_get_path (NM_CONNECTION (remote));
@@ -440,6 +488,92 @@ nm_remote_settings_load_connections_finish (NMRemoteSettings *settings,
 	}
 }
 
+/**
+ * nm_remote_settings_fetch_connection_settings:
+ * @settings: the %NMRemoteSettings
+ * @connections: (element-type NMRemoteConnection): the connections
+ * @cancellable: a #GCancellable, or %NULL
+ * @error: location for a #GError, or %NULL
+ *
+ * Requests the settings of all @connections, whose settings are not
+ * loaded yet, with a single ListConnectionsWithSettings call. Daemons
+ * without that method are asked for the settings of each connection.
+ *
+ * Returns: %FALSE if @cancellable got cancelled.
+ */
+gboolean
+nm_remote_settings_fetch_connection_settings (NMRemoteSettings *settings,
+                                              const GPtrArray *connections,
+                                              GCancellable *cancellable,
+                                              GError **error)
+{
+	NMRemoteSettingsPrivate *priv;
+	gs_unref_ptrarray GPtrArray *pending = NULL;
+	gs_unref_variant GVariant *result = NULL;
+	gs_unref_hashtable GHashTable *by_path = NULL;
+	gs_free_error GError *local = NULL;
+	gs_free const char **paths = NULL;
+	GVariantIter iter;
+	const char *path;
+	GVariant *con_settings;
+	guint i;
+
+	g_return_val_if_fail (NM_IS_REMOTE_SETTINGS (settings), FALSE);
+	g_return_val_if_fail (connections, FALSE);
+
+	priv = NM_REMOTE_SETTINGS_GET_PRIVATE (settings);
+
+	pending = g_ptr_array_new_full (connections->len, g_object_unref);
+	for (i = 0; i < connections->len; i++) {
+		NMConnection *connection = connections->pdata[i];
+
+		g_return_val_if_fail (NM_IS_REMOTE_CONNECTION (connection), FALSE);
+
+		if (_nm_connection_get_lazy_load_pending (connection))
+			g_ptr_array_add (pending, g_object_ref (connection));
+	}
+	if (!pending->len)
+		return TRUE;
+
+	paths = g_new (const char *, pending->len + 1);
+	for (i = 0; i < pending->len; i++)
+		paths[i] = nm_object_get_path (NM_OBJECT (pending->pdata[i]));
+	paths[i] = NULL;
+
+	if (!nmdbus_settings_call_list_connections_with_settings_sync (priv->proxy,
+	                                                               paths,
+	                                                               &result,
+	                                                               cancellable,
+	                                                               &local)) {
+		if (g_error_matches (local, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+			g_propagate_error (error, g_steal_pointer (&local));
+			return FALSE;
+		}
+
+		/* an older daemon doesn't have the method */
+		return _nm_remote_connection_fetch_settings ((NMRemoteConnection *const*) pending->pdata,
+		                                             pending->len,
+		                                             cancellable,
+		                                             error);
+	}
+
+	by_path = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) g_variant_unref);
+	g_variant_iter_init (&iter, result);
+	while (g_variant_iter_next (&iter, "{&o@a{sa{sv}}}", &path, &con_settings))
+		g_hash_table_insert (by_path, (gpointer) path, con_settings);
+
+	/* connections missing in the result are not visible to the user. */
+	for (i = 0; i < pending->len; i++) {
+		NMRemoteConnection *connection = pending->pdata[i];
+
+		_nm_remote_connection_apply_fetched_settings (connection,
+		                                              g_hash_table_lookup (by_path,
+		                                                                   nm_object_get_path (NM_OBJECT (connection))));
+	}
+
+	return !g_cancellable_set_error_if_cancelled (cancellable, error);
+}
+
 gboolean
 nm_remote_settings_reload_connections (NMRemoteSettings *settings,
                                        GCancellable *cancellable,
@@ -670,6 +804,7 @@ dispose (GObject *object)
 	}
 
 	g_clear_pointer (&priv->visible_connections, g_ptr_array_unref);
+	idx_clear (self);
 	g_clear_pointer (&priv->hostname, g_free);
 	g_clear_object (&priv->proxy);
 
@@ -101,6 +101,11 @@ gboolean nm_remote_settings_load_connections_finish (NMRemoteSettings *settings,
                                                      GAsyncResult *result,
                                                      GError **error);
 
+gboolean nm_remote_settings_fetch_connection_settings (NMRemoteSettings *settings,
+                                                       const GPtrArray *connections,
+                                                       GCancellable *cancellable,
+                                                       GError **error);
+
 gboolean nm_remote_settings_reload_connections        (NMRemoteSettings *settings,
                                                        GCancellable *cancellable,
                                                        GError **error);
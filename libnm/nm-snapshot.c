@@ -0,0 +1,1149 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ * Copyright 2017 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "nm-snapshot.h"
+
+#include <string.h>
+
+#include "nm-client.h"
+#include "nm-device.h"
+#include "nm-active-connection.h"
+#include "nm-remote-connection.h"
+#include "nm-ip-config.h"
+#include "nm-object-private.h"
+#include "nm-core-internal.h"
+
+/**
+ * SECTION:nm-snapshot
+ * @short_description: Immutable view of the client state
+ *
+ * An #NMSnapshot is a copy of the devices, active connections and
+ * connection profiles of an #NMClient at one point in time. It is created
+ * with nm_client_get_snapshot() from the thread that owns the main context
+ * of the client. Unlike the #NMObject instances it is built from, a
+ * snapshot never changes and its reference counting is atomic, so it can
+ * be passed to and read from any thread.
+ *
+ * Consecutive snapshots share the entries of objects that did not change,
+ * so comparing entries by pointer is enough to find out what changed
+ * between two snapshots. If nothing changed at all, the same snapshot is
+ * returned again. The change notifications of the objects are tracked,
+ * so only the entries of objects that changed are copied again.
+ */
+
+/*****************************************************************************/
+
+struct _NMSnapshotDevice {
+	int refcount;
+	char *path;
+	char *iface;
+	char *ip_iface;
+	char *hw_address;
+	char *active_connection_path;
+	char **ip4_addresses;
+	char *ip4_gateway;
+	char **ip6_addresses;
+	char *ip6_gateway;
+	NMDeviceType device_type;
+	NMDeviceState state;
+};
+
+struct _NMSnapshotActiveConnection {
+	int refcount;
+	char *path;
+	char *connection_path;
+	char *id;
+	char *uuid;
+	char *type;
+	char **device_paths;
+	NMActiveConnectionState state;
+	bool is_default:1;
+	bool is_default6:1;
+	bool vpn:1;
+};
+
+struct _NMSnapshotConnection {
+	int refcount;
+	char *path;
+	char *id;
+	char *uuid;
+	char *type;
+	char *interface_name;
+	bool unsaved:1;
+};
+
+struct _NMSnapshot {
+	int refcount;
+	NMState state;
+	guint n_devices;
+	guint n_active_connections;
+	guint n_connections;
+	NMSnapshotDevice **devices;
+	NMSnapshotActiveConnection **active_connections;
+	NMSnapshotConnection **connections;
+};
+
+G_DEFINE_BOXED_TYPE (NMSnapshot, nm_snapshot, nm_snapshot_ref, nm_snapshot_unref)
+G_DEFINE_BOXED_TYPE (NMSnapshotDevice, nm_snapshot_device, nm_snapshot_device_ref, nm_snapshot_device_unref)
+G_DEFINE_BOXED_TYPE (NMSnapshotActiveConnection, nm_snapshot_active_connection, nm_snapshot_active_connection_ref, nm_snapshot_active_connection_unref)
+G_DEFINE_BOXED_TYPE (NMSnapshotConnection, nm_snapshot_connection, nm_snapshot_connection_ref, nm_snapshot_connection_unref)
+
+/* The EntryCache of an NMObject. */
+static GQuark
+_entry_quark (void)
+{
+	static GQuark quark;
+
+	if (G_UNLIKELY (!quark))
+		quark = g_quark_from_static_string ("libnm-snapshot-entry");
+	return quark;
+}
+
+/*****************************************************************************/
+
+static char **
+_ip_addresses_to_strv (NMIPConfig *config)
+{
+	GPtrArray *addresses;
+	char **strv;
+	guint i;
+
+	addresses = config ? nm_ip_config_get_addresses (config) : NULL;
+	if (!addresses)
+		return g_new0 (char *, 1);
+
+	strv = g_new (char *, addresses->len + 1);
+	for (i = 0; i < addresses->len; i++) {
+		NMIPAddress *a = addresses->pdata[i];
+
+		strv[i] = g_strdup_printf ("%s/%u",
+		                           nm_ip_address_get_address (a),
+		                           nm_ip_address_get_prefix (a));
+	}
+	strv[i] = NULL;
+	return strv;
+}
+
+static char **
+_object_paths_to_strv (const GPtrArray *objects)
+{
+	char **strv;
+	guint i;
+
+	if (!objects)
+		return g_new0 (char *, 1);
+
+	strv = g_new (char *, objects->len + 1);
+	for (i = 0; i < objects->len; i++)
+		strv[i] = g_strdup (nm_object_get_path (objects->pdata[i]));
+	strv[i] = NULL;
+	return strv;
+}
+
+static const char *
+_object_path (gpointer object)
+{
+	return object ? nm_object_get_path (object) : NULL;
+}
+
+/*****************************************************************************/
+
+/**
+ * nm_snapshot_device_ref:
+ * @device: the #NMSnapshotDevice
+ *
+ * Increases the reference count of @device. This is thread-safe.
+ *
+ * Returns: @device
+ *
+ * Since: 1.10
+ **/
+NMSnapshotDevice *
+nm_snapshot_device_ref (NMSnapshotDevice *device)
+{
+	g_return_val_if_fail (device, NULL);
+	g_return_val_if_fail (device->refcount > 0, NULL);
+
+	g_atomic_int_inc (&device->refcount);
+	return device;
+}
+
+/**
+ * nm_snapshot_device_unref:
+ * @device: the #NMSnapshotDevice
+ *
+ * Decreases the reference count of @device and frees it when the count
+ * drops to zero. This is thread-safe.
+ *
+ * Since: 1.10
+ **/
+void
+nm_snapshot_device_unref (NMSnapshotDevice *device)
+{
+	g_return_if_fail (device);
+	g_return_if_fail (device->refcount > 0);
+
+	if (!g_atomic_int_dec_and_test (&device->refcount))
+		return;
+
+	g_free (device->path);
+	g_free (device->iface);
+	g_free (device->ip_iface);
+	g_free (device->hw_address);
+	g_free (device->active_connection_path);
+	g_strfreev (device->ip4_addresses);
+	g_free (device->ip4_gateway);
+	g_strfreev (device->ip6_addresses);
+	g_free (device->ip6_gateway);
+	g_slice_free (NMSnapshotDevice, device);
+}
+
+static gboolean
+_device_equal (const NMSnapshotDevice *a, const NMSnapshotDevice *b)
+{
+	return    a->device_type == b->device_type
+	       && a->state == b->state
+	       && nm_streq0 (a->path, b->path)
+	       && nm_streq0 (a->iface, b->iface)
+	       && nm_streq0 (a->ip_iface, b->ip_iface)
+	       && nm_streq0 (a->hw_address, b->hw_address)
+	       && nm_streq0 (a->active_connection_path, b->active_connection_path)
+	       && nm_streq0 (a->ip4_gateway, b->ip4_gateway)
+	       && nm_streq0 (a->ip6_gateway, b->ip6_gateway)
+	       && _nm_utils_strv_equal (a->ip4_addresses, b->ip4_addresses)
+	       && _nm_utils_strv_equal (a->ip6_addresses, b->ip6_addresses);
+}
+
+static NMSnapshotDevice *
+_device_new (NMDevice *device)
+{
+	NMSnapshotDevice *entry;
+	NMIPConfig *ip4_config = nm_device_get_ip4_config (device);
+	NMIPConfig *ip6_config = nm_device_get_ip6_config (device);
+
+	entry = g_slice_new0 (NMSnapshotDevice);
+	entry->refcount = 1;
+	entry->path = g_strdup (nm_object_get_path (NM_OBJECT (device)));
+	entry->iface = g_strdup (nm_device_get_iface (device));
+	entry->ip_iface = g_strdup (nm_device_get_ip_iface (device));
+	entry->hw_address = g_strdup (nm_device_get_hw_address (device));
+	entry->active_connection_path = g_strdup (_object_path (nm_device_get_active_connection (device)));
+	entry->ip4_addresses = _ip_addresses_to_strv (ip4_config);
+	entry->ip4_gateway = g_strdup (ip4_config ? nm_ip_config_get_gateway (ip4_config) : NULL);
+	entry->ip6_addresses = _ip_addresses_to_strv (ip6_config);
+	entry->ip6_gateway = g_strdup (ip6_config ? nm_ip_config_get_gateway (ip6_config) : NULL);
+	entry->device_type = nm_device_get_device_type (device);
+	entry->state = nm_device_get_state (device);
+	return entry;
+}
+
+/**
+ * nm_snapshot_device_get_path:
+ * @device: the #NMSnapshotDevice
+ *
+ * Returns: the D-Bus path of the device
+ *
+ * Since: 1.10
+ **/
+const char *
+nm_snapshot_device_get_path (NMSnapshotDevice *device)
+{
+	g_return_val_if_fail (device, NULL);
+	return device->path;
+}
+
+/**
+ * nm_snapshot_device_get_iface:
+ * @device: the #NMSnapshotDevice
+ *
+ * Returns: the interface name of the device
+ *
+ * Since: 1.10
+ **/
+const char *
+nm_snapshot_device_get_iface (NMSnapshotDevice *device)
+{
+	g_return_val_if_fail (device, NULL);
+	return device->iface;
+}
+
+/**
+ * nm_snapshot_device_get_ip_iface:
+ * @device: the #NMSnapshotDevice
+ *
+ * Returns: the IP interface name of the device, see nm_device_get_ip_iface()
+ *
+ * Since: 1.10
+ **/
+const char *
+nm_snapshot_device_get_ip_iface (NMSnapshotDevice *device)
+{
+	g_return_val_if_fail (device, NULL);
+	return device->ip_iface;
+}
+
+/**
+ * nm_snapshot_device_get_device_type:
+ * @device: the #NMSnapshotDevice
+ *
+ * Returns: the type of the device
+ *
+ * Since: 1.10
+ **/
+NMDeviceType
+nm_snapshot_device_get_device_type (NMSnapshotDevice *device)
+{
+	g_return_val_if_fail (device, NM_DEVICE_TYPE_UNKNOWN);
+	return device->device_type;
+}
+
+/**
+ * nm_snapshot_device_get_state:
+ * @device: the #NMSnapshotDevice
+ *
+ * Returns: the state of the device
+ *
+ * Since: 1.10
+ **/
+NMDeviceState
+nm_snapshot_device_get_state (NMSnapshotDevice *device)
+{
+	g_return_val_if_fail (device, NM_DEVICE_STATE_UNKNOWN);
+	return device->state;
+}
+
+/**
+ * nm_snapshot_device_get_hw_address:
+ * @device: the #NMSnapshotDevice
+ *
+ * Returns: the current hardware address of the device
+ *
+ * Since: 1.10
+ **/
+const char *
+nm_snapshot_device_get_hw_address (NMSnapshotDevice *device)
+{
+	g_return_val_if_fail (device, NULL);
+	return device->hw_address;
+}
+
+/**
+ * nm_snapshot_device_get_active_connection_path:
+ * @device: the #NMSnapshotDevice
+ *
+ * Returns: the D-Bus path of the active connection of the device, which
+ * can be looked up in the active connections of the same #NMSnapshot, or
+ * %NULL
+ *
+ * Since: 1.10
+ **/
+const char *
+nm_snapshot_device_get_active_connection_path (NMSnapshotDevice *device)
+{
+	g_return_val_if_fail (device, NULL);
+	return device->active_connection_path;
+}
+
+/**
+ * nm_snapshot_device_get_ip4_addresses:
+ * @device: the #NMSnapshotDevice
+ *
+ * Returns: (transfer none): the IPv4 addresses of the device in
+ * "address/prefix" notation. The array is never %NULL.
+ *
+ * Since: 1.10
+ **/
+const char * const *
+nm_snapshot_device_get_ip4_addresses (NMSnapshotDevice *device)
+{
+	g_return_val_if_fail (device, NULL);
+	return (const char * const *) device->ip4_addresses;
+}
+
+/**
+ * nm_snapshot_device_get_ip4_gateway:
+ * @device: the #NMSnapshotDevice
+ *
+ * Returns: the IPv4 gateway of the device, or %NULL
+ *
+ * Since: 1.10
+ **/
+const char *
+nm_snapshot_device_get_ip4_gateway (NMSnapshotDevice *device)
+{
+	g_return_val_if_fail (device, NULL);
+	return device->ip4_gateway;
+}
+
+/**
+ * nm_snapshot_device_get_ip6_addresses:
+ * @device: the #NMSnapshotDevice
+ *
+ * Returns: (transfer none): the IPv6 addresses of the device in
+ * "address/prefix" notation. The array is never %NULL.
+ *
+ * Since: 1.10
+ **/
+const char * const *
+nm_snapshot_device_get_ip6_addresses (NMSnapshotDevice *device)
+{
+	g_return_val_if_fail (device, NULL);
+	return (const char * const *) device->ip6_addresses;
+}
+
+/**
+ * nm_snapshot_device_get_ip6_gateway:
+ * @device: the #NMSnapshotDevice
+ *
+ * Returns: the IPv6 gateway of the device, or %NULL
+ *
+ * Since: 1.10
+ **/
+const char *
+nm_snapshot_device_get_ip6_gateway (NMSnapshotDevice *device)
+{
+	g_return_val_if_fail (device, NULL);
+	return device->ip6_gateway;
+}
+
+/*****************************************************************************/
+
+/**
+ * nm_snapshot_active_connection_ref:
+ * @active: the #NMSnapshotActiveConnection
+ *
+ * Increases the reference count of @active. This is thread-safe.
+ *
+ * Returns: @active
+ *
+ * Since: 1.10
+ **/
+NMSnapshotActiveConnection *
+nm_snapshot_active_connection_ref (NMSnapshotActiveConnection *active)
+{
+	g_return_val_if_fail (active, NULL);
+	g_return_val_if_fail (active->refcount > 0, NULL);
+
+	g_atomic_int_inc (&active->refcount);
+	return active;
+}
+
+/**
+ * nm_snapshot_active_connection_unref:
+ * @active: the #NMSnapshotActiveConnection
+ *
+ * Decreases the reference count of @active and frees it when the count
+ * drops to zero. This is thread-safe.
+ *
+ * Since: 1.10
+ **/
+void
+nm_snapshot_active_connection_unref (NMSnapshotActiveConnection *active)
+{
+	g_return_if_fail (active);
+	g_return_if_fail (active->refcount > 0);
+
+	if (!g_atomic_int_dec_and_test (&active->refcount))
+		return;
+
+	g_free (active->path);
+	g_free (active->connection_path);
+	g_free (active->id);
+	g_free (active->uuid);
+	g_free (active->type);
+	g_strfreev (active->device_paths);
+	g_slice_free (NMSnapshotActiveConnection, active);
+}
+
+static gboolean
+_active_connection_equal (const NMSnapshotActiveConnection *a, const NMSnapshotActiveConnection *b)
+{
+	return    a->state == b->state
+	       && a->is_default == b->is_default
+	       && a->is_default6 == b->is_default6
+	       && a->vpn == b->vpn
+	       && nm_streq0 (a->path, b->path)
+	       && nm_streq0 (a->connection_path, b->connection_path)
+	       && nm_streq0 (a->id, b->id)
+	       && nm_streq0 (a->uuid, b->uuid)
+	       && nm_streq0 (a->type, b->type)
+	       && _nm_utils_strv_equal (a->device_paths, b->device_paths);
+}
+
+static NMSnapshotActiveConnection *
+_active_connection_new (NMActiveConnection *active)
+{
+	NMSnapshotActiveConnection *entry;
+
+	entry = g_slice_new0 (NMSnapshotActiveConnection);
+	entry->refcount = 1;
+	entry->path = g_strdup (nm_object_get_path (NM_OBJECT (active)));
+	entry->connection_path = g_strdup (_object_path (nm_active_connection_get_connection (active)));
+	entry->id = g_strdup (nm_active_connection_get_id (active));
+	entry->uuid = g_strdup (nm_active_connection_get_uuid (active));
+	entry->type = g_strdup (nm_active_connection_get_connection_type (active));
+	entry->device_paths = _object_paths_to_strv (nm_active_connection_get_devices (active));
+	entry->state = nm_active_connection_get_state (active);
+	entry->is_default = nm_active_connection_get_default (active);
+	entry->is_default6 = nm_active_connection_get_default6 (active);
+	entry->vpn = nm_active_connection_get_vpn (active);
+	return entry;
+}
+
+/**
+ * nm_snapshot_active_connection_get_path:
+ * @active: the #NMSnapshotActiveConnection
+ *
+ * Returns: the D-Bus path of the active connection
+ *
+ * Since: 1.10
+ **/
+const char *
+nm_snapshot_active_connection_get_path (NMSnapshotActiveConnection *active)
+{
+	g_return_val_if_fail (active, NULL);
+	return active->path;
+}
+
+/**
+ * nm_snapshot_active_connection_get_connection_path:
+ * @active: the #NMSnapshotActiveConnection
+ *
+ * Returns: the D-Bus path of the connection profile that was activated,
+ * or %NULL
+ *
+ * Since: 1.10
+ **/
+const char *
+nm_snapshot_active_connection_get_connection_path (NMSnapshotActiveConnection *active)
+{
+	g_return_val_if_fail (active, NULL);
+	return active->connection_path;
+}
+
+/**
+ * nm_snapshot_active_connection_get_id:
+ * @active: the #NMSnapshotActiveConnection
+ *
+ * Returns: the ID of the connection profile
+ *
+ * Since: 1.10
+ **/
+const char *
+nm_snapshot_active_connection_get_id (NMSnapshotActiveConnection *active)
+{
+	g_return_val_if_fail (active, NULL);
+	return active->id;
+}
+
+/**
+ * nm_snapshot_active_connection_get_uuid:
+ * @active: the #NMSnapshotActiveConnection
+ *
+ * Returns: the UUID of the connection profile
+ *
+ * Since: 1.10
+ **/
+const char *
+nm_snapshot_active_connection_get_uuid (NMSnapshotActiveConnection *active)
+{
+	g_return_val_if_fail (active, NULL);
+	return active->uuid;
+}
+
+/**
+ * nm_snapshot_active_connection_get_connection_type:
+ * @active: the #NMSnapshotActiveConnection
+ *
+ * Returns: the type of the connection profile
+ *
+ * Since: 1.10
+ **/
+const char *
+nm_snapshot_active_connection_get_connection_type (NMSnapshotActiveConnection *active)
+{
+	g_return_val_if_fail (active, NULL);
+	return active->type;
+}
+
+/**
+ * nm_snapshot_active_connection_get_state:
+ * @active: the #NMSnapshotActiveConnection
+ *
+ * Returns: the state of the active connection
+ *
+ * Since: 1.10
+ **/
+NMActiveConnectionState
+nm_snapshot_active_connection_get_state (NMSnapshotActiveConnection *active)
+{
+	g_return_val_if_fail (active, NM_ACTIVE_CONNECTION_STATE_UNKNOWN);
+	return active->state;
+}
+
+/**
+ * nm_snapshot_active_connection_get_device_paths:
+ * @active: the #NMSnapshotActiveConnection
+ *
+ * Returns: (transfer none): the D-Bus paths of the devices of the active
+ * connection. The array is never %NULL.
+ *
+ * Since: 1.10
+ **/
+const char * const *
+nm_snapshot_active_connection_get_device_paths (NMSnapshotActiveConnection *active)
+{
+	g_return_val_if_fail (active, NULL);
+	return (const char * const *) active->device_paths;
+}
+
+/**
+ * nm_snapshot_active_connection_get_default:
+ * @active: the #NMSnapshotActiveConnection
+ *
+ * Returns: whether the active connection has the IPv4 default route
+ *
+ * Since: 1.10
+ **/
+gboolean
+nm_snapshot_active_connection_get_default (NMSnapshotActiveConnection *active)
+{
+	g_return_val_if_fail (active, FALSE);
+	return active->is_default;
+}
+
+/**
+ * nm_snapshot_active_connection_get_default6:
+ * @active: the #NMSnapshotActiveConnection
+ *
+ * Returns: whether the active connection has the IPv6 default route
+ *
+ * Since: 1.10
+ **/
+gboolean
+nm_snapshot_active_connection_get_default6 (NMSnapshotActiveConnection *active)
+{
+	g_return_val_if_fail (active, FALSE);
+	return active->is_default6;
+}
+
+/**
+ * nm_snapshot_active_connection_get_vpn:
+ * @active: the #NMSnapshotActiveConnection
+ *
+ * Returns: whether the active connection is a VPN connection
+ *
+ * Since: 1.10
+ **/
+gboolean
+nm_snapshot_active_connection_get_vpn (NMSnapshotActiveConnection *active)
+{
+	g_return_val_if_fail (active, FALSE);
+	return active->vpn;
+}
+
+/*****************************************************************************/
+
+/**
+ * nm_snapshot_connection_ref:
+ * @connection: the #NMSnapshotConnection
+ *
+ * Increases the reference count of @connection. This is thread-safe.
+ *
+ * Returns: @connection
+ *
+ * Since: 1.10
+ **/
+NMSnapshotConnection *
+nm_snapshot_connection_ref (NMSnapshotConnection *connection)
+{
+	g_return_val_if_fail (connection, NULL);
+	g_return_val_if_fail (connection->refcount > 0, NULL);
+
+	g_atomic_int_inc (&connection->refcount);
+	return connection;
+}
+
+/**
+ * nm_snapshot_connection_unref:
+ * @connection: the #NMSnapshotConnection
+ *
+ * Decreases the reference count of @connection and frees it when the
+ * count drops to zero. This is thread-safe.
+ *
+ * Since: 1.10
+ **/
+void
+nm_snapshot_connection_unref (NMSnapshotConnection *connection)
+{
+	g_return_if_fail (connection);
+	g_return_if_fail (connection->refcount > 0);
+
+	if (!g_atomic_int_dec_and_test (&connection->refcount))
+		return;
+
+	g_free (connection->path);
+	g_free (connection->id);
+	g_free (connection->uuid);
+	g_free (connection->type);
+	g_free (connection->interface_name);
+	g_slice_free (NMSnapshotConnection, connection);
+}
+
+static gboolean
+_connection_equal (const NMSnapshotConnection *a, const NMSnapshotConnection *b)
+{
+	return    a->unsaved == b->unsaved
+	       && nm_streq0 (a->path, b->path)
+	       && nm_streq0 (a->id, b->id)
+	       && nm_streq0 (a->uuid, b->uuid)
+	       && nm_streq0 (a->type, b->type)
+	       && nm_streq0 (a->interface_name, b->interface_name);
+}
+
+static NMSnapshotConnection *
+_connection_new (NMRemoteConnection *remote)
+{
+	NMConnection *connection = NM_CONNECTION (remote);
+	NMSnapshotConnection *entry;
+
+	entry = g_slice_new0 (NMSnapshotConnection);
+	entry->refcount = 1;
+	entry->path = g_strdup (nm_connection_get_path (connection));
+	entry->id = g_strdup (nm_connection_get_id (connection));
+	entry->uuid = g_strdup (nm_connection_get_uuid (connection));
+	entry->type = g_strdup (nm_connection_get_connection_type (connection));
+	entry->interface_name = g_strdup (nm_connection_get_interface_name (connection));
+	entry->unsaved = nm_remote_connection_get_unsaved (remote);
+	return entry;
+}
+
+/**
+ * nm_snapshot_connection_get_path:
+ * @connection: the #NMSnapshotConnection
+ *
+ * Returns: the D-Bus path of the connection profile
+ *
+ * Since: 1.10
+ **/
+const char *
+nm_snapshot_connection_get_path (NMSnapshotConnection *connection)
+{
+	g_return_val_if_fail (connection, NULL);
+	return connection->path;
+}
+
+/**
+ * nm_snapshot_connection_get_id:
+ * @connection: the #NMSnapshotConnection
+ *
+ * Returns: the ID of the connection profile
+ *
+ * Since: 1.10
+ **/
+const char *
+nm_snapshot_connection_get_id (NMSnapshotConnection *connection)
+{
+	g_return_val_if_fail (connection, NULL);
+	return connection->id;
+}
+
+/**
+ * nm_snapshot_connection_get_uuid:
+ * @connection: the #NMSnapshotConnection
+ *
+ * Returns: the UUID of the connection profile
+ *
+ * Since: 1.10
+ **/
+const char *
+nm_snapshot_connection_get_uuid (NMSnapshotConnection *connection)
+{
+	g_return_val_if_fail (connection, NULL);
+	return connection->uuid;
+}
+
+/**
+ * nm_snapshot_connection_get_connection_type:
+ * @connection: the #NMSnapshotConnection
+ *
+ * Returns: the type of the connection profile
+ *
+ * Since: 1.10
+ **/
+const char *
+nm_snapshot_connection_get_connection_type (NMSnapshotConnection *connection)
+{
+	g_return_val_if_fail (connection, NULL);
+	return connection->type;
+}
+
+/**
+ * nm_snapshot_connection_get_interface_name:
+ * @connection: the #NMSnapshotConnection
+ *
+ * Returns: the interface name the connection profile is bound to, or %NULL
+ *
+ * Since: 1.10
+ **/
+const char *
+nm_snapshot_connection_get_interface_name (NMSnapshotConnection *connection)
+{
+	g_return_val_if_fail (connection, NULL);
+	return connection->interface_name;
+}
+
+/**
+ * nm_snapshot_connection_get_unsaved:
+ * @connection: the #NMSnapshotConnection
+ *
+ * Returns: whether the connection profile has unsaved changes
+ *
+ * Since: 1.10
+ **/
+gboolean
+nm_snapshot_connection_get_unsaved (NMSnapshotConnection *connection)
+{
+	g_return_val_if_fail (connection, FALSE);
+	return connection->unsaved;
+}
+
+/*****************************************************************************/
+
+/**
+ * nm_snapshot_ref:
+ * @snapshot: the #NMSnapshot
+ *
+ * Increases the reference count of @snapshot. This is thread-safe.
+ *
+ * Returns: @snapshot
+ *
+ * Since: 1.10
+ **/
+NMSnapshot *
+nm_snapshot_ref (NMSnapshot *snapshot)
+{
+	g_return_val_if_fail (snapshot, NULL);
+	g_return_val_if_fail (snapshot->refcount > 0, NULL);
+
+	g_atomic_int_inc (&snapshot->refcount);
+	return snapshot;
+}
+
+/**
+ * nm_snapshot_unref:
+ * @snapshot: the #NMSnapshot
+ *
+ * Decreases the reference count of @snapshot and frees it when the count
+ * drops to zero. This is thread-safe.
+ *
+ * Since: 1.10
+ **/
+void
+nm_snapshot_unref (NMSnapshot *snapshot)
+{
+	guint i;
+
+	g_return_if_fail (snapshot);
+	g_return_if_fail (snapshot->refcount > 0);
+
+	if (!g_atomic_int_dec_and_test (&snapshot->refcount))
+		return;
+
+	for (i = 0; i < snapshot->n_devices; i++)
+		nm_snapshot_device_unref (snapshot->devices[i]);
+	for (i = 0; i < snapshot->n_active_connections; i++)
+		nm_snapshot_active_connection_unref (snapshot->active_connections[i]);
+	for (i = 0; i < snapshot->n_connections; i++)
+		nm_snapshot_connection_unref (snapshot->connections[i]);
+	g_free (snapshot->devices);
+	g_free (snapshot->active_connections);
+	g_free (snapshot->connections);
+	g_slice_free (NMSnapshot, snapshot);
+}
+
+/**
+ * nm_snapshot_get_state:
+ * @snapshot: the #NMSnapshot
+ *
+ * Returns: the state of NetworkManager, see nm_client_get_state()
+ *
+ * Since: 1.10
+ **/
+NMState
+nm_snapshot_get_state (NMSnapshot *snapshot)
+{
+	g_return_val_if_fail (snapshot, NM_STATE_UNKNOWN);
+	return snapshot->state;
+}
+
+/**
+ * nm_snapshot_get_devices:
+ * @snapshot: the #NMSnapshot
+ * @out_len: (out): the number of devices
+ *
+ * Returns: (array length=out_len) (transfer none): the realized devices,
+ * in the order of nm_client_get_devices()
+ *
+ * Since: 1.10
+ **/
+NMSnapshotDevice *const *
+nm_snapshot_get_devices (NMSnapshot *snapshot, guint *out_len)
+{
+	g_return_val_if_fail (snapshot, NULL);
+	g_return_val_if_fail (out_len, NULL);
+
+	*out_len = snapshot->n_devices;
+	return snapshot->devices;
+}
+
+/**
+ * nm_snapshot_get_active_connections:
+ * @snapshot: the #NMSnapshot
+ * @out_len: (out): the number of active connections
+ *
+ * Returns: (array length=out_len) (transfer none): the active connections
+ *
+ * Since: 1.10
+ **/
+NMSnapshotActiveConnection *const *
+nm_snapshot_get_active_connections (NMSnapshot *snapshot, guint *out_len)
+{
+	g_return_val_if_fail (snapshot, NULL);
+	g_return_val_if_fail (out_len, NULL);
+
+	*out_len = snapshot->n_active_connections;
+	return snapshot->active_connections;
+}
+
+/**
+ * nm_snapshot_get_connections:
+ * @snapshot: the #NMSnapshot
+ * @out_len: (out): the number of connection profiles
+ *
+ * Returns: (array length=out_len) (transfer none): the connection profiles
+ *
+ * Since: 1.10
+ **/
+NMSnapshotConnection *const *
+nm_snapshot_get_connections (NMSnapshot *snapshot, guint *out_len)
+{
+	g_return_val_if_fail (snapshot, NULL);
+	g_return_val_if_fail (out_len, NULL);
+
+	*out_len = snapshot->n_connections;
+	return snapshot->connections;
+}
+
+/*****************************************************************************/
+
+/* The entry last created for an NMObject, to be shared with the next
+ * snapshot. Change notifications of the object mark it @dirty, so that
+ * only the entries of objects that changed are created again. */
+typedef struct {
+	gpointer entry;
+	GDestroyNotify entry_unref;
+
+	/* the IP configs of a device, which are part of its entry */
+	NMObject *deps[2];
+	gulong dep_ids[2];
+
+	bool dirty:1;
+} EntryCache;
+
+static void
+_entry_cache_notify_cb (GObject *object, GParamSpec *pspec, gpointer user_data)
+{
+	((EntryCache *) user_data)->dirty = TRUE;
+}
+
+static void
+_entry_cache_changed_cb (NMConnection *connection, gpointer user_data)
+{
+	((EntryCache *) user_data)->dirty = TRUE;
+}
+
+static void
+_entry_cache_clear_deps (EntryCache *cache)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (cache->deps); i++) {
+		if (cache->deps[i]) {
+			g_signal_handler_disconnect (cache->deps[i], cache->dep_ids[i]);
+			g_clear_object (&cache->deps[i]);
+		}
+	}
+}
+
+static void
+_entry_cache_free (EntryCache *cache)
+{
+	_entry_cache_clear_deps (cache);
+	if (cache->entry)
+		cache->entry_unref (cache->entry);
+	g_slice_free (EntryCache, cache);
+}
+
+static EntryCache *
+_entry_cache_get (NMObject *object)
+{
+	EntryCache *cache;
+
+	cache = g_object_get_qdata (G_OBJECT (object), _entry_quark ());
+	if (!cache) {
+		/* the handlers of @object are gone before the qdata is freed. */
+		cache = g_slice_new0 (EntryCache);
+		g_object_set_qdata_full (G_OBJECT (object), _entry_quark (), cache,
+		                         (GDestroyNotify) _entry_cache_free);
+		g_signal_connect (object, "notify",
+		                  G_CALLBACK (_entry_cache_notify_cb), cache);
+		if (NM_IS_REMOTE_CONNECTION (object)) {
+			g_signal_connect (object, NM_CONNECTION_CHANGED,
+			                  G_CALLBACK (_entry_cache_changed_cb), cache);
+		}
+	}
+	return cache;
+}
+
+static gboolean
+_entry_cache_is_valid (EntryCache *cache, NMObject *object)
+{
+	guint i;
+
+	/* NMObject emits the notifications of D-Bus property changes from an
+	 * idle handler, but the getters already return the new values. */
+	if (   !cache->entry
+	    || cache->dirty
+	    || _nm_object_has_pending_notify (object))
+		return FALSE;
+	for (i = 0; i < G_N_ELEMENTS (cache->deps); i++) {
+		if (   cache->deps[i]
+		    && _nm_object_has_pending_notify (cache->deps[i]))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+/* Starts tracking the changes of @object anew, before its entry is
+ * created again. */
+static void
+_entry_cache_track (EntryCache *cache, NMObject *object)
+{
+	NMIPConfig *deps[2] = { };
+	guint i;
+
+	_entry_cache_clear_deps (cache);
+	cache->dirty = FALSE;
+
+	if (NM_IS_DEVICE (object)) {
+		deps[0] = nm_device_get_ip4_config (NM_DEVICE (object));
+		deps[1] = nm_device_get_ip6_config (NM_DEVICE (object));
+	}
+	for (i = 0; i < G_N_ELEMENTS (deps); i++) {
+		if (!deps[i])
+			continue;
+		cache->deps[i] = g_object_ref (deps[i]);
+		cache->dep_ids[i] = g_signal_connect (deps[i], "notify",
+		                                      G_CALLBACK (_entry_cache_notify_cb), cache);
+	}
+}
+
+/* Returns the entry for @object. The entry of the previous snapshot is
+ * reused if the object didn't change, or if the new entry is equal to
+ * it, so that unchanged objects are shared. */
+#define _ENTRY_GET(object, new_func, equal_func, unref_func) \
+	({ \
+		gpointer _object = (object); \
+		EntryCache *_cache = _entry_cache_get (_object); \
+		typeof (new_func (_object)) _entry = _cache->entry; \
+		\
+		if (!_entry_cache_is_valid (_cache, _object)) { \
+			typeof (_entry) _new; \
+			\
+			_entry_cache_track (_cache, _object); \
+			_new = new_func (_object); \
+			if (_entry && equal_func (_entry, _new)) \
+				unref_func (_new); \
+			else { \
+				if (_entry) \
+					unref_func (_entry); \
+				_cache->entry = _entry = _new; \
+				_cache->entry_unref = (GDestroyNotify) unref_func; \
+			} \
+		} \
+		g_atomic_int_inc (&_entry->refcount); \
+		_entry; \
+	})
+
+NMSnapshot *
+_nm_snapshot_new (NMClient *client, NMSnapshot *previous)
+{
+	NMSnapshot *snapshot;
+	const GPtrArray *arr;
+	gboolean same;
+	guint i;
+
+	snapshot = g_slice_new0 (NMSnapshot);
+	snapshot->refcount = 1;
+	snapshot->state = nm_client_get_state (client);
+
+	arr = nm_client_get_devices (client);
+	snapshot->n_devices = arr ? arr->len : 0;
+	snapshot->devices = g_new (NMSnapshotDevice *, snapshot->n_devices + 1);
+	for (i = 0; i < snapshot->n_devices; i++)
+		snapshot->devices[i] = _ENTRY_GET (arr->pdata[i], _device_new, _device_equal, nm_snapshot_device_unref);
+	snapshot->devices[i] = NULL;
+
+	arr = nm_client_get_active_connections (client);
+	snapshot->n_active_connections = arr ? arr->len : 0;
+	snapshot->active_connections = g_new (NMSnapshotActiveConnection *, snapshot->n_active_connections + 1);
+	for (i = 0; i < snapshot->n_active_connections; i++)
+		snapshot->active_connections[i] = _ENTRY_GET (arr->pdata[i], _active_connection_new, _active_connection_equal, nm_snapshot_active_connection_unref);
+	snapshot->active_connections[i] = NULL;
+
+	arr = nm_client_get_connections (client);
+	snapshot->n_connections = arr ? arr->len : 0;
+	snapshot->connections = g_new (NMSnapshotConnection *, snapshot->n_connections + 1);
+	for (i = 0; i < snapshot->n_connections; i++)
+		snapshot->connections[i] = _ENTRY_GET (arr->pdata[i], _connection_new, _connection_equal, nm_snapshot_connection_unref);
+	snapshot->connections[i] = NULL;
+
+	if (!previous)
+		return snapshot;
+
+	same =    previous->state == snapshot->state
+	       && previous->n_devices == snapshot->n_devices
+	       && previous->n_active_connections == snapshot->n_active_connections
+	       && previous->n_connections == snapshot->n_connections
+	       && !memcmp (previous->devices, snapshot->devices,
+	                   sizeof (gpointer) * snapshot->n_devices)
+	       && !memcmp (previous->active_connections, snapshot->active_connections,
+	                   sizeof (gpointer) * snapshot->n_active_connections)
+	       && !memcmp (previous->connections, snapshot->connections,
+	                   sizeof (gpointer) * snapshot->n_connections);
+	if (!same)
+		return snapshot;
+
+	nm_snapshot_unref (snapshot);
+	return nm_snapshot_ref (previous);
+}
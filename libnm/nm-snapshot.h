@@ -0,0 +1,131 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ * Copyright 2017 Red Hat, Inc.
+ */
+
+#ifndef __NM_SNAPSHOT_H__
+#define __NM_SNAPSHOT_H__
+
+#if !defined (__NETWORKMANAGER_H_INSIDE__) && !defined (NETWORKMANAGER_COMPILATION)
+#error "Only <NetworkManager.h> can be included directly."
+#endif
+
+#include "nm-types.h"
+
+G_BEGIN_DECLS
+
+typedef struct _NMSnapshotDevice           NMSnapshotDevice;
+typedef struct _NMSnapshotActiveConnection NMSnapshotActiveConnection;
+typedef struct _NMSnapshotConnection       NMSnapshotConnection;
+
+NM_AVAILABLE_IN_1_10
+GType                         nm_snapshot_get_type               (void);
+NM_AVAILABLE_IN_1_10
+NMSnapshot *                  nm_snapshot_ref                    (NMSnapshot *snapshot);
+NM_AVAILABLE_IN_1_10
+void                          nm_snapshot_unref                  (NMSnapshot *snapshot);
+NM_AVAILABLE_IN_1_10
+NMState                       nm_snapshot_get_state              (NMSnapshot *snapshot);
+NM_AVAILABLE_IN_1_10
+NMSnapshotDevice *const *     nm_snapshot_get_devices            (NMSnapshot *snapshot,
+                                                                  guint *out_len);
+NM_AVAILABLE_IN_1_10
+NMSnapshotActiveConnection *const *nm_snapshot_get_active_connections (NMSnapshot *snapshot,
+                                                                       guint *out_len);
+NM_AVAILABLE_IN_1_10
+NMSnapshotConnection *const * nm_snapshot_get_connections        (NMSnapshot *snapshot,
+                                                                  guint *out_len);
+
+NM_AVAILABLE_IN_1_10
+GType                nm_snapshot_device_get_type                   (void);
+NM_AVAILABLE_IN_1_10
+NMSnapshotDevice *   nm_snapshot_device_ref                        (NMSnapshotDevice *device);
+NM_AVAILABLE_IN_1_10
+void                 nm_snapshot_device_unref                      (NMSnapshotDevice *device);
+NM_AVAILABLE_IN_1_10
+const char *         nm_snapshot_device_get_path                   (NMSnapshotDevice *device);
+NM_AVAILABLE_IN_1_10
+const char *         nm_snapshot_device_get_iface                  (NMSnapshotDevice *device);
+NM_AVAILABLE_IN_1_10
+const char *         nm_snapshot_device_get_ip_iface               (NMSnapshotDevice *device);
+NM_AVAILABLE_IN_1_10
+NMDeviceType         nm_snapshot_device_get_device_type            (NMSnapshotDevice *device);
+NM_AVAILABLE_IN_1_10
+NMDeviceState        nm_snapshot_device_get_state                  (NMSnapshotDevice *device);
+NM_AVAILABLE_IN_1_10
+const char *         nm_snapshot_device_get_hw_address             (NMSnapshotDevice *device);
+NM_AVAILABLE_IN_1_10
+const char *         nm_snapshot_device_get_active_connection_path (NMSnapshotDevice *device);
+NM_AVAILABLE_IN_1_10
+const char * const * nm_snapshot_device_get_ip4_addresses          (NMSnapshotDevice *device);
+NM_AVAILABLE_IN_1_10
+const char *         nm_snapshot_device_get_ip4_gateway            (NMSnapshotDevice *device);
+NM_AVAILABLE_IN_1_10
+const char * const * nm_snapshot_device_get_ip6_addresses          (NMSnapshotDevice *device);
+NM_AVAILABLE_IN_1_10
+const char *         nm_snapshot_device_get_ip6_gateway            (NMSnapshotDevice *device);
+
+NM_AVAILABLE_IN_1_10
+GType                        nm_snapshot_active_connection_get_type            (void);
+NM_AVAILABLE_IN_1_10
+NMSnapshotActiveConnection * nm_snapshot_active_connection_ref                 (NMSnapshotActiveConnection *active);
+NM_AVAILABLE_IN_1_10
+void                         nm_snapshot_active_connection_unref               (NMSnapshotActiveConnection *active);
+NM_AVAILABLE_IN_1_10
+const char *                 nm_snapshot_active_connection_get_path            (NMSnapshotActiveConnection *active);
+NM_AVAILABLE_IN_1_10
+const char *                 nm_snapshot_active_connection_get_connection_path (NMSnapshotActiveConnection *active);
+NM_AVAILABLE_IN_1_10
+const char *                 nm_snapshot_active_connection_get_id              (NMSnapshotActiveConnection *active);
+NM_AVAILABLE_IN_1_10
+const char *                 nm_snapshot_active_connection_get_uuid            (NMSnapshotActiveConnection *active);
+NM_AVAILABLE_IN_1_10
+const char *                 nm_snapshot_active_connection_get_connection_type (NMSnapshotActiveConnection *active);
+NM_AVAILABLE_IN_1_10
+NMActiveConnectionState      nm_snapshot_active_connection_get_state           (NMSnapshotActiveConnection *active);
+NM_AVAILABLE_IN_1_10
+const char * const *         nm_snapshot_active_connection_get_device_paths    (NMSnapshotActiveConnection *active);
+NM_AVAILABLE_IN_1_10
+gboolean                     nm_snapshot_active_connection_get_default         (NMSnapshotActiveConnection *active);
+NM_AVAILABLE_IN_1_10
+gboolean                     nm_snapshot_active_connection_get_default6        (NMSnapshotActiveConnection *active);
+NM_AVAILABLE_IN_1_10
+gboolean                     nm_snapshot_active_connection_get_vpn             (NMSnapshotActiveConnection *active);
+
+NM_AVAILABLE_IN_1_10
+GType                  nm_snapshot_connection_get_type             (void);
+NM_AVAILABLE_IN_1_10
+NMSnapshotConnection * nm_snapshot_connection_ref                  (NMSnapshotConnection *connection);
+NM_AVAILABLE_IN_1_10
+void                   nm_snapshot_connection_unref                (NMSnapshotConnection *connection);
+NM_AVAILABLE_IN_1_10
+const char *           nm_snapshot_connection_get_path             (NMSnapshotConnection *connection);
+NM_AVAILABLE_IN_1_10
+const char *           nm_snapshot_connection_get_id               (NMSnapshotConnection *connection);
+NM_AVAILABLE_IN_1_10
+const char *           nm_snapshot_connection_get_uuid             (NMSnapshotConnection *connection);
+NM_AVAILABLE_IN_1_10
+const char *           nm_snapshot_connection_get_connection_type  (NMSnapshotConnection *connection);
+NM_AVAILABLE_IN_1_10
+const char *           nm_snapshot_connection_get_interface_name   (NMSnapshotConnection *connection);
+NM_AVAILABLE_IN_1_10
+gboolean               nm_snapshot_connection_get_unsaved          (NMSnapshotConnection *connection);
+
+G_END_DECLS
+
+#endif /* __NM_SNAPSHOT_H__ */
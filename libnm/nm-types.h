@@ -53,6 +53,7 @@ typedef struct _NMDhcpConfig        NMDhcpConfig;
 typedef struct _NMIPConfig          NMIPConfig;
 typedef struct _NMObject            NMObject;
 typedef struct _NMRemoteConnection  NMRemoteConnection;
+typedef struct _NMSnapshot          NMSnapshot;
 typedef struct _NMVpnConnection     NMVpnConnection;
 typedef struct _NMWimaxNsp          NMWimaxNsp;
 
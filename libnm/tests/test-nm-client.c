@@ -764,6 +764,118 @@ test_devices_array (void)
 	g_clear_pointer (&sinfo, nmtstc_service_cleanup);
 }
 
+/* Each added device changes the "Devices" property of the manager, which
+ * libnm diffs against the previous array. With many devices, a quadratic
+ * diff dominates. Run with -m perf for more devices. */
+static void
+test_devices_array_many (void)
+{
+	NMClient *client = NULL;
+	gs_free NMDevice **added = NULL;
+	const GPtrArray *devices;
+	guint n, i;
+	gint64 start;
+
+	n = g_test_perf () ? 1000 : 50;
+	added = g_new0 (NMDevice *, n);
+
+	sinfo = nmtstc_service_init ();
+
+	client = nm_client_new (NULL, NULL);
+	g_assert (client != NULL);
+
+	start = g_get_monotonic_time ();
+	for (i = 0; i < n; i++) {
+		char ifname[32];
+
+		nm_sprintf_buf (ifname, "eth%u", i);
+		added[i] = nmtstc_service_add_device (sinfo, client, "AddWiredDevice", ifname);
+	}
+	g_test_message ("bench\tlibnm\tdevices-added\t%u\t%.0f", n,
+	                (double) (g_get_monotonic_time () - start) * 1000.0 / n);
+
+	/* the devices are in the order in which they were added */
+	devices = nm_client_get_devices (client);
+	g_assert (devices);
+	g_assert_cmpint (devices->len, ==, n);
+	for (i = 0; i < n; i++)
+		g_assert (devices->pdata[i] == added[i]);
+
+	g_object_unref (client);
+	g_clear_pointer (&sinfo, nmtstc_service_cleanup);
+}
+
+static gpointer
+snapshot_thread (gpointer user_data)
+{
+	NMSnapshot *snapshot = user_data;
+	NMSnapshotDevice *const *devices;
+	guint n;
+
+	devices = nm_snapshot_get_devices (snapshot, &n);
+	g_assert_cmpint (n, ==, 2);
+	g_assert_cmpstr (nm_snapshot_device_get_iface (devices[0]), ==, "eth0");
+	g_assert_cmpstr (nm_snapshot_device_get_iface (devices[1]), ==, "eth1");
+	g_assert (nm_snapshot_device_get_ip4_addresses (devices[0]));
+
+	nm_snapshot_unref (snapshot);
+	return NULL;
+}
+
+static void
+test_snapshot (void)
+{
+	NMClient *client = NULL;
+	NMSnapshot *snapshot1, *snapshot2, *snapshot3;
+	NMSnapshotDevice *const *devices1, *const *devices3;
+	NMDevice *eth0, *eth1;
+	GThread *thread;
+	guint n1, n3;
+
+	sinfo = nmtstc_service_init ();
+
+	client = nm_client_new (NULL, NULL);
+	g_assert (client != NULL);
+
+	eth0 = nmtstc_service_add_device (sinfo, client, "AddWiredDevice", "eth0");
+	eth1 = nmtstc_service_add_device (sinfo, client, "AddWiredDevice", "eth1");
+
+	snapshot1 = nm_client_get_snapshot (client);
+	devices1 = nm_snapshot_get_devices (snapshot1, &n1);
+	g_assert_cmpint (n1, ==, 2);
+	g_assert_cmpstr (nm_snapshot_device_get_path (devices1[0]), ==, nm_object_get_path (NM_OBJECT (eth0)));
+	g_assert_cmpint (nm_snapshot_device_get_device_type (devices1[1]), ==, NM_DEVICE_TYPE_ETHERNET);
+
+	/* nothing changed, so the same snapshot is returned. */
+	snapshot2 = nm_client_get_snapshot (client);
+	g_assert (snapshot2 == snapshot1);
+	nm_snapshot_unref (snapshot2);
+
+	/* the snapshot can be read and released from another thread. */
+	thread = g_thread_new ("snapshot", snapshot_thread, nm_snapshot_ref (snapshot1));
+	g_thread_join (thread);
+
+	/* after a change, unchanged entries are shared. */
+	nmtstc_service_add_device (sinfo, client, "AddWiredDevice", "eth2");
+	snapshot3 = nm_client_get_snapshot (client);
+	g_assert (snapshot3 != snapshot1);
+	devices3 = nm_snapshot_get_devices (snapshot3, &n3);
+	g_assert_cmpint (n3, ==, 3);
+	g_assert (devices3[0] == devices1[0]);
+	g_assert (devices3[1] == devices1[1]);
+	g_assert_cmpstr (nm_snapshot_device_get_iface (devices3[2]), ==, "eth2");
+
+	/* the old snapshot is unaffected. */
+	g_assert (nm_snapshot_get_devices (snapshot1, &n1) == devices1);
+	g_assert_cmpint (n1, ==, 2);
+	g_assert_cmpstr (nm_snapshot_device_get_iface (devices1[1]), ==, nm_device_get_iface (eth1));
+
+	nm_snapshot_unref (snapshot1);
+	nm_snapshot_unref (snapshot3);
+	g_object_unref (client);
+	g_clear_pointer (&sinfo, nmtstc_service_cleanup);
+}
+
 static void
 nm_running_changed (GObject *client,
                     GParamSpec *pspec,
@@ -1586,6 +1698,8 @@ main (int argc, char **argv)
 	g_test_add_func ("/libnm/wifi-ap-added-removed", test_wifi_ap_added_removed);
 	g_test_add_func ("/libnm/wimax-nsp-added-removed", test_wimax_nsp_added_removed);
 	g_test_add_func ("/libnm/devices-array", test_devices_array);
+	g_test_add_func ("/libnm/devices-array-many", test_devices_array_many);
+	g_test_add_func ("/libnm/snapshot", test_snapshot);
 	g_test_add_func ("/libnm/client-nm-running", test_client_nm_running);
 	g_test_add_func ("/libnm/active-connections", test_active_connections);
 	g_test_add_func ("/libnm/activate-virtual", test_activate_virtual);
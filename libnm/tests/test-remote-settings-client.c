@@ -89,6 +89,46 @@ test_add_connection (void)
 
 /*****************************************************************************/
 
+static void
+test_lazy_settings (void)
+{
+	const char *path;
+	int i;
+
+	g_assert (remote != NULL);
+	path = nm_connection_get_path (NM_CONNECTION (remote));
+
+	for (i = 0; i < 2; i++) {
+		gs_unref_object NMClient *lazy_client = NULL;
+		GError *error = NULL;
+		NMRemoteConnection *lazy;
+
+		lazy_client = g_initable_new (NM_TYPE_CLIENT, NULL, &error,
+		                              NM_CLIENT_LAZY_SETTINGS, TRUE,
+		                              NULL);
+		g_assert_no_error (error);
+
+		/* the path is known without the settings */
+		lazy = nm_client_get_connection_by_path (lazy_client, path);
+		g_assert (lazy);
+		g_assert (nm_remote_connection_get_visible (lazy));
+
+		if (i == 0) {
+			/* request them all at once... */
+			nm_client_fetch_connection_settings (lazy_client, NULL, NULL, &error);
+			g_assert_no_error (error);
+		}
+
+		/* ... or on first access */
+		g_assert_cmpstr (nm_connection_get_id (NM_CONNECTION (lazy)), ==, TEST_CON_ID);
+		g_assert (nm_connection_compare (NM_CONNECTION (remote),
+		                                 NM_CONNECTION (lazy),
+		                                 NM_SETTING_COMPARE_FLAG_EXACT));
+	}
+}
+
+/*****************************************************************************/
+
 static void
 set_visible_cb (GObject *proxy,
                 GAsyncResult *result,
@@ -523,6 +563,7 @@ main (int argc, char **argv)
 	 * does not actually guarantee that!
 	 */
 	g_test_add_func ("/client/add_connection", test_add_connection);
+	g_test_add_func ("/client/lazy_settings", test_lazy_settings);
 	g_test_add_func ("/client/make_invisible", test_make_invisible);
 	g_test_add_func ("/client/make_visible", test_make_visible);
 	g_test_add_func ("/client/remove_connection", test_remove_connection);
@@ -1243,6 +1243,35 @@ _nmtst_assert_resolve_relative_path_equals (const char *f1, const char *f2, cons
 
 /*****************************************************************************/
 
+/* Benchmarks are not run by "make check". Their size is taken from the
+ * environment variable @env, and each measured operation prints one line
+ *
+ *   bench<TAB>profile<TAB>operation<TAB>count<TAB>ns-per-op
+ *
+ * to stdout. */
+
+static inline guint
+nmtst_bench_size (const char *env, guint default_value, guint max_value)
+{
+	return _nm_utils_ascii_str_to_int64 (g_getenv (env), 10, 1, max_value, default_value);
+}
+
+static inline guint
+nmtst_bench_iterations (guint default_value, guint max_value)
+{
+	return nmtst_bench_size ("NMTST_BENCH_ITERATIONS", default_value, max_value);
+}
+
+/* @start is the g_get_monotonic_time() when the @count operations started. */
+static inline void
+nmtst_bench_report (const char *profile, const char *op, guint count, gint64 start)
+{
+	g_print ("bench\t%s\t%s\t%u\t%.0f\n", profile, op, count,
+	         (double) (g_get_monotonic_time () - start) * 1000.0 / MAX (count, 1u));
+}
+
+/*****************************************************************************/
+
 #ifdef NM_SETTING_IP_CONFIG_H
 static inline void
 nmtst_setting_ip_config_add_address (NMSettingIPConfig *s_ip,
@@ -838,3 +838,38 @@ nm_utils_g_value_set_object_path_array (GValue *value,
 }
 
 /*****************************************************************************/
+
+/**
+ * nm_utils_dhcp_options_equal:
+ * @options: the options as exported, a variant of type "a{sv}" with string values
+ * @new_options: the options of a new lease
+ * @ignore_keys: (allow-none): %NULL terminated list of options whose
+ *   values are not compared, only their presence.
+ *
+ * Returns: %TRUE if @new_options has the same options and values as
+ *   @options, apart from the values of @ignore_keys.
+ */
+gboolean
+nm_utils_dhcp_options_equal (GVariant *options,
+                             GHashTable *new_options,
+                             const char *const *ignore_keys)
+{
+	GHashTableIter iter;
+	const char *key, *value, *old_value;
+
+	if (g_variant_n_children (options) != g_hash_table_size (new_options))
+		return FALSE;
+
+	g_hash_table_iter_init (&iter, new_options);
+	while (g_hash_table_iter_next (&iter, (gpointer *) &key, (gpointer *) &value)) {
+		if (!g_variant_lookup (options, key, "&s", &old_value))
+			return FALSE;
+		if (ignore_keys && g_strv_contains (ignore_keys, key))
+			continue;
+		if (!nm_streq0 (old_value, value))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+/*****************************************************************************/
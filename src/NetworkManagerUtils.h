@@ -63,6 +63,10 @@ void nm_utils_g_value_set_object_path_array (GValue *value,
                                              NMUtilsObjectFunc filter_func,
                                              gpointer user_data);
 
+gboolean nm_utils_dhcp_options_equal (GVariant *options,
+                                      GHashTable *new_options,
+                                      const char *const *ignore_keys);
+
 /*****************************************************************************/
 
 #endif /* __NETWORKMANAGER_UTILS_H__ */
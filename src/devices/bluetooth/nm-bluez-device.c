@@ -415,7 +415,9 @@ load_connections (NMBluezDevice *self)
 	guint i;
 	gboolean changed = FALSE;
 
-	connections = nm_settings_get_connections (priv->settings, NULL);
+	connections = nm_settings_get_connections_by_type (priv->settings,
+	                                                   NM_SETTING_BLUETOOTH_SETTING_NAME,
+	                                                   NULL);
 	for (i = 0; connections[i]; i++) {
 		NMConnection *connection = (NMConnection *) connections[i];
 
@@ -19,8 +19,11 @@
 #include "nm-arping-manager.h"
 
 #include <netinet/in.h>
-#include <sys/types.h>
-#include <sys/wait.h>
+#include <sys/socket.h>
+#include <net/ethernet.h>
+#include <net/if_arp.h>
+#include <linux/if_packet.h>
+#include <unistd.h>
 
 #include "platform/nm-platform.h"
 #include "nm-utils.h"
@@ -28,6 +31,10 @@
 
 /*****************************************************************************/
 
+/* the number of probes for duplicate address detection, which are sent
+ * spread over the timeout of nm_arping_manager_start_probe(). */
+#define PROBE_NUM 3
+
 typedef enum {
 	STATE_INIT,
 	STATE_PROBING,
@@ -37,12 +44,27 @@ typedef enum {
 
 typedef struct {
 	in_addr_t address;
-	GPid pid;
-	guint watch;
 	gboolean duplicate;
-	NMArpingManager *manager;
 } AddressInfo;
 
+typedef struct {
+	int ifindex;
+	int refcount;
+	int fd;
+	GIOChannel *channel;
+	guint channel_id;
+	guint8 hwaddr[ETH_ALEN];
+	GSList *managers;
+} ArpSocket;
+
+typedef struct {
+	struct arphdr hdr;
+	guint8 sha[ETH_ALEN];
+	guint8 spa[4];
+	guint8 tha[ETH_ALEN];
+	guint8 tpa[4];
+} _nm_packed ArpPacket;
+
 /*****************************************************************************/
 
 enum {
@@ -56,9 +78,12 @@ typedef struct {
 	int            ifindex;
 	State          state;
 	GHashTable    *addresses;
-	guint          completed;
-	guint          timer;
+	guint          probes_sent;
+	guint          probe_interval;
+	gint64         probe_next_ms;
 	guint          round2_id;
+
+	ArpSocket     *socket;
 } NMArpingManagerPrivate;
 
 struct _NMArpingManager {
@@ -74,6 +99,18 @@ G_DEFINE_TYPE (NMArpingManager, nm_arping_manager, G_TYPE_OBJECT)
 
 #define NM_ARPING_MANAGER_GET_PRIVATE(self) _NM_GET_PRIVATE (self, NMArpingManager, NM_IS_ARPING_MANAGER)
 
+/* Probing is shared by all managers of the daemon: there is one packet
+ * socket per interface, no matter how many managers use it, and one
+ * timer that fires for whichever probing manager is due next. That way
+ * DAD for several devices activated together runs concurrently and each
+ * manager terminates at its own deadline. */
+static struct {
+	GHashTable *sockets;
+	GSList *probing;
+	guint timer_id;
+	gint64 timer_expiry_ms;
+} shared;
+
 /*****************************************************************************/
 
 #define _NMLOG_DOMAIN         LOGD_IP4
@@ -120,71 +157,350 @@ nm_arping_manager_add_address (NMArpingManager *self, in_addr_t address)
 
 	info = g_slice_new0 (AddressInfo);
 	info->address = address;
-	info->manager = self;
 
 	g_hash_table_insert (priv->addresses, GUINT_TO_POINTER (address), info);
 
 	return TRUE;
 }
 
+/*****************************************************************************/
+
+static void probe_schedule (void);
+
 static void
-arping_watch_cb (GPid pid, gint status, gpointer user_data)
+process_packet (NMArpingManager *self, const ArpPacket *packet)
 {
-	AddressInfo *info = user_data;
-	NMArpingManager *self = info->manager;
 	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
-	const char *addr;
+	GHashTableIter iter;
+	AddressInfo *info;
+	in_addr_t spa, tpa;
 
-	info->pid = 0;
-	info->watch = 0;
-	addr = nm_utils_inet4_ntop (info->address, NULL);
+	if (priv->state != STATE_PROBING)
+		return;
 
-	if (WIFEXITED (status)) {
-		if (WEXITSTATUS (status) != 0) {
-			_LOGD ("%s already used in the %s network",
-			       addr, nm_platform_link_get_name (NM_PLATFORM_GET, priv->ifindex));
-			info->duplicate = TRUE;
-		} else
-			_LOGD ("DAD succeeded for %s", addr);
-	} else {
-		_LOGD ("stopped unexpectedly with status %d for %s", status, addr);
+	memcpy (&spa, packet->spa, sizeof (spa));
+	memcpy (&tpa, packet->tpa, sizeof (tpa));
+
+	/* RFC 5227, 2.1.1: a conflict is an ARP packet from another host
+	 * using the address, or another host probing for it. */
+	info = g_hash_table_lookup (priv->addresses, GUINT_TO_POINTER (spa));
+	if (   !info
+	    && spa == 0
+	    && ntohs (packet->hdr.ar_op) == ARPOP_REQUEST)
+		info = g_hash_table_lookup (priv->addresses, GUINT_TO_POINTER (tpa));
+	if (!info || info->duplicate)
+		return;
+
+	_LOGD ("%s already used in the %s network by %s",
+	       nm_utils_inet4_ntop (info->address, NULL),
+	       nm_platform_link_get_name (NM_PLATFORM_GET, priv->ifindex),
+	       nm_utils_hwaddr_ntoa (packet->sha, ETH_ALEN));
+	info->duplicate = TRUE;
+
+	/* once every address is known to be duplicate, further probes
+	 * cannot change the result. Terminate on the next timer dispatch. */
+	g_hash_table_iter_init (&iter, priv->addresses);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &info)) {
+		if (!info->duplicate)
+			return;
+	}
+	priv->probes_sent = PROBE_NUM;
+	priv->probe_next_ms = 0;
+	probe_schedule ();
+}
+
+static gboolean
+socket_receive_cb (GIOChannel *channel, GIOCondition condition, gpointer user_data)
+{
+	ArpSocket *sock = user_data;
+	ArpPacket packet;
+	GSList *iter;
+	ssize_t len;
+
+	for (;;) {
+		len = recv (sock->fd, &packet, sizeof (packet), 0);
+		if (len < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		if (   len < (ssize_t) sizeof (packet)
+		    || packet.hdr.ar_hrd != htons (ARPHRD_ETHER)
+		    || packet.hdr.ar_pro != htons (ETH_P_IP)
+		    || packet.hdr.ar_hln != ETH_ALEN
+		    || packet.hdr.ar_pln != 4
+		    || !NM_IN_SET (ntohs (packet.hdr.ar_op), ARPOP_REQUEST, ARPOP_REPLY))
+			continue;
+
+		/* our own packets */
+		if (memcmp (packet.sha, sock->hwaddr, ETH_ALEN) == 0)
+			continue;
+
+		for (iter = sock->managers; iter; iter = iter->next)
+			process_packet (iter->data, &packet);
+	}
+
+	return G_SOURCE_CONTINUE;
+}
+
+static void
+arp_socket_unref (ArpSocket *sock)
+{
+	nm_assert (sock && sock->refcount > 0);
+
+	if (--sock->refcount > 0)
+		return;
+
+	nm_assert (!sock->managers);
+	g_hash_table_remove (shared.sockets, &sock->ifindex);
+	nm_clear_g_source (&sock->channel_id);
+	g_clear_pointer (&sock->channel, g_io_channel_unref);
+	if (sock->fd >= 0)
+		close (sock->fd);
+	g_slice_free (ArpSocket, sock);
+}
+
+static ArpSocket *
+arp_socket_ref (int ifindex, GError **error)
+{
+	struct sockaddr_ll sll = {
+		.sll_family = AF_PACKET,
+		.sll_protocol = htons (ETH_P_ARP),
+		.sll_ifindex = ifindex,
+	};
+	ArpSocket *sock;
+	gconstpointer hwaddr;
+	size_t hwaddr_len = 0;
+	int errsv;
+
+	if (G_UNLIKELY (!shared.sockets))
+		shared.sockets = g_hash_table_new (g_int_hash, g_int_equal);
+
+	sock = g_hash_table_lookup (shared.sockets, &ifindex);
+	if (sock) {
+		sock->refcount++;
+		return sock;
+	}
+
+	hwaddr = nm_platform_link_get_address (NM_PLATFORM_GET, ifindex, &hwaddr_len);
+	if (!hwaddr || hwaddr_len != ETH_ALEN) {
+		g_set_error (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
+		             "ARP is not supported on ifindex %d", ifindex);
+		return NULL;
 	}
 
-	if (++priv->completed == g_hash_table_size (priv->addresses)) {
-		priv->state = STATE_PROBE_DONE;
-		nm_clear_g_source (&priv->timer);
-		g_signal_emit (self, signals[PROBE_TERMINATED], 0);
+	sock = g_slice_new0 (ArpSocket);
+	sock->ifindex = ifindex;
+	sock->refcount = 1;
+	memcpy (sock->hwaddr, hwaddr, ETH_ALEN);
+
+	sock->fd = socket (AF_PACKET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, htons (ETH_P_ARP));
+	if (sock->fd < 0) {
+		errsv = errno;
+		g_set_error (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
+		             "could not create ARP socket: %s", g_strerror (errsv));
+		g_slice_free (ArpSocket, sock);
+		return NULL;
 	}
+
+	if (bind (sock->fd, (struct sockaddr *) &sll, sizeof (sll)) < 0) {
+		errsv = errno;
+		g_set_error (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
+		             "could not bind ARP socket to ifindex %d: %s",
+		             ifindex, g_strerror (errsv));
+		close (sock->fd);
+		g_slice_free (ArpSocket, sock);
+		return NULL;
+	}
+
+	sock->channel = g_io_channel_unix_new (sock->fd);
+	sock->channel_id = g_io_add_watch (sock->channel, G_IO_IN, socket_receive_cb, sock);
+	g_hash_table_insert (shared.sockets, &sock->ifindex, sock);
+	return sock;
+}
+
+static void
+socket_close (NMArpingManager *self)
+{
+	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
+
+	if (!priv->socket)
+		return;
+
+	priv->socket->managers = g_slist_remove (priv->socket->managers, self);
+	arp_socket_unref (g_steal_pointer (&priv->socket));
+}
+
+static gboolean
+socket_open (NMArpingManager *self, GError **error)
+{
+	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
+
+	if (priv->socket)
+		return TRUE;
+
+	priv->socket = arp_socket_ref (priv->ifindex, error);
+	if (!priv->socket)
+		return FALSE;
+
+	priv->socket->managers = g_slist_prepend (priv->socket->managers, self);
+	return TRUE;
 }
 
 static gboolean
-arping_timeout_cb (gpointer user_data)
+send_arp (NMArpingManager *self, guint16 op, in_addr_t spa, in_addr_t tpa)
+{
+	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
+	struct sockaddr_ll sll = {
+		.sll_family = AF_PACKET,
+		.sll_protocol = htons (ETH_P_ARP),
+		.sll_ifindex = priv->ifindex,
+		.sll_halen = ETH_ALEN,
+		.sll_addr = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff },
+	};
+	ArpPacket packet = {
+		.hdr = {
+			.ar_hrd = htons (ARPHRD_ETHER),
+			.ar_pro = htons (ETH_P_IP),
+			.ar_hln = ETH_ALEN,
+			.ar_pln = 4,
+			.ar_op = htons (op),
+		},
+	};
+
+	memcpy (packet.sha, priv->socket->hwaddr, ETH_ALEN);
+	memcpy (packet.spa, &spa, sizeof (spa));
+	memcpy (packet.tpa, &tpa, sizeof (tpa));
+
+	if (sendto (priv->socket->fd, &packet, sizeof (packet), 0,
+	            (struct sockaddr *) &sll, sizeof (sll)) < 0) {
+		int errsv = errno;
+
+		_LOGD ("could not send ARP for address %s: %s",
+		       nm_utils_inet4_ntop (tpa, NULL), g_strerror (errsv));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/*****************************************************************************/
+
+static void
+probe_send (NMArpingManager *self)
 {
-	NMArpingManager *self = user_data;
 	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
 	GHashTableIter iter;
 	AddressInfo *info;
 
-	priv->timer = 0;
+	/* RFC 5227, 2.1.1: a probe is an ARP request for the address with
+	 * an unspecified sender address. */
+	g_hash_table_iter_init (&iter, priv->addresses);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &info)) {
+		if (!info->duplicate)
+			send_arp (self, ARPOP_REQUEST, 0, info->address);
+	}
+	priv->probes_sent++;
+}
+
+static void
+probe_terminate (NMArpingManager *self)
+{
+	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
+	GHashTableIter iter;
+	AddressInfo *info;
 
 	g_hash_table_iter_init (&iter, priv->addresses);
 	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &info)) {
-		nm_clear_g_source (&info->watch);
-		if (info->pid) {
-			_LOGD ("DAD timed out for %s",
+		if (!info->duplicate) {
+			_LOGD ("DAD succeeded for %s",
 			       nm_utils_inet4_ntop (info->address, NULL));
-			nm_utils_kill_child_async (info->pid, SIGTERM, LOGD_IP4,
-			                           "arping", 1000, NULL, NULL);
-			info->pid = 0;
 		}
 	}
 
+	shared.probing = g_slist_remove (shared.probing, self);
 	priv->state = STATE_PROBE_DONE;
 	g_signal_emit (self, signals[PROBE_TERMINATED], 0);
+}
+
+static gboolean
+probe_timeout_cb (gpointer user_data)
+{
+	gs_unref_ptrarray GPtrArray *due = NULL;
+	GSList *iter;
+	gint64 now;
+	guint i;
+
+	shared.timer_id = 0;
+	now = nm_utils_get_monotonic_timestamp_ms ();
+
+	/* handling a manager can destroy others (the signal handler may
+	 * tear down the device), so collect references first. */
+	due = g_ptr_array_new_with_free_func (g_object_unref);
+	for (iter = shared.probing; iter; iter = iter->next) {
+		NMArpingManager *self = iter->data;
+
+		if (NM_ARPING_MANAGER_GET_PRIVATE (self)->probe_next_ms <= now)
+			g_ptr_array_add (due, g_object_ref (self));
+	}
 
+	for (i = 0; i < due->len; i++) {
+		NMArpingManager *self = due->pdata[i];
+		NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
+
+		if (priv->state != STATE_PROBING)
+			continue;
+
+		if (priv->probes_sent < PROBE_NUM) {
+			probe_send (self);
+			priv->probe_next_ms = now + priv->probe_interval;
+		} else
+			probe_terminate (self);
+	}
+
+	probe_schedule ();
 	return G_SOURCE_REMOVE;
 }
 
+static void
+probe_schedule (void)
+{
+	GSList *iter;
+	gint64 expiry = G_MAXINT64;
+	gint64 now;
+
+	for (iter = shared.probing; iter; iter = iter->next) {
+		NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE ((NMArpingManager *) iter->data);
+
+		expiry = MIN (expiry, priv->probe_next_ms);
+	}
+
+	if (shared.timer_id) {
+		if (shared.timer_expiry_ms == expiry)
+			return;
+		nm_clear_g_source (&shared.timer_id);
+	}
+
+	if (!shared.probing)
+		return;
+
+	now = nm_utils_get_monotonic_timestamp_ms ();
+	shared.timer_expiry_ms = expiry;
+	shared.timer_id = g_timeout_add (expiry > now ? (guint) (expiry - now) : 0,
+	                                 probe_timeout_cb, NULL);
+}
+
+static void
+probe_cancel (NMArpingManager *self)
+{
+	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
+
+	if (priv->state != STATE_PROBING)
+		return;
+
+	shared.probing = g_slist_remove (shared.probing, self);
+	probe_schedule ();
+}
+
 /**
  * nm_arping_manager_start_probe:
  * @self: a #NMArpingManager
@@ -194,17 +510,18 @@ arping_timeout_cb (gpointer user_data)
  * Start probing IP addresses for duplicates; when the probe terminates a
  * PROBE_TERMINATED signal is emitted.
  *
- * Returns: %TRUE if at least one probe could be started, %FALSE otherwise
+ * All addresses are probed in parallel: the probes are sent spread over
+ * @timeout, after which the probe terminates. The packet socket of the
+ * interface and the probe timer are shared with all other managers, so
+ * that probes of different managers run concurrently. The probe terminates
+ * early if all addresses turn out to be duplicate.
+ *
+ * Returns: %TRUE if the probe could be started, %FALSE otherwise
  */
 gboolean
 nm_arping_manager_start_probe (NMArpingManager *self, guint timeout, GError **error)
 {
-	const char *argv[] = { NULL, "-D", "-q", "-I", NULL, "-c", NULL, "-w", NULL, NULL, NULL };
 	NMArpingManagerPrivate *priv;
-	GHashTableIter iter;
-	AddressInfo *info;
-	gs_free char *timeout_str = NULL;
-	gboolean success = FALSE;
 
 	g_return_val_if_fail (NM_IS_ARPING_MANAGER (self), FALSE);
 	g_return_val_if_fail (!error || !*error, FALSE);
@@ -213,54 +530,24 @@ nm_arping_manager_start_probe (NMArpingManager *self, guint timeout, GError **er
 	priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
 	g_return_val_if_fail (priv->state == STATE_INIT, FALSE);
 
-	argv[4] = nm_platform_link_get_name (NM_PLATFORM_GET, priv->ifindex);
-	if (!argv[4]) {
-		/* The device was probably just removed. */
-		g_set_error (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
-		             "can't find a name for ifindex %d", priv->ifindex);
-		return FALSE;
-	}
-
-	priv->completed = 0;
-
-	argv[0] = nm_utils_find_helper ("arping", NULL, NULL);
-	if (!argv[0]) {
+	if (!g_hash_table_size (priv->addresses)) {
 		g_set_error_literal (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
-		                     "arping could not be found");
+		                     "no addresses to probe");
 		return FALSE;
 	}
 
-	timeout_str = g_strdup_printf ("%u", timeout / 1000 + 2);
-	argv[6] = timeout_str;
-	argv[8] = timeout_str;
-
-	g_hash_table_iter_init (&iter, priv->addresses);
-
-	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &info)) {
-		gs_free char *tmp_str = NULL;
-
-		argv[9] = nm_utils_inet4_ntop (info->address, NULL);
-		_LOGD ("run %s", (tmp_str = g_strjoinv (" ", (char **) argv)));
-
-		if (g_spawn_async (NULL, (char **) argv, NULL,
-		                   G_SPAWN_STDOUT_TO_DEV_NULL |
-		                   G_SPAWN_STDERR_TO_DEV_NULL |
-		                   G_SPAWN_DO_NOT_REAP_CHILD,
-		                   NULL, NULL, &info->pid, NULL)) {
-			info->watch = g_child_watch_add (info->pid, arping_watch_cb, info);
-			success = TRUE;
-		}
-	}
+	if (!socket_open (self, error))
+		return FALSE;
 
-	if (success) {
-		priv->timer = g_timeout_add (timeout, arping_timeout_cb, self);
-		priv->state = STATE_PROBING;
-	} else {
-		g_set_error_literal (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
-		                     "could not spawn arping process");
-	}
+	priv->state = STATE_PROBING;
+	priv->probes_sent = 0;
+	priv->probe_interval = MAX (timeout / PROBE_NUM, 1u);
+	probe_send (self);
+	priv->probe_next_ms = nm_utils_get_monotonic_timestamp_ms () + priv->probe_interval;
+	shared.probing = g_slist_prepend (shared.probing, self);
+	probe_schedule ();
 
-	return success;
+	return TRUE;
 }
 
 /**
@@ -277,9 +564,10 @@ nm_arping_manager_reset (NMArpingManager *self)
 	g_return_if_fail (NM_IS_ARPING_MANAGER (self));
 	priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
 
-	nm_clear_g_source (&priv->timer);
+	probe_cancel (self);
 	nm_clear_g_source (&priv->round2_id);
 	g_hash_table_remove_all (priv->addresses);
+	socket_close (self);
 
 	priv->state = STATE_INIT;
 }
@@ -327,49 +615,27 @@ nm_arping_manager_check_address (NMArpingManager *self, in_addr_t address)
 }
 
 static void
-send_announcements (NMArpingManager *self, const char *mode_arg)
+send_announcements (NMArpingManager *self, guint16 op)
 {
 	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
-	const char *argv[] = { NULL, mode_arg, "-q", "-I", NULL, "-c", "1", NULL, NULL };
-	int ip_arg = G_N_ELEMENTS (argv) - 2;
-	GError *error = NULL;
+	gs_free_error GError *error = NULL;
 	GHashTableIter iter;
 	AddressInfo *info;
 
-	argv[4] = nm_platform_link_get_name (NM_PLATFORM_GET, priv->ifindex);
-	if (!argv[4]) {
-		/* The device was probably just removed. */
-		_LOGW ("can't find a name for ifindex %d", priv->ifindex);
-		return;
-	}
-
-	argv[0] = nm_utils_find_helper ("arping", NULL, NULL);
-	if (!argv[0]) {
-		_LOGW ("arping could not be found; no ARPs will be sent");
+	if (!socket_open (self, &error)) {
+		_LOGW ("no ARPs will be sent: %s", error->message);
 		return;
 	}
 
+	/* RFC 5227, 2.3: an announcement has the address as sender
+	 * and target address. */
 	g_hash_table_iter_init (&iter, priv->addresses);
-
 	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &info)) {
-		gs_free char *tmp_str = NULL;
-		gboolean success;
-
 		if (info->duplicate)
 			continue;
 
-		argv[ip_arg] = nm_utils_inet4_ntop (info->address, NULL);
-		_LOGD ("run %s", (tmp_str = g_strjoinv (" ", (char **) argv)));
-
-		success = g_spawn_async (NULL, (char **) argv, NULL,
-		                         G_SPAWN_STDOUT_TO_DEV_NULL |
-		                         G_SPAWN_STDERR_TO_DEV_NULL,
-		                         NULL, NULL, NULL, &error);
-		if (!success) {
-			_LOGW ("could not send ARP for address %s: %s", argv[ip_arg],
-			       error->message);
-			g_clear_error (&error);
-		}
+		_LOGD ("announce %s", nm_utils_inet4_ntop (info->address, NULL));
+		send_arp (self, op, info->address, info->address);
 	}
 }
 
@@ -379,9 +645,10 @@ arp_announce_round2 (gpointer self)
 	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE ((NMArpingManager *) self);
 
 	priv->round2_id = 0;
-	send_announcements (self, "-U");
+	send_announcements (self, ARPOP_REQUEST);
 	priv->state = STATE_INIT;
 	g_hash_table_remove_all (priv->addresses);
+	socket_close (self);
 
 	return G_SOURCE_REMOVE;
 }
@@ -400,7 +667,8 @@ nm_arping_manager_announce_addresses (NMArpingManager *self)
 	g_return_if_fail (   priv->state == STATE_INIT
 	                  || priv->state == STATE_PROBE_DONE);
 
-	send_announcements (self, "-A");
+	/* like "arping -A" first, and "arping -U" two seconds later. */
+	send_announcements (self, ARPOP_REPLY);
 	nm_clear_g_source (&priv->round2_id);
 	priv->round2_id = g_timeout_add_seconds (2, arp_announce_round2, self);
 	priv->state = STATE_ANNOUNCING;
@@ -411,13 +679,6 @@ destroy_address_info (gpointer data)
 {
 	AddressInfo *info = (AddressInfo *) data;
 
-	nm_clear_g_source (&info->watch);
-
-	if (info->pid) {
-		nm_utils_kill_child_async (info->pid, SIGTERM, LOGD_IP4, "arping",
-		                           1000, NULL, NULL);
-	}
-
 	g_slice_free (AddressInfo, info);
 }
 
@@ -451,9 +712,11 @@ dispose (GObject *object)
 	NMArpingManager *self = NM_ARPING_MANAGER (object);
 	NMArpingManagerPrivate *priv = NM_ARPING_MANAGER_GET_PRIVATE (self);
 
-	nm_clear_g_source (&priv->timer);
+	probe_cancel (self);
+	priv->state = STATE_INIT;
 	nm_clear_g_source (&priv->round2_id);
 	g_clear_pointer (&priv->addresses, g_hash_table_destroy);
+	socket_close (self);
 
 	G_OBJECT_CLASS (nm_arping_manager_parent_class)->dispose (object);
 }
@@ -130,36 +130,41 @@ complete_connection (NMDevice *device,
 typedef struct {
 	const char *name;
 	const char *sysname;
+	gsize nl_offset;
 	gboolean default_if_zero;
 	gboolean user_hz_compensate;
 } Option;
 
+#define MASTER_OPTION(name, sysname, field, default_if_zero, user_hz_compensate) \
+	{ name, sysname, G_STRUCT_OFFSET (NMPlatformBridgeOptions, field), default_if_zero, user_hz_compensate }
+
+#define SLAVE_OPTION(name, sysname, field, default_if_zero, user_hz_compensate) \
+	{ name, sysname, G_STRUCT_OFFSET (NMPlatformBridgePortOptions, field), default_if_zero, user_hz_compensate }
+
 static const Option master_options[] = {
-	{ NM_SETTING_BRIDGE_STP, "stp_state", FALSE, FALSE },
-	{ NM_SETTING_BRIDGE_PRIORITY, "priority", TRUE, FALSE },
-	{ NM_SETTING_BRIDGE_FORWARD_DELAY, "forward_delay", TRUE, TRUE },
-	{ NM_SETTING_BRIDGE_HELLO_TIME, "hello_time", TRUE, TRUE },
-	{ NM_SETTING_BRIDGE_MAX_AGE, "max_age", TRUE, TRUE },
-	{ NM_SETTING_BRIDGE_AGEING_TIME, "ageing_time", TRUE, TRUE },
-	{ NM_SETTING_BRIDGE_MULTICAST_SNOOPING, "multicast_snooping", FALSE, FALSE },
+	MASTER_OPTION (NM_SETTING_BRIDGE_STP, "stp_state", stp_state, FALSE, FALSE),
+	MASTER_OPTION (NM_SETTING_BRIDGE_PRIORITY, "priority", priority, TRUE, FALSE),
+	MASTER_OPTION (NM_SETTING_BRIDGE_FORWARD_DELAY, "forward_delay", forward_delay, TRUE, TRUE),
+	MASTER_OPTION (NM_SETTING_BRIDGE_HELLO_TIME, "hello_time", hello_time, TRUE, TRUE),
+	MASTER_OPTION (NM_SETTING_BRIDGE_MAX_AGE, "max_age", max_age, TRUE, TRUE),
+	MASTER_OPTION (NM_SETTING_BRIDGE_AGEING_TIME, "ageing_time", ageing_time, TRUE, TRUE),
+	MASTER_OPTION (NM_SETTING_BRIDGE_MULTICAST_SNOOPING, "multicast_snooping", multicast_snooping, FALSE, FALSE),
 	{ NULL, NULL }
 };
 
 static const Option slave_options[] = {
-	{ NM_SETTING_BRIDGE_PORT_PRIORITY, "priority", TRUE, FALSE },
-	{ NM_SETTING_BRIDGE_PORT_PATH_COST, "path_cost", TRUE, FALSE },
-	{ NM_SETTING_BRIDGE_PORT_HAIRPIN_MODE, "hairpin_mode", FALSE, FALSE },
+	SLAVE_OPTION (NM_SETTING_BRIDGE_PORT_PRIORITY, "priority", priority, TRUE, FALSE),
+	SLAVE_OPTION (NM_SETTING_BRIDGE_PORT_PATH_COST, "path_cost", path_cost, TRUE, FALSE),
+	SLAVE_OPTION (NM_SETTING_BRIDGE_PORT_HAIRPIN_MODE, "hairpin_mode", hairpin_mode, FALSE, FALSE),
 	{ NULL, NULL }
 };
 
-static void
-commit_option (NMDevice *device, NMSetting *setting, const Option *option, gboolean slave)
+static guint32
+option_get_value (NMSetting *setting, const Option *option)
 {
-	int ifindex = nm_device_get_ifindex (device);
 	GParamSpec *pspec;
 	GValue val = G_VALUE_INIT;
 	guint32 uval = 0;
-	gs_free char *value = NULL;
 
 	g_assert (setting);
 
@@ -195,27 +200,60 @@ commit_option (NMDevice *device, NMSetting *setting, const Option *option, gbool
 		g_assert_not_reached ();
 	g_value_unset (&val);
 
-	value = g_strdup_printf ("%u", uval);
-	if (slave)
-		nm_platform_sysctl_slave_set_option (NM_PLATFORM_GET, ifindex, option->sysname, value);
-	else
-		nm_platform_sysctl_master_set_option (NM_PLATFORM_GET, ifindex, option->sysname, value);
+	return uval;
 }
 
+/* Fill the platform options struct @nl_options from @setting. Returns
+ * the values in option order in @values as well, for the sysfs fallback. */
 static void
-commit_master_options (NMDevice *device, NMSettingBridge *setting)
+options_get_values (NMSetting *setting, const Option *options, gpointer nl_options, guint32 *values)
 {
 	const Option *option;
-	NMSetting *s = NM_SETTING (setting);
 
-	for (option = master_options; option->name; option++)
-		commit_option (device, s, option, FALSE);
+	for (option = options; option->name; option++) {
+		values[option - options] = option_get_value (setting, option);
+		G_STRUCT_MEMBER (guint32, nl_options, option->nl_offset) = values[option - options];
+	}
 }
 
 static void
-commit_slave_options (NMDevice *device, NMSettingBridgePort *setting)
+commit_options_sysfs (NMDevice *device, const Option *options, const guint32 *values, gboolean slave)
 {
+	int ifindex = nm_device_get_ifindex (device);
 	const Option *option;
+
+	for (option = options; option->name; option++) {
+		char value[20];
+
+		nm_sprintf_buf (value, "%u", values[option - options]);
+		if (slave)
+			nm_platform_sysctl_slave_set_option (NM_PLATFORM_GET, ifindex, option->sysname, value);
+		else
+			nm_platform_sysctl_master_set_option (NM_PLATFORM_GET, ifindex, option->sysname, value);
+	}
+}
+
+static void
+commit_master_options (NMDevice *device, NMSettingBridge *setting)
+{
+	NMPlatformBridgeOptions nl_options = { 0 };
+	guint32 values[G_N_ELEMENTS (master_options)];
+
+	options_get_values (NM_SETTING (setting), master_options, &nl_options, values);
+
+	/* set all options with one netlink message. Older kernels don't
+	 * support changing bridge options via netlink, and the kernel rejects
+	 * the whole message if one value is out of range. In both cases
+	 * set each option via sysfs, like we used to. */
+	if (!nm_platform_link_bridge_change (NM_PLATFORM_GET, nm_device_get_ifindex (device), &nl_options))
+		commit_options_sysfs (device, master_options, values, FALSE);
+}
+
+static void
+commit_slave_options (NMDevice *device, NMSettingBridgePort *setting)
+{
+	NMPlatformBridgePortOptions nl_options = { 0 };
+	guint32 values[G_N_ELEMENTS (slave_options)];
 	NMSetting *s, *s_clear = NULL;
 
 	if (setting)
@@ -223,8 +261,10 @@ commit_slave_options (NMDevice *device, NMSettingBridgePort *setting)
 	else
 		s = s_clear = nm_setting_bridge_port_new ();
 
-	for (option = slave_options; option->name; option++)
-		commit_option (device, s, option, TRUE);
+	options_get_values (s, slave_options, &nl_options, values);
+
+	if (!nm_platform_link_bridge_port_change (NM_PLATFORM_GET, nm_device_get_ifindex (device), &nl_options))
+		commit_options_sysfs (device, slave_options, values, TRUE);
 
 	g_clear_object (&s_clear);
 }
@@ -348,6 +388,48 @@ enslave_slave (NMDevice *device,
 	return TRUE;
 }
 
+static void
+enslave_slaves (NMDevice *device,
+                NMDevice *const *slaves,
+                NMConnection *const *connections,
+                const gboolean *configure,
+                guint n_slaves,
+                gboolean *out_success)
+{
+	NMDeviceBridge *self = NM_DEVICE_BRIDGE (device);
+	gs_free int *ifindexes = NULL;
+	gs_free gboolean *enslaved = NULL;
+	guint i, n = 0;
+
+	/* attach all ports with one batch of netlink requests. */
+	ifindexes = g_new (int, n_slaves);
+	enslaved = g_new0 (gboolean, n_slaves);
+	for (i = 0; i < n_slaves; i++) {
+		if (configure[i])
+			ifindexes[n++] = nm_device_get_ip_ifindex (slaves[i]);
+	}
+	if (n)
+		nm_platform_link_enslave_many (NM_PLATFORM_GET, nm_device_get_ip_ifindex (device), ifindexes, n, enslaved);
+
+	for (i = 0, n = 0; i < n_slaves; i++) {
+		if (!configure[i]) {
+			_LOGI (LOGD_BRIDGE, "bridge port %s was attached",
+			       nm_device_get_ip_iface (slaves[i]));
+			out_success[i] = TRUE;
+			continue;
+		}
+
+		out_success[i] = enslaved[n++];
+		if (!out_success[i])
+			continue;
+
+		commit_slave_options (slaves[i], nm_connection_get_setting_bridge_port (connections[i]));
+
+		_LOGI (LOGD_BRIDGE, "attached bridge port %s",
+		       nm_device_get_ip_iface (slaves[i]));
+	}
+}
+
 static void
 release_slave (NMDevice *device,
                NMDevice *slave,
@@ -444,6 +526,7 @@ nm_device_bridge_class_init (NMDeviceBridgeClass *klass)
 	parent_class->create_and_realize = create_and_realize;
 	parent_class->act_stage1_prepare = act_stage1_prepare;
 	parent_class->enslave_slave = enslave_slave;
+	parent_class->enslave_slaves = enslave_slaves;
 	parent_class->release_slave = release_slave;
 	parent_class->get_configured_mtu = nm_device_get_configured_mtu_for_wired;
 
@@ -246,11 +246,17 @@ nm_device_factory_class_init (NMDeviceFactoryClass *klass)
 static GHashTable *factories_by_link = NULL;
 static GHashTable *factories_by_setting = NULL;
 
+/* each loaded factory once, so that iterating them does not need to
+ * deduplicate the values of the hash tables above. */
+static GSList *factories = NULL;
+
 static void __attribute__((destructor))
 _cleanup (void)
 {
 	g_clear_pointer (&factories_by_link, g_hash_table_unref);
 	g_clear_pointer (&factories_by_setting, g_hash_table_unref);
+	g_slist_free_full (factories, g_object_unref);
+	factories = NULL;
 }
 
 static NMDeviceFactory *
@@ -304,30 +310,10 @@ void
 nm_device_factory_manager_for_each_factory (NMDeviceFactoryManagerFactoryFunc callback,
                                             gpointer user_data)
 {
-	GHashTableIter iter;
-	NMDeviceFactory *factory;
-	GSList *list_iter, *list = NULL;
-
-	if (factories_by_link) {
-		g_hash_table_iter_init (&iter, factories_by_link);
-		while (g_hash_table_iter_next (&iter, NULL, (gpointer) &factory)) {
-			if (!g_slist_find (list, factory))
-				list = g_slist_prepend (list, factory);
-		}
-	}
-
-	if (factories_by_setting) {
-		g_hash_table_iter_init (&iter, factories_by_setting);
-		while (g_hash_table_iter_next (&iter, NULL, (gpointer) &factory)) {
-			if (!g_slist_find (list, factory))
-				list = g_slist_prepend (list, factory);
-		}
-	}
-
-	for (list_iter = list; list_iter; list_iter = list_iter->next)
-		callback (list_iter->data, user_data);
+	GSList *iter;
 
-	g_slist_free (list);
+	for (iter = factories; iter; iter = iter->next)
+		callback (iter->data, user_data);
 }
 
 static gboolean
@@ -362,6 +348,7 @@ _add_factory (NMDeviceFactory *factory,
 		g_hash_table_insert (factories_by_link, GUINT_TO_POINTER (link_types[i]), g_object_ref (factory));
 	for (i = 0; setting_types && setting_types[i]; i++)
 		g_hash_table_insert (factories_by_setting, (char *) setting_types[i], g_object_ref (factory));
+	factories = g_slist_prepend (factories, g_object_ref (factory));
 
 	callback (factory, user_data);
 
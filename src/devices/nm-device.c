@@ -68,6 +68,7 @@
 #include "nm-arping-manager.h"
 #include "nm-connectivity.h"
 #include "nm-dbus-interface.h"
+#include "nm-trace.h"
 
 #include "nm-device-logging.h"
 _LOG_DECLARE_SELF (NMDevice);
@@ -109,6 +110,7 @@ typedef struct {
 	gulong watch_id;
 	bool slave_is_enslaved;
 	bool configure;
+	bool enslave_queued;
 } SlaveInfo;
 
 typedef struct {
@@ -132,6 +134,19 @@ typedef enum {
 	HW_ADDR_TYPE_GENERATED,
 } HwAddrType;
 
+typedef enum {
+	ACT_STAGE_PREPARE,    /* stage1, until stage2 starts */
+	ACT_STAGE_CONFIG,     /* stage2, until stage3 is scheduled */
+	ACT_STAGE_FIREWALL,   /* changing the firewall zone before stage3 */
+	ACT_STAGE_IP4_CONFIG, /* IPv4 configuration, including the DHCP wait, until stage5 */
+	ACT_STAGE_IP4_COMMIT, /* IPv4 stage5, until IPv4 is done */
+	ACT_STAGE_IP6_CONFIG, /* IPv6 configuration, including the ndisc and DHCPv6 wait, until stage5 */
+	ACT_STAGE_IP6_COMMIT, /* IPv6 stage5 and DAD, until IPv6 is done */
+	ACT_STAGE_DISPATCHER, /* the pre-up dispatcher scripts */
+	ACT_STAGE_TOTAL,      /* stage1 until the device is activated */
+	_ACT_STAGE_NUM,
+} ActStage;
+
 /*****************************************************************************/
 
 enum {
@@ -192,6 +207,7 @@ NM_GOBJECT_PROPERTIES_DEFINE (NMDevice,
 	PROP_TX_BYTES,
 	PROP_RX_BYTES,
 	PROP_CONNECTIVITY,
+	PROP_CARRIER_SUPPRESSED,
 );
 
 typedef struct _NMDevicePrivate {
@@ -210,8 +226,6 @@ typedef struct _NMDevicePrivate {
 		NMDeviceStateReason reason;
 	} queued_state;
 
-	guint queued_ip4_config_id;
-	guint queued_ip6_config_id;
 	GSList *pending_actions;
 	GSList *dad6_failed_addrs;
 
@@ -237,6 +251,10 @@ typedef struct _NMDevicePrivate {
 	bool queued_ip4_config_pending:1;
 	bool queued_ip6_config_pending:1;
 
+	/* the device is in ip_config_queue, see queued_ip_config_schedule() */
+	bool queued_ip4_config_scheduled:1;
+	bool queued_ip6_config_scheduled:1;
+
 	char *        ip_iface;
 	int           ip_ifindex;
 	NMDeviceType  type;
@@ -279,6 +297,7 @@ typedef struct _NMDevicePrivate {
 	ActivationHandleData act_handle4; /* for layer2 and IPv4. */
 	ActivationHandleData act_handle6;
 	guint           recheck_assume_id;
+	guint           enslave_queue_id;
 	struct {
 		guint               call_id;
 		NMDeviceStateReason available_reason;
@@ -296,6 +315,19 @@ typedef struct _NMDevicePrivate {
 	guint           carrier_defer_id;
 	guint           carrier_wait_id;
 	gulong          ignore_carrier_id;
+
+	/* penalty-based dampening of carrier flaps, like route flap
+	 * dampening in BGP. While suppressed, carrier-on is ignored. */
+	struct {
+		guint32     half_life;  /* seconds, 0 disables dampening */
+		guint32     suppress;
+		guint32     reuse;
+		guint32     penalty;
+		gint32      penalty_ts;
+		guint       reuse_id;
+		bool        suppressed:1;
+	}               carrier_damp;
+
 	guint32         mtu;
 	guint32         ip6_mtu;
 	guint32 mtu_initial;
@@ -371,6 +403,7 @@ typedef struct _NMDevicePrivate {
 
 	/* Firewall */
 	bool fw_ready;
+	bool fw_async;
 	NMFirewallManagerCallId fw_call;
 
 	/* IPv4LL stuff */
@@ -409,6 +442,11 @@ typedef struct _NMDevicePrivate {
 
 	GHashTable *   ip6_saved_properties;
 
+	/* original CPU masks of the queues ("rx-0" => "ff") and of the
+	 * interrupts ("42" => "ff") changed by the ethtool setting */
+	GHashTable *   queue_cpus_saved;
+	GHashTable *   irq_affinity_saved;
+
 	struct {
 		NMDhcpClient *   client;
 		NMNDiscDHCPLevel mode;
@@ -452,12 +490,19 @@ typedef struct _NMDevicePrivate {
 	guint check_delete_unrealized_id;
 
 	struct {
-		guint timeout_id;
+		/* the effective rate of the StatsGroup the device is in, or 0 */
+		guint group_rate_ms;
 		guint refresh_rate_ms;
 		guint64 tx_bytes;
 		guint64 rx_bytes;
 	} stats;
 
+	/* timestamps of the running activation stages, see _act_stage_begin() */
+	struct {
+		gint64 start_ns[_ACT_STAGE_NUM];
+		guint done;
+	} act_stage;
+
 } NMDevicePrivate;
 
 G_DEFINE_ABSTRACT_TYPE (NMDevice, nm_device, NM_TYPE_EXPORTED_OBJECT)
@@ -504,8 +549,8 @@ static void _set_state_full (NMDevice *self,
                              NMDeviceStateReason reason,
                              gboolean quitting);
 static void queued_state_clear (NMDevice *device);
-static gboolean queued_ip4_config_change (gpointer user_data);
-static gboolean queued_ip6_config_change (gpointer user_data);
+static void queued_ip_config_schedule (NMDevice *self, int addr_family);
+static gboolean queued_ip_config_unschedule (NMDevice *self, int addr_family);
 static void ip_check_ping_watch_cb (GPid pid, gint status, gpointer user_data);
 static gboolean ip_config_valid (NMDeviceState state);
 static NMActStageReturn dhcp4_start (NMDevice *self, NMConnection *connection);
@@ -520,6 +565,24 @@ static void _cancel_activation (NMDevice *self);
 
 /*****************************************************************************/
 
+/* unmanaged devices are only listed. To keep them cheap, state that is only
+ * needed for managed devices is allocated on demand. */
+static guint
+_available_connections_size (NMDevice *self)
+{
+	GHashTable *available_connections = NM_DEVICE_GET_PRIVATE (self)->available_connections;
+
+	return available_connections ? g_hash_table_size (available_connections) : 0;
+}
+
+static gboolean
+_is_listed_only (NMDevice *self)
+{
+	return NM_DEVICE_GET_PRIVATE (self)->state == NM_DEVICE_STATE_UNMANAGED;
+}
+
+/*****************************************************************************/
+
 NM_UTILS_LOOKUP_STR_DEFINE_STATIC (queued_state_to_string, NMDeviceState,
 	NM_UTILS_LOOKUP_DEFAULT  (                              NM_PENDING_ACTIONPREFIX_QUEUED_STATE_CHANGE "???"),
 	NM_UTILS_LOOKUP_STR_ITEM (NM_DEVICE_STATE_UNKNOWN,      NM_PENDING_ACTIONPREFIX_QUEUED_STATE_CHANGE "unknown"),
@@ -865,6 +928,115 @@ NM_UTILS_LOOKUP_STR_DEFINE_STATIC (_ip_state_to_string, IpState,
 	NM_UTILS_LOOKUP_STR_ITEM (IP_FAIL, "fail"),
 );
 
+/*****************************************************************************/
+
+/* Each activation stage is timed at most once per activation. The durations
+ * are exposed on the active connection and aggregated into daemon-wide
+ * histograms, where bucket 0 counts durations below 1 ms and bucket i
+ * those from 2^(i-1) up to 2^i ms. The last bucket has no upper bound. */
+
+#define ACT_STAGE_HISTOGRAM_BUCKETS 18
+
+static const char *const act_stage_names[_ACT_STAGE_NUM] = {
+	[ACT_STAGE_PREPARE]    = "prepare",
+	[ACT_STAGE_CONFIG]     = "config",
+	[ACT_STAGE_FIREWALL]   = "firewall",
+	[ACT_STAGE_IP4_CONFIG] = "ip4-config",
+	[ACT_STAGE_IP4_COMMIT] = "ip4-commit",
+	[ACT_STAGE_IP6_CONFIG] = "ip6-config",
+	[ACT_STAGE_IP6_COMMIT] = "ip6-commit",
+	[ACT_STAGE_DISPATCHER] = "dispatcher",
+	[ACT_STAGE_TOTAL]      = "total",
+};
+
+static struct {
+	guint64 count;
+	guint64 total_us;
+	guint64 max_us;
+	guint64 buckets[ACT_STAGE_HISTOGRAM_BUCKETS];
+} act_stage_stats[_ACT_STAGE_NUM];
+
+static void
+_act_stage_begin (NMDevice *self, ActStage stage)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+
+	/* external and assumed connections are not set up by us, there is
+	 * nothing to measure. */
+	if (   priv->act_stage.start_ns[stage]
+	    || NM_FLAGS_HAS (priv->act_stage.done, 1u << stage)
+	    || !priv->act_request
+	    || priv->state >= NM_DEVICE_STATE_ACTIVATED
+	    || nm_device_sys_iface_state_is_external_or_assume (self))
+		return;
+
+	priv->act_stage.start_ns[stage] = nm_utils_get_monotonic_timestamp_ns ();
+}
+
+static void
+_act_stage_end (NMDevice *self, ActStage stage)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	guint64 duration_us, ms;
+	guint bucket = 0;
+
+	if (!priv->act_stage.start_ns[stage])
+		return;
+
+	duration_us = (nm_utils_get_monotonic_timestamp_ns () - priv->act_stage.start_ns[stage]) / 1000;
+	priv->act_stage.start_ns[stage] = 0;
+	priv->act_stage.done |= (1u << stage);
+
+	if (priv->act_request) {
+		nm_active_connection_set_stage_duration (NM_ACTIVE_CONNECTION (priv->act_request),
+		                                         act_stage_names[stage],
+		                                         duration_us);
+	}
+
+	for (ms = duration_us / 1000; ms; ms >>= 1)
+		bucket++;
+	act_stage_stats[stage].buckets[MIN (bucket, ACT_STAGE_HISTOGRAM_BUCKETS - 1)]++;
+	act_stage_stats[stage].count++;
+	act_stage_stats[stage].total_us += duration_us;
+	act_stage_stats[stage].max_us = MAX (act_stage_stats[stage].max_us, duration_us);
+
+	_LOGD (LOGD_DEVICE, "Activation: stage %s took %"G_GUINT64_FORMAT".%03u ms",
+	       act_stage_names[stage], duration_us / 1000, (guint) (duration_us % 1000));
+}
+
+/**
+ * nm_device_activation_statistics_to_variant:
+ *
+ * Returns: (transfer floating): a variant of type "a{s(tttat)}" that maps
+ *   the name of each activation stage that completed at least once to the
+ *   number of activations, the total and maximum duration in microseconds
+ *   and the histogram of the durations.
+ */
+GVariant *
+nm_device_activation_statistics_to_variant (void)
+{
+	GVariantBuilder builder;
+	guint i;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{s(tttat)}"));
+	for (i = 0; i < _ACT_STAGE_NUM; i++) {
+		if (!act_stage_stats[i].count)
+			continue;
+		g_variant_builder_add (&builder, "{s(ttt@at)}",
+		                       act_stage_names[i],
+		                       act_stage_stats[i].count,
+		                       act_stage_stats[i].total_us,
+		                       act_stage_stats[i].max_us,
+		                       g_variant_new_fixed_array (G_VARIANT_TYPE_UINT64,
+		                                                  act_stage_stats[i].buckets,
+		                                                  ACT_STAGE_HISTOGRAM_BUCKETS,
+		                                                  sizeof (guint64)));
+	}
+	return g_variant_builder_end (&builder);
+}
+
+/*****************************************************************************/
+
 static void
 _set_ip_state (NMDevice *self, int addr_family, IpState new_state)
 {
@@ -879,6 +1051,11 @@ _set_ip_state (NMDevice *self, int addr_family, IpState new_state)
 		_LOGT (LOGD_DEVICE, "ip%c-state: set to %d (%s)", addr_family == AF_INET ? '4' : '6',
 		       (int) new_state, _ip_state_to_string (new_state));
 		*p = new_state;
+
+		if (new_state == IP_CONF)
+			_act_stage_begin (self, addr_family == AF_INET ? ACT_STAGE_IP4_CONFIG : ACT_STAGE_IP6_CONFIG);
+		else if (new_state == IP_DONE)
+			_act_stage_end (self, addr_family == AF_INET ? ACT_STAGE_IP4_COMMIT : ACT_STAGE_IP6_COMMIT);
 	}
 }
 
@@ -1021,7 +1198,7 @@ nm_device_set_ip_iface (NMDevice *self, const char *iface)
 	}
 
 	/* We don't care about any saved values from the old iface */
-	g_hash_table_remove_all (priv->ip6_saved_properties);
+	g_clear_pointer (&priv->ip6_saved_properties, g_hash_table_unref);
 
 	_notify (self, PROP_IP_IFACE);
 	return TRUE;
@@ -1208,22 +1385,106 @@ _stats_update_counters_from_pllink (NMDevice *self, const NMPlatformLink *pllink
 	_stats_update_counters (self, pllink->tx_bytes, pllink->rx_bytes);
 }
 
+/* Devices that want their statistics refreshed at the same rate share one
+ * timer. On each tick the group requests a single dump of all links instead
+ * of one RTM_GETLINK per device; the counters then reach every device through
+ * the regular link-changed handling. */
+typedef struct {
+	guint refresh_rate_ms;
+	guint timeout_id;
+	GHashTable *devices;
+} StatsGroup;
+
+/* up to this many devices in a group are refreshed one by one, beyond it a
+ * dump of all links is cheaper. */
+#define STATS_GROUP_REFRESH_ALL_MIN 3
+
+static GHashTable *stats_groups = NULL;
+static gint64 stats_refresh_all_last_ms;
+
 static gboolean
-_stats_timeout_cb (gpointer user_data)
+_stats_group_timeout_cb (gpointer user_data)
 {
-	NMDevice *self = user_data;
+	StatsGroup *group = user_data;
+	GHashTableIter iter;
+	NMDevice *device;
+	gint64 now_ms;
 	int ifindex;
 
-	ifindex = nm_device_get_ip_ifindex (self);
-
-	_LOGT (LOGD_DEVICE, "stats: refresh %d", ifindex);
+	if (g_hash_table_size (group->devices) < STATS_GROUP_REFRESH_ALL_MIN) {
+		g_hash_table_iter_init (&iter, group->devices);
+		while (g_hash_table_iter_next (&iter, (gpointer *) &device, NULL)) {
+			ifindex = nm_device_get_ip_ifindex (device);
+			nm_log_trace (LOGD_DEVICE, "stats: refresh %d (every %u ms)", ifindex, group->refresh_rate_ms);
+			if (ifindex > 0)
+				nm_platform_link_refresh (NM_PLATFORM_GET, ifindex);
+		}
+		return G_SOURCE_CONTINUE;
+	}
 
-	if (ifindex > 0)
-		nm_platform_link_refresh (NM_PLATFORM_GET, ifindex);
+	/* groups with different rates tick independently. Don't dump again if
+	 * another group just did, the data is still fresh enough. */
+	now_ms = nm_utils_get_monotonic_timestamp_ms ();
+	if (   stats_refresh_all_last_ms
+	    && now_ms - stats_refresh_all_last_ms < group->refresh_rate_ms / 2)
+		return G_SOURCE_CONTINUE;
+	stats_refresh_all_last_ms = now_ms;
 
+	nm_log_trace (LOGD_DEVICE, "stats: refresh all links for %u devices (every %u ms)",
+	              g_hash_table_size (group->devices), group->refresh_rate_ms);
+	nm_platform_link_refresh_all (NM_PLATFORM_GET);
 	return G_SOURCE_CONTINUE;
 }
 
+static void
+_stats_group_join (NMDevice *self, guint refresh_rate_ms)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	StatsGroup *group;
+
+	nm_assert (refresh_rate_ms);
+	nm_assert (!priv->stats.group_rate_ms);
+
+	if (!stats_groups)
+		stats_groups = g_hash_table_new (NULL, NULL);
+
+	group = g_hash_table_lookup (stats_groups, GUINT_TO_POINTER (refresh_rate_ms));
+	if (!group) {
+		group = g_slice_new0 (StatsGroup);
+		group->refresh_rate_ms = refresh_rate_ms;
+		group->devices = g_hash_table_new (NULL, NULL);
+		group->timeout_id = g_timeout_add (refresh_rate_ms, _stats_group_timeout_cb, group);
+		g_hash_table_insert (stats_groups, GUINT_TO_POINTER (refresh_rate_ms), group);
+	}
+
+	g_hash_table_add (group->devices, self);
+	priv->stats.group_rate_ms = refresh_rate_ms;
+}
+
+static void
+_stats_group_leave (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	StatsGroup *group;
+
+	if (!priv->stats.group_rate_ms)
+		return;
+
+	group = g_hash_table_lookup (stats_groups, GUINT_TO_POINTER (priv->stats.group_rate_ms));
+	priv->stats.group_rate_ms = 0;
+	g_return_if_fail (group);
+
+	if (!g_hash_table_remove (group->devices, self))
+		g_return_if_reached ();
+
+	if (g_hash_table_size (group->devices) == 0) {
+		g_hash_table_remove (stats_groups, GUINT_TO_POINTER (group->refresh_rate_ms));
+		nm_clear_g_source (&group->timeout_id);
+		g_hash_table_unref (group->devices);
+		g_slice_free (StatsGroup, group);
+	}
+}
+
 static guint
 _stats_refresh_rate_real (guint refresh_rate_ms)
 {
@@ -1266,7 +1527,7 @@ _stats_set_refresh_rate (NMDevice *self, guint refresh_rate_ms)
 	if (_stats_refresh_rate_real (old_rate) == refresh_rate_ms)
 		return;
 
-	nm_clear_g_source (&priv->stats.timeout_id);
+	_stats_group_leave (self);
 
 	if (!refresh_rate_ms)
 		return;
@@ -1278,7 +1539,7 @@ _stats_set_refresh_rate (NMDevice *self, guint refresh_rate_ms)
 	if (ifindex > 0)
 		nm_platform_link_refresh (NM_PLATFORM_GET, ifindex);
 
-	priv->stats.timeout_id = g_timeout_add (refresh_rate_ms, _stats_timeout_cb, self);
+	_stats_group_join (self, refresh_rate_ms);
 }
 
 /*****************************************************************************/
@@ -1909,6 +2170,43 @@ find_slave_info (NMDevice *self, NMDevice *slave)
  * Returns: %TRUE on success, %FALSE on failure or if this device cannot enslave
  *  other devices.
  */
+static void
+master_enslaved_slaves_changed (NMDevice *self, gboolean any_success)
+{
+	/* Ensure the device's hardware address is up-to-date; it often changes
+	 * when slaves change.
+	 */
+	nm_device_update_hw_address (self);
+
+	/* Restart IP configuration if we're waiting for slaves.  Do this
+	 * after updating the hardware address as IP config may need the
+	 * new address.
+	 */
+	if (any_success) {
+		if (NM_DEVICE_GET_PRIVATE (self)->ip4_state == IP_WAIT)
+			nm_device_activate_stage3_ip4_start (self);
+
+		if (NM_DEVICE_GET_PRIVATE (self)->ip6_state == IP_WAIT)
+			nm_device_activate_stage3_ip6_start (self);
+	}
+}
+
+static void
+master_enslave_slave_done (NMDevice *self, SlaveInfo *info, gboolean success)
+{
+	gs_unref_object NMDevice *slave = g_object_ref (info->slave);
+
+	info->slave_is_enslaved = success;
+
+	/* this might release the slave and free @info */
+	nm_device_slave_notify_enslave (slave, success);
+
+	/* Since slave devices don't have their own IP configuration,
+	 * set the MTU here.
+	 */
+	_commit_mtu (slave, NM_DEVICE_GET_PRIVATE (slave)->ip4_config);
+}
+
 static gboolean
 nm_device_master_enslave_slave (NMDevice *self, NMDevice *slave, NMConnection *connection)
 {
@@ -1924,6 +2222,8 @@ nm_device_master_enslave_slave (NMDevice *self, NMDevice *slave, NMConnection *c
 	if (!info)
 		return FALSE;
 
+	info->enslave_queued = FALSE;
+
 	if (info->slave_is_enslaved)
 		success = TRUE;
 	else {
@@ -1932,34 +2232,114 @@ nm_device_master_enslave_slave (NMDevice *self, NMDevice *slave, NMConnection *c
 			g_return_val_if_fail (nm_device_get_state (slave) >= NM_DEVICE_STATE_DISCONNECTED, FALSE);
 
 		success = NM_DEVICE_GET_CLASS (self)->enslave_slave (self, slave, connection, configure);
-		info->slave_is_enslaved = success;
 	}
 
-	nm_device_slave_notify_enslave (info->slave, success);
+	master_enslave_slave_done (self, info, success);
+	master_enslaved_slaves_changed (self, success);
+	return success;
+}
 
-	/* Ensure the device's hardware address is up-to-date; it often changes
-	 * when slaves change.
-	 */
-	nm_device_update_hw_address (self);
+static gboolean
+master_enslave_queue_cb (gpointer user_data)
+{
+	NMDevice *self = user_data;
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	gs_unref_ptrarray GPtrArray *slaves = NULL;
+	gs_free NMDevice **to_enslave = NULL;
+	gs_free NMConnection **connections = NULL;
+	gs_free gboolean *configure = NULL;
+	gs_free gboolean *success = NULL;
+	gboolean any_success = FALSE;
+	guint n_enslave = 0, n_enslaved;
+	GSList *iter;
+	guint i;
 
-	/* Restart IP configuration if we're waiting for slaves.  Do this
-	 * after updating the hardware address as IP config may need the
-	 * new address.
-	 */
-	if (success) {
-		if (NM_DEVICE_GET_PRIVATE (self)->ip4_state == IP_WAIT)
-			nm_device_activate_stage3_ip4_start (self);
+	priv->enslave_queue_id = 0;
 
-		if (NM_DEVICE_GET_PRIVATE (self)->ip6_state == IP_WAIT)
-			nm_device_activate_stage3_ip6_start (self);
+	slaves = g_ptr_array_new_with_free_func (g_object_unref);
+	for (iter = priv->slaves; iter; iter = iter->next) {
+		SlaveInfo *info = iter->data;
+
+		if (!info->enslave_queued)
+			continue;
+		info->enslave_queued = FALSE;
+
+		/* the slave may have moved on while it was queued */
+		if (   priv->state < NM_DEVICE_STATE_CONFIG
+		    || nm_device_get_state (info->slave) != NM_DEVICE_STATE_IP_CONFIG)
+			continue;
+
+		g_ptr_array_add (slaves, g_object_ref (info->slave));
 	}
 
-	/* Since slave devices don't have their own IP configuration,
-	 * set the MTU here.
-	 */
-	_commit_mtu (slave, NM_DEVICE_GET_PRIVATE (slave)->ip4_config);
+	if (!slaves->len)
+		return G_SOURCE_REMOVE;
 
-	return success;
+	to_enslave = g_new (NMDevice *, slaves->len);
+	connections = g_new (NMConnection *, slaves->len);
+	configure = g_new (gboolean, slaves->len);
+	success = g_new0 (gboolean, slaves->len);
+
+	for (i = 0; i < slaves->len; i++) {
+		SlaveInfo *info = find_slave_info (self, slaves->pdata[i]);
+
+		if (info->slave_is_enslaved)
+			continue;
+
+		to_enslave[n_enslave] = info->slave;
+		connections[n_enslave] = nm_device_get_applied_connection (info->slave);
+		configure[n_enslave] = (info->configure && connections[n_enslave] != NULL);
+		n_enslave++;
+	}
+
+	if (n_enslave) {
+		_LOGD (LOGD_DEVICE, "master: enslave %u queued slaves", n_enslave);
+		NM_DEVICE_GET_CLASS (self)->enslave_slaves (self, to_enslave, connections, configure,
+		                                            n_enslave, success);
+	}
+
+	/* finishing one slave can release others, so look them up again. */
+	for (i = 0, n_enslaved = 0; i < slaves->len; i++) {
+		SlaveInfo *info = find_slave_info (self, slaves->pdata[i]);
+		gboolean slave_success;
+
+		if (   n_enslaved < n_enslave
+		    && to_enslave[n_enslaved] == slaves->pdata[i])
+			slave_success = success[n_enslaved++];
+		else
+			slave_success = TRUE;
+
+		if (info) {
+			master_enslave_slave_done (self, info, slave_success);
+			any_success |= slave_success;
+		}
+	}
+
+	master_enslaved_slaves_changed (self, any_success);
+	return G_SOURCE_REMOVE;
+}
+
+/* Enslave @slave, right away or, if the master can handle several
+ * slaves at once, together with other slaves that become ready in the
+ * same main loop iteration. */
+static void
+master_enslave_slave_queue (NMDevice *self, NMDevice *slave)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	SlaveInfo *info;
+
+	if (!NM_DEVICE_GET_CLASS (self)->enslave_slaves) {
+		nm_device_master_enslave_slave (self, slave, nm_device_get_applied_connection (slave));
+		return;
+	}
+
+	info = find_slave_info (self, slave);
+	if (!info)
+		return;
+
+	info->enslave_queued = TRUE;
+	if (!priv->enslave_queue_id)
+		priv->enslave_queue_id = g_idle_add (master_enslave_queue_cb, self);
 }
 
 /**
@@ -2095,7 +2475,7 @@ nm_device_update_dynamic_ip_setup (NMDevice *self)
 
 	priv = NM_DEVICE_GET_PRIVATE (self);
 
-	g_hash_table_remove_all (priv->ip6_saved_properties);
+	g_clear_pointer (&priv->ip6_saved_properties, g_hash_table_unref);
 
 	if (priv->dhcp4.client) {
 		if (!nm_device_dhcp4_renew (self, FALSE)) {
@@ -2227,6 +2607,194 @@ link_disconnect_action_cancel (NMDevice *self)
 	}
 }
 
+/*****************************************************************************/
+
+#define CARRIER_DAMP_FLAP_PENALTY 1000
+#define CARRIER_DAMP_LIMIT_MAX    1000000
+
+static void
+carrier_damp_decay (NMDevice *self, gint32 now)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	guint32 elapsed, half_lives;
+
+	if (priv->carrier_damp.penalty && now > priv->carrier_damp.penalty_ts) {
+		elapsed = now - priv->carrier_damp.penalty_ts;
+		half_lives = elapsed / priv->carrier_damp.half_life;
+		if (half_lives >= 32)
+			priv->carrier_damp.penalty = 0;
+		else {
+			priv->carrier_damp.penalty >>= half_lives;
+			/* within one half-life, follow the chord of the decay curve.
+			 * It lies slightly above the curve, which errs on the side of
+			 * suppressing a little longer. */
+			priv->carrier_damp.penalty -= (guint64) priv->carrier_damp.penalty
+			                              * (elapsed % priv->carrier_damp.half_life)
+			                              / (2 * priv->carrier_damp.half_life);
+		}
+	}
+	priv->carrier_damp.penalty_ts = now;
+}
+
+static guint32
+carrier_damp_reuse_delay (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	guint32 penalty = priv->carrier_damp.penalty;
+	guint32 delay = 0;
+
+	if (penalty < priv->carrier_damp.reuse)
+		return 0;
+
+	while ((penalty >> 1) >= priv->carrier_damp.reuse) {
+		penalty >>= 1;
+		delay += priv->carrier_damp.half_life;
+	}
+
+	/* the inverse of the chord in carrier_damp_decay() */
+	return delay + 1 + (guint64) 2 * priv->carrier_damp.half_life
+	                   * (penalty - priv->carrier_damp.reuse) / penalty;
+}
+
+static void carrier_damp_schedule_reuse (NMDevice *self);
+
+static void
+carrier_damp_set_suppressed (NMDevice *self, gboolean suppressed)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	NMDeviceClass *klass = NM_DEVICE_GET_CLASS (self);
+
+	if (priv->carrier_damp.suppressed == (!!suppressed))
+		return;
+
+	priv->carrier_damp.suppressed = suppressed;
+	_notify (self, PROP_CARRIER_SUPPRESSED);
+
+	if (suppressed) {
+		_LOGW (LOGD_DEVICE, "link is flapping, ignoring carrier until it is stable (penalty %u)",
+		       (guint) priv->carrier_damp.penalty);
+		return;
+	}
+
+	nm_clear_g_source (&priv->carrier_damp.reuse_id);
+	_LOGI (LOGD_DEVICE, "link is stable again, no longer ignoring carrier");
+
+	if (priv->carrier) {
+		link_disconnect_action_cancel (self);
+		klass->carrier_changed (self, TRUE);
+
+		if (nm_clear_g_source (&priv->carrier_wait_id)) {
+			nm_device_remove_pending_action (self, NM_PENDING_ACTION_CARRIER_WAIT, TRUE);
+			_carrier_wait_check_queued_act_request (self);
+		}
+	}
+}
+
+static gboolean
+carrier_damp_reuse_cb (gpointer user_data)
+{
+	NMDevice *self = user_data;
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+
+	priv->carrier_damp.reuse_id = 0;
+
+	carrier_damp_decay (self, nm_utils_get_monotonic_timestamp_s ());
+	if (priv->carrier_damp.penalty < priv->carrier_damp.reuse)
+		carrier_damp_set_suppressed (self, FALSE);
+	else
+		carrier_damp_schedule_reuse (self);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+carrier_damp_schedule_reuse (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+
+	nm_clear_g_source (&priv->carrier_damp.reuse_id);
+	priv->carrier_damp.reuse_id = g_timeout_add_seconds (MAX (carrier_damp_reuse_delay (self), 1),
+	                                                     carrier_damp_reuse_cb, self);
+}
+
+static void
+carrier_damp_flap (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	guint32 ceiling;
+
+	if (!priv->carrier_damp.half_life)
+		return;
+
+	carrier_damp_decay (self, nm_utils_get_monotonic_timestamp_s ());
+
+	/* cap the penalty so that a suppressed link is used again after
+	 * at most a few half-lives of stability. */
+	ceiling = MAX (priv->carrier_damp.reuse << 4,
+	               priv->carrier_damp.suppress + CARRIER_DAMP_FLAP_PENALTY);
+	priv->carrier_damp.penalty = MIN (priv->carrier_damp.penalty + CARRIER_DAMP_FLAP_PENALTY,
+	                                  ceiling);
+
+	_LOGT (LOGD_DEVICE, "link flapped (penalty %u)", (guint) priv->carrier_damp.penalty);
+
+	if (priv->carrier_damp.penalty >= priv->carrier_damp.suppress)
+		carrier_damp_set_suppressed (self, TRUE);
+	if (priv->carrier_damp.suppressed)
+		carrier_damp_schedule_reuse (self);
+}
+
+static guint32
+carrier_damp_get_config (NMDevice *self,
+                         NMConfigData *config_data,
+                         const char *property,
+                         guint32 max,
+                         guint32 fallback)
+{
+	return nm_config_data_get_device_config_int64 (config_data, property, self, 0, max, fallback);
+}
+
+static void
+carrier_damp_update_config (NMDevice *self, NMConfigData *config_data)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	guint32 half_life, suppress, reuse;
+
+	half_life = carrier_damp_get_config (self, config_data,
+	                                     NM_CONFIG_KEYFILE_KEY_DEVICE_CARRIER_DAMPENING_HALF_LIFE,
+	                                     G_MAXINT32, 0);
+	suppress = carrier_damp_get_config (self, config_data,
+	                                    NM_CONFIG_KEYFILE_KEY_DEVICE_CARRIER_DAMPENING_SUPPRESS,
+	                                    CARRIER_DAMP_LIMIT_MAX, 2000);
+	reuse = carrier_damp_get_config (self, config_data,
+	                                 NM_CONFIG_KEYFILE_KEY_DEVICE_CARRIER_DAMPENING_REUSE,
+	                                 CARRIER_DAMP_LIMIT_MAX, 750);
+
+	if (half_life && (!reuse || reuse >= suppress)) {
+		_LOGW (LOGD_DEVICE, "carrier dampening disabled: the reuse limit %u must be non-zero and below the suppress limit %u",
+		       (guint) reuse, (guint) suppress);
+		half_life = 0;
+	}
+
+	if (   priv->carrier_damp.half_life == half_life
+	    && priv->carrier_damp.suppress == suppress
+	    && priv->carrier_damp.reuse == reuse)
+		return;
+
+	if (priv->carrier_damp.half_life)
+		carrier_damp_decay (self, nm_utils_get_monotonic_timestamp_s ());
+
+	priv->carrier_damp.half_life = half_life;
+	priv->carrier_damp.suppress = suppress;
+	priv->carrier_damp.reuse = reuse;
+
+	if (!half_life) {
+		priv->carrier_damp.penalty = 0;
+		carrier_damp_set_suppressed (self, FALSE);
+	} else if (priv->carrier_damp.suppressed)
+		carrier_damp_schedule_reuse (self);
+}
+
+/*****************************************************************************/
+
 void
 nm_device_set_carrier (NMDevice *self, gboolean carrier)
 {
@@ -2240,7 +2808,15 @@ nm_device_set_carrier (NMDevice *self, gboolean carrier)
 	priv->carrier = carrier;
 	_notify (self, PROP_CARRIER);
 
+	if (!priv->carrier)
+		carrier_damp_flap (self);
+
 	if (priv->carrier) {
+		if (priv->carrier_damp.suppressed) {
+			_LOGI (LOGD_DEVICE, "link connected (ignored while flapping)");
+			return;
+		}
+
 		_LOGI (LOGD_DEVICE, "link connected");
 		link_disconnect_action_cancel (self);
 		klass->carrier_changed (self, TRUE);
@@ -2807,9 +3383,14 @@ config_changed_update_ignore_carrier (NMConfig *config,
 {
 	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
 
+	if (!NM_FLAGS_HAS (changes, NM_CONFIG_CHANGE_DEVICE_CONFIG))
+		return;
+
 	if (   priv->state <= NM_DEVICE_STATE_DISCONNECTED
 	    || priv->state > NM_DEVICE_STATE_ACTIVATED)
 		priv->ignore_carrier = nm_config_data_get_ignore_carrier (config_data, self);
+
+	carrier_damp_update_config (self, config_data);
 }
 
 static void
@@ -2864,8 +3445,8 @@ realize_start_setup (NMDevice *self,
 	g_return_if_fail (nm_device_get_unmanaged_flags (self, NM_UNMANAGED_PLATFORM_INIT));
 	g_return_if_fail (priv->ip_ifindex <= 0);
 	g_return_if_fail (priv->ip_iface == NULL);
-	g_return_if_fail (!priv->queued_ip4_config_id);
-	g_return_if_fail (!priv->queued_ip6_config_id);
+	g_return_if_fail (!priv->queued_ip4_config_scheduled);
+	g_return_if_fail (!priv->queued_ip6_config_scheduled);
 
 	_LOGD (LOGD_DEVICE, "start setup of %s, kernel ifindex %d", G_OBJECT_TYPE_NAME (self), plink ? plink->ifindex : 0);
 
@@ -2941,6 +3522,7 @@ realize_start_setup (NMDevice *self,
 	/* Note: initial hardware address must be read before calling get_ignore_carrier() */
 	config = nm_config_get ();
 	priv->ignore_carrier = nm_config_data_get_ignore_carrier (nm_config_get_data (config), self);
+	carrier_damp_update_config (self, nm_config_get_data (config));
 	if (!priv->ignore_carrier_id) {
 		priv->ignore_carrier_id = g_signal_connect (config,
 		                                            NM_CONFIG_SIGNAL_CONFIG_CHANGED,
@@ -2959,10 +3541,10 @@ realize_start_setup (NMDevice *self,
 		priv->carrier = TRUE;
 	}
 
-	nm_assert (!priv->stats.timeout_id);
+	nm_assert (!priv->stats.group_rate_ms);
 	real_rate = _stats_refresh_rate_real (priv->stats.refresh_rate_ms);
 	if (real_rate)
-		priv->stats.timeout_id = g_timeout_add (real_rate, _stats_timeout_cb, self);
+		_stats_group_join (self, real_rate);
 
 	nm_device_set_autoconnect_full (self, !!DEFAULT_AUTOCONNECT, TRUE);
 
@@ -3043,7 +3625,7 @@ available_connections_check_delete_unrealized_on_idle (gpointer user_data)
 
 	priv->check_delete_unrealized_id = 0;
 
-	if (   g_hash_table_size (priv->available_connections) == 0
+	if (   _available_connections_size (self) == 0
 	    && !nm_device_is_real (self))
 		g_signal_emit (self, signals[REMOVED], 0);
 
@@ -3058,7 +3640,7 @@ available_connections_check_delete_unrealized (NMDevice *self)
 	/* always rescheadule the remove signal. */
 	nm_clear_g_source (&priv->check_delete_unrealized_id);
 
-	if (   g_hash_table_size (priv->available_connections) == 0
+	if (   _available_connections_size (self) == 0
 	    && !nm_device_is_real (self))
 		priv->check_delete_unrealized_id = g_idle_add (available_connections_check_delete_unrealized_on_idle, self);
 }
@@ -3144,7 +3726,7 @@ nm_device_unrealize (NMDevice *self, gboolean remove_resources, GError **error)
 		_notify (self, PROP_PHYSICAL_PORT_ID);
 	}
 
-	nm_clear_g_source (&priv->stats.timeout_id);
+	_stats_group_leave (self);
 	_stats_update_counters (self, 0, 0);
 
 	priv->hw_addr_len_ = 0;
@@ -3271,7 +3853,7 @@ slave_state_changed (NMDevice *slave,
 		return;
 
 	if (slave_new_state == NM_DEVICE_STATE_IP_CONFIG)
-		nm_device_master_enslave_slave (self, slave, nm_device_get_applied_connection (slave));
+		master_enslave_slave_queue (self, slave);
 	else if (slave_new_state > NM_DEVICE_STATE_ACTIVATED)
 		release = TRUE;
 	else if (   slave_new_state <= NM_DEVICE_STATE_DISCONNECTED
@@ -3662,7 +4244,8 @@ is_available (NMDevice *self, NMDeviceCheckDevAvailableFlags flags)
 {
 	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
 
-	if (priv->carrier || priv->ignore_carrier)
+	if (   (priv->carrier && !priv->carrier_damp.suppressed)
+	    || priv->ignore_carrier)
 		return TRUE;
 
 	if (NM_FLAGS_HAS (flags, _NM_DEVICE_CHECK_DEV_AVAILABLE_IGNORE_CARRIER))
@@ -4564,6 +5147,9 @@ activate_stage1_device_prepare (NMDevice *self)
 	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
 	NMActStageReturn ret = NM_ACT_STAGE_RETURN_SUCCESS;
 
+	_act_stage_begin (self, ACT_STAGE_TOTAL);
+	_act_stage_begin (self, ACT_STAGE_PREPARE);
+
 	_set_ip_state (self, AF_INET, IP_NONE);
 	_set_ip_state (self, AF_INET6, IP_NONE);
 
@@ -4653,6 +5239,166 @@ lldp_init (NMDevice *self, gboolean restart)
 	}
 }
 
+static void
+ethtool_set (NMDevice *self)
+{
+	NMSettingEthtool *s_ethtool;
+	int ifindex = nm_device_get_ifindex (self);
+
+	if (ifindex <= 0)
+		return;
+
+	s_ethtool = (NMSettingEthtool *) nm_device_get_applied_setting (self, NM_TYPE_SETTING_ETHTOOL);
+	if (!s_ethtool)
+		return;
+
+	/* Failures are not fatal: not every driver supports every
+	 * parameter and the connection still works with the defaults. */
+	if (!nm_platform_ethtool_set_ring (NM_PLATFORM_GET, ifindex,
+	                                   nm_setting_ethtool_get_ring_rx (s_ethtool),
+	                                   nm_setting_ethtool_get_ring_tx (s_ethtool)))
+		_LOGW (LOGD_DEVICE, "ethtool: failure to set ring parameters");
+
+	if (!nm_platform_ethtool_set_channels (NM_PLATFORM_GET, ifindex,
+	                                       nm_setting_ethtool_get_channels_combined (s_ethtool)))
+		_LOGW (LOGD_DEVICE, "ethtool: failure to set channels");
+
+	if (!nm_platform_ethtool_set_coalesce (NM_PLATFORM_GET, ifindex,
+	                                       nm_setting_ethtool_get_coalesce_rx_usecs (s_ethtool),
+	                                       nm_setting_ethtool_get_coalesce_tx_usecs (s_ethtool)))
+		_LOGW (LOGD_DEVICE, "ethtool: failure to set interrupt coalescing");
+
+	if (!nm_platform_ethtool_set_offloads (NM_PLATFORM_GET, ifindex,
+	                                       nm_setting_ethtool_get_offload_gro (s_ethtool),
+	                                       nm_setting_ethtool_get_offload_tso (s_ethtool),
+	                                       nm_setting_ethtool_get_offload_lro (s_ethtool)))
+		_LOGW (LOGD_DEVICE, "ethtool: failure to set offload features");
+}
+
+static const char *
+cpus_resolve (NMDevice *self, const char *cpus, char **numa_cpus)
+{
+	if (!nm_streq0 (cpus, NM_SETTING_ETHTOOL_CPUS_NUMA))
+		return cpus;
+
+	if (!*numa_cpus) {
+		*numa_cpus = nm_platform_link_get_numa_cpus (NM_PLATFORM_GET, nm_device_get_ifindex (self));
+		if (!*numa_cpus) {
+			_LOGD (LOGD_DEVICE, "ethtool: NUMA node of device unknown, not changing CPU masks");
+			return NULL;
+		}
+	}
+	return *numa_cpus;
+}
+
+static void
+queue_cpus_set (NMDevice *self, gboolean tx, const char *cpus)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	const char *option = tx ? "xps_cpus" : "rps_cpus";
+	gs_strfreev char **queues = NULL;
+	char *value;
+	guint i;
+
+	queues = nm_platform_link_get_queues (NM_PLATFORM_GET, priv->ifindex, tx);
+	if (!queues)
+		return;
+
+	for (i = 0; queues[i]; i++) {
+		if (!priv->queue_cpus_saved)
+			priv->queue_cpus_saved = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+		if (!g_hash_table_contains (priv->queue_cpus_saved, queues[i])) {
+			value = nm_platform_link_get_queue_option (NM_PLATFORM_GET, priv->ifindex, queues[i], option);
+			if (!value)
+				continue;
+			g_hash_table_insert (priv->queue_cpus_saved, g_strdup (queues[i]), value);
+		}
+		if (!nm_platform_link_set_queue_option (NM_PLATFORM_GET, priv->ifindex, queues[i], option, cpus))
+			_LOGW (LOGD_DEVICE, "ethtool: failure to set %s of queue %s to %s", option, queues[i], cpus);
+	}
+}
+
+static void
+irq_affinity_set (NMDevice *self, const char *cpus)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	gs_strfreev char **irqs = NULL;
+	char *value;
+	guint i;
+
+	irqs = nm_platform_link_get_irqs (NM_PLATFORM_GET, priv->ifindex);
+	if (!irqs)
+		return;
+
+	for (i = 0; irqs[i]; i++) {
+		if (!priv->irq_affinity_saved)
+			priv->irq_affinity_saved = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+		if (!g_hash_table_contains (priv->irq_affinity_saved, irqs[i])) {
+			value = nm_platform_irq_get_affinity (NM_PLATFORM_GET, irqs[i]);
+			if (!value)
+				continue;
+			g_hash_table_insert (priv->irq_affinity_saved, g_strdup (irqs[i]), value);
+		}
+		if (!nm_platform_irq_set_affinity (NM_PLATFORM_GET, irqs[i], cpus))
+			_LOGW (LOGD_DEVICE, "ethtool: failure to set affinity of IRQ %s to %s", irqs[i], cpus);
+	}
+}
+
+static void
+cpu_masks_set (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	NMSettingEthtool *s_ethtool;
+	gs_free char *numa_cpus = NULL;
+	const char *cpus;
+
+	if (priv->ifindex <= 0)
+		return;
+
+	s_ethtool = (NMSettingEthtool *) nm_device_get_applied_setting (self, NM_TYPE_SETTING_ETHTOOL);
+	if (!s_ethtool)
+		return;
+
+	cpus = cpus_resolve (self, nm_setting_ethtool_get_rps_cpus (s_ethtool), &numa_cpus);
+	if (cpus)
+		queue_cpus_set (self, FALSE, cpus);
+
+	cpus = cpus_resolve (self, nm_setting_ethtool_get_xps_cpus (s_ethtool), &numa_cpus);
+	if (cpus)
+		queue_cpus_set (self, TRUE, cpus);
+
+	cpus = cpus_resolve (self, nm_setting_ethtool_get_irq_affinity (s_ethtool), &numa_cpus);
+	if (cpus)
+		irq_affinity_set (self, cpus);
+}
+
+static void
+cpu_masks_restore (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	GHashTableIter iter;
+	const char *key, *value;
+
+	if (priv->queue_cpus_saved) {
+		if (priv->ifindex > 0) {
+			g_hash_table_iter_init (&iter, priv->queue_cpus_saved);
+			while (g_hash_table_iter_next (&iter, (gpointer *) &key, (gpointer *) &value)) {
+				nm_platform_link_set_queue_option (NM_PLATFORM_GET, priv->ifindex, key,
+				                                   g_str_has_prefix (key, "tx-") ? "xps_cpus" : "rps_cpus",
+				                                   value);
+			}
+		}
+		g_clear_pointer (&priv->queue_cpus_saved, g_hash_table_unref);
+	}
+
+	if (priv->irq_affinity_saved) {
+		g_hash_table_iter_init (&iter, priv->irq_affinity_saved);
+		while (g_hash_table_iter_next (&iter, (gpointer *) &key, (gpointer *) &value))
+			nm_platform_irq_set_affinity (NM_PLATFORM_GET, key, value);
+		g_clear_pointer (&priv->irq_affinity_saved, g_hash_table_unref);
+	}
+}
+
 /*
  * activate_stage2_device_config
  *
@@ -4668,6 +5414,9 @@ activate_stage2_device_config (NMDevice *self)
 	gboolean no_firmware = FALSE;
 	GSList *iter;
 
+	_act_stage_end (self, ACT_STAGE_PREPARE);
+	_act_stage_begin (self, ACT_STAGE_CONFIG);
+
 	nm_device_state_changed (self, NM_DEVICE_STATE_CONFIG, NM_DEVICE_STATE_REASON_NONE);
 
 	/* Assumed connections were already set up outside NetworkManager */
@@ -4682,6 +5431,9 @@ activate_stage2_device_config (NMDevice *self)
 			return;
 		}
 
+		ethtool_set (self);
+		cpu_masks_set (self);
+
 		ret = NM_DEVICE_GET_CLASS (self)->act_stage2_config (self, &failure_reason);
 		if (ret == NM_ACT_STAGE_RETURN_POSTPONE)
 			return;
@@ -4698,7 +5450,7 @@ activate_stage2_device_config (NMDevice *self)
 		NMDeviceState slave_state = nm_device_get_state (info->slave);
 
 		if (slave_state == NM_DEVICE_STATE_IP_CONFIG)
-			nm_device_master_enslave_slave (self, info->slave, nm_device_get_applied_connection (info->slave));
+			master_enslave_slave_queue (self, info->slave);
 		else if (   priv->act_request
 		         && nm_device_sys_iface_state_is_external (self)
 		         && slave_state <= NM_DEVICE_STATE_DISCONNECTED)
@@ -5673,8 +6425,8 @@ dhcp4_state_changed (NMDhcpClient *client,
 		priv->dhcp4.pac_url = g_strdup (g_hash_table_lookup (options, "wpad"));
 		nm_device_set_proxy_config (self, priv->dhcp4.pac_url);
 
-		nm_dhcp4_config_set_options (priv->dhcp4.config, options);
-		_notify (self, PROP_DHCP4_CONFIG);
+		if (nm_dhcp4_config_set_options (priv->dhcp4.config, options))
+			_notify (self, PROP_DHCP4_CONFIG);
 		priv->dhcp4.num_tries_left = DHCP_NUM_TRIES_MAX;
 
 		if (priv->ip4_state == IP_CONF) {
@@ -6483,8 +7235,8 @@ dhcp6_state_changed (NMDhcpClient *client,
 			if (ip6_config) {
 				priv->dhcp6.ip6_config = g_object_ref (ip6_config);
 				priv->dhcp6.event_id = g_strdup (event_id);
-				nm_dhcp6_config_set_options (priv->dhcp6.config, options);
-				_notify (self, PROP_DHCP6_CONFIG);
+				if (nm_dhcp6_config_set_options (priv->dhcp6.config, options))
+					_notify (self, PROP_DHCP6_CONFIG);
 			}
 		}
 
@@ -6551,6 +7303,12 @@ dhcp6_start_with_link_ready (NMDevice *self, NMConnection *connection)
 	s_ip6 = nm_connection_get_setting_ip6_config (connection);
 	g_assert (s_ip6);
 
+	if (!priv->ext_ip6_config_captured) {
+		/* not kept while the device was unmanaged, see update_ip6_config(). */
+		priv->ext_ip6_config_captured = nm_ip6_config_capture (nm_device_get_ip_ifindex (self),
+		                                                       FALSE,
+		                                                       NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
+	}
 	if (priv->ext_ip6_config_captured)
 		ll_addr = nm_ip6_config_get_address_first_nontentative (priv->ext_ip6_config_captured, TRUE);
 
@@ -7100,15 +7858,90 @@ _commit_mtu (NMDevice *self, const NMIP4Config *config)
 			priv->ip6_mtu_initial = _IP6_MTU_SYS ();
 		}
 
-		if (mtu_desired && mtu_desired != mtu_plat)
-			nm_platform_link_set_mtu (NM_PLATFORM_GET, ifindex, mtu_desired);
+		if (mtu_desired && mtu_desired != mtu_plat)
+			nm_platform_link_set_mtu (NM_PLATFORM_GET, ifindex, mtu_desired);
+
+		if (ip6_mtu && ip6_mtu != _IP6_MTU_SYS ()) {
+			nm_device_ipv6_sysctl_set (self, "mtu",
+			                           nm_sprintf_buf (sbuf, "%u", (unsigned) ip6_mtu));
+		}
+	}
+#undef _IP6_MTU_SYS
+}
+
+static void
+ndisc_address_fill (NMPlatformIP6Address *address,
+                    const NMNDiscAddress *discovered_address,
+                    gboolean system_support,
+                    guint32 ifa_flags)
+{
+	memset (address, 0, sizeof (*address));
+	address->address = discovered_address->address;
+	address->plen = system_support ? 64 : 128;
+	address->timestamp = discovered_address->timestamp;
+	address->lifetime = discovered_address->lifetime;
+	address->preferred = discovered_address->preferred;
+	if (address->preferred > address->lifetime)
+		address->preferred = address->lifetime;
+	address->addr_source = NM_IP_CONFIG_SOURCE_NDISC;
+	address->n_ifa_flags = ifa_flags;
+}
+
+/* Routers re-announce their prefixes every few seconds, which mostly just
+ * extends the lifetimes of the addresses already configured. Handle that
+ * by updating the lifetimes on the existing addresses instead of
+ * rebuilding and re-committing the whole IPv6 configuration. Returns
+ * %FALSE if the set of addresses changed. */
+static gboolean
+ndisc_refresh_address_lifetimes (NMDevice *self,
+                                 const NMNDiscData *rdata,
+                                 gboolean system_support,
+                                 guint32 ifa_flags)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	NMPlatformIP6Address address;
+	const NMPlatformIP6Address *old;
+	guint32 now, lifetime, preferred;
+	int ifindex = nm_device_get_ip_ifindex (self);
+	guint i;
+
+	if (nm_ip6_config_get_num_addresses (priv->ac_ip6_config) != rdata->addresses_n)
+		return FALSE;
+
+	/* the addresses were added in the order of @rdata */
+	for (i = 0; i < rdata->addresses_n; i++) {
+		ndisc_address_fill (&address, &rdata->addresses[i], system_support, ifa_flags);
+		old = nm_ip6_config_get_address (priv->ac_ip6_config, i);
+		if (   !IN6_ARE_ADDR_EQUAL (&old->address, &address.address)
+		    || old->plen != address.plen
+		    || old->n_ifa_flags != address.n_ifa_flags)
+			return FALSE;
+
+		/* adding keeps the longer lifetime, so shortened lifetimes
+		 * need the rebuild. */
+		if (nm_platform_ip_address_cmp_expiry ((const NMPlatformIPAddress *) old,
+		                                       (const NMPlatformIPAddress *) &address) > 0)
+			return FALSE;
+	}
+
+	now = nm_utils_get_monotonic_timestamp_s ();
+	for (i = 0; i < rdata->addresses_n; i++) {
+		ndisc_address_fill (&address, &rdata->addresses[i], system_support, ifa_flags);
+		nm_ip6_config_add_address (priv->ac_ip6_config, &address);
+		if (   priv->ip6_config
+		    && nm_ip6_config_address_exists (priv->ip6_config, &address))
+			nm_ip6_config_add_address (priv->ip6_config, &address);
 
-		if (ip6_mtu && ip6_mtu != _IP6_MTU_SYS ()) {
-			nm_device_ipv6_sysctl_set (self, "mtu",
-			                           nm_sprintf_buf (sbuf, "%u", (unsigned) ip6_mtu));
-		}
+		if (!nm_utils_lifetime_get (address.timestamp, address.lifetime, address.preferred,
+		                            now, &lifetime, &preferred))
+			continue;
+		nm_platform_ip6_address_add (NM_PLATFORM_GET, ifindex, address.address,
+		                             address.plen, address.peer_address,
+		                             lifetime, preferred, address.n_ifa_flags);
 	}
-#undef _IP6_MTU_SYS
+
+	_LOGD (LOGD_IP6, "ndisc: refreshed lifetimes of %u addresses", (guint) rdata->addresses_n);
+	return TRUE;
 }
 
 static void
@@ -7142,6 +7975,11 @@ ndisc_config_changed (NMNDisc *ndisc, const NMNDiscData *rdata, guint changed_in
 	if (!priv->ac_ip6_config)
 		priv->ac_ip6_config = nm_ip6_config_new (nm_device_get_ip_ifindex (self));
 
+	if (   changed == NM_NDISC_CONFIG_ADDRESSES
+	    && priv->ip6_state == IP_DONE
+	    && ndisc_refresh_address_lifetimes (self, rdata, system_support, ifa_flags))
+		return;
+
 	if (changed & NM_NDISC_CONFIG_GATEWAYS) {
 		/* Use the first gateway as ordered in neighbor discovery cache. */
 		if (rdata->gateways_n)
@@ -7160,20 +7998,9 @@ ndisc_config_changed (NMNDisc *ndisc, const NMNDiscData *rdata, guint changed_in
 		 * max_addresses.
 		 **/
 		for (i = 0; i < rdata->addresses_n; i++) {
-			const NMNDiscAddress *discovered_address = &rdata->addresses[i];
 			NMPlatformIP6Address address;
 
-			memset (&address, 0, sizeof (address));
-			address.address = discovered_address->address;
-			address.plen = system_support ? 64 : 128;
-			address.timestamp = discovered_address->timestamp;
-			address.lifetime = discovered_address->lifetime;
-			address.preferred = discovered_address->preferred;
-			if (address.preferred > address.lifetime)
-				address.preferred = address.lifetime;
-			address.addr_source = NM_IP_CONFIG_SOURCE_NDISC;
-			address.n_ifa_flags = ifa_flags;
-
+			ndisc_address_fill (&address, &rdata->addresses[i], system_support, ifa_flags);
 			nm_ip6_config_add_address (priv->ac_ip6_config, &address);
 		}
 	}
@@ -7436,11 +8263,13 @@ save_ip6_properties (NMDevice *self)
 	char *value;
 	int i;
 
-	g_hash_table_remove_all (priv->ip6_saved_properties);
+	g_clear_pointer (&priv->ip6_saved_properties, g_hash_table_unref);
 
 	for (i = 0; i < G_N_ELEMENTS (ip6_properties_to_save); i++) {
 		value = nm_platform_sysctl_get (NM_PLATFORM_GET, NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_ip6_property_path (ifname, ip6_properties_to_save[i])));
 		if (value) {
+			if (!priv->ip6_saved_properties)
+				priv->ip6_saved_properties = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
 			g_hash_table_insert (priv->ip6_saved_properties,
 			                     (char *) ip6_properties_to_save[i],
 			                     value);
@@ -7455,6 +8284,9 @@ restore_ip6_properties (NMDevice *self)
 	GHashTableIter iter;
 	gpointer key, value;
 
+	if (!priv->ip6_saved_properties)
+		return;
+
 	g_hash_table_iter_init (&iter, priv->ip6_saved_properties);
 	while (g_hash_table_iter_next (&iter, &key, &value)) {
 		/* Don't touch "disable_ipv6" if we're doing userland IPv6LL */
@@ -7884,9 +8716,38 @@ fw_change_zone_cb_stage2 (NMFirewallManager *firewall_manager,
 	priv = NM_DEVICE_GET_PRIVATE (self);
 	priv->fw_ready = TRUE;
 
+	_act_stage_end (self, ACT_STAGE_FIREWALL);
+
 	nm_device_activate_schedule_stage3_ip_config_start (self);
 }
 
+static void ip_check_start_with_firewall (NMDevice *self);
+
+static void
+fw_change_zone_cb_async (NMFirewallManager *firewall_manager,
+                         NMFirewallManagerCallId call_id,
+                         GError *error,
+                         gpointer user_data)
+{
+	NMDevice *self = user_data;
+	NMDevicePrivate *priv;
+
+	if (!fw_change_zone_handle (self, call_id, error))
+		return;
+
+	priv = NM_DEVICE_GET_PRIVATE (self);
+	priv->fw_ready = TRUE;
+
+	_act_stage_end (self, ACT_STAGE_FIREWALL);
+
+	/* IP configuration went ahead without waiting for firewalld. If it
+	 * already finished, the IP check was held back until now. */
+	if (priv->state == NM_DEVICE_STATE_IP_CHECK) {
+		_LOGD (LOGD_DEVICE, "Activation: firewall zone set, continuing with IP check");
+		ip_check_start_with_firewall (self);
+	}
+}
+
 static void
 fw_change_zone_cb_ip_check (NMFirewallManager *firewall_manager,
                             NMFirewallManagerCallId call_id,
@@ -7906,6 +8767,36 @@ fw_change_zone_cb_ip_check (NMFirewallManager *firewall_manager,
 		nm_device_start_ip_check (self);
 }
 
+static void
+ip_check_start_with_firewall (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	NMConnection *applied_connection;
+
+	/* Now that IP config has completed, check if the firewall
+	 * zone must be set again for the IP interface.
+	 */
+	applied_connection = nm_device_get_applied_connection (self);
+
+	if (   applied_connection
+	    && priv->ifindex != priv->ip_ifindex
+	    && !nm_device_sys_iface_state_is_external (self)) {
+		NMSettingConnection *s_con;
+		const char *zone;
+
+		s_con = nm_connection_get_setting_connection (applied_connection);
+		zone = nm_setting_connection_get_zone (s_con);
+		g_assert (!priv->fw_call);
+		priv->fw_call = nm_firewall_manager_add_or_change_zone (nm_firewall_manager_get (),
+		                                                        nm_device_get_ip_iface (self),
+		                                                        zone,
+		                                                        FALSE,
+		                                                        fw_change_zone_cb_ip_check,
+		                                                        self);
+	} else
+		nm_device_start_ip_check (self);
+}
+
 /*
  * nm_device_activate_schedule_stage3_ip_config_start
  *
@@ -7924,6 +8815,8 @@ nm_device_activate_schedule_stage3_ip_config_start (NMDevice *self)
 	priv = NM_DEVICE_GET_PRIVATE (self);
 	g_return_if_fail (priv->act_request);
 
+	_act_stage_end (self, ACT_STAGE_CONFIG);
+
 	/* Add the interface to the specified firewall zone */
 	connection = nm_device_get_applied_connection (self);
 	g_assert (connection);
@@ -7935,16 +8828,28 @@ nm_device_activate_schedule_stage3_ip_config_start (NMDevice *self)
 		else {
 			if (!priv->fw_call) {
 				zone = nm_setting_connection_get_zone (s_con);
-
-				_LOGD (LOGD_DEVICE, "Activation: setting firewall zone '%s'", zone ? zone : "default");
+				priv->fw_async = nm_config_data_get_value_boolean (NM_CONFIG_GET_DATA,
+				                                                   NM_CONFIG_KEYFILE_GROUP_MAIN,
+				                                                   NM_CONFIG_KEYFILE_KEY_MAIN_FIREWALL_ZONE_ASYNC,
+				                                                   FALSE);
+
+				_LOGD (LOGD_DEVICE, "Activation: setting firewall zone '%s'%s",
+				       zone ? zone : "default",
+				       priv->fw_async ? " (in parallel to IP configuration)" : "");
+				_act_stage_begin (self, ACT_STAGE_FIREWALL);
 				priv->fw_call = nm_firewall_manager_add_or_change_zone (nm_firewall_manager_get (),
 				                                                        nm_device_get_ip_iface (self),
 				                                                        zone,
 				                                                        FALSE,
-				                                                        fw_change_zone_cb_stage2,
+				                                                        priv->fw_async
+				                                                          ? fw_change_zone_cb_async
+				                                                          : fw_change_zone_cb_stage2,
 				                                                        self);
 			}
-			return;
+			/* in async mode, the zone change only blocks the IP check
+			 * (see ip_check_start_with_firewall()). */
+			if (!priv->fw_async)
+				return;
 		}
 	}
 
@@ -8230,6 +9135,9 @@ activate_stage5_ip4_config_commit (NMDevice *self)
 	connection = nm_act_request_get_applied_connection (req);
 	g_assert (connection);
 
+	_act_stage_end (self, ACT_STAGE_IP4_CONFIG);
+	_act_stage_begin (self, ACT_STAGE_IP4_COMMIT);
+
 	/* Interface must be IFF_UP before IP config can be applied */
 	ip_ifindex = nm_device_get_ip_ifindex (self);
 	if (!nm_platform_link_is_up (NM_PLATFORM_GET, ip_ifindex) && !nm_device_sys_iface_state_is_external_or_assume (self)) {
@@ -8379,6 +9287,9 @@ activate_stage5_ip6_config_commit (NMDevice *self)
 	connection = nm_act_request_get_applied_connection (req);
 	g_assert (connection);
 
+	_act_stage_end (self, ACT_STAGE_IP6_CONFIG);
+	_act_stage_begin (self, ACT_STAGE_IP6_COMMIT);
+
 	/* Interface must be IFF_UP before IP config can be applied */
 	ip_ifindex = nm_device_get_ip_ifindex (self);
 	if (!nm_platform_link_is_up (NM_PLATFORM_GET, ip_ifindex) && !nm_device_sys_iface_state_is_external_or_assume (self)) {
@@ -8500,6 +9411,8 @@ act_request_set (NMDevice *self, NMActRequest *act_request)
 	 * don't want that the property is public yet.  */
 	priv->act_request_public = FALSE;
 
+	memset (&priv->act_stage, 0, sizeof (priv->act_stage));
+
 	nm_clear_g_signal_handler (priv->act_request, &priv->act_request_id);
 
 	old_act_requst = priv->act_request;
@@ -8659,7 +9572,7 @@ _cleanup_ip4_pre (NMDevice *self, CleanupType cleanup_type)
 
 	_set_ip_state (self, AF_INET, IP_NONE);
 
-	if (nm_clear_g_source (&priv->queued_ip4_config_id))
+	if (queued_ip_config_unschedule (self, AF_INET))
 		_LOGD (LOGD_DEVICE, "clearing queued IP4 config change");
 	priv->queued_ip4_config_pending = FALSE;
 
@@ -8676,7 +9589,7 @@ _cleanup_ip6_pre (NMDevice *self, CleanupType cleanup_type)
 
 	_set_ip_state (self, AF_INET6, IP_NONE);
 
-	if (nm_clear_g_source (&priv->queued_ip6_config_id))
+	if (queued_ip_config_unschedule (self, AF_INET6))
 		_LOGD (LOGD_DEVICE, "clearing queued IP6 config change");
 	priv->queued_ip6_config_pending = FALSE;
 
@@ -8876,7 +9789,8 @@ can_reapply_change (NMDevice *self, const char *setting_name,
 	} else if (NM_IN_STRSET (setting_name,
 	                         NM_SETTING_IP4_CONFIG_SETTING_NAME,
 	                         NM_SETTING_IP6_CONFIG_SETTING_NAME,
-	                         NM_SETTING_PROXY_SETTING_NAME)) {
+	                         NM_SETTING_PROXY_SETTING_NAME,
+	                         NM_SETTING_ETHTOOL_SETTING_NAME)) {
 		/* accept all */
 		return TRUE;
 	} else {
@@ -8895,6 +9809,60 @@ reapply_connection (NMDevice *self, NMConnection *con_old, NMConnection *con_new
 
 }
 
+static gboolean
+reapply_key_changed (GHashTable *diffs, const char *setting_name, const char *key)
+{
+	GHashTable *setting_diff;
+
+	/* without @diffs the unmodified connection is reapplied as a whole */
+	if (!diffs)
+		return TRUE;
+
+	setting_diff = g_hash_table_lookup (diffs, setting_name);
+	if (!setting_diff)
+		return FALSE;
+	return !key || g_hash_table_contains (setting_diff, key);
+}
+
+static gboolean
+reapply_ip_needs_restart (GHashTable *diffs, const char *setting_name)
+{
+	GHashTable *setting_diff;
+	GHashTableIter iter;
+	const char *key;
+
+	if (!diffs)
+		return TRUE;
+
+	setting_diff = g_hash_table_lookup (diffs, setting_name);
+	if (!setting_diff)
+		return FALSE;
+
+	/* These only change the configuration that is merged on top of
+	 * what the IP method provides, so they can be applied without
+	 * restarting the method (and re-running DHCP). Anything else,
+	 * including the route metric passed on to the DHCP client, needs
+	 * a restart. */
+	g_hash_table_iter_init (&iter, setting_diff);
+	while (g_hash_table_iter_next (&iter, (gpointer *) &key, NULL)) {
+		if (!NM_IN_STRSET (key,
+		                   NM_SETTING_IP_CONFIG_ADDRESSES,
+		                   NM_SETTING_IP_CONFIG_GATEWAY,
+		                   NM_SETTING_IP_CONFIG_ROUTES,
+		                   NM_SETTING_IP_CONFIG_DNS,
+		                   NM_SETTING_IP_CONFIG_DNS_SEARCH,
+		                   NM_SETTING_IP_CONFIG_DNS_OPTIONS,
+		                   NM_SETTING_IP_CONFIG_DNS_PRIORITY,
+		                   NM_SETTING_IP_CONFIG_IGNORE_AUTO_ROUTES,
+		                   NM_SETTING_IP_CONFIG_IGNORE_AUTO_DNS,
+		                   NM_SETTING_IP_CONFIG_NEVER_DEFAULT,
+		                   NM_SETTING_IP_CONFIG_MAY_FAIL,
+		                   NM_SETTING_IP_CONFIG_DAD_TIMEOUT))
+			return TRUE;
+	}
+	return FALSE;
+}
+
 /* check_and_reapply_connection:
  * @connection: the new connection settings to be applied or %NULL to reapply
  *   the current settings connection
@@ -8906,6 +9874,11 @@ reapply_connection (NMDevice *self, NMConnection *con_old, NMConnection *con_new
  * Change configuration of an already configured device if possible.
  * Updates the device's applied connection upon success.
  *
+ * Only the parts of the configuration affected by the changed settings
+ * are reapplied: device-specific settings (like MTU or bond options) are
+ * set on the live link, and IP configuration is only restarted when the
+ * way it is obtained changes.
+ *
  * Return: %FALSE if the new configuration can not be reapplied.
  */
 static gboolean
@@ -8924,6 +9897,7 @@ check_and_reapply_connection (NMDevice *self,
 	NMSettingIPConfig *s_ip4_old, *s_ip4_new;
 	NMSettingIPConfig *s_ip6_old, *s_ip6_new;
 	GHashTableIter iter;
+	gboolean link_changed, ip4_changed, ip6_changed;
 
 	if (priv->state != NM_DEVICE_STATE_ACTIVATED) {
 		g_set_error_literal (error,
@@ -8939,6 +9913,8 @@ check_and_reapply_connection (NMDevice *self,
 	                    NM_SETTING_COMPARE_FLAG_IGNORE_SECRETS,
 	                    &diffs);
 
+	link_changed = !diffs;
+
 	if (diffs && nm_audit_manager_audit_enabled (nm_audit_manager_get ()))
 		*audit_args = nm_utils_format_con_diff_for_audit (diffs);
 	else
@@ -8960,6 +9936,14 @@ check_and_reapply_connection (NMDevice *self,
 			                                setting_diff,
 			                                error))
 				return FALSE;
+
+			if (!NM_IN_STRSET (setting_name,
+			                   NM_SETTING_CONNECTION_SETTING_NAME,
+			                   NM_SETTING_IP4_CONFIG_SETTING_NAME,
+			                   NM_SETTING_IP6_CONFIG_SETTING_NAME,
+			                   NM_SETTING_PROXY_SETTING_NAME,
+			                   NM_SETTING_ETHTOOL_SETTING_NAME))
+				link_changed = TRUE;
 		}
 	}
 
@@ -9025,21 +10009,45 @@ check_and_reapply_connection (NMDevice *self,
 	/**************************************************************************
 	 * Reapply changes
 	 *************************************************************************/
-	klass->reapply_connection (self, con_old, con_new);
+	if (link_changed)
+		klass->reapply_connection (self, con_old, con_new);
 
-	nm_device_update_firewall_zone (self);
-	nm_device_update_metered (self);
-	lldp_init (self, FALSE);
+	if (reapply_key_changed (diffs, NM_SETTING_CONNECTION_SETTING_NAME, NM_SETTING_CONNECTION_ZONE))
+		nm_device_update_firewall_zone (self);
+	if (reapply_key_changed (diffs, NM_SETTING_CONNECTION_SETTING_NAME, NM_SETTING_CONNECTION_METERED))
+		nm_device_update_metered (self);
+	if (reapply_key_changed (diffs, NM_SETTING_CONNECTION_SETTING_NAME, NM_SETTING_CONNECTION_LLDP))
+		lldp_init (self, FALSE);
+	if (reapply_key_changed (diffs, NM_SETTING_ETHTOOL_SETTING_NAME, NULL)) {
+		ethtool_set (self);
+		/* start from the original masks, in case some were unset */
+		cpu_masks_restore (self);
+		cpu_masks_set (self);
+	}
 
 	s_ip4_old = nm_connection_get_setting_ip4_config (con_old);
 	s_ip4_new = nm_connection_get_setting_ip4_config (con_new);
 	s_ip6_old = nm_connection_get_setting_ip6_config (con_old);
 	s_ip6_new = nm_connection_get_setting_ip6_config (con_new);
 
-	nm_device_reactivate_ip4_config (self, s_ip4_old, s_ip4_new, TRUE);
-	nm_device_reactivate_ip6_config (self, s_ip6_old, s_ip6_new, TRUE);
+	/* the MTU and other link properties are committed together with the
+	 * IP configuration, so link changes need an IP update too. */
+	ip4_changed = link_changed || reapply_key_changed (diffs, NM_SETTING_IP4_CONFIG_SETTING_NAME, NULL);
+	ip6_changed = link_changed || reapply_key_changed (diffs, NM_SETTING_IP6_CONFIG_SETTING_NAME, NULL);
+
+	if (ip4_changed) {
+		nm_device_reactivate_ip4_config (self, s_ip4_old, s_ip4_new,
+		                                 reapply_ip_needs_restart (diffs, NM_SETTING_IP4_CONFIG_SETTING_NAME));
+	}
+	if (ip6_changed) {
+		nm_device_reactivate_ip6_config (self, s_ip6_old, s_ip6_new,
+		                                 reapply_ip_needs_restart (diffs, NM_SETTING_IP6_CONFIG_SETTING_NAME));
+	}
 
-	reactivate_proxy_config (self);
+	if (   ip4_changed
+	    || ip6_changed
+	    || reapply_key_changed (diffs, NM_SETTING_PROXY_SETTING_NAME, NULL))
+		reactivate_proxy_config (self);
 
 	return TRUE;
 }
@@ -9936,6 +10944,8 @@ dispatcher_complete_proceed_state (guint call_id, gpointer user_data)
 
 	g_return_if_fail (call_id == priv->dispatcher.call_id);
 
+	_act_stage_end (self, ACT_STAGE_DISPATCHER);
+
 	priv->dispatcher.call_id = 0;
 	nm_device_queue_state (self, priv->dispatcher.post_state,
 	                       priv->dispatcher.post_state_reason);
@@ -9957,6 +10967,7 @@ ip_check_pre_up (NMDevice *self)
 
 	priv->dispatcher.post_state = NM_DEVICE_STATE_SECONDARIES;
 	priv->dispatcher.post_state_reason = NM_DEVICE_STATE_REASON_NONE;
+	_act_stage_begin (self, ACT_STAGE_DISPATCHER);
 	if (!nm_dispatcher_call_device (NM_DISPATCHER_ACTION_PRE_UP,
 	                                self,
 	                                NULL,
@@ -10474,8 +11485,7 @@ update_ip4_config (NMDevice *self, gboolean initial)
 	    && activation_source_is_scheduled (self,
 	                                       activate_stage5_ip4_config_commit,
 	                                       AF_INET)) {
-		priv->queued_ip4_config_pending = FALSE;
-		priv->queued_ip4_config_id = g_idle_add (queued_ip4_config_change, self);
+		queued_ip_config_schedule (self, AF_INET);
 		_LOGT (LOGD_DEVICE, "IP4 update was postponed");
 		return;
 	}
@@ -10490,6 +11500,16 @@ update_ip4_config (NMDevice *self, gboolean initial)
 	/* IPv4 */
 	g_clear_object (&priv->ext_ip4_config);
 	priv->ext_ip4_config = nm_ip4_config_capture (ifindex, capture_resolv_conf);
+	if (   priv->ext_ip4_config
+	    && _is_listed_only (self)
+	    && nm_ip4_config_get_num_addresses (priv->ext_ip4_config) == 0
+	    && nm_ip4_config_get_num_routes (priv->ext_ip4_config) == 0
+	    && nm_ip4_config_get_num_nameservers (priv->ext_ip4_config) == 0) {
+		/* don't keep and export an empty configuration for unmanaged devices. */
+		g_clear_object (&priv->ext_ip4_config);
+		if (priv->ip4_config)
+			nm_device_set_ip4_config (self, NULL, 0, FALSE, FALSE);
+	}
 	if (priv->ext_ip4_config) {
 		if (initial) {
 			g_clear_object (&priv->dev_ip4_config);
@@ -10565,8 +11585,7 @@ update_ip6_config (NMDevice *self, gboolean initial)
 	    && activation_source_is_scheduled (self,
 	                                       activate_stage5_ip6_config_commit,
 	                                       AF_INET6)) {
-		priv->queued_ip6_config_pending = FALSE;
-		priv->queued_ip6_config_id = g_idle_add (queued_ip6_config_change, self);
+		queued_ip_config_schedule (self, AF_INET6);
 		_LOGT (LOGD_DEVICE, "IP6 update was postponed");
 		return;
 	}
@@ -10582,6 +11601,16 @@ update_ip6_config (NMDevice *self, gboolean initial)
 	g_clear_object (&priv->ext_ip6_config);
 	g_clear_object (&priv->ext_ip6_config_captured);
 	priv->ext_ip6_config_captured = nm_ip6_config_capture (ifindex, capture_resolv_conf, NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
+	if (   priv->ext_ip6_config_captured
+	    && _is_listed_only (self)
+	    && nm_ip6_config_get_num_addresses (priv->ext_ip6_config_captured) == 0
+	    && nm_ip6_config_get_num_routes (priv->ext_ip6_config_captured) == 0
+	    && nm_ip6_config_get_num_nameservers (priv->ext_ip6_config_captured) == 0) {
+		/* don't keep and export an empty configuration for unmanaged devices. */
+		g_clear_object (&priv->ext_ip6_config_captured);
+		if (priv->ip6_config)
+			nm_device_set_ip6_config (self, NULL, FALSE, FALSE);
+	}
 	if (priv->ext_ip6_config_captured) {
 
 		priv->ext_ip6_config = nm_ip6_config_new_cloned (priv->ext_ip6_config_captured);
@@ -10624,6 +11653,10 @@ update_ip6_config (NMDevice *self, gboolean initial)
 		 */
 		linklocal6_complete (self);
 	}
+
+	/* the captured configuration is only needed during activation. */
+	if (_is_listed_only (self))
+		g_clear_object (&priv->ext_ip6_config_captured);
 }
 
 void
@@ -10633,49 +11666,27 @@ nm_device_capture_initial_config (NMDevice *self)
 	update_ip6_config (self, TRUE);
 }
 
-static gboolean
-queued_ip4_config_change (gpointer user_data)
+static void
+queued_ip4_config_change (NMDevice *self)
 {
-	NMDevice *self = user_data;
-	NMDevicePrivate *priv;
-
-	g_return_val_if_fail (NM_IS_DEVICE (self), G_SOURCE_REMOVE);
-
-	priv = NM_DEVICE_GET_PRIVATE (self);
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
 
 	nm_assert (!priv->queued_ip4_config_pending);
 
-	/* Wait for any queued state changes */
-	if (priv->queued_state.id)
-		return TRUE;
-
-	priv->queued_ip4_config_id = 0;
 	update_ip4_config (self, FALSE);
 
 	set_unmanaged_external_down (self, TRUE);
-
-	return FALSE;
 }
 
-static gboolean
-queued_ip6_config_change (gpointer user_data)
+static void
+queued_ip6_config_change (NMDevice *self)
 {
-	NMDevice *self = user_data;
-	NMDevicePrivate *priv;
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
 	GSList *iter;
 	gboolean need_ipv6ll = FALSE;
 
-	g_return_val_if_fail (NM_IS_DEVICE (self), G_SOURCE_REMOVE);
-
-	priv = NM_DEVICE_GET_PRIVATE (self);
-
-	nm_assert (!priv->queued_ip4_config_pending);
-
-	/* Wait for any queued state changes */
-	if (priv->queued_state.id)
-		return TRUE;
+	nm_assert (!priv->queued_ip6_config_pending);
 
-	priv->queued_ip6_config_id = 0;
 	update_ip6_config (self, FALSE);
 
 	if (priv->state < NM_DEVICE_STATE_DEACTIVATING
@@ -10725,47 +11736,141 @@ queued_ip6_config_change (gpointer user_data)
 	}
 
 	set_unmanaged_external_down (self, TRUE);
+}
 
-	return FALSE;
+/* Platform changes often touch many interfaces at once, for example when
+ * routes are flushed. Instead of an idle source per device and address
+ * family, the devices with pending changes are collected in one queue and
+ * updated in a single pass. The captured configurations are cached per
+ * ifindex by nm_ip4_config_capture() and nm_ip6_config_capture(), so that
+ * the platform cache is only read once for each interface that changed. */
+static struct {
+	GPtrArray *devices;
+	guint idle_id;
+} ip_config_queue;
+
+static gboolean
+queued_ip_config_change_cb (gpointer user_data)
+{
+	gs_unref_ptrarray GPtrArray *devices = NULL;
+	guint i;
+
+	devices = g_steal_pointer (&ip_config_queue.devices);
+	ip_config_queue.idle_id = 0;
+
+	for (i = 0; devices && i < devices->len; i++) {
+		NMDevice *self = devices->pdata[i];
+		NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+		gboolean ip4, ip6;
+
+		/* the device was unscheduled by an earlier device of this pass. */
+		if (   !priv->queued_ip4_config_scheduled
+		    && !priv->queued_ip6_config_scheduled)
+			continue;
+
+		/* Wait for any queued state changes */
+		if (priv->queued_state.id) {
+			if (!ip_config_queue.devices)
+				ip_config_queue.devices = g_ptr_array_new_with_free_func (g_object_unref);
+			g_ptr_array_add (ip_config_queue.devices, g_object_ref (self));
+			continue;
+		}
+
+		ip4 = priv->queued_ip4_config_scheduled;
+		ip6 = priv->queued_ip6_config_scheduled;
+		priv->queued_ip4_config_scheduled = FALSE;
+		priv->queued_ip6_config_scheduled = FALSE;
+
+		if (ip4)
+			queued_ip4_config_change (self);
+		if (ip6)
+			queued_ip6_config_change (self);
+	}
+
+	if (   ip_config_queue.devices
+	    && !ip_config_queue.idle_id)
+		ip_config_queue.idle_id = g_idle_add (queued_ip_config_change_cb, NULL);
+
+	return G_SOURCE_REMOVE;
 }
 
 static void
-device_ipx_changed (NMPlatform *platform,
-                    int obj_type_i,
-                    int ifindex,
-                    gpointer platform_object,
-                    int change_type_i,
-                    NMDevice *self)
+queued_ip_config_schedule (NMDevice *self, int addr_family)
 {
-	const NMPObjectType obj_type = obj_type_i;
-	const NMPlatformSignalChangeType change_type = change_type_i;
-	NMDevicePrivate *priv;
-	NMPlatformIP6Address *addr;
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	gboolean queued;
 
-	if (nm_device_get_ip_ifindex (self) != ifindex)
+	queued =    priv->queued_ip4_config_scheduled
+	         || priv->queued_ip6_config_scheduled;
+
+	if (addr_family == AF_INET) {
+		priv->queued_ip4_config_pending = FALSE;
+		priv->queued_ip4_config_scheduled = TRUE;
+	} else {
+		priv->queued_ip6_config_pending = FALSE;
+		priv->queued_ip6_config_scheduled = TRUE;
+	}
+
+	if (queued)
 		return;
 
-	priv = NM_DEVICE_GET_PRIVATE (self);
+	/* the queue keeps a reference, so that the device stays alive until
+	 * the pass that updates it. */
+	if (!ip_config_queue.devices)
+		ip_config_queue.devices = g_ptr_array_new_with_free_func (g_object_unref);
+	g_ptr_array_add (ip_config_queue.devices, g_object_ref (self));
+
+	if (!ip_config_queue.idle_id)
+		ip_config_queue.idle_id = g_idle_add (queued_ip_config_change_cb, NULL);
+}
+
+static gboolean
+queued_ip_config_unschedule (NMDevice *self, int addr_family)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+
+	if (addr_family == AF_INET) {
+		if (!priv->queued_ip4_config_scheduled)
+			return FALSE;
+		priv->queued_ip4_config_scheduled = FALSE;
+	} else {
+		if (!priv->queued_ip6_config_scheduled)
+			return FALSE;
+		priv->queued_ip6_config_scheduled = FALSE;
+	}
+
+	if (   !priv->queued_ip4_config_scheduled
+	    && !priv->queued_ip6_config_scheduled
+	    && ip_config_queue.devices)
+		g_ptr_array_remove (ip_config_queue.devices, self);
+
+	return TRUE;
+}
 
-	switch (obj_type) {
+static void
+device_ipx_changed_one (NMDevice *self, const NMPlatformChange *change)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	const NMPlatformIP6Address *addr;
+
+	switch (change->obj_type) {
 	case NMP_OBJECT_TYPE_IP4_ADDRESS:
 	case NMP_OBJECT_TYPE_IP4_ROUTE:
 		if (nm_device_get_unmanaged_flags (self, NM_UNMANAGED_PLATFORM_INIT)) {
 			priv->queued_ip4_config_pending = TRUE;
-			nm_assert_se (!nm_clear_g_source (&priv->queued_ip4_config_id));
-		} else if (!priv->queued_ip4_config_id) {
-			priv->queued_ip4_config_pending = FALSE;
-			priv->queued_ip4_config_id = g_idle_add (queued_ip4_config_change, self);
+			nm_assert_se (!queued_ip_config_unschedule (self, AF_INET));
+		} else if (!priv->queued_ip4_config_scheduled) {
+			queued_ip_config_schedule (self, AF_INET);
 			_LOGD (LOGD_DEVICE, "queued IP4 config change");
 		}
 		break;
 	case NMP_OBJECT_TYPE_IP6_ADDRESS:
-		addr = platform_object;
+		addr = &change->ip6_address;
 
 		if (   priv->state > NM_DEVICE_STATE_DISCONNECTED
 		    && priv->state < NM_DEVICE_STATE_DEACTIVATING
-		    && (   (change_type == NM_PLATFORM_SIGNAL_CHANGED && addr->n_ifa_flags & IFA_F_DADFAILED)
-		        || (change_type == NM_PLATFORM_SIGNAL_REMOVED && addr->n_ifa_flags & IFA_F_TENTATIVE))) {
+		    && (   (change->change_type == NM_PLATFORM_SIGNAL_CHANGED && addr->n_ifa_flags & IFA_F_DADFAILED)
+		        || (change->change_type == NM_PLATFORM_SIGNAL_REMOVED && addr->n_ifa_flags & IFA_F_TENTATIVE))) {
 			priv->dad6_failed_addrs = g_slist_append (priv->dad6_failed_addrs,
 			                                          g_memdup (addr, sizeof (NMPlatformIP6Address)));
 		}
@@ -10773,15 +11878,38 @@ device_ipx_changed (NMPlatform *platform,
 	case NMP_OBJECT_TYPE_IP6_ROUTE:
 		if (nm_device_get_unmanaged_flags (self, NM_UNMANAGED_PLATFORM_INIT)) {
 			priv->queued_ip6_config_pending = TRUE;
-			nm_assert_se (!nm_clear_g_source (&priv->queued_ip6_config_id));
-		} else if (!priv->queued_ip6_config_id) {
-			priv->queued_ip6_config_pending = FALSE;
-			priv->queued_ip6_config_id = g_idle_add (queued_ip6_config_change, self);
+			nm_assert_se (!queued_ip_config_unschedule (self, AF_INET6));
+		} else if (!priv->queued_ip6_config_scheduled) {
+			queued_ip_config_schedule (self, AF_INET6);
 			_LOGD (LOGD_DEVICE, "queued IP6 config change");
 		}
 		break;
 	default:
-		g_return_if_reached ();
+		break;
+	}
+}
+
+static void
+device_ipx_changed (NMPlatform *platform,
+                    const NMPlatformChanges *changes,
+                    NMDevice *self)
+{
+	int ifindex;
+	guint i;
+
+	if (!(  NM_PLATFORM_CHANGES_HAS_TYPE (changes, NMP_OBJECT_TYPE_IP4_ADDRESS)
+	      | NM_PLATFORM_CHANGES_HAS_TYPE (changes, NMP_OBJECT_TYPE_IP6_ADDRESS)
+	      | NM_PLATFORM_CHANGES_HAS_TYPE (changes, NMP_OBJECT_TYPE_IP4_ROUTE)
+	      | NM_PLATFORM_CHANGES_HAS_TYPE (changes, NMP_OBJECT_TYPE_IP6_ROUTE)))
+		return;
+
+	ifindex = nm_device_get_ip_ifindex (self);
+	if (ifindex <= 0)
+		return;
+
+	for (i = 0; i < changes->len; i++) {
+		if (changes->changes[i].ifindex == ifindex)
+			device_ipx_changed_one (self, &changes->changes[i]);
 	}
 }
 
@@ -11026,23 +12154,21 @@ _set_unmanaged_flags (NMDevice *self,
 		if (!NM_FLAGS_HAS (flags, NM_UNMANAGED_USER_SETTINGS)) {
 			gboolean unmanaged;
 
-			unmanaged = nm_device_spec_match_list (self,
-			                                       nm_settings_get_unmanaged_specs (NM_DEVICE_GET_PRIVATE (self)->settings));
+			unmanaged = nm_device_spec_match_compiled (self,
+			                                           nm_settings_get_unmanaged_specs_compiled (NM_DEVICE_GET_PRIVATE (self)->settings));
 			nm_device_set_unmanaged_flags (self,
 			                               NM_UNMANAGED_USER_SETTINGS,
 			                               !!unmanaged);
 		}
 
 		if (priv->queued_ip4_config_pending) {
-			priv->queued_ip4_config_pending = FALSE;
-			nm_assert_se (!nm_clear_g_source (&priv->queued_ip4_config_id));
-			priv->queued_ip4_config_id = g_idle_add (queued_ip4_config_change, self);
+			nm_assert_se (!queued_ip_config_unschedule (self, AF_INET));
+			queued_ip_config_schedule (self, AF_INET);
 		}
 
 		if (priv->queued_ip6_config_pending) {
-			priv->queued_ip6_config_pending = FALSE;
-			nm_assert_se (!nm_clear_g_source (&priv->queued_ip6_config_id));
-			priv->queued_ip6_config_id = g_idle_add (queued_ip6_config_change, self);
+			nm_assert_se (!queued_ip_config_unschedule (self, AF_INET6));
+			queued_ip_config_schedule (self, AF_INET6);
 		}
 
 		if (!priv->pending_actions) {
@@ -11183,8 +12309,8 @@ nm_device_set_unmanaged_by_user_settings (NMDevice *self)
 		return;
 	}
 
-	unmanaged = nm_device_spec_match_list (self,
-	                                       nm_settings_get_unmanaged_specs (NM_DEVICE_GET_PRIVATE (self)->settings));
+	unmanaged = nm_device_spec_match_compiled (self,
+	                                           nm_settings_get_unmanaged_specs_compiled (NM_DEVICE_GET_PRIVATE (self)->settings));
 
 	nm_device_set_unmanaged_by_flags (self,
 	                                  NM_UNMANAGED_USER_SETTINGS,
@@ -11478,22 +12604,25 @@ nm_device_check_connection_available (NMDevice *self,
 static gboolean
 available_connections_del_all (NMDevice *self)
 {
-	if (g_hash_table_size (self->_priv->available_connections) == 0)
+	if (_available_connections_size (self) == 0)
 		return FALSE;
-	g_hash_table_remove_all (self->_priv->available_connections);
+	g_clear_pointer (&self->_priv->available_connections, g_hash_table_unref);
 	return TRUE;
 }
 
 static gboolean
 available_connections_add (NMDevice *self, NMConnection *connection)
 {
+	if (!self->_priv->available_connections)
+		self->_priv->available_connections = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, NULL);
 	return nm_g_hash_table_add (self->_priv->available_connections, g_object_ref (connection));
 }
 
 static gboolean
 available_connections_del (NMDevice *self, NMConnection *connection)
 {
-	return g_hash_table_remove (self->_priv->available_connections, connection);
+	return    self->_priv->available_connections
+	       && g_hash_table_remove (self->_priv->available_connections, connection);
 }
 
 static gboolean
@@ -11538,7 +12667,7 @@ nm_device_recheck_available_connections (NMDevice *self)
 
 	priv = NM_DEVICE_GET_PRIVATE(self);
 
-	if (g_hash_table_size (priv->available_connections) > 0) {
+	if (_available_connections_size (self) > 0) {
 		prune_list = g_hash_table_new (g_direct_hash, g_direct_equal);
 		g_hash_table_iter_init (&h_iter, priv->available_connections);
 		while (g_hash_table_iter_next (&h_iter, (gpointer *) &connection, NULL))
@@ -11595,24 +12724,26 @@ nm_device_get_best_connection (NMDevice *self,
 	guint64 best_timestamp = 0;
 	GHashTableIter iter;
 
-	g_hash_table_iter_init (&iter, priv->available_connections);
-	while (g_hash_table_iter_next (&iter, (gpointer) &candidate, NULL)) {
-		guint64 candidate_timestamp = 0;
+	if (priv->available_connections) {
+		g_hash_table_iter_init (&iter, priv->available_connections);
+		while (g_hash_table_iter_next (&iter, (gpointer) &candidate, NULL)) {
+			guint64 candidate_timestamp = 0;
 
-		/* If a specific object is given, only include connections that are
-		 * compatible with it.
-		 */
-		if (    specific_object /* << Optimization: we know that the connection is available without @specific_object.  */
-		    && !nm_device_check_connection_available (self,
-		                                              NM_CONNECTION (candidate),
-		                                              _NM_DEVICE_CHECK_CON_AVAILABLE_FOR_USER_REQUEST,
-		                                              specific_object))
-			continue;
+			/* If a specific object is given, only include connections that are
+			 * compatible with it.
+			 */
+			if (    specific_object /* << Optimization: we know that the connection is available without @specific_object.  */
+			    && !nm_device_check_connection_available (self,
+			                                              NM_CONNECTION (candidate),
+			                                              _NM_DEVICE_CHECK_CON_AVAILABLE_FOR_USER_REQUEST,
+			                                              specific_object))
+				continue;
 
-		nm_settings_connection_get_timestamp (candidate, &candidate_timestamp);
-		if (!connection || (candidate_timestamp > best_timestamp)) {
-			connection = candidate;
-			best_timestamp = candidate_timestamp;
+			nm_settings_connection_get_timestamp (candidate, &candidate_timestamp);
+			if (!connection || (candidate_timestamp > best_timestamp)) {
+				connection = candidate;
+				best_timestamp = candidate_timestamp;
+			}
 		}
 	}
 
@@ -11807,6 +12938,7 @@ _cancel_activation (NMDevice *self)
 		priv->fw_call = NULL;
 	}
 	priv->fw_ready = FALSE;
+	priv->fw_async = FALSE;
 
 	ip_check_gw_ping_cleanup (self);
 
@@ -11969,6 +13101,13 @@ nm_device_cleanup (NMDevice *self, NMDeviceStateReason reason, CleanupType clean
 	if (priv->lldp_listener)
 		nm_lldp_listener_stop (priv->lldp_listener);
 
+	if (cleanup_type == CLEANUP_TYPE_DECONFIGURE)
+		cpu_masks_restore (self);
+	else {
+		g_clear_pointer (&priv->queue_cpus_saved, g_hash_table_unref);
+		g_clear_pointer (&priv->irq_affinity_saved, g_hash_table_unref);
+	}
+
 	nm_device_update_metered (self);
 
 	/* during device cleanup, we want to reset the MAC address of the device
@@ -12033,32 +13172,43 @@ find_dhcp4_address (NMDevice *self)
 	return NULL;
 }
 
-void
-nm_device_spawn_iface_helper (NMDevice *self)
+/**
+ * nm_device_get_iface_helper_args:
+ * @self: the device
+ * @argv: the command line of nm-iface-helper to extend
+ *
+ * Appends the options with which nm-iface-helper takes over the IP
+ * configuration of @self after NetworkManager quits. One nm-iface-helper
+ * process can manage several interfaces, the options of each start
+ * with "--ifname".
+ *
+ * Returns: %TRUE if @self needs nm-iface-helper. Otherwise, @argv
+ *   is left unchanged.
+ */
+gboolean
+nm_device_get_iface_helper_args (NMDevice *self, GPtrArray *argv)
 {
 	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
 	gboolean configured = FALSE;
 	NMConnection *connection;
-	GError *error = NULL;
 	const char *method;
-	GPtrArray *argv;
 	gs_free char *dhcp4_address = NULL;
-	char *logging_backend;
 	NMUtilsStableType stable_type;
 	const char *stable_id;
+	guint argv_len;
+
+	g_return_val_if_fail (argv, FALSE);
 
 	if (priv->state != NM_DEVICE_STATE_ACTIVATED)
-		return;
+		return FALSE;
 	if (!nm_device_can_assume_connections (self))
-		return;
+		return FALSE;
 
 	connection = nm_device_get_applied_connection (self);
 	g_assert (connection);
 
-	argv = g_ptr_array_sized_new (10);
-	g_ptr_array_set_free_func (argv, g_free);
+	argv_len = argv->len;
 
-	g_ptr_array_add (argv, g_strdup (LIBEXECDIR "/nm-iface-helper"));
 	g_ptr_array_add (argv, g_strdup ("--ifname"));
 	g_ptr_array_add (argv, g_strdup (nm_device_get_ip_iface (self)));
 	g_ptr_array_add (argv, g_strdup ("--uuid"));
@@ -12070,23 +13220,6 @@ nm_device_spawn_iface_helper (NMDevice *self)
 		g_ptr_array_add (argv, g_strdup_printf ("%d %s", (int) stable_type, stable_id));
 	}
 
-	logging_backend = nm_config_get_is_debug (nm_config_get ())
-	                  ? g_strdup ("debug")
-	                  : nm_config_data_get_value (NM_CONFIG_GET_DATA_ORIG,
-	                                              NM_CONFIG_KEYFILE_GROUP_LOGGING,
-	                                              NM_CONFIG_KEYFILE_KEY_LOGGING_BACKEND,
-	                                              NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY);
-	if (logging_backend) {
-		g_ptr_array_add (argv, g_strdup ("--logging-backend"));
-		g_ptr_array_add (argv, logging_backend);
-	}
-
-	g_ptr_array_add (argv, g_strdup ("--log-level"));
-	g_ptr_array_add (argv, g_strdup (nm_logging_level_to_string ()));
-
-	g_ptr_array_add (argv, g_strdup ("--log-domains"));
-	g_ptr_array_add (argv, g_strdup (nm_logging_domains_to_string ()));
-
 	dhcp4_address = find_dhcp4_address (self);
 
 	method = nm_utils_get_ip_config_method (connection, NM_TYPE_SETTING_IP4_CONFIG);
@@ -12166,29 +13299,13 @@ nm_device_spawn_iface_helper (NMDevice *self)
 		configured = TRUE;
 	}
 
-	if (configured) {
-		GPid pid;
-
-		g_ptr_array_add (argv, NULL);
-
-		if (nm_logging_enabled (LOGL_DEBUG, LOGD_DEVICE)) {
-			char *tmp;
-
-			tmp = g_strjoinv (" ", (char **) argv->pdata);
-			_LOGD (LOGD_DEVICE, "running '%s'", tmp);
-			g_free (tmp);
-		}
-
-		if (g_spawn_async (NULL, (char **) argv->pdata, NULL,
-		                   G_SPAWN_DO_NOT_REAP_CHILD, NULL, NULL, &pid, &error)) {
-			_LOGI (LOGD_DEVICE, "spawned helper PID %u", (guint) pid);
-		} else {
-			_LOGW (LOGD_DEVICE, "failed to spawn helper: %s", error->message);
-			g_error_free (error);
-		}
+	if (!configured) {
+		g_ptr_array_set_size (argv, argv_len);
+		return FALSE;
 	}
 
-	g_ptr_array_unref (argv);
+	_LOGD (LOGD_DEVICE, "hand over to nm-iface-helper");
+	return TRUE;
 }
 
 /*****************************************************************************/
@@ -12292,7 +13409,6 @@ _set_state_full (NMDevice *self,
 	NMActRequest *req;
 	gboolean no_firmware = FALSE;
 	NMSettingsConnection *connection;
-	NMConnection *applied_connection;
 
 	g_return_if_fail (NM_IS_DEVICE (self));
 
@@ -12329,6 +13445,8 @@ _set_state_full (NMDevice *self,
 	       state,
 	       reason);
 
+	NM_TRACE4 (device__state, priv->iface, (int) old_state, (int) state, (int) reason);
+
 	priv->in_state_changed = TRUE;
 
 	priv->state = state;
@@ -12520,6 +13638,7 @@ _set_state_full (NMDevice *self,
 		break;
 	case NM_DEVICE_STATE_ACTIVATED:
 		_LOGI (LOGD_DEVICE, "Activation: successful, device activated.");
+		_act_stage_end (self, ACT_STAGE_TOTAL);
 		nm_device_update_metered (self);
 		nm_dispatcher_call_device (NM_DISPATCHER_ACTION_UP,
 		                           self,
@@ -12574,28 +13693,14 @@ _set_state_full (NMDevice *self,
 		nm_device_queue_state (self, NM_DEVICE_STATE_DISCONNECTED, NM_DEVICE_STATE_REASON_NONE);
 		break;
 	case NM_DEVICE_STATE_IP_CHECK:
-		/* Now that IP config has completed, check if the firewall
-		 * zone must be set again for the IP interface.
-		 */
-		applied_connection = nm_device_get_applied_connection (self);
-
-		if (   applied_connection
-		    && priv->ifindex != priv->ip_ifindex
-		    && !nm_device_sys_iface_state_is_external (self)) {
-			NMSettingConnection *s_con;
-			const char *zone;
-
-			s_con = nm_connection_get_setting_connection (applied_connection);
-			zone = nm_setting_connection_get_zone (s_con);
-			g_assert (!priv->fw_call);
-			priv->fw_call = nm_firewall_manager_add_or_change_zone (nm_firewall_manager_get (),
-			                                                        nm_device_get_ip_iface (self),
-			                                                        zone,
-			                                                        FALSE,
-			                                                        fw_change_zone_cb_ip_check,
-			                                                        self);
+		if (priv->fw_call) {
+			/* the firewall zone is still being set in parallel to IP
+			 * configuration. The device must not become activated
+			 * before that is done; fw_change_zone_cb_async() continues. */
+			nm_assert (priv->fw_async);
+			_LOGD (LOGD_DEVICE, "Activation: waiting for firewall zone before IP check");
 		} else
-			nm_device_start_ip_check (self);
+			ip_check_start_with_firewall (self);
 
 		/* IP-related properties are only valid when the device has IP configuration;
 		 * now that it does, ensure their change notifications are emitted.
@@ -13464,6 +14569,39 @@ nm_device_spec_match_list (NMDevice *self, const GSList *specs)
 	return m == NM_MATCH_SPEC_MATCH;
 }
 
+/**
+ * nm_device_spec_match_compiled:
+ * @self: an #NMDevice
+ * @compiled: (allow-none): specs from nm_match_spec_compile()
+ *
+ * Like nm_device_spec_match_list(), but for specs that were parsed
+ * before.
+ *
+ * Returns: #TRUE if @self matches @compiled
+ */
+gboolean
+nm_device_spec_match_compiled (NMDevice *self, const NMMatchSpecCompiled *compiled)
+{
+	NMDeviceClass *klass;
+	NMMatchSpecMatchType m;
+
+	g_return_val_if_fail (NM_IS_DEVICE (self), FALSE);
+
+	if (!compiled)
+		return FALSE;
+
+	klass = NM_DEVICE_GET_CLASS (self);
+
+	m = nm_match_spec_compiled_match_device (compiled,
+	                                         nm_device_get_iface (self),
+	                                         nm_device_get_type_description (self),
+	                                         nm_device_get_driver (self),
+	                                         nm_device_get_driver_version (self),
+	                                         nm_device_get_permanent_hw_address (self),
+	                                         klass->get_s390_subchannels ? klass->get_s390_subchannels (self) : NULL);
+	return m == NM_MATCH_SPEC_MATCH;
+}
+
 guint
 nm_device_get_supplicant_timeout (NMDevice *self)
 {
@@ -13530,8 +14668,6 @@ nm_device_init (NMDevice *self)
 	priv->rfkill_type = RFKILL_TYPE_UNKNOWN;
 	priv->unmanaged_flags = NM_UNMANAGED_PLATFORM_INIT;
 	priv->unmanaged_mask = priv->unmanaged_flags;
-	priv->available_connections = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, NULL);
-	priv->ip6_saved_properties = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
 	priv->sys_iface_state = NM_DEVICE_SYS_IFACE_STATE_EXTERNAL;
 
 	priv->pacrunner_manager = g_object_ref (nm_pacrunner_manager_get ());
@@ -13601,10 +14737,7 @@ constructed (GObject *object)
 
 	/* Watch for external IP config changes */
 	platform = NM_PLATFORM_GET;
-	g_signal_connect (platform, NM_PLATFORM_SIGNAL_IP4_ADDRESS_CHANGED, G_CALLBACK (device_ipx_changed), self);
-	g_signal_connect (platform, NM_PLATFORM_SIGNAL_IP6_ADDRESS_CHANGED, G_CALLBACK (device_ipx_changed), self);
-	g_signal_connect (platform, NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED, G_CALLBACK (device_ipx_changed), self);
-	g_signal_connect (platform, NM_PLATFORM_SIGNAL_IP6_ROUTE_CHANGED, G_CALLBACK (device_ipx_changed), self);
+	g_signal_connect (platform, NM_PLATFORM_SIGNAL_CHANGES, G_CALLBACK (device_ipx_changed), self);
 	g_signal_connect (platform, NM_PLATFORM_SIGNAL_LINK_CHANGED, G_CALLBACK (link_changed_cb), self);
 
 	g_signal_connect (nm_route_manager_get (), NM_ROUTE_MANAGER_IP4_ROUTES_CHANGED,
@@ -13672,16 +14805,20 @@ dispose (GObject *object)
 
 	_cleanup_generic_post (self, CLEANUP_TYPE_KEEP);
 
-	g_hash_table_remove_all (priv->ip6_saved_properties);
+	g_clear_pointer (&priv->ip6_saved_properties, g_hash_table_unref);
+	g_clear_pointer (&priv->queue_cpus_saved, g_hash_table_unref);
+	g_clear_pointer (&priv->irq_affinity_saved, g_hash_table_unref);
 
 	nm_clear_g_source (&priv->recheck_assume_id);
 	nm_clear_g_source (&priv->recheck_available.call_id);
+	nm_clear_g_source (&priv->enslave_queue_id);
 
 	nm_clear_g_source (&priv->check_delete_unrealized_id);
 
-	nm_clear_g_source (&priv->stats.timeout_id);
+	_stats_group_leave (self);
 
 	link_disconnect_action_cancel (self);
+	nm_clear_g_source (&priv->carrier_damp.reuse_id);
 
 	if (priv->ifindex > 0) {
 		priv->ifindex = 0;
@@ -13746,8 +14883,8 @@ finalize (GObject *object)
 	g_free (priv->dhcp_anycast_address);
 	g_free (priv->current_stable_id);
 
-	g_hash_table_unref (priv->ip6_saved_properties);
-	g_hash_table_unref (priv->available_connections);
+	g_clear_pointer (&priv->ip6_saved_properties, g_hash_table_unref);
+	g_clear_pointer (&priv->available_connections, g_hash_table_unref);
 
 	G_OBJECT_CLASS (nm_device_parent_class)->finalize (object);
 
@@ -13949,10 +15086,12 @@ get_property (GObject *object, guint prop_id,
 		g_value_set_uint (value, priv->rfkill_type);
 		break;
 	case PROP_AVAILABLE_CONNECTIONS:
-		array = g_ptr_array_sized_new (g_hash_table_size (priv->available_connections));
-		g_hash_table_iter_init (&iter, priv->available_connections);
-		while (g_hash_table_iter_next (&iter, (gpointer) &connection, NULL))
-			g_ptr_array_add (array, g_strdup (nm_connection_get_path (connection)));
+		array = g_ptr_array_sized_new (_available_connections_size (self) + 1);
+		if (priv->available_connections) {
+			g_hash_table_iter_init (&iter, priv->available_connections);
+			while (g_hash_table_iter_next (&iter, (gpointer) &connection, NULL))
+				g_ptr_array_add (array, g_strdup (nm_connection_get_path (connection)));
+		}
 		g_ptr_array_add (array, NULL);
 		g_value_take_boxed (value, (char **) g_ptr_array_free (array, FALSE));
 		break;
@@ -13997,6 +15136,9 @@ get_property (GObject *object, guint prop_id,
 	case PROP_REAL:
 		g_value_set_boolean (value, nm_device_is_real (self));
 		break;
+	case PROP_CARRIER_SUPPRESSED:
+		g_value_set_boolean (value, priv->carrier_damp.suppressed);
+		break;
 	case PROP_SLAVES: {
 		GSList *slave_iter;
 		char **slave_list;
@@ -14119,6 +15261,11 @@ nm_device_class_init (NMDeviceClass *klass)
 	                          FALSE,
 	                          G_PARAM_READABLE |
 	                          G_PARAM_STATIC_STRINGS);
+	obj_properties[PROP_CARRIER_SUPPRESSED] =
+	    g_param_spec_boolean (NM_DEVICE_CARRIER_SUPPRESSED, "", "",
+	                          FALSE,
+	                          G_PARAM_READABLE |
+	                          G_PARAM_STATIC_STRINGS);
 	obj_properties[PROP_MTU] =
 	    g_param_spec_uint (NM_DEVICE_MTU, "", "",
 	                       0, G_MAXUINT32, 1500,
@@ -14393,4 +15540,8 @@ nm_device_class_init (NMDeviceClass *klass)
 	nm_exported_object_class_add_interface (NM_EXPORTED_OBJECT_CLASS (klass),
 	                                        NMDBUS_TYPE_DEVICE_STATISTICS_SKELETON,
 	                                        NULL);
+	nm_exported_object_class_rate_limit_properties (NM_EXPORTED_OBJECT_CLASS (klass),
+	                                                "TxBytes",
+	                                                "RxBytes",
+	                                                NULL);
 }
@@ -102,6 +102,7 @@ nm_device_state_reason_check (NMDeviceStateReason reason)
 #define NM_DEVICE_METERED          "metered"
 #define NM_DEVICE_LLDP_NEIGHBORS  "lldp-neighbors"
 #define NM_DEVICE_REAL             "real"
+#define NM_DEVICE_CARRIER_SUPPRESSED "carrier-suppressed"
 
 /* "parent" is exposed on D-Bus by subclasses like NMDeviceIPTunnel */
 #define NM_DEVICE_PARENT           "parent"
@@ -354,6 +355,16 @@ typedef struct {
 	                                   NMConnection *connection,
 	                                   gboolean configure);
 
+	/* Optional. Like enslave_slave(), but for several slaves at once.
+	 * If implemented, slaves becoming ready together are enslaved
+	 * together. */
+	void            (* enslave_slaves) (NMDevice *self,
+	                                    NMDevice *const *slaves,
+	                                    NMConnection *const *connections,
+	                                    const gboolean *configure,
+	                                    guint n_slaves,
+	                                    gboolean *out_success);
+
 	void            (* release_slave) (NMDevice *self,
 	                                   NMDevice *slave,
 	                                   gboolean configure);
@@ -501,6 +512,7 @@ gboolean nm_device_check_slave_connection_compatible (NMDevice *device, NMConnec
 gboolean nm_device_unmanage_on_quit (NMDevice *self);
 
 gboolean nm_device_spec_match_list (NMDevice *device, const GSList *specs);
+gboolean nm_device_spec_match_compiled (NMDevice *device, const NMMatchSpecCompiled *compiled);
 
 gboolean nm_device_is_activating (NMDevice *dev);
 gboolean nm_device_autoconnect_allowed (NMDevice *self);
@@ -664,7 +676,7 @@ NMConnection *nm_device_new_default_connection (NMDevice *self);
 const NMPlatformIP4Route *nm_device_get_ip4_default_route (NMDevice *self, gboolean *out_is_assumed);
 const NMPlatformIP6Route *nm_device_get_ip6_default_route (NMDevice *self, gboolean *out_is_assumed);
 
-void nm_device_spawn_iface_helper (NMDevice *self);
+gboolean nm_device_get_iface_helper_args (NMDevice *self, GPtrArray *argv);
 
 void nm_device_reapply_settings_immediately (NMDevice *self);
 
@@ -699,4 +711,6 @@ void nm_device_check_connectivity (NMDevice *self,
                                    gpointer user_data);
 NMConnectivityState nm_device_get_connectivity_state (NMDevice *self);
 
+GVariant *nm_device_activation_statistics_to_variant (void);
+
 #endif /* __NETWORKMANAGER_DEVICE_H__ */
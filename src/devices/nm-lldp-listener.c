@@ -30,7 +30,9 @@
 
 #include "systemd/nm-sd.h"
 
-#define MAX_NEIGHBORS         4096
+/* per interface. When the table is full, the neighbor that was heard
+ * from least recently is dropped to make room for a new one. */
+#define MAX_NEIGHBORS         128
 #define MIN_UPDATE_INTERVAL_NS (2 * NM_UTILS_NS_PER_SECOND)
 
 #define LLDP_MAC_NEAREST_BRIDGE          ((const struct ether_addr *) ((uint8_t[ETH_ALEN]) { 0x01, 0x80, 0xc2, 0x00, 0x00, 0x0e }))
@@ -78,6 +80,10 @@ typedef struct {
 	sd_lldp      *lldp_handle;
 	GHashTable   *lldp_neighbors;
 
+	/* the neighbors ordered by the last time we received a frame
+	 * from them, least recent first. */
+	GQueue        lldp_neighbors_lru;
+
 	/* the timestamp in nsec until which we delay updates. */
 	gint64        ratelimit_next;
 	guint         ratelimit_id;
@@ -113,6 +119,8 @@ typedef struct {
 	LldpAttrData attrs[_LLDP_PROP_ID_COUNT];
 
 	GVariant *variant;
+
+	GList lru_link;
 } LldpNeighbor;
 
 /*****************************************************************************/
@@ -338,7 +346,7 @@ lldp_neighbor_equal (LldpNeighbor *a, LldpNeighbor *b)
 
 	if (   a->chassis_id_type != b->chassis_id_type
 	    || a->port_id_type != b->port_id_type
-	    || ether_addr_equal (&a->destination_address, &b->destination_address)
+	    || !ether_addr_equal (&a->destination_address, &b->destination_address)
 	    || !nm_streq0 (a->chassis_id, b->chassis_id)
 	    || !nm_streq0 (a->port_id, b->port_id))
 		return FALSE;
@@ -403,6 +411,7 @@ lldp_neighbor_new (sd_lldp_neighbor *neighbor_sd, GError **error)
 	}
 
 	neigh = g_slice_new0 (LldpNeighbor);
+	neigh->lru_link.data = neigh;
 	neigh->chassis_id_type = chassis_id_type;
 	neigh->port_id_type = port_id_type;
 
@@ -651,6 +660,24 @@ data_changed_schedule (NMLldpListener *self)
 		priv->ratelimit_id = g_timeout_add (NM_UTILS_NS_TO_MSEC_CEIL (priv->ratelimit_next - now), data_changed_timeout, self);
 }
 
+static void
+lldp_neighbors_remove (NMLldpListenerPrivate *priv, LldpNeighbor *neigh)
+{
+	g_queue_unlink (&priv->lldp_neighbors_lru, &neigh->lru_link);
+	if (!g_hash_table_remove (priv->lldp_neighbors, neigh))
+		nm_assert_not_reached ();
+}
+
+static void
+lldp_neighbors_add (NMLldpListenerPrivate *priv, LldpNeighbor *neigh, LldpNeighbor *neigh_old)
+{
+	/* adding an equal neighbor replaces (and frees) the old one. */
+	if (neigh_old)
+		g_queue_unlink (&priv->lldp_neighbors_lru, &neigh_old->lru_link);
+	g_hash_table_add (priv->lldp_neighbors, neigh);
+	g_queue_push_tail_link (&priv->lldp_neighbors_lru, &neigh->lru_link);
+}
+
 static void
 process_lldp_neighbor (NMLldpListener *self, sd_lldp_neighbor *neighbor_sd, gboolean neighbor_valid)
 {
@@ -686,11 +713,16 @@ process_lldp_neighbor (NMLldpListener *self, sd_lldp_neighbor *neighbor_sd, gboo
 			       "remove", LOG_NEIGH_ARG (neigh),
 			       NM_PRINT_FMT_QUOTED (parse_error, " (failed to parse: ", parse_error->message, ")", ""));
 
-			g_hash_table_remove (priv->lldp_neighbors, neigh_old);
+			lldp_neighbors_remove (priv, neigh_old);
 			changed = TRUE;
 			goto done;
-		} else if (lldp_neighbor_equal (neigh_old, neigh))
+		} else if (lldp_neighbor_equal (neigh_old, neigh)) {
+			/* nothing changed. Keep the cached variant and don't notify,
+			 * only remember that the neighbor is still around. */
+			g_queue_unlink (&priv->lldp_neighbors_lru, &neigh_old->lru_link);
+			g_queue_push_tail_link (&priv->lldp_neighbors_lru, &neigh_old->lru_link);
 			return;
+		}
 	} else if (!neighbor_valid) {
 		if (parse_error)
 			_LOGT ("process: failed to parse neighbor: %s", parse_error->message);
@@ -700,8 +732,11 @@ process_lldp_neighbor (NMLldpListener *self, sd_lldp_neighbor *neighbor_sd, gboo
 	/* ensure that we have at most MAX_NEIGHBORS entires */
 	if (   !neigh_old /* only matters in the "add" case. */
 	    && (g_hash_table_size (priv->lldp_neighbors) + 1 > MAX_NEIGHBORS)) {
-		_LOGT ("process: ignore neighbor due to overall limit of %d", MAX_NEIGHBORS);
-		return;
+		LldpNeighbor *neigh_lru = g_queue_peek_head (&priv->lldp_neighbors_lru);
+
+		_LOGT ("process: %s neigh: "LOG_NEIGH_FMT" (limit of %d neighbors reached)",
+		       "evict", LOG_NEIGH_ARG (neigh_lru), MAX_NEIGHBORS);
+		lldp_neighbors_remove (priv, neigh_lru);
 	}
 
 	_LOGD ("process: %s neigh: "LOG_NEIGH_FMT,
@@ -709,7 +744,7 @@ process_lldp_neighbor (NMLldpListener *self, sd_lldp_neighbor *neighbor_sd, gboo
 	        LOG_NEIGH_ARG (neigh));
 
 	changed = TRUE;
-	g_hash_table_add (priv->lldp_neighbors, g_steal_pointer (&neigh));
+	lldp_neighbors_add (priv, g_steal_pointer (&neigh), neigh_old);
 
 done:
 	if (changed)
@@ -754,6 +789,13 @@ nm_lldp_listener_start (NMLldpListener *self, int ifindex, GError **error)
 		goto err;
 	}
 
+	ret = sd_lldp_set_neighbors_max (priv->lldp_handle, MAX_NEIGHBORS);
+	if (ret < 0) {
+		g_set_error_literal (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
+		                     "failed setting neighbors limit");
+		goto err;
+	}
+
 	ret = sd_lldp_set_callback (priv->lldp_handle, lldp_event_handler, self);
 	if (ret < 0) {
 		g_set_error_literal (error, NM_DEVICE_ERROR, NM_DEVICE_ERROR_FAILED,
@@ -808,6 +850,7 @@ nm_lldp_listener_stop (NMLldpListener *self)
 		priv->lldp_handle = NULL;
 
 		size = g_hash_table_size (priv->lldp_neighbors);
+		g_queue_init (&priv->lldp_neighbors_lru);
 		g_hash_table_remove_all (priv->lldp_neighbors);
 		if (size || priv->ratelimit_id)
 			changed = TRUE;
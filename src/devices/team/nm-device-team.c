@@ -246,39 +246,49 @@ master_update_slave_connection (NMDevice *self,
                                 NMConnection *connection,
                                 GError **error)
 {
+	NMDeviceTeamPrivate *priv = NM_DEVICE_TEAM_GET_PRIVATE ((NMDeviceTeam *) self);
 	NMSettingTeamPort *s_port;
 	char *port_config = NULL;
 	int err = 0;
 	struct teamdctl *tdc;
+	struct teamdctl *tdc_temp = NULL;
 	const char *team_port_config = NULL;
 	const char *iface = nm_device_get_iface (self);
 	const char *iface_slave = nm_device_get_iface (slave);
 
-	tdc = teamdctl_alloc ();
+	/* Reuse the control connection of the team if there is one. Only
+	 * connect temporarily for teams that we don't control, like
+	 * update_connection() does. */
+	tdc = priv->tdc;
 	if (!tdc) {
-		g_set_error (error,
-		             NM_DEVICE_ERROR,
-		             NM_DEVICE_ERROR_FAILED,
-		             "update slave connection for slave '%s' failed to connect to teamd for master %s (out of memory?)",
-		             iface_slave, iface);
-		g_return_val_if_reached (FALSE);
-	}
+		tdc = tdc_temp = teamdctl_alloc ();
+		if (!tdc) {
+			g_set_error (error,
+			             NM_DEVICE_ERROR,
+			             NM_DEVICE_ERROR_FAILED,
+			             "update slave connection for slave '%s' failed to connect to teamd for master %s (out of memory?)",
+			             iface_slave, iface);
+			g_return_val_if_reached (FALSE);
+		}
 
-	err = teamdctl_connect (tdc, iface, NULL, NULL);
-	if (err) {
-		teamdctl_free (tdc);
-		g_set_error (error,
-		             NM_DEVICE_ERROR,
-		             NM_DEVICE_ERROR_FAILED,
-		             "update slave connection for slave '%s' failed to connect to teamd for master %s (err=%d)",
-		             iface_slave, iface, err);
-		return FALSE;
+		err = teamdctl_connect (tdc, iface, NULL, NULL);
+		if (err) {
+			teamdctl_free (tdc);
+			g_set_error (error,
+			             NM_DEVICE_ERROR,
+			             NM_DEVICE_ERROR_FAILED,
+			             "update slave connection for slave '%s' failed to connect to teamd for master %s (err=%d)",
+			             iface_slave, iface, err);
+			return FALSE;
+		}
 	}
 
 	err = teamdctl_port_config_get_raw_direct (tdc, iface_slave, (char **)&team_port_config);
 	port_config = g_strdup (team_port_config);
-	teamdctl_disconnect (tdc);
-	teamdctl_free (tdc);
+	if (tdc_temp) {
+		teamdctl_disconnect (tdc_temp);
+		teamdctl_free (tdc_temp);
+	}
 	if (err) {
 		g_set_error (error,
 		             NM_DEVICE_ERROR,
@@ -61,8 +61,31 @@ _LOG_DECLARE_SELF(NMDeviceWifi);
 #define SCAN_INTERVAL_STEP 20
 #define SCAN_INTERVAL_MAX 120
 
+/* While activated, scan more often when the signal of the current AP is
+ * weak or drops, as roaming gets likely, and less often while it is
+ * strong and steady. */
+#define SCAN_INTERVAL_ROAM        30
+#define SCAN_INTERVAL_MAX_STABLE  240
+#define SCAN_STRENGTH_ROAM        40
+#define SCAN_STRENGTH_STABLE      70
+#define SCAN_STRENGTH_DROP        10
+
+/* Periodic scans while activated only scan the channels of the APs of
+ * the current network; each SCAN_FULL_EVERY-th scan is a full one. */
+#define SCAN_FULL_EVERY 4
+
+/* An AP dropped by the supplicant stays exported for this many seconds,
+ * so that it keeps its object path when the BSS shows up again shortly
+ * after, as it often does while moving. */
+#define AP_LOST_GRACE_S 60
+
 #define SCAN_RAND_MAC_ADDRESS_EXPIRE_MIN 5
 
+/* seconds between updates of the signal and the bitrate. When the
+ * platform pushes events, only the bitrate is polled, and less often. */
+#define PERIODIC_UPDATE_INTERVAL        6
+#define PERIODIC_UPDATE_INTERVAL_EVENTS 30
+
 static NM_CACHED_QUARK_FCN ("wireless-secrets-tries", wireless_secrets_tries_quark)
 
 /*****************************************************************************/
@@ -89,7 +112,27 @@ static guint signals[LAST_SIGNAL] = { 0 };
 typedef struct {
 	gint8             invalid_strength_counter;
 
+	/* the APs by their exported path, and by the D-Bus path of the
+	 * supplicant's BSS. @aps_sorted has the APs sorted by their id.
+	 * As new APs get the highest id, adding an AP only appends. */
 	GHashTable *      aps;
+	GHashTable *      aps_by_supplicant_path;
+	GPtrArray *       aps_sorted;
+
+	/* APs no longer known to the supplicant, with the timestamp when
+	 * they were lost, see AP_LOST_GRACE_S. They stay exported but are
+	 * neither listed nor used for matching connections. */
+	GHashTable *      aps_lost;
+	guint             aps_lost_cull_id;
+
+	/* APs updated while scanning, with their property notifications
+	 * frozen until the scan completes. */
+	GHashTable *      aps_frozen;
+
+	/* the cached reply for GetAccessPoints and GetAllAccessPoints,
+	 * indexed by include_without_ssid. */
+	GVariant *        aps_paths_variant[2];
+
 	NMWifiAP *        current_ap;
 	guint32           rate;
 	bool              enabled:1; /* rfkilled or not */
@@ -100,6 +143,14 @@ typedef struct {
 	gint32            last_scan;
 	gint32            scheduled_scan_time;
 	guint8            scan_interval; /* seconds */
+	gint8             scan_strength; /* of the current AP at the previous scheduling, or -1 */
+	guint8            scan_roam_count; /* channel-restricted scans since the last full one */
+
+	/* cached result of build_hidden_probe_list(), until the connections
+	 * change. */
+	GPtrArray        *hidden_probe_list;
+	guint             hidden_probe_list_max_ssids;
+	bool              hidden_probe_list_valid:1;
 	guint             pending_scan_id;
 	guint             ap_dump_id;
 
@@ -112,6 +163,7 @@ typedef struct {
 	NMActRequestGetSecretsCallId wifi_secrets_id;
 
 	guint             periodic_source_id;
+	int               periodic_events_ifindex;
 	guint             link_timeout_id;
 	guint32           failed_iface_count;
 	guint             reacquire_iface_id;
@@ -178,7 +230,9 @@ static void supplicant_iface_notify_current_bss (NMSupplicantInterface *iface,
                                                  GParamSpec *pspec,
                                                  NMDeviceWifi *self);
 
-static void request_wireless_scan (NMDeviceWifi *self, gboolean force_if_scanning, GVariant *scan_options);
+static void schedule_ap_list_dump (NMDeviceWifi *self);
+
+static void request_wireless_scan (NMDeviceWifi *self, gboolean force_if_scanning, gboolean periodic, GVariant *scan_options);
 
 static void ap_add_remove (NMDeviceWifi *self,
                            guint signum,
@@ -187,6 +241,10 @@ static void ap_add_remove (NMDeviceWifi *self,
 
 static void _hw_addr_set_scanning (NMDeviceWifi *self, gboolean do_reset);
 
+static void ap_thaw_notify_all (NMDeviceWifi *self);
+
+static void ap_lost_cull_schedule (NMDeviceWifi *self);
+
 /*****************************************************************************/
 
 static void
@@ -322,6 +380,8 @@ supplicant_interface_release (NMDeviceWifi *self)
 
 	nm_clear_g_source (&priv->ap_dump_id);
 
+	ap_thaw_notify_all (self);
+
 	if (priv->sup_iface) {
 		/* Clear supplicant interface signal handlers */
 		g_signal_handlers_disconnect_by_data (priv->sup_iface, self);
@@ -346,19 +406,92 @@ get_ap_by_path (NMDeviceWifi *self, const char *path)
 static NMWifiAP *
 get_ap_by_supplicant_path (NMDeviceWifi *self, const char *path)
 {
+	g_return_val_if_fail (path != NULL, NULL);
+	return g_hash_table_lookup (NM_DEVICE_WIFI_GET_PRIVATE (self)->aps_by_supplicant_path, path);
+}
+
+static void
+ap_thaw_notify (NMDeviceWifi *self, NMWifiAP *ap)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+
+	if (g_hash_table_remove (priv->aps_frozen, ap))
+		g_object_thaw_notify (G_OBJECT (ap));
+}
+
+static void
+ap_thaw_notify_all (NMDeviceWifi *self)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 	GHashTableIter iter;
 	NMWifiAP *ap;
 
-	g_return_val_if_fail (path != NULL, NULL);
+	g_hash_table_iter_init (&iter, priv->aps_frozen);
+	while (g_hash_table_iter_next (&iter, (gpointer *) &ap, NULL)) {
+		g_hash_table_iter_remove (&iter);
+		g_object_thaw_notify (G_OBJECT (ap));
+	}
+}
 
-	g_hash_table_iter_init (&iter, NM_DEVICE_WIFI_GET_PRIVATE (self)->aps);
-	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &ap)) {
-		if (g_strcmp0 (path, nm_wifi_ap_get_supplicant_path (ap)) == 0)
-			return ap;
+static NMWifiAP *
+ap_lost_find (NMDeviceWifi *self, NMWifiAP *ap)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	const GByteArray *ssid = nm_wifi_ap_get_ssid (ap);
+	GHashTableIter iter;
+	NMWifiAP *lost;
+
+	g_hash_table_iter_init (&iter, priv->aps_lost);
+	while (g_hash_table_iter_next (&iter, (gpointer *) &lost, NULL)) {
+		const GByteArray *lost_ssid = nm_wifi_ap_get_ssid (lost);
+
+		if (   nm_streq0 (nm_wifi_ap_get_address (lost), nm_wifi_ap_get_address (ap))
+		    && nm_utils_same_ssid (lost_ssid ? lost_ssid->data : NULL,
+		                           lost_ssid ? lost_ssid->len : 0,
+		                           ssid ? ssid->data : NULL,
+		                           ssid ? ssid->len : 0,
+		                           FALSE))
+			return lost;
 	}
 	return NULL;
 }
 
+static gboolean
+ap_is_lost (NMDeviceWifi *self, NMWifiAP *ap)
+{
+	return g_hash_table_contains (NM_DEVICE_WIFI_GET_PRIVATE (self)->aps_lost, ap);
+}
+
+static void
+ap_list_changed (NMDeviceWifi *self)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+
+	g_clear_pointer (&priv->aps_paths_variant[FALSE], g_variant_unref);
+	g_clear_pointer (&priv->aps_paths_variant[TRUE], g_variant_unref);
+}
+
+static guint
+ap_list_sorted_find (NMDeviceWifi *self, NMWifiAP *ap)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	guint64 id = nm_wifi_ap_get_id (ap);
+	guint lo = 0, hi = priv->aps_sorted->len;
+
+	while (lo < hi) {
+		guint mid = lo + (hi - lo) / 2;
+		guint64 mid_id = nm_wifi_ap_get_id (priv->aps_sorted->pdata[mid]);
+
+		if (mid_id == id)
+			return mid;
+		if (mid_id < id)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	g_return_val_if_reached (G_MAXUINT);
+}
+
 static void
 update_seen_bssids_cache (NMDeviceWifi *self, NMWifiAP *ap)
 {
@@ -470,6 +603,47 @@ periodic_update_cb (gpointer user_data)
 	return TRUE;
 }
 
+static void
+periodic_update_event_cb (NMPlatform *platform, int ifindex, gpointer user_data)
+{
+	periodic_update (NM_DEVICE_WIFI (user_data));
+}
+
+static void
+periodic_update_start (NMDeviceWifi *self)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	int ifindex = nm_device_get_ifindex (NM_DEVICE (self));
+	guint interval = PERIODIC_UPDATE_INTERVAL;
+
+	if (priv->periodic_source_id)
+		return;
+
+	/* When the platform notifies us about changes of the association and
+	 * the signal, we only poll for the bitrate, which has no events. */
+	if (   ifindex > 0
+	    && nm_platform_wifi_watch_events (NM_PLATFORM_GET, ifindex,
+	                                      periodic_update_event_cb, self)) {
+		priv->periodic_events_ifindex = ifindex;
+		interval = PERIODIC_UPDATE_INTERVAL_EVENTS;
+	}
+
+	priv->periodic_source_id = g_timeout_add_seconds (interval, periodic_update_cb, self);
+}
+
+static void
+periodic_update_stop (NMDeviceWifi *self)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+
+	nm_clear_g_source (&priv->periodic_source_id);
+	if (priv->periodic_events_ifindex > 0) {
+		nm_platform_wifi_watch_events (NM_PLATFORM_GET, priv->periodic_events_ifindex,
+		                               NULL, NULL);
+		priv->periodic_events_ifindex = 0;
+	}
+}
+
 static void
 ap_add_remove (NMDeviceWifi *self,
                guint signum,
@@ -484,13 +658,33 @@ ap_add_remove (NMDeviceWifi *self,
 		g_hash_table_insert (priv->aps,
 		                     (gpointer) nm_exported_object_export ((NMExportedObject *) ap),
 		                     g_object_ref (ap));
+		if (nm_wifi_ap_get_supplicant_path (ap)) {
+			g_hash_table_replace (priv->aps_by_supplicant_path,
+			                      (gpointer) nm_wifi_ap_get_supplicant_path (ap),
+			                      ap);
+		}
+		nm_assert (   !priv->aps_sorted->len
+		           || nm_wifi_ap_get_id (priv->aps_sorted->pdata[priv->aps_sorted->len - 1]) < nm_wifi_ap_get_id (ap));
+		g_ptr_array_add (priv->aps_sorted, ap);
 		_ap_dump (self, LOGL_DEBUG, ap, "added", 0);
 	} else
 		_ap_dump (self, LOGL_DEBUG, ap, "removed", 0);
 
+	ap_list_changed (self);
+
 	g_signal_emit (self, signals[signum], 0, ap);
 
 	if (signum == ACCESS_POINT_REMOVED) {
+		guint idx;
+
+		idx = ap_list_sorted_find (self, ap);
+		if (idx != G_MAXUINT)
+			g_ptr_array_remove_index (priv->aps_sorted, idx);
+		g_hash_table_remove (priv->aps_lost, ap);
+		ap_thaw_notify (self, ap);
+		if (   nm_wifi_ap_get_supplicant_path (ap)
+		    && g_hash_table_lookup (priv->aps_by_supplicant_path, nm_wifi_ap_get_supplicant_path (ap)) == ap)
+			g_hash_table_remove (priv->aps_by_supplicant_path, nm_wifi_ap_get_supplicant_path (ap));
 		g_hash_table_remove (priv->aps, nm_exported_object_get_path ((NMExportedObject *) ap));
 		nm_exported_object_unexport ((NMExportedObject *) ap);
 		g_object_unref (ap);
@@ -507,24 +701,88 @@ static void
 remove_all_aps (NMDeviceWifi *self)
 {
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
-	GHashTableIter iter;
-	NMWifiAP *ap;
 
-	if (!g_hash_table_size (priv->aps))
+	if (!priv->aps_sorted->len)
 		return;
 
 	set_current_ap (self, NULL, FALSE);
 
-again:
-	g_hash_table_iter_init (&iter, priv->aps);
-	if (g_hash_table_iter_next (&iter, NULL, (gpointer) &ap)) {
-		ap_add_remove (self, ACCESS_POINT_REMOVED, ap, FALSE);
-		goto again;
+	while (priv->aps_sorted->len) {
+		ap_add_remove (self, ACCESS_POINT_REMOVED,
+		               priv->aps_sorted->pdata[priv->aps_sorted->len - 1],
+		               FALSE);
 	}
 
 	nm_device_recheck_available_connections (NM_DEVICE (self));
 }
 
+static void
+ap_lost_cull (NMDeviceWifi *self, gint32 now_s)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	gs_free NMWifiAP **expired = NULL;
+	GHashTableIter iter;
+	NMWifiAP *ap;
+	gpointer lost_s;
+	guint i, n = 0;
+
+	if (!g_hash_table_size (priv->aps_lost))
+		return;
+
+	expired = g_new (NMWifiAP *, g_hash_table_size (priv->aps_lost));
+	g_hash_table_iter_init (&iter, priv->aps_lost);
+	while (g_hash_table_iter_next (&iter, (gpointer *) &ap, &lost_s)) {
+		if (   ap != priv->current_ap
+		    && now_s - GPOINTER_TO_INT (lost_s) >= AP_LOST_GRACE_S)
+			expired[n++] = ap;
+	}
+
+	for (i = 0; i < n; i++)
+		ap_add_remove (self, ACCESS_POINT_REMOVED, expired[i], i == n - 1);
+	if (n)
+		schedule_ap_list_dump (self);
+}
+
+static gboolean
+ap_lost_cull_cb (gpointer user_data)
+{
+	NMDeviceWifi *self = user_data;
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+
+	priv->aps_lost_cull_id = 0;
+	ap_lost_cull (self, nm_utils_get_monotonic_timestamp_s ());
+	ap_lost_cull_schedule (self);
+	return G_SOURCE_REMOVE;
+}
+
+/* Lost APs are removed on a timer of their own, as there might be no
+ * further scans to do it. */
+static void
+ap_lost_cull_schedule (NMDeviceWifi *self)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	GHashTableIter iter;
+	NMWifiAP *ap;
+	gpointer lost_s;
+	gint32 first_s = G_MAXINT32;
+	gint32 now_s;
+
+	if (priv->aps_lost_cull_id)
+		return;
+
+	g_hash_table_iter_init (&iter, priv->aps_lost);
+	while (g_hash_table_iter_next (&iter, (gpointer *) &ap, &lost_s)) {
+		if (ap != priv->current_ap)
+			first_s = MIN (first_s, GPOINTER_TO_INT (lost_s));
+	}
+	if (first_s == G_MAXINT32)
+		return;
+
+	now_s = nm_utils_get_monotonic_timestamp_s ();
+	priv->aps_lost_cull_id = g_timeout_add_seconds (MAX (first_s + AP_LOST_GRACE_S - now_s, 1),
+	                                                ap_lost_cull_cb, self);
+}
+
 static void
 deactivate (NMDevice *device)
 {
@@ -533,7 +791,7 @@ deactivate (NMDevice *device)
 	int ifindex = nm_device_get_ifindex (device);
 	NM80211Mode old_mode = priv->mode;
 
-	nm_clear_g_source (&priv->periodic_source_id);
+	periodic_update_stop (self);
 
 	cleanup_association_attempt (self, TRUE);
 
@@ -560,7 +818,7 @@ deactivate (NMDevice *device)
 
 	/* Ensure we trigger a scan after deactivating a Hotspot */
 	if (old_mode == NM_802_11_MODE_AP)
-		request_wireless_scan (self, FALSE, NULL);
+		request_wireless_scan (self, FALSE, FALSE, NULL);
 }
 
 static void
@@ -675,22 +933,21 @@ find_first_compatible_ap (NMDeviceWifi *self,
                           NMConnection *connection,
                           gboolean allow_unstable_order)
 {
-	GHashTableIter iter;
-	NMWifiAP *ap;
-	NMWifiAP *cand_ap = NULL;
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	guint i;
 
 	g_return_val_if_fail (connection != NULL, NULL);
 
-	g_hash_table_iter_init (&iter, NM_DEVICE_WIFI_GET_PRIVATE (self)->aps);
-	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &ap)) {
-		if (!nm_wifi_ap_check_compatible (ap, connection))
-			continue;
-		if (allow_unstable_order)
+	/* the compatible AP with the highest id. As that is also stable,
+	 * @allow_unstable_order makes no difference. */
+	for (i = priv->aps_sorted->len; i > 0; i--) {
+		NMWifiAP *ap = priv->aps_sorted->pdata[i - 1];
+
+		if (   !ap_is_lost (self, ap)
+		    && nm_wifi_ap_check_compatible (ap, connection))
 			return ap;
-		if (!cand_ap || (nm_wifi_ap_get_id (cand_ap) < nm_wifi_ap_get_id (ap)))
-			cand_ap = ap;
 	}
-	return cand_ap;
+	return NULL;
 }
 
 static gboolean
@@ -712,7 +969,9 @@ check_connection_available (NMDevice *device,
 		NMWifiAP *ap;
 
 		ap = get_ap_by_path (NM_DEVICE_WIFI (device), specific_object);
-		return ap ? nm_wifi_ap_check_compatible (ap, connection) : FALSE;
+		return    ap
+		       && !ap_is_lost (NM_DEVICE_WIFI (device), ap)
+		       && nm_wifi_ap_check_compatible (ap, connection);
 	}
 
 	/* Ad-Hoc and AP connections are always available because they may be
@@ -1028,48 +1287,22 @@ can_auto_connect (NMDevice *device,
 	return FALSE;
 }
 
-static int
-ap_id_compare (gconstpointer p_a, gconstpointer p_b, gpointer user_data)
-{
-	guint64 a_id = nm_wifi_ap_get_id (*((NMWifiAP **) p_a));
-	guint64 b_id = nm_wifi_ap_get_id (*((NMWifiAP **) p_b));
-
-	return a_id < b_id ? -1 : (a_id == b_id ? 0 : 1);
-}
-
 static NMWifiAP **
 ap_list_get_sorted (NMDeviceWifi *self, gboolean include_without_ssid)
 {
-	NMDeviceWifiPrivate *priv;
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 	NMWifiAP **list;
-	GHashTableIter iter;
-	NMWifiAP *ap;
-	gsize i, n;
+	guint i, n;
 
-	priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
-
-	n = g_hash_table_size (priv->aps);
-	list = g_new (NMWifiAP *, n + 1);
-
-	i = 0;
-	if (n > 0) {
-		g_hash_table_iter_init (&iter, priv->aps);
-		while (g_hash_table_iter_next (&iter, NULL, (gpointer) &ap)) {
-			nm_assert (i < n);
-			if (   include_without_ssid
-			    || nm_wifi_ap_get_ssid (ap))
-				list[i++] = ap;
-		}
-		nm_assert (i <= n);
-		nm_assert (!include_without_ssid || i == n);
+	list = g_new (NMWifiAP *, priv->aps_sorted->len + 1);
+	for (i = 0, n = 0; i < priv->aps_sorted->len; i++) {
+		NMWifiAP *ap = priv->aps_sorted->pdata[i];
 
-		g_qsort_with_data (list,
-		                   i,
-		                   sizeof (gpointer),
-		                   ap_id_compare,
-		                   NULL);
+		if (   include_without_ssid
+		    || nm_wifi_ap_get_ssid (ap))
+			list[n++] = ap;
 	}
-	list[i] = NULL;
+	list[n] = NULL;
 	return list;
 }
 
@@ -1084,6 +1317,9 @@ ap_list_get_sorted_paths (NMDeviceWifi *self, gboolean include_without_ssid)
 		NMWifiAP *ap = list[i];
 		const char *path;
 
+		if (ap_is_lost (self, ap))
+			continue;
+
 		/* update @list inplace to hold instead the export-path. */
 		path = nm_exported_object_get_path (NM_EXPORTED_OBJECT (ap));
 		nm_assert (path);
@@ -1092,15 +1328,28 @@ ap_list_get_sorted_paths (NMDeviceWifi *self, gboolean include_without_ssid)
 	return (const char **) list;
 }
 
+static GVariant *
+ap_list_get_paths_variant (NMDeviceWifi *self, gboolean include_without_ssid)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	GVariant **cached = &priv->aps_paths_variant[!!include_without_ssid];
+
+	if (!*cached) {
+		gs_free const char **list = NULL;
+
+		list = ap_list_get_sorted_paths (self, include_without_ssid);
+		*cached = g_variant_ref_sink (g_variant_new_objv (list, -1));
+	}
+	return *cached;
+}
+
 static void
 impl_device_wifi_get_access_points (NMDeviceWifi *self,
                                     GDBusMethodInvocation *context)
 {
-	gs_free const char **list = NULL;
 	GVariant *v;
 
-	list = ap_list_get_sorted_paths (self, FALSE);
-	v = g_variant_new_objv (list, -1);
+	v = ap_list_get_paths_variant (self, FALSE);
 	g_dbus_method_invocation_return_value (context, g_variant_new_tuple (&v, 1));
 }
 
@@ -1108,11 +1357,9 @@ static void
 impl_device_wifi_get_all_access_points (NMDeviceWifi *self,
                                         GDBusMethodInvocation *context)
 {
-	gs_free const char **list = NULL;
 	GVariant *v;
 
-	list = ap_list_get_sorted_paths (self, TRUE);
-	v = g_variant_new_objv (list, -1);
+	v = ap_list_get_paths_variant (self, TRUE);
 	g_dbus_method_invocation_return_value (context, g_variant_new_tuple (&v, 1));
 }
 
@@ -1123,6 +1370,7 @@ _hw_addr_set_scanning (NMDeviceWifi *self, gboolean do_reset)
 	NMDeviceWifiPrivate *priv;
 	guint32 now;
 	gboolean randomize;
+	gs_free char *generate_mac_address_mask = NULL;
 
 	g_return_if_fail (NM_IS_DEVICE_WIFI (self));
 
@@ -1137,6 +1385,26 @@ _hw_addr_set_scanning (NMDeviceWifi *self, gboolean do_reset)
 	                                                      device,
 	                                                      TRUE, TRUE);
 
+	generate_mac_address_mask = nm_config_data_get_device_config (NM_CONFIG_GET_DATA,
+	                                                              "wifi.scan-generate-mac-address-mask",
+	                                                              device,
+	                                                              NULL);
+
+	/* Prefer letting the supplicant (and the driver) use a random address
+	 * for each scan. Changing the address of the link requires taking it
+	 * down, which interrupts the supplicant. The supplicant can't keep
+	 * parts of the address though, so a configured mask still needs the
+	 * link to be changed. */
+	if (   priv->sup_iface
+	    && nm_supplicant_interface_get_scan_rand_mac_support (priv->sup_iface) == NM_SUPPLICANT_FEATURE_YES
+	    && (!randomize || !generate_mac_address_mask)) {
+		nm_supplicant_interface_set_scan_rand_mac (priv->sup_iface, randomize);
+		if (priv->hw_addr_scan)
+			do_reset = TRUE;
+		randomize = FALSE;
+	} else if (priv->sup_iface)
+		nm_supplicant_interface_set_scan_rand_mac (priv->sup_iface, FALSE);
+
 	if (!randomize) {
 		g_clear_pointer (&priv->hw_addr_scan, g_free);
 		if (do_reset)
@@ -1148,8 +1416,6 @@ _hw_addr_set_scanning (NMDeviceWifi *self, gboolean do_reset)
 
 	if (   !priv->hw_addr_scan
 	    || now >= priv->hw_addr_scan_expire) {
-		gs_free char *generate_mac_address_mask = NULL;
-
 		/* the random MAC address for scanning expires after a while.
 		 *
 		 * We don't bother with to update the MAC address exactly when
@@ -1157,11 +1423,6 @@ _hw_addr_set_scanning (NMDeviceWifi *self, gboolean do_reset)
 		 * a new one.*/
 		priv->hw_addr_scan_expire = now + (SCAN_RAND_MAC_ADDRESS_EXPIRE_MIN * 60);
 
-		generate_mac_address_mask = nm_config_data_get_device_config (NM_CONFIG_GET_DATA,
-		                                                              "wifi.scan-generate-mac-address-mask",
-		                                                              device,
-		                                                              NULL);
-
 		g_free (priv->hw_addr_scan);
 		priv->hw_addr_scan = nm_utils_hw_addr_gen_random_eth (nm_device_get_initial_hw_address (device),
 		                                                      generate_mac_address_mask);
@@ -1196,7 +1457,7 @@ request_scan_cb (NMDevice *device,
 
 	priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 
-	request_wireless_scan (self, FALSE, new_scan_options);
+	request_wireless_scan (self, FALSE, FALSE, new_scan_options);
 	g_dbus_method_invocation_return_value (context, NULL);
 }
 
@@ -1359,11 +1620,18 @@ hidden_filter_func (NMSettings *settings,
 	return s_wifi ? nm_setting_wireless_get_hidden (s_wifi) : FALSE;
 }
 
-static GPtrArray *
-build_hidden_probe_list (NMDeviceWifi *self)
+static void
+hidden_probe_list_invalidate (NMDeviceWifi *self)
 {
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
-	guint max_scan_ssids = nm_supplicant_interface_get_max_scan_ssids (priv->sup_iface);
+
+	priv->hidden_probe_list_valid = FALSE;
+	g_clear_pointer (&priv->hidden_probe_list, g_ptr_array_unref);
+}
+
+static GPtrArray *
+_build_hidden_probe_list (NMDeviceWifi *self, guint max_scan_ssids)
+{
 	gs_free NMSettingsConnection **connections = NULL;
 	guint i, len;
 	GPtrArray *ssids = NULL;
@@ -1411,6 +1679,73 @@ build_hidden_probe_list (NMDeviceWifi *self)
 	return ssids;
 }
 
+static GPtrArray *
+build_hidden_probe_list (NMDeviceWifi *self)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	guint max_scan_ssids = nm_supplicant_interface_get_max_scan_ssids (priv->sup_iface);
+
+	if (   !priv->hidden_probe_list_valid
+	    || priv->hidden_probe_list_max_ssids != max_scan_ssids) {
+		hidden_probe_list_invalidate (self);
+		priv->hidden_probe_list = _build_hidden_probe_list (self, max_scan_ssids);
+		priv->hidden_probe_list_max_ssids = max_scan_ssids;
+		priv->hidden_probe_list_valid = TRUE;
+	}
+
+	return priv->hidden_probe_list ? g_ptr_array_ref (priv->hidden_probe_list) : NULL;
+}
+
+static guint32 *
+build_roam_freqs (NMDeviceWifi *self)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	const GByteArray *ssid;
+	guint32 *freqs;
+	guint i, j, n;
+
+	if (   nm_device_get_state (NM_DEVICE (self)) != NM_DEVICE_STATE_ACTIVATED
+	    || priv->mode != NM_802_11_MODE_INFRA
+	    || !priv->current_ap)
+		return NULL;
+
+	if (++priv->scan_roam_count >= SCAN_FULL_EVERY) {
+		priv->scan_roam_count = 0;
+		return NULL;
+	}
+
+	ssid = nm_wifi_ap_get_ssid (priv->current_ap);
+	if (!ssid)
+		return NULL;
+
+	/* the channels of the APs of the current network, where we
+	 * might roam to. */
+	freqs = g_new (guint32, priv->aps_sorted->len + 1);
+	for (i = 0, n = 0; i < priv->aps_sorted->len; i++) {
+		NMWifiAP *ap = priv->aps_sorted->pdata[i];
+		const GByteArray *ap_ssid = nm_wifi_ap_get_ssid (ap);
+		guint32 freq = nm_wifi_ap_get_freq (ap);
+
+		if (   !freq
+		    || !ap_ssid
+		    || !nm_utils_same_ssid (ssid->data, ssid->len, ap_ssid->data, ap_ssid->len, TRUE))
+			continue;
+		for (j = 0; j < n; j++) {
+			if (freqs[j] == freq)
+				break;
+		}
+		if (j == n)
+			freqs[n++] = freq;
+	}
+	freqs[n] = 0;
+
+	if (!n) {
+		g_free (freqs);
+		return NULL;
+	}
+	return freqs;
+}
+
 static GPtrArray *
 ssids_options_to_ptrarray (GVariant *value)
 {
@@ -1436,7 +1771,7 @@ ssids_options_to_ptrarray (GVariant *value)
 }
 
 static void
-request_wireless_scan (NMDeviceWifi *self, gboolean force_if_scanning, GVariant *scan_options)
+request_wireless_scan (NMDeviceWifi *self, gboolean force_if_scanning, gboolean periodic, GVariant *scan_options)
 {
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 	gboolean request_started = FALSE;
@@ -1450,6 +1785,7 @@ request_wireless_scan (NMDeviceWifi *self, gboolean force_if_scanning, GVariant
 
 	if (check_scanning_allowed (self)) {
 		gs_unref_ptrarray GPtrArray *ssids = NULL;
+		gs_free guint32 *freqs = NULL;
 
 		_LOGD (LOGD_WIFI, "wifi-scan: scanning requested");
 
@@ -1486,9 +1822,18 @@ request_wireless_scan (NMDeviceWifi *self, gboolean force_if_scanning, GVariant
 				_LOGD (LOGD_WIFI, "wifi-scan: no SSIDs to probe scan");
 		}
 
+		if (periodic)
+			freqs = build_roam_freqs (self);
+		if (freqs && _LOGD_ENABLED (LOGD_WIFI)) {
+			guint i;
+
+			for (i = 0; freqs[i]; i++)
+				_LOGD (LOGD_WIFI, "wifi-scan: scanning channel %u MHz", (guint) freqs[i]);
+		}
+
 		_hw_addr_set_scanning (self, FALSE);
 
-		nm_supplicant_interface_request_scan (priv->sup_iface, ssids);
+		nm_supplicant_interface_request_scan (priv->sup_iface, ssids, freqs);
 		request_started = TRUE;
 	} else
 		_LOGD (LOGD_WIFI, "wifi-scan: scanning requested but not allowed at this time");
@@ -1505,7 +1850,7 @@ request_wireless_scan_periodic (gpointer user_data)
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 
 	priv->pending_scan_id = 0;
-	request_wireless_scan (self, FALSE, NULL);
+	request_wireless_scan (self, FALSE, TRUE, NULL);
 	return G_SOURCE_REMOVE;
 }
 
@@ -1528,23 +1873,43 @@ schedule_scan (NMDeviceWifi *self, gboolean backoff)
 	}
 
 	if (!priv->pending_scan_id) {
-		guint factor = 2, next_scan = priv->scan_interval;
+		guint factor = 2, next_scan;
+		guint interval_max = SCAN_INTERVAL_MAX;
 
 		if (    nm_device_is_activating (NM_DEVICE (self))
 		    || (nm_device_get_state (NM_DEVICE (self)) == NM_DEVICE_STATE_ACTIVATED))
 			factor = 1;
 
+		if (   nm_device_get_state (NM_DEVICE (self)) == NM_DEVICE_STATE_ACTIVATED
+		    && priv->current_ap) {
+			int strength = nm_wifi_ap_get_strength (priv->current_ap);
+
+			if (   strength < SCAN_STRENGTH_ROAM
+			    || (   priv->scan_strength >= 0
+			        && strength + SCAN_STRENGTH_DROP <= priv->scan_strength)) {
+				priv->scan_interval = MIN (priv->scan_interval, SCAN_INTERVAL_ROAM);
+				interval_max = SCAN_INTERVAL_ROAM;
+			} else if (   strength >= SCAN_STRENGTH_STABLE
+			           && priv->scan_strength >= 0
+			           && ABS (strength - priv->scan_strength) < SCAN_STRENGTH_DROP)
+				interval_max = SCAN_INTERVAL_MAX_STABLE;
+			priv->scan_strength = strength;
+		} else
+			priv->scan_strength = -1;
+
+		next_scan = priv->scan_interval;
+
 		priv->pending_scan_id = g_timeout_add_seconds (next_scan,
 		                                               request_wireless_scan_periodic,
 		                                               self);
 
 		priv->scheduled_scan_time = now + priv->scan_interval;
-		if (backoff && (priv->scan_interval < (SCAN_INTERVAL_MAX / factor))) {
+		if (backoff && (priv->scan_interval < (interval_max / factor))) {
 				priv->scan_interval += (SCAN_INTERVAL_STEP / factor);
 				/* Ensure the scan interval will never be less than 20s... */
 				priv->scan_interval = MAX(priv->scan_interval, SCAN_INTERVAL_MIN + SCAN_INTERVAL_STEP);
-				/* ... or more than 120s */
-				priv->scan_interval = MIN(priv->scan_interval, SCAN_INTERVAL_MAX);
+				/* ... or more than 120s (240s while the signal is steady) */
+				priv->scan_interval = MIN(priv->scan_interval, interval_max);
 		} else if (!backoff && (priv->scan_interval == 0)) {
 			/* Invalid combination; would cause continual rescheduling of
 			 * the scan and hog CPU.  Reset to something minimally sane.
@@ -1567,6 +1932,9 @@ supplicant_iface_scan_done_cb (NMSupplicantInterface *iface,
 	_LOGD (LOGD_WIFI, "wifi-scan: scan-done callback: %s", success ? "successful" : "failed");
 
 	priv->last_scan = nm_utils_get_monotonic_timestamp_s ();
+
+	ap_thaw_notify_all (self);
+
 	schedule_scan (self, success);
 
 	_requested_scan_set (self, FALSE);
@@ -1626,7 +1994,9 @@ try_fill_ssid_for_hidden_ap (NMDeviceWifi *self,
 
 	/* Look for this AP's BSSID in the seen-bssids list of a connection,
 	 * and if a match is found, copy over the SSID */
-	connections = nm_settings_get_connections (nm_device_get_settings ((NMDevice *) self), NULL);
+	connections = nm_settings_get_connections_by_type (nm_device_get_settings ((NMDevice *) self),
+	                                                   NM_SETTING_WIRELESS_SETTING_NAME,
+	                                                   NULL);
 	for (i = 0; connections[i]; i++) {
 		NMConnection *connection = (NMConnection *) connections[i];
 		NMSettingWireless *s_wifi;
@@ -1669,8 +2039,16 @@ supplicant_iface_bss_updated_cb (NMSupplicantInterface *iface,
 
 	found_ap = get_ap_by_supplicant_path (self, object_path);
 	if (found_ap) {
+		/* batch the property changes of known APs until the scan is done. */
+		if (   nm_supplicant_interface_get_scanning (iface)
+		    && !g_hash_table_contains (priv->aps_frozen, found_ap)) {
+			g_object_freeze_notify (G_OBJECT (found_ap));
+			g_hash_table_add (priv->aps_frozen, found_ap);
+		}
 		if (!nm_wifi_ap_update_from_properties (found_ap, object_path, properties))
 			return;
+		/* the SSID might have changed. */
+		ap_list_changed (self);
 		_ap_dump (self, LOGL_DEBUG, found_ap, "updated", 0);
 	} else {
 		gs_unref_object NMWifiAP *ap = NULL;
@@ -1699,7 +2077,21 @@ supplicant_iface_bss_updated_cb (NMSupplicantInterface *iface,
 			}
 		}
 
-		ap_add_remove (self, ACCESS_POINT_ADDED, ap, TRUE);
+		found_ap = ap_lost_find (self, ap);
+		if (found_ap) {
+			/* the BSS is back within the grace period. Keep the exported AP. */
+			g_hash_table_remove (priv->aps_lost, found_ap);
+			nm_wifi_ap_update_from_properties (found_ap, object_path, properties);
+			g_hash_table_replace (priv->aps_by_supplicant_path,
+			                      (gpointer) nm_wifi_ap_get_supplicant_path (found_ap),
+			                      found_ap);
+			ap_list_changed (self);
+			_notify (self, PROP_ACCESS_POINTS);
+			nm_device_emit_recheck_auto_activate (NM_DEVICE (self));
+			nm_device_recheck_available_connections (NM_DEVICE (self));
+			_ap_dump (self, LOGL_DEBUG, found_ap, "restored", 0);
+		} else
+			ap_add_remove (self, ACCESS_POINT_ADDED, ap, TRUE);
 	}
 
 	/* Update the current AP if the supplicant notified a current BSS change
@@ -1736,7 +2128,18 @@ supplicant_iface_bss_removed_cb (NMSupplicantInterface *iface,
 		if (nm_wifi_ap_set_fake (ap, TRUE))
 			_ap_dump (self, LOGL_DEBUG, ap, "updated", 0);
 	} else {
-		ap_add_remove (self, ACCESS_POINT_REMOVED, ap, TRUE);
+		/* Keep the AP exported for a grace period; it is reused should the
+		 * BSS reappear, and removed by ap_lost_cull() otherwise. */
+		g_hash_table_remove (priv->aps_by_supplicant_path, object_path);
+		nm_wifi_ap_set_supplicant_path (ap, NULL);
+		nm_wifi_ap_set_fake (ap, TRUE);
+		g_hash_table_insert (priv->aps_lost, ap,
+		                     GINT_TO_POINTER (nm_utils_get_monotonic_timestamp_s ()));
+		_ap_dump (self, LOGL_DEBUG, ap, "lost", 0);
+		ap_list_changed (self);
+		_notify (self, PROP_ACCESS_POINTS);
+		nm_device_recheck_available_connections (NM_DEVICE (self));
+		ap_lost_cull_schedule (self);
 		schedule_ap_list_dump (self);
 	}
 }
@@ -2132,7 +2535,7 @@ supplicant_iface_state_cb (NMSupplicantInterface *iface,
 		/* we would clear _requested_scan_set() and trigger a new scan.
 		 * However, we don't want to cancel the current pending action, so force
 		 * a new scan request. */
-		request_wireless_scan (self, TRUE, NULL);
+		request_wireless_scan (self, TRUE, FALSE, NULL);
 		break;
 	default:
 		break;
@@ -2653,8 +3056,7 @@ act_stage2_config (NMDevice *device, NMDeviceStateReason *out_failure_reason)
 	                                              supplicant_connection_timeout_cb,
 	                                              self);
 
-	if (!priv->periodic_source_id)
-		priv->periodic_source_id = g_timeout_add_seconds (6, periodic_update_cb, self);
+	periodic_update_start (self);
 
 	/* We'll get stage3 started when the supplicant connects */
 	ret = NM_ACT_STAGE_RETURN_POSTPONE;
@@ -2956,7 +3358,7 @@ device_state_changed (NMDevice *device,
 		if (priv->sup_iface)
 			supplicant_interface_release (self);
 
-		nm_clear_g_source (&priv->periodic_source_id);
+		periodic_update_stop (self);
 
 		cleanup_association_attempt (self, TRUE);
 		cleanup_supplicant_failures (self);
@@ -2988,6 +3390,9 @@ device_state_changed (NMDevice *device,
 		break;
 	case NM_DEVICE_STATE_ACTIVATED:
 		activation_success_handler (device);
+		/* activating updates the timestamp of the connection, by which
+		 * the hidden SSIDs are sorted. */
+		hidden_probe_list_invalidate (self);
 		break;
 	case NM_DEVICE_STATE_FAILED:
 		activation_failure_handler (device);
@@ -2995,7 +3400,7 @@ device_state_changed (NMDevice *device,
 	case NM_DEVICE_STATE_DISCONNECTED:
 		/* Kick off a scan to get latest results */
 		priv->scan_interval = SCAN_INTERVAL_MIN;
-		request_wireless_scan (self, FALSE, NULL);
+		request_wireless_scan (self, FALSE, FALSE, NULL);
 		break;
 	default:
 		break;
@@ -3159,7 +3564,12 @@ nm_device_wifi_init (NMDeviceWifi *self)
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 
 	priv->mode = NM_802_11_MODE_INFRA;
+	priv->scan_strength = -1;
 	priv->aps = g_hash_table_new (g_str_hash, g_str_equal);
+	priv->aps_by_supplicant_path = g_hash_table_new (g_str_hash, g_str_equal);
+	priv->aps_sorted = g_ptr_array_new ();
+	priv->aps_lost = g_hash_table_new (g_direct_hash, g_direct_equal);
+	priv->aps_frozen = g_hash_table_new (g_direct_hash, g_direct_equal);
 }
 
 static void
@@ -3175,6 +3585,16 @@ constructed (GObject *object)
 
 	/* Connect to the supplicant manager */
 	priv->sup_mgr = g_object_ref (nm_supplicant_manager_get ());
+
+	g_signal_connect_swapped (nm_device_get_settings ((NMDevice *) self),
+	                          NM_SETTINGS_SIGNAL_CONNECTION_ADDED,
+	                          G_CALLBACK (hidden_probe_list_invalidate), self);
+	g_signal_connect_swapped (nm_device_get_settings ((NMDevice *) self),
+	                          NM_SETTINGS_SIGNAL_CONNECTION_UPDATED,
+	                          G_CALLBACK (hidden_probe_list_invalidate), self);
+	g_signal_connect_swapped (nm_device_get_settings ((NMDevice *) self),
+	                          NM_SETTINGS_SIGNAL_CONNECTION_REMOVED,
+	                          G_CALLBACK (hidden_probe_list_invalidate), self);
 }
 
 NMDevice *
@@ -3196,7 +3616,14 @@ dispose (GObject *object)
 	NMDeviceWifi *self = NM_DEVICE_WIFI (object);
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 
-	nm_clear_g_source (&priv->periodic_source_id);
+	periodic_update_stop (self);
+
+	if (nm_device_get_settings ((NMDevice *) self)) {
+		g_signal_handlers_disconnect_by_func (nm_device_get_settings ((NMDevice *) self),
+		                                      G_CALLBACK (hidden_probe_list_invalidate),
+		                                      self);
+	}
+	hidden_probe_list_invalidate (self);
 
 	wifi_secrets_cancel (self);
 
@@ -3206,6 +3633,7 @@ dispose (GObject *object)
 
 	g_clear_object (&priv->sup_mgr);
 
+	nm_clear_g_source (&priv->aps_lost_cull_id);
 	remove_all_aps (self);
 
 	G_OBJECT_CLASS (nm_device_wifi_parent_class)->dispose (object);
@@ -3218,8 +3646,17 @@ finalize (GObject *object)
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 
 	nm_assert (g_hash_table_size (priv->aps) == 0);
+	nm_assert (g_hash_table_size (priv->aps_by_supplicant_path) == 0);
+	nm_assert (priv->aps_sorted->len == 0);
+	nm_assert (g_hash_table_size (priv->aps_lost) == 0);
+	nm_assert (g_hash_table_size (priv->aps_frozen) == 0);
 
 	g_hash_table_unref (priv->aps);
+	g_hash_table_unref (priv->aps_by_supplicant_path);
+	g_ptr_array_unref (priv->aps_sorted);
+	g_hash_table_unref (priv->aps_lost);
+	g_hash_table_unref (priv->aps_frozen);
+	ap_list_changed (self);
 
 	g_free (priv->hw_addr_scan);
 
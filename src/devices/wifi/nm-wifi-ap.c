@@ -97,6 +97,23 @@ nm_wifi_ap_get_supplicant_path (NMWifiAP *ap)
 	return NM_WIFI_AP_GET_PRIVATE (ap)->supplicant_path;
 }
 
+gboolean
+nm_wifi_ap_set_supplicant_path (NMWifiAP *ap, const char *supplicant_path)
+{
+	NMWifiAPPrivate *priv;
+
+	g_return_val_if_fail (NM_IS_WIFI_AP (ap), FALSE);
+
+	priv = NM_WIFI_AP_GET_PRIVATE (ap);
+
+	if (!nm_streq0 (priv->supplicant_path, supplicant_path)) {
+		g_free (priv->supplicant_path);
+		priv->supplicant_path = g_strdup (supplicant_path);
+		return TRUE;
+	}
+	return FALSE;
+}
+
 guint64
 nm_wifi_ap_get_id (NMWifiAP *ap)
 {
@@ -1084,5 +1101,9 @@ nm_wifi_ap_class_init (NMWifiAPClass *ap_class)
 	nm_exported_object_class_add_interface (NM_EXPORTED_OBJECT_CLASS (ap_class),
 	                                        NMDBUS_TYPE_ACCESS_POINT_SKELETON,
 	                                        NULL);
+	nm_exported_object_class_rate_limit_properties (NM_EXPORTED_OBJECT_CLASS (ap_class),
+	                                                "Strength",
+	                                                "LastSeen",
+	                                                NULL);
 }
 
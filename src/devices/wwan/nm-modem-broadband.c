@@ -82,6 +82,7 @@ typedef struct {
 	MMModem *modem_iface;
 	MMModemSimple *simple_iface;
 	MMSim *sim_iface;
+	GCancellable *sim_cancellable;
 
 	/* Connection setup */
 	ConnectContext *ctx;
@@ -1248,8 +1249,15 @@ get_sim_ready (MMModem *modem,
 	GError *error = NULL;
 	MMSim *new_sim;
 
-
 	new_sim = mm_modem_get_sim_finish (modem, res, &error);
+	if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		/* superseded by a newer request, or disposing. */
+		g_clear_error (&error);
+		g_object_unref (self);
+		return;
+	}
+	g_clear_object (&self->_priv.sim_cancellable);
+
 	if (new_sim != self->_priv.sim_iface) {
 		g_clear_object (&self->_priv.sim_iface);
 		self->_priv.sim_iface = new_sim;
@@ -1279,19 +1287,37 @@ static void
 sim_changed (MMModem *modem, GParamSpec *pspec, gpointer user_data)
 {
 	NMModemBroadband *self = NM_MODEM_BROADBAND (user_data);
+	const char *sim_path;
 
 	g_return_if_fail (modem == self->_priv.modem_iface);
 
-	if (mm_modem_get_sim_path (self->_priv.modem_iface)) {
+	sim_path = mm_modem_get_sim_path (self->_priv.modem_iface);
+
+	/* Creating the SIM object costs a round-trip to fetch its properties.
+	 * ModemManager also announces the property when it didn't change,
+	 * so keep the SIM object we have as long as the path is the same. The
+	 * object's properties are kept up to date with change notifications. */
+	if (   sim_path
+	    && self->_priv.sim_iface
+	    && !self->_priv.sim_cancellable
+	    && nm_streq0 (sim_path, mm_sim_get_path (self->_priv.sim_iface)))
+		return;
+
+	nm_clear_g_cancellable (&self->_priv.sim_cancellable);
+
+	if (sim_path) {
+		self->_priv.sim_cancellable = g_cancellable_new ();
 		mm_modem_get_sim (self->_priv.modem_iface,
-		                  NULL,  /* cancellable */
+		                  self->_priv.sim_cancellable,
 		                  (GAsyncReadyCallback) get_sim_ready,
 		                  g_object_ref (self));
-	} else
+	} else {
+		g_clear_object (&self->_priv.sim_iface);
 		g_object_set (G_OBJECT (self),
 		              NM_MODEM_SIM_ID, NULL,
 		              NM_MODEM_SIM_OPERATOR_ID, NULL,
 		              NULL);
+	}
 }
 
 static void
@@ -1416,6 +1442,7 @@ dispose (GObject *object)
 	g_clear_object (&self->_priv.bearer);
 	g_clear_object (&self->_priv.modem_iface);
 	g_clear_object (&self->_priv.simple_iface);
+	nm_clear_g_cancellable (&self->_priv.sim_cancellable);
 	g_clear_object (&self->_priv.sim_iface);
 	g_clear_object (&self->_priv.modem_object);
 
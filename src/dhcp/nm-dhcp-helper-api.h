@@ -33,4 +33,26 @@
 
 /*****************************************************************************/
 
+/* Besides the D-Bus interface above, the helper can report an event to
+ * NetworkManager over a plain unix socket of type SOCK_SEQPACKET, which
+ * avoids the D-Bus authentication and marshalling.
+ *
+ * An event is one message: the magic as a guint32, followed by the
+ * options. Each option is a NMDhcpHelperEventOption header followed by
+ * @name_len bytes of the name and @value_len bytes of the value, neither
+ * NUL terminated. All integers are in host byte order. Once the event
+ * is handled, the server acknowledges it by sending back one byte. */
+
+#define NM_DHCP_HELPER_EVENT_SOCKET_PATH        NMRUNDIR "/private-dhcp-event"
+#define NM_DHCP_HELPER_EVENT_MAGIC              0x4e4d4431u
+#define NM_DHCP_HELPER_EVENT_MAX_SIZE           (64 * 1024)
+
+typedef struct {
+	guint16 name_len;
+	guint16 _reserved;
+	guint32 value_len;
+} NMDhcpHelperEventOption;
+
+/*****************************************************************************/
+
 #endif /* __NM_DHCP_HELPER_API_H__ */
@@ -24,6 +24,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <signal.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 #include "nm-utils/nm-vpn-plugin-macros.h"
 
@@ -64,6 +67,33 @@
 
 static const char * ignore[] = {"PATH", "SHLVL", "_", "PWD", "dhc_dbus", NULL};
 
+static gboolean
+split_environ_item (const char *item, char **out_name, const char **out_val)
+{
+	char *name, *val, **p;
+
+	/* Split on the = */
+	name = g_strdup (item);
+	val = strchr (name, '=');
+	if (!val || val == name)
+		goto ignore;
+	*val++ = '\0';
+
+	/* Ignore non-DCHP-related environment variables */
+	for (p = (char **) ignore; *p; p++) {
+		if (strncmp (name, *p, strlen (*p)) == 0)
+			goto ignore;
+	}
+
+	*out_name = name;
+	*out_val = val;
+	return TRUE;
+
+ignore:
+	g_free (name);
+	return FALSE;
+}
+
 static GVariant *
 build_signal_parameters (void)
 {
@@ -74,20 +104,11 @@ build_signal_parameters (void)
 
 	/* List environment and format for dbus dict */
 	for (item = environ; *item; item++) {
-		char *name, *val, **p;
-
-		/* Split on the = */
-		name = g_strdup (*item);
-		val = strchr (name, '=');
-		if (!val || val == name)
-			goto next;
-		*val++ = '\0';
-
-		/* Ignore non-DCHP-related environment variables */
-		for (p = (char **) ignore; *p; p++) {
-			if (strncmp (name, *p, strlen (*p)) == 0)
-				goto next;
-		}
+		char *name;
+		const char *val;
+
+		if (!split_environ_item (*item, &name, &val))
+			continue;
 
 		/* Value passed as a byte array rather than a string, because there are
 		 * no character encoding guarantees with DHCP, and D-Bus requires
@@ -100,14 +121,104 @@ build_signal_parameters (void)
 		                       name,
 		                       g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE,
 		                                                  val, strlen (val), 1));
-
-	next:
 		g_free (name);
 	}
 
 	return g_variant_ref_sink (g_variant_new ("(a{sv})", &builder));
 }
 
+static GArray *
+build_event_message (void)
+{
+	GArray *msg;
+	char **item;
+	guint32 magic = NM_DHCP_HELPER_EVENT_MAGIC;
+
+	msg = g_array_sized_new (FALSE, FALSE, 1, 4096);
+	g_array_append_vals (msg, &magic, sizeof (magic));
+
+	for (item = environ; *item; item++) {
+		NMDhcpHelperEventOption option = { 0 };
+		gs_free char *name = NULL;
+		const char *val;
+		gsize name_len, value_len;
+
+		if (!split_environ_item (*item, &name, &val))
+			continue;
+
+		name_len = strlen (name);
+		value_len = strlen (val);
+		if (name_len > G_MAXUINT16)
+			continue;
+
+		option.name_len = name_len;
+		option.value_len = value_len;
+		g_array_append_vals (msg, &option, sizeof (option));
+		g_array_append_vals (msg, name, name_len);
+		g_array_append_vals (msg, val, value_len);
+	}
+
+	return msg;
+}
+
+static gboolean
+notify_event_socket (GError **error)
+{
+	struct sockaddr_un addr = {
+		.sun_family = AF_UNIX,
+		.sun_path = NM_DHCP_HELPER_EVENT_SOCKET_PATH,
+	};
+	struct timeval tv = { .tv_sec = 1 };
+	nm_auto_close int fd = -1;
+	gs_unref_array GArray *msg = NULL;
+	char ack;
+	ssize_t r;
+	int errsv;
+
+	msg = build_event_message ();
+	if (msg->len > NM_DHCP_HELPER_EVENT_MAX_SIZE) {
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_MESSAGE_TOO_LARGE,
+		             "event too large (%u bytes)", msg->len);
+		return FALSE;
+	}
+
+	fd = socket (AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		goto fail;
+
+	if (setsockopt (fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof (tv)) < 0)
+		goto fail;
+
+	if (connect (fd, (struct sockaddr *) &addr, sizeof (addr)) < 0)
+		goto fail;
+
+	do {
+		r = send (fd, msg->data, msg->len, MSG_NOSIGNAL);
+	} while (r < 0 && errno == EINTR);
+	if (r < 0)
+		goto fail;
+
+	/* wait until NetworkManager handled the event */
+	do {
+		r = recv (fd, &ack, sizeof (ack), 0);
+	} while (r < 0 && errno == EINTR);
+	if (r < 0)
+		goto fail;
+	if (r == 0) {
+		g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_CONNECTION_CLOSED,
+		                     "connection closed before the event was acknowledged");
+		return FALSE;
+	}
+
+	return TRUE;
+
+fail:
+	errsv = errno;
+	g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+	             "%s", g_strerror (errsv));
+	return FALSE;
+}
+
 static void
 kill_pid (void)
 {
@@ -136,6 +247,16 @@ main (int argc, char *argv[])
 
 	nm_g_type_init ();
 
+	if (notify_event_socket (&error)) {
+		success = TRUE;
+		goto out;
+	}
+
+	/* fall back to D-Bus, for example when notifying an older server
+	 * while upgrading the NetworkManager package. */
+	_LOGi ("could not notify via event socket: %s (try D-Bus)", error->message);
+	g_clear_error (&error);
+
 	/* FIXME: g_dbus_connection_new_for_address_sync() tries to connect to the socket in
 	 * non-blocking mode, which can easily fail with EAGAIN, causing the creation of the
 	 * socket to fail with "Could not connect: Resource temporarily unavailable".
@@ -22,6 +22,8 @@
 #include "nm-dhcp-listener.h"
 
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 #include <sys/wait.h>
 #include <signal.h>
 #include <string.h>
@@ -60,6 +62,11 @@ typedef struct {
 	gulong              new_conn_id;
 	gulong              dis_conn_id;
 	GHashTable *        connections;
+
+	int                 event_fd;
+	GIOChannel *        event_channel;
+	guint               event_id;
+	GSList *            event_clients;
 } NMDhcpListenerPrivate;
 
 struct _NMDhcpListener {
@@ -135,31 +142,13 @@ get_option (GVariant *options, const char *key)
 }
 
 static void
-_method_call (GDBusConnection *connection,
-              const char *sender,
-              const char *object_path,
-              const char *interface_name,
-              const char *method_name,
-              GVariant *parameters,
-              GDBusMethodInvocation *invocation,
-              gpointer user_data)
+handle_event (NMDhcpListener *self, GVariant *options)
 {
-	NMDhcpListener *self = NM_DHCP_LISTENER (user_data);
 	char *iface = NULL;
 	char *pid_str = NULL;
 	char *reason = NULL;
 	gint pid;
 	gboolean handled = FALSE;
-	GVariant *options;
-
-	if (!nm_streq0 (interface_name, NM_DHCP_HELPER_SERVER_INTERFACE_NAME))
-		g_return_if_reached ();
-	if (!nm_streq0 (method_name, NM_DHCP_HELPER_SERVER_METHOD_NOTIFY))
-		g_return_if_reached ();
-	if (!g_variant_is_of_type (parameters, G_VARIANT_TYPE ("(a{sv})")))
-		g_return_if_reached ();
-
-	g_variant_get (parameters, "(@a{sv})", &options);
 
 	iface = get_option (options, "interface");
 	if (iface == NULL) {
@@ -193,7 +182,30 @@ out:
 	g_free (iface);
 	g_free (pid_str);
 	g_free (reason);
-	g_variant_unref (options);
+}
+
+static void
+_method_call (GDBusConnection *connection,
+              const char *sender,
+              const char *object_path,
+              const char *interface_name,
+              const char *method_name,
+              GVariant *parameters,
+              GDBusMethodInvocation *invocation,
+              gpointer user_data)
+{
+	NMDhcpListener *self = NM_DHCP_LISTENER (user_data);
+	gs_unref_variant GVariant *options = NULL;
+
+	if (!nm_streq0 (interface_name, NM_DHCP_HELPER_SERVER_INTERFACE_NAME))
+		g_return_if_reached ();
+	if (!nm_streq0 (method_name, NM_DHCP_HELPER_SERVER_METHOD_NOTIFY))
+		g_return_if_reached ();
+	if (!g_variant_is_of_type (parameters, G_VARIANT_TYPE ("(a{sv})")))
+		g_return_if_reached ();
+
+	g_variant_get (parameters, "(@a{sv})", &options);
+	handle_event (self, options);
 	g_dbus_method_invocation_return_value (invocation, NULL);
 }
 
@@ -287,6 +299,198 @@ dis_connection_cb (NMBusManager *mgr,
 
 /*****************************************************************************/
 
+typedef struct {
+	NMDhcpListener *listener;
+	int fd;
+	GIOChannel *channel;
+	guint id;
+} EventClient;
+
+static void
+event_client_free (EventClient *client)
+{
+	nm_clear_g_source (&client->id);
+	g_io_channel_unref (client->channel);
+	close (client->fd);
+	g_slice_free (EventClient, client);
+}
+
+static GVariant *
+event_message_parse (const guint8 *data, gsize len)
+{
+	GVariantBuilder builder;
+	NMDhcpHelperEventOption option;
+	guint32 magic;
+	gsize pos;
+
+	if (len < sizeof (magic))
+		return NULL;
+	memcpy (&magic, data, sizeof (magic));
+	if (magic != NM_DHCP_HELPER_EVENT_MAGIC)
+		return NULL;
+
+	/* build the same dictionary as the helper sends via D-Bus */
+	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+	for (pos = sizeof (magic); pos < len; ) {
+		gs_free char *name = NULL;
+
+		if (len - pos < sizeof (option))
+			goto fail;
+		memcpy (&option, &data[pos], sizeof (option));
+		pos += sizeof (option);
+
+		if (   !option.name_len
+		    || len - pos < (gsize) option.name_len + option.value_len)
+			goto fail;
+
+		name = g_strndup ((const char *) &data[pos], option.name_len);
+		pos += option.name_len;
+		if (strlen (name) != option.name_len)
+			goto fail;
+
+		g_variant_builder_add (&builder, "{sv}",
+		                       name,
+		                       g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE,
+		                                                  &data[pos], option.value_len, 1));
+		pos += option.value_len;
+	}
+
+	return g_variant_ref_sink (g_variant_builder_end (&builder));
+
+fail:
+	g_variant_builder_clear (&builder);
+	return NULL;
+}
+
+static gboolean
+event_client_receive_cb (GIOChannel *channel, GIOCondition condition, gpointer user_data)
+{
+	EventClient *client = user_data;
+	NMDhcpListener *self = client->listener;
+	NMDhcpListenerPrivate *priv = NM_DHCP_LISTENER_GET_PRIVATE (self);
+	gs_free guint8 *buf = NULL;
+	gs_unref_variant GVariant *options = NULL;
+	const char ack = 0;
+	ssize_t len;
+
+	buf = g_malloc (NM_DHCP_HELPER_EVENT_MAX_SIZE);
+	do {
+		len = recv (client->fd, buf, NM_DHCP_HELPER_EVENT_MAX_SIZE, MSG_TRUNC);
+	} while (len < 0 && errno == EINTR);
+
+	if (len < 0 && errno == EAGAIN)
+		return G_SOURCE_CONTINUE;
+
+	if (len > NM_DHCP_HELPER_EVENT_MAX_SIZE)
+		_LOGW ("dhcp-event: message of %zd bytes is too large", len);
+	else if (len > 0) {
+		options = event_message_parse (buf, len);
+		if (options) {
+			handle_event (self, options);
+			if (send (client->fd, &ack, sizeof (ack), MSG_NOSIGNAL | MSG_DONTWAIT) < 0)
+				_LOGD ("dhcp-event: failure to acknowledge event: %s", g_strerror (errno));
+		} else
+			_LOGW ("dhcp-event: invalid message");
+	}
+
+	/* one event per connection */
+	client->id = 0;
+	priv->event_clients = g_slist_remove (priv->event_clients, client);
+	event_client_free (client);
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean
+event_accept_cb (GIOChannel *channel, GIOCondition condition, gpointer user_data)
+{
+	NMDhcpListener *self = user_data;
+	NMDhcpListenerPrivate *priv = NM_DHCP_LISTENER_GET_PRIVATE (self);
+	EventClient *client;
+	struct ucred cred;
+	socklen_t cred_len;
+	int fd;
+
+	for (;;) {
+		fd = accept4 (priv->event_fd, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
+		if (fd < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+
+		/* like the private D-Bus socket, only accept root */
+		cred_len = sizeof (cred);
+		if (   getsockopt (fd, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len) < 0
+		    || cred.uid != 0) {
+			_LOGW ("dhcp-event: rejecting connection from non-root peer");
+			close (fd);
+			continue;
+		}
+
+		client = g_slice_new0 (EventClient);
+		client->listener = self;
+		client->fd = fd;
+		client->channel = g_io_channel_unix_new (fd);
+		client->id = g_io_add_watch (client->channel, G_IO_IN | G_IO_HUP | G_IO_ERR,
+		                             event_client_receive_cb, client);
+		priv->event_clients = g_slist_prepend (priv->event_clients, client);
+	}
+
+	return G_SOURCE_CONTINUE;
+}
+
+static void
+event_socket_open (NMDhcpListener *self)
+{
+	NMDhcpListenerPrivate *priv = NM_DHCP_LISTENER_GET_PRIVATE (self);
+	struct sockaddr_un addr = {
+		.sun_family = AF_UNIX,
+		.sun_path = NM_DHCP_HELPER_EVENT_SOCKET_PATH,
+	};
+	int errsv;
+
+	priv->event_fd = socket (AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+	if (priv->event_fd < 0) {
+		errsv = errno;
+		_LOGW ("failure to create event socket: %s", g_strerror (errsv));
+		return;
+	}
+
+	unlink (NM_DHCP_HELPER_EVENT_SOCKET_PATH);
+	if (   bind (priv->event_fd, (struct sockaddr *) &addr, sizeof (addr)) < 0
+	    || chmod (NM_DHCP_HELPER_EVENT_SOCKET_PATH, 0600) < 0
+	    || listen (priv->event_fd, 32) < 0) {
+		errsv = errno;
+		_LOGW ("failure to set up event socket %s: %s",
+		       NM_DHCP_HELPER_EVENT_SOCKET_PATH, g_strerror (errsv));
+		close (priv->event_fd);
+		priv->event_fd = -1;
+		return;
+	}
+
+	priv->event_channel = g_io_channel_unix_new (priv->event_fd);
+	priv->event_id = g_io_add_watch (priv->event_channel, G_IO_IN, event_accept_cb, self);
+}
+
+static void
+event_socket_close (NMDhcpListener *self)
+{
+	NMDhcpListenerPrivate *priv = NM_DHCP_LISTENER_GET_PRIVATE (self);
+
+	g_slist_free_full (priv->event_clients, (GDestroyNotify) event_client_free);
+	priv->event_clients = NULL;
+
+	nm_clear_g_source (&priv->event_id);
+	g_clear_pointer (&priv->event_channel, g_io_channel_unref);
+	if (priv->event_fd >= 0) {
+		close (priv->event_fd);
+		priv->event_fd = -1;
+		unlink (NM_DHCP_HELPER_EVENT_SOCKET_PATH);
+	}
+}
+
+/*****************************************************************************/
+
 static void
 nm_dhcp_listener_init (NMDhcpListener *self)
 {
@@ -298,7 +502,7 @@ nm_dhcp_listener_init (NMDhcpListener *self)
 	priv->dbus_mgr = nm_bus_manager_get ();
 
 	/* Register the socket our DHCP clients will return lease info on */
-	nm_bus_manager_private_server_register (priv->dbus_mgr, PRIV_SOCK_PATH, PRIV_SOCK_TAG);
+	nm_bus_manager_private_server_register (priv->dbus_mgr, PRIV_SOCK_PATH, PRIV_SOCK_TAG, FALSE);
 	priv->new_conn_id = g_signal_connect (priv->dbus_mgr,
 	                                      NM_BUS_MANAGER_PRIVATE_CONNECTION_NEW "::" PRIV_SOCK_TAG,
 	                                      G_CALLBACK (new_connection_cb),
@@ -307,6 +511,10 @@ nm_dhcp_listener_init (NMDhcpListener *self)
 	                                      NM_BUS_MANAGER_PRIVATE_CONNECTION_DISCONNECTED "::" PRIV_SOCK_TAG,
 	                                      G_CALLBACK (dis_connection_cb),
 	                                      self);
+
+	/* and the lightweight event socket, which the helper tries first */
+	priv->event_fd = -1;
+	event_socket_open (self);
 }
 
 static void
@@ -320,6 +528,8 @@ dispose (GObject *object)
 
 	g_clear_pointer (&priv->connections, g_hash_table_destroy);
 
+	event_socket_close ((NMDhcpListener *) object);
+
 	G_OBJECT_CLASS (nm_dhcp_listener_parent_class)->dispose (object);
 }
 
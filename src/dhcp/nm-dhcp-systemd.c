@@ -27,6 +27,7 @@
 #include <arpa/inet.h>
 #include <ctype.h>
 #include <net/if_arp.h>
+#include <sys/stat.h>
 
 #include "nm-utils.h"
 #include "nm-dhcp-utils.h"
@@ -55,6 +56,7 @@ typedef struct {
 	sd_dhcp_client *client4;
 	sd_dhcp6_client *client6;
 	char *lease_file;
+	guint optimistic_id;
 
 	guint request_count;
 
@@ -96,6 +98,10 @@ G_DEFINE_TYPE (NMDhcpSystemd, nm_dhcp_systemd, NM_TYPE_DHCP_CLIENT)
 #define DHCP6_OPTION_REBIND          1033
 #define DHCP6_OPTION_IAID            1034
 
+/* a saved lease is used before the server confirmed it only if it is
+ * valid for at least this many more seconds. */
+#define OPTIMISTIC_LEASE_MIN_LIFETIME 60
+
 typedef struct {
 	guint num;
 	const char *name;
@@ -220,6 +226,7 @@ static NMIP4Config *
 lease_to_ip4_config (const char *iface,
                      int ifindex,
                      sd_dhcp_lease *lease,
+                     guint32 lease_age,
                      GHashTable *options,
                      guint32 default_priority,
                      gboolean log_lease,
@@ -266,6 +273,7 @@ lease_to_ip4_config (const char *iface,
 
 	/* Lease time */
 	sd_dhcp_lease_get_lifetime (lease, &lifetime);
+	lifetime = lifetime > lease_age ? lifetime - lease_age : 0;
 	address.timestamp = nm_utils_get_monotonic_timestamp_s ();
 	address.lifetime = address.preferred = lifetime;
 	end_time = (guint64) time (NULL) + lifetime;
@@ -442,7 +450,7 @@ nm_dhcp_systemd_get_lease_ip_configs (const char *iface,
 	path = get_leasefile_path (iface, uuid, FALSE);
 	r = dhcp_lease_load (&lease, path);
 	if (r == 0 && lease) {
-		ip4_config = lease_to_ip4_config (iface, ifindex, lease, NULL, default_route_metric, FALSE, NULL);
+		ip4_config = lease_to_ip4_config (iface, ifindex, lease, 0, NULL, default_route_metric, FALSE, NULL);
 		if (ip4_config)
 			leases = g_slist_append (leases, ip4_config);
 		sd_dhcp_lease_unref (lease);
@@ -486,6 +494,8 @@ bound4_handle (NMDhcpSystemd *self)
 	GError *error = NULL;
 	int r;
 
+	nm_clear_g_source (&priv->optimistic_id);
+
 	r = sd_dhcp_client_get_lease (priv->client4, &lease);
 	if (r < 0 || !lease) {
 		_LOGW ("no lease!");
@@ -499,6 +509,7 @@ bound4_handle (NMDhcpSystemd *self)
 	ip4_config = lease_to_ip4_config (iface,
 	                                  nm_dhcp_client_get_ifindex (NM_DHCP_CLIENT (self)),
 	                                  lease,
+	                                  0,
 	                                  options,
 	                                  nm_dhcp_client_get_priority (NM_DHCP_CLIENT (self)),
 	                                  TRUE,
@@ -557,6 +568,100 @@ dhcp_event_cb (sd_dhcp_client *client, int event, gpointer user_data)
 	}
 }
 
+static gboolean
+lease_file_get_age (const char *path, guint32 *out_age)
+{
+	struct stat st;
+	time_t now;
+
+	/* the lease file is rewritten on every renewal, so its modification
+	 * time is when the lease was last acknowledged. */
+	if (stat (path, &st) != 0)
+		return FALSE;
+
+	now = time (NULL);
+	if (st.st_mtime > now)
+		return FALSE;
+
+	*out_age = MIN (now - st.st_mtime, (time_t) G_MAXUINT32);
+	return TRUE;
+}
+
+static gboolean
+lease_matches_request (sd_dhcp_lease *lease,
+                       const struct in_addr *address,
+                       GBytes *client_id)
+{
+	struct in_addr lease_addr = { 0 };
+	const void *lease_client_id = NULL;
+	size_t lease_client_id_len = 0;
+
+	if (   sd_dhcp_lease_get_address (lease, &lease_addr) < 0
+	    || lease_addr.s_addr != address->s_addr)
+		return FALSE;
+
+	if (!client_id)
+		return TRUE;
+
+	if (   sd_dhcp_lease_get_client_id (lease, &lease_client_id, &lease_client_id_len) < 0
+	    || !lease_client_id_len)
+		return FALSE;
+
+	return    g_bytes_get_size (client_id) == lease_client_id_len
+	       && memcmp (g_bytes_get_data (client_id, NULL), lease_client_id, lease_client_id_len) == 0;
+}
+
+static gboolean
+optimistic_lease_cb (gpointer user_data)
+{
+	NMDhcpSystemd *self = user_data;
+	NMDhcpSystemdPrivate *priv = NM_DHCP_SYSTEMD_GET_PRIVATE (self);
+	const char *iface = nm_dhcp_client_get_iface (NM_DHCP_CLIENT (self));
+	gs_unref_hashtable GHashTable *options = NULL;
+	gs_unref_object NMIP4Config *ip4_config = NULL;
+	sd_dhcp_lease *lease = NULL;
+	guint32 lifetime = 0, age;
+
+	priv->optimistic_id = 0;
+
+	if (   dhcp_lease_load (&lease, priv->lease_file) != 0
+	    || !lease)
+		return G_SOURCE_REMOVE;
+
+	sd_dhcp_lease_get_lifetime (lease, &lifetime);
+	if (   !lease_file_get_age (priv->lease_file, &age)
+	    || lifetime < age
+	    || lifetime - age < OPTIMISTIC_LEASE_MIN_LIFETIME) {
+		sd_dhcp_lease_unref (lease);
+		return G_SOURCE_REMOVE;
+	}
+
+	options = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+	ip4_config = lease_to_ip4_config (iface,
+	                                  nm_dhcp_client_get_ifindex (NM_DHCP_CLIENT (self)),
+	                                  lease,
+	                                  age,
+	                                  options,
+	                                  nm_dhcp_client_get_priority (NM_DHCP_CLIENT (self)),
+	                                  FALSE,
+	                                  NULL);
+	sd_dhcp_lease_unref (lease);
+	if (!ip4_config)
+		return G_SOURCE_REMOVE;
+
+	/* RFC 2131, 3.2: the client may keep using an unexpired lease while
+	 * it verifies it with INIT-REBOOT. If the server NAKs, the client
+	 * restarts and the new lease replaces this configuration. */
+	_LOGI ("using saved lease, valid for %u more seconds, until the server confirms it",
+	       lifetime - age);
+	add_requests_to_options (options, dhcp4_requests);
+	nm_dhcp_client_set_state (NM_DHCP_CLIENT (self),
+	                          NM_DHCP_STATE_BOUND,
+	                          G_OBJECT (ip4_config),
+	                          options);
+	return G_SOURCE_REMOVE;
+}
+
 static guint16
 get_arp_type (const GByteArray *hwaddr)
 {
@@ -721,6 +826,15 @@ ip4_start (NMDhcpClient *client, const char *dhcp_anycast_addr, const char *last
 
 	nm_dhcp_client_start_timeout (client);
 
+	/* With a saved lease for the requested address, and the same client
+	 * identifier, the client starts in INIT-REBOOT. Configure the lease
+	 * right away instead of waiting for the server's answer. The state
+	 * change is reported from idle, after the caller connected to it. */
+	if (   lease
+	    && last_addr.s_addr
+	    && lease_matches_request (lease, &last_addr, override_client_id))
+		priv->optimistic_id = g_idle_add (optimistic_lease_cb, self);
+
 	success = TRUE;
 
 error:
@@ -1008,6 +1122,8 @@ stop (NMDhcpClient *client, gboolean release, const GByteArray *duid)
 	       priv->client4 ? '4' : '6',
 	       priv->client4 ? (gpointer) priv->client4 : (gpointer) priv->client6);
 
+	nm_clear_g_source (&priv->optimistic_id);
+
 	if (priv->client4) {
 		sd_dhcp_client_set_callback (priv->client4, NULL, NULL);
 		r = sd_dhcp_client_stop (priv->client4);
@@ -1032,6 +1148,7 @@ dispose (GObject *object)
 {
 	NMDhcpSystemdPrivate *priv = NM_DHCP_SYSTEMD_GET_PRIVATE ((NMDhcpSystemd *) object);
 
+	nm_clear_g_source (&priv->optimistic_id);
 	g_clear_pointer (&priv->lease_file, g_free);
 
 	if (priv->client4) {
@@ -53,6 +53,9 @@ typedef struct {
 	gboolean running;
 
 	GVariant *set_server_ex_args;
+
+	/* checksum of the files in CONFDIR when dnsmasq was started */
+	char *conf_checksum;
 } NMDnsDnsmasqPrivate;
 
 struct _NMDnsDnsmasq {
@@ -474,6 +477,44 @@ dnsmasq_proxy_cb (GObject *source, GAsyncResult *res, gpointer user_data)
 		send_dnsmasq_update (self);
 }
 
+/* Returns a checksum of the names and contents of the files in CONFDIR,
+ * or NULL if the directory doesn't exist. */
+static char *
+conf_dir_checksum (void)
+{
+	gs_unref_ptrarray GPtrArray *names = NULL;
+	GChecksum *sum;
+	GDir *dir;
+	const char *name;
+	char *result;
+	guint i;
+
+	dir = g_dir_open (CONFDIR, 0, NULL);
+	if (!dir)
+		return NULL;
+
+	names = g_ptr_array_new_with_free_func (g_free);
+	while ((name = g_dir_read_name (dir)))
+		g_ptr_array_add (names, g_strdup (name));
+	g_dir_close (dir);
+	g_ptr_array_sort (names, nm_strcmp_p);
+
+	sum = g_checksum_new (G_CHECKSUM_SHA1);
+	for (i = 0; i < names->len; i++) {
+		gs_free char *path = g_build_filename (CONFDIR, names->pdata[i], NULL);
+		gs_free char *contents = NULL;
+		gsize len = 0;
+
+		g_checksum_update (sum, names->pdata[i], strlen (names->pdata[i]) + 1);
+		if (g_file_get_contents (path, &contents, &len, NULL))
+			g_checksum_update (sum, (const guchar *) contents, len);
+		g_checksum_update (sum, (const guchar *) "", 1);
+	}
+	result = g_strdup (g_checksum_get_string (sum));
+	g_checksum_free (sum);
+	return result;
+}
+
 static void
 start_dnsmasq (NMDnsDnsmasq *self)
 {
@@ -523,6 +564,9 @@ start_dnsmasq (NMDnsDnsmasq *self)
 	nm_assert (idx <= G_N_ELEMENTS (argv));
 
 	/* And finally spawn dnsmasq */
+	g_free (priv->conf_checksum);
+	priv->conf_checksum = conf_dir_checksum ();
+
 	pid = nm_dns_plugin_child_spawn (NM_DNS_PLUGIN (self), argv, PIDFILE, "bin/dnsmasq");
 	if (!pid)
 		return;
@@ -617,6 +661,26 @@ child_quit (NMDnsPlugin *plugin, gint status)
 
 /*****************************************************************************/
 
+static gboolean
+reload (NMDnsPlugin *plugin)
+{
+	NMDnsDnsmasq *self = NM_DNS_DNSMASQ (plugin);
+	NMDnsDnsmasqPrivate *priv = NM_DNS_DNSMASQ_GET_PRIVATE (self);
+	gs_free char *checksum = NULL;
+
+	/* the nameservers are updated via D-Bus. Only the options from
+	 * CONFDIR require to start dnsmasq again. */
+	if (nm_dns_plugin_child_pid (plugin) <= 0)
+		return TRUE;
+
+	checksum = conf_dir_checksum ();
+	if (!nm_streq0 (checksum, priv->conf_checksum)) {
+		_LOGD ("configuration in %s changed", CONFDIR);
+		return FALSE;
+	}
+	return TRUE;
+}
+
 static gboolean
 is_caching (NMDnsPlugin *plugin)
 {
@@ -653,6 +717,7 @@ dispose (GObject *object)
 	g_clear_object (&priv->dnsmasq);
 
 	g_clear_pointer (&priv->set_server_ex_args, g_variant_unref);
+	g_clear_pointer (&priv->conf_checksum, g_free);
 
 	G_OBJECT_CLASS (nm_dns_dnsmasq_parent_class)->dispose (object);
 }
@@ -669,4 +734,5 @@ nm_dns_dnsmasq_class_init (NMDnsDnsmasqClass *dns_class)
 	plugin_class->is_caching = is_caching;
 	plugin_class->update = update;
 	plugin_class->get_name = get_name;
+	plugin_class->reload = reload;
 }
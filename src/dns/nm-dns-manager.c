@@ -52,7 +52,9 @@
 #include "nm-dns-plugin.h"
 #include "nm-dns-dnsmasq.h"
 #include "nm-dns-systemd-resolved.h"
+#include "nm-dns-stub.h"
 #include "nm-dns-unbound.h"
+#include "nm-trace.h"
 
 #include "introspection/org.freedesktop.NetworkManager.DnsManager.h"
 
@@ -70,6 +72,9 @@
 #define PLUGIN_RATELIMIT_BURST       5
 #define PLUGIN_RATELIMIT_DELAY       300
 
+/* default for main.dns-update-interval, in milliseconds */
+#define UPDATE_INTERVAL_DEFAULT      200
+
 enum {
 	CONFIG_CHANGED,
 
@@ -131,6 +136,23 @@ typedef struct {
 	guint8 hash[HASH_LEN];  /* SHA1 hash of current DNS config */
 	guint8 prev_hash[HASH_LEN];  /* Hash when begin_updates() was called */
 
+	/* SHA1 hash of the data last pushed to the plugin */
+	guint8 plugin_hash[HASH_LEN];
+	bool plugin_hash_valid:1;
+
+	/* the data last handed to resolvconf or netconfig */
+	char *spawn_content;
+
+	struct {
+		guint id;
+		gint64 last_ts;
+
+		/* the number of updates that were coalesced or found
+		 * unchanged, for logging. */
+		guint num_coalesced;
+		guint num_suppressed;
+	} update;
+
 	NMDnsManagerResolvConfManager rc_manager;
 	char *mode;
 	NMDnsPlugin *plugin;
@@ -142,6 +164,10 @@ typedef struct {
 		guint num_restarts;
 		guint timer;
 	} plugin_ratelimit;
+
+	/* how often the plugin had to be restarted, after its child
+	 * quit or because it couldn't reload the configuration. */
+	guint num_plugin_restarts;
 } NMDnsManagerPrivate;
 
 struct _NMDnsManager {
@@ -688,6 +714,15 @@ _read_link_cached (const char *path, gboolean *is_cached, char **cached)
 #define MY_RESOLV_CONF_TMP MY_RESOLV_CONF ".tmp"
 #define RESOLV_CONF_TMP "/etc/.resolv.conf.NetworkManager"
 
+static gboolean
+_file_has_content (const char *path, const char *content)
+{
+	gs_free char *existing = NULL;
+
+	return    g_file_get_contents (path, &existing, NULL, NULL)
+	       && nm_streq (existing, content);
+}
+
 static SpawnResult
 update_resolv_conf (NMDnsManager *self,
                     char **searches,
@@ -705,6 +740,7 @@ update_resolv_conf (NMDnsManager *self,
 	nm_auto_free char *rc_path_real = NULL;
 	gboolean resconf_link_cached = FALSE;
 	gs_free char *resconf_link = NULL;
+	gboolean write_rc_path;
 
 	/* If we are not managing /etc/resolv.conf and it points to
 	 * MY_RESOLV_CONF, don't write the private DNS configuration to
@@ -724,16 +760,30 @@ update_resolv_conf (NMDnsManager *self,
 
 	content = create_resolv_conf (searches, nameservers, options);
 
-	if (   rc_manager == NM_DNS_MANAGER_RESOLV_CONF_MAN_FILE
-	    || (   rc_manager == NM_DNS_MANAGER_RESOLV_CONF_MAN_SYMLINK
-	        && !_read_link_cached (_PATH_RESCONF, &resconf_link_cached, &resconf_link))) {
-		GError *local = NULL;
+	write_rc_path =    rc_manager == NM_DNS_MANAGER_RESOLV_CONF_MAN_FILE
+	                || (   rc_manager == NM_DNS_MANAGER_RESOLV_CONF_MAN_SYMLINK
+	                    && !_read_link_cached (_PATH_RESCONF, &resconf_link_cached, &resconf_link));
 
-		if (rc_manager == NM_DNS_MANAGER_RESOLV_CONF_MAN_FILE) {
-			rc_path_real = realpath (rc_path, NULL);
-			if (rc_path_real)
-				rc_path = rc_path_real;
-		}
+	if (rc_manager == NM_DNS_MANAGER_RESOLV_CONF_MAN_FILE) {
+		rc_path_real = realpath (rc_path, NULL);
+		if (rc_path_real)
+			rc_path = rc_path_real;
+	}
+
+	/* Rewriting the files with the same content only wakes up everybody
+	 * watching resolv.conf. Compare with what is on disk, so that changes
+	 * done by somebody else still get overwritten. */
+	if (   _file_has_content (MY_RESOLV_CONF, content)
+	    && (!write_rc_path || _file_has_content (rc_path, content))) {
+		NM_DNS_MANAGER_GET_PRIVATE (self)->update.num_suppressed++;
+		_LOGT ("update-resolv-conf: content unchanged, not writing %s (rc-manager=%s)",
+		       write_rc_path ? rc_path : MY_RESOLV_CONF,
+		       _rc_manager_to_string (rc_manager));
+		return SR_SUCCESS;
+	}
+
+	if (write_rc_path) {
+		GError *local = NULL;
 
 		/* we first write to /etc/resolv.conf directly. If that fails,
 		 * we still continue to write to runstatedir but remember the
@@ -903,6 +953,38 @@ compute_hash (NMDnsManager *self, const NMGlobalDnsConfig *global, guint8 buffer
 	g_checksum_free (sum);
 }
 
+static void
+compute_plugin_hash (const NMGlobalDnsConfig *global,
+                     const NMDnsIPConfigData *const*plugin_confs,
+                     const char *hostname,
+                     guint8 buffer[HASH_LEN])
+{
+	GChecksum *sum;
+	gsize len = HASH_LEN;
+	guint32 type;
+
+	sum = g_checksum_new (G_CHECKSUM_SHA1);
+
+	if (global)
+		nm_global_dns_config_update_checksum (global, sum);
+	for (; plugin_confs && *plugin_confs; plugin_confs++) {
+		const NMDnsIPConfigData *data = *plugin_confs;
+
+		type = data->type;
+		g_checksum_update (sum, (const guint8 *) &type, sizeof (type));
+		g_checksum_update (sum, (const guint8 *) data->iface, strlen (data->iface) + 1);
+		if (NM_IS_IP4_CONFIG (data->config))
+			nm_ip4_config_hash ((NMIP4Config *) data->config, sum, TRUE);
+		else
+			nm_ip6_config_hash ((NMIP6Config *) data->config, sum, TRUE);
+	}
+	if (hostname)
+		g_checksum_update (sum, (const guint8 *) hostname, strlen (hostname) + 1);
+
+	g_checksum_get_digest (sum, buffer, &len);
+	g_checksum_free (sum);
+}
+
 static gboolean
 merge_global_dns_config (NMResolvConfData *rc, NMGlobalDnsConfig *global_conf)
 {
@@ -1099,20 +1181,27 @@ update_dns (NMDnsManager *self,
 	gs_strfreev char **nis_servers = NULL;
 	gboolean caching = FALSE, update = TRUE;
 	gboolean resolv_conf_updated = FALSE;
+	guint8 plugin_hash[HASH_LEN];
 	SpawnResult result = SR_ERROR;
 	NMConfigData *data;
 	NMGlobalDnsConfig *global_config;
 	gs_free NMDnsIPConfigData **plugin_confs = NULL;
+	gs_free char *spawn_content = NULL;
 
 	g_return_val_if_fail (!error || !*error, FALSE);
 
 	priv = NM_DNS_MANAGER_GET_PRIVATE (self);
 
+	nm_clear_g_source (&priv->update.id);
+	priv->update.last_ts = nm_utils_get_monotonic_timestamp_ms ();
+
 	if (priv->is_stopped) {
 		_LOGD ("update-dns: not updating resolv.conf (is stopped)");
 		return TRUE;
 	}
 
+	NM_TRACE1 (dns__update, (int) no_caching);
+
 	nm_clear_g_source (&priv->plugin_ratelimit.timer);
 
 	if (NM_IN_SET (priv->rc_manager, NM_DNS_MANAGER_RESOLV_CONF_MAN_UNMANAGED,
@@ -1153,6 +1242,18 @@ update_dns (NMDnsManager *self,
 			caching = TRUE;
 		}
 
+		compute_plugin_hash (global_config,
+		                     (const NMDnsIPConfigData *const*) plugin_confs,
+		                     priv->hostname,
+		                     plugin_hash);
+		if (   priv->plugin_hash_valid
+		    && memcmp (plugin_hash, priv->plugin_hash, HASH_LEN) == 0) {
+			priv->update.num_suppressed++;
+			_LOGD ("update-dns: plugin %s not updated (configuration unchanged)",
+			       plugin_name);
+			goto skip;
+		}
+
 		_LOGD ("update-dns: updating plugin %s", plugin_name);
 		if (!nm_dns_plugin_update (plugin,
 		                           (const NMDnsIPConfigData **) plugin_confs,
@@ -1164,6 +1265,10 @@ update_dns (NMDnsManager *self,
 			 * caching DNS configuration to resolv.conf.
 			 */
 			caching = FALSE;
+			priv->plugin_hash_valid = FALSE;
+		} else {
+			memcpy (priv->plugin_hash, plugin_hash, HASH_LEN);
+			priv->plugin_hash_valid = TRUE;
 		}
 
 	skip:
@@ -1192,11 +1297,39 @@ update_dns (NMDnsManager *self,
 				priv->dns_touched = FALSE;
 			break;
 		case NM_DNS_MANAGER_RESOLV_CONF_MAN_RESOLVCONF:
-			result = dispatch_resolvconf (self, searches, nameservers, options, error);
-			break;
 		case NM_DNS_MANAGER_RESOLV_CONF_MAN_NETCONFIG:
-			result = dispatch_netconfig (self, searches, nameservers, nis_domain,
-			                             nis_servers, error);
+			/* don't spawn the helper again for the same data. */
+			if (priv->rc_manager == NM_DNS_MANAGER_RESOLV_CONF_MAN_RESOLVCONF)
+				spawn_content = create_resolv_conf (searches, nameservers, options);
+			else {
+				gs_free char *s_searches = searches ? g_strjoinv (" ", searches) : NULL;
+				gs_free char *s_nameservers = nameservers ? g_strjoinv (" ", nameservers) : NULL;
+				gs_free char *s_nis_servers = nis_servers ? g_strjoinv (" ", nis_servers) : NULL;
+
+				spawn_content = g_strdup_printf ("%s\n%s\n%s\n%s",
+				                                 s_searches ?: "",
+				                                 s_nameservers ?: "",
+				                                 nis_domain ?: "",
+				                                 s_nis_servers ?: "");
+			}
+			if (nm_streq0 (spawn_content, priv->spawn_content)) {
+				priv->update.num_suppressed++;
+				_LOGD ("update-dns: %s not called (configuration unchanged)",
+				       _rc_manager_to_string (priv->rc_manager));
+				result = SR_SUCCESS;
+				break;
+			}
+			g_clear_pointer (&priv->spawn_content, g_free);
+			if (priv->rc_manager == NM_DNS_MANAGER_RESOLV_CONF_MAN_RESOLVCONF)
+				result = dispatch_resolvconf (self, searches, nameservers, options, error);
+			else {
+				result = dispatch_netconfig (self, searches, nameservers, nis_domain,
+				                             nis_servers, error);
+			}
+			if (result == SR_SUCCESS) {
+				priv->spawn_content = spawn_content;
+				spawn_content = NULL;
+			}
 			break;
 		default:
 			g_assert_not_reached ();
@@ -1222,9 +1355,72 @@ update_dns (NMDnsManager *self,
 	g_clear_pointer (&priv->config_variant, g_variant_unref);
 	_notify (self, PROP_CONFIGURATION);
 
+	NM_TRACE1 (dns__update__done, (int) (!update || result == SR_SUCCESS));
+
 	return !update || result == SR_SUCCESS;
 }
 
+static gboolean
+update_dns_timeout_cb (gpointer user_data)
+{
+	NMDnsManager *self = user_data;
+	NMDnsManagerPrivate *priv = NM_DNS_MANAGER_GET_PRIVATE (self);
+	GError *error = NULL;
+
+	priv->update.id = 0;
+
+	/* a batch of updates is in progress. nm_dns_manager_end_updates()
+	 * commits the changes. */
+	if (priv->updates_queue)
+		return G_SOURCE_REMOVE;
+
+	_LOGD ("update-dns: rate limited update (%u updates coalesced, %u unchanged so far)",
+	       priv->update.num_coalesced, priv->update.num_suppressed);
+	if (!update_dns (self, FALSE, &error)) {
+		_LOGW ("could not commit DNS changes: %s", error->message);
+		g_clear_error (&error);
+	}
+	return G_SOURCE_REMOVE;
+}
+
+/* Updates DNS right away, unless the last update was less than
+ * main.dns-update-interval ago. Then, the update is delayed until the
+ * interval passed, so that bursts of changes like during mass
+ * activation only result in one update after the first one. */
+static void
+update_dns_schedule (NMDnsManager *self)
+{
+	NMDnsManagerPrivate *priv = NM_DNS_MANAGER_GET_PRIVATE (self);
+	GError *error = NULL;
+	gint64 interval, now;
+
+	if (priv->update.id) {
+		priv->update.num_coalesced++;
+		return;
+	}
+
+	interval = nm_config_data_get_value_int64 (nm_config_get_data (priv->config),
+	                                           NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                                           NM_CONFIG_KEYFILE_KEY_MAIN_DNS_UPDATE_INTERVAL,
+	                                           0, 60000, UPDATE_INTERVAL_DEFAULT);
+
+	now = nm_utils_get_monotonic_timestamp_ms ();
+	if (   interval == 0
+	    || !priv->update.last_ts
+	    || now >= priv->update.last_ts + interval) {
+		if (!update_dns (self, FALSE, &error)) {
+			_LOGW ("could not commit DNS changes: %s", error->message);
+			g_clear_error (&error);
+		}
+		return;
+	}
+
+	_LOGD ("update-dns: rate limit update for %"G_GINT64_FORMAT" msec",
+	       priv->update.last_ts + interval - now);
+	priv->update.id = g_timeout_add (priv->update.last_ts + interval - now,
+	                                 update_dns_timeout_cb, self);
+}
+
 static void
 plugin_failed (NMDnsPlugin *plugin, gpointer user_data)
 {
@@ -1235,6 +1431,8 @@ plugin_failed (NMDnsPlugin *plugin, gpointer user_data)
 	if (!nm_dns_plugin_is_caching (plugin))
 		return;
 
+	NM_DNS_MANAGER_GET_PRIVATE (self)->plugin_hash_valid = FALSE;
+
 	/* Disable caching until the next DNS update */
 	if (!update_dns (self, TRUE, &error)) {
 		_LOGW ("could not commit DNS changes: %s", error->message);
@@ -1264,7 +1462,12 @@ plugin_child_quit (NMDnsPlugin *plugin, int exit_status, gpointer user_data)
 	NMDnsManagerPrivate *priv = NM_DNS_MANAGER_GET_PRIVATE (self);
 	gint64 ts = nm_utils_get_monotonic_timestamp_ms ();
 
-	_LOGW ("plugin %s child quit unexpectedly", nm_dns_plugin_get_name (plugin));
+	priv->num_plugin_restarts++;
+	_LOGW ("plugin %s child quit unexpectedly (%u restarts)",
+	       nm_dns_plugin_get_name (plugin), priv->num_plugin_restarts);
+
+	/* the restarted child needs the full configuration. */
+	priv->plugin_hash_valid = FALSE;
 
 	if (   !priv->plugin_ratelimit.ts
 	    || (ts - priv->plugin_ratelimit.ts) / 1000 > PLUGIN_RATELIMIT_INTERVAL) {
@@ -1313,7 +1516,6 @@ nm_dns_manager_add_ip_config (NMDnsManager *self,
                               NMDnsIPConfigType cfg_type)
 {
 	NMDnsManagerPrivate *priv;
-	GError *error = NULL;
 	NMDnsIPConfigData *data;
 	gboolean v4 = NM_IS_IP4_CONFIG (config);
 	guint i;
@@ -1360,10 +1562,8 @@ nm_dns_manager_add_ip_config (NMDnsManager *self,
 		}
 	}
 
-	if (!priv->updates_queue && !update_dns (self, FALSE, &error)) {
-		_LOGW ("could not commit DNS changes: %s", error->message);
-		g_clear_error (&error);
-	}
+	if (!priv->updates_queue)
+		update_dns_schedule (self);
 
 	return TRUE;
 }
@@ -1390,7 +1590,6 @@ static gboolean
 nm_dns_manager_remove_ip_config (NMDnsManager *self, gpointer config)
 {
 	NMDnsManagerPrivate *priv;
-	GError *error = NULL;
 	NMDnsIPConfigData *data;
 	guint i;
 
@@ -1406,10 +1605,8 @@ nm_dns_manager_remove_ip_config (NMDnsManager *self, gpointer config)
 			forget_data (self, data);
 			g_ptr_array_remove_index (priv->configs, i);
 
-			if (!priv->updates_queue && !update_dns (self, FALSE, &error)) {
-				_LOGW ("could not commit DNS changes: %s", error->message);
-				g_clear_error (&error);
-			}
+			if (!priv->updates_queue)
+				update_dns_schedule (self);
 
 			return TRUE;
 		}
@@ -1444,7 +1641,6 @@ nm_dns_manager_set_hostname (NMDnsManager *self,
                              gboolean skip_update)
 {
 	NMDnsManagerPrivate *priv = NM_DNS_MANAGER_GET_PRIVATE (self);
-	GError *error = NULL;
 	const char *filtered = NULL;
 
 	/* Certain hostnames we don't want to include in resolv.conf 'searches' */
@@ -1464,10 +1660,8 @@ nm_dns_manager_set_hostname (NMDnsManager *self,
 
 	if (skip_update)
 		return;
-	if (!priv->updates_queue && !update_dns (self, FALSE, &error)) {
-		_LOGW ("could not commit DNS changes: %s", error->message);
-		g_clear_error (&error);
-	}
+	if (!priv->updates_queue)
+		update_dns_schedule (self);
 }
 
 gboolean
@@ -1508,7 +1702,6 @@ void
 nm_dns_manager_end_updates (NMDnsManager *self, const char *func)
 {
 	NMDnsManagerPrivate *priv;
-	GError *error = NULL;
 	gboolean changed;
 	guint8 new[HASH_LEN];
 
@@ -1534,10 +1727,7 @@ nm_dns_manager_end_updates (NMDnsManager *self, const char *func)
 
 	/* Commit all the outstanding changes */
 	_LOGD ("(%s): committing DNS changes (%d)", func, priv->updates_queue);
-	if (!update_dns (self, FALSE, &error)) {
-		_LOGW ("could not commit DNS changes: %s", error->message);
-		g_clear_error (&error);
-	}
+	update_dns_schedule (self);
 
 	memset (priv->prev_hash, 0, sizeof (priv->prev_hash));
 }
@@ -1578,6 +1768,7 @@ _clear_plugin (NMDnsManager *self)
 {
 	NMDnsManagerPrivate *priv = NM_DNS_MANAGER_GET_PRIVATE (self);
 
+	priv->plugin_hash_valid = FALSE;
 	if (priv->plugin) {
 		g_signal_handlers_disconnect_by_func (priv->plugin, plugin_failed, self);
 		g_signal_handlers_disconnect_by_func (priv->plugin, plugin_child_quit, self);
@@ -1670,7 +1861,8 @@ _resolvconf_resolved_managed (void)
 	return ret;
 }
 
-static void
+/* Returns whether the mode, the resolv.conf manager or the plugin changed. */
+static gboolean
 init_resolv_conf_mode (NMDnsManager *self, gboolean force_reload_plugin)
 {
 	NMDnsManagerPrivate *priv = NM_DNS_MANAGER_GET_PRIVATE (self);
@@ -1715,6 +1907,22 @@ again:
 
 	rc_manager = _check_resconf_immutable (rc_manager);
 
+	/* on reload, keep the plugin if it can apply the new configuration
+	 * in place. Restarting it drops the cache of the nameserver and
+	 * interrupts name resolution. */
+	if (   force_reload_plugin
+	    && priv->plugin
+	    && nm_streq0 (mode, nm_dns_plugin_get_name (priv->plugin))) {
+		if (nm_dns_plugin_reload (priv->plugin)) {
+			_LOGD ("init: plugin %s reloaded without restart", mode);
+			force_reload_plugin = FALSE;
+		} else {
+			priv->num_plugin_restarts++;
+			_LOGI ("init: restart plugin %s to reload its configuration (%u restarts)",
+			       mode, priv->num_plugin_restarts);
+		}
+	}
+
 	if (   (!mode && _resolvconf_resolved_managed ())
 	    || nm_streq0 (mode, "systemd-resolved")) {
 		if (   force_reload_plugin
@@ -1730,6 +1938,12 @@ again:
 			priv->plugin = nm_dns_dnsmasq_new ();
 			plugin_changed = TRUE;
 		}
+	} else if (nm_streq0 (mode, "stub")) {
+		if (force_reload_plugin || !NM_IS_DNS_STUB (priv->plugin)) {
+			_clear_plugin (self);
+			priv->plugin = nm_dns_stub_new ();
+			plugin_changed = TRUE;
+		}
 	} else if (nm_streq0 (mode, "unbound")) {
 		if (force_reload_plugin || !NM_IS_DNS_UNBOUND (priv->plugin)) {
 			_clear_plugin (self);
@@ -1762,6 +1976,7 @@ again:
 
 	if (priv->rc_manager != rc_manager) {
 		priv->rc_manager = rc_manager;
+		g_clear_pointer (&priv->spawn_content, g_free);
 		param_changed = TRUE;
 		_notify (self, PROP_RC_MANAGER);
 	}
@@ -1774,6 +1989,8 @@ again:
 	}
 
 	g_object_thaw_notify (G_OBJECT (self));
+
+	return param_changed || plugin_changed;
 }
 
 static void
@@ -1784,6 +2001,7 @@ config_changed_cb (NMConfig *config,
                    NMDnsManager *self)
 {
 	GError *error = NULL;
+	gboolean mode_changed = FALSE;
 
 	if (NM_FLAGS_ANY (changes, NM_CONFIG_CHANGE_DNS_MODE |
 	                           NM_CONFIG_CHANGE_RC_MANAGER |
@@ -1793,13 +2011,16 @@ config_changed_cb (NMConfig *config,
 		 * The reason is, that the configuration also depends on whether resolv.conf
 		 * is immutable, thus, without the configuration changing, we always want to
 		 * re-configure the mode. */
-		init_resolv_conf_mode (self,
-		                       NM_FLAGS_ANY (changes,   NM_CONFIG_CHANGE_CAUSE_SIGHUP
-		                                              | NM_CONFIG_CHANGE_CAUSE_DNS_FULL));
+		mode_changed = init_resolv_conf_mode (self,
+		                                      NM_FLAGS_ANY (changes,   NM_CONFIG_CHANGE_CAUSE_SIGHUP
+		                                                             | NM_CONFIG_CHANGE_CAUSE_DNS_FULL));
 	}
 
-	if (NM_FLAGS_ANY (changes, NM_CONFIG_CHANGE_CAUSE_SIGHUP |
-	                           NM_CONFIG_CHANGE_CAUSE_SIGUSR1 |
+	/* A SIGHUP alone doesn't rewrite the DNS configuration. That only
+	 * happens if it changed the DNS settings or restarted the plugin;
+	 * SIGUSR1 still forces a rewrite. */
+	if (   mode_changed
+	    || NM_FLAGS_ANY (changes, NM_CONFIG_CHANGE_CAUSE_SIGUSR1 |
 	                           NM_CONFIG_CHANGE_CAUSE_DNS_RC |
 	                           NM_CONFIG_CHANGE_CAUSE_DNS_FULL |
 	                           NM_CONFIG_CHANGE_DNS_MODE |
@@ -2077,6 +2298,7 @@ dispose (GObject *object)
 	}
 
 	nm_clear_g_source (&priv->plugin_ratelimit.timer);
+	nm_clear_g_source (&priv->update.id);
 
 	G_OBJECT_CLASS (nm_dns_manager_parent_class)->dispose (object);
 }
@@ -2089,6 +2311,7 @@ finalize (GObject *object)
 
 	g_free (priv->hostname);
 	g_free (priv->mode);
+	g_free (priv->spawn_content);
 
 	G_OBJECT_CLASS (nm_dns_manager_parent_class)->finalize (object);
 }
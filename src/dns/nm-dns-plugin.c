@@ -108,6 +108,14 @@ nm_dns_plugin_get_name (NMDnsPlugin *self)
 	return NM_DNS_PLUGIN_GET_CLASS (self)->get_name (self);
 }
 
+gboolean
+nm_dns_plugin_reload (NMDnsPlugin *self)
+{
+	if (!NM_DNS_PLUGIN_GET_CLASS (self)->reload)
+		return FALSE;
+	return NM_DNS_PLUGIN_GET_CLASS (self)->reload (self);
+}
+
 /*****************************************************************************/
 
 static void
@@ -63,6 +63,13 @@ typedef struct {
 	/* Subclasses should override this and return their plugin name */
 	const char *(*get_name) (NMDnsPlugin *self);
 
+	/* Called when the configuration is reloaded. Subclasses can
+	 * override it and return TRUE if they can keep running, which
+	 * spares a restart of the nameserver and keeps its cache.
+	 * Otherwise, the plugin is destroyed and created again.
+	 */
+	gboolean (*reload) (NMDnsPlugin *self);
+
 	/* Signals */
 
 	/* Emitted by the plugin base class when the nameserver subprocess
@@ -79,6 +86,8 @@ gboolean nm_dns_plugin_is_caching (NMDnsPlugin *self);
 
 const char *nm_dns_plugin_get_name (NMDnsPlugin *self);
 
+gboolean nm_dns_plugin_reload (NMDnsPlugin *self);
+
 gboolean nm_dns_plugin_update (NMDnsPlugin *self,
                                const NMDnsIPConfigData **configs,
                                const NMGlobalDnsConfig *global_config,
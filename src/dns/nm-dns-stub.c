@@ -0,0 +1,1407 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2017 Red Hat, Inc.
+ */
+
+/* A caching DNS stub resolver inside NetworkManager. It listens for UDP
+ * and TCP queries on 127.0.0.1 and forwards them to the nameservers of the
+ * active connections. Like with dnsmasq, the nameservers of VPN
+ * connections are only used for their search domains and for the reverse
+ * domains of their addresses and routes ("split DNS"). Negative answers
+ * are cached too, and entries which are used shortly before they expire
+ * are refreshed in the background.
+ */
+
+#include "nm-default.h"
+
+#include "nm-dns-stub.h"
+
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "nm-core-internal.h"
+#include "platform/nm-platform.h"
+#include "nm-utils.h"
+#include "nm-ip4-config.h"
+#include "nm-ip6-config.h"
+#include "NetworkManagerUtils.h"
+#include "nm-dns-utils.h"
+
+#define STUB_PORT               53
+
+/* the largest query, and the largest reply read over UDP. Replies that
+ * are truncated are read again over TCP, which allows G_MAXUINT16. */
+#define PACKET_SIZE_MAX         4096
+
+#define CACHE_SIZE_MAX          1000
+
+#define UPSTREAM_TIMEOUT_MSEC   2000
+
+/* queries to upstream servers at the same time. Above that, clients get
+ * SERVFAIL instead of making us open ever more sockets. */
+#define QUERIES_MAX             256
+
+#define TCP_CONNECTIONS_MAX     32
+#define TCP_IDLE_TIMEOUT_SEC    10
+#define TCP_OUTPUT_MAX          (256 * 1024)
+
+/* a cache hit in the last PREFETCH_PERCENT of the time to live refreshes
+ * the entry in the background, if it lives at least PREFETCH_TTL_MIN. */
+#define PREFETCH_PERCENT        10
+#define PREFETCH_TTL_MIN        10
+
+/*****************************************************************************/
+
+typedef union {
+	struct sockaddr sa;
+	struct sockaddr_in in;
+	struct sockaddr_in6 in6;
+} SockAddr;
+
+typedef struct {
+	SockAddr addr;
+
+	/* in lower case and without trailing dot. NULL for servers
+	 * that resolve all other names. */
+	char *domain;
+} Server;
+
+typedef struct _TcpConn TcpConn;
+
+typedef struct {
+	SockAddr addr;
+
+	/* the connection the query came on, NULL for UDP */
+	TcpConn *conn;
+
+	guint16 id;
+
+	/* the largest reply the client takes over UDP */
+	guint16 udp_size;
+} Client;
+
+struct _TcpConn {
+	NMDnsStub *self;
+	int ref_count;
+
+	int fd;
+	GIOChannel *channel;
+	guint in_id;
+	guint out_id;
+	guint timeout_id;
+
+	/* the queries read so far, each after its length */
+	guint8 in_buf[2 + PACKET_SIZE_MAX];
+	gsize in_len;
+
+	/* the replies not sent yet, each after its length */
+	GByteArray *out_buf;
+};
+
+typedef struct {
+	char *key;
+	guint8 *reply;
+	gsize reply_len;
+	gint64 timestamp;
+	guint32 ttl;
+	GList lru_link;
+} CacheEntry;
+
+typedef struct {
+	NMDnsStub *self;
+	char *key;
+
+	/* the key of the question alone, to match the reply */
+	char *question_key;
+
+	/* the query as sent upstream */
+	guint8 *query;
+	gsize query_len;
+	gsize question_len;
+	guint16 id;
+
+	/* SockAddr, the servers to try in order */
+	GArray *servers;
+	guint server_idx;
+
+	int fd;
+	GIOChannel *channel;
+	guint channel_id;
+	guint timeout_id;
+
+	/* over TCP, first the query to send and then the reply being
+	 * read, each after its length */
+	guint8 *tcp_buf;
+	gsize tcp_pos;
+	gboolean tcp_reading;
+
+	/* Client, the clients waiting for the answer. Empty
+	 * when prefetching. */
+	GArray *clients;
+} Query;
+
+typedef struct {
+	int fd;
+	GIOChannel *channel;
+	guint channel_id;
+
+	int tcp_fd;
+	GIOChannel *tcp_channel;
+	guint tcp_channel_id;
+
+	/* TcpConn */
+	GSList *tcp_conns;
+
+	/* Server */
+	GArray *servers;
+
+	/* key to CacheEntry, and the entries from least to
+	 * most recently used */
+	GHashTable *cache;
+	GQueue cache_lru;
+
+	/* key to Query */
+	GHashTable *queries;
+
+	guint num_hits;
+	guint num_misses;
+} NMDnsStubPrivate;
+
+struct _NMDnsStub {
+	NMDnsPlugin parent;
+	NMDnsStubPrivate _priv;
+};
+
+struct _NMDnsStubClass {
+	NMDnsPluginClass parent;
+};
+
+G_DEFINE_TYPE (NMDnsStub, nm_dns_stub, NM_TYPE_DNS_PLUGIN)
+
+#define NM_DNS_STUB_GET_PRIVATE(self) _NM_GET_PRIVATE (self, NMDnsStub, NM_IS_DNS_STUB)
+
+/*****************************************************************************/
+
+#define _NMLOG_DOMAIN         LOGD_DNS
+#define _NMLOG(level, ...) __NMLOG_DEFAULT_WITH_ADDR (level, _NMLOG_DOMAIN, "dns-stub", __VA_ARGS__)
+
+/*****************************************************************************/
+
+static socklen_t
+_sockaddr_len (const SockAddr *addr)
+{
+	return addr->sa.sa_family == AF_INET6
+	       ? sizeof (struct sockaddr_in6)
+	       : sizeof (struct sockaddr_in);
+}
+
+static gboolean
+_sockaddr_equal (const SockAddr *a, const SockAddr *b)
+{
+	if (a->sa.sa_family != b->sa.sa_family)
+		return FALSE;
+	if (a->sa.sa_family == AF_INET) {
+		return    a->in.sin_port == b->in.sin_port
+		       && a->in.sin_addr.s_addr == b->in.sin_addr.s_addr;
+	}
+	return    a->in6.sin6_port == b->in6.sin6_port
+	       && a->in6.sin6_scope_id == b->in6.sin6_scope_id
+	       && IN6_ARE_ADDR_EQUAL (&a->in6.sin6_addr, &b->in6.sin6_addr);
+}
+
+static const char *
+_sockaddr_to_string (const SockAddr *addr, char *buf)
+{
+	if (addr->sa.sa_family == AF_INET)
+		return nm_utils_inet4_ntop (addr->in.sin_addr.s_addr, buf);
+	return nm_utils_inet6_ntop (&addr->in6.sin6_addr, buf);
+}
+
+/*****************************************************************************/
+
+
+static TcpConn *
+tcp_conn_ref (TcpConn *conn)
+{
+	conn->ref_count++;
+	return conn;
+}
+
+static void
+tcp_conn_unref (TcpConn *conn)
+{
+	if (--conn->ref_count > 0)
+		return;
+
+	nm_assert (conn->fd < 0);
+	g_byte_array_unref (conn->out_buf);
+	g_slice_free (TcpConn, conn);
+}
+
+/* Clients waiting for an answer keep their reference, replies to a closed
+ * connection are dropped. */
+static void
+tcp_conn_close (TcpConn *conn)
+{
+	NMDnsStubPrivate *priv = NM_DNS_STUB_GET_PRIVATE (conn->self);
+
+	if (conn->fd < 0)
+		return;
+
+	nm_clear_g_source (&conn->in_id);
+	nm_clear_g_source (&conn->out_id);
+	nm_clear_g_source (&conn->timeout_id);
+	g_io_channel_unref (conn->channel);
+	conn->channel = NULL;
+	close (conn->fd);
+	conn->fd = -1;
+
+	priv->tcp_conns = g_slist_remove (priv->tcp_conns, conn);
+	tcp_conn_unref (conn);
+}
+
+static gboolean
+tcp_conn_timeout_cb (gpointer user_data)
+{
+	TcpConn *conn = user_data;
+
+	conn->timeout_id = 0;
+	tcp_conn_close (conn);
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean
+tcp_conn_out_cb (GIOChannel *channel, GIOCondition condition, gpointer user_data)
+{
+	TcpConn *conn = user_data;
+	ssize_t n;
+
+	n = send (conn->fd, conn->out_buf->data, conn->out_buf->len, MSG_NOSIGNAL);
+	if (n < 0) {
+		if (NM_IN_SET (errno, EAGAIN, EINTR))
+			return G_SOURCE_CONTINUE;
+		conn->out_id = 0;
+		tcp_conn_close (conn);
+		return G_SOURCE_REMOVE;
+	}
+
+	g_byte_array_remove_range (conn->out_buf, 0, n);
+	if (conn->out_buf->len)
+		return G_SOURCE_CONTINUE;
+	conn->out_id = 0;
+	return G_SOURCE_REMOVE;
+}
+
+static void
+tcp_conn_send (TcpConn *conn, const guint8 *data, gsize len)
+{
+	guint8 prefix[2];
+
+	if (conn->fd < 0)
+		return;
+
+	if (conn->out_buf->len + 2 + len > TCP_OUTPUT_MAX) {
+		/* the client doesn't read its replies */
+		tcp_conn_close (conn);
+		return;
+	}
+
+	nm_dns_put_u16 (prefix, len);
+	g_byte_array_append (conn->out_buf, prefix, sizeof (prefix));
+	g_byte_array_append (conn->out_buf, data, len);
+	if (!conn->out_id) {
+		conn->out_id = g_io_add_watch (conn->channel, G_IO_OUT | G_IO_ERR | G_IO_HUP,
+		                               tcp_conn_out_cb, conn);
+	}
+}
+
+static void handle_query (NMDnsStub *self,
+                          const guint8 *data,
+                          gsize len,
+                          const SockAddr *from,
+                          TcpConn *conn);
+
+static gboolean
+tcp_conn_in_cb (GIOChannel *channel, GIOCondition condition, gpointer user_data)
+{
+	TcpConn *conn = user_data;
+	gboolean result = G_SOURCE_CONTINUE;
+	gsize used = 0, msg_len;
+	ssize_t n;
+
+	n = recv (conn->fd, &conn->in_buf[conn->in_len], sizeof (conn->in_buf) - conn->in_len, 0);
+	if (n < 0 && NM_IN_SET (errno, EAGAIN, EINTR))
+		return G_SOURCE_CONTINUE;
+	if (n <= 0) {
+		conn->in_id = 0;
+		tcp_conn_close (conn);
+		return G_SOURCE_REMOVE;
+	}
+	conn->in_len += n;
+
+	nm_clear_g_source (&conn->timeout_id);
+	conn->timeout_id = g_timeout_add_seconds (TCP_IDLE_TIMEOUT_SEC, tcp_conn_timeout_cb, conn);
+
+	/* answering can close the connection */
+	tcp_conn_ref (conn);
+	while (   conn->fd >= 0
+	       && conn->in_len - used >= 2) {
+		msg_len = nm_dns_get_u16 (&conn->in_buf[used]);
+		if (msg_len > PACKET_SIZE_MAX) {
+			tcp_conn_close (conn);
+			break;
+		}
+		if (conn->in_len - used < 2 + msg_len)
+			break;
+		handle_query (conn->self, &conn->in_buf[used + 2], msg_len, NULL, conn);
+		used += 2 + msg_len;
+	}
+
+	if (conn->fd >= 0) {
+		memmove (conn->in_buf, &conn->in_buf[used], conn->in_len - used);
+		conn->in_len -= used;
+	} else
+		result = G_SOURCE_REMOVE;
+	tcp_conn_unref (conn);
+	return result;
+}
+
+/*****************************************************************************/
+
+static void
+send_reply (NMDnsStub *self, guint8 *data, gsize len, const Client *client)
+{
+	NMDnsStubPrivate *priv = NM_DNS_STUB_GET_PRIVATE (self);
+	guint8 buf[PACKET_SIZE_MAX];
+	gsize p = DNS_HEADER_SIZE;
+
+	nm_dns_put_u16 (data, client->id);
+
+	if (client->conn) {
+		tcp_conn_send (client->conn, data, len);
+		return;
+	}
+
+	if (len > client->udp_size) {
+		/* only the question, with the TC flag. The client asks
+		 * again over TCP. */
+		if (   nm_dns_get_u16 (&data[4]) != 1
+		    || !nm_dns_skip_name (data, len, &p)
+		    || p + 4 > MIN (len, sizeof (buf)))
+			return;
+		len = p + 4;
+		memcpy (buf, data, len);
+		nm_dns_put_u16 (&buf[2], nm_dns_get_u16 (&buf[2]) | DNS_FLAG_TC);
+		memset (&buf[6], 0, 6);
+		data = buf;
+	}
+
+	if (sendto (priv->fd, data, len, 0, &client->addr.sa, _sockaddr_len (&client->addr)) < 0) {
+		int errsv = errno;
+
+		_LOGD ("could not send reply: %s", g_strerror (errsv));
+	}
+}
+
+/* replies with an error and only the question of @query, if any. */
+static void
+send_error (NMDnsStub *self,
+            const guint8 *query,
+            gsize question_len,
+            const Client *client,
+            guint rcode)
+{
+	guint8 buf[PACKET_SIZE_MAX];
+
+	nm_assert (question_len >= DNS_HEADER_SIZE && question_len <= sizeof (buf));
+
+	memcpy (buf, query, question_len);
+	nm_dns_put_u16 (&buf[2], DNS_FLAG_QR | DNS_FLAG_RA | (nm_dns_get_u16 (&query[2]) & DNS_FLAG_RD) | rcode);
+	nm_dns_put_u16 (&buf[4], question_len > DNS_HEADER_SIZE ? 1 : 0);
+	memset (&buf[6], 0, 6);
+	send_reply (self, buf, question_len, client);
+}
+
+/*****************************************************************************/
+
+static void
+cache_remove (NMDnsStub *self, CacheEntry *entry)
+{
+	NMDnsStubPrivate *priv = NM_DNS_STUB_GET_PRIVATE (self);
+
+	g_queue_unlink (&priv->cache_lru, &entry->lru_link);
+	g_hash_table_remove (priv->cache, entry->key);
+}
+
+static void
+cache_entry_free (gpointer data)
+{
+	CacheEntry *entry = data;
+
+	g_free (entry->key);
+	g_free (entry->reply);
+	g_slice_free (CacheEntry, entry);
+}
+
+static void
+cache_add (NMDnsStub *self, const char *key, const guint8 *reply, gsize len, guint32 ttl)
+{
+	NMDnsStubPrivate *priv = NM_DNS_STUB_GET_PRIVATE (self);
+	CacheEntry *entry;
+
+	entry = g_hash_table_lookup (priv->cache, key);
+	if (entry)
+		cache_remove (self, entry);
+	else if (g_hash_table_size (priv->cache) >= CACHE_SIZE_MAX)
+		cache_remove (self, priv->cache_lru.head->data);
+
+	entry = g_slice_new0 (CacheEntry);
+	entry->key = g_strdup (key);
+	entry->reply = g_memdup (reply, len);
+	entry->reply_len = len;
+	entry->timestamp = nm_utils_get_monotonic_timestamp_ms ();
+	entry->ttl = ttl;
+	entry->lru_link.data = entry;
+
+	g_hash_table_insert (priv->cache, entry->key, entry);
+	g_queue_push_tail_link (&priv->cache_lru, &entry->lru_link);
+}
+
+static void
+cache_flush (NMDnsStub *self)
+{
+	NMDnsStubPrivate *priv = NM_DNS_STUB_GET_PRIVATE (self);
+
+	if (g_hash_table_size (priv->cache)) {
+		_LOGD ("flush cache with %u entries (%u hits, %u misses)",
+		       g_hash_table_size (priv->cache), priv->num_hits, priv->num_misses);
+	}
+	g_queue_init (&priv->cache_lru);
+	g_hash_table_remove_all (priv->cache);
+}
+
+/*****************************************************************************/
+
+static void
+query_socket_close (Query *q)
+{
+	nm_clear_g_source (&q->channel_id);
+	if (q->channel) {
+		g_io_channel_unref (q->channel);
+		q->channel = NULL;
+	}
+	if (q->fd >= 0) {
+		close (q->fd);
+		q->fd = -1;
+	}
+	g_clear_pointer (&q->tcp_buf, g_free);
+	q->tcp_pos = 0;
+	q->tcp_reading = FALSE;
+}
+
+static void
+client_clear (gpointer data)
+{
+	Client *client = data;
+
+	if (client->conn)
+		tcp_conn_unref (client->conn);
+}
+
+static void
+query_add_client (Query *q, const Client *client)
+{
+	g_array_append_val (q->clients, *client);
+	if (client->conn)
+		tcp_conn_ref (client->conn);
+}
+
+static void
+query_free (gpointer data)
+{
+	Query *q = data;
+
+	nm_clear_g_source (&q->timeout_id);
+	query_socket_close (q);
+	g_array_unref (q->servers);
+	g_array_unref (q->clients);
+	g_free (q->query);
+	g_free (q->question_key);
+	g_free (q->key);
+	g_slice_free (Query, q);
+}
+
+static void
+query_complete (Query *q, guint8 *reply, gsize len)
+{
+	NMDnsStub *self = q->self;
+	NMDnsStubPrivate *priv = NM_DNS_STUB_GET_PRIVATE (self);
+	guint32 ttl;
+	guint i;
+
+	g_hash_table_steal (priv->queries, q->key);
+
+	if (reply) {
+		ttl = nm_dns_reply_ttl (reply, len, 0);
+		if (ttl)
+			cache_add (self, q->key, reply, len, ttl);
+		for (i = 0; i < q->clients->len; i++)
+			send_reply (self, reply, len, &g_array_index (q->clients, Client, i));
+	} else {
+		_LOGD ("no answer for %s", q->key);
+		for (i = 0; i < q->clients->len; i++) {
+			send_error (self, q->query, q->question_len,
+			            &g_array_index (q->clients, Client, i),
+			            DNS_RCODE_SERVFAIL);
+		}
+	}
+
+	query_free (q);
+}
+
+static void query_send (Query *q);
+static gboolean query_send_tcp (Query *q);
+
+static gboolean
+query_timeout_cb (gpointer user_data)
+{
+	Query *q = user_data;
+
+	q->timeout_id = 0;
+	q->server_idx++;
+	query_send (q);
+	return G_SOURCE_REMOVE;
+}
+
+/* whether @data looks like the answer of the server to our query */
+static gboolean
+query_reply_matches (Query *q, const guint8 *data, gsize len)
+{
+	gs_free char *key = NULL;
+
+	if (   len < DNS_HEADER_SIZE
+	    || nm_dns_get_u16 (data) != q->id
+	    || !(nm_dns_get_u16 (&data[2]) & DNS_FLAG_QR)
+	    || nm_dns_get_u16 (&data[4]) != 1)
+		return FALSE;
+	key = nm_dns_question_key (data, len, NULL);
+	return nm_streq0 (key, q->question_key);
+}
+
+/* the source watching the socket must be gone already. @truncated
+ * tells that the reply didn't fit into the buffer. */
+static void
+query_handle_reply (Query *q, guint8 *data, gsize len, gboolean truncated)
+{
+	guint16 flags = nm_dns_get_u16 (&data[2]);
+
+	nm_clear_g_source (&q->timeout_id);
+
+	if (   (truncated || (flags & DNS_FLAG_TC))
+	    && !q->tcp_reading) {
+		/* the answer didn't fit, ask the same server over TCP */
+		if (!query_send_tcp (q)) {
+			q->server_idx++;
+			query_send (q);
+		}
+	} else if (   NM_IN_SET (DNS_RCODE (flags), DNS_RCODE_SERVFAIL, DNS_RCODE_REFUSED)
+	           && q->server_idx + 1 < q->servers->len) {
+		q->server_idx++;
+		query_send (q);
+	} else
+		query_complete (q, data, len);
+}
+
+static gboolean
+query_receive_cb (GIOChannel *channel, GIOCondition condition, gpointer user_data)
+{
+	Query *q = user_data;
+	guint8 buf[PACKET_SIZE_MAX];
+	SockAddr from;
+	socklen_t from_len = sizeof (from);
+	ssize_t len;
+
+	/* the query asks for no more than PACKET_SIZE_MAX, but a server
+	 * may send more anyway. With MSG_TRUNC, @len is the real size. */
+	len = recvfrom (q->fd, buf, sizeof (buf), MSG_TRUNC, &from.sa, &from_len);
+
+	/* ignore anything that doesn't look like the answer of the
+	 * server to our query. */
+	if (   len < DNS_HEADER_SIZE
+	    || !_sockaddr_equal (&from, &g_array_index (q->servers, SockAddr, q->server_idx))
+	    || !query_reply_matches (q, buf, MIN (len, (ssize_t) sizeof (buf))))
+		return G_SOURCE_CONTINUE;
+
+	/* the source is removed by returning G_SOURCE_REMOVE */
+	q->channel_id = 0;
+	query_handle_reply (q, buf, MIN (len, (ssize_t) sizeof (buf)), len > (ssize_t) sizeof (buf));
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean
+query_tcp_cb (GIOChannel *channel, GIOCondition condition, gpointer user_data)
+{
+	Query *q = user_data;
+	NMDnsStub *self = q->self;
+	char buf[NM_UTILS_INET_ADDRSTRLEN];
+	ssize_t n;
+
+	if (!q->tcp_reading)
+		n = send (q->fd, &q->tcp_buf[q->tcp_pos], 2 + q->query_len - q->tcp_pos, MSG_NOSIGNAL);
+	else {
+		n = recv (q->fd, &q->tcp_buf[q->tcp_pos],
+		          (q->tcp_pos < 2 ? 2 : 2 + nm_dns_get_u16 (q->tcp_buf)) - q->tcp_pos, 0);
+	}
+	if (n < 0 && NM_IN_SET (errno, EAGAIN, EINTR))
+		return G_SOURCE_CONTINUE;
+	if (n <= 0)
+		goto fail;
+	q->tcp_pos += n;
+
+	if (!q->tcp_reading) {
+		if (q->tcp_pos < 2 + q->query_len)
+			return G_SOURCE_CONTINUE;
+
+		/* the query is out, wait for the reply */
+		g_free (q->tcp_buf);
+		q->tcp_buf = g_malloc (2 + G_MAXUINT16);
+		q->tcp_pos = 0;
+		q->tcp_reading = TRUE;
+		q->channel_id = g_io_add_watch (q->channel, G_IO_IN | G_IO_ERR | G_IO_HUP,
+		                                query_tcp_cb, q);
+		return G_SOURCE_REMOVE;
+	}
+
+	if (   q->tcp_pos < 2
+	    || q->tcp_pos < 2 + nm_dns_get_u16 (q->tcp_buf))
+		return G_SOURCE_CONTINUE;
+	if (!query_reply_matches (q, &q->tcp_buf[2], q->tcp_pos - 2))
+		goto fail;
+
+	q->channel_id = 0;
+	query_handle_reply (q, &q->tcp_buf[2], q->tcp_pos - 2, FALSE);
+	return G_SOURCE_REMOVE;
+
+fail:
+	_LOGD ("could not query %s over TCP from %s",
+	       q->key, _sockaddr_to_string (&g_array_index (q->servers, SockAddr, q->server_idx), buf));
+	q->channel_id = 0;
+	nm_clear_g_source (&q->timeout_id);
+	q->server_idx++;
+	query_send (q);
+	return G_SOURCE_REMOVE;
+}
+
+/* sends the query again to the current server, over TCP. The reply
+ * is read in full even if it is larger than PACKET_SIZE_MAX. */
+static gboolean
+query_send_tcp (Query *q)
+{
+	NMDnsStub *self = q->self;
+	char buf[NM_UTILS_INET_ADDRSTRLEN];
+	const SockAddr *addr = &g_array_index (q->servers, SockAddr, q->server_idx);
+	int errsv;
+
+	query_socket_close (q);
+	q->fd = socket (addr->sa.sa_family, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+	if (q->fd < 0) {
+		errsv = errno;
+		_LOGD ("could not create TCP socket for %s: %s",
+		       _sockaddr_to_string (addr, buf), g_strerror (errsv));
+		return FALSE;
+	}
+
+	if (   connect (q->fd, &addr->sa, _sockaddr_len (addr)) < 0
+	    && errno != EINPROGRESS) {
+		errsv = errno;
+		_LOGD ("could not connect to %s: %s",
+		       _sockaddr_to_string (addr, buf), g_strerror (errsv));
+		return FALSE;
+	}
+
+	_LOGT ("reply for %s is truncated, retrying over TCP", q->key);
+	q->tcp_buf = g_malloc (2 + q->query_len);
+	nm_dns_put_u16 (q->tcp_buf, q->query_len);
+	memcpy (&q->tcp_buf[2], q->query, q->query_len);
+
+	q->channel = g_io_channel_unix_new (q->fd);
+	q->channel_id = g_io_add_watch (q->channel, G_IO_OUT | G_IO_ERR | G_IO_HUP,
+	                                query_tcp_cb, q);
+	q->timeout_id = g_timeout_add (UPSTREAM_TIMEOUT_MSEC, query_timeout_cb, q);
+	return TRUE;
+}
+
+/* sends the query to the current server, or to the next ones if that
+ * fails. Each server is queried from a new socket, so that every
+ * query has a random source port. */
+static void
+query_send (Query *q)
+{
+	NMDnsStub *self = q->self;
+	char buf[NM_UTILS_INET_ADDRSTRLEN];
+	const SockAddr *addr;
+	int errsv;
+
+	for (; q->server_idx < q->servers->len; q->server_idx++) {
+		addr = &g_array_index (q->servers, SockAddr, q->server_idx);
+
+		query_socket_close (q);
+		q->fd = socket (addr->sa.sa_family, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+		if (q->fd < 0) {
+			errsv = errno;
+			_LOGD ("could not create socket for %s: %s",
+			       _sockaddr_to_string (addr, buf), g_strerror (errsv));
+			continue;
+		}
+
+		if (sendto (q->fd, q->query, q->query_len, 0, &addr->sa, _sockaddr_len (addr)) < 0) {
+			errsv = errno;
+			_LOGD ("could not send query for %s to %s: %s",
+			       q->key, _sockaddr_to_string (addr, buf), g_strerror (errsv));
+			continue;
+		}
+
+		q->channel = g_io_channel_unix_new (q->fd);
+		q->channel_id = g_io_add_watch (q->channel, G_IO_IN, query_receive_cb, q);
+		q->timeout_id = g_timeout_add (UPSTREAM_TIMEOUT_MSEC, query_timeout_cb, q);
+		return;
+	}
+
+	query_complete (q, NULL, 0);
+}
+
+static gboolean
+_name_in_domain (const char *name, gsize name_len, const char *domain)
+{
+	gsize domain_len = strlen (domain);
+
+	if (name_len == domain_len)
+		return memcmp (name, domain, domain_len) == 0;
+	return    name_len > domain_len
+	       && name[name_len - domain_len - 1] == '.'
+	       && memcmp (&name[name_len - domain_len], domain, domain_len) == 0;
+}
+
+/* returns the servers for the most specific domain of the name in @key,
+ * or the servers without domain. */
+static GArray *
+_servers_for_key (NMDnsStub *self, const char *key)
+{
+	NMDnsStubPrivate *priv = NM_DNS_STUB_GET_PRIVATE (self);
+	const char *best = NULL;
+	gsize name_len = strchr (key, '/') - key;
+	GArray *result;
+	guint i;
+
+	for (i = 0; i < priv->servers->len; i++) {
+		const Server *server = &g_array_index (priv->servers, Server, i);
+
+		if (   server->domain
+		    && _name_in_domain (key, name_len, server->domain)
+		    && (!best || strlen (server->domain) > strlen (best)))
+			best = server->domain;
+	}
+
+	result = g_array_new (FALSE, FALSE, sizeof (SockAddr));
+	for (i = 0; i < priv->servers->len; i++) {
+		const Server *server = &g_array_index (priv->servers, Server, i);
+
+		if (nm_streq0 (server->domain, best))
+			g_array_append_val (result, server->addr);
+	}
+	return result;
+}
+
+static void
+query_start (NMDnsStub *self,
+             const char *key,
+             const guint8 *data,
+             gsize len,
+             gsize question_len,
+             const Client *client)
+{
+	NMDnsStubPrivate *priv = NM_DNS_STUB_GET_PRIVATE (self);
+	Query *q;
+
+	q = g_hash_table_lookup (priv->queries, key);
+	if (q) {
+		/* the same question is already on its way */
+		if (client)
+			query_add_client (q, client);
+		return;
+	}
+
+	if (g_hash_table_size (priv->queries) >= QUERIES_MAX) {
+		_LOGD ("too many queries, fail %s", key);
+		if (client)
+			send_error (self, data, question_len, client, DNS_RCODE_SERVFAIL);
+		return;
+	}
+
+	q = g_slice_new0 (Query);
+	q->self = self;
+	q->fd = -1;
+	q->key = g_strdup (key);
+	q->question_key = nm_dns_question_key (data, len, NULL);
+	q->query = g_memdup (data, len);
+	q->query_len = len;
+	q->question_len = question_len;
+	q->id = g_random_int () & 0xFFFF;
+	nm_dns_put_u16 (q->query, q->id);
+	/* the client may accept larger replies than we read over UDP */
+	nm_dns_query_clamp_udp_size (q->query, q->query_len, PACKET_SIZE_MAX);
+	q->servers = _servers_for_key (self, key);
+	q->clients = g_array_new (FALSE, FALSE, sizeof (Client));
+	g_array_set_clear_func (q->clients, client_clear);
+	if (client)
+		query_add_client (q, client);
+
+	g_hash_table_insert (priv->queries, q->key, q);
+	query_send (q);
+}
+
+/* handles a query from @from over UDP, or on @conn over TCP. */
+static void
+handle_query (NMDnsStub *self,
+              const guint8 *data,
+              gsize len,
+              const SockAddr *from,
+              TcpConn *conn)
+{
+	NMDnsStubPrivate *priv = NM_DNS_STUB_GET_PRIVATE (self);
+	gs_free char *key = NULL;
+	Client client = {
+		.conn = conn,
+		.udp_size = DNS_UDP_SIZE_DEFAULT,
+	};
+	CacheEntry *entry;
+	gsize question_len = 0;
+	guint16 flags;
+
+	if (len < DNS_HEADER_SIZE)
+		return;
+
+	flags = nm_dns_get_u16 (&data[2]);
+	if (flags & DNS_FLAG_QR)
+		return;
+
+	if (from)
+		client.addr = *from;
+	client.id = nm_dns_get_u16 (data);
+
+	if (DNS_OPCODE (flags) != 0) {
+		send_error (self, data, DNS_HEADER_SIZE, &client, DNS_RCODE_NOTIMP);
+		return;
+	}
+	key = nm_dns_query_key (data, len, &question_len, &client.udp_size);
+	if (!key) {
+		send_error (self, data, DNS_HEADER_SIZE, &client, DNS_RCODE_FORMERR);
+		return;
+	}
+
+	entry = g_hash_table_lookup (priv->cache, key);
+	if (entry) {
+		gint64 elapsed = (nm_utils_get_monotonic_timestamp_ms () - entry->timestamp) / 1000;
+
+		if (elapsed < entry->ttl) {
+			gs_free guint8 *buf = g_memdup (entry->reply, entry->reply_len);
+
+			priv->num_hits++;
+			nm_dns_reply_ttl (buf, entry->reply_len, elapsed);
+			send_reply (self, buf, entry->reply_len, &client);
+
+			g_queue_unlink (&priv->cache_lru, &entry->lru_link);
+			g_queue_push_tail_link (&priv->cache_lru, &entry->lru_link);
+
+			if (   entry->ttl >= PREFETCH_TTL_MIN
+			    && (entry->ttl - elapsed) * 100 < entry->ttl * PREFETCH_PERCENT) {
+				_LOGT ("prefetch %s", key);
+				query_start (self, key, data, len, question_len, NULL);
+			}
+			return;
+		}
+		cache_remove (self, entry);
+	}
+
+	priv->num_misses++;
+	query_start (self, key, data, len, question_len, &client);
+}
+
+static gboolean
+listen_receive_cb (GIOChannel *channel, GIOCondition condition, gpointer user_data)
+{
+	NMDnsStub *self = user_data;
+	NMDnsStubPrivate *priv = NM_DNS_STUB_GET_PRIVATE (self);
+	guint8 buf[PACKET_SIZE_MAX];
+	SockAddr from;
+	socklen_t from_len = sizeof (from);
+	ssize_t len;
+
+	len = recvfrom (priv->fd, buf, sizeof (buf), 0, &from.sa, &from_len);
+	if (len > 0)
+		handle_query (self, buf, len, &from, NULL);
+	return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+listen_accept_cb (GIOChannel *channel, GIOCondition condition, gpointer user_data)
+{
+	NMDnsStub *self = user_data;
+	NMDnsStubPrivate *priv = NM_DNS_STUB_GET_PRIVATE (self);
+	TcpConn *conn;
+	int fd;
+
+	for (;;) {
+		fd = accept4 (priv->tcp_fd, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
+		if (fd < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+
+		if (g_slist_length (priv->tcp_conns) >= TCP_CONNECTIONS_MAX) {
+			_LOGD ("rejecting TCP connection, too many open");
+			close (fd);
+			continue;
+		}
+
+		conn = g_slice_new0 (TcpConn);
+		conn->self = self;
+		conn->ref_count = 1;
+		conn->fd = fd;
+		conn->out_buf = g_byte_array_new ();
+		conn->channel = g_io_channel_unix_new (fd);
+		conn->in_id = g_io_add_watch (conn->channel, G_IO_IN | G_IO_HUP | G_IO_ERR,
+		                              tcp_conn_in_cb, conn);
+		conn->timeout_id = g_timeout_add_seconds (TCP_IDLE_TIMEOUT_SEC, tcp_conn_timeout_cb, conn);
+		priv->tcp_conns = g_slist_prepend (priv->tcp_conns, conn);
+	}
+
+	return G_SOURCE_CONTINUE;
+}
+
+static void
+listen_close (NMDnsStub *self)
+{
+	NMDnsStubPrivate *priv = NM_DNS_STUB_GET_PRIVATE (self);
+
+	nm_clear_g_source (&priv->channel_id);
+	if (priv->channel) {
+		g_io_channel_unref (priv->channel);
+		priv->channel = NULL;
+	}
+	if (priv->fd >= 0) {
+		close (priv->fd);
+		priv->fd = -1;
+	}
+
+	while (priv->tcp_conns)
+		tcp_conn_close (priv->tcp_conns->data);
+	nm_clear_g_source (&priv->tcp_channel_id);
+	if (priv->tcp_channel) {
+		g_io_channel_unref (priv->tcp_channel);
+		priv->tcp_channel = NULL;
+	}
+	if (priv->tcp_fd >= 0) {
+		close (priv->tcp_fd);
+		priv->tcp_fd = -1;
+	}
+}
+
+static gboolean
+listen_open (NMDnsStub *self)
+{
+	NMDnsStubPrivate *priv = NM_DNS_STUB_GET_PRIVATE (self);
+	SockAddr addr = {
+		.in = {
+			.sin_family = AF_INET,
+			.sin_port = htons (STUB_PORT),
+			.sin_addr.s_addr = htonl (INADDR_LOOPBACK),
+		},
+	};
+	int one = 1;
+	int errsv;
+
+	if (priv->fd >= 0)
+		return TRUE;
+
+	priv->fd = socket (AF_INET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+	if (priv->fd < 0) {
+		errsv = errno;
+		_LOGW ("could not create socket: %s", g_strerror (errsv));
+		return FALSE;
+	}
+	setsockopt (priv->fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof (one));
+
+	if (bind (priv->fd, &addr.sa, sizeof (addr.in)) < 0) {
+		errsv = errno;
+		_LOGW ("could not listen on 127.0.0.1:%d: %s", STUB_PORT, g_strerror (errsv));
+		listen_close (self);
+		return FALSE;
+	}
+
+	/* clients ask again over TCP when the reply is truncated */
+	priv->tcp_fd = socket (AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+	if (priv->tcp_fd < 0) {
+		errsv = errno;
+		_LOGW ("could not create TCP socket: %s", g_strerror (errsv));
+		listen_close (self);
+		return FALSE;
+	}
+	setsockopt (priv->tcp_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof (one));
+
+	if (   bind (priv->tcp_fd, &addr.sa, sizeof (addr.in)) < 0
+	    || listen (priv->tcp_fd, TCP_CONNECTIONS_MAX) < 0) {
+		errsv = errno;
+		_LOGW ("could not listen on TCP 127.0.0.1:%d: %s", STUB_PORT, g_strerror (errsv));
+		listen_close (self);
+		return FALSE;
+	}
+
+	_LOGI ("listening on 127.0.0.1:%d", STUB_PORT);
+	priv->channel = g_io_channel_unix_new (priv->fd);
+	priv->channel_id = g_io_add_watch (priv->channel, G_IO_IN, listen_receive_cb, self);
+	priv->tcp_channel = g_io_channel_unix_new (priv->tcp_fd);
+	priv->tcp_channel_id = g_io_add_watch (priv->tcp_channel, G_IO_IN, listen_accept_cb, self);
+	return TRUE;
+}
+
+/*****************************************************************************/
+
+static void
+server_clear (gpointer data)
+{
+	g_free (((Server *) data)->domain);
+}
+
+static void
+add_server (NMDnsStub *self, GArray *servers, const SockAddr *addr, const char *domain)
+{
+	char buf[NM_UTILS_INET_ADDRSTRLEN];
+	Server server = { .addr = *addr };
+	guint i;
+
+	if (domain) {
+		server.domain = g_ascii_strdown (domain, -1);
+		g_strchomp (server.domain);
+		while (g_str_has_suffix (server.domain, "."))
+			server.domain[strlen (server.domain) - 1] = '\0';
+		if (!server.domain[0])
+			g_clear_pointer (&server.domain, g_free);
+	}
+
+	for (i = 0; i < servers->len; i++) {
+		const Server *s = &g_array_index (servers, Server, i);
+
+		if (   _sockaddr_equal (&s->addr, &server.addr)
+		    && nm_streq0 (s->domain, server.domain)) {
+			g_free (server.domain);
+			return;
+		}
+	}
+
+	_LOGD ("adding nameserver '%s'%s%s%s", _sockaddr_to_string (addr, buf),
+	       NM_PRINT_FMT_QUOTED (server.domain, " for domain \"", server.domain, "\"", ""));
+	g_array_append_val (servers, server);
+}
+
+static void
+add_nameserver (NMDnsStub *self,
+                GArray *servers,
+                const SockAddr *addr,
+                GPtrArray *domains,
+                gboolean add_default)
+{
+	guint i;
+
+	for (i = 0; i < domains->len; i++)
+		add_server (self, servers, addr, domains->pdata[i]);
+	if (add_default)
+		add_server (self, servers, addr, NULL);
+}
+
+static void
+add_ip4_config (NMDnsStub *self, GArray *servers, NMIP4Config *ip4, gboolean split)
+{
+	gs_unref_ptrarray GPtrArray *domains = g_ptr_array_new_with_free_func (g_free);
+	gboolean add_default = TRUE;
+	guint i, n;
+
+	if (split) {
+		/* searches are preferred over domains */
+		n = nm_ip4_config_get_num_searches (ip4);
+		for (i = 0; i < n; i++)
+			g_ptr_array_add (domains, g_strdup (nm_ip4_config_get_search (ip4, i)));
+		if (n == 0) {
+			n = nm_ip4_config_get_num_domains (ip4);
+			for (i = 0; i < n; i++)
+				g_ptr_array_add (domains, g_strdup (nm_ip4_config_get_domain (ip4, i)));
+		}
+		add_default = (domains->len == 0);
+
+		/* send reverse lookups for the networks of the VPN to its nameservers */
+		for (i = 0; i < nm_ip4_config_get_num_addresses (ip4); i++) {
+			const NMPlatformIP4Address *address = nm_ip4_config_get_address (ip4, i);
+
+			nm_utils_get_reverse_dns_domains_ip4 (address->address, address->plen, domains);
+		}
+		for (i = 0; i < nm_ip4_config_get_num_routes (ip4); i++) {
+			const NMPlatformIP4Route *route = nm_ip4_config_get_route (ip4, i);
+
+			nm_utils_get_reverse_dns_domains_ip4 (route->network, route->plen, domains);
+		}
+	}
+
+	n = nm_ip4_config_get_num_nameservers (ip4);
+	for (i = 0; i < n; i++) {
+		SockAddr addr = {
+			.in = {
+				.sin_family = AF_INET,
+				.sin_port = htons (53),
+				.sin_addr.s_addr = nm_ip4_config_get_nameserver (ip4, i),
+			},
+		};
+
+		add_nameserver (self, servers, &addr, domains, add_default);
+	}
+}
+
+static void
+add_ip6_config (NMDnsStub *self, GArray *servers, NMIP6Config *ip6,
+                const char *iface, gboolean split)
+{
+	gs_unref_ptrarray GPtrArray *domains = g_ptr_array_new_with_free_func (g_free);
+	gboolean add_default = TRUE;
+	guint i, n;
+
+	if (split) {
+		/* searches are preferred over domains */
+		n = nm_ip6_config_get_num_searches (ip6);
+		for (i = 0; i < n; i++)
+			g_ptr_array_add (domains, g_strdup (nm_ip6_config_get_search (ip6, i)));
+		if (n == 0) {
+			n = nm_ip6_config_get_num_domains (ip6);
+			for (i = 0; i < n; i++)
+				g_ptr_array_add (domains, g_strdup (nm_ip6_config_get_domain (ip6, i)));
+		}
+		add_default = (domains->len == 0);
+
+		/* send reverse lookups for the networks of the VPN to its nameservers */
+		for (i = 0; i < nm_ip6_config_get_num_addresses (ip6); i++) {
+			const NMPlatformIP6Address *address = nm_ip6_config_get_address (ip6, i);
+
+			nm_utils_get_reverse_dns_domains_ip6 (&address->address, address->plen, domains);
+		}
+		for (i = 0; i < nm_ip6_config_get_num_routes (ip6); i++) {
+			const NMPlatformIP6Route *route = nm_ip6_config_get_route (ip6, i);
+
+			nm_utils_get_reverse_dns_domains_ip6 (&route->network, route->plen, domains);
+		}
+	}
+
+	n = nm_ip6_config_get_num_nameservers (ip6);
+	for (i = 0; i < n; i++) {
+		const struct in6_addr *ns = nm_ip6_config_get_nameserver (ip6, i);
+		SockAddr addr = { 0 };
+
+		if (IN6_IS_ADDR_V4MAPPED (ns)) {
+			addr.in.sin_family = AF_INET;
+			addr.in.sin_port = htons (53);
+			addr.in.sin_addr.s_addr = ns->s6_addr32[3];
+		} else {
+			addr.in6.sin6_family = AF_INET6;
+			addr.in6.sin6_port = htons (53);
+			addr.in6.sin6_addr = *ns;
+			/* link-local nameservers are only reachable on their interface */
+			if (IN6_IS_ADDR_LINKLOCAL (ns))
+				addr.in6.sin6_scope_id = nm_platform_link_get_ifindex (NM_PLATFORM_GET, iface);
+		}
+
+		add_nameserver (self, servers, &addr, domains, add_default);
+	}
+}
+
+static void
+add_global_config (NMDnsStub *self, GArray *servers, const NMGlobalDnsConfig *config)
+{
+	guint i, j;
+
+	for (i = 0; i < nm_global_dns_config_get_num_domains (config); i++) {
+		NMGlobalDnsDomain *domain = nm_global_dns_config_get_domain (config, i);
+		const char *const *strv = nm_global_dns_domain_get_servers (domain);
+		const char *name = nm_global_dns_domain_get_name (domain);
+
+		for (j = 0; strv && strv[j]; j++) {
+			SockAddr addr = { 0 };
+
+			if (inet_pton (AF_INET, strv[j], &addr.in.sin_addr) == 1) {
+				addr.in.sin_family = AF_INET;
+				addr.in.sin_port = htons (53);
+			} else if (inet_pton (AF_INET6, strv[j], &addr.in6.sin6_addr) == 1) {
+				addr.in6.sin6_family = AF_INET6;
+				addr.in6.sin6_port = htons (53);
+			} else
+				continue;
+
+			add_server (self, servers, &addr, nm_streq0 (name, "*") ? NULL : name);
+		}
+	}
+}
+
+static gboolean
+_servers_equal (GArray *a, GArray *b)
+{
+	guint i;
+
+	if (a->len != b->len)
+		return FALSE;
+	for (i = 0; i < a->len; i++) {
+		const Server *sa = &g_array_index (a, Server, i);
+		const Server *sb = &g_array_index (b, Server, i);
+
+		if (   !_sockaddr_equal (&sa->addr, &sb->addr)
+		    || !nm_streq0 (sa->domain, sb->domain))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static gboolean
+update (NMDnsPlugin *plugin,
+        const NMDnsIPConfigData **configs,
+        const NMGlobalDnsConfig *global_config,
+        const char *hostname)
+{
+	NMDnsStub *self = NM_DNS_STUB (plugin);
+	NMDnsStubPrivate *priv = NM_DNS_STUB_GET_PRIVATE (self);
+	GArray *servers;
+
+	if (!listen_open (self))
+		return FALSE;
+
+	servers = g_array_new (FALSE, FALSE, sizeof (Server));
+	g_array_set_clear_func (servers, server_clear);
+
+	if (global_config)
+		add_global_config (self, servers, global_config);
+	else {
+		for (; *configs; configs++) {
+			const NMDnsIPConfigData *data = *configs;
+
+			if (NM_IS_IP4_CONFIG (data->config)) {
+				add_ip4_config (self, servers, data->config,
+				                data->type == NM_DNS_IP_CONFIG_TYPE_VPN);
+			} else if (NM_IS_IP6_CONFIG (data->config)) {
+				add_ip6_config (self, servers, data->config, data->iface,
+				                data->type == NM_DNS_IP_CONFIG_TYPE_VPN);
+			}
+		}
+	}
+
+	/* queries in flight keep going to the servers they were started
+	 * with. Cached answers might come from servers that are gone. */
+	if (_servers_equal (priv->servers, servers)) {
+		g_array_unref (servers);
+		return TRUE;
+	}
+
+	g_array_unref (priv->servers);
+	priv->servers = servers;
+	cache_flush (self);
+	return TRUE;
+}
+
+/*****************************************************************************/
+
+static gboolean
+reload (NMDnsPlugin *plugin)
+{
+	/* there is no configuration besides the nameservers. */
+	return TRUE;
+}
+
+static gboolean
+is_caching (NMDnsPlugin *plugin)
+{
+	return TRUE;
+}
+
+static const char *
+get_name (NMDnsPlugin *plugin)
+{
+	return "stub";
+}
+
+/*****************************************************************************/
+
+static void
+nm_dns_stub_init (NMDnsStub *self)
+{
+	NMDnsStubPrivate *priv = NM_DNS_STUB_GET_PRIVATE (self);
+
+	priv->fd = -1;
+	priv->tcp_fd = -1;
+	priv->servers = g_array_new (FALSE, FALSE, sizeof (Server));
+	g_array_set_clear_func (priv->servers, server_clear);
+	priv->cache = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, cache_entry_free);
+	g_queue_init (&priv->cache_lru);
+	priv->queries = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, query_free);
+}
+
+NMDnsPlugin *
+nm_dns_stub_new (void)
+{
+	return g_object_new (NM_TYPE_DNS_STUB, NULL);
+}
+
+static void
+dispose (GObject *object)
+{
+	NMDnsStub *self = NM_DNS_STUB (object);
+	NMDnsStubPrivate *priv = NM_DNS_STUB_GET_PRIVATE (self);
+
+	listen_close (self);
+
+	if (priv->queries) {
+		g_hash_table_unref (priv->queries);
+		priv->queries = NULL;
+	}
+	if (priv->cache) {
+		cache_flush (self);
+		g_hash_table_unref (priv->cache);
+		priv->cache = NULL;
+	}
+	g_clear_pointer (&priv->servers, g_array_unref);
+
+	G_OBJECT_CLASS (nm_dns_stub_parent_class)->dispose (object);
+}
+
+static void
+nm_dns_stub_class_init (NMDnsStubClass *klass)
+{
+	NMDnsPluginClass *plugin_class = NM_DNS_PLUGIN_CLASS (klass);
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->dispose = dispose;
+
+	plugin_class->is_caching = is_caching;
+	plugin_class->update = update;
+	plugin_class->get_name = get_name;
+	plugin_class->reload = reload;
+}
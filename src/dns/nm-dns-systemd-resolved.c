@@ -51,6 +51,13 @@ typedef struct {
 	GList *configs;
 } InterfaceConfig;
 
+/* the configuration last sent to resolved for a link */
+typedef struct {
+	GVariant *dns;
+	GVariant *domains;
+	guint generation;
+} LinkState;
+
 /*****************************************************************************/
 
 typedef struct {
@@ -59,6 +66,10 @@ typedef struct {
 	GCancellable *update_cancellable;
 	GQueue dns_updates;
 	GQueue domain_updates;
+
+	/* ifindex to LinkState */
+	GHashTable *links;
+	guint generation;
 } NMDnsSystemdResolvedPrivate;
 
 struct _NMDnsSystemdResolved {
@@ -81,12 +92,33 @@ G_DEFINE_TYPE (NMDnsSystemdResolved, nm_dns_systemd_resolved, NM_TYPE_DNS_PLUGIN
 
 /*****************************************************************************/
 
+static void
+link_state_free (gpointer data)
+{
+	LinkState *state = data;
+
+	if (state->dns)
+		g_variant_unref (state->dns);
+	if (state->domains)
+		g_variant_unref (state->domains);
+	g_slice_free (LinkState, state);
+}
+
+typedef struct {
+	NMDnsSystemdResolved *self;
+	int ifindex;
+} CallData;
+
 static void
 call_done (GObject *source, GAsyncResult *r, gpointer user_data)
 {
-	GVariant *v;
-	GError *error = NULL;
-	NMDnsSystemdResolved *self = (NMDnsSystemdResolved *) user_data;
+	gs_unref_variant GVariant *v = NULL;
+	gs_free_error GError *error = NULL;
+	CallData *data = user_data;
+	NMDnsSystemdResolved *self = data->self;
+	int ifindex = data->ifindex;
+
+	g_slice_free (CallData, data);
 
 	v = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), r, &error);
 
@@ -95,8 +127,57 @@ call_done (GObject *source, GAsyncResult *r, gpointer user_data)
 
 	if (error != NULL) {
 		_LOGW ("Failed: %s\n", error->message);
-		g_error_free (error);
+
+		/* we don't know what resolved has for the link. Send it
+		 * again with the next update. */
+		g_hash_table_remove (NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE (self)->links,
+		                     GINT_TO_POINTER (ifindex));
+	}
+}
+
+static void
+send_link_value (NMDnsSystemdResolved *self,
+                 const char *method,
+                 GVariant *value,
+                 GVariant **last_sent)
+{
+	NMDnsSystemdResolvedPrivate *priv = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE (self);
+	CallData *data;
+
+	if (*last_sent && g_variant_equal (*last_sent, value))
+		return;
+
+	if (*last_sent)
+		g_variant_unref (*last_sent);
+	*last_sent = g_variant_ref (value);
+
+	data = g_slice_new (CallData);
+	data->self = self;
+	g_variant_get_child (value, 0, "i", &data->ifindex);
+
+	/* the calls are not serialized, all of them are in flight
+	 * at the same time. */
+	g_dbus_proxy_call (priv->resolve, method, value,
+	                   G_DBUS_CALL_FLAGS_NONE,
+	                   -1, priv->update_cancellable, call_done, data);
+}
+
+static LinkState *
+link_state_get (NMDnsSystemdResolved *self, GVariant *value)
+{
+	NMDnsSystemdResolvedPrivate *priv = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE (self);
+	LinkState *state;
+	int ifindex;
+
+	g_variant_get_child (value, 0, "i", &ifindex);
+
+	state = g_hash_table_lookup (priv->links, GINT_TO_POINTER (ifindex));
+	if (!state) {
+		state = g_slice_new0 (LinkState);
+		g_hash_table_insert (priv->links, GINT_TO_POINTER (ifindex), state);
 	}
+	state->generation = priv->generation;
+	return state;
 }
 
 static void
@@ -261,32 +342,42 @@ prepare_one_interface (NMDnsSystemdResolved *self, InterfaceConfig *ic)
 	                   g_variant_ref_sink (g_variant_builder_end (&domains)));
 }
 
+static gboolean
+link_state_is_stale (gpointer key, gpointer value, gpointer user_data)
+{
+	return ((LinkState *) value)->generation != GPOINTER_TO_UINT (user_data);
+}
+
+/* sends the prepared updates for the links whose configuration differs
+ * from what was last sent. The state of links that are no longer
+ * configured is forgotten, so that they are sent again when they
+ * get configured. */
 static void
 send_updates (NMDnsSystemdResolved *self)
 {
 	NMDnsSystemdResolvedPrivate *priv = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE (self);
 	GVariant *v;
 
-	nm_clear_g_cancellable (&priv->update_cancellable);
-
 	if (!priv->resolve)
 		return;
 
-	priv->update_cancellable = g_cancellable_new ();
+	if (!priv->update_cancellable)
+		priv->update_cancellable = g_cancellable_new ();
+
+	priv->generation++;
 
 	while ((v = g_queue_pop_head (&priv->dns_updates)) != NULL) {
-		g_dbus_proxy_call (priv->resolve, "SetLinkDNS", v,
-		                   G_DBUS_CALL_FLAGS_NONE,
-		                   -1, priv->update_cancellable, call_done, self);
+		send_link_value (self, "SetLinkDNS", v, &link_state_get (self, v)->dns);
 		g_variant_unref (v);
 	}
 
 	while ((v = g_queue_pop_head (&priv->domain_updates)) != NULL) {
-		g_dbus_proxy_call (priv->resolve, "SetLinkDomains", v,
-		                   G_DBUS_CALL_FLAGS_NONE,
-		                   -1, priv->update_cancellable, call_done, self);
+		send_link_value (self, "SetLinkDomains", v, &link_state_get (self, v)->domains);
 		g_variant_unref (v);
 	}
+
+	g_hash_table_foreach_remove (priv->links, link_state_is_stale,
+	                             GUINT_TO_POINTER (priv->generation));
 }
 
 static gboolean
@@ -371,6 +462,8 @@ nm_dns_systemd_resolved_init (NMDnsSystemdResolved *self)
 
 	g_queue_init (&priv->dns_updates);
 	g_queue_init (&priv->domain_updates);
+	priv->links = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+	                                     NULL, link_state_free);
 
 	dbus_mgr = nm_bus_manager_get ();
 	g_return_if_fail (dbus_mgr);
@@ -407,6 +500,7 @@ dispose (GObject *object)
 	g_clear_object (&priv->resolve);
 	nm_clear_g_cancellable (&priv->init_cancellable);
 	nm_clear_g_cancellable (&priv->update_cancellable);
+	g_clear_pointer (&priv->links, g_hash_table_unref);
 
 	G_OBJECT_CLASS (nm_dns_systemd_resolved_parent_class)->dispose (object);
 }
@@ -0,0 +1,270 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2017 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "nm-dns-utils.h"
+
+/*****************************************************************************/
+
+/* Moves @pos past the name that starts there. A compression pointer ends
+ * the name and is not followed, so there are no loops to detect. */
+gboolean
+nm_dns_skip_name (const guint8 *data, gsize len, gsize *pos)
+{
+	gsize p = *pos;
+	guint8 l;
+
+	for (;;) {
+		if (p >= len)
+			return FALSE;
+		l = data[p];
+		if ((l & 0xC0) == 0xC0) {
+			if (p + 2 > len)
+				return FALSE;
+			*pos = p + 2;
+			return TRUE;
+		}
+		if (l & 0xC0)
+			return FALSE;
+		p += 1 + l;
+		if (l == 0) {
+			*pos = p;
+			return TRUE;
+		}
+	}
+}
+
+/* Returns the key of the first question in @data, as "name/type/class"
+ * with the name in lower case. Bytes that could make two names look the
+ * same are escaped. */
+char *
+nm_dns_question_key (const guint8 *data, gsize len, gsize *out_question_len)
+{
+	GString *str;
+	gsize p = DNS_HEADER_SIZE;
+	guint8 l, c;
+	guint i;
+
+	str = g_string_sized_new (64);
+	for (;;) {
+		if (p >= len)
+			goto fail;
+		l = data[p++];
+		if (l == 0)
+			break;
+		/* no compression in the question */
+		if (l > 63 || p + l > len)
+			goto fail;
+		if (str->len)
+			g_string_append_c (str, '.');
+		for (i = 0; i < l; i++) {
+			c = g_ascii_tolower (data[p + i]);
+			if (   !g_ascii_isgraph (c)
+			    || NM_IN_SET (c, '.', '/', '\\'))
+				g_string_append_printf (str, "\\%03u", c);
+			else
+				g_string_append_c (str, c);
+		}
+		p += l;
+	}
+	if (p + 4 > len)
+		goto fail;
+
+	g_string_append_printf (str, "/%u/%u", nm_dns_get_u16 (&data[p]), nm_dns_get_u16 (&data[p + 2]));
+	NM_SET_OUT (out_question_len, p + 4);
+	return g_string_free (str, FALSE);
+
+fail:
+	g_string_free (str, TRUE);
+	return NULL;
+}
+
+/* Returns the key for the cache of the query @data, which must have
+ * exactly one question. The key of the question is followed by "/edns" or
+ * "/edns+do" if the query has an OPT record, because the reply depends on
+ * it. @out_udp_size is the largest reply the client accepts over UDP. */
+char *
+nm_dns_query_key (const guint8 *data,
+                  gsize len,
+                  gsize *out_question_len,
+                  guint16 *out_udp_size)
+{
+	gs_free char *key = NULL;
+	gboolean has_opt = FALSE;
+	guint16 udp_size = DNS_UDP_SIZE_DEFAULT;
+	guint32 edns_flags = 0;
+	gsize question_len;
+	gsize p;
+	guint i, n_before, n;
+
+	if (   len < DNS_HEADER_SIZE
+	    || nm_dns_get_u16 (&data[4]) != 1)
+		return NULL;
+
+	key = nm_dns_question_key (data, len, &question_len);
+	if (!key)
+		return NULL;
+
+	/* the OPT record is among the additional records */
+	n_before = nm_dns_get_u16 (&data[6]) + nm_dns_get_u16 (&data[8]);
+	n = n_before + nm_dns_get_u16 (&data[10]);
+	p = question_len;
+	for (i = 0; i < n; i++) {
+		guint16 rdlength;
+
+		if (   !nm_dns_skip_name (data, len, &p)
+		    || p + 10 > len)
+			return NULL;
+		rdlength = nm_dns_get_u16 (&data[p + 8]);
+		if (p + 10 + rdlength > len)
+			return NULL;
+
+		if (   i >= n_before
+		    && nm_dns_get_u16 (&data[p]) == DNS_TYPE_OPT) {
+			/* more than one is an error (RFC 6891, section 6.1.1) */
+			if (has_opt)
+				return NULL;
+			has_opt = TRUE;
+			/* the class field of the OPT record holds the UDP payload size */
+			udp_size = MAX (nm_dns_get_u16 (&data[p + 2]), DNS_UDP_SIZE_DEFAULT);
+			edns_flags = nm_dns_get_u32 (&data[p + 4]);
+		}
+		p += 10 + rdlength;
+	}
+
+	NM_SET_OUT (out_question_len, question_len);
+	NM_SET_OUT (out_udp_size, udp_size);
+	if (!has_opt)
+		return g_steal_pointer (&key);
+	return g_strdup_printf ("%s/edns%s", key,
+	                        (edns_flags & DNS_EDNS_FLAG_DO) ? "+do" : "");
+}
+
+/* Lowers the UDP payload size that the query @data advertises in its OPT
+ * record to @udp_size_max, so that the server doesn't send a larger reply
+ * than we can read. Returns whether the query was changed. */
+gboolean
+nm_dns_query_clamp_udp_size (guint8 *data, gsize len, guint16 udp_size_max)
+{
+	gsize p = DNS_HEADER_SIZE;
+	guint i, n_before, n;
+
+	if (len < DNS_HEADER_SIZE)
+		return FALSE;
+
+	for (i = nm_dns_get_u16 (&data[4]); i > 0; i--) {
+		if (   !nm_dns_skip_name (data, len, &p)
+		    || p + 4 > len)
+			return FALSE;
+		p += 4;
+	}
+
+	n_before = nm_dns_get_u16 (&data[6]) + nm_dns_get_u16 (&data[8]);
+	n = n_before + nm_dns_get_u16 (&data[10]);
+	for (i = 0; i < n; i++) {
+		if (   !nm_dns_skip_name (data, len, &p)
+		    || p + 10 > len
+		    || p + 10 + nm_dns_get_u16 (&data[p + 8]) > len)
+			return FALSE;
+
+		if (   i >= n_before
+		    && nm_dns_get_u16 (&data[p]) == DNS_TYPE_OPT) {
+			if (nm_dns_get_u16 (&data[p + 2]) <= udp_size_max)
+				return FALSE;
+			nm_dns_put_u16 (&data[p + 2], udp_size_max);
+			return TRUE;
+		}
+		p += 10 + nm_dns_get_u16 (&data[p + 8]);
+	}
+	return FALSE;
+}
+
+/* Walks over the resource records of the reply @data and returns for how
+ * long the reply can be cached, or zero if not at all. If @elapsed is
+ * not zero, the time to live of the records is decreased by it. */
+guint32
+nm_dns_reply_ttl (guint8 *data, gsize len, guint32 elapsed)
+{
+	guint32 ttl_answer = G_MAXUINT32;
+	guint32 ttl_soa = G_MAXUINT32;
+	guint16 flags, count[3];
+	gsize p = DNS_HEADER_SIZE;
+	guint i, s;
+
+	if (len < DNS_HEADER_SIZE)
+		return 0;
+
+	flags = nm_dns_get_u16 (&data[2]);
+	for (i = nm_dns_get_u16 (&data[4]); i > 0; i--) {
+		if (   !nm_dns_skip_name (data, len, &p)
+		    || p + 4 > len)
+			return 0;
+		p += 4;
+	}
+
+	for (s = 0; s < 3; s++)
+		count[s] = nm_dns_get_u16 (&data[6 + 2 * s]);
+
+	for (s = 0; s < 3; s++) {
+		for (i = 0; i < count[s]; i++) {
+			guint16 type, rdlength;
+			guint32 ttl;
+
+			if (   !nm_dns_skip_name (data, len, &p)
+			    || p + 10 > len)
+				return 0;
+			type = nm_dns_get_u16 (&data[p]);
+			ttl = nm_dns_get_u32 (&data[p + 4]);
+			rdlength = nm_dns_get_u16 (&data[p + 8]);
+			if (p + 10 + rdlength > len)
+				return 0;
+
+			/* the TTL field of the OPT pseudo record holds the EDNS flags */
+			if (type != DNS_TYPE_OPT) {
+				if (elapsed)
+					nm_dns_put_u32 (&data[p + 4], ttl > elapsed ? ttl - elapsed : 0);
+				if (s == 0)
+					ttl_answer = MIN (ttl_answer, ttl);
+				else if (   s == 1
+				         && type == DNS_TYPE_SOA
+				         && rdlength >= 20) {
+					/* the SOA minimum is the negative caching TTL */
+					ttl_soa = MIN (ttl, nm_dns_get_u32 (&data[p + 10 + rdlength - 4]));
+				}
+			}
+			p += 10 + rdlength;
+		}
+	}
+
+	if (flags & DNS_FLAG_TC)
+		return 0;
+
+	switch (DNS_RCODE (flags)) {
+	case DNS_RCODE_NOERROR:
+		if (count[0] > 0)
+			return MIN (ttl_answer, DNS_TTL_MAX);
+		/* no data, fall through */
+	case DNS_RCODE_NXDOMAIN:
+		if (ttl_soa != G_MAXUINT32)
+			return MIN (ttl_soa, DNS_NEGATIVE_TTL_MAX);
+		return DNS_NEGATIVE_TTL_DEFAULT;
+	default:
+		return 0;
+	}
+}
@@ -0,0 +1,102 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2017 Red Hat, Inc.
+ */
+
+#ifndef __NETWORKMANAGER_DNS_UTILS_H__
+#define __NETWORKMANAGER_DNS_UTILS_H__
+
+#include <arpa/inet.h>
+
+/* Parsing of DNS messages (RFC 1035) for the stub resolver. */
+
+#define DNS_HEADER_SIZE         12
+#define DNS_FLAG_QR             0x8000
+#define DNS_FLAG_TC             0x0200
+#define DNS_FLAG_RD             0x0100
+#define DNS_FLAG_RA             0x0080
+#define DNS_OPCODE(flags)       (((flags) >> 11) & 0xF)
+#define DNS_RCODE(flags)        ((flags) & 0xF)
+
+#define DNS_RCODE_NOERROR       0
+#define DNS_RCODE_FORMERR       1
+#define DNS_RCODE_SERVFAIL      2
+#define DNS_RCODE_NXDOMAIN      3
+#define DNS_RCODE_NOTIMP        4
+#define DNS_RCODE_REFUSED       5
+
+#define DNS_TYPE_SOA            6
+#define DNS_TYPE_OPT            41
+
+/* the largest reply over UDP without EDNS0 (RFC 1035, section 4.2.1) */
+#define DNS_UDP_SIZE_DEFAULT    512
+
+/* the DO bit in the TTL field of the OPT record (RFC 3225) */
+#define DNS_EDNS_FLAG_DO        0x8000
+
+/* time to live limits of cached replies, in seconds. Negative answers
+ * without SOA record are cached for DNS_NEGATIVE_TTL_DEFAULT (RFC 2308,
+ * section 5). */
+#define DNS_TTL_MAX             86400
+#define DNS_NEGATIVE_TTL_DEFAULT 60
+#define DNS_NEGATIVE_TTL_MAX    10800
+
+static inline guint16
+nm_dns_get_u16 (const guint8 *data)
+{
+	guint16 v;
+
+	memcpy (&v, data, sizeof (v));
+	return ntohs (v);
+}
+
+static inline guint32
+nm_dns_get_u32 (const guint8 *data)
+{
+	guint32 v;
+
+	memcpy (&v, data, sizeof (v));
+	return ntohl (v);
+}
+
+static inline void
+nm_dns_put_u16 (guint8 *data, guint16 v)
+{
+	v = htons (v);
+	memcpy (data, &v, sizeof (v));
+}
+
+static inline void
+nm_dns_put_u32 (guint8 *data, guint32 v)
+{
+	v = htonl (v);
+	memcpy (data, &v, sizeof (v));
+}
+
+gboolean nm_dns_skip_name (const guint8 *data, gsize len, gsize *pos);
+
+char *nm_dns_question_key (const guint8 *data, gsize len, gsize *out_question_len);
+
+char *nm_dns_query_key (const guint8 *data,
+                        gsize len,
+                        gsize *out_question_len,
+                        guint16 *out_udp_size);
+
+gboolean nm_dns_query_clamp_udp_size (guint8 *data, gsize len, guint16 udp_size_max);
+
+guint32 nm_dns_reply_ttl (guint8 *data, gsize len, guint32 elapsed);
+
+#endif /* __NETWORKMANAGER_DNS_UTILS_H__ */
@@ -0,0 +1,407 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ */
+
+#include "nm-default.h"
+
+#include "dns/nm-dns-utils.h"
+
+#include "nm-test-utils-core.h"
+
+/*****************************************************************************/
+
+static void
+_add_u16 (GByteArray *msg, guint16 v)
+{
+	guint8 buf[2];
+
+	nm_dns_put_u16 (buf, v);
+	g_byte_array_append (msg, buf, sizeof (buf));
+}
+
+static void
+_add_u32 (GByteArray *msg, guint32 v)
+{
+	guint8 buf[4];
+
+	nm_dns_put_u32 (buf, v);
+	g_byte_array_append (msg, buf, sizeof (buf));
+}
+
+static void
+_add_name (GByteArray *msg, const char *name)
+{
+	gs_strfreev char **labels = g_strsplit (name, ".", -1);
+	guint i;
+
+	for (i = 0; labels[i]; i++) {
+		guint8 l = strlen (labels[i]);
+
+		if (!l)
+			continue;
+		g_byte_array_append (msg, &l, 1);
+		g_byte_array_append (msg, (const guint8 *) labels[i], l);
+	}
+	g_byte_array_append (msg, (const guint8 *) "", 1);
+}
+
+static GByteArray *
+_new_msg (guint16 flags, guint16 qd, guint16 an, guint16 ns, guint16 ar)
+{
+	GByteArray *msg = g_byte_array_new ();
+
+	_add_u16 (msg, 0x1234);
+	_add_u16 (msg, flags);
+	_add_u16 (msg, qd);
+	_add_u16 (msg, an);
+	_add_u16 (msg, ns);
+	_add_u16 (msg, ar);
+	return msg;
+}
+
+static void
+_add_question (GByteArray *msg, const char *name, guint16 type)
+{
+	_add_name (msg, name);
+	_add_u16 (msg, type);
+	_add_u16 (msg, 1);
+}
+
+static void
+_add_rr (GByteArray *msg, const char *name, guint16 type, guint32 ttl,
+         const guint8 *rdata, guint16 rdlength)
+{
+	_add_name (msg, name);
+	_add_u16 (msg, type);
+	_add_u16 (msg, 1);
+	_add_u32 (msg, ttl);
+	_add_u16 (msg, rdlength);
+	g_byte_array_append (msg, rdata, rdlength);
+}
+
+static void
+_add_a (GByteArray *msg, const char *name, guint32 ttl)
+{
+	static const guint8 addr[4] = { 192, 0, 2, 1 };
+
+	_add_rr (msg, name, 1, ttl, addr, sizeof (addr));
+}
+
+static void
+_add_soa (GByteArray *msg, const char *name, guint32 ttl, guint32 minimum)
+{
+	guint8 rdata[22] = { 0 };
+
+	/* root mname and rname, then serial, refresh, retry, expire, minimum */
+	nm_dns_put_u32 (&rdata[18], minimum);
+	_add_rr (msg, name, DNS_TYPE_SOA, ttl, rdata, sizeof (rdata));
+}
+
+static void
+_add_opt (GByteArray *msg, guint16 udp_size, guint32 flags)
+{
+	g_byte_array_append (msg, (const guint8 *) "", 1);
+	_add_u16 (msg, DNS_TYPE_OPT);
+	_add_u16 (msg, udp_size);
+	_add_u32 (msg, flags);
+	_add_u16 (msg, 0);
+}
+
+/*****************************************************************************/
+
+static void
+test_skip_name (void)
+{
+	static const guint8 plain[] = "\3www\7example\3com";
+	static const guint8 pointer[] = { 3, 'w', 'w', 'w', 0xC0, 0x00 };
+	static const guint8 loop[] = { 0xC0, 0x00 };
+	static const guint8 truncated_label[] = { 3, 'w', 'w' };
+	static const guint8 truncated_pointer[] = { 3, 'w', 'w', 'w', 0xC0 };
+	static const guint8 unterminated[] = { 3, 'w', 'w', 'w' };
+	static const guint8 bad_label[] = { 0x43, 'w', 'w', 'w', 0 };
+	gsize pos;
+
+	pos = 0;
+	g_assert (nm_dns_skip_name (plain, sizeof (plain), &pos));
+	g_assert_cmpint (pos, ==, sizeof (plain));
+
+	/* a pointer ends the name */
+	pos = 0;
+	g_assert (nm_dns_skip_name (pointer, sizeof (pointer), &pos));
+	g_assert_cmpint (pos, ==, sizeof (pointer));
+
+	/* pointers are not followed, so a pointer to itself is no loop */
+	pos = 0;
+	g_assert (nm_dns_skip_name (loop, sizeof (loop), &pos));
+	g_assert_cmpint (pos, ==, 2);
+
+	pos = 0;
+	g_assert (!nm_dns_skip_name (truncated_label, sizeof (truncated_label), &pos));
+	g_assert (!nm_dns_skip_name (truncated_pointer, sizeof (truncated_pointer), &pos));
+	g_assert (!nm_dns_skip_name (unterminated, sizeof (unterminated), &pos));
+	g_assert (!nm_dns_skip_name (bad_label, sizeof (bad_label), &pos));
+	g_assert_cmpint (pos, ==, 0);
+
+	pos = 1;
+	g_assert (!nm_dns_skip_name (loop, 1, &pos));
+}
+
+static void
+test_question_key (void)
+{
+	GByteArray *msg;
+	char *key;
+	gsize question_len;
+
+	msg = _new_msg (0, 1, 0, 0, 0);
+	_add_question (msg, "WWW.Example.com", 28);
+	key = nm_dns_question_key (msg->data, msg->len, &question_len);
+	g_assert_cmpstr (key, ==, "www.example.com/28/1");
+	g_assert_cmpint (question_len, ==, msg->len);
+	g_free (key);
+
+	/* the class is missing */
+	key = nm_dns_question_key (msg->data, msg->len - 1, NULL);
+	g_assert (!key);
+	g_byte_array_unref (msg);
+
+	msg = _new_msg (0, 1, 0, 0, 0);
+	_add_question (msg, "", 2);
+	key = nm_dns_question_key (msg->data, msg->len, NULL);
+	g_assert_cmpstr (key, ==, "/2/1");
+	g_free (key);
+	g_byte_array_unref (msg);
+
+	/* a dot or slash inside a label doesn't make it look like another name */
+	msg = _new_msg (0, 1, 0, 0, 0);
+	g_byte_array_append (msg, (const guint8 *) "\3a.b\1/\0", 7);
+	_add_u16 (msg, 1);
+	_add_u16 (msg, 1);
+	key = nm_dns_question_key (msg->data, msg->len, NULL);
+	g_assert_cmpstr (key, ==, "a\\046b.\\047/1/1");
+	g_free (key);
+	g_byte_array_unref (msg);
+
+	/* no compression in the question */
+	msg = _new_msg (0, 1, 0, 0, 0);
+	g_byte_array_append (msg, (const guint8 *) "\xC0\x0C", 2);
+	_add_u16 (msg, 1);
+	_add_u16 (msg, 1);
+	g_assert (!nm_dns_question_key (msg->data, msg->len, NULL));
+	g_byte_array_unref (msg);
+
+	/* the name runs past the end */
+	msg = _new_msg (0, 1, 0, 0, 0);
+	g_byte_array_append (msg, (const guint8 *) "\7example", 8);
+	g_assert (!nm_dns_question_key (msg->data, msg->len, NULL));
+	g_byte_array_unref (msg);
+}
+
+static void
+test_query_key (void)
+{
+	GByteArray *msg;
+	char *key;
+	gsize question_len;
+	guint16 udp_size;
+
+	msg = _new_msg (DNS_FLAG_RD, 1, 0, 0, 0);
+	_add_question (msg, "example.com", 1);
+	key = nm_dns_query_key (msg->data, msg->len, &question_len, &udp_size);
+	g_assert_cmpstr (key, ==, "example.com/1/1");
+	g_assert_cmpint (question_len, ==, msg->len);
+	g_assert_cmpint (udp_size, ==, DNS_UDP_SIZE_DEFAULT);
+	g_free (key);
+	g_byte_array_unref (msg);
+
+	/* EDNS0 and the DO bit change the key */
+	msg = _new_msg (DNS_FLAG_RD, 1, 0, 0, 1);
+	_add_question (msg, "example.com", 1);
+	_add_opt (msg, 4096, 0);
+	key = nm_dns_query_key (msg->data, msg->len, &question_len, &udp_size);
+	g_assert_cmpstr (key, ==, "example.com/1/1/edns");
+	g_assert_cmpint (udp_size, ==, 4096);
+	g_free (key);
+	g_byte_array_unref (msg);
+
+	msg = _new_msg (DNS_FLAG_RD, 1, 0, 0, 1);
+	_add_question (msg, "example.com", 1);
+	_add_opt (msg, 100, DNS_EDNS_FLAG_DO);
+	key = nm_dns_query_key (msg->data, msg->len, &question_len, &udp_size);
+	g_assert_cmpstr (key, ==, "example.com/1/1/edns+do");
+	g_assert_cmpint (udp_size, ==, DNS_UDP_SIZE_DEFAULT);
+	g_free (key);
+
+	/* the OPT record is cut short */
+	g_assert (!nm_dns_query_key (msg->data, msg->len - 1, NULL, NULL));
+	g_byte_array_unref (msg);
+
+	/* only one OPT record is allowed */
+	msg = _new_msg (DNS_FLAG_RD, 1, 0, 0, 2);
+	_add_question (msg, "example.com", 1);
+	_add_opt (msg, 4096, 0);
+	_add_opt (msg, 4096, 0);
+	g_assert (!nm_dns_query_key (msg->data, msg->len, NULL, NULL));
+	g_byte_array_unref (msg);
+
+	/* exactly one question */
+	msg = _new_msg (DNS_FLAG_RD, 2, 0, 0, 0);
+	_add_question (msg, "example.com", 1);
+	_add_question (msg, "example.org", 1);
+	g_assert (!nm_dns_query_key (msg->data, msg->len, NULL, NULL));
+	g_byte_array_unref (msg);
+
+	msg = _new_msg (DNS_FLAG_RD, 1, 0, 0, 0);
+	g_assert (!nm_dns_query_key (msg->data, msg->len - 1, NULL, NULL));
+	g_byte_array_unref (msg);
+}
+
+static void
+test_clamp_udp_size (void)
+{
+	GByteArray *msg;
+	guint16 udp_size;
+
+	msg = _new_msg (DNS_FLAG_RD, 1, 0, 0, 1);
+	_add_question (msg, "example.com", 1);
+	_add_opt (msg, 65535, DNS_EDNS_FLAG_DO);
+	g_assert (nm_dns_query_clamp_udp_size (msg->data, msg->len, 4096));
+	g_free (nm_dns_query_key (msg->data, msg->len, NULL, &udp_size));
+	g_assert_cmpint (udp_size, ==, 4096);
+	g_assert (!nm_dns_query_clamp_udp_size (msg->data, msg->len, 4096));
+	g_byte_array_unref (msg);
+
+	/* smaller sizes and queries without OPT record stay */
+	msg = _new_msg (DNS_FLAG_RD, 1, 0, 0, 1);
+	_add_question (msg, "example.com", 1);
+	_add_opt (msg, 1232, 0);
+	g_assert (!nm_dns_query_clamp_udp_size (msg->data, msg->len, 4096));
+	g_free (nm_dns_query_key (msg->data, msg->len, NULL, &udp_size));
+	g_assert_cmpint (udp_size, ==, 1232);
+	g_byte_array_unref (msg);
+
+	msg = _new_msg (DNS_FLAG_RD, 1, 0, 0, 0);
+	_add_question (msg, "example.com", 1);
+	g_assert (!nm_dns_query_clamp_udp_size (msg->data, msg->len, 4096));
+	g_byte_array_unref (msg);
+}
+
+static void
+test_reply_ttl (void)
+{
+	GByteArray *msg;
+	gsize pos;
+
+	msg = _new_msg (DNS_FLAG_QR, 1, 2, 0, 1);
+	_add_question (msg, "example.com", 1);
+	pos = msg->len;
+	_add_a (msg, "example.com", 300);
+	_add_a (msg, "example.com", 600);
+	_add_opt (msg, 4096, DNS_EDNS_FLAG_DO);
+	g_assert_cmpint (nm_dns_reply_ttl (msg->data, msg->len, 0), ==, 300);
+
+	/* the records age, the EDNS flags stay */
+	g_assert_cmpint (nm_dns_reply_ttl (msg->data, msg->len, 100), ==, 300);
+	g_assert_cmpint (nm_dns_get_u32 (&msg->data[pos + 13 + 4]), ==, 200);
+	g_assert_cmpint (nm_dns_get_u32 (&msg->data[msg->len - 6]), ==, DNS_EDNS_FLAG_DO);
+	g_assert_cmpint (nm_dns_reply_ttl (msg->data, msg->len, 1000), ==, 200);
+	g_assert_cmpint (nm_dns_get_u32 (&msg->data[pos + 13 + 4]), ==, 0);
+
+	/* a record runs past the end */
+	g_assert_cmpint (nm_dns_reply_ttl (msg->data, msg->len - 1, 0), ==, 0);
+	g_assert_cmpint (nm_dns_reply_ttl (msg->data, DNS_HEADER_SIZE - 1, 0), ==, 0);
+	g_byte_array_unref (msg);
+
+	msg = _new_msg (DNS_FLAG_QR, 1, 1, 0, 0);
+	_add_question (msg, "example.com", 1);
+	_add_a (msg, "example.com", G_MAXUINT32);
+	g_assert_cmpint (nm_dns_reply_ttl (msg->data, msg->len, 0), ==, DNS_TTL_MAX);
+	g_byte_array_unref (msg);
+
+	/* a name that points to itself doesn't loop */
+	msg = _new_msg (DNS_FLAG_QR, 0, 1, 0, 0);
+	g_byte_array_append (msg, (const guint8 *) "\xC0\x0C", 2);
+	_add_u16 (msg, 1);
+	_add_u16 (msg, 1);
+	_add_u32 (msg, 60);
+	_add_u16 (msg, 0);
+	g_assert_cmpint (nm_dns_reply_ttl (msg->data, msg->len, 0), ==, 60);
+	g_byte_array_unref (msg);
+
+	/* negative answers live for the SOA minimum, at most for the
+	 * time to live of the SOA record itself */
+	msg = _new_msg (DNS_FLAG_QR | DNS_RCODE_NXDOMAIN, 1, 0, 1, 0);
+	_add_question (msg, "nothing.example.com", 1);
+	_add_soa (msg, "example.com", 3600, 900);
+	g_assert_cmpint (nm_dns_reply_ttl (msg->data, msg->len, 0), ==, 900);
+	g_byte_array_unref (msg);
+
+	msg = _new_msg (DNS_FLAG_QR | DNS_RCODE_NXDOMAIN, 1, 0, 1, 0);
+	_add_question (msg, "nothing.example.com", 1);
+	_add_soa (msg, "example.com", 300, 900);
+	g_assert_cmpint (nm_dns_reply_ttl (msg->data, msg->len, 0), ==, 300);
+	g_byte_array_unref (msg);
+
+	msg = _new_msg (DNS_FLAG_QR | DNS_RCODE_NXDOMAIN, 1, 0, 1, 0);
+	_add_question (msg, "nothing.example.com", 1);
+	_add_soa (msg, "example.com", 86400, 86400);
+	g_assert_cmpint (nm_dns_reply_ttl (msg->data, msg->len, 0), ==, DNS_NEGATIVE_TTL_MAX);
+	g_byte_array_unref (msg);
+
+	/* no data */
+	msg = _new_msg (DNS_FLAG_QR, 1, 0, 1, 0);
+	_add_question (msg, "example.com", 28);
+	_add_soa (msg, "example.com", 3600, 120);
+	g_assert_cmpint (nm_dns_reply_ttl (msg->data, msg->len, 0), ==, 120);
+	g_byte_array_unref (msg);
+
+	msg = _new_msg (DNS_FLAG_QR | DNS_RCODE_NXDOMAIN, 1, 0, 0, 0);
+	_add_question (msg, "nothing.example.com", 1);
+	g_assert_cmpint (nm_dns_reply_ttl (msg->data, msg->len, 0), ==, DNS_NEGATIVE_TTL_DEFAULT);
+	g_byte_array_unref (msg);
+
+	/* not cached at all */
+	msg = _new_msg (DNS_FLAG_QR | DNS_FLAG_TC, 1, 0, 0, 0);
+	_add_question (msg, "example.com", 1);
+	g_assert_cmpint (nm_dns_reply_ttl (msg->data, msg->len, 0), ==, 0);
+	g_byte_array_unref (msg);
+
+	msg = _new_msg (DNS_FLAG_QR | DNS_RCODE_SERVFAIL, 1, 0, 0, 0);
+	_add_question (msg, "example.com", 1);
+	g_assert_cmpint (nm_dns_reply_ttl (msg->data, msg->len, 0), ==, 0);
+	g_byte_array_unref (msg);
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE ();
+
+int
+main (int argc, char **argv)
+{
+	nmtst_init_assert_logging (&argc, &argv, "INFO", "DEFAULT");
+
+	g_test_add_func ("/dns/skip-name", test_skip_name);
+	g_test_add_func ("/dns/question-key", test_question_key);
+	g_test_add_func ("/dns/query-key", test_query_key);
+	g_test_add_func ("/dns/clamp-udp-size", test_clamp_udp_size);
+	g_test_add_func ("/dns/reply-ttl", test_reply_ttl);
+
+	return g_test_run ();
+}
@@ -46,9 +46,11 @@
 #include "nm-session-monitor.h"
 #include "nm-dispatcher.h"
 #include "settings/nm-settings.h"
+#include "settings/nm-settings-connection.h"
 #include "nm-auth-manager.h"
 #include "nm-core-internal.h"
 #include "nm-exported-object.h"
+#include "nm-state-snapshot.h"
 #include "nm-connectivity.h"
 #include "dns/nm-dns-manager.h"
 #include "systemd/nm-sd.h"
@@ -94,9 +96,11 @@ _init_nm_debug (NMConfig *config)
 	gs_free char *debug = NULL;
 	const guint D_RLIMIT_CORE = 1;
 	const guint D_FATAL_WARNINGS = 2;
+	const guint D_MEMORY_ACCOUNTING = 4;
 	GDebugKey keys[] = {
 		{ "RLIMIT_CORE", D_RLIMIT_CORE },
 		{ "fatal-warnings", D_FATAL_WARNINGS },
+		{ "memory-accounting", D_MEMORY_ACCOUNTING },
 	};
 	guint flags;
 	const char *env = getenv ("NM_DEBUG");
@@ -121,6 +125,8 @@ _init_nm_debug (NMConfig *config)
 	}
 	if (NM_FLAGS_HAS (flags, D_FATAL_WARNINGS))
 		_set_g_fatal_warnings ();
+	if (NM_FLAGS_HAS (flags, D_MEMORY_ACCOUNTING))
+		nm_exported_object_class_set_memory_accounting ();
 }
 
 void
@@ -225,6 +231,10 @@ main (int argc, char *argv[])
 	char *bad_domains = NULL;
 	NMConfigCmdLineOptions *config_cli;
 	guint sd_id = 0;
+	NMStateSnapshot *snapshot = NULL;
+	gint64 snapshot_interval;
+	gint64 shutdown_timeout;
+	gs_free char *ignore_route_protocols = NULL;
 
 	nm_g_type_init ();
 
@@ -236,6 +246,8 @@ main (int argc, char *argv[])
 
 	_nm_utils_is_manager_process = TRUE;
 
+	nm_utils_startup_trace_add ("main");
+
 	main_loop = g_main_loop_new (NULL, FALSE);
 
 	config_cli = nm_config_cmd_line_options_new ();
@@ -311,6 +323,7 @@ main (int argc, char *argv[])
 		         error->message);
 		exit (1);
 	}
+	nm_utils_startup_trace_add ("config-loaded");
 
 	_init_nm_debug (config);
 
@@ -333,6 +346,21 @@ main (int argc, char *argv[])
 		}
 	}
 
+	if (!nm_logging_recorder_setup (_nm_utils_ascii_str_to_int64 (nm_config_data_get_value_cached (NM_CONFIG_GET_DATA_ORIG,
+	                                                                                               NM_CONFIG_KEYFILE_GROUP_LOGGING,
+	                                                                                               NM_CONFIG_KEYFILE_KEY_LOGGING_TRACE_BUFFER_SIZE,
+	                                                                                               NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY),
+	                                                              10, 0, 1024 * 1024, 0) * 1024,
+	                                nm_config_data_get_value_cached (NM_CONFIG_GET_DATA_ORIG,
+	                                                                 NM_CONFIG_KEYFILE_GROUP_LOGGING,
+	                                                                 NM_CONFIG_KEYFILE_KEY_LOGGING_TRACE_BUFFER_LEVEL,
+	                                                                 NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY),
+	                                &error)) {
+		fprintf (stderr, _("Error in configuration file: %s.\n"),
+		         error->message);
+		exit (1);
+	}
+
 	if (global_opt.become_daemon && !nm_config_get_is_debug (config)) {
 		if (daemon (0, 0) < 0) {
 			int saved_errno;
@@ -355,6 +383,12 @@ main (int argc, char *argv[])
 	                                                            NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY),
 	                           nm_config_get_is_debug (config));
 
+	if (nm_config_data_get_value_boolean (NM_CONFIG_GET_DATA_ORIG,
+	                                      NM_CONFIG_KEYFILE_GROUP_LOGGING,
+	                                      NM_CONFIG_KEYFILE_KEY_LOGGING_ASYNC,
+	                                      FALSE))
+		nm_logging_start_writer_thread ();
+
 	nm_log_info (LOGD_CORE, "NetworkManager (version " NM_DIST_VERSION ") is starting...");
 
 	nm_log_info (LOGD_CORE, "Read config: %s", nm_config_data_get_config_description (nm_config_get_data (config)));
@@ -388,8 +422,24 @@ main (int argc, char *argv[])
 		}
 	}
 
+	if (nm_config_data_get_value_boolean (NM_CONFIG_GET_DATA_ORIG,
+	                                      NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                                      NM_CONFIG_KEYFILE_KEY_MAIN_PRIVATE_SOCKET,
+	                                      FALSE)) {
+		/* The path is also known to libnm, see libnm/nm-dbus-helpers.c. */
+		nm_bus_manager_private_server_register (nm_bus_manager_get (),
+		                                        NMRUNDIR "/private",
+		                                        "main",
+		                                        TRUE);
+	}
+
 	/* Set up platform interaction layer */
-	nm_linux_platform_setup ();
+	ignore_route_protocols = nm_config_data_get_value (NM_CONFIG_GET_DATA_ORIG,
+	                                                   NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                                                   NM_CONFIG_KEYFILE_KEY_MAIN_IGNORE_ROUTE_PROTOCOLS,
+	                                                   NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY);
+	nm_linux_platform_setup_full (NULL, ignore_route_protocols);
+	nm_utils_startup_trace_add ("platform-dump");
 
 	NM_UTILS_KEEP_ALIVE (config, NM_PLATFORM_GET, "NMConfig-depends-on-NMPlatform");
 #if WITH_CONCHECK
@@ -420,6 +470,13 @@ main (int argc, char *argv[])
 	nm_log_dbg (LOGD_CORE, "setting up local loopback");
 	nm_platform_link_set_up (NM_PLATFORM_GET, 1, NULL);
 
+	snapshot_interval = nm_config_data_get_value_int64 (NM_CONFIG_GET_DATA_ORIG,
+	                                                    NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                                                    NM_CONFIG_KEYFILE_KEY_MAIN_STATE_SNAPSHOT_INTERVAL,
+	                                                    0, 3600, 0);
+	if (snapshot_interval > 0)
+		snapshot = nm_state_snapshot_new (nm_manager_get (), snapshot_interval);
+
 	success = TRUE;
 
 	if (configure_and_quit == FALSE) {
@@ -430,6 +487,8 @@ main (int argc, char *argv[])
 
 done:
 
+	g_clear_pointer (&snapshot, nm_state_snapshot_free);
+
 	/* write the device-state to file. Note that we only persist the
 	 * state here. We don't bother updating the state as devices
 	 * change during regular operation. If NM is killed with SIGKILL,
@@ -438,8 +497,17 @@ done:
 
 	nm_exported_object_class_set_quitting ();
 
+	shutdown_timeout = nm_config_data_get_value_int64 (NM_CONFIG_GET_DATA_ORIG,
+	                                                   NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                                                   NM_CONFIG_KEYFILE_KEY_MAIN_SHUTDOWN_TIMEOUT,
+	                                                   0, 3600, 0);
+	if (shutdown_timeout > 0)
+		nm_dispatcher_set_sync_deadline (nm_utils_get_monotonic_timestamp_ms () + shutdown_timeout * 1000);
+
 	nm_manager_stop (nm_manager_get ());
 
+	nm_settings_connection_flush_state_dbs ();
+
 	nm_config_state_set (config, TRUE, TRUE);
 
 	nm_dns_manager_stop (nm_dns_manager_get ());
@@ -449,6 +517,8 @@ done:
 
 	nm_log_info (LOGD_CORE, "exiting (%s)", success ? "success" : "error");
 
+	nm_logging_stop_writer_thread ();
+
 	nm_clear_g_source (&sd_id);
 
 	exit (success ? 0 : 1);
@@ -55,6 +55,7 @@ struct _NMNDiscPrivate {
 	};
 	guint ra_timeout_id;  /* first RA timeout */
 	guint timeout_id;   /* prefix/dns/etc lifetime timeout */
+	guint32 next_event; /* no item expires or needs refresh before this time */
 	char *last_error;
 	NMUtilsIPv6IfaceId iid;
 
@@ -190,6 +191,23 @@ _emit_config_change (NMNDisc *self, NMNDiscConfigMap changed)
 
 /*****************************************************************************/
 
+/* Items only ever get added or refreshed here, so keeping the earliest
+ * event of all of them as a lower bound lets check_timestamps() skip
+ * scanning the lists until something can actually have expired. */
+static void
+_note_event (NMNDisc *ndisc, guint32 timestamp, guint32 lifetime, gboolean refresh)
+{
+	NMNDiscPrivate *priv = NM_NDISC_GET_PRIVATE (ndisc);
+	guint64 event;
+
+	if (NM_IN_SET (lifetime, 0, G_MAXUINT32))
+		return;
+
+	event = (guint64) timestamp + (refresh ? lifetime / 2 : lifetime);
+	if (event < priv->next_event)
+		priv->next_event = event;
+}
+
 gboolean
 nm_ndisc_add_gateway (NMNDisc *ndisc, const NMNDiscGateway *new)
 {
@@ -211,6 +229,7 @@ nm_ndisc_add_gateway (NMNDisc *ndisc, const NMNDiscGateway *new)
 			}
 
 			memcpy (item, new, sizeof (*new));
+			_note_event (ndisc, new->timestamp, new->lifetime, FALSE);
 			return FALSE;
 		}
 
@@ -219,8 +238,10 @@ nm_ndisc_add_gateway (NMNDisc *ndisc, const NMNDiscGateway *new)
 			insert_idx = i;
 	}
 
-	if (new->lifetime)
+	if (new->lifetime) {
 		g_array_insert_val (rdata->gateways, MAX (insert_idx, 0), *new);
+		_note_event (ndisc, new->timestamp, new->lifetime, FALSE);
+	}
 	return !!new->lifetime;
 }
 
@@ -299,6 +320,7 @@ nm_ndisc_add_address (NMNDisc *ndisc, const NMNDiscAddress *new)
 			changed = item->timestamp + item->lifetime  != new->timestamp + new->lifetime ||
 			          item->timestamp + item->preferred != new->timestamp + new->preferred;
 			*item = *new;
+			_note_event (ndisc, new->timestamp, new->lifetime, FALSE);
 			return changed;
 		}
 	}
@@ -310,8 +332,10 @@ nm_ndisc_add_address (NMNDisc *ndisc, const NMNDiscAddress *new)
 	if (priv->max_addresses && rdata->addresses->len >= priv->max_addresses)
 		return FALSE;
 
-	if (new->lifetime)
+	if (new->lifetime) {
 		g_array_insert_val (rdata->addresses, i, *new);
+		_note_event (ndisc, new->timestamp, new->lifetime, FALSE);
+	}
 	return !!new->lifetime;
 }
 
@@ -360,6 +384,7 @@ nm_ndisc_add_route (NMNDisc *ndisc, const NMNDiscRoute *new)
 			}
 
 			memcpy (item, new, sizeof (*new));
+			_note_event (ndisc, new->timestamp, new->lifetime, FALSE);
 			return FALSE;
 		}
 
@@ -368,8 +393,10 @@ nm_ndisc_add_route (NMNDisc *ndisc, const NMNDiscRoute *new)
 			insert_idx = i;
 	}
 
-	if (new->lifetime)
+	if (new->lifetime) {
 		g_array_insert_val (rdata->routes, CLAMP (insert_idx, 0, G_MAXINT), *new);
+		_note_event (ndisc, new->timestamp, new->lifetime, FALSE);
+	}
 	return !!new->lifetime;
 }
 
@@ -391,16 +418,20 @@ nm_ndisc_add_dns_server (NMNDisc *ndisc, const NMNDiscDNSServer *new)
 				g_array_remove_index (rdata->dns_servers, i);
 				return TRUE;
 			}
+			/* the lifetime is not exposed beyond NMNDisc, so a
+			 * refresh is not a configuration change. */
 			if (item->timestamp != new->timestamp || item->lifetime != new->lifetime) {
 				*item = *new;
-				return TRUE;
+				_note_event (ndisc, new->timestamp, new->lifetime, TRUE);
 			}
 			return FALSE;
 		}
 	}
 
-	if (new->lifetime)
+	if (new->lifetime) {
 		g_array_insert_val (rdata->dns_servers, i, *new);
+		_note_event (ndisc, new->timestamp, new->lifetime, TRUE);
+	}
 	return !!new->lifetime;
 }
 
@@ -420,20 +451,19 @@ nm_ndisc_add_dns_domain (NMNDisc *ndisc, const NMNDiscDNSDomain *new)
 		item = &g_array_index (rdata->dns_domains, NMNDiscDNSDomain, i);
 
 		if (!g_strcmp0 (item->domain, new->domain)) {
-			gboolean changed;
-
 			if (new->lifetime == 0) {
 				g_array_remove_index (rdata->dns_domains, i);
 				return TRUE;
 			}
 
-			changed = (item->timestamp != new->timestamp ||
-			           item->lifetime != new->lifetime);
-			if (changed) {
+			/* like for DNS servers, a refresh is no change */
+			if (   item->timestamp != new->timestamp
+			    || item->lifetime != new->lifetime) {
 				item->timestamp = new->timestamp;
 				item->lifetime = new->lifetime;
+				_note_event (ndisc, new->timestamp, new->lifetime, TRUE);
 			}
-			return changed;
+			return FALSE;
 		}
 	}
 
@@ -441,6 +471,7 @@ nm_ndisc_add_dns_domain (NMNDisc *ndisc, const NMNDiscDNSDomain *new)
 		g_array_insert_val (rdata->dns_domains, i, *new);
 		item = &g_array_index (rdata->dns_domains, NMNDiscDNSDomain, i);
 		item->domain = g_strdup (new->domain);
+		_note_event (ndisc, new->timestamp, new->lifetime, TRUE);
 	}
 	return !!new->lifetime;
 }
@@ -915,9 +946,11 @@ clean_dns_servers (NMNDisc *ndisc, guint32 now, NMNDiscConfigMap *changed, guint
 		if (now >= expiry) {
 			g_array_remove_index (rdata->dns_servers, i--);
 			*changed |= NM_NDISC_CONFIG_DNS_SERVERS;
-		} else if (now >= refresh)
+		} else if (now >= refresh) {
 			solicit_routers (ndisc);
-		else if (*nextevent > refresh)
+			if (*nextevent > expiry)
+				*nextevent = expiry;
+		} else if (*nextevent > refresh)
 			*nextevent = refresh;
 	}
 }
@@ -941,39 +974,47 @@ clean_dns_domains (NMNDisc *ndisc, guint32 now, NMNDiscConfigMap *changed, guint
 		if (now >= expiry) {
 			g_array_remove_index (rdata->dns_domains, i--);
 			*changed |= NM_NDISC_CONFIG_DNS_DOMAINS;
-		} else if (now >= refresh)
+		} else if (now >= refresh) {
 			solicit_routers (ndisc);
-		else if (*nextevent > refresh)
+			if (*nextevent > expiry)
+				*nextevent = expiry;
+		} else if (*nextevent > refresh)
 			*nextevent = refresh;
 	}
 }
 
 static gboolean timeout_cb (gpointer user_data);
 
+/* Use a magic date in the distant future (~68 years) */
+#define NEXT_EVENT_NEVER ((guint32) G_MAXINT32)
+
 static void
 check_timestamps (NMNDisc *ndisc, guint32 now, NMNDiscConfigMap changed)
 {
 	NMNDiscPrivate *priv = NM_NDISC_GET_PRIVATE (ndisc);
-	/* Use a magic date in the distant future (~68 years) */
-	guint32 never = G_MAXINT32;
-	guint32 nextevent = never;
+	guint32 nextevent = NEXT_EVENT_NEVER;
 
 	nm_clear_g_source (&priv->timeout_id);
 
-	clean_gateways (ndisc, now, &changed, &nextevent);
-	clean_addresses (ndisc, now, &changed, &nextevent);
-	clean_routes (ndisc, now, &changed, &nextevent);
-	clean_dns_servers (ndisc, now, &changed, &nextevent);
-	clean_dns_domains (ndisc, now, &changed, &nextevent);
+	/* nothing can have expired before the earliest noted event, so only
+	 * then the lists are scanned and the exact next event is computed. */
+	if (now >= priv->next_event) {
+		clean_gateways (ndisc, now, &changed, &nextevent);
+		clean_addresses (ndisc, now, &changed, &nextevent);
+		clean_routes (ndisc, now, &changed, &nextevent);
+		clean_dns_servers (ndisc, now, &changed, &nextevent);
+		clean_dns_domains (ndisc, now, &changed, &nextevent);
+		priv->next_event = nextevent;
+	}
 
 	if (changed)
 		_emit_config_change (ndisc, changed);
 
-	if (nextevent != never) {
-		g_return_if_fail (nextevent > now);
+	if (priv->next_event != NEXT_EVENT_NEVER) {
+		g_return_if_fail (priv->next_event > now);
 		_LOGD ("scheduling next now/lifetime check: %u seconds",
-		       nextevent - now);
-		priv->timeout_id = g_timeout_add_seconds (nextevent - now, timeout_cb, ndisc);
+		       priv->next_event - now);
+		priv->timeout_id = g_timeout_add_seconds (priv->next_event - now, timeout_cb, ndisc);
 	}
 }
 
@@ -1100,6 +1141,7 @@ nm_ndisc_init (NMNDisc *ndisc)
 	rdata->dns_domains = g_array_new (FALSE, FALSE, sizeof (NMNDiscDNSDomain));
 	g_array_set_clear_func (rdata->dns_domains, dns_domain_free);
 	priv->rdata.public.hop_limit = 64;
+	priv->next_event = NEXT_EVENT_NEVER;
 
 	/* Start at very low number so that last_rs - router_solicitation_interval
 	 * is much lower than nm_utils_get_monotonic_timestamp_s() at startup.
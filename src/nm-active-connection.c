@@ -57,12 +57,16 @@ typedef struct _NMActiveConnectionPrivate {
 	NMActiveConnection *master;
 
 	NMActiveConnection *parent;
+	NMDevice *parent_device;
 
 	NMAuthChain *chain;
 	const char *wifi_shared_permission;
 	NMActiveConnectionAuthResultFunc result_func;
 	gpointer user_data1;
 	gpointer user_data2;
+
+	/* of StageDuration, in the order the stages completed */
+	GArray *stage_durations;
 } NMActiveConnectionPrivate;
 
 NM_GOBJECT_PROPERTIES_DEFINE (NMActiveConnection,
@@ -81,6 +85,7 @@ NM_GOBJECT_PROPERTIES_DEFINE (NMActiveConnection,
 	PROP_DHCP6_CONFIG,
 	PROP_VPN,
 	PROP_MASTER,
+	PROP_STAGE_DURATIONS,
 
 	PROP_INT_SETTINGS_CONNECTION,
 	PROP_INT_APPLIED_CONNECTION,
@@ -746,6 +751,50 @@ nm_active_connection_get_activation_type (NMActiveConnection *self)
 	return NM_ACTIVE_CONNECTION_GET_PRIVATE (self)->activation_type;
 }
 
+typedef struct {
+	const char *stage;
+	guint64 duration_us;
+} StageDuration;
+
+/**
+ * nm_active_connection_set_stage_duration:
+ * @self: the #NMActiveConnection
+ * @stage: the name of the activation stage, a static string
+ * @duration_us: how long the stage took, in microseconds
+ *
+ * Records the duration of an activation stage. It is exposed on D-Bus
+ * by the StageDurations property.
+ */
+void
+nm_active_connection_set_stage_duration (NMActiveConnection *self,
+                                         const char *stage,
+                                         guint64 duration_us)
+{
+	NMActiveConnectionPrivate *priv;
+	StageDuration *d;
+	guint i;
+
+	g_return_if_fail (NM_IS_ACTIVE_CONNECTION (self));
+	g_return_if_fail (stage);
+
+	priv = NM_ACTIVE_CONNECTION_GET_PRIVATE (self);
+
+	if (!priv->stage_durations)
+		priv->stage_durations = g_array_new (FALSE, FALSE, sizeof (StageDuration));
+
+	for (i = 0; i < priv->stage_durations->len; i++) {
+		d = &g_array_index (priv->stage_durations, StageDuration, i);
+		if (nm_streq (d->stage, stage)) {
+			d->duration_us = duration_us;
+			goto out;
+		}
+	}
+
+	g_array_append_val (priv->stage_durations, ((StageDuration) { .stage = stage, .duration_us = duration_us }));
+out:
+	_notify (self, PROP_STAGE_DURATIONS);
+}
+
 static void
 _set_activation_type (NMActiveConnection *self,
                       NMActivationType activation_type)
@@ -802,21 +851,57 @@ parent_destroyed (gpointer user_data, GObject *parent)
 	g_signal_emit (self, signals[PARENT_ACTIVE], 0, NULL);
 }
 
+static gboolean
+parent_is_ready (NMActiveConnection *self)
+{
+	NMActiveConnectionPrivate *priv = NM_ACTIVE_CONNECTION_GET_PRIVATE (self);
+	NMActiveConnectionState parent_state = nm_active_connection_get_state (priv->parent);
+
+	if (parent_state >= NM_ACTIVE_CONNECTION_STATE_ACTIVATED)
+		return TRUE;
+
+	/* The child only needs the link of the parent to exist. Don't wait
+	 * until the parent is fully activated (which might include waiting for
+	 * DHCP), so that stacks like bond, VLANs and bridges on top of them
+	 * come up layer by layer as soon as each link is created. */
+	return    parent_state == NM_ACTIVE_CONNECTION_STATE_ACTIVATING
+	       && priv->parent_device
+	       && nm_device_is_real (priv->parent_device)
+	       && nm_device_get_ifindex (priv->parent_device) > 0
+	       && nm_device_get_state (priv->parent_device) >= NM_DEVICE_STATE_PREPARE;
+}
+
 static void
-parent_state_cb (NMActiveConnection *parent_ac,
-                 GParamSpec *pspec,
-                 gpointer user_data)
+parent_check_ready (NMActiveConnection *self)
 {
-	NMActiveConnection *self = user_data;
-	NMActiveConnectionState parent_state = nm_active_connection_get_state (parent_ac);
+	NMActiveConnectionPrivate *priv = NM_ACTIVE_CONNECTION_GET_PRIVATE (self);
+	NMActiveConnection *parent_ac = priv->parent;
 
-	if (parent_state < NM_ACTIVE_CONNECTION_STATE_ACTIVATED)
+	if (!parent_is_ready (self))
 		return;
 
 	unwatch_parent (self, TRUE);
 	g_signal_emit (self, signals[PARENT_ACTIVE], 0, parent_ac);
 }
 
+static void
+parent_state_cb (NMActiveConnection *parent_ac,
+                 GParamSpec *pspec,
+                 gpointer user_data)
+{
+	parent_check_ready (user_data);
+}
+
+static void
+parent_device_state_cb (NMDevice *device,
+                        NMDeviceState new_state,
+                        NMDeviceState old_state,
+                        NMDeviceStateReason reason,
+                        gpointer user_data)
+{
+	parent_check_ready (user_data);
+}
+
 static void
 unwatch_parent (NMActiveConnection *self, gboolean unref)
 {
@@ -825,6 +910,12 @@ unwatch_parent (NMActiveConnection *self, gboolean unref)
 	g_signal_handlers_disconnect_by_func (priv->parent,
 	                                      (GCallback) parent_state_cb,
 	                                      self);
+	if (priv->parent_device) {
+		g_signal_handlers_disconnect_by_func (priv->parent_device,
+		                                      (GCallback) parent_device_state_cb,
+		                                      self);
+		g_clear_object (&priv->parent_device);
+	}
 	if (unref)
 		g_object_weak_unref ((GObject *) priv->parent, parent_destroyed, self);
 	priv->parent = NULL;
@@ -833,11 +924,12 @@ unwatch_parent (NMActiveConnection *self, gboolean unref)
 /**
  * nm_active_connection_set_parent:
  * @self: the #NMActiveConnection
- * @parent: The #NMActiveConnection that must be active before the manager
+ * @parent: The #NMActiveConnection whose device must exist before the manager
  * can proceed progressing the device to disconnected state for us.
  *
  * Sets the parent connection of @self. A "parent-active" signal will be
- * emitted when the parent connection becomes active.
+ * emitted as soon as the link of the parent's device exists and the parent
+ * is activating, or when the parent connection becomes active.
  */
 void
 nm_active_connection_set_parent (NMActiveConnection *self, NMActiveConnection *parent)
@@ -850,6 +942,17 @@ nm_active_connection_set_parent (NMActiveConnection *self, NMActiveConnection *p
 	                  "notify::" NM_ACTIVE_CONNECTION_STATE,
 	                  (GCallback) parent_state_cb,
 	                  self);
+
+	/* the device of the parent is usually not yet realized. Its state
+	 * changes tell us when its link got created. */
+	priv->parent_device = nm_active_connection_get_device (parent);
+	if (priv->parent_device) {
+		g_object_ref (priv->parent_device);
+		g_signal_connect (priv->parent_device,
+		                  NM_DEVICE_STATE_CHANGED,
+		                  (GCallback) parent_device_state_cb,
+		                  self);
+	}
 	g_object_weak_ref ((GObject *) priv->parent, parent_destroyed, self);
 }
 
@@ -1033,6 +1136,8 @@ get_property (GObject *object, guint prop_id,
 	NMActiveConnectionPrivate *priv = NM_ACTIVE_CONNECTION_GET_PRIVATE ((NMActiveConnection *) object);
 	GPtrArray *devices;
 	NMDevice *master_device = NULL;
+	GVariantBuilder builder;
+	guint i;
 
 	switch (prop_id) {
 	case PROP_CONNECTION:
@@ -1094,6 +1199,15 @@ get_property (GObject *object, guint prop_id,
 			master_device = nm_active_connection_get_device (priv->master);
 		nm_utils_g_value_set_object_path (value, master_device);
 		break;
+	case PROP_STAGE_DURATIONS:
+		g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{st}"));
+		for (i = 0; priv->stage_durations && i < priv->stage_durations->len; i++) {
+			const StageDuration *d = &g_array_index (priv->stage_durations, StageDuration, i);
+
+			g_variant_builder_add (&builder, "{st}", d->stage, d->duration_us);
+		}
+		g_value_take_variant (value, g_variant_builder_end (&builder));
+		break;
 	case PROP_INT_SUBJECT:
 		g_value_set_object (value, priv->subject);
 		break;
@@ -1243,6 +1357,8 @@ dispose (GObject *object)
 
 	g_clear_object (&priv->subject);
 
+	g_clear_pointer (&priv->stage_durations, g_array_unref);
+
 	G_OBJECT_CLASS (nm_active_connection_parent_class)->dispose (object);
 }
 
@@ -1354,6 +1470,13 @@ nm_active_connection_class_init (NMActiveConnectionClass *ac_class)
 	                          G_PARAM_READABLE |
 	                          G_PARAM_STATIC_STRINGS);
 
+	obj_properties[PROP_STAGE_DURATIONS] =
+	     g_param_spec_variant (NM_ACTIVE_CONNECTION_STAGE_DURATIONS, "", "",
+	                           G_VARIANT_TYPE ("a{st}"),
+	                           NULL,
+	                           G_PARAM_READABLE |
+	                           G_PARAM_STATIC_STRINGS);
+
 	/* Internal properties */
 	obj_properties[PROP_INT_SETTINGS_CONNECTION] =
 	     g_param_spec_object (NM_ACTIVE_CONNECTION_INT_SETTINGS_CONNECTION, "", "",
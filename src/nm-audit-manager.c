@@ -50,9 +50,27 @@ typedef struct {
 
 /*****************************************************************************/
 
+typedef struct {
+	char *msg;
+	gboolean success;
+} AuditRecord;
+
 typedef struct {
 	NMConfig *config;
 	int auditd_fd;
+
+	/* Records for auditd are handed to a writer thread, because sending
+	 * them waits for auditd to acknowledge each of them. The socket is
+	 * only opened or closed while the thread is not running. */
+	struct {
+		GMutex lock;
+		GCond cond;
+		/* signaled when the writer took records off a full queue. */
+		GCond cond_space;
+		GThread *thread;
+		GQueue queue;
+		bool stop;
+	} writer;
 } NMAuditManagerPrivate;
 
 struct _NMAuditManager {
@@ -74,6 +92,9 @@ G_DEFINE_TYPE (NMAuditManager, nm_audit_manager, G_TYPE_OBJECT)
 
 #define AUDIT_LOG_LEVEL LOGL_INFO
 
+#define AUDIT_WRITER_QUEUE_SIZE 1024
+#define AUDIT_WRITER_BATCH_SIZE 32
+
 #define _NMLOG_PREFIX_NAME    "audit"
 #define _NMLOG(level, domain, ...) \
     G_STMT_START { \
@@ -157,6 +178,111 @@ build_message (GPtrArray *fields, AuditBackend backend)
 	return g_string_free (string, FALSE);
 }
 
+#if HAVE_LIBAUDIT
+static void
+_audit_record_free (AuditRecord *record)
+{
+	g_free (record->msg);
+	g_slice_free (AuditRecord, record);
+}
+
+static gpointer
+_audit_writer_thread (gpointer user_data)
+{
+	NMAuditManagerPrivate *priv = user_data;
+	AuditRecord *batch[AUDIT_WRITER_BATCH_SIZE];
+	guint i, n;
+
+	g_mutex_lock (&priv->writer.lock);
+	for (;;) {
+		while (   g_queue_is_empty (&priv->writer.queue)
+		       && !priv->writer.stop)
+			g_cond_wait (&priv->writer.cond, &priv->writer.lock);
+
+		/* on stop, the queue is drained first. */
+		if (g_queue_is_empty (&priv->writer.queue))
+			break;
+
+		if (priv->writer.queue.length >= AUDIT_WRITER_QUEUE_SIZE)
+			g_cond_broadcast (&priv->writer.cond_space);
+		for (n = 0; n < AUDIT_WRITER_BATCH_SIZE; n++) {
+			batch[n] = g_queue_pop_head (&priv->writer.queue);
+			if (!batch[n])
+				break;
+		}
+		g_mutex_unlock (&priv->writer.lock);
+
+		for (i = 0; i < n; i++) {
+			audit_log_user_message (priv->auditd_fd, AUDIT_USYS_CONFIG, batch[i]->msg,
+			                        NULL, NULL, NULL, batch[i]->success);
+			_audit_record_free (batch[i]);
+		}
+
+		g_mutex_lock (&priv->writer.lock);
+	}
+	g_mutex_unlock (&priv->writer.lock);
+	return NULL;
+}
+
+static void
+_audit_writer_start (NMAuditManager *self)
+{
+	NMAuditManagerPrivate *priv = NM_AUDIT_MANAGER_GET_PRIVATE (self);
+
+	nm_assert (priv->auditd_fd >= 0);
+	nm_assert (!priv->writer.thread);
+
+	priv->writer.stop = FALSE;
+	priv->writer.thread = g_thread_new ("nm-audit-writer", _audit_writer_thread, priv);
+}
+
+/* Writes the queued records and stops the writer thread. */
+static void
+_audit_writer_stop (NMAuditManager *self)
+{
+	NMAuditManagerPrivate *priv = NM_AUDIT_MANAGER_GET_PRIVATE (self);
+	GThread *thread;
+
+	if (!priv->writer.thread)
+		return;
+
+	g_mutex_lock (&priv->writer.lock);
+	priv->writer.stop = TRUE;
+	g_cond_signal (&priv->writer.cond);
+	g_mutex_unlock (&priv->writer.lock);
+
+	thread = g_steal_pointer (&priv->writer.thread);
+	g_thread_join (thread);
+}
+
+/* Queues @msg for auditd and takes ownership of it. Audit records must
+ * not be lost, so when the writer can't keep up, this waits until there
+ * is room in the queue again. */
+static void
+_audit_writer_push (NMAuditManager *self, char *msg, gboolean success)
+{
+	NMAuditManagerPrivate *priv = NM_AUDIT_MANAGER_GET_PRIVATE (self);
+	AuditRecord *record;
+	gboolean waited = FALSE;
+
+	g_mutex_lock (&priv->writer.lock);
+	while (priv->writer.queue.length >= AUDIT_WRITER_QUEUE_SIZE) {
+		waited = TRUE;
+		g_cond_wait (&priv->writer.cond_space, &priv->writer.lock);
+	}
+
+	record = g_slice_new (AuditRecord);
+	record->msg = msg;
+	record->success = success;
+	g_queue_push_tail (&priv->writer.queue, record);
+	if (priv->writer.queue.length == 1)
+		g_cond_signal (&priv->writer.cond);
+	g_mutex_unlock (&priv->writer.lock);
+
+	if (waited)
+		_LOGD (LOGD_AUDIT, "waited for auditd to catch up");
+}
+#endif /* HAVE_LIBAUDIT */
 
 static void
 nm_audit_log (NMAuditManager *self, GPtrArray *fields, const char *file,
@@ -174,9 +300,7 @@ nm_audit_log (NMAuditManager *self, GPtrArray *fields, const char *file,
 
 	if (priv->auditd_fd >= 0) {
 		msg = build_message (fields, BACKEND_AUDITD);
-		audit_log_user_message (priv->auditd_fd, AUDIT_USYS_CONFIG, msg,
-		                        NULL, NULL, NULL, success);
-		g_free (msg);
+		_audit_writer_push (self, msg, success);
 	}
 #endif
 
@@ -346,11 +470,14 @@ init_auditd (NMAuditManager *self)
 			priv->auditd_fd = audit_open ();
 			if (priv->auditd_fd < 0)
 				_LOGE (LOGD_CORE, "failed to open auditd socket: %s", strerror (errno));
-			else
+			else {
 				_LOGD (LOGD_CORE, "socket created");
+				_audit_writer_start (self);
+			}
 		}
 	} else {
 		if (priv->auditd_fd >= 0) {
+			_audit_writer_stop (self);
 			audit_close (priv->auditd_fd);
 			priv->auditd_fd = -1;
 			_LOGD (LOGD_CORE, "socket closed");
@@ -365,7 +492,12 @@ config_changed_cb (NMConfig *config,
                    NMConfigData *old_data,
                    NMAuditManager *self)
 {
-	if (NM_FLAGS_HAS (changes, NM_CONFIG_CHANGE_VALUES))
+	/* on SIGHUP, also retry to open the socket if that failed before. */
+	if (   NM_FLAGS_HAS (changes, NM_CONFIG_CHANGE_CAUSE_SIGHUP)
+	    || (   NM_FLAGS_HAS (changes, NM_CONFIG_CHANGE_VALUES)
+	        && nm_config_data_is_value_changed (old_data, config_data,
+	                                            NM_CONFIG_KEYFILE_GROUP_LOGGING,
+	                                            NM_CONFIG_KEYFILE_KEY_AUDIT)))
 		init_auditd (self);
 }
 #endif
@@ -384,6 +516,10 @@ nm_audit_manager_init (NMAuditManager *self)
 	                  G_CALLBACK (config_changed_cb),
 	                  self);
 	priv->auditd_fd = -1;
+	g_mutex_init (&priv->writer.lock);
+	g_cond_init (&priv->writer.cond);
+	g_cond_init (&priv->writer.cond_space);
+	g_queue_init (&priv->writer.queue);
 
 	init_auditd (self);
 #endif
@@ -402,6 +538,7 @@ dispose (GObject *object)
 	}
 
 	 if (priv->auditd_fd >= 0) {
+		_audit_writer_stop (self);
 		audit_close (priv->auditd_fd);
 		priv->auditd_fd = -1;
 	}
@@ -410,10 +547,30 @@ dispose (GObject *object)
 	G_OBJECT_CLASS (nm_audit_manager_parent_class)->dispose (object);
 }
 
+#if HAVE_LIBAUDIT
+static void
+finalize (GObject *object)
+{
+	NMAuditManagerPrivate *priv = NM_AUDIT_MANAGER_GET_PRIVATE ((NMAuditManager *) object);
+
+	nm_assert (!priv->writer.thread);
+	nm_assert (g_queue_is_empty (&priv->writer.queue));
+
+	g_mutex_clear (&priv->writer.lock);
+	g_cond_clear (&priv->writer.cond);
+	g_cond_clear (&priv->writer.cond_space);
+
+	G_OBJECT_CLASS (nm_audit_manager_parent_class)->finalize (object);
+}
+#endif
+
 static void
 nm_audit_manager_class_init (NMAuditManagerClass *klass)
 {
 	GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
 	object_class->dispose = dispose;
+#if HAVE_LIBAUDIT
+	object_class->finalize = finalize;
+#endif
 }
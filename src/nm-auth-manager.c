@@ -30,6 +30,13 @@
 #define POLKIT_OBJECT_PATH                  "/org/freedesktop/PolicyKit1/Authority"
 #define POLKIT_INTERFACE                    "org.freedesktop.PolicyKit1.Authority"
 
+/* How long a definite polkit answer is reused for the same subject and
+ * action. polkit announces policy changes via its "Changed" signal, which
+ * flushes the cache; the timeout only bounds staleness for changes that
+ * polkit does not announce (like a session becoming inactive). */
+#define AUTH_CACHE_TIMEOUT_MSEC             5000
+#define AUTH_CACHE_MAX_ENTRIES              256
+
 /*****************************************************************************/
 
 NM_GOBJECT_PROPERTIES_DEFINE_BASE (
@@ -50,6 +57,9 @@ typedef struct {
 	GCancellable *new_proxy_cancellable;
 	GSList *queued_calls;
 	GDBusProxy *proxy;
+	GHashTable *cache;
+	guint cache_hits;
+	guint cache_misses;
 #endif
 } NMAuthManagerPrivate;
 
@@ -111,6 +121,7 @@ typedef struct {
 	gchar *cancellation_id;
 	GVariant *dbus_parameters;
 	GCancellable *cancellable;
+	char *cache_key;
 } CheckAuthData;
 
 static void
@@ -122,6 +133,7 @@ _check_auth_data_free (CheckAuthData *data)
 	g_object_unref (data->simple);
 	g_clear_object (&data->cancellable);
 	g_free (data->cancellation_id);
+	g_free (data->cache_key);
 	g_free (data);
 }
 
@@ -168,6 +180,96 @@ typedef struct {
 	gboolean is_challenge;
 } CheckAuthorizationResult;
 
+typedef struct {
+	CheckAuthorizationResult result;
+	gint64 expiry_msec;
+} CacheEntry;
+
+static char *
+_cache_key (NMAuthSubject *subject, const char *action_id)
+{
+	char subject_buf[64];
+
+	/* the subject string contains the process start time, so that a
+	 * recycled PID doesn't inherit the authorization of a previous process. */
+	return g_strdup_printf ("%s:%s",
+	                        nm_auth_subject_to_string (subject, subject_buf, sizeof (subject_buf)),
+	                        action_id);
+}
+
+static void
+_cache_clear (NMAuthManager *self)
+{
+	NMAuthManagerPrivate *priv = NM_AUTH_MANAGER_GET_PRIVATE (self);
+
+	if (priv->cache && g_hash_table_size (priv->cache) > 0) {
+		_LOGD ("cache: flush %u entries (hits %u, misses %u)",
+		       g_hash_table_size (priv->cache),
+		       priv->cache_hits,
+		       priv->cache_misses);
+		g_hash_table_remove_all (priv->cache);
+	}
+}
+
+static const CheckAuthorizationResult *
+_cache_lookup (NMAuthManager *self, const char *key)
+{
+	NMAuthManagerPrivate *priv = NM_AUTH_MANAGER_GET_PRIVATE (self);
+	CacheEntry *entry;
+
+	entry = g_hash_table_lookup (priv->cache, key);
+	if (entry && entry->expiry_msec <= nm_utils_get_monotonic_timestamp_ms ()) {
+		g_hash_table_remove (priv->cache, key);
+		entry = NULL;
+	}
+
+	if (!entry) {
+		priv->cache_misses++;
+		return NULL;
+	}
+	priv->cache_hits++;
+	return &entry->result;
+}
+
+static void
+_cache_add (NMAuthManager *self, char *key, const CheckAuthorizationResult *result)
+{
+	NMAuthManagerPrivate *priv = NM_AUTH_MANAGER_GET_PRIVATE (self);
+	CacheEntry *entry;
+	gint64 now;
+
+	/* only remember definite answers. */
+	if (result->is_challenge) {
+		g_free (key);
+		return;
+	}
+
+	now = nm_utils_get_monotonic_timestamp_ms ();
+
+	if (g_hash_table_size (priv->cache) >= AUTH_CACHE_MAX_ENTRIES) {
+		GHashTableIter iter;
+
+		g_hash_table_iter_init (&iter, priv->cache);
+		while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &entry)) {
+			if (entry->expiry_msec <= now)
+				g_hash_table_iter_remove (&iter);
+		}
+		if (g_hash_table_size (priv->cache) >= AUTH_CACHE_MAX_ENTRIES)
+			g_hash_table_remove_all (priv->cache);
+	}
+
+	entry = g_slice_new (CacheEntry);
+	entry->result = *result;
+	entry->expiry_msec = now + AUTH_CACHE_TIMEOUT_MSEC;
+	g_hash_table_replace (priv->cache, key, entry);
+}
+
+static void
+_cache_entry_free (gpointer data)
+{
+	g_slice_free (CacheEntry, data);
+}
+
 static void
 check_authorization_cb (GDBusProxy *proxy,
                         GAsyncResult *res,
@@ -215,6 +317,8 @@ check_authorization_cb (GDBusProxy *proxy,
 		g_variant_unref (value);
 
 		_LOGD ("call[%u]: CheckAuthorization succeeded: (is_authorized=%d, is_challenge=%d)", data->call_id, result->is_authorized, result->is_challenge);
+		if (data->cache_key)
+			_cache_add (self, g_steal_pointer (&data->cache_key), result);
 		g_simple_async_result_set_op_res_gpointer (data->simple, result, g_free);
 	}
 
@@ -256,6 +360,8 @@ nm_auth_manager_polkit_authority_check_authorization (NMAuthManager *self,
 	GVariant *subject_value;
 	GVariant *details_value;
 	CheckAuthData *data;
+	const CheckAuthorizationResult *cached;
+	char *cache_key;
 
 	g_return_if_fail (NM_IS_AUTH_MANAGER (self));
 	g_return_if_fail (NM_IS_AUTH_SUBJECT (subject));
@@ -267,6 +373,32 @@ nm_auth_manager_polkit_authority_check_authorization (NMAuthManager *self,
 
 	g_return_if_fail (priv->polkit_enabled);
 
+	/* with user interaction, polkit may ask the user for a password (auth_admin)
+	 * and that answer must not be reused for later requests. Such checks
+	 * neither use nor fill the cache. */
+	cache_key = allow_user_interaction ? NULL : _cache_key (subject, action_id);
+	cached = cache_key ? _cache_lookup (self, cache_key) : NULL;
+	if (cached) {
+		GSimpleAsyncResult *simple;
+
+		_LOGD ("call[%u]: CheckAuthorization(%s), subject=%s (cached: is_authorized=%d, hits %u, misses %u)",
+		       ++priv->call_id_counter, action_id,
+		       nm_auth_subject_to_string (subject, subject_buf, sizeof (subject_buf)),
+		       cached->is_authorized, priv->cache_hits, priv->cache_misses);
+
+		simple = g_simple_async_result_new (G_OBJECT (self),
+		                                    callback,
+		                                    user_data,
+		                                    nm_auth_manager_polkit_authority_check_authorization);
+		g_simple_async_result_set_op_res_gpointer (simple,
+		                                           g_memdup (cached, sizeof (*cached)),
+		                                           g_free);
+		g_simple_async_result_complete_in_idle (simple);
+		g_object_unref (simple);
+		g_free (cache_key);
+		return;
+	}
+
 	flags = allow_user_interaction
 	    ? POLKIT_CHECK_AUTHORIZATION_FLAGS_ALLOW_USER_INTERACTION
 	    : POLKIT_CHECK_AUTHORIZATION_FLAGS_NONE;
@@ -285,6 +417,7 @@ nm_auth_manager_polkit_authority_check_authorization (NMAuthManager *self,
 	                                          callback,
 	                                          user_data,
 	                                          nm_auth_manager_polkit_authority_check_authorization);
+	data->cache_key = cache_key;
 	if (cancellable != NULL) {
 		data->cancellation_id = g_strdup_printf ("cancellation-id-%u", data->call_id);
 		data->cancellable = g_object_ref (cancellable);
@@ -349,6 +482,10 @@ nm_auth_manager_polkit_authority_check_authorization_finish (NMAuthManager *self
 static void
 _emit_changed_signal (NMAuthManager *self)
 {
+	/* polkit's policy changed or polkit went away. Either way, the
+	 * cached answers can no longer be trusted. */
+	_cache_clear (self);
+
 	_LOGD ("emit changed signal");
 	g_signal_emit_by_name (self, NM_AUTH_MANAGER_SIGNAL_CHANGED);
 }
@@ -539,6 +676,7 @@ constructed (GObject *object)
 	if (priv->polkit_enabled) {
 		NMAuthManager **p_self;
 
+		priv->cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, _cache_entry_free);
 		priv->new_proxy_cancellable = g_cancellable_new ();
 		p_self = g_new (NMAuthManager *, 1);
 		*p_self = self;
@@ -601,6 +739,11 @@ dispose (GObject *object)
 		g_signal_handlers_disconnect_by_data (priv->proxy, self);
 		g_clear_object (&priv->proxy);
 	}
+
+	if (priv->cache) {
+		_LOGD ("cache: hits %u, misses %u", priv->cache_hits, priv->cache_misses);
+		g_clear_pointer (&priv->cache, g_hash_table_unref);
+	}
 #endif
 
 	G_OBJECT_CLASS (nm_auth_manager_parent_class)->dispose (object);
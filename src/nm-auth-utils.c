@@ -28,6 +28,8 @@
 #include "nm-auth-subject.h"
 #include "nm-auth-manager.h"
 #include "nm-session-monitor.h"
+#include "nm-exported-object.h"
+#include "nm-core-utils.h"
 
 struct NMAuthChain {
 	guint32 refcount;
@@ -41,6 +43,10 @@ struct NMAuthChain {
 	guint idle_id;
 	gboolean done;
 
+	/* when the chain was created, to account the authorization time
+	 * to the method of @context. */
+	gint64 start_ns;
+
 	NMAuthChainResultFunc done_func;
 	gpointer user_data;
 };
@@ -87,6 +93,11 @@ auth_chain_finish (gpointer user_data)
 	self->idle_id = 0;
 	self->done = TRUE;
 
+	if (self->context) {
+		nm_exported_object_method_stats_add_auth (self->context,
+		                                          (nm_utils_get_monotonic_timestamp_ns () - self->start_ns) / 1000);
+	}
+
 	/* Ensure we stay alive across the callback */
 	self->refcount++;
 	self->done_func (self, self->error, self->context, self->user_data);
@@ -136,6 +147,8 @@ nm_auth_chain_new_subject (NMAuthSubject *subject,
 	self->user_data = user_data;
 	self->context = context ? g_object_ref (context) : NULL;
 	self->subject = g_object_ref (subject);
+	if (context)
+		self->start_ns = nm_utils_get_monotonic_timestamp_ns ();
 
 	return self;
 }
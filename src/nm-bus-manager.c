@@ -140,6 +140,10 @@ typedef struct {
 	GHashTable *obj_managers;
 
 	NMBusManager *manager;
+
+	/* whether all objects registered via nm_bus_manager_register_object()
+	 * are exported on the connections of this server too. */
+	bool export_objects:1;
 } PrivateServer;
 
 typedef struct {
@@ -226,6 +230,17 @@ private_server_new_connection (GDBusServer *server,
 	g_dbus_object_manager_server_set_connection (manager, conn);
 	g_hash_table_insert (s->obj_managers, manager, sender);
 
+	if (s->export_objects) {
+		GList *exported, *iter;
+
+		exported = g_dbus_object_manager_get_objects ((GDBusObjectManager *) NM_BUS_MANAGER_GET_PRIVATE (s->manager)->obj_manager);
+		for (iter = exported; iter; iter = iter->next) {
+			g_dbus_object_manager_server_export (manager, iter->data);
+			g_object_unref (iter->data);
+		}
+		g_list_free (exported);
+	}
+
 	_LOGD ("(%s) accepted connection %p on private socket", s->tag, conn);
 
 	/* Emit this for the manager.
@@ -264,6 +279,7 @@ private_server_authorize (GDBusAuthObserver *observer,
 static PrivateServer *
 private_server_new (const char *path,
                     const char *tag,
+                    gboolean export_objects,
                     NMBusManager *manager)
 {
 	PrivateServer *s;
@@ -307,6 +323,7 @@ private_server_new (const char *path,
 	                                         (GDestroyNotify) private_server_manager_destroy,
 	                                         g_free);
 	s->manager = manager;
+	s->export_objects = export_objects;
 	s->detail = g_quark_from_string (tag);
 	s->tag = g_quark_to_string (s->detail);
 
@@ -331,10 +348,23 @@ private_server_free (gpointer ptr)
 	g_free (s);
 }
 
+/**
+ * nm_bus_manager_private_server_register:
+ * @self: the #NMBusManager
+ * @path: the path of the unix socket
+ * @tag: the tag of the server, as detail of the "private-connection-*" signals
+ * @export_objects: whether the connections of the server get all objects
+ *   registered with nm_bus_manager_register_object(), like the bus
+ *   connection. Otherwise the users of the server export their objects
+ *   on the connections themselves.
+ *
+ * Listens for peer-to-peer D-Bus connections from root on @path.
+ */
 void
 nm_bus_manager_private_server_register (NMBusManager *self,
                                         const char *path,
-                                        const char *tag)
+                                        const char *tag,
+                                        gboolean export_objects)
 {
 	NMBusManagerPrivate *priv = NM_BUS_MANAGER_GET_PRIVATE (self);
 	PrivateServer *s;
@@ -351,7 +381,7 @@ nm_bus_manager_private_server_register (NMBusManager *self,
 			return;
 	}
 
-	s = private_server_new (path, tag, self);
+	s = private_server_new (path, tag, export_objects, self);
 	if (s)
 		priv->private_servers = g_slist_append (priv->private_servers, s);
 }
@@ -808,6 +838,7 @@ nm_bus_manager_register_object (NMBusManager *self,
                                 GDBusObjectSkeleton *object)
 {
 	NMBusManagerPrivate *priv;
+	GSList *iter;
 
 	g_return_if_fail (NM_IS_BUS_MANAGER (self));
 	g_return_if_fail (NM_IS_EXPORTED_OBJECT (object));
@@ -822,6 +853,18 @@ nm_bus_manager_register_object (NMBusManager *self,
 #endif
 
 	g_dbus_object_manager_server_export (priv->obj_manager, object);
+
+	for (iter = priv->private_servers; iter; iter = iter->next) {
+		PrivateServer *s = iter->data;
+		GHashTableIter h_iter;
+		GDBusObjectManagerServer *manager;
+
+		if (!s->export_objects)
+			continue;
+		g_hash_table_iter_init (&h_iter, s->obj_managers);
+		while (g_hash_table_iter_next (&h_iter, (gpointer *) &manager, NULL))
+			g_dbus_object_manager_server_export (manager, object);
+	}
 }
 
 GDBusObjectSkeleton *
@@ -839,6 +882,7 @@ nm_bus_manager_unregister_object (NMBusManager *self,
 {
 	NMBusManagerPrivate *priv;
 	gs_free char *path = NULL;
+	GSList *iter;
 
 	g_return_if_fail (NM_IS_BUS_MANAGER (self));
 	g_return_if_fail (NM_IS_EXPORTED_OBJECT (object));
@@ -856,6 +900,18 @@ nm_bus_manager_unregister_object (NMBusManager *self,
 	g_return_if_fail (path != NULL);
 
 	g_dbus_object_manager_server_unexport (priv->obj_manager, path);
+
+	for (iter = priv->private_servers; iter; iter = iter->next) {
+		PrivateServer *s = iter->data;
+		GHashTableIter h_iter;
+		GDBusObjectManagerServer *manager;
+
+		if (!s->export_objects)
+			continue;
+		g_hash_table_iter_init (&h_iter, s->obj_managers);
+		while (g_hash_table_iter_next (&h_iter, (gpointer *) &manager, NULL))
+			g_dbus_object_manager_server_unexport (manager, path);
+	}
 }
 
 const char *
@@ -81,7 +81,8 @@ GDBusObjectSkeleton *nm_bus_manager_get_registered_object (NMBusManager *self,
 
 void nm_bus_manager_private_server_register (NMBusManager *self,
                                              const char *path,
-                                             const char *tag);
+                                             const char *tag,
+                                             gboolean export_objects);
 
 GDBusProxy *nm_bus_manager_new_proxy (NMBusManager *self,
                                       GDBusConnection *connection,
@@ -118,6 +118,45 @@ nm_checkpoint_includes_device (NMCheckpoint *self, NMDevice *device)
 	return g_hash_table_contains (priv->devices, device);
 }
 
+/* Checkpoints only keep immutable snapshots of connections. The snapshot
+ * is cached on the connection and shared by all checkpoints, until the
+ * connection changes. Checkpointing many devices repeatedly thus only clones
+ * the connections that changed in between. */
+
+static NM_CACHED_QUARK_FCN ("nm-checkpoint-snapshot", _snapshot_quark)
+#define SNAPSHOT_QUARK (_snapshot_quark ())
+
+static void
+connection_snapshot_changed_cb (NMConnection *connection, gpointer user_data)
+{
+	g_signal_handlers_disconnect_by_func (connection, connection_snapshot_changed_cb, NULL);
+	g_object_set_qdata (G_OBJECT (connection), SNAPSHOT_QUARK, NULL);
+}
+
+static NMConnection *
+connection_snapshot_peek (NMConnection *connection)
+{
+	return g_object_get_qdata (G_OBJECT (connection), SNAPSHOT_QUARK);
+}
+
+static NMConnection *
+connection_snapshot_ref (NMConnection *connection)
+{
+	NMConnection *snapshot;
+
+	snapshot = connection_snapshot_peek (connection);
+	if (!snapshot) {
+		snapshot = nm_simple_connection_new_clone (connection);
+		g_object_set_qdata_full (G_OBJECT (connection), SNAPSHOT_QUARK,
+		                         snapshot, g_object_unref);
+		g_signal_connect (connection, NM_CONNECTION_CHANGED,
+		                  G_CALLBACK (connection_snapshot_changed_cb), NULL);
+	}
+	return g_object_ref (snapshot);
+}
+
+/*****************************************************************************/
+
 static NMSettingsConnection *
 find_settings_connection (NMCheckpoint *self,
                           DeviceCheckpoint *dev_checkpoint,
@@ -139,10 +178,12 @@ find_settings_connection (NMCheckpoint *self,
 	if (!connection)
 		return NULL;
 
-	/* Now check if the connection changed, ... */
-	if (!nm_connection_compare (dev_checkpoint->settings_connection,
-	                            NM_CONNECTION (connection),
-	                            NM_SETTING_COMPARE_FLAG_EXACT)) {
+	/* Now check if the connection changed, ... As long as the connection
+	 * still caches our snapshot, it did not. */
+	if (   connection_snapshot_peek (NM_CONNECTION (connection)) != dev_checkpoint->settings_connection
+	    && !nm_connection_compare (dev_checkpoint->settings_connection,
+	                               NM_CONNECTION (connection),
+	                               NM_SETTING_COMPARE_FLAG_EXACT)) {
 		_LOGT ("rollback: settings connection %s changed", uuid);
 		*need_update = TRUE;
 		*need_activation = TRUE;
@@ -272,12 +313,19 @@ activate:
 			}
 
 			if (need_activation) {
+				gs_unref_object NMConnection *applied = NULL;
+
 				_LOGD ("rollback: reactivating connection %s",
 				       nm_settings_connection_get_uuid (connection));
+
+				/* the active connection modifies its applied connection, but
+				 * the snapshot may be shared with other checkpoints. */
+				applied = nm_simple_connection_new_clone (dev_checkpoint->applied_connection);
+
 				subject = nm_auth_subject_new_internal ();
 				if (!nm_manager_activate_connection (priv->manager,
 				                                     connection,
-				                                     dev_checkpoint->applied_connection,
+				                                     applied,
 				                                     NULL,
 				                                     device,
 				                                     subject,
@@ -376,12 +424,12 @@ device_checkpoint_create (NMDevice *device,
 	applied_connection = nm_device_get_applied_connection (device);
 	if (applied_connection) {
 		dev_checkpoint->applied_connection =
-			nm_simple_connection_new_clone (applied_connection);
+			connection_snapshot_ref (applied_connection);
 
 		settings_connection = nm_device_get_settings_connection (device);
 		g_return_val_if_fail (settings_connection, NULL);
 		dev_checkpoint->settings_connection =
-			nm_simple_connection_new_clone (NM_CONNECTION (settings_connection));
+			connection_snapshot_ref (NM_CONNECTION (settings_connection));
 
 		act_request = nm_device_get_act_request (device);
 		g_return_val_if_fail (act_request, NULL);
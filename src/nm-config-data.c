@@ -23,6 +23,7 @@
 
 #include "nm-config-data.h"
 
+#include <errno.h>
 #include <string.h>
 
 #include "nm-config.h"
@@ -32,8 +33,28 @@
 
 /*****************************************************************************/
 
+/* The values of the merged keyfile, parsed once when the configuration
+ * is loaded. */
+typedef struct {
+	/* as returned by g_key_file_get_string(). %NULL if the value has
+	 * invalid escape sequences. */
+	char *value;
+
+	/* as returned by g_key_file_get_value() */
+	char *value_raw;
+
+	gint64 int64;
+	bool int64_valid;
+
+	/* the result of nm_config_parse_boolean() for @value and @value_raw,
+	 * or -1 if the value is no boolean. */
+	gint8 boolean;
+	gint8 boolean_raw;
+} ConfigValue;
+
 typedef struct {
 	char *group_name;
+	GHashTable *values;
 	gboolean stop_match;
 	struct {
 		/* have a separate boolean field @has, because a @spec with
@@ -41,6 +62,7 @@ typedef struct {
 		 * "match-device" was unspecified. */
 		gboolean has;
 		GSList *spec;
+		NMMatchSpecCompiled *compiled;
 	} match_device;
 } MatchSectionInfo;
 
@@ -79,6 +101,9 @@ typedef struct {
 	GKeyFile *keyfile_user;
 	GKeyFile *keyfile_intern;
 
+	/* The parsed values of @keyfile, hashed by group, then by key. */
+	GHashTable *values;
+
 	/* A zero-terminated list of pre-processed information from the
 	 * [connection] sections. This is to speed up lookup. */
 	MatchSectionInfo *connection_infos;
@@ -97,10 +122,14 @@ typedef struct {
 		char **arr;
 		GSList *specs;
 		GSList *specs_config;
+		NMMatchSpecCompiled *specs_compiled;
+		NMMatchSpecCompiled *specs_config_compiled;
 	} no_auto_default;
 
 	GSList *ignore_carrier;
 	GSList *assume_ipv6ll_only;
+	NMMatchSpecCompiled *ignore_carrier_compiled;
+	NMMatchSpecCompiled *assume_ipv6ll_only_compiled;
 
 	char *dns_mode;
 	char *rc_manager;
@@ -134,6 +163,90 @@ G_DEFINE_TYPE (NMConfigData, nm_config_data, G_TYPE_OBJECT)
 
 /*****************************************************************************/
 
+static void
+_config_value_free (gpointer data)
+{
+	ConfigValue *cv = data;
+
+	g_free (cv->value);
+	g_free (cv->value_raw);
+	g_slice_free (ConfigValue, cv);
+}
+
+static GHashTable *
+_config_values_construct (GKeyFile *keyfile)
+{
+	GHashTable *values;
+	gs_strfreev char **groups = NULL;
+	gsize i, j;
+
+	values = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_hash_table_unref);
+
+	groups = g_key_file_get_groups (keyfile, NULL);
+	for (i = 0; groups && groups[i]; i++) {
+		gs_strfreev char **keys = NULL;
+		GHashTable *group_values;
+
+		keys = g_key_file_get_keys (keyfile, groups[i], NULL, NULL);
+		if (!keys || !keys[0])
+			continue;
+
+		group_values = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, _config_value_free);
+		for (j = 0; keys[j]; j++) {
+			ConfigValue *cv;
+
+			cv = g_slice_new0 (ConfigValue);
+			cv->value_raw = g_key_file_get_value (keyfile, groups[i], keys[j], NULL);
+			cv->value = g_key_file_get_string (keyfile, groups[i], keys[j], NULL);
+			cv->boolean_raw = nm_config_parse_boolean (cv->value_raw, -1);
+			cv->boolean = nm_config_parse_boolean (cv->value, -1);
+			cv->int64 = _nm_utils_ascii_str_to_int64 (cv->value, 10, G_MININT64, G_MAXINT64, 0);
+			cv->int64_valid = (errno == 0);
+
+			/* later keys of the same name win, like in GKeyFile. */
+			g_hash_table_insert (group_values, g_steal_pointer (&keys[j]), cv);
+		}
+		g_hash_table_insert (values, g_steal_pointer (&groups[i]), group_values);
+	}
+	return values;
+}
+
+static const ConfigValue *
+_config_value_lookup (const NMConfigDataPrivate *priv, const char *group, const char *key)
+{
+	GHashTable *group_values;
+
+	group_values = g_hash_table_lookup (priv->values, group);
+	return group_values ? g_hash_table_lookup (group_values, key) : NULL;
+}
+
+/* Like nm_config_keyfile_get_value(). */
+static char *
+_config_value_get (const ConfigValue *cv, NMConfigGetValueFlags flags)
+{
+	char *value;
+
+	if (!cv)
+		return NULL;
+
+	value = g_strdup (NM_FLAGS_HAS (flags, NM_CONFIG_GET_VALUE_RAW) ? cv->value_raw : cv->value);
+	if (!value)
+		return NULL;
+
+	if (NM_FLAGS_HAS (flags, NM_CONFIG_GET_VALUE_STRIP))
+		g_strstrip (value);
+
+	if (   NM_FLAGS_HAS (flags, NM_CONFIG_GET_VALUE_NO_EMPTY)
+	    && !*value) {
+		g_free (value);
+		return NULL;
+	}
+
+	return value;
+}
+
+/*****************************************************************************/
+
 const char *
 nm_config_data_get_config_main_file (const NMConfigData *self)
 {
@@ -166,7 +279,7 @@ nm_config_data_get_value (const NMConfigData *self, const char *group, const cha
 	g_return_val_if_fail (group && *group, NULL);
 	g_return_val_if_fail (key && *key, NULL);
 
-	return nm_config_keyfile_get_value (NM_CONFIG_DATA_GET_PRIVATE (self)->keyfile, group, key, flags);
+	return _config_value_get (_config_value_lookup (NM_CONFIG_DATA_GET_PRIVATE (self), group, key), flags);
 }
 
 const char *nm_config_data_get_value_cached (const NMConfigData *self, const char *group, const char *key, NMConfigGetValueFlags flags)
@@ -181,7 +294,7 @@ const char *nm_config_data_get_value_cached (const NMConfigData *self, const cha
 
 	/* we modify @value_cached. In C++ jargon, the field is mutable. */
 	g_free (((NMConfigDataPrivate *) priv)->value_cached);
-	((NMConfigDataPrivate *) priv)->value_cached = nm_config_keyfile_get_value (priv->keyfile, group, key, flags);
+	((NMConfigDataPrivate *) priv)->value_cached = _config_value_get (_config_value_lookup (priv, group, key), flags);
 	return priv->value_cached;
 }
 
@@ -194,27 +307,74 @@ nm_config_data_has_value (const NMConfigData *self, const char *group, const cha
 	g_return_val_if_fail (group && *group, FALSE);
 	g_return_val_if_fail (key && *key, FALSE);
 
-	value = nm_config_keyfile_get_value (NM_CONFIG_DATA_GET_PRIVATE (self)->keyfile, group, key, flags);
+	value = _config_value_get (_config_value_lookup (NM_CONFIG_DATA_GET_PRIVATE (self), group, key), flags);
 	return !!value;
 }
 
+/**
+ * nm_config_data_is_value_changed:
+ * @old_data: the previous configuration
+ * @new_data: the current configuration
+ * @group: the group of the value
+ * @key: the key of the value
+ *
+ * Config-changed handlers can use this to restrict their work to the
+ * keys they care about. This compares the raw values and is cheap.
+ *
+ * Returns: whether @key in @group differs between @old_data and @new_data.
+ */
+gboolean
+nm_config_data_is_value_changed (const NMConfigData *old_data, const NMConfigData *new_data, const char *group, const char *key)
+{
+	const ConfigValue *cv_old, *cv_new;
+
+	g_return_val_if_fail (NM_IS_CONFIG_DATA (old_data), TRUE);
+	g_return_val_if_fail (NM_IS_CONFIG_DATA (new_data), TRUE);
+	g_return_val_if_fail (group && *group, TRUE);
+	g_return_val_if_fail (key && *key, TRUE);
+
+	if (old_data == new_data)
+		return FALSE;
+
+	cv_old = _config_value_lookup (NM_CONFIG_DATA_GET_PRIVATE (old_data), group, key);
+	cv_new = _config_value_lookup (NM_CONFIG_DATA_GET_PRIVATE (new_data), group, key);
+	return g_strcmp0 (cv_old ? cv_old->value_raw : NULL,
+	                  cv_new ? cv_new->value_raw : NULL) != 0;
+}
+
 gint
 nm_config_data_get_value_boolean (const NMConfigData *self, const char *group, const char *key, gint default_value)
 {
-	char *str;
-	gint value = default_value;
+	const ConfigValue *cv;
 
 	g_return_val_if_fail (NM_IS_CONFIG_DATA (self), default_value);
 	g_return_val_if_fail (group && *group, default_value);
 	g_return_val_if_fail (key && *key, default_value);
 
 	/* when parsing the boolean, base it on the raw value from g_key_file_get_value(). */
-	str = g_key_file_get_value (NM_CONFIG_DATA_GET_PRIVATE (self)->keyfile, group, key, NULL);
-	if (str) {
-		value = nm_config_parse_boolean (str, default_value);
-		g_free (str);
-	}
-	return value;
+	cv = _config_value_lookup (NM_CONFIG_DATA_GET_PRIVATE (self), group, key);
+	if (!cv || cv->boolean_raw == -1)
+		return default_value;
+	return cv->boolean_raw;
+}
+
+gint64
+nm_config_data_get_value_int64 (const NMConfigData *self, const char *group, const char *key,
+                                gint64 min, gint64 max, gint64 fallback)
+{
+	const ConfigValue *cv;
+
+	g_return_val_if_fail (NM_IS_CONFIG_DATA (self), fallback);
+	g_return_val_if_fail (group && *group, fallback);
+	g_return_val_if_fail (key && *key, fallback);
+
+	cv = _config_value_lookup (NM_CONFIG_DATA_GET_PRIVATE (self), group, key);
+	if (   !cv
+	    || !cv->int64_valid
+	    || cv->int64 < min
+	    || cv->int64 > max)
+		return fallback;
+	return cv->int64;
 }
 
 char **
@@ -279,8 +439,8 @@ nm_config_data_get_no_auto_default_for_device (const NMConfigData *self, NMDevic
 	g_return_val_if_fail (NM_IS_DEVICE (device), FALSE);
 
 	priv = NM_CONFIG_DATA_GET_PRIVATE (self);
-	return    nm_device_spec_match_list (device, priv->no_auto_default.specs)
-	       || nm_device_spec_match_list (device, priv->no_auto_default.specs_config);
+	return    nm_device_spec_match_compiled (device, priv->no_auto_default.specs_compiled)
+	       || nm_device_spec_match_compiled (device, priv->no_auto_default.specs_config_compiled);
 }
 
 const char *
@@ -302,17 +462,16 @@ nm_config_data_get_rc_manager (const NMConfigData *self)
 gboolean
 nm_config_data_get_ignore_carrier (const NMConfigData *self, NMDevice *device)
 {
-	gs_free char *value = NULL;
-	gboolean has_match;
+	gint value;
 
 	g_return_val_if_fail (NM_IS_CONFIG_DATA (self), FALSE);
 	g_return_val_if_fail (NM_IS_DEVICE (device), FALSE);
 
-	value = nm_config_data_get_device_config (self, NM_CONFIG_KEYFILE_KEY_DEVICE_IGNORE_CARRIER, device, &has_match);
-	if (has_match)
-		return nm_config_parse_boolean (value, FALSE);
+	value = nm_config_data_get_device_config_boolean (self, NM_CONFIG_KEYFILE_KEY_DEVICE_IGNORE_CARRIER, device, -1, FALSE);
+	if (value != -1)
+		return value;
 
-	return nm_device_spec_match_list (device, NM_CONFIG_DATA_GET_PRIVATE (self)->ignore_carrier);
+	return nm_device_spec_match_compiled (device, NM_CONFIG_DATA_GET_PRIVATE (self)->ignore_carrier_compiled);
 }
 
 gboolean
@@ -321,7 +480,7 @@ nm_config_data_get_assume_ipv6ll_only (const NMConfigData *self, NMDevice *devic
 	g_return_val_if_fail (NM_IS_CONFIG_DATA (self), FALSE);
 	g_return_val_if_fail (NM_IS_DEVICE (device), FALSE);
 
-	return nm_device_spec_match_list (device, NM_CONFIG_DATA_GET_PRIVATE (self)->assume_ipv6ll_only);
+	return nm_device_spec_match_compiled (device, NM_CONFIG_DATA_GET_PRIVATE (self)->assume_ipv6ll_only_compiled);
 }
 
 GKeyFile *
@@ -1163,38 +1322,40 @@ global_dns_equal (NMGlobalDnsConfig *old, NMGlobalDnsConfig *new)
 
 static const MatchSectionInfo *
 _match_section_infos_lookup (const MatchSectionInfo *match_section_infos,
-                             GKeyFile *keyfile,
                              const char *property,
                              NMDevice *device,
-                             char **out_value)
+                             const ConfigValue **out_value)
 {
 	if (!match_section_infos)
 		return NULL;
 
 	for (; match_section_infos->group_name; match_section_infos++) {
-		char *value = NULL;
+		const ConfigValue *cv = NULL;
 		gboolean match;
 
-		/* FIXME: Here we use g_key_file_get_string(). This should be in sync with what keyfile-reader
-		 * does.
+		/* FIXME: Here we use the value from g_key_file_get_string(). This should be in sync with
+		 * what keyfile-reader does.
 		 *
 		 * Unfortunately that is currently not possible because keyfile-reader does the two steps
 		 * string_to_value(keyfile_to_string(keyfile)) in one. Optimally, keyfile library would
 		 * expose both functions, and we would return here keyfile_to_string(keyfile).
 		 * The caller then could convert the string to the proper value via string_to_value(value). */
-		value = g_key_file_get_string (keyfile, match_section_infos->group_name, property, NULL);
-		if (!value && !match_section_infos->stop_match)
+		if (match_section_infos->values) {
+			cv = g_hash_table_lookup (match_section_infos->values, property);
+			if (cv && !cv->value)
+				cv = NULL;
+		}
+		if (!cv && !match_section_infos->stop_match)
 			continue;
 
 		match = TRUE;
 		if (match_section_infos->match_device.has)
-			match = device && nm_device_spec_match_list (device, match_section_infos->match_device.spec);
+			match = device && nm_device_spec_match_compiled (device, match_section_infos->match_device.compiled);
 
 		if (match) {
-			*out_value = value;
+			*out_value = cv;
 			return match_section_infos;
 		}
-		g_free (value);
 	}
 	return NULL;
 }
@@ -1207,7 +1368,7 @@ nm_config_data_get_device_config (const NMConfigData *self,
 {
 	const NMConfigDataPrivate *priv;
 	const MatchSectionInfo *connection_info;
-	char *value = NULL;
+	const ConfigValue *cv = NULL;
 
 	g_return_val_if_fail (self, NULL);
 	g_return_val_if_fail (property && *property, NULL);
@@ -1215,12 +1376,11 @@ nm_config_data_get_device_config (const NMConfigData *self,
 	priv = NM_CONFIG_DATA_GET_PRIVATE (self);
 
 	connection_info = _match_section_infos_lookup (&priv->device_infos[0],
-	                                               priv->keyfile,
 	                                               property,
 	                                               device,
-	                                               &value);
+	                                               &cv);
 	NM_SET_OUT (has_match, !!connection_info);
-	return value;
+	return cv ? g_strdup (cv->value) : NULL;
 }
 
 gboolean
@@ -1230,13 +1390,44 @@ nm_config_data_get_device_config_boolean (const NMConfigData *self,
                                           gint val_no_match,
                                           gint val_invalid)
 {
-	gs_free char *value = NULL;
-	gboolean has_match;
+	const NMConfigDataPrivate *priv;
+	const ConfigValue *cv = NULL;
+
+	g_return_val_if_fail (self, val_no_match);
+	g_return_val_if_fail (property && *property, val_no_match);
+
+	priv = NM_CONFIG_DATA_GET_PRIVATE (self);
 
-	value = nm_config_data_get_device_config (self, property, device, &has_match);
-	if (!has_match)
+	if (!_match_section_infos_lookup (&priv->device_infos[0], property, device, &cv))
 		return val_no_match;
-	return nm_config_parse_boolean (value, val_invalid);
+	if (!cv || cv->boolean == -1)
+		return val_invalid;
+	return cv->boolean;
+}
+
+gint64
+nm_config_data_get_device_config_int64 (const NMConfigData *self,
+                                        const char *property,
+                                        NMDevice *device,
+                                        gint64 min,
+                                        gint64 max,
+                                        gint64 fallback)
+{
+	const NMConfigDataPrivate *priv;
+	const ConfigValue *cv = NULL;
+
+	g_return_val_if_fail (self, fallback);
+	g_return_val_if_fail (property && *property, fallback);
+
+	priv = NM_CONFIG_DATA_GET_PRIVATE (self);
+
+	if (   !_match_section_infos_lookup (&priv->device_infos[0], property, device, &cv)
+	    || !cv
+	    || !cv->int64_valid
+	    || cv->int64 < min
+	    || cv->int64 > max)
+		return fallback;
+	return cv->int64;
 }
 
 char *
@@ -1245,7 +1436,7 @@ nm_config_data_get_connection_default (const NMConfigData *self,
                                        NMDevice *device)
 {
 	const NMConfigDataPrivate *priv;
-	char *value = NULL;
+	const ConfigValue *cv = NULL;
 
 	g_return_val_if_fail (self, NULL);
 	g_return_val_if_fail (property && *property, NULL);
@@ -1254,23 +1445,24 @@ nm_config_data_get_connection_default (const NMConfigData *self,
 	priv = NM_CONFIG_DATA_GET_PRIVATE (self);
 
 	_match_section_infos_lookup (&priv->connection_infos[0],
-	                             priv->keyfile,
 	                             property,
 	                             device,
-	                             &value);
-	return value;
+	                             &cv);
+	return cv ? g_strdup (cv->value) : NULL;
 }
 
 static void
-_get_connection_info_init (MatchSectionInfo *connection_info, GKeyFile *keyfile, char *group)
+_get_connection_info_init (MatchSectionInfo *connection_info, GKeyFile *keyfile, GHashTable *values, char *group)
 {
 	/* pass ownership of @group on... */
 	connection_info->group_name = group;
+	connection_info->values = g_hash_table_lookup (values, group);
 
 	connection_info->match_device.spec = nm_config_get_match_spec (keyfile,
 	                                                               group,
 	                                                               "match-device",
 	                                                               &connection_info->match_device.has);
+	connection_info->match_device.compiled = nm_match_spec_compile (connection_info->match_device.spec);
 	connection_info->stop_match = nm_config_keyfile_get_boolean (keyfile, group, "stop-match", FALSE);
 }
 
@@ -1284,12 +1476,13 @@ _match_section_infos_free (MatchSectionInfo *match_section_infos)
 	for (i = 0; match_section_infos[i].group_name; i++) {
 		g_free (match_section_infos[i].group_name);
 		g_slist_free_full (match_section_infos[i].match_device.spec, g_free);
+		nm_match_spec_compiled_free (match_section_infos[i].match_device.compiled);
 	}
 	g_free (match_section_infos);
 }
 
 static MatchSectionInfo *
-_match_section_infos_construct (GKeyFile *keyfile, const char *prefix)
+_match_section_infos_construct (GKeyFile *keyfile, GHashTable *values, const char *prefix)
 {
 	char **groups;
 	gsize i, j, ngroups;
@@ -1328,11 +1521,11 @@ _match_section_infos_construct (GKeyFile *keyfile, const char *prefix)
 	match_section_infos = g_new0 (MatchSectionInfo, ngroups + 1 + (connection_tag ? 1 : 0));
 	for (i = 0; i < ngroups; i++) {
 		/* pass ownership of @group on... */
-		_get_connection_info_init (&match_section_infos[i], keyfile, groups[ngroups - i - 1]);
+		_get_connection_info_init (&match_section_infos[i], keyfile, values, groups[ngroups - i - 1]);
 	}
 	if (connection_tag) {
 		/* pass ownership of @connection_tag on... */
-		_get_connection_info_init (&match_section_infos[i], keyfile, connection_tag);
+		_get_connection_info_init (&match_section_infos[i], keyfile, values, connection_tag);
 	}
 	g_free (groups);
 
@@ -1351,6 +1544,45 @@ _slist_str_equals (GSList *a, GSList *b)
 	return !a && !b;
 }
 
+static gboolean
+_config_values_group_equal (GHashTable *a, GHashTable *b)
+{
+	GHashTableIter iter;
+	const char *key;
+	const ConfigValue *cv_a, *cv_b;
+
+	if (a == b)
+		return TRUE;
+	if (   !a
+	    || !b
+	    || g_hash_table_size (a) != g_hash_table_size (b))
+		return FALSE;
+
+	g_hash_table_iter_init (&iter, a);
+	while (g_hash_table_iter_next (&iter, (gpointer *) &key, (gpointer *) &cv_a)) {
+		cv_b = g_hash_table_lookup (b, key);
+		if (   !cv_b
+		    || g_strcmp0 (cv_a->value_raw, cv_b->value_raw) != 0)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static gboolean
+_match_section_infos_equal (const MatchSectionInfo *a, const MatchSectionInfo *b)
+{
+	if (!a || !b)
+		return a == b;
+
+	/* the order of the sections matters, as the first match wins. */
+	for (; a->group_name && b->group_name; a++, b++) {
+		if (   !nm_streq (a->group_name, b->group_name)
+		    || !_config_values_group_equal (a->values, b->values))
+			return FALSE;
+	}
+	return !a->group_name && !b->group_name;
+}
+
 NMConfigChangeFlags
 nm_config_data_diff (NMConfigData *old_data, NMConfigData *new_data)
 {
@@ -1391,6 +1623,11 @@ nm_config_data_diff (NMConfigData *old_data, NMConfigData *new_data)
 	if (!global_dns_equal (priv_old->global_dns, priv_new->global_dns))
 		changes |= NM_CONFIG_CHANGE_GLOBAL_DNS_CONFIG;
 
+	if (   !_match_section_infos_equal (priv_old->device_infos, priv_new->device_infos)
+	    || !_slist_str_equals (priv_old->ignore_carrier, priv_new->ignore_carrier)
+	    || !_slist_str_equals (priv_old->assume_ipv6ll_only, priv_new->assume_ipv6ll_only))
+		changes |= NM_CONFIG_CHANGE_DEVICE_CONFIG;
+
 	nm_assert (!NM_FLAGS_ANY (changes, NM_CONFIG_CHANGE_CAUSES));
 
 	return changes;
@@ -1506,9 +1743,10 @@ constructed (GObject *object)
 	char *interval;
 
 	priv->keyfile = _merge_keyfiles (priv->keyfile_user, priv->keyfile_intern);
+	priv->values = _config_values_construct (priv->keyfile);
 
-	priv->connection_infos = _match_section_infos_construct (priv->keyfile, NM_CONFIG_KEYFILE_GROUPPREFIX_CONNECTION);
-	priv->device_infos = _match_section_infos_construct (priv->keyfile, NM_CONFIG_KEYFILE_GROUPPREFIX_DEVICE);
+	priv->connection_infos = _match_section_infos_construct (priv->keyfile, priv->values, NM_CONFIG_KEYFILE_GROUPPREFIX_CONNECTION);
+	priv->device_infos = _match_section_infos_construct (priv->keyfile, priv->values, NM_CONFIG_KEYFILE_GROUPPREFIX_DEVICE);
 
 	priv->connectivity.uri = nm_strstrip (g_key_file_get_string (priv->keyfile, NM_CONFIG_KEYFILE_GROUP_CONNECTIVITY, "uri", NULL));
 	priv->connectivity.response = g_key_file_get_string (priv->keyfile, NM_CONFIG_KEYFILE_GROUP_CONNECTIVITY, "response", NULL);
@@ -1529,6 +1767,11 @@ constructed (GObject *object)
 
 	priv->no_auto_default.specs_config = nm_config_get_match_spec (priv->keyfile, NM_CONFIG_KEYFILE_GROUP_MAIN, "no-auto-default", NULL);
 
+	priv->ignore_carrier_compiled = nm_match_spec_compile (priv->ignore_carrier);
+	priv->assume_ipv6ll_only_compiled = nm_match_spec_compile (priv->assume_ipv6ll_only);
+	priv->no_auto_default.specs_compiled = nm_match_spec_compile (priv->no_auto_default.specs);
+	priv->no_auto_default.specs_config_compiled = nm_match_spec_compile (priv->no_auto_default.specs_config);
+
 	priv->global_dns = load_global_dns (priv->keyfile_user, FALSE);
 	if (!priv->global_dns)
 		priv->global_dns = load_global_dns (priv->keyfile_intern, TRUE);
@@ -1594,6 +1837,8 @@ finalize (GObject *gobject)
 
 	g_slist_free_full (priv->no_auto_default.specs, g_free);
 	g_slist_free_full (priv->no_auto_default.specs_config, g_free);
+	nm_match_spec_compiled_free (priv->no_auto_default.specs_compiled);
+	nm_match_spec_compiled_free (priv->no_auto_default.specs_config_compiled);
 	g_strfreev (priv->no_auto_default.arr);
 
 	g_free (priv->dns_mode);
@@ -1601,12 +1846,16 @@ finalize (GObject *gobject)
 
 	g_slist_free_full (priv->ignore_carrier, g_free);
 	g_slist_free_full (priv->assume_ipv6ll_only, g_free);
+	nm_match_spec_compiled_free (priv->ignore_carrier_compiled);
+	nm_match_spec_compiled_free (priv->assume_ipv6ll_only_compiled);
 
 	nm_global_dns_config_free (priv->global_dns);
 
 	_match_section_infos_free (priv->connection_infos);
 	_match_section_infos_free (priv->device_infos);
 
+	g_hash_table_unref (priv->values);
+
 	g_key_file_unref (priv->keyfile);
 	if (priv->keyfile_user)
 		g_key_file_unref (priv->keyfile_user);
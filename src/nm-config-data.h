@@ -125,6 +125,10 @@ typedef enum { /*< flags >*/
 	/* configuration regarding global dns-config changed */
 	NM_CONFIG_CHANGE_GLOBAL_DNS_CONFIG         = (1L << 18),
 
+	/* the [device] sections, or the device specs in [main] like
+	 * ignore-carrier changed */
+	NM_CONFIG_CHANGE_DEVICE_CONFIG             = (1L << 19),
+
 } NMConfigChangeFlags;
 
 typedef struct _NMConfigDataClass NMConfigDataClass;
@@ -154,9 +158,11 @@ const char *nm_config_data_get_config_description (const NMConfigData *config_da
 
 gboolean nm_config_data_has_group (const NMConfigData *self, const char *group);
 gboolean nm_config_data_has_value (const NMConfigData *self, const char *group, const char *key, NMConfigGetValueFlags flags);
+gboolean nm_config_data_is_value_changed (const NMConfigData *old_data, const NMConfigData *new_data, const char *group, const char *key);
 char *nm_config_data_get_value (const NMConfigData *config_data, const char *group, const char *key, NMConfigGetValueFlags flags);
 const char *nm_config_data_get_value_cached (const NMConfigData *config_data, const char *group, const char *key, NMConfigGetValueFlags flags);
 gint nm_config_data_get_value_boolean (const NMConfigData *self, const char *group, const char *key, gint default_value);
+gint64 nm_config_data_get_value_int64 (const NMConfigData *self, const char *group, const char *key, gint64 min, gint64 max, gint64 fallback);
 
 char **nm_config_data_get_plugins (const NMConfigData *config_data, gboolean allow_default);
 const char *nm_config_data_get_connectivity_uri (const NMConfigData *config_data);
@@ -188,6 +194,13 @@ gboolean nm_config_data_get_device_config_boolean (const NMConfigData *self,
                                                    gint val_no_match,
                                                    gint val_invalid);
 
+gint64 nm_config_data_get_device_config_int64 (const NMConfigData *self,
+                                               const char *property,
+                                               NMDevice *device,
+                                               gint64 min,
+                                               gint64 max,
+                                               gint64 fallback);
+
 char **nm_config_data_get_groups (const NMConfigData *self);
 char **nm_config_data_get_keys (const NMConfigData *self, const char *group);
 gboolean nm_config_data_is_intern_atomic_group (const NMConfigData *self, const char *group);
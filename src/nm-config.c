@@ -1852,6 +1852,8 @@ _nm_config_state_set (NMConfig *self,
 #define DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_MANAGED             "managed"
 #define DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_PERM_HW_ADDR_FAKE   "perm-hw-addr-fake"
 #define DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_CONNECTION_UUID     "connection-uuid"
+#define DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_CONNECTION_CHECKSUM "connection-checksum"
+#define DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_IP_ADDRESSES        "ip-addresses"
 
 static NMConfigDeviceStateData *
 _config_device_state_data_new (int ifindex, GKeyFile *kf)
@@ -1859,8 +1861,12 @@ _config_device_state_data_new (int ifindex, GKeyFile *kf)
 	NMConfigDeviceStateData *device_state;
 	NMConfigDeviceStateManagedType managed_type = NM_CONFIG_DEVICE_STATE_MANAGED_TYPE_UNKNOWN;
 	gs_free char *connection_uuid = NULL;
+	gs_free char *connection_checksum = NULL;
+	gs_free char *ip_addresses = NULL;
 	gs_free char *perm_hw_addr_fake = NULL;
 	gsize connection_uuid_len;
+	gsize connection_checksum_len;
+	gsize ip_addresses_len;
 	gsize perm_hw_addr_fake_len;
 	char *p;
 
@@ -1883,6 +1889,16 @@ _config_device_state_data_new (int ifindex, GKeyFile *kf)
 			                                               DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_CONNECTION_UUID,
 			                                               NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY);
 		}
+		if (connection_uuid) {
+			connection_checksum = nm_config_keyfile_get_value (kf,
+			                                                   DEVICE_RUN_STATE_KEYFILE_GROUP_DEVICE,
+			                                                   DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_CONNECTION_CHECKSUM,
+			                                                   NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY);
+			ip_addresses = nm_config_keyfile_get_value (kf,
+			                                            DEVICE_RUN_STATE_KEYFILE_GROUP_DEVICE,
+			                                            DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_IP_ADDRESSES,
+			                                            NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY);
+		}
 
 		perm_hw_addr_fake = nm_config_keyfile_get_value (kf,
 		                                                 DEVICE_RUN_STATE_KEYFILE_GROUP_DEVICE,
@@ -1898,15 +1914,21 @@ _config_device_state_data_new (int ifindex, GKeyFile *kf)
 	}
 
 	connection_uuid_len = connection_uuid ? strlen (connection_uuid) + 1 : 0;
+	connection_checksum_len = connection_checksum ? strlen (connection_checksum) + 1 : 0;
+	ip_addresses_len = ip_addresses ? strlen (ip_addresses) + 1 : 0;
 	perm_hw_addr_fake_len = perm_hw_addr_fake ? strlen (perm_hw_addr_fake) + 1 : 0;
 
 	device_state = g_malloc (sizeof (NMConfigDeviceStateData) +
 	                         connection_uuid_len +
+	                         connection_checksum_len +
+	                         ip_addresses_len +
 	                         perm_hw_addr_fake_len);
 
 	device_state->ifindex = ifindex;
 	device_state->managed = managed_type;
 	device_state->connection_uuid = NULL;
+	device_state->connection_checksum = NULL;
+	device_state->ip_addresses = NULL;
 	device_state->perm_hw_addr_fake = NULL;
 
 	p = (char *) (&device_state[1]);
@@ -1915,6 +1937,16 @@ _config_device_state_data_new (int ifindex, GKeyFile *kf)
 		device_state->connection_uuid = p;
 		p += connection_uuid_len;
 	}
+	if (connection_checksum) {
+		memcpy (p, connection_checksum, connection_checksum_len);
+		device_state->connection_checksum = p;
+		p += connection_checksum_len;
+	}
+	if (ip_addresses) {
+		memcpy (p, ip_addresses, ip_addresses_len);
+		device_state->ip_addresses = p;
+		p += ip_addresses_len;
+	}
 	if (perm_hw_addr_fake) {
 		memcpy (p, perm_hw_addr_fake, perm_hw_addr_fake_len);
 		device_state->perm_hw_addr_fake = p;
@@ -1969,7 +2001,9 @@ nm_config_device_state_write (NMConfig *self,
                               int ifindex,
                               gboolean managed,
                               const char *perm_hw_addr_fake,
-                              const char *connection_uuid)
+                              const char *connection_uuid,
+                              const char *connection_checksum,
+                              const char *ip_addresses)
 {
 	char path[NM_STRLEN (NM_CONFIG_DEVICE_STATE_DIR) + 60];
 	GError *local = NULL;
@@ -1979,6 +2013,7 @@ nm_config_device_state_write (NMConfig *self,
 	g_return_val_if_fail (ifindex > 0, FALSE);
 	g_return_val_if_fail (!connection_uuid || *connection_uuid, FALSE);
 	g_return_val_if_fail (managed || !connection_uuid, FALSE);
+	g_return_val_if_fail (connection_uuid || !connection_checksum, FALSE);
 
 	nm_assert (!perm_hw_addr_fake || nm_utils_hwaddr_valid (perm_hw_addr_fake, -1));
 
@@ -2000,6 +2035,18 @@ nm_config_device_state_write (NMConfig *self,
 		                       DEVICE_RUN_STATE_KEYFILE_GROUP_DEVICE,
 		                       DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_CONNECTION_UUID,
 		                       connection_uuid);
+		if (connection_checksum) {
+			g_key_file_set_string (kf,
+			                       DEVICE_RUN_STATE_KEYFILE_GROUP_DEVICE,
+			                       DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_CONNECTION_CHECKSUM,
+			                       connection_checksum);
+		}
+		if (ip_addresses) {
+			g_key_file_set_string (kf,
+			                       DEVICE_RUN_STATE_KEYFILE_GROUP_DEVICE,
+			                       DEVICE_RUN_STATE_KEYFILE_KEY_DEVICE_IP_ADDRESSES,
+			                       ip_addresses);
+		}
 	}
 
 	if (!g_key_file_save_to_file (kf, path, &local)) {
@@ -2145,6 +2192,7 @@ NM_UTILS_FLAGS2STR_DEFINE (nm_config_change_flags_to_string, NMConfigChangeFlags
 	NM_UTILS_FLAGS2STR (NM_CONFIG_CHANGE_DNS_MODE, "dns-mode"),
 	NM_UTILS_FLAGS2STR (NM_CONFIG_CHANGE_RC_MANAGER, "rc-manager"),
 	NM_UTILS_FLAGS2STR (NM_CONFIG_CHANGE_GLOBAL_DNS_CONFIG, "global-dns-config"),
+	NM_UTILS_FLAGS2STR (NM_CONFIG_CHANGE_DEVICE_CONFIG, "device-config"),
 );
 
 static void
@@ -63,7 +63,20 @@
 #define NM_CONFIG_KEYFILE_KEY_MAIN_DHCP                     "dhcp"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_DEBUG                    "debug"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_HOSTNAME_MODE            "hostname-mode"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_DNS_UPDATE_INTERVAL      "dns-update-interval"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_SECRET_AGENTS_PARALLEL   "secret-agents-parallel"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_FIREWALL_ZONE_ASYNC      "firewall-zone-async"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_VPN_PLUGIN_POOL_SIZE     "vpn-plugin-pool-size"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_VPN_PLUGIN_POOL_TIMEOUT  "vpn-plugin-pool-timeout"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_VPN_RECONNECT_CACHE      "vpn-reconnect-cache"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_PRIVATE_SOCKET           "private-socket"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_STATE_SNAPSHOT_INTERVAL  "state-snapshot-interval"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_IGNORE_ROUTE_PROTOCOLS   "ignore-route-protocols"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_SHUTDOWN_TIMEOUT         "shutdown-timeout"
 #define NM_CONFIG_KEYFILE_KEY_LOGGING_BACKEND               "backend"
+#define NM_CONFIG_KEYFILE_KEY_LOGGING_ASYNC                 "async"
+#define NM_CONFIG_KEYFILE_KEY_LOGGING_TRACE_BUFFER_SIZE     "trace-buffer-size"
+#define NM_CONFIG_KEYFILE_KEY_LOGGING_TRACE_BUFFER_LEVEL    "trace-buffer-level"
 #define NM_CONFIG_KEYFILE_KEY_CONFIG_ENABLE                 "enable"
 #define NM_CONFIG_KEYFILE_KEY_ATOMIC_SECTION_WAS            ".was"
 #define NM_CONFIG_KEYFILE_KEY_KEYFILE_PATH                  "path"
@@ -75,6 +88,10 @@
 #define NM_CONFIG_KEYFILE_KEY_AUDIT                         "audit"
 
 #define NM_CONFIG_KEYFILE_KEY_DEVICE_IGNORE_CARRIER         "ignore-carrier"
+#define NM_CONFIG_KEYFILE_KEY_DEVICE_CARRIER_DAMPENING_HALF_LIFE "carrier-dampening.half-life"
+#define NM_CONFIG_KEYFILE_KEY_DEVICE_CARRIER_DAMPENING_SUPPRESS  "carrier-dampening.suppress"
+#define NM_CONFIG_KEYFILE_KEY_DEVICE_CARRIER_DAMPENING_REUSE     "carrier-dampening.reuse"
+#define NM_CONFIG_KEYFILE_KEY_DEVICE_LAZY_EXTERNAL_CONNECTION    "lazy-external-connection"
 
 #define NM_CONFIG_KEYFILE_KEYPREFIX_WAS                     ".was."
 #define NM_CONFIG_KEYFILE_KEYPREFIX_SET                     ".set."
@@ -200,6 +217,16 @@ struct _NMConfigDeviceStateData {
 	 * on the device. */
 	const char *connection_uuid;
 
+	/* a checksum of the settings-connection, if it was active on the
+	 * device unmodified. Together with @ip_addresses it allows to
+	 * assume the connection after restart without generating and
+	 * matching a connection. */
+	const char *connection_checksum;
+
+	/* the addresses that were configured on the device, as a
+	 * comma separated list of "address/plen". */
+	const char *ip_addresses;
+
 	const char *perm_hw_addr_fake;
 };
 
@@ -209,7 +236,9 @@ gboolean nm_config_device_state_write (NMConfig *self,
                                        int ifindex,
                                        gboolean managed,
                                        const char *perm_hw_addr_fake,
-                                       const char *connection_uuid);
+                                       const char *connection_uuid,
+                                       const char *connection_checksum,
+                                       const char *ip_addresses);
 void nm_config_device_state_prune_unseen (NMConfig *self, GHashTable *seen_ifindexes);
 
 /*****************************************************************************/
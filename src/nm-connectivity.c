@@ -32,14 +32,28 @@
 
 /*****************************************************************************/
 
+/* When a check does not report full connectivity, the periodic check is
+ * rescheduled after this many seconds and the delay doubles with every
+ * failing round until it reaches the configured interval again. */
+#define PERIODIC_CHECK_BACKOFF_MIN_SEC 5
+
+/* Once a check is decided we keep reading (and discarding) the rest of the
+ * reply, so that the connection can go back to the pool. Replies longer than
+ * this are cut short and their connection is dropped. */
+#define DRAIN_MAX_SIZE 4096
+
 typedef struct {
 	char *uri;
 	char *response;
 	guint interval;
 	NMConfig *config;
 	guint periodic_check_id;
+	guint periodic_check_cur;
+	bool periodic_check_failed:1;
 	CURLM *curl_mhandle;
+	CURLSH *curl_shandle;
 	guint curl_timer;
+	GSList *checks;
 } NMConnectivityPrivate;
 
 struct _NMConnectivity {
@@ -99,32 +113,71 @@ NM_UTILS_LOOKUP_STR_DEFINE (nm_connectivity_state_to_string, NMConnectivityState
 /*****************************************************************************/
 
 typedef struct {
+	NMConnectivity *self;
 	GSimpleAsyncResult *simple;
 	char *response;
 	CURL *curl_ehandle;
 	size_t msg_size;
 	char *msg;
-	struct curl_slist *request_headers;
 	guint timeout_id;
 	char *ifspec;
 } ConCheckCbData;
 
+static void periodic_check_schedule (NMConnectivity *self, guint interval);
+
+static void
+periodic_check_report (NMConnectivity *self, NMConnectivityState state)
+{
+	NMConnectivityPrivate *priv = NM_CONNECTIVITY_GET_PRIVATE (self);
+
+	if (NM_IN_SET (state, NM_CONNECTIVITY_FULL, NM_CONNECTIVITY_UNKNOWN))
+		return;
+
+	priv->periodic_check_failed = TRUE;
+
+	/* Start backing off right away instead of waiting for a full
+	 * interval to notice that the check is failing. */
+	if (   priv->periodic_check_id
+	    && priv->periodic_check_cur == priv->interval)
+		periodic_check_schedule (self, MIN (PERIODIC_CHECK_BACKOFF_MIN_SEC, priv->interval));
+}
+
 static void
 finish_cb_data (ConCheckCbData *cb_data, NMConnectivityState new_state)
 {
+	GSimpleAsyncResult *simple;
+
 	/* Contrary to what cURL manual claim it is *not* safe to remove
 	 * the easy handle "at any moment"; specifically not from the
-	 * write function. Thus here we just dissociate the cb_data from
-	 * the easy handle and the easy handle will be cleaned up when the
-	 * message goes to CURLMSG_DONE in curl_check_connectivity(). */
-	curl_easy_setopt (cb_data->curl_ehandle, CURLOPT_PRIVATE, NULL);
-
-	g_simple_async_result_set_op_res_gssize (cb_data->simple, new_state);
-	g_simple_async_result_complete (cb_data->simple);
-	g_object_unref (cb_data->simple);
-	curl_slist_free_all (cb_data->request_headers);
+	 * write function. Thus here we only report the result and keep
+	 * the cb_data around. It is freed together with the easy handle
+	 * once the message goes to CURLMSG_DONE in curl_check_connectivity(). */
+	simple = g_steal_pointer (&cb_data->simple);
+	if (!simple)
+		return;
+
+	periodic_check_report (cb_data->self, new_state);
+
+	g_simple_async_result_set_op_res_gssize (simple, new_state);
+	g_simple_async_result_complete (simple);
+	g_object_unref (simple);
+}
+
+static void
+free_cb_data (ConCheckCbData *cb_data)
+{
+	NMConnectivityPrivate *priv = NM_CONNECTIVITY_GET_PRIVATE (cb_data->self);
+
+	nm_assert (!cb_data->simple);
+
+	priv->checks = g_slist_remove (priv->checks, cb_data);
+
+	curl_multi_remove_handle (priv->curl_mhandle, cb_data->curl_ehandle);
+	curl_easy_cleanup (cb_data->curl_ehandle);
+	nm_clear_g_source (&cb_data->timeout_id);
 	g_free (cb_data->response);
-	g_source_remove (cb_data->timeout_id);
+	g_free (cb_data->msg);
+	g_free (cb_data->ifspec);
 	g_slice_free (ConCheckCbData, cb_data);
 }
 
@@ -150,8 +203,11 @@ curl_check_connectivity (CURLM *mhandle, CURLMcode ret)
 			continue;
 		}
 
-		if (cb_data) {
-			/* If cb_data is still there this message hasn't been
+		if (!cb_data)
+			continue;
+
+		if (cb_data->simple) {
+			/* If the result is still pending this message hasn't been
 			 * taken care of. Do so now. */
 			if (msg->data.result == CURLE_OK) {
 				/* If we get here, it means that easy_write_cb() didn't read enough
@@ -165,8 +221,7 @@ curl_check_connectivity (CURLM *mhandle, CURLMcode ret)
 			}
 		}
 
-		curl_multi_remove_handle (mhandle, msg->easy_handle);
-		curl_easy_cleanup (msg->easy_handle);
+		free_cb_data (cb_data);
 	}
 }
 
@@ -274,11 +329,13 @@ easy_header_cb (char *buffer, size_t size, size_t nitems, void *userdata)
 	ConCheckCbData *cb_data = userdata;
 	size_t len = size * nitems;
 
+	if (!cb_data->simple)
+		return len;
+
 	if (   len >= sizeof (HEADER_STATUS_ONLINE) - 1
 	    && !g_ascii_strncasecmp (buffer, HEADER_STATUS_ONLINE, sizeof (HEADER_STATUS_ONLINE) - 1)) {
 		_LOG2D ("status header found, check successful");
 		finish_cb_data (cb_data, NM_CONNECTIVITY_FULL);
-		return 0;
 	}
 
 	return len;
@@ -290,6 +347,13 @@ easy_write_cb (void *buffer, size_t size, size_t nmemb, void *userdata)
 	ConCheckCbData *cb_data = userdata;
 	size_t len = size * nmemb;
 
+	if (!cb_data->simple) {
+		/* The result is already known. Drain the reply so that the
+		 * connection can be reused by the next check. */
+		cb_data->msg_size += len;
+		return cb_data->msg_size <= DRAIN_MAX_SIZE ? len : 0;
+	}
+
 	cb_data->msg = g_realloc (cb_data->msg, cb_data->msg_size + len);
 	memcpy (cb_data->msg + cb_data->msg_size, buffer, len);
 	cb_data->msg_size += len;
@@ -304,7 +368,6 @@ easy_write_cb (void *buffer, size_t size, size_t nmemb, void *userdata)
 			        cb_data->response);
 			finish_cb_data (cb_data, NM_CONNECTIVITY_PORTAL);
 		}
-		return 0;
 	}
 
 	return len;
@@ -314,14 +377,13 @@ static gboolean
 timeout_cb (gpointer user_data)
 {
 	ConCheckCbData *cb_data = user_data;
-	NMConnectivity *self = NM_CONNECTIVITY (g_async_result_get_source_object (G_ASYNC_RESULT (cb_data->simple)));
-	NMConnectivityPrivate *priv = NM_CONNECTIVITY_GET_PRIVATE (self);
-	CURL *ehandle = cb_data->curl_ehandle;
 
-	_LOG2I ("timed out");
-	finish_cb_data (cb_data, NM_CONNECTIVITY_LIMITED);
-	curl_multi_remove_handle (priv->curl_mhandle, ehandle);
-	curl_easy_cleanup (ehandle);
+	cb_data->timeout_id = 0;
+	if (cb_data->simple) {
+		_LOG2I ("timed out");
+		finish_cb_data (cb_data, NM_CONNECTIVITY_LIMITED);
+	}
+	free_cb_data (cb_data);
 
 	return G_SOURCE_REMOVE;
 }
@@ -348,8 +410,8 @@ nm_connectivity_check_async (NMConnectivity      *self,
 	if (ehandle) {
 		ConCheckCbData *cb_data = g_slice_new0 (ConCheckCbData);
 
+		cb_data->self = self;
 		cb_data->curl_ehandle = ehandle;
-		cb_data->request_headers = curl_slist_append (NULL, "Connection: close");
 		cb_data->ifspec = g_strdup_printf ("if!%s", iface);
 		cb_data->simple = simple;
 		if (priv->response)
@@ -363,9 +425,11 @@ nm_connectivity_check_async (NMConnectivity      *self,
 		curl_easy_setopt (ehandle, CURLOPT_HEADERFUNCTION, easy_header_cb);
 		curl_easy_setopt (ehandle, CURLOPT_HEADERDATA, cb_data);
 		curl_easy_setopt (ehandle, CURLOPT_PRIVATE, cb_data);
-		curl_easy_setopt (ehandle, CURLOPT_HTTPHEADER, cb_data->request_headers);
 		curl_easy_setopt (ehandle, CURLOPT_INTERFACE, cb_data->ifspec);
+		if (priv->curl_shandle)
+			curl_easy_setopt (ehandle, CURLOPT_SHARE, priv->curl_shandle);
 		curl_multi_add_handle (priv->curl_mhandle, ehandle);
+		priv->checks = g_slist_prepend (priv->checks, cb_data);
 
 		cb_data->timeout_id = g_timeout_add_seconds (30, timeout_cb, cb_data);
 
@@ -400,8 +464,39 @@ nm_connectivity_check_finish (NMConnectivity  *self,
 static gboolean
 periodic_check (gpointer user_data)
 {
-	g_signal_emit (NM_CONNECTIVITY (user_data), signals[PERIODIC_CHECK], 0);
-	return G_SOURCE_CONTINUE;
+	NMConnectivity *self = NM_CONNECTIVITY (user_data);
+	NMConnectivityPrivate *priv = NM_CONNECTIVITY_GET_PRIVATE (self);
+	gboolean ret = G_SOURCE_CONTINUE;
+	guint next;
+
+	/* Back off exponentially while any check of the last round failed,
+	 * return to the configured interval as soon as all succeed. */
+	if (priv->periodic_check_failed)
+		next = MIN (priv->periodic_check_cur * 2, priv->interval);
+	else
+		next = priv->interval;
+	priv->periodic_check_failed = FALSE;
+
+	if (next != priv->periodic_check_cur) {
+		_LOGD ("next periodic check in %u seconds", next);
+		priv->periodic_check_id = 0;
+		periodic_check_schedule (self, next);
+		ret = G_SOURCE_REMOVE;
+	}
+
+	g_signal_emit (self, signals[PERIODIC_CHECK], 0);
+	return ret;
+}
+
+static void
+periodic_check_schedule (NMConnectivity *self, guint interval)
+{
+	NMConnectivityPrivate *priv = NM_CONNECTIVITY_GET_PRIVATE (self);
+
+	nm_clear_g_source (&priv->periodic_check_id);
+	priv->periodic_check_cur = interval;
+	if (interval)
+		priv->periodic_check_id = g_timeout_add_seconds (interval, periodic_check, self);
 }
 
 static void
@@ -456,8 +551,8 @@ update_config (NMConnectivity *self, NMConfigData *config_data)
 	}
 
 	if (changed) {
-		nm_clear_g_source (&priv->periodic_check_id);
-		priv->periodic_check_id = g_timeout_add_seconds (priv->interval, periodic_check, self);
+		priv->periodic_check_failed = FALSE;
+		periodic_check_schedule (self, priv->interval);
 	}
 }
 
@@ -468,7 +563,8 @@ config_changed_cb (NMConfig *config,
                    NMConfigData *old_data,
                    NMConnectivity *self)
 {
-	update_config (self, config_data);
+	if (NM_FLAGS_HAS (changes, NM_CONFIG_CHANGE_CONNECTIVITY))
+		update_config (self, config_data);
 }
 
 static void
@@ -498,6 +594,15 @@ nm_connectivity_init (NMConnectivity *self)
 	curl_multi_setopt (priv->curl_mhandle, CURLMOPT_TIMERFUNCTION, multi_timer_cb);
 	curl_multi_setopt (priv->curl_mhandle, CURLMOPT_TIMERDATA, self);
 	curl_multi_setopt (priv->curl_mhandle, CURLOPT_VERBOSE, 1);
+
+	/* Easy handles in the same multi handle already share the connection
+	 * pool and the DNS cache. Also share TLS sessions, so that a check
+	 * over HTTPS does not need a full handshake every time. */
+	priv->curl_shandle = curl_share_init ();
+	if (priv->curl_shandle) {
+		curl_share_setopt (priv->curl_shandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+		curl_share_setopt (priv->curl_shandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+	}
 }
 
 static void
@@ -514,7 +619,11 @@ dispose (GObject *object)
 		g_clear_object (&priv->config);
 	}
 
-	curl_multi_cleanup (priv->curl_mhandle);
+	while (priv->checks)
+		free_cb_data (priv->checks->data);
+
+	g_clear_pointer (&priv->curl_mhandle, curl_multi_cleanup);
+	g_clear_pointer (&priv->curl_shandle, curl_share_cleanup);
 	curl_global_cleanup ();
 	nm_clear_g_source (&priv->periodic_check_id);
 
@@ -1525,6 +1525,332 @@ nm_match_spec_device (const GSList *specs,
 	return match;
 }
 
+/*****************************************************************************/
+
+/* A list of device specs, parsed once for matching many devices. Exact
+ * interface names and MAC addresses are looked up in hash tables, all
+ * other specs are evaluated in order, as by nm_match_spec_device(). */
+
+typedef enum {
+	MATCH_ITEM_INTERFACE_NAME,
+	MATCH_ITEM_DEVICE_TYPE,
+	MATCH_ITEM_DRIVER,
+	MATCH_ITEM_S390_SUBCHANNELS,
+} MatchItemType;
+
+typedef struct {
+	MatchItemType type;
+	bool except;
+	const char *value;
+	/* for a driver with version, the length of the driver name */
+	gsize driver_len;
+	GPatternSpec *pattern;
+	guint32 a;
+	guint32 b;
+	guint32 c;
+} MatchItem;
+
+enum {
+	MATCH_FLAG_MATCH  = 1,
+	MATCH_FLAG_EXCEPT = 2,
+};
+
+struct _NMMatchSpecCompiled {
+	GSList *specs;
+	bool match_all;
+	bool except_all;
+	/* interface names and encoded MAC addresses to MATCH_FLAG_* */
+	GHashTable *names;
+	GHashTable *hwaddrs;
+	GArray *items;
+};
+
+/* encodes @bin like nm_utils_hwaddr_matches() compares them: only the
+ * last 8 bytes of an InfiniBand address are significant. */
+static char *
+_match_hwaddr_key (const guint8 *bin, gsize len)
+{
+	gs_free char *str = NULL;
+
+	if (len == INFINIBAND_ALEN) {
+		str = nm_utils_hwaddr_ntoa (&bin[INFINIBAND_ALEN - 8], 8);
+		return g_strdup_printf ("ib/%s", str);
+	}
+	return nm_utils_hwaddr_ntoa (bin, len);
+}
+
+static void
+_match_add_flag (GHashTable **table, char *key, bool except)
+{
+	guint flags;
+
+	if (!*table)
+		*table = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	flags = GPOINTER_TO_UINT (g_hash_table_lookup (*table, key));
+	flags |= except ? MATCH_FLAG_EXCEPT : MATCH_FLAG_MATCH;
+	g_hash_table_insert (*table, key, GUINT_TO_POINTER (flags));
+}
+
+static void
+_match_add_hwaddr (NMMatchSpecCompiled *compiled, const char *spec_str, bool except)
+{
+	guint8 bin[NM_UTILS_HWADDR_LEN_MAX];
+	gsize l;
+
+	/* an invalid address never matches */
+	if (_nm_utils_hwaddr_aton (spec_str, bin, sizeof (bin), &l))
+		_match_add_flag (&compiled->hwaddrs, _match_hwaddr_key (bin, l), except);
+}
+
+static void
+_match_add_item (NMMatchSpecCompiled *compiled, const MatchItem *item)
+{
+	if (!compiled->items)
+		compiled->items = g_array_new (FALSE, FALSE, sizeof (MatchItem));
+	g_array_append_vals (compiled->items, item, 1);
+}
+
+static void
+_match_compile_one (NMMatchSpecCompiled *compiled, const char *spec_str, bool except)
+{
+	MatchItem item = { .except = except };
+
+	if (spec_str[0] == '*' && spec_str[1] == '\0') {
+		if (except)
+			compiled->except_all = TRUE;
+		else
+			compiled->match_all = TRUE;
+		return;
+	}
+
+	if (_MATCH_CHECK (spec_str, DEVICE_TYPE_TAG)) {
+		item.type = MATCH_ITEM_DEVICE_TYPE;
+		item.value = spec_str;
+		_match_add_item (compiled, &item);
+		return;
+	}
+
+	if (_MATCH_CHECK (spec_str, MAC_TAG)) {
+		_match_add_hwaddr (compiled, spec_str, except);
+		return;
+	}
+
+	if (_MATCH_CHECK (spec_str, INTERFACE_NAME_TAG)) {
+		gboolean use_pattern = FALSE;
+
+		if (spec_str[0] == '=')
+			spec_str += 1;
+		else {
+			if (spec_str[0] == '~')
+				spec_str += 1;
+			use_pattern = TRUE;
+		}
+
+		if (use_pattern && strpbrk (spec_str, "*?")) {
+			item.type = MATCH_ITEM_INTERFACE_NAME;
+			item.value = spec_str;
+			item.pattern = g_pattern_spec_new (spec_str);
+			_match_add_item (compiled, &item);
+		} else
+			_match_add_flag (&compiled->names, g_strdup (spec_str), except);
+		return;
+	}
+
+	if (_MATCH_CHECK (spec_str, DRIVER_TAG)) {
+		const char *t = strrchr (spec_str, '/');
+
+		item.type = MATCH_ITEM_DRIVER;
+		item.value = spec_str;
+		if (t) {
+			item.driver_len = t - spec_str;
+			item.pattern = g_pattern_spec_new (&t[1]);
+		}
+		_match_add_item (compiled, &item);
+		return;
+	}
+
+	if (_MATCH_CHECK (spec_str, SUBCHAN_TAG)) {
+		if (match_device_s390_subchannels_parse (spec_str, &item.a, &item.b, &item.c)) {
+			item.type = MATCH_ITEM_S390_SUBCHANNELS;
+			_match_add_item (compiled, &item);
+		}
+		return;
+	}
+
+	/* without tag, a spec is either a MAC address or an interface
+	 * name. An "except:" spec without tag never matches. */
+	if (!except) {
+		_match_add_hwaddr (compiled, spec_str, FALSE);
+		_match_add_flag (&compiled->names, g_strdup (spec_str), FALSE);
+	}
+}
+
+/**
+ * nm_match_spec_compile:
+ * @specs: (element-type utf8): a list of device specs
+ *
+ * Returns: (transfer full): the parsed @specs for
+ *   nm_match_spec_compiled_match_device(), or %NULL if @specs
+ *   is empty. Free with nm_match_spec_compiled_free().
+ */
+NMMatchSpecCompiled *
+nm_match_spec_compile (const GSList *specs)
+{
+	NMMatchSpecCompiled *compiled;
+	const GSList *iter;
+
+	if (!specs)
+		return NULL;
+
+	compiled = g_slice_new0 (NMMatchSpecCompiled);
+	for (iter = specs; iter; iter = iter->next) {
+		if (iter->data)
+			compiled->specs = g_slist_prepend (compiled->specs, g_strdup (iter->data));
+	}
+	compiled->specs = g_slist_reverse (compiled->specs);
+
+	for (iter = compiled->specs; iter; iter = iter->next) {
+		const char *spec_str = iter->data;
+		gboolean except;
+
+		if (!*spec_str)
+			continue;
+		spec_str = match_except (spec_str, &except);
+		_match_compile_one (compiled, spec_str, except);
+	}
+	return compiled;
+}
+
+void
+nm_match_spec_compiled_free (NMMatchSpecCompiled *compiled)
+{
+	guint i;
+
+	if (!compiled)
+		return;
+
+	if (compiled->items) {
+		for (i = 0; i < compiled->items->len; i++) {
+			MatchItem *item = &g_array_index (compiled->items, MatchItem, i);
+
+			if (item->pattern)
+				g_pattern_spec_free (item->pattern);
+		}
+		g_array_unref (compiled->items);
+	}
+	if (compiled->names)
+		g_hash_table_unref (compiled->names);
+	if (compiled->hwaddrs)
+		g_hash_table_unref (compiled->hwaddrs);
+	g_slist_free_full (compiled->specs, g_free);
+	g_slice_free (NMMatchSpecCompiled, compiled);
+}
+
+static gboolean
+_match_item_eval (const MatchItem *item, MatchDeviceData *match_data)
+{
+	switch (item->type) {
+	case MATCH_ITEM_INTERFACE_NAME:
+		return    match_data->interface_name
+		       && g_pattern_match_string (item->pattern, match_data->interface_name);
+	case MATCH_ITEM_DEVICE_TYPE:
+		return    match_data->device_type
+		       && nm_streq (item->value, match_data->device_type);
+	case MATCH_ITEM_DRIVER:
+		if (!match_data->driver)
+			return FALSE;
+		if (!item->pattern)
+			return nm_streq (item->value, match_data->driver);
+		return    strncmp (item->value, match_data->driver, item->driver_len) == 0
+		       && g_pattern_match_string (item->pattern, match_data->driver_version ?: "");
+	case MATCH_ITEM_S390_SUBCHANNELS:
+		if (G_UNLIKELY (!match_data->s390_subchannels.is_parsed)) {
+			match_data->s390_subchannels.is_parsed = TRUE;
+			if (   !match_data->s390_subchannels.value
+			    || !match_device_s390_subchannels_parse (match_data->s390_subchannels.value,
+			                                             &match_data->s390_subchannels.a,
+			                                             &match_data->s390_subchannels.b,
+			                                             &match_data->s390_subchannels.c))
+				match_data->s390_subchannels.value = NULL;
+		}
+		return    match_data->s390_subchannels.value
+		       && match_data->s390_subchannels.a == item->a
+		       && match_data->s390_subchannels.b == item->b
+		       && match_data->s390_subchannels.c == item->c;
+	}
+	g_return_val_if_reached (FALSE);
+}
+
+/**
+ * nm_match_spec_compiled_match_device:
+ * @compiled: (allow-none): the specs from nm_match_spec_compile()
+ *
+ * Like nm_match_spec_device(), for specs that were parsed before.
+ *
+ * Returns: the same result as nm_match_spec_device() for the specs
+ *   that @compiled was created from.
+ */
+NMMatchSpecMatchType
+nm_match_spec_compiled_match_device (const NMMatchSpecCompiled *compiled,
+                                     const char *interface_name,
+                                     const char *device_type,
+                                     const char *driver,
+                                     const char *driver_version,
+                                     const char *hwaddr,
+                                     const char *s390_subchannels)
+{
+	MatchDeviceData match_data = {
+	    .interface_name = interface_name,
+	    .device_type = nm_str_not_empty (device_type),
+	    .driver = nm_str_not_empty (driver),
+	    .driver_version = nm_str_not_empty (driver_version),
+	    .s390_subchannels = {
+	        .value = s390_subchannels,
+	    },
+	};
+	gboolean match;
+	guint flags = 0;
+	guint i;
+
+	nm_assert (!hwaddr || nm_utils_hwaddr_valid (hwaddr, -1));
+
+	if (!compiled)
+		return NM_MATCH_SPEC_NO_MATCH;
+	if (compiled->except_all)
+		return NM_MATCH_SPEC_NEG_MATCH;
+
+	if (compiled->names && interface_name)
+		flags |= GPOINTER_TO_UINT (g_hash_table_lookup (compiled->names, interface_name));
+	if (compiled->hwaddrs && hwaddr) {
+		guint8 bin[NM_UTILS_HWADDR_LEN_MAX];
+		gs_free char *key = NULL;
+		gsize l;
+
+		if (_nm_utils_hwaddr_aton (hwaddr, bin, sizeof (bin), &l)) {
+			key = _match_hwaddr_key (bin, l);
+			flags |= GPOINTER_TO_UINT (g_hash_table_lookup (compiled->hwaddrs, key));
+		}
+	}
+	if (flags & MATCH_FLAG_EXCEPT)
+		return NM_MATCH_SPEC_NEG_MATCH;
+
+	match = compiled->match_all || (flags & MATCH_FLAG_MATCH);
+
+	for (i = 0; compiled->items && i < compiled->items->len; i++) {
+		const MatchItem *item = &g_array_index (compiled->items, MatchItem, i);
+
+		if (!item->except && match)
+			continue;
+		if (!_match_item_eval (item, &match_data))
+			continue;
+		if (item->except)
+			return NM_MATCH_SPEC_NEG_MATCH;
+		match = TRUE;
+	}
+
+	return match ? NM_MATCH_SPEC_MATCH : NM_MATCH_SPEC_NO_MATCH;
+}
+
 static gboolean
 match_config_eval (const char *str, const char *tag, guint cur_nm_version)
 {
@@ -2277,130 +2603,47 @@ typedef struct
 	GHashTable *setting_diff;
 } LogConnectionSettingData;
 
-typedef struct
-{
-	const char *item_name;
-	NMSettingDiffResult diff_result;
-} LogConnectionSettingItem;
-
-static gint
-_log_connection_sort_hashes_fcn (gconstpointer a, gconstpointer b)
-{
-	const LogConnectionSettingData *v1 = a;
-	const LogConnectionSettingData *v2 = b;
-	guint32 p1, p2;
-	NMSetting *s1, *s2;
-
-	s1 = v1->setting ? v1->setting : v1->diff_base_setting;
-	s2 = v2->setting ? v2->setting : v2->diff_base_setting;
-
-	g_assert (s1 && s2);
-
-	p1 = _nm_setting_get_setting_priority (s1);
-	p2 = _nm_setting_get_setting_priority (s2);
-
-	if (p1 != p2)
-		return p1 > p2 ? 1 : -1;
-
-	return strcmp (v1->name, v2->name);
-}
-
-static GArray *
-_log_connection_sort_hashes (NMConnection *connection, NMConnection *diff_base, GHashTable *connection_diff)
-{
-	GHashTableIter iter;
-	GArray *sorted_hashes;
-	LogConnectionSettingData setting_data;
-
-	sorted_hashes = g_array_sized_new (TRUE, FALSE, sizeof (LogConnectionSettingData), g_hash_table_size (connection_diff));
-
-	g_hash_table_iter_init (&iter, connection_diff);
-	while (g_hash_table_iter_next (&iter, (gpointer) &setting_data.name, (gpointer) &setting_data.setting_diff)) {
-		setting_data.setting = nm_connection_get_setting_by_name (connection, setting_data.name);
-		setting_data.diff_base_setting = diff_base ? nm_connection_get_setting_by_name (diff_base, setting_data.name) : NULL;
-		g_assert (setting_data.setting || setting_data.diff_base_setting);
-		g_array_append_val (sorted_hashes, setting_data);
-	}
-
-	g_array_sort (sorted_hashes, _log_connection_sort_hashes_fcn);
-	return sorted_hashes;
-}
-
-static gint
-_log_connection_sort_names_fcn (gconstpointer a, gconstpointer b)
-{
-	const LogConnectionSettingItem *v1 = a;
-	const LogConnectionSettingItem *v2 = b;
-
-	/* we want to first show the items, that disappeared, then the one that changed and
-	 * then the ones that were added. */
-
-	if ((v1->diff_result & NM_SETTING_DIFF_RESULT_IN_A) != (v2->diff_result & NM_SETTING_DIFF_RESULT_IN_A))
-		return (v1->diff_result & NM_SETTING_DIFF_RESULT_IN_A) ? -1 : 1;
-	if ((v1->diff_result & NM_SETTING_DIFF_RESULT_IN_B) != (v2->diff_result & NM_SETTING_DIFF_RESULT_IN_B))
-		return (v1->diff_result & NM_SETTING_DIFF_RESULT_IN_B) ? 1 : -1;
-	return strcmp (v1->item_name, v2->item_name);
-}
-
-static char *
-_log_connection_get_property (NMSetting *setting, const char *name)
+static void
+_log_connection_append_property (GString *str, NMSetting *setting, const char *name)
 {
 	GValue val = G_VALUE_INIT;
-	char *s;
+	char *escaped;
 
-	g_return_val_if_fail (setting, NULL);
+	g_return_if_fail (setting);
 
 	if (   !NM_IS_SETTING_VPN (setting)
-	    && nm_setting_get_secret_flags (setting, name, NULL, NULL))
-		return g_strdup ("****");
+	    && nm_setting_get_secret_flags (setting, name, NULL, NULL)) {
+		g_string_append (str, "****");
+		return;
+	}
 
 	if (!_nm_setting_get_property (setting, name, &val))
-		g_return_val_if_reached (FALSE);
+		g_return_if_reached ();
 
 	if (G_VALUE_HOLDS_STRING (&val)) {
 		const char *val_s;
 
 		val_s = g_value_get_string (&val);
 		if (!val_s) {
-			/* for NULL, we want to return the unquoted string "NULL". */
-			s = g_strdup ("NULL");
+			/* for NULL, we want to print the unquoted string "NULL". */
+			g_string_append (str, "NULL");
 		} else {
-			char *escaped = g_strescape (val_s, "'");
-
-			s = g_strdup_printf ("'%s'", escaped);
+			escaped = g_strescape (val_s, "'");
+			g_string_append_printf (str, "'%s'", escaped);
 			g_free (escaped);
 		}
 	} else {
-		s = g_strdup_value_contents (&val);
-		if (s == NULL)
-			s = g_strdup ("NULL");
-		else {
-			char *escaped = g_strescape (s, "'");
+		gs_free char *contents = g_strdup_value_contents (&val);
 
-			g_free (s);
-			s = escaped;
+		if (!contents)
+			g_string_append (str, "NULL");
+		else {
+			escaped = g_strescape (contents, "'");
+			g_string_append (str, escaped);
+			g_free (escaped);
 		}
 	}
-	g_value_unset(&val);
-	return s;
-}
-
-static void
-_log_connection_sort_names (LogConnectionSettingData *setting_data, GArray *sorted_names)
-{
-	GHashTableIter iter;
-	LogConnectionSettingItem item;
-	gpointer p;
-
-	g_array_set_size (sorted_names, 0);
-
-	g_hash_table_iter_init (&iter, setting_data->setting_diff);
-	while (g_hash_table_iter_next (&iter, (gpointer) &item.item_name, &p)) {
-		item.diff_result = GPOINTER_TO_UINT (p);
-		g_array_append_val (sorted_names, item);
-	}
-
-	g_array_sort (sorted_names, _log_connection_sort_names_fcn);
+	g_value_unset (&val);
 }
 
 void
@@ -2408,12 +2651,11 @@ nm_utils_log_connection_diff (NMConnection *connection, NMConnection *diff_base,
 {
 	GHashTable *connection_diff = NULL;
 	GArray *sorted_hashes;
-	GArray *sorted_names = NULL;
-	int i, j;
+	int i;
 	gboolean connection_diff_are_same;
 	gboolean print_header = TRUE;
 	gboolean print_setting_header;
-	GString *str1;
+	GString *str1, *str2;
 
 	g_return_if_fail (NM_IS_CONNECTION (connection));
 	g_return_if_fail (!diff_base || (NM_IS_CONNECTION (diff_base) && diff_base != connection));
@@ -2445,24 +2687,21 @@ nm_utils_log_connection_diff (NMConnection *connection, NMConnection *diff_base,
 	if (sorted_hashes->len <= 0)
 		goto out;
 
-	sorted_names = g_array_new (FALSE, FALSE, sizeof (LogConnectionSettingItem));
 	str1 = g_string_new (NULL);
+	str2 = g_string_new (NULL);
 
 	for (i = 0; i < sorted_hashes->len; i++) {
 		LogConnectionSettingData *setting_data = &g_array_index (sorted_hashes, LogConnectionSettingData, i);
+		GHashTableIter iter;
+		const char *item_name;
+		gpointer p;
 
-		_log_connection_sort_names (setting_data, sorted_names);
+		/* the properties are printed in the order of the diff result as is: sorting
+		 * them costs more than it is worth when debug-logging bulk imports. */
 		print_setting_header = TRUE;
-		for (j = 0; j < sorted_names->len; j++) {
-			char *str_conn, *str_diff;
-			LogConnectionSettingItem *item = &g_array_index (sorted_names, LogConnectionSettingItem, j);
-
-			str_conn = (item->diff_result & NM_SETTING_DIFF_RESULT_IN_A)
-			           ? _log_connection_get_property (setting_data->setting, item->item_name)
-			           : NULL;
-			str_diff = (item->diff_result & NM_SETTING_DIFF_RESULT_IN_B)
-			           ? _log_connection_get_property (setting_data->diff_base_setting, item->item_name)
-			           : NULL;
+		g_hash_table_iter_init (&iter, setting_data->setting_diff);
+		while (g_hash_table_iter_next (&iter, (gpointer) &item_name, &p)) {
+			NMSettingDiffResult diff_result = GPOINTER_TO_UINT (p);
 
 			if (print_header) {
 				GError *err_verify = NULL;
@@ -2496,25 +2735,30 @@ nm_utils_log_connection_diff (NMConnection *connection, NMConnection *diff_base,
 					nm_log (level, domain, NULL, NULL, "%s%"_NM_LOG_ALIGN"s [ %p ]", prefix, setting_data->name, setting_data->setting);
 				print_setting_header = FALSE;
 			}
-			g_string_printf (str1, "%s.%s", setting_data->name, item->item_name);
-			switch (item->diff_result & (NM_SETTING_DIFF_RESULT_IN_A | NM_SETTING_DIFF_RESULT_IN_B)) {
-				case NM_SETTING_DIFF_RESULT_IN_B:
-					nm_log (level, domain, NULL, NULL, "%s%"_NM_LOG_ALIGN"s < %s", prefix, str1->str, str_diff ? str_diff : "NULL");
-					break;
-				case NM_SETTING_DIFF_RESULT_IN_A:
-					nm_log (level, domain, NULL, NULL, "%s%"_NM_LOG_ALIGN"s = %s", prefix, str1->str, str_conn ? str_conn : "NULL");
-					break;
-				default:
-					nm_log (level, domain, NULL, NULL, "%s%"_NM_LOG_ALIGN"s = %s < %s", prefix, str1->str, str_conn ? str_conn : "NULL", str_diff ? str_diff : "NULL");
-					break;
-#undef _NM_LOG_ALIGN
+			g_string_printf (str1, "%s.%s", setting_data->name, item_name);
+			g_string_truncate (str2, 0);
+			switch (diff_result & (NM_SETTING_DIFF_RESULT_IN_A | NM_SETTING_DIFF_RESULT_IN_B)) {
+			case NM_SETTING_DIFF_RESULT_IN_B:
+				g_string_append (str2, "< ");
+				_log_connection_append_property (str2, setting_data->diff_base_setting, item_name);
+				break;
+			case NM_SETTING_DIFF_RESULT_IN_A:
+				g_string_append (str2, "= ");
+				_log_connection_append_property (str2, setting_data->setting, item_name);
+				break;
+			default:
+				g_string_append (str2, "= ");
+				_log_connection_append_property (str2, setting_data->setting, item_name);
+				g_string_append (str2, " < ");
+				_log_connection_append_property (str2, setting_data->diff_base_setting, item_name);
+				break;
 			}
-			g_free (str_conn);
-			g_free (str_diff);
+			nm_log (level, domain, NULL, NULL, "%s%"_NM_LOG_ALIGN"s %s", prefix, str1->str, str2->str);
+#undef _NM_LOG_ALIGN
 		}
 	}
 
-	g_array_free (sorted_names, TRUE);
+	g_string_free (str2, TRUE);
 	g_string_free (str1, TRUE);
 out:
 	g_hash_table_destroy (connection_diff);
@@ -4157,13 +4401,20 @@ nm_utils_get_reverse_dns_domains_ip6 (const struct in6_addr *ip, guint8 plen, GP
 /**
  * Copied from GLib's g_file_set_contents() et al., but allows
  * specifying a mode for the new file.
+ *
+ * Like GLib, the new file is synced before renaming it over a non-empty
+ * destination. With @always_fsync, it is also synced if there is no such
+ * destination, so that the data is on disk once this returns. The directory
+ * entry is not synced; queue that with nm_utils_file_sync_dir_queue(), or
+ * use nm_utils_file_set_contents_queue() instead.
  */
 gboolean
-nm_utils_file_set_contents (const gchar *filename,
-                            const gchar *contents,
-                            gssize length,
-                            mode_t mode,
-                            GError **error)
+nm_utils_file_set_contents_full (const gchar *filename,
+                                 const gchar *contents,
+                                 gssize length,
+                                 mode_t mode,
+                                 gboolean always_fsync,
+                                 GError **error)
 {
 	gs_free char *tmp_name = NULL;
 	struct stat statbuf;
@@ -4223,8 +4474,9 @@ nm_utils_file_set_contents (const gchar *filename,
 	 * the new and the old file on some filesystems. (I.E. those that don't
 	 * guarantee the data is written to the disk before the metadata.)
 	 */
-	if (   lstat (filename, &statbuf) == 0
-	    && statbuf.st_size > 0
+	if (   (   always_fsync
+	        || (   lstat (filename, &statbuf) == 0
+	            && statbuf.st_size > 0))
 	    && fsync (fd) != 0) {
 		errsv = errno;
 
@@ -4258,6 +4510,289 @@ nm_utils_file_set_contents (const gchar *filename,
 	return TRUE;
 }
 
+gboolean
+nm_utils_file_set_contents (const gchar *filename,
+                            const gchar *contents,
+                            gssize length,
+                            mode_t mode,
+                            GError **error)
+{
+	return nm_utils_file_set_contents_full (filename, contents, length, mode, FALSE, error);
+}
+
+/*****************************************************************************/
+
+typedef struct {
+	char *filename;
+	NMUtilsFileSyncCallback callback;
+	gpointer user_data;
+
+	/* the content to write first, if any. */
+	char *contents;
+	gsize length;
+	mode_t mode;
+	GError *error;
+
+	int errsv;
+} FileSyncData;
+
+static struct {
+	GMutex lock;
+	GCond cond;
+	GThread *thread;
+	GPtrArray *pending;
+} file_sync;
+
+static void
+_file_sync_data_free (gpointer data)
+{
+	FileSyncData *d = data;
+
+	g_free (d->filename);
+	g_free (d->contents);
+	g_clear_error (&d->error);
+	g_slice_free (FileSyncData, d);
+}
+
+static int
+_file_sync_dir (const char *path)
+{
+	int fd;
+	int errsv = 0;
+
+	fd = open (path, O_DIRECTORY | O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return errno;
+	if (fsync (fd) != 0)
+		errsv = errno;
+	close (fd);
+	return errsv;
+}
+
+static gboolean
+_file_sync_complete_cb (gpointer user_data)
+{
+	gs_unref_ptrarray GPtrArray *batch = user_data;
+	guint i;
+
+	for (i = 0; i < batch->len; i++) {
+		FileSyncData *d = batch->pdata[i];
+		gs_free_error GError *error = NULL;
+
+		if (!d->callback)
+			continue;
+
+		if (d->error)
+			error = g_steal_pointer (&d->error);
+		else if (d->errsv) {
+			g_set_error (&error,
+			             G_FILE_ERROR,
+			             g_file_error_from_errno (d->errsv),
+			             "failed to fsync the directory of %s: %s",
+			             d->filename,
+			             g_strerror (d->errsv));
+		}
+		d->callback (d->filename, error, d->user_data);
+	}
+	return G_SOURCE_REMOVE;
+}
+
+static gpointer
+_file_sync_thread (gpointer unused)
+{
+	while (TRUE) {
+		GPtrArray *batch;
+		gs_unref_hashtable GHashTable *dirs = NULL;
+		gpointer errsv_p;
+		guint i;
+
+		g_mutex_lock (&file_sync.lock);
+		while (!file_sync.pending)
+			g_cond_wait (&file_sync.cond, &file_sync.lock);
+		batch = g_steal_pointer (&file_sync.pending);
+		g_mutex_unlock (&file_sync.lock);
+
+		/* write the files in the order they were queued, then sync
+		 * each directory only once per batch. */
+		dirs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+		for (i = 0; i < batch->len; i++) {
+			FileSyncData *d = batch->pdata[i];
+			char *dirname;
+
+			if (   d->contents
+			    && !nm_utils_file_set_contents_full (d->filename, d->contents, d->length,
+			                                         d->mode, TRUE, &d->error))
+				continue;
+
+			dirname = g_path_get_dirname (d->filename);
+
+			if (g_hash_table_lookup_extended (dirs, dirname, NULL, &errsv_p)) {
+				g_free (dirname);
+				d->errsv = GPOINTER_TO_INT (errsv_p);
+				continue;
+			}
+			d->errsv = _file_sync_dir (dirname);
+			g_hash_table_insert (dirs, dirname, GINT_TO_POINTER (d->errsv));
+		}
+
+		g_idle_add (_file_sync_complete_cb, batch);
+	}
+	return NULL;
+}
+
+static void
+_file_sync_queue (FileSyncData *d)
+{
+	g_mutex_lock (&file_sync.lock);
+	if (!file_sync.thread)
+		file_sync.thread = g_thread_new ("nm-file-sync", _file_sync_thread, NULL);
+	if (!file_sync.pending)
+		file_sync.pending = g_ptr_array_new_with_free_func (_file_sync_data_free);
+	g_ptr_array_add (file_sync.pending, d);
+	g_cond_signal (&file_sync.cond);
+	g_mutex_unlock (&file_sync.lock);
+}
+
+/**
+ * nm_utils_file_sync_dir_queue:
+ * @filename: a file written with nm_utils_file_set_contents_full() and
+ *   @always_fsync
+ * @callback: (allow-none): invoked on the main context once the directory
+ *   of @filename is synced to disk.
+ * @user_data: user data for @callback
+ *
+ * The content of @filename is already on disk, but its directory entry is
+ * not until the directory is synced. Queue that to a worker thread. The
+ * directories of all files queued while the worker is busy are synced
+ * together, each only once. This keeps the blocking fsync() of the
+ * directory off the main loop when several profiles are written in a row.
+ */
+void
+nm_utils_file_sync_dir_queue (const char *filename,
+                              NMUtilsFileSyncCallback callback,
+                              gpointer user_data)
+{
+	FileSyncData *d;
+
+	g_return_if_fail (filename && filename[0] == '/');
+
+	d = g_slice_new0 (FileSyncData);
+	d->filename = g_strdup (filename);
+	d->callback = callback;
+	d->user_data = user_data;
+	_file_sync_queue (d);
+}
+
+/**
+ * nm_utils_file_set_contents_queue:
+ * @filename: the file to write
+ * @contents: the new content of @filename, copied
+ * @length: the length of @contents, or -1 if it is NUL terminated
+ * @mode: the mode of the new file
+ * @callback: (allow-none): invoked on the main context once the file and
+ *   its directory are synced to disk, or writing failed.
+ * @user_data: user data for @callback
+ *
+ * Like nm_utils_file_set_contents_full() with @always_fsync followed by
+ * nm_utils_file_sync_dir_queue(), but writing, syncing and renaming the
+ * file happens on the worker thread, too. Files queued one after another
+ * are written in that order.
+ */
+void
+nm_utils_file_set_contents_queue (const char *filename,
+                                  const char *contents,
+                                  gssize length,
+                                  mode_t mode,
+                                  NMUtilsFileSyncCallback callback,
+                                  gpointer user_data)
+{
+	FileSyncData *d;
+
+	g_return_if_fail (filename && filename[0] == '/');
+	g_return_if_fail (contents || length <= 0);
+
+	if (length < 0)
+		length = strlen (contents);
+
+	d = g_slice_new0 (FileSyncData);
+	d->filename = g_strdup (filename);
+	d->callback = callback;
+	d->user_data = user_data;
+	/* an empty file is written too, so never leave @contents NULL. */
+	d->contents = g_malloc (length + 1);
+	if (length)
+		memcpy (d->contents, contents, length);
+	d->length = length;
+	d->mode = mode;
+	_file_sync_queue (d);
+}
+
+/*****************************************************************************/
+
+typedef struct {
+	NMUtilsParallelFunc func;
+	gpointer user_data;
+} ParallelData;
+
+static void
+_run_parallel_cb (gpointer data, gpointer user_data)
+{
+	const ParallelData *p = user_data;
+
+	p->func (GPOINTER_TO_UINT (data) - 1, p->user_data);
+}
+
+/**
+ * nm_utils_run_parallel:
+ * @n_items: the number of items
+ * @func: invoked once for each index below @n_items
+ * @user_data: user data for @func
+ *
+ * Invokes @func for all items on a pool of worker threads, one per
+ * processor, and blocks until all are done. The order in which the
+ * items are processed is undefined, so @func should only store its
+ * result by the index. It must be safe to call from any thread and
+ * must not touch the main context.
+ */
+void
+nm_utils_run_parallel (guint n_items,
+                       NMUtilsParallelFunc func,
+                       gpointer user_data)
+{
+	ParallelData data = {
+		.func = func,
+		.user_data = user_data,
+	};
+	GThreadPool *pool;
+	guint n_threads;
+	guint i;
+
+	g_return_if_fail (func);
+
+	n_threads = MIN (g_get_num_processors (), n_items);
+	if (n_threads <= 1) {
+		for (i = 0; i < n_items; i++)
+			func (i, user_data);
+		return;
+	}
+
+	pool = g_thread_pool_new (_run_parallel_cb, &data, n_threads, TRUE, NULL);
+	if (!pool) {
+		for (i = 0; i < n_items; i++)
+			func (i, user_data);
+		return;
+	}
+
+	/* pass the index shifted by one, because the pool rejects NULL. */
+	for (i = 0; i < n_items; i++)
+		g_thread_pool_push (pool, GUINT_TO_POINTER (i + 1), NULL);
+
+	/* waits until all items are processed. */
+	g_thread_pool_free (pool, FALSE, TRUE);
+}
+
+/*****************************************************************************/
+
 struct plugin_info {
 	char *path;
 	struct stat st;
@@ -4418,3 +4953,112 @@ NM_UTILS_LOOKUP_STR_DEFINE (nm_activation_type_to_string, NMActivationType,
 	NM_UTILS_LOOKUP_STR_ITEM (NM_ACTIVATION_TYPE_ASSUME,   "assume"),
 	NM_UTILS_LOOKUP_STR_ITEM (NM_ACTIVATION_TYPE_EXTERNAL, "external"),
 )
+
+/*****************************************************************************/
+
+typedef struct {
+	const char *label;
+	gint64 timestamp_ns;
+} StartupTraceEntry;
+
+static struct {
+	GArray *entries;
+	bool finished;
+} startup_trace;
+
+/**
+ * nm_utils_startup_trace_add:
+ * @label: a static string naming the startup milestone
+ *
+ * Records the current monotonic timestamp for @label. Only the first
+ * occurrence of each label is recorded, and nothing is recorded anymore
+ * once nm_utils_startup_trace_finish() was called.
+ */
+void
+nm_utils_startup_trace_add (const char *label)
+{
+	StartupTraceEntry *entry;
+	guint i;
+
+	g_return_if_fail (label);
+
+	if (startup_trace.finished)
+		return;
+
+	if (!startup_trace.entries)
+		startup_trace.entries = g_array_new (FALSE, FALSE, sizeof (StartupTraceEntry));
+	else {
+		for (i = 0; i < startup_trace.entries->len; i++) {
+			if (nm_streq (g_array_index (startup_trace.entries, StartupTraceEntry, i).label, label))
+				return;
+		}
+	}
+
+	g_array_set_size (startup_trace.entries, startup_trace.entries->len + 1);
+	entry = &g_array_index (startup_trace.entries, StartupTraceEntry, startup_trace.entries->len - 1);
+	entry->label = label;
+	entry->timestamp_ns = nm_utils_get_monotonic_timestamp_ns ();
+}
+
+/**
+ * nm_utils_startup_trace_finish:
+ *
+ * Records the final "startup-complete" milestone, stops recording
+ * and logs the timeline. Later calls are ignored.
+ */
+void
+nm_utils_startup_trace_finish (void)
+{
+	nm_auto_free_gstring GString *str = NULL;
+	const StartupTraceEntry *entry;
+	gint64 start_ns, prev_ns;
+	guint i;
+
+	if (startup_trace.finished)
+		return;
+
+	nm_utils_startup_trace_add ("startup-complete");
+	startup_trace.finished = TRUE;
+
+	str = g_string_new (NULL);
+	start_ns = g_array_index (startup_trace.entries, StartupTraceEntry, 0).timestamp_ns;
+	prev_ns = start_ns;
+	for (i = 0; i < startup_trace.entries->len; i++) {
+		entry = &g_array_index (startup_trace.entries, StartupTraceEntry, i);
+		g_string_append_printf (str, "%s%s=%"G_GINT64_FORMAT"ms (+%"G_GINT64_FORMAT"ms)",
+		                        i ? ", " : "",
+		                        entry->label,
+		                        (entry->timestamp_ns - start_ns) / NM_UTILS_NS_PER_MSEC,
+		                        (entry->timestamp_ns - prev_ns) / NM_UTILS_NS_PER_MSEC);
+		prev_ns = entry->timestamp_ns;
+	}
+	nm_log_info (LOGD_CORE, "startup timeline: %s", str->str);
+}
+
+/**
+ * nm_utils_startup_trace_to_variant:
+ *
+ * Returns: (transfer floating): a variant of type "a(st)" with the
+ *   recorded milestones and their offset in microseconds relative to
+ *   the first one.
+ */
+GVariant *
+nm_utils_startup_trace_to_variant (void)
+{
+	GVariantBuilder builder;
+	const StartupTraceEntry *entry;
+	gint64 start_ns;
+	guint i;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(st)"));
+	if (startup_trace.entries && startup_trace.entries->len) {
+		start_ns = g_array_index (startup_trace.entries, StartupTraceEntry, 0).timestamp_ns;
+		for (i = 0; i < startup_trace.entries->len; i++) {
+			entry = &g_array_index (startup_trace.entries, StartupTraceEntry, i);
+			g_variant_builder_add (&builder, "(st)",
+			                       entry->label,
+			                       (guint64) ((entry->timestamp_ns - start_ns) / 1000));
+		}
+	}
+	return g_variant_builder_end (&builder);
+}
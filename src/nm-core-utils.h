@@ -149,6 +149,18 @@ NMMatchSpecMatchType nm_match_spec_device (const GSList *specs,
                                            const char *device_type,
                                            const char *hwaddr,
                                            const char *s390_subchannels);
+typedef struct _NMMatchSpecCompiled NMMatchSpecCompiled;
+
+NMMatchSpecCompiled *nm_match_spec_compile (const GSList *specs);
+void nm_match_spec_compiled_free (NMMatchSpecCompiled *compiled);
+NMMatchSpecMatchType nm_match_spec_compiled_match_device (const NMMatchSpecCompiled *compiled,
+                                                          const char *interface_name,
+                                                          const char *device_type,
+                                                          const char *driver,
+                                                          const char *driver_version,
+                                                          const char *hwaddr,
+                                                          const char *s390_subchannels);
+
 NMMatchSpecMatchType nm_match_spec_config (const GSList *specs,
                                            guint nm_version,
                                            const char *env);
@@ -319,6 +331,33 @@ gboolean nm_utils_file_set_contents (const gchar *filename,
                                      gssize length,
                                      mode_t mode,
                                      GError **error);
+gboolean nm_utils_file_set_contents_full (const gchar *filename,
+                                          const gchar *contents,
+                                          gssize length,
+                                          mode_t mode,
+                                          gboolean always_fsync,
+                                          GError **error);
+
+typedef void (*NMUtilsFileSyncCallback) (const char *filename,
+                                         GError *error,
+                                         gpointer user_data);
+
+void nm_utils_file_sync_dir_queue (const char *filename,
+                                   NMUtilsFileSyncCallback callback,
+                                   gpointer user_data);
+
+void nm_utils_file_set_contents_queue (const char *filename,
+                                       const char *contents,
+                                       gssize length,
+                                       mode_t mode,
+                                       NMUtilsFileSyncCallback callback,
+                                       gpointer user_data);
+
+typedef void (*NMUtilsParallelFunc) (guint idx, gpointer user_data);
+
+void nm_utils_run_parallel (guint n_items,
+                            NMUtilsParallelFunc func,
+                            gpointer user_data);
 
 int nm_utils_read_urandom (void *p, size_t n);
 
@@ -482,4 +521,10 @@ const char *nm_activation_type_to_string (NMActivationType activation_type);
 
 /*****************************************************************************/
 
+void nm_utils_startup_trace_add (const char *label);
+void nm_utils_startup_trace_finish (void);
+GVariant *nm_utils_startup_trace_to_variant (void);
+
+/*****************************************************************************/
+
 #endif /* __NM_CORE_UTILS_H__ */
@@ -93,22 +93,25 @@ _dcb_enable (const char *iface,
 		return do_helper (iface, DCBTOOL, run_func, user_data, error, "dcb off");
 }
 
-#define SET_FLAGS(f, tag) \
-G_STMT_START { \
-	if (!do_helper (iface, DCBTOOL, run_func, user_data, error, tag " e:%c a:%c w:%c", \
-	                 f & NM_SETTING_DCB_FLAG_ENABLE ? '1' : '0', \
-	                 f & NM_SETTING_DCB_FLAG_ADVERTISE ? '1' : '0', \
-	                 f & NM_SETTING_DCB_FLAG_WILLING ? '1' : '0')) \
-		return FALSE; \
-} G_STMT_END
-
+#define FLAGS_FMT " e:%c a:%c w:%c"
+#define FLAGS_ARGS(f) \
+	(f) & NM_SETTING_DCB_FLAG_ENABLE ? '1' : '0', \
+	(f) & NM_SETTING_DCB_FLAG_ADVERTISE ? '1' : '0', \
+	(f) & NM_SETTING_DCB_FLAG_WILLING ? '1' : '0'
+
+/* dcbtool accepts the flags and the feature configuration in one command,
+ * so set both at once instead of spawning dcbtool twice. */
 #define SET_APP(f, s, tag) \
 G_STMT_START { \
 	gint prio = nm_setting_dcb_get_app_##tag##_priority (s); \
  \
-	SET_FLAGS (f, "app:" #tag); \
 	if ((f & NM_SETTING_DCB_FLAG_ENABLE) && (prio >= 0)) { \
-		if (!do_helper (iface, DCBTOOL, run_func, user_data, error, "app:" #tag " appcfg:%02x", (1 << prio))) \
+		if (!do_helper (iface, DCBTOOL, run_func, user_data, error, "app:" #tag FLAGS_FMT " appcfg:%02x", \
+		                FLAGS_ARGS (f), (1 << prio))) \
+			return FALSE; \
+	} else { \
+		if (!do_helper (iface, DCBTOOL, run_func, user_data, error, "app:" #tag FLAGS_FMT, \
+		                FLAGS_ARGS (f))) \
 			return FALSE; \
 	} \
 } G_STMT_END
@@ -139,14 +142,18 @@ _dcb_setup (const char *iface,
 
 	/* Priority Flow Control */
 	flags = nm_setting_dcb_get_priority_flow_control_flags (s_dcb);
-	SET_FLAGS (flags, "pfc");
 	if (flags & NM_SETTING_DCB_FLAG_ENABLE) {
 		char buf[10];
 
 		for (i = 0; i < 8; i++)
 			buf[i] = nm_setting_dcb_get_priority_flow_control (s_dcb, i) ? '1' : '0';
 		buf[i] = 0;
-		if (!do_helper (iface, DCBTOOL, run_func, user_data, error, "pfc pfcup:%s", buf))
+		if (!do_helper (iface, DCBTOOL, run_func, user_data, error, "pfc" FLAGS_FMT " pfcup:%s",
+		                FLAGS_ARGS (flags), buf))
+			return FALSE;
+	} else {
+		if (!do_helper (iface, DCBTOOL, run_func, user_data, error, "pfc" FLAGS_FMT,
+		                FLAGS_ARGS (flags)))
 			return FALSE;
 	}
 
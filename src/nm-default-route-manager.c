@@ -50,6 +50,12 @@ typedef struct {
 		gboolean has_v6_changes;
 	} resync;
 
+	/* the IPv4 multipath default route that we added, if any. */
+	struct {
+		guint32 metric;
+		GArray *nexthops;
+	} ecmp4;
+
 	/* During disposing, we unref the sources of all entries. This happens usually
 	 * during shutdown, which might call the final deletion of the object. That
 	 * again might cause calls back into NMDefaultRouteManager, which finds dangling
@@ -184,6 +190,16 @@ typedef struct {
 	gboolean never_default;
 
 	guint32 effective_metric;
+
+	/* the weight of the entry in a multipath default route, or zero
+	 * if the entry always gets a default route of its own. Only
+	 * supported for IPv4 device sources. */
+	guint32 weight;
+
+	/* whether the entry is currently a nexthop of the multipath
+	 * default route, instead of having a default route of its own.
+	 * Set by _resync_all(). */
+	gboolean ecmp;
 } Entry;
 
 typedef struct {
@@ -259,6 +275,43 @@ _entry_find_by_source (GPtrArray *entries, gpointer source, guint *out_idx)
 	return NULL;
 }
 
+static GHashTable *
+_get_synced_ifindexes (GPtrArray *entries)
+{
+	GHashTable *result;
+	guint i;
+
+	/* the ifindexes that have at least one synced entry. Those are managed
+	 * by us, all others are assumed. Collect them once, instead of searching
+	 * the entries for every route and every entry. */
+	result = g_hash_table_new (NULL, NULL);
+	for (i = 0; i < entries->len; i++) {
+		const Entry *e = g_ptr_array_index (entries, i);
+
+		if (e->synced)
+			g_hash_table_add (result, GINT_TO_POINTER (e->route.rx.ifindex));
+	}
+	return result;
+}
+
+static guint
+_entry_ifindex_metric_hash (gconstpointer ptr)
+{
+	const Entry *e = ptr;
+
+	return ((guint) e->route.rx.ifindex) * 1103515245u + e->effective_metric;
+}
+
+static gboolean
+_entry_ifindex_metric_equal (gconstpointer a, gconstpointer b)
+{
+	const Entry *e_a = a;
+	const Entry *e_b = b;
+
+	return    e_a->route.rx.ifindex == e_b->route.rx.ifindex
+	       && e_a->effective_metric == e_b->effective_metric;
+}
+
 static gboolean
 _platform_route_sync_add (const VTableIP *vtable, NMDefaultRouteManager *self, guint32 metric)
 {
@@ -275,7 +328,7 @@ _platform_route_sync_add (const VTableIP *vtable, NMDefaultRouteManager *self, g
 	for (i = 0; i < entries->len; i++) {
 		Entry *e = g_ptr_array_index (entries, i);
 
-		if (e->never_default)
+		if (e->never_default || e->ecmp)
 			continue;
 
 		if (e->effective_metric != metric)
@@ -325,37 +378,40 @@ _platform_route_sync_add (const VTableIP *vtable, NMDefaultRouteManager *self, g
 }
 
 static gboolean
-_platform_route_sync_flush (const VTableIP *vtable, NMDefaultRouteManager *self, int ifindex_to_flush)
+_platform_route_sync_flush (const VTableIP *vtable, NMDefaultRouteManager *self, GHashTable *synced_ifindexes, int ifindex_to_flush)
 {
 	NMDefaultRouteManagerPrivate *priv = NM_DEFAULT_ROUTE_MANAGER_GET_PRIVATE (self);
 	GPtrArray *entries = vtable->get_entries (priv);
+	GHashTable *synced_entries;
 	GArray *routes;
-	guint i, j;
+	guint i;
 	gboolean changed = FALSE;
 
+	/* the synced entries that have a default route, by ifindex and effective metric. */
+	synced_entries = g_hash_table_new (_entry_ifindex_metric_hash, _entry_ifindex_metric_equal);
+	for (i = 0; i < entries->len; i++) {
+		Entry *e = g_ptr_array_index (entries, i);
+
+		if (e->synced && !e->never_default && !e->ecmp)
+			g_hash_table_add (synced_entries, e);
+	}
+
 	/* prune all other default routes from this device. */
 	routes = vtable->vt->route_get_all (priv->platform, 0, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT);
 
 	for (i = 0; i < routes->len; i++) {
 		const NMPlatformIPRoute *route;
-		gboolean has_ifindex_synced = FALSE;
-		Entry *entry = NULL;
+		gboolean has_ifindex_synced;
+		Entry *entry;
+		Entry needle;
 
 		route = _vt_route_index (vtable, routes, i);
 
-		/* look at all entries and see if the route for this ifindex pair is
-		 * a known entry. */
-		for (j = 0; j < entries->len; j++) {
-			Entry *e = g_ptr_array_index (entries, j);
-
-			if (   e->route.rx.ifindex == route->ifindex
-			    && e->synced) {
-				has_ifindex_synced = TRUE;
-				if (   !e->never_default
-				    && e->effective_metric == route->metric)
-					entry = e;
-			}
-		}
+		/* see if the route for this ifindex pair is a known entry. */
+		has_ifindex_synced = g_hash_table_contains (synced_ifindexes, GINT_TO_POINTER (route->ifindex));
+		needle.route.rx.ifindex = route->ifindex;
+		needle.effective_metric = route->metric;
+		entry = has_ifindex_synced ? g_hash_table_lookup (synced_entries, &needle) : NULL;
 
 		/* we only delete the route if we don't have a matching entry,
 		 * and there is at least one entry that references this ifindex
@@ -371,6 +427,7 @@ _platform_route_sync_flush (const VTableIP *vtable, NMDefaultRouteManager *self,
 		}
 	}
 	g_array_free (routes, TRUE);
+	g_hash_table_unref (synced_entries);
 	return changed;
 }
 
@@ -416,12 +473,57 @@ _sort_entries_cmp (gconstpointer a, gconstpointer b, gpointer user_data)
 	return 0;
 }
 
+static void
+_entries_reposition (GPtrArray *entries, guint entry_idx)
+{
+	Entry *entry;
+	guint lo, hi, mid, lo_eq;
+	int c;
+
+	/* All entries but the one at @entry_idx are already sorted. Move that
+	 * one to where a stable sort of the whole list would put it, without
+	 * sorting the list again: among entries that compare equal, it keeps its
+	 * position relative to the others. */
+	entry = g_ptr_array_index (entries, entry_idx);
+	g_ptr_array_remove_index (entries, entry_idx);
+
+	/* the first entry that is not smaller... */
+	lo = 0;
+	hi = entries->len;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (_sort_entries_cmp (&entries->pdata[mid], &entry, NULL) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	lo_eq = lo;
+
+	/* ... and the first entry that is larger. */
+	hi = entries->len;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (_sort_entries_cmp (&entries->pdata[mid], &entry, NULL) <= 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	entry_idx = CLAMP (entry_idx, lo_eq, lo);
+
+	g_ptr_array_add (entries, NULL);
+	memmove (&entries->pdata[entry_idx + 1],
+	         &entries->pdata[entry_idx],
+	         sizeof (gpointer) * (entries->len - 1 - entry_idx));
+	entries->pdata[entry_idx] = entry;
+}
+
 static GHashTable *
-_get_assumed_interface_metrics (const VTableIP *vtable, NMDefaultRouteManager *self, GArray *routes)
+_get_assumed_interface_metrics (const VTableIP *vtable, NMDefaultRouteManager *self, GArray *routes, GHashTable *synced_ifindexes)
 {
 	NMDefaultRouteManagerPrivate *priv = NM_DEFAULT_ROUTE_MANAGER_GET_PRIVATE (self);
 	GPtrArray *entries;
-	guint i, j;
+	guint i;
 	GHashTable *result;
 
 	/* create a list of all metrics that are currently assigned on an interface
@@ -434,22 +536,11 @@ _get_assumed_interface_metrics (const VTableIP *vtable, NMDefaultRouteManager *s
 	result = g_hash_table_new (NULL, NULL);
 
 	for (i = 0; i < routes->len; i++) {
-		gboolean ifindex_has_synced_entry = FALSE;
 		const NMPlatformIPRoute *route;
 
 		route = _vt_route_index (vtable, routes, i);
 
-		for (j = 0; j < entries->len; j++) {
-			Entry *e = g_ptr_array_index (entries, j);
-
-			if (   e->synced
-			    && e->route.rx.ifindex == route->ifindex) {
-				ifindex_has_synced_entry = TRUE;
-				break;
-			}
-		}
-
-		if (!ifindex_has_synced_entry)
+		if (!g_hash_table_contains (synced_ifindexes, GINT_TO_POINTER (route->ifindex)))
 			g_hash_table_add (result, GUINT_TO_POINTER (vtable->vt->metric_normalize (route->metric)));
 	}
 
@@ -457,27 +548,94 @@ _get_assumed_interface_metrics (const VTableIP *vtable, NMDefaultRouteManager *s
 	 * we track as non-synced but that are no longer part of platform routes. Anyway, for now
 	 * we still want to treat them as assumed. */
 	for (i = 0; i < entries->len; i++) {
-		gboolean ifindex_has_synced_entry = FALSE;
 		Entry *e_i = g_ptr_array_index (entries, i);
 
 		if (e_i->synced)
 			continue;
 
-		for (j = 0; j < entries->len; j++) {
-			Entry *e_j = g_ptr_array_index (entries, j);
+		if (!g_hash_table_contains (synced_ifindexes, GINT_TO_POINTER (e_i->route.rx.ifindex)))
+			g_hash_table_add (result, GUINT_TO_POINTER (vtable->vt->metric_normalize (e_i->route.rx.metric)));
+	}
+
+	return result;
+}
+
+static void
+_ecmp_mark_entries (const VTableIP *vtable, GPtrArray *entries)
+{
+	guint i, j, n;
+
+	/* Entries with a weight and the same (original) metric are merged into
+	 * one multipath default route. Since a kernel route is identified by
+	 * its metric, there is only one such route: the one for the best metric
+	 * that has at least two candidates. The other candidates get default
+	 * routes of their own. */
+	for (i = 0; i < entries->len; i++)
+		((Entry *) g_ptr_array_index (entries, i))->ecmp = FALSE;
+
+	if (!vtable->vt->is_ip4)
+		return;
+
+	for (i = 0; i < entries->len; i = j) {
+		const Entry *e_i = g_ptr_array_index (entries, i);
+
+		/* entries are sorted by metric, find all entries with the same one. */
+		n = 0;
+		for (j = i; j < entries->len; j++) {
+			const Entry *e_j = g_ptr_array_index (entries, j);
 
-			if (   j != i
-			    && (e_j->synced && e_j->route.rx.ifindex == e_i->route.rx.ifindex)) {
-				ifindex_has_synced_entry = TRUE;
+			if (e_j->route.rx.metric != e_i->route.rx.metric)
 				break;
+			if (e_j->synced && !e_j->never_default && e_j->weight > 0)
+				n++;
+		}
+
+		if (n >= 2) {
+			for (j = i; j < entries->len; j++) {
+				Entry *e_j = g_ptr_array_index (entries, j);
+
+				if (e_j->route.rx.metric != e_i->route.rx.metric)
+					break;
+				if (e_j->synced && !e_j->never_default && e_j->weight > 0)
+					e_j->ecmp = TRUE;
 			}
+			return;
 		}
+	}
+}
 
-		if (!ifindex_has_synced_entry)
-			g_hash_table_add (result, GUINT_TO_POINTER (vtable->vt->metric_normalize (e_i->route.rx.metric)));
+static GArray *
+_ecmp_get_nexthops (GPtrArray *entries, NMIPConfigSource *out_source)
+{
+	GArray *nexthops = NULL;
+	guint i;
+
+	for (i = 0; i < entries->len; i++) {
+		const Entry *e = g_ptr_array_index (entries, i);
+		NMPlatformIP4Nexthop nh = {
+			.ifindex = e->route.rx.ifindex,
+			.gateway = e->route.r4.gateway,
+			.weight = e->weight,
+		};
+
+		if (!e->ecmp)
+			continue;
+		if (!nexthops) {
+			nexthops = g_array_new (FALSE, FALSE, sizeof (NMPlatformIP4Nexthop));
+			*out_source = e->route.rx.rt_source;
+		}
+		g_array_append_val (nexthops, nh);
 	}
+	return nexthops;
+}
 
-	return result;
+static gboolean
+_ecmp_nexthops_equal (GArray *a, GArray *b)
+{
+	if (!a || !b)
+		return a == b;
+	return    a->len == b->len
+	       && memcmp (a->data, b->data, a->len * sizeof (NMPlatformIP4Nexthop)) == 0;
 }
 
 static gboolean
@@ -491,9 +649,13 @@ _resync_all (const VTableIP *vtable, NMDefaultRouteManager *self, const Entry *c
 	GPtrArray *entries;
 	GArray *changed_metrics = g_array_new (FALSE, FALSE, sizeof (guint32));
 	GHashTable *assumed_metrics;
+	GHashTable *synced_ifindexes;
 	GArray *routes;
 	gboolean changed = FALSE;
 	int ifindex_to_flush = 0;
+	gint64 ecmp_metric = -1;
+	GArray *ecmp_nexthops = NULL;
+	NMIPConfigSource ecmp_source = NM_IP_CONFIG_SOURCE_UNKNOWN;
 
 	g_assert (priv->resync.guard == 0);
 	priv->resync.guard++;
@@ -511,7 +673,10 @@ _resync_all (const VTableIP *vtable, NMDefaultRouteManager *self, const Entry *c
 
 	routes = vtable->vt->route_get_all (priv->platform, 0, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT);
 
-	assumed_metrics = _get_assumed_interface_metrics (vtable, self, routes);
+	synced_ifindexes = _get_synced_ifindexes (entries);
+	assumed_metrics = _get_assumed_interface_metrics (vtable, self, routes, synced_ifindexes);
+
+	_ecmp_mark_entries (vtable, entries);
 
 	if (old_entry && old_entry->synced && !old_entry->never_default) {
 		/* The old version obviously changed. */
@@ -526,22 +691,11 @@ _resync_all (const VTableIP *vtable, NMDefaultRouteManager *self, const Entry *c
 			continue;
 
 		if (!entry->synced) {
-			gboolean has_synced_entry = FALSE;
-
 			/* A non synced entry is completely ignored, if we have
 			 * a synced entry for the same if index.
 			 * Otherwise the metric of the entry is still remembered as
 			 * last_metric to avoid reusing it. */
-			for (j = 0; j < entries->len; j++) {
-				const Entry *e = g_ptr_array_index (entries, j);
-
-				if (   e->synced
-					&& e->route.rx.ifindex == entry->route.rx.ifindex) {
-					has_synced_entry = TRUE;
-					break;
-				}
-			}
-			if (!has_synced_entry)
+			if (!g_hash_table_contains (synced_ifindexes, GINT_TO_POINTER (entry->route.rx.ifindex)))
 				last_metric = MAX (last_metric, (gint64) entry->effective_metric);
 			continue;
 		}
@@ -559,7 +713,7 @@ _resync_all (const VTableIP *vtable, NMDefaultRouteManager *self, const Entry *c
 
 			/* However, if there is a matching route (ifindex+metric) for our current entry, we are done. */
 			for (j = 0; j < routes->len; j++) {
-				const NMPlatformIPRoute *r = _vt_route_index (vtable, routes, i);
+				const NMPlatformIPRoute *r = _vt_route_index (vtable, routes, j);
 
 				if (   r->metric == expected_metric
 				    && r->ifindex == entry->route.rx.ifindex) {
@@ -572,6 +726,25 @@ _resync_all (const VTableIP *vtable, NMDefaultRouteManager *self, const Entry *c
 			expected_metric++;
 		}
 
+		if (entry->ecmp) {
+			/* the nexthops of the multipath route all share the metric
+			 * of the first one. They are synced separately below. */
+			if (ecmp_metric < 0) {
+				ecmp_metric = expected_metric;
+				_LOG2D (vtable, i, entry, "sync:ecmp   %s (%u, weight %u)",
+				        vtable->vt->route_to_string (&entry->route, NULL, 0), (guint) expected_metric,
+				        (guint) entry->weight);
+			} else
+				expected_metric = ecmp_metric;
+
+			if (entry->effective_metric != expected_metric) {
+				entry->effective_metric = expected_metric;
+				changed = TRUE;
+			}
+			last_metric = MAX (last_metric, (gint64) expected_metric);
+			continue;
+		}
+
 		if (changed_entry == entry) {
 			/* for the changed entry, the previous metric was either old_entry->effective_metric,
 			 * or none. Hence, we only have to remember what is going to change. */
@@ -611,6 +784,20 @@ _resync_all (const VTableIP *vtable, NMDefaultRouteManager *self, const Entry *c
 
 	g_array_free (routes, TRUE);
 
+	if (vtable->vt->is_ip4) {
+		ecmp_nexthops = _ecmp_get_nexthops (entries, &ecmp_source);
+
+		/* a multipath route that is no longer wanted must be gone before
+		 * adding single default routes, which might use the same metric. */
+		if (   priv->ecmp4.nexthops
+		    && (!ecmp_nexthops || priv->ecmp4.metric != ecmp_metric)) {
+			nm_platform_ip4_default_route_set_multipath (priv->platform, priv->ecmp4.metric,
+			                                             NM_IP_CONFIG_SOURCE_UNKNOWN, NULL, 0);
+			g_clear_pointer (&priv->ecmp4.nexthops, g_array_unref);
+			changed = TRUE;
+		}
+	}
+
 	g_array_sort_with_data (changed_metrics, nm_cmp_uint32_p_with_data, NULL);
 	last_metric = -1;
 	for (j = 0; j < changed_metrics->len; j++) {
@@ -634,10 +821,41 @@ _resync_all (const VTableIP *vtable, NMDefaultRouteManager *self, const Entry *c
 		ifindex_to_flush = old_entry->route.rx.ifindex;
 	}
 
-	changed |= _platform_route_sync_flush (vtable, self, ifindex_to_flush);
+	changed |= _platform_route_sync_flush (vtable, self, synced_ifindexes, ifindex_to_flush);
+
+	/* add the multipath route only after flushing, because deleting a single
+	 * default route by ifindex and metric could also hit the multipath route
+	 * if the ifindex is its first nexthop.
+	 *
+	 * The platform cache ignores multipath routes, so we would not notice
+	 * if the route was deleted by somebody else. Replace it on every resync
+	 * even if it didn't change, which restores it in that case. */
+	if (ecmp_nexthops) {
+		if (nm_platform_ip4_default_route_set_multipath (priv->platform, ecmp_metric, ecmp_source,
+		                                                 (const NMPlatformIP4Nexthop *) ecmp_nexthops->data,
+		                                                 ecmp_nexthops->len)) {
+			if (   !priv->ecmp4.nexthops
+			    || priv->ecmp4.metric != ecmp_metric
+			    || !_ecmp_nexthops_equal (ecmp_nexthops, priv->ecmp4.nexthops)) {
+				if (priv->ecmp4.nexthops)
+					g_array_unref (priv->ecmp4.nexthops);
+				priv->ecmp4.nexthops = g_steal_pointer (&ecmp_nexthops);
+				priv->ecmp4.metric = ecmp_metric;
+				changed = TRUE;
+			}
+		} else {
+			/* only remember what is installed: the previous route, if it
+			 * had the same metric, or none. The next resync tries again. */
+			_LOGW (AF_INET, "failed to add multipath default route with %u nexthops and metric %u",
+			       ecmp_nexthops->len, (guint) ecmp_metric);
+		}
+	}
+	if (ecmp_nexthops)
+		g_array_unref (ecmp_nexthops);
 
 	g_array_free (changed_metrics, TRUE);
 	g_hash_table_unref (assumed_metrics);
+	g_hash_table_unref (synced_ifindexes);
 
 	priv->resync.guard--;
 	return changed;
@@ -670,7 +888,7 @@ _entry_at_idx_update (const VTableIP *vtable, NMDefaultRouteManager *self, guint
 	        vtable->vt->route_to_string (&entry->route, NULL, 0),
 	        entry->effective_metric);
 
-	g_ptr_array_sort_with_data (entries, _sort_entries_cmp, NULL);
+	_entries_reposition (entries, entry_idx);
 
 	_resync_all (vtable, self, entry, old_entry, FALSE);
 }
@@ -718,6 +936,7 @@ _ipx_update_default_route (const VTableIP *vtable,
 	NMVpnConnection *vpn = NULL;
 	gboolean never_default = FALSE;
 	gboolean synced = FALSE;
+	guint32 weight = 0;
 
 	g_return_if_fail (NM_IS_DEFAULT_ROUTE_MANAGER (self));
 
@@ -779,6 +998,14 @@ _ipx_update_default_route (const VTableIP *vtable,
 				never_default = TRUE;
 			}
 			synced = !is_assumed;
+
+			if (vtable->vt->is_ip4 && synced && !never_default) {
+				NMSetting *s_ip4;
+
+				s_ip4 = nm_device_get_applied_setting (device, NM_TYPE_SETTING_IP4_CONFIG);
+				if (s_ip4)
+					weight = nm_setting_ip4_config_get_route_weight (NM_SETTING_IP4_CONFIG (s_ip4));
+			}
 		} else {
 			NMConnection *connection = nm_active_connection_get_applied_connection ((NMActiveConnection *) vpn);
 
@@ -852,6 +1079,7 @@ _ipx_update_default_route (const VTableIP *vtable,
 		entry->never_default = never_default;
 		entry->effective_metric = entry->route.rx.metric;
 		entry->synced = synced;
+		entry->weight = weight;
 
 		g_ptr_array_add (entries, entry);
 		_entry_at_idx_update (vtable, self, entries->len - 1, NULL);
@@ -869,6 +1097,7 @@ _ipx_update_default_route (const VTableIP *vtable,
 		new_entry.route.rx.ifindex = ip_ifindex;
 		new_entry.never_default = never_default;
 		new_entry.synced = synced;
+		new_entry.weight = weight;
 
 		if (memcmp (entry, &new_entry, sizeof (new_entry)) == 0) {
 			if (!synced) {
@@ -1395,36 +1624,12 @@ _resync_idle_reschedule (NMDefaultRouteManager *self)
 
 static void
 _platform_changed_cb (NMPlatform *platform,
-                      int obj_type_i,
-                      int ifindex,
-                      gpointer platform_object,
-                      int change_type_i,
+                      const NMPlatformChanges *changes,
                       NMDefaultRouteManager *self)
 {
 	NMDefaultRouteManagerPrivate *priv;
-	const NMPObjectType obj_type = obj_type_i;
-	const VTableIP *vtable;
-
-	switch (obj_type) {
-	case NMP_OBJECT_TYPE_IP4_ADDRESS:
-		vtable = &vtable_ip4;
-		break;
-	case NMP_OBJECT_TYPE_IP6_ADDRESS:
-		vtable = &vtable_ip6;
-		break;
-	case NMP_OBJECT_TYPE_IP4_ROUTE:
-		if (!NM_PLATFORM_IP_ROUTE_IS_DEFAULT (platform_object))
-			return;
-		vtable = &vtable_ip4;
-		break;
-	case NMP_OBJECT_TYPE_IP6_ROUTE:
-		if (!NM_PLATFORM_IP_ROUTE_IS_DEFAULT (platform_object))
-			return;
-		vtable = &vtable_ip6;
-		break;
-	default:
-		g_return_if_reached ();
-	}
+	gboolean has_v4_changes, has_v6_changes;
+	guint i;
 
 	priv = NM_DEFAULT_ROUTE_MANAGER_GET_PRIVATE (self);
 
@@ -1433,9 +1638,36 @@ _platform_changed_cb (NMPlatform *platform,
 		return;
 	}
 
-	if (vtable->vt->is_ip4)
+	has_v4_changes = NM_PLATFORM_CHANGES_HAS_TYPE (changes, NMP_OBJECT_TYPE_IP4_ADDRESS);
+	has_v6_changes = NM_PLATFORM_CHANGES_HAS_TYPE (changes, NMP_OBJECT_TYPE_IP6_ADDRESS);
+
+	if (   (!has_v4_changes && NM_PLATFORM_CHANGES_HAS_TYPE (changes, NMP_OBJECT_TYPE_IP4_ROUTE))
+	    || (!has_v6_changes && NM_PLATFORM_CHANGES_HAS_TYPE (changes, NMP_OBJECT_TYPE_IP6_ROUTE))) {
+		/* only changes of default routes are relevant. */
+		for (i = 0; i < changes->len; i++) {
+			const NMPlatformChange *change = &changes->changes[i];
+
+			switch (change->obj_type) {
+			case NMP_OBJECT_TYPE_IP4_ROUTE:
+				if (NM_PLATFORM_IP_ROUTE_IS_DEFAULT (&change->ip4_route))
+					has_v4_changes = TRUE;
+				break;
+			case NMP_OBJECT_TYPE_IP6_ROUTE:
+				if (NM_PLATFORM_IP_ROUTE_IS_DEFAULT (&change->ip6_route))
+					has_v6_changes = TRUE;
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	if (!has_v4_changes && !has_v6_changes)
+		return;
+
+	if (has_v4_changes)
 		priv->resync.has_v4_changes = TRUE;
-	else
+	if (has_v6_changes)
 		priv->resync.has_v6_changes = TRUE;
 
 	_resync_idle_reschedule (self);
@@ -1480,10 +1712,7 @@ constructed (GObject *object)
 	priv->entries_ip4 = g_ptr_array_new_full (0, (GDestroyNotify) _entry_free);
 	priv->entries_ip6 = g_ptr_array_new_full (0, (GDestroyNotify) _entry_free);
 
-	g_signal_connect (priv->platform, NM_PLATFORM_SIGNAL_IP4_ADDRESS_CHANGED, G_CALLBACK (_platform_changed_cb), self);
-	g_signal_connect (priv->platform, NM_PLATFORM_SIGNAL_IP6_ADDRESS_CHANGED, G_CALLBACK (_platform_changed_cb), self);
-	g_signal_connect (priv->platform, NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED, G_CALLBACK (_platform_changed_cb), self);
-	g_signal_connect (priv->platform, NM_PLATFORM_SIGNAL_IP6_ROUTE_CHANGED, G_CALLBACK (_platform_changed_cb), self);
+	g_signal_connect (priv->platform, NM_PLATFORM_SIGNAL_CHANGES, G_CALLBACK (_platform_changed_cb), self);
 }
 
 NMDefaultRouteManager *
@@ -1509,6 +1738,8 @@ dispose (GObject *object)
 
 	_resync_idle_cancel (self);
 
+	g_clear_pointer (&priv->ecmp4.nexthops, g_array_unref);
+
 	/* g_ptr_array_free() invokes the free function for all entries without actually
 	 * removing them and having dangling pointers in the process. _entry_free()
 	 * will unref the source, which might cause the destruction of the object, which
@@ -27,6 +27,7 @@
 #include "nm-dbus-interface.h"
 #include "nm-utils.h"
 #include "nm-exported-object.h"
+#include "NetworkManagerUtils.h"
 
 #include "introspection/org.freedesktop.NetworkManager.DHCP4Config.h"
 
@@ -34,10 +35,12 @@
 
 NM_GOBJECT_PROPERTIES_DEFINE (NMDhcp4Config,
 	PROP_OPTIONS,
+	PROP_EXPIRY,
 );
 
 typedef struct {
 	GVariant *options;
+	guint64 expiry;
 } NMDhcp4ConfigPrivate;
 
 struct _NMDhcp4Config {
@@ -55,7 +58,18 @@ G_DEFINE_TYPE (NMDhcp4Config, nm_dhcp4_config, NM_TYPE_EXPORTED_OBJECT)
 
 /*****************************************************************************/
 
-void
+/* changes with every renewal; exported separately as the Expiry property. */
+static const char *const volatile_options[] = { "expiry", NULL };
+
+/**
+ * nm_dhcp4_config_set_options:
+ * @self: the #NMDhcp4Config
+ * @options: the options of the lease
+ *
+ * Returns: %TRUE if the options changed. If only options that change with
+ *   every renewal did, the exported options are kept as they are.
+ */
+gboolean
 nm_dhcp4_config_set_options (NMDhcp4Config *self,
                              GHashTable *options)
 {
@@ -63,9 +77,19 @@ nm_dhcp4_config_set_options (NMDhcp4Config *self,
 	GHashTableIter iter;
 	const char *key, *value;
 	GVariantBuilder builder;
+	guint64 expiry;
+
+	g_return_val_if_fail (NM_IS_DHCP4_CONFIG (self), FALSE);
+	g_return_val_if_fail (options != NULL, FALSE);
 
-	g_return_if_fail (NM_IS_DHCP4_CONFIG (self));
-	g_return_if_fail (options != NULL);
+	expiry = _nm_utils_ascii_str_to_int64 (g_hash_table_lookup (options, "expiry"), 10, 0, G_MAXINT64, 0);
+	if (expiry != priv->expiry) {
+		priv->expiry = expiry;
+		_notify (self, PROP_EXPIRY);
+	}
+
+	if (nm_utils_dhcp_options_equal (priv->options, options, volatile_options))
+		return FALSE;
 
 	g_variant_unref (priv->options);
 
@@ -77,6 +101,7 @@ nm_dhcp4_config_set_options (NMDhcp4Config *self,
 	priv->options = g_variant_builder_end (&builder);
 	g_variant_ref_sink (priv->options);
 	_notify (self, PROP_OPTIONS);
+	return TRUE;
 }
 
 const char *
@@ -114,6 +139,9 @@ get_property (GObject *object, guint prop_id,
 	case PROP_OPTIONS:
 		g_value_set_variant (value, priv->options);
 		break;
+	case PROP_EXPIRY:
+		g_value_set_uint64 (value, priv->expiry);
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
@@ -166,6 +194,12 @@ nm_dhcp4_config_class_init (NMDhcp4ConfigClass *config_class)
 	                           G_PARAM_READABLE |
 	                           G_PARAM_STATIC_STRINGS);
 
+	obj_properties[PROP_EXPIRY] =
+	     g_param_spec_uint64 (NM_DHCP4_CONFIG_EXPIRY, "", "",
+	                          0, G_MAXUINT64, 0,
+	                          G_PARAM_READABLE |
+	                          G_PARAM_STATIC_STRINGS);
+
 	g_object_class_install_properties (object_class, _PROPERTY_ENUMS_LAST, obj_properties);
 
 	nm_exported_object_class_add_interface (NM_EXPORTED_OBJECT_CLASS (config_class),
@@ -29,6 +29,7 @@
 #define NM_DHCP4_CONFIG_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), NM_TYPE_DHCP4_CONFIG, NMDhcp4ConfigClass))
 
 #define NM_DHCP4_CONFIG_OPTIONS "options"
+#define NM_DHCP4_CONFIG_EXPIRY  "expiry"
 
 typedef struct _NMDhcp4ConfigClass NMDhcp4ConfigClass;
 
@@ -36,8 +37,8 @@ GType nm_dhcp4_config_get_type (void);
 
 NMDhcp4Config *nm_dhcp4_config_new (void);
 
-void nm_dhcp4_config_set_options (NMDhcp4Config *config,
-                                  GHashTable *options);
+gboolean nm_dhcp4_config_set_options (NMDhcp4Config *config,
+                                      GHashTable *options);
 
 const char *nm_dhcp4_config_get_option (NMDhcp4Config *config, const char *option);
 
@@ -27,6 +27,7 @@
 #include "nm-dbus-interface.h"
 #include "nm-utils.h"
 #include "nm-exported-object.h"
+#include "NetworkManagerUtils.h"
 
 #include "introspection/org.freedesktop.NetworkManager.DHCP6Config.h"
 
@@ -55,7 +56,18 @@ G_DEFINE_TYPE (NMDhcp6Config, nm_dhcp6_config, NM_TYPE_EXPORTED_OBJECT)
 
 /*****************************************************************************/
 
-void
+/* change with every renewal. */
+static const char *const volatile_options[] = { "starts", "life_starts", NULL };
+
+/**
+ * nm_dhcp6_config_set_options:
+ * @self: the #NMDhcp6Config
+ * @options: the options of the lease
+ *
+ * Returns: %TRUE if the options changed. If only options that change with
+ *   every renewal did, the exported options are kept as they are.
+ */
+gboolean
 nm_dhcp6_config_set_options (NMDhcp6Config *self,
                              GHashTable *options)
 {
@@ -64,8 +76,11 @@ nm_dhcp6_config_set_options (NMDhcp6Config *self,
 	const char *key, *value;
 	GVariantBuilder builder;
 
-	g_return_if_fail (NM_IS_DHCP6_CONFIG (self));
-	g_return_if_fail (options != NULL);
+	g_return_val_if_fail (NM_IS_DHCP6_CONFIG (self), FALSE);
+	g_return_val_if_fail (options != NULL, FALSE);
+
+	if (nm_utils_dhcp_options_equal (priv->options, options, volatile_options))
+		return FALSE;
 
 	g_variant_unref (priv->options);
 
@@ -77,6 +92,7 @@ nm_dhcp6_config_set_options (NMDhcp6Config *self,
 	priv->options = g_variant_builder_end (&builder);
 	g_variant_ref_sink (priv->options);
 	_notify (self, PROP_OPTIONS);
+	return TRUE;
 }
 
 const char *
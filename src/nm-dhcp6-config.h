@@ -36,8 +36,8 @@ GType nm_dhcp6_config_get_type (void);
 
 NMDhcp6Config *nm_dhcp6_config_new (void);
 
-void nm_dhcp6_config_set_options (NMDhcp6Config *config,
-                                  GHashTable *options);
+gboolean nm_dhcp6_config_set_options (NMDhcp6Config *config,
+                                      GHashTable *options);
 
 const char *nm_dhcp6_config_get_option (NMDhcp6Config *config, const char *option);
 
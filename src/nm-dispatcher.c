@@ -38,6 +38,7 @@
 #include "nm-ip4-config.h"
 #include "nm-ip6-config.h"
 #include "nm-manager.h"
+#include "nm-config.h"
 #include "settings/nm-settings-connection.h"
 #include "platform/nm-platform.h"
 #include "nm-core-internal.h"
@@ -50,6 +51,14 @@
 static GDBusProxy *dispatcher_proxy;
 static GHashTable *requests = NULL;
 
+/* monotonic timestamp in msec, after which blocking calls are skipped.
+ * Zero means no limit besides CALL_TIMEOUT. */
+static gint64 sync_deadline_ms;
+
+/* the per-interface queues of calls for the "dispatcher.coalesce-events"
+ * mode, indexed by the interface name. */
+static GHashTable *coalesce_queues = NULL;
+
 typedef struct {
 	GFileMonitor *monitor;
 	const char *const description;
@@ -247,18 +256,49 @@ dump_ip6_to_props (NMIP6Config *ip6, GVariantBuilder *builder)
 	                       g_variant_builder_end (&int_builder));
 }
 
+#define IP_PROPS_QUARK NM_CACHED_QUARK ("nm-dispatcher-ip-props")
+
+static void
+_ip_props_invalidate (GObject *config, GParamSpec *pspec, gpointer user_data)
+{
+	g_signal_handlers_disconnect_by_func (config, _ip_props_invalidate, NULL);
+	g_object_set_qdata (config, IP_PROPS_QUARK, NULL);
+}
+
+/* returns the serialized properties of the IP config. They are cached on
+ * the config until it changes, so that subsequent calls for an unchanged
+ * config don't serialize it again. */
+static GVariant *
+_ip_props_get (gpointer config, void (*dump_func) (gpointer config, GVariantBuilder *builder))
+{
+	GVariantBuilder builder;
+	GVariant *props;
+
+	if (!config)
+		return g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0);
+
+	props = g_object_get_qdata (config, IP_PROPS_QUARK);
+	if (!props) {
+		g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+		dump_func (config, &builder);
+		props = g_variant_ref_sink (g_variant_builder_end (&builder));
+		g_object_set_qdata_full (config, IP_PROPS_QUARK, props,
+		                         (GDestroyNotify) g_variant_unref);
+		g_signal_connect (config, "notify", G_CALLBACK (_ip_props_invalidate), NULL);
+	}
+	return props;
+}
+
 static void
 fill_device_props (NMDevice *device,
                    GVariantBuilder *dev_builder,
                    GVariantBuilder *proxy_builder,
-                   GVariantBuilder *ip4_builder,
-                   GVariantBuilder *ip6_builder,
+                   GVariant **ip4_props,
+                   GVariant **ip6_props,
                    GVariant **dhcp4_props,
                    GVariant **dhcp6_props)
 {
 	NMProxyConfig *proxy_config;
-	NMIP4Config *ip4_config;
-	NMIP6Config *ip6_config;
 	NMDhcp4Config *dhcp4_config;
 	NMDhcp6Config *dhcp6_config;
 
@@ -279,13 +319,10 @@ fill_device_props (NMDevice *device,
 	if (proxy_config)
 		dump_proxy_to_props (proxy_config, proxy_builder);
 
-	ip4_config = nm_device_get_ip4_config (device);
-	if (ip4_config)
-		dump_ip4_to_props (ip4_config, ip4_builder);
-
-	ip6_config = nm_device_get_ip6_config (device);
-	if (ip6_config)
-		dump_ip6_to_props (ip6_config, ip6_builder);
+	*ip4_props = _ip_props_get (nm_device_get_ip4_config (device),
+	                            (void (*) (gpointer, GVariantBuilder *)) dump_ip4_to_props);
+	*ip6_props = _ip_props_get (nm_device_get_ip6_config (device),
+	                            (void (*) (gpointer, GVariantBuilder *)) dump_ip6_to_props);
 
 	dhcp4_config = nm_device_get_dhcp4_config (device);
 	if (dhcp4_config)
@@ -301,15 +338,15 @@ fill_vpn_props (NMProxyConfig *proxy_config,
                 NMIP4Config *ip4_config,
                 NMIP6Config *ip6_config,
                 GVariantBuilder *proxy_builder,
-                GVariantBuilder *ip4_builder,
-                GVariantBuilder *ip6_builder)
+                GVariant **ip4_props,
+                GVariant **ip6_props)
 {
 	if (proxy_config)
 		dump_proxy_to_props (proxy_config, proxy_builder);
-	if (ip4_config)
-		dump_ip4_to_props (ip4_config, ip4_builder);
-	if (ip6_config)
-		dump_ip6_to_props (ip6_config, ip6_builder);
+	*ip4_props = _ip_props_get (ip4_config,
+	                            (void (*) (gpointer, GVariantBuilder *)) dump_ip4_to_props);
+	*ip6_props = _ip_props_get (ip6_config,
+	                            (void (*) (gpointer, GVariantBuilder *)) dump_ip6_to_props);
 }
 
 typedef struct {
@@ -318,6 +355,10 @@ typedef struct {
 	NMDispatcherFunc callback;
 	gpointer user_data;
 	guint idle_id;
+
+	/* set, if the call is the in-flight call of the coalesce queue
+	 * of the interface. */
+	char *coalesce_iface;
 } DispatchInfo;
 
 static void
@@ -325,6 +366,7 @@ dispatcher_info_free (DispatchInfo *info)
 {
 	if (info->idle_id)
 		g_source_remove (info->idle_id);
+	g_free (info->coalesce_iface);
 	g_free (info);
 }
 
@@ -407,6 +449,8 @@ dispatcher_results_process (guint request_id, NMDispatcherAction action, GVarian
 	}
 }
 
+static void coalesce_queue_next (const char *iface);
+
 static void
 dispatcher_done_cb (GObject *proxy, GAsyncResult *result, gpointer user_data)
 {
@@ -438,6 +482,9 @@ dispatcher_done_cb (GObject *proxy, GAsyncResult *result, gpointer user_data)
 	if (info->callback)
 		info->callback (info->request_id, info->user_data);
 
+	if (info->coalesce_iface)
+		coalesce_queue_next (info->coalesce_iface);
+
 	dispatcher_info_cleanup (info);
 }
 
@@ -475,6 +522,191 @@ dispatcher_idle_cb (gpointer user_data)
 	return G_SOURCE_REMOVE;
 }
 
+/*****************************************************************************/
+
+typedef struct {
+	NMDispatcherAction action;
+	guint request_id;
+	GVariant *parameters;
+} CoalescePending;
+
+/* a queue exists while a call of the interface is running in the dispatcher.
+ * Until it returns, new calls are queued in @pending, where they can be
+ * superseded by later calls. */
+typedef struct {
+	GQueue pending;
+} CoalesceQueue;
+
+static void
+coalesce_pending_free (CoalescePending *pending)
+{
+	g_variant_unref (pending->parameters);
+	g_slice_free (CoalescePending, pending);
+}
+
+static void
+coalesce_queue_free (CoalesceQueue *queue)
+{
+	g_queue_free_full (&queue->pending, (GDestroyNotify) coalesce_pending_free);
+	g_slice_free (CoalesceQueue, queue);
+}
+
+static void
+dispatcher_send (guint request_id,
+                 NMDispatcherAction action,
+                 GVariant *parameters,
+                 const char *coalesce_iface)
+{
+	DispatchInfo *info;
+
+	info = g_malloc0 (sizeof (*info));
+	info->action = action;
+	info->request_id = request_id;
+	info->coalesce_iface = g_strdup (coalesce_iface);
+	g_hash_table_insert (requests, GUINT_TO_POINTER (info->request_id), info);
+
+	g_dbus_proxy_call (dispatcher_proxy, "Action",
+	                   parameters,
+	                   G_DBUS_CALL_FLAGS_NONE, CALL_TIMEOUT,
+	                   NULL, dispatcher_done_cb, info);
+}
+
+static gboolean
+_action_is_coalescable (NMDispatcherAction action)
+{
+	return NM_IN_SET (action,
+	                  NM_DISPATCHER_ACTION_UP,
+	                  NM_DISPATCHER_ACTION_DOWN,
+	                  NM_DISPATCHER_ACTION_DHCP4_CHANGE,
+	                  NM_DISPATCHER_ACTION_DHCP6_CHANGE);
+}
+
+static void
+coalesce_queue_next (const char *iface)
+{
+	CoalesceQueue *queue;
+	CoalescePending *pending;
+
+	queue = coalesce_queues ? g_hash_table_lookup (coalesce_queues, iface) : NULL;
+	if (!queue)
+		return;
+
+	pending = g_queue_pop_head (&queue->pending);
+	if (!pending) {
+		g_hash_table_remove (coalesce_queues, iface);
+		return;
+	}
+
+	_LOGD ("(%u) (%s) dispatching coalesced action '%s'",
+	       pending->request_id, iface, action_to_string (pending->action));
+	dispatcher_send (pending->request_id, pending->action, pending->parameters, iface);
+	coalesce_pending_free (pending);
+}
+
+/* sends all queued calls of @iface right away, so that a call which cannot
+ * be coalesced doesn't overtake them. */
+static void
+coalesce_queue_flush (const char *iface)
+{
+	CoalesceQueue *queue;
+	CoalescePending *pending;
+
+	queue = coalesce_queues ? g_hash_table_lookup (coalesce_queues, iface) : NULL;
+	if (!queue)
+		return;
+
+	while ((pending = g_queue_pop_head (&queue->pending))) {
+		dispatcher_send (pending->request_id, pending->action, pending->parameters, NULL);
+		coalesce_pending_free (pending);
+	}
+}
+
+/**
+ * coalesce_queue_add:
+ * @iface: the interface of the call
+ * @request_id: the id of the call
+ * @action: the action of the call
+ * @parameters: the parameters for the Action() call
+ *
+ * While a call of @iface is running, queue the call. Calls still in the
+ * queue are dropped if they are superseded by the new call: a "dhcp4-change"
+ * or "dhcp6-change" by a later one of the same type, and an "up" together
+ * with the following changes if the device goes down again before the "up"
+ * was dispatched.
+ *
+ * Returns: %TRUE if the call was queued or dropped, %FALSE if it must
+ * be sent right away.
+ */
+static gboolean
+coalesce_queue_add (const char *iface,
+                    guint request_id,
+                    NMDispatcherAction action,
+                    GVariant *parameters)
+{
+	CoalesceQueue *queue;
+	CoalescePending *pending;
+	GList *iter, *prev;
+
+	if (G_UNLIKELY (!coalesce_queues)) {
+		coalesce_queues = g_hash_table_new_full (g_str_hash, g_str_equal,
+		                                         g_free, (GDestroyNotify) coalesce_queue_free);
+	}
+
+	queue = g_hash_table_lookup (coalesce_queues, iface);
+	if (!queue) {
+		queue = g_slice_new0 (CoalesceQueue);
+		g_queue_init (&queue->pending);
+		g_hash_table_insert (coalesce_queues, g_strdup (iface), queue);
+		return FALSE;
+	}
+
+	for (iter = queue->pending.tail; iter; iter = prev) {
+		pending = iter->data;
+		prev = iter->prev;
+
+		if (NM_IN_SET (pending->action, NM_DISPATCHER_ACTION_UP, NM_DISPATCHER_ACTION_DOWN)) {
+			if (   action == NM_DISPATCHER_ACTION_DOWN
+			    && pending->action == NM_DISPATCHER_ACTION_UP) {
+				/* the "up" was never dispatched. Drop it together with
+				 * the changes after it and the "down". */
+				while (queue->pending.tail != prev) {
+					pending = g_queue_pop_tail (&queue->pending);
+					_LOGD ("(%u) (%s) drop action '%s', superseded by (%u)",
+					       pending->request_id, iface,
+					       action_to_string (pending->action), request_id);
+					coalesce_pending_free (pending);
+				}
+				_LOGD ("(%u) (%s) drop action '%s'",
+				       request_id, iface, action_to_string (action));
+				g_variant_unref (g_variant_ref_sink (parameters));
+				return TRUE;
+			}
+			break;
+		}
+
+		if (   NM_IN_SET (action, NM_DISPATCHER_ACTION_DHCP4_CHANGE, NM_DISPATCHER_ACTION_DHCP6_CHANGE)
+		    && pending->action == action) {
+			_LOGD ("(%u) (%s) drop action '%s', superseded by (%u)",
+			       pending->request_id, iface,
+			       action_to_string (pending->action), request_id);
+			g_queue_delete_link (&queue->pending, iter);
+			coalesce_pending_free (pending);
+		}
+	}
+
+	pending = g_slice_new (CoalescePending);
+	pending->action = action;
+	pending->request_id = request_id;
+	pending->parameters = g_variant_ref_sink (parameters);
+	g_queue_push_tail (&queue->pending, pending);
+
+	_LOGD ("(%u) (%s) queue action '%s' (%u pending)",
+	       request_id, iface, action_to_string (action), queue->pending.length);
+	return TRUE;
+}
+
+/*****************************************************************************/
+
 static gboolean
 _dispatcher_call (NMDispatcherAction action,
                   gboolean blocking,
@@ -495,13 +727,15 @@ _dispatcher_call (NMDispatcherAction action,
 	GVariantBuilder connection_props;
 	GVariantBuilder device_props;
 	GVariantBuilder device_proxy_props;
-	GVariantBuilder device_ip4_props;
-	GVariantBuilder device_ip6_props;
+	GVariant *device_ip4_props = NULL;
+	GVariant *device_ip6_props = NULL;
 	GVariant *device_dhcp4_props = NULL;
 	GVariant *device_dhcp6_props = NULL;
 	GVariantBuilder vpn_proxy_props;
-	GVariantBuilder vpn_ip4_props;
-	GVariantBuilder vpn_ip6_props;
+	GVariant *vpn_ip4_props = NULL;
+	GVariant *vpn_ip6_props = NULL;
+	GVariant *parameters;
+	const char *coalesce_iface = NULL;
 	DispatchInfo *info = NULL;
 	gboolean success = FALSE;
 	GError *error = NULL;
@@ -586,11 +820,7 @@ _dispatcher_call (NMDispatcherAction action,
 
 	g_variant_builder_init (&device_props, G_VARIANT_TYPE_VARDICT);
 	g_variant_builder_init (&device_proxy_props, G_VARIANT_TYPE_VARDICT);
-	g_variant_builder_init (&device_ip4_props, G_VARIANT_TYPE_VARDICT);
-	g_variant_builder_init (&device_ip6_props, G_VARIANT_TYPE_VARDICT);
 	g_variant_builder_init (&vpn_proxy_props, G_VARIANT_TYPE_VARDICT);
-	g_variant_builder_init (&vpn_ip4_props, G_VARIANT_TYPE_VARDICT);
-	g_variant_builder_init (&vpn_ip6_props, G_VARIANT_TYPE_VARDICT);
 
 	/* hostname and connectivity-change actions don't send device data */
 	if (   action != NM_DISPATCHER_ACTION_HOSTNAME
@@ -602,6 +832,21 @@ _dispatcher_call (NMDispatcherAction action,
 		                   &device_ip6_props,
 		                   &device_dhcp4_props,
 		                   &device_dhcp6_props);
+
+		/* only calls that nobody waits for can be delayed or dropped. */
+		if (   !blocking
+		    && !callback
+		    && !out_call_id
+		    && !vpn_iface
+		    && _action_is_coalescable (action)
+		    && nm_config_data_get_device_config_boolean (NM_CONFIG_GET_DATA,
+		                                                 "dispatcher.coalesce-events",
+		                                                 device,
+		                                                 FALSE, FALSE))
+			coalesce_iface = nm_device_get_iface (device);
+		else
+			coalesce_queue_flush (nm_device_get_iface (device));
+
 		if (vpn_ip4_config || vpn_ip6_config) {
 			fill_vpn_props (vpn_proxy_config,
 			                vpn_ip4_config,
@@ -612,39 +857,62 @@ _dispatcher_call (NMDispatcherAction action,
 		}
 	}
 
+	if (!device_ip4_props)
+		device_ip4_props = g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0);
+	if (!device_ip6_props)
+		device_ip6_props = g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0);
 	if (!device_dhcp4_props)
 		device_dhcp4_props = g_variant_ref_sink (g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0));
 	if (!device_dhcp6_props)
 		device_dhcp6_props = g_variant_ref_sink (g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0));
+	if (!vpn_ip4_props)
+		vpn_ip4_props = g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0);
+	if (!vpn_ip6_props)
+		vpn_ip6_props = g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0);
 
 #if WITH_CONCHECK
 	connectivity_state_string = nm_connectivity_state_to_string (connectivity_state);
 #endif
 
+	parameters = g_variant_new ("(s@a{sa{sv}}a{sv}a{sv}a{sv}@a{sv}@a{sv}@a{sv}@a{sv}ssa{sv}@a{sv}@a{sv}b)",
+	                            action_to_string (action),
+	                            connection_dict,
+	                            &connection_props,
+	                            &device_props,
+	                            &device_proxy_props,
+	                            device_ip4_props,
+	                            device_ip6_props,
+	                            device_dhcp4_props,
+	                            device_dhcp6_props,
+	                            connectivity_state_string,
+	                            vpn_iface ? vpn_iface : "",
+	                            &vpn_proxy_props,
+	                            vpn_ip4_props,
+	                            vpn_ip6_props,
+	                            nm_logging_enabled (LOGL_DEBUG, LOGD_DISPATCH));
+
 	/* Send the action to the dispatcher */
 	if (blocking) {
 		GVariant *ret;
 		GVariantIter *results;
+		gint64 timeout = CALL_TIMEOUT;
+
+		if (sync_deadline_ms) {
+			timeout = MIN (timeout, sync_deadline_ms - nm_utils_get_monotonic_timestamp_ms ());
+			if (timeout <= 0) {
+				_LOGW ("(%u) skipping blocking action '%s': deadline expired",
+				       reqid, action_to_string (action));
+				g_variant_unref (g_variant_ref_sink (parameters));
+				g_variant_unref (device_dhcp4_props);
+				g_variant_unref (device_dhcp6_props);
+				return FALSE;
+			}
+		}
 
 		ret = _nm_dbus_proxy_call_sync (dispatcher_proxy, "Action",
-		                                g_variant_new ("(s@a{sa{sv}}a{sv}a{sv}a{sv}a{sv}a{sv}@a{sv}@a{sv}ssa{sv}a{sv}a{sv}b)",
-		                                               action_to_string (action),
-		                                               connection_dict,
-		                                               &connection_props,
-		                                               &device_props,
-		                                               &device_proxy_props,
-		                                               &device_ip4_props,
-		                                               &device_ip6_props,
-		                                               device_dhcp4_props,
-		                                               device_dhcp6_props,
-		                                               connectivity_state_string,
-		                                               vpn_iface ? vpn_iface : "",
-		                                               &vpn_proxy_props,
-		                                               &vpn_ip4_props,
-		                                               &vpn_ip6_props,
-		                                               nm_logging_enabled (LOGL_DEBUG, LOGD_DISPATCH)),
+		                                parameters,
 		                                G_VARIANT_TYPE ("(a(sus))"),
-		                                G_DBUS_CALL_FLAGS_NONE, CALL_TIMEOUT,
+		                                G_DBUS_CALL_FLAGS_NONE, timeout,
 		                                NULL, &error);
 		if (ret) {
 			g_variant_get (ret, "(a(sus))", &results);
@@ -658,29 +926,19 @@ _dispatcher_call (NMDispatcherAction action,
 			g_clear_error (&error);
 			success = FALSE;
 		}
+	} else if (   coalesce_iface
+	           && coalesce_queue_add (coalesce_iface, reqid, action, parameters)) {
+		/* queued or dropped. */
+		success = TRUE;
 	} else {
 		info = g_malloc0 (sizeof (*info));
 		info->action = action;
 		info->request_id = reqid;
 		info->callback = callback;
 		info->user_data = user_data;
+		info->coalesce_iface = g_strdup (coalesce_iface);
 		g_dbus_proxy_call (dispatcher_proxy, "Action",
-		                   g_variant_new ("(s@a{sa{sv}}a{sv}a{sv}a{sv}a{sv}a{sv}@a{sv}@a{sv}ssa{sv}a{sv}a{sv}b)",
-		                                  action_to_string (action),
-		                                  connection_dict,
-		                                  &connection_props,
-		                                  &device_props,
-		                                  &device_proxy_props,
-		                                  &device_ip4_props,
-		                                  &device_ip6_props,
-		                                  device_dhcp4_props,
-		                                  device_dhcp6_props,
-		                                  connectivity_state_string,
-		                                  vpn_iface ? vpn_iface : "",
-		                                  &vpn_proxy_props,
-		                                  &vpn_ip4_props,
-		                                  &vpn_ip6_props,
-		                                  nm_logging_enabled (LOGL_DEBUG, LOGD_DISPATCH)),
+		                   parameters,
 		                   G_DBUS_CALL_FLAGS_NONE, CALL_TIMEOUT,
 		                   NULL, dispatcher_done_cb, info);
 		success = TRUE;
@@ -701,6 +959,21 @@ done:
 	return success;
 }
 
+/**
+ * nm_dispatcher_set_sync_deadline:
+ * @deadline_ms: a timestamp from nm_utils_get_monotonic_timestamp_ms(),
+ *   or 0 for no deadline.
+ *
+ * Limits the time of all following blocking calls, so that together they
+ * don't take longer than until @deadline_ms. Calls made after the deadline
+ * are skipped. Used on shutdown.
+ */
+void
+nm_dispatcher_set_sync_deadline (gint64 deadline_ms)
+{
+	sync_deadline_ms = deadline_ms;
+}
+
 /**
  * nm_dispatcher_call_hostname:
  * @callback: a caller-supplied callback to execute when done
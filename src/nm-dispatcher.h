@@ -85,6 +85,8 @@ gboolean nm_dispatcher_call_connectivity (NMConnectivityState state,
 
 void nm_dispatcher_call_cancel (guint call_id);
 
+void nm_dispatcher_set_sync_deadline (gint64 deadline_ms);
+
 void nm_dispatcher_init (void);
 
 #endif /* __NM_DISPATCHER_H__ */
@@ -26,6 +26,8 @@
 #include <string.h>
 
 #include "nm-bus-manager.h"
+#include "nm-core-utils.h"
+#include "nm-trace.h"
 
 #include "devices/nm-device.h"
 #include "nm-active-connection.h"
@@ -48,6 +50,9 @@ NM_GOBJECT_PROPERTIES_DEFINE (NMExportedObject,
 typedef struct {
 	GDBusInterfaceSkeleton *interface;
 	guint property_changed_signal_id;
+
+	/* the D-Bus property name => GParamSpec of the changed properties. Their
+	 * values are only converted to GVariant when emitting the signal. */
 	GHashTable *pending_notifies;
 } InterfaceData;
 
@@ -58,7 +63,12 @@ typedef struct _NMExportedObjectPrivate {
 	InterfaceData *interfaces;
 	guint num_interfaces;
 
-	guint notify_idle_id;
+	/* the link in emit_queue.fast or emit_queue.slow, while notifies are pending. */
+	GList *notify_link;
+	bool notify_slow:1;
+
+	/* whether the object is counted by the memory accounting. */
+	bool accounted:1;
 
 #ifdef _ASSERT_NO_EARLY_EXPORT
 	bool _constructed:1;
@@ -75,6 +85,10 @@ typedef struct {
 	GHashTable *properties;
 	GSList *skeleton_types;
 	GArray *methods;
+
+	/* the D-Bus names of the properties, for which
+	 * nm_exported_object_class_rate_limit_properties() was called. */
+	GHashTable *rate_limited;
 } NMExportedObjectClassInfo;
 
 static NM_CACHED_QUARK_FCN ("NMExportedObjectClassInfo", nm_exported_object_class_info_quark)
@@ -89,6 +103,340 @@ static NM_CACHED_QUARK_FCN ("NMExportedObjectClassInfo", nm_exported_object_clas
 
 /*****************************************************************************/
 
+/* The memory accounting counts the live instances per type and the D-Bus
+ * skeletons created for them. It is opt-in, because it costs a hash lookup
+ * for every object that is created and destroyed. */
+static struct {
+	bool enabled;
+
+	/* GType => guint64 *, the number of live instances. */
+	GHashTable *n_objects;
+
+	guint64 n_skeletons;
+	guint64 skeletons_bytes;
+} accounting;
+
+static gsize
+_type_instance_size (GType type)
+{
+	GTypeQuery query;
+
+	g_type_query (type, &query);
+	return query.instance_size;
+}
+
+static void
+_accounting_count_object (NMExportedObject *self, gboolean add)
+{
+	GType type = G_OBJECT_TYPE (self);
+	guint64 *n;
+
+	n = g_hash_table_lookup (accounting.n_objects, GSIZE_TO_POINTER (type));
+	if (!n) {
+		nm_assert (add);
+		n = g_slice_new0 (guint64);
+		g_hash_table_insert (accounting.n_objects, GSIZE_TO_POINTER (type), n);
+	}
+	if (add)
+		(*n)++;
+	else {
+		nm_assert (*n > 0);
+		(*n)--;
+	}
+}
+
+static void
+_accounting_count_skeleton (GDBusInterfaceSkeleton *interface, gboolean add)
+{
+	gsize size = _type_instance_size (G_OBJECT_TYPE (interface));
+
+	if (add) {
+		accounting.n_skeletons++;
+		accounting.skeletons_bytes += size;
+	} else {
+		accounting.n_skeletons--;
+		accounting.skeletons_bytes -= size;
+	}
+}
+
+/**
+ * nm_exported_object_class_set_memory_accounting:
+ *
+ * Enables counting the instances of all #NMExportedObject types, so that
+ * they are reported by nm_exported_object_memory_usage_foreach(). Only
+ * objects created after this call are counted, so it should be called
+ * early during startup.
+ */
+void
+nm_exported_object_class_set_memory_accounting (void)
+{
+	if (accounting.enabled)
+		return;
+	accounting.enabled = TRUE;
+	accounting.n_objects = g_hash_table_new (g_direct_hash, g_direct_equal);
+}
+
+/**
+ * nm_exported_object_memory_usage_foreach:
+ * @func: called for each type with live instances
+ * @user_data: user data for @func
+ *
+ * Reports the number of live instances per type and the size of their
+ * instance structs, and the D-Bus skeletons that export them. The memory
+ * referenced by the instances is not included. Nothing is reported, unless
+ * nm_exported_object_class_set_memory_accounting() was called.
+ */
+void
+nm_exported_object_memory_usage_foreach (NMMemoryUsageFunc func, gpointer user_data)
+{
+	GHashTableIter iter;
+	gpointer type;
+	guint64 *n;
+	char buf[128];
+
+	g_return_if_fail (func);
+
+	if (!accounting.enabled)
+		return;
+
+	g_hash_table_iter_init (&iter, accounting.n_objects);
+	while (g_hash_table_iter_next (&iter, &type, (gpointer *) &n)) {
+		if (*n == 0)
+			continue;
+		nm_sprintf_buf (buf, "objects.%s", g_type_name (GPOINTER_TO_SIZE (type)));
+		func (buf, *n, *n * _type_instance_size (GPOINTER_TO_SIZE (type)), user_data);
+	}
+	func ("objects.dbus-skeletons", accounting.n_skeletons, accounting.skeletons_bytes, user_data);
+}
+
+/*****************************************************************************/
+
+/* Per D-Bus method statistics. The handler time is the time spent in the
+ * synchronous part of the method handler, the authorization time is the
+ * time an NMAuthChain spent waiting for its results. Bucket 0 of the
+ * histograms counts durations below 1 ms and bucket i those from 2^(i-1)
+ * up to 2^i ms. The last bucket has no upper bound. */
+
+#define METHOD_STATS_HISTOGRAM_BUCKETS 14
+
+typedef struct {
+	guint64 count;
+	guint64 total_us;
+	guint64 max_us;
+	guint64 buckets[METHOD_STATS_HISTOGRAM_BUCKETS];
+} MethodLatency;
+
+typedef struct {
+	char *name;
+	MethodLatency handler;
+	MethodLatency auth;
+} MethodStats;
+
+/* const GDBusMethodInfo * => MethodStats *. The method infos are static
+ * data of the generated skeletons, so their address identifies a method of
+ * an interface. */
+static GHashTable *method_stats;
+
+static void
+_method_latency_add (MethodLatency *latency, guint64 duration_us)
+{
+	guint64 ms;
+	guint bucket = 0;
+
+	for (ms = duration_us / 1000; ms; ms >>= 1)
+		bucket++;
+	latency->buckets[MIN (bucket, METHOD_STATS_HISTOGRAM_BUCKETS - 1)]++;
+	latency->count++;
+	latency->total_us += duration_us;
+	latency->max_us = MAX (latency->max_us, duration_us);
+}
+
+static MethodStats *
+_method_stats_get (GDBusMethodInvocation *invocation)
+{
+	const GDBusMethodInfo *info;
+	MethodStats *stats;
+
+	info = g_dbus_method_invocation_get_method_info (invocation);
+	if (!info)
+		return NULL;
+
+	if (G_UNLIKELY (!method_stats))
+		method_stats = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	stats = g_hash_table_lookup (method_stats, info);
+	if (!stats) {
+		stats = g_slice_new0 (MethodStats);
+		stats->name = g_strdup_printf ("%s.%s",
+		                               g_dbus_method_invocation_get_interface_name (invocation),
+		                               info->name);
+		g_hash_table_insert (method_stats, (gpointer) info, stats);
+	}
+	return stats;
+}
+
+/**
+ * nm_exported_object_method_stats_add_auth:
+ * @invocation: the method call that was authorized
+ * @duration_us: how long the authorization took
+ *
+ * Accounts the time spent authorizing @invocation to its method.
+ */
+void
+nm_exported_object_method_stats_add_auth (GDBusMethodInvocation *invocation,
+                                          guint64 duration_us)
+{
+	MethodStats *stats;
+
+	g_return_if_fail (G_IS_DBUS_METHOD_INVOCATION (invocation));
+
+	stats = _method_stats_get (invocation);
+	if (stats)
+		_method_latency_add (&stats->auth, duration_us);
+}
+
+static GVariant *
+_method_latency_to_variant (const MethodLatency *latency)
+{
+	return g_variant_new ("(ttt@at)",
+	                      latency->count,
+	                      latency->total_us,
+	                      latency->max_us,
+	                      g_variant_new_fixed_array (G_VARIANT_TYPE_UINT64,
+	                                                 latency->buckets,
+	                                                 METHOD_STATS_HISTOGRAM_BUCKETS,
+	                                                 sizeof (guint64)));
+}
+
+/**
+ * nm_exported_object_method_stats_to_variant:
+ *
+ * Returns: (transfer floating): a variant of type "a{s((tttat)(tttat))}"
+ *   that maps "interface.Method" of each method that was called at least
+ *   once to the statistics of its handler time and of its authorization
+ *   time. Each consists of the number of calls, the total and maximum
+ *   duration in microseconds and the histogram of the durations.
+ */
+GVariant *
+nm_exported_object_method_stats_to_variant (void)
+{
+	GVariantBuilder builder;
+	GHashTableIter iter;
+	MethodStats *stats;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{s((tttat)(tttat))}"));
+	if (method_stats) {
+		g_hash_table_iter_init (&iter, method_stats);
+		while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &stats)) {
+			g_variant_builder_add (&builder, "{s(@(tttat)@(tttat))}",
+			                       stats->name,
+			                       _method_latency_to_variant (&stats->handler),
+			                       _method_latency_to_variant (&stats->auth));
+		}
+	}
+	return g_variant_builder_end (&builder);
+}
+
+/*****************************************************************************/
+
+/* The journal records the last JOURNAL_SIZE changes to exported objects,
+ * so that clients that were away can catch up with GetChangesSince()
+ * instead of fetching all objects again. The epoch identifies an instance
+ * of the daemon, the sequence numbers of the entries are only meaningful
+ * within it. */
+
+#define JOURNAL_SIZE 1024
+
+typedef enum {
+	JOURNAL_KIND_ADDED    = 1,
+	JOURNAL_KIND_REMOVED  = 2,
+	JOURNAL_KIND_CHANGED  = 3,
+} JournalKind;
+
+typedef struct {
+	char *path;
+	const char *interface;
+	GVariant *properties;
+	JournalKind kind;
+} JournalEntry;
+
+static struct {
+	guint64 epoch;
+
+	/* the sequence number of the last entry. The entry for sequence
+	 * number i is at entries[i % JOURNAL_SIZE]. */
+	guint64 last_seq;
+	JournalEntry *entries;
+} journal;
+
+static void
+_journal_add (JournalKind kind, const char *path, const char *interface, GVariant *properties)
+{
+	JournalEntry *entry;
+
+	if (G_UNLIKELY (!journal.entries)) {
+		journal.entries = g_new0 (JournalEntry, JOURNAL_SIZE);
+		journal.epoch = (((guint64) g_random_int ()) << 32) | g_random_int ();
+	}
+
+	entry = &journal.entries[++journal.last_seq % JOURNAL_SIZE];
+	g_free (entry->path);
+	g_clear_pointer (&entry->properties, g_variant_unref);
+
+	entry->kind = kind;
+	entry->path = g_strdup (path);
+	entry->interface = interface;
+	entry->properties = properties ? g_variant_ref (properties) : NULL;
+}
+
+/**
+ * nm_exported_object_journal_get_changes_since:
+ * @epoch: the epoch the client got with @since
+ * @since: the sequence number of the last change the client knows
+ *
+ * Returns: (transfer floating): a variant of type "(ttba(tusa{sv}))" with
+ *   the current epoch and sequence number, whether the changes after @since
+ *   are complete, and the changes. Each change consists of its sequence
+ *   number, its kind, the object path and, for changed properties, the
+ *   interface and the new values. The changes are not complete and none
+ *   are returned, if @epoch is not the current epoch, or if the journal
+ *   does not reach back to @since.
+ */
+GVariant *
+nm_exported_object_journal_get_changes_since (guint64 epoch, guint64 since)
+{
+	GVariantBuilder builder;
+	guint64 first_seq, seq;
+	gboolean complete;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(tusa{sv})"));
+
+	first_seq = journal.last_seq >= JOURNAL_SIZE ? journal.last_seq - JOURNAL_SIZE + 1 : 1;
+	complete =    journal.entries
+	           && epoch == journal.epoch
+	           && since <= journal.last_seq
+	           && since + 1 >= first_seq;
+
+	for (seq = since + 1; complete && seq <= journal.last_seq; seq++) {
+		const JournalEntry *entry = &journal.entries[seq % JOURNAL_SIZE];
+
+		g_variant_builder_add (&builder, "(tus@a{sv})",
+		                       seq,
+		                       (guint32) entry->kind,
+		                       entry->path,
+		                       entry->interface ?: "",
+		                       entry->properties ?: g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0));
+	}
+
+	return g_variant_new ("(ttba(tusa{sv}))",
+	                      journal.epoch,
+	                      journal.last_seq,
+	                      complete,
+	                      &builder);
+}
+
+/*****************************************************************************/
+
 /* "AddConnectionUnsaved" -> "handle-add-connection-unsaved" */
 char *
 nm_exported_object_skeletonify_method_name (const char *dbus_method_name)
@@ -273,6 +621,7 @@ nm_exported_object_class_add_interface (NMExportedObjectClass *object_class,
 		classinfo->skeleton_types = NULL;
 		classinfo->methods = g_array_new (FALSE, FALSE, sizeof (NMExportedObjectDBusMethodImpl));
 		classinfo->properties = g_hash_table_new (g_str_hash, g_str_equal);
+		classinfo->rate_limited = NULL;
 		g_type_set_qdata (G_TYPE_FROM_CLASS (object_class),
 		                  nm_exported_object_class_info_quark (), classinfo);
 	}
@@ -358,6 +707,41 @@ nm_exported_object_class_add_interface (NMExportedObjectClass *object_class,
 	g_type_class_unref (dbus_object_class);
 }
 
+/**
+ * nm_exported_object_class_rate_limit_properties:
+ * @object_class: an #NMExportedObjectClass
+ * @dbus_property_name: the D-Bus name of a property, like "Strength"
+ * @...: more property names, %NULL-terminated
+ *
+ * Marks properties of the interfaces that @object_class added with
+ * nm_exported_object_class_add_interface() as changing frequently. A change
+ * of only such properties is announced by the deprecated PropertiesChanged
+ * signal of the interface at most once per second. A change to another
+ * property of the object emits the pending changes right away.
+ */
+void
+nm_exported_object_class_rate_limit_properties (NMExportedObjectClass *object_class,
+                                                const char *dbus_property_name,
+                                                ...)
+{
+	NMExportedObjectClassInfo *classinfo;
+	va_list ap;
+
+	g_return_if_fail (NM_IS_EXPORTED_OBJECT_CLASS (object_class));
+
+	classinfo = g_type_get_qdata (G_TYPE_FROM_CLASS (object_class),
+	                              nm_exported_object_class_info_quark ());
+	g_return_if_fail (classinfo);
+
+	if (!classinfo->rate_limited)
+		classinfo->rate_limited = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	va_start (ap, dbus_property_name);
+	for (; dbus_property_name; dbus_property_name = va_arg (ap, const char *))
+		g_hash_table_add (classinfo->rate_limited, g_strdup (dbus_property_name));
+	va_end (ap);
+}
+
 /*****************************************************************************/
 
 /* "meta-marshaller" that receives the skeleton "handle-foo" signal, replaces
@@ -371,18 +755,39 @@ nm_exported_object_meta_marshal (GClosure *closure, GValue *return_value,
                                  gpointer invocation_hint, gpointer marshal_data)
 {
 	GValue *local_param_values;
+	GDBusMethodInvocation *invocation;
+	MethodStats *stats;
+	gint64 start_ns;
 
 	local_param_values = g_new0 (GValue, n_param_values);
 	g_value_init (&local_param_values[0], G_TYPE_POINTER);
 	g_value_set_pointer (&local_param_values[0], closure->data);
 	memcpy (local_param_values + 1, param_values + 1, (n_param_values - 1) * sizeof (GValue));
 
+	NM_TRACE2 (dbus__method,
+	           G_OBJECT_TYPE_NAME (closure->data),
+	           g_signal_name (((GSignalInvocationHint *) invocation_hint)->signal_id));
+
+	/* the first argument of the "handle-*" signals is the invocation. Take
+	 * the reference, because the handler might complete it right away. */
+	invocation = g_value_dup_object (&param_values[1]);
+	stats = _method_stats_get (invocation);
+	start_ns = nm_utils_get_monotonic_timestamp_ns ();
+
 	g_cclosure_marshal_generic (closure, NULL,
 	                            n_param_values, local_param_values,
 	                            invocation_hint,
 	                            ((GCClosure *)closure)->callback);
 	g_value_set_boolean (return_value, TRUE);
 
+	if (stats)
+		_method_latency_add (&stats->handler, (nm_utils_get_monotonic_timestamp_ns () - start_ns) / 1000);
+	g_object_unref (invocation);
+
+	NM_TRACE2 (dbus__method__done,
+	           G_OBJECT_TYPE_NAME (closure->data),
+	           g_signal_name (((GSignalInvocationHint *) invocation_hint)->signal_id));
+
 	g_value_unset (&local_param_values[0]);
 	g_free (local_param_values);
 }
@@ -498,13 +903,12 @@ nm_exported_object_create_skeletons (NMExportedObject *self,
 		                                                        methods_len,
 		                                                        (GObject *) self);
 		g_dbus_object_skeleton_add_interface ((GDBusObjectSkeleton *) self, ifdata->interface);
+		if (priv->accounted)
+			_accounting_count_skeleton (ifdata->interface, TRUE);
 
 		ifdata->property_changed_signal_id = g_signal_lookup ("properties-changed", G_OBJECT_TYPE (ifdata->interface));
 
-		ifdata->pending_notifies = g_hash_table_new_full (g_direct_hash,
-		                                                  g_direct_equal,
-		                                                  NULL,
-		                                                  (GDestroyNotify) g_variant_unref);
+		ifdata->pending_notifies = g_hash_table_new (g_direct_hash, g_direct_equal);
 	}
 	nm_assert (i == 0);
 
@@ -557,6 +961,8 @@ nm_exported_object_destroy_skeletons (NMExportedObject *self)
 		InterfaceData *ifdata = &priv->interfaces[--priv->num_interfaces];
 
 		g_dbus_object_skeleton_remove_interface ((GDBusObjectSkeleton *) self, ifdata->interface);
+		if (priv->accounted)
+			_accounting_count_skeleton (ifdata->interface, FALSE);
 		nm_exported_object_skeleton_release (ifdata->interface);
 		g_hash_table_destroy (ifdata->pending_notifies);
 	}
@@ -683,11 +1089,15 @@ nm_exported_object_export (NMExportedObject *self)
 
 	nm_bus_manager_register_object (priv->bus_mgr, (GDBusObjectSkeleton *) self);
 
+	_journal_add (JOURNAL_KIND_ADDED, priv->path, NULL, NULL);
+
 	_notify (self, PROP_PATH);
 
 	return priv->path;
 }
 
+static void _emit_queue_remove (NMExportedObject *self);
+
 /**
  * nm_exported_object_unexport:
  * @self: an #NMExportedObject
@@ -710,6 +1120,8 @@ nm_exported_object_unexport (NMExportedObject *self)
 
 	_LOGT ("unexport: \"%s\"", priv->path);
 
+	_journal_add (JOURNAL_KIND_REMOVED, priv->path, NULL, NULL);
+
 	if (priv->bus_mgr) {
 		nm_bus_manager_unregister_object (priv->bus_mgr, (GDBusObjectSkeleton *) self);
 		g_object_remove_weak_pointer ((GObject *) priv->bus_mgr, (gpointer *) &priv->bus_mgr);
@@ -722,7 +1134,7 @@ nm_exported_object_unexport (NMExportedObject *self)
 
 	g_clear_pointer (&priv->path, g_free);
 
-	nm_clear_g_source (&priv->notify_idle_id);
+	_emit_queue_remove (self);
 
 	_notify (self, PROP_PATH);
 }
@@ -777,6 +1189,45 @@ nm_exported_object_get_interface_by_type (NMExportedObject *self, GType interfac
 	return NULL;
 }
 
+/**
+ * nm_exported_object_get_properties:
+ * @self: an exported #NMExportedObject
+ * @interfaces: (allow-none): the D-Bus interfaces to include, or %NULL
+ *   or an empty list for all of them
+ *
+ * Returns: a floating #GVariant of type "a{sa{sv}}" with the properties
+ *   of the requested interfaces of @self, like GetManagedObjects() returns
+ *   them. The values are taken from the skeletons, which already hold them,
+ *   so no property of @self is read again.
+ */
+GVariant *
+nm_exported_object_get_properties (NMExportedObject *self, const char *const *interfaces)
+{
+	NMExportedObjectPrivate *priv;
+	GVariantBuilder builder;
+	guint i;
+
+	g_return_val_if_fail (NM_IS_EXPORTED_OBJECT (self), NULL);
+
+	priv = NM_EXPORTED_OBJECT_GET_PRIVATE (self);
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sa{sv}}"));
+	for (i = 0; i < priv->num_interfaces; i++) {
+		GDBusInterfaceSkeleton *interface = priv->interfaces[i].interface;
+		const char *name = g_dbus_interface_skeleton_get_info (interface)->name;
+
+		if (   interfaces
+		    && interfaces[0]
+		    && !g_strv_contains (interfaces, name))
+			continue;
+
+		g_variant_builder_add (&builder, "{s@a{sv}}",
+		                       name,
+		                       g_dbus_interface_skeleton_get_properties (interface));
+	}
+	return g_variant_builder_end (&builder);
+}
+
 /*****************************************************************************/
 
 void
@@ -789,6 +1240,7 @@ nm_exported_object_class_set_quitting (void)
 
 typedef struct {
 	const char *property_name;
+	GParamSpec *pspec;
 	GVariant *variant;
 } PendingNotifiesItem;
 
@@ -799,13 +1251,44 @@ _sort_pending_notifies (gconstpointer a, gconstpointer b, gpointer       user_da
 	               ((const PendingNotifiesItem *) b)->property_name);
 }
 
-static gboolean
-idle_emit_properties_changed (gpointer self)
+static GDBusPropertyInfo *
+_lookup_property_info (NMExportedObjectPrivate *priv, const char *dbus_property_name, InterfaceData **out_ifdata)
 {
-	NMExportedObjectPrivate *priv = NM_EXPORTED_OBJECT_GET_PRIVATE (NM_EXPORTED_OBJECT (self));
-	guint k;
+	guint i;
+
+	for (i = 0; i < priv->num_interfaces; i++) {
+		InterfaceData *ifdata = &priv->interfaces[i];
+		GDBusPropertyInfo *pinfo;
+
+		pinfo = g_dbus_interface_info_lookup_property (g_dbus_interface_skeleton_get_info (ifdata->interface),
+		                                               dbus_property_name);
+		if (pinfo) {
+			NM_SET_OUT (out_ifdata, ifdata);
+			return pinfo;
+		}
+	}
+	return NULL;
+}
+
+static GVariant *
+_property_to_variant (GObject *object, GParamSpec *pspec, const GVariantType *vtype)
+{
+	GValue value = G_VALUE_INIT;
+	GVariant *variant;
+
+	g_value_init (&value, pspec->value_type);
+	g_object_get_property (object, pspec->name, &value);
+	variant = g_dbus_gvalue_to_gvariant (&value, vtype);
+	g_value_unset (&value);
+	return variant;
+}
 
-	priv->notify_idle_id = 0;
+static void
+emit_properties_changed (NMExportedObject *self)
+{
+	NMExportedObjectPrivate *priv = NM_EXPORTED_OBJECT_GET_PRIVATE (self);
+	gs_unref_hashtable GHashTable *converted = NULL;
+	guint k;
 
 	for (k = 0; k < priv->num_interfaces; k++) {
 		InterfaceData *ifdata = &priv->interfaces[k];
@@ -829,12 +1312,35 @@ idle_emit_properties_changed (gpointer self)
 
 		i = 0;
 		g_hash_table_iter_init (&hash_iter, ifdata->pending_notifies);
-		while (g_hash_table_iter_next (&hash_iter, (gpointer) &values[i].property_name, (gpointer) &values[i].variant))
+		while (g_hash_table_iter_next (&hash_iter, (gpointer) &values[i].property_name, (gpointer) &values[i].pspec))
 			i++;
 		nm_assert (i == n);
 
 		g_qsort_with_data (values, n, sizeof (values[0]), _sort_pending_notifies, NULL);
 
+		/* convert the current values. A property that changed several times since
+		 * the last emission is converted only once, also if it is pending on
+		 * more than one interface. */
+		if (!converted) {
+			converted = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+			                                   NULL, (GDestroyNotify) g_variant_unref);
+		}
+		for (i = 0; i < n; i++) {
+			values[i].variant = g_hash_table_lookup (converted, values[i].pspec);
+			if (!values[i].variant) {
+				GDBusPropertyInfo *pinfo;
+
+				/* the property might be pending on interfaces that don't
+				 * have it, see nm_exported_object_notify(). */
+				pinfo = _lookup_property_info (priv, values[i].property_name, NULL);
+				nm_assert (pinfo);
+				values[i].variant = g_variant_ref_sink (_property_to_variant ((GObject *) self,
+				                                                              values[i].pspec,
+				                                                              G_VARIANT_TYPE (pinfo->signature)));
+				g_hash_table_insert (converted, values[i].pspec, values[i].variant);
+			}
+		}
+
 		g_variant_builder_init (&notifies, G_VARIANT_TYPE_VARDICT);
 		for (i = 0; i < n; i++)
 			g_variant_builder_add (&notifies, "{sv}", values[i].property_name, values[i].variant);
@@ -851,12 +1357,98 @@ idle_emit_properties_changed (gpointer self)
 
 		g_signal_emit (ifdata->interface, ifdata->property_changed_signal_id, 0, variant);
 
+		_journal_add (JOURNAL_KIND_CHANGED,
+		              priv->path,
+		              g_dbus_interface_skeleton_get_info (ifdata->interface)->name,
+		              variant);
+
 		g_hash_table_remove_all (ifdata->pending_notifies);
 	}
+}
+
+/*****************************************************************************/
+
+/* The objects with pending notifies. All of them are emitted together, by one
+ * idle handler, instead of one idle handler per object. Objects whose changes
+ * are only in rate-limited properties wait in the slow queue. */
+
+#define EMIT_RATE_LIMIT_MSEC 1000
+
+static struct {
+	GQueue fast;
+	GQueue slow;
+	guint fast_id;
+	guint slow_id;
+} emit_queue = {
+	.fast = G_QUEUE_INIT,
+	.slow = G_QUEUE_INIT,
+};
+
+static gboolean
+_emit_queue_cb (gpointer user_data)
+{
+	GQueue *queue = user_data;
+	GList *link;
+
+	if (queue == &emit_queue.fast)
+		emit_queue.fast_id = 0;
+	else
+		emit_queue.slow_id = 0;
+
+	while ((link = g_queue_pop_head_link (queue))) {
+		gs_unref_object NMExportedObject *self = g_object_ref (link->data);
+		NMExportedObjectPrivate *priv = NM_EXPORTED_OBJECT_GET_PRIVATE (self);
+
+		nm_assert (priv->notify_link == link);
+
+		priv->notify_link = NULL;
+		g_list_free_1 (link);
+		emit_properties_changed (self);
+	}
 
 	return G_SOURCE_REMOVE;
 }
 
+static void
+_emit_queue_add (NMExportedObject *self, gboolean rate_limited)
+{
+	NMExportedObjectPrivate *priv = NM_EXPORTED_OBJECT_GET_PRIVATE (self);
+
+	if (priv->notify_link) {
+		if (rate_limited || !priv->notify_slow)
+			return;
+		g_queue_unlink (&emit_queue.slow, priv->notify_link);
+		g_queue_push_tail_link (&emit_queue.fast, priv->notify_link);
+	} else {
+		priv->notify_link = g_list_alloc ();
+		priv->notify_link->data = self;
+		g_queue_push_tail_link (rate_limited ? &emit_queue.slow : &emit_queue.fast,
+		                        priv->notify_link);
+	}
+	priv->notify_slow = rate_limited;
+
+	if (rate_limited) {
+		if (!emit_queue.slow_id)
+			emit_queue.slow_id = g_timeout_add (EMIT_RATE_LIMIT_MSEC, _emit_queue_cb, &emit_queue.slow);
+	} else {
+		if (!emit_queue.fast_id)
+			emit_queue.fast_id = g_idle_add (_emit_queue_cb, &emit_queue.fast);
+	}
+}
+
+static void
+_emit_queue_remove (NMExportedObject *self)
+{
+	NMExportedObjectPrivate *priv = NM_EXPORTED_OBJECT_GET_PRIVATE (self);
+
+	if (!priv->notify_link)
+		return;
+
+	g_queue_delete_link (priv->notify_slow ? &emit_queue.slow : &emit_queue.fast,
+	                     priv->notify_link);
+	priv->notify_link = NULL;
+}
+
 static void
 nm_exported_object_notify (GObject *object, GParamSpec *pspec)
 {
@@ -865,10 +1457,8 @@ nm_exported_object_notify (GObject *object, GParamSpec *pspec)
 	NMExportedObjectClassInfo *classinfo;
 	GType type;
 	const char *dbus_property_name = NULL;
-	GValue value = G_VALUE_INIT;
-	GVariant *value_variant;
 	InterfaceData *ifdata = NULL;
-	const GVariantType *vtype;
+	gboolean rate_limited;
 	guint i, j;
 
 	/* Hook to emit deprecated "PropertiesChanged" signal on NetworkManager interfaces.
@@ -893,25 +1483,14 @@ nm_exported_object_notify (GObject *object, GParamSpec *pspec)
 		return;
 	}
 
-	for (i = 0; i < priv->num_interfaces; i++) {
-		GDBusInterfaceInfo *iinfo;
-
-		ifdata = &priv->interfaces[i];
-		iinfo = g_dbus_interface_skeleton_get_info (ifdata->interface);
-		for (j = 0; iinfo->properties[j]; j++) {
-			if (nm_streq (iinfo->properties[j]->name, dbus_property_name)) {
-				vtype = G_VARIANT_TYPE (iinfo->properties[j]->signature);
-				goto vtype_found;
-			}
-		}
-	}
-	g_return_if_reached ();
+	if (!_lookup_property_info (priv, dbus_property_name, &ifdata))
+		g_return_if_reached ();
 
-vtype_found:
-	g_value_init (&value, pspec->value_type);
-	g_object_get_property ((GObject *) self, pspec->name, &value);
-	value_variant = g_dbus_gvalue_to_gvariant (&value, vtype);
-	g_value_unset (&value);
+	rate_limited =    classinfo->rate_limited
+	               && g_hash_table_contains (classinfo->rate_limited, dbus_property_name);
+
+	/* only remember the property. The value is converted, when the signal
+	 * is emitted. */
 
 	if (   (   NM_IS_DEVICE (self)
 	        && !NMDBUS_IS_DEVICE_STATISTICS_SKELETON (ifdata->interface))
@@ -948,22 +1527,20 @@ vtype_found:
 				j++;
 				g_hash_table_insert (ifdata->pending_notifies,
 				                     (gpointer) dbus_property_name,
-				                     g_variant_ref (value_variant));
+				                     pspec);
 			}
 		}
 		nm_assert (j > 0);
-		g_variant_unref (value_variant);
 	} else if (ifdata->property_changed_signal_id) {
 		/* @dbus_property_name is inside classinfo and never freed, thus we don't clone it.
 		 * Also, we do a pointer, not string comparison. */
 		g_hash_table_insert (ifdata->pending_notifies,
 		                     (gpointer) dbus_property_name,
-		                     value_variant);
+		                     pspec);
 	} else
-		g_variant_unref (value_variant);
+		return;
 
-	if (!priv->notify_idle_id)
-		priv->notify_idle_id = g_idle_add (idle_emit_properties_changed, self);
+	_emit_queue_add (self, rate_limited);
 }
 
 /*****************************************************************************/
@@ -1001,6 +1578,11 @@ constructed (GObject *object)
 
 	G_OBJECT_CLASS (nm_exported_object_parent_class)->constructed (object);
 
+	if (accounting.enabled) {
+		NM_EXPORTED_OBJECT_GET_PRIVATE (NM_EXPORTED_OBJECT (object))->accounted = TRUE;
+		_accounting_count_object ((NMExportedObject *) object, TRUE);
+	}
+
 #ifdef _ASSERT_NO_EARLY_EXPORT
 	NM_EXPORTED_OBJECT_GET_PRIVATE (NM_EXPORTED_OBJECT (object))->_constructed = TRUE;
 #endif
@@ -1028,11 +1610,20 @@ dispose (GObject *object)
 	} else if (nm_clear_g_free (&priv->path))
 		_notify (self, PROP_PATH);
 
-	nm_clear_g_source (&priv->notify_idle_id);
+	_emit_queue_remove (self);
 
 	G_OBJECT_CLASS (nm_exported_object_parent_class)->dispose (object);
 }
 
+static void
+finalize (GObject *object)
+{
+	if (NM_EXPORTED_OBJECT_GET_PRIVATE (NM_EXPORTED_OBJECT (object))->accounted)
+		_accounting_count_object ((NMExportedObject *) object, FALSE);
+
+	G_OBJECT_CLASS (nm_exported_object_parent_class)->finalize (object);
+}
+
 static void
 nm_exported_object_class_init (NMExportedObjectClass *klass)
 {
@@ -1043,6 +1634,7 @@ nm_exported_object_class_init (NMExportedObjectClass *klass)
 	object_class->constructed = constructed;
 	object_class->notify = nm_exported_object_notify;
 	object_class->dispose = dispose;
+	object_class->finalize = finalize;
 	object_class->get_property = get_property;
 
 	obj_properties[PROP_PATH] =
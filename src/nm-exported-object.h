@@ -69,14 +69,29 @@ GType nm_exported_object_get_type (void);
 
 void nm_exported_object_class_set_quitting  (void);
 
+void nm_exported_object_class_set_memory_accounting (void);
+void nm_exported_object_memory_usage_foreach (NMMemoryUsageFunc func, gpointer user_data);
+
+void nm_exported_object_method_stats_add_auth (GDBusMethodInvocation *invocation,
+                                               guint64 duration_us);
+GVariant *nm_exported_object_method_stats_to_variant (void);
+
+GVariant *nm_exported_object_journal_get_changes_since (guint64 epoch, guint64 since);
+
 void nm_exported_object_class_add_interface (NMExportedObjectClass *object_class,
                                              GType                  dbus_skeleton_type,
                                              ...) G_GNUC_NULL_TERMINATED;
 
+void nm_exported_object_class_rate_limit_properties (NMExportedObjectClass *object_class,
+                                                     const char *dbus_property_name,
+                                                     ...) G_GNUC_NULL_TERMINATED;
+
 const char *nm_exported_object_export      (NMExportedObject *self);
 const char *nm_exported_object_get_path    (NMExportedObject *self);
 gboolean    nm_exported_object_is_exported (NMExportedObject *self);
 void        nm_exported_object_unexport    (NMExportedObject *self);
+GVariant *nm_exported_object_get_properties (NMExportedObject *self, const char *const *interfaces);
+
 GDBusInterfaceSkeleton *nm_exported_object_get_interface_by_type (NMExportedObject *self, GType interface_type);
 
 void        _nm_exported_object_clear_and_unexport (NMExportedObject **location);
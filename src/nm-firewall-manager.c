@@ -28,6 +28,12 @@
 
 /*****************************************************************************/
 
+/* Requests are not sent to firewalld right away but collected for this
+ * long, so that a burst of zone assignments (for example when many devices
+ * activate at once) is sent as one batch and superseded assignments for the
+ * same interface are dropped. */
+#define BATCH_WINDOW_MSEC 50
+
 NM_GOBJECT_PROPERTIES_DEFINE (NMFirewallManager,
 	PROP_AVAILABLE,
 );
@@ -44,6 +50,9 @@ typedef struct {
 	gboolean        running;
 
 	GHashTable     *pending_calls;
+
+	GQueue          batch_queue;
+	guint           batch_id;
 } NMFirewallManagerPrivate;
 
 struct _NMFirewallManager {
@@ -73,6 +82,7 @@ typedef enum {
 
 typedef enum {
 	CB_INFO_MODE_IDLE = 1,
+	CB_INFO_MODE_QUEUED,
 	CB_INFO_MODE_DBUS,
 	CB_INFO_MODE_DBUS_COMPLETED,
 } CBInfoMode;
@@ -82,6 +92,7 @@ struct _NMFirewallManagerCallId {
 	CBInfoOpsType ops_type;
 	CBInfoMode mode;
 	char *iface;
+	char *zone;
 	NMFirewallManagerAddRemoveCallback callback;
 	gpointer user_data;
 
@@ -150,6 +161,7 @@ static CBInfo *
 _cb_info_create (NMFirewallManager *self,
                  CBInfoOpsType ops_type,
                  const char *iface,
+                 const char *zone,
                  NMFirewallManagerAddRemoveCallback callback,
                  gpointer user_data)
 {
@@ -160,11 +172,12 @@ _cb_info_create (NMFirewallManager *self,
 	info->self = g_object_ref (self);
 	info->ops_type = ops_type;
 	info->iface = g_strdup (iface);
+	info->zone = g_strdup (zone);
 	info->callback = callback;
 	info->user_data = user_data;
 
 	if (priv->running) {
-		info->mode = CB_INFO_MODE_DBUS;
+		info->mode = CB_INFO_MODE_QUEUED;
 		info->dbus.cancellable = g_cancellable_new ();
 	} else
 		info->mode = CB_INFO_MODE_IDLE;
@@ -181,6 +194,7 @@ _cb_info_free (CBInfo *info)
 	if (!_cb_info_is_idle (info))
 		g_object_unref (info->dbus.cancellable);
 	g_free (info->iface);
+	g_free (info->zone);
 	if (info->self)
 		g_object_unref (info->self);
 	g_slice_free (CBInfo, info);
@@ -268,6 +282,96 @@ _handle_dbus (GObject *proxy, GAsyncResult *result, gpointer user_data)
 	_cb_info_complete_normal (info, error);
 }
 
+static void
+_cb_info_dispatch (CBInfo *info)
+{
+	NMFirewallManagerPrivate *priv = NM_FIREWALL_MANAGER_GET_PRIVATE (info->self);
+	const char *dbus_method;
+
+	nm_assert (info->mode == CB_INFO_MODE_QUEUED);
+
+	switch (info->ops_type) {
+	case CB_INFO_OPS_ADD:
+		dbus_method = "addInterface";
+		break;
+	case CB_INFO_OPS_CHANGE:
+		dbus_method = "changeZone";
+		break;
+	case CB_INFO_OPS_REMOVE:
+		dbus_method = "removeInterface";
+		break;
+	default:
+		g_assert_not_reached ();
+	}
+
+	info->mode = CB_INFO_MODE_DBUS;
+	g_dbus_proxy_call (priv->proxy,
+	                   dbus_method,
+	                   g_variant_new ("(ss)", info->zone ? info->zone : "", info->iface),
+	                   G_DBUS_CALL_FLAGS_NONE, 10000,
+	                   info->dbus.cancellable,
+	                   _handle_dbus,
+	                   info);
+}
+
+static gboolean
+_cb_info_is_zone_assignment (CBInfo *info)
+{
+	return NM_IN_SET (info->ops_type, CB_INFO_OPS_ADD, CB_INFO_OPS_CHANGE);
+}
+
+static gboolean
+_batch_flush_cb (gpointer user_data)
+{
+	NMFirewallManager *self = user_data;
+	NMFirewallManagerPrivate *priv = NM_FIREWALL_MANAGER_GET_PRIVATE (self);
+	CBInfo *info;
+	GList *iter;
+	guint n;
+
+	priv->batch_id = 0;
+
+	/* completing a request invokes callbacks, which might cancel queued
+	 * requests or queue new ones. New requests start the next batch. */
+	n = priv->batch_queue.length;
+
+	_LOGD (NULL, "dispatch batch of %u request(s)", n);
+
+	g_object_ref (self);
+	while (   n-- > 0
+	       && (info = g_queue_pop_head (&priv->batch_queue))) {
+		if (!priv->running) {
+			_LOGD (info, "complete: firewall stopped, simulate success");
+			_cb_info_complete_normal (info, NULL);
+			continue;
+		}
+
+		if (_cb_info_is_zone_assignment (info)) {
+			/* a later assignment for the same interface in this batch
+			 * overrides this one. Don't bother firewalld with it. */
+			for (iter = priv->batch_queue.head; iter; iter = iter->next) {
+				CBInfo *later = iter->data;
+
+				if (nm_streq (later->iface, info->iface)) {
+					if (!_cb_info_is_zone_assignment (later))
+						iter = NULL;
+					break;
+				}
+			}
+			if (iter) {
+				_LOGD (info, "complete: superseded by a later request");
+				_cb_info_complete_normal (info, NULL);
+				continue;
+			}
+		}
+
+		_cb_info_dispatch (info);
+	}
+	g_object_unref (self);
+
+	return G_SOURCE_REMOVE;
+}
+
 static NMFirewallManagerCallId
 _start_request (NMFirewallManager *self,
                 CBInfoOpsType ops_type,
@@ -278,14 +382,13 @@ _start_request (NMFirewallManager *self,
 {
 	NMFirewallManagerPrivate *priv;
 	CBInfo *info;
-	const char *dbus_method;
 
 	g_return_val_if_fail (NM_IS_FIREWALL_MANAGER (self), NULL);
 	g_return_val_if_fail (iface && *iface, NULL);
 
 	priv = NM_FIREWALL_MANAGER_GET_PRIVATE (self);
 
-	info = _cb_info_create (self, ops_type, iface, callback, user_data);
+	info = _cb_info_create (self, ops_type, iface, zone, callback, user_data);
 
 	_LOGD (info, "firewall zone %s %s:%s%s%s%s",
 	       _ops_type_to_string (info->ops_type),
@@ -295,27 +398,9 @@ _start_request (NMFirewallManager *self,
 
 	if (!_cb_info_is_idle (info)) {
 
-		switch (ops_type) {
-		case CB_INFO_OPS_ADD:
-			dbus_method = "addInterface";
-			break;
-		case CB_INFO_OPS_CHANGE:
-			dbus_method = "changeZone";
-			break;
-		case CB_INFO_OPS_REMOVE:
-			dbus_method = "removeInterface";
-			break;
-		default:
-			g_assert_not_reached ();
-		}
-
-		g_dbus_proxy_call (priv->proxy,
-		                   dbus_method,
-		                   g_variant_new ("(ss)", zone ? zone : "", iface),
-		                   G_DBUS_CALL_FLAGS_NONE, 10000,
-		                   info->dbus.cancellable,
-		                   _handle_dbus,
-		                   info);
+		g_queue_push_tail (&priv->batch_queue, info);
+		if (!priv->batch_id)
+			priv->batch_id = g_timeout_add (BATCH_WINDOW_MSEC, _batch_flush_cb, self);
 
 		if (!info->callback) {
 			/* if the user did not provide a callback, the call_id is useless.
@@ -396,6 +481,11 @@ nm_firewall_manager_cancel_call (NMFirewallManagerCallId call)
 	if (_cb_info_is_idle (info)) {
 		g_source_remove (info->idle.id);
 		_cb_info_free (info);
+	} else if (info->mode == CB_INFO_MODE_QUEUED) {
+		g_queue_remove (&priv->batch_queue, info);
+		if (g_queue_is_empty (&priv->batch_queue))
+			nm_clear_g_source (&priv->batch_id);
+		_cb_info_free (info);
 	} else {
 		info->mode = CB_INFO_MODE_DBUS_COMPLETED;
 		g_cancellable_cancel (info->dbus.cancellable);
@@ -503,6 +593,9 @@ dispose (GObject *object)
 		priv->pending_calls = NULL;
 	}
 
+	nm_assert (g_queue_is_empty (&priv->batch_queue));
+	nm_clear_g_source (&priv->batch_id);
+
 	g_clear_object (&priv->proxy);
 
 	G_OBJECT_CLASS (nm_firewall_manager_parent_class)->dispose (object);
@@ -51,52 +51,147 @@
 
 /*****************************************************************************/
 
-static struct {
-	GMainLoop *main_loop;
-	int ifindex;
-} gl/*obal*/ = {
-	.ifindex = -1,
-};
-
-static struct {
-	gboolean slaac;
-	gboolean show_version;
-	gboolean become_daemon;
-	gboolean debug;
-	gboolean g_fatal_warnings;
-	gboolean slaac_required;
-	gboolean dhcp4_required;
-	int tempaddr;
+/* the options that apply to one interface. Each "--ifname" on the command
+ * line starts a new interface, so that one helper process can take over
+ * many interfaces. */
+typedef struct {
 	char *ifname;
 	char *uuid;
 	char *stable_id;
+	gboolean slaac;
+	gboolean slaac_required;
+	int tempaddr;
 	char *dhcp4_address;
+	gboolean dhcp4_required;
 	char *dhcp4_clientid;
 	char *dhcp4_hostname;
 	char *dhcp4_fqdn;
 	char *iid_str;
 	NMSettingIP6ConfigAddrGenMode addr_gen_mode;
+	gint64 priority64_v4;
+	gint64 priority64_v6;
+} IfaceOpt;
+
+#define IFACE_OPT_INIT { \
+		.tempaddr = NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN, \
+		.priority64_v4 = -1, \
+		.priority64_v6 = -1, \
+	}
+
+typedef struct {
+	IfaceOpt opt;
+	int ifindex;
+	guint32 priority_v4;
+	guint32 priority_v6;
+	char *pidfile;
+
+	NMDhcpClient *dhcp4_client;
+	NMIP4Config *dhcp4_last_config;
+
+	NMNDisc *ndisc;
+	NMIP6Config *ndisc_config;
+	gulong ip6_address_changed_id;
+	guint stop_idle_id;
+
+	bool wrote_pidfile:1;
+	bool stopped:1;
+} Iface;
+
+static struct {
+	GMainLoop *main_loop;
+	GPtrArray *ifaces;
+	guint n_running;
+} gl/*obal*/;
+
+static struct {
+	gboolean show_version;
+	gboolean become_daemon;
+	gboolean debug;
+	gboolean g_fatal_warnings;
 	char *logging_backend;
 	char *opt_log_level;
 	char *opt_log_domains;
-	guint32 priority_v4;
-	guint32 priority_v6;
+
+	/* the options of the interface that is currently parsed. */
+	IfaceOpt iface;
+	GPtrArray *iface_opts;
 } global_opt = {
-	.tempaddr = NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN,
-	.priority_v4 = NM_PLATFORM_ROUTE_METRIC_DEFAULT_IP4,
-	.priority_v6 = NM_PLATFORM_ROUTE_METRIC_DEFAULT_IP6,
+	.iface = IFACE_OPT_INIT,
 };
 
 /*****************************************************************************/
 
 #define _NMLOG_PREFIX_NAME      "nm-iface-helper"
 #define _NMLOG(level, domain, ...) \
-    nm_log ((level), (domain), global_opt.ifname, NULL, \
+    nm_log ((level), (domain), iface ? iface->opt.ifname : NULL, NULL, \
             "iface-helper: " _NM_UTILS_MACRO_FIRST (__VA_ARGS__) \
             _NM_UTILS_MACRO_REST (__VA_ARGS__))
 
 /*****************************************************************************/
 
+static gboolean
+iface_stop_idle_cb (gpointer user_data)
+{
+	Iface *iface = user_data;
+
+	iface->stop_idle_id = 0;
+	if (iface->dhcp4_client) {
+		nm_dhcp_client_stop (iface->dhcp4_client, FALSE);
+		g_clear_object (&iface->dhcp4_client);
+	}
+	g_clear_object (&iface->ndisc);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+iface_stop (Iface *iface)
+{
+	if (iface->stopped)
+		return;
+	iface->stopped = TRUE;
+
+	if (iface->dhcp4_client)
+		g_signal_handlers_disconnect_by_data (iface->dhcp4_client, iface);
+	if (iface->ndisc)
+		g_signal_handlers_disconnect_by_data (iface->ndisc, iface);
+	nm_clear_g_signal_handler (NM_PLATFORM_GET, &iface->ip6_address_changed_id);
+
+	/* we are called from a signal of the DHCP client or ndisc instance.
+	 * Release them later. */
+	iface->stop_idle_id = g_idle_add (iface_stop_idle_cb, iface);
+
+	nm_assert (gl.n_running > 0);
+	if (--gl.n_running == 0)
+		g_main_loop_quit (gl.main_loop);
+}
+
+static void
+iface_free (Iface *iface)
+{
+	nm_clear_g_source (&iface->stop_idle_id);
+	g_clear_object (&iface->dhcp4_client);
+	g_clear_object (&iface->dhcp4_last_config);
+	g_clear_object (&iface->ndisc);
+	g_clear_object (&iface->ndisc_config);
+	nm_clear_g_signal_handler (NM_PLATFORM_GET, &iface->ip6_address_changed_id);
+
+	if (iface->pidfile && iface->wrote_pidfile)
+		unlink (iface->pidfile);
+	g_free (iface->pidfile);
+
+	g_free (iface->opt.ifname);
+	g_free (iface->opt.uuid);
+	g_free (iface->opt.stable_id);
+	g_free (iface->opt.dhcp4_address);
+	g_free (iface->opt.dhcp4_clientid);
+	g_free (iface->opt.dhcp4_hostname);
+	g_free (iface->opt.dhcp4_fqdn);
+	g_free (iface->opt.iid_str);
+	g_slice_free (Iface, iface);
+}
+
+/*****************************************************************************/
+
 static void
 dhcp4_state_changed (NMDhcpClient *client,
                      NMDhcpState state,
@@ -105,7 +200,7 @@ dhcp4_state_changed (NMDhcpClient *client,
                      const char *event_id,
                      gpointer user_data)
 {
-	static NMIP4Config *last_config = NULL;
+	Iface *iface = user_data;
 	NMIP4Config *existing;
 
 	g_return_if_fail (!ip4_config || NM_IS_IP4_CONFIG (ip4_config));
@@ -115,25 +210,25 @@ dhcp4_state_changed (NMDhcpClient *client,
 	switch (state) {
 	case NM_DHCP_STATE_BOUND:
 		g_assert (ip4_config);
-		existing = nm_ip4_config_capture (gl.ifindex, FALSE);
-		if (last_config)
-			nm_ip4_config_subtract (existing, last_config);
+		existing = nm_ip4_config_capture (iface->ifindex, FALSE);
+		if (iface->dhcp4_last_config)
+			nm_ip4_config_subtract (existing, iface->dhcp4_last_config);
 
 		nm_ip4_config_merge (existing, ip4_config, NM_IP_CONFIG_MERGE_DEFAULT);
-		if (!nm_ip4_config_commit (existing, gl.ifindex, TRUE, global_opt.priority_v4))
+		if (!nm_ip4_config_commit (existing, iface->ifindex, TRUE, iface->priority_v4))
 			_LOGW (LOGD_DHCP4, "failed to apply DHCPv4 config");
 
-		if (last_config)
-			g_object_unref (last_config);
-		last_config = nm_ip4_config_new (nm_dhcp_client_get_ifindex (client));
-		nm_ip4_config_replace (last_config, ip4_config, NULL);
+		if (iface->dhcp4_last_config)
+			g_object_unref (iface->dhcp4_last_config);
+		iface->dhcp4_last_config = nm_ip4_config_new (nm_dhcp_client_get_ifindex (client));
+		nm_ip4_config_replace (iface->dhcp4_last_config, ip4_config, NULL);
 		break;
 	case NM_DHCP_STATE_TIMEOUT:
 	case NM_DHCP_STATE_DONE:
 	case NM_DHCP_STATE_FAIL:
-		if (global_opt.dhcp4_required) {
-			_LOGW (LOGD_DHCP4, "DHCPv4 timed out or failed, quitting...");
-			g_main_loop_quit (gl.main_loop);
+		if (iface->opt.dhcp4_required) {
+			_LOGW (LOGD_DHCP4, "DHCPv4 timed out or failed, stop managing the interface...");
+			iface_stop (iface);
 		} else
 			_LOGW (LOGD_DHCP4, "DHCPv4 timed out or failed");
 		break;
@@ -145,8 +240,8 @@ dhcp4_state_changed (NMDhcpClient *client,
 static void
 ndisc_config_changed (NMNDisc *ndisc, const NMNDiscData *rdata, guint changed_int, gpointer user_data)
 {
+	Iface *iface = user_data;
 	NMNDiscConfigMap changed = changed_int;
-	static NMIP6Config *ndisc_config = NULL;
 	NMIP6Config *existing;
 	int system_support;
 	guint32 ifa_flags = 0x00;
@@ -163,30 +258,30 @@ ndisc_config_changed (NMNDisc *ndisc, const NMNDiscData *rdata, guint changed_in
 
 	if (system_support)
 		ifa_flags = IFA_F_NOPREFIXROUTE;
-	if (global_opt.tempaddr == NM_SETTING_IP6_CONFIG_PRIVACY_PREFER_TEMP_ADDR
-	    || global_opt.tempaddr == NM_SETTING_IP6_CONFIG_PRIVACY_PREFER_PUBLIC_ADDR)
+	if (iface->opt.tempaddr == NM_SETTING_IP6_CONFIG_PRIVACY_PREFER_TEMP_ADDR
+	    || iface->opt.tempaddr == NM_SETTING_IP6_CONFIG_PRIVACY_PREFER_PUBLIC_ADDR)
 	{
 		/* without system_support, this flag will be ignored. Still set it, doesn't seem to do any harm. */
 		ifa_flags |= IFA_F_MANAGETEMPADDR;
 	}
 
-	existing = nm_ip6_config_capture (gl.ifindex, FALSE, global_opt.tempaddr);
-	if (ndisc_config)
-		nm_ip6_config_subtract (existing, ndisc_config);
+	existing = nm_ip6_config_capture (iface->ifindex, FALSE, iface->opt.tempaddr);
+	if (iface->ndisc_config)
+		nm_ip6_config_subtract (existing, iface->ndisc_config);
 	else
-		ndisc_config = nm_ip6_config_new (gl.ifindex);
+		iface->ndisc_config = nm_ip6_config_new (iface->ifindex);
 
 	if (changed & NM_NDISC_CONFIG_GATEWAYS) {
 		/* Use the first gateway as ordered in neighbor discovery cache. */
 		if (rdata->gateways_n)
-			nm_ip6_config_set_gateway (ndisc_config, &rdata->gateways[0].address);
+			nm_ip6_config_set_gateway (iface->ndisc_config, &rdata->gateways[0].address);
 		else
-			nm_ip6_config_set_gateway (ndisc_config, NULL);
+			nm_ip6_config_set_gateway (iface->ndisc_config, NULL);
 	}
 
 	if (changed & NM_NDISC_CONFIG_ADDRESSES) {
 		/* Rebuild address list from neighbor discovery cache. */
-		nm_ip6_config_reset_addresses (ndisc_config);
+		nm_ip6_config_reset_addresses (iface->ndisc_config);
 
 		/* ndisc->addresses contains at most max_addresses entries.
 		 * This is different from what the kernel does, which
@@ -208,13 +303,13 @@ ndisc_config_changed (NMNDisc *ndisc, const NMNDiscData *rdata, guint changed_in
 			address.addr_source = NM_IP_CONFIG_SOURCE_NDISC;
 			address.n_ifa_flags = ifa_flags;
 
-			nm_ip6_config_add_address (ndisc_config, &address);
+			nm_ip6_config_add_address (iface->ndisc_config, &address);
 		}
 	}
 
 	if (changed & NM_NDISC_CONFIG_ROUTES) {
 		/* Rebuild route list from neighbor discovery cache. */
-		nm_ip6_config_reset_routes (ndisc_config);
+		nm_ip6_config_reset_routes (iface->ndisc_config);
 
 		for (i = 0; i < rdata->routes_n; i++) {
 			const NMNDiscRoute *discovered_route = &rdata->routes[i];
@@ -223,10 +318,10 @@ ndisc_config_changed (NMNDisc *ndisc, const NMNDiscData *rdata, guint changed_in
 				.plen       = discovered_route->plen,
 				.gateway    = discovered_route->gateway,
 				.rt_source  = NM_IP_CONFIG_SOURCE_NDISC,
-				.metric     = global_opt.priority_v6,
+				.metric     = iface->priority_v6,
 			};
 
-			nm_ip6_config_add_route (ndisc_config, &route);
+			nm_ip6_config_add_route (iface->ndisc_config, &route);
 		}
 	}
 
@@ -235,26 +330,28 @@ ndisc_config_changed (NMNDisc *ndisc, const NMNDiscData *rdata, guint changed_in
 	}
 
 	if (changed & NM_NDISC_CONFIG_HOP_LIMIT)
-		nm_platform_sysctl_set_ip6_hop_limit_safe (NM_PLATFORM_GET, global_opt.ifname, rdata->hop_limit);
+		nm_platform_sysctl_set_ip6_hop_limit_safe (NM_PLATFORM_GET, iface->opt.ifname, rdata->hop_limit);
 
 	if (changed & NM_NDISC_CONFIG_MTU) {
 		char val[16];
 
 		g_snprintf (val, sizeof (val), "%d", rdata->mtu);
-		nm_platform_sysctl_set (NM_PLATFORM_GET, NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_ip6_property_path (global_opt.ifname, "mtu")), val);
+		nm_platform_sysctl_set (NM_PLATFORM_GET, NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_ip6_property_path (iface->opt.ifname, "mtu")), val);
 	}
 
-	nm_ip6_config_merge (existing, ndisc_config, NM_IP_CONFIG_MERGE_DEFAULT);
-	if (!nm_ip6_config_commit (existing, gl.ifindex, TRUE))
+	nm_ip6_config_merge (existing, iface->ndisc_config, NM_IP_CONFIG_MERGE_DEFAULT);
+	if (!nm_ip6_config_commit (existing, iface->ifindex, TRUE))
 		_LOGW (LOGD_IP6, "failed to apply IPv6 config");
 }
 
 static void
 ndisc_ra_timeout (NMNDisc *ndisc, gpointer user_data)
 {
-	if (global_opt.slaac_required) {
-		_LOGW (LOGD_IP6, "IPv6 timed out or failed, quitting...");
-		g_main_loop_quit (gl.main_loop);
+	Iface *iface = user_data;
+
+	if (iface->opt.slaac_required) {
+		_LOGW (LOGD_IP6, "IPv6 timed out or failed, stop managing the interface...");
+		iface_stop (iface);
 	} else
 		_LOGW (LOGD_IP6, "IPv6 timed out or failed");
 }
@@ -274,28 +371,63 @@ setup_signals (void)
 	g_unix_signal_add (SIGTERM, quit_handler, NULL);
 }
 
+static void
+iface_opt_commit (void)
+{
+	IfaceOpt *opt = &global_opt.iface;
+	IfaceOpt *copy;
+
+	/* GOption owns the strings that it parsed and frees them when an
+	 * option is given again for the next interface. Copy them. */
+	copy = g_slice_new (IfaceOpt);
+	*copy = *opt;
+	copy->uuid = g_strdup (opt->uuid);
+	copy->stable_id = g_strdup (opt->stable_id);
+	copy->dhcp4_address = g_strdup (opt->dhcp4_address);
+	copy->dhcp4_clientid = g_strdup (opt->dhcp4_clientid);
+	copy->dhcp4_hostname = g_strdup (opt->dhcp4_hostname);
+	copy->dhcp4_fqdn = g_strdup (opt->dhcp4_fqdn);
+	copy->iid_str = g_strdup (opt->iid_str);
+	g_ptr_array_add (global_opt.iface_opts, copy);
+
+	*opt = (IfaceOpt) IFACE_OPT_INIT;
+}
+
+static gboolean
+iface_opt_ifname_cb (const char *option_name,
+                     const char *value,
+                     gpointer data,
+                     GError **error)
+{
+	/* options given before the first "--ifname" belong to the first
+	 * interface, like when managing only a single one. */
+	if (global_opt.iface.ifname)
+		iface_opt_commit ();
+	global_opt.iface.ifname = g_strdup (value);
+	return TRUE;
+}
+
 static gboolean
 do_early_setup (int *argc, char **argv[])
 {
-	gint64 priority64_v4 = -1;
-	gint64 priority64_v6 = -1;
+	IfaceOpt *iface_opt = &global_opt.iface;
 	GOptionEntry options[] = {
 		/* Interface/IP config */
-		{ "ifname", 'i', 0, G_OPTION_ARG_STRING, &global_opt.ifname, N_("The interface to manage"), "eth0" },
-		{ "uuid", 'u', 0, G_OPTION_ARG_STRING, &global_opt.uuid, N_("Connection UUID"),  "661e8cd0-b618-46b8-9dc9-31a52baaa16b" },
-		{ "stable-id", '\0', 0, G_OPTION_ARG_STRING, &global_opt.stable_id, N_("Connection Token for Stable IDs"),  "eth" },
-		{ "slaac", 's', 0, G_OPTION_ARG_NONE, &global_opt.slaac, N_("Whether to manage IPv6 SLAAC"), NULL },
-		{ "slaac-required", '6', 0, G_OPTION_ARG_NONE, &global_opt.slaac_required, N_("Whether SLAAC must be successful"), NULL },
-		{ "slaac-tempaddr", 't', 0, G_OPTION_ARG_INT, &global_opt.tempaddr, N_("Use an IPv6 temporary privacy address"), NULL },
-		{ "dhcp4", 'd', 0, G_OPTION_ARG_STRING, &global_opt.dhcp4_address, N_("Current DHCPv4 address"), NULL },
-		{ "dhcp4-required", '4', 0, G_OPTION_ARG_NONE, &global_opt.dhcp4_required, N_("Whether DHCPv4 must be successful"), NULL },
-		{ "dhcp4-clientid", 'c', 0, G_OPTION_ARG_STRING, &global_opt.dhcp4_clientid, N_("Hex-encoded DHCPv4 client ID"), NULL },
-		{ "dhcp4-hostname", 'h', 0, G_OPTION_ARG_STRING, &global_opt.dhcp4_hostname, N_("Hostname to send to DHCP server"), N_("barbar") },
-		{ "dhcp4-fqdn",     'F', 0, G_OPTION_ARG_STRING, &global_opt.dhcp4_fqdn, N_("FQDN to send to DHCP server"), N_("host.domain.org") },
-		{ "priority4", '\0', 0, G_OPTION_ARG_INT64, &priority64_v4, N_("Route priority for IPv4"), N_("0") },
-		{ "priority6", '\0', 0, G_OPTION_ARG_INT64, &priority64_v6, N_("Route priority for IPv6"), N_("1024") },
-		{ "iid", 'e', 0, G_OPTION_ARG_STRING, &global_opt.iid_str, N_("Hex-encoded Interface Identifier"), "" },
-		{ "addr-gen-mode", 'e', 0, G_OPTION_ARG_INT, &global_opt.addr_gen_mode, N_("IPv6 SLAAC address generation mode"), "eui64" },
+		{ "ifname", 'i', 0, G_OPTION_ARG_CALLBACK, iface_opt_ifname_cb, N_("The interface to manage. Can be repeated, the following options apply to that interface"), "eth0" },
+		{ "uuid", 'u', 0, G_OPTION_ARG_STRING, &iface_opt->uuid, N_("Connection UUID"),  "661e8cd0-b618-46b8-9dc9-31a52baaa16b" },
+		{ "stable-id", '\0', 0, G_OPTION_ARG_STRING, &iface_opt->stable_id, N_("Connection Token for Stable IDs"),  "eth" },
+		{ "slaac", 's', 0, G_OPTION_ARG_NONE, &iface_opt->slaac, N_("Whether to manage IPv6 SLAAC"), NULL },
+		{ "slaac-required", '6', 0, G_OPTION_ARG_NONE, &iface_opt->slaac_required, N_("Whether SLAAC must be successful"), NULL },
+		{ "slaac-tempaddr", 't', 0, G_OPTION_ARG_INT, &iface_opt->tempaddr, N_("Use an IPv6 temporary privacy address"), NULL },
+		{ "dhcp4", 'd', 0, G_OPTION_ARG_STRING, &iface_opt->dhcp4_address, N_("Current DHCPv4 address"), NULL },
+		{ "dhcp4-required", '4', 0, G_OPTION_ARG_NONE, &iface_opt->dhcp4_required, N_("Whether DHCPv4 must be successful"), NULL },
+		{ "dhcp4-clientid", 'c', 0, G_OPTION_ARG_STRING, &iface_opt->dhcp4_clientid, N_("Hex-encoded DHCPv4 client ID"), NULL },
+		{ "dhcp4-hostname", 'h', 0, G_OPTION_ARG_STRING, &iface_opt->dhcp4_hostname, N_("Hostname to send to DHCP server"), N_("barbar") },
+		{ "dhcp4-fqdn",     'F', 0, G_OPTION_ARG_STRING, &iface_opt->dhcp4_fqdn, N_("FQDN to send to DHCP server"), N_("host.domain.org") },
+		{ "priority4", '\0', 0, G_OPTION_ARG_INT64, &iface_opt->priority64_v4, N_("Route priority for IPv4"), N_("0") },
+		{ "priority6", '\0', 0, G_OPTION_ARG_INT64, &iface_opt->priority64_v6, N_("Route priority for IPv6"), N_("1024") },
+		{ "iid", 'e', 0, G_OPTION_ARG_STRING, &iface_opt->iid_str, N_("Hex-encoded Interface Identifier"), "" },
+		{ "addr-gen-mode", 'e', 0, G_OPTION_ARG_INT, &iface_opt->addr_gen_mode, N_("IPv6 SLAAC address generation mode"), "eui64" },
 		{ "logging-backend", '\0', 0, G_OPTION_ARG_STRING, &global_opt.logging_backend, N_("The logging backend configuration value. See logging.backend in NetworkManager.conf"), NULL },
 
 		/* Logging/debugging */
@@ -310,51 +442,148 @@ do_early_setup (int *argc, char **argv[])
 		{NULL}
 	};
 
+	global_opt.iface_opts = g_ptr_array_new ();
+
 	if (!nm_main_utils_early_setup ("nm-iface-helper",
 	                                argc,
 	                                argv,
 	                                options,
 	                                NULL,
 	                                NULL,
-	                                _("nm-iface-helper is a small, standalone process that manages a single network interface.")))
+	                                _("nm-iface-helper is a small, standalone process that manages network interfaces.")))
 		return FALSE;
 
-	if (priority64_v4 >= 0 && priority64_v4 <= G_MAXUINT32)
-		global_opt.priority_v4 = (guint32) priority64_v4;
-	if (priority64_v6 >= 0 && priority64_v6 <= G_MAXUINT32)
-		global_opt.priority_v6 = (guint32) priority64_v6;
+	if (global_opt.iface.ifname)
+		iface_opt_commit ();
 	return TRUE;
 }
 
 static void
 ip6_address_changed (NMPlatform *platform,
                      int obj_type_i,
-                     int iface,
+                     int ifindex,
                      NMPlatformIP6Address *addr,
                      int change_type_i,
-                     NMNDisc *ndisc)
+                     Iface *iface)
 {
 	const NMPlatformSignalChangeType change_type = change_type_i;
 
+	if (ifindex != iface->ifindex)
+		return;
+
 	if (   (change_type == NM_PLATFORM_SIGNAL_CHANGED && addr->n_ifa_flags & IFA_F_DADFAILED)
 	    || (change_type == NM_PLATFORM_SIGNAL_REMOVED && addr->n_ifa_flags & IFA_F_TENTATIVE))
-		nm_ndisc_dad_failed (ndisc, &addr->address);
+		nm_ndisc_dad_failed (iface->ndisc, &addr->address);
 }
 
-int
-main (int argc, char *argv[])
+static gboolean
+iface_start (Iface *iface)
 {
-	char *bad_domains = NULL;
-	GError *error = NULL;
-	gboolean wrote_pidfile = FALSE;
-	gs_free char *pidfile = NULL;
-	gs_unref_object NMDhcpClient *dhcp4_client = NULL;
-	gs_unref_object NMNDisc *ndisc = NULL;
 	GByteArray *hwaddr = NULL;
 	size_t hwaddr_len = 0;
 	gconstpointer tmp;
 	gs_free NMUtilsIPv6IfaceId *iid = NULL;
+
+	if (iface->opt.iid_str) {
+		GBytes *bytes;
+		gsize ignored = 0;
+
+		bytes = nm_utils_hexstr2bin (iface->opt.iid_str);
+		if (!bytes || g_bytes_get_size (bytes) != sizeof (*iid)) {
+			fprintf (stderr, _("(%s): Invalid IID %s\n"), iface->opt.ifname, iface->opt.iid_str);
+			return FALSE;
+		}
+		iid = g_bytes_unref_to_data (bytes, &ignored);
+	}
+
+	tmp = nm_platform_link_get_address (NM_PLATFORM_GET, iface->ifindex, &hwaddr_len);
+	if (tmp) {
+		hwaddr = g_byte_array_sized_new (hwaddr_len);
+		g_byte_array_append (hwaddr, tmp, hwaddr_len);
+	}
+
+	if (iface->opt.dhcp4_address) {
+		nm_platform_sysctl_set (NM_PLATFORM_GET, NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_ip4_property_path (iface->opt.ifname, "promote_secondaries")), "1");
+
+		iface->dhcp4_client = nm_dhcp_manager_start_ip4 (nm_dhcp_manager_get (),
+		                                                 iface->opt.ifname,
+		                                                 iface->ifindex,
+		                                                 hwaddr,
+		                                                 iface->opt.uuid,
+		                                                 iface->priority_v4,
+		                                                 !!iface->opt.dhcp4_hostname,
+		                                                 iface->opt.dhcp4_hostname,
+		                                                 iface->opt.dhcp4_fqdn,
+		                                                 iface->opt.dhcp4_clientid,
+		                                                 45,
+		                                                 NULL,
+		                                                 iface->opt.dhcp4_address);
+		g_assert (iface->dhcp4_client);
+		g_signal_connect (iface->dhcp4_client,
+		                  NM_DHCP_CLIENT_SIGNAL_STATE_CHANGED,
+		                  G_CALLBACK (dhcp4_state_changed),
+		                  iface);
+	}
+
+	if (iface->opt.slaac) {
+		NMUtilsStableType stable_type = NM_UTILS_STABLE_TYPE_UUID;
+		const char *stable_id = iface->opt.uuid;
+
+		nm_platform_link_set_user_ipv6ll_enabled (NM_PLATFORM_GET, iface->ifindex, TRUE);
+
+		if (   iface->opt.stable_id
+		    && (iface->opt.stable_id[0] >= '0' && iface->opt.stable_id[0] <= '9')
+		    && iface->opt.stable_id[1] == ' ') {
+			/* strict parsing of --stable-id, which is the numeric stable-type
+			 * and the ID, joined with one space. For now, only support stable-types
+			 * from 0 to 9. */
+			stable_type = (iface->opt.stable_id[0] - '0');
+			stable_id = &iface->opt.stable_id[2];
+		}
+		iface->ndisc = nm_lndp_ndisc_new (NM_PLATFORM_GET, iface->ifindex, iface->opt.ifname,
+		                                  stable_type, stable_id,
+		                                  iface->opt.addr_gen_mode,
+		                                  NM_NDISC_NODE_TYPE_HOST,
+		                                  NULL);
+		g_assert (iface->ndisc);
+
+		if (iid)
+			nm_ndisc_set_iid (iface->ndisc, *iid);
+
+		nm_platform_sysctl_set (NM_PLATFORM_GET, NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_ip6_property_path (iface->opt.ifname, "accept_ra")), "1");
+		nm_platform_sysctl_set (NM_PLATFORM_GET, NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_ip6_property_path (iface->opt.ifname, "accept_ra_defrtr")), "0");
+		nm_platform_sysctl_set (NM_PLATFORM_GET, NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_ip6_property_path (iface->opt.ifname, "accept_ra_pinfo")), "0");
+		nm_platform_sysctl_set (NM_PLATFORM_GET, NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_ip6_property_path (iface->opt.ifname, "accept_ra_rtr_pref")), "0");
+
+		iface->ip6_address_changed_id = g_signal_connect (NM_PLATFORM_GET,
+		                                                  NM_PLATFORM_SIGNAL_IP6_ADDRESS_CHANGED,
+		                                                  G_CALLBACK (ip6_address_changed),
+		                                                  iface);
+		g_signal_connect (iface->ndisc,
+		                  NM_NDISC_CONFIG_RECEIVED,
+		                  G_CALLBACK (ndisc_config_changed),
+		                  iface);
+		g_signal_connect (iface->ndisc,
+		                  NM_NDISC_RA_TIMEOUT,
+		                  G_CALLBACK (ndisc_ra_timeout),
+		                  iface);
+		nm_ndisc_start (iface->ndisc);
+	}
+
+	g_clear_pointer (&hwaddr, g_byte_array_unref);
+	return TRUE;
+}
+
+int
+main (int argc, char *argv[])
+{
+	char *bad_domains = NULL;
+	GError *error = NULL;
+	gs_free int *ifindexes = NULL;
+	gs_free char *log_ifname = NULL;
+	Iface *iface = NULL;
 	guint sd_id;
+	guint i;
 
 	nm_g_type_init ();
 
@@ -363,11 +592,18 @@ main (int argc, char *argv[])
 	if (!do_early_setup (&argc, &argv))
 		return 1;
 
+	if (global_opt.iface_opts->len > 1) {
+		log_ifname = g_strdup_printf ("%s+%u",
+		                              ((IfaceOpt *) global_opt.iface_opts->pdata[0])->ifname,
+		                              global_opt.iface_opts->len - 1);
+	} else if (global_opt.iface_opts->len == 1)
+		log_ifname = g_strdup (((IfaceOpt *) global_opt.iface_opts->pdata[0])->ifname);
+
 	nm_logging_set_syslog_identifier ("nm-iface-helper");
 	nm_logging_set_prefix ("%s[%ld] (%s): ",
 	                       _NMLOG_PREFIX_NAME,
 	                       (long) getpid (),
-	                       global_opt.ifname ?: "???");
+	                       log_ifname ?: "???");
 
 	if (global_opt.g_fatal_warnings) {
 		GLogLevelFlags fatal_mask;
@@ -384,18 +620,49 @@ main (int argc, char *argv[])
 
 	nm_main_utils_ensure_root ();
 
-	if (!global_opt.ifname || !global_opt.uuid) {
+	if (!global_opt.iface_opts->len) {
 		fprintf (stderr, _("An interface name and UUID are required\n"));
 		return 1;
 	}
 
-	gl.ifindex = nmp_utils_if_nametoindex (global_opt.ifname);
-	if (gl.ifindex <= 0) {
-		fprintf (stderr, _("Failed to find interface index for %s (%s)\n"), global_opt.ifname, strerror (errno));
-		return 1;
+	gl.ifaces = g_ptr_array_new_with_free_func ((GDestroyNotify) iface_free);
+	ifindexes = g_new0 (int, global_opt.iface_opts->len + 1);
+
+	for (i = 0; i < global_opt.iface_opts->len; i++) {
+		IfaceOpt *opt = global_opt.iface_opts->pdata[i];
+
+		iface = g_slice_new0 (Iface);
+		iface->opt = *opt;
+		g_slice_free (IfaceOpt, opt);
+		g_ptr_array_add (gl.ifaces, iface);
+
+		if (!iface->opt.ifname || !iface->opt.uuid) {
+			fprintf (stderr, _("An interface name and UUID are required\n"));
+			return 1;
+		}
+
+		iface->ifindex = nmp_utils_if_nametoindex (iface->opt.ifname);
+		if (iface->ifindex <= 0) {
+			fprintf (stderr, _("Failed to find interface index for %s (%s)\n"), iface->opt.ifname, strerror (errno));
+			return 1;
+		}
+		ifindexes[i] = iface->ifindex;
+
+		iface->priority_v4 = NM_PLATFORM_ROUTE_METRIC_DEFAULT_IP4;
+		if (iface->opt.priority64_v4 >= 0 && iface->opt.priority64_v4 <= G_MAXUINT32)
+			iface->priority_v4 = (guint32) iface->opt.priority64_v4;
+		iface->priority_v6 = NM_PLATFORM_ROUTE_METRIC_DEFAULT_IP6;
+		if (iface->opt.priority64_v6 >= 0 && iface->opt.priority64_v6 <= G_MAXUINT32)
+			iface->priority_v6 = (guint32) iface->opt.priority64_v6;
+
+		iface->pidfile = g_strdup_printf (NMIH_PID_FILE_FMT, iface->ifindex);
+		nm_main_utils_ensure_not_running_pidfile (iface->pidfile);
 	}
-	pidfile = g_strdup_printf (NMIH_PID_FILE_FMT, gl.ifindex);
-	nm_main_utils_ensure_not_running_pidfile (pidfile);
+	g_clear_pointer (&global_opt.iface_opts, g_ptr_array_unref);
+
+	/* when managing only one interface, log messages that are not
+	 * about a particular interface with that interface's name. */
+	iface = gl.ifaces->len == 1 ? gl.ifaces->pdata[0] : NULL;
 
 	nm_main_utils_ensure_rundir ();
 
@@ -424,8 +691,12 @@ main (int argc, char *argv[])
 			         saved_errno);
 			return 1;
 		}
-		if (nm_main_utils_write_pidfile (pidfile))
-			wrote_pidfile = TRUE;
+		for (i = 0; i < gl.ifaces->len; i++) {
+			Iface *iface_i = gl.ifaces->pdata[i];
+
+			if (nm_main_utils_write_pidfile (iface_i->pidfile))
+				iface_i->wrote_pidfile = TRUE;
+		}
 	}
 
 	/* Set up unix signal handling - before creating threads, but after daemonizing! */
@@ -437,106 +708,24 @@ main (int argc, char *argv[])
 
 	_LOGI (LOGD_CORE, "nm-iface-helper (version " NM_DIST_VERSION ") is starting...");
 
-	/* Set up platform interaction layer */
-	nm_linux_platform_setup ();
-
-	tmp = nm_platform_link_get_address (NM_PLATFORM_GET, gl.ifindex, &hwaddr_len);
-	if (tmp) {
-		hwaddr = g_byte_array_sized_new (hwaddr_len);
-		g_byte_array_append (hwaddr, tmp, hwaddr_len);
-	}
+	/* Set up platform interaction layer. The platform cache only needs to
+	 * know about the interfaces that we manage. */
+	nm_linux_platform_setup_filtered (ifindexes);
 
-	if (global_opt.iid_str) {
-		GBytes *bytes;
-		gsize ignored = 0;
-
-		bytes = nm_utils_hexstr2bin (global_opt.iid_str);
-		if (!bytes || g_bytes_get_size (bytes) != sizeof (*iid)) {
-			fprintf (stderr, _("(%s): Invalid IID %s\n"), global_opt.ifname, global_opt.iid_str);
+	for (i = 0; i < gl.ifaces->len; i++) {
+		if (!iface_start (gl.ifaces->pdata[i]))
 			return 1;
-		}
-		iid = g_bytes_unref_to_data (bytes, &ignored);
-	}
-
-	if (global_opt.dhcp4_address) {
-		nm_platform_sysctl_set (NM_PLATFORM_GET, NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_ip4_property_path (global_opt.ifname, "promote_secondaries")), "1");
-
-		dhcp4_client = nm_dhcp_manager_start_ip4 (nm_dhcp_manager_get (),
-		                                          global_opt.ifname,
-		                                          gl.ifindex,
-		                                          hwaddr,
-		                                          global_opt.uuid,
-		                                          global_opt.priority_v4,
-		                                          !!global_opt.dhcp4_hostname,
-		                                          global_opt.dhcp4_hostname,
-		                                          global_opt.dhcp4_fqdn,
-		                                          global_opt.dhcp4_clientid,
-		                                          45,
-		                                          NULL,
-		                                          global_opt.dhcp4_address);
-		g_assert (dhcp4_client);
-		g_signal_connect (dhcp4_client,
-		                  NM_DHCP_CLIENT_SIGNAL_STATE_CHANGED,
-		                  G_CALLBACK (dhcp4_state_changed),
-		                  NULL);
-	}
-
-	if (global_opt.slaac) {
-		NMUtilsStableType stable_type = NM_UTILS_STABLE_TYPE_UUID;
-		const char *stable_id = global_opt.uuid;
-
-		nm_platform_link_set_user_ipv6ll_enabled (NM_PLATFORM_GET, gl.ifindex, TRUE);
-
-		if (   global_opt.stable_id
-		    && (global_opt.stable_id[0] >= '0' && global_opt.stable_id[0] <= '9')
-		    && global_opt.stable_id[1] == ' ') {
-			/* strict parsing of --stable-id, which is the numeric stable-type
-			 * and the ID, joined with one space. For now, only support stable-types
-			 * from 0 to 9. */
-			stable_type = (global_opt.stable_id[0] - '0');
-			stable_id = &global_opt.stable_id[2];
-		}
-		ndisc = nm_lndp_ndisc_new (NM_PLATFORM_GET, gl.ifindex, global_opt.ifname,
-		                           stable_type, stable_id,
-		                           global_opt.addr_gen_mode,
-		                           NM_NDISC_NODE_TYPE_HOST,
-		                           NULL);
-		g_assert (ndisc);
-
-		if (iid)
-			nm_ndisc_set_iid (ndisc, *iid);
-
-		nm_platform_sysctl_set (NM_PLATFORM_GET, NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_ip6_property_path (global_opt.ifname, "accept_ra")), "1");
-		nm_platform_sysctl_set (NM_PLATFORM_GET, NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_ip6_property_path (global_opt.ifname, "accept_ra_defrtr")), "0");
-		nm_platform_sysctl_set (NM_PLATFORM_GET, NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_ip6_property_path (global_opt.ifname, "accept_ra_pinfo")), "0");
-		nm_platform_sysctl_set (NM_PLATFORM_GET, NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_ip6_property_path (global_opt.ifname, "accept_ra_rtr_pref")), "0");
-
-		g_signal_connect (NM_PLATFORM_GET,
-		                  NM_PLATFORM_SIGNAL_IP6_ADDRESS_CHANGED,
-		                  G_CALLBACK (ip6_address_changed),
-		                  ndisc);
-		g_signal_connect (ndisc,
-		                  NM_NDISC_CONFIG_RECEIVED,
-		                  G_CALLBACK (ndisc_config_changed),
-		                  NULL);
-		g_signal_connect (ndisc,
-		                  NM_NDISC_RA_TIMEOUT,
-		                  G_CALLBACK (ndisc_ra_timeout),
-		                  NULL);
-		nm_ndisc_start (ndisc);
 	}
+	gl.n_running = gl.ifaces->len;
 
 	sd_id = nm_sd_event_attach_default ();
 
 	g_main_loop_run (gl.main_loop);
 
-	g_clear_pointer (&hwaddr, g_byte_array_unref);
-
-	if (pidfile && wrote_pidfile)
-		unlink (pidfile);
-
 	_LOGI (LOGD_CORE, "exiting");
 
+	g_clear_pointer (&gl.ifaces, g_ptr_array_unref);
+
 	nm_clear_g_source (&sd_id);
 	g_clear_pointer (&gl.main_loop, g_main_loop_unref);
 	return 0;
@@ -559,6 +748,8 @@ const NMDhcpClientFactory *const _nm_dhcp_manager_factories[3] = {
 void
 nm_main_config_reload (int signal)
 {
+	const Iface *iface = NULL;
+
 	_LOGI (LOGD_CORE, "reloading configuration not supported");
 }
 
@@ -71,6 +71,10 @@ typedef struct {
 	gint64 route_metric;
 	GArray *addresses;
 	GArray *routes;
+	GHashTable *addresses_idx;
+	GHashTable *routes_idx;
+	bool addresses_shared:1;
+	bool routes_shared:1;
 	GArray *nameservers;
 	GPtrArray *domains;
 	GPtrArray *searches;
@@ -248,43 +252,183 @@ notify_addresses (NMIP4Config *self)
 	_notify (self, PROP_ADDRESSES);
 }
 
-NMIP4Config *
-nm_ip4_config_capture (int ifindex, gboolean capture_resolv_conf)
+/*****************************************************************************/
+
+/* The address and route arrays are copy-on-write. replace() and merge()
+ * into an empty config share the arrays of the source instead of copying
+ * each entry, so that cloning a config or rebuilding a composite config
+ * does not copy what did not change. Before modifying a shared array,
+ * the config takes its own copy. The "shared" flag is set on both sides
+ * and only cleared on copying, so a config might copy an array that is
+ * no longer shared. That is just an unnecessary copy. */
+
+static GArray *
+_array_unshare (GArray *array, gboolean keep_content)
 {
-	NMIP4Config *config;
-	NMIP4ConfigPrivate *priv;
-	guint i;
-	guint32 lowest_metric = G_MAXUINT32;
-	guint32 old_gateway = 0;
-	gboolean old_has_gateway = FALSE;
+	GArray *copy;
 
-	/* Slaves have no IP configuration */
-	if (nm_platform_link_get_master (NM_PLATFORM_GET, ifindex) > 0)
-		return NULL;
+	copy = g_array_sized_new (FALSE, FALSE, g_array_get_element_size (array),
+	                          keep_content ? array->len : 0);
+	if (keep_content)
+		g_array_append_vals (copy, array->data, array->len);
+	g_array_unref (array);
+	return copy;
+}
 
-	config = nm_ip4_config_new (ifindex);
-	priv = NM_IP4_CONFIG_GET_PRIVATE (config);
+static void
+_addresses_unshare (NMIP4ConfigPrivate *priv, gboolean keep_content)
+{
+	if (priv->addresses_shared) {
+		priv->addresses = _array_unshare (priv->addresses, keep_content);
+		priv->addresses_shared = FALSE;
+	}
+}
+
+static void
+_routes_unshare (NMIP4ConfigPrivate *priv, gboolean keep_content)
+{
+	if (priv->routes_shared) {
+		priv->routes = _array_unshare (priv->routes, keep_content);
+		priv->routes_shared = FALSE;
+	}
+}
+
+static void
+_addresses_share (NMIP4Config *self, const NMIP4Config *src)
+{
+	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
+	NMIP4ConfigPrivate *src_priv = NM_IP4_CONFIG_GET_PRIVATE ((NMIP4Config *) src);
+
+	nm_assert (self != src);
 
 	g_array_unref (priv->addresses);
+	priv->addresses = g_array_ref (src_priv->addresses);
+	priv->addresses_shared = TRUE;
+	src_priv->addresses_shared = TRUE;
+	g_clear_pointer (&priv->addresses_idx, g_hash_table_unref);
+	notify_addresses (self);
+}
+
+static void
+_routes_share (NMIP4Config *self, const NMIP4Config *src)
+{
+	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
+	NMIP4ConfigPrivate *src_priv = NM_IP4_CONFIG_GET_PRIVATE ((NMIP4Config *) src);
+
+	/* the routes carry the ifindex of the config */
+	nm_assert (self != src);
+	nm_assert (priv->ifindex == src_priv->ifindex);
+
 	g_array_unref (priv->routes);
+	priv->routes = g_array_ref (src_priv->routes);
+	priv->routes_shared = TRUE;
+	src_priv->routes_shared = TRUE;
+	g_clear_pointer (&priv->routes_idx, g_hash_table_unref);
+	_notify (self, PROP_ROUTE_DATA);
+	_notify (self, PROP_ROUTES);
+}
+
+/* The captured addresses and routes per ifindex. Capturing happens on
+ * every change of the platform, but mostly only addresses or only routes
+ * changed. The arrays are shared copy-on-write with the captured configs,
+ * so that recapturing the unchanged part does not copy it again out of the
+ * platform cache. An array is replaced, when the change stamp of the
+ * platform for the ifindex tells that it is outdated. */
+typedef struct {
+	GArray *addresses;
+	GArray *routes;
+	guint64 addresses_stamp;
+	guint64 routes_stamp;
+	gint64 route_metric;
+	guint32 gateway;
+	bool has_gateway:1;
+} CaptureEntry;
 
-	priv->addresses = nm_platform_ip4_address_get_all (NM_PLATFORM_GET, ifindex);
-	priv->routes = nm_platform_ip4_route_get_all (NM_PLATFORM_GET, ifindex, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT | NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT);
+static struct {
+	NMPlatform *platform;
+	GHashTable *entries;
+} capture_cache;
+
+static void
+_capture_entry_free (gpointer data)
+{
+	CaptureEntry *entry = data;
+
+	if (entry->addresses)
+		g_array_unref (entry->addresses);
+	if (entry->routes)
+		g_array_unref (entry->routes);
+	g_slice_free (CaptureEntry, entry);
+}
+
+static void
+_capture_cache_link_changed_cb (NMPlatform *platform,
+                                NMPObjectType obj_type,
+                                int ifindex,
+                                const NMPlatformLink *plink,
+                                NMPlatformSignalChangeType change_type,
+                                gpointer user_data)
+{
+	if (change_type == NM_PLATFORM_SIGNAL_REMOVED)
+		g_hash_table_remove (capture_cache.entries, GINT_TO_POINTER (ifindex));
+}
+
+static CaptureEntry *
+_capture_cache_get (NMPlatform *platform, int ifindex)
+{
+	CaptureEntry *entry;
+
+	if (capture_cache.platform != platform) {
+		if (capture_cache.platform) {
+			g_signal_handlers_disconnect_by_func (capture_cache.platform,
+			                                      G_CALLBACK (_capture_cache_link_changed_cb),
+			                                      NULL);
+			g_object_remove_weak_pointer (G_OBJECT (capture_cache.platform),
+			                              (gpointer *) &capture_cache.platform);
+		}
+		if (capture_cache.entries)
+			g_hash_table_remove_all (capture_cache.entries);
+		else
+			capture_cache.entries = g_hash_table_new_full (NULL, NULL, NULL, _capture_entry_free);
+
+		capture_cache.platform = platform;
+		g_object_add_weak_pointer (G_OBJECT (platform), (gpointer *) &capture_cache.platform);
+		g_signal_connect (platform, NM_PLATFORM_SIGNAL_LINK_CHANGED,
+		                  G_CALLBACK (_capture_cache_link_changed_cb), NULL);
+	}
+
+	entry = g_hash_table_lookup (capture_cache.entries, GINT_TO_POINTER (ifindex));
+	if (!entry) {
+		entry = g_slice_new0 (CaptureEntry);
+		g_hash_table_insert (capture_cache.entries, GINT_TO_POINTER (ifindex), entry);
+	}
+	return entry;
+}
+
+static void
+_capture_entry_update_routes (CaptureEntry *entry, NMPlatform *platform, int ifindex)
+{
+	guint i;
+	guint32 lowest_metric = G_MAXUINT32;
+
+	if (entry->routes)
+		g_array_unref (entry->routes);
+	entry->routes = nm_platform_ip4_route_get_all (platform, ifindex, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT | NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT);
+	entry->gateway = 0;
+	entry->has_gateway = FALSE;
 
 	/* Extract gateway from default route */
-	old_gateway = priv->gateway;
-	old_has_gateway = priv->has_gateway;
-	for (i = 0; i < priv->routes->len; ) {
-		const NMPlatformIP4Route *route = &g_array_index (priv->routes, NMPlatformIP4Route, i);
+	for (i = 0; i < entry->routes->len; ) {
+		const NMPlatformIP4Route *route = &g_array_index (entry->routes, NMPlatformIP4Route, i);
 
 		if (NM_PLATFORM_IP_ROUTE_IS_DEFAULT (route)) {
 			if (route->metric < lowest_metric) {
-				priv->gateway = route->gateway;
+				entry->gateway = route->gateway;
 				lowest_metric = route->metric;
 			}
-			priv->has_gateway = TRUE;
+			entry->has_gateway = TRUE;
 			/* Remove the default route from the list */
-			g_array_remove_index_fast (priv->routes, i);
+			g_array_remove_index_fast (entry->routes, i);
 			continue;
 		}
 		i++;
@@ -292,23 +436,74 @@ nm_ip4_config_capture (int ifindex, gboolean capture_resolv_conf)
 
 	/* we detect the route metric based on the default route. All non-default
 	 * routes have their route metrics explicitly set. */
-	priv->route_metric = priv->has_gateway ? (gint64) lowest_metric : (gint64) -1;
+	entry->route_metric = entry->has_gateway ? (gint64) lowest_metric : (gint64) -1;
 
 	/* If there is a host route to the gateway, ignore that route.  It is
 	 * automatically added by NetworkManager when needed.
 	 */
-	if (priv->has_gateway) {
-		for (i = 0; i < priv->routes->len; i++) {
-			const NMPlatformIP4Route *route = &g_array_index (priv->routes, NMPlatformIP4Route, i);
+	if (entry->has_gateway) {
+		for (i = 0; i < entry->routes->len; i++) {
+			const NMPlatformIP4Route *route = &g_array_index (entry->routes, NMPlatformIP4Route, i);
 
 			if (   (route->plen == 32)
-			    && (route->network == priv->gateway)
+			    && (route->network == entry->gateway)
 			    && (route->gateway == 0)) {
-				g_array_remove_index (priv->routes, i);
+				g_array_remove_index (entry->routes, i);
 				i--;
 			}
 		}
 	}
+}
+
+NMIP4Config *
+nm_ip4_config_capture (int ifindex, gboolean capture_resolv_conf)
+{
+	NMPlatform *platform = NM_PLATFORM_GET;
+	NMIP4Config *config;
+	NMIP4ConfigPrivate *priv;
+	CaptureEntry *entry;
+	guint64 stamp;
+	guint32 old_gateway = 0;
+	gboolean old_has_gateway = FALSE;
+
+	/* Slaves have no IP configuration */
+	if (nm_platform_link_get_master (platform, ifindex) > 0)
+		return NULL;
+
+	entry = _capture_cache_get (platform, ifindex);
+
+	stamp = nm_platform_changes_get_stamp (platform, NMP_OBJECT_TYPE_IP4_ADDRESS, ifindex);
+	if (!entry->addresses || entry->addresses_stamp != stamp) {
+		if (entry->addresses)
+			g_array_unref (entry->addresses);
+		entry->addresses = nm_platform_ip4_address_get_all (platform, ifindex);
+		entry->addresses_stamp = stamp;
+	}
+
+	stamp = nm_platform_changes_get_stamp (platform, NMP_OBJECT_TYPE_IP4_ROUTE, ifindex);
+	if (!entry->routes || entry->routes_stamp != stamp) {
+		_capture_entry_update_routes (entry, platform, ifindex);
+		entry->routes_stamp = stamp;
+	}
+
+	config = nm_ip4_config_new (ifindex);
+	priv = NM_IP4_CONFIG_GET_PRIVATE (config);
+
+	/* the arrays of @entry are never modified, only replaced. */
+	g_array_unref (priv->addresses);
+	priv->addresses = g_array_ref (entry->addresses);
+	priv->addresses_shared = TRUE;
+	g_array_unref (priv->routes);
+	priv->routes = g_array_ref (entry->routes);
+	priv->routes_shared = TRUE;
+
+	old_gateway = priv->gateway;
+	old_has_gateway = priv->has_gateway;
+	if (entry->has_gateway) {
+		priv->gateway = entry->gateway;
+		priv->has_gateway = TRUE;
+	}
+	priv->route_metric = entry->route_metric;
 
 	/* If the interface has the default route, and has IPv4 addresses, capture
 	 * nameservers from /etc/resolv.conf.
@@ -330,18 +525,67 @@ nm_ip4_config_capture (int ifindex, gboolean capture_resolv_conf)
 	return config;
 }
 
+/* The state of the last successful address sync per ifindex. With it,
+ * the address sync does not re-add addresses that did not change, which
+ * otherwise costs a netlink request per address on every DHCP renewal
+ * or router advertisement. */
+static GHashTable *committed_addresses;
+
+static void
+_committed_addresses_free (NMPlatformAddressCommit *commit)
+{
+	nm_platform_address_commit_clear (commit);
+	g_slice_free (NMPlatformAddressCommit, commit);
+}
+
+static void
+_committed_addresses_link_changed (NMPlatform *platform,
+                                   int obj_type_i,
+                                   int ifindex,
+                                   const NMPlatformLink *plink,
+                                   int change_type_i,
+                                   gpointer user_data)
+{
+	/* a later link may get the same ifindex. */
+	if ((NMPlatformSignalChangeType) change_type_i == NM_PLATFORM_SIGNAL_REMOVED)
+		g_hash_table_remove (committed_addresses, GINT_TO_POINTER (ifindex));
+}
+
+static NMPlatformAddressCommit *
+_committed_addresses_get (int ifindex)
+{
+	NMPlatformAddressCommit *commit;
+
+	if (G_UNLIKELY (!committed_addresses)) {
+		committed_addresses = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) _committed_addresses_free);
+		g_signal_connect (NM_PLATFORM_GET, NM_PLATFORM_SIGNAL_LINK_CHANGED,
+		                  G_CALLBACK (_committed_addresses_link_changed), NULL);
+	}
+
+	commit = g_hash_table_lookup (committed_addresses, GINT_TO_POINTER (ifindex));
+	if (!commit) {
+		commit = g_slice_new0 (NMPlatformAddressCommit);
+		g_hash_table_insert (committed_addresses, GINT_TO_POINTER (ifindex), commit);
+	}
+	return commit;
+}
+
 gboolean
 nm_ip4_config_commit (const NMIP4Config *config, int ifindex, gboolean routes_full_sync, gint64 default_route_metric)
 {
 	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (config);
 	gs_unref_ptrarray GPtrArray *added_addresses = NULL;
+	NMPlatformAddressCommit *commit;
 
 	g_return_val_if_fail (ifindex > 0, FALSE);
 	g_return_val_if_fail (config != NULL, FALSE);
 
 	/* Addresses */
-	nm_platform_ip4_address_sync (NM_PLATFORM_GET, ifindex, priv->addresses,
+	commit = _committed_addresses_get (ifindex);
+	nm_platform_ip4_address_sync (NM_PLATFORM_GET, ifindex, priv->addresses, commit,
 	                              default_route_metric >= 0 ? &added_addresses : NULL);
+	if (!commit->known_addresses)
+		g_hash_table_remove (committed_addresses, GINT_TO_POINTER (ifindex));
 
 	/* Routes */
 	{
@@ -688,8 +932,12 @@ nm_ip4_config_merge (NMIP4Config *dst, const NMIP4Config *src, NMIPConfigMergeFl
 	g_object_freeze_notify (G_OBJECT (dst));
 
 	/* addresses */
-	for (i = 0; i < nm_ip4_config_get_num_addresses (src); i++)
-		nm_ip4_config_add_address (dst, nm_ip4_config_get_address (src, i));
+	if (!dst_priv->addresses->len && src_priv->addresses->len)
+		_addresses_share (dst, src);
+	else {
+		for (i = 0; i < nm_ip4_config_get_num_addresses (src); i++)
+			nm_ip4_config_add_address (dst, nm_ip4_config_get_address (src, i));
+	}
 
 	/* nameservers */
 	if (!NM_FLAGS_HAS (merge_flags, NM_IP_CONFIG_MERGE_NO_DNS)) {
@@ -703,8 +951,14 @@ nm_ip4_config_merge (NMIP4Config *dst, const NMIP4Config *src, NMIPConfigMergeFl
 
 	/* routes */
 	if (!NM_FLAGS_HAS (merge_flags, NM_IP_CONFIG_MERGE_NO_ROUTES)) {
-		for (i = 0; i < nm_ip4_config_get_num_routes (src); i++)
-			nm_ip4_config_add_route (dst, nm_ip4_config_get_route (src, i));
+		if (   !dst_priv->routes->len
+		    && src_priv->routes->len
+		    && dst_priv->ifindex == src_priv->ifindex)
+			_routes_share (dst, src);
+		else {
+			for (i = 0; i < nm_ip4_config_get_num_routes (src); i++)
+				nm_ip4_config_add_route (dst, nm_ip4_config_get_route (src, i));
+		}
 	}
 
 	if (dst_priv->route_metric == -1)
@@ -769,12 +1023,124 @@ nm_ip4_config_merge (NMIP4Config *dst, const NMIP4Config *src, NMIPConfigMergeFl
 
 /*****************************************************************************/
 
+/* Configurations with many addresses or routes (like classless static
+ * routes from DHCP) would make add, subtract and intersect quadratic.
+ * So once an array reaches IDX_MIN_LEN entries, lookups go through a
+ * hash index over the identity of the entries. The index is created on
+ * the first lookup, extended on append and dropped whenever entries
+ * are removed. */
+#define IDX_MIN_LEN 16
+
+typedef struct {
+	guint32 addr;
+	guint32 peer_net;
+	guint8 plen;
+} IdxKey;
+
+typedef void (*IdxKeyInitFunc) (IdxKey *key, gconstpointer item);
+
+static guint
+_idx_key_hash (gconstpointer ptr)
+{
+	const IdxKey *key = ptr;
+	guint h = key->addr;
+
+	h = (h * 33) + key->peer_net;
+	h = (h * 33) + key->plen;
+	return h;
+}
+
+static gboolean
+_idx_key_equal (gconstpointer a, gconstpointer b)
+{
+	const IdxKey *k1 = a, *k2 = b;
+
+	return    k1->addr == k2->addr
+	       && k1->peer_net == k2->peer_net
+	       && k1->plen == k2->plen;
+}
+
+static void
+_idx_key_free (gpointer ptr)
+{
+	g_slice_free (IdxKey, ptr);
+}
+
+static void
+_idx_key_init_address (IdxKey *key, const NMPlatformIP4Address *a)
+{
+	/* identical keys if and only if addresses_are_duplicate() */
+	key->addr = a->address;
+	key->peer_net = a->peer_address & nm_utils_ip4_prefix_to_netmask (a->plen);
+	key->plen = a->plen;
+}
+
+static void
+_idx_key_init_route (IdxKey *key, const NMPlatformIP4Route *r)
+{
+	/* identical keys if and only if routes_are_duplicate() */
+	key->addr = r->network;
+	key->peer_net = 0;
+	key->plen = r->plen;
+}
+
+static void
+_idx_add (GHashTable *idx, IdxKeyInitFunc key_init, gconstpointer item, guint i)
+{
+	IdxKey *key;
+
+	key = g_slice_new0 (IdxKey);
+	key_init (key, item);
+
+	/* like the linear search, find the first of duplicate entries */
+	if (g_hash_table_contains (idx, key)) {
+		_idx_key_free (key);
+		return;
+	}
+	g_hash_table_insert (idx, key, GUINT_TO_POINTER (i));
+}
+
+static int
+_idx_lookup (GHashTable **p_idx, const GArray *array, IdxKeyInitFunc key_init, gconstpointer needle)
+{
+	IdxKey key = { 0 };
+	gpointer value;
+	guint i;
+
+	if (!*p_idx) {
+		const guint elt_size = g_array_get_element_size ((GArray *) array);
+
+		*p_idx = g_hash_table_new_full (_idx_key_hash, _idx_key_equal, _idx_key_free, NULL);
+		for (i = 0; i < array->len; i++)
+			_idx_add (*p_idx, key_init, &array->data[i * elt_size], i);
+	}
+
+	key_init (&key, needle);
+	if (!g_hash_table_lookup_extended (*p_idx, &key, NULL, &value))
+		return -1;
+	return (int) GPOINTER_TO_UINT (value);
+}
+
+static void
+_idx_append (GHashTable *idx, IdxKeyInitFunc key_init, const GArray *array)
+{
+	const guint elt_size = g_array_get_element_size ((GArray *) array);
+
+	if (idx)
+		_idx_add (idx, key_init, &array->data[(array->len - 1) * elt_size], array->len - 1);
+}
+
 static int
 _addresses_get_index (const NMIP4Config *self, const NMPlatformIP4Address *addr)
 {
-	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
+	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE ((NMIP4Config *) self);
 	guint i;
 
+	if (priv->addresses->len >= IDX_MIN_LEN) {
+		return _idx_lookup (&priv->addresses_idx, priv->addresses,
+		                    (IdxKeyInitFunc) _idx_key_init_address, addr);
+	}
+
 	for (i = 0; i < priv->addresses->len; i++) {
 		const NMPlatformIP4Address *a = &g_array_index (priv->addresses, NMPlatformIP4Address, i);
 
@@ -802,9 +1168,14 @@ _nameservers_get_index (const NMIP4Config *self, guint32 ns)
 static int
 _routes_get_index (const NMIP4Config *self, const NMPlatformIP4Route *route)
 {
-	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
+	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE ((NMIP4Config *) self);
 	guint i;
 
+	if (priv->routes->len >= IDX_MIN_LEN) {
+		return _idx_lookup (&priv->routes_idx, priv->routes,
+		                    (IdxKeyInitFunc) _idx_key_init_route, route);
+	}
+
 	for (i = 0; i < priv->routes->len; i++) {
 		const NMPlatformIP4Route *r = &g_array_index (priv->routes, NMPlatformIP4Route, i);
 
@@ -910,11 +1281,14 @@ nm_ip4_config_subtract (NMIP4Config *dst, const NMIP4Config *src)
 
 	g_object_freeze_notify (G_OBJECT (dst));
 
-	/* addresses */
-	for (i = 0; i < nm_ip4_config_get_num_addresses (src); i++) {
-		idx = _addresses_get_index (dst, nm_ip4_config_get_address (src, i));
+	/* addresses. Look up the entries of @dst in @src and not the other
+	 * way around, because deleting from @dst drops its index. */
+	for (i = 0; i < nm_ip4_config_get_num_addresses (dst); ) {
+		idx = _addresses_get_index (src, nm_ip4_config_get_address (dst, i));
 		if (idx >= 0)
-			nm_ip4_config_del_address (dst, idx);
+			nm_ip4_config_del_address (dst, i);
+		else
+			i++;
 	}
 
 	/* nameservers */
@@ -935,10 +1309,12 @@ nm_ip4_config_subtract (NMIP4Config *dst, const NMIP4Config *src)
 	/* ignore route_metric */
 
 	/* routes */
-	for (i = 0; i < nm_ip4_config_get_num_routes (src); i++) {
-		idx = _routes_get_index (dst, nm_ip4_config_get_route (src, i));
+	for (i = 0; i < nm_ip4_config_get_num_routes (dst); ) {
+		idx = _routes_get_index (src, nm_ip4_config_get_route (dst, i));
 		if (idx >= 0)
-			nm_ip4_config_del_route (dst, idx);
+			nm_ip4_config_del_route (dst, i);
+		else
+			i++;
 	}
 
 	/* domains */
@@ -1129,9 +1505,7 @@ nm_ip4_config_replace (NMIP4Config *dst, const NMIP4Config *src, gboolean *relev
 	} else
 		has_relevant_changes = TRUE;
 	if (!are_equal) {
-		nm_ip4_config_reset_addresses (dst);
-		for (i = 0; i < num; i++)
-			nm_ip4_config_add_address (dst, nm_ip4_config_get_address (src, i));
+		_addresses_share (dst, src);
 		has_minor_changes = TRUE;
 	}
 
@@ -1152,9 +1526,8 @@ nm_ip4_config_replace (NMIP4Config *dst, const NMIP4Config *src, gboolean *relev
 	} else
 		has_relevant_changes = TRUE;
 	if (!are_equal) {
-		nm_ip4_config_reset_routes (dst);
-		for (i = 0; i < num; i++)
-			nm_ip4_config_add_route (dst, nm_ip4_config_get_route (src, i));
+		/* the ifindex was already taken over from @src above */
+		_routes_share (dst, src);
 		has_minor_changes = TRUE;
 	}
 
@@ -1496,7 +1869,9 @@ nm_ip4_config_reset_addresses (NMIP4Config *config)
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (config);
 
 	if (priv->addresses->len != 0) {
+		_addresses_unshare (priv, FALSE);
 		g_array_set_size (priv->addresses, 0);
+		g_clear_pointer (&priv->addresses_idx, g_hash_table_unref);
 		notify_addresses (config);
 	}
 }
@@ -1520,39 +1895,41 @@ nm_ip4_config_add_address (NMIP4Config *config, const NMPlatformIP4Address *new)
 
 	g_return_if_fail (new != NULL);
 
-	for (i = 0; i < priv->addresses->len; i++ ) {
+	_addresses_unshare (priv, TRUE);
+
+	i = _addresses_get_index (config, new);
+	if (i >= 0) {
 		NMPlatformIP4Address *item = &g_array_index (priv->addresses, NMPlatformIP4Address, i);
 
-		if (addresses_are_duplicate (item, new)) {
-			if (nm_platform_ip4_address_cmp (item, new) == 0)
-				return;
-
-			/* remember the old values. */
-			item_old = *item;
-			/* Copy over old item to get new lifetime, timestamp, preferred */
-			*item = *new;
-
-			/* But restore highest priority source */
-			item->addr_source = MAX (item_old.addr_source, new->addr_source);
-
-			/* for addresses that we read from the kernel, we keep the timestamps as defined
-			 * by the previous source (item_old). The reason is, that the other source configured the lifetimes
-			 * with "what should be" and the kernel values are "what turned out after configuring it".
-			 *
-			 * For other sources, the longer lifetime wins. */
-			if (   (new->addr_source == NM_IP_CONFIG_SOURCE_KERNEL && new->addr_source != item_old.addr_source)
-			    || nm_platform_ip_address_cmp_expiry ((const NMPlatformIPAddress *) &item_old, (const NMPlatformIPAddress *) new) > 0) {
-				item->timestamp = item_old.timestamp;
-				item->lifetime = item_old.lifetime;
-				item->preferred = item_old.preferred;
-			}
-			if (nm_platform_ip4_address_cmp (&item_old, item) == 0)
-				return;
-			goto NOTIFY;
+		if (nm_platform_ip4_address_cmp (item, new) == 0)
+			return;
+
+		/* remember the old values. */
+		item_old = *item;
+		/* Copy over old item to get new lifetime, timestamp, preferred */
+		*item = *new;
+
+		/* But restore highest priority source */
+		item->addr_source = MAX (item_old.addr_source, new->addr_source);
+
+		/* for addresses that we read from the kernel, we keep the timestamps as defined
+		 * by the previous source (item_old). The reason is, that the other source configured the lifetimes
+		 * with "what should be" and the kernel values are "what turned out after configuring it".
+		 *
+		 * For other sources, the longer lifetime wins. */
+		if (   (new->addr_source == NM_IP_CONFIG_SOURCE_KERNEL && new->addr_source != item_old.addr_source)
+		    || nm_platform_ip_address_cmp_expiry ((const NMPlatformIPAddress *) &item_old, (const NMPlatformIPAddress *) new) > 0) {
+			item->timestamp = item_old.timestamp;
+			item->lifetime = item_old.lifetime;
+			item->preferred = item_old.preferred;
 		}
+		if (nm_platform_ip4_address_cmp (&item_old, item) == 0)
+			return;
+		goto NOTIFY;
 	}
 
 	g_array_append_val (priv->addresses, *new);
+	_idx_append (priv->addresses_idx, (IdxKeyInitFunc) _idx_key_init_address, priv->addresses);
 NOTIFY:
 	notify_addresses (config);
 }
@@ -1564,7 +1941,9 @@ nm_ip4_config_del_address (NMIP4Config *config, guint i)
 
 	g_return_if_fail (i < priv->addresses->len);
 
+	_addresses_unshare (priv, TRUE);
 	g_array_remove_index (priv->addresses, i);
+	g_clear_pointer (&priv->addresses_idx, g_hash_table_unref);
 
 	notify_addresses (config);
 }
@@ -1600,7 +1979,9 @@ nm_ip4_config_reset_routes (NMIP4Config *config)
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (config);
 
 	if (priv->routes->len != 0) {
+		_routes_unshare (priv, FALSE);
 		g_array_set_size (priv->routes, 0);
+		g_clear_pointer (&priv->routes_idx, g_hash_table_unref);
 		_notify (config, PROP_ROUTE_DATA);
 		_notify (config, PROP_ROUTES);
 	}
@@ -1627,23 +2008,25 @@ nm_ip4_config_add_route (NMIP4Config *config, const NMPlatformIP4Route *new)
 	g_return_if_fail (new->plen > 0 && new->plen <= 32);
 	g_return_if_fail (priv->ifindex > 0);
 
-	for (i = 0; i < priv->routes->len; i++ ) {
+	_routes_unshare (priv, TRUE);
+
+	i = _routes_get_index (config, new);
+	if (i >= 0) {
 		NMPlatformIP4Route *item = &g_array_index (priv->routes, NMPlatformIP4Route, i);
 
-		if (routes_are_duplicate (item, new, FALSE)) {
-			if (nm_platform_ip4_route_cmp (item, new) == 0)
-				return;
-			old_source = item->rt_source;
-			memcpy (item, new, sizeof (*item));
-			/* Restore highest priority source */
-			item->rt_source = MAX (old_source, new->rt_source);
-			item->ifindex = priv->ifindex;
-			goto NOTIFY;
-		}
+		if (nm_platform_ip4_route_cmp (item, new) == 0)
+			return;
+		old_source = item->rt_source;
+		memcpy (item, new, sizeof (*item));
+		/* Restore highest priority source */
+		item->rt_source = MAX (old_source, new->rt_source);
+		item->ifindex = priv->ifindex;
+		goto NOTIFY;
 	}
 
 	g_array_append_val (priv->routes, *new);
 	g_array_index (priv->routes, NMPlatformIP4Route, priv->routes->len - 1).ifindex = priv->ifindex;
+	_idx_append (priv->routes_idx, (IdxKeyInitFunc) _idx_key_init_route, priv->routes);
 NOTIFY:
 	_notify (config, PROP_ROUTE_DATA);
 	_notify (config, PROP_ROUTES);
@@ -1656,7 +2039,9 @@ nm_ip4_config_del_route (NMIP4Config *config, guint i)
 
 	g_return_if_fail (i < priv->routes->len);
 
+	_routes_unshare (priv, TRUE);
 	g_array_remove_index (priv->routes, i);
+	g_clear_pointer (&priv->routes_idx, g_hash_table_unref);
 	_notify (config, PROP_ROUTE_DATA);
 	_notify (config, PROP_ROUTES);
 }
@@ -2502,6 +2887,10 @@ finalize (GObject *object)
 	nm_clear_g_variant (&priv->addresses_variant);
 	g_array_unref (priv->addresses);
 	g_array_unref (priv->routes);
+	if (priv->addresses_idx)
+		g_hash_table_unref (priv->addresses_idx);
+	if (priv->routes_idx)
+		g_hash_table_unref (priv->routes_idx);
 	g_array_unref (priv->nameservers);
 	g_ptr_array_unref (priv->domains);
 	g_ptr_array_unref (priv->searches);
@@ -47,6 +47,10 @@ typedef struct {
 	struct in6_addr gateway;
 	GArray *addresses;
 	GArray *routes;
+	GHashTable *addresses_idx;
+	GHashTable *routes_idx;
+	bool addresses_shared:1;
+	bool routes_shared:1;
 	GArray *nameservers;
 	GPtrArray *domains;
 	GPtrArray *searches;
@@ -111,6 +115,82 @@ notify_addresses (NMIP6Config *self)
 	_notify (self, PROP_ADDRESSES);
 }
 
+/*****************************************************************************/
+
+/* The address and route arrays are copy-on-write. replace() and merge()
+ * into an empty config share the arrays of the source instead of copying
+ * each entry, so that cloning a config or rebuilding a composite config
+ * does not copy what did not change. Before modifying a shared array,
+ * the config takes its own copy. The "shared" flag is set on both sides
+ * and only cleared on copying, so a config might copy an array that is
+ * no longer shared. That is just an unnecessary copy. */
+
+static GArray *
+_array_unshare (GArray *array, gboolean keep_content)
+{
+	GArray *copy;
+
+	copy = g_array_sized_new (FALSE, TRUE, g_array_get_element_size (array),
+	                          keep_content ? array->len : 0);
+	if (keep_content)
+		g_array_append_vals (copy, array->data, array->len);
+	g_array_unref (array);
+	return copy;
+}
+
+static void
+_addresses_unshare (NMIP6ConfigPrivate *priv, gboolean keep_content)
+{
+	if (priv->addresses_shared) {
+		priv->addresses = _array_unshare (priv->addresses, keep_content);
+		priv->addresses_shared = FALSE;
+	}
+}
+
+static void
+_routes_unshare (NMIP6ConfigPrivate *priv, gboolean keep_content)
+{
+	if (priv->routes_shared) {
+		priv->routes = _array_unshare (priv->routes, keep_content);
+		priv->routes_shared = FALSE;
+	}
+}
+
+static void
+_addresses_share (NMIP6Config *self, const NMIP6Config *src)
+{
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *src_priv = NM_IP6_CONFIG_GET_PRIVATE ((NMIP6Config *) src);
+
+	nm_assert (self != src);
+
+	g_array_unref (priv->addresses);
+	priv->addresses = g_array_ref (src_priv->addresses);
+	priv->addresses_shared = TRUE;
+	src_priv->addresses_shared = TRUE;
+	g_clear_pointer (&priv->addresses_idx, g_hash_table_unref);
+	notify_addresses (self);
+}
+
+static void
+_routes_share (NMIP6Config *self, const NMIP6Config *src)
+{
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *src_priv = NM_IP6_CONFIG_GET_PRIVATE ((NMIP6Config *) src);
+
+	/* the routes carry the ifindex of the config */
+	nm_assert (self != src);
+	nm_assert (priv->ifindex == src_priv->ifindex);
+
+	g_array_unref (priv->routes);
+	priv->routes = g_array_ref (src_priv->routes);
+	priv->routes_shared = TRUE;
+	src_priv->routes_shared = TRUE;
+	g_clear_pointer (&priv->routes_idx, g_hash_table_unref);
+	_notify (self, PROP_ROUTE_DATA);
+	_notify (self, PROP_ROUTES);
+}
+
 /**
  * nm_ip6_config_capture_resolv_conf():
  * @nameservers: array of struct in6_addr
@@ -282,6 +362,8 @@ nm_ip6_config_addresses_sort (NMIP6Config *self)
 
 	priv = NM_IP6_CONFIG_GET_PRIVATE (self);
 	if (priv->addresses->len > 1) {
+		_addresses_unshare (priv, TRUE);
+
 		data_len = priv->addresses->len * g_array_get_element_size (priv->addresses);
 		data_pre = g_new (char, data_len);
 		memcpy (data_pre, priv->addresses->data, data_len);
@@ -293,6 +375,7 @@ nm_ip6_config_addresses_sort (NMIP6Config *self)
 		g_free (data_pre);
 
 		if (changed) {
+			g_clear_pointer (&priv->addresses_idx, g_hash_table_unref);
 			notify_addresses (self);
 			return TRUE;
 		}
@@ -300,43 +383,108 @@ nm_ip6_config_addresses_sort (NMIP6Config *self)
 	return FALSE;
 }
 
-NMIP6Config *
-nm_ip6_config_capture (int ifindex, gboolean capture_resolv_conf, NMSettingIP6ConfigPrivacy use_temporary)
+/* The captured addresses and routes per ifindex. Capturing happens on
+ * every change of the platform, but mostly only addresses or only routes
+ * changed. The arrays are shared copy-on-write with the captured configs,
+ * so that recapturing the unchanged part does not copy it again out of the
+ * platform cache. An array is replaced, when the change stamp of the
+ * platform for the ifindex tells that it is outdated. */
+typedef struct {
+	GArray *addresses;
+	GArray *routes;
+	guint64 addresses_stamp;
+	guint64 routes_stamp;
+	gint64 route_metric;
+	struct in6_addr gateway;
+	NMSettingIP6ConfigPrivacy use_temporary;
+	bool has_gateway:1;
+} CaptureEntry;
+
+static struct {
+	NMPlatform *platform;
+	GHashTable *entries;
+} capture_cache;
+
+static void
+_capture_entry_free (gpointer data)
 {
-	NMIP6Config *config;
-	NMIP6ConfigPrivate *priv;
-	guint i;
-	guint32 lowest_metric = G_MAXUINT32;
-	struct in6_addr old_gateway = IN6ADDR_ANY_INIT;
-	gboolean has_gateway = FALSE;
-	gboolean notify_nameservers = FALSE;
+	CaptureEntry *entry = data;
 
-	/* Slaves have no IP configuration */
-	if (nm_platform_link_get_master (NM_PLATFORM_GET, ifindex) > 0)
-		return NULL;
+	if (entry->addresses)
+		g_array_unref (entry->addresses);
+	if (entry->routes)
+		g_array_unref (entry->routes);
+	g_slice_free (CaptureEntry, entry);
+}
 
-	config = nm_ip6_config_new (ifindex);
-	priv = NM_IP6_CONFIG_GET_PRIVATE (config);
+static void
+_capture_cache_link_changed_cb (NMPlatform *platform,
+                                NMPObjectType obj_type,
+                                int ifindex,
+                                const NMPlatformLink *plink,
+                                NMPlatformSignalChangeType change_type,
+                                gpointer user_data)
+{
+	if (change_type == NM_PLATFORM_SIGNAL_REMOVED)
+		g_hash_table_remove (capture_cache.entries, GINT_TO_POINTER (ifindex));
+}
 
-	g_array_unref (priv->addresses);
-	g_array_unref (priv->routes);
+static CaptureEntry *
+_capture_cache_get (NMPlatform *platform, int ifindex)
+{
+	CaptureEntry *entry;
 
-	priv->addresses = nm_platform_ip6_address_get_all (NM_PLATFORM_GET, ifindex);
-	priv->routes = nm_platform_ip6_route_get_all (NM_PLATFORM_GET, ifindex, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT | NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT);
+	if (capture_cache.platform != platform) {
+		if (capture_cache.platform) {
+			g_signal_handlers_disconnect_by_func (capture_cache.platform,
+			                                      G_CALLBACK (_capture_cache_link_changed_cb),
+			                                      NULL);
+			g_object_remove_weak_pointer (G_OBJECT (capture_cache.platform),
+			                              (gpointer *) &capture_cache.platform);
+		}
+		if (capture_cache.entries)
+			g_hash_table_remove_all (capture_cache.entries);
+		else
+			capture_cache.entries = g_hash_table_new_full (NULL, NULL, NULL, _capture_entry_free);
+
+		capture_cache.platform = platform;
+		g_object_add_weak_pointer (G_OBJECT (platform), (gpointer *) &capture_cache.platform);
+		g_signal_connect (platform, NM_PLATFORM_SIGNAL_LINK_CHANGED,
+		                  G_CALLBACK (_capture_cache_link_changed_cb), NULL);
+	}
+
+	entry = g_hash_table_lookup (capture_cache.entries, GINT_TO_POINTER (ifindex));
+	if (!entry) {
+		entry = g_slice_new0 (CaptureEntry);
+		g_hash_table_insert (capture_cache.entries, GINT_TO_POINTER (ifindex), entry);
+	}
+	return entry;
+}
+
+static void
+_capture_entry_update_routes (CaptureEntry *entry, NMPlatform *platform, int ifindex)
+{
+	guint i;
+	guint32 lowest_metric = G_MAXUINT32;
+
+	if (entry->routes)
+		g_array_unref (entry->routes);
+	entry->routes = nm_platform_ip6_route_get_all (platform, ifindex, NM_PLATFORM_GET_ROUTE_FLAGS_WITH_DEFAULT | NM_PLATFORM_GET_ROUTE_FLAGS_WITH_NON_DEFAULT);
+	entry->gateway = in6addr_any;
+	entry->has_gateway = FALSE;
 
 	/* Extract gateway from default route */
-	old_gateway = priv->gateway;
-	for (i = 0; i < priv->routes->len; ) {
-		const NMPlatformIP6Route *route = &g_array_index (priv->routes, NMPlatformIP6Route, i);
+	for (i = 0; i < entry->routes->len; ) {
+		const NMPlatformIP6Route *route = &g_array_index (entry->routes, NMPlatformIP6Route, i);
 
 		if (NM_PLATFORM_IP_ROUTE_IS_DEFAULT (route)) {
 			if (route->metric < lowest_metric) {
-				priv->gateway = route->gateway;
+				entry->gateway = route->gateway;
 				lowest_metric = route->metric;
 			}
-			has_gateway = TRUE;
+			entry->has_gateway = TRUE;
 			/* Remove the default route from the list */
-			g_array_remove_index_fast (priv->routes, i);
+			g_array_remove_index_fast (entry->routes, i);
 			continue;
 		}
 		i++;
@@ -344,34 +492,85 @@ nm_ip6_config_capture (int ifindex, gboolean capture_resolv_conf, NMSettingIP6Co
 
 	/* we detect the route metric based on the default route. All non-default
 	 * routes have their route metrics explicitly set. */
-	priv->route_metric = has_gateway ? (gint64) lowest_metric : (gint64) -1;
+	entry->route_metric = entry->has_gateway ? (gint64) lowest_metric : (gint64) -1;
 
 	/* If there is a host route to the gateway, ignore that route.  It is
 	 * automatically added by NetworkManager when needed.
 	 */
-	if (has_gateway) {
-		for (i = 0; i < priv->routes->len; i++) {
-			const NMPlatformIP6Route *route = &g_array_index (priv->routes, NMPlatformIP6Route, i);
+	if (entry->has_gateway) {
+		for (i = 0; i < entry->routes->len; i++) {
+			const NMPlatformIP6Route *route = &g_array_index (entry->routes, NMPlatformIP6Route, i);
 
 			if (   route->plen == 128
-			    && IN6_ARE_ADDR_EQUAL (&route->network, &priv->gateway)
+			    && IN6_ARE_ADDR_EQUAL (&route->network, &entry->gateway)
 			    && IN6_IS_ADDR_UNSPECIFIED (&route->gateway)) {
-				g_array_remove_index (priv->routes, i);
+				g_array_remove_index (entry->routes, i);
 				i--;
 			}
 		}
 	}
+}
+
+NMIP6Config *
+nm_ip6_config_capture (int ifindex, gboolean capture_resolv_conf, NMSettingIP6ConfigPrivacy use_temporary)
+{
+	NMPlatform *platform = NM_PLATFORM_GET;
+	NMIP6Config *config;
+	NMIP6ConfigPrivate *priv;
+	CaptureEntry *entry;
+	guint64 stamp;
+	struct in6_addr old_gateway = IN6ADDR_ANY_INIT;
+	gboolean notify_nameservers = FALSE;
+
+	/* Slaves have no IP configuration */
+	if (nm_platform_link_get_master (platform, ifindex) > 0)
+		return NULL;
+
+	entry = _capture_cache_get (platform, ifindex);
+
+	/* the sort order of the addresses depends on @use_temporary. */
+	stamp = nm_platform_changes_get_stamp (platform, NMP_OBJECT_TYPE_IP6_ADDRESS, ifindex);
+	if (   !entry->addresses
+	    || entry->addresses_stamp != stamp
+	    || entry->use_temporary != use_temporary) {
+		if (entry->addresses)
+			g_array_unref (entry->addresses);
+		entry->addresses = nm_platform_ip6_address_get_all (platform, ifindex);
+		g_array_sort_with_data (entry->addresses, _addresses_sort_cmp, GINT_TO_POINTER (use_temporary));
+		entry->addresses_stamp = stamp;
+		entry->use_temporary = use_temporary;
+	}
+
+	stamp = nm_platform_changes_get_stamp (platform, NMP_OBJECT_TYPE_IP6_ROUTE, ifindex);
+	if (!entry->routes || entry->routes_stamp != stamp) {
+		_capture_entry_update_routes (entry, platform, ifindex);
+		entry->routes_stamp = stamp;
+	}
+
+	config = nm_ip6_config_new (ifindex);
+	priv = NM_IP6_CONFIG_GET_PRIVATE (config);
+
+	/* the arrays of @entry are never modified, only replaced. */
+	g_array_unref (priv->addresses);
+	priv->addresses = g_array_ref (entry->addresses);
+	priv->addresses_shared = TRUE;
+	g_array_unref (priv->routes);
+	priv->routes = g_array_ref (entry->routes);
+	priv->routes_shared = TRUE;
+
+	old_gateway = priv->gateway;
+	if (entry->has_gateway)
+		priv->gateway = entry->gateway;
+	priv->route_metric = entry->route_metric;
 
 	/* If the interface has the default route, and has IPv6 addresses, capture
 	 * nameservers from /etc/resolv.conf.
 	 */
-	if (priv->addresses->len && has_gateway && capture_resolv_conf)
+	if (priv->addresses->len && entry->has_gateway && capture_resolv_conf)
 		notify_nameservers = nm_ip6_config_capture_resolv_conf (priv->nameservers,
 		                                                        priv->dns_options,
 		                                                        NULL);
 
-	g_array_sort_with_data (priv->addresses, _addresses_sort_cmp, GINT_TO_POINTER (use_temporary));
-
 	/* actually, nobody should be connected to the signal, just to be sure, notify */
 	if (notify_nameservers)
 		_notify (config, PROP_NAMESERVERS);
@@ -385,17 +584,66 @@ nm_ip6_config_capture (int ifindex, gboolean capture_resolv_conf, NMSettingIP6Co
 	return config;
 }
 
+/* The state of the last successful address sync per ifindex. With it,
+ * the address sync does not re-add addresses that did not change, which
+ * otherwise costs a netlink request per address on every DHCP renewal
+ * or router advertisement. */
+static GHashTable *committed_addresses;
+
+static void
+_committed_addresses_free (NMPlatformAddressCommit *commit)
+{
+	nm_platform_address_commit_clear (commit);
+	g_slice_free (NMPlatformAddressCommit, commit);
+}
+
+static void
+_committed_addresses_link_changed (NMPlatform *platform,
+                                   int obj_type_i,
+                                   int ifindex,
+                                   const NMPlatformLink *plink,
+                                   int change_type_i,
+                                   gpointer user_data)
+{
+	/* a later link may get the same ifindex. */
+	if ((NMPlatformSignalChangeType) change_type_i == NM_PLATFORM_SIGNAL_REMOVED)
+		g_hash_table_remove (committed_addresses, GINT_TO_POINTER (ifindex));
+}
+
+static NMPlatformAddressCommit *
+_committed_addresses_get (int ifindex)
+{
+	NMPlatformAddressCommit *commit;
+
+	if (G_UNLIKELY (!committed_addresses)) {
+		committed_addresses = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) _committed_addresses_free);
+		g_signal_connect (NM_PLATFORM_GET, NM_PLATFORM_SIGNAL_LINK_CHANGED,
+		                  G_CALLBACK (_committed_addresses_link_changed), NULL);
+	}
+
+	commit = g_hash_table_lookup (committed_addresses, GINT_TO_POINTER (ifindex));
+	if (!commit) {
+		commit = g_slice_new0 (NMPlatformAddressCommit);
+		g_hash_table_insert (committed_addresses, GINT_TO_POINTER (ifindex), commit);
+	}
+	return commit;
+}
+
 gboolean
 nm_ip6_config_commit (const NMIP6Config *config, int ifindex, gboolean routes_full_sync)
 {
 	const NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (config);
 	gboolean success;
+	NMPlatformAddressCommit *commit;
 
 	g_return_val_if_fail (ifindex > 0, FALSE);
 	g_return_val_if_fail (config != NULL, FALSE);
 
 	/* Addresses */
-	nm_platform_ip6_address_sync (NM_PLATFORM_GET, ifindex, priv->addresses, TRUE);
+	commit = _committed_addresses_get (ifindex);
+	nm_platform_ip6_address_sync (NM_PLATFORM_GET, ifindex, priv->addresses, commit, TRUE);
+	if (!commit->known_addresses)
+		g_hash_table_remove (committed_addresses, GINT_TO_POINTER (ifindex));
 
 	/* Routes */
 	{
@@ -714,8 +962,12 @@ nm_ip6_config_merge (NMIP6Config *dst, const NMIP6Config *src, NMIPConfigMergeFl
 	g_object_freeze_notify (G_OBJECT (dst));
 
 	/* addresses */
-	for (i = 0; i < nm_ip6_config_get_num_addresses (src); i++)
-		nm_ip6_config_add_address (dst, nm_ip6_config_get_address (src, i));
+	if (!dst_priv->addresses->len && src_priv->addresses->len)
+		_addresses_share (dst, src);
+	else {
+		for (i = 0; i < nm_ip6_config_get_num_addresses (src); i++)
+			nm_ip6_config_add_address (dst, nm_ip6_config_get_address (src, i));
+	}
 
 	/* nameservers */
 	if (!NM_FLAGS_HAS (merge_flags, NM_IP_CONFIG_MERGE_NO_DNS)) {
@@ -729,8 +981,14 @@ nm_ip6_config_merge (NMIP6Config *dst, const NMIP6Config *src, NMIPConfigMergeFl
 
 	/* routes */
 	if (!NM_FLAGS_HAS (merge_flags, NM_IP_CONFIG_MERGE_NO_ROUTES)) {
-		for (i = 0; i < nm_ip6_config_get_num_routes (src); i++)
-			nm_ip6_config_add_route (dst, nm_ip6_config_get_route (src, i));
+		if (   !dst_priv->routes->len
+		    && src_priv->routes->len
+		    && dst_priv->ifindex == src_priv->ifindex)
+			_routes_share (dst, src);
+		else {
+			for (i = 0; i < nm_ip6_config_get_num_routes (src); i++)
+				nm_ip6_config_add_route (dst, nm_ip6_config_get_route (src, i));
+		}
 	}
 
 	if (dst_priv->route_metric == -1)
@@ -789,12 +1047,120 @@ nm_ip6_config_destination_is_direct (const NMIP6Config *config, const struct in6
 
 /*****************************************************************************/
 
+/* Hundreds of routes from router advertisements would make add, subtract
+ * and intersect quadratic. So once an array reaches IDX_MIN_LEN entries,
+ * lookups go through a hash index over the identity of the entries. The
+ * index is created on the first lookup, extended on append and dropped
+ * whenever entries are removed or reordered. */
+#define IDX_MIN_LEN 16
+
+typedef struct {
+	struct in6_addr addr;
+	guint8 plen;
+} IdxKey;
+
+typedef void (*IdxKeyInitFunc) (IdxKey *key, gconstpointer item);
+
+static guint
+_idx_key_hash (gconstpointer ptr)
+{
+	const IdxKey *key = ptr;
+	guint h = key->plen;
+	guint i;
+
+	for (i = 0; i < sizeof (key->addr.s6_addr); i++)
+		h = (h * 33) + key->addr.s6_addr[i];
+	return h;
+}
+
+static gboolean
+_idx_key_equal (gconstpointer a, gconstpointer b)
+{
+	const IdxKey *k1 = a, *k2 = b;
+
+	return    IN6_ARE_ADDR_EQUAL (&k1->addr, &k2->addr)
+	       && k1->plen == k2->plen;
+}
+
+static void
+_idx_key_free (gpointer ptr)
+{
+	g_slice_free (IdxKey, ptr);
+}
+
+static void
+_idx_key_init_address (IdxKey *key, const NMPlatformIP6Address *a)
+{
+	/* identical keys if and only if addresses_are_duplicate() */
+	key->addr = a->address;
+	key->plen = 0;
+}
+
+static void
+_idx_key_init_route (IdxKey *key, const NMPlatformIP6Route *r)
+{
+	/* identical keys if and only if routes_are_duplicate() */
+	key->addr = r->network;
+	key->plen = r->plen;
+}
+
+static void
+_idx_add (GHashTable *idx, IdxKeyInitFunc key_init, gconstpointer item, guint i)
+{
+	IdxKey *key;
+
+	key = g_slice_new0 (IdxKey);
+	key_init (key, item);
+
+	/* like the linear search, find the first of duplicate entries */
+	if (g_hash_table_contains (idx, key)) {
+		_idx_key_free (key);
+		return;
+	}
+	g_hash_table_insert (idx, key, GUINT_TO_POINTER (i));
+}
+
+static int
+_idx_lookup (GHashTable **p_idx, const GArray *array, IdxKeyInitFunc key_init, gconstpointer needle)
+{
+	IdxKey key = { IN6ADDR_ANY_INIT };
+	gpointer value;
+	guint i;
+
+	if (!*p_idx) {
+		const guint elt_size = g_array_get_element_size ((GArray *) array);
+
+		*p_idx = g_hash_table_new_full (_idx_key_hash, _idx_key_equal, _idx_key_free, NULL);
+		for (i = 0; i < array->len; i++)
+			_idx_add (*p_idx, key_init, &array->data[i * elt_size], i);
+	}
+
+	key_init (&key, needle);
+	if (!g_hash_table_lookup_extended (*p_idx, &key, NULL, &value))
+		return -1;
+	return (int) GPOINTER_TO_UINT (value);
+}
+
+static void
+_idx_append (GHashTable *idx, IdxKeyInitFunc key_init, const GArray *array)
+{
+	const guint elt_size = g_array_get_element_size ((GArray *) array);
+
+	if (idx)
+		_idx_add (idx, key_init, &array->data[(array->len - 1) * elt_size], array->len - 1);
+}
+
 static int
 _addresses_get_index (const NMIP6Config *self, const NMPlatformIP6Address *addr)
 {
-	const NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE ((NMIP6Config *) self);
 	guint i;
 
+	if (priv->addresses->len >= IDX_MIN_LEN) {
+		return _idx_lookup (&priv->addresses_idx, priv->addresses,
+		                    (IdxKeyInitFunc) _idx_key_init_address, addr);
+	}
+
 	for (i = 0; i < priv->addresses->len; i++) {
 		const NMPlatformIP6Address *a = &g_array_index (priv->addresses, NMPlatformIP6Address, i);
 
@@ -822,9 +1188,14 @@ _nameservers_get_index (const NMIP6Config *self, const struct in6_addr *ns)
 static int
 _routes_get_index (const NMIP6Config *self, const NMPlatformIP6Route *route)
 {
-	const NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE ((NMIP6Config *) self);
 	guint i;
 
+	if (priv->routes->len >= IDX_MIN_LEN) {
+		return _idx_lookup (&priv->routes_idx, priv->routes,
+		                    (IdxKeyInitFunc) _idx_key_init_route, route);
+	}
+
 	for (i = 0; i < priv->routes->len; i++) {
 		const NMPlatformIP6Route *r = &g_array_index (priv->routes, NMPlatformIP6Route, i);
 
@@ -900,11 +1271,14 @@ nm_ip6_config_subtract (NMIP6Config *dst, const NMIP6Config *src)
 
 	g_object_freeze_notify (G_OBJECT (dst));
 
-	/* addresses */
-	for (i = 0; i < nm_ip6_config_get_num_addresses (src); i++) {
-		idx = _addresses_get_index (dst, nm_ip6_config_get_address (src, i));
+	/* addresses. Look up the entries of @dst in @src and not the other
+	 * way around, because deleting from @dst drops its index. */
+	for (i = 0; i < nm_ip6_config_get_num_addresses (dst); ) {
+		idx = _addresses_get_index (src, nm_ip6_config_get_address (dst, i));
 		if (idx >= 0)
-			nm_ip6_config_del_address (dst, idx);
+			nm_ip6_config_del_address (dst, i);
+		else
+			i++;
 	}
 
 	/* nameservers */
@@ -926,10 +1300,12 @@ nm_ip6_config_subtract (NMIP6Config *dst, const NMIP6Config *src)
 	/* ignore route_metric */
 
 	/* routes */
-	for (i = 0; i < nm_ip6_config_get_num_routes (src); i++) {
-		idx = _routes_get_index (dst, nm_ip6_config_get_route (src, i));
+	for (i = 0; i < nm_ip6_config_get_num_routes (dst); ) {
+		idx = _routes_get_index (src, nm_ip6_config_get_route (dst, i));
 		if (idx >= 0)
-			nm_ip6_config_del_route (dst, idx);
+			nm_ip6_config_del_route (dst, i);
+		else
+			i++;
 	}
 
 	/* domains */
@@ -1096,9 +1472,7 @@ nm_ip6_config_replace (NMIP6Config *dst, const NMIP6Config *src, gboolean *relev
 	} else
 		has_relevant_changes = TRUE;
 	if (!are_equal) {
-		nm_ip6_config_reset_addresses (dst);
-		for (i = 0; i < num; i++)
-			nm_ip6_config_add_address (dst, nm_ip6_config_get_address (src, i));
+		_addresses_share (dst, src);
 		has_minor_changes = TRUE;
 	}
 
@@ -1119,9 +1493,8 @@ nm_ip6_config_replace (NMIP6Config *dst, const NMIP6Config *src, gboolean *relev
 	} else
 		has_relevant_changes = TRUE;
 	if (!are_equal) {
-		nm_ip6_config_reset_routes (dst);
-		for (i = 0; i < num; i++)
-			nm_ip6_config_add_route (dst, nm_ip6_config_get_route (src, i));
+		/* the ifindex was already taken over from @src above */
+		_routes_share (dst, src);
 		has_minor_changes = TRUE;
 	}
 
@@ -1343,7 +1716,9 @@ nm_ip6_config_reset_addresses (NMIP6Config *config)
 	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (config);
 
 	if (priv->addresses->len != 0) {
+		_addresses_unshare (priv, FALSE);
 		g_array_set_size (priv->addresses, 0);
+		g_clear_pointer (&priv->addresses_idx, g_hash_table_unref);
 		notify_addresses (config);
 	}
 }
@@ -1367,39 +1742,41 @@ nm_ip6_config_add_address (NMIP6Config *config, const NMPlatformIP6Address *new)
 
 	g_return_if_fail (new != NULL);
 
-	for (i = 0; i < priv->addresses->len; i++ ) {
+	_addresses_unshare (priv, TRUE);
+
+	i = _addresses_get_index (config, new);
+	if (i >= 0) {
 		NMPlatformIP6Address *item = &g_array_index (priv->addresses, NMPlatformIP6Address, i);
 
-		if (addresses_are_duplicate (item, new)) {
-			if (nm_platform_ip6_address_cmp (item, new) == 0)
-				return;
-
-			/* remember the old values. */
-			item_old = *item;
-			/* Copy over old item to get new lifetime, timestamp, preferred */
-			*item = *new;
-
-			/* But restore highest priority source */
-			item->addr_source = MAX (item_old.addr_source, new->addr_source);
-
-			/* for addresses that we read from the kernel, we keep the timestamps as defined
-			 * by the previous source (item_old). The reason is, that the other source configured the lifetimes
-			 * with "what should be" and the kernel values are "what turned out after configuring it".
-			 *
-			 * For other sources, the longer lifetime wins. */
-			if (   (new->addr_source == NM_IP_CONFIG_SOURCE_KERNEL && new->addr_source != item_old.addr_source)
-			    || nm_platform_ip_address_cmp_expiry ((const NMPlatformIPAddress *) &item_old, (const NMPlatformIPAddress *) new) > 0) {
-				item->timestamp = item_old.timestamp;
-				item->lifetime = item_old.lifetime;
-				item->preferred = item_old.preferred;
-			}
-			if (nm_platform_ip6_address_cmp (&item_old, item) == 0)
-				return;
-			goto NOTIFY;
+		if (nm_platform_ip6_address_cmp (item, new) == 0)
+			return;
+
+		/* remember the old values. */
+		item_old = *item;
+		/* Copy over old item to get new lifetime, timestamp, preferred */
+		*item = *new;
+
+		/* But restore highest priority source */
+		item->addr_source = MAX (item_old.addr_source, new->addr_source);
+
+		/* for addresses that we read from the kernel, we keep the timestamps as defined
+		 * by the previous source (item_old). The reason is, that the other source configured the lifetimes
+		 * with "what should be" and the kernel values are "what turned out after configuring it".
+		 *
+		 * For other sources, the longer lifetime wins. */
+		if (   (new->addr_source == NM_IP_CONFIG_SOURCE_KERNEL && new->addr_source != item_old.addr_source)
+		    || nm_platform_ip_address_cmp_expiry ((const NMPlatformIPAddress *) &item_old, (const NMPlatformIPAddress *) new) > 0) {
+			item->timestamp = item_old.timestamp;
+			item->lifetime = item_old.lifetime;
+			item->preferred = item_old.preferred;
 		}
+		if (nm_platform_ip6_address_cmp (&item_old, item) == 0)
+			return;
+		goto NOTIFY;
 	}
 
 	g_array_append_val (priv->addresses, *new);
+	_idx_append (priv->addresses_idx, (IdxKeyInitFunc) _idx_key_init_address, priv->addresses);
 NOTIFY:
 notify_addresses (config);
 }
@@ -1411,7 +1788,9 @@ nm_ip6_config_del_address (NMIP6Config *config, guint i)
 
 	g_return_if_fail (i < priv->addresses->len);
 
+	_addresses_unshare (priv, TRUE);
 	g_array_remove_index (priv->addresses, i);
+	g_clear_pointer (&priv->addresses_idx, g_hash_table_unref);
 
 	notify_addresses (config);
 }
@@ -1511,7 +1890,9 @@ nm_ip6_config_reset_routes (NMIP6Config *config)
 	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (config);
 
 	if (priv->routes->len != 0) {
+		_routes_unshare (priv, FALSE);
 		g_array_set_size (priv->routes, 0);
+		g_clear_pointer (&priv->routes_idx, g_hash_table_unref);
 		_notify (config, PROP_ROUTE_DATA);
 		_notify (config, PROP_ROUTES);
 	}
@@ -1538,23 +1919,25 @@ nm_ip6_config_add_route (NMIP6Config *config, const NMPlatformIP6Route *new)
 	g_return_if_fail (new->plen > 0 && new->plen <= 128);
 	g_return_if_fail (priv->ifindex > 0);
 
-	for (i = 0; i < priv->routes->len; i++ ) {
+	_routes_unshare (priv, TRUE);
+
+	i = _routes_get_index (config, new);
+	if (i >= 0) {
 		NMPlatformIP6Route *item = &g_array_index (priv->routes, NMPlatformIP6Route, i);
 
-		if (routes_are_duplicate (item, new, FALSE)) {
-			if (nm_platform_ip6_route_cmp (item, new) == 0)
-				return;
-			old_source = item->rt_source;
-			*item = *new;
-			/* Restore highest priority source */
-			item->rt_source = MAX (old_source, new->rt_source);
-			item->ifindex = priv->ifindex;
-			goto NOTIFY;
-		}
+		if (nm_platform_ip6_route_cmp (item, new) == 0)
+			return;
+		old_source = item->rt_source;
+		*item = *new;
+		/* Restore highest priority source */
+		item->rt_source = MAX (old_source, new->rt_source);
+		item->ifindex = priv->ifindex;
+		goto NOTIFY;
 	}
 
 	g_array_append_val (priv->routes, *new);
 	g_array_index (priv->routes, NMPlatformIP6Route, priv->routes->len - 1).ifindex = priv->ifindex;
+	_idx_append (priv->routes_idx, (IdxKeyInitFunc) _idx_key_init_route, priv->routes);
 NOTIFY:
 	_notify (config, PROP_ROUTE_DATA);
 	_notify (config, PROP_ROUTES);
@@ -1567,7 +1950,9 @@ nm_ip6_config_del_route (NMIP6Config *config, guint i)
 
 	g_return_if_fail (i < priv->routes->len);
 
+	_routes_unshare (priv, TRUE);
 	g_array_remove_index (priv->routes, i);
+	g_clear_pointer (&priv->routes_idx, g_hash_table_unref);
 	_notify (config, PROP_ROUTE_DATA);
 	_notify (config, PROP_ROUTES);
 }
@@ -2280,6 +2665,10 @@ finalize (GObject *object)
 
 	g_array_unref (priv->addresses);
 	g_array_unref (priv->routes);
+	if (priv->addresses_idx)
+		g_hash_table_unref (priv->addresses_idx);
+	if (priv->routes_idx)
+		g_hash_table_unref (priv->routes_idx);
 	g_array_unref (priv->nameservers);
 	g_ptr_array_unref (priv->domains);
 	g_ptr_array_unref (priv->searches);
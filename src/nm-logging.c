@@ -90,6 +90,15 @@ NMLogDomain _nm_logging_enabled_state[_LOGL_N_REAL] = {
 	[LOGL_ERR]  = LOGD_DEFAULT,
 };
 
+/* the domains recorded in the trace buffer, see nm_logging_recorder_setup(). */
+NMLogDomain _nm_logging_recorder_state[_LOGL_N_REAL];
+
+NMLogDomain _nm_logging_check_state[_LOGL_N_REAL] = {
+	[LOGL_INFO] = LOGD_DEFAULT,
+	[LOGL_WARN] = LOGD_DEFAULT,
+	[LOGL_ERR]  = LOGD_DEFAULT,
+};
+
 static struct Global {
 	NMLogLevel log_level;
 	bool uses_syslog:1;
@@ -177,9 +186,55 @@ G_STATIC_ASSERT (sizeof (NMLogDomain) >= sizeof (guint64));
 #define LOGD_DHCP_STRING    "DHCP"
 #define LOGD_IP_STRING      "IP"
 
+/* pseudo domain to configure the rate limit per call site */
+#define LOGD_CALLSITE_STRING "CALLSITE"
+
+/*****************************************************************************/
+
+/* Rate limiting allows at most @burst messages per @interval seconds, for
+ * each domain and for each call site. Further messages are suppressed and
+ * a summary with the number of suppressed messages is logged once the
+ * interval is over. Rate limits only apply to the logging backend, the
+ * trace buffer still records all messages. */
+
+#define RATELIMIT_INTERVAL_DEFAULT 5
+#define RATELIMIT_INTERVAL_MAX     3600
+#define RATELIMIT_CALLSITES        1024
+#define RATELIMIT_CALLSITES_PROBE  8
+
+typedef struct {
+	guint burst;
+	guint interval;
+} RateLimit;
+
+typedef struct {
+	gint64 window_start_ms;
+	guint count;
+	guint suppressed;
+	NMLogLevel suppressed_level;
+} RateLimitState;
+
+typedef struct {
+	const char *file;
+	guint line;
+	NMLogDomain domain;
+	RateLimitState state;
+} RateLimitCallsite;
+
+static struct {
+	GMutex lock;
+	bool enabled;
+	guint flush_id;
+	RateLimit domain_limit[64];
+	RateLimitState domain_state[64];
+	RateLimit callsite_limit;
+	RateLimitCallsite callsites[RATELIMIT_CALLSITES];
+} ratelimit;
+
 /*****************************************************************************/
 
 static char *_domains_to_string (gboolean include_level_override);
+static gboolean _ratelimit_flush (gboolean force);
 
 /*****************************************************************************/
 
@@ -268,6 +323,38 @@ match_log_level (const char  *level,
 	return FALSE;
 }
 
+static gboolean
+parse_rate_limit (const char  *str,
+                  RateLimit   *out_limit,
+                  GError     **error)
+{
+	gs_free char *burst = g_strdup (str);
+	char *interval;
+	gint64 v;
+
+	*out_limit = (RateLimit) { .interval = RATELIMIT_INTERVAL_DEFAULT };
+
+	interval = strchr (burst, '/');
+	if (interval) {
+		*interval++ = '\0';
+		v = _nm_utils_ascii_str_to_int64 (interval, 10, 1, RATELIMIT_INTERVAL_MAX, -1);
+		if (v == -1)
+			goto fail;
+		out_limit->interval = v;
+	}
+
+	v = _nm_utils_ascii_str_to_int64 (burst, 10, 0, G_MAXUINT, -1);
+	if (v == -1)
+		goto fail;
+	out_limit->burst = v;
+	return TRUE;
+
+fail:
+	g_set_error (error, NM_MANAGER_ERROR, NM_MANAGER_ERROR_INVALID_ARGUMENTS,
+	             _("Invalid rate limit '%s'"), str);
+	return FALSE;
+}
+
 gboolean
 nm_logging_setup (const char  *level,
                   const char  *domains,
@@ -277,6 +364,9 @@ nm_logging_setup (const char  *level,
 	GString *unrecognized = NULL;
 	NMLogDomain new_logging[G_N_ELEMENTS (_nm_logging_enabled_state)];
 	NMLogLevel new_log_level = global.log_level;
+	RateLimit new_domain_limit[G_N_ELEMENTS (ratelimit.domain_limit)] = { };
+	RateLimit new_callsite_limit = { };
+	gboolean keep = FALSE;
 	char **tmp, **iter;
 	int i;
 	gboolean had_platform_debug;
@@ -300,6 +390,10 @@ nm_logging_setup (const char  *level,
 			new_log_level = global.log_level;
 			for (i = 0; i < G_N_ELEMENTS (new_logging); i++)
 				new_logging[i] = _nm_logging_enabled_state[i];
+			for (i = 0; i < G_N_ELEMENTS (new_domain_limit); i++)
+				new_domain_limit[i] = ratelimit.domain_limit[i];
+			new_callsite_limit = ratelimit.callsite_limit;
+			keep = TRUE;
 		}
 	}
 
@@ -308,6 +402,8 @@ nm_logging_setup (const char  *level,
 		const LogDesc *diter;
 		NMLogLevel domain_log_level;
 		NMLogDomain bits;
+		RateLimit limit = { };
+		gboolean has_limit = FALSE;
 		char *p;
 
 		/* LOGD_VPN_PLUGIN is protected, that is, when setting ALL or DEFAULT,
@@ -318,6 +414,22 @@ nm_logging_setup (const char  *level,
 		if (!strlen (*iter))
 			continue;
 
+		p = strchr (*iter, '@');
+		if (p) {
+			*p = '\0';
+			if (!parse_rate_limit (p + 1, &limit, error)) {
+				g_strfreev (tmp);
+				return FALSE;
+			}
+			has_limit = TRUE;
+		}
+
+		if (!g_ascii_strcasecmp (*iter, LOGD_CALLSITE_STRING)) {
+			if (has_limit || !keep)
+				new_callsite_limit = limit;
+			continue;
+		}
+
 		p = strchr (*iter, ':');
 		if (p) {
 			*p = '\0';
@@ -379,6 +491,16 @@ nm_logging_setup (const char  *level,
 			}
 		}
 
+		/* with KEEP, the rate limit is only changed when given. */
+		if (   has_limit
+		    || (   !keep
+		        && domain_log_level != _LOGL_KEEP)) {
+			for (i = 0; i < G_N_ELEMENTS (new_domain_limit); i++) {
+				if (bits & (((NMLogDomain) 1) << i))
+					new_domain_limit[i] = limit;
+			}
+		}
+
 		if (domain_log_level == _LOGL_KEEP) {
 			for (i = 0; i < G_N_ELEMENTS (new_logging); i++)
 				new_logging[i] = (new_logging[i] & ~bits) | (_nm_logging_enabled_state[i] & bits);
@@ -402,8 +524,25 @@ nm_logging_setup (const char  *level,
 	had_platform_debug = nm_logging_enabled (LOGL_DEBUG, LOGD_PLATFORM);
 
 	global.log_level = new_log_level;
-	for (i = 0; i < G_N_ELEMENTS (new_logging); i++)
+	for (i = 0; i < G_N_ELEMENTS (new_logging); i++) {
 		_nm_logging_enabled_state[i] = new_logging[i];
+		_nm_logging_check_state[i] = new_logging[i] | _nm_logging_recorder_state[i];
+	}
+
+	/* report what was suppressed under the previous limits, before
+	 * starting over. */
+	g_mutex_lock (&ratelimit.lock);
+	_ratelimit_flush (TRUE);
+	ratelimit.enabled = !!new_callsite_limit.burst;
+	for (i = 0; i < G_N_ELEMENTS (new_domain_limit); i++) {
+		ratelimit.domain_limit[i] = new_domain_limit[i];
+		ratelimit.domain_state[i] = (RateLimitState) { };
+		if (new_domain_limit[i].burst)
+			ratelimit.enabled = TRUE;
+	}
+	ratelimit.callsite_limit = new_callsite_limit;
+	memset (ratelimit.callsites, 0, sizeof (ratelimit.callsites));
+	g_mutex_unlock (&ratelimit.lock);
 
 	if (   had_platform_debug
 	    && _nm_logging_clear_platform_logging_cache
@@ -454,6 +593,16 @@ nm_logging_domains_to_string (void)
 	return global.logging_domains_to_string;
 }
 
+static void
+_domains_append_rate_limit (GString *str, const RateLimit *limit)
+{
+	if (!limit->burst)
+		return;
+	g_string_append_printf (str, "@%u", limit->burst);
+	if (limit->interval != RATELIMIT_INTERVAL_DEFAULT)
+		g_string_append_printf (str, "/%u", limit->interval);
+}
+
 static char *
 _domains_to_string (gboolean include_level_override)
 {
@@ -475,26 +624,37 @@ _domains_to_string (gboolean include_level_override)
 			g_string_append_c (str, ',');
 		g_string_append (str, diter->name);
 
-		if (!include_level_override)
-			continue;
-
-		/* Check if it's logging at a lower level than the default. */
-		for (i = 0; i < global.log_level; i++) {
-			if (diter->num & _nm_logging_enabled_state[i]) {
-				g_string_append_printf (str, ":%s", global.level_desc[i].name);
-				break;
-			}
-		}
-		/* Check if it's logging at a higher level than the default. */
-		if (!(diter->num & _nm_logging_enabled_state[global.log_level])) {
-			for (i = global.log_level + 1; i < G_N_ELEMENTS (_nm_logging_enabled_state); i++) {
+		if (include_level_override) {
+			/* Check if it's logging at a lower level than the default. */
+			for (i = 0; i < global.log_level; i++) {
 				if (diter->num & _nm_logging_enabled_state[i]) {
 					g_string_append_printf (str, ":%s", global.level_desc[i].name);
 					break;
 				}
 			}
+			/* Check if it's logging at a higher level than the default. */
+			if (!(diter->num & _nm_logging_enabled_state[global.log_level])) {
+				for (i = global.log_level + 1; i < G_N_ELEMENTS (_nm_logging_enabled_state); i++) {
+					if (diter->num & _nm_logging_enabled_state[i]) {
+						g_string_append_printf (str, ":%s", global.level_desc[i].name);
+						break;
+					}
+				}
+			}
 		}
+
+		/* the rate limits are kept when only the level is changed, thus
+		 * they are always included. */
+		_domains_append_rate_limit (str, &ratelimit.domain_limit[__builtin_ctzll ((guint64) diter->num)]);
 	}
+
+	if (ratelimit.callsite_limit.burst) {
+		if (str->len)
+			g_string_append_c (str, ',');
+		g_string_append (str, LOGD_CALLSITE_STRING);
+		_domains_append_rate_limit (str, &ratelimit.callsite_limit);
+	}
+
 	return g_string_free (str, FALSE);
 }
 
@@ -535,13 +695,231 @@ nm_logging_get_level (NMLogDomain domain)
 {
 	NMLogLevel sl = _LOGL_OFF;
 
+	/* the trace buffer doesn't count, the level is passed on to
+	 * helper programs. */
 	G_STATIC_ASSERT (LOGL_TRACE == 0);
 	while (   sl > LOGL_TRACE
-	       && nm_logging_enabled (sl - 1, domain))
+	       && (_nm_logging_enabled_state[sl - 1] & domain))
 		sl--;
 	return sl;
 }
 
+/* The trace buffer is a flight recorder: it keeps the most recent messages
+ * in memory, independent of the configured logging level, so that they can
+ * be retrieved after an incident. Each message is stored as a RecorderEntry
+ * followed by the message text without terminating NUL. When the buffer is
+ * full, the oldest entries are overwritten. */
+
+#define RECORDER_MSG_MAX 1024
+
+typedef struct {
+	gint64 timestamp_us;
+	guint16 msg_len;
+	guint8 level;
+	guint8 domain_bit;
+} RecorderEntry;
+
+static struct {
+	GMutex lock;
+	guint8 *buf;
+	gsize size;
+	gsize head;
+	gsize used;
+} recorder;
+
+static void
+_recorder_copy_in (gsize pos, const void *data, gsize len)
+{
+	const gsize n = MIN (len, recorder.size - pos);
+
+	memcpy (&recorder.buf[pos], data, n);
+	memcpy (recorder.buf, ((const guint8 *) data) + n, len - n);
+}
+
+static void
+_recorder_copy_out (gsize pos, void *data, gsize len)
+{
+	const gsize n = MIN (len, recorder.size - pos);
+
+	memcpy (data, &recorder.buf[pos], n);
+	memcpy (((guint8 *) data) + n, recorder.buf, len - n);
+}
+
+static void
+_recorder_add (NMLogLevel level, NMLogDomain domain, const GTimeVal *tv, const char *msg)
+{
+	RecorderEntry entry;
+	gsize len, pos;
+
+	entry.timestamp_us = ((gint64) tv->tv_sec * G_USEC_PER_SEC) + tv->tv_usec;
+	entry.msg_len = NM_MIN (strlen (msg), (gsize) RECORDER_MSG_MAX);
+	entry.level = level;
+	entry.domain_bit = __builtin_ctzll ((guint64) domain);
+	len = sizeof (entry) + entry.msg_len;
+
+	g_mutex_lock (&recorder.lock);
+
+	if (len > recorder.size) {
+		g_mutex_unlock (&recorder.lock);
+		return;
+	}
+
+	while (recorder.size - recorder.used < len) {
+		RecorderEntry old;
+
+		_recorder_copy_out (recorder.head, &old, sizeof (old));
+		recorder.head = (recorder.head + sizeof (old) + old.msg_len) % recorder.size;
+		recorder.used -= sizeof (old) + old.msg_len;
+	}
+
+	pos = (recorder.head + recorder.used) % recorder.size;
+	_recorder_copy_in (pos, &entry, sizeof (entry));
+	_recorder_copy_in ((pos + sizeof (entry)) % recorder.size, msg, entry.msg_len);
+	recorder.used += len;
+
+	g_mutex_unlock (&recorder.lock);
+}
+
+/**
+ * nm_logging_recorder_setup:
+ * @size: the size of the trace buffer in bytes, or 0 to disable it
+ * @level: (allow-none): the least severe level of messages to record,
+ *   defaults to "DEBUG"
+ * @error: location for a #GError, or %NULL
+ *
+ * Sets up the trace buffer. The messages of all domains, except for
+ * VPN_PLUGIN, are recorded. Previously recorded messages are discarded.
+ *
+ * Returns: %FALSE if @level is invalid.
+ */
+gboolean
+nm_logging_recorder_setup (gsize size, const char *level, GError **error)
+{
+	NMLogLevel rec_level = LOGL_DEBUG;
+	gboolean had_platform_debug;
+	int i;
+
+	g_return_val_if_fail (!error || !*error, FALSE);
+
+	if (level && *level) {
+		if (!match_log_level (level, &rec_level, error))
+			return FALSE;
+		if (rec_level == _LOGL_KEEP) {
+			g_set_error (error, NM_MANAGER_ERROR, NM_MANAGER_ERROR_UNKNOWN_LOG_LEVEL,
+			             _("Unknown log level '%s'"), level);
+			return FALSE;
+		}
+		if (rec_level == _LOGL_OFF)
+			size = 0;
+	}
+
+	/* there must be room for at least one message. */
+	if (size)
+		size = NM_MAX (size, sizeof (RecorderEntry) + RECORDER_MSG_MAX);
+
+	g_mutex_lock (&recorder.lock);
+	g_free (recorder.buf);
+	recorder.buf = size ? g_malloc (size) : NULL;
+	recorder.size = size;
+	recorder.head = 0;
+	recorder.used = 0;
+	g_mutex_unlock (&recorder.lock);
+
+	had_platform_debug = nm_logging_enabled (LOGL_DEBUG, LOGD_PLATFORM);
+
+	for (i = 0; i < G_N_ELEMENTS (_nm_logging_recorder_state); i++) {
+		_nm_logging_recorder_state[i] =   (size && i >= rec_level)
+		                                ? (LOGD_ALL & ~LOGD_VPN_PLUGIN)
+		                                : LOGD_NONE;
+		_nm_logging_check_state[i] = _nm_logging_enabled_state[i] | _nm_logging_recorder_state[i];
+	}
+
+	if (   had_platform_debug
+	    && _nm_logging_clear_platform_logging_cache
+	    && !nm_logging_enabled (LOGL_DEBUG, LOGD_PLATFORM))
+		_nm_logging_clear_platform_logging_cache ();
+
+	return TRUE;
+}
+
+/**
+ * nm_logging_recorder_get_size:
+ *
+ * Returns: the size of the trace buffer in bytes, or 0 if it is disabled.
+ */
+gsize
+nm_logging_recorder_get_size (void)
+{
+	gsize size;
+
+	g_mutex_lock (&recorder.lock);
+	size = recorder.size;
+	g_mutex_unlock (&recorder.lock);
+	return size;
+}
+
+/**
+ * nm_logging_recorder_to_variant:
+ *
+ * Returns: (transfer floating): a variant of type "a(tsss)" with the
+ *   recorded messages, oldest first. Each entry consists of the wall
+ *   clock time in microseconds, the level, the logging domain and
+ *   the message.
+ */
+GVariant *
+nm_logging_recorder_to_variant (void)
+{
+	GVariantBuilder builder;
+	char msg[RECORDER_MSG_MAX + 1];
+	gsize pos, remaining;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(tsss)"));
+
+	g_mutex_lock (&recorder.lock);
+
+	pos = recorder.head;
+	remaining = recorder.used;
+	while (remaining > 0) {
+		RecorderEntry entry;
+		const LogDesc *diter;
+		const char *domain_name = "";
+		const char *end;
+		gsize len;
+
+		_recorder_copy_out (pos, &entry, sizeof (entry));
+		_recorder_copy_out ((pos + sizeof (entry)) % recorder.size, msg, entry.msg_len);
+		msg[entry.msg_len] = '\0';
+
+		/* truncated messages may end inside a UTF-8 sequence, and the
+		 * messages are not guaranteed to be valid UTF-8 anyway. */
+		while (!g_utf8_validate (msg, entry.msg_len, &end))
+			msg[end - msg] = '?';
+
+		for (diter = &global.domain_desc[0]; diter->name; diter++) {
+			if (diter->num == (((NMLogDomain) 1) << entry.domain_bit)) {
+				domain_name = diter->name;
+				break;
+			}
+		}
+
+		g_variant_builder_add (&builder, "(tsss)",
+		                       (guint64) entry.timestamp_us,
+		                       global.level_desc[entry.level].name,
+		                       domain_name,
+		                       msg);
+
+		len = sizeof (entry) + entry.msg_len;
+		pos = (pos + len) % recorder.size;
+		remaining -= len;
+	}
+
+	g_mutex_unlock (&recorder.lock);
+
+	return g_variant_builder_end (&builder);
+}
+
+/*****************************************************************************/
+
 #if SYSTEMD_JOURNAL
 static void
 _iovec_set (struct iovec *iov, const void *str, gsize len)
@@ -587,54 +965,36 @@ _iovec_set_format (struct iovec *iov, gpointer *iov_free, const char *format, ..
 	} G_STMT_END
 #endif
 
-void
-_nm_log_impl (const char *file,
-              guint line,
-              const char *func,
-              NMLogLevel level,
-              NMLogDomain domain,
-              int error,
-              const char *ifname,
-              const char *conn_uuid,
-              const char *fmt,
-              ...)
-{
-	va_list args;
-	char *msg;
-	GTimeVal tv;
-	int errno_saved;
-
-	if ((guint) level >= G_N_ELEMENTS (_nm_logging_enabled_state))
-		g_return_if_reached ();
-
-	if (!(_nm_logging_enabled_state[level] & domain))
-		return;
-
-	errno_saved = errno;
-
-	/* Make sure that %m maps to the specified error */
-	if (error != 0) {
-		if (error < 0)
-			error = -error;
-		errno = error;
-	}
+/*****************************************************************************/
 
-	va_start (args, fmt);
-	msg = g_strdup_vprintf (fmt, args);
-	va_end (args);
+typedef struct {
+	const char *file;
+	const char *func;
+	const char *ifname;
+	const char *conn_uuid;
+	const char *msg;
+	guint line;
+	NMLogLevel level;
+	NMLogDomain domain;
+	NMLogDomain domain_enabled;
+	int error;
+	GTimeVal tv;
+	gint64 now_ns;
+} LogRecord;
 
+static void
+_log_write (const LogRecord *r)
+{
 #define MESSAGE_FMT "%s%-7s [%ld.%04ld] %s"
-#define MESSAGE_ARG(global, tv, msg) \
+#define MESSAGE_ARG(global, r) \
     (global).prefix, \
-    (global).level_desc[level].level_str, \
-    (tv).tv_sec, \
-    ((tv).tv_usec / 100), \
-    (msg)
-
-	g_get_current_time (&tv);
+    (global).level_desc[(r)->level].level_str, \
+    (r)->tv.tv_sec, \
+    ((r)->tv.tv_usec / 100), \
+    (r)->msg
 
 	if (global.debug_stderr)
-		g_printerr (MESSAGE_FMT"\n", MESSAGE_ARG (global, tv, msg));
+		g_printerr (MESSAGE_FMT"\n", MESSAGE_ARG (global, r));
 
 	switch (global.log_backend) {
 #if SYSTEMD_JOURNAL
@@ -648,19 +1008,19 @@ _nm_log_impl (const char *file,
 			gpointer *iov_free = iov_free_data;
 			nm_auto_free_gstring GString *s_domain_all = NULL;
 
-			now = nm_utils_get_monotonic_timestamp_ns ();
+			now = r->now_ns;
 			boottime = nm_utils_monotonic_timestamp_as_boottime (now, 1);
 
-			_iovec_set_format_a (iov++, 30, "PRIORITY=%d", global.level_desc[level].syslog_level);
-			_iovec_set_format (iov++, iov_free++, "MESSAGE="MESSAGE_FMT, MESSAGE_ARG (global, tv, msg));
+			_iovec_set_format_a (iov++, 30, "PRIORITY=%d", global.level_desc[r->level].syslog_level);
+			_iovec_set_format (iov++, iov_free++, "MESSAGE="MESSAGE_FMT, MESSAGE_ARG (global, r));
 			_iovec_set_string (iov++, syslog_identifier_full (&global));
 			_iovec_set_format_a (iov++, 30, "SYSLOG_PID=%ld", (long) getpid ());
 			{
 				const LogDesc *diter;
 				int i_domain = _NUM_MAX_FIELDS_SYSLOG_FACILITY;
 				const char *s_domain_1 = NULL;
-				NMLogDomain dom_all = domain;
-				NMLogDomain dom = dom_all & _nm_logging_enabled_state[level];
+				NMLogDomain dom_all = r->domain;
+				NMLogDomain dom = r->domain_enabled;
 
 				for (diter = &global.domain_desc[0]; diter->name; diter++) {
 					if (!NM_FLAGS_HAS (dom_all, diter->num))
@@ -697,19 +1057,19 @@ _nm_log_impl (const char *file,
 				else
 					_iovec_set_format_a (iov++, _MAX_LEN (30, s_domain_1), "NM_LOG_DOMAINS=%s", s_domain_1);
 			}
-			_iovec_set_format_a (iov++, _MAX_LEN (15, global.level_desc[level].name), "NM_LOG_LEVEL=%s", global.level_desc[level].name);
-			if (func)
-				_iovec_set_format (iov++, iov_free++, "CODE_FUNC=%s", func);
-			_iovec_set_format (iov++, iov_free++, "CODE_FILE=%s", file ?: "");
-			_iovec_set_format_a (iov++, 20, "CODE_LINE=%u", line);
+			_iovec_set_format_a (iov++, _MAX_LEN (15, global.level_desc[r->level].name), "NM_LOG_LEVEL=%s", global.level_desc[r->level].name);
+			if (r->func)
+				_iovec_set_format (iov++, iov_free++, "CODE_FUNC=%s", r->func);
+			_iovec_set_format (iov++, iov_free++, "CODE_FILE=%s", r->file ?: "");
+			_iovec_set_format_a (iov++, 20, "CODE_LINE=%u", r->line);
 			_iovec_set_format_a (iov++, 60, "TIMESTAMP_MONOTONIC=%lld.%06lld", (long long) (now / NM_UTILS_NS_PER_SECOND), (long long) ((now % NM_UTILS_NS_PER_SECOND) / 1000));
 			_iovec_set_format_a (iov++, 60, "TIMESTAMP_BOOTTIME=%lld.%06lld", (long long) (boottime / NM_UTILS_NS_PER_SECOND), (long long) ((boottime % NM_UTILS_NS_PER_SECOND) / 1000));
-			if (error != 0)
-				_iovec_set_format_a (iov++, 30, "ERRNO=%d", error);
-			if (ifname)
-				_iovec_set_format (iov++, iov_free++, "NM_DEVICE=%s", ifname);
-			if (conn_uuid)
-				_iovec_set_format (iov++, iov_free++, "NM_CONNECTION=%s", conn_uuid);
+			if (r->error != 0)
+				_iovec_set_format_a (iov++, 30, "ERRNO=%d", r->error);
+			if (r->ifname)
+				_iovec_set_format (iov++, iov_free++, "NM_DEVICE=%s", r->ifname);
+			if (r->conn_uuid)
+				_iovec_set_format (iov++, iov_free++, "NM_CONNECTION=%s", r->conn_uuid);
 
 			nm_assert (iov <= &iov_data[G_N_ELEMENTS (iov_data)]);
 			nm_assert (iov_free <= &iov_free_data[G_N_ELEMENTS (iov_free_data)]);
@@ -722,14 +1082,476 @@ _nm_log_impl (const char *file,
 		break;
 #endif
 	case LOG_BACKEND_SYSLOG:
-		syslog (global.level_desc[level].syslog_level,
-		        MESSAGE_FMT, MESSAGE_ARG (global, tv, msg));
+		syslog (global.level_desc[r->level].syslog_level,
+		        MESSAGE_FMT, MESSAGE_ARG (global, r));
 		break;
 	default:
-		g_log (syslog_identifier_domain (&global), global.level_desc[level].g_log_level,
-		       MESSAGE_FMT, MESSAGE_ARG (global, tv, msg));
+		g_log (syslog_identifier_domain (&global), global.level_desc[r->level].g_log_level,
+		       MESSAGE_FMT, MESSAGE_ARG (global, r));
 		break;
 	}
+}
+
+/*****************************************************************************/
+
+/* With the writer thread, _nm_log_impl() only formats the message and
+ * queues it. Writing to syslog or the journal, which may block, happens
+ * on the writer thread. When the queue is full, messages are dropped and
+ * the number of dropped messages is logged later. */
+
+#define LOG_WRITER_QUEUE_SIZE 4096
+#define LOG_WRITER_BATCH_SIZE 64
+
+static struct {
+	GMutex lock;
+	GCond cond;
+	GThread *thread;
+	LogRecord *queue[LOG_WRITER_QUEUE_SIZE];
+	guint head;
+	guint len;
+	guint64 n_dropped;
+	bool stop;
+} log_writer;
+
+static LogRecord *
+_log_record_dup (const LogRecord *r)
+{
+	LogRecord *dup;
+	gsize l_msg, l_ifname, l_conn_uuid;
+	char *s;
+
+	l_msg = strlen (r->msg) + 1;
+	l_ifname = r->ifname ? strlen (r->ifname) + 1 : 0;
+	l_conn_uuid = r->conn_uuid ? strlen (r->conn_uuid) + 1 : 0;
+
+	/* the record and its strings are allocated as one chunk. @file and
+	 * @func are static strings and not copied. */
+	dup = g_malloc (sizeof (LogRecord) + l_msg + l_ifname + l_conn_uuid);
+	*dup = *r;
+	s = (char *) &dup[1];
+
+	dup->msg = memcpy (s, r->msg, l_msg);
+	s += l_msg;
+	if (r->ifname) {
+		dup->ifname = memcpy (s, r->ifname, l_ifname);
+		s += l_ifname;
+	}
+	if (r->conn_uuid)
+		dup->conn_uuid = memcpy (s, r->conn_uuid, l_conn_uuid);
+	return dup;
+}
+
+static gboolean
+_log_writer_push (const LogRecord *r)
+{
+	LogRecord *dup;
+
+	dup = _log_record_dup (r);
+
+	g_mutex_lock (&log_writer.lock);
+	if (log_writer.stop) {
+		g_mutex_unlock (&log_writer.lock);
+		g_free (dup);
+		return FALSE;
+	}
+	if (log_writer.len >= LOG_WRITER_QUEUE_SIZE) {
+		log_writer.n_dropped++;
+		g_mutex_unlock (&log_writer.lock);
+		g_free (dup);
+		return TRUE;
+	}
+	log_writer.queue[(log_writer.head + log_writer.len) % LOG_WRITER_QUEUE_SIZE] = dup;
+	if (log_writer.len++ == 0)
+		g_cond_signal (&log_writer.cond);
+	g_mutex_unlock (&log_writer.lock);
+	return TRUE;
+}
+
+static void
+_log_write_dropped (guint64 n_dropped)
+{
+	gs_free char *msg = NULL;
+	LogRecord r = {
+		.file = __FILE__,
+		.line = __LINE__,
+		.func = G_STRFUNC,
+		.level = LOGL_WARN,
+		.domain = LOGD_CORE,
+		.domain_enabled = LOGD_CORE,
+	};
+
+	msg = g_strdup_printf ("logging: %"G_GUINT64_FORMAT" messages dropped, the log writer could not keep up",
+	                       n_dropped);
+	r.msg = msg;
+	g_get_current_time (&r.tv);
+	r.now_ns = nm_utils_get_monotonic_timestamp_ns ();
+	_log_write (&r);
+}
+
+static gpointer
+_log_writer_thread (gpointer user_data)
+{
+	LogRecord *batch[LOG_WRITER_BATCH_SIZE];
+	guint64 n_dropped;
+	guint i, n;
+
+	g_mutex_lock (&log_writer.lock);
+	for (;;) {
+		while (   !log_writer.len
+		       && !log_writer.n_dropped
+		       && !log_writer.stop)
+			g_cond_wait (&log_writer.cond, &log_writer.lock);
+
+		/* on stop, the queue is drained first. */
+		if (!log_writer.len && !log_writer.n_dropped)
+			break;
+
+		n_dropped = log_writer.n_dropped;
+		log_writer.n_dropped = 0;
+		n = MIN (log_writer.len, LOG_WRITER_BATCH_SIZE);
+		for (i = 0; i < n; i++) {
+			batch[i] = log_writer.queue[log_writer.head];
+			log_writer.head = (log_writer.head + 1) % LOG_WRITER_QUEUE_SIZE;
+		}
+		log_writer.len -= n;
+		g_mutex_unlock (&log_writer.lock);
+
+		if (n_dropped)
+			_log_write_dropped (n_dropped);
+		for (i = 0; i < n; i++) {
+			_log_write (batch[i]);
+			g_free (batch[i]);
+		}
+
+		g_mutex_lock (&log_writer.lock);
+	}
+	g_mutex_unlock (&log_writer.lock);
+	return NULL;
+}
+
+/*****************************************************************************/
+
+static void
+_ratelimit_write_summary (NMLogLevel level,
+                          NMLogDomain domain,
+                          const char *file,
+                          guint line,
+                          guint n_suppressed)
+{
+	gs_free char *msg = NULL;
+	const LogDesc *diter;
+	LogRecord r = {
+		.file = __FILE__,
+		.line = __LINE__,
+		.func = G_STRFUNC,
+		.level = level,
+		.domain = domain,
+		.domain_enabled = domain,
+	};
+
+	if (file)
+		msg = g_strdup_printf ("logging: %u messages from %s:%u suppressed", n_suppressed, file, line);
+	else {
+		for (diter = &global.domain_desc[0]; diter->name; diter++) {
+			if (diter->num == domain)
+				break;
+		}
+		msg = g_strdup_printf ("logging: %u messages of domain %s suppressed", n_suppressed, diter->name ?: "");
+	}
+	r.msg = msg;
+	g_get_current_time (&r.tv);
+	if (global.log_backend == LOG_BACKEND_JOURNAL)
+		r.now_ns = nm_utils_get_monotonic_timestamp_ns ();
+
+	if (   !log_writer.thread
+	    || !_log_writer_push (&r))
+		_log_write (&r);
+}
+
+/* Starts a new window if @now_ms is past the current one. Returns the number
+ * of messages suppressed in the window that ended. */
+static guint
+_ratelimit_state_advance (RateLimitState *state, const RateLimit *limit, gint64 now_ms)
+{
+	guint suppressed;
+
+	if (now_ms - state->window_start_ms < (gint64) limit->interval * 1000)
+		return 0;
+
+	suppressed = state->suppressed;
+	state->window_start_ms = now_ms;
+	state->count = 0;
+	state->suppressed = 0;
+	return suppressed;
+}
+
+static gboolean
+_ratelimit_state_take (RateLimitState *state, const RateLimit *limit, NMLogLevel level)
+{
+	if (state->count < limit->burst) {
+		state->count++;
+		return TRUE;
+	}
+	if (!state->suppressed || level > state->suppressed_level)
+		state->suppressed_level = level;
+	state->suppressed++;
+	return FALSE;
+}
+
+/* Logs the summaries of the windows that ended, or of all windows
+ * with @force. Returns whether there are suppressed messages left to report.
+ * Must be called with the lock held. */
+static gboolean
+_ratelimit_flush (gboolean force)
+{
+	gint64 now_ms;
+	gboolean pending = FALSE;
+	guint i, n;
+
+	if (!ratelimit.enabled)
+		return FALSE;
+
+	now_ms = force ? G_MAXINT64 / 2 : nm_utils_get_monotonic_timestamp_ms ();
+
+	for (i = 0; i < G_N_ELEMENTS (ratelimit.domain_state); i++) {
+		RateLimitState *state = &ratelimit.domain_state[i];
+
+		if (!state->suppressed)
+			continue;
+		n = _ratelimit_state_advance (state, &ratelimit.domain_limit[i], now_ms);
+		if (n)
+			_ratelimit_write_summary (state->suppressed_level, ((NMLogDomain) 1) << i, NULL, 0, n);
+		else
+			pending = TRUE;
+	}
+
+	for (i = 0; i < G_N_ELEMENTS (ratelimit.callsites); i++) {
+		RateLimitCallsite *callsite = &ratelimit.callsites[i];
+
+		if (!callsite->state.suppressed)
+			continue;
+		n = _ratelimit_state_advance (&callsite->state, &ratelimit.callsite_limit, now_ms);
+		if (n)
+			_ratelimit_write_summary (callsite->state.suppressed_level, callsite->domain, callsite->file, callsite->line, n);
+		else
+			pending = TRUE;
+	}
+
+	return pending;
+}
+
+static gboolean
+_ratelimit_flush_cb (gpointer user_data)
+{
+	gboolean pending;
+
+	g_mutex_lock (&ratelimit.lock);
+	pending = _ratelimit_flush (FALSE);
+	if (!pending)
+		ratelimit.flush_id = 0;
+	g_mutex_unlock (&ratelimit.lock);
+
+	return pending ? G_SOURCE_CONTINUE : G_SOURCE_REMOVE;
+}
+
+static RateLimitCallsite *
+_ratelimit_callsite_get (const char *file, guint line, NMLogDomain domain)
+{
+	guint h, i;
+
+	/* @file is a static string, comparing the pointer suffices. */
+	h = GPOINTER_TO_UINT (file) ^ (line * 2654435761u);
+	for (i = 0; i < RATELIMIT_CALLSITES_PROBE; i++) {
+		RateLimitCallsite *callsite = &ratelimit.callsites[(h + i) % RATELIMIT_CALLSITES];
+
+		if (!callsite->file) {
+			callsite->file = file;
+			callsite->line = line;
+			callsite->domain = domain;
+			return callsite;
+		}
+		if (   callsite->file == file
+		    && callsite->line == line)
+			return callsite;
+	}
+
+	/* the table is crowded, don't limit this call site. */
+	return NULL;
+}
+
+/* Returns whether the message may be written to the logging backend. */
+static gboolean
+_ratelimit_check (const char *file, guint line, NMLogLevel level, NMLogDomain domain)
+{
+	RateLimitCallsite *callsite;
+	gboolean allowed = TRUE;
+	NMLogDomain d;
+	gint64 now_ms;
+	guint i, n;
+
+	if (G_LIKELY (!ratelimit.enabled))
+		return TRUE;
+
+	/* outside the lock, because the first call logs a message. */
+	now_ms = nm_utils_get_monotonic_timestamp_ms ();
+
+	g_mutex_lock (&ratelimit.lock);
+
+	for (d = domain; d; d &= d - 1) {
+		RateLimitState *state;
+
+		i = __builtin_ctzll ((guint64) d);
+		if (!ratelimit.domain_limit[i].burst)
+			continue;
+
+		state = &ratelimit.domain_state[i];
+		n = _ratelimit_state_advance (state, &ratelimit.domain_limit[i], now_ms);
+		if (n)
+			_ratelimit_write_summary (state->suppressed_level, ((NMLogDomain) 1) << i, NULL, 0, n);
+		if (!_ratelimit_state_take (state, &ratelimit.domain_limit[i], level))
+			allowed = FALSE;
+	}
+
+	if (   ratelimit.callsite_limit.burst
+	    && (callsite = _ratelimit_callsite_get (file, line, domain))) {
+		n = _ratelimit_state_advance (&callsite->state, &ratelimit.callsite_limit, now_ms);
+		if (n)
+			_ratelimit_write_summary (callsite->state.suppressed_level, callsite->domain, file, line, n);
+		if (!_ratelimit_state_take (&callsite->state, &ratelimit.callsite_limit, level))
+			allowed = FALSE;
+	}
+
+	/* the summaries are also written when the storm is over and no
+	 * further message would start a new window. */
+	if (   !allowed
+	    && !ratelimit.flush_id)
+		ratelimit.flush_id = g_timeout_add_seconds (1, _ratelimit_flush_cb, NULL);
+
+	g_mutex_unlock (&ratelimit.lock);
+
+	return allowed;
+}
+
+/*****************************************************************************/
+
+/**
+ * nm_logging_start_writer_thread:
+ *
+ * Hand over the writing of logging messages to a separate thread, so
+ * that logging doesn't block the main loop. Must be called after
+ * nm_logging_syslog_openlog().
+ */
+void
+nm_logging_start_writer_thread (void)
+{
+	if (log_writer.thread)
+		g_return_if_reached ();
+
+	/* the monotonic timestamp logs a message on first access. */
+	nm_utils_get_monotonic_timestamp_ns ();
+
+	log_writer.stop = FALSE;
+	log_writer.thread = g_thread_new ("nm-log-writer", _log_writer_thread, NULL);
+}
+
+/**
+ * nm_logging_stop_writer_thread:
+ *
+ * Writes the pending messages and stops the writer thread. Afterwards,
+ * messages are written synchronously again.
+ */
+void
+nm_logging_stop_writer_thread (void)
+{
+	GThread *thread;
+
+	if (!log_writer.thread)
+		return;
+
+	g_mutex_lock (&log_writer.lock);
+	log_writer.stop = TRUE;
+	g_cond_signal (&log_writer.cond);
+	g_mutex_unlock (&log_writer.lock);
+
+	thread = log_writer.thread;
+	log_writer.thread = NULL;
+	g_thread_join (thread);
+}
+
+/*****************************************************************************/
+
+void
+_nm_log_impl (const char *file,
+              guint line,
+              const char *func,
+              NMLogLevel level,
+              NMLogDomain domain,
+              int error,
+              const char *ifname,
+              const char *conn_uuid,
+              const char *fmt,
+              ...)
+{
+	va_list args;
+	char *msg;
+	int errno_saved;
+	NMLogDomain domain_enabled;
+	LogRecord r;
+
+	if ((guint) level >= G_N_ELEMENTS (_nm_logging_enabled_state))
+		g_return_if_reached ();
+
+	if (!(_nm_logging_check_state[level] & domain))
+		return;
+
+	errno_saved = errno;
+
+	domain_enabled = domain & _nm_logging_enabled_state[level];
+	if (   domain_enabled
+	    && !_ratelimit_check (file, line, level, domain_enabled)) {
+		domain_enabled = LOGD_NONE;
+		if (!(_nm_logging_recorder_state[level] & domain)) {
+			errno = errno_saved;
+			return;
+		}
+	}
+
+	/* Make sure that %m maps to the specified error */
+	if (error != 0) {
+		if (error < 0)
+			error = -error;
+		errno = error;
+	}
+
+	va_start (args, fmt);
+	msg = g_strdup_vprintf (fmt, args);
+	va_end (args);
+
+	r = (LogRecord) {
+		.file = file,
+		.line = line,
+		.func = func,
+		.level = level,
+		.domain = domain,
+		.domain_enabled = domain_enabled,
+		.error = error,
+		.ifname = ifname,
+		.conn_uuid = conn_uuid,
+		.msg = msg,
+	};
+	g_get_current_time (&r.tv);
+
+	if (_nm_logging_recorder_state[level] & domain)
+		_recorder_add (level, domain & _nm_logging_recorder_state[level], &r.tv, msg);
+
+	if (r.domain_enabled) {
+		if (global.log_backend == LOG_BACKEND_JOURNAL)
+			r.now_ns = nm_utils_get_monotonic_timestamp_ns ();
+
+		if (   !log_writer.thread
+		    || !_log_writer_push (&r))
+			_log_write (&r);
+	}
 
 	g_free (msg);
 
@@ -205,12 +205,20 @@ const char *nm_logging_level_to_string (void);
 const char *nm_logging_domains_to_string (void);
 
 extern NMLogDomain _nm_logging_enabled_state[_LOGL_N_REAL];
+extern NMLogDomain _nm_logging_recorder_state[_LOGL_N_REAL];
+
+/* the union of _nm_logging_enabled_state and _nm_logging_recorder_state,
+ * so that the check costs a single load. All logging macros check it
+ * before evaluating their arguments, so that disabled messages are never
+ * formatted. */
+extern NMLogDomain _nm_logging_check_state[_LOGL_N_REAL];
+
 static inline gboolean
 nm_logging_enabled (NMLogLevel level, NMLogDomain domain)
 {
-	nm_assert (((guint) level) < G_N_ELEMENTS (_nm_logging_enabled_state));
-	return    (((guint) level) < G_N_ELEMENTS (_nm_logging_enabled_state))
-	       && !!(_nm_logging_enabled_state[level] & domain);
+	nm_assert (((guint) level) < G_N_ELEMENTS (_nm_logging_check_state));
+	return    (((guint) level) < G_N_ELEMENTS (_nm_logging_check_state))
+	       && !!(_nm_logging_check_state[level] & domain);
 }
 
 NMLogLevel nm_logging_get_level (NMLogDomain domain);
@@ -227,6 +235,13 @@ void nm_logging_set_syslog_identifier (const char *domain);
 void nm_logging_set_prefix (const char *format, ...) _nm_printf (1, 2);
 
 void     nm_logging_syslog_openlog (const char *logging_backend, gboolean debug);
+
+void     nm_logging_start_writer_thread (void);
+void     nm_logging_stop_writer_thread (void);
+
+gboolean  nm_logging_recorder_setup (gsize size, const char *level, GError **error);
+GVariant *nm_logging_recorder_to_variant (void);
+gsize     nm_logging_recorder_get_size (void);
 gboolean nm_logging_syslog_enabled (void);
 
 /*****************************************************************************/
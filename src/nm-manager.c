@@ -24,6 +24,7 @@
 #include "nm-manager.h"
 
 #include <stdlib.h>
+#include <stdio.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <string.h>
@@ -55,6 +56,8 @@
 #include "nm-checkpoint.h"
 #include "nm-checkpoint-manager.h"
 #include "nm-dispatcher.h"
+#include "nm-ip4-config.h"
+#include "nm-ip6-config.h"
 #include "NetworkManagerUtils.h"
 
 #include "introspection/org.freedesktop.NetworkManager.h"
@@ -144,6 +147,9 @@ typedef struct {
 	GSList *auth_chains;
 	GHashTable *sleep_devices;
 
+	/* external devices whose connection is generated only once needed */
+	GHashTable *lazy_external_devices;
+
 	/* Firmware dir monitor */
 	GFileMonitor *fw_monitor;
 	guint fw_changed_id;
@@ -152,6 +158,16 @@ typedef struct {
 
 	guint devices_inited_id;
 
+	/* ifindexes of links that were added or removed, handled on idle */
+	struct {
+		GHashTable *pending;
+		guint idle_id;
+	} link_cb;
+
+	/* per-interface arguments of nm-iface-helper, collected while
+	 * quitting in configure-and-quit mode. */
+	GPtrArray *iface_helper_args;
+
 	bool startup:1;
 	bool devices_inited:1;
 
@@ -328,7 +344,9 @@ active_connection_state_changed (NMActiveConnection *active,
 	NMSettingsConnection *con;
 
 	state = nm_active_connection_get_state (active);
-	if (state == NM_ACTIVE_CONNECTION_STATE_DEACTIVATED) {
+	if (state == NM_ACTIVE_CONNECTION_STATE_ACTIVATED)
+		nm_utils_startup_trace_add ("first-activation");
+	else if (state == NM_ACTIVE_CONNECTION_STATE_DEACTIVATED) {
 		/* Destroy active connections from an idle handler to ensure that
 		 * their last property change notifications go out, which wouldn't
 		 * happen if we destroyed them immediately when their state was set
@@ -450,28 +468,44 @@ _get_activatable_connections_filter (NMSettings *settings,
                                      NMSettingsConnection *connection,
                                      gpointer user_data)
 {
-	return !active_connection_find_first (user_data, connection, NULL, NM_ACTIVE_CONNECTION_STATE_DEACTIVATING);
+	return !g_hash_table_contains (user_data, connection);
 }
 
 /* Filter out connections that are already active.
  * nm_settings_get_connections_sorted() returns sorted list. We need to preserve the
  * order so that we didn't change auto-activation order (recent timestamps
  * are first).
- * Caller is responsible for freeing the returned list with g_slist_free().
+ * Caller is responsible for freeing the returned list with g_free().
  */
 NMSettingsConnection **
 nm_manager_get_activatable_connections (NMManager *manager, guint *out_len, gboolean sort)
 {
 	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (manager);
 	NMSettingsConnection **connections;
-	guint len;
-
-	connections = nm_settings_get_connections_clone (priv->settings, &len,
-	                                                 _get_activatable_connections_filter,
-	                                                 manager);
-	if (sort && len > 1)
-		g_qsort_with_data (connections, len, sizeof (connections[0]), nm_settings_connection_cmp_autoconnect_priority_p_with_data, NULL);
-	NM_SET_OUT (out_len, len);
+	gs_unref_hashtable GHashTable *active = NULL;
+	GSList *iter;
+
+	/* Collect the connections that are active once, instead of searching the
+	 * active connections again for every settings connection. */
+	for (iter = priv->active_connections; iter; iter = iter->next) {
+		NMActiveConnection *ac = iter->data;
+
+		if (nm_active_connection_get_state (ac) > NM_ACTIVE_CONNECTION_STATE_DEACTIVATING)
+			continue;
+		if (!active)
+			active = g_hash_table_new (NULL, NULL);
+		g_hash_table_add (active, nm_active_connection_get_settings_connection (ac));
+	}
+
+	if (sort) {
+		connections = nm_settings_get_connections_sorted_filtered (priv->settings, out_len,
+		                                                           active ? _get_activatable_connections_filter : NULL,
+		                                                           active);
+	} else {
+		connections = nm_settings_get_connections_clone (priv->settings, out_len,
+		                                                 active ? _get_activatable_connections_filter : NULL,
+		                                                 active);
+	}
 	return connections;
 }
 
@@ -918,6 +952,7 @@ check_if_startup_complete (NMManager *self)
 	}
 
 	_LOGI (LOGD_CORE, "startup complete");
+	nm_utils_startup_trace_finish ();
 
 	priv->startup = FALSE;
 
@@ -1001,7 +1036,9 @@ remove_device (NMManager *self,
 				nm_device_set_unmanaged_by_flags (device, NM_UNMANAGED_PLATFORM_INIT, TRUE, NM_DEVICE_STATE_REASON_REMOVED);
 			}
 		} else if (quitting && nm_config_get_configure_and_quit (priv->config)) {
-			nm_device_spawn_iface_helper (device);
+			if (!priv->iface_helper_args)
+				priv->iface_helper_args = g_ptr_array_new_with_free_func (g_free);
+			nm_device_get_iface_helper_args (device, priv->iface_helper_args);
 		}
 	}
 
@@ -1009,6 +1046,7 @@ remove_device (NMManager *self,
 
 	nm_settings_device_removed (priv->settings, device, quitting);
 	priv->devices = g_slist_remove (priv->devices, device);
+	g_hash_table_remove (priv->lazy_external_devices, device);
 
 	_parent_notify_changed (self, device, TRUE);
 
@@ -1683,13 +1721,196 @@ match_connection_filter (NMConnection *connection, gpointer user_data)
 	return nm_device_check_connection_compatible (NM_DEVICE (user_data), connection);
 }
 
+/* A checksum of the non-secret settings of @connection, independent of
+ * the order in which the settings were added. */
+static char *
+_connection_checksum (NMConnection *connection)
+{
+	gs_unref_variant GVariant *dict = NULL;
+	GChecksum *sum;
+	GPtrArray *names;
+	GVariantIter iter;
+	const char *name;
+	char *result;
+	guint i;
+
+	sum = g_checksum_new (G_CHECKSUM_SHA256);
+
+	dict = nm_connection_to_dbus (connection, NM_CONNECTION_SERIALIZE_NO_SECRETS);
+	if (dict) {
+		names = g_ptr_array_new ();
+		g_variant_iter_init (&iter, dict);
+		while (g_variant_iter_next (&iter, "{&s@a{sv}}", &name, NULL))
+			g_ptr_array_add (names, (gpointer) name);
+		g_ptr_array_sort (names, nm_strcmp_p);
+
+		for (i = 0; i < names->len; i++) {
+			gs_unref_variant GVariant *setting = NULL;
+			gs_free char *str = NULL;
+
+			setting = g_variant_lookup_value (dict, names->pdata[i], NM_VARIANT_TYPE_SETTING);
+			str = g_variant_print (setting, FALSE);
+			g_checksum_update (sum, (const guchar *) names->pdata[i], strlen (names->pdata[i]) + 1);
+			g_checksum_update (sum, (const guchar *) str, strlen (str) + 1);
+		}
+		g_ptr_array_free (names, TRUE);
+	}
+
+	result = g_strdup (g_checksum_get_string (sum));
+	g_checksum_free (sum);
+	return result;
+}
+
+static void
+_ip_addresses_append (GString *str, int addr_family, gconstpointer addr, guint8 plen)
+{
+	char buf[NM_UTILS_INET_ADDRSTRLEN];
+
+	if (str->len)
+		g_string_append_c (str, ',');
+	g_string_append_printf (str, "%s/%u",
+	                        addr_family == AF_INET
+	                          ? nm_utils_inet4_ntop (*((const in_addr_t *) addr), buf)
+	                          : nm_utils_inet6_ntop (addr, buf),
+	                        plen);
+}
+
+/* the addresses of @device that NetworkManager configured, as a comma
+ * separated list. IPv6 link-local addresses are skipped, because kernel
+ * adds them on its own. */
+static char *
+_device_get_ip_addresses (NMDevice *device)
+{
+	NMIP4Config *ip4_config = nm_device_get_ip4_config (device);
+	NMIP6Config *ip6_config = nm_device_get_ip6_config (device);
+	GString *str = g_string_new (NULL);
+	guint i, n;
+
+	if (ip4_config) {
+		n = nm_ip4_config_get_num_addresses (ip4_config);
+		for (i = 0; i < n; i++) {
+			const NMPlatformIP4Address *a = nm_ip4_config_get_address (ip4_config, i);
+
+			_ip_addresses_append (str, AF_INET, &a->address, a->plen);
+		}
+	}
+	if (ip6_config) {
+		n = nm_ip6_config_get_num_addresses (ip6_config);
+		for (i = 0; i < n; i++) {
+			const NMPlatformIP6Address *a = nm_ip6_config_get_address (ip6_config, i);
+
+			if (IN6_IS_ADDR_LINKLOCAL (&a->address))
+				continue;
+			_ip_addresses_append (str, AF_INET6, &a->address, a->plen);
+		}
+	}
+
+	return g_string_free (str, str->len == 0);
+}
+
+/* whether all addresses in @ip_addresses are still
+ * configured on the device. */
+static gboolean
+_device_has_ip_addresses (NMDevice *device, const char *ip_addresses)
+{
+	int ifindex = nm_device_get_ip_ifindex (device);
+	gs_strfreev char **tokens = NULL;
+	gs_unref_array GArray *addrs4 = NULL;
+	gs_unref_array GArray *addrs6 = NULL;
+	gs_unref_hashtable GHashTable *present = NULL;
+	GString *str;
+	guint i;
+
+	if (ifindex <= 0)
+		return FALSE;
+
+	present = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	str = g_string_new (NULL);
+
+	addrs4 = nm_platform_ip4_address_get_all (NM_PLATFORM_GET, ifindex);
+	for (i = 0; i < addrs4->len; i++) {
+		const NMPlatformIP4Address *a = &g_array_index (addrs4, NMPlatformIP4Address, i);
+
+		g_string_truncate (str, 0);
+		_ip_addresses_append (str, AF_INET, &a->address, a->plen);
+		g_hash_table_add (present, g_strdup (str->str));
+	}
+	addrs6 = nm_platform_ip6_address_get_all (NM_PLATFORM_GET, ifindex);
+	for (i = 0; i < addrs6->len; i++) {
+		const NMPlatformIP6Address *a = &g_array_index (addrs6, NMPlatformIP6Address, i);
+
+		g_string_truncate (str, 0);
+		_ip_addresses_append (str, AF_INET6, &a->address, a->plen);
+		g_hash_table_add (present, g_strdup (str->str));
+	}
+	g_string_free (str, TRUE);
+
+	tokens = g_strsplit (ip_addresses, ",", -1);
+	for (i = 0; tokens[i]; i++) {
+		if (!g_hash_table_contains (present, tokens[i]))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+/* Before restart, NetworkManager saved the checksum of the connection that
+ * was active on the device and its addresses. If the connection is unchanged
+ * and the addresses are still there, we can assume the connection right away,
+ * without generating a connection from the device and matching it. */
+static NMSettingsConnection *
+_get_saved_connection (NMManager *self,
+                       NMDevice *device,
+                       const NMConfigDeviceStateData *dev_state)
+{
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	NMSettingsConnection *connection;
+	gs_free char *checksum = NULL;
+
+	if (   !dev_state
+	    || !dev_state->connection_uuid
+	    || !dev_state->connection_checksum
+	    || !dev_state->ip_addresses)
+		return NULL;
+
+	connection = nm_settings_get_connection_by_uuid (priv->settings, dev_state->connection_uuid);
+	if (!connection)
+		return NULL;
+
+	if (active_connection_find_first (self, connection, NULL,
+	                                  NM_ACTIVE_CONNECTION_STATE_DEACTIVATING))
+		return NULL;
+
+	checksum = _connection_checksum (NM_CONNECTION (connection));
+	if (!nm_streq (checksum, dev_state->connection_checksum)) {
+		_LOGD (LOGD_DEVICE, "(%s): connection '%s' changed since it was active",
+		       nm_device_get_iface (device),
+		       nm_settings_connection_get_id (connection));
+		return NULL;
+	}
+
+	if (!nm_device_check_connection_compatible (device, NM_CONNECTION (connection)))
+		return NULL;
+
+	if (!_device_has_ip_addresses (device, dev_state->ip_addresses)) {
+		_LOGD (LOGD_DEVICE, "(%s): addresses of connection '%s' are no longer configured",
+		       nm_device_get_iface (device),
+		       nm_settings_connection_get_id (connection));
+		return NULL;
+	}
+
+	return connection;
+}
+
 /**
  * get_existing_connection:
  * @manager: #NMManager instance
  * @device: #NMDevice instance
- * @assume_connection_uuid: if present, try to assume a connection with this
- *   UUID. If no uuid is given or no matching connection is found, we
- *   only do external activation.
+ * @dev_state: (allow-none): the state of the device that was saved
+ *   before restart. If it contains a connection UUID, try to assume a
+ *   connection with this UUID. If no uuid is given or no matching
+ *   connection is found, we only do external activation.
+ * @allow_lazy: whether generating a connection for an external device
+ *   may be postponed until the connection is needed.
  * @out_generated: (allow-none): return TRUE, if the connection was generated.
  *
  * Returns: a #NMSettingsConnection to be assumed by the device, or %NULL if
@@ -1698,7 +1919,8 @@ match_connection_filter (NMConnection *connection, gpointer user_data)
 static NMSettingsConnection *
 get_existing_connection (NMManager *self,
                          NMDevice *device,
-                         const char *assume_connection_uuid,
+                         const NMConfigDeviceStateData *dev_state,
+                         gboolean allow_lazy,
                          gboolean *out_generated)
 {
 	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
@@ -1708,6 +1930,7 @@ get_existing_connection (NMManager *self,
 	NMDevice *master = NULL;
 	int ifindex = nm_device_get_ifindex (device);
 	NMSettingsConnection *matched;
+	const char *assume_connection_uuid = dev_state ? dev_state->connection_uuid : NULL;
 
 	if (out_generated)
 		*out_generated = FALSE;
@@ -1732,6 +1955,31 @@ get_existing_connection (NMManager *self,
 		}
 	}
 
+	matched = _get_saved_connection (self, device, dev_state);
+	if (matched) {
+		_LOGI (LOGD_DEVICE, "(%s): found saved connection '%s'",
+		       nm_device_get_iface (device),
+		       nm_settings_connection_get_id (matched));
+		return matched;
+	}
+
+	/* Generating and matching a connection is expensive. Devices that
+	 * nothing depends on yet are only remembered; their connection is
+	 * generated once a slave activates on them or they ask for a recheck. */
+	if (   allow_lazy
+	    && !assume_connection_uuid
+	    && nm_config_data_get_device_config_boolean (NM_CONFIG_GET_DATA,
+	                                                 NM_CONFIG_KEYFILE_KEY_DEVICE_LAZY_EXTERNAL_CONNECTION,
+	                                                 device,
+	                                                 FALSE,
+	                                                 FALSE)) {
+		_LOGD (LOGD_DEVICE, "(%s): postpone generating connection",
+		       nm_device_get_iface (device));
+		g_hash_table_add (priv->lazy_external_devices, device);
+		return NULL;
+	}
+	g_hash_table_remove (priv->lazy_external_devices, device);
+
 	/* The core of the API is nm_device_generate_connection() function and
 	 * update_connection() virtual method and the convenient connection_type
 	 * class attribute. Subclasses supporting the new API must have
@@ -1803,7 +2051,8 @@ get_existing_connection (NMManager *self,
 static gboolean
 recheck_assume_connection (NMManager *self,
                            NMDevice *device,
-                           const char *assume_connection_uuid)
+                           const NMConfigDeviceStateData *dev_state,
+                           gboolean allow_lazy)
 {
 	NMSettingsConnection *connection;
 	gboolean was_unmanaged = FALSE;
@@ -1826,7 +2075,7 @@ recheck_assume_connection (NMManager *self,
 	if (nm_device_sys_iface_state_get (device) != NM_DEVICE_SYS_IFACE_STATE_EXTERNAL)
 		return FALSE;
 
-	connection = get_existing_connection (self, device, assume_connection_uuid, &generated);
+	connection = get_existing_connection (self, device, dev_state, allow_lazy, &generated);
 	if (!connection) {
 		_LOGD (LOGD_DEVICE, "(%s): can't assume; no connection",
 		       nm_device_get_iface (device));
@@ -1906,7 +2155,7 @@ recheck_assume_connection (NMManager *self,
 static void
 recheck_assume_connection_cb (NMDevice *device, gpointer user_data)
 {
-	recheck_assume_connection (user_data, device, NULL);
+	recheck_assume_connection (user_data, device, NULL, FALSE);
 }
 
 static void
@@ -2000,7 +2249,7 @@ static void
 _device_realize_finish (NMManager *self,
                         NMDevice *device,
                         const NMPlatformLink *plink,
-                        const char *connection_uuid_to_assume)
+                        const NMConfigDeviceStateData *dev_state)
 {
 	g_return_if_fail (NM_IS_MANAGER (self));
 	g_return_if_fail (NM_IS_DEVICE (device));
@@ -2010,7 +2259,7 @@ _device_realize_finish (NMManager *self,
 	if (!nm_device_get_managed (device, FALSE))
 		return;
 
-	if (recheck_assume_connection (self, device, connection_uuid_to_assume))
+	if (recheck_assume_connection (self, device, dev_state, TRUE))
 		return;
 
 	/* if we failed to assume a connection for the managed device, but the device
@@ -2316,8 +2565,7 @@ platform_link_added (NMManager *self,
 		                             NULL,
 		                             &error)) {
 			add_device (self, device, NULL);
-			_device_realize_finish (self, device, plink,
-			                        dev_state ? dev_state->connection_uuid : NULL);
+			_device_realize_finish (self, device, plink, dev_state);
 		} else {
 			_LOGW (LOGD_DEVICE, "%s: failed to realize device: %s",
 			       plink->name, error->message);
@@ -2326,52 +2574,108 @@ platform_link_added (NMManager *self,
 	}
 }
 
-typedef struct {
-	NMManager *self;
-	int ifindex;
-} PlatformLinkCbData;
+static void
+platform_link_removed (NMManager *self, int ifindex)
+{
+	NMDevice *device;
+	GError *error = NULL;
+
+	device = nm_manager_get_device_by_ifindex (self, ifindex);
+	if (!device)
+		return;
+
+	if (nm_device_is_software (device)) {
+		/* Our software devices stick around until their connection is removed */
+		if (!nm_device_unrealize (device, FALSE, &error)) {
+			_LOGW (LOGD_DEVICE, "(%s): failed to unrealize: %s",
+			       nm_device_get_iface (device),
+			       error->message);
+			g_clear_error (&error);
+			remove_device (self, device, FALSE, TRUE);
+		}
+	} else {
+		/* Hardware and external devices always get removed when their kernel link is gone */
+		remove_device (self, device, FALSE, TRUE);
+	}
+}
+
+static int
+_platform_link_cmp_ifindex (gconstpointer a, gconstpointer b)
+{
+	const NMPlatformLink *link_a = a;
+	const NMPlatformLink *link_b = b;
+
+	return link_a->ifindex < link_b->ifindex ? -1 : (link_a->ifindex > link_b->ifindex);
+}
 
 static gboolean
-_platform_link_cb_idle (PlatformLinkCbData *data)
+_platform_link_cb_idle (gpointer user_data)
 {
-	NMManager *self = data->self;
-	const NMPlatformLink *l;
+	NMManager *self = user_data;
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	gs_unref_hashtable GHashTable *pending = NULL;
+	gs_free NMPlatformLink *links = NULL;
+	gs_free int *removed = NULL;
+	GHashTableIter iter;
+	gpointer ifindex_p;
+	guint i, n_links = 0, n_removed = 0, n_done = 0;
+	gboolean force = FALSE;
+
+	priv->link_cb.idle_id = 0;
+	pending = g_steal_pointer (&priv->link_cb.pending);
+
+	/* Look at the links as they are now. A link that was added and removed
+	 * again since it was queued is only handled once, in its final state. */
+	links = g_new (NMPlatformLink, g_hash_table_size (pending));
+	removed = g_new (int, g_hash_table_size (pending));
+	g_hash_table_iter_init (&iter, pending);
+	while (g_hash_table_iter_next (&iter, &ifindex_p, NULL)) {
+		const NMPlatformLink *l;
+
+		l = nm_platform_link_get (NM_PLATFORM_GET, GPOINTER_TO_INT (ifindex_p));
+		if (l)
+			links[n_links++] = *l; /* make a copy of the link instance */
+		else {
+			removed[n_removed++] = GPOINTER_TO_INT (ifindex_p);
+			g_hash_table_iter_remove (&iter);
+		}
+	}
 
-	if (!self)
-		goto out;
+	_LOGT (LOGD_PLATFORM, "process %u added and %u removed links", n_links, n_removed);
 
-	g_object_remove_weak_pointer (G_OBJECT (self), (gpointer *) &data->self);
+	/* Handle removed links first. A link that is recreated with the same name
+	 * then finds its software device unrealized and can take it over. */
+	for (i = 0; i < n_removed; i++)
+		platform_link_removed (self, removed[i]);
 
-	l = nm_platform_link_get (NM_PLATFORM_GET, data->ifindex);
-	if (l) {
-		NMPlatformLink pllink;
+	/* Create the devices for parents and masters before the devices for
+	 * the VLANs, macvlans or ports on top of them. @pending contains the
+	 * added links which are not yet handled. In the unexpected case that
+	 * the links depend on each other in a loop, handle them in order of
+	 * their ifindex. */
+	qsort (links, n_links, sizeof (NMPlatformLink), _platform_link_cmp_ifindex);
+	while (n_done < n_links) {
+		gboolean progress = FALSE;
 
-		pllink = *l; /* make a copy of the link instance */
-		platform_link_added (self, data->ifindex, &pllink, NULL);
-	} else {
-		NMDevice *device;
-		GError *error = NULL;
+		for (i = 0; i < n_links; i++) {
+			const NMPlatformLink *l = &links[i];
 
-		device = nm_manager_get_device_by_ifindex (self, data->ifindex);
-		if (device) {
-			if (nm_device_is_software (device)) {
-				/* Our software devices stick around until their connection is removed */
-				if (!nm_device_unrealize (device, FALSE, &error)) {
-					_LOGW (LOGD_DEVICE, "(%s): failed to unrealize: %s",
-					       nm_device_get_iface (device),
-					       error->message);
-					g_clear_error (&error);
-					remove_device (self, device, FALSE, TRUE);
-				}
-			} else {
-				/* Hardware and external devices always get removed when their kernel link is gone */
-				remove_device (self, device, FALSE, TRUE);
-			}
+			if (!g_hash_table_contains (pending, GINT_TO_POINTER (l->ifindex)))
+				continue;
+			if (   !force
+			    && (   (l->parent > 0 && g_hash_table_contains (pending, GINT_TO_POINTER (l->parent)))
+			        || (l->master > 0 && g_hash_table_contains (pending, GINT_TO_POINTER (l->master)))))
+				continue;
+
+			g_hash_table_remove (pending, GINT_TO_POINTER (l->ifindex));
+			platform_link_added (self, l->ifindex, l, NULL);
+			n_done++;
+			progress = TRUE;
 		}
+		if (!progress)
+			force = TRUE;
 	}
 
-out:
-	g_slice_free (PlatformLinkCbData, data);
 	return G_SOURCE_REMOVE;
 }
 
@@ -2383,17 +2687,19 @@ platform_link_cb (NMPlatform *platform,
                   int change_type_i,
                   gpointer user_data)
 {
+	NMManager *self = NM_MANAGER (user_data);
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
 	const NMPlatformSignalChangeType change_type = change_type_i;
-	PlatformLinkCbData *data;
 
 	switch (change_type) {
 	case NM_PLATFORM_SIGNAL_ADDED:
 	case NM_PLATFORM_SIGNAL_REMOVED:
-		data = g_slice_new (PlatformLinkCbData);
-		data->self = NM_MANAGER (user_data);
-		data->ifindex = ifindex;
-		g_object_add_weak_pointer (G_OBJECT (data->self), (gpointer *) &data->self);
-		g_idle_add ((GSourceFunc) _platform_link_cb_idle, data);
+		/* all links that change until the next idle are handled together. */
+		if (!priv->link_cb.pending)
+			priv->link_cb.pending = g_hash_table_new (NULL, NULL);
+		g_hash_table_add (priv->link_cb.pending, GINT_TO_POINTER (ifindex));
+		if (!priv->link_cb.idle_id)
+			priv->link_cb.idle_id = g_idle_add (_platform_link_cb_idle, self);
 		break;
 	default:
 		break;
@@ -2540,6 +2846,59 @@ impl_manager_get_all_devices (NMManager *self,
 	_get_devices (self, context, TRUE);
 }
 
+static void
+_add_object_properties (GVariantBuilder *builder,
+                        GHashTable *seen,
+                        gpointer object,
+                        const char *const *interfaces)
+{
+	const char *path;
+
+	if (!object)
+		return;
+
+	path = nm_exported_object_get_path (object);
+	if (!path || !nm_g_hash_table_add (seen, (gpointer) path))
+		return;
+
+	g_variant_builder_add (builder, "{o@a{sa{sv}}}",
+	                       path,
+	                       nm_exported_object_get_properties (object, interfaces));
+}
+
+static void
+impl_manager_get_devices_with_properties (NMManager *self,
+                                          GDBusMethodInvocation *context,
+                                          const char *const *interfaces,
+                                          gboolean include_referenced)
+{
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	gs_unref_hashtable GHashTable *seen = NULL;
+	GVariantBuilder builder;
+	GSList *iter;
+
+	seen = g_hash_table_new (g_str_hash, g_str_equal);
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{oa{sa{sv}}}"));
+
+	for (iter = priv->devices; iter; iter = iter->next) {
+		NMDevice *device = iter->data;
+
+		if (!nm_device_is_real (device))
+			continue;
+
+		_add_object_properties (&builder, seen, device, interfaces);
+		if (include_referenced) {
+			_add_object_properties (&builder, seen, nm_device_get_ip4_config (device), interfaces);
+			_add_object_properties (&builder, seen, nm_device_get_ip6_config (device), interfaces);
+			_add_object_properties (&builder, seen, nm_device_get_dhcp4_config (device), interfaces);
+			_add_object_properties (&builder, seen, nm_device_get_dhcp6_config (device), interfaces);
+		}
+	}
+
+	g_dbus_method_invocation_return_value (context,
+	                                       g_variant_new ("(a{oa{sa{sv}}})", &builder));
+}
+
 static void
 impl_manager_get_device_by_ip_iface (NMManager *self,
                                      GDBusMethodInvocation *context,
@@ -3239,6 +3598,14 @@ _internal_activate_device (NMManager *self, NMActiveConnection *active, GError *
 		return FALSE;
 	}
 
+	/* An external master whose connection was not generated yet must be
+	 * assumed now, instead of activating another connection on it. */
+	if (   master_device
+	    && !master_ac
+	    && g_hash_table_remove (NM_MANAGER_GET_PRIVATE (self)->lazy_external_devices, master_device)
+	    && recheck_assume_connection (self, master_device, NULL, FALSE))
+		master_ac = (NMActiveConnection *) nm_device_get_act_request (master_device);
+
 	/* Ensure there's a master active connection the new connection we're
 	 * activating can depend on.
 	 */
@@ -4065,6 +4432,287 @@ error:
 
 /*****************************************************************************/
 
+static NMActiveConnection *
+_add_and_activate_virtual_one (NMManager *self,
+                               NMConnection *connection,
+                               NMAuthSubject *subject,
+                               NMSettingsConnection **out_added,
+                               GError **error)
+{
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	NMSettingsConnection *added;
+	NMActiveConnection *active;
+	NMDevice *device;
+
+	/* Adding the connection emits "connection-added", which already
+	 * creates the software device via system_create_virtual_device(). */
+	added = nm_settings_add_connection (priv->settings, connection, TRUE, error);
+	if (!added)
+		return NULL;
+	*out_added = added;
+
+	device = nm_manager_get_best_device_for_connection (self, NM_CONNECTION (added), TRUE, NULL);
+	if (!device) {
+		gs_free char *iface = NULL;
+
+		iface = nm_manager_get_connection_iface (self, NM_CONNECTION (added), NULL, error);
+		if (!iface)
+			return NULL;
+		device = find_device_by_iface (self, iface, NM_CONNECTION (added), NULL);
+		if (!device) {
+			g_set_error_literal (error,
+			                     NM_MANAGER_ERROR,
+			                     NM_MANAGER_ERROR_UNKNOWN_DEVICE,
+			                     "Failed to find a compatible device for this connection");
+			return NULL;
+		}
+	}
+
+	active = _new_active_connection (self,
+	                                 NM_CONNECTION (added),
+	                                 NULL,
+	                                 NULL,
+	                                 device,
+	                                 subject,
+	                                 NM_ACTIVATION_TYPE_MANAGED,
+	                                 error);
+	if (!active)
+		return NULL;
+
+	/* The request was already authorized for network-control as a whole,
+	 * so contrary to ActivateConnection() there is no per-connection
+	 * nm_active_connection_authorize(). */
+	if (!_internal_activate_generic (self, active, error)) {
+		_internal_activation_failed (self, active, (*error)->message);
+		g_object_unref (active);
+		return NULL;
+	}
+
+	return active;
+}
+
+static void
+_add_and_activate_virtual_rollback_delete_cb (NMSettingsConnection *connection,
+                                              GError *error,
+                                              gpointer user_data)
+{
+	gs_unref_object NMAuthSubject *subject = user_data;
+
+	nm_audit_log_connection_op (NM_AUDIT_OP_CONN_DELETE, connection, !error, NULL,
+	                            subject, error ? error->message : NULL);
+}
+
+/* Undoes the entries of a request that succeeded before a later one
+ * failed, the last one first. */
+static void
+_add_and_activate_virtual_rollback (NMManager *self,
+                                    NMAuthSubject *subject,
+                                    GPtrArray *added_list,
+                                    GPtrArray *active_list)
+{
+	guint i;
+
+	nm_assert (added_list->len == active_list->len);
+
+	for (i = added_list->len; i > 0; i--) {
+		NMSettingsConnection *added = added_list->pdata[i - 1];
+		NMActiveConnection *active = active_list->pdata[i - 1];
+		GError *error = NULL;
+
+		if (   nm_active_connection_get_state (active) <= NM_ACTIVE_CONNECTION_STATE_ACTIVATED
+		    && !nm_manager_deactivate_connection (self,
+		                                          active,
+		                                          NM_DEVICE_STATE_REASON_CONNECTION_REMOVED,
+		                                          &error)) {
+			_LOGW (LOGD_CORE, "rollback: failed to deactivate connection '%s': %s",
+			       nm_settings_connection_get_id (added),
+			       error->message);
+			g_clear_error (&error);
+		}
+		nm_settings_connection_delete (added,
+		                               _add_and_activate_virtual_rollback_delete_cb,
+		                               g_object_ref (subject));
+	}
+}
+
+static void
+add_and_activate_virtual_auth_done_cb (NMAuthChain *chain,
+                                       GError *auth_error,
+                                       GDBusMethodInvocation *context,
+                                       gpointer user_data)
+{
+	NMManager *self = NM_MANAGER (user_data);
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	GPtrArray *connections;
+	NMAuthSubject *subject;
+	gs_unref_ptrarray GPtrArray *added_list = NULL;
+	gs_unref_ptrarray GPtrArray *active_list = NULL;
+	GVariantBuilder paths, active_paths;
+	GError *error = NULL;
+	guint i;
+
+	g_assert (context);
+
+	priv->auth_chains = g_slist_remove (priv->auth_chains, chain);
+
+	connections = nm_auth_chain_get_data (chain, "connections");
+	subject = nm_auth_chain_get_subject (chain);
+
+	if (auth_error) {
+		error = g_error_new (NM_MANAGER_ERROR,
+		                     NM_MANAGER_ERROR_PERMISSION_DENIED,
+		                     "Error checking authorization: %s",
+		                     auth_error->message);
+	} else if (   nm_auth_chain_get_result (chain, NM_AUTH_PERMISSION_NETWORK_CONTROL) != NM_AUTH_CALL_RESULT_YES
+	           || nm_auth_chain_get_result (chain, NM_AUTH_PERMISSION_SETTINGS_MODIFY_SYSTEM) != NM_AUTH_CALL_RESULT_YES) {
+		error = g_error_new_literal (NM_MANAGER_ERROR,
+		                             NM_MANAGER_ERROR_PERMISSION_DENIED,
+		                             "Not authorized to add and activate connections");
+	}
+
+	if (error) {
+		nm_audit_log_connection_op (NM_AUDIT_OP_CONN_ADD_ACTIVATE, NULL, FALSE, NULL,
+		                            subject, error->message);
+		g_dbus_method_invocation_take_error (context, error);
+		nm_auth_chain_unref (chain);
+		return;
+	}
+
+	added_list = g_ptr_array_new_with_free_func (g_object_unref);
+	active_list = g_ptr_array_new_with_free_func (g_object_unref);
+
+	for (i = 0; i < connections->len; i++) {
+		NMSettingsConnection *added = NULL;
+		NMActiveConnection *active;
+
+		active = _add_and_activate_virtual_one (self, connections->pdata[i], subject, &added, &error);
+		nm_audit_log_connection_op (NM_AUDIT_OP_CONN_ADD_ACTIVATE,
+		                            active ? added : NULL,
+		                            !!active,
+		                            NULL,
+		                            subject,
+		                            error ? error->message : NULL);
+		if (!active) {
+			if (added)
+				nm_settings_connection_delete (added, NULL, NULL);
+			g_prefix_error (&error, "'%s': ", nm_connection_get_id (connections->pdata[i]));
+			break;
+		}
+
+		g_ptr_array_add (added_list, g_object_ref (added));
+		g_ptr_array_add (active_list, active);
+	}
+
+	if (error) {
+		/* all or nothing: undo the entries before the failed one. */
+		_add_and_activate_virtual_rollback (self, subject, added_list, active_list);
+		g_dbus_method_invocation_take_error (context, error);
+		nm_auth_chain_unref (chain);
+		return;
+	}
+
+	g_variant_builder_init (&paths, G_VARIANT_TYPE ("ao"));
+	g_variant_builder_init (&active_paths, G_VARIANT_TYPE ("ao"));
+	for (i = 0; i < added_list->len; i++) {
+		g_variant_builder_add (&paths, "o", nm_connection_get_path (added_list->pdata[i]));
+		g_variant_builder_add (&active_paths, "o", nm_exported_object_get_path (active_list->pdata[i]));
+	}
+	g_dbus_method_invocation_return_value (context,
+	                                       g_variant_new ("(aoao)", &paths, &active_paths));
+
+	nm_auth_chain_unref (chain);
+}
+
+static void
+impl_manager_add_and_activate_virtual_connections (NMManager *self,
+                                                   GDBusMethodInvocation *context,
+                                                   GVariant *settings)
+{
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	gs_unref_ptrarray GPtrArray *connections = NULL;
+	gs_unref_object NMAuthSubject *subject = NULL;
+	NMAuthChain *chain;
+	GError *error = NULL;
+	GVariantIter iter;
+	GVariant *dict;
+	guint i;
+
+	subject = nm_auth_subject_new_unix_process_from_context (context);
+	if (!subject) {
+		error = g_error_new_literal (NM_MANAGER_ERROR,
+		                             NM_MANAGER_ERROR_PERMISSION_DENIED,
+		                             "Failed to get request UID.");
+		goto error;
+	}
+
+	/* Validate all connections upfront, so that a bogus entry does not leave
+	 * the request half done. */
+	connections = g_ptr_array_new_with_free_func (g_object_unref);
+	g_variant_iter_init (&iter, settings);
+	while ((dict = g_variant_iter_next_value (&iter))) {
+		NMConnection *connection;
+
+		connection = _nm_simple_connection_new_from_dbus (dict,
+		                                                    NM_SETTING_PARSE_FLAGS_STRICT
+		                                                  | NM_SETTING_PARSE_FLAGS_NORMALIZE,
+		                                                  &error);
+		g_variant_unref (dict);
+		if (!connection) {
+			g_prefix_error (&error, "connection #%u: ", connections->len);
+			goto error;
+		}
+		g_ptr_array_add (connections, connection);
+
+		if (!nm_connection_is_virtual (connection)) {
+			error = g_error_new (NM_MANAGER_ERROR,
+			                     NM_MANAGER_ERROR_INVALID_ARGUMENTS,
+			                     "connection '%s' is not for a software device",
+			                     nm_connection_get_id (connection));
+			goto error;
+		}
+	}
+
+	if (!connections->len) {
+		error = g_error_new_literal (NM_MANAGER_ERROR,
+		                             NM_MANAGER_ERROR_INVALID_ARGUMENTS,
+		                             "no connections given");
+		goto error;
+	}
+
+	for (i = 0; i < connections->len; i++) {
+		gs_free char *error_desc = NULL;
+
+		if (!nm_auth_is_subject_in_acl (connections->pdata[i], subject, &error_desc)) {
+			error = g_error_new_literal (NM_MANAGER_ERROR,
+			                             NM_MANAGER_ERROR_PERMISSION_DENIED,
+			                             error_desc);
+			goto error;
+		}
+	}
+
+	/* One authorization for the whole request instead of one per connection */
+	chain = nm_auth_chain_new_subject (subject, context, add_and_activate_virtual_auth_done_cb, self);
+	if (!chain) {
+		error = g_error_new_literal (NM_MANAGER_ERROR,
+		                             NM_MANAGER_ERROR_PERMISSION_DENIED,
+		                             "Unable to authenticate request.");
+		goto error;
+	}
+
+	priv->auth_chains = g_slist_append (priv->auth_chains, chain);
+	nm_auth_chain_set_data (chain, "connections", g_steal_pointer (&connections),
+	                        (GDestroyNotify) g_ptr_array_unref);
+	nm_auth_chain_add_call (chain, NM_AUTH_PERMISSION_NETWORK_CONTROL, TRUE);
+	nm_auth_chain_add_call (chain, NM_AUTH_PERMISSION_SETTINGS_MODIFY_SYSTEM, TRUE);
+	return;
+
+error:
+	nm_audit_log_connection_op (NM_AUDIT_OP_CONN_ADD_ACTIVATE, NULL, FALSE, NULL, subject, error->message);
+	g_dbus_method_invocation_take_error (context, error);
+}
+
+/*****************************************************************************/
+
 gboolean
 nm_manager_deactivate_connection (NMManager *manager,
                                   NMActiveConnection *active,
@@ -4820,6 +5468,149 @@ impl_manager_get_logging (NMManager *manager,
 	                                                      nm_logging_domains_to_string ()));
 }
 
+static void
+impl_manager_get_trace_buffer (NMManager *self,
+                               GDBusMethodInvocation *context)
+{
+	/* The permission is already enforced by the D-Bus daemon, see
+	 * impl_manager_set_logging(). */
+	if (!nm_bus_manager_ensure_uid (nm_bus_manager_get (),
+	                                context,
+	                                G_MAXULONG,
+	                                NM_MANAGER_ERROR,
+	                                NM_MANAGER_ERROR_PERMISSION_DENIED))
+		return;
+
+	g_dbus_method_invocation_return_value (context,
+	                                       g_variant_new ("(@a(tsss))",
+	                                                      nm_logging_recorder_to_variant ()));
+}
+
+static void
+_platform_statistics_add_cb (const char *name, guint64 value, gpointer user_data)
+{
+	g_variant_builder_add ((GVariantBuilder *) user_data, "{st}", name, value);
+}
+
+static void
+impl_manager_get_platform_statistics (NMManager *manager,
+                                      GDBusMethodInvocation *context)
+{
+	GVariantBuilder builder;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{st}"));
+	nm_platform_statistics_foreach (NM_PLATFORM_GET, _platform_statistics_add_cb, &builder);
+	g_dbus_method_invocation_return_value (context,
+	                                       g_variant_new ("(a{st})", &builder));
+}
+
+static void
+_memory_usage_add_cb (const char *name, guint64 n_objects, guint64 bytes, gpointer user_data)
+{
+	g_variant_builder_add ((GVariantBuilder *) user_data, "{s(tt)}", name, n_objects, bytes);
+}
+
+static void
+_memory_usage_add_process (GVariantBuilder *builder)
+{
+	gs_free char *contents = NULL;
+	unsigned long resident, data;
+	guint64 page_size;
+
+	if (!g_file_get_contents ("/proc/self/statm", &contents, NULL, NULL))
+		return;
+	if (sscanf (contents, "%*u %lu %*u %*u %*u %lu", &resident, &data) != 2)
+		return;
+
+	page_size = sysconf (_SC_PAGESIZE);
+	_memory_usage_add_cb ("process.rss", 1, (guint64) resident * page_size, builder);
+	_memory_usage_add_cb ("process.data", 1, (guint64) data * page_size, builder);
+}
+
+static void
+impl_manager_get_memory_usage (NMManager *self,
+                               GDBusMethodInvocation *context)
+{
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	GVariantBuilder builder;
+	NMSettingsConnection *const *connections;
+	guint i, len;
+	guint64 bytes = 0;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{s(tt)}"));
+
+	_memory_usage_add_process (&builder);
+
+	nm_platform_memory_usage_foreach (NM_PLATFORM_GET, _memory_usage_add_cb, &builder);
+
+	/* the settings are not stored as a flat buffer, but the size of their
+	 * serialization is a good estimate of the memory they take. */
+	connections = nm_settings_get_connections (priv->settings, &len);
+	for (i = 0; i < len; i++) {
+		gs_unref_variant GVariant *v = NULL;
+
+		v = nm_connection_to_dbus (NM_CONNECTION (connections[i]), NM_CONNECTION_SERIALIZE_ALL);
+		if (v)
+			bytes += g_variant_get_size (v);
+	}
+	_memory_usage_add_cb ("settings.connections", len, bytes, &builder);
+
+	_memory_usage_add_cb ("logging.trace-buffer", 1, nm_logging_recorder_get_size (), &builder);
+
+	nm_exported_object_memory_usage_foreach (_memory_usage_add_cb, &builder);
+
+	g_dbus_method_invocation_return_value (context,
+	                                       g_variant_new ("(a{s(tt)})", &builder));
+}
+
+static void
+impl_manager_get_vpn_plugins (NMManager *self,
+                              GDBusMethodInvocation *context)
+{
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+
+	g_dbus_method_invocation_return_value (context,
+	                                       g_variant_new ("(@a(ss))",
+	                                                      nm_vpn_manager_get_plugin_index (priv->vpn_manager)));
+}
+
+static void
+impl_manager_get_activation_statistics (NMManager *manager,
+                                        GDBusMethodInvocation *context)
+{
+	g_dbus_method_invocation_return_value (context,
+	                                       g_variant_new ("(@a{s(tttat)})",
+	                                                      nm_device_activation_statistics_to_variant ()));
+}
+
+static void
+impl_manager_get_dbus_statistics (NMManager *manager,
+                                  GDBusMethodInvocation *context)
+{
+	g_dbus_method_invocation_return_value (context,
+	                                       g_variant_new ("(@a{s((tttat)(tttat))})",
+	                                                      nm_exported_object_method_stats_to_variant ()));
+}
+
+static void
+impl_manager_get_changes_since (NMManager *manager,
+                                GDBusMethodInvocation *context,
+                                guint64 epoch,
+                                guint64 since)
+{
+	g_dbus_method_invocation_return_value (context,
+	                                       nm_exported_object_journal_get_changes_since (epoch, since));
+}
+
+static void
+impl_manager_get_startup_timeline (NMManager *manager,
+                                   GDBusMethodInvocation *context)
+{
+	g_dbus_method_invocation_return_value (context,
+	                                       g_variant_new ("(@a(st))",
+	                                                      nm_utils_startup_trace_to_variant ()));
+}
+
 typedef struct {
 	guint remaining;
 	GDBusMethodInvocation *context;
@@ -4939,6 +5730,8 @@ nm_manager_write_device_state (NMManager *self)
 		gboolean managed;
 		NMConnection *settings_connection;
 		const char *uuid = NULL;
+		gs_free char *checksum = NULL;
+		gs_free char *ip_addresses = NULL;
 		const char *perm_hw_addr_fake = NULL;
 		gboolean perm_hw_addr_is_fake;
 
@@ -4956,8 +5749,23 @@ nm_manager_write_device_state (NMManager *self)
 		managed = nm_device_get_managed (device, FALSE);
 		if (managed) {
 			settings_connection = NM_CONNECTION (nm_device_get_settings_connection (device));
-			if (settings_connection)
+			if (settings_connection) {
+				NMConnection *applied_connection = nm_device_get_applied_connection (device);
+
 				uuid = nm_connection_get_uuid (settings_connection);
+
+				/* only allow a quick reassume, if the profile is active as is. */
+				if (   nm_device_get_state (device) == NM_DEVICE_STATE_ACTIVATED
+				    && applied_connection
+				    && nm_connection_compare (applied_connection,
+				                              settings_connection,
+				                              NM_SETTING_COMPARE_FLAG_IGNORE_SECRETS |
+				                              NM_SETTING_COMPARE_FLAG_IGNORE_TIMESTAMP)) {
+					ip_addresses = _device_get_ip_addresses (device);
+					if (ip_addresses)
+						checksum = _connection_checksum (settings_connection);
+				}
+			}
 		}
 
 		perm_hw_addr_fake = nm_device_get_permanent_hw_address_full (device, FALSE, &perm_hw_addr_is_fake);
@@ -4968,7 +5776,9 @@ nm_manager_write_device_state (NMManager *self)
 		                                  ifindex,
 		                                  managed,
 		                                  perm_hw_addr_fake,
-		                                  uuid))
+		                                  uuid,
+		                                  checksum,
+		                                  ip_addresses))
 			g_hash_table_add (seen_ifindexes, GINT_TO_POINTER (ifindex));
 	}
 
@@ -5029,6 +5839,7 @@ nm_manager_start (NMManager *self, GError **error)
 	/* Start device factories */
 	nm_device_factory_manager_load_factories (_register_device_factory, self);
 	nm_device_factory_manager_for_each_factory (start_factory, NULL);
+	nm_utils_startup_trace_add ("device-factories-loaded");
 
 	nm_platform_process_events (NM_PLATFORM_GET);
 
@@ -5056,14 +5867,136 @@ nm_manager_start (NMManager *self, GError **error)
 	return TRUE;
 }
 
+static void
+spawn_iface_helper (NMManager *self)
+{
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	gs_unref_ptrarray GPtrArray *argv = NULL;
+	gs_free_error GError *error = NULL;
+	char *logging_backend;
+	guint i;
+	GPid pid;
+
+	if (!priv->iface_helper_args || !priv->iface_helper_args->len)
+		return;
+
+	/* one helper takes over all interfaces, so that there is only one
+	 * platform cache and netlink socket for them. */
+	argv = g_ptr_array_new_with_free_func (g_free);
+	g_ptr_array_add (argv, g_strdup (LIBEXECDIR "/nm-iface-helper"));
+
+	logging_backend = nm_config_get_is_debug (priv->config)
+	                  ? g_strdup ("debug")
+	                  : nm_config_data_get_value (NM_CONFIG_GET_DATA_ORIG,
+	                                              NM_CONFIG_KEYFILE_GROUP_LOGGING,
+	                                              NM_CONFIG_KEYFILE_KEY_LOGGING_BACKEND,
+	                                              NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY);
+	if (logging_backend) {
+		g_ptr_array_add (argv, g_strdup ("--logging-backend"));
+		g_ptr_array_add (argv, logging_backend);
+	}
+
+	g_ptr_array_add (argv, g_strdup ("--log-level"));
+	g_ptr_array_add (argv, g_strdup (nm_logging_level_to_string ()));
+
+	g_ptr_array_add (argv, g_strdup ("--log-domains"));
+	g_ptr_array_add (argv, g_strdup (nm_logging_domains_to_string ()));
+
+	for (i = 0; i < priv->iface_helper_args->len; i++)
+		g_ptr_array_add (argv, g_strdup (priv->iface_helper_args->pdata[i]));
+	g_ptr_array_add (argv, NULL);
+
+	g_clear_pointer (&priv->iface_helper_args, g_ptr_array_unref);
+
+	if (nm_logging_enabled (LOGL_DEBUG, LOGD_CORE)) {
+		gs_free char *tmp = NULL;
+
+		tmp = g_strjoinv (" ", (char **) argv->pdata);
+		_LOGD (LOGD_CORE, "running '%s'", tmp);
+	}
+
+	if (g_spawn_async (NULL, (char **) argv->pdata, NULL,
+	                   G_SPAWN_DO_NOT_REAP_CHILD, NULL, NULL, &pid, &error))
+		_LOGI (LOGD_CORE, "spawned nm-iface-helper PID %u", (guint) pid);
+	else
+		_LOGW (LOGD_CORE, "failed to spawn nm-iface-helper: %s", error->message);
+}
+
+typedef struct {
+	NMDevice *device;
+	/* the master and the parent, which must outlive the device */
+	NMDevice *deps[2];
+	guint n_children;
+} StopDevice;
+
 void
 nm_manager_stop (NMManager *self)
 {
 	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	gs_unref_hashtable GHashTable *by_device = NULL;
+	gs_free StopDevice *stop_devices = NULL;
+	GQueue ready = G_QUEUE_INIT;
+	StopDevice *d, *dep;
+	GSList *iter;
+	guint i, j, n;
+
+	/* Remove all devices, slaves and children before their master
+	 * and parent, so that no device is torn down while another one
+	 * still depends on it. Count the children of each device once and
+	 * remove a device when its last child is gone. */
+	n = g_slist_length (priv->devices);
+	stop_devices = g_new0 (StopDevice, n);
+	by_device = g_hash_table_new (NULL, NULL);
+	for (iter = priv->devices, i = 0; iter; iter = iter->next, i++) {
+		d = &stop_devices[i];
+		d->device = iter->data;
+		d->deps[0] = nm_device_get_master (d->device);
+		d->deps[1] = nm_device_parent_get_device (d->device);
+		if (d->deps[1] == d->deps[0])
+			d->deps[1] = NULL;
+		for (j = 0; j < G_N_ELEMENTS (d->deps); j++) {
+			if (d->deps[j] == d->device)
+				d->deps[j] = NULL;
+		}
+		g_hash_table_insert (by_device, d->device, d);
+	}
+	for (i = 0; i < n; i++) {
+		for (j = 0; j < G_N_ELEMENTS (stop_devices[i].deps); j++) {
+			dep = g_hash_table_lookup (by_device, stop_devices[i].deps[j]);
+			if (dep)
+				dep->n_children++;
+			else
+				stop_devices[i].deps[j] = NULL;
+		}
+	}
+	for (i = 0; i < n; i++) {
+		if (stop_devices[i].n_children == 0)
+			g_queue_push_tail (&ready, &stop_devices[i]);
+	}
 
-	/* Remove all devices */
-	while (priv->devices)
-		remove_device (self, NM_DEVICE (priv->devices->data), TRUE, TRUE);
+	while (priv->devices) {
+		d = g_queue_pop_head (&ready);
+		if (!d) {
+			/* a dependency loop can't exist, but don't hang on one. */
+			d = g_hash_table_lookup (by_device, priv->devices->data);
+			if (!d) {
+				remove_device (self, priv->devices->data, TRUE, TRUE);
+				continue;
+			}
+		}
+
+		g_hash_table_remove (by_device, d->device);
+		for (j = 0; j < G_N_ELEMENTS (d->deps); j++) {
+			dep = g_hash_table_lookup (by_device, d->deps[j]);
+			if (dep && --dep->n_children == 0)
+				g_queue_push_tail (&ready, dep);
+		}
+
+		remove_device (self, d->device, TRUE, TRUE);
+	}
+	g_queue_clear (&ready);
+
+	spawn_iface_helper (self);
 
 	_active_connection_cleanup (self);
 
@@ -6044,6 +6977,7 @@ nm_manager_init (NMManager *self)
 
 	priv->metered = NM_METERED_UNKNOWN;
 	priv->sleep_devices = g_hash_table_new (g_direct_hash, g_direct_equal);
+	priv->lazy_external_devices = g_hash_table_new (g_direct_hash, g_direct_equal);
 }
 
 static gboolean
@@ -6200,12 +7134,20 @@ dispose (GObject *object)
 {
 	NMManager *manager = NM_MANAGER (object);
 	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (manager);
+	NMPlatform *platform;
 
 	g_slist_free_full (priv->auth_chains, (GDestroyNotify) nm_auth_chain_unref);
 	priv->auth_chains = NULL;
 
 	nm_clear_g_source (&priv->devices_inited_id);
 
+	platform = nm_platform_try_get ();
+	if (platform)
+		g_signal_handlers_disconnect_by_func (platform, G_CALLBACK (platform_link_cb), manager);
+	nm_clear_g_source (&priv->link_cb.idle_id);
+	g_clear_pointer (&priv->link_cb.pending, g_hash_table_unref);
+	g_clear_pointer (&priv->iface_helper_args, g_ptr_array_unref);
+
 	if (priv->checkpoint_mgr) {
 		nm_checkpoint_manager_destroy_all (priv->checkpoint_mgr, NULL);
 		g_clear_pointer (&priv->checkpoint_mgr, nm_checkpoint_manager_unref);
@@ -6219,6 +7161,7 @@ dispose (GObject *object)
 	}
 
 	g_assert (priv->devices == NULL);
+	g_clear_pointer (&priv->lazy_external_devices, g_hash_table_unref);
 
 	nm_clear_g_source (&priv->ac_cleanup_id);
 
@@ -6548,15 +7491,25 @@ nm_manager_class_init (NMManagerClass *manager_class)
 	                                        "Reload", impl_manager_reload,
 	                                        "GetDevices", impl_manager_get_devices,
 	                                        "GetAllDevices", impl_manager_get_all_devices,
+	                                        "GetDevicesWithProperties", impl_manager_get_devices_with_properties,
 	                                        "GetDeviceByIpIface", impl_manager_get_device_by_ip_iface,
 	                                        "ActivateConnection", impl_manager_activate_connection,
 	                                        "AddAndActivateConnection", impl_manager_add_and_activate_connection,
+	                                        "AddAndActivateVirtualConnections", impl_manager_add_and_activate_virtual_connections,
 	                                        "DeactivateConnection", impl_manager_deactivate_connection,
 	                                        "Sleep", impl_manager_sleep,
 	                                        "Enable", impl_manager_enable,
 	                                        "GetPermissions", impl_manager_get_permissions,
 	                                        "SetLogging", impl_manager_set_logging,
 	                                        "GetLogging", impl_manager_get_logging,
+	                                        "GetTraceBuffer", impl_manager_get_trace_buffer,
+	                                        "GetStartupTimeline", impl_manager_get_startup_timeline,
+	                                        "GetPlatformStatistics", impl_manager_get_platform_statistics,
+	                                        "GetMemoryUsage", impl_manager_get_memory_usage,
+	                                        "GetActivationStatistics", impl_manager_get_activation_statistics,
+	                                        "GetDBusStatistics", impl_manager_get_dbus_statistics,
+	                                        "GetChangesSince", impl_manager_get_changes_since,
+	                                        "GetVpnPlugins", impl_manager_get_vpn_plugins,
 	                                        "CheckConnectivity", impl_manager_check_connectivity,
 	                                        "state", impl_manager_get_state,
 	                                        "CheckpointCreate", impl_manager_checkpoint_create,
@@ -24,42 +24,100 @@
 
 #include <string.h>
 
-struct NMMultiIndex {
-	NMMultiIndexFuncEqual equal_fcn;
-	NMMultiIndexFuncClone clone_fcn;
-	GHashTable *hash;
-};
+/* NMMultiIndex maps an id to a set of values.
+ *
+ * The groups live in an open addressing hash table with linear probing.
+ * Each bucket stores the hash of its id, so probing rarely has to call
+ * @equal_fcn on a mismatch. Removing a group shifts the following
+ * buckets of the probe sequence back, so there are no tombstones and
+ * lookups never degrade after many removals.
+ *
+ * The values of a group are kept in a separate ValuesData, so that the
+ * arrays returned by nm_multi_index_lookup() stay valid while other
+ * groups are added or removed. */
+
+#define BUCKETS_MIN 8
+
+/* groups with more values than this keep them only in a hash set. The
+ * array returned by nm_multi_index_lookup() is then created on demand.
+ * Smaller groups keep an array that is searched linearly. */
+#define VALUES_SET_THRESHOLD 16
 
 typedef struct {
-	/* when storing the first item for a multi-index id, we don't yet create
-	 * the hashtable @index. Instead we store it inplace to @value0. Note that
-	 * &values_data->value0 is a NULL terminated array with one item that is
-	 * suitable to be returned directly from nm_multi_index_lookup(). */
+	/* while @alloc is zero and there is no @set, the group has exactly
+	 * one value, which is stored inplace in @value0. Note that
+	 * &values_data->value0 is a NULL terminated array with one item that
+	 * is suitable to be returned directly from nm_multi_index_lookup(). */
 	union {
 		gpointer value0;
 		gpointer *values;
 	};
-	GHashTable *index;
+
+	/* large groups have their values in @set, which only costs a hash
+	 * and a key per value. In that case @values is a NULL terminated
+	 * snapshot of the set, created by nm_multi_index_lookup() and
+	 * dropped on the next modification of the group, or %NULL. */
+	GHashTable *set;
+	guint len;
+	guint alloc;
 } ValuesData;
 
+typedef struct {
+	NMMultiIndexId *id;
+	ValuesData *values_data;
+	guint hash;
+} Bucket;
+
+struct NMMultiIndex {
+	NMMultiIndexFuncHash hash_fcn;
+	NMMultiIndexFuncEqual equal_fcn;
+	NMMultiIndexFuncClone clone_fcn;
+	NMMultiIndexFuncDestroy destroy_fcn;
+
+	/* @n_buckets is zero or a power of two. A bucket is empty if it
+	 * has no @id. */
+	Bucket *buckets;
+	guint n_buckets;
+	guint n_groups;
+};
+
 /*****************************************************************************/
 
 static void
 _values_data_destroy (ValuesData *values_data)
 {
-	if (values_data->index) {
+	if (values_data->set) {
+		g_free (values_data->values);
+		g_hash_table_unref (values_data->set);
+	} else if (values_data->alloc)
 		g_free (values_data->values);
-		g_hash_table_unref (values_data->index);
-	}
 	g_slice_free (ValuesData, values_data);
 }
 
+/* returns the position of @value plus one, or zero. Not for large groups. */
+static guint
+_values_data_find (const ValuesData *values_data, gconstpointer value)
+{
+	guint i;
+
+	nm_assert (!values_data->set);
+
+	if (!values_data->alloc)
+		return value == values_data->value0 ? 1 : 0;
+
+	for (i = 0; i < values_data->len; i++) {
+		if (values_data->values[i] == value)
+			return i + 1;
+	}
+	return 0;
+}
+
 static gboolean
-_values_data_contains (ValuesData *values_data, gconstpointer value)
+_values_data_contains (const ValuesData *values_data, gconstpointer value)
 {
-	return values_data->index
-	       ? g_hash_table_contains (values_data->index, value)
-	       : value == values_data->value0;
+	if (values_data->set)
+		return g_hash_table_contains (values_data->set, value);
+	return _values_data_find (values_data, value) != 0;
 }
 
 static void
@@ -67,36 +125,225 @@ _values_data_get_data (ValuesData *values_data,
                        void *const**out_data,
                        guint *out_len)
 {
-	guint i, len;
-	gpointer *values;
 	GHashTableIter iter;
+	gpointer value;
+	guint i;
 
 	nm_assert (values_data);
 
-	if (!values_data->index) {
+	if (values_data->set) {
+		nm_assert (values_data->len == g_hash_table_size (values_data->set));
+
+		if (!values_data->values) {
+			values_data->values = g_new (gpointer, values_data->len + 1);
+			i = 0;
+			g_hash_table_iter_init (&iter, values_data->set);
+			while (g_hash_table_iter_next (&iter, &value, NULL))
+				values_data->values[i++] = value;
+			values_data->values[i] = NULL;
+		}
+		NM_SET_OUT (out_data, values_data->values);
+		NM_SET_OUT (out_len, values_data->len);
+		return;
+	}
+
+	if (!values_data->alloc) {
 		NM_SET_OUT (out_data, &values_data->value0);
 		NM_SET_OUT (out_len, 1);
 		return;
 	}
 
-	nm_assert (values_data->index && g_hash_table_size (values_data->index) > 0);
+	nm_assert (values_data->len > 0);
+	nm_assert (values_data->values[values_data->len] == NULL);
 
-	if (!values_data->values) {
-		len = g_hash_table_size (values_data->index);
-		values = g_new (gpointer, len + 1);
+	NM_SET_OUT (out_data, values_data->values);
+	NM_SET_OUT (out_len, values_data->len);
+}
 
-		g_hash_table_iter_init (&iter, values_data->index);
-		for (i = 0; g_hash_table_iter_next (&iter, &values[i], NULL); i++)
-			nm_assert (i < len);
-		nm_assert (i == len);
-		values[i] = NULL;
+/* @value must not yet be in @values_data. */
+static void
+_values_data_append (ValuesData *values_data, gpointer value)
+{
+	guint i;
 
-		values_data->values = values;
-		NM_SET_OUT (out_len, len);
-	} else if (out_len)
-		NM_SET_OUT (out_len, g_hash_table_size (values_data->index));
+	if (values_data->set) {
+		g_clear_pointer (&values_data->values, g_free);
+		g_hash_table_add (values_data->set, value);
+		values_data->len++;
+		return;
+	}
 
-	NM_SET_OUT (out_data, values_data->values);
+	if (!values_data->alloc) {
+		gpointer value0 = values_data->value0;
+
+		/* @values shares the storage with @value0. */
+		values_data->alloc = 4;
+		values_data->values = g_new (gpointer, values_data->alloc + 1);
+		values_data->values[0] = value0;
+		values_data->len = 1;
+	} else if (values_data->len >= values_data->alloc) {
+		values_data->alloc *= 2;
+		values_data->values = g_renew (gpointer, values_data->values, values_data->alloc + 1);
+	}
+	values_data->values[values_data->len++] = value;
+	values_data->values[values_data->len] = NULL;
+
+	if (values_data->len > VALUES_SET_THRESHOLD) {
+		/* switch to a set. A set where keys and values are identical doesn't
+		 * allocate an array for the values, which makes it more compact than
+		 * the array plus a hash of the positions. */
+		values_data->set = g_hash_table_new (NULL, NULL);
+		for (i = 0; i < values_data->len; i++)
+			g_hash_table_add (values_data->set, values_data->values[i]);
+		g_clear_pointer (&values_data->values, g_free);
+		values_data->alloc = 0;
+	}
+}
+
+/* returns %FALSE if @value was not in @values_data. The caller must
+ * drop the group when it becomes empty. */
+static gboolean
+_values_data_remove (ValuesData *values_data, gconstpointer value)
+{
+	GHashTableIter iter;
+	gpointer last;
+	guint pos;
+
+	if (values_data->set) {
+		if (!g_hash_table_remove (values_data->set, value))
+			return FALSE;
+		g_clear_pointer (&values_data->values, g_free);
+		values_data->len--;
+
+		if (values_data->len <= VALUES_SET_THRESHOLD / 2) {
+			/* switch back to an array. */
+			values_data->alloc = VALUES_SET_THRESHOLD;
+			values_data->values = g_new (gpointer, values_data->alloc + 1);
+			pos = 0;
+			g_hash_table_iter_init (&iter, values_data->set);
+			while (g_hash_table_iter_next (&iter, &last, NULL))
+				values_data->values[pos++] = last;
+			values_data->values[pos] = NULL;
+			g_clear_pointer (&values_data->set, g_hash_table_unref);
+		}
+		return TRUE;
+	}
+
+	pos = _values_data_find (values_data, value);
+	if (pos == 0)
+		return FALSE;
+
+	if (!values_data->alloc) {
+		values_data->len = 0;
+		return TRUE;
+	}
+
+	pos--;
+	values_data->len--;
+	if (pos < values_data->len) {
+		last = values_data->values[values_data->len];
+		values_data->values[pos] = last;
+	}
+	values_data->values[values_data->len] = NULL;
+	return TRUE;
+}
+
+/*****************************************************************************/
+
+static guint
+_hash (const NMMultiIndex *index, const NMMultiIndexId *id)
+{
+	guint h = index->hash_fcn (id);
+
+	/* the buckets are selected by the lowest bits. Mix the hash, because
+	 * hash functions of the ids don't necessarily spread their values there. */
+	h ^= h >> 16;
+	h *= 0x45d9f3bu;
+	h ^= h >> 16;
+	return h;
+}
+
+static Bucket *
+_lookup_bucket (const NMMultiIndex *index, const NMMultiIndexId *id, guint hash)
+{
+	guint mask, i;
+
+	if (!index->n_buckets)
+		return NULL;
+
+	mask = index->n_buckets - 1;
+	for (i = hash & mask; ; i = (i + 1) & mask) {
+		Bucket *bucket = &index->buckets[i];
+
+		if (!bucket->id)
+			return NULL;
+		if (   bucket->hash == hash
+		    && index->equal_fcn (bucket->id, id))
+			return bucket;
+	}
+}
+
+static ValuesData *
+_lookup (const NMMultiIndex *index, const NMMultiIndexId *id)
+{
+	Bucket *bucket;
+
+	bucket = _lookup_bucket (index, id, _hash (index, id));
+	return bucket ? bucket->values_data : NULL;
+}
+
+static void
+_resize (NMMultiIndex *index, guint n_buckets)
+{
+	Bucket *old_buckets = index->buckets;
+	guint old_n_buckets = index->n_buckets;
+	guint mask, i, j;
+
+	nm_assert (n_buckets >= BUCKETS_MIN);
+	nm_assert ((n_buckets & (n_buckets - 1)) == 0);
+	nm_assert (index->n_groups < n_buckets);
+
+	index->buckets = g_new0 (Bucket, n_buckets);
+	index->n_buckets = n_buckets;
+	mask = n_buckets - 1;
+
+	for (i = 0; i < old_n_buckets; i++) {
+		if (!old_buckets[i].id)
+			continue;
+		for (j = old_buckets[i].hash & mask; index->buckets[j].id; j = (j + 1) & mask)
+			;
+		index->buckets[j] = old_buckets[i];
+	}
+	g_free (old_buckets);
+}
+
+static void
+_remove_bucket (NMMultiIndex *index, Bucket *bucket)
+{
+	guint mask = index->n_buckets - 1;
+	guint i, j, k;
+
+	index->destroy_fcn (bucket->id);
+	_values_data_destroy (bucket->values_data);
+	index->n_groups--;
+
+	/* backward shift deletion: move the following entries of the probe
+	 * sequence into the hole, unless they would end up before their
+	 * home bucket. */
+	i = bucket - index->buckets;
+	for (j = (i + 1) & mask; index->buckets[j].id; j = (j + 1) & mask) {
+		k = index->buckets[j].hash & mask;
+		if (i <= j ? (i < k && k <= j) : (i < k || k <= j))
+			continue;
+		index->buckets[i] = index->buckets[j];
+		i = j;
+	}
+	index->buckets[i].id = NULL;
+	index->buckets[i].values_data = NULL;
+
+	if (   index->n_buckets > BUCKETS_MIN
+	    && index->n_groups < index->n_buckets / 8)
+		_resize (index, index->n_buckets / 2);
 }
 
 /*****************************************************************************/
@@ -109,7 +356,8 @@ _values_data_get_data (ValuesData *values_data,
  *   that are returned.
  *
  * Returns: (transfer none): %NULL if there are no values
- *   or a %NULL terminated array of pointers.
+ *   or a %NULL terminated array of pointers. The array is only
+ *   valid until the group of @id is modified.
  */
 void *const*
 nm_multi_index_lookup (const NMMultiIndex *index,
@@ -122,7 +370,7 @@ nm_multi_index_lookup (const NMMultiIndex *index,
 	g_return_val_if_fail (index, NULL);
 	g_return_val_if_fail (id, NULL);
 
-	values_data = g_hash_table_lookup (index->hash, id);
+	values_data = _lookup (index, id);
 	if (!values_data) {
 		if (out_len)
 			*out_len = 0;
@@ -143,7 +391,7 @@ nm_multi_index_contains (const NMMultiIndex *index,
 	g_return_val_if_fail (id, FALSE);
 	g_return_val_if_fail (value, FALSE);
 
-	values_data = g_hash_table_lookup (index->hash, id);
+	values_data = _lookup (index, id);
 	return values_data && _values_data_contains (values_data, value);
 }
 
@@ -151,25 +399,25 @@ const NMMultiIndexId *
 nm_multi_index_lookup_first_by_value (const NMMultiIndex *index,
                                       gconstpointer value)
 {
-	GHashTableIter iter;
-	const NMMultiIndexId *id;
-	ValuesData *values_data;
+	guint i;
 
 	g_return_val_if_fail (index, NULL);
 	g_return_val_if_fail (value, NULL);
 
-	/* reverse-lookup needs to iterate over all hash tables. It should
-	 * still be fairly quick, if the number of hash tables is small.
+	/* reverse-lookup needs to iterate over all groups. It should
+	 * still be fairly quick, if the number of groups is small.
 	 * There is no O(1) reverse lookup implemented, because this access
 	 * pattern is not what NMMultiIndex is here for.
 	 * You are supposed to use NMMultiIndex by always knowing which @id
 	 * a @value has.
 	 */
 
-	g_hash_table_iter_init (&iter, index->hash);
-	while (g_hash_table_iter_next (&iter, (gpointer *) &id, (gpointer *) &values_data)) {
-		if (_values_data_contains (values_data, value))
-			return id;
+	for (i = 0; i < index->n_buckets; i++) {
+		const Bucket *bucket = &index->buckets[i];
+
+		if (   bucket->id
+		    && _values_data_contains (bucket->values_data, value))
+			return bucket->id;
 	}
 	return NULL;
 }
@@ -180,21 +428,16 @@ nm_multi_index_foreach (const NMMultiIndex *index,
                         NMMultiIndexFuncForeach foreach_func,
                         gpointer user_data)
 {
-	GHashTableIter iter;
+	NMMultiIndexIter iter;
 	const NMMultiIndexId *id;
-	ValuesData *values_data;
-	guint len;
 	void *const*values;
+	guint len;
 
 	g_return_if_fail (index);
 	g_return_if_fail (foreach_func);
 
-	g_hash_table_iter_init (&iter, index->hash);
-	while (g_hash_table_iter_next (&iter, (gpointer *) &id, (gpointer *) &values_data)) {
-		if (value && !_values_data_contains (values_data, value))
-			continue;
-
-		_values_data_get_data (values_data, &values, &len);
+	nm_multi_index_iter_init (&iter, index, value);
+	while (nm_multi_index_iter_next (&iter, &id, &values, &len)) {
 		if (!foreach_func (id, values, len, user_data))
 			return;
 	}
@@ -208,9 +451,9 @@ nm_multi_index_iter_init (NMMultiIndexIter *iter,
 	g_return_if_fail (index);
 	g_return_if_fail (iter);
 
-	g_hash_table_iter_init (&iter->_iter, index->hash);
 	iter->_index = index;
 	iter->_value = value;
+	iter->_pos = 0;
 }
 
 gboolean
@@ -219,18 +462,22 @@ nm_multi_index_iter_next (NMMultiIndexIter *iter,
                           void *const**out_values,
                           guint *out_len)
 {
-	const NMMultiIndexId *id;
-	ValuesData *values_data;
+	const NMMultiIndex *index;
 
 	g_return_val_if_fail (iter, FALSE);
 
-	while (g_hash_table_iter_next (&iter->_iter, (gpointer *) &id, (gpointer *) &values_data)) {
+	index = iter->_index;
+	while (iter->_pos < index->n_buckets) {
+		const Bucket *bucket = &index->buckets[iter->_pos++];
+
+		if (!bucket->id)
+			continue;
 		if (   !iter->_value
-		    || _values_data_contains (values_data, iter->_value)) {
+		    || _values_data_contains (bucket->values_data, iter->_value)) {
 			if (out_values || out_len)
-				_values_data_get_data (values_data, out_values, out_len);
+				_values_data_get_data (bucket->values_data, out_values, out_len);
 			if (out_id)
-				*out_id = id;
+				*out_id = bucket->id;
 			return TRUE;
 		}
 	}
@@ -250,16 +497,22 @@ nm_multi_index_id_iter_init (NMMultiIndexIdIter *iter,
 	g_return_if_fail (iter);
 	g_return_if_fail (id);
 
-	values_data = g_hash_table_lookup (index->hash, id);
-	if (!values_data)
-		iter->_state = 2;
-	else if (values_data->index) {
-		iter->_state = 1;
-		g_hash_table_iter_init (&iter->_iter, values_data->index);
-	} else {
-		iter->_state = 0;
-		iter->_value = values_data->value0;
-	}
+	iter->_pos = 0;
+	iter->_set = NULL;
+	values_data = _lookup (index, id);
+	if (!values_data) {
+		iter->_values = NULL;
+		iter->_len = 0;
+	} else if (values_data->set) {
+		/* walk the set directly instead of creating the snapshot for
+		 * nm_multi_index_lookup(), which would be rebuilt after every
+		 * modification of the group. */
+		iter->_set = values_data->set;
+		g_hash_table_iter_init (&iter->_set_iter, values_data->set);
+		iter->_values = NULL;
+		iter->_len = values_data->len;
+	} else
+		_values_data_get_data (values_data, &iter->_values, &iter->_len);
 }
 
 gboolean
@@ -268,19 +521,19 @@ nm_multi_index_id_iter_next (NMMultiIndexIdIter *iter,
 {
 	g_return_val_if_fail (iter, FALSE);
 
-	switch (iter->_state) {
-	case 0:
-		iter->_state = 2;
-		NM_SET_OUT (out_value, iter->_value);
+	if (iter->_set) {
+		gpointer value;
+
+		if (!g_hash_table_iter_next (&iter->_set_iter, &value, NULL))
+			return FALSE;
+		NM_SET_OUT (out_value, value);
 		return TRUE;
-	case 1:
-		return g_hash_table_iter_next (&iter->_iter, out_value, NULL);
-	case 2:
-		iter->_state = 3;
-		return FALSE;
-	default:
-		g_return_val_if_reached (FALSE);
 	}
+
+	if (iter->_pos >= iter->_len)
+		return FALSE;
+	NM_SET_OUT (out_value, iter->_values[iter->_pos++]);
+	return TRUE;
 }
 
 /*****************************************************************************/
@@ -291,42 +544,48 @@ _do_add (NMMultiIndex *index,
          gconstpointer value)
 {
 	ValuesData *values_data;
+	Bucket *bucket;
+	guint hash, mask, i;
 
-	values_data = g_hash_table_lookup (index->hash, id);
-	if (!values_data) {
-		NMMultiIndexId *id_new;
-
-		/* Contrary to GHashTable, we don't take ownership of the @id that was
-		 * provided to nm_multi_index_add(). Instead we clone it via @clone_fcn
-		 * when needed.
-		 *
-		 * The reason is, that we expect in most cases that there exists
-		 * already a @id so that we don't need ownership of it (or clone it).
-		 * By doing this, the caller can pass a stack allocated @id or
-		 * reuse the @id for other insertions.
-		 */
-		id_new = index->clone_fcn (id);
-		if (!id_new)
-			g_return_val_if_reached (FALSE);
-
-		values_data = g_slice_new0 (ValuesData);
-		values_data->value0 = (gpointer) value;
-
-		g_hash_table_insert (index->hash, id_new, values_data);
-	} else {
-		if (!values_data->index) {
-			if (values_data->value0 == value)
-				return FALSE;
-			values_data->index = g_hash_table_new (NULL, NULL);
-			g_hash_table_replace (values_data->index, (gpointer) value, (gpointer) value);
-			g_hash_table_replace (values_data->index, values_data->value0, values_data->value0);
-			values_data->values = NULL;
-		} else {
-			if (!nm_g_hash_table_replace (values_data->index, (gpointer) value, (gpointer) value))
-				return FALSE;
-			g_clear_pointer (&values_data->values, g_free);
-		}
+	hash = _hash (index, id);
+	bucket = _lookup_bucket (index, id, hash);
+	if (bucket) {
+		values_data = bucket->values_data;
+		if (_values_data_contains (values_data, value))
+			return FALSE;
+		_values_data_append (values_data, (gpointer) value);
+		return TRUE;
 	}
+
+	/* keep the load factor below 3/4. */
+	if ((index->n_groups + 1) * 4 > index->n_buckets * 3)
+		_resize (index, MAX (index->n_buckets * 2, BUCKETS_MIN));
+
+	mask = index->n_buckets - 1;
+	for (i = hash & mask; index->buckets[i].id; i = (i + 1) & mask)
+		;
+	bucket = &index->buckets[i];
+
+	/* Contrary to GHashTable, we don't take ownership of the @id that was
+	 * provided to nm_multi_index_add(). Instead we clone it via @clone_fcn
+	 * when needed.
+	 *
+	 * The reason is, that we expect in most cases that there exists
+	 * already a @id so that we don't need ownership of it (or clone it).
+	 * By doing this, the caller can pass a stack allocated @id or
+	 * reuse the @id for other insertions.
+	 */
+	bucket->id = index->clone_fcn (id);
+	if (!bucket->id)
+		g_return_val_if_reached (FALSE);
+
+	values_data = g_slice_new0 (ValuesData);
+	values_data->value0 = (gpointer) value;
+	values_data->len = 1;
+
+	bucket->values_data = values_data;
+	bucket->hash = hash;
+	index->n_groups++;
 	return TRUE;
 }
 
@@ -335,25 +594,16 @@ _do_remove (NMMultiIndex *index,
             const NMMultiIndexId *id,
             gconstpointer value)
 {
-	ValuesData *values_data;
+	Bucket *bucket;
 
-	values_data = g_hash_table_lookup (index->hash, id);
-	if (!values_data)
+	bucket = _lookup_bucket (index, id, _hash (index, id));
+	if (!bucket)
 		return FALSE;
 
-	if (values_data->index) {
-		if (!g_hash_table_remove (values_data->index, value))
-			return FALSE;
-		if (g_hash_table_size (values_data->index) == 0)
-			g_hash_table_remove (index->hash, id);
-		else
-			g_clear_pointer (&values_data->values, g_free);
-	} else {
-		if (values_data->value0 != value)
-			return FALSE;
-		g_hash_table_remove (index->hash, id);
-	}
-
+	if (!_values_data_remove (bucket->values_data, value))
+		return FALSE;
+	if (bucket->values_data->len == 0)
+		_remove_bucket (index, bucket);
 	return TRUE;
 }
 
@@ -436,7 +686,7 @@ guint
 nm_multi_index_get_num_groups (const NMMultiIndex *index)
 {
 	g_return_val_if_fail (index, 0);
-	return g_hash_table_size (index->hash);
+	return index->n_groups;
 }
 
 NMMultiIndex *
@@ -452,22 +702,28 @@ nm_multi_index_new (NMMultiIndexFuncHash hash_fcn,
 	g_return_val_if_fail (clone_fcn, NULL);
 	g_return_val_if_fail (destroy_fcn, NULL);
 
-	index = g_new (NMMultiIndex, 1);
+	index = g_new0 (NMMultiIndex, 1);
+	index->hash_fcn = hash_fcn;
 	index->equal_fcn = equal_fcn;
 	index->clone_fcn = clone_fcn;
-
-	index->hash = g_hash_table_new_full ((GHashFunc) hash_fcn,
-	                                     (GEqualFunc) equal_fcn,
-	                                     (GDestroyNotify) destroy_fcn,
-	                                     (GDestroyNotify) _values_data_destroy);
+	index->destroy_fcn = destroy_fcn;
 	return index;
 }
 
 void
 nm_multi_index_free (NMMultiIndex *index)
 {
+	guint i;
+
 	g_return_if_fail (index);
-	g_hash_table_unref (index->hash);
+
+	for (i = 0; i < index->n_buckets; i++) {
+		if (index->buckets[i].id) {
+			index->destroy_fcn (index->buckets[i].id);
+			_values_data_destroy (index->buckets[i].values_data);
+		}
+	}
+	g_free (index->buckets);
 	g_free (index);
 }
 
@@ -28,17 +28,18 @@ typedef struct {
 typedef struct NMMultiIndex NMMultiIndex;
 
 typedef struct {
-	GHashTableIter _iter;
 	const NMMultiIndex *_index;
 	gconstpointer _value;
+	guint _pos;
 } NMMultiIndexIter;
 
 typedef struct {
-	union {
-		GHashTableIter _iter;
-		gpointer _value;
-	};
-	guint _state;
+	/* large groups are iterated via @_set_iter, if @_set is set. */
+	GHashTable *_set;
+	GHashTableIter _set_iter;
+	void *const*_values;
+	guint _len;
+	guint _pos;
 } NMMultiIndexIdIter;
 
 typedef gboolean (*NMMultiIndexFuncEqual) (const NMMultiIndexId *id_a, const NMMultiIndexId *id_b);
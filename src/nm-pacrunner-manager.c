@@ -32,20 +32,27 @@
 #define PACRUNNER_DBUS_INTERFACE "org.pacrunner.Manager"
 #define PACRUNNER_DBUS_PATH "/org/pacrunner/manager"
 
+/* changes within this time are sent together. A device commonly removes
+ * and re-adds its configuration for one change. */
+#define FLUSH_DELAY_MS 100
+
 /*****************************************************************************/
 
-struct remove_data {
+typedef struct {
 	char *iface;
-	char *path;
-};
+	GVariant *args;      /* what we want pacrunner to have, or NULL */
+	GVariant *sent_args; /* what pacrunner has, or is being sent */
+	char *path;          /* pacrunner's object for @sent_args */
+	gboolean create_pending;
+} Config;
 
 typedef struct {
-	char *iface;
 	GPtrArray *domains;
 	GDBusProxy *pacrunner;
 	GCancellable *pacrunner_cancellable;
-	GList *args;
-	GList *remove;
+	GCancellable *cancellable;
+	GHashTable *configs; /* iface -> Config */
+	guint flush_id;
 } NMPacrunnerManagerPrivate;
 
 struct _NMPacrunnerManager {
@@ -73,14 +80,15 @@ NM_DEFINE_SINGLETON_GETTER (NMPacrunnerManager, nm_pacrunner_manager_get, NM_TYP
 /*****************************************************************************/
 
 static void
-remove_data_destroy (struct remove_data *data)
+config_free (gpointer data)
 {
-	g_return_if_fail (data != NULL);
+	Config *config = data;
 
-	g_free (data->iface);
-	g_free (data->path);
-	memset (data, 0, sizeof (struct remove_data));
-	g_free (data);
+	g_free (config->iface);
+	nm_clear_g_variant (&config->args);
+	nm_clear_g_variant (&config->sent_args);
+	g_free (config->path);
+	g_slice_free (Config, config);
 }
 
 static void
@@ -186,64 +194,157 @@ add_ip6_config (NMPacrunnerManager *self, GVariantBuilder *proxy_data, NMIP6Conf
 	}
 }
 
+static void schedule_flush (NMPacrunnerManager *self);
+
 static void
 pacrunner_send_done (GObject *source, GAsyncResult *res, gpointer user_data)
 {
-	NMPacrunnerManager *self = NM_PACRUNNER_MANAGER (user_data);
-	NMPacrunnerManagerPrivate *priv = NM_PACRUNNER_MANAGER_GET_PRIVATE (self);
+	gs_free char *iface = user_data;
+	NMPacrunnerManager *self;
+	NMPacrunnerManagerPrivate *priv;
 	gs_free_error GError *error = NULL;
 	gs_unref_variant GVariant *variant = NULL;
-	const char *path = NULL;
-	GList *iter = NULL;
-	gboolean found = FALSE;
+	Config *config;
+
+	variant = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), res, &error);
+	if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+		return;
+
+	self = nm_pacrunner_manager_get ();
+	priv = NM_PACRUNNER_MANAGER_GET_PRIVATE (self);
+
+	config = g_hash_table_lookup (priv->configs, iface);
+	if (!config || !config->create_pending)
+		return;
+	config->create_pending = FALSE;
 
-	variant = g_dbus_proxy_call_finish (priv->pacrunner, res, &error);
 	if (!variant) {
 		_LOGD ("sending proxy config to pacrunner failed: %s", error->message);
+		nm_clear_g_variant (&config->sent_args);
 	} else {
-		struct remove_data *data;
-		g_variant_get (variant, "(&o)", &path);
+		const char *path;
 
-		/* Replace the old path (if any) of proxy config with the new one returned
-		 * from CreateProxyConfiguration() DBus method on pacrunner.
-		 */
-		for (iter = g_list_first (priv->remove); iter; iter = g_list_next (iter)) {
-			struct remove_data *r = iter->data;
-			if (g_strcmp0 (priv->iface, r->iface) == 0) {
-				g_free (r->path);
-				r->path = g_strdup (path);
-				found = TRUE;
-				break;
-			}
-		}
-
-		if (!found) {
-			data = g_malloc0 (sizeof (struct remove_data));
-			data->iface = g_strdup (priv->iface);
-			data->path = g_strdup (path);
-			priv->remove = g_list_append (priv->remove, data);
-			_LOGD ("proxy config sent to pacrunner");
-		}
+		g_variant_get (variant, "(&o)", &path);
+		g_free (config->path);
+		config->path = g_strdup (path);
+		_LOGD ("proxy config sent to pacrunner");
 	}
+
+	/* catch up with changes made while the call was pending. */
+	if (   !config->args
+	    || !config->sent_args
+	    || !g_variant_equal (config->args, config->sent_args))
+		schedule_flush (self);
 }
 
 static void
-send_pacrunner_proxy_data (NMPacrunnerManager *self, GVariant *pacrunner_manager_args)
+pacrunner_remove_done (GObject *source, GAsyncResult *res, gpointer user_data)
 {
+	/* @self may be a dangling pointer. However, we don't use it as the
+	 * logging macro below does not dereference @self. */
+	NMPacrunnerManager *self = user_data;
+	gs_free_error GError *error = NULL;
+	gs_unref_variant GVariant *ret = NULL;
+
+	ret = g_dbus_proxy_call_finish ((GDBusProxy *) source, res, &error);
+
+	if (!ret)
+		_LOGD ("Couldn't remove proxy config from pacrunner: %s", error->message);
+	else
+		_LOGD ("Successfully removed proxy config from pacrunner");
+}
+
+static gboolean
+flush_cb (gpointer user_data)
+{
+	NMPacrunnerManager *self = user_data;
 	NMPacrunnerManagerPrivate *priv = NM_PACRUNNER_MANAGER_GET_PRIVATE (self);
+	gs_free char *owner = NULL;
+	GHashTableIter iter;
+	Config *config;
 
-	if (!pacrunner_manager_args)
-		return;
+	priv->flush_id = 0;
 
+	/* without pacrunner, everything is sent when it appears. */
 	if (priv->pacrunner)
+		owner = g_dbus_proxy_get_name_owner (priv->pacrunner);
+	if (!owner)
+		return G_SOURCE_REMOVE;
+
+	g_hash_table_iter_init (&iter, priv->configs);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &config)) {
+		/* the result decides what to do next. */
+		if (config->create_pending)
+			continue;
+
+		if (   config->args
+		    && config->sent_args
+		    && g_variant_equal (config->args, config->sent_args))
+			continue;
+
+		/* pacrunner cannot change a configuration, only replace it. */
+		if (config->path) {
+			g_dbus_proxy_call (priv->pacrunner,
+			                   "DestroyProxyConfiguration",
+			                   g_variant_new ("(o)", config->path),
+			                   G_DBUS_CALL_FLAGS_NONE,
+			                   -1,
+			                   NULL,
+			                   (GAsyncReadyCallback) pacrunner_remove_done,
+			                   self);
+			g_clear_pointer (&config->path, g_free);
+		}
+		nm_clear_g_variant (&config->sent_args);
+
+		if (!config->args) {
+			g_hash_table_iter_remove (&iter);
+			continue;
+		}
+
+		config->sent_args = g_variant_ref (config->args);
+		config->create_pending = TRUE;
 		g_dbus_proxy_call (priv->pacrunner,
 		                   "CreateProxyConfiguration",
-		                   pacrunner_manager_args,
+		                   config->args,
 		                   G_DBUS_CALL_FLAGS_NONE,
 		                   -1,
-		                   NULL,
-		                  (GAsyncReadyCallback) pacrunner_send_done,
-		                   self);
+		                   priv->cancellable,
+		                   (GAsyncReadyCallback) pacrunner_send_done,
+		                   g_strdup (config->iface));
+	}
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+schedule_flush (NMPacrunnerManager *self)
+{
+	NMPacrunnerManagerPrivate *priv = NM_PACRUNNER_MANAGER_GET_PRIVATE (self);
+
+	if (!priv->flush_id)
+		priv->flush_id = g_timeout_add (FLUSH_DELAY_MS, flush_cb, self);
+}
+
+static void
+set_config (NMPacrunnerManager *self, const char *iface, GVariant *args)
+{
+	NMPacrunnerManagerPrivate *priv = NM_PACRUNNER_MANAGER_GET_PRIVATE (self);
+	Config *config;
+
+	config = g_hash_table_lookup (priv->configs, iface);
+	if (!config) {
+		if (!args)
+			return;
+		config = g_slice_new0 (Config);
+		config->iface = g_strdup (iface);
+		g_hash_table_insert (priv->configs, config->iface, config);
+	}
+
+	nm_clear_g_variant (&config->args);
+	if (args)
+		config->args = g_variant_ref_sink (args);
+
+	schedule_flush (self);
 }
 
 static void
@@ -254,17 +355,33 @@ name_owner_changed (GObject *object,
 	NMPacrunnerManager *self = NM_PACRUNNER_MANAGER (user_data);
 	NMPacrunnerManagerPrivate *priv = NM_PACRUNNER_MANAGER_GET_PRIVATE (self);
 	gs_free char *owner = NULL;
-	GList *iter = NULL;
+	GHashTableIter iter;
+	Config *config;
 
 	owner = g_dbus_proxy_get_name_owner (G_DBUS_PROXY (object));
-	if (owner) {
+	if (owner)
 		_LOGD ("pacrunner appeared as %s", owner);
-		for (iter = g_list_first(priv->args); iter; iter = g_list_next(iter)) {
-			send_pacrunner_proxy_data (self, iter->data);
-		}
-	} else {
+	else
 		_LOGD ("pacrunner disappeared");
+
+	/* a new pacrunner has nothing of ours. Pending calls went to the old
+	 * one, their results are ignored. */
+	nm_clear_g_cancellable (&priv->cancellable);
+	priv->cancellable = g_cancellable_new ();
+
+	g_hash_table_iter_init (&iter, priv->configs);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &config)) {
+		if (!config->args) {
+			g_hash_table_iter_remove (&iter);
+			continue;
+		}
+		nm_clear_g_variant (&config->sent_args);
+		g_clear_pointer (&config->path, g_free);
+		config->create_pending = FALSE;
 	}
+
+	if (owner)
+		schedule_flush (self);
 }
 
 static void
@@ -290,6 +407,9 @@ pacrunner_proxy_cb (GObject *source, GAsyncResult *res, gpointer user_data)
 
 	g_signal_connect (priv->pacrunner, "notify::g-name-owner",
 	                  G_CALLBACK (name_owner_changed), self);
+
+	/* send what was queued while we connected. */
+	schedule_flush (self);
 }
 
 /**
@@ -299,6 +419,9 @@ pacrunner_proxy_cb (GObject *source, GAsyncResult *res, gpointer user_data)
  * @proxy_config: proxy config of the connection
  * @ip4_config: IP4 config of the connection
  * @ip6_config: IP6 config of the connection
+ *
+ * Sets the proxy configuration for @iface. Pacrunner is updated shortly
+ * after, and only if the configuration differs from what it has.
  */
 void
 nm_pacrunner_manager_send (NMPacrunnerManager *self,
@@ -311,16 +434,12 @@ nm_pacrunner_manager_send (NMPacrunnerManager *self,
 	NMProxyConfigMethod method;
 	NMPacrunnerManagerPrivate *priv;
 	GVariantBuilder proxy_data;
-	GVariant *pacrunner_manager_args;
 
 	g_return_if_fail (NM_IS_PACRUNNER_MANAGER (self));
 	g_return_if_fail (proxy_config);
 
 	priv = NM_PACRUNNER_MANAGER_GET_PRIVATE (self);
 
-	g_free (priv->iface);
-	priv->iface = g_strdup (iface);
-
 	g_variant_builder_init (&proxy_data, G_VARIANT_TYPE_VARDICT);
 
 	if (iface) {
@@ -355,6 +474,7 @@ nm_pacrunner_manager_send (NMPacrunnerManager *self,
 
 	g_ptr_array_add (priv->domains, NULL);
 	strv = (char **) g_ptr_array_free (priv->domains, (priv->domains->len == 1));
+	priv->domains = NULL;
 
 	if (strv) {
 		g_variant_builder_add (&proxy_data, "{sv}",
@@ -363,31 +483,7 @@ nm_pacrunner_manager_send (NMPacrunnerManager *self,
 		g_strfreev (strv);
 	}
 
-	pacrunner_manager_args = g_variant_ref_sink (g_variant_new ("(a{sv})", &proxy_data));
-	priv->args = g_list_append (priv->args, pacrunner_manager_args);
-
-	/* Send if pacrunner is available on Bus, otherwise
-	 * argument has already been appended above to be
-	 * sent when pacrunner appears.
-	 */
-	send_pacrunner_proxy_data (self, pacrunner_manager_args);
-}
-
-static void
-pacrunner_remove_done (GObject *source, GAsyncResult *res, gpointer user_data)
-{
-	/* @self may be a dangling pointer. However, we don't use it as the
-	 * logging macro below does not dereference @self. */
-	NMPacrunnerManager *self = user_data;
-	gs_free_error GError *error = NULL;
-	gs_unref_variant GVariant *ret = NULL;
-
-	ret = g_dbus_proxy_call_finish ((GDBusProxy *) source, res, &error);
-
-	if (!ret)
-		_LOGD ("Couldn't remove proxy config from pacrunner: %s", error->message);
-	else
-		_LOGD ("Successfully removed proxy config from pacrunner");
+	set_config (self, iface ? iface : "", g_variant_new ("(a{sv})", &proxy_data));
 }
 
 /**
@@ -399,24 +495,9 @@ pacrunner_remove_done (GObject *source, GAsyncResult *res, gpointer user_data)
 void
 nm_pacrunner_manager_remove (NMPacrunnerManager *self, const char *iface)
 {
-	NMPacrunnerManagerPrivate *priv = NM_PACRUNNER_MANAGER_GET_PRIVATE (self);
-	GList *list;
-
-	for (list = g_list_first(priv->remove); list; list = g_list_next(list)) {
-		struct remove_data *data = list->data;
-		if (g_strcmp0 (data->iface, iface) == 0) {
-			if (priv->pacrunner && data->path)
-				g_dbus_proxy_call (priv->pacrunner,
-				                   "DestroyProxyConfiguration",
-				                   g_variant_new ("(o)", data->path),
-				                   G_DBUS_CALL_FLAGS_NONE,
-				                   -1,
-				                   NULL,
-				                  (GAsyncReadyCallback) pacrunner_remove_done,
-				                   self);
-			break;
-		}
-	}
+	g_return_if_fail (NM_IS_PACRUNNER_MANAGER (self));
+
+	set_config (self, iface ? iface : "", NULL);
 }
 
 /*****************************************************************************/
@@ -427,6 +508,8 @@ nm_pacrunner_manager_init (NMPacrunnerManager *self)
 	NMPacrunnerManagerPrivate *priv = NM_PACRUNNER_MANAGER_GET_PRIVATE (self);
 
 	priv->pacrunner_cancellable = g_cancellable_new ();
+	priv->cancellable = g_cancellable_new ();
+	priv->configs = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, config_free);
 
 	g_dbus_proxy_new_for_bus (G_BUS_TYPE_SYSTEM,
 	                          G_DBUS_PROXY_FLAGS_NONE,
@@ -444,17 +527,16 @@ dispose (GObject *object)
 {
 	NMPacrunnerManagerPrivate *priv = NM_PACRUNNER_MANAGER_GET_PRIVATE ((NMPacrunnerManager *) object);
 
-	g_clear_pointer (&priv->iface, g_free);
+	nm_clear_g_source (&priv->flush_id);
 
 	nm_clear_g_cancellable (&priv->pacrunner_cancellable);
+	nm_clear_g_cancellable (&priv->cancellable);
 
+	if (priv->pacrunner)
+		g_signal_handlers_disconnect_by_func (priv->pacrunner, name_owner_changed, object);
 	g_clear_object (&priv->pacrunner);
 
-	g_list_free_full (priv->args, (GDestroyNotify) g_variant_unref);
-	priv->args = NULL;
-
-	g_list_free_full (priv->remove, (GDestroyNotify) remove_data_destroy);
-	priv->remove = NULL;
+	g_clear_pointer (&priv->configs, g_hash_table_unref);
 
 	G_OBJECT_CLASS (nm_pacrunner_manager_parent_class)->dispose (object);
 }
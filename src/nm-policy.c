@@ -79,12 +79,14 @@ typedef struct {
 	GResolver *resolver;
 	GInetAddress *lookup_addr;
 	GCancellable *lookup_cancellable;
+	GHashTable *lookup_cache; /* address string -> LookupCacheEntry */
 	NMDnsManager *dns_manager;
 	gulong config_changed_id;
 
 	guint reset_retries_id;  /* idle handler for resetting the retries count */
 
 	guint schedule_activate_all_id; /* idle handler for schedule_activate_all(). */
+	guint auto_activate_id; /* idle handler processing pending_activation_checks. */
 
 	NMPolicyHostnameMode hostname_mode;
 	char *orig_hostname; /* hostname at NM start time */
@@ -555,6 +557,77 @@ _set_hostname (NMPolicy *self,
 	                                    g_object_ref (self));
 }
 
+/*****************************************************************************/
+
+/* Results of reverse lookups are kept for a while, so that the same address
+ * showing up again (DHCP renewals, the best device flapping) doesn't cause
+ * another query. Failures are retried sooner. The cache is dropped when the
+ * DNS configuration changes. */
+#define LOOKUP_CACHE_TTL_S          300
+#define LOOKUP_CACHE_NEGATIVE_TTL_S 30
+
+typedef struct {
+	char *hostname;
+	gint32 expiry;
+} LookupCacheEntry;
+
+static void
+lookup_cache_entry_free (gpointer data)
+{
+	LookupCacheEntry *entry = data;
+
+	g_free (entry->hostname);
+	g_slice_free (LookupCacheEntry, entry);
+}
+
+static void
+lookup_cache_add (NMPolicy *self, GInetAddress *addr, const char *hostname)
+{
+	NMPolicyPrivate *priv = NM_POLICY_GET_PRIVATE (self);
+	gint32 now = nm_utils_get_monotonic_timestamp_s ();
+	LookupCacheEntry *entry;
+	GHashTableIter iter;
+
+	if (!priv->lookup_cache) {
+		priv->lookup_cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+		                                            g_free, lookup_cache_entry_free);
+	}
+
+	g_hash_table_iter_init (&iter, priv->lookup_cache);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &entry)) {
+		if (entry->expiry <= now)
+			g_hash_table_iter_remove (&iter);
+	}
+
+	entry = g_slice_new (LookupCacheEntry);
+	entry->hostname = g_strdup (hostname);
+	entry->expiry = now + (hostname ? LOOKUP_CACHE_TTL_S : LOOKUP_CACHE_NEGATIVE_TTL_S);
+	g_hash_table_insert (priv->lookup_cache, g_inet_address_to_string (addr), entry);
+}
+
+static const LookupCacheEntry *
+lookup_cache_get (NMPolicy *self, GInetAddress *addr)
+{
+	NMPolicyPrivate *priv = NM_POLICY_GET_PRIVATE (self);
+	gs_free char *key = NULL;
+	LookupCacheEntry *entry;
+
+	if (!priv->lookup_cache)
+		return NULL;
+
+	key = g_inet_address_to_string (addr);
+	entry = g_hash_table_lookup (priv->lookup_cache, key);
+	if (!entry || entry->expiry <= nm_utils_get_monotonic_timestamp_s ())
+		return NULL;
+	return entry;
+}
+
+static void
+lookup_cancel (GCancellable **p_cancellable)
+{
+	nm_clear_g_cancellable (p_cancellable);
+}
+
 static void
 lookup_callback (GObject *source,
                  GAsyncResult *result,
@@ -572,6 +645,9 @@ lookup_callback (GObject *source,
 		return;
 	}
 
+	if (priv->lookup_addr)
+		lookup_cache_add (self, priv->lookup_addr, hostname);
+
 	if (hostname)
 		_set_hostname (self, hostname, "from address lookup");
 	else {
@@ -592,6 +668,9 @@ update_system_hostname (NMPolicy *self, NMDevice *best4, NMDevice *best6, const
 	NMIP4Config *ip4_config;
 	NMIP6Config *ip6_config;
 	gboolean external_hostname = FALSE;
+	gs_unref_object GInetAddress *addr = NULL;
+	const LookupCacheEntry *cached;
+	nm_auto (lookup_cancel) GCancellable *superseded = NULL;
 
 	g_return_if_fail (self != NULL);
 
@@ -602,7 +681,9 @@ update_system_hostname (NMPolicy *self, NMDevice *best4, NMDevice *best6, const
 
 	_LOGT (LOGD_DNS, "set-hostname: updating hostname (%s)", msg);
 
-	nm_clear_g_cancellable (&priv->lookup_cancellable);
+	/* A pending lookup is cancelled when we return, unless it is for the
+	 * address we would look up again. */
+	superseded = g_steal_pointer (&priv->lookup_cancellable);
 
 	/* Check if the hostname was set externally to NM, so that in that case
 	 * we can avoid to fallback to the one we got when we started.
@@ -739,22 +820,41 @@ update_system_hostname (NMPolicy *self, NMDevice *best4, NMDevice *best6, const
 		const NMPlatformIP4Address *addr4;
 
 		addr4 = nm_ip4_config_get_address (ip4_config, 0);
-		g_clear_object (&priv->lookup_addr);
-		priv->lookup_addr = g_inet_address_new_from_bytes ((guint8 *) &addr4->address,
-		                                                   G_SOCKET_FAMILY_IPV4);
+		addr = g_inet_address_new_from_bytes ((guint8 *) &addr4->address,
+		                                      G_SOCKET_FAMILY_IPV4);
 	} else if (ip6_config && nm_ip6_config_get_num_addresses (ip6_config) > 0) {
 		const NMPlatformIP6Address *addr6;
 
 		addr6 = nm_ip6_config_get_address (ip6_config, 0);
-		g_clear_object (&priv->lookup_addr);
-		priv->lookup_addr = g_inet_address_new_from_bytes ((guint8 *) &addr6->address,
-		                                                   G_SOCKET_FAMILY_IPV6);
+		addr = g_inet_address_new_from_bytes ((guint8 *) &addr6->address,
+		                                      G_SOCKET_FAMILY_IPV6);
 	} else {
 		/* No valid IP config; fall back to localhost.localdomain */
+		g_clear_object (&priv->lookup_addr);
 		_set_hostname (self, NULL, "no IP config");
 		return;
 	}
 
+	if (   superseded
+	    && priv->lookup_addr
+	    && g_inet_address_equal (addr, priv->lookup_addr)) {
+		_LOGT (LOGD_DNS, "set-hostname: address lookup already in progress");
+		priv->lookup_cancellable = g_steal_pointer (&superseded);
+		return;
+	}
+
+	g_clear_object (&priv->lookup_addr);
+	priv->lookup_addr = g_steal_pointer (&addr);
+
+	cached = lookup_cache_get (self, priv->lookup_addr);
+	if (cached) {
+		if (cached->hostname)
+			_set_hostname (self, cached->hostname, "from address lookup (cached)");
+		else
+			_set_hostname (self, NULL, "address lookup failed (cached)");
+		return;
+	}
+
 	priv->lookup_cancellable = g_cancellable_new ();
 	g_resolver_lookup_by_address_async (priv->resolver,
 	                                    priv->lookup_addr,
@@ -1056,7 +1156,7 @@ check_activating_devices (NMPolicy *self)
 typedef struct {
 	NMPolicy *policy;
 	NMDevice *device;
-	guint autoactivate_id;
+	bool scheduled;
 } ActivateData;
 
 static void
@@ -1067,22 +1167,25 @@ activate_data_free (ActivateData *data)
 	nm_device_remove_pending_action (data->device, NM_PENDING_ACTION_AUTOACTIVATE, TRUE);
 	priv->pending_activation_checks = g_slist_remove (priv->pending_activation_checks, data);
 
-	if (data->autoactivate_id)
-		g_source_remove (data->autoactivate_id);
 	g_object_unref (data->device);
 
 	g_slice_free (ActivateData, data);
 }
 
+/* @connections is the list of activatable connections, shared by all devices
+ * of one auto-activation pass. The caller owns a reference to each entry.
+ * A connection that gets activated is cleared from the list, so the following
+ * devices don't consider it again. */
 static void
 auto_activate_device (NMPolicy *self,
-                      NMDevice *device)
+                      NMDevice *device,
+                      NMSettingsConnection **connections,
+                      guint len)
 {
 	NMPolicyPrivate *priv;
 	NMSettingsConnection *best_connection;
 	gs_free char *specific_object = NULL;
-	gs_free NMSettingsConnection **connections = NULL;
-	guint i, len;
+	guint i;
 
 	nm_assert (NM_IS_POLICY (self));
 	nm_assert (NM_IS_DEVICE (device));
@@ -1096,15 +1199,15 @@ auto_activate_device (NMPolicy *self,
 	if (nm_device_get_act_request (device))
 		return;
 
-	connections = nm_manager_get_activatable_connections (priv->manager, &len, TRUE);
-	if (!connections[0])
-		return;
-
 	/* Find the first connection that should be auto-activated */
 	best_connection = NULL;
 	for (i = 0; i < len; i++) {
-		NMSettingsConnection *candidate = NM_SETTINGS_CONNECTION (connections[i]);
+		NMSettingsConnection *candidate = connections[i];
 
+		if (!candidate)
+			continue;
+		if (!nm_settings_has_connection (priv->settings, candidate))
+			continue;
 		if (!nm_settings_connection_can_autoconnect (candidate))
 			continue;
 		if (nm_device_can_auto_connect (device, (NMConnection *) candidate, &specific_object)) {
@@ -1133,23 +1236,55 @@ auto_activate_device (NMPolicy *self,
 			       error->code,
 			       error->message);
 			g_error_free (error);
-		}
+		} else
+			g_clear_object (&connections[i]);
 		g_object_unref (subject);
 	}
 }
 
 static gboolean
-auto_activate_device_cb (gpointer user_data)
+auto_activate_all_cb (gpointer user_data)
 {
-	ActivateData *data = user_data;
+	NMPolicy *self = user_data;
+	NMPolicyPrivate *priv = NM_POLICY_GET_PRIVATE (self);
+	NMSettingsConnection **connections = NULL;
+	ActivateData *data;
+	guint i, len = 0;
 
-	g_assert (data);
-	g_assert (NM_IS_POLICY (data->policy));
-	g_assert (NM_IS_DEVICE (data->device));
+	priv->auto_activate_id = 0;
+
+	/* Process all scheduled devices in one pass, in the order they were
+	 * scheduled, sharing one scan of the activatable connections.
+	 *
+	 * Only the entry being processed is not scheduled, and it is freed
+	 * before the next iteration. So the head of the list is always the
+	 * next entry to process, and removing it is cheap. Devices scheduled
+	 * meanwhile are appended and handled in the same pass. */
+	while (priv->pending_activation_checks) {
+		data = priv->pending_activation_checks->data;
+
+		nm_assert (data->scheduled);
+		nm_assert (NM_IS_DEVICE (data->device));
+
+		if (!connections) {
+			connections = nm_manager_get_activatable_connections (priv->manager, &len, TRUE);
+			for (i = 0; i < len; i++)
+				g_object_ref (connections[i]);
+		}
+
+		data->scheduled = FALSE;
+		auto_activate_device (self, data->device, connections, len);
+		activate_data_free (data);
+	}
+
+	if (connections) {
+		for (i = 0; i < len; i++) {
+			if (connections[i])
+				g_object_unref (connections[i]);
+		}
+		g_free (connections);
+	}
 
-	data->autoactivate_id = 0;
-	auto_activate_device (data->policy, data->device);
-	activate_data_free (data);
 	return G_SOURCE_REMOVE;
 }
 
@@ -1375,8 +1510,11 @@ schedule_activate_check (NMPolicy *self, NMDevice *device)
 	data = g_slice_new0 (ActivateData);
 	data->policy = self;
 	data->device = g_object_ref (device);
-	data->autoactivate_id = g_idle_add (auto_activate_device_cb, data);
+	data->scheduled = TRUE;
 	priv->pending_activation_checks = g_slist_append (priv->pending_activation_checks, data);
+
+	if (!priv->auto_activate_id)
+		priv->auto_activate_id = g_idle_add (auto_activate_all_cb, self);
 }
 
 static void
@@ -1386,7 +1524,7 @@ clear_pending_activate_check (NMPolicy *self, NMDevice *device)
 	ActivateData *data;
 
 	data = find_pending_activation (priv->pending_activation_checks, device);
-	if (data && data->autoactivate_id)
+	if (data && data->scheduled)
 		activate_data_free (data);
 }
 
@@ -1944,22 +2082,28 @@ vpn_connection_retry_after_failure (NMVpnConnection *vpn, NMPolicy *self)
 	NMPolicyPrivate *priv = NM_POLICY_GET_PRIVATE (self);
 	NMActiveConnection *ac = NM_ACTIVE_CONNECTION (vpn);
 	NMSettingsConnection *connection = nm_active_connection_get_settings_connection (ac);
+	NMActiveConnection *new_ac;
 	GError *error = NULL;
 
 	/* Attempt to reconnect VPN connections that failed after being connected */
-	if (!nm_manager_activate_connection (priv->manager,
-	                                     connection,
-	                                     NULL,
-	                                     NULL,
-	                                     NULL,
-	                                     nm_active_connection_get_subject (ac),
-	                                     NM_ACTIVATION_TYPE_MANAGED,
-	                                     &error)) {
+	new_ac = nm_manager_activate_connection (priv->manager,
+	                                         connection,
+	                                         NULL,
+	                                         NULL,
+	                                         NULL,
+	                                         nm_active_connection_get_subject (ac),
+	                                         NM_ACTIVATION_TYPE_MANAGED,
+	                                         &error);
+	if (!new_ac) {
 		_LOGW (LOGD_DEVICE, "VPN '%s' reconnect failed: %s",
 		       nm_settings_connection_get_id (connection),
 		       error->message ? error->message : "unknown");
 		g_clear_error (&error);
+		return;
 	}
+
+	if (NM_IS_VPN_CONNECTION (new_ac))
+		nm_vpn_connection_reconnect_from (NM_VPN_CONNECTION (new_ac), vpn);
 }
 
 static void
@@ -2081,6 +2225,10 @@ dns_config_changed (NMDnsManager *dns_manager, gpointer user_data)
 
 	nm_clear_g_cancellable (&priv->lookup_cancellable);
 
+	/* Earlier results may be different with the new DNS servers. */
+	if (priv->lookup_cache)
+		g_hash_table_remove_all (priv->lookup_cache);
+
 	/* Re-start the hostname lookup thread if we don't have hostname yet. */
 	if (priv->lookup_addr) {
 		char *str = NULL;
@@ -2376,6 +2524,7 @@ dispose (GObject *object)
 	nm_clear_g_cancellable (&priv->lookup_cancellable);
 
 	g_clear_object (&priv->lookup_addr);
+	g_clear_pointer (&priv->lookup_cache, g_hash_table_unref);
 	g_clear_object (&priv->resolver);
 
 	while (priv->pending_activation_checks)
@@ -2410,6 +2559,7 @@ dispose (GObject *object)
 
 	nm_clear_g_source (&priv->reset_retries_id);
 	nm_clear_g_source (&priv->schedule_activate_all_id);
+	nm_clear_g_source (&priv->auto_activate_id);
 
 	g_clear_pointer (&priv->orig_hostname, g_free);
 	g_clear_pointer (&priv->cur_hostname, g_free);
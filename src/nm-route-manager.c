@@ -28,12 +28,17 @@
 #include "platform/nmp-object.h"
 #include "nm-core-internal.h"
 #include "NetworkManagerUtils.h"
+#include "nm-trace.h"
 
 /* if within half a second after adding an IP address a matching device-route shows
  * up, we delete it. */
 #define IP4_DEVICE_ROUTES_WAIT_TIME_NS                 (NM_UTILS_NS_PER_SECOND / 2)
 
-#define IP4_DEVICE_ROUTES_GC_INTERVAL_SEC              (IP4_DEVICE_ROUTES_WAIT_TIME_NS * 2)
+/* pending purges are expired by a single timer that advances a small timer
+ * wheel once per tick. The wheel must be larger than the number of ticks an
+ * entry can lie in the future. */
+#define IP4_DEVICE_ROUTES_TICK_NS                      IP4_DEVICE_ROUTES_WAIT_TIME_NS
+#define IP4_DEVICE_ROUTES_WHEEL_SIZE                   4
 
 /*****************************************************************************/
 
@@ -57,7 +62,13 @@ typedef struct {
 typedef struct {
 	NMRouteManager *self;
 	gint64 scheduled_at_ns;
-	guint idle_id;
+	gint64 expires_tick;
+
+	/* the link in the wheel slot for @expires_tick. */
+	GList *wheel_link;
+
+	/* the link in the purge queue, if a matching route showed up. */
+	GList *purge_link;
 	NMPObject *obj;
 } IP4DeviceRoutePurgeEntry;
 
@@ -80,7 +91,11 @@ typedef struct {
 	RouteEntries ip6_routes;
 	struct {
 		GHashTable *entries;
+		GQueue wheel[IP4_DEVICE_ROUTES_WHEEL_SIZE];
+		gint64 wheel_tick;
+		GQueue purge_queue;
 		guint gc_id;
+		guint idle_id;
 	} ip4_device_routes;
 } NMRouteManagerPrivate;
 
@@ -307,6 +322,84 @@ _route_index_create (const VTableIP *vtable, const GArray *routes)
 	return index;
 }
 
+/* Create a new index for @routes, based on the previous @old_order.
+ *
+ * @old_order contains the offsets into @routes as they were sorted before
+ * @routes got modified. Since then, the (sorted) offsets @deleted were removed
+ * from @routes and @n_added new routes were appended.
+ *
+ * The result is identical to _route_index_create(), but instead of sorting all
+ * routes, only the added ones are sorted and then merged with the existing order. */
+static RouteIndex *
+_route_index_create_merged (const VTableIP *vtable,
+                            const GArray *routes,
+                            const guint *old_order,
+                            guint old_len,
+                            const guint *deleted,
+                            guint n_deleted,
+                            guint n_added)
+{
+	RouteIndex *index;
+	gs_free guint *shift = NULL;
+	gs_free NMPlatformIPXRoute **added = NULL;
+	guint len = routes ? routes->len : 0;
+	guint i, j, n_kept;
+	guint i_old, i_added;
+
+	nm_assert (len == old_len - n_deleted + n_added);
+
+	/* map the previous offsets to the ones after deletion. */
+	shift = g_new (guint, old_len + 1);
+	for (i = 0, j = 0, n_kept = 0; i < old_len; i++) {
+		if (j < n_deleted && deleted[j] == i) {
+			shift[i] = G_MAXUINT;
+			j++;
+		} else
+			shift[i] = n_kept++;
+	}
+	nm_assert (j == n_deleted);
+	nm_assert (n_kept + n_added == len);
+
+	added = g_new (NMPlatformIPXRoute *, n_added + 1);
+	for (i = 0; i < n_added; i++)
+		added[i] = VTABLE_ROUTE_INDEX (vtable, routes, n_kept + i);
+
+	/* this is a stable sort, which is very important at this point. */
+	g_qsort_with_data (added,
+	                   n_added,
+	                   sizeof (NMPlatformIPXRoute *),
+	                   (GCompareDataFunc) _route_index_create_sort,
+	                   (gpointer) vtable);
+
+	index = g_malloc (sizeof (RouteIndex) + len * sizeof (NMPlatformIPXRoute *));
+	index->len = len;
+
+	/* Merge. On equal routes, the previously existing ones come first. That
+	 * is the same order as a stable sort of @routes would give. */
+	i_old = 0;
+	i_added = 0;
+	for (i = 0; i < len; i++) {
+		NMPlatformIPXRoute *r_old = NULL;
+
+		while (i_old < old_len && shift[old_order[i_old]] == G_MAXUINT)
+			i_old++;
+		if (i_old < old_len)
+			r_old = VTABLE_ROUTE_INDEX (vtable, routes, shift[old_order[i_old]]);
+
+		if (   r_old
+		    && (   i_added >= n_added
+		        || vtable->route_id_cmp (r_old, added[i_added]) <= 0)) {
+			index->entries[i] = r_old;
+			i_old++;
+		} else {
+			nm_assert (i_added < n_added);
+			index->entries[i] = added[i_added++];
+		}
+	}
+	index->entries[i] = NULL;
+	return index;
+}
+
 static int
 _vx_route_id_cmp_full (const NMPlatformIPXRoute *r1, const NMPlatformIPXRoute *r2, const VTableIP *vtable)
 {
@@ -453,6 +546,25 @@ _sort_indexes_cmp (guint *a, guint *b)
 	g_return_val_if_reached (0);
 }
 
+static void
+_route_batch_append (const VTableIP *vtable, GArray **p_batch, gboolean is_delete, int ifindex, const NMPlatformIPXRoute *route, gint64 metric)
+{
+	NMPlatformIPRouteBatchEntry *e;
+
+	if (!*p_batch)
+		*p_batch = g_array_new (FALSE, TRUE, sizeof (NMPlatformIPRouteBatchEntry));
+
+	g_array_set_size (*p_batch, (*p_batch)->len + 1);
+	e = &g_array_index (*p_batch, NMPlatformIPRouteBatchEntry, (*p_batch)->len - 1);
+
+	memcpy (&e->route, route, vtable->vt->sizeof_route);
+	if (ifindex > 0)
+		e->route.rx.ifindex = ifindex;
+	if (metric >= 0)
+		e->route.rx.metric = metric;
+	e->is_delete = is_delete;
+}
+
 /*****************************************************************************/
 
 static gboolean
@@ -472,6 +584,10 @@ _vx_route_sync (const VTableIP *vtable, NMRouteManager *self, int ifindex, const
 	gint64 *p_effective_metric = NULL;
 	gboolean ipx_routes_changed = FALSE;
 	gint64 *effective_metrics = NULL;
+	GArray *batch = NULL;
+	guint batch_sync_start;
+
+	NM_TRACE4 (route__sync__start, vtable->vt->addr_family, ifindex, known_routes->len, (int) full_sync);
 
 	nm_platform_process_events (priv->platform);
 
@@ -598,13 +714,22 @@ _vx_route_sync (const VTableIP *vtable, NMRouteManager *self, int ifindex, const
 				 * in platform. Delete it. */
 				_LOGt (vtable->vt->addr_family, "%3d: platform rt-rm #%u - %s", ifindex, i_plat_routes,
 				       vtable->vt->route_to_string (cur_plat_route, NULL, 0));
-				vtable->vt->route_delete (priv->platform, ifindex, cur_plat_route);
+				_route_batch_append (vtable, &batch, TRUE, ifindex, cur_plat_route, -1);
 			}
 		}
 	}
 
 	/* Update @ipx_routes with the just learned changes. */
 	if (to_delete_indexes || to_add_routes) {
+		gs_free guint *old_order = NULL;
+		guint old_len = ipx_routes->index->len;
+
+		/* remember the current sort order as offsets into @ipx_routes->entries, so that
+		 * we don't have to sort all entries again afterwards. */
+		old_order = g_new (guint, old_len + 1);
+		for (i = 0; i < old_len; i++)
+			old_order[i] = _route_index_reverse_idx (vtable, ipx_routes->index, i, ipx_routes->entries);
+
 		if (to_delete_indexes) {
 			for (i = 0; i < to_delete_indexes->len; i++) {
 				guint idx = g_array_index (to_delete_indexes, guint, i);
@@ -616,7 +741,6 @@ _vx_route_sync (const VTableIP *vtable, NMRouteManager *self, int ifindex, const
 			g_array_sort (to_delete_indexes, (GCompareFunc) _sort_indexes_cmp);
 			nm_utils_array_remove_at_indexes (ipx_routes->entries, &g_array_index (to_delete_indexes, guint, 0), to_delete_indexes->len);
 			nm_utils_array_remove_at_indexes (ipx_routes->effective_metrics_reverse, &g_array_index (to_delete_indexes, guint, 0), to_delete_indexes->len);
-			g_array_unref (to_delete_indexes);
 		}
 		if (to_add_routes) {
 			guint j = ipx_routes->effective_metrics_reverse->len;
@@ -637,10 +761,19 @@ _vx_route_sync (const VTableIP *vtable, NMRouteManager *self, int ifindex, const
 				_LOGt (vtable->vt->addr_family, "%3d: STATE: added   #%u - %s", ifindex, ipx_routes->entries->len - 1,
 				       vtable->vt->route_to_string (ipx_route, NULL, 0));
 			}
-			g_ptr_array_unref (to_add_routes);
 		}
 		g_free (ipx_routes->index);
-		ipx_routes->index = _route_index_create (vtable, ipx_routes->entries);
+		ipx_routes->index = _route_index_create_merged (vtable,
+		                                                ipx_routes->entries,
+		                                                old_order,
+		                                                old_len,
+		                                                to_delete_indexes ? &g_array_index (to_delete_indexes, guint, 0) : NULL,
+		                                                to_delete_indexes ? to_delete_indexes->len : 0,
+		                                                to_add_routes ? to_add_routes->len : 0);
+		if (to_delete_indexes)
+			g_array_unref (to_delete_indexes);
+		if (to_add_routes)
+			g_ptr_array_unref (to_add_routes);
 		ipx_routes_changed = TRUE;
 		ASSERT_route_index_valid (vtable, ipx_routes->entries, ipx_routes->index, TRUE);
 	}
@@ -764,7 +897,7 @@ next:
 			if (   !cur_ipx_route
 			    || route_dest_cmp_result != 0
 			    || *p_effective_metric != cur_plat_route->rx.metric)
-				vtable->vt->route_delete (priv->platform, ifindex, cur_plat_route);
+				_route_batch_append (vtable, &batch, TRUE, ifindex, cur_plat_route, -1);
 
 			cur_plat_route = _get_next_plat_route (plat_routes_idx, FALSE, &i_plat_routes);
 		}
@@ -837,15 +970,15 @@ next:
 					gateway_routes = g_array_new (FALSE, FALSE, sizeof (guint));
 				g_array_append_val (gateway_routes, i_ipx_routes);
 			} else
-				vtable->vt->route_add (priv->platform, 0, cur_ipx_route, *p_effective_metric);
+				_route_batch_append (vtable, &batch, FALSE, 0, cur_ipx_route, *p_effective_metric);
 		}
 
 		if (gateway_routes) {
 			for (i = 0; i < gateway_routes->len; i++) {
 				i_ipx_routes = g_array_index (gateway_routes, guint, i);
-				vtable->vt->route_add (priv->platform, 0,
-				                       ipx_routes->index->entries[i_ipx_routes],
-				                       effective_metrics[i_ipx_routes]);
+				_route_batch_append (vtable, &batch, FALSE, 0,
+				                     ipx_routes->index->entries[i_ipx_routes],
+				                     effective_metrics[i_ipx_routes]);
 			}
 			g_array_unref (gateway_routes);
 		}
@@ -855,6 +988,9 @@ next:
 	 * Sync @ipx_routes for @ifindex to platform
 	 **************************************************************************/
 
+	/* failures of the requests before @batch_sync_start are ignored. */
+	batch_sync_start = batch ? batch->len : 0;
+
 	for (i_type = 0; i_type < 2; i_type++) {
 		/* iterate (twice) over @ipx_routes and @plat_routes */
 		cur_plat_route = _get_next_plat_route (plat_routes_idx, TRUE, &i_plat_routes);
@@ -892,22 +1028,38 @@ next:
 			 * i.e. if @cur_plat_route is different from @cur_ipx_route. */
 			if (   !cur_plat_route
 			    || route_dest_cmp_result != 0
-			    || !_route_equals_ignoring_ifindex (vtable, cur_plat_route, cur_ipx_route, *p_effective_metric)) {
-
-				if (!vtable->vt->route_add (priv->platform, ifindex, cur_ipx_route, *p_effective_metric)) {
-					if (cur_ipx_route->rx.rt_source < NM_IP_CONFIG_SOURCE_USER) {
-						_LOGD (vtable->vt->addr_family,
-						       "ignore error adding IPv%c route to kernel: %s",
-						       vtable->vt->is_ip4 ? '4' : '6',
-						       vtable->vt->route_to_string (cur_ipx_route, NULL, 0));
-					} else {
-						/* Remember that there was a failure, but for now continue trying
-						 * to sync the remaining routes. */
-						success = FALSE;
-					}
-				}
+			    || !_route_equals_ignoring_ifindex (vtable, cur_plat_route, cur_ipx_route, *p_effective_metric))
+				_route_batch_append (vtable, &batch, FALSE, ifindex, cur_ipx_route, *p_effective_metric);
+		}
+	}
+
+	/* Send all the collected requests to platform at once. They are processed
+	 * in order, so deletions still happen before additions and device routes
+	 * are added before the gateway routes that might depend on them. */
+	if (batch) {
+		nm_platform_ip_route_batch (priv->platform,
+		                            vtable->vt->addr_family,
+		                            &g_array_index (batch, NMPlatformIPRouteBatchEntry, 0),
+		                            batch->len);
+
+		for (i = batch_sync_start; i < batch->len; i++) {
+			const NMPlatformIPRouteBatchEntry *e = &g_array_index (batch, NMPlatformIPRouteBatchEntry, i);
+
+			if (e->success)
+				continue;
+
+			if (e->route.rx.rt_source < NM_IP_CONFIG_SOURCE_USER) {
+				_LOGD (vtable->vt->addr_family,
+				       "ignore error adding IPv%c route to kernel: %s",
+				       vtable->vt->is_ip4 ? '4' : '6',
+				       vtable->vt->route_to_string (&e->route, NULL, 0));
+			} else {
+				/* Remember that there was a failure, but still sync the
+				 * remaining routes. */
+				success = FALSE;
 			}
 		}
+		g_array_unref (batch);
 	}
 
 	if (vtable->vt->is_ip4 && ipx_routes_changed)
@@ -917,6 +1069,8 @@ next:
 	g_free (plat_routes_idx);
 	g_array_unref (plat_routes);
 
+	NM_TRACE3 (route__sync__done, vtable->vt->addr_family, ifindex, (int) success);
+
 	return success;
 }
 
@@ -1005,6 +1159,12 @@ nm_route_manager_ip4_routes_shadowed (NMRouteManager *self, int ifindex)
 
 /*****************************************************************************/
 
+static gint64
+_ip4_device_routes_tick (gint64 now_ns)
+{
+	return now_ns / IP4_DEVICE_ROUTES_TICK_NS;
+}
+
 static gboolean
 _ip4_device_routes_entry_expired (const IP4DeviceRoutePurgeEntry *entry, gint64 now)
 {
@@ -1016,11 +1176,13 @@ _ip4_device_routes_purge_entry_create (NMRouteManager *self, const NMPlatformIP4
 {
 	IP4DeviceRoutePurgeEntry *entry;
 
-	entry = g_slice_new (IP4DeviceRoutePurgeEntry);
+	entry = g_slice_new0 (IP4DeviceRoutePurgeEntry);
 
 	entry->self = self;
 	entry->scheduled_at_ns = now_ns;
-	entry->idle_id = 0;
+
+	/* the first tick at which the entry is certainly expired. */
+	entry->expires_tick = _ip4_device_routes_tick (now_ns + IP4_DEVICE_ROUTES_WAIT_TIME_NS) + 1;
 	entry->obj = nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, (NMPlatformObject *) route);
 	return entry;
 }
@@ -1028,35 +1190,55 @@ _ip4_device_routes_purge_entry_create (NMRouteManager *self, const NMPlatformIP4
 static void
 _ip4_device_routes_purge_entry_free (IP4DeviceRoutePurgeEntry *entry)
 {
+	NMRouteManagerPrivate *priv = NM_ROUTE_MANAGER_GET_PRIVATE (entry->self);
+
+	if (entry->wheel_link) {
+		g_queue_delete_link (&priv->ip4_device_routes.wheel[entry->expires_tick % IP4_DEVICE_ROUTES_WHEEL_SIZE],
+		                     entry->wheel_link);
+	}
+	if (entry->purge_link)
+		g_queue_delete_link (&priv->ip4_device_routes.purge_queue, entry->purge_link);
 	nmp_object_unref (entry->obj);
-	nm_clear_g_source (&entry->idle_id);
 	g_slice_free (IP4DeviceRoutePurgeEntry, entry);
 }
 
+static void
+_ip4_device_routes_counter_add (NMRouteManager *self, NMPlatformCounter counter)
+{
+	NMRouteManagerPrivate *priv = NM_ROUTE_MANAGER_GET_PRIVATE (self);
+
+	if (priv->platform)
+		nm_platform_counter_add (priv->platform, counter, 1);
+}
+
 static gboolean
-_ip4_device_routes_idle_cb (IP4DeviceRoutePurgeEntry *entry)
+_ip4_device_routes_idle_cb (NMRouteManager *self)
 {
-	NMRouteManager *self;
-	NMRouteManagerPrivate *priv;
+	NMRouteManagerPrivate *priv = NM_ROUTE_MANAGER_GET_PRIVATE (self);
+	IP4DeviceRoutePurgeEntry *entry;
 
-	nm_clear_g_source (&entry->idle_id);
+	priv->ip4_device_routes.idle_id = 0;
 
-	self = entry->self;
-	priv = NM_ROUTE_MANAGER_GET_PRIVATE (self);
-	if (_route_index_find (&vtable_v4, priv->ip4_routes.index, &entry->obj->ipx_route) >= 0) {
-		/* we have an identical route in our list. Don't delete it. */
-		return G_SOURCE_REMOVE;
-	}
+	while ((entry = g_queue_pop_head (&priv->ip4_device_routes.purge_queue))) {
+		entry->purge_link = NULL;
 
-	_LOGt (vtable_v4.vt->addr_family, "device-route: delete %s", nmp_object_to_string (entry->obj, NMP_OBJECT_TO_STRING_PUBLIC, NULL, 0));
+		if (_route_index_find (&vtable_v4, priv->ip4_routes.index, &entry->obj->ipx_route) >= 0) {
+			/* we have an identical route in our list. Don't delete it. */
+			continue;
+		}
+
+		_LOGt (vtable_v4.vt->addr_family, "device-route: delete %s", nmp_object_to_string (entry->obj, NMP_OBJECT_TO_STRING_PUBLIC, NULL, 0));
 
-	nm_platform_ip4_route_delete (priv->platform,
-	                              entry->obj->ip4_route.ifindex,
-	                              entry->obj->ip4_route.network,
-	                              entry->obj->ip4_route.plen,
-	                              entry->obj->ip4_route.metric);
+		nm_platform_ip4_route_delete (priv->platform,
+		                              entry->obj->ip4_route.ifindex,
+		                              entry->obj->ip4_route.network,
+		                              entry->obj->ip4_route.plen,
+		                              entry->obj->ip4_route.metric);
+		_ip4_device_routes_counter_add (self, NM_PLATFORM_COUNTER_IP4_DEVICE_ROUTE_PURGED);
+
+		g_hash_table_remove (priv->ip4_device_routes.entries, entry->obj);
+	}
 
-	g_hash_table_remove (priv->ip4_device_routes.entries, entry->obj);
 	_ip4_device_routes_cancel (self);
 	return G_SOURCE_REMOVE;
 }
@@ -1092,14 +1274,18 @@ _ip4_device_routes_ip4_route_changed (NMPlatform *platform,
 
 	if (_ip4_device_routes_entry_expired (entry, nm_utils_get_monotonic_timestamp_ns ())) {
 		_LOGt (vtable_v4.vt->addr_family, "device-route: cleanup-ch %s", nmp_object_to_string (entry->obj, NMP_OBJECT_TO_STRING_PUBLIC, NULL, 0));
+		_ip4_device_routes_counter_add (self, NM_PLATFORM_COUNTER_IP4_DEVICE_ROUTE_EXPIRED);
 		g_hash_table_remove (priv->ip4_device_routes.entries, entry->obj);
 		_ip4_device_routes_cancel (self);
 		return;
 	}
 
-	if (entry->idle_id == 0) {
+	if (!entry->purge_link) {
 		_LOGt (vtable_v4.vt->addr_family, "device-route: schedule %s", nmp_object_to_string (entry->obj, NMP_OBJECT_TO_STRING_PUBLIC, NULL, 0));
-		entry->idle_id = g_idle_add ((GSourceFunc) _ip4_device_routes_idle_cb, entry);
+		g_queue_push_tail (&priv->ip4_device_routes.purge_queue, entry);
+		entry->purge_link = priv->ip4_device_routes.purge_queue.tail;
+		if (priv->ip4_device_routes.idle_id == 0)
+			priv->ip4_device_routes.idle_id = g_idle_add ((GSourceFunc) _ip4_device_routes_idle_cb, self);
 	}
 }
 
@@ -1115,6 +1301,7 @@ _ip4_device_routes_cancel (NMRouteManager *self)
 		if (priv->platform)
 			g_signal_handlers_disconnect_by_func (priv->platform, G_CALLBACK (_ip4_device_routes_ip4_route_changed), self);
 		nm_clear_g_source (&priv->ip4_device_routes.gc_id);
+		nm_clear_g_source (&priv->ip4_device_routes.idle_id);
 	}
 	return G_SOURCE_REMOVE;
 }
@@ -1123,19 +1310,33 @@ static gboolean
 _ip4_device_routes_gc (NMRouteManager *self)
 {
 	NMRouteManagerPrivate *priv;
-	GHashTableIter iter;
 	IP4DeviceRoutePurgeEntry *entry;
-	gint64 now = nm_utils_get_monotonic_timestamp_ns ();
+	gint64 now_tick = _ip4_device_routes_tick (nm_utils_get_monotonic_timestamp_ns ());
+	gint64 tick;
+	GList *iter, *next;
 
 	priv = NM_ROUTE_MANAGER_GET_PRIVATE (self);
 
-	g_hash_table_iter_init (&iter, priv->ip4_device_routes.entries);
-	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &entry)) {
-		if (_ip4_device_routes_entry_expired (entry, now)) {
+	/* only visit the slots that became due since the last run. If we are
+	 * late by more than a full turn of the wheel, every slot is visited once. */
+	for (tick = priv->ip4_device_routes.wheel_tick + 1;
+	     tick <= now_tick && tick <= priv->ip4_device_routes.wheel_tick + IP4_DEVICE_ROUTES_WHEEL_SIZE;
+	     tick++) {
+		GQueue *slot = &priv->ip4_device_routes.wheel[tick % IP4_DEVICE_ROUTES_WHEEL_SIZE];
+
+		for (iter = slot->head; iter; iter = next) {
+			next = iter->next;
+			entry = iter->data;
+
+			if (entry->expires_tick > now_tick)
+				continue;
+
 			_LOGt (vtable_v4.vt->addr_family, "device-route: cleanup-gc %s", nmp_object_to_string (entry->obj, NMP_OBJECT_TO_STRING_PUBLIC, NULL, 0));
-			g_hash_table_iter_remove (&iter);
+			_ip4_device_routes_counter_add (self, NM_PLATFORM_COUNTER_IP4_DEVICE_ROUTE_EXPIRED);
+			g_hash_table_remove (priv->ip4_device_routes.entries, entry->obj);
 		}
 	}
+	priv->ip4_device_routes.wheel_tick = now_tick;
 
 	return _ip4_device_routes_cancel (self);
 }
@@ -1147,7 +1348,10 @@ _ip4_device_routes_gc (NMRouteManager *self)
  * metric zero. We don't want that route and want to delete it. However, the route
  * by kernel immediately, but some time after. That means during nm_route_manager_ip4_route_sync()
  * such a route doesn't exist yet. We must remember that we expect such a route to appear later
- * and to remove it. */
+ * and to remove it.
+ *
+ * All pending entries share one coarse timer: each entry is put into the slot
+ * of a small timer wheel that corresponds to the tick at which it expires. */
 void
 nm_route_manager_ip4_route_register_device_route_purge_list (NMRouteManager *self, GArray *device_route_purge_list)
 {
@@ -1161,8 +1365,16 @@ nm_route_manager_ip4_route_register_device_route_purge_list (NMRouteManager *sel
 	priv = NM_ROUTE_MANAGER_GET_PRIVATE (self);
 
 	now_ns = nm_utils_get_monotonic_timestamp_ns ();
+
+	if (priv->ip4_device_routes.gc_id == 0) {
+		g_signal_connect (priv->platform, NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED, G_CALLBACK (_ip4_device_routes_ip4_route_changed), self);
+		priv->ip4_device_routes.wheel_tick = _ip4_device_routes_tick (now_ns);
+		priv->ip4_device_routes.gc_id = g_timeout_add (IP4_DEVICE_ROUTES_TICK_NS / NM_UTILS_NS_PER_MSEC, (GSourceFunc) _ip4_device_routes_gc, self);
+	}
+
 	for (i = 0; i < device_route_purge_list->len; i++) {
 		IP4DeviceRoutePurgeEntry *entry;
+		GQueue *slot;
 
 		entry = _ip4_device_routes_purge_entry_create (self, &g_array_index (device_route_purge_list, NMPlatformIP4Route, i), now_ns);
 		_LOGt (vtable_v4.vt->addr_family, "device-route: watch (%s) %s",
@@ -1172,10 +1384,15 @@ nm_route_manager_ip4_route_register_device_route_purge_list (NMRouteManager *sel
 		g_hash_table_replace (priv->ip4_device_routes.entries,
 		                      nmp_object_ref (entry->obj),
 		                      entry);
-	}
-	if (priv->ip4_device_routes.gc_id == 0) {
-		g_signal_connect (priv->platform, NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED, G_CALLBACK (_ip4_device_routes_ip4_route_changed), self);
-		priv->ip4_device_routes.gc_id = g_timeout_add (IP4_DEVICE_ROUTES_GC_INTERVAL_SEC, (GSourceFunc) _ip4_device_routes_gc, self);
+
+		nm_assert (entry->expires_tick > priv->ip4_device_routes.wheel_tick);
+		nm_assert (entry->expires_tick - priv->ip4_device_routes.wheel_tick <= IP4_DEVICE_ROUTES_WHEEL_SIZE);
+
+		slot = &priv->ip4_device_routes.wheel[entry->expires_tick % IP4_DEVICE_ROUTES_WHEEL_SIZE];
+		g_queue_push_tail (slot, entry);
+		entry->wheel_link = slot->tail;
+
+		_ip4_device_routes_counter_add (self, NM_PLATFORM_COUNTER_IP4_DEVICE_ROUTE_WATCHED);
 	}
 }
 
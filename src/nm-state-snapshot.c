@@ -0,0 +1,270 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2017 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "nm-state-snapshot.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "nm-manager.h"
+#include "nm-ip4-config.h"
+#include "nm-ip6-config.h"
+#include "devices/nm-device.h"
+#include "platform/nm-platform.h"
+
+/*****************************************************************************/
+
+struct _NMStateSnapshot {
+	NMManager *manager;
+	int fd;
+	guint8 *map;
+	gsize map_size;
+	guint32 seq;
+	guint timeout_id;
+	GArray *devices;
+	GArray *addresses;
+	GArray *routes;
+};
+
+/*****************************************************************************/
+
+static void
+collect_device (NMStateSnapshot *self, NMDevice *device)
+{
+	NMStateSnapshotDevice *dev;
+	const NMPlatformLink *pllink;
+	NMIP4Config *ip4_config;
+	NMIP6Config *ip6_config;
+	guint i, n;
+
+	g_array_set_size (self->devices, self->devices->len + 1);
+	dev = &g_array_index (self->devices, NMStateSnapshotDevice, self->devices->len - 1);
+	memset (dev, 0, sizeof (*dev));
+
+	g_strlcpy (dev->iface, nm_device_get_iface (device), sizeof (dev->iface));
+	dev->ifindex = nm_device_get_ip_ifindex (device);
+	dev->state = nm_device_get_state (device);
+	dev->first_address = self->addresses->len;
+	dev->first_route = self->routes->len;
+
+	if (dev->ifindex > 0) {
+		pllink = nm_platform_link_get (NM_PLATFORM_GET, dev->ifindex);
+		if (pllink) {
+			dev->rx_packets = pllink->rx_packets;
+			dev->rx_bytes = pllink->rx_bytes;
+			dev->tx_packets = pllink->tx_packets;
+			dev->tx_bytes = pllink->tx_bytes;
+		}
+	}
+
+	ip4_config = nm_device_get_ip4_config (device);
+	if (ip4_config) {
+		n = nm_ip4_config_get_num_addresses (ip4_config);
+		for (i = 0; i < n; i++) {
+			const NMPlatformIP4Address *a = nm_ip4_config_get_address (ip4_config, i);
+			NMStateSnapshotAddress addr = { .family = AF_INET, .plen = a->plen };
+
+			memcpy (addr.address, &a->address, sizeof (a->address));
+			g_array_append_val (self->addresses, addr);
+		}
+
+		n = nm_ip4_config_get_num_routes (ip4_config);
+		for (i = 0; i < n; i++) {
+			const NMPlatformIP4Route *r = nm_ip4_config_get_route (ip4_config, i);
+			NMStateSnapshotRoute route = { .family = AF_INET, .plen = r->plen, .metric = r->metric };
+
+			memcpy (route.network, &r->network, sizeof (r->network));
+			memcpy (route.gateway, &r->gateway, sizeof (r->gateway));
+			g_array_append_val (self->routes, route);
+		}
+	}
+
+	ip6_config = nm_device_get_ip6_config (device);
+	if (ip6_config) {
+		n = nm_ip6_config_get_num_addresses (ip6_config);
+		for (i = 0; i < n; i++) {
+			const NMPlatformIP6Address *a = nm_ip6_config_get_address (ip6_config, i);
+			NMStateSnapshotAddress addr = { .family = AF_INET6, .plen = a->plen };
+
+			memcpy (addr.address, &a->address, sizeof (a->address));
+			g_array_append_val (self->addresses, addr);
+		}
+
+		n = nm_ip6_config_get_num_routes (ip6_config);
+		for (i = 0; i < n; i++) {
+			const NMPlatformIP6Route *r = nm_ip6_config_get_route (ip6_config, i);
+			NMStateSnapshotRoute route = { .family = AF_INET6, .plen = r->plen, .metric = r->metric };
+
+			memcpy (route.network, &r->network, sizeof (r->network));
+			memcpy (route.gateway, &r->gateway, sizeof (r->gateway));
+			g_array_append_val (self->routes, route);
+		}
+	}
+
+	dev->n_addresses = self->addresses->len - dev->first_address;
+	dev->n_routes = self->routes->len - dev->first_route;
+}
+
+static gboolean
+ensure_size (NMStateSnapshot *self, gsize size)
+{
+	gsize page_size = sysconf (_SC_PAGESIZE);
+	gsize new_size;
+	guint8 *map;
+
+	if (size <= self->map_size)
+		return TRUE;
+
+	new_size = (size + page_size - 1) / page_size * page_size;
+
+	/* grow the file before mapping it again. Readers see the larger
+	 * @file_size only after the next update and remap on their own. */
+	if (ftruncate (self->fd, new_size) != 0) {
+		nm_log_warn (LOGD_CORE, "state-snapshot: cannot resize %s: %s",
+		             NM_STATE_SNAPSHOT_PATH, g_strerror (errno));
+		return FALSE;
+	}
+
+	map = mmap (NULL, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, self->fd, 0);
+	if (map == MAP_FAILED) {
+		nm_log_warn (LOGD_CORE, "state-snapshot: cannot map %s: %s",
+		             NM_STATE_SNAPSHOT_PATH, g_strerror (errno));
+		return FALSE;
+	}
+
+	if (self->map)
+		munmap (self->map, self->map_size);
+	self->map = map;
+	self->map_size = new_size;
+	return TRUE;
+}
+
+static void
+update (NMStateSnapshot *self)
+{
+	NMStateSnapshotHeader *header;
+	const GSList *iter;
+	gsize off_addresses, off_routes, size;
+
+	g_array_set_size (self->devices, 0);
+	g_array_set_size (self->addresses, 0);
+	g_array_set_size (self->routes, 0);
+
+	for (iter = nm_manager_get_devices (self->manager); iter; iter = iter->next)
+		collect_device (self, iter->data);
+
+	off_addresses = sizeof (NMStateSnapshotHeader) + self->devices->len * sizeof (NMStateSnapshotDevice);
+	off_routes = off_addresses + self->addresses->len * sizeof (NMStateSnapshotAddress);
+	size = off_routes + self->routes->len * sizeof (NMStateSnapshotRoute);
+
+	if (!ensure_size (self, size))
+		return;
+
+	header = (NMStateSnapshotHeader *) self->map;
+
+	/* seqlock write side: make @seq odd before touching the records,
+	 * and even again only after all of them are stored. */
+	__atomic_store_n (&header->seq, ++self->seq, __ATOMIC_RELAXED);
+	__atomic_thread_fence (__ATOMIC_RELEASE);
+
+	header->magic = NM_STATE_SNAPSHOT_MAGIC;
+	header->version = NM_STATE_SNAPSHOT_VERSION;
+	header->file_size = self->map_size;
+	header->n_devices = self->devices->len;
+	header->n_addresses = self->addresses->len;
+	header->n_routes = self->routes->len;
+	header->timestamp_ms = g_get_real_time () / 1000;
+
+	memcpy (&self->map[sizeof (NMStateSnapshotHeader)],
+	        self->devices->data,
+	        self->devices->len * sizeof (NMStateSnapshotDevice));
+	memcpy (&self->map[off_addresses],
+	        self->addresses->data,
+	        self->addresses->len * sizeof (NMStateSnapshotAddress));
+	memcpy (&self->map[off_routes],
+	        self->routes->data,
+	        self->routes->len * sizeof (NMStateSnapshotRoute));
+
+	__atomic_store_n (&header->seq, ++self->seq, __ATOMIC_RELEASE);
+}
+
+static gboolean
+update_cb (gpointer user_data)
+{
+	update (user_data);
+	return G_SOURCE_CONTINUE;
+}
+
+/*****************************************************************************/
+
+NMStateSnapshot *
+nm_state_snapshot_new (NMManager *manager, guint interval_sec)
+{
+	NMStateSnapshot *self;
+	int fd;
+
+	g_return_val_if_fail (NM_IS_MANAGER (manager), NULL);
+	g_return_val_if_fail (interval_sec > 0, NULL);
+
+	fd = open (NM_STATE_SNAPSHOT_PATH, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd < 0) {
+		nm_log_warn (LOGD_CORE, "state-snapshot: cannot create %s: %s",
+		             NM_STATE_SNAPSHOT_PATH, g_strerror (errno));
+		return NULL;
+	}
+
+	self = g_slice_new0 (NMStateSnapshot);
+	self->manager = g_object_ref (manager);
+	self->fd = fd;
+	self->devices = g_array_new (FALSE, FALSE, sizeof (NMStateSnapshotDevice));
+	self->addresses = g_array_new (FALSE, FALSE, sizeof (NMStateSnapshotAddress));
+	self->routes = g_array_new (FALSE, FALSE, sizeof (NMStateSnapshotRoute));
+
+	update (self);
+	self->timeout_id = g_timeout_add_seconds (interval_sec, update_cb, self);
+
+	nm_log_info (LOGD_CORE, "state-snapshot: writing %s every %u seconds",
+	             NM_STATE_SNAPSHOT_PATH, interval_sec);
+	return self;
+}
+
+void
+nm_state_snapshot_free (NMStateSnapshot *self)
+{
+	if (!self)
+		return;
+
+	nm_clear_g_source (&self->timeout_id);
+	if (self->map)
+		munmap (self->map, self->map_size);
+	close (self->fd);
+	unlink (NM_STATE_SNAPSHOT_PATH);
+
+	g_array_unref (self->devices);
+	g_array_unref (self->addresses);
+	g_array_unref (self->routes);
+	g_object_unref (self->manager);
+	g_slice_free (NMStateSnapshot, self);
+}
@@ -0,0 +1,99 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2017 Red Hat, Inc.
+ */
+
+#ifndef __NM_STATE_SNAPSHOT_H__
+#define __NM_STATE_SNAPSHOT_H__
+
+/* The state snapshot is a file that monitoring tools can mmap() to read
+ * the devices, their addresses, routes and traffic counters without
+ * talking to NetworkManager. All integers are in host byte order, all
+ * addresses in network byte order.
+ *
+ * The file starts with an NMStateSnapshotHeader, followed by @n_devices
+ * NMStateSnapshotDevice, @n_addresses NMStateSnapshotAddress and
+ * @n_routes NMStateSnapshotRoute records. Each device refers to its
+ * addresses and routes by index and count.
+ *
+ * The file is updated in place, protected by a sequence lock. A reader:
+ *   1. loads @seq with acquire semantics and starts over if it is odd;
+ *   2. checks that @file_size is not larger than its mapping, otherwise
+ *      it maps the file again and starts over;
+ *   3. copies the header and the records;
+ *   4. issues an acquire fence, loads @seq again and starts over if it
+ *      differs from the first load.
+ * The file never shrinks while NetworkManager runs. On shutdown it is
+ * removed. */
+
+#define NM_STATE_SNAPSHOT_PATH     NMRUNDIR "/state-snapshot"
+#define NM_STATE_SNAPSHOT_MAGIC    G_GUINT64_CONSTANT (0x31504e53534d4e) /* "NMSSNP1" */
+#define NM_STATE_SNAPSHOT_VERSION  1
+
+typedef struct {
+	guint64 magic;
+	guint32 version;
+
+	/* odd while the snapshot is being updated. */
+	guint32 seq;
+
+	guint32 file_size;
+	guint32 n_devices;
+	guint32 n_addresses;
+	guint32 n_routes;
+
+	/* the wall clock time of the update, in milliseconds since the epoch. */
+	gint64 timestamp_ms;
+} NMStateSnapshotHeader;
+
+typedef struct {
+	char iface[16];
+	gint32 ifindex;
+	guint32 state; /* NMDeviceState */
+	guint32 first_address;
+	guint32 n_addresses;
+	guint32 first_route;
+	guint32 n_routes;
+	guint64 rx_packets;
+	guint64 rx_bytes;
+	guint64 tx_packets;
+	guint64 tx_bytes;
+} NMStateSnapshotDevice;
+
+typedef struct {
+	guint8 family; /* AF_INET or AF_INET6 */
+	guint8 plen;
+	guint8 _reserved[2];
+	guint8 address[16];
+} NMStateSnapshotAddress;
+
+typedef struct {
+	guint8 family; /* AF_INET or AF_INET6 */
+	guint8 plen;
+	guint8 _reserved[2];
+	guint32 metric;
+	guint8 network[16];
+	guint8 gateway[16];
+} NMStateSnapshotRoute;
+
+typedef struct _NMStateSnapshot NMStateSnapshot;
+
+NMStateSnapshot *nm_state_snapshot_new (NMManager *manager, guint interval_sec);
+void nm_state_snapshot_free (NMStateSnapshot *self);
+
+#endif /* __NM_STATE_SNAPSHOT_H__ */
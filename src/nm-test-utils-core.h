@@ -52,6 +52,134 @@ nmtst_init_assert_logging (int *argc, char ***argv, const char *log_level, const
 
 /*****************************************************************************/
 
+/* Read/write benchmark of a settings plugin, see nmtst_bench_report().
+ * The connections read from the fixtures in @fixtures_dir are written
+ * under new names to a scratch directory, which is then read back like
+ * the plugin reads its directory. */
+typedef struct {
+	const char *profile;
+	const char *fixtures_dir;
+
+	gboolean (*should_ignore_file) (const char *filename);
+
+	/* returns the normalized connection of a fixture, or %NULL if
+	 * the plugin cannot write it. Some fixtures are invalid on purpose,
+	 * or not connections at all. */
+	NMConnection *(*read_fixture) (const char *path);
+
+	NMConnection *(*read) (const char *path);
+	gboolean (*write) (NMConnection *connection, const char *dirname, char **out_path);
+} NMTstSettingsBench;
+
+static inline void
+_nmtst_settings_bench_rm_dir (const char *dirname)
+{
+	GDir *dir;
+	const char *name;
+
+	dir = g_dir_open (dirname, 0, NULL);
+	if (dir) {
+		while ((name = g_dir_read_name (dir))) {
+			gs_free char *path = g_build_filename (dirname, name, NULL);
+
+			unlink (path);
+		}
+		g_dir_close (dir);
+	}
+	rmdir (dirname);
+}
+
+static inline void
+nmtst_settings_bench_run (const NMTstSettingsBench *bench, const char *scratch_dir_base)
+{
+	gs_unref_ptrarray GPtrArray *fixtures = NULL;
+	gs_unref_ptrarray GPtrArray *paths = NULL;
+	gs_free char *scratch_dir = NULL;
+	guint n_copies = nmtst_bench_size ("NMTST_BENCH_COPIES", 1000, 16 * 1024 * 1024);
+	guint n_reloads = nmtst_bench_size ("NMTST_BENCH_RELOADS", 1000, 16 * 1024 * 1024);
+	guint i, n_read;
+	gint64 start;
+	GDir *dir;
+	const char *name;
+
+	fixtures = g_ptr_array_new_with_free_func (g_object_unref);
+	dir = g_dir_open (bench->fixtures_dir, 0, NULL);
+	g_assert (dir);
+	while ((name = g_dir_read_name (dir))) {
+		gs_free char *path = NULL;
+		NMConnection *connection;
+
+		if (bench->should_ignore_file (name))
+			continue;
+		path = g_build_filename (bench->fixtures_dir, name, NULL);
+		connection = bench->read_fixture (path);
+		if (connection)
+			g_ptr_array_add (fixtures, connection);
+	}
+	g_dir_close (dir);
+	g_assert (fixtures->len > 0);
+
+	paths = g_ptr_array_new_with_free_func (g_free);
+
+	scratch_dir = g_strdup_printf ("%s/bench-XXXXXX", scratch_dir_base);
+	if (!g_mkdtemp (scratch_dir))
+		g_error ("cannot create \"%s\": %s", scratch_dir, g_strerror (errno));
+
+	start = g_get_monotonic_time ();
+	for (i = 0; i < n_copies; i++) {
+		gs_unref_object NMConnection *connection = NULL;
+		gs_free char *id = NULL;
+		gs_free char *uuid = NULL;
+		char *path = NULL;
+		NMSettingConnection *s_con;
+
+		connection = nmtst_clone_connection (fixtures->pdata[i % fixtures->len]);
+		s_con = nm_connection_get_setting_connection (connection);
+		id = g_strdup_printf ("bench-%u-%s", i, nm_setting_connection_get_id (s_con));
+		uuid = nm_utils_uuid_generate ();
+		g_object_set (s_con,
+		              NM_SETTING_CONNECTION_ID, id,
+		              NM_SETTING_CONNECTION_UUID, uuid,
+		              NULL);
+
+		if (bench->write (connection, scratch_dir, &path))
+			g_ptr_array_add (paths, path);
+	}
+	nmtst_bench_report (bench->profile, "write", n_copies, start);
+	g_assert (paths->len > 0);
+
+	start = g_get_monotonic_time ();
+	n_read = 0;
+	dir = g_dir_open (scratch_dir, 0, NULL);
+	g_assert (dir);
+	while ((name = g_dir_read_name (dir))) {
+		gs_free char *path = NULL;
+		gs_unref_object NMConnection *connection = NULL;
+
+		if (bench->should_ignore_file (name))
+			continue;
+		path = g_build_filename (scratch_dir, name, NULL);
+		connection = bench->read (path);
+		if (connection)
+			n_read++;
+	}
+	g_dir_close (dir);
+	nmtst_bench_report (bench->profile, "load-all", n_read, start);
+
+	start = g_get_monotonic_time ();
+	for (i = 0; i < n_reloads; i++) {
+		gs_unref_object NMConnection *connection = NULL;
+
+		connection = bench->read (paths->pdata[0]);
+		g_assert (connection);
+	}
+	nmtst_bench_report (bench->profile, "reload-one", n_reloads, start);
+
+	_nmtst_settings_bench_rm_dir (scratch_dir);
+}
+
+/*****************************************************************************/
+
 #ifdef __NETWORKMANAGER_PLATFORM_H__
 
 static inline NMPlatformIP4Address *
@@ -0,0 +1,75 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2017 Red Hat, Inc.
+ */
+
+#ifndef __NM_TRACE_H__
+#define __NM_TRACE_H__
+
+/* Static tracepoints (USDT) for bpftrace, perf and SystemTap.
+ *
+ * The probes are only compiled in with --enable-sdt-probes. Otherwise the
+ * macros expand to nothing and the arguments are not evaluated. When compiled
+ * in, a probe is a single nop instruction plus an ELF note; the arguments are
+ * still evaluated, so they must be cheap to compute.
+ *
+ * All probes belong to the provider "NetworkManager". Their names and
+ * arguments are stable:
+ *
+ *   netlink__msg (nlmsg_type, nlmsg_seq, nlmsg_len)
+ *       a netlink message is received, before parsing.
+ *   netlink__parsed (nlmsg_type, obj_type, ifindex)
+ *       a received netlink message was parsed into an object.
+ *   cache__op (obj_type, ops_type, ifindex)
+ *       the platform cache added, updated or removed an object.
+ *   route__sync__start (addr_family, ifindex, n_known_routes, full_sync)
+ *   route__sync__done (addr_family, ifindex, success)
+ *       syncing the routes of an interface.
+ *   device__state (iface, old_state, new_state, reason)
+ *       a device changes its state.
+ *   dbus__method (type_name, signal_name)
+ *   dbus__method__done (type_name, signal_name)
+ *       dispatching a D-Bus method call to an exported object.
+ *   settings__commit (uuid, commit_reason)
+ *       a connection profile is written.
+ *   dns__update (no_caching)
+ *   dns__update__done (success)
+ *       updating the DNS configuration.
+ */
+
+#if NM_SDT_PROBES
+
+#include <sys/sdt.h>
+
+#define NM_TRACE0(name)                     DTRACE_PROBE  (NetworkManager, name)
+#define NM_TRACE1(name, a1)                 DTRACE_PROBE1 (NetworkManager, name, a1)
+#define NM_TRACE2(name, a1, a2)             DTRACE_PROBE2 (NetworkManager, name, a1, a2)
+#define NM_TRACE3(name, a1, a2, a3)         DTRACE_PROBE3 (NetworkManager, name, a1, a2, a3)
+#define NM_TRACE4(name, a1, a2, a3, a4)     DTRACE_PROBE4 (NetworkManager, name, a1, a2, a3, a4)
+
+#else
+
+#define NM_TRACE0(name)                     G_STMT_START { } G_STMT_END
+#define NM_TRACE1(name, a1)                 G_STMT_START { } G_STMT_END
+#define NM_TRACE2(name, a1, a2)             G_STMT_START { } G_STMT_END
+#define NM_TRACE3(name, a1, a2, a3)         G_STMT_START { } G_STMT_END
+#define NM_TRACE4(name, a1, a2, a3, a4)     G_STMT_START { } G_STMT_END
+
+#endif
+
+#endif /* __NM_TRACE_H__ */
@@ -203,4 +203,8 @@ typedef struct _NMSettingsConnection NMSettingsConnection;
 /* utils */
 typedef struct _NMUtilsIPv6IfaceId   NMUtilsIPv6IfaceId;
 
+/* reports the number of objects and the bytes used by an owner of memory,
+ * see GetMemoryUsage() on the manager. */
+typedef void (*NMMemoryUsageFunc) (const char *name, guint64 n_objects, guint64 bytes, gpointer user_data);
+
 #endif  /* NM_TYPES_H */
@@ -130,7 +130,8 @@ _ip4_address_equal_peer_net (in_addr_t peer1, in_addr_t peer2, guint8 plen)
 			g_assert (!_pathid); \
 			g_assert (_path[0] == '/'); \
 			g_assert (   g_str_has_prefix (_path, "/proc/sys/") \
-			          || g_str_has_prefix (_path, "/sys/")); \
+			          || g_str_has_prefix (_path, "/sys/") \
+			          || g_str_has_prefix (_path, "/proc/irq/")); \
 		} else { \
 			g_assert_not_reached (); \
 		} \
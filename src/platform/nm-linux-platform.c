@@ -52,6 +52,7 @@
 #include "wifi/wifi-utils-wext.h"
 #include "nm-utils/unaligned.h"
 #include "nm-utils/nm-udev-utils.h"
+#include "nm-trace.h"
 
 #define VLAN_FLAG_MVRP 0x8
 
@@ -111,6 +112,21 @@
 #define IP6_FLOWINFO_TCLASS_SHIFT       20
 #define IP6_FLOWINFO_FLOWLABEL_MASK     0x000FFFFF
 
+#define IFLA_INFO_SLAVE_KIND            4
+#define IFLA_INFO_SLAVE_DATA            5
+
+#define IFLA_BR_FORWARD_DELAY           1
+#define IFLA_BR_HELLO_TIME              2
+#define IFLA_BR_MAX_AGE                 3
+#define IFLA_BR_AGEING_TIME             4
+#define IFLA_BR_STP_STATE               5
+#define IFLA_BR_PRIORITY                6
+#define IFLA_BR_MCAST_SNOOPING          23
+
+#define IFLA_BRPORT_PRIORITY            2
+#define IFLA_BRPORT_COST                3
+#define IFLA_BRPORT_MODE                4
+
 /*****************************************************************************/
 
 #define IFLA_MACSEC_UNSPEC              0
@@ -259,6 +275,7 @@ static void cache_pre_hook (NMPCache *cache, const NMPObject *old, const NMPObje
 static void cache_prune_candidates_prune (NMPlatform *platform);
 static gboolean event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks);
 static void ASSERT_NETNS_CURRENT (NMPlatform *platform);
+static void _stats_count_link_parse (NMPlatform *platform, gboolean skipped);
 
 /*****************************************************************************/
 
@@ -626,6 +643,7 @@ _linktype_get_type (NMPlatform *platform,
                     const NMPObject **link_cached,
                     const char **out_kind)
 {
+	NMPNetns *netns = platform ? nm_platform_netns_get (platform) : NULL;
 	guint i;
 
 	ASSERT_NETNS_CURRENT (platform);
@@ -698,7 +716,7 @@ _linktype_get_type (NMPlatform *platform,
 		NMPUtilsEthtoolDriverInfo driver_info;
 
 		/* Fallback OVS detection for kernel <= 3.16 */
-		if (nmp_utils_ethtool_get_driver_info (ifindex, &driver_info)) {
+		if (nmp_utils_ethtool_get_driver_info (netns, ifindex, &driver_info)) {
 			if (nm_streq (driver_info.driver, "openvswitch"))
 				return NM_LINK_TYPE_OPENVSWITCH;
 
@@ -717,7 +735,7 @@ _linktype_get_type (NMPlatform *platform,
 		gs_free char *devtype = NULL;
 		char ifname_verified[IFNAMSIZ];
 
-		dirfd = nmp_utils_sysctl_open_netdir (ifindex, ifname, ifname_verified);
+		dirfd = nmp_utils_sysctl_open_netdir (netns, ifindex, ifname, ifname_verified);
 		if (dirfd >= 0) {
 			if (faccessat (dirfd, "anycast_mask", F_OK, 0) == 0)
 				return NM_LINK_TYPE_OLPC_MESH;
@@ -1456,6 +1474,122 @@ _parse_lnk_vxlan (const char *kind, struct nlattr *info_data)
 
 /*****************************************************************************/
 
+typedef struct {
+	/* if set, the attributes are appended to @buf. Otherwise, they are
+	 * compared with @cmp_data. */
+	GByteArray *buf;
+	const guint8 *cmp_data;
+	gsize cmp_len;
+	gsize offset;
+	bool differs;
+} LinkAttrsWalk;
+
+static void
+_link_attrs_walk_data (LinkAttrsWalk *w, gconstpointer data, gsize len)
+{
+	if (w->buf) {
+		g_byte_array_append (w->buf, data, len);
+		return;
+	}
+	if (   len > w->cmp_len - w->offset
+	    || memcmp (&w->cmp_data[w->offset], data, len) != 0) {
+		w->differs = TRUE;
+		return;
+	}
+	w->offset += len;
+}
+
+/* Walks the content of a RTM_NEWLINK message, except for the statistics
+ * which change all the time. A comparison stops at the first difference. */
+static void
+_link_attrs_walk (struct nlmsghdr *nlh, LinkAttrsWalk *w, struct nlattr **out_stats64)
+{
+	const struct ifinfomsg *ifi = nlmsg_data (nlh);
+	struct nlattr *attr, *af_attr, *inet6_attr;
+	int rem, af_rem, inet6_rem;
+
+	*out_stats64 = NULL;
+
+	_link_attrs_walk_data (w, &ifi->ifi_type, sizeof (ifi->ifi_type));
+	_link_attrs_walk_data (w, &ifi->ifi_flags, sizeof (ifi->ifi_flags));
+
+	nlmsg_for_each_attr (attr, nlh, sizeof (*ifi), rem) {
+		if (w->differs)
+			return;
+		switch (nla_type (attr)) {
+		case IFLA_STATS:
+		case IFLA_XSTATS:
+			break;
+		case IFLA_STATS64:
+			*out_stats64 = attr;
+			break;
+		case IFLA_AF_SPEC:
+			nla_for_each_nested (af_attr, attr, af_rem) {
+				if (nla_type (af_attr) != AF_INET6) {
+					_link_attrs_walk_data (w, af_attr, af_attr->nla_len);
+					continue;
+				}
+				_link_attrs_walk_data (w, &af_attr->nla_type, sizeof (af_attr->nla_type));
+				nla_for_each_nested (inet6_attr, af_attr, inet6_rem) {
+					if (NM_IN_SET (nla_type (inet6_attr), IFLA_INET6_STATS,
+					                                      IFLA_INET6_ICMP6STATS,
+					                                      IFLA_INET6_CACHEINFO))
+						continue;
+					_link_attrs_walk_data (w, inet6_attr, inet6_attr->nla_len);
+				}
+			}
+			break;
+		default:
+			_link_attrs_walk_data (w, attr, attr->nla_len);
+			break;
+		}
+	}
+}
+
+/* Returns the content of a RTM_NEWLINK message without the statistics. */
+static GBytes *
+_link_attrs_new (struct nlmsghdr *nlh)
+{
+	LinkAttrsWalk w = { 0 };
+	struct nlattr *nl_stats64;
+
+	w.buf = g_byte_array_sized_new (nlh->nlmsg_len);
+	_link_attrs_walk (nlh, &w, &nl_stats64);
+	return g_byte_array_free_to_bytes (w.buf);
+}
+
+/* Whether the RTM_NEWLINK message is identical to @attrs, besides the
+ * statistics. Then it carries no news and doesn't need to be parsed. */
+static gboolean
+_link_attrs_equal (struct nlmsghdr *nlh, GBytes *attrs, struct nlattr **out_stats64)
+{
+	LinkAttrsWalk w = { 0 };
+
+	w.cmp_data = g_bytes_get_data (attrs, &w.cmp_len);
+	_link_attrs_walk (nlh, &w, out_stats64);
+	return    !w.differs
+	       && w.offset == w.cmp_len;
+}
+
+static void
+_parse_link_stats64 (NMPObject *obj, struct nlattr *attr)
+{
+	/* attr is only guaranteed to be 32bit-aligned, so in general we can't
+	 * access the rtnl_link_stats64 struct members directly on 64bit
+	 * architectures. */
+	char *stats = nla_data (attr);
+
+#define READ_STAT64(member) \
+	unaligned_read_ne64 (stats + offsetof (struct rtnl_link_stats64, member))
+
+	obj->link.rx_packets = READ_STAT64 (rx_packets);
+	obj->link.rx_bytes   = READ_STAT64 (rx_bytes);
+	obj->link.tx_packets = READ_STAT64 (tx_packets);
+	obj->link.tx_bytes   = READ_STAT64 (tx_bytes);
+
+#undef READ_STAT64
+}
+
 /* Copied and heavily modified from libnl3's link_msg_parser(). */
 static NMPObject *
 _new_from_nl_link (NMPlatform *platform, const NMPCache *cache, struct nlmsghdr *nlh, gboolean id_only)
@@ -1497,6 +1631,7 @@ _new_from_nl_link (NMPlatform *platform, const NMPCache *cache, struct nlmsghdr
 	struct nlattr *tb[IFLA_MAX+1];
 	struct nlattr *li[IFLA_INFO_MAX+1];
 	struct nlattr *nl_info_data = NULL;
+	struct nlattr *nl_stats64;
 	const char *nl_info_kind = NULL;
 	int err;
 	nm_auto_nmpobj NMPObject *obj = NULL;
@@ -1505,6 +1640,7 @@ _new_from_nl_link (NMPlatform *platform, const NMPCache *cache, struct nlmsghdr
 	gboolean *completed_from_cache = cache ? &completed_from_cache_val : NULL;
 	const NMPObject *link_cached = NULL;
 	NMPObject *lnk_data = NULL;
+	GBytes *lnk_info_data = NULL;
 	gboolean address_complete_from_cache = TRUE;
 	gboolean lnk_data_complete_from_cache = TRUE;
 	gboolean af_inet6_token_valid = FALSE;
@@ -1519,6 +1655,33 @@ _new_from_nl_link (NMPlatform *platform, const NMPCache *cache, struct nlmsghdr
 	if (id_only)
 		goto id_only_handled;
 
+	if (   completed_from_cache
+	    && _lookup_cached_link (cache, obj->link.ifindex, completed_from_cache, &link_cached)
+	    && link_cached->_link.netlink.attrs
+	    && _link_attrs_equal (nlh, link_cached->_link.netlink.attrs, &nl_stats64)
+	    && (   !nl_stats64
+	        || nla_len (nl_stats64) >= nm_offsetofend (struct rtnl_link_stats64, tx_compressed))) {
+		/* Nothing but the statistics changed. Parsing the message would
+		 * give the cached object again, so start from that. Like for a parsed
+		 * object, the fields that come from udev are left unset and merged
+		 * by nmp_cache_update_netlink(). */
+		nmp_object_unref (obj);
+		obj = nmp_object_clone (link_cached, FALSE);
+		if (obj->_link.udev.device) {
+			udev_device_unref (obj->_link.udev.device);
+			obj->_link.udev.device = NULL;
+		}
+		obj->_link.udev.deferred = FALSE;
+		obj->link.driver = NULL;
+		obj->link.initialized = FALSE;
+		obj->link.connected = NM_FLAGS_HAS (obj->link.n_ifi_flags, IFF_LOWER_UP);
+		if (nl_stats64)
+			_parse_link_stats64 (obj, nl_stats64);
+		_stats_count_link_parse (platform, TRUE);
+		goto parse_skipped;
+	}
+	_stats_count_link_parse (platform, FALSE);
+
 	err = nlmsg_parse (nlh, sizeof (*ifi), tb, IFLA_MAX, policy);
 	if (err < 0)
 		goto errout;
@@ -1540,20 +1703,8 @@ _new_from_nl_link (NMPlatform *platform, const NMPCache *cache, struct nlmsghdr
 		nl_info_data = li[IFLA_INFO_DATA];
 	}
 
-	if (tb[IFLA_STATS64]) {
-		/* tb[IFLA_STATS64] is only guaranteed to be 32bit-aligned,
-		 * so in general we can't access the rtnl_link_stats64 struct
-		 * members directly on 64bit architectures. */
-		char *stats = nla_data (tb[IFLA_STATS64]);
-
-#define READ_STAT64(member) \
-	unaligned_read_ne64 (stats + offsetof (struct rtnl_link_stats64, member))
-
-		obj->link.rx_packets = READ_STAT64 (rx_packets);
-		obj->link.rx_bytes   = READ_STAT64 (rx_bytes);
-		obj->link.tx_packets = READ_STAT64 (tx_packets);
-		obj->link.tx_bytes   = READ_STAT64 (tx_bytes);
-	}
+	if (tb[IFLA_STATS64])
+		_parse_link_stats64 (obj, tb[IFLA_STATS64]);
 
 	obj->link.n_ifi_flags = ifi->ifi_flags;
 	obj->link.connected = NM_FLAGS_HAS (obj->link.n_ifi_flags, IFF_LOWER_UP);
@@ -1612,6 +1763,24 @@ _new_from_nl_link (NMPlatform *platform, const NMPCache *cache, struct nlmsghdr
 	if (tb[IFLA_MTU])
 		obj->link.mtu = nla_get_u32 (tb[IFLA_MTU]);
 
+	if (   nl_info_data
+	    && completed_from_cache
+	    && _lookup_cached_link (cache, obj->link.ifindex, completed_from_cache, &link_cached)
+	    && link_cached->link.type == obj->link.type
+	    && link_cached->_link.netlink.lnk
+	    && link_cached->_link.netlink.lnk_info_data
+	    && g_bytes_get_size (link_cached->_link.netlink.lnk_info_data) == nla_len (nl_info_data)
+	    && memcmp (g_bytes_get_data (link_cached->_link.netlink.lnk_info_data, NULL),
+	               nla_data (nl_info_data),
+	               nla_len (nl_info_data)) == 0) {
+		/* Most RTM_NEWLINK messages are about statistics or flags. If the
+		 * info-data is byte-for-byte what we parsed before, don't parse it
+		 * again but share the lnk object of the cache. */
+		lnk_data = nmp_object_ref (link_cached->_link.netlink.lnk);
+		lnk_info_data = g_bytes_ref (link_cached->_link.netlink.lnk_info_data);
+		goto lnk_data_handled;
+	}
+
 	switch (obj->link.type) {
 	case NM_LINK_TYPE_GRE:
 		lnk_data = _parse_lnk_gre (nl_info_kind, nl_info_data);
@@ -1646,6 +1815,10 @@ _new_from_nl_link (NMPlatform *platform, const NMPCache *cache, struct nlmsghdr
 		break;
 	}
 
+	if (lnk_data && nl_info_data)
+		lnk_info_data = g_bytes_new (nla_data (nl_info_data), nla_len (nl_info_data));
+
+lnk_data_handled:
 	if (   completed_from_cache
 	    && (   lnk_data_complete_from_cache
 	        || address_complete_from_cache
@@ -1667,6 +1840,8 @@ _new_from_nl_link (NMPlatform *platform, const NMPCache *cache, struct nlmsghdr
 				 * we want to keep the previously received lnk_data. */
 				nmp_object_unref (lnk_data);
 				lnk_data = nmp_object_ref (link_cached->_link.netlink.lnk);
+				if (!lnk_info_data && link_cached->_link.netlink.lnk_info_data)
+					lnk_info_data = g_bytes_ref (link_cached->_link.netlink.lnk_info_data);
 			}
 			if (address_complete_from_cache)
 				obj->link.addr = link_cached->link.addr;
@@ -1684,8 +1859,12 @@ _new_from_nl_link (NMPlatform *platform, const NMPCache *cache, struct nlmsghdr
 	}
 
 	obj->_link.netlink.lnk = lnk_data;
+	obj->_link.netlink.lnk_info_data = lnk_info_data;
+	if (completed_from_cache)
+		obj->_link.netlink.attrs = _link_attrs_new (nlh);
 
 	obj->_link.netlink.is_in_netlink = TRUE;
+parse_skipped:
 id_only_handled:
 	obj_result = obj;
 	obj = NULL;
@@ -1808,6 +1987,40 @@ errout:
 	return obj_result;
 }
 
+/* A cheap check on the fixed header of a route message, whether
+ * _new_from_nl_route() would reject the route anyway. Dumps contain
+ * many such routes (for example of the local table), and this saves
+ * copying and parsing them. */
+static gboolean
+_nlmsghdr_is_ignored_route (const struct nlmsghdr *nlh, const guint32 *ignored_rtprots)
+{
+	const struct rtmsg *rtm;
+
+	if (!NM_IN_SET (nlh->nlmsg_type, RTM_NEWROUTE, RTM_DELROUTE))
+		return FALSE;
+	if (!nlmsg_valid_hdr (nlh, sizeof (*rtm)))
+		return FALSE;
+
+	rtm = nlmsg_data (nlh);
+
+	if (!NM_IN_SET (rtm->rtm_family, AF_INET, AF_INET6))
+		return TRUE;
+	if (rtm->rtm_type != RTN_UNICAST)
+		return TRUE;
+
+	/* kernel sets rtm_table to RT_TABLE_COMPAT for table ids that don't fit,
+	 * and only the RTA_TABLE attribute tells the real one. */
+	if (!NM_IN_SET (rtm->rtm_table, RT_TABLE_UNSPEC, RT_TABLE_MAIN, RT_TABLE_COMPAT))
+		return TRUE;
+
+	/* routes of other daemons, like a BGP daemon with a full table,
+	 * can be excluded by their protocol. */
+	if (   ignored_rtprots
+	    && (ignored_rtprots[rtm->rtm_protocol / 32] & (1u << (rtm->rtm_protocol % 32))))
+		return TRUE;
+	return FALSE;
+}
+
 /* Copied and heavily modified from libnl3's rtnl_route_parse() and parse_multipath(). */
 static NMPObject *
 _new_from_nl_route (struct nlmsghdr *nlh, gboolean id_only)
@@ -2080,6 +2293,40 @@ nmp_object_new_from_nl (NMPlatform *platform, const NMPCache *cache, struct nl_m
 	}
 }
 
+/**
+ * nm_linux_platform_object_new_from_nlmsg:
+ * @cache: (allow-none): the cache to complete the object from.
+ * @nlh: a NETLINK_ROUTE message
+ * @id_only: whether only to create an empty object with only the ID fields set.
+ *
+ * Parses @nlh like a received netlink event, but without a platform
+ * instance. This allows tools to replay recorded netlink traffic.
+ *
+ * Returns: %NULL or a newly created NMPObject instance.
+ **/
+NMPObject *
+nm_linux_platform_object_new_from_nlmsg (const NMPCache *cache,
+                                         struct nlmsghdr *nlh,
+                                         gboolean id_only)
+{
+	struct nl_msg *msg;
+	NMPObject *obj;
+
+	g_return_val_if_fail (nlh, NULL);
+
+	if (_nlmsghdr_is_ignored_route (nlh, NULL))
+		return NULL;
+
+	msg = nlmsg_convert (nlh);
+	if (!msg)
+		return NULL;
+	nlmsg_set_proto (msg, NETLINK_ROUTE);
+
+	obj = nmp_object_new_from_nl (NULL, cache, msg, id_only);
+	nlmsg_free (msg);
+	return obj;
+}
+
 /*****************************************************************************/
 
 static gboolean
@@ -2526,9 +2773,19 @@ _support_kernel_extended_ifa_flags_get (void)
  * NMPlatform types and functions
  ******************************************************************/
 
+static const guint16 _stats_nlmsg_types[] = {
+	RTM_NEWLINK,
+	RTM_DELLINK,
+	RTM_NEWADDR,
+	RTM_DELADDR,
+	RTM_NEWROUTE,
+	RTM_DELROUTE,
+};
+
 typedef struct {
 	guint32 seq_number;
 	WaitForNlResponseResult seq_result;
+	gint64 start_ns;
 	gint64 timeout_abs_ns;
 	WaitForNlResponseResult *out_seq_result;
 	gint *out_refresh_all_in_progess;
@@ -2537,6 +2794,15 @@ typedef struct {
 typedef struct {
 	struct nl_sock *nlh;
 	guint32 nlh_seq_next;
+
+	/* the requested size of the receive buffer of @nlh. It grows when
+	 * we lose netlink messages. */
+	int nlh_rcvbuf_size;
+
+	/* the number of times the cache had to be resynchronized, because
+	 * netlink messages were lost. */
+	guint nlh_resync_count;
+	gint64 nlh_resync_last_ns;
 #ifdef NM_MORE_LOGGING
 	guint32 nlh_seq_last_handled;
 #endif
@@ -2548,8 +2814,48 @@ typedef struct {
 	gboolean sysctl_get_warned;
 	GHashTable *sysctl_get_prev_values;
 
+	/* per-ifindex cache of the ipv4/ipv6 "conf" sysctl values we wrote
+	 * or read, to skip writes that don't change anything. It is cleared
+	 * for a link on each change of the link. A value changed by another
+	 * program is not noticed before that. */
+	GHashTable *sysctl_cache;
+	/* the entries of @sysctl_cache with open directory fds, least recently
+	 * used first. See SYSCTL_DIRFD_CACHE_MAX. */
+	GQueue sysctl_dirfd_lru;
+	guint sysctl_cache_hits;
+	guint sysctl_cache_misses;
+
+	/* per-ifindex cache of the ethtool facts that don't change during
+	 * the lifetime of a link, see _ethtool_cache_get(). */
+	GHashTable *ethtool_cache;
+	guint ethtool_cache_hits;
+	guint ethtool_cache_misses;
+
+	/* counters, as reported by nm_platform_statistics_foreach(). */
+	struct {
+		/* indexed like _stats_nlmsg_types, the last entry counts the
+		 * other message types. */
+		guint64 nlmsg_rx[G_N_ELEMENTS (_stats_nlmsg_types) + 1];
+		guint64 cache_ops[NMP_OBJECT_TYPE_MAX + 1][3];
+		guint64 refresh_all[NMP_OBJECT_TYPE_MAX + 1];
+		guint64 enobufs;
+		guint64 sysctl_reads;
+		guint64 sysctl_writes;
+		guint64 ack_wait_count;
+		gint64 ack_wait_total_ns;
+		gint64 ack_wait_max_ns;
+		guint64 event_wakeups;
+		guint64 event_batch_max;
+		guint64 link_parsed;
+		guint64 link_parse_skipped;
+	} stats;
+
 	NMUdevClient *udev_client;
 
+	/* the last device looked up for a link whose udev data is deferred.
+	 * See _link_get_udev_device(). */
+	struct udev_device *udev_device_ondemand;
+
 	struct {
 		/* which delayed actions are scheduled, as marked in @flags.
 		 * Some types have additional arguments in the fields below. */
@@ -2559,6 +2865,10 @@ typedef struct {
 		 * by type. */
 		gint refresh_all_in_progess[_DELAYED_ACTION_IDX_REFRESH_ALL_NUM];
 
+		/* the refresh-all actions that were handled during the current
+		 * delayed_action_handle_all() run. */
+		DelayedActionType refresh_all_handled;
+
 		GPtrArray *list_master_connected;
 		GPtrArray *list_refresh_link;
 		GArray *list_wait_for_nl_response;
@@ -2566,9 +2876,28 @@ typedef struct {
 		gint is_handling;
 	} delayed_action;
 
+	struct {
+		/* the refresh-all types of the netlink events that were received
+		 * since the socket was drained the last time. */
+		DelayedActionType seen;
+
+		/* after an overrun, the refresh-all types that were not seen
+		 * are only resynchronized later, on idle. */
+		DelayedActionType deferred;
+		guint deferred_id;
+	} resync;
+
 	GHashTable *prune_candidates;
 
 	GHashTable *wifi_data;
+
+	/* if set, only objects of these ifindexes are cached. */
+	GHashTable *ifindex_filter;
+
+	/* a bitmap of rtm_protocol values. Routes with these protocols
+	 * are dropped before parsing and never enter the cache. */
+	guint32 ignored_rtprots[256 / 32];
+	bool has_ignored_rtprots:1;
 } NMLinuxPlatformPrivate;
 
 struct _NMLinuxPlatform {
@@ -2584,6 +2913,11 @@ G_DEFINE_TYPE (NMLinuxPlatform, nm_linux_platform, NM_TYPE_PLATFORM)
 
 #define NM_LINUX_PLATFORM_GET_PRIVATE(self) _NM_GET_PRIVATE_VOID(self, NMLinuxPlatform, NM_IS_LINUX_PLATFORM)
 
+NM_GOBJECT_PROPERTIES_DEFINE_BASE (
+	PROP_IFINDEXES,
+	PROP_IGNORED_ROUTE_PROTOCOLS,
+);
+
 NMPlatform *
 nm_linux_platform_new (gboolean netns_support)
 {
@@ -2595,13 +2929,173 @@ nm_linux_platform_new (gboolean netns_support)
 
 void
 nm_linux_platform_setup (void)
+{
+	nm_linux_platform_setup_filtered (NULL);
+}
+
+/**
+ * nm_linux_platform_setup_filtered:
+ * @ifindexes: (allow-none): a list of interface indexes, terminated
+ *   by zero.
+ *
+ * Like nm_linux_platform_setup(), but the platform cache only tracks
+ * the links, addresses and routes of the interfaces in @ifindexes.
+ * Everything else that the kernel notifies about is ignored. That is
+ * for processes that only care about a few interfaces, like nm-iface-helper.
+ */
+void
+nm_linux_platform_setup_filtered (const int *ifindexes)
+{
+	nm_linux_platform_setup_full (ifindexes, NULL);
+}
+
+/**
+ * nm_linux_platform_setup_full:
+ * @ifindexes: (allow-none): see nm_linux_platform_setup_filtered().
+ * @ignored_route_protocols: (allow-none): a list of route protocols,
+ *   separated by commas or spaces, given by name or number.
+ *
+ * Sets up the platform singleton. Routes with one of the protocols
+ * in @ignored_route_protocols are dropped as soon as they are received
+ * from kernel. They never enter the platform cache, so NetworkManager
+ * neither sees nor touches them. The protocols that NetworkManager uses
+ * for its own routes cannot be ignored.
+ */
+void
+nm_linux_platform_setup_full (const int *ifindexes,
+                              const char *ignored_route_protocols)
 {
 	g_object_new (NM_TYPE_LINUX_PLATFORM,
 	              NM_PLATFORM_REGISTER_SINGLETON, TRUE,
 	              NM_PLATFORM_NETNS_SUPPORT, FALSE,
+	              NM_LINUX_PLATFORM_IFINDEXES, ifindexes,
+	              NM_LINUX_PLATFORM_IGNORED_ROUTE_PROTOCOLS, ignored_route_protocols,
 	              NULL);
 }
 
+static gboolean
+_ifindex_filter_accept (NMPlatform *platform, int ifindex)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	return    !priv->ifindex_filter
+	       || g_hash_table_contains (priv->ifindex_filter, GINT_TO_POINTER (ifindex));
+}
+
+/*****************************************************************************/
+
+static void
+_stats_count_nlmsg (NMLinuxPlatformPrivate *priv, guint16 nlmsg_type)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (_stats_nlmsg_types); i++) {
+		if (_stats_nlmsg_types[i] == nlmsg_type)
+			break;
+	}
+	priv->stats.nlmsg_rx[i]++;
+}
+
+static void
+_stats_count_link_parse (NMPlatform *platform, gboolean skipped)
+{
+	NMLinuxPlatformPrivate *priv;
+
+	/* links parsed outside of a platform instance are not counted. */
+	if (!platform)
+		return;
+
+	priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	if (skipped)
+		priv->stats.link_parse_skipped++;
+	else
+		priv->stats.link_parsed++;
+}
+
+static guint64
+_stats_nlmsg_rx_total (NMLinuxPlatformPrivate *priv)
+{
+	guint64 total = 0;
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (priv->stats.nlmsg_rx); i++)
+		total += priv->stats.nlmsg_rx[i];
+	return total;
+}
+
+static void
+statistics_foreach (NMPlatform *platform, NMPlatformStatisticsFunc func, gpointer user_data)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	static const char *const cache_ops_names[] = { "added", "updated", "removed" };
+	char buf[64];
+	char buf_nlmsg_type[16];
+	NMPObjectType obj_type;
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (priv->stats.nlmsg_rx); i++) {
+		nm_sprintf_buf (buf, "netlink.rx.%s",
+		                i < G_N_ELEMENTS (_stats_nlmsg_types)
+		                ? _nl_nlmsg_type_to_str (_stats_nlmsg_types[i], buf_nlmsg_type, sizeof (buf_nlmsg_type))
+		                : "other");
+		func (buf, priv->stats.nlmsg_rx[i], user_data);
+	}
+	func ("netlink.enobufs", priv->stats.enobufs, user_data);
+	func ("netlink.resync", priv->nlh_resync_count, user_data);
+	func ("netlink.ack-wait.count", priv->stats.ack_wait_count, user_data);
+	func ("netlink.ack-wait.total-usec", priv->stats.ack_wait_total_ns / 1000, user_data);
+	func ("netlink.ack-wait.max-usec", priv->stats.ack_wait_max_ns / 1000, user_data);
+	func ("netlink.event.wakeups", priv->stats.event_wakeups, user_data);
+	func ("netlink.event.batch-max", priv->stats.event_batch_max, user_data);
+	func ("cache.link.parsed", priv->stats.link_parsed, user_data);
+	func ("cache.link.parse-skipped", priv->stats.link_parse_skipped, user_data);
+
+	for (obj_type = 1; obj_type <= NMP_OBJECT_TYPE_MAX; obj_type++) {
+		const NMPClass *klass = nmp_class_from_type (obj_type);
+
+		if (!klass->rtm_gettype)
+			continue;
+		nm_sprintf_buf (buf, "cache.%s.refresh-all", klass->obj_type_name);
+		func (buf, priv->stats.refresh_all[obj_type], user_data);
+	}
+
+	for (obj_type = 1; obj_type <= NMP_OBJECT_TYPE_MAX; obj_type++) {
+		const NMPClass *klass = nmp_class_from_type (obj_type);
+
+		for (i = 0; i < G_N_ELEMENTS (cache_ops_names); i++) {
+			nm_sprintf_buf (buf, "cache.%s.%s", klass->obj_type_name, cache_ops_names[i]);
+			func (buf, priv->stats.cache_ops[obj_type][i], user_data);
+		}
+	}
+
+	func ("sysctl.read", priv->stats.sysctl_reads, user_data);
+	func ("sysctl.write", priv->stats.sysctl_writes, user_data);
+	func ("sysctl.write-cache-hit", priv->sysctl_cache_hits, user_data);
+	func ("sysctl.write-cache-miss", priv->sysctl_cache_misses, user_data);
+	func ("ethtool.cached", priv->ethtool_cache_hits, user_data);
+	func ("ethtool.queried", priv->ethtool_cache_misses, user_data);
+}
+
+static void
+memory_usage_foreach (NMPlatform *platform, NMMemoryUsageFunc func, gpointer user_data)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	char buf[64];
+	NMPObjectType obj_type;
+
+	for (obj_type = 1; obj_type <= NMP_OBJECT_TYPE_MAX; obj_type++) {
+		const NMPClass *klass = nmp_class_from_type (obj_type);
+		NMPCacheId cache_id;
+		guint len;
+
+		nmp_cache_lookup_multi (priv->cache,
+		                        nmp_cache_id_init_object_type (&cache_id, obj_type, FALSE),
+		                        &len);
+		nm_sprintf_buf (buf, "platform.cache.%s", klass->obj_type_name);
+		func (buf, len, (guint64) len * sizeof (NMPObject), user_data);
+	}
+}
+
 static void
 ASSERT_NETNS_CURRENT (NMPlatform *platform)
 {
@@ -2623,7 +3117,8 @@ ASSERT_NETNS_CURRENT (NMPlatform *platform)
 			nm_assert (!_pathid); \
 			nm_assert (_path[0] == '/'); \
 			nm_assert (   g_str_has_prefix (_path, "/proc/sys/") \
-			           || g_str_has_prefix (_path, "/sys/")); \
+			           || g_str_has_prefix (_path, "/sys/") \
+			           || g_str_has_prefix (_path, "/proc/irq/")); \
 		} else { \
 			nm_assert (_pathid && _pathid[0] && _pathid[0] != '/'); \
 			nm_assert (_path[0] != '/'); \
@@ -2661,71 +3156,382 @@ _log_dbg_sysctl_set_impl (NMPlatform *platform, const char *pathid, int dirfd, c
 		} \
 	} G_STMT_END
 
-static gboolean
-sysctl_set (NMPlatform *platform, const char *pathid, int dirfd, const char *path, const char *value)
-{
-	nm_auto_pop_netns NMPNetns *netns = NULL;
-	int fd, tries;
-	gssize nwrote;
-	gsize len;
-	char *actual;
-	gs_free char *actual_free = NULL;
-	int errsv;
+/*****************************************************************************/
 
-	g_return_val_if_fail (path != NULL, FALSE);
-	g_return_val_if_fail (value != NULL, FALSE);
+/* the number of links for which the directory fds are kept open. There
+ * can be thousands of links, but writes come in bursts for a few of them. */
+#define SYSCTL_DIRFD_CACHE_MAX 16
 
-	ASSERT_SYSCTL_ARGS (pathid, dirfd, path);
+typedef struct {
+	int ifindex;
+	char ifname[IFNAMSIZ];
 
-	if (dirfd < 0) {
-		if (!nm_platform_netns_push (platform, &netns)) {
-			errno = ENETDOWN;
-			return FALSE;
-		}
+	/* directory fds for /proc/sys/net/ipv{4,6}/conf/<ifname>. */
+	int dirfd[2];
 
-		pathid = path;
+	/* linked in sysctl_dirfd_lru while a directory fd is open. */
+	GList lru_link;
+	GQueue *lru;
 
-		fd = open (path, O_WRONLY | O_TRUNC | O_CLOEXEC);
-		if (fd == -1) {
-			errsv = errno;
-			if (errsv == ENOENT) {
-				_LOGD ("sysctl: failed to open '%s': (%d) %s",
-				       pathid, errsv, strerror (errsv));
-			} else {
-				_LOGE ("sysctl: failed to open '%s': (%d) %s",
-				       pathid, errsv, strerror (errsv));
-			}
-			errno = errsv;
-			return FALSE;
-		}
-	} else {
-		fd = openat (dirfd, path, O_WRONLY | O_TRUNC | O_CLOEXEC);
-		if (fd == -1) {
-			errsv = errno;
-			if (errsv == ENOENT) {
-				_LOGD ("sysctl: failed to openat '%s': (%d) %s",
-				       pathid, errsv, strerror (errsv));
-			} else {
-				_LOGE ("sysctl: failed to openat '%s': (%d) %s",
-				       pathid, errsv, strerror (errsv));
-			}
-			errno = errsv;
-			return FALSE;
+	/* "ipv4/<name>" and "ipv6/<name>" to the last known value. */
+	GHashTable *values;
+} SysctlIfaceCache;
+
+static void
+_sysctl_iface_cache_close (SysctlIfaceCache *c)
+{
+	guint i;
+
+	if (c->lru_link.data) {
+		g_queue_unlink (c->lru, &c->lru_link);
+		c->lru_link.data = NULL;
+	}
+
+	for (i = 0; i < G_N_ELEMENTS (c->dirfd); i++) {
+		if (c->dirfd[i] >= 0) {
+			close (c->dirfd[i]);
+			c->dirfd[i] = -1;
 		}
 	}
+}
 
-	_log_dbg_sysctl_set (platform, pathid, dirfd, path, value);
+static void
+_sysctl_iface_cache_free (gpointer data)
+{
+	SysctlIfaceCache *c = data;
 
-	/* Most sysfs and sysctl options don't care about a trailing LF, while some
-	 * (like infiniband) do.  So always add the LF.  Also, neither sysfs nor
-	 * sysctl support partial writes so the LF must be added to the string we're
-	 * about to write.
-	 */
-	len = strlen (value) + 1;
-	if (len > 512)
-		actual = actual_free = g_malloc (len + 1);
-	else
-		actual = g_alloca (len + 1);
+	_sysctl_iface_cache_close (c);
+	g_hash_table_unref (c->values);
+	g_slice_free (SysctlIfaceCache, c);
+}
+
+/* Parses "/proc/sys/net/ipv{4,6}/conf/<ifname>/<name>". */
+static gboolean
+_sysctl_parse_conf_path (const char *path,
+                         guint *out_family_idx,
+                         char *out_ifname,
+                         const char **out_name)
+{
+	const char *s;
+	const char *slash;
+	guint family_idx;
+
+	if (g_str_has_prefix (path, "/proc/sys/net/ipv4/conf/"))
+		family_idx = 0;
+	else if (g_str_has_prefix (path, "/proc/sys/net/ipv6/conf/"))
+		family_idx = 1;
+	else
+		return FALSE;
+
+	s = &path[NM_STRLEN ("/proc/sys/net/ipv4/conf/")];
+	slash = strchr (s, '/');
+	if (   !slash
+	    || slash == s
+	    || slash - s >= IFNAMSIZ
+	    || !slash[1]
+	    || strchr (&slash[1], '/'))
+		return FALSE;
+
+	memcpy (out_ifname, s, slash - s);
+	out_ifname[slash - s] = '\0';
+	if (NM_IN_STRSET (out_ifname, "all", "default"))
+		return FALSE;
+
+	*out_family_idx = family_idx;
+	*out_name = &slash[1];
+	return TRUE;
+}
+
+/* Returns the cache entry for the link named in @path, or %NULL if @path
+ * is not a per-interface conf sysctl of a link we know. */
+static SysctlIfaceCache *
+_sysctl_cache_lookup (NMPlatform *platform,
+                      const char *path,
+                      guint *out_family_idx,
+                      const char **out_name)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	char ifname[IFNAMSIZ];
+	const NMPObject *obj;
+	SysctlIfaceCache *c;
+
+	if (!_sysctl_parse_conf_path (path, out_family_idx, ifname, out_name))
+		return NULL;
+
+	obj = nmp_cache_lookup_link_full (priv->cache, 0, ifname, TRUE, NM_LINK_TYPE_NONE, NULL, NULL);
+	if (!obj)
+		return NULL;
+
+	if (!priv->sysctl_cache)
+		priv->sysctl_cache = g_hash_table_new_full (NULL, NULL, NULL, _sysctl_iface_cache_free);
+
+	c = g_hash_table_lookup (priv->sysctl_cache, GINT_TO_POINTER (obj->link.ifindex));
+	if (!c) {
+		c = g_slice_new0 (SysctlIfaceCache);
+		c->ifindex = obj->link.ifindex;
+		c->dirfd[0] = -1;
+		c->dirfd[1] = -1;
+		c->lru = &priv->sysctl_dirfd_lru;
+		c->values = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+		g_strlcpy (c->ifname, ifname, sizeof (c->ifname));
+		g_hash_table_insert (priv->sysctl_cache, GINT_TO_POINTER (c->ifindex), c);
+	} else if (!nm_streq (c->ifname, ifname)) {
+		/* renamed. The directory fds point to the old name. */
+		_sysctl_iface_cache_close (c);
+		g_hash_table_remove_all (c->values);
+		g_strlcpy (c->ifname, ifname, sizeof (c->ifname));
+	}
+	return c;
+}
+
+static int
+_sysctl_cache_get_dirfd (SysctlIfaceCache *c, guint family_idx)
+{
+	if (c->lru_link.data) {
+		g_queue_unlink (c->lru, &c->lru_link);
+		c->lru_link.data = NULL;
+	}
+
+	if (c->dirfd[family_idx] < 0) {
+		char path[100];
+
+		nm_sprintf_buf (path, "/proc/sys/net/ipv%c/conf/%s", family_idx ? '6' : '4', c->ifname);
+		c->dirfd[family_idx] = open (path, O_DIRECTORY | O_RDONLY | O_CLOEXEC);
+	}
+
+	if (   c->dirfd[0] >= 0
+	    || c->dirfd[1] >= 0) {
+		if (c->lru->length >= SYSCTL_DIRFD_CACHE_MAX)
+			_sysctl_iface_cache_close (c->lru->head->data);
+		c->lru_link.data = c;
+		g_queue_push_tail_link (c->lru, &c->lru_link);
+	}
+	return c->dirfd[family_idx];
+}
+
+static void
+_sysctl_cache_update (SysctlIfaceCache *c, guint family_idx, const char *name, const char *value)
+{
+	if (value) {
+		g_hash_table_insert (c->values,
+		                     g_strdup_printf ("ipv%c/%s", family_idx ? '6' : '4', name),
+		                     g_strdup (value));
+	} else {
+		char key[100];
+
+		nm_sprintf_buf (key, "ipv%c/%s", family_idx ? '6' : '4', name);
+		g_hash_table_remove (c->values, key);
+	}
+}
+
+static const char *
+_sysctl_cache_get_value (SysctlIfaceCache *c, guint family_idx, const char *name)
+{
+	char key[100];
+
+	nm_sprintf_buf (key, "ipv%c/%s", family_idx ? '6' : '4', name);
+	return g_hash_table_lookup (c->values, key);
+}
+
+static void
+_sysctl_cache_invalidate (NMPlatform *platform, int ifindex, gboolean remove)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	SysctlIfaceCache *c;
+
+	if (!priv->sysctl_cache)
+		return;
+
+	if (remove)
+		g_hash_table_remove (priv->sysctl_cache, GINT_TO_POINTER (ifindex));
+	else {
+		c = g_hash_table_lookup (priv->sysctl_cache, GINT_TO_POINTER (ifindex));
+		if (c)
+			g_hash_table_remove_all (c->values);
+	}
+}
+
+/*****************************************************************************/
+
+typedef enum {
+	ETHTOOL_CACHE_DRIVER_INFO     = (1LL << 0),
+	ETHTOOL_CACHE_PERM_ADDRESS    = (1LL << 1),
+	ETHTOOL_CACHE_CARRIER_DETECT  = (1LL << 2),
+	ETHTOOL_CACHE_VLANS           = (1LL << 3),
+} EthtoolCacheFlags;
+
+typedef struct {
+	char ifname[IFNAMSIZ];
+
+	/* the facts that were queried, and among them, the ones that
+	 * were successful or supported. */
+	EthtoolCacheFlags known;
+	EthtoolCacheFlags valid;
+
+	NMPUtilsEthtoolDriverInfo driver_info;
+	guint8 perm_address[NM_UTILS_HWADDR_LEN_MAX];
+	size_t perm_address_len;
+} EthtoolIfaceCache;
+
+/* Returns the cache entry for the visible link @ifindex, or %NULL if there
+ * is no such link. The entries are dropped when the link goes away and
+ * reset when it is renamed, so that a new link that reuses the ifindex, or
+ * a different netdev that now has the name, is queried again. */
+static EthtoolIfaceCache *
+_ethtool_cache_get (NMPlatform *platform, int ifindex)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	const NMPObject *obj;
+	EthtoolIfaceCache *c;
+
+	obj = nmp_cache_lookup_link (priv->cache, ifindex);
+	if (!nmp_object_is_visible (obj))
+		return NULL;
+
+	if (!priv->ethtool_cache)
+		priv->ethtool_cache = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+	c = g_hash_table_lookup (priv->ethtool_cache, GINT_TO_POINTER (ifindex));
+	if (!c) {
+		c = g_new0 (EthtoolIfaceCache, 1);
+		g_hash_table_insert (priv->ethtool_cache, GINT_TO_POINTER (ifindex), c);
+	} else if (!nm_streq (c->ifname, obj->link.name))
+		c->known = 0;
+
+	if (!c->known)
+		g_strlcpy (c->ifname, obj->link.name, sizeof (c->ifname));
+	return c;
+}
+
+/* Returns whether @flag is already known for @c, and counts the hit or miss.
+ * On a miss, the caller queries the kernel and calls _ethtool_cache_set(). */
+static gboolean
+_ethtool_cache_has (NMPlatform *platform, EthtoolIfaceCache *c, EthtoolCacheFlags flag)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	if (c && NM_FLAGS_HAS (c->known, flag)) {
+		priv->ethtool_cache_hits++;
+		return TRUE;
+	}
+	priv->ethtool_cache_misses++;
+	return FALSE;
+}
+
+static gboolean
+_ethtool_cache_set (EthtoolIfaceCache *c, EthtoolCacheFlags flag, gboolean valid)
+{
+	if (c) {
+		c->known |= flag;
+		if (valid)
+			c->valid |= flag;
+		else
+			c->valid &= ~flag;
+	}
+	return valid;
+}
+
+static void
+_ethtool_cache_invalidate (NMPlatform *platform, int ifindex)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	if (priv->ethtool_cache)
+		g_hash_table_remove (priv->ethtool_cache, GINT_TO_POINTER (ifindex));
+}
+
+/*****************************************************************************/
+
+static gboolean
+sysctl_set (NMPlatform *platform, const char *pathid, int dirfd, const char *path, const char *value)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	nm_auto_pop_netns NMPNetns *netns = NULL;
+	int fd, tries;
+	gssize nwrote;
+	gsize len;
+	char *actual;
+	gs_free char *actual_free = NULL;
+	int errsv;
+	SysctlIfaceCache *cache = NULL;
+	guint cache_family_idx = 0;
+	const char *cache_name = NULL;
+
+	g_return_val_if_fail (path != NULL, FALSE);
+	g_return_val_if_fail (value != NULL, FALSE);
+
+	ASSERT_SYSCTL_ARGS (pathid, dirfd, path);
+
+	if (dirfd < 0) {
+		if (!nm_platform_netns_push (platform, &netns)) {
+			errno = ENETDOWN;
+			return FALSE;
+		}
+
+		pathid = path;
+
+		cache = _sysctl_cache_lookup (platform, path, &cache_family_idx, &cache_name);
+		if (cache) {
+			if (nm_streq0 (_sysctl_cache_get_value (cache, cache_family_idx, cache_name), value)) {
+				priv->sysctl_cache_hits++;
+				_LOGD ("sysctl: setting '%s' to '%s' skipped (cached value is identical, %u hits, %u misses)",
+				       pathid, value, priv->sysctl_cache_hits, priv->sysctl_cache_misses);
+				return TRUE;
+			}
+			priv->sysctl_cache_misses++;
+
+			dirfd = _sysctl_cache_get_dirfd (cache, cache_family_idx);
+			if (dirfd >= 0)
+				path = cache_name;
+		}
+	}
+
+	priv->stats.sysctl_writes++;
+
+	if (dirfd < 0) {
+		fd = open (path, O_WRONLY | O_TRUNC | O_CLOEXEC);
+		if (fd == -1) {
+			errsv = errno;
+			if (errsv == ENOENT) {
+				_LOGD ("sysctl: failed to open '%s': (%d) %s",
+				       pathid, errsv, strerror (errsv));
+			} else {
+				_LOGE ("sysctl: failed to open '%s': (%d) %s",
+				       pathid, errsv, strerror (errsv));
+			}
+			errno = errsv;
+			return FALSE;
+		}
+	} else {
+		fd = openat (dirfd, path, O_WRONLY | O_TRUNC | O_CLOEXEC);
+		if (fd == -1) {
+			errsv = errno;
+			if (cache)
+				_sysctl_cache_update (cache, cache_family_idx, cache_name, NULL);
+			if (errsv == ENOENT) {
+				_LOGD ("sysctl: failed to openat '%s': (%d) %s",
+				       pathid, errsv, strerror (errsv));
+			} else {
+				_LOGE ("sysctl: failed to openat '%s': (%d) %s",
+				       pathid, errsv, strerror (errsv));
+			}
+			errno = errsv;
+			return FALSE;
+		}
+	}
+
+	_log_dbg_sysctl_set (platform, pathid, dirfd, path, value);
+
+	/* Most sysfs and sysctl options don't care about a trailing LF, while some
+	 * (like infiniband) do.  So always add the LF.  Also, neither sysfs nor
+	 * sysctl support partial writes so the LF must be added to the string we're
+	 * about to write.
+	 */
+	len = strlen (value) + 1;
+	if (len > 512)
+		actual = actual_free = g_malloc (len + 1);
+	else
+		actual = g_alloca (len + 1);
 	memcpy (actual, value, len - 1);
 	actual[len - 1] = '\n';
 	actual[len] = '\0';
@@ -2745,13 +3551,15 @@ sysctl_set (NMPlatform *platform, const char *pathid, int dirfd, const char *pat
 	}
 	if (nwrote == -1 && errsv != EEXIST) {
 		_LOGE ("sysctl: failed to set '%s' to '%s': (%d) %s",
-		       path, value, errsv, strerror (errsv));
+		       pathid, value, errsv, strerror (errsv));
 	} else if (nwrote < len - 1) {
 		_LOGE ("sysctl: failed to set '%s' to '%s' after three attempts",
-		       path, value);
+		       pathid, value);
 	}
 
 	if (nwrote < len - 1) {
+		if (cache)
+			_sysctl_cache_update (cache, cache_family_idx, cache_name, NULL);
 		if (close (fd) != 0) {
 			if (errsv != 0)
 				errno = errsv;
@@ -2763,9 +3571,14 @@ sysctl_set (NMPlatform *platform, const char *pathid, int dirfd, const char *pat
 	}
 	if (close (fd) != 0) {
 		/* errno is already properly set. */
+		if (cache)
+			_sysctl_cache_update (cache, cache_family_idx, cache_name, NULL);
 		return FALSE;
 	}
 
+	if (cache)
+		_sysctl_cache_update (cache, cache_family_idx, cache_name, value);
+
 	/* success. errno is undefined (no need to set). */
 	return TRUE;
 }
@@ -2830,9 +3643,13 @@ _log_dbg_sysctl_get_impl (NMPlatform *platform, const char *pathid, const char *
 static char *
 sysctl_get (NMPlatform *platform, const char *pathid, int dirfd, const char *path)
 {
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
 	nm_auto_pop_netns NMPNetns *netns = NULL;
 	GError *error = NULL;
 	char *contents;
+	SysctlIfaceCache *cache = NULL;
+	guint cache_family_idx = 0;
+	const char *cache_name = NULL;
 
 	ASSERT_SYSCTL_ARGS (pathid, dirfd, path);
 
@@ -2840,8 +3657,17 @@ sysctl_get (NMPlatform *platform, const char *pathid, int dirfd, const char *pat
 		if (!nm_platform_netns_push (platform, &netns))
 			return NULL;
 		pathid = path;
+
+		cache = _sysctl_cache_lookup (platform, path, &cache_family_idx, &cache_name);
+		if (cache) {
+			dirfd = _sysctl_cache_get_dirfd (cache, cache_family_idx);
+			if (dirfd >= 0)
+				path = cache_name;
+		}
 	}
 
+	priv->stats.sysctl_reads++;
+
 	if (nm_utils_file_get_contents (dirfd, path, 1*1024*1024, &contents, NULL, &error) < 0) {
 		/* We assume FAILED means EOPNOTSUP */
 		if (   g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT)
@@ -2851,11 +3677,17 @@ sysctl_get (NMPlatform *platform, const char *pathid, int dirfd, const char *pat
 		else
 			_LOGE ("error reading %s: %s", pathid, error->message);
 		g_clear_error (&error);
+		if (cache)
+			_sysctl_cache_update (cache, cache_family_idx, cache_name, NULL);
 		return NULL;
 	}
 
 	g_strstrip (contents);
 
+	/* what we read is the current value. */
+	if (cache)
+		_sysctl_cache_update (cache, cache_family_idx, cache_name, contents);
+
 	_log_dbg_sysctl_get (platform, pathid, contents);
 
 	return contents;
@@ -3096,6 +3928,14 @@ delayed_action_wait_for_nl_response_complete (NMPlatform *platform,
 
 	_LOGt_delayed_action (DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE, data, "complete");
 
+	if (data->start_ns) {
+		gint64 wait_ns = nm_utils_get_monotonic_timestamp_ns () - data->start_ns;
+
+		priv->stats.ack_wait_count++;
+		priv->stats.ack_wait_total_ns += wait_ns;
+		priv->stats.ack_wait_max_ns = MAX (priv->stats.ack_wait_max_ns, wait_ns);
+	}
+
 	if (priv->delayed_action.list_wait_for_nl_response->len <= 1)
 		priv->delayed_action.flags &= ~DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE;
 	if (data->out_seq_result)
@@ -3219,6 +4059,8 @@ delayed_action_handle_one (NMPlatform *platform)
 			}
 		}
 
+		priv->delayed_action.refresh_all_handled |= flags;
+		priv->resync.deferred &= ~flags;
 		delayed_action_handle_REFRESH_ALL (platform, flags);
 		return TRUE;
 	}
@@ -3249,6 +4091,25 @@ delayed_action_handle_one (NMPlatform *platform)
 	return FALSE;
 }
 
+static void
+delayed_action_log_object_pool_stats (NMPlatform *platform, DelayedActionType action_type)
+{
+	DelayedActionType iflags;
+
+	FOR_EACH_DELAYED_ACTION (iflags, action_type) {
+		NMPObjectType obj_type = delayed_action_refresh_to_object_type (iflags);
+		NMPObjectPoolStats stats;
+
+		nmp_object_pool_get_stats (obj_type, &stats);
+		_LOGT ("object-pool: %s: %u alive, %u pooled, %"G_GUINT64_FORMAT" allocated (%"G_GUINT64_FORMAT" recycled)",
+		       nmp_class_from_type (obj_type)->obj_type_name,
+		       stats.n_alive,
+		       stats.n_pooled,
+		       stats.n_allocated,
+		       stats.n_recycled);
+	}
+}
+
 static gboolean
 delayed_action_handle_all (NMPlatform *platform, gboolean read_netlink)
 {
@@ -3257,6 +4118,9 @@ delayed_action_handle_all (NMPlatform *platform, gboolean read_netlink)
 
 	g_return_val_if_fail (priv->delayed_action.is_handling == 0, FALSE);
 
+	/* collect the changes of this pass for one "changes" signal. */
+	nm_platform_changes_freeze (platform);
+
 	priv->delayed_action.is_handling++;
 	if (read_netlink)
 		delayed_action_schedule (platform, DELAYED_ACTION_TYPE_READ_NETLINK, NULL);
@@ -3266,6 +4130,14 @@ delayed_action_handle_all (NMPlatform *platform, gboolean read_netlink)
 
 	cache_prune_candidates_prune (platform);
 
+	nm_platform_changes_thaw (platform);
+
+	if (priv->delayed_action.refresh_all_handled) {
+		if (_LOGT_ENABLED ())
+			delayed_action_log_object_pool_stats (platform, priv->delayed_action.refresh_all_handled);
+		priv->delayed_action.refresh_all_handled = DELAYED_ACTION_TYPE_NONE;
+	}
+
 	return any;
 }
 
@@ -3312,9 +4184,11 @@ delayed_action_schedule_WAIT_FOR_NL_RESPONSE (NMPlatform *platform,
                                               WaitForNlResponseResult *out_seq_result,
                                               gint *out_refresh_all_in_progess)
 {
+	gint64 now_ns = nm_utils_get_monotonic_timestamp_ns ();
 	DelayedActionWaitForNlResponseData data = {
 		.seq_number = seq_number,
-		.timeout_abs_ns = nm_utils_get_monotonic_timestamp_ns () + (200 * (NM_UTILS_NS_PER_SECOND / 1000)),
+		.start_ns = now_ns,
+		.timeout_abs_ns = now_ns + (200 * (NM_UTILS_NS_PER_SECOND / 1000)),
 		.out_seq_result = out_seq_result,
 		.out_refresh_all_in_progess = out_refresh_all_in_progess,
 	};
@@ -3420,6 +4294,12 @@ cache_pre_hook (NMPCache *cache, const NMPObject *old, const NMPObject *new, NMP
 
 	klass = old ? NMP_OBJECT_GET_CLASS (old) : NMP_OBJECT_GET_CLASS (new);
 
+	NM_TRACE3 (cache__op, (int) klass->obj_type, (int) ops_type, (old ?: new)->object.ifindex);
+
+	priv->stats.cache_ops[klass->obj_type][  ops_type == NMP_CACHE_OPS_ADDED
+	                                       ? 0
+	                                       : (ops_type == NMP_CACHE_OPS_UPDATED ? 1 : 2)]++;
+
 	nm_assert (klass == (new ? NMP_OBJECT_GET_CLASS (new) : NMP_OBJECT_GET_CLASS (old)));
 
 	_LOGt ("update-cache-%s: %s: %s%s%s",
@@ -3439,6 +4319,26 @@ cache_pre_hook (NMPCache *cache, const NMPObject *old, const NMPObject *new, NMP
 
 	switch (klass->obj_type) {
 	case NMP_OBJECT_TYPE_LINK:
+		{
+			/* the kernel resets some conf sysctls when the link changes, for
+			 * example the IPv6 MTU on a MTU change or the IPv6 settings when
+			 * the link goes down and up. Forget what we know about them on
+			 * every change of the link, and drop the entry together with
+			 * the link. */
+			if (ops_type == NMP_CACHE_OPS_REMOVED)
+				_sysctl_cache_invalidate (platform, old->link.ifindex, TRUE);
+			else if (ops_type == NMP_CACHE_OPS_UPDATED)
+				_sysctl_cache_invalidate (platform, new->link.ifindex, FALSE);
+		}
+		{
+			/* the ethtool facts belong to the netdev. Forget them when the
+			 * link disappears or is renamed, see _ethtool_cache_get(). */
+			if (ops_type == NMP_CACHE_OPS_REMOVED)
+				_ethtool_cache_invalidate (platform, old->link.ifindex);
+			else if (   ops_type == NMP_CACHE_OPS_UPDATED
+			         && !nm_streq (old->link.name, new->link.name))
+				_ethtool_cache_invalidate (platform, new->link.ifindex);
+		}
 		{
 			/* check whether changing a slave link can cause a master link (bridge or bond) to go up/down */
 			if (   old
@@ -3763,6 +4663,8 @@ do_request_all_no_delayed_actions (NMPlatform *platform, DelayedActionType actio
 		nm_assert (*out_refresh_all_in_progess >= 0);
 		*out_refresh_all_in_progess += 1;
 
+		priv->stats.refresh_all[obj_type]++;
+
 		/* clear any delayed action that request a refresh of this object type. */
 		priv->delayed_action.flags &= ~iflags;
 		_LOGt_delayed_action (iflags, NULL, "handle (do-request-all)");
@@ -3881,6 +4783,8 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 
 	msghdr = nlmsg_hdr (msg);
 
+	NM_TRACE3 (netlink__msg, msghdr->nlmsg_type, msghdr->nlmsg_seq, msghdr->nlmsg_len);
+
 	if (_support_kernel_extended_ifa_flags_still_undecided () && msghdr->nlmsg_type == RTM_NEWADDR)
 		_support_kernel_extended_ifa_flags_detect (msg);
 
@@ -3901,6 +4805,17 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 		return;
 	}
 
+	if (!_ifindex_filter_accept (platform, obj->object.ifindex)) {
+		_LOGT ("event-notification: %s, seq %u: ignore filtered ifindex %d",
+		       _nl_nlmsg_type_to_str (msghdr->nlmsg_type, buf_nlmsg_type, sizeof (buf_nlmsg_type)),
+		       msghdr->nlmsg_seq, obj->object.ifindex);
+		return;
+	}
+
+	NM_TRACE3 (netlink__parsed, msghdr->nlmsg_type, (int) NMP_OBJECT_GET_TYPE (obj), obj->object.ifindex);
+
+	priv->resync.seen |= delayed_action_refresh_from_object_type (NMP_OBJECT_GET_TYPE (obj));
+
 	_LOGT ("event-notification: %s, seq %u: %s",
 	       _nl_nlmsg_type_to_str (msghdr->nlmsg_type, buf_nlmsg_type, sizeof (buf_nlmsg_type)),
 	       msghdr->nlmsg_seq, nmp_object_to_string (obj,
@@ -3990,37 +4905,30 @@ _nm_platform_link_get_by_ifname (NMPlatform *platform,
 	return obj ? &obj->link : NULL;
 }
 
-struct _nm_platform_link_get_by_address_data {
-	gconstpointer address;
-	guint8 length;
-};
-
-static gboolean
-_nm_platform_link_get_by_address_match_link (const NMPObject *obj, struct _nm_platform_link_get_by_address_data *d)
-{
-	return obj->link.addr.len == d->length && !memcmp (obj->link.addr.data, d->address, d->length);
-}
-
 static const NMPlatformLink *
 _nm_platform_link_get_by_address (NMPlatform *platform,
                                   gconstpointer address,
                                   size_t length)
 {
-	const NMPObject *obj;
-	struct _nm_platform_link_get_by_address_data d = {
-		.address = address,
-		.length = length,
-	};
+	const NMPlatformObject *const *list;
+	NMPCacheId cache_id;
+	guint i, len;
 
 	if (length <= 0 || length > NM_UTILS_HWADDR_LEN_MAX)
 		return NULL;
 	if (!address)
 		return NULL;
 
-	obj = nmp_cache_lookup_link_full (NM_LINUX_PLATFORM_GET_PRIVATE (platform)->cache,
-	                                  0, NULL, TRUE, NM_LINK_TYPE_NONE,
-	                                  (NMPObjectMatchFn) _nm_platform_link_get_by_address_match_link, &d);
-	return obj ? &obj->link : NULL;
+	list = nmp_cache_lookup_multi (NM_LINUX_PLATFORM_GET_PRIVATE (platform)->cache,
+	                               nmp_cache_id_init_link_by_address (&cache_id, address, length),
+	                               &len);
+	for (i = 0; i < len; i++) {
+		const NMPObject *obj = NMP_OBJECT_UP_CAST (list[i]);
+
+		if (nmp_object_is_visible (obj))
+			return &obj->link;
+	}
+	return NULL;
 }
 
 /*****************************************************************************/
@@ -4168,6 +5076,32 @@ do_add_addrroute (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *
 	return obj && seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK;
 }
 
+static gboolean
+_delete_object_result_is_success (const NMPObject *obj_id,
+                                  WaitForNlResponseResult seq_result,
+                                  const char **out_log_detail)
+{
+	const char *log_detail = "";
+	gboolean success = TRUE;
+
+	if (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK) {
+		/* ok */
+	} else if (NM_IN_SET (-((int) seq_result), ESRCH, ENOENT))
+		log_detail = ", meaning the object was already removed";
+	else if (   NM_IN_SET (-((int) seq_result), ENXIO)
+	         && NM_IN_SET (NMP_OBJECT_GET_TYPE (obj_id), NMP_OBJECT_TYPE_IP6_ADDRESS)) {
+		/* On RHEL7 kernel, deleting a non existing address fails with ENXIO */
+		log_detail = ", meaning the address was already removed";
+	} else if (   NM_IN_SET (-((int) seq_result), EADDRNOTAVAIL)
+	           && NM_IN_SET (NMP_OBJECT_GET_TYPE (obj_id), NMP_OBJECT_TYPE_IP4_ADDRESS, NMP_OBJECT_TYPE_IP6_ADDRESS))
+		log_detail = ", meaning the address was already removed";
+	else
+		success = FALSE;
+
+	*out_log_detail = log_detail;
+	return success;
+}
+
 static gboolean
 do_delete_object (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *nlmsg)
 {
@@ -4175,8 +5109,8 @@ do_delete_object (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *
 	WaitForNlResponseResult seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
 	int nle;
 	char s_buf[256];
-	gboolean success = TRUE;
-	const char *log_detail = "";
+	gboolean success;
+	const char *log_detail;
 
 	event_handler_read_netlink (platform, FALSE);
 
@@ -4193,19 +5127,7 @@ do_delete_object (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *
 
 	nm_assert (seq_result);
 
-	if (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK) {
-		/* ok */
-	} else if (NM_IN_SET (-((int) seq_result), ESRCH, ENOENT))
-		log_detail = ", meaning the object was already removed";
-	else if (   NM_IN_SET (-((int) seq_result), ENXIO)
-	         && NM_IN_SET (NMP_OBJECT_GET_TYPE (obj_id), NMP_OBJECT_TYPE_IP6_ADDRESS)) {
-		/* On RHEL7 kernel, deleting a non existing address fails with ENXIO */
-		log_detail = ", meaning the address was already removed";
-	} else if (   NM_IN_SET (-((int) seq_result), EADDRNOTAVAIL)
-	           && NM_IN_SET (NMP_OBJECT_GET_TYPE (obj_id), NMP_OBJECT_TYPE_IP4_ADDRESS, NMP_OBJECT_TYPE_IP6_ADDRESS))
-		log_detail = ", meaning the address was already removed";
-	else
-		success = FALSE;
+	success = _delete_object_result_is_success (obj_id, seq_result, &log_detail);
 
 	_NMLOG (success ? LOGL_DEBUG : LOGL_ERR,
 	        "do-delete-%s[%s]: %s%s",
@@ -4395,6 +5317,35 @@ link_get_type_name (NMPlatform *platform, int ifindex)
 	return obj->link.kind ?: "unknown";
 }
 
+static struct udev_device *
+_link_get_udev_device (NMPlatform *platform, const NMPObject *obj)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	struct udev_device *udevice;
+
+	if (   obj->_link.udev.device
+	    || !obj->_link.udev.deferred
+	    || !priv->udev_client)
+		return obj->_link.udev.device;
+
+	/* udev announced the link, but we didn't keep the device. Look it
+	 * up now and keep it only until the next on-demand lookup, so that
+	 * callers can use the returned device like the one from the cache. */
+	udevice = priv->udev_device_ondemand;
+	if (udevice) {
+		if (   nm_streq0 (udev_device_get_sysname (udevice), obj->link.name)
+		    && _nm_utils_ascii_str_to_int64 (udev_device_get_property_value (udevice, "IFINDEX"),
+		                                     10, 1, G_MAXINT, 0) == obj->link.ifindex)
+			return udevice;
+		g_clear_pointer (&priv->udev_device_ondemand, udev_device_unref);
+	}
+
+	priv->udev_device_ondemand = udev_device_new_from_subsystem_sysname (nm_udev_client_get_udev (priv->udev_client),
+	                                                                     "net",
+	                                                                     obj->link.name);
+	return priv->udev_device_ondemand;
+}
+
 static gboolean
 link_get_unmanaged (NMPlatform *platform, int ifindex, gboolean *unmanaged)
 {
@@ -4407,7 +5358,7 @@ link_get_unmanaged (NMPlatform *platform, int ifindex, gboolean *unmanaged)
 	if (!link)
 		return FALSE;
 
-	udevice = link->_link.udev.device;
+	udevice = _link_get_udev_device (platform, link);
 	if (!udevice)
 		return FALSE;
 
@@ -4423,6 +5374,12 @@ link_refresh (NMPlatform *platform, int ifindex)
 	return !!cache_lookup_link (platform, ifindex);
 }
 
+static void
+link_refresh_all (NMPlatform *platform)
+{
+	do_request_one_type (platform, NMP_OBJECT_TYPE_LINK);
+}
+
 static gboolean
 link_set_netns (NMPlatform *platform,
                 int ifindex,
@@ -4508,12 +5465,13 @@ static const char *
 link_get_udi (NMPlatform *platform, int ifindex)
 {
 	const NMPObject *obj = cache_lookup_link (platform, ifindex);
+	struct udev_device *udevice;
 
 	if (   !obj
 	    || !obj->_link.netlink.is_in_netlink
-	    || !obj->_link.udev.device)
+	    || !(udevice = _link_get_udev_device (platform, obj)))
 		return NULL;
-	return udev_device_get_syspath (obj->_link.udev.device);
+	return udev_device_get_syspath (udevice);
 }
 
 static struct udev_device *
@@ -4527,7 +5485,7 @@ link_get_udev_device (NMPlatform *platform, int ifindex)
 	 * appears invisible via other platform functions. */
 
 	obj_cache = nmp_cache_lookup_link (NM_LINUX_PLATFORM_GET_PRIVATE (platform)->cache, ifindex);
-	return obj_cache ? obj_cache->_link.udev.device : NULL;
+	return obj_cache ? _link_get_udev_device (platform, obj_cache) : NULL;
 }
 
 static NMPlatformError
@@ -4576,23 +5534,26 @@ link_set_token (NMPlatform *platform, int ifindex, NMUtilsIPv6IfaceId iid)
 static gboolean
 link_supports_carrier_detect (NMPlatform *platform, int ifindex)
 {
-	nm_auto_pop_netns NMPNetns *netns = NULL;
+	NMPNetns *netns = nm_platform_netns_get (platform);
+	EthtoolIfaceCache *c = _ethtool_cache_get (platform, ifindex);
 
-	if (!nm_platform_netns_push (platform, &netns))
-		return FALSE;
+	if (_ethtool_cache_has (platform, c, ETHTOOL_CACHE_CARRIER_DETECT))
+		return NM_FLAGS_HAS (c->valid, ETHTOOL_CACHE_CARRIER_DETECT);
 
 	/* We use netlink for the actual carrier detection, but netlink can't tell
 	 * us whether the device actually supports carrier detection in the first
 	 * place. We assume any device that does implements one of these two APIs.
 	 */
-	return nmp_utils_ethtool_supports_carrier_detect (ifindex) || nmp_utils_mii_supports_carrier_detect (ifindex);
+	return _ethtool_cache_set (c, ETHTOOL_CACHE_CARRIER_DETECT,
+	                              nmp_utils_ethtool_supports_carrier_detect (netns, ifindex)
+	                           || nmp_utils_mii_supports_carrier_detect (netns, ifindex));
 }
 
 static gboolean
 link_supports_vlans (NMPlatform *platform, int ifindex)
 {
-	nm_auto_pop_netns NMPNetns *netns = NULL;
 	const NMPObject *obj;
+	EthtoolIfaceCache *c;
 
 	obj = cache_lookup_link (platform, ifindex);
 
@@ -4600,10 +5561,12 @@ link_supports_vlans (NMPlatform *platform, int ifindex)
 	if (!obj || obj->link.arptype != ARPHRD_ETHER)
 		return FALSE;
 
-	if (!nm_platform_netns_push (platform, &netns))
-		return FALSE;
+	c = _ethtool_cache_get (platform, ifindex);
+	if (_ethtool_cache_has (platform, c, ETHTOOL_CACHE_VLANS))
+		return NM_FLAGS_HAS (c->valid, ETHTOOL_CACHE_VLANS);
 
-	return nmp_utils_ethtool_supports_vlans (ifindex);
+	return _ethtool_cache_set (c, ETHTOOL_CACHE_VLANS,
+	                           nmp_utils_ethtool_supports_vlans (nm_platform_netns_get (platform), ifindex));
 }
 
 static NMPlatformError
@@ -4666,12 +5629,24 @@ link_get_permanent_address (NMPlatform *platform,
                             guint8 *buf,
                             size_t *length)
 {
-	nm_auto_pop_netns NMPNetns *netns = NULL;
+	EthtoolIfaceCache *c = _ethtool_cache_get (platform, ifindex);
 
-	if (!nm_platform_netns_push (platform, &netns))
+	if (!c)
+		return nmp_utils_ethtool_get_permanent_address (nm_platform_netns_get (platform), ifindex, buf, length);
+
+	if (!_ethtool_cache_has (platform, c, ETHTOOL_CACHE_PERM_ADDRESS)) {
+		_ethtool_cache_set (c, ETHTOOL_CACHE_PERM_ADDRESS,
+		                    nmp_utils_ethtool_get_permanent_address (nm_platform_netns_get (platform),
+		                                                             ifindex,
+		                                                             c->perm_address,
+		                                                             &c->perm_address_len));
+	}
+	if (!NM_FLAGS_HAS (c->valid, ETHTOOL_CACHE_PERM_ADDRESS))
 		return FALSE;
 
-	return nmp_utils_ethtool_get_permanent_address (ifindex, buf, length);
+	memcpy (buf, c->perm_address, c->perm_address_len);
+	*length = c->perm_address_len;
+	return TRUE;
 }
 
 static gboolean
@@ -4769,6 +5744,102 @@ nla_put_failure:
 	g_return_val_if_reached (FALSE);
 }
 
+static gboolean
+link_bridge_change (NMPlatform *platform,
+                    int ifindex,
+                    const NMPlatformBridgeOptions *options)
+{
+	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+	struct nlattr *info;
+	struct nlattr *data;
+
+	_LOGD ("link: change %d: bridge: stp %u, priority %u, forward-delay %u, hello-time %u, max-age %u, ageing-time %u, multicast-snooping %u",
+	       ifindex,
+	       options->stp_state,
+	       options->priority,
+	       options->forward_delay,
+	       options->hello_time,
+	       options->max_age,
+	       options->ageing_time,
+	       options->multicast_snooping);
+
+	nlmsg = _nl_msg_new_link (RTM_NEWLINK,
+	                          0,
+	                          ifindex,
+	                          NULL,
+	                          0,
+	                          0);
+	if (!nlmsg)
+		return FALSE;
+
+	if (!(info = nla_nest_start (nlmsg, IFLA_LINKINFO)))
+		goto nla_put_failure;
+
+	NLA_PUT_STRING (nlmsg, IFLA_INFO_KIND, "bridge");
+
+	if (!(data = nla_nest_start (nlmsg, IFLA_INFO_DATA)))
+		goto nla_put_failure;
+
+	NLA_PUT_U32 (nlmsg, IFLA_BR_FORWARD_DELAY, options->forward_delay);
+	NLA_PUT_U32 (nlmsg, IFLA_BR_HELLO_TIME, options->hello_time);
+	NLA_PUT_U32 (nlmsg, IFLA_BR_MAX_AGE, options->max_age);
+	NLA_PUT_U32 (nlmsg, IFLA_BR_AGEING_TIME, options->ageing_time);
+	NLA_PUT_U32 (nlmsg, IFLA_BR_STP_STATE, options->stp_state);
+	NLA_PUT_U16 (nlmsg, IFLA_BR_PRIORITY, options->priority);
+	NLA_PUT_U8 (nlmsg, IFLA_BR_MCAST_SNOOPING, !!options->multicast_snooping);
+
+	nla_nest_end (nlmsg, data);
+	nla_nest_end (nlmsg, info);
+
+	return do_change_link (platform, ifindex, nlmsg) == NM_PLATFORM_ERROR_SUCCESS;
+nla_put_failure:
+	g_return_val_if_reached (FALSE);
+}
+
+static gboolean
+link_bridge_port_change (NMPlatform *platform,
+                         int ifindex,
+                         const NMPlatformBridgePortOptions *options)
+{
+	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+	struct nlattr *info;
+	struct nlattr *data;
+
+	_LOGD ("link: change %d: bridge-port: priority %u, path-cost %u, hairpin-mode %u",
+	       ifindex,
+	       options->priority,
+	       options->path_cost,
+	       options->hairpin_mode);
+
+	nlmsg = _nl_msg_new_link (RTM_NEWLINK,
+	                          0,
+	                          ifindex,
+	                          NULL,
+	                          0,
+	                          0);
+	if (!nlmsg)
+		return FALSE;
+
+	if (!(info = nla_nest_start (nlmsg, IFLA_LINKINFO)))
+		goto nla_put_failure;
+
+	NLA_PUT_STRING (nlmsg, IFLA_INFO_SLAVE_KIND, "bridge");
+
+	if (!(data = nla_nest_start (nlmsg, IFLA_INFO_SLAVE_DATA)))
+		goto nla_put_failure;
+
+	NLA_PUT_U16 (nlmsg, IFLA_BRPORT_PRIORITY, options->priority);
+	NLA_PUT_U32 (nlmsg, IFLA_BRPORT_COST, options->path_cost);
+	NLA_PUT_U8 (nlmsg, IFLA_BRPORT_MODE, !!options->hairpin_mode);
+
+	nla_nest_end (nlmsg, data);
+	nla_nest_end (nlmsg, info);
+
+	return do_change_link (platform, ifindex, nlmsg) == NM_PLATFORM_ERROR_SUCCESS;
+nla_put_failure:
+	g_return_val_if_reached (FALSE);
+}
+
 static int
 link_gre_add (NMPlatform *platform,
               const char *name,
@@ -5344,9 +6415,11 @@ tun_add (NMPlatform *platform, const char *name, gboolean tap,
          gint64 owner, gint64 group, gboolean pi, gboolean vnet_hdr,
          gboolean multi_queue, const NMPlatformLink **out_link)
 {
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
 	const NMPObject *obj;
 	struct ifreq ifr = { };
-	int fd;
+	nm_auto_close int fd = -1;
+	NMLinkType link_type = tap ? NM_LINK_TYPE_TAP : NM_LINK_TYPE_TUN;
 
 	_LOGD ("link: add %s '%s' owner %" G_GINT64_FORMAT " group %" G_GINT64_FORMAT,
 	       tap ? "tap" : "tun", name, owner, group);
@@ -5365,63 +6438,130 @@ tun_add (NMPlatform *platform, const char *name, gboolean tap,
 	if (multi_queue)
 		ifr.ifr_flags |= NM_IFF_MULTI_QUEUE;
 
-	if (ioctl (fd, TUNSETIFF, &ifr)) {
-		close (fd);
+	if (ioctl (fd, TUNSETIFF, &ifr))
 		return FALSE;
-	}
 
 	if (owner >= 0 && owner < G_MAXINT32) {
-		if (ioctl (fd, TUNSETOWNER, (uid_t) owner)) {
-			close (fd);
+		if (ioctl (fd, TUNSETOWNER, (uid_t) owner))
 			return FALSE;
-		}
 	}
 
 	if (group >= 0 && group < G_MAXINT32) {
-		if (ioctl (fd, TUNSETGROUP, (gid_t) group)) {
-			close (fd);
+		if (ioctl (fd, TUNSETGROUP, (gid_t) group))
 			return FALSE;
-		}
 	}
 
-	if (ioctl (fd, TUNSETPERSIST, 1)) {
-		close (fd);
+	if (ioctl (fd, TUNSETPERSIST, 1))
 		return FALSE;
+
+	/* The kernel has no RTM_NEWLINK support for tun devices, so they can
+	 * only be created via ioctl(). But the RTM_NEWLINK notification for
+	 * the new link is queued on our socket before TUNSETIFF returns. Read
+	 * it instead of requesting the link, and only do the extra round trip
+	 * if the notification got lost (e.g. on a socket buffer overrun). */
+	delayed_action_handle_all (platform, TRUE);
+	obj = nmp_cache_lookup_link_full (priv->cache, 0, name, FALSE, link_type, NULL, NULL);
+	if (!obj) {
+		do_request_link (platform, 0, name);
+		obj = nmp_cache_lookup_link_full (priv->cache, 0, name, FALSE, link_type, NULL, NULL);
 	}
-	do_request_link (platform, 0, name);
-	obj = nmp_cache_lookup_link_full (NM_LINUX_PLATFORM_GET_PRIVATE (platform)->cache,
-	                                  0, name, FALSE,
-	                                  tap ? NM_LINK_TYPE_TAP : NM_LINK_TYPE_TUN,
-	                                  NULL, NULL);
+
 	if (out_link)
 		*out_link = obj ? &obj->link : NULL;
-
-	close (fd);
 	return !!obj;
 }
 
-static gboolean
-link_enslave (NMPlatform *platform, int master, int slave)
+static struct nl_msg *
+_nl_msg_new_link_enslave (int master, int slave)
 {
-	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
-	int ifindex = slave;
-
-	_LOGD ("link: change %d: enslave: master %d", slave, master);
+	struct nl_msg *nlmsg;
 
 	nlmsg = _nl_msg_new_link (RTM_NEWLINK,
 	                          0,
-	                          ifindex,
+	                          slave,
 	                          NULL,
 	                          0,
 	                          0);
 	if (!nlmsg)
-		return FALSE;
+		return NULL;
 
 	NLA_PUT_U32 (nlmsg, IFLA_MASTER, master);
-
-	return do_change_link (platform, ifindex, nlmsg) == NM_PLATFORM_ERROR_SUCCESS;
+	return nlmsg;
 nla_put_failure:
-	g_return_val_if_reached (FALSE);
+	nlmsg_free (nlmsg);
+	g_return_val_if_reached (NULL);
+}
+
+static gboolean
+link_enslave (NMPlatform *platform, int master, int slave)
+{
+	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+
+	_LOGD ("link: change %d: enslave: master %d", slave, master);
+
+	nlmsg = _nl_msg_new_link_enslave (master, slave);
+	if (!nlmsg)
+		return FALSE;
+
+	return do_change_link (platform, slave, nlmsg) == NM_PLATFORM_ERROR_SUCCESS;
+}
+
+/* limits the number of requests in flight, so that the acks and the
+ * link notifications don't overflow the socket's receive buffer. */
+#define ENSLAVE_MANY_BATCH_SIZE 64
+
+static void
+link_enslave_many (NMPlatform *platform,
+                   int master,
+                   const int *slaves,
+                   guint n_slaves,
+                   gboolean *out_success)
+{
+	nm_auto_pop_netns NMPNetns *netns = NULL;
+	gs_free WaitForNlResponseResult *seq_results = NULL;
+	guint i, batch_start;
+
+	memset (out_success, 0, sizeof (*out_success) * n_slaves);
+
+	if (!nm_platform_netns_push (platform, &netns))
+		return;
+
+	seq_results = g_new0 (WaitForNlResponseResult, n_slaves);
+
+	for (batch_start = 0; batch_start < n_slaves; batch_start += ENSLAVE_MANY_BATCH_SIZE) {
+		guint batch_end = MIN (batch_start + ENSLAVE_MANY_BATCH_SIZE, n_slaves);
+
+		for (i = batch_start; i < batch_end; i++) {
+			nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+			int nle;
+
+			_LOGD ("link: change %d: enslave: master %d", slaves[i], master);
+
+			nlmsg = _nl_msg_new_link_enslave (master, slaves[i]);
+			if (!nlmsg)
+				continue;
+
+			nle = _nl_send_auto_with_seq (platform, nlmsg, &seq_results[i], NULL);
+			if (nle < 0) {
+				_LOGE ("do-change-link[%d]: failure sending netlink request \"%s\" (%d)",
+				       slaves[i],
+				       nl_geterror (nle), -nle);
+			}
+		}
+
+		/* like do_change_link(), refetch the changed links. But for a
+		 * larger batch, a single dump is much cheaper than one request
+		 * per slave. */
+		if (batch_end - batch_start > 1)
+			delayed_action_schedule (platform, DELAYED_ACTION_TYPE_REFRESH_ALL_LINKS, NULL);
+		else
+			delayed_action_schedule (platform, DELAYED_ACTION_TYPE_REFRESH_LINK, GINT_TO_POINTER (slaves[batch_start]));
+
+		delayed_action_handle_all (platform, FALSE);
+	}
+
+	for (i = 0; i < n_slaves; i++)
+		out_success[i] = (do_change_link_result (platform, slaves[i], seq_results[i]) == NM_PLATFORM_ERROR_SUCCESS);
 }
 
 static gboolean
@@ -5608,6 +6748,49 @@ wifi_indicate_addressing_running (NMPlatform *platform, int ifindex, gboolean ru
 	wifi_utils_indicate_addressing_running (wifi_data, running);
 }
 
+typedef struct {
+	NMPlatform *platform;
+	NMPlatformWifiEventFunc callback;
+	gpointer user_data;
+} WifiWatchEventsData;
+
+static void
+_wifi_watch_events_cb (WifiData *wifi_data, gpointer user_data)
+{
+	WifiWatchEventsData *data = user_data;
+
+	data->callback (data->platform,
+	                wifi_utils_get_ifindex (wifi_data),
+	                data->user_data);
+}
+
+static void
+_wifi_watch_events_data_free (gpointer user_data)
+{
+	g_slice_free (WifiWatchEventsData, user_data);
+}
+
+static gboolean
+wifi_watch_events (NMPlatform *platform, int ifindex, NMPlatformWifiEventFunc callback, gpointer user_data)
+{
+	WifiWatchEventsData *data;
+
+	WIFI_GET_WIFI_DATA_NETNS (wifi_data, platform, ifindex, FALSE);
+
+	if (!callback)
+		return wifi_utils_watch_events (wifi_data, NULL, NULL, NULL);
+
+	/* the platform owns the WifiData, so it outlives the watch. */
+	data = g_slice_new (WifiWatchEventsData);
+	data->platform = platform;
+	data->callback = callback;
+	data->user_data = user_data;
+	return wifi_utils_watch_events (wifi_data,
+	                                _wifi_watch_events_cb,
+	                                data,
+	                                _wifi_watch_events_data_free);
+}
+
 /*****************************************************************************/
 
 static gboolean
@@ -5679,14 +6862,10 @@ mesh_set_ssid (NMPlatform *platform, int ifindex, const guint8 *ssid, gsize len)
 static gboolean
 link_get_wake_on_lan (NMPlatform *platform, int ifindex)
 {
-	nm_auto_pop_netns NMPNetns *netns = NULL;
 	NMLinkType type = nm_platform_link_get_type (platform, ifindex);
 
-	if (!nm_platform_netns_push (platform, &netns))
-		return FALSE;
-
 	if (type == NM_LINK_TYPE_ETHERNET)
-		return nmp_utils_ethtool_get_wake_on_lan (ifindex);
+		return nmp_utils_ethtool_get_wake_on_lan (nm_platform_netns_get (platform), ifindex);
 	else if (type == NM_LINK_TYPE_WIFI) {
 		WifiData *wifi_data = wifi_get_wifi_data (platform, ifindex);
 
@@ -5705,17 +6884,28 @@ link_get_driver_info (NMPlatform *platform,
                       char **out_driver_version,
                       char **out_fw_version)
 {
-	nm_auto_pop_netns NMPNetns *netns = NULL;
-	NMPUtilsEthtoolDriverInfo driver_info;
+	NMPUtilsEthtoolDriverInfo driver_info_local;
+	const NMPUtilsEthtoolDriverInfo *driver_info = &driver_info_local;
+	EthtoolIfaceCache *c = _ethtool_cache_get (platform, ifindex);
 
-	if (!nm_platform_netns_push (platform, &netns))
-		return FALSE;
+	if (!c) {
+		if (!nmp_utils_ethtool_get_driver_info (nm_platform_netns_get (platform), ifindex, &driver_info_local))
+			return FALSE;
+	} else {
+		if (!_ethtool_cache_has (platform, c, ETHTOOL_CACHE_DRIVER_INFO)) {
+			_ethtool_cache_set (c, ETHTOOL_CACHE_DRIVER_INFO,
+			                    nmp_utils_ethtool_get_driver_info (nm_platform_netns_get (platform),
+			                                                       ifindex,
+			                                                       &c->driver_info));
+		}
+		if (!NM_FLAGS_HAS (c->valid, ETHTOOL_CACHE_DRIVER_INFO))
+			return FALSE;
+		driver_info = &c->driver_info;
+	}
 
-	if (!nmp_utils_ethtool_get_driver_info (ifindex, &driver_info))
-		return FALSE;
-	NM_SET_OUT (out_driver_name,    g_strdup (driver_info.driver));
-	NM_SET_OUT (out_driver_version, g_strdup (driver_info.version));
-	NM_SET_OUT (out_fw_version,     g_strdup (driver_info.fw_version));
+	NM_SET_OUT (out_driver_name,    g_strdup (driver_info->driver));
+	NM_SET_OUT (out_driver_version, g_strdup (driver_info->version));
+	NM_SET_OUT (out_fw_version,     g_strdup (driver_info->fw_version));
 	return TRUE;
 }
 
@@ -5948,39 +7138,117 @@ ip_route_get_lock_flag (NMPlatformIPRoute *route)
 	       | (((guint32) route->lock_mtu) << RTAX_MTU);
 }
 
-static gboolean
-ip4_route_add (NMPlatform *platform, const NMPlatformIP4Route *route)
+static struct nl_msg *
+_nl_msg_new_ip4_route_add (const NMPlatformIP4Route *route, NMPObject *out_obj_id)
 {
-	NMPObject obj_id;
-	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
 	in_addr_t network;
 
 	network = nm_utils_ip4_address_clear_host_address (route->network, route->plen);
 
+	nmp_object_stackinit_id_ip4_route (out_obj_id, route->ifindex, network, route->plen, route->metric);
+
 	/* FIXME: take the scope from route into account */
-	nlmsg = _nl_msg_new_route (RTM_NEWROUTE,
-	                           NLM_F_CREATE | NLM_F_REPLACE,
-	                           AF_INET,
-	                           route->ifindex,
-	                           route->rt_source,
-	                           route->gateway ? RT_SCOPE_UNIVERSE : RT_SCOPE_LINK,
-	                           &network,
-	                           route->plen,
-	                           &route->gateway,
-	                           route->metric,
-	                           route->mss,
-	                           route->pref_src ? &route->pref_src : NULL,
-	                           NULL,
-	                           0,
-	                           route->tos,
-	                           route->window,
-	                           route->cwnd,
-	                           route->initcwnd,
-	                           route->initrwnd,
-	                           route->mtu,
-	                           ip_route_get_lock_flag ((NMPlatformIPRoute *) route));
-
-	nmp_object_stackinit_id_ip4_route (&obj_id, route->ifindex, network, route->plen, route->metric);
+	return _nl_msg_new_route (RTM_NEWROUTE,
+	                          NLM_F_CREATE | NLM_F_REPLACE,
+	                          AF_INET,
+	                          route->ifindex,
+	                          route->rt_source,
+	                          route->gateway ? RT_SCOPE_UNIVERSE : RT_SCOPE_LINK,
+	                          &network,
+	                          route->plen,
+	                          &route->gateway,
+	                          route->metric,
+	                          route->mss,
+	                          route->pref_src ? &route->pref_src : NULL,
+	                          NULL,
+	                          0,
+	                          route->tos,
+	                          route->window,
+	                          route->cwnd,
+	                          route->initcwnd,
+	                          route->initrwnd,
+	                          route->mtu,
+	                          ip_route_get_lock_flag ((NMPlatformIPRoute *) route));
+}
+
+static struct nl_msg *
+_nl_msg_new_ip6_route_add (const NMPlatformIP6Route *route, NMPObject *out_obj_id)
+{
+	struct in6_addr network;
+
+	nm_utils_ip6_address_clear_host_address (&network, &route->network, route->plen);
+
+	nmp_object_stackinit_id_ip6_route (out_obj_id, route->ifindex, &network, route->plen, route->metric);
+
+	/* FIXME: take the scope from route into account */
+	return _nl_msg_new_route (RTM_NEWROUTE,
+	                          NLM_F_CREATE | NLM_F_REPLACE,
+	                          AF_INET6,
+	                          route->ifindex,
+	                          route->rt_source,
+	                          IN6_IS_ADDR_UNSPECIFIED (&route->gateway) ? RT_SCOPE_LINK : RT_SCOPE_UNIVERSE,
+	                          &network,
+	                          route->plen,
+	                          &route->gateway,
+	                          route->metric,
+	                          route->mss,
+	                          !IN6_IS_ADDR_UNSPECIFIED (&route->pref_src) ? &route->pref_src : NULL,
+	                          !IN6_IS_ADDR_UNSPECIFIED (&route->src) ? &route->src : NULL,
+	                          route->src_plen,
+	                          route->tos,
+	                          route->window,
+	                          route->cwnd,
+	                          route->initcwnd,
+	                          route->initrwnd,
+	                          route->mtu,
+	                          ip_route_get_lock_flag ((NMPlatformIPRoute *) route));
+}
+
+static struct nl_msg *
+_nl_msg_new_ip_route_delete (int addr_family,
+                             int ifindex,
+                             gconstpointer network,
+                             guint8 plen,
+                             guint32 metric,
+                             NMPObject *out_obj_id)
+{
+	if (addr_family == AF_INET)
+		nmp_object_stackinit_id_ip4_route (out_obj_id, ifindex, *((const in_addr_t *) network), plen, metric);
+	else {
+		metric = nm_utils_ip6_route_metric_normalize (metric);
+		nmp_object_stackinit_id_ip6_route (out_obj_id, ifindex, network, plen, metric);
+	}
+
+	return _nl_msg_new_route (RTM_DELROUTE,
+	                          0,
+	                          addr_family,
+	                          ifindex,
+	                          NM_IP_CONFIG_SOURCE_UNKNOWN,
+	                          RT_SCOPE_NOWHERE,
+	                          network,
+	                          plen,
+	                          NULL,
+	                          metric,
+	                          0,
+	                          NULL,
+	                          NULL,
+	                          0,
+	                          0,
+	                          0,
+	                          0,
+	                          0,
+	                          0,
+	                          0,
+	                          0);
+}
+
+static gboolean
+ip4_route_add (NMPlatform *platform, const NMPlatformIP4Route *route)
+{
+	NMPObject obj_id;
+	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+
+	nlmsg = _nl_msg_new_ip4_route_add (route, &obj_id);
 	return do_add_addrroute (platform, &obj_id, nlmsg);
 }
 
@@ -5989,34 +7257,8 @@ ip6_route_add (NMPlatform *platform, const NMPlatformIP6Route *route)
 {
 	NMPObject obj_id;
 	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
-	struct in6_addr network;
 
-	nm_utils_ip6_address_clear_host_address (&network, &route->network, route->plen);
-
-	/* FIXME: take the scope from route into account */
-	nlmsg = _nl_msg_new_route (RTM_NEWROUTE,
-	                           NLM_F_CREATE | NLM_F_REPLACE,
-	                           AF_INET6,
-	                           route->ifindex,
-	                           route->rt_source,
-	                           IN6_IS_ADDR_UNSPECIFIED (&route->gateway) ? RT_SCOPE_LINK : RT_SCOPE_UNIVERSE,
-	                           &network,
-	                           route->plen,
-	                           &route->gateway,
-	                           route->metric,
-	                           route->mss,
-	                           !IN6_IS_ADDR_UNSPECIFIED (&route->pref_src) ? &route->pref_src : NULL,
-	                           !IN6_IS_ADDR_UNSPECIFIED (&route->src) ? &route->src : NULL,
-	                           route->src_plen,
-	                           route->tos,
-	                           route->window,
-	                           route->cwnd,
-	                           route->initcwnd,
-	                           route->initrwnd,
-	                           route->mtu,
-	                           ip_route_get_lock_flag ((NMPlatformIPRoute *) route));
-
-	nmp_object_stackinit_id_ip6_route (&obj_id, route->ifindex, &network, route->plen, route->metric);
+	nlmsg = _nl_msg_new_ip6_route_add (route, &obj_id);
 	return do_add_addrroute (platform, &obj_id, nlmsg);
 }
 
@@ -6058,27 +7300,7 @@ ip4_route_delete (NMPlatform *platform, int ifindex, in_addr_t network, guint8 p
 		}
 	}
 
-	nlmsg = _nl_msg_new_route (RTM_DELROUTE,
-	                           0,
-	                           AF_INET,
-	                           ifindex,
-	                           NM_IP_CONFIG_SOURCE_UNKNOWN,
-	                           RT_SCOPE_NOWHERE,
-	                           &network,
-	                           plen,
-	                           NULL,
-	                           metric,
-	                           0,
-	                           NULL,
-	                           NULL,
-	                           0,
-	                           0,
-	                           0,
-	                           0,
-	                           0,
-	                           0,
-	                           0,
-	                           0);
+	nlmsg = _nl_msg_new_ip_route_delete (AF_INET, ifindex, &network, plen, metric, &obj_id);
 	if (!nlmsg)
 		return FALSE;
 
@@ -6091,35 +7313,293 @@ ip6_route_delete (NMPlatform *platform, int ifindex, struct in6_addr network, gu
 	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
 	NMPObject obj_id;
 
-	metric = nm_utils_ip6_route_metric_normalize (metric);
+	nlmsg = _nl_msg_new_ip_route_delete (AF_INET6, ifindex, &network, plen, metric, &obj_id);
+	if (!nlmsg)
+		return FALSE;
 
-	nlmsg = _nl_msg_new_route (RTM_DELROUTE,
-	                           0,
-	                           AF_INET6,
-	                           ifindex,
-	                           NM_IP_CONFIG_SOURCE_UNKNOWN,
-	                           RT_SCOPE_NOWHERE,
-	                           &network,
-	                           plen,
-	                           NULL,
-	                           metric,
-	                           0,
-	                           NULL,
-	                           NULL,
-	                           0,
-	                           0,
-	                           0,
-	                           0,
-	                           0,
-	                           0,
-	                           0,
-	                           0);
+	return do_delete_object (platform, &obj_id, nlmsg);
+}
+
+/*****************************************************************************/
+
+/* the maximum number of bytes that are packed into one sendmsg() call
+ * by ip_route_batch(). */
+#define IP_ROUTE_BATCH_SEND_BUF_SIZE (32 * 1024)
+
+typedef struct {
+	NMPObject obj_id;
+	guint32 seq_number;
+	WaitForNlResponseResult seq_result;
+} IPRouteBatchData;
+
+static gboolean
+_ip_route_batch_entry_send_single (int addr_family, const NMPlatformIPRouteBatchEntry *entry)
+{
+	/* deleting IPv4 routes with metric zero requires special care,
+	 * see ip4_route_delete(). */
+	return    addr_family == AF_INET
+	       && entry->is_delete
+	       && entry->route.rx.metric == 0;
+}
+
+static gboolean
+_ip_route_batch_flush (NMPlatform *platform,
+                       GByteArray *buf,
+                       IPRouteBatchData *data,
+                       guint i_start,
+                       guint i_end)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	guint i;
+	int nle;
+
+	if (buf->len == 0)
+		return TRUE;
+
+	nle = nl_sendto (priv->nlh, buf->data, buf->len);
+	g_byte_array_set_size (buf, 0);
+	if (nle < 0) {
+		_LOGE ("do-route-batch: failure sending netlink request \"%s\" (%d)",
+		       nl_geterror (nle), -nle);
+		return FALSE;
+	}
+
+	for (i = i_start; i < i_end; i++) {
+		if (data[i].seq_number == 0)
+			continue;
+		delayed_action_schedule_WAIT_FOR_NL_RESPONSE (platform,
+		                                              data[i].seq_number,
+		                                              &data[i].seq_result,
+		                                              NULL);
+	}
+	return TRUE;
+}
+
+static guint
+_ip_route_batch_send (NMPlatform *platform,
+                      int addr_family,
+                      const NMPlatformIPRouteBatchEntry *entries,
+                      IPRouteBatchData *data,
+                      guint i_start,
+                      guint n_entries)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	GByteArray *buf;
+	guint i, i_chunk;
+
+	buf = g_byte_array_sized_new (IP_ROUTE_BATCH_SEND_BUF_SIZE);
+
+	for (i = i_start, i_chunk = i_start; i < n_entries; i++) {
+		const NMPlatformIPRouteBatchEntry *e = &entries[i];
+		nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+		struct nlmsghdr *hdr;
+
+		if (_ip_route_batch_entry_send_single (addr_family, e))
+			break;
+
+		if (e->is_delete) {
+			nlmsg = _nl_msg_new_ip_route_delete (addr_family,
+			                                     e->route.rx.ifindex,
+			                                     addr_family == AF_INET
+			                                         ? (gconstpointer) &e->route.r4.network
+			                                         : (gconstpointer) &e->route.r6.network,
+			                                     e->route.rx.plen,
+			                                     e->route.rx.metric,
+			                                     &data[i].obj_id);
+		} else if (addr_family == AF_INET)
+			nlmsg = _nl_msg_new_ip4_route_add (&e->route.r4, &data[i].obj_id);
+		else
+			nlmsg = _nl_msg_new_ip6_route_add (&e->route.r6, &data[i].obj_id);
+		if (!nlmsg)
+			continue;
+
+		/* complete the message with a sequence number (ensuring it's not zero). */
+		hdr = nlmsg_hdr (nlmsg);
+		hdr->nlmsg_seq = priv->nlh_seq_next++ ?: priv->nlh_seq_next++;
+		nl_complete_msg (priv->nlh, nlmsg);
+
+		if (buf->len + hdr->nlmsg_len > IP_ROUTE_BATCH_SEND_BUF_SIZE) {
+			_ip_route_batch_flush (platform, buf, data, i_chunk, i);
+			i_chunk = i;
+		}
+
+		data[i].seq_number = hdr->nlmsg_seq;
+		g_byte_array_append (buf, (const guint8 *) hdr, NLMSG_ALIGN (hdr->nlmsg_len));
+	}
+	_ip_route_batch_flush (platform, buf, data, i_chunk, i);
+
+	g_byte_array_unref (buf);
+	return i;
+}
+
+static gboolean
+ip_route_batch (NMPlatform *platform, int addr_family, NMPlatformIPRouteBatchEntry *entries, guint n_entries)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	gs_free IPRouteBatchData *data = NULL;
+	NMPObjectType obj_type;
+	gboolean success = TRUE;
+	gboolean refetched;
+	guint i, i_start, i_end;
+	char s_buf[256];
+
+	nm_assert (NM_IN_SET (addr_family, AF_INET, AF_INET6));
+
+	obj_type = addr_family == AF_INET ? NMP_OBJECT_TYPE_IP4_ROUTE : NMP_OBJECT_TYPE_IP6_ROUTE;
+	data = g_new0 (IPRouteBatchData, n_entries);
+
+	for (i_start = 0; i_start < n_entries; i_start = i_end) {
+		NMPlatformIPRouteBatchEntry *e = &entries[i_start];
+
+		if (_ip_route_batch_entry_send_single (addr_family, e)) {
+			e->success = ip4_route_delete (platform, e->route.rx.ifindex, e->route.r4.network, e->route.rx.plen, 0);
+			if (!e->success)
+				success = FALSE;
+			i_end = i_start + 1;
+			continue;
+		}
+
+		/* Send all requests up to the next one that needs special handling,
+		 * and collect all responses at once. */
+		event_handler_read_netlink (platform, FALSE);
+		i_end = _ip_route_batch_send (platform, addr_family, entries, data, i_start, n_entries);
+		delayed_action_handle_all (platform, FALSE);
+
+		refetched = FALSE;
+		for (i = i_start; i < i_end; i++) {
+			IPRouteBatchData *d = &data[i];
+			const char *log_detail = "";
+			gboolean seq_success;
+			gboolean in_cache;
+
+			e = &entries[i];
+
+			if (e->is_delete)
+				seq_success = _delete_object_result_is_success (&d->obj_id, d->seq_result, &log_detail);
+			else
+				seq_success = (d->seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK);
+
+			_NMLOG (seq_success ? LOGL_DEBUG : LOGL_ERR,
+			        "do-%s-%s[%s]: %s%s (batched)",
+			        e->is_delete ? "delete" : "add",
+			        NMP_OBJECT_GET_CLASS (&d->obj_id)->obj_type_name,
+			        nmp_object_to_string (&d->obj_id, NMP_OBJECT_TO_STRING_ID, NULL, 0),
+			        wait_for_nl_response_to_string (d->seq_result, s_buf, sizeof (s_buf)),
+			        log_detail);
+
+			/* like for do_add_addrroute() and do_delete_object(), the cache
+			 * must agree with the result. Refetch the routes at most once per
+			 * batch, if it doesn't. */
+			in_cache = !!nmp_cache_lookup_obj (priv->cache, &d->obj_id);
+			if (   !refetched
+			    && in_cache == !!e->is_delete
+			    && (e->is_delete || seq_success)) {
+				do_request_one_type (platform, obj_type);
+				refetched = TRUE;
+				in_cache = !!nmp_cache_lookup_obj (priv->cache, &d->obj_id);
+			}
+
+			if (e->is_delete)
+				e->success = !in_cache;
+			else
+				e->success = seq_success && in_cache;
+			if (!e->success)
+				success = FALSE;
+		}
+	}
+
+	return success;
+}
+
+static gboolean
+ip4_default_route_set_multipath (NMPlatform *platform,
+                                 guint32 metric,
+                                 NMIPConfigSource source,
+                                 const NMPlatformIP4Nexthop *nexthops,
+                                 guint n_nexthops)
+{
+	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+	WaitForNlResponseResult seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
+	struct rtmsg rtmsg = {
+		.rtm_family = AF_INET,
+		.rtm_table = RT_TABLE_MAIN,
+		.rtm_type = RTN_UNICAST,
+	};
+	const in_addr_t network = 0;
+	struct nlattr *multipath;
+	char s_buf[256];
+	guint i;
+	int nle;
+
+	if (n_nexthops > 0) {
+		nlmsg = nlmsg_alloc_simple (RTM_NEWROUTE, NLM_F_CREATE | NLM_F_REPLACE);
+		rtmsg.rtm_protocol = nmp_utils_ip_config_source_coerce_to_rtprot (source);
+		rtmsg.rtm_scope = RT_SCOPE_UNIVERSE;
+	} else {
+		nlmsg = nlmsg_alloc_simple (RTM_DELROUTE, 0);
+		rtmsg.rtm_scope = RT_SCOPE_NOWHERE;
+	}
 	if (!nlmsg)
+		g_return_val_if_reached (FALSE);
+
+	if (nlmsg_append (nlmsg, &rtmsg, sizeof (rtmsg), NLMSG_ALIGNTO) < 0)
+		goto nla_put_failure;
+
+	NLA_PUT (nlmsg, RTA_DST, sizeof (network), &network);
+	NLA_PUT_U32 (nlmsg, RTA_PRIORITY, metric);
+
+	if (n_nexthops > 0) {
+		/* the platform cache ignores routes with more than one nexthop,
+		 * so we cannot use do_add_addrroute() which expects the route
+		 * in the cache afterwards. */
+		multipath = nla_nest_start (nlmsg, RTA_MULTIPATH);
+		if (!multipath)
+			goto nla_put_failure;
+
+		for (i = 0; i < n_nexthops; i++) {
+			struct rtnexthop *rtnh;
+
+			rtnh = nlmsg_reserve (nlmsg, sizeof (*rtnh), NLMSG_ALIGNTO);
+			if (!rtnh)
+				goto nla_put_failure;
+
+			rtnh->rtnh_flags = 0;
+			rtnh->rtnh_hops = nexthops[i].weight - 1;
+			rtnh->rtnh_ifindex = nexthops[i].ifindex;
+			if (nexthops[i].gateway)
+				NLA_PUT (nlmsg, RTA_GATEWAY, sizeof (in_addr_t), &nexthops[i].gateway);
+			rtnh->rtnh_len = (char *) nlmsg_tail (nlmsg_hdr (nlmsg)) - (char *) rtnh;
+		}
+
+		nla_nest_end (nlmsg, multipath);
+	}
+
+	event_handler_read_netlink (platform, FALSE);
+
+	nle = _nl_send_auto_with_seq (platform, nlmsg, &seq_result, NULL);
+	if (nle < 0) {
+		_LOGE ("do-%s-multipath-route[%u]: failure sending netlink request \"%s\" (%d)",
+		       n_nexthops ? "add" : "delete", metric, nl_geterror (nle), -nle);
 		return FALSE;
+	}
 
-	nmp_object_stackinit_id_ip6_route (&obj_id, ifindex, &network, plen, metric);
+	delayed_action_handle_all (platform, FALSE);
 
-	return do_delete_object (platform, &obj_id, nlmsg);
+	if (   n_nexthops == 0
+	    && NM_IN_SET (-((int) seq_result), ESRCH, ENOENT))
+		seq_result = WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK;
+
+	_NMLOG (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK
+	            ? LOGL_DEBUG
+	            : LOGL_WARN,
+	        "do-%s-multipath-route[%u]: %s",
+	        n_nexthops ? "add" : "delete", metric,
+	        wait_for_nl_response_to_string (seq_result, s_buf, sizeof (s_buf)));
+
+	return seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK;
+
+nla_put_failure:
+	g_return_val_if_reached (FALSE);
 }
 
 static const NMPlatformIP4Route *
@@ -6161,12 +7641,77 @@ event_handler (GIOChannel *channel,
                GIOCondition io_condition,
                gpointer user_data)
 {
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (user_data);
+	guint64 rx_before = _stats_nlmsg_rx_total (priv);
+
 	delayed_action_handle_all (NM_PLATFORM (user_data), TRUE);
+
+	/* how many messages queued up in the socket between two wakeups. A
+	 * growing batch means the main loop is too busy to keep up. */
+	priv->stats.event_wakeups++;
+	priv->stats.event_batch_max = MAX (priv->stats.event_batch_max,
+	                                   _stats_nlmsg_rx_total (priv) - rx_before);
 	return TRUE;
 }
 
 /*****************************************************************************/
 
+/* the initial receive buffer size for the netlink socket, and the limit
+ * up to which it grows on overruns. */
+#define NL_RCVBUF_SIZE_INIT   (8 * 1024 * 1024)
+#define NL_RCVBUF_SIZE_MAX    (128 * 1024 * 1024)
+
+/* when overruns happen more often than this, grow the buffer faster. */
+#define NL_RESYNC_FREQUENT_NS (60 * NM_UTILS_NS_PER_SECOND)
+
+static gboolean
+_nl_socket_set_rcvbuf_size (NMPlatform *platform, int size)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	int fd = nl_socket_get_fd (priv->nlh);
+	int nle;
+
+	/* SO_RCVBUF is capped by net.core.rmem_max. Try to overrule that
+	 * limit first, which requires CAP_NET_ADMIN. */
+	if (setsockopt (fd, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof (size)) == 0) {
+		priv->nlh_rcvbuf_size = size;
+		return TRUE;
+	}
+
+	nle = nl_socket_set_buffer_size (priv->nlh, size, 0);
+	if (nle < 0) {
+		_LOGW ("netlink: failed to set receive buffer size to %d bytes: %s (%d)",
+		       size, nl_geterror (nle), nle);
+		return FALSE;
+	}
+	priv->nlh_rcvbuf_size = size;
+	return TRUE;
+}
+
+static void
+_nl_socket_handle_overrun (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	gint64 now_ns = nm_utils_get_monotonic_timestamp_ns ();
+	gboolean frequent;
+	int size;
+
+	frequent =    priv->nlh_resync_last_ns
+	           && now_ns - priv->nlh_resync_last_ns < NL_RESYNC_FREQUENT_NS;
+
+	priv->nlh_resync_count++;
+	priv->nlh_resync_last_ns = now_ns;
+
+	if (priv->nlh_rcvbuf_size >= NL_RCVBUF_SIZE_MAX)
+		return;
+
+	/* we lost messages. Grow the receive buffer, faster if that happens
+	 * repeatedly. */
+	size = MIN (priv->nlh_rcvbuf_size * (frequent ? 4 : 2), NL_RCVBUF_SIZE_MAX);
+	if (_nl_socket_set_rcvbuf_size (platform, size))
+		_LOGD ("netlink: increase receive buffer size to %d bytes", size);
+}
+
 /* copied from libnl3's recvmsgs() */
 static int
 event_handler_recvmsgs (NMPlatform *platform, gboolean handle_events)
@@ -6247,15 +7792,6 @@ continue_reading:
 		gboolean process_valid_msg = FALSE;
 		guint32 seq_number;
 
-		msg = nlmsg_convert (hdr);
-		if (!msg) {
-			err = -NLE_NOMEM;
-			goto out;
-		}
-
-		nlmsg_set_proto (msg, NETLINK_ROUTE);
-		nlmsg_set_src (msg, &nla);
-
 		if (!creds || creds->pid) {
 			if (creds)
 				_LOGT ("netlink: recvmsg: received non-kernel message (pid %d)", creds->pid);
@@ -6268,9 +7804,6 @@ continue_reading:
 		_LOGt ("netlink: recvmsg: new message type %d, seq %u",
 		       hdr->nlmsg_type, hdr->nlmsg_seq);
 
-		if (creds)
-			nlmsg_set_creds (msg, creds);
-
 		if (hdr->nlmsg_flags & NLM_F_MULTI)
 			multipart = 1;
 
@@ -6326,14 +7859,14 @@ continue_reading:
 				_LOGD ("netlink: recvmsg: error message from kernel: %s (%d) for request %d",
 				       strerror (errsv),
 				       errsv,
-				       nlmsg_hdr (msg)->nlmsg_seq);
+				       hdr->nlmsg_seq);
 				seq_result = -errsv;
 			} else
 				seq_result = WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK;
 		} else
 			process_valid_msg = TRUE;
 
-		seq_number = nlmsg_hdr (msg)->nlmsg_seq;
+		seq_number = hdr->nlmsg_seq;
 
 		/* check whether the seq number is different from before, and
 		 * whether the previous number (@nlh_seq_last_seen) is a pending
@@ -6349,7 +7882,23 @@ continue_reading:
 			 * get along with broken kernels. NL_SKIP has no
 			 * effect on this.  */
 
-			event_valid_msg (platform, msg, handle_events);
+			_stats_count_nlmsg (priv, hdr->nlmsg_type);
+
+			if (!_nlmsghdr_is_ignored_route (hdr,
+			                                 priv->has_ignored_rtprots ? priv->ignored_rtprots : NULL)) {
+				/* only copy the message, if we are going to parse it. */
+				msg = nlmsg_convert (hdr);
+				if (!msg) {
+					err = -NLE_NOMEM;
+					goto out;
+				}
+
+				nlmsg_set_proto (msg, NETLINK_ROUTE);
+				nlmsg_set_src (msg, &nla);
+				nlmsg_set_creds (msg, creds);
+
+				event_valid_msg (platform, msg, handle_events);
+			}
 
 			seq_result = WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK;
 		}
@@ -6382,6 +7931,47 @@ out:
 
 /*****************************************************************************/
 
+static gboolean
+resync_deferred_cb (gpointer user_data)
+{
+	NMPlatform *platform = NM_PLATFORM (user_data);
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	DelayedActionType flags;
+
+	priv->resync.deferred_id = 0;
+
+	flags = priv->resync.deferred;
+	priv->resync.deferred = DELAYED_ACTION_TYPE_NONE;
+	if (flags) {
+		_LOGD ("netlink: resynchronize the remaining parts of the platform cache");
+		delayed_action_schedule (platform, flags, NULL);
+		delayed_action_handle_all (platform, FALSE);
+	}
+	return G_SOURCE_REMOVE;
+}
+
+static void
+resync_schedule (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	DelayedActionType flags;
+
+	/* netlink doesn't tell us which events were lost. Most likely, they
+	 * are of the same kind as the flood of events that we were just reading,
+	 * so resync those types right away. To stay correct, the remaining types
+	 * are resynced as well, but only once we are idle. */
+	flags = priv->resync.seen & DELAYED_ACTION_TYPE_REFRESH_ALL;
+	if (!flags)
+		flags = DELAYED_ACTION_TYPE_REFRESH_ALL;
+
+	delayed_action_schedule (platform, flags, NULL);
+
+	priv->resync.deferred |= (DELAYED_ACTION_TYPE_REFRESH_ALL & ~flags);
+	if (   priv->resync.deferred
+	    && !priv->resync.deferred_id)
+		priv->resync.deferred_id = g_idle_add (resync_deferred_cb, platform);
+}
+
 static gboolean
 event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
 {
@@ -6410,13 +8000,19 @@ event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
 			if (nle < 0)
 				switch (nle) {
 				case -NLE_AGAIN:
+					priv->resync.seen = DELAYED_ACTION_TYPE_NONE;
 					goto after_read;
 				case -NLE_DUMP_INTR:
 					_LOGD ("netlink: read: uncritical failure to retrieve incoming events: %s (%d)", nl_geterror (nle), nle);
 					break;
 				case -_NLE_MSG_TRUNC:
 				case -_NLE_NM_NOBUFS:
-					_LOGI ("netlink: read: %s. Need to resynchronize platform cache",
+					if (nle == -_NLE_NM_NOBUFS) {
+						priv->stats.enobufs++;
+						_nl_socket_handle_overrun (platform);
+					} else
+						priv->nlh_resync_count++;
+					_LOGI ("netlink: read: %s. Need to resynchronize platform cache (resync #%u)",
 					       ({
 					            const char *_reason = "unknown";
 					            switch (nle) {
@@ -6424,16 +8020,12 @@ event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
 					            case -_NLE_NM_NOBUFS: _reason = "too many netlink events"; break;
 					            }
 					            _reason;
-					       }));
+					       }),
+					       priv->nlh_resync_count);
 					event_handler_recvmsgs (platform, FALSE);
 					delayed_action_wait_for_nl_response_complete_all (platform, WAIT_FOR_NL_RESPONSE_RESULT_FAILED_RESYNC);
-					delayed_action_schedule (platform,
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_LINKS |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ADDRESSES |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ADDRESSES |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES,
-					                         NULL);
+					resync_schedule (platform);
+					priv->resync.seen = DELAYED_ACTION_TYPE_NONE;
 					break;
 				default:
 					_LOGE ("netlink: read: failed to retrieve incoming events: %s (%d)", nl_geterror (nle), nle);
@@ -6515,6 +8107,9 @@ cache_update_link_udev (NMPlatform *platform,
 	gboolean was_visible;
 	NMPCacheOpsType cache_op;
 
+	/* udev has news about some link. Don't risk handing out stale data. */
+	g_clear_pointer (&priv->udev_device_ondemand, udev_device_unref);
+
 	cache_op = nmp_cache_update_link_udev (priv->cache, ifindex, udevice, &obj_cache, &was_visible, cache_pre_hook, platform);
 
 	if (cache_op != NMP_CACHE_OPS_UNCHANGED) {
@@ -6556,6 +8151,9 @@ udev_device_added (NMPlatform *platform,
 		return;
 	}
 
+	if (!_ifindex_filter_accept (platform, ifindex))
+		return;
+
 	_LOGT ("udev-add[%s,%d]: device added", ifname, ifindex);
 	cache_update_link_udev (platform, ifindex, udevice);
 }
@@ -6626,6 +8224,68 @@ handle_udev_event (NMUdevClient *udev_client,
 
 /*****************************************************************************/
 
+static void
+_set_ignored_route_protocols (NMLinuxPlatformPrivate *priv, const char *str)
+{
+	gs_strfreev char **tokens = NULL;
+	char **iter;
+	int rtprot;
+
+	if (!str)
+		return;
+
+	tokens = g_strsplit_set (str, ", ", -1);
+	for (iter = tokens; *iter; iter++) {
+		if (!(*iter)[0])
+			continue;
+
+		rtprot = nmp_utils_rtprot_from_string (*iter);
+		if (rtprot < 0) {
+			nm_log_warn (LOGD_PLATFORM, "platform: unknown route protocol '%s' to ignore", *iter);
+			continue;
+		}
+		if (NM_IN_SET (rtprot, RTPROT_UNSPEC, RTPROT_REDIRECT, RTPROT_KERNEL, RTPROT_BOOT,
+		                       RTPROT_STATIC, RTPROT_RA, RTPROT_DHCP)) {
+			/* NetworkManager adds routes with these protocols and must see them. */
+			nm_log_warn (LOGD_PLATFORM, "platform: cannot ignore routes of protocol '%s'", *iter);
+			continue;
+		}
+
+		priv->ignored_rtprots[rtprot / 32] |= (1u << (rtprot % 32));
+		priv->has_ignored_rtprots = TRUE;
+		nm_log_dbg (LOGD_PLATFORM, "platform: ignore routes of protocol %d", rtprot);
+	}
+}
+
+static void
+set_property (GObject *object, guint prop_id,
+              const GValue *value, GParamSpec *pspec)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (object);
+	const int *ifindexes;
+
+	switch (prop_id) {
+	case PROP_IFINDEXES:
+		/* construct-only */
+		ifindexes = g_value_get_pointer (value);
+		if (ifindexes) {
+			priv->ifindex_filter = g_hash_table_new (NULL, NULL);
+			for (; *ifindexes; ifindexes++) {
+				nm_assert (*ifindexes > 0);
+				g_hash_table_add (priv->ifindex_filter, GINT_TO_POINTER (*ifindexes));
+			}
+		}
+		break;
+	case PROP_IGNORED_ROUTE_PROTOCOLS:
+		/* construct-only */
+		_set_ignored_route_protocols (priv, g_value_get_string (value));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+		break;
+	}
+}
+
 static void
 nm_linux_platform_init (NMLinuxPlatform *self)
 {
@@ -6683,8 +8343,8 @@ constructed (GObject *_object)
 	g_assert (!nle);
 
 	/* use 8 MB for receive socket kernel queue. */
-	nle = nl_socket_set_buffer_size (priv->nlh, 8*1024*1024, 0);
-	g_assert (!nle);
+	if (!_nl_socket_set_rcvbuf_size (platform, NL_RCVBUF_SIZE_INIT))
+		g_assert_not_reached ();
 
 	/* explicitly set the msg buffer size and disable MSG_PEEK.
 	 * If we later encounter NLE_MSG_TRUNC, we will adjust the buffer size. */
@@ -6708,9 +8368,13 @@ constructed (GObject *_object)
 	status = g_io_channel_set_flags (priv->event_channel,
 	                                 channel_flags | G_IO_FLAG_NONBLOCK, NULL);
 	g_assert (status);
-	priv->event_id = g_io_add_watch (priv->event_channel,
-	                                (EVENT_CONDITIONS | ERROR_CONDITIONS | DISCONNECT_CONDITIONS),
-	                                 event_handler, platform);
+	/* netlink events go before D-Bus requests, idle handlers and timeouts
+	 * of the default priority. Otherwise a flood of requests delays reading
+	 * the socket until it overruns and we have to resync the whole cache. */
+	priv->event_id = g_io_add_watch_full (priv->event_channel,
+	                                      G_PRIORITY_HIGH,
+	                                      (EVENT_CONDITIONS | ERROR_CONDITIONS | DISCONNECT_CONDITIONS),
+	                                      event_handler, platform, NULL);
 
 	/* complete construction of the GObject instance before populating the cache. */
 	G_OBJECT_CLASS (nm_linux_platform_parent_class)->constructed (_object);
@@ -6741,13 +8405,21 @@ constructed (GObject *_object)
 		devices = udev_enumerate_get_list_entry (enumerator);
 		for (l = devices; l; l = udev_list_entry_get_next (l)) {
 			struct udev_device *udevice;
+			const NMPObject *obj;
 
 			udevice = udev_device_new_from_syspath (udev_enumerate_get_udev (enumerator),
 			                                        udev_list_entry_get_name (l));
 			if (!udevice)
 				continue;
 
-			udev_device_added (platform, udevice);
+			/* for links that don't need udev data, skip reading the udev
+			 * properties. The cache only records that udev knows the link. */
+			obj = nmp_cache_lookup_link_full (priv->cache, 0, udev_device_get_sysname (udevice),
+			                                  FALSE, NM_LINK_TYPE_NONE, NULL, NULL);
+			if (obj && !nmp_object_link_udev_needed (obj))
+				cache_update_link_udev (platform, obj->link.ifindex, udevice);
+			else
+				udev_device_added (platform, udevice);
 			udev_device_unref (udevice);
 		}
 
@@ -6766,6 +8438,8 @@ dispose (GObject *object)
 	delayed_action_wait_for_nl_response_complete_all (platform, WAIT_FOR_NL_RESPONSE_RESULT_FAILED_DISPOSING);
 
 	priv->delayed_action.flags = DELAYED_ACTION_TYPE_NONE;
+	priv->resync.deferred = DELAYED_ACTION_TYPE_NONE;
+	nm_clear_g_source (&priv->resync.deferred_id);
 	g_ptr_array_set_size (priv->delayed_action.list_master_connected, 0);
 	g_ptr_array_set_size (priv->delayed_action.list_refresh_link, 0);
 
@@ -6795,7 +8469,11 @@ finalize (GObject *object)
 		sysctl_clear_cache_list = g_slist_remove (sysctl_clear_cache_list, object);
 		g_hash_table_destroy (priv->sysctl_get_prev_values);
 	}
+	g_clear_pointer (&priv->sysctl_cache, g_hash_table_unref);
+	g_clear_pointer (&priv->ethtool_cache, g_hash_table_unref);
+	g_clear_pointer (&priv->ifindex_filter, g_hash_table_unref);
 
+	g_clear_pointer (&priv->udev_device_ondemand, udev_device_unref);
 	priv->udev_client = nm_udev_client_unref (priv->udev_client);
 
 	G_OBJECT_CLASS (nm_linux_platform_parent_class)->finalize (object);
@@ -6807,10 +8485,24 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 	GObjectClass *object_class = G_OBJECT_CLASS (klass);
 	NMPlatformClass *platform_class = NM_PLATFORM_CLASS (klass);
 
+	object_class->set_property = set_property;
 	object_class->constructed = constructed;
 	object_class->dispose = dispose;
 	object_class->finalize = finalize;
 
+	obj_properties[PROP_IFINDEXES]
+	    = g_param_spec_pointer (NM_LINUX_PLATFORM_IFINDEXES, "", "",
+	                            G_PARAM_WRITABLE |
+	                            G_PARAM_CONSTRUCT_ONLY |
+	                            G_PARAM_STATIC_STRINGS);
+	obj_properties[PROP_IGNORED_ROUTE_PROTOCOLS]
+	    = g_param_spec_string (NM_LINUX_PLATFORM_IGNORED_ROUTE_PROTOCOLS, "", "",
+	                           NULL,
+	                           G_PARAM_WRITABLE |
+	                           G_PARAM_CONSTRUCT_ONLY |
+	                           G_PARAM_STATIC_STRINGS);
+	g_object_class_install_properties (object_class, _PROPERTY_ENUMS_LAST, obj_properties);
+
 	platform_class->sysctl_set = sysctl_set;
 	platform_class->sysctl_get = sysctl_get;
 
@@ -6826,6 +8518,7 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 	platform_class->link_get_lnk = link_get_lnk;
 
 	platform_class->link_refresh = link_refresh;
+	platform_class->link_refresh_all = link_refresh_all;
 
 	platform_class->link_set_netns = link_set_netns;
 
@@ -6853,12 +8546,15 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 	platform_class->link_supports_vlans = link_supports_vlans;
 
 	platform_class->link_enslave = link_enslave;
+	platform_class->link_enslave_many = link_enslave_many;
 	platform_class->link_release = link_release;
 
 	platform_class->link_can_assume = link_can_assume;
 
 	platform_class->vlan_add = vlan_add;
 	platform_class->link_vlan_change = link_vlan_change;
+	platform_class->link_bridge_change = link_bridge_change;
+	platform_class->link_bridge_port_change = link_bridge_port_change;
 	platform_class->link_vxlan_add = link_vxlan_add;
 
 	platform_class->tun_add = tun_add;
@@ -6876,6 +8572,7 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 	platform_class->wifi_set_powersave = wifi_set_powersave;
 	platform_class->wifi_find_frequency = wifi_find_frequency;
 	platform_class->wifi_indicate_addressing_running = wifi_indicate_addressing_running;
+	platform_class->wifi_watch_events = wifi_watch_events;
 
 	platform_class->mesh_get_channel = mesh_get_channel;
 	platform_class->mesh_set_channel = mesh_set_channel;
@@ -6905,10 +8602,14 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 	platform_class->ip6_route_add = ip6_route_add;
 	platform_class->ip4_route_delete = ip4_route_delete;
 	platform_class->ip6_route_delete = ip6_route_delete;
+	platform_class->ip_route_batch = ip_route_batch;
+	platform_class->ip4_default_route_set_multipath = ip4_default_route_set_multipath;
 
 	platform_class->check_support_kernel_extended_ifa_flags = check_support_kernel_extended_ifa_flags;
 	platform_class->check_support_user_ipv6ll = check_support_user_ipv6ll;
 
 	platform_class->process_events = process_events;
+	platform_class->statistics_foreach = statistics_foreach;
+	platform_class->memory_usage_foreach = memory_usage_foreach;
 }
 
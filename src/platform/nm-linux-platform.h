@@ -30,6 +30,9 @@
 #define NM_IS_LINUX_PLATFORM_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), NM_TYPE_LINUX_PLATFORM))
 #define NM_LINUX_PLATFORM_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), NM_TYPE_LINUX_PLATFORM, NMLinuxPlatformClass))
 
+#define NM_LINUX_PLATFORM_IFINDEXES               "ifindexes"
+#define NM_LINUX_PLATFORM_IGNORED_ROUTE_PROTOCOLS "ignored-route-protocols"
+
 typedef struct _NMLinuxPlatform NMLinuxPlatform;
 typedef struct _NMLinuxPlatformClass NMLinuxPlatformClass;
 
@@ -38,11 +41,20 @@ GType nm_linux_platform_get_type (void);
 NMPlatform *nm_linux_platform_new (gboolean netns_support);
 
 void nm_linux_platform_setup (void);
+void nm_linux_platform_setup_filtered (const int *ifindexes);
+void nm_linux_platform_setup_full (const int *ifindexes,
+                                   const char *ignored_route_protocols);
 
 struct _NMPCacheId;
+struct _NMPCache;
+struct nlmsghdr;
 
 const NMPlatformObject *const *nm_linux_platform_lookup (NMPlatform *platform,
                                                          const struct _NMPCacheId *cache_id,
                                                          guint *out_len);
 
+NMPObject *nm_linux_platform_object_new_from_nlmsg (const struct _NMPCache *cache,
+                                                    struct nlmsghdr *nlh,
+                                                    gboolean id_only);
+
 #endif /* __NETWORKMANAGER_LINUX_PLATFORM_H__ */
@@ -38,6 +38,7 @@
 #include "nm-setting-wired.h"
 
 #include "nm-core-utils.h"
+#include "nmp-netns.h"
 
 /******************************************************************
  * utils
@@ -63,21 +64,65 @@ nmp_utils_if_nametoindex (const char *ifname)
 	return if_nametoindex (ifname);
 }
 
+/* Get a socket for ioctl() calls in @netns, or in the current namespace
+ * if @netns is %NULL. In the latter case, a new socket is created and
+ * returned in @out_fd_free too, and the caller must close it. */
+static int
+_ioctl_fd_get (NMPNetns *netns, int *out_fd_free)
+{
+	nm_assert (out_fd_free && *out_fd_free < 0);
+
+	if (netns)
+		return nmp_netns_get_fd_ioctl (netns);
+
+	*out_fd_free = socket (PF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	return *out_fd_free;
+}
+
+/* Like if_indextoname(), but resolves the name in the namespace of
+ * @fd_ioctl, which must be a socket from _ioctl_fd_get(). */
+static const char *
+_ioctl_indextoname (int fd_ioctl, int ifindex, char *out_ifname/*IFNAMSIZ*/)
+{
+	struct ifreq ifr = {
+		.ifr_ifindex = ifindex,
+	};
+
+	if (ioctl (fd_ioctl, SIOCGIFNAME, &ifr) < 0)
+		return NULL;
+
+	memcpy (out_ifname, ifr.ifr_name, IFNAMSIZ);
+	out_ifname[IFNAMSIZ - 1] = '\0';
+	return out_ifname;
+}
+
 /******************************************************************
  * ethtool
  ******************************************************************/
 
 NM_UTILS_ENUM2STR_DEFINE_STATIC (_ethtool_cmd_to_string, guint32,
+	NM_UTILS_ENUM2STR (ETHTOOL_GCHANNELS,  "ETHTOOL_GCHANNELS"),
+	NM_UTILS_ENUM2STR (ETHTOOL_GCOALESCE,  "ETHTOOL_GCOALESCE"),
 	NM_UTILS_ENUM2STR (ETHTOOL_GDRVINFO,   "ETHTOOL_GDRVINFO"),
 	NM_UTILS_ENUM2STR (ETHTOOL_GFEATURES,  "ETHTOOL_GFEATURES"),
+	NM_UTILS_ENUM2STR (ETHTOOL_GFLAGS,     "ETHTOOL_GFLAGS"),
+	NM_UTILS_ENUM2STR (ETHTOOL_GGRO,       "ETHTOOL_GGRO"),
 	NM_UTILS_ENUM2STR (ETHTOOL_GLINK,      "ETHTOOL_GLINK"),
 	NM_UTILS_ENUM2STR (ETHTOOL_GPERMADDR,  "ETHTOOL_GPERMADDR"),
+	NM_UTILS_ENUM2STR (ETHTOOL_GRINGPARAM, "ETHTOOL_GRINGPARAM"),
 	NM_UTILS_ENUM2STR (ETHTOOL_GSET,       "ETHTOOL_GSET"),
 	NM_UTILS_ENUM2STR (ETHTOOL_GSSET_INFO, "ETHTOOL_GSSET_INFO"),
 	NM_UTILS_ENUM2STR (ETHTOOL_GSTATS,     "ETHTOOL_GSTATS"),
 	NM_UTILS_ENUM2STR (ETHTOOL_GSTRINGS,   "ETHTOOL_GSTRINGS"),
+	NM_UTILS_ENUM2STR (ETHTOOL_GTSO,       "ETHTOOL_GTSO"),
 	NM_UTILS_ENUM2STR (ETHTOOL_GWOL,       "ETHTOOL_GWOL"),
+	NM_UTILS_ENUM2STR (ETHTOOL_SCHANNELS,  "ETHTOOL_SCHANNELS"),
+	NM_UTILS_ENUM2STR (ETHTOOL_SCOALESCE,  "ETHTOOL_SCOALESCE"),
+	NM_UTILS_ENUM2STR (ETHTOOL_SFLAGS,     "ETHTOOL_SFLAGS"),
+	NM_UTILS_ENUM2STR (ETHTOOL_SGRO,       "ETHTOOL_SGRO"),
+	NM_UTILS_ENUM2STR (ETHTOOL_SRINGPARAM, "ETHTOOL_SRINGPARAM"),
 	NM_UTILS_ENUM2STR (ETHTOOL_SSET,       "ETHTOOL_SSET"),
+	NM_UTILS_ENUM2STR (ETHTOOL_STSO,       "ETHTOOL_STSO"),
 	NM_UTILS_ENUM2STR (ETHTOOL_SWOL,       "ETHTOOL_SWOL"),
 );
 
@@ -95,13 +140,27 @@ _ethtool_data_to_string (gconstpointer edata, char *buf, gsize len)
 #endif
 
 static gboolean
-ethtool_get (int ifindex, gpointer edata)
+ethtool_get (NMPNetns *netns, int ifindex, gpointer edata)
 {
+	nm_auto_close int fd_free = -1;
 	char ifname[IFNAMSIZ];
 	char sbuf[50];
+	struct ifreq ifr = {
+		.ifr_data = edata,
+	};
+	int fd;
 
 	nm_assert (ifindex > 0);
 
+	fd = _ioctl_fd_get (netns, &fd_free);
+	if (fd < 0) {
+		nm_log_trace (LOGD_PLATFORM, "ethtool[%d]: %s: failed creating socket for ioctl: %s",
+		              ifindex,
+		              _ethtool_data_to_string (edata, sbuf, sizeof (sbuf)),
+		              g_strerror (errno));
+		return FALSE;
+	}
+
 	/* ethtool ioctl API uses the ifname to refer to an interface. That is racy
 	 * as interfaces can be renamed *sigh*.
 	 *
@@ -114,7 +173,7 @@ ethtool_get (int ifindex, gpointer edata)
 	 * This does not solve the renaming race, but it minimizes the time for
 	 * the race to happen as much as possible. */
 
-	if (!nmp_utils_if_indextoname (ifindex, ifname)) {
+	if (!_ioctl_indextoname (fd, ifindex, ifname)) {
 		nm_log_trace (LOGD_PLATFORM, "ethtool[%d]: %s: request fails resolving ifindex: %s",
 		              ifindex,
 		              _ethtool_data_to_string (edata, sbuf, sizeof (sbuf)),
@@ -122,43 +181,26 @@ ethtool_get (int ifindex, gpointer edata)
 		return FALSE;
 	}
 
-	{
-		nm_auto_close int fd = -1;
-		struct ifreq ifr = {
-			.ifr_data = edata,
-		};
-
-		memcpy (ifr.ifr_name, ifname, sizeof (ifname));
-
-		fd = socket (PF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
-		if (fd < 0) {
-			nm_log_trace (LOGD_PLATFORM, "ethtool[%d]: %s, %s: failed creating socket for ioctl: %s",
-			              ifindex,
-			              _ethtool_data_to_string (edata, sbuf, sizeof (sbuf)),
-			              ifname,
-			              g_strerror (errno));
-			return FALSE;
-		}
+	memcpy (ifr.ifr_name, ifname, sizeof (ifname));
 
-		if (ioctl (fd, SIOCETHTOOL, &ifr) < 0) {
-			nm_log_trace (LOGD_PLATFORM, "ethtool[%d]: %s, %s: failed: %s",
-			              ifindex,
-			              _ethtool_data_to_string (edata, sbuf, sizeof (sbuf)),
-			              ifname,
-			              strerror (errno));
-			return FALSE;
-		}
-
-		nm_log_trace (LOGD_PLATFORM, "ethtool[%d]: %s, %s: success",
+	if (ioctl (fd, SIOCETHTOOL, &ifr) < 0) {
+		nm_log_trace (LOGD_PLATFORM, "ethtool[%d]: %s, %s: failed: %s",
 		              ifindex,
 		              _ethtool_data_to_string (edata, sbuf, sizeof (sbuf)),
-		              ifname);
-		return TRUE;
+		              ifname,
+		              strerror (errno));
+		return FALSE;
 	}
+
+	nm_log_trace (LOGD_PLATFORM, "ethtool[%d]: %s, %s: success",
+	              ifindex,
+	              _ethtool_data_to_string (edata, sbuf, sizeof (sbuf)),
+	              ifname);
+	return TRUE;
 }
 
 static int
-ethtool_get_stringset_index (int ifindex, int stringset_id, const char *string)
+ethtool_get_stringset_index (NMPNetns *netns, int ifindex, int stringset_id, const char *string)
 {
 	gs_free struct ethtool_sset_info *info = NULL;
 	gs_free struct ethtool_gstrings *strings = NULL;
@@ -171,7 +213,7 @@ ethtool_get_stringset_index (int ifindex, int stringset_id, const char *string)
 	info->reserved = 0;
 	info->sset_mask = 1ULL << stringset_id;
 
-	if (!ethtool_get (ifindex, info))
+	if (!ethtool_get (netns, ifindex, info))
 		return -1;
 	if (!info->sset_mask)
 		return -1;
@@ -182,7 +224,7 @@ ethtool_get_stringset_index (int ifindex, int stringset_id, const char *string)
 	strings->cmd = ETHTOOL_GSTRINGS;
 	strings->string_set = stringset_id;
 	strings->len = len;
-	if (!ethtool_get (ifindex, strings))
+	if (!ethtool_get (netns, ifindex, strings))
 		return -1;
 
 	for (i = 0; i < len; i++) {
@@ -194,7 +236,8 @@ ethtool_get_stringset_index (int ifindex, int stringset_id, const char *string)
 }
 
 gboolean
-nmp_utils_ethtool_get_driver_info (int ifindex,
+nmp_utils_ethtool_get_driver_info (NMPNetns *netns,
+                                   int ifindex,
                                    NMPUtilsEthtoolDriverInfo *data)
 {
 	struct ethtool_drvinfo *drvinfo;
@@ -213,11 +256,12 @@ nmp_utils_ethtool_get_driver_info (int ifindex,
 
 	memset (drvinfo, 0, sizeof (*drvinfo));
 	drvinfo->cmd = ETHTOOL_GDRVINFO;
-	return ethtool_get (ifindex, drvinfo);
+	return ethtool_get (netns, ifindex, drvinfo);
 }
 
 gboolean
-nmp_utils_ethtool_get_permanent_address (int ifindex,
+nmp_utils_ethtool_get_permanent_address (NMPNetns *netns,
+                                         int ifindex,
                                          guint8 *buf,
                                          size_t *length)
 {
@@ -233,7 +277,7 @@ nmp_utils_ethtool_get_permanent_address (int ifindex,
 	edata.e.cmd = ETHTOOL_GPERMADDR;
 	edata.e.size = NM_UTILS_HWADDR_LEN_MAX;
 
-	if (!ethtool_get (ifindex, &edata.e))
+	if (!ethtool_get (netns, ifindex, &edata.e))
 		return FALSE;
 
 	if (edata.e.size > NM_UTILS_HWADDR_LEN_MAX)
@@ -260,7 +304,8 @@ not_all_0or1:
 }
 
 gboolean
-nmp_utils_ethtool_supports_carrier_detect (int ifindex)
+nmp_utils_ethtool_supports_carrier_detect (NMPNetns *netns,
+                                           int ifindex)
 {
 	struct ethtool_cmd edata = { .cmd = ETHTOOL_GLINK };
 
@@ -270,18 +315,19 @@ nmp_utils_ethtool_supports_carrier_detect (int ifindex)
 	 * assume the device supports carrier-detect, otherwise we assume it
 	 * doesn't.
 	 */
-	return ethtool_get (ifindex, &edata);
+	return ethtool_get (netns, ifindex, &edata);
 }
 
 gboolean
-nmp_utils_ethtool_supports_vlans (int ifindex)
+nmp_utils_ethtool_supports_vlans (NMPNetns *netns,
+                                  int ifindex)
 {
 	gs_free struct ethtool_gfeatures *features = NULL;
 	int idx, block, bit, size;
 
 	g_return_val_if_fail (ifindex > 0, FALSE);
 
-	idx = ethtool_get_stringset_index (ifindex, ETH_SS_FEATURES, "vlan-challenged");
+	idx = ethtool_get_stringset_index (netns, ifindex, ETH_SS_FEATURES, "vlan-challenged");
 	if (idx == -1) {
 		nm_log_dbg (LOGD_PLATFORM, "ethtool: vlan-challenged ethtool feature does not exist for %d?", ifindex);
 		return FALSE;
@@ -295,21 +341,22 @@ nmp_utils_ethtool_supports_vlans (int ifindex)
 	features->cmd = ETHTOOL_GFEATURES;
 	features->size = size;
 
-	if (!ethtool_get (ifindex, features))
+	if (!ethtool_get (netns, ifindex, features))
 		return FALSE;
 
 	return !(features->features[block].active & (1 << bit));
 }
 
 int
-nmp_utils_ethtool_get_peer_ifindex (int ifindex)
+nmp_utils_ethtool_get_peer_ifindex (NMPNetns *netns,
+                                    int ifindex)
 {
 	gs_free struct ethtool_stats *stats = NULL;
 	int peer_ifindex_stat;
 
 	g_return_val_if_fail (ifindex > 0, 0);
 
-	peer_ifindex_stat = ethtool_get_stringset_index (ifindex, ETH_SS_STATS, "peer_ifindex");
+	peer_ifindex_stat = ethtool_get_stringset_index (netns, ifindex, ETH_SS_STATS, "peer_ifindex");
 	if (peer_ifindex_stat == -1) {
 		nm_log_dbg (LOGD_PLATFORM, "ethtool: peer_ifindex stat for %d does not exist?", ifindex);
 		return FALSE;
@@ -318,14 +365,15 @@ nmp_utils_ethtool_get_peer_ifindex (int ifindex)
 	stats = g_malloc0 (sizeof (*stats) + (peer_ifindex_stat + 1) * sizeof (guint64));
 	stats->cmd = ETHTOOL_GSTATS;
 	stats->n_stats = peer_ifindex_stat + 1;
-	if (!ethtool_get (ifindex, stats))
+	if (!ethtool_get (netns, ifindex, stats))
 		return 0;
 
 	return stats->data[peer_ifindex_stat];
 }
 
 gboolean
-nmp_utils_ethtool_get_wake_on_lan (int ifindex)
+nmp_utils_ethtool_get_wake_on_lan (NMPNetns *netns,
+                                   int ifindex)
 {
 	struct ethtool_wolinfo wol;
 
@@ -333,14 +381,15 @@ nmp_utils_ethtool_get_wake_on_lan (int ifindex)
 
 	memset (&wol, 0, sizeof (wol));
 	wol.cmd = ETHTOOL_GWOL;
-	if (!ethtool_get (ifindex, &wol))
+	if (!ethtool_get (netns, ifindex, &wol))
 		return FALSE;
 
 	return wol.wolopts != 0;
 }
 
 gboolean
-nmp_utils_ethtool_get_link_settings (int ifindex,
+nmp_utils_ethtool_get_link_settings (NMPNetns *netns,
+                                     int ifindex,
                                      gboolean *out_autoneg,
                                      guint32 *out_speed,
                                      NMPlatformLinkDuplexType *out_duplex)
@@ -351,7 +400,7 @@ nmp_utils_ethtool_get_link_settings (int ifindex,
 
 	g_return_val_if_fail (ifindex > 0, FALSE);
 
-	if (!ethtool_get (ifindex, &edata))
+	if (!ethtool_get (netns, ifindex, &edata))
 		return FALSE;
 
 	if (out_autoneg)
@@ -385,7 +434,8 @@ nmp_utils_ethtool_get_link_settings (int ifindex,
 }
 
 gboolean
-nmp_utils_ethtool_set_link_settings (int ifindex,
+nmp_utils_ethtool_set_link_settings (NMPNetns *netns,
+                                     int ifindex,
                                      gboolean autoneg,
                                      guint32 speed,
                                      NMPlatformLinkDuplexType duplex)
@@ -397,7 +447,7 @@ nmp_utils_ethtool_set_link_settings (int ifindex,
 	g_return_val_if_fail (ifindex > 0, FALSE);
 
 	/* retrieve first current settings */
-	if (!ethtool_get (ifindex, &edata))
+	if (!ethtool_get (netns, ifindex, &edata))
 		return FALSE;
 
 	/* then change the needed ones */
@@ -425,11 +475,164 @@ nmp_utils_ethtool_set_link_settings (int ifindex,
 		}
 	}
 
-	return ethtool_get (ifindex, &edata);
+	return ethtool_get (netns, ifindex, &edata);
+}
+
+/* The following setters share the approach of
+ * nmp_utils_ethtool_set_link_settings(): fetch the current parameters first
+ * and only change the requested ones. A request that matches the current
+ * value is not sent to the driver, as many drivers reset the link when
+ * rings or channels are reconfigured. */
+
+gboolean
+nmp_utils_ethtool_set_ring (NMPNetns *netns,
+                            int ifindex,
+                            guint32 rx_pending,
+                            guint32 tx_pending)
+{
+	struct ethtool_ringparam edata = {
+		.cmd = ETHTOOL_GRINGPARAM,
+	};
+
+	g_return_val_if_fail (ifindex > 0, FALSE);
+
+	if (!rx_pending && !tx_pending)
+		return TRUE;
+
+	if (!ethtool_get (netns, ifindex, &edata))
+		return FALSE;
+
+	if (   (!rx_pending || edata.rx_pending == rx_pending)
+	    && (!tx_pending || edata.tx_pending == tx_pending))
+		return TRUE;
+
+	edata.cmd = ETHTOOL_SRINGPARAM;
+	if (rx_pending)
+		edata.rx_pending = rx_pending;
+	if (tx_pending)
+		edata.tx_pending = tx_pending;
+
+	return ethtool_get (netns, ifindex, &edata);
 }
 
 gboolean
-nmp_utils_ethtool_set_wake_on_lan (int ifindex,
+nmp_utils_ethtool_set_channels (NMPNetns *netns,
+                                int ifindex,
+                                guint32 combined_count)
+{
+	struct ethtool_channels edata = {
+		.cmd = ETHTOOL_GCHANNELS,
+	};
+
+	g_return_val_if_fail (ifindex > 0, FALSE);
+
+	if (!combined_count)
+		return TRUE;
+
+	if (!ethtool_get (netns, ifindex, &edata))
+		return FALSE;
+
+	if (edata.combined_count == combined_count)
+		return TRUE;
+
+	edata.cmd = ETHTOOL_SCHANNELS;
+	edata.combined_count = combined_count;
+
+	return ethtool_get (netns, ifindex, &edata);
+}
+
+gboolean
+nmp_utils_ethtool_set_coalesce (NMPNetns *netns,
+                                int ifindex,
+                                gint32 rx_usecs,
+                                gint32 tx_usecs)
+{
+	struct ethtool_coalesce edata = {
+		.cmd = ETHTOOL_GCOALESCE,
+	};
+
+	g_return_val_if_fail (ifindex > 0, FALSE);
+
+	if (rx_usecs < 0 && tx_usecs < 0)
+		return TRUE;
+
+	if (!ethtool_get (netns, ifindex, &edata))
+		return FALSE;
+
+	if (   (rx_usecs < 0 || edata.rx_coalesce_usecs == (guint32) rx_usecs)
+	    && (tx_usecs < 0 || edata.tx_coalesce_usecs == (guint32) tx_usecs))
+		return TRUE;
+
+	edata.cmd = ETHTOOL_SCOALESCE;
+	if (rx_usecs >= 0)
+		edata.rx_coalesce_usecs = rx_usecs;
+	if (tx_usecs >= 0)
+		edata.tx_coalesce_usecs = tx_usecs;
+
+	return ethtool_get (netns, ifindex, &edata);
+}
+
+static gboolean
+ethtool_set_value (NMPNetns *netns, int ifindex, guint32 get_cmd, guint32 set_cmd, int enabled)
+{
+	struct ethtool_value edata = {
+		.cmd = get_cmd,
+	};
+
+	if (enabled < 0)
+		return TRUE;
+
+	if (!ethtool_get (netns, ifindex, &edata))
+		return FALSE;
+
+	if (!!edata.data == !!enabled)
+		return TRUE;
+
+	edata.cmd = set_cmd;
+	edata.data = !!enabled;
+	return ethtool_get (netns, ifindex, &edata);
+}
+
+gboolean
+nmp_utils_ethtool_set_offloads (NMPNetns *netns,
+                                int ifindex,
+                                int gro,
+                                int tso,
+                                int lro)
+{
+	struct ethtool_value edata = {
+		.cmd = ETHTOOL_GFLAGS,
+	};
+	gboolean success = TRUE;
+
+	g_return_val_if_fail (ifindex > 0, FALSE);
+
+	if (!ethtool_set_value (netns, ifindex, ETHTOOL_GGRO, ETHTOOL_SGRO, gro))
+		success = FALSE;
+	if (!ethtool_set_value (netns, ifindex, ETHTOOL_GTSO, ETHTOOL_STSO, tso))
+		success = FALSE;
+
+	/* LRO has no dedicated command, it is a bit in the device flags. */
+	if (lro >= 0) {
+		if (!ethtool_get (netns, ifindex, &edata))
+			return FALSE;
+		if (NM_FLAGS_HAS (edata.data, ETH_FLAG_LRO) != !!lro) {
+			edata.cmd = ETHTOOL_SFLAGS;
+			if (lro)
+				edata.data |= ETH_FLAG_LRO;
+			else
+				edata.data &= ~ETH_FLAG_LRO;
+			if (!ethtool_get (netns, ifindex, &edata))
+				success = FALSE;
+		}
+	}
+
+	return success;
+}
+
+gboolean
+nmp_utils_ethtool_set_wake_on_lan (NMPNetns *netns,
+                                   int ifindex,
                                    NMSettingWiredWakeOnLan wol,
                                    const char *wol_password)
 {
@@ -467,7 +670,7 @@ nmp_utils_ethtool_set_wake_on_lan (int ifindex,
 		wol_info.wolopts |= WAKE_MAGICSECURE;
 	}
 
-	return ethtool_get (ifindex, &wol_info);
+	return ethtool_get (netns, ifindex, &wol_info);
 }
 
 /******************************************************************
@@ -475,23 +678,24 @@ nmp_utils_ethtool_set_wake_on_lan (int ifindex,
  ******************************************************************/
 
 gboolean
-nmp_utils_mii_supports_carrier_detect (int ifindex)
+nmp_utils_mii_supports_carrier_detect (NMPNetns *netns, int ifindex)
 {
 	char ifname[IFNAMSIZ];
-	nm_auto_close int fd = -1;
+	nm_auto_close int fd_free = -1;
+	int fd;
 	struct ifreq ifr;
 	struct mii_ioctl_data *mii;
 
 	g_return_val_if_fail (ifindex > 0, FALSE);
 
-	if (!nmp_utils_if_indextoname (ifindex, ifname)) {
-		nm_log_trace (LOGD_PLATFORM, "mii[%d]: carrier-detect no: request fails resolving ifindex: %s", ifindex, g_strerror (errno));
+	fd = _ioctl_fd_get (netns, &fd_free);
+	if (fd < 0) {
+		nm_log_trace (LOGD_PLATFORM, "mii[%d]: carrier-detect no: couldn't open control socket: %s", ifindex, g_strerror (errno));
 		return FALSE;
 	}
 
-	fd = socket (PF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
-	if (fd < 0) {
-		nm_log_trace (LOGD_PLATFORM, "mii[%d,%s]: carrier-detect no: couldn't open control socket: %s", ifindex, ifname, g_strerror (errno));
+	if (!_ioctl_indextoname (fd, ifindex, ifname)) {
+		nm_log_trace (LOGD_PLATFORM, "mii[%d]: carrier-detect no: request fails resolving ifindex: %s", ifindex, g_strerror (errno));
 		return FALSE;
 	}
 
@@ -633,6 +837,55 @@ nmp_utils_ip_config_source_coerce_from_rtprot (NMIPConfigSource source)
 	}
 }
 
+/**
+ * nmp_utils_rtprot_from_string:
+ * @str: the name of a route protocol, as in /etc/iproute2/rt_protos,
+ *   or its number.
+ *
+ * Returns: the rtm_protocol value or -1 if @str is not a known protocol.
+ */
+int
+nmp_utils_rtprot_from_string (const char *str)
+{
+	static const struct {
+		const char *name;
+		guint8 rtprot;
+	} names[] = {
+		{ "unspec",   RTPROT_UNSPEC },
+		{ "redirect", RTPROT_REDIRECT },
+		{ "kernel",   RTPROT_KERNEL },
+		{ "boot",     RTPROT_BOOT },
+		{ "static",   RTPROT_STATIC },
+		{ "gated",    8 },
+		{ "ra",       RTPROT_RA },
+		{ "mrt",      10 },
+		{ "zebra",    11 },
+		{ "bird",     12 },
+		{ "dnrouted", 13 },
+		{ "xorp",     14 },
+		{ "ntk",      15 },
+		{ "dhcp",     RTPROT_DHCP },
+		{ "mrouted",  17 },
+		{ "babel",    42 },
+		{ "bgp",      186 },
+		{ "isis",     187 },
+		{ "ospf",     188 },
+		{ "rip",      189 },
+		{ "eigrp",    192 },
+	};
+	guint i;
+
+	if (!str || !str[0])
+		return -1;
+
+	for (i = 0; i < G_N_ELEMENTS (names); i++) {
+		if (g_ascii_strcasecmp (str, names[i].name) == 0)
+			return names[i].rtprot;
+	}
+
+	return _nm_utils_ascii_str_to_int64 (str, 10, 0, 255, -1);
+}
+
 const char *
 nmp_utils_ip_config_source_to_string (NMIPConfigSource source, char *buf, gsize len)
 {
@@ -682,6 +935,9 @@ nmp_utils_ip_config_source_to_string (NMIPConfigSource source, char *buf, gsize
 
 /**
  * nmp_utils_sysctl_open_netdir:
+ * @netns: (allow-none): the namespace of @ifindex. If given, the directory
+ *   is opened relative to the sysfs of @netns, without switching into it.
+ *   Otherwise, the current namespace is used.
  * @ifindex: the ifindex for which to open "/sys/class/net/%s"
  * @ifname_guess: (allow-none): optional argument, if present used as initial
  *   guess as the current name for @ifindex. If guessed right,
@@ -694,7 +950,8 @@ nmp_utils_ip_config_source_to_string (NMIPConfigSource source, char *buf, gsize
  *   to the "/sys/class/net/%s" directory for @ifindex.
  */
 int
-nmp_utils_sysctl_open_netdir (int ifindex,
+nmp_utils_sysctl_open_netdir (NMPNetns *netns,
+                              int ifindex,
                               const char *ifname_guess,
                               char *out_ifname)
 {
@@ -706,9 +963,18 @@ nmp_utils_sysctl_open_netdir (int ifindex,
 	char sysdir[NM_STRLEN (SYS_CLASS_NET) + IFNAMSIZ] = SYS_CLASS_NET;
 	char fd_buf[256];
 	ssize_t nn;
+	int fd_sysfs_net = -1;
+	int fd_ioctl = -1;
 
 	g_return_val_if_fail (ifindex >= 0, -1);
 
+	if (netns) {
+		fd_sysfs_net = nmp_netns_get_fd_sysfs_net (netns);
+		fd_ioctl = nmp_netns_get_fd_ioctl (netns);
+		if (fd_sysfs_net < 0 || fd_ioctl < 0)
+			return -1;
+	}
+
 	ifname_buf_last_try[0] = '\0';
 
 	for (try_count = 0; try_count < 10; try_count++, ifname = NULL) {
@@ -717,7 +983,9 @@ nmp_utils_sysctl_open_netdir (int ifindex,
 		int fd;
 
 		if (!ifname) {
-			ifname = nmp_utils_if_indextoname (ifindex, ifname_buf);
+			ifname = netns
+			         ? _ioctl_indextoname (fd_ioctl, ifindex, ifname_buf)
+			         : nmp_utils_if_indextoname (ifindex, ifname_buf);
 			if (!ifname)
 				return -1;
 		}
@@ -734,7 +1002,10 @@ nmp_utils_sysctl_open_netdir (int ifindex,
 			return -1;
 		strcpy (ifname_buf_last_try, ifname);
 
-		fd_dir = open (sysdir, O_DIRECTORY | O_CLOEXEC);
+		if (netns)
+			fd_dir = openat (fd_sysfs_net, ifname, O_DIRECTORY | O_CLOEXEC);
+		else
+			fd_dir = open (sysdir, O_DIRECTORY | O_CLOEXEC);
 		if (fd_dir < 0)
 			continue;
 
@@ -26,15 +26,20 @@
 
 
 const char *nmp_utils_ethtool_get_driver (int ifindex);
-gboolean nmp_utils_ethtool_supports_carrier_detect (int ifindex);
-gboolean nmp_utils_ethtool_supports_vlans (int ifindex);
-int nmp_utils_ethtool_get_peer_ifindex (int ifindex);
-gboolean nmp_utils_ethtool_get_wake_on_lan (int ifindex);
-gboolean nmp_utils_ethtool_set_wake_on_lan (int ifindex, NMSettingWiredWakeOnLan wol,
+gboolean nmp_utils_ethtool_supports_carrier_detect (NMPNetns *netns, int ifindex);
+gboolean nmp_utils_ethtool_supports_vlans (NMPNetns *netns, int ifindex);
+int nmp_utils_ethtool_get_peer_ifindex (NMPNetns *netns, int ifindex);
+gboolean nmp_utils_ethtool_get_wake_on_lan (NMPNetns *netns, int ifindex);
+gboolean nmp_utils_ethtool_set_wake_on_lan (NMPNetns *netns, int ifindex, NMSettingWiredWakeOnLan wol,
                                             const char *wol_password);
 
-gboolean nmp_utils_ethtool_get_link_settings (int ifindex, gboolean *out_autoneg, guint32 *out_speed, NMPlatformLinkDuplexType *out_duplex);
-gboolean nmp_utils_ethtool_set_link_settings (int ifindex, gboolean autoneg, guint32 speed, NMPlatformLinkDuplexType duplex);
+gboolean nmp_utils_ethtool_get_link_settings (NMPNetns *netns, int ifindex, gboolean *out_autoneg, guint32 *out_speed, NMPlatformLinkDuplexType *out_duplex);
+gboolean nmp_utils_ethtool_set_link_settings (NMPNetns *netns, int ifindex, gboolean autoneg, guint32 speed, NMPlatformLinkDuplexType duplex);
+
+gboolean nmp_utils_ethtool_set_ring (NMPNetns *netns, int ifindex, guint32 rx_pending, guint32 tx_pending);
+gboolean nmp_utils_ethtool_set_channels (NMPNetns *netns, int ifindex, guint32 combined_count);
+gboolean nmp_utils_ethtool_set_coalesce (NMPNetns *netns, int ifindex, gint32 rx_usecs, gint32 tx_usecs);
+gboolean nmp_utils_ethtool_set_offloads (NMPNetns *netns, int ifindex, int gro, int tso, int lro);
 
 typedef struct {
 	/* We don't want to include <linux/ethtool.h> in header files,
@@ -53,15 +58,17 @@ typedef struct {
 	guint32 _private_regdump_len;
 } NMPUtilsEthtoolDriverInfo;
 
-gboolean nmp_utils_ethtool_get_driver_info (int ifindex,
+gboolean nmp_utils_ethtool_get_driver_info (NMPNetns *netns,
+                                            int ifindex,
                                             NMPUtilsEthtoolDriverInfo *data);
 
-gboolean  nmp_utils_ethtool_get_permanent_address (int ifindex,
+gboolean  nmp_utils_ethtool_get_permanent_address (NMPNetns *netns,
+                                                   int ifindex,
                                                    guint8 *buf,
                                                    size_t *length);
 
 
-gboolean nmp_utils_mii_supports_carrier_detect (int ifindex);
+gboolean nmp_utils_mii_supports_carrier_detect (NMPNetns *netns, int ifindex);
 
 
 struct udev_device;
@@ -74,10 +81,13 @@ NMIPConfigSource nmp_utils_ip_config_source_coerce_from_rtprot (NMIPConfigSource
 NMIPConfigSource nmp_utils_ip_config_source_round_trip_rtprot  (NMIPConfigSource source) _nm_const;
 const char *     nmp_utils_ip_config_source_to_string (NMIPConfigSource source, char *buf, gsize len);
 
+int nmp_utils_rtprot_from_string (const char *str);
+
 const char *nmp_utils_if_indextoname (int ifindex, char *out_ifname/*IFNAMSIZ*/);
 int nmp_utils_if_nametoindex (const char *ifname);
 
-int nmp_utils_sysctl_open_netdir (int ifindex,
+int nmp_utils_sysctl_open_netdir (NMPNetns *netns,
+                                  int ifindex,
                                   const char *ifname_guess,
                                   char *out_ifname);
 
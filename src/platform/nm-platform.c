@@ -25,6 +25,8 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <string.h>
@@ -79,6 +81,7 @@ G_STATIC_ASSERT (G_STRUCT_OFFSET (NMPlatformIPRoute, network_ptr) == G_STRUCT_OF
 /*****************************************************************************/
 
 static guint signals[_NM_PLATFORM_SIGNAL_ID_LAST] = { 0 };
+static guint signal_changes = 0;
 
 enum {
 	PROP_0,
@@ -89,6 +92,17 @@ enum {
 
 typedef struct _NMPlatformPrivate {
 	bool register_singleton:1;
+
+	/* the changes collected for the next "changes" signal. */
+	GArray *changes;
+	guint changes_obj_types;
+	guint changes_freeze_count;
+
+	/* ifindex => ChangesStamps, the stamp of the last change per object type. */
+	GHashTable *changes_stamps;
+	guint64 changes_stamp_init;
+
+	guint64 counters[_NM_PLATFORM_COUNTER_NUM];
 } NMPlatformPrivate;
 
 G_DEFINE_TYPE (NMPlatform, nm_platform, G_TYPE_OBJECT)
@@ -263,6 +277,82 @@ nm_platform_process_events (NMPlatform *self)
 		klass->process_events (self);
 }
 
+/**
+ * nm_platform_statistics_foreach:
+ * @self: platform instance
+ * @func: called for each counter
+ * @user_data: user data for @func
+ *
+ * Reports the internal counters of the platform, like the number of
+ * netlink messages received. The set of counters depends on the platform
+ * implementation, followed by the counters added via
+ * nm_platform_counter_add().
+ */
+void
+nm_platform_statistics_foreach (NMPlatform *self,
+                                NMPlatformStatisticsFunc func,
+                                gpointer user_data)
+{
+	NMPlatformPrivate *priv;
+
+	_CHECK_SELF_VOID (self, klass);
+
+	g_return_if_fail (func);
+
+	if (klass->statistics_foreach)
+		klass->statistics_foreach (self, func, user_data);
+
+	priv = NM_PLATFORM_GET_PRIVATE (self);
+	func ("route.ip4-device-route-watched", priv->counters[NM_PLATFORM_COUNTER_IP4_DEVICE_ROUTE_WATCHED], user_data);
+	func ("route.ip4-device-route-purged", priv->counters[NM_PLATFORM_COUNTER_IP4_DEVICE_ROUTE_PURGED], user_data);
+	func ("route.ip4-device-route-expired", priv->counters[NM_PLATFORM_COUNTER_IP4_DEVICE_ROUTE_EXPIRED], user_data);
+}
+
+/**
+ * nm_platform_memory_usage_foreach:
+ * @self: platform instance
+ * @func: called for each owner of memory
+ * @user_data: user data for @func
+ *
+ * Reports the memory used by the caches of the platform. The numbers
+ * are computed on demand and cover only the objects themselves, not
+ * the allocator overhead.
+ */
+void
+nm_platform_memory_usage_foreach (NMPlatform *self,
+                                  NMMemoryUsageFunc func,
+                                  gpointer user_data)
+{
+	_CHECK_SELF_VOID (self, klass);
+
+	g_return_if_fail (func);
+
+	if (klass->memory_usage_foreach)
+		klass->memory_usage_foreach (self, func, user_data);
+}
+
+/**
+ * nm_platform_counter_add:
+ * @self: platform instance
+ * @counter: the counter to increment
+ * @n: the amount to add
+ *
+ * Accounts events that happen on behalf of the platform but are
+ * tracked by its users, so that they show up in
+ * nm_platform_statistics_foreach().
+ */
+void
+nm_platform_counter_add (NMPlatform *self,
+                         NMPlatformCounter counter,
+                         guint64 n)
+{
+	_CHECK_SELF_VOID (self, klass);
+
+	g_return_if_fail (counter < _NM_PLATFORM_COUNTER_NUM);
+
+	NM_PLATFORM_GET_PRIVATE (self)->counters[counter] += n;
+}
+
 /*****************************************************************************/
 
 /**
@@ -271,8 +361,8 @@ nm_platform_process_events (NMPlatform *self)
  * @ifindex: the ifindex for which to open /sys/class/net/%s
  * @out_ifname: optional output argument of the found ifname.
  *
- * Wraps nmp_utils_sysctl_open_netdir() by first changing into the right
- * network-namespace.
+ * Wraps nmp_utils_sysctl_open_netdir() for the network-namespace
+ * of @self.
  *
  * Returns: on success, the open file descriptor to the /sys/class/net/%s
  *   directory.
@@ -281,7 +371,7 @@ int
 nm_platform_sysctl_open_netdir (NMPlatform *self, int ifindex, char *out_ifname)
 {
 	const char*ifname_guess;
-	_CHECK_SELF_NETNS (self, klass, netns, -1);
+	_CHECK_SELF (self, klass, -1);
 
 	g_return_val_if_fail (ifindex > 0, -1);
 
@@ -290,7 +380,7 @@ nm_platform_sysctl_open_netdir (NMPlatform *self, int ifindex, char *out_ifname)
 	 * the right ifname cached and save if_indextoname() */
 	ifname_guess = nm_platform_link_get_name (self, ifindex);
 
-	return nmp_utils_sysctl_open_netdir (ifindex, ifname_guess, out_ifname);
+	return nmp_utils_sysctl_open_netdir (self->_netns, ifindex, ifname_guess, out_ifname);
 }
 
 /**
@@ -916,6 +1006,22 @@ nm_platform_link_refresh (NMPlatform *self, int ifindex)
 	return TRUE;
 }
 
+/**
+ * nm_platform_link_refresh_all:
+ * @self: platform instance
+ *
+ * Reload all links synchronously with a single dump request. This is
+ * cheaper than refreshing many links one by one.
+ */
+void
+nm_platform_link_refresh_all (NMPlatform *self)
+{
+	_CHECK_SELF_VOID (self, klass);
+
+	if (klass->link_refresh_all)
+		klass->link_refresh_all (self);
+}
+
 static guint
 _link_get_flags (NMPlatform *self, int ifindex)
 {
@@ -1409,6 +1515,46 @@ nm_platform_link_enslave (NMPlatform *self, int master, int slave)
 	return klass->link_enslave (self, master, slave);
 }
 
+/**
+ * nm_platform_link_enslave_many:
+ * @self: platform instance
+ * @master: Interface index of the master
+ * @slaves: (array length=n_slaves): Interface indexes of the slaves
+ * @n_slaves: the number of slaves
+ * @out_success: (array length=n_slaves): returns for each slave whether
+ *   it was enslaved
+ *
+ * Enslave all @slaves to @master. Unlike calling nm_platform_link_enslave()
+ * for each slave, the requests are sent without waiting for each response,
+ * and the links are refetched once.
+ */
+void
+nm_platform_link_enslave_many (NMPlatform *self,
+                               int master,
+                               const int *slaves,
+                               guint n_slaves,
+                               gboolean *out_success)
+{
+	guint i;
+
+	_CHECK_SELF_VOID (self, klass);
+
+	g_return_if_fail (master > 0);
+	g_return_if_fail (!n_slaves || (slaves && out_success));
+
+	_LOGD ("link: enslaving %u links to master '%s' (%d)",
+	       n_slaves,
+	       nm_platform_link_get_name (self, master), master);
+
+	if (klass->link_enslave_many) {
+		klass->link_enslave_many (self, master, slaves, n_slaves, out_success);
+		return;
+	}
+
+	for (i = 0; i < n_slaves; i++)
+		out_success[i] = klass->link_enslave (self, master, slaves[i]);
+}
+
 /**
  * nm_platform_link_release:
  * @self: platform instance
@@ -1853,6 +1999,171 @@ nm_platform_sysctl_slave_get_option (NMPlatform *self, int ifindex, const char *
 	return link_get_option (self, ifindex, slave_category (self, ifindex), option);
 }
 
+static char **
+link_list_dir (NMPlatform *self, int ifindex, const char *subdir, const char *prefix)
+{
+	nm_auto_close int dirfd = -1;
+	int fd;
+	DIR *dir;
+	struct dirent *ent;
+	GPtrArray *names;
+
+	dirfd = nm_platform_sysctl_open_netdir (self, ifindex, NULL);
+	if (dirfd < 0)
+		return NULL;
+
+	fd = openat (dirfd, subdir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (fd < 0)
+		return NULL;
+
+	dir = fdopendir (fd);
+	if (!dir) {
+		close (fd);
+		return NULL;
+	}
+
+	names = g_ptr_array_new ();
+	while ((ent = readdir (dir))) {
+		if (ent->d_name[0] == '.')
+			continue;
+		if (prefix && !g_str_has_prefix (ent->d_name, prefix))
+			continue;
+		g_ptr_array_add (names, g_strdup (ent->d_name));
+	}
+	closedir (dir);
+
+	g_ptr_array_add (names, NULL);
+	return (char **) g_ptr_array_free (names, FALSE);
+}
+
+/**
+ * nm_platform_link_get_queues:
+ * @self: platform instance
+ * @ifindex: the interface
+ * @tx: whether to return the transmit or the receive queues
+ *
+ * Returns: (transfer full): the names of the queues in
+ *   /sys/class/net/<ifname>/queues, like "rx-0", or %NULL if
+ *   the directory cannot be read.
+ */
+char **
+nm_platform_link_get_queues (NMPlatform *self, int ifindex, gboolean tx)
+{
+	_CHECK_SELF (self, klass, NULL);
+
+	g_return_val_if_fail (ifindex > 0, NULL);
+
+	return link_list_dir (self, ifindex, "queues", tx ? "tx-" : "rx-");
+}
+
+gboolean
+nm_platform_link_set_queue_option (NMPlatform *self, int ifindex, const char *queue, const char *option, const char *value)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (ifindex > 0, FALSE);
+	g_return_val_if_fail (queue, FALSE);
+	g_return_val_if_fail (option, FALSE);
+	g_return_val_if_fail (value, FALSE);
+
+	return link_set_option (self, ifindex,
+	                        nm_sprintf_bufa (NM_STRLEN ("queues/") + strlen (queue) + 1, "queues/%s", queue),
+	                        option, value);
+}
+
+char *
+nm_platform_link_get_queue_option (NMPlatform *self, int ifindex, const char *queue, const char *option)
+{
+	_CHECK_SELF (self, klass, NULL);
+
+	g_return_val_if_fail (ifindex > 0, NULL);
+	g_return_val_if_fail (queue, NULL);
+	g_return_val_if_fail (option, NULL);
+
+	return link_get_option (self, ifindex,
+	                        nm_sprintf_bufa (NM_STRLEN ("queues/") + strlen (queue) + 1, "queues/%s", queue),
+	                        option);
+}
+
+/**
+ * nm_platform_link_get_irqs:
+ * @self: platform instance
+ * @ifindex: the interface
+ *
+ * Returns: (transfer full): the MSI interrupts of the device backing
+ *   @ifindex as decimal strings, or %NULL if the device has none.
+ */
+char **
+nm_platform_link_get_irqs (NMPlatform *self, int ifindex)
+{
+	_CHECK_SELF (self, klass, NULL);
+
+	g_return_val_if_fail (ifindex > 0, NULL);
+
+	return link_list_dir (self, ifindex, "device/msi_irqs", NULL);
+}
+
+gboolean
+nm_platform_irq_set_affinity (NMPlatform *self, const char *irq, const char *cpus)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (irq, FALSE);
+	g_return_val_if_fail (cpus, FALSE);
+
+	return nm_platform_sysctl_set (self,
+	                               NMP_SYSCTL_PATHID_ABSOLUTE (nm_sprintf_bufa (NM_STRLEN ("/proc/irq//smp_affinity") + strlen (irq) + 1,
+	                                                                            "/proc/irq/%s/smp_affinity", irq)),
+	                               cpus);
+}
+
+char *
+nm_platform_irq_get_affinity (NMPlatform *self, const char *irq)
+{
+	_CHECK_SELF (self, klass, NULL);
+
+	g_return_val_if_fail (irq, NULL);
+
+	return nm_platform_sysctl_get (self,
+	                               NMP_SYSCTL_PATHID_ABSOLUTE (nm_sprintf_bufa (NM_STRLEN ("/proc/irq//smp_affinity") + strlen (irq) + 1,
+	                                                                            "/proc/irq/%s/smp_affinity", irq)));
+}
+
+/**
+ * nm_platform_link_get_numa_cpus:
+ * @self: platform instance
+ * @ifindex: the interface
+ *
+ * Returns: (transfer full): the CPU mask of the NUMA node the device
+ *   backing @ifindex is attached to, or %NULL if it is unknown.
+ */
+char *
+nm_platform_link_get_numa_cpus (NMPlatform *self, int ifindex)
+{
+	nm_auto_close int dirfd = -1;
+	char ifname_verified[IFNAMSIZ];
+	gint64 node;
+	char path[100];
+
+	_CHECK_SELF (self, klass, NULL);
+
+	g_return_val_if_fail (ifindex > 0, NULL);
+
+	dirfd = nm_platform_sysctl_open_netdir (self, ifindex, ifname_verified);
+	if (dirfd < 0)
+		return NULL;
+
+	/* numa_node is -1 if the platform does not know the node. */
+	node = nm_platform_sysctl_get_int_checked (self,
+	                                           NMP_SYSCTL_PATHID_NETDIR (dirfd, ifname_verified, "device/numa_node"),
+	                                           10, -1, G_MAXINT32, -1);
+	if (node < 0)
+		return NULL;
+
+	nm_sprintf_buf (path, "/sys/devices/system/node/node%d/cpumap", (int) node);
+	return nm_platform_sysctl_get (self, NMP_SYSCTL_PATHID_ABSOLUTE (path));
+}
+
 /*****************************************************************************/
 
 gboolean
@@ -1943,6 +2254,56 @@ nm_platform_link_vlan_set_egress_map (NMPlatform *self, int ifindex, int from, i
 	return nm_platform_link_vlan_change (self, ifindex, 0, 0, FALSE, NULL, 0, FALSE, &map, 1);
 }
 
+/**
+ * nm_platform_link_bridge_change:
+ * @self: platform instance
+ * @ifindex: the ifindex of the bridge
+ * @options: the options to set
+ *
+ * Sets all options of the bridge at once.
+ *
+ * Returns: %FALSE if the platform does not support it or the kernel
+ *   refused the change. The caller may fall back to setting the
+ *   options individually via sysfs.
+ */
+gboolean
+nm_platform_link_bridge_change (NMPlatform *self,
+                                int ifindex,
+                                const NMPlatformBridgeOptions *options)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (ifindex > 0, FALSE);
+	g_return_val_if_fail (options, FALSE);
+
+	if (!klass->link_bridge_change)
+		return FALSE;
+	return klass->link_bridge_change (self, ifindex, options);
+}
+
+/**
+ * nm_platform_link_bridge_port_change:
+ * @self: platform instance
+ * @ifindex: the ifindex of the bridge port
+ * @options: the options to set
+ *
+ * Like nm_platform_link_bridge_change(), but for the options of a port.
+ */
+gboolean
+nm_platform_link_bridge_port_change (NMPlatform *self,
+                                     int ifindex,
+                                     const NMPlatformBridgePortOptions *options)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (ifindex > 0, FALSE);
+	g_return_val_if_fail (options, FALSE);
+
+	if (!klass->link_bridge_port_change)
+		return FALSE;
+	return klass->link_bridge_port_change (self, ifindex, options);
+}
+
 /**
  * nm_platform_link_gre_add:
  * @self: platform instance
@@ -2322,11 +2683,7 @@ nm_platform_link_veth_get_properties (NMPlatform *self, int ifindex, int *out_pe
 
 	/* Pre-4.1 kernel did not expose the peer_ifindex as IFA_LINK. Lookup via ethtool. */
 	if (out_peer_ifindex) {
-		nm_auto_pop_netns NMPNetns *netns = NULL;
-
-		if (!nm_platform_netns_push (self, &netns))
-			return FALSE;
-		peer_ifindex = nmp_utils_ethtool_get_peer_ifindex (plink->ifindex);
+		peer_ifindex = nmp_utils_ethtool_get_peer_ifindex (self->_netns, plink->ifindex);
 		if (peer_ifindex <= 0)
 			return FALSE;
 
@@ -2482,6 +2839,35 @@ nm_platform_wifi_indicate_addressing_running (NMPlatform *self, int ifindex, gbo
 	klass->wifi_indicate_addressing_running (self, ifindex, running);
 }
 
+/**
+ * nm_platform_wifi_watch_events:
+ * @self: platform instance
+ * @ifindex: the Wi-Fi interface
+ * @callback: (allow-none): called when the association or the signal
+ *   quality of @ifindex changes. %NULL stops watching.
+ * @user_data: user data for @callback
+ *
+ * There is at most one watch per interface; a new one replaces the
+ * previous.
+ *
+ * Returns: %TRUE if the events are watched. Otherwise, the platform
+ *   cannot notify about changes and the caller must poll.
+ */
+gboolean
+nm_platform_wifi_watch_events (NMPlatform *self,
+                               int ifindex,
+                               NMPlatformWifiEventFunc callback,
+                               gpointer user_data)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (ifindex > 0, FALSE);
+
+	if (!klass->wifi_watch_events)
+		return FALSE;
+	return klass->wifi_watch_events (self, ifindex, callback, user_data);
+}
+
 guint32
 nm_platform_mesh_get_channel (NMPlatform *self, int ifindex)
 {
@@ -2562,31 +2948,71 @@ _to_string_ifa_flags (guint32 ifa_flags, char *buf, gsize size)
 gboolean
 nm_platform_ethtool_set_wake_on_lan (NMPlatform *self, int ifindex, NMSettingWiredWakeOnLan wol, const char *wol_password)
 {
-	_CHECK_SELF_NETNS (self, klass, netns, FALSE);
+	_CHECK_SELF (self, klass, FALSE);
 
 	g_return_val_if_fail (ifindex > 0, FALSE);
 
-	return nmp_utils_ethtool_set_wake_on_lan (ifindex, wol, wol_password);
+	return nmp_utils_ethtool_set_wake_on_lan (self->_netns, ifindex, wol, wol_password);
 }
 
 gboolean
 nm_platform_ethtool_set_link_settings (NMPlatform *self, int ifindex, gboolean autoneg, guint32 speed, NMPlatformLinkDuplexType duplex)
 {
-	_CHECK_SELF_NETNS (self, klass, netns, FALSE);
+	_CHECK_SELF (self, klass, FALSE);
 
 	g_return_val_if_fail (ifindex > 0, FALSE);
 
-	return nmp_utils_ethtool_set_link_settings (ifindex, autoneg, speed, duplex);
+	return nmp_utils_ethtool_set_link_settings (self->_netns, ifindex, autoneg, speed, duplex);
 }
 
 gboolean
 nm_platform_ethtool_get_link_settings (NMPlatform *self, int ifindex, gboolean *out_autoneg, guint32 *out_speed,  NMPlatformLinkDuplexType *out_duplex)
 {
-	_CHECK_SELF_NETNS (self, klass, netns, FALSE);
+	_CHECK_SELF (self, klass, FALSE);
 
 	g_return_val_if_fail (ifindex > 0, FALSE);
 
-	return nmp_utils_ethtool_get_link_settings (ifindex, out_autoneg, out_speed, out_duplex);
+	return nmp_utils_ethtool_get_link_settings (self->_netns, ifindex, out_autoneg, out_speed, out_duplex);
+}
+
+gboolean
+nm_platform_ethtool_set_ring (NMPlatform *self, int ifindex, guint32 rx_pending, guint32 tx_pending)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (ifindex > 0, FALSE);
+
+	return nmp_utils_ethtool_set_ring (self->_netns, ifindex, rx_pending, tx_pending);
+}
+
+gboolean
+nm_platform_ethtool_set_channels (NMPlatform *self, int ifindex, guint32 combined_count)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (ifindex > 0, FALSE);
+
+	return nmp_utils_ethtool_set_channels (self->_netns, ifindex, combined_count);
+}
+
+gboolean
+nm_platform_ethtool_set_coalesce (NMPlatform *self, int ifindex, gint32 rx_usecs, gint32 tx_usecs)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (ifindex > 0, FALSE);
+
+	return nmp_utils_ethtool_set_coalesce (self->_netns, ifindex, rx_usecs, tx_usecs);
+}
+
+gboolean
+nm_platform_ethtool_set_offloads (NMPlatform *self, int ifindex, int gro, int tso, int lro)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (ifindex > 0, FALSE);
+
+	return nmp_utils_ethtool_set_offloads (self->_netns, ifindex, gro, tso, lro);
 }
 
 /*****************************************************************************/
@@ -2906,11 +3332,60 @@ ip4_addr_subnets_is_secondary (const NMPlatformIP4Address *address, GHashTable *
 	return FALSE;
 }
 
+void
+nm_platform_address_commit_clear (NMPlatformAddressCommit *commit)
+{
+	g_clear_pointer (&commit->known_addresses, g_array_unref);
+	g_clear_pointer (&commit->configured_addresses, g_array_unref);
+}
+
+/* Returns the address as it was configured after the last sync, if
+ * @known_address was committed unchanged, or %NULL. */
+static gconstpointer
+_address_commit_lookup (const NMPlatformAddressCommit *commit,
+                        gsize elt_size,
+                        guint idx,
+                        gconstpointer known_address,
+                        GCompareFunc cmp)
+{
+	const GArray *known;
+	guint i;
+
+	if (!commit || !commit->known_addresses)
+		return NULL;
+
+	known = commit->known_addresses;
+
+	/* usually the addresses are committed in the same order again */
+	if (   idx < known->len
+	    && cmp (&known->data[idx * elt_size], known_address) == 0)
+		return &commit->configured_addresses->data[idx * elt_size];
+	for (i = 0; i < known->len; i++) {
+		if (cmp (&known->data[i * elt_size], known_address) == 0)
+			return &commit->configured_addresses->data[i * elt_size];
+	}
+	return NULL;
+}
+
+static void
+_address_commit_set (NMPlatformAddressCommit *commit,
+                     gsize elt_size,
+                     const GArray *known_addresses,
+                     GArray *configured_addresses)
+{
+	nm_platform_address_commit_clear (commit);
+	commit->known_addresses = g_array_sized_new (FALSE, FALSE, elt_size, known_addresses->len);
+	g_array_append_vals (commit->known_addresses, known_addresses->data, known_addresses->len);
+	commit->configured_addresses = configured_addresses;
+}
+
 /**
  * nm_platform_ip4_address_sync:
  * @self: platform instance
  * @ifindex: Interface index
  * @known_addresses: List of addresses
+ * @commit: (allow-none): the state of the previous successful sync of
+ *   @ifindex. On success, it is updated to this sync, otherwise cleared.
  * @out_added_addresses: (out): (allow-none): if not %NULL, return a #GPtrArray
  *   with the addresses added. The pointers point into @known_addresses.
  *   It possibly does not contain all addresses from @known_address because
@@ -2920,14 +3395,23 @@ ip4_addr_subnets_is_secondary (const NMPlatformIP4Address *address, GHashTable *
  * with the least possible disturbance. It simply removes addresses that are
  * not listed and adds addresses that are.
  *
+ * A known address that is identical to one of the previous sync, including
+ * its timestamp and lifetimes, is not added again if it is still configured
+ * exactly as after that sync. Re-adding it would only set the same
+ * lifetimes. If the address was changed or removed meanwhile, for example
+ * by another program, it is added again.
+ *
  * Returns: %TRUE on success.
  */
 gboolean
-nm_platform_ip4_address_sync (NMPlatform *self, int ifindex, const GArray *known_addresses, GPtrArray **out_added_addresses)
+nm_platform_ip4_address_sync (NMPlatform *self, int ifindex, const GArray *known_addresses, NMPlatformAddressCommit *commit, GPtrArray **out_added_addresses)
 {
 	GArray *addresses;
+	GArray *configured_addresses;
 	NMPlatformIP4Address *address;
 	const NMPlatformIP4Address *known_address;
+	const NMPlatformIP4Address *configured;
+	gconstpointer committed;
 	gint32 now = nm_utils_get_monotonic_timestamp_s ();
 	GHashTable *plat_subnets;
 	GHashTable *known_subnets;
@@ -2990,8 +3474,11 @@ nm_platform_ip4_address_sync (NMPlatform *self, int ifindex, const GArray *known
 	if (out_added_addresses)
 		*out_added_addresses = NULL;
 
-	if (!known_addresses)
+	if (!known_addresses) {
+		if (commit)
+			nm_platform_address_commit_clear (commit);
 		return TRUE;
+	}
 
 	/* Add missing addresses */
 	for (i = 0; i < known_addresses->len; i++) {
@@ -3003,11 +3490,26 @@ nm_platform_ip4_address_sync (NMPlatform *self, int ifindex, const GArray *known
 		                            now, &lifetime, &preferred))
 			continue;
 
-		if (!nm_platform_ip4_address_add (self, ifindex, known_address->address, known_address->plen,
-		                                  known_address->peer_address, lifetime, preferred,
-		                                  0, known_address->label)) {
-			ip4_addr_subnets_destroy_index (known_subnets, known_addresses);
-			return FALSE;
+		committed = _address_commit_lookup (commit, sizeof (NMPlatformIP4Address), i, known_address,
+		                                    (GCompareFunc) nm_platform_ip4_address_cmp);
+		if (committed) {
+			configured = nm_platform_ip4_address_get (self, ifindex, known_address->address,
+			                                          known_address->plen, known_address->peer_address);
+			if (   configured
+			    && nm_platform_ip4_address_cmp (configured, committed) != 0)
+				configured = NULL;
+		} else
+			configured = NULL;
+
+		if (!configured) {
+			if (!nm_platform_ip4_address_add (self, ifindex, known_address->address, known_address->plen,
+			                                  known_address->peer_address, lifetime, preferred,
+			                                  0, known_address->label)) {
+				if (commit)
+					nm_platform_address_commit_clear (commit);
+				ip4_addr_subnets_destroy_index (known_subnets, known_addresses);
+				return FALSE;
+			}
 		}
 
 		if (out_added_addresses) {
@@ -3019,6 +3521,19 @@ nm_platform_ip4_address_sync (NMPlatform *self, int ifindex, const GArray *known
 
 	ip4_addr_subnets_destroy_index (known_subnets, known_addresses);
 
+	if (commit) {
+		configured_addresses = g_array_sized_new (FALSE, TRUE, sizeof (NMPlatformIP4Address), known_addresses->len);
+		g_array_set_size (configured_addresses, known_addresses->len);
+		for (i = 0; i < known_addresses->len; i++) {
+			known_address = &g_array_index (known_addresses, NMPlatformIP4Address, i);
+			configured = nm_platform_ip4_address_get (self, ifindex, known_address->address,
+			                                          known_address->plen, known_address->peer_address);
+			if (configured)
+				g_array_index (configured_addresses, NMPlatformIP4Address, i) = *configured;
+		}
+		_address_commit_set (commit, sizeof (NMPlatformIP4Address), known_addresses, configured_addresses);
+	}
+
 	return TRUE;
 }
 
@@ -3027,19 +3542,26 @@ nm_platform_ip4_address_sync (NMPlatform *self, int ifindex, const GArray *known
  * @self: platform instance
  * @ifindex: Interface index
  * @known_addresses: List of addresses
+ * @commit: (allow-none): the state of the previous successful sync of
+ *   @ifindex. On success, it is updated to this sync, otherwise cleared.
  * @keep_link_local: Don't remove link-local address
  *
  * A convenience function to synchronize addresses for a specific interface
  * with the least possible disturbance. It simply removes addresses that are
- * not listed and adds addresses that are.
+ * not listed and adds addresses that are. Like for nm_platform_ip4_address_sync(),
+ * addresses unchanged since the sync recorded in @commit are not added again.
  *
  * Returns: %TRUE on success.
  */
 gboolean
-nm_platform_ip6_address_sync (NMPlatform *self, int ifindex, const GArray *known_addresses, gboolean keep_link_local)
+nm_platform_ip6_address_sync (NMPlatform *self, int ifindex, const GArray *known_addresses, NMPlatformAddressCommit *commit, gboolean keep_link_local)
 {
 	GArray *addresses;
+	GArray *configured_addresses;
 	NMPlatformIP6Address *address;
+	const NMPlatformIP6Address *known_address;
+	const NMPlatformIP6Address *configured;
+	gconstpointer committed;
 	gint32 now = nm_utils_get_monotonic_timestamp_s ();
 	int i;
 
@@ -3057,14 +3579,18 @@ nm_platform_ip6_address_sync (NMPlatform *self, int ifindex, const GArray *known
 	}
 	g_array_free (addresses, TRUE);
 
-	if (!known_addresses)
+	if (!known_addresses) {
+		if (commit)
+			nm_platform_address_commit_clear (commit);
 		return TRUE;
+	}
 
 	/* Add missing addresses */
 	for (i = 0; i < known_addresses->len; i++) {
-		const NMPlatformIP6Address *known_address = &g_array_index (known_addresses, NMPlatformIP6Address, i);
 		guint32 lifetime, preferred;
 
+		known_address = &g_array_index (known_addresses, NMPlatformIP6Address, i);
+
 		if (NM_FLAGS_HAS (known_address->n_ifa_flags, IFA_F_TEMPORARY)) {
 			/* Kernel manages these */
 			continue;
@@ -3074,10 +3600,34 @@ nm_platform_ip6_address_sync (NMPlatform *self, int ifindex, const GArray *known
 		                            now, &lifetime, &preferred))
 			continue;
 
+		committed = _address_commit_lookup (commit, sizeof (NMPlatformIP6Address), i, known_address,
+		                                    (GCompareFunc) nm_platform_ip6_address_cmp);
+		if (committed) {
+			configured = nm_platform_ip6_address_get (self, ifindex, known_address->address, known_address->plen);
+			if (   configured
+			    && nm_platform_ip6_address_cmp (configured, committed) == 0)
+				continue;
+		}
+
 		if (!nm_platform_ip6_address_add (self, ifindex, known_address->address,
 		                                  known_address->plen, known_address->peer_address,
-		                                  lifetime, preferred, known_address->n_ifa_flags))
+		                                  lifetime, preferred, known_address->n_ifa_flags)) {
+			if (commit)
+				nm_platform_address_commit_clear (commit);
 			return FALSE;
+		}
+	}
+
+	if (commit) {
+		configured_addresses = g_array_sized_new (FALSE, TRUE, sizeof (NMPlatformIP6Address), known_addresses->len);
+		g_array_set_size (configured_addresses, known_addresses->len);
+		for (i = 0; i < known_addresses->len; i++) {
+			known_address = &g_array_index (known_addresses, NMPlatformIP6Address, i);
+			configured = nm_platform_ip6_address_get (self, ifindex, known_address->address, known_address->plen);
+			if (configured)
+				g_array_index (configured_addresses, NMPlatformIP6Address, i) = *configured;
+		}
+		_address_commit_set (commit, sizeof (NMPlatformIP6Address), known_addresses, configured_addresses);
 	}
 
 	return TRUE;
@@ -3088,8 +3638,8 @@ nm_platform_address_flush (NMPlatform *self, int ifindex)
 {
 	_CHECK_SELF (self, klass, FALSE);
 
-	return    nm_platform_ip4_address_sync (self, ifindex, NULL, NULL)
-	       && nm_platform_ip6_address_sync (self, ifindex, NULL, FALSE);
+	return    nm_platform_ip4_address_sync (self, ifindex, NULL, NULL, NULL)
+	       && nm_platform_ip6_address_sync (self, ifindex, NULL, NULL, FALSE);
 }
 
 /*****************************************************************************/
@@ -3189,6 +3739,118 @@ nm_platform_ip6_route_delete (NMPlatform *self, int ifindex, struct in6_addr net
 	return klass->ip6_route_delete (self, ifindex, network, plen, metric);
 }
 
+/**
+ * nm_platform_ip_route_batch:
+ * @self: the #NMPlatform instance
+ * @addr_family: either AF_INET or AF_INET6
+ * @entries: (array length=n_entries): the routes to add or delete
+ * @n_entries: the number of @entries
+ *
+ * Adds or deletes the routes in @entries, in the given order. Contrary
+ * to calling nm_platform_ip4_route_add() and nm_platform_ip4_route_delete()
+ * repeatedly, the platform implementation may send all requests at once
+ * and wait for all the responses together.
+ *
+ * The result of each request is returned in the @success field of the
+ * corresponding entry.
+ *
+ * Returns: %TRUE if all requests succeeded.
+ */
+gboolean
+nm_platform_ip_route_batch (NMPlatform *self, int addr_family, NMPlatformIPRouteBatchEntry *entries, guint n_entries)
+{
+	gboolean success = TRUE;
+	guint i;
+
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (NM_IN_SET (addr_family, AF_INET, AF_INET6), FALSE);
+	g_return_val_if_fail (entries || n_entries == 0, FALSE);
+
+	if (n_entries == 0)
+		return TRUE;
+
+	for (i = 0; i < n_entries; i++) {
+		NMPlatformIPRouteBatchEntry *e = &entries[i];
+
+		g_return_val_if_fail (e->route.rx.plen <= (addr_family == AF_INET ? 32 : 128), FALSE);
+
+		e->success = FALSE;
+		_LOGD ("route: batch #%u: %s IPv%c route: %s",
+		       i,
+		       e->is_delete ? "deleting" : "adding or updating",
+		       addr_family == AF_INET ? '4' : '6',
+		       addr_family == AF_INET
+		           ? nm_platform_ip4_route_to_string (&e->route.r4, NULL, 0)
+		           : nm_platform_ip6_route_to_string (&e->route.r6, NULL, 0));
+	}
+
+	if (klass->ip_route_batch)
+		return klass->ip_route_batch (self, addr_family, entries, n_entries);
+
+	for (i = 0; i < n_entries; i++) {
+		NMPlatformIPRouteBatchEntry *e = &entries[i];
+
+		if (addr_family == AF_INET) {
+			e->success = e->is_delete
+			             ? klass->ip4_route_delete (self, e->route.rx.ifindex, e->route.r4.network, e->route.rx.plen, e->route.rx.metric)
+			             : klass->ip4_route_add (self, &e->route.r4);
+		} else {
+			e->success = e->is_delete
+			             ? klass->ip6_route_delete (self, e->route.rx.ifindex, e->route.r6.network, e->route.rx.plen, e->route.rx.metric)
+			             : klass->ip6_route_add (self, &e->route.r6);
+		}
+		if (!e->success)
+			success = FALSE;
+	}
+	return success;
+}
+
+/**
+ * nm_platform_ip4_default_route_set_multipath:
+ * @self: platform instance
+ * @metric: the metric of the default route
+ * @source: the source of the route
+ * @nexthops: (array length=n_nexthops): the nexthops of the route
+ * @n_nexthops: the number of @nexthops. If zero, the multipath default
+ *   route with @metric is deleted.
+ *
+ * Adds or replaces an IPv4 default route with multiple nexthops, over
+ * which the kernel spreads the flows in proportion to their weights.
+ *
+ * Such routes are not tracked in the platform cache, so the caller must
+ * remember which routes it added and delete them again.
+ *
+ * Returns: %TRUE on success.
+ */
+gboolean
+nm_platform_ip4_default_route_set_multipath (NMPlatform *self,
+                                             guint32 metric,
+                                             NMIPConfigSource source,
+                                             const NMPlatformIP4Nexthop *nexthops,
+                                             guint n_nexthops)
+{
+	guint i;
+
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (nexthops || n_nexthops == 0, FALSE);
+
+	for (i = 0; i < n_nexthops; i++) {
+		g_return_val_if_fail (nexthops[i].ifindex > 0, FALSE);
+		g_return_val_if_fail (nexthops[i].weight >= 1 && nexthops[i].weight <= 256, FALSE);
+		_LOGD ("route: multipath default route, metric %u: nexthop #%u via %s dev %d weight %u",
+		       metric, i, nm_utils_inet4_ntop (nexthops[i].gateway, NULL),
+		       nexthops[i].ifindex, nexthops[i].weight);
+	}
+	if (n_nexthops == 0)
+		_LOGD ("route: deleting multipath default route, metric %u", metric);
+
+	if (!klass->ip4_default_route_set_multipath)
+		return FALSE;
+	return klass->ip4_default_route_set_multipath (self, metric, source, nexthops, n_nexthops);
+}
+
 const NMPlatformIP4Route *
 nm_platform_ip4_route_get (NMPlatform *self, int ifindex, in_addr_t network, guint8 plen, guint32 metric)
 {
@@ -4413,35 +5075,181 @@ nm_platform_signal_change_type_to_string (NMPlatformSignalChangeType change_type
 	}
 }
 
+static void
+_changes_emit (NMPlatform *self)
+{
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	GArray *changes;
+	NMPlatformChanges data;
+
+	if (!priv->changes || priv->changes->len == 0)
+		return;
+
+	/* take the collected changes. Signal handlers might cause new
+	 * changes, which are collected for the next emission. */
+	changes = priv->changes;
+	data.changes = &g_array_index (changes, NMPlatformChange, 0);
+	data.len = changes->len;
+	data.obj_types = priv->changes_obj_types;
+	priv->changes = NULL;
+	priv->changes_obj_types = 0;
+
+	_LOGt ("signal: changes: %u changes", data.len);
+	g_signal_emit (self, signal_changes, 0, &data);
+
+	if (!priv->changes) {
+		g_array_set_size (changes, 0);
+		priv->changes = changes;
+	} else
+		g_array_unref (changes);
+}
+
+typedef struct {
+	guint64 v[NMP_OBJECT_TYPE_IP6_ROUTE + 1];
+} ChangesStamps;
+
+/* shared by all instances, so that stamps of different instances never
+ * compare equal. */
+static guint64 changes_stamp_counter;
+
+static void
+_changes_stamp (NMPlatform *self, NMPObjectType obj_type, int ifindex)
+{
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	ChangesStamps *stamps;
+	guint i;
+
+	nm_assert (obj_type > NMP_OBJECT_TYPE_UNKNOWN && obj_type <= NMP_OBJECT_TYPE_IP6_ROUTE);
+
+	if (!priv->changes_stamps)
+		priv->changes_stamps = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+	stamps = g_hash_table_lookup (priv->changes_stamps, GINT_TO_POINTER (ifindex));
+	if (!stamps) {
+		stamps = g_new (ChangesStamps, 1);
+		for (i = 0; i < G_N_ELEMENTS (stamps->v); i++)
+			stamps->v[i] = priv->changes_stamp_init;
+		g_hash_table_insert (priv->changes_stamps, GINT_TO_POINTER (ifindex), stamps);
+	}
+	stamps->v[obj_type] = ++changes_stamp_counter;
+}
+
+/**
+ * nm_platform_changes_get_stamp:
+ * @self: the #NMPlatform instance
+ * @obj_type: the object type, one of link, address or route
+ * @ifindex: the interface index
+ *
+ * Returns: a stamp that is updated whenever an object of type @obj_type
+ *   on @ifindex changes in the cache. Contrary to the "changes" signal,
+ *   it is updated immediately, also while the signal is frozen. So, a
+ *   result derived from the cache can be reused as long as the stamp
+ *   stays the same.
+ */
+guint64
+nm_platform_changes_get_stamp (NMPlatform *self, NMPObjectType obj_type, int ifindex)
+{
+	NMPlatformPrivate *priv;
+	const ChangesStamps *stamps;
+
+	_CHECK_SELF (self, klass, 0);
+
+	g_return_val_if_fail (obj_type > NMP_OBJECT_TYPE_UNKNOWN && obj_type <= NMP_OBJECT_TYPE_IP6_ROUTE, 0);
+
+	priv = NM_PLATFORM_GET_PRIVATE (self);
+	stamps = priv->changes_stamps
+	         ? g_hash_table_lookup (priv->changes_stamps, GINT_TO_POINTER (ifindex))
+	         : NULL;
+	return stamps ? stamps->v[obj_type] : priv->changes_stamp_init;
+}
+
+static void
+_changes_add (NMPlatform *self, NMPObjectType obj_type, int ifindex, gconstpointer obj, gsize obj_size, NMPlatformSignalChangeType change_type)
+{
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	NMPlatformChange *change;
+
+	_changes_stamp (self, obj_type, ifindex);
+
+	if (!priv->changes)
+		priv->changes = g_array_new (FALSE, FALSE, sizeof (NMPlatformChange));
+
+	g_array_set_size (priv->changes, priv->changes->len + 1);
+	change = &g_array_index (priv->changes, NMPlatformChange, priv->changes->len - 1);
+	change->obj_type = obj_type;
+	change->change_type = change_type;
+	change->ifindex = ifindex;
+	memcpy (&change->object, obj, obj_size);
+	priv->changes_obj_types |= (1u << obj_type);
+
+	if (priv->changes_freeze_count == 0)
+		_changes_emit (self);
+}
+
+/**
+ * nm_platform_changes_freeze:
+ * @self: the #NMPlatform instance
+ *
+ * Postpone emitting the "changes" signal until the matching
+ * nm_platform_changes_thaw(). Can be nested.
+ */
+void
+nm_platform_changes_freeze (NMPlatform *self)
+{
+	_CHECK_SELF_VOID (self, klass);
+
+	NM_PLATFORM_GET_PRIVATE (self)->changes_freeze_count++;
+}
+
+void
+nm_platform_changes_thaw (NMPlatform *self)
+{
+	NMPlatformPrivate *priv;
+
+	_CHECK_SELF_VOID (self, klass);
+
+	priv = NM_PLATFORM_GET_PRIVATE (self);
+
+	g_return_if_fail (priv->changes_freeze_count > 0);
+
+	if (--priv->changes_freeze_count == 0)
+		_changes_emit (self);
+}
+
 static void
 log_link (NMPlatform *self, NMPObjectType obj_type, int ifindex, NMPlatformLink *device, NMPlatformSignalChangeType change_type, gpointer user_data)
 {
 
 	_LOGD ("signal: link %7s: %s", nm_platform_signal_change_type_to_string (change_type), nm_platform_link_to_string (device, NULL, 0));
+	_changes_add (self, obj_type, ifindex, device, sizeof (*device), change_type);
 }
 
 static void
 log_ip4_address (NMPlatform *self, NMPObjectType obj_type, int ifindex, NMPlatformIP4Address *address, NMPlatformSignalChangeType change_type, gpointer user_data)
 {
 	_LOGD ("signal: address 4 %7s: %s", nm_platform_signal_change_type_to_string (change_type), nm_platform_ip4_address_to_string (address, NULL, 0));
+	_changes_add (self, obj_type, ifindex, address, sizeof (*address), change_type);
 }
 
 static void
 log_ip6_address (NMPlatform *self, NMPObjectType obj_type, int ifindex, NMPlatformIP6Address *address, NMPlatformSignalChangeType change_type, gpointer user_data)
 {
 	_LOGD ("signal: address 6 %7s: %s", nm_platform_signal_change_type_to_string (change_type), nm_platform_ip6_address_to_string (address, NULL, 0));
+	_changes_add (self, obj_type, ifindex, address, sizeof (*address), change_type);
 }
 
 static void
 log_ip4_route (NMPlatform *self, NMPObjectType obj_type, int ifindex, NMPlatformIP4Route *route, NMPlatformSignalChangeType change_type, gpointer user_data)
 {
 	_LOGD ("signal: route   4 %7s: %s", nm_platform_signal_change_type_to_string (change_type), nm_platform_ip4_route_to_string (route, NULL, 0));
+	_changes_add (self, obj_type, ifindex, route, sizeof (*route), change_type);
 }
 
 static void
 log_ip6_route (NMPlatform *self, NMPObjectType obj_type, int ifindex, NMPlatformIP6Route *route, NMPlatformSignalChangeType change_type, gpointer user_data)
 {
 	_LOGD ("signal: route   6 %7s: %s", nm_platform_signal_change_type_to_string (change_type), nm_platform_ip6_route_to_string (route, NULL, 0));
+	_changes_add (self, obj_type, ifindex, route, sizeof (*route), change_type);
 }
 
 /*****************************************************************************/
@@ -4609,14 +5417,20 @@ static void
 nm_platform_init (NMPlatform *self)
 {
 	self->_priv = G_TYPE_INSTANCE_GET_PRIVATE (self, NM_TYPE_PLATFORM, NMPlatformPrivate);
+	NM_PLATFORM_GET_PRIVATE (self)->changes_stamp_init = ++changes_stamp_counter;
 }
 
 static void
 finalize (GObject *object)
 {
 	NMPlatform *self = NM_PLATFORM (object);
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
 
 	g_clear_object (&self->_netns);
+	if (priv->changes)
+		g_array_unref (priv->changes);
+	if (priv->changes_stamps)
+		g_hash_table_unref (priv->changes_stamps);
 }
 
 static void
@@ -4670,4 +5484,13 @@ nm_platform_class_init (NMPlatformClass *platform_class)
 	SIGNAL (NM_PLATFORM_SIGNAL_ID_IP6_ADDRESS, NM_PLATFORM_SIGNAL_IP6_ADDRESS_CHANGED, log_ip6_address);
 	SIGNAL (NM_PLATFORM_SIGNAL_ID_IP4_ROUTE,   NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED,   log_ip4_route);
 	SIGNAL (NM_PLATFORM_SIGNAL_ID_IP6_ROUTE,   NM_PLATFORM_SIGNAL_IP6_ROUTE_CHANGED,   log_ip6_route);
+
+	signal_changes =
+	    g_signal_new (NM_PLATFORM_SIGNAL_CHANGES,
+	                  G_OBJECT_CLASS_TYPE (object_class),
+	                  G_SIGNAL_RUN_FIRST,
+	                  0,
+	                  NULL, NULL, NULL,
+	                  G_TYPE_NONE, 1,
+	                  G_TYPE_POINTER /* const NMPlatformChanges * */);
 }
@@ -295,6 +295,22 @@ typedef union {
 
 #undef __NMPlatformIPAddress_COMMON
 
+/**
+ * NMPlatformAddressCommit:
+ * @known_addresses: the known addresses of the last successful address
+ *   sync of an interface, as #NMPlatformIP4Address or #NMPlatformIP6Address.
+ * @configured_addresses: for each entry of @known_addresses, the address
+ *   as found in the platform cache after that sync. The ifindex of an
+ *   entry is zero if the address was not configured.
+ *
+ * With it, nm_platform_ip4_address_sync() and nm_platform_ip6_address_sync()
+ * don't add again addresses that did not change since the last sync.
+ **/
+typedef struct {
+	GArray *known_addresses;
+	GArray *configured_addresses;
+} NMPlatformAddressCommit;
+
 
 /* Default value for adding an IPv4 route. This is also what iproute2 does.
  * Note that contrary to IPv6, you can add routes with metric 0 and it is even
@@ -384,6 +400,24 @@ typedef union {
 
 #undef __NMPlatformIPRoute_COMMON
 
+typedef struct {
+	/* the route to add or delete. The ifindex and metric are
+	 * used as is. For deletion, only the ID fields matter. */
+	NMPlatformIPXRoute route;
+	bool is_delete:1;
+
+	/* set by nm_platform_ip_route_batch(). */
+	bool success:1;
+} NMPlatformIPRouteBatchEntry;
+
+typedef struct {
+	int ifindex;
+	in_addr_t gateway;
+
+	/* the relative weight of the nexthop, 1 to 256. */
+	guint weight;
+} NMPlatformIP4Nexthop;
+
 
 #undef __NMPlatformObject_COMMON
 
@@ -504,6 +538,25 @@ typedef struct {
 	bool l3miss:1;
 } NMPlatformLnkVxlan;
 
+/* Options of a bridge, as written to IFLA_INFO_DATA. The time values are
+ * in USER_HZ, like in sysfs. */
+typedef struct {
+	guint32 stp_state;
+	guint32 priority;
+	guint32 forward_delay;
+	guint32 hello_time;
+	guint32 max_age;
+	guint32 ageing_time;
+	guint32 multicast_snooping;
+} NMPlatformBridgeOptions;
+
+/* Options of a bridge port, as written to IFLA_INFO_SLAVE_DATA. */
+typedef struct {
+	guint32 priority;
+	guint32 path_cost;
+	guint32 hairpin_mode;
+} NMPlatformBridgePortOptions;
+
 typedef struct {
 	gint64 owner;
 	gint64 group;
@@ -523,6 +576,20 @@ typedef enum {
 
 struct _NMPlatformPrivate;
 
+typedef void (*NMPlatformStatisticsFunc) (const char *name, guint64 value, gpointer user_data);
+
+/* counters maintained by the platform base class on behalf of its users.
+ * They are reported by nm_platform_statistics_foreach() in addition to
+ * the counters of the platform implementation. */
+typedef enum {
+	NM_PLATFORM_COUNTER_IP4_DEVICE_ROUTE_WATCHED,
+	NM_PLATFORM_COUNTER_IP4_DEVICE_ROUTE_PURGED,
+	NM_PLATFORM_COUNTER_IP4_DEVICE_ROUTE_EXPIRED,
+	_NM_PLATFORM_COUNTER_NUM,
+} NMPlatformCounter;
+
+typedef void (*NMPlatformWifiEventFunc) (NMPlatform *platform, int ifindex, gpointer user_data);
+
 struct _NMPlatform {
 	GObject parent;
 	NMPNetns *_netns;
@@ -553,6 +620,7 @@ typedef struct {
 	gboolean (*link_get_unmanaged) (NMPlatform *, int ifindex, gboolean *unmanaged);
 
 	gboolean (*link_refresh) (NMPlatform *, int ifindex);
+	void (*link_refresh_all) (NMPlatform *);
 
 	gboolean (*link_set_netns) (NMPlatform *, int ifindex, int netns_fd);
 
@@ -589,6 +657,11 @@ typedef struct {
 	gboolean (*link_supports_vlans) (NMPlatform *, int ifindex);
 
 	gboolean (*link_enslave) (NMPlatform *, int master, int slave);
+	void (*link_enslave_many) (NMPlatform *,
+	                           int master,
+	                           const int *slaves,
+	                           guint n_slaves,
+	                           gboolean *out_success);
 	gboolean (*link_release) (NMPlatform *, int master, int slave);
 
 	gboolean (*link_can_assume) (NMPlatform *, int ifindex);
@@ -604,6 +677,12 @@ typedef struct {
 	                              gboolean egress_reset_all,
 	                              const NMVlanQosMapping *egress_map,
 	                              gsize n_egress_map);
+	gboolean (*link_bridge_change) (NMPlatform *,
+	                                int ifindex,
+	                                const NMPlatformBridgeOptions *options);
+	gboolean (*link_bridge_port_change) (NMPlatform *,
+	                                     int ifindex,
+	                                     const NMPlatformBridgePortOptions *options);
 	gboolean (*link_vxlan_add) (NMPlatform *,
 	                            const char *name,
 	                            const NMPlatformLnkVxlan *props,
@@ -652,6 +731,7 @@ typedef struct {
 	void        (*wifi_set_powersave)    (NMPlatform *, int ifindex, guint32 powersave);
 	guint32     (*wifi_find_frequency)   (NMPlatform *, int ifindex, const guint32 *freqs);
 	void        (*wifi_indicate_addressing_running) (NMPlatform *, int ifindex, gboolean running);
+	gboolean    (*wifi_watch_events)     (NMPlatform *, int ifindex, NMPlatformWifiEventFunc callback, gpointer user_data);
 
 	guint32     (*mesh_get_channel)      (NMPlatform *, int ifindex);
 	gboolean    (*mesh_set_channel)      (NMPlatform *, int ifindex, guint32 channel);
@@ -687,11 +767,16 @@ typedef struct {
 	gboolean (*ip6_route_add) (NMPlatform *, const NMPlatformIP6Route *route);
 	gboolean (*ip4_route_delete) (NMPlatform *, int ifindex, in_addr_t network, guint8 plen, guint32 metric);
 	gboolean (*ip6_route_delete) (NMPlatform *, int ifindex, struct in6_addr network, guint8 plen, guint32 metric);
+	gboolean (*ip_route_batch) (NMPlatform *, int addr_family, NMPlatformIPRouteBatchEntry *entries, guint n_entries);
+	gboolean (*ip4_default_route_set_multipath) (NMPlatform *, guint32 metric, NMIPConfigSource source, const NMPlatformIP4Nexthop *nexthops, guint n_nexthops);
 	const NMPlatformIP4Route *(*ip4_route_get) (NMPlatform *, int ifindex, in_addr_t network, guint8 plen, guint32 metric);
 	const NMPlatformIP6Route *(*ip6_route_get) (NMPlatform *, int ifindex, struct in6_addr network, guint8 plen, guint32 metric);
 
 	gboolean (*check_support_kernel_extended_ifa_flags) (NMPlatform *);
 	gboolean (*check_support_user_ipv6ll) (NMPlatform *);
+
+	void (*statistics_foreach) (NMPlatform *self, NMPlatformStatisticsFunc func, gpointer user_data);
+	void (*memory_usage_foreach) (NMPlatform *self, NMMemoryUsageFunc func, gpointer user_data);
 } NMPlatformClass;
 
 /* NMPlatform signals
@@ -711,8 +796,44 @@ typedef struct {
 #define NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED "ip4-route-changed"
 #define NM_PLATFORM_SIGNAL_IP6_ROUTE_CHANGED "ip6-route-changed"
 
+/* In addition to the signals above, "changes" reports all the changes
+ * at once. Platform collects them while it is processing events and
+ * emits the signal once per pass, or immediately when nothing is pending.
+ * Listeners that only need to know that something changed (or on which
+ * ifindex) should prefer this signal over one emission per object. */
+#define NM_PLATFORM_SIGNAL_CHANGES "changes"
+
+typedef struct {
+	NMPObjectType obj_type;
+	NMPlatformSignalChangeType change_type;
+	int ifindex;
+	union {
+		NMPlatformObject     object;
+		NMPlatformLink       link;
+		NMPlatformIP4Address ip4_address;
+		NMPlatformIP6Address ip6_address;
+		NMPlatformIP4Route   ip4_route;
+		NMPlatformIP6Route   ip6_route;
+	};
+} NMPlatformChange;
+
+typedef struct {
+	/* the changes in the order in which the signals were emitted. */
+	const NMPlatformChange *changes;
+	guint len;
+
+	/* the object types in @changes, as flags (1 << NMPObjectType). */
+	guint obj_types;
+} NMPlatformChanges;
+
+#define NM_PLATFORM_CHANGES_HAS_TYPE(changes, obj_type) NM_FLAGS_ANY ((changes)->obj_types, (1u << (obj_type)))
+
 const char *nm_platform_signal_change_type_to_string (NMPlatformSignalChangeType change_type);
 
+void nm_platform_changes_freeze (NMPlatform *self);
+void nm_platform_changes_thaw (NMPlatform *self);
+guint64 nm_platform_changes_get_stamp (NMPlatform *self, NMPObjectType obj_type, int ifindex);
+
 /*****************************************************************************/
 
 GType nm_platform_get_type (void);
@@ -807,8 +928,19 @@ gboolean nm_platform_link_supports_slaves (NMPlatform *self, int ifindex);
 const char *nm_platform_link_get_type_name (NMPlatform *self, int ifindex);
 
 gboolean nm_platform_link_refresh (NMPlatform *self, int ifindex);
+void nm_platform_link_refresh_all (NMPlatform *self);
 void nm_platform_process_events (NMPlatform *self);
 
+void nm_platform_statistics_foreach (NMPlatform *self,
+                                     NMPlatformStatisticsFunc func,
+                                     gpointer user_data);
+void nm_platform_memory_usage_foreach (NMPlatform *self,
+                                       NMMemoryUsageFunc func,
+                                       gpointer user_data);
+void nm_platform_counter_add (NMPlatform *self,
+                              NMPlatformCounter counter,
+                              guint64 n);
+
 gboolean nm_platform_link_set_up (NMPlatform *self, int ifindex, gboolean *out_no_firmware);
 gboolean nm_platform_link_set_down (NMPlatform *self, int ifindex);
 gboolean nm_platform_link_set_arp (NMPlatform *self, int ifindex);
@@ -838,6 +970,11 @@ gboolean nm_platform_link_supports_carrier_detect (NMPlatform *self, int ifindex
 gboolean nm_platform_link_supports_vlans (NMPlatform *self, int ifindex);
 
 gboolean nm_platform_link_enslave (NMPlatform *self, int master, int slave);
+void nm_platform_link_enslave_many (NMPlatform *self,
+                                    int master,
+                                    const int *slaves,
+                                    guint n_slaves,
+                                    gboolean *out_success);
 gboolean nm_platform_link_release (NMPlatform *self, int master, int slave);
 
 gboolean nm_platform_sysctl_master_set_option (NMPlatform *self, int ifindex, const char *option, const char *value);
@@ -845,6 +982,14 @@ char *nm_platform_sysctl_master_get_option (NMPlatform *self, int ifindex, const
 gboolean nm_platform_sysctl_slave_set_option (NMPlatform *self, int ifindex, const char *option, const char *value);
 char *nm_platform_sysctl_slave_get_option (NMPlatform *self, int ifindex, const char *option);
 
+char **nm_platform_link_get_queues (NMPlatform *self, int ifindex, gboolean tx);
+gboolean nm_platform_link_set_queue_option (NMPlatform *self, int ifindex, const char *queue, const char *option, const char *value);
+char *nm_platform_link_get_queue_option (NMPlatform *self, int ifindex, const char *queue, const char *option);
+char **nm_platform_link_get_irqs (NMPlatform *self, int ifindex);
+char *nm_platform_link_get_numa_cpus (NMPlatform *self, int ifindex);
+gboolean nm_platform_irq_set_affinity (NMPlatform *self, const char *irq, const char *cpus);
+char *nm_platform_irq_get_affinity (NMPlatform *self, const char *irq);
+
 const NMPObject *nm_platform_link_get_lnk (NMPlatform *self, int ifindex, NMLinkType link_type, const NMPlatformLink **out_link);
 const NMPlatformLnkGre *nm_platform_link_get_lnk_gre (NMPlatform *self, int ifindex, const NMPlatformLink **out_link);
 const NMPlatformLnkIp6Tnl *nm_platform_link_get_lnk_ip6tnl (NMPlatform *self, int ifindex, const NMPlatformLink **out_link);
@@ -877,6 +1022,13 @@ gboolean nm_platform_link_vlan_change (NMPlatform *self,
                                        const NMVlanQosMapping *egress_map,
                                        gsize n_egress_map);
 
+gboolean nm_platform_link_bridge_change (NMPlatform *self,
+                                         int ifindex,
+                                         const NMPlatformBridgeOptions *options);
+gboolean nm_platform_link_bridge_port_change (NMPlatform *self,
+                                              int ifindex,
+                                              const NMPlatformBridgePortOptions *options);
+
 NMPlatformError nm_platform_link_vxlan_add (NMPlatform *self,
                                             const char *name,
                                             const NMPlatformLnkVxlan *props,
@@ -914,6 +1066,7 @@ void        nm_platform_wifi_set_mode         (NMPlatform *self, int ifindex, NM
 void        nm_platform_wifi_set_powersave    (NMPlatform *self, int ifindex, guint32 powersave);
 guint32     nm_platform_wifi_find_frequency   (NMPlatform *self, int ifindex, const guint32 *freqs);
 void        nm_platform_wifi_indicate_addressing_running (NMPlatform *self, int ifindex, gboolean running);
+gboolean    nm_platform_wifi_watch_events     (NMPlatform *self, int ifindex, NMPlatformWifiEventFunc callback, gpointer user_data);
 
 guint32     nm_platform_mesh_get_channel      (NMPlatform *self, int ifindex);
 gboolean    nm_platform_mesh_set_channel      (NMPlatform *self, int ifindex, guint32 channel);
@@ -973,8 +1126,9 @@ gboolean nm_platform_ip6_address_add (NMPlatform *self,
                                       guint32 flags);
 gboolean nm_platform_ip4_address_delete (NMPlatform *self, int ifindex, in_addr_t address, guint8 plen, in_addr_t peer_address);
 gboolean nm_platform_ip6_address_delete (NMPlatform *self, int ifindex, struct in6_addr address, guint8 plen);
-gboolean nm_platform_ip4_address_sync (NMPlatform *self, int ifindex, const GArray *known_addresses, GPtrArray **out_added_addresses);
-gboolean nm_platform_ip6_address_sync (NMPlatform *self, int ifindex, const GArray *known_addresses, gboolean keep_link_local);
+gboolean nm_platform_ip4_address_sync (NMPlatform *self, int ifindex, const GArray *known_addresses, NMPlatformAddressCommit *commit, GPtrArray **out_added_addresses);
+gboolean nm_platform_ip6_address_sync (NMPlatform *self, int ifindex, const GArray *known_addresses, NMPlatformAddressCommit *commit, gboolean keep_link_local);
+void nm_platform_address_commit_clear (NMPlatformAddressCommit *commit);
 gboolean nm_platform_address_flush (NMPlatform *self, int ifindex);
 
 const NMPlatformIP4Route *nm_platform_ip4_route_get (NMPlatform *self, int ifindex, in_addr_t network, guint8 plen, guint32 metric);
@@ -985,6 +1139,8 @@ gboolean nm_platform_ip4_route_add (NMPlatform *self, const NMPlatformIP4Route *
 gboolean nm_platform_ip6_route_add (NMPlatform *self, const NMPlatformIP6Route *route);
 gboolean nm_platform_ip4_route_delete (NMPlatform *self, int ifindex, in_addr_t network, guint8 plen, guint32 metric);
 gboolean nm_platform_ip6_route_delete (NMPlatform *self, int ifindex, struct in6_addr network, guint8 plen, guint32 metric);
+gboolean nm_platform_ip_route_batch (NMPlatform *self, int addr_family, NMPlatformIPRouteBatchEntry *entries, guint n_entries);
+gboolean nm_platform_ip4_default_route_set_multipath (NMPlatform *self, guint32 metric, NMIPConfigSource source, const NMPlatformIP4Nexthop *nexthops, guint n_nexthops);
 
 const char *nm_platform_link_to_string (const NMPlatformLink *link, char *buf, gsize len);
 const char *nm_platform_lnk_gre_to_string (const NMPlatformLnkGre *lnk, char *buf, gsize len);
@@ -1035,5 +1191,9 @@ int nm_platform_ip_address_cmp_expiry (const NMPlatformIPAddress *a, const NMPla
 gboolean nm_platform_ethtool_set_wake_on_lan (NMPlatform *self, int ifindex, NMSettingWiredWakeOnLan wol, const char *wol_password);
 gboolean nm_platform_ethtool_set_link_settings (NMPlatform *self, int ifindex, gboolean autoneg, guint32 speed, NMPlatformLinkDuplexType duplex);
 gboolean nm_platform_ethtool_get_link_settings (NMPlatform *self, int ifindex, gboolean *out_autoneg, guint32 *out_speed, NMPlatformLinkDuplexType *out_duplex);
+gboolean nm_platform_ethtool_set_ring (NMPlatform *self, int ifindex, guint32 rx_pending, guint32 tx_pending);
+gboolean nm_platform_ethtool_set_channels (NMPlatform *self, int ifindex, guint32 combined_count);
+gboolean nm_platform_ethtool_set_coalesce (NMPlatform *self, int ifindex, gint32 rx_usecs, gint32 tx_usecs);
+gboolean nm_platform_ethtool_set_offloads (NMPlatform *self, int ifindex, int gro, int tso, int lro);
 
 #endif /* __NETWORKMANAGER_PLATFORM_H__ */
@@ -26,6 +26,7 @@
 #include <sys/mount.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/socket.h>
 
 #include "NetworkManagerUtils.h"
 
@@ -93,6 +94,11 @@ NM_GOBJECT_PROPERTIES_DEFINE_BASE (
 typedef struct {
 	int fd_net;
 	int fd_mnt;
+
+	/* resources that belong to the namespace, opened on first use.
+	 * See nmp_netns_get_fd_ioctl() and nmp_netns_get_fd_sysfs_net(). */
+	int fd_ioctl;
+	int fd_sysfs_net;
 } NMPNetnsPrivate;
 
 struct _NMPNetns {
@@ -416,6 +422,80 @@ nmp_netns_get_fd_mnt (NMPNetns *self)
 	return NMP_NETNS_GET_PRIVATE (self)->fd_mnt;
 }
 
+/**
+ * nmp_netns_get_fd_ioctl:
+ * @self: the #NMPNetns instance
+ *
+ * Returns a datagram socket that lives in the network namespace of @self,
+ * for ioctl() calls like SIOCETHTOOL. The socket is created on first use
+ * and owned by @self, so that later calls don't need to switch into the
+ * namespace.
+ *
+ * Returns: the socket or -1 on failure.
+ */
+int
+nmp_netns_get_fd_ioctl (NMPNetns *self)
+{
+	NMPNetnsPrivate *priv;
+	int errsv;
+
+	g_return_val_if_fail (NMP_IS_NETNS (self), -1);
+
+	priv = NMP_NETNS_GET_PRIVATE (self);
+	if (G_UNLIKELY (priv->fd_ioctl < 0)) {
+		nm_auto_pop_netns NMPNetns *netns_pop = NULL;
+
+		if (!nmp_netns_push_type (self, CLONE_NEWNET))
+			return -1;
+		netns_pop = self;
+
+		priv->fd_ioctl = socket (PF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+		if (priv->fd_ioctl < 0) {
+			errsv = errno;
+			_LOGE (self, "failed to create ioctl socket: %s", g_strerror (errsv));
+			errno = errsv;
+		}
+	}
+	return priv->fd_ioctl;
+}
+
+/**
+ * nmp_netns_get_fd_sysfs_net:
+ * @self: the #NMPNetns instance
+ *
+ * Like nmp_netns_get_fd_ioctl(), but returns a directory file descriptor
+ * to "/sys/class/net" as seen from within @self.
+ *
+ * Returns: the directory file descriptor or -1 on failure.
+ */
+int
+nmp_netns_get_fd_sysfs_net (NMPNetns *self)
+{
+	NMPNetnsPrivate *priv;
+	int errsv;
+
+	g_return_val_if_fail (NMP_IS_NETNS (self), -1);
+
+	priv = NMP_NETNS_GET_PRIVATE (self);
+	if (G_UNLIKELY (priv->fd_sysfs_net < 0)) {
+		nm_auto_pop_netns NMPNetns *netns_pop = NULL;
+
+		/* sysfs shows the devices of the netns that mounted it. Hence, we
+		 * need the mount namespace. */
+		if (!nmp_netns_push (self))
+			return -1;
+		netns_pop = self;
+
+		priv->fd_sysfs_net = open ("/sys/class/net", O_DIRECTORY | O_CLOEXEC);
+		if (priv->fd_sysfs_net < 0) {
+			errsv = errno;
+			_LOGE (self, "failed to open /sys/class/net: %s", g_strerror (errsv));
+			errno = errsv;
+		}
+	}
+	return priv->fd_sysfs_net;
+}
+
 /*****************************************************************************/
 
 static gboolean
@@ -694,6 +774,10 @@ set_property (GObject *object, guint prop_id,
 static void
 nmp_netns_init (NMPNetns *self)
 {
+	NMPNetnsPrivate *priv = NMP_NETNS_GET_PRIVATE (self);
+
+	priv->fd_ioctl = -1;
+	priv->fd_sysfs_net = -1;
 }
 
 static void
@@ -712,6 +796,16 @@ dispose (GObject *object)
 		priv->fd_mnt = 0;
 	}
 
+	if (priv->fd_ioctl >= 0) {
+		close (priv->fd_ioctl);
+		priv->fd_ioctl = -1;
+	}
+
+	if (priv->fd_sysfs_net >= 0) {
+		close (priv->fd_sysfs_net);
+		priv->fd_sysfs_net = -1;
+	}
+
 	G_OBJECT_CLASS (nmp_netns_parent_class)->dispose (object);
 }
 
@@ -50,6 +50,9 @@ gboolean nmp_netns_is_initial (void);
 int nmp_netns_get_fd_net (NMPNetns *self);
 int nmp_netns_get_fd_mnt (NMPNetns *self);
 
+int nmp_netns_get_fd_ioctl (NMPNetns *self);
+int nmp_netns_get_fd_sysfs_net (NMPNetns *self);
+
 static inline void
 _nm_auto_pop_netns (NMPNetns **p)
 {
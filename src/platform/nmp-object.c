@@ -140,7 +140,7 @@ _link_get_driver (struct udev_device *udevice, const char *kind, int ifindex)
 	if (ifindex > 0) {
 		NMPUtilsEthtoolDriverInfo driver_info;
 
-		if (nmp_utils_ethtool_get_driver_info (ifindex, &driver_info)) {
+		if (nmp_utils_ethtool_get_driver_info (NULL, ifindex, &driver_info)) {
 			if (driver_info.driver[0])
 				return g_intern_string (driver_info.driver);
 		}
@@ -165,7 +165,8 @@ _nmp_object_fixup_link_udev_fields (NMPObject *obj, gboolean use_udev)
 		driver = _link_get_driver (obj->_link.udev.device,
 		                           obj->link.kind,
 		                           obj->link.ifindex);
-		if (obj->_link.udev.device)
+		if (   obj->_link.udev.device
+		    || obj->_link.udev.deferred)
 			initialized = TRUE;
 		else if (!use_udev) {
 			/* If we don't use udev, we immediately mark the link as initialized.
@@ -183,6 +184,37 @@ _nmp_object_fixup_link_udev_fields (NMPObject *obj, gboolean use_udev)
 	obj->link.initialized = initialized;
 }
 
+/**
+ * nmp_object_link_udev_needed:
+ * @obj: the link object
+ *
+ * From udev we get the driver, the NM_UNMANAGED property and the syspath
+ * of a link. For some purely virtual link types the driver is as well
+ * known from netlink and the rest is rarely needed. On hosts with
+ * many such links, keeping a udev device for each of them is costly.
+ *
+ * Returns: whether the udev device of @obj should be kept in the
+ *   cache. If not, it is only looked up on demand.
+ */
+gboolean
+nmp_object_link_udev_needed (const NMPObject *obj)
+{
+	nm_assert (NMP_OBJECT_GET_TYPE (obj) == NMP_OBJECT_TYPE_LINK);
+
+	/* without netlink, we don't know the type yet. */
+	if (!obj->_link.netlink.is_in_netlink)
+		return TRUE;
+
+	switch (obj->link.type) {
+	case NM_LINK_TYPE_TAP:
+	case NM_LINK_TYPE_TUN:
+	case NM_LINK_TYPE_VETH:
+		return FALSE;
+	default:
+		return TRUE;
+	}
+}
+
 static void
 _nmp_object_fixup_link_master_connected (NMPObject *obj, const NMPCache *cache)
 {
@@ -214,6 +246,88 @@ nmp_object_ref (NMPObject *obj)
 	return obj;
 }
 
+/*****************************************************************************/
+
+/* Parsing netlink messages creates (and often right away releases) a large
+ * number of objects, for example during a dump of all routes. Instead of
+ * going through the slice allocator each time, keep a bounded number of
+ * released objects per object type for reuse.
+ *
+ * NMPObject instances are only used from the main thread, so the pools
+ * are not thread safe. */
+
+#define NMP_OBJECT_POOL_SIZE_MAX 256
+
+typedef struct {
+	gpointer free_list;
+	guint n_free;
+	guint n_alive;
+	guint64 n_allocated;
+	guint64 n_recycled;
+} NMPObjectPool;
+
+static NMPObjectPool _nmp_object_pools[NMP_OBJECT_TYPE_MAX];
+
+#define _nmp_object_pool_get(klass) (&_nmp_object_pools[(klass)->obj_type - 1])
+
+static gpointer
+_nmp_object_pool_alloc (const NMPClass *klass)
+{
+	NMPObjectPool *pool = _nmp_object_pool_get (klass);
+	gsize size = klass->sizeof_data + G_STRUCT_OFFSET (NMPObject, object);
+	gpointer mem;
+
+	pool->n_allocated++;
+	pool->n_alive++;
+
+	if (!pool->free_list)
+		return g_slice_alloc0 (size);
+
+	/* the first pointer of a pooled object links to the next one. */
+	mem = pool->free_list;
+	pool->free_list = *((gpointer *) mem);
+	pool->n_free--;
+	pool->n_recycled++;
+	memset (mem, 0, size);
+	return mem;
+}
+
+static void
+_nmp_object_pool_free (const NMPClass *klass, gpointer mem)
+{
+	NMPObjectPool *pool = _nmp_object_pool_get (klass);
+
+	nm_assert (pool->n_alive > 0);
+	pool->n_alive--;
+
+	if (pool->n_free >= NMP_OBJECT_POOL_SIZE_MAX) {
+		g_slice_free1 (klass->sizeof_data + G_STRUCT_OFFSET (NMPObject, object), mem);
+		return;
+	}
+
+	*((gpointer *) mem) = pool->free_list;
+	pool->free_list = mem;
+	pool->n_free++;
+}
+
+void
+nmp_object_pool_get_stats (NMPObjectType obj_type, NMPObjectPoolStats *out_stats)
+{
+	const NMPClass *klass = nmp_class_from_type (obj_type);
+	const NMPObjectPool *pool;
+
+	g_return_if_fail (klass);
+	g_return_if_fail (out_stats);
+
+	pool = _nmp_object_pool_get (klass);
+	out_stats->n_alive = pool->n_alive;
+	out_stats->n_pooled = pool->n_free;
+	out_stats->n_allocated = pool->n_allocated;
+	out_stats->n_recycled = pool->n_recycled;
+}
+
+/*****************************************************************************/
+
 void
 nmp_object_unref (NMPObject *obj)
 {
@@ -226,7 +340,7 @@ nmp_object_unref (NMPObject *obj)
 			nm_assert (!obj->is_cached);
 			if (klass->cmd_obj_dispose)
 				klass->cmd_obj_dispose (obj);
-			g_slice_free1 (klass->sizeof_data + G_STRUCT_OFFSET (NMPObject, object), obj);
+			_nmp_object_pool_free (klass, obj);
 		}
 	}
 }
@@ -239,6 +353,10 @@ _vt_cmd_obj_dispose_link (NMPObject *obj)
 		obj->_link.udev.device = NULL;
 	}
 	nmp_object_unref (obj->_link.netlink.lnk);
+	if (obj->_link.netlink.lnk_info_data)
+		g_bytes_unref (obj->_link.netlink.lnk_info_data);
+	if (obj->_link.netlink.attrs)
+		g_bytes_unref (obj->_link.netlink.attrs);
 }
 
 static void
@@ -257,7 +375,7 @@ _nmp_object_new_from_class (const NMPClass *klass)
 	nm_assert (klass->sizeof_data > 0);
 	nm_assert (klass->sizeof_public > 0 && klass->sizeof_public <= klass->sizeof_data);
 
-	obj = g_slice_alloc0 (klass->sizeof_data + G_STRUCT_OFFSET (NMPObject, object));
+	obj = _nmp_object_pool_alloc (klass);
 	obj->_class = klass;
 	obj->_ref_count = 1;
 	return obj;
@@ -618,6 +736,8 @@ _vt_cmd_obj_cmp_link (const NMPObject *obj1, const NMPObject *obj2)
 		 * Have this check as very last. */
 		return (obj1->_link.udev.device < obj2->_link.udev.device) ? -1 : 1;
 	}
+	if (obj1->_link.udev.deferred != obj2->_link.udev.deferred)
+		return obj1->_link.udev.deferred ? 1 : -1;
 	return 0;
 }
 
@@ -692,6 +812,20 @@ _vt_cmd_obj_copy_link (NMPObject *dst, const NMPObject *src)
 			nmp_object_unref (dst->_link.netlink.lnk);
 		dst->_link.netlink.lnk = src->_link.netlink.lnk;
 	}
+	if (dst->_link.netlink.lnk_info_data != src->_link.netlink.lnk_info_data) {
+		if (src->_link.netlink.lnk_info_data)
+			g_bytes_ref (src->_link.netlink.lnk_info_data);
+		if (dst->_link.netlink.lnk_info_data)
+			g_bytes_unref (dst->_link.netlink.lnk_info_data);
+		dst->_link.netlink.lnk_info_data = src->_link.netlink.lnk_info_data;
+	}
+	if (dst->_link.netlink.attrs != src->_link.netlink.attrs) {
+		if (src->_link.netlink.attrs)
+			g_bytes_ref (src->_link.netlink.attrs);
+		if (dst->_link.netlink.attrs)
+			g_bytes_unref (dst->_link.netlink.attrs);
+		dst->_link.netlink.attrs = src->_link.netlink.attrs;
+	}
 	dst->_link = src->_link;
 }
 
@@ -960,6 +1094,8 @@ _NM_UTILS_LOOKUP_DEFINE (static, _nmp_cache_id_size_by_type, NMPCacheIdType, gui
 	NM_UTILS_LOOKUP_ITEM (NMP_CACHE_ID_TYPE_ROUTES_VISIBLE_BY_IFINDEX_NO_DEFAULT,   nm_offsetofend (NMPCacheId, object_type_by_ifindex)),
 	NM_UTILS_LOOKUP_ITEM (NMP_CACHE_ID_TYPE_ROUTES_VISIBLE_BY_IFINDEX_ONLY_DEFAULT, nm_offsetofend (NMPCacheId, object_type_by_ifindex)),
 	NM_UTILS_LOOKUP_ITEM (NMP_CACHE_ID_TYPE_LINK_BY_IFNAME,                         nm_offsetofend (NMPCacheId, link_by_ifname)),
+	NM_UTILS_LOOKUP_ITEM (NMP_CACHE_ID_TYPE_LINK_BY_ADDRESS,                        nm_offsetofend (NMPCacheId, link_by_address)),
+	NM_UTILS_LOOKUP_ITEM (NMP_CACHE_ID_TYPE_LINK_BY_MASTER,                         nm_offsetofend (NMPCacheId, link_by_master)),
 	NM_UTILS_LOOKUP_ITEM (NMP_CACHE_ID_TYPE_ROUTES_BY_DESTINATION_IP4,              nm_offsetofend (NMPCacheId, routes_by_destination_ip4)),
 	NM_UTILS_LOOKUP_ITEM (NMP_CACHE_ID_TYPE_ROUTES_BY_DESTINATION_IP6,              nm_offsetofend (NMPCacheId, routes_by_destination_ip6)),
 	NM_UTILS_LOOKUP_ITEM_IGNORE (NMP_CACHE_ID_TYPE_NONE),
@@ -1113,6 +1249,34 @@ nmp_cache_id_init_link_by_ifname (NMPCacheId *id,
 	return id;
 }
 
+NMPCacheId *
+nmp_cache_id_init_link_by_address (NMPCacheId *id,
+                                   gconstpointer address,
+                                   gsize length)
+{
+	if (   !address
+	    || length == 0
+	    || length > sizeof (id->link_by_address.data))
+		g_return_val_if_reached (id);
+
+	_nmp_cache_id_init (id, NMP_CACHE_ID_TYPE_LINK_BY_ADDRESS);
+
+	id->link_by_address.len = length;
+	memcpy (id->link_by_address.data, address, length);
+	memset (&id->link_by_address.data[length], 0, sizeof (id->link_by_address.data) - length);
+
+	return id;
+}
+
+NMPCacheId *
+nmp_cache_id_init_link_by_master (NMPCacheId *id,
+                                  int master)
+{
+	_nmp_cache_id_init (id, NMP_CACHE_ID_TYPE_LINK_BY_MASTER);
+	memcpy (&id->link_by_master._misaligned_master, &master, sizeof (int));
+	return id;
+}
+
 NMPCacheId *
 nmp_cache_id_init_routes_by_destination_ip4 (NMPCacheId *id,
                                              guint32 network,
@@ -1166,6 +1330,8 @@ static const guint8 _supported_cache_ids_link[] = {
 	NMP_CACHE_ID_TYPE_OBJECT_TYPE,
 	NMP_CACHE_ID_TYPE_OBJECT_TYPE_VISIBLE_ONLY,
 	NMP_CACHE_ID_TYPE_LINK_BY_IFNAME,
+	NMP_CACHE_ID_TYPE_LINK_BY_ADDRESS,
+	NMP_CACHE_ID_TYPE_LINK_BY_MASTER,
 	0,
 };
 
@@ -1179,6 +1345,19 @@ _vt_cmd_obj_init_cache_id_link (const NMPObject *obj, NMPCacheIdType id_type, NM
 			return TRUE;
 		}
 		break;
+	case NMP_CACHE_ID_TYPE_LINK_BY_ADDRESS:
+		if (   obj->link.addr.len > 0
+		    && obj->link.addr.len <= sizeof (id->link_by_address.data)) {
+			*out_id = nmp_cache_id_init_link_by_address (id, obj->link.addr.data, obj->link.addr.len);
+			return TRUE;
+		}
+		break;
+	case NMP_CACHE_ID_TYPE_LINK_BY_MASTER:
+		if (obj->link.master > 0) {
+			*out_id = nmp_cache_id_init_link_by_master (id, obj->link.master);
+			return TRUE;
+		}
+		break;
 	default:
 		return FALSE;
 	}
@@ -1361,7 +1540,8 @@ nmp_cache_link_connected_needs_toggle (const NMPCache *cache, const NMPObject *m
 	} else {
 		NMPCacheId cache_id;
 
-		links = (const NMPlatformLink *const *) nmp_cache_lookup_multi (cache, nmp_cache_id_init_object_type (&cache_id, NMP_OBJECT_TYPE_LINK, FALSE), &len);
+		/* only look at the links enslaved to @master. */
+		links = (const NMPlatformLink *const *) nmp_cache_lookup_multi (cache, nmp_cache_id_init_link_by_master (&cache_id, master->link.ifindex), &len);
 		for (i = 0; i < len; i++) {
 			const NMPlatformLink *link = links[i];
 			const NMPObject *obj = NMP_OBJECT_UP_CAST ((NMPlatformObject *) link);
@@ -1866,7 +2046,15 @@ nmp_cache_update_netlink (NMPCache *cache, NMPObject *obj, NMPObject **out_obj,
 
 				/* Merge the netlink parts with what we have from udev. */
 				udev_device_unref (obj->_link.udev.device);
-				obj->_link.udev.device = old->_link.udev.device ? udev_device_ref (old->_link.udev.device) : NULL;
+				obj->_link.udev.device = NULL;
+				obj->_link.udev.deferred = old->_link.udev.deferred;
+				if (old->_link.udev.device) {
+					/* now that we know the type, drop a device that we don't need. */
+					if (nmp_object_link_udev_needed (obj))
+						obj->_link.udev.device = udev_device_ref (old->_link.udev.device);
+					else
+						obj->_link.udev.deferred = TRUE;
+				}
 				_nmp_object_fixup_link_udev_fields (obj, cache->use_udev);
 			}
 		} else
@@ -1880,8 +2068,20 @@ nmp_cache_update_netlink (NMPCache *cache, NMPObject *obj, NMPObject **out_obj,
 			return NMP_CACHE_OPS_REMOVED;
 		}
 
-		if (nmp_object_equal (old, obj))
+		if (nmp_object_equal (old, obj)) {
+			if (   NMP_OBJECT_GET_TYPE (obj) == NMP_OBJECT_TYPE_LINK
+			    && obj->_link.netlink.attrs
+			    && old->_link.netlink.attrs != obj->_link.netlink.attrs) {
+				/* the attributes are neither compared nor part of any index,
+				 * so it is fine to update them in the cached object. Otherwise,
+				 * a change that doesn't affect the object would prevent skipping
+				 * the parsing forever. */
+				if (old->_link.netlink.attrs)
+					g_bytes_unref (old->_link.netlink.attrs);
+				old->_link.netlink.attrs = g_bytes_ref (obj->_link.netlink.attrs);
+			}
 			return NMP_CACHE_OPS_UNCHANGED;
+		}
 
 		if (pre_hook)
 			pre_hook (cache, old, obj, NMP_CACHE_OPS_UPDATED, user_data);
@@ -1895,6 +2095,7 @@ nmp_cache_update_link_udev (NMPCache *cache, int ifindex, struct udev_device *ud
 {
 	NMPObject *old;
 	nm_auto_nmpobj NMPObject *obj = NULL;
+	gboolean deferred = FALSE;
 
 	old = (NMPObject *) nmp_cache_lookup_link (cache, ifindex);
 
@@ -1930,10 +2131,16 @@ nmp_cache_update_link_udev (NMPCache *cache, int ifindex, struct udev_device *ud
 		if (out_was_visible)
 			*out_was_visible = nmp_object_is_visible (old);
 
-		if (old->_link.udev.device == udevice)
+		if (udevice && !nmp_object_link_udev_needed (old)) {
+			deferred = TRUE;
+			udevice = NULL;
+		}
+
+		if (   old->_link.udev.device == udevice
+		    && old->_link.udev.deferred == deferred)
 			return NMP_CACHE_OPS_UNCHANGED;
 
-		if (!udevice && !old->_link.netlink.is_in_netlink) {
+		if (!udevice && !deferred && !old->_link.netlink.is_in_netlink) {
 			/* the update would make @old invalid. Remove it. */
 			if (pre_hook)
 				pre_hook (cache, old, NULL, NMP_CACHE_OPS_REMOVED, user_data);
@@ -1945,6 +2152,7 @@ nmp_cache_update_link_udev (NMPCache *cache, int ifindex, struct udev_device *ud
 
 		udev_device_unref (obj->_link.udev.device);
 		obj->_link.udev.device = udevice ? udev_device_ref (udevice) : NULL;
+		obj->_link.udev.deferred = deferred;
 
 		_nmp_object_fixup_link_udev_fields (obj, cache->use_udev);
 
@@ -64,6 +64,12 @@ typedef enum { /*< skip >*/
 	/* index for the link objects by ifname. */
 	NMP_CACHE_ID_TYPE_LINK_BY_IFNAME,
 
+	/* index for the link objects by hardware address. */
+	NMP_CACHE_ID_TYPE_LINK_BY_ADDRESS,
+
+	/* index for the slave links of a master, by the master's ifindex. */
+	NMP_CACHE_ID_TYPE_LINK_BY_MASTER,
+
 	/* all the visible objects of a certain type */
 	NMP_CACHE_ID_TYPE_OBJECT_TYPE_VISIBLE_ONLY,
 
@@ -120,6 +126,17 @@ struct _NMPCacheId {
 			guint8 _id_type;
 			char ifname_short[IFNAMSIZ - 1]; /* don't include the trailing NUL so the struct fits in 4 bytes. */
 		} link_by_ifname;
+		struct _nm_packed {
+			/* NMP_CACHE_ID_TYPE_LINK_BY_ADDRESS */
+			guint8 _id_type;
+			guint8 len;
+			guint8 data[20 /* NM_UTILS_HWADDR_LEN_MAX */];
+		} link_by_address;
+		struct _nm_packed {
+			/* NMP_CACHE_ID_TYPE_LINK_BY_MASTER */
+			guint8 _id_type;
+			int _misaligned_master;
+		} link_by_master;
 		struct _nm_packed {
 			/* NMP_CACHE_ID_TYPE_ROUTES_BY_DESTINATION_IP4 */
 			guint8 _id_type;
@@ -183,6 +200,15 @@ typedef struct {
 
 		/* Additional data that depends on the link-type (IFLA_INFO_DATA) */
 		NMPObject *lnk;
+
+		/* The raw IFLA_INFO_DATA that @lnk was parsed from. As long as
+		 * the kernel sends the same bytes, @lnk is reused without parsing. */
+		GBytes *lnk_info_data;
+
+		/* The RTM_NEWLINK message this object was parsed from, leaving
+		 * out the statistics. It is not part of the identity of the object
+		 * nor compared. See _link_attrs_equal(). */
+		GBytes *attrs;
 	} netlink;
 
 	struct {
@@ -203,6 +229,11 @@ typedef struct {
 		 * that cause access to the udev library context.
 		 */
 		struct udev_device *device;
+
+		/* the link was announced by udev, but its type needs no udev
+		 * data (see nmp_object_link_udev_needed()). Hence the device is
+		 * not retained and looked up on demand. */
+		bool deferred:1;
 	} udev;
 } NMPObjectLink;
 
@@ -381,6 +412,19 @@ NMP_OBJECT_GET_TYPE (const NMPObject *obj)
 
 const NMPClass *nmp_class_from_type (NMPObjectType obj_type);
 
+typedef struct {
+	/* the number of objects of this type that are currently allocated. */
+	guint n_alive;
+	/* the number of released objects that are kept for reuse. */
+	guint n_pooled;
+	/* the total number of allocations, and how many of them were
+	 * served by reusing a pooled object. */
+	guint64 n_allocated;
+	guint64 n_recycled;
+} NMPObjectPoolStats;
+
+void nmp_object_pool_get_stats (NMPObjectType obj_type, NMPObjectPoolStats *out_stats);
+
 NMPObject *nmp_object_ref (NMPObject *object);
 void nmp_object_unref (NMPObject *object);
 NMPObject *nmp_object_new (NMPObjectType obj_type, const NMPlatformObject *plob);
@@ -405,6 +449,7 @@ gboolean nmp_object_is_alive (const NMPObject *obj);
 gboolean nmp_object_is_visible (const NMPObject *obj);
 
 void _nmp_object_fixup_link_udev_fields (NMPObject *obj, gboolean use_udev);
+gboolean nmp_object_link_udev_needed (const NMPObject *obj);
 
 #define nm_auto_nmpobj __attribute__((cleanup(_nm_auto_nmpobj_cleanup)))
 static inline void
@@ -427,6 +472,8 @@ NMPCacheId *nmp_cache_id_init_object_type (NMPCacheId *id, NMPObjectType obj_typ
 NMPCacheId *nmp_cache_id_init_addrroute_visible_by_ifindex (NMPCacheId *id, NMPObjectType obj_type, int ifindex);
 NMPCacheId *nmp_cache_id_init_routes_visible (NMPCacheId *id, NMPObjectType obj_type, gboolean with_default, gboolean with_non_default, int ifindex);
 NMPCacheId *nmp_cache_id_init_link_by_ifname (NMPCacheId *id, const char *ifname);
+NMPCacheId *nmp_cache_id_init_link_by_address (NMPCacheId *id, gconstpointer address, gsize length);
+NMPCacheId *nmp_cache_id_init_link_by_master (NMPCacheId *id, int master);
 NMPCacheId *nmp_cache_id_init_routes_by_destination_ip4 (NMPCacheId *id, guint32 network, guint8 plen, guint32 metric);
 NMPCacheId *nmp_cache_id_init_routes_by_destination_ip6 (NMPCacheId *id, const struct in6_addr *network, guint8 plen, guint32 metric);
 
@@ -0,0 +1,340 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright 2017 Red Hat, Inc.
+ */
+
+/* Replay recorded rtnetlink traffic through the parser of NMLinuxPlatform
+ * and into a NMPCache, without a kernel.
+ *
+ * The recordings are either pcap files captured on a nlmon device
+ *
+ *   ip link add nlmon0 type nlmon && ip link set nlmon0 up
+ *   tcpdump -i nlmon0 -w rtnl.pcap
+ *
+ * or files with the raw netlink messages, as read from the socket. Only
+ * RTM_NEWLINK/DELLINK, RTM_NEWADDR/DELADDR and RTM_NEWROUTE/DELROUTE
+ * messages are replayed. Raw files must only contain NETLINK_ROUTE
+ * messages, while for pcap files other protocols are skipped.
+ *
+ * The results are printed like libnm-core/tests/test-bench, as
+ *
+ *   bench<TAB>replay<TAB>operation<TAB>messages<TAB>ns-per-message
+ */
+
+#include "nm-default.h"
+
+#include <stdlib.h>
+#include <time.h>
+#include <linux/rtnetlink.h>
+
+#include "platform/nm-linux-platform.h"
+#include "platform/nmp-object.h"
+
+#include "nm-test-utils-core.h"
+
+NMTST_DEFINE ();
+
+static struct {
+	int iterations;
+} global_opt = {
+	.iterations = 1,
+};
+
+/*****************************************************************************/
+
+/* count the allocations of the replay by interposing the malloc functions
+ * of glibc. With G_SLICE=always-malloc, this also covers g_slice_*(). */
+
+static struct {
+	gboolean enabled;
+	guint64 n;
+} alloc_count;
+
+#if defined (__GLIBC__)
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t nmemb, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+
+void *
+malloc (size_t size)
+{
+	if (alloc_count.enabled)
+		alloc_count.n++;
+	return __libc_malloc (size);
+}
+
+void *
+calloc (size_t nmemb, size_t size)
+{
+	if (alloc_count.enabled)
+		alloc_count.n++;
+	return __libc_calloc (nmemb, size);
+}
+
+void *
+realloc (void *ptr, size_t size)
+{
+	if (alloc_count.enabled)
+		alloc_count.n++;
+	return __libc_realloc (ptr, size);
+}
+#define HAVE_ALLOC_COUNT 1
+#else
+#define HAVE_ALLOC_COUNT 0
+#endif
+
+/*****************************************************************************/
+
+#define PCAP_MAGIC          0xa1b2c3d4u
+#define PCAP_MAGIC_NSEC     0xa1b23c4du
+#define PCAP_LINKTYPE_NETLINK 253
+
+static guint32
+_pcap_u32 (const guint8 *data, gboolean swap)
+{
+	guint32 v;
+
+	memcpy (&v, data, sizeof (v));
+	return swap ? GUINT32_SWAP_LE_BE (v) : v;
+}
+
+static void
+_add_messages (GPtrArray *msgs, const guint8 *data, gsize len)
+{
+	const struct nlmsghdr *nlh;
+	int remaining = len;
+
+	for (nlh = (const struct nlmsghdr *) data;
+	     NLMSG_OK (nlh, remaining);
+	     nlh = NLMSG_NEXT (nlh, remaining)) {
+		if (!NM_IN_SET (nlh->nlmsg_type,
+		                RTM_NEWLINK, RTM_DELLINK,
+		                RTM_NEWADDR, RTM_DELADDR,
+		                RTM_NEWROUTE, RTM_DELROUTE))
+			continue;
+		g_ptr_array_add (msgs, g_memdup (nlh, nlh->nlmsg_len));
+	}
+}
+
+static gboolean
+_load_file (GPtrArray *msgs, const char *filename, GError **error)
+{
+	gs_free char *contents = NULL;
+	const guint8 *data;
+	gsize len, pos;
+	guint32 magic;
+	gboolean swap;
+
+	if (!g_file_get_contents (filename, &contents, &len, error))
+		return FALSE;
+	data = (const guint8 *) contents;
+
+	magic = len >= 24 ? _pcap_u32 (data, FALSE) : 0;
+	if (   !NM_IN_SET (magic, PCAP_MAGIC, PCAP_MAGIC_NSEC)
+	    && !NM_IN_SET (GUINT32_SWAP_LE_BE (magic), PCAP_MAGIC, PCAP_MAGIC_NSEC)) {
+		/* raw netlink messages */
+		_add_messages (msgs, data, len);
+		return TRUE;
+	}
+
+	swap = !NM_IN_SET (magic, PCAP_MAGIC, PCAP_MAGIC_NSEC);
+	if (_pcap_u32 (&data[20], swap) != PCAP_LINKTYPE_NETLINK) {
+		g_set_error (error, NM_UTILS_ERROR, NM_UTILS_ERROR_UNKNOWN,
+		             "%s: unsupported link type %u of pcap file, expected nlmon capture",
+		             filename, (guint) _pcap_u32 (&data[20], swap));
+		return FALSE;
+	}
+
+	for (pos = 24; pos + 16 <= len; ) {
+		guint32 caplen = _pcap_u32 (&data[pos + 8], swap);
+
+		pos += 16;
+		if (caplen > len - pos)
+			break;
+
+		/* the packet has a 16 byte header, like a cooked capture, which
+		 * ends with the netlink protocol in network byte order. The
+		 * netlink message follows. */
+		if (   caplen > 16
+		    && data[pos + 14] == 0
+		    && data[pos + 15] == NETLINK_ROUTE)
+			_add_messages (msgs, &data[pos + 16], caplen - 16);
+		pos += caplen;
+	}
+	return TRUE;
+}
+
+/*****************************************************************************/
+
+static gint64
+_now_ns (void)
+{
+	struct timespec tp;
+
+	clock_gettime (CLOCK_MONOTONIC, &tp);
+	return (((gint64) tp.tv_sec) * NM_UTILS_NS_PER_SECOND) + tp.tv_nsec;
+}
+
+typedef struct {
+	guint64 n_msgs;
+	guint64 n_parsed;
+	guint64 n_changed;
+	guint64 n_allocs;
+	gint64 parse_ns;
+	gint64 update_ns;
+	gint64 update_max_ns;
+} ReplayStats;
+
+static void
+_replay (GPtrArray *msgs, ReplayStats *stats)
+{
+	NMPCache *cache;
+	guint i;
+
+	cache = nmp_cache_new (FALSE);
+
+	for (i = 0; i < msgs->len; i++) {
+		struct nlmsghdr *nlh = msgs->pdata[i];
+		nm_auto_nmpobj NMPObject *obj = NULL;
+		nm_auto_nmpobj NMPObject *obj_cache = NULL;
+		NMPCacheOpsType cache_op;
+		gboolean was_visible;
+		gint64 t0, t1, t2;
+		gboolean id_only;
+
+		id_only = NM_IN_SET (nlh->nlmsg_type, RTM_DELLINK, RTM_DELADDR, RTM_DELROUTE);
+
+		alloc_count.enabled = TRUE;
+		t0 = _now_ns ();
+
+		obj = nm_linux_platform_object_new_from_nlmsg (cache, nlh, id_only);
+
+		t1 = _now_ns ();
+
+		if (obj) {
+			if (id_only)
+				cache_op = nmp_cache_remove_netlink (cache, obj, &obj_cache, &was_visible, NULL, NULL);
+			else
+				cache_op = nmp_cache_update_netlink (cache, obj, &obj_cache, &was_visible, NULL, NULL);
+		} else
+			cache_op = NMP_CACHE_OPS_UNCHANGED;
+
+		t2 = _now_ns ();
+		alloc_count.enabled = FALSE;
+
+		stats->n_msgs++;
+		stats->parse_ns += t1 - t0;
+		if (obj) {
+			stats->n_parsed++;
+			stats->update_ns += t2 - t1;
+			stats->update_max_ns = MAX (stats->update_max_ns, t2 - t1);
+			if (cache_op != NMP_CACHE_OPS_UNCHANGED)
+				stats->n_changed++;
+		}
+	}
+
+	nmp_cache_free (cache);
+}
+
+/*****************************************************************************/
+
+static gboolean
+read_argv (int *argc, char ***argv)
+{
+	GOptionContext *context;
+	GOptionEntry options[] = {
+		{ "iterations", 'n', 0, G_OPTION_ARG_INT, &global_opt.iterations, "Replay the recording N times", "N" },
+		{ 0 },
+	};
+	gs_free_error GError *error = NULL;
+
+	context = g_option_context_new ("FILE...");
+	g_option_context_set_summary (context, "Replay recorded rtnetlink messages into a NMPCache.");
+	g_option_context_add_main_entries (context, options, NULL);
+
+	if (!g_option_context_parse (context, argc, argv, &error)) {
+		g_warning ("Error parsing command line arguments: %s", error->message);
+		g_option_context_free (context);
+		return FALSE;
+	}
+
+	g_option_context_free (context);
+	return TRUE;
+}
+
+int
+main (int argc, char **argv)
+{
+	gs_unref_ptrarray GPtrArray *msgs = NULL;
+	ReplayStats stats = { 0 };
+	gint64 start_ns, total_ns;
+	int i;
+
+	/* route g_slice_*() through malloc(), so that it gets counted. This
+	 * must happen before GLib initializes GSlice. */
+	setenv ("G_SLICE", "always-malloc", TRUE);
+
+	nmtst_init_with_logging (&argc, &argv, "WARN", "ALL");
+
+	if (!read_argv (&argc, &argv))
+		return 2;
+	if (argc < 2 || global_opt.iterations < 1) {
+		g_printerr ("Usage: %s [--iterations N] FILE...\n", argv[0]);
+		return 2;
+	}
+
+	msgs = g_ptr_array_new_with_free_func (g_free);
+	for (i = 1; i < argc; i++) {
+		gs_free_error GError *error = NULL;
+
+		if (!_load_file (msgs, argv[i], &error)) {
+			g_printerr ("Failure to load recording: %s\n", error->message);
+			return EXIT_FAILURE;
+		}
+	}
+	if (!msgs->len) {
+		g_printerr ("No rtnetlink messages found\n");
+		return EXIT_FAILURE;
+	}
+
+	alloc_count.n = 0;
+	start_ns = _now_ns ();
+	for (i = 0; i < global_opt.iterations; i++)
+		_replay (msgs, &stats);
+	total_ns = _now_ns () - start_ns;
+	stats.n_allocs = alloc_count.n;
+
+	g_print ("replay: %u messages, %d iterations, %"G_GUINT64_FORMAT" parsed, %"G_GUINT64_FORMAT" cache changes\n",
+	         msgs->len, global_opt.iterations, stats.n_parsed, stats.n_changed);
+	g_print ("replay: %.0f messages/sec\n",
+	         (double) stats.n_msgs * NM_UTILS_NS_PER_SECOND / MAX (total_ns, 1));
+	if (HAVE_ALLOC_COUNT) {
+		g_print ("replay: %.2f allocations/message\n",
+		         (double) stats.n_allocs / stats.n_msgs);
+	}
+
+	g_print ("bench\treplay\ttotal\t%"G_GUINT64_FORMAT"\t%.0f\n", stats.n_msgs,
+	         (double) total_ns / stats.n_msgs);
+	g_print ("bench\treplay\tparse\t%"G_GUINT64_FORMAT"\t%.0f\n", stats.n_msgs,
+	         (double) stats.parse_ns / stats.n_msgs);
+	g_print ("bench\treplay\tcache-update\t%"G_GUINT64_FORMAT"\t%.0f\n", stats.n_parsed,
+	         (double) stats.update_ns / MAX (stats.n_parsed, 1));
+	g_print ("bench\treplay\tcache-update-max\t%"G_GUINT64_FORMAT"\t%"G_GINT64_FORMAT"\n", stats.n_parsed,
+	         stats.update_max_ns);
+
+	return EXIT_SUCCESS;
+}
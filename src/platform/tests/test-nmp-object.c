@@ -163,6 +163,8 @@ _nmp_cache_update_netlink (NMPCache *cache, NMPObject *obj, NMPObject **out_obj,
 	obj_old = nmp_cache_lookup_link (cache, obj->object.ifindex);
 	if (obj_old && obj_old->_link.udev.device)
 		obj_clone->_link.udev.device = udev_device_ref (obj_old->_link.udev.device);
+	if (obj_old)
+		obj_clone->_link.udev.deferred = obj_old->_link.udev.deferred;
 	_nmp_object_fixup_link_udev_fields (obj_clone, nmp_cache_use_udev_get (cache));
 
 	g_assert (cache);
@@ -385,6 +387,103 @@ test_cache_link (void)
 	nmp_cache_free (cache);
 }
 
+static const NMPlatformLink pl_link_4 = {
+	.ifindex = 4,
+	.name = "veth0",
+	.type = NM_LINK_TYPE_VETH,
+};
+
+static void
+test_cache_link_udev_deferred (void)
+{
+	NMPCache *cache;
+	NMPObject *obj1, *obj2;
+	gboolean was_visible;
+	struct udev_device *udev_device_4 = g_list_nth_data (global.udev_devices, 0);
+	NMPCacheOpsType ops_type;
+
+	if (!udev_device_4) {
+		g_test_skip ("no udev device");
+		return;
+	}
+
+	cache = nmp_cache_new (TRUE);
+
+	obj1 = nmp_object_new (NMP_OBJECT_TYPE_LINK, (NMPlatformObject *) &pl_link_4);
+	obj1->_link.netlink.is_in_netlink = TRUE;
+	g_assert (!nmp_object_link_udev_needed (obj1));
+	_nmp_cache_update_netlink (cache, obj1, &obj2, &was_visible, NMP_CACHE_OPS_ADDED);
+	ASSERT_nmp_cache_is_consistent (cache);
+	g_assert (!obj2->link.initialized);
+	nmp_object_unref (obj2);
+
+	/* udev announces the link, but the device is not kept. */
+	ops_type = nmp_cache_update_link_udev (cache, pl_link_4.ifindex, udev_device_4, &obj2, &was_visible, NULL, NULL);
+	ASSERT_nmp_cache_is_consistent (cache);
+	g_assert_cmpint (ops_type, ==, NMP_CACHE_OPS_UPDATED);
+	g_assert (was_visible);
+	nmp_object_unref (obj2);
+	obj2 = (NMPObject *) nmp_cache_lookup_link (cache, pl_link_4.ifindex);
+	g_assert (!obj2->_link.udev.device);
+	g_assert (obj2->_link.udev.deferred);
+	g_assert (obj2->link.initialized);
+
+	ops_type = nmp_cache_update_link_udev (cache, pl_link_4.ifindex, udev_device_4, &obj2, &was_visible, NULL, NULL);
+	g_assert_cmpint (ops_type, ==, NMP_CACHE_OPS_UNCHANGED);
+	nmp_object_unref (obj2);
+
+	/* a netlink update keeps the udev state. */
+	_nmp_cache_update_netlink (cache, obj1, &obj2, &was_visible, NMP_CACHE_OPS_UNCHANGED);
+	ASSERT_nmp_cache_is_consistent (cache);
+	g_assert (obj2->_link.udev.deferred);
+	g_assert (obj2->link.initialized);
+	nmp_object_unref (obj2);
+
+	ops_type = nmp_cache_update_link_udev (cache, pl_link_4.ifindex, NULL, &obj2, &was_visible, NULL, NULL);
+	ASSERT_nmp_cache_is_consistent (cache);
+	g_assert_cmpint (ops_type, ==, NMP_CACHE_OPS_UPDATED);
+	nmp_object_unref (obj2);
+	obj2 = (NMPObject *) nmp_cache_lookup_link (cache, pl_link_4.ifindex);
+	g_assert (!obj2->_link.udev.deferred);
+	g_assert (!obj2->link.initialized);
+
+	nmp_object_unref (obj1);
+	nmp_cache_free (cache);
+}
+
+/*****************************************************************************/
+
+static void
+test_object_pool (void)
+{
+	NMPObjectPoolStats stats1, stats2;
+	NMPObject *obj;
+
+	obj = nmp_object_new (NMP_OBJECT_TYPE_LINK, (NMPlatformObject *) &pl_link_2);
+	nmp_object_unref (obj);
+
+	nmp_object_pool_get_stats (NMP_OBJECT_TYPE_LINK, &stats1);
+	g_assert_cmpint (stats1.n_pooled, >, 0);
+
+	obj = nmp_object_new (NMP_OBJECT_TYPE_LINK, (NMPlatformObject *) &pl_link_3);
+	g_assert_cmpint (obj->link.ifindex, ==, pl_link_3.ifindex);
+	g_assert_cmpstr (obj->link.name, ==, pl_link_3.name);
+	g_assert (!obj->_link.netlink.is_in_netlink);
+	g_assert (!obj->_link.udev.device);
+
+	nmp_object_pool_get_stats (NMP_OBJECT_TYPE_LINK, &stats2);
+	g_assert_cmpint (stats2.n_alive, ==, stats1.n_alive + 1);
+	g_assert_cmpint (stats2.n_pooled, ==, stats1.n_pooled - 1);
+	g_assert_cmpint (stats2.n_recycled, ==, stats1.n_recycled + 1);
+	g_assert_cmpint (stats2.n_allocated, ==, stats1.n_allocated + 1);
+
+	nmp_object_unref (obj);
+
+	nmp_object_pool_get_stats (NMP_OBJECT_TYPE_LINK, &stats2);
+	g_assert_cmpint (stats2.n_alive, ==, stats1.n_alive);
+	g_assert_cmpint (stats2.n_pooled, ==, stats1.n_pooled);
+}
+
 /*****************************************************************************/
 
 NMTST_DEFINE ();
@@ -430,6 +529,8 @@ main (int argc, char **argv)
 	}
 
 	g_test_add_func ("/nmp-object/cache_link", test_cache_link);
+	g_test_add_func ("/nmp-object/cache_link_udev_deferred", test_cache_link_udev_deferred);
+	g_test_add_func ("/nmp-object/object_pool", test_object_pool);
 
 	result = g_test_run ();
 
@@ -372,6 +372,54 @@ test_ip4_zero_gateway (void)
 	nm_platform_process_events (NM_PLATFORM_GET);
 }
 
+#define MULTIPATH_METRIC 4242
+
+static gboolean
+_multipath_route_exists (void)
+{
+	return nmtstp_run_command ("ip -4 route show default metric %u | grep -q nexthop", MULTIPATH_METRIC) == 0;
+}
+
+static void
+test_ip4_default_route_multipath (void)
+{
+	const NMPlatformLink *pllink;
+	NMPlatformIP4Nexthop nexthops[2] = { };
+
+	pllink = nmtstp_link_dummy_add (NM_PLATFORM_GET, FALSE, "nm-test-mp");
+	g_assert (nm_platform_link_set_up (NM_PLATFORM_GET, pllink->ifindex, NULL));
+
+	nexthops[0].ifindex = nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME);
+	nexthops[0].weight = 1;
+	nexthops[1].ifindex = pllink->ifindex;
+	nexthops[1].weight = 3;
+
+	g_assert (nm_platform_ip4_default_route_set_multipath (NM_PLATFORM_GET, MULTIPATH_METRIC,
+	                                                       NM_IP_CONFIG_SOURCE_USER, nexthops, 2));
+	g_assert (_multipath_route_exists ());
+
+	/* replacing it with the same route succeeds... */
+	g_assert (nm_platform_ip4_default_route_set_multipath (NM_PLATFORM_GET, MULTIPATH_METRIC,
+	                                                       NM_IP_CONFIG_SOURCE_USER, nexthops, 2));
+	g_assert (_multipath_route_exists ());
+
+	/* ... and restores it after somebody else deleted it. */
+	nmtstp_run_command_check ("ip -4 route del default metric %u", MULTIPATH_METRIC);
+	g_assert (!_multipath_route_exists ());
+	g_assert (nm_platform_ip4_default_route_set_multipath (NM_PLATFORM_GET, MULTIPATH_METRIC,
+	                                                       NM_IP_CONFIG_SOURCE_USER, nexthops, 2));
+	g_assert (_multipath_route_exists ());
+
+	/* deleting a route that is gone already is no failure */
+	g_assert (nm_platform_ip4_default_route_set_multipath (NM_PLATFORM_GET, MULTIPATH_METRIC,
+	                                                       NM_IP_CONFIG_SOURCE_UNKNOWN, NULL, 0));
+	g_assert (!_multipath_route_exists ());
+	g_assert (nm_platform_ip4_default_route_set_multipath (NM_PLATFORM_GET, MULTIPATH_METRIC,
+	                                                       NM_IP_CONFIG_SOURCE_UNKNOWN, NULL, 0));
+
+	nmtstp_link_del (NM_PLATFORM_GET, FALSE, pllink->ifindex, NULL);
+}
+
 static void
 test_ip4_route_options (void)
 {
@@ -509,6 +557,8 @@ _nmtstp_setup_tests (void)
 	g_test_add_func ("/route/ip4_options", test_ip4_route_options);
 	g_test_add_func ("/route/ip6_options", test_ip6_route_options);
 
-	if (nmtstp_is_root_test ())
+	if (nmtstp_is_root_test ()) {
 		g_test_add_func ("/route/ip4_zero_gateway", test_ip4_zero_gateway);
+		g_test_add_func ("/route/ip4_default_route_multipath", test_ip4_default_route_multipath);
+	}
 }
@@ -37,6 +37,10 @@
 #include "platform/nm-platform-utils.h"
 #include "nm-utils.h"
 
+#ifndef NL80211_MULTICAST_GROUP_MLME
+#define NL80211_MULTICAST_GROUP_MLME "mlme"
+#endif
+
 #define _NMLOG_PREFIX_NAME      "wifi-nl80211"
 #define _NMLOG(level, domain, ...) \
 	G_STMT_START { \
@@ -147,6 +151,12 @@ genlmsg_parse (struct nlmsghdr *nlh, int hdrlen, struct nlattr *tb[],
  * Reimplementation of libnl3/genl functions:
  *****************************************************************************/
 
+typedef struct {
+	const char *grp_name;
+	gint32 family_id;
+	gint32 grp_id;
+} ProbeResponseData;
+
 static int
 probe_response (struct nl_msg *msg, void *arg)
 {
@@ -162,25 +172,55 @@ probe_response (struct nl_msg *msg, void *arg)
 	};
 	struct nlattr *tb[CTRL_ATTR_MAX+1];
 	struct nlmsghdr *nlh = nlmsg_hdr (msg);
-	gint32 *response_data = arg;
+	ProbeResponseData *response_data = arg;
 
 	if (genlmsg_parse (nlh, 0, tb, CTRL_ATTR_MAX, ctrl_policy))
 		return NL_SKIP;
 
 	if (tb[CTRL_ATTR_FAMILY_ID])
-		*response_data = nla_get_u16 (tb[CTRL_ATTR_FAMILY_ID]);
+		response_data->family_id = nla_get_u16 (tb[CTRL_ATTR_FAMILY_ID]);
+
+	if (response_data->grp_name && tb[CTRL_ATTR_MCAST_GROUPS]) {
+		struct nlattr *mcgrp;
+		int i;
+
+		nla_for_each_nested (mcgrp, tb[CTRL_ATTR_MCAST_GROUPS], i) {
+			struct nlattr *tb_mcgrp[CTRL_ATTR_MCAST_GRP_MAX + 1];
+
+			if (nla_parse (tb_mcgrp, CTRL_ATTR_MCAST_GRP_MAX,
+			               nla_data (mcgrp), nla_len (mcgrp), NULL) < 0)
+				continue;
+			if (   !tb_mcgrp[CTRL_ATTR_MCAST_GRP_NAME]
+			    || !tb_mcgrp[CTRL_ATTR_MCAST_GRP_ID])
+				continue;
+			if (strncmp (nla_data (tb_mcgrp[CTRL_ATTR_MCAST_GRP_NAME]),
+			             response_data->grp_name,
+			             nla_len (tb_mcgrp[CTRL_ATTR_MCAST_GRP_NAME])) != 0)
+				continue;
+			response_data->grp_id = nla_get_u32 (tb_mcgrp[CTRL_ATTR_MCAST_GRP_ID]);
+			break;
+		}
+	}
 
 	return NL_STOP;
 }
 
+/* Resolves the id of the generic netlink family @name. If @grp_name is
+ * given, also resolves the id of its multicast group @grp_name into
+ * @out_grp_id, or -1 if the family has no such group. */
 static int
-genl_ctrl_resolve (struct nl_sock *sk, const char *name)
+genl_ctrl_resolve (struct nl_sock *sk, const char *name,
+                   const char *grp_name, int *out_grp_id)
 {
 	struct nl_msg *msg;
 	struct nl_cb *cb, *orig;
 	int rc;
 	int result = -NLE_OBJ_NOTFOUND;
-	gint32 response_data = -1;
+	ProbeResponseData response_data = {
+		.grp_name = grp_name,
+		.family_id = -1,
+		.grp_id = -1,
+	};
 
 	if (!(orig = nl_socket_get_cb (sk)))
 		goto out;
@@ -218,8 +258,8 @@ genl_ctrl_resolve (struct nl_sock *sk, const char *name)
 	if (rc < 0)
 		goto out_msg_free;
 
-	if (response_data > 0)
-		result = response_data;
+	if (response_data.family_id > 0)
+		result = response_data.family_id;
 
 out_msg_free:
 	nlmsg_free (msg);
@@ -230,6 +270,7 @@ out:
 		_LOGD (LOGD_WIFI, "genl_ctrl_resolve: resolved \"%s\" as 0x%x", name, result);
 	else
 		_LOGE (LOGD_WIFI, "genl_ctrl_resolve: failed resolve \"%s\"", name);
+	NM_SET_OUT (out_grp_id, result >= 0 ? response_data.grp_id : -1);
 	return result;
 }
 
@@ -245,6 +286,17 @@ typedef struct {
 	guint32 *freqs;
 	int num_freqs;
 	int phy;
+	int mlme_grp;
+
+	/* for wifi_nl80211_watch_events() */
+	struct nl_sock *event_sock;
+	GIOChannel *event_channel;
+	guint event_id;
+	WifiUtilsEventFunc event_callback;
+	gpointer event_user_data;
+	GDestroyNotify event_destroy;
+	bool event_pending:1;
+	bool event_rearm_cqm:1;
 } WifiDataNl80211;
 
 static int
@@ -365,11 +417,17 @@ nl80211_send_and_recv (WifiDataNl80211 *nl80211,
 	                               valid_handler, valid_data);
 }
 
+static gboolean wifi_nl80211_watch_events (WifiData *data,
+                                           WifiUtilsEventFunc callback,
+                                           gpointer user_data,
+                                           GDestroyNotify destroy);
+
 static void
 wifi_nl80211_deinit (WifiData *parent)
 {
 	WifiDataNl80211 *nl80211 = (WifiDataNl80211 *) parent;
 
+	wifi_nl80211_watch_events (parent, NULL, NULL, NULL);
 	if (nl80211->nl_sock)
 		nl_socket_free (nl80211->nl_sock);
 	if (nl80211->nl_cb)
@@ -654,6 +712,7 @@ struct nl80211_station_info {
 	guint32 txrate;
 	gboolean txrate_valid;
 	guint8 signal;
+	gint8 signal_dbm;
 	gboolean signal_valid;
 };
 
@@ -697,6 +756,12 @@ nl80211_station_handler (struct nl_msg *msg, void *arg)
 	                      stats_policy))
 		return NL_SKIP;
 
+	if (sinfo[NL80211_STA_INFO_SIGNAL] != NULL) {
+		info->signal_dbm = (gint8) nla_get_u8 (sinfo[NL80211_STA_INFO_SIGNAL]);
+		info->signal = nl80211_xbm_to_percent (info->signal_dbm, 1);
+		info->signal_valid = TRUE;
+	}
+
 	if (sinfo[NL80211_STA_INFO_TX_BITRATE] == NULL)
 		return NL_SKIP;
 
@@ -712,11 +777,6 @@ nl80211_station_handler (struct nl_msg *msg, void *arg)
 	info->txrate = nla_get_u16 (rinfo[NL80211_RATE_INFO_BITRATE]) * 100;
 	info->txrate_valid = TRUE;
 
-	if (sinfo[NL80211_STA_INFO_SIGNAL] != NULL) {
-		info->signal = nl80211_xbm_to_percent ((gint8) nla_get_u8 (sinfo[NL80211_STA_INFO_SIGNAL]), 1);
-		info->signal_valid = TRUE;
-	}
-
 	return NL_SKIP;
 }
 
@@ -772,6 +832,203 @@ wifi_nl80211_get_qual (WifiData *data)
 	return sta_info.signal;
 }
 
+/*****************************************************************************/
+
+/* The hysteresis in dB around the current signal, after which the kernel
+ * sends a NL80211_CMD_NOTIFY_CQM event. With nl80211_xbm_to_percent(),
+ * one dB is about one percent of signal quality. */
+#define CQM_RSSI_HYST_DBM        3
+
+/* The threshold for when we don't know the current signal. */
+#define CQM_RSSI_THOLD_DEFAULT   -70
+
+static int
+nl80211_set_cqm_rssi (WifiDataNl80211 *nl80211)
+{
+	struct nl80211_station_info sta_info;
+	struct nl_msg *msg;
+	struct nlattr *cqm;
+	gint32 thold;
+
+	/* arm a single threshold at the current signal. The kernel notifies
+	 * us when the signal leaves the range of the hysteresis around it,
+	 * and we re-arm at the new signal. */
+	nl80211_get_ap_info (nl80211, &sta_info);
+	thold = sta_info.signal_valid ? sta_info.signal_dbm : CQM_RSSI_THOLD_DEFAULT;
+
+	msg = nl80211_alloc_msg (nl80211, NL80211_CMD_SET_CQM, 0);
+	if (!msg)
+		return -ENOMEM;
+
+	cqm = nla_nest_start (msg, NL80211_ATTR_CQM);
+	if (!cqm)
+		goto nla_put_failure;
+	NLA_PUT_U32 (msg, NL80211_ATTR_CQM_RSSI_THOLD, (guint32) thold);
+	NLA_PUT_U32 (msg, NL80211_ATTR_CQM_RSSI_HYST, CQM_RSSI_HYST_DBM);
+	nla_nest_end (msg, cqm);
+
+	return nl80211_send_and_recv (nl80211, msg, NULL, NULL);
+
+nla_put_failure:
+	nlmsg_free (msg);
+	return -ENOMEM;
+}
+
+static int
+nl80211_event_handler (struct nl_msg *msg, void *arg)
+{
+	WifiDataNl80211 *nl80211 = arg;
+	struct nlattr *tb[NL80211_ATTR_MAX + 1];
+	struct genlmsghdr *gnlh = nlmsg_data (nlmsg_hdr (msg));
+
+	if (nla_parse (tb, NL80211_ATTR_MAX, genlmsg_attrdata (gnlh, 0),
+	               genlmsg_attrlen (gnlh, 0), NULL) < 0)
+		return NL_SKIP;
+
+	/* the multicast group has the events of all interfaces. */
+	if (   !tb[NL80211_ATTR_IFINDEX]
+	    || nla_get_u32 (tb[NL80211_ATTR_IFINDEX]) != nl80211->parent.ifindex)
+		return NL_SKIP;
+
+	switch (gnlh->cmd) {
+	case NL80211_CMD_NOTIFY_CQM:
+	case NL80211_CMD_CONNECT:
+	case NL80211_CMD_ROAM:
+		/* the threshold is relative to the signal of the previous
+		 * event, or of the previous BSS. */
+		nl80211->event_rearm_cqm = TRUE;
+		/* fall through */
+	case NL80211_CMD_DISCONNECT:
+	case NL80211_CMD_CH_SWITCH_NOTIFY:
+		nl80211->event_pending = TRUE;
+		break;
+	default:
+		break;
+	}
+
+	return NL_SKIP;
+}
+
+static gboolean
+nl80211_event_cb (GIOChannel *channel,
+                  GIOCondition io_condition,
+                  gpointer user_data)
+{
+	WifiDataNl80211 *nl80211 = user_data;
+	int err;
+
+	/* first receive, and only then handle the events, so that the
+	 * callback may stop watching the events. If more messages are
+	 * queued, the watch fires again. */
+	err = nl_recvmsgs_default (nl80211->event_sock);
+	if (err < 0 && err != -NLE_AGAIN) {
+		/* on overruns, we lost events. Pretend that something
+		 * changed, so that the caller re-reads the state. */
+		_LOGD (LOGD_WIFI, "(%d): error reading events: (%d) %s",
+		       nl80211->parent.ifindex, err, nl_geterror (err));
+		nl80211->event_pending = TRUE;
+		nl80211->event_rearm_cqm = TRUE;
+	}
+
+	if (nl80211->event_rearm_cqm) {
+		nl80211->event_rearm_cqm = FALSE;
+		nl80211_set_cqm_rssi (nl80211);
+	}
+
+	if (nl80211->event_pending) {
+		nl80211->event_pending = FALSE;
+		nl80211->event_callback ((WifiData *) nl80211, nl80211->event_user_data);
+	}
+
+	return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+wifi_nl80211_watch_events (WifiData *data,
+                           WifiUtilsEventFunc callback,
+                           gpointer user_data,
+                           GDestroyNotify destroy)
+{
+	WifiDataNl80211 *nl80211 = (WifiDataNl80211 *) data;
+	GDestroyNotify old_destroy;
+	gpointer old_user_data;
+	int err;
+
+	old_destroy = nl80211->event_destroy;
+	old_user_data = nl80211->event_user_data;
+	nl80211->event_callback = NULL;
+	nl80211->event_user_data = NULL;
+	nl80211->event_destroy = NULL;
+
+	if (!callback) {
+		nm_clear_g_source (&nl80211->event_id);
+		if (nl80211->event_channel) {
+			g_io_channel_unref (nl80211->event_channel);
+			nl80211->event_channel = NULL;
+		}
+		if (nl80211->event_sock) {
+			nl_socket_free (nl80211->event_sock);
+			nl80211->event_sock = NULL;
+		}
+		goto out;
+	}
+
+	if (!nl80211->event_sock) {
+		if (nl80211->mlme_grp < 0)
+			goto fail;
+
+		nl80211->event_sock = nl_socket_alloc ();
+		if (!nl80211->event_sock)
+			goto fail;
+
+		/* events are not answers to our requests. */
+		nl_socket_disable_seq_check (nl80211->event_sock);
+
+		if (nl_connect (nl80211->event_sock, NETLINK_GENERIC))
+			goto fail;
+		if (nl_socket_add_membership (nl80211->event_sock, nl80211->mlme_grp))
+			goto fail;
+		if (nl_socket_set_nonblocking (nl80211->event_sock))
+			goto fail;
+		nl_socket_modify_cb (nl80211->event_sock, NL_CB_VALID, NL_CB_CUSTOM,
+		                     nl80211_event_handler, nl80211);
+
+		/* without CQM, we only get events about the association, but
+		 * not about the signal. */
+		err = nl80211_set_cqm_rssi (nl80211);
+		if (err == -EOPNOTSUPP) {
+			_LOGD (LOGD_WIFI, "(%d): driver does not support CQM RSSI events",
+			       nl80211->parent.ifindex);
+			goto fail;
+		}
+
+		nl80211->event_channel = g_io_channel_unix_new (nl_socket_get_fd (nl80211->event_sock));
+		g_io_channel_set_encoding (nl80211->event_channel, NULL, NULL);
+		nl80211->event_id = g_io_add_watch (nl80211->event_channel,
+		                                    G_IO_IN | G_IO_ERR | G_IO_HUP,
+		                                    nl80211_event_cb, nl80211);
+	}
+
+	nl80211->event_callback = callback;
+	nl80211->event_user_data = user_data;
+	nl80211->event_destroy = destroy;
+
+out:
+	if (old_destroy)
+		old_destroy (old_user_data);
+	return !!callback;
+
+fail:
+	if (nl80211->event_sock) {
+		nl_socket_free (nl80211->event_sock);
+		nl80211->event_sock = NULL;
+	}
+	if (destroy)
+		destroy (user_data);
+	callback = NULL;
+	goto out;
+}
+
 #if HAVE_NL80211_CRITICAL_PROTOCOL_CMDS
 static gboolean
 wifi_nl80211_indicate_addressing_running (WifiData *data, gboolean running)
@@ -1068,6 +1325,7 @@ wifi_nl80211_init (int ifindex)
 	nl80211->parent.indicate_addressing_running = wifi_nl80211_indicate_addressing_running;
 #endif
 	nl80211->parent.deinit = wifi_nl80211_deinit;
+	nl80211->parent.watch_events = wifi_nl80211_watch_events;
 
 	nl80211->nl_sock = nl_socket_alloc ();
 	if (nl80211->nl_sock == NULL)
@@ -1076,7 +1334,8 @@ wifi_nl80211_init (int ifindex)
 	if (nl_connect (nl80211->nl_sock, NETLINK_GENERIC))
 		goto error;
 
-	nl80211->id = genl_ctrl_resolve (nl80211->nl_sock, "nl80211");
+	nl80211->id = genl_ctrl_resolve (nl80211->nl_sock, "nl80211",
+	                                 NL80211_MULTICAST_GROUP_MLME, &nl80211->mlme_grp);
 	if (nl80211->id < 0)
 		goto error;
 
@@ -55,6 +55,14 @@ struct WifiData {
 
 	gboolean (*get_wowlan) (WifiData *data);
 
+	/* Call @callback when the association or the signal changes. Passing
+	 * a %NULL @callback stops watching. Returns %FALSE if the backend
+	 * cannot notify about changes, and the caller must poll. */
+	gboolean (*watch_events) (WifiData *data,
+	                          WifiUtilsEventFunc callback,
+	                          gpointer user_data,
+	                          GDestroyNotify destroy);
+
 	/* OLPC Mesh-only functions */
 
 	guint32 (*get_mesh_channel) (WifiData *data);
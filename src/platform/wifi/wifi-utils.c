@@ -163,6 +163,22 @@ wifi_utils_get_wowlan (WifiData *data)
 	return data->get_wowlan (data);
 }
 
+gboolean
+wifi_utils_watch_events (WifiData *data,
+                         WifiUtilsEventFunc callback,
+                         gpointer user_data,
+                         GDestroyNotify destroy)
+{
+	g_return_val_if_fail (data != NULL, FALSE);
+
+	if (!data->watch_events) {
+		if (callback && destroy)
+			destroy (user_data);
+		return FALSE;
+	}
+	return data->watch_events (data, callback, user_data, destroy);
+}
+
 void
 wifi_utils_deinit (WifiData *data)
 {
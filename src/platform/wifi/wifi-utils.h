@@ -66,6 +66,17 @@ gboolean wifi_utils_get_wowlan (WifiData *data);
 
 gboolean wifi_utils_set_powersave (WifiData *data, guint32 powersave);
 
+typedef void (*WifiUtilsEventFunc) (WifiData *data, gpointer user_data);
+
+/* Calls @callback when the association or the signal quality changes,
+ * until called again with a %NULL @callback. Returns %FALSE if the
+ * driver doesn't notify about such changes. In that case, @destroy
+ * is already invoked. */
+gboolean wifi_utils_watch_events (WifiData *data,
+                                  WifiUtilsEventFunc callback,
+                                  gpointer user_data,
+                                  GDestroyNotify destroy);
+
 
 /* OLPC Mesh-only functions */
 guint32 wifi_utils_get_mesh_channel (WifiData *data);
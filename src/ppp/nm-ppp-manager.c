@@ -32,17 +32,9 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <sys/socket.h>
-#include <sys/ioctl.h>
 #include <asm/types.h>
 #include <sys/stat.h>
 
-#include <linux/ppp_defs.h>
-#ifndef aligned_u64
-#define aligned_u64 unsigned long long __attribute__((aligned(8)))
-#endif
-#include <linux/if.h>
-#include <linux/if_ppp.h>
-
 #include "NetworkManagerUtils.h"
 #include "platform/nm-platform.h"
 #include "nm-core-internal.h"
@@ -103,8 +95,9 @@ typedef struct {
 
 	/* Monitoring */
 	char *ip_iface;
-	int monitor_fd;
-	guint monitor_id;
+	int monitor_ifindex;
+	guint64 monitor_rx_bytes;
+	guint64 monitor_tx_bytes;
 } NMPPPManagerPrivate;
 
 struct _NMPPPManager {
@@ -132,48 +125,71 @@ static void _ppp_kill (NMPPPManager *manager);
 
 /*****************************************************************************/
 
-static gboolean
-monitor_cb (gpointer user_data)
+static void
+monitor_emit (NMPPPManager *manager, const NMPlatformLink *pllink)
 {
-	NMPPPManager *manager = NM_PPP_MANAGER (user_data);
 	NMPPPManagerPrivate *priv = NM_PPP_MANAGER_GET_PRIVATE (manager);
-	struct ifreq req;
-	struct ppp_stats stats;
 
-	memset (&req, 0, sizeof (req));
-	memset (&stats, 0, sizeof (stats));
-	req.ifr_data = (caddr_t) &stats;
+	if (   priv->monitor_rx_bytes == pllink->rx_bytes
+	    && priv->monitor_tx_bytes == pllink->tx_bytes)
+		return;
 
-	strncpy (req.ifr_name, priv->ip_iface, sizeof (req.ifr_name));
-	if (ioctl (priv->monitor_fd, SIOCGPPPSTATS, &req) < 0) {
-		if (errno != ENODEV)
-			_LOGW ("could not read ppp stats: %s", strerror (errno));
-	} else {
-		g_signal_emit (manager, signals[STATS], 0,
-		               (guint) stats.p.ppp_ibytes,
-		               (guint) stats.p.ppp_obytes);
-	}
+	priv->monitor_rx_bytes = pllink->rx_bytes;
+	priv->monitor_tx_bytes = pllink->tx_bytes;
+	g_signal_emit (manager, signals[STATS], 0,
+	               (guint) pllink->rx_bytes,
+	               (guint) pllink->tx_bytes);
+}
 
-	return TRUE;
+static void
+monitor_link_changed_cb (NMPlatform *platform,
+                         int obj_type_i,
+                         int ifindex,
+                         const NMPlatformLink *pllink,
+                         int change_type_i,
+                         NMPPPManager *manager)
+{
+	NMPPPManagerPrivate *priv = NM_PPP_MANAGER_GET_PRIVATE (manager);
+	const NMPlatformSignalChangeType change_type = change_type_i;
+
+	if (   ifindex != priv->monitor_ifindex
+	    || change_type != NM_PLATFORM_SIGNAL_CHANGED)
+		return;
+
+	monitor_emit (manager, pllink);
 }
 
 static void
 monitor_stats (NMPPPManager *manager)
 {
 	NMPPPManagerPrivate *priv = NM_PPP_MANAGER_GET_PRIVATE (manager);
+	const NMPlatformLink *pllink;
+	int ifindex;
+
+	/* The counters come with the netlink link messages the platform
+	 * receives anyway, either on kernel notifications or when the device's
+	 * statistics refresh-rate asks for them. There is no need to poll. */
+	ifindex = nm_platform_link_get_ifindex (NM_PLATFORM_GET, priv->ip_iface);
+	if (ifindex <= 0) {
+		_LOGW ("could not monitor PPP stats: interface %s not found", priv->ip_iface);
+		return;
+	}
 
 	/* already monitoring */
-	if (priv->monitor_fd >= 0)
+	if (priv->monitor_ifindex == ifindex)
 		return;
 
-	priv->monitor_fd = socket (AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
-	if (priv->monitor_fd >= 0) {
-		g_warn_if_fail (priv->monitor_id == 0);
-		if (priv->monitor_id)
-			g_source_remove (priv->monitor_id);
-		priv->monitor_id = g_timeout_add_seconds (5, monitor_cb, manager);
-	} else
-		_LOGW ("could not monitor PPP stats: %s", strerror (errno));
+	if (!priv->monitor_ifindex) {
+		g_signal_connect (NM_PLATFORM_GET,
+		                  NM_PLATFORM_SIGNAL_LINK_CHANGED,
+		                  G_CALLBACK (monitor_link_changed_cb),
+		                  manager);
+	}
+	priv->monitor_ifindex = ifindex;
+
+	pllink = nm_platform_link_get (NM_PLATFORM_GET, ifindex);
+	if (pllink)
+		monitor_emit (manager, pllink);
 }
 
 /*****************************************************************************/
@@ -1033,13 +1049,18 @@ _ppp_cleanup (NMPPPManager *manager)
 
 	cancel_get_secrets (manager);
 
-	nm_clear_g_source (&priv->monitor_id);
+	if (priv->monitor_ifindex) {
+		NMPlatform *platform = nm_platform_try_get ();
+		const NMPlatformLink *pllink;
 
-	if (priv->monitor_fd >= 0) {
-		/* Get the stats one last time */
-		monitor_cb (manager);
-		close (priv->monitor_fd);
-		priv->monitor_fd = -1;
+		if (platform) {
+			/* Get the stats one last time */
+			pllink = nm_platform_link_get (platform, priv->monitor_ifindex);
+			if (pllink)
+				monitor_emit (manager, pllink);
+			g_signal_handlers_disconnect_by_func (platform, monitor_link_changed_cb, manager);
+		}
+		priv->monitor_ifindex = 0;
 	}
 
 	nm_clear_g_source (&priv->ppp_timeout_handler);
@@ -1192,7 +1213,6 @@ set_property (GObject *object, guint prop_id,
 static void
 nm_ppp_manager_init (NMPPPManager *manager)
 {
-	NM_PPP_MANAGER_GET_PRIVATE (manager)->monitor_fd = -1;
 }
 
 static NMPPPManager *
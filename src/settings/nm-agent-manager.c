@@ -36,6 +36,7 @@
 #include "nm-simple-connection.h"
 #include "NetworkManagerUtils.h"
 #include "nm-core-internal.h"
+#include "nm-config.h"
 
 #include "introspection/org.freedesktop.NetworkManager.AgentManager.h"
 
@@ -127,11 +128,14 @@ static void request_remove_agent (Request *req, NMSecretAgent *agent, GSList **p
 
 static void request_next_agent (Request *req);
 
+static void req_complete_cancel (Request *req, gboolean is_disposing);
+
 static void _con_get_request_start (Request *req);
 static void _con_save_request_start (Request *req);
 static void _con_del_request_start (Request *req);
 
 static gboolean _con_get_try_complete_early (Request *req);
+static void _con_get_request_start_parallel (Request *req);
 
 /*****************************************************************************/
 
@@ -490,6 +494,11 @@ struct _NMAgentManagerCallId {
 
 					NMAgentSecretsResultFunc callback;
 					gpointer callback_data;
+
+					/* When the agents are asked concurrently, each of them
+					 * is asked by a child request of the original one. */
+					Request *parent;
+					GSList *children;
 				} get;
 			};
 		} con;
@@ -537,6 +546,22 @@ request_free (Request *req)
 	if (req->idle_id)
 		g_source_remove (req->idle_id);
 
+	if (   req->request_type == REQUEST_TYPE_CON_GET
+	    && req->con.get.children) {
+		NMAgentManagerPrivate *priv = NM_AGENT_MANAGER_GET_PRIVATE (req->self);
+		GSList *children, *iter;
+
+		/* Cancel the agents that are still being asked. The children's
+		 * callbacks ignore the result, as they are no longer tracked. */
+		children = g_steal_pointer (&req->con.get.children);
+		for (iter = children; iter; iter = iter->next) {
+			if (!g_hash_table_remove (priv->requests, iter->data))
+				nm_assert_not_reached ();
+			req_complete_cancel (iter->data, FALSE);
+		}
+		g_slist_free (children);
+	}
+
 	if (req->current && req->current_call_id) {
 		/* cancel-secrets invokes the done-callback synchronously -- in which case
 		 * the handler just return.
@@ -818,8 +843,20 @@ request_start (gpointer user_data)
 
 	switch (req->request_type) {
 	case REQUEST_TYPE_CON_GET:
+		/* a child request only exists if its parent couldn't complete early */
+		if (req->con.get.parent)
+			break;
 		if (_con_get_try_complete_early (req))
 			goto out;
+		if (   req->pending
+		    && req->pending->next
+		    && nm_config_data_get_value_boolean (NM_CONFIG_GET_DATA,
+		                                         NM_CONFIG_KEYFILE_GROUP_MAIN,
+		                                         NM_CONFIG_KEYFILE_KEY_MAIN_SECRET_AGENTS_PARALLEL,
+		                                         FALSE)) {
+			_con_get_request_start_parallel (req);
+			goto out;
+		}
 		break;
 	default:
 		break;
@@ -1185,6 +1222,92 @@ _con_get_try_complete_early (Request *req)
 	return FALSE;
 }
 
+static void
+_con_get_parallel_child_done (NMAgentManager *self,
+                              NMAgentManagerCallId call_id,
+                              const char *agent_dbus_owner,
+                              const char *agent_uname,
+                              gboolean agent_has_modify,
+                              const char *setting_name,
+                              NMSecretAgentGetSecretsFlags flags,
+                              GVariant *secrets,
+                              GError *error,
+                              gpointer user_data)
+{
+	Request *child = call_id;
+	Request *req = user_data;
+
+	/* the parent already completed and is cancelling its other children */
+	if (!g_slist_find (req->con.get.children, child))
+		return;
+
+	req->con.get.children = g_slist_remove (req->con.get.children, child);
+
+	if (!error) {
+		_LOGD (NULL, "("LOG_REQ_FMT") secrets returned by agent %s, cancel %u other agents",
+		       LOG_REQ_ARG (req), agent_dbus_owner,
+		       g_slist_length (req->con.get.children));
+		req->con.current_has_modify = agent_has_modify;
+		req_complete (req, secrets, agent_dbus_owner, agent_uname, NULL);
+		return;
+	}
+
+	/* This agent had no secrets or failed; keep waiting for the others.
+	 * Any other error (the user cancelled a dialog, or the request was
+	 * cancelled) ends the request, like it does for sequential requests. */
+	if (   g_error_matches (error, NM_AGENT_MANAGER_ERROR, NM_AGENT_MANAGER_ERROR_NO_SECRETS)
+	    && req->con.get.children)
+		return;
+
+	req_complete_error (req, error);
+}
+
+static void
+_con_get_request_start_parallel (Request *req)
+{
+	NMAgentManager *self = req->self;
+	NMAgentManagerPrivate *priv = NM_AGENT_MANAGER_GET_PRIVATE (self);
+	GSList *agents, *iter;
+
+	nm_assert (req->request_type == REQUEST_TYPE_CON_GET);
+	nm_assert (!req->con.get.children);
+
+	_LOGD (NULL, "("LOG_REQ_FMT") asking %u agents concurrently",
+	       LOG_REQ_ARG (req), g_slist_length (req->pending));
+
+	agents = g_steal_pointer (&req->pending);
+	for (iter = agents; iter; iter = iter->next) {
+		Request *child;
+
+		child = request_new (self,
+		                     REQUEST_TYPE_CON_GET,
+		                     req->detail,
+		                     req->subject);
+		child->con.path = g_strdup (req->con.path);
+		child->con.connection = g_object_ref (req->con.connection);
+		if (req->con.get.existing_secrets)
+			child->con.get.existing_secrets = g_variant_ref (req->con.get.existing_secrets);
+		child->con.get.setting_name = g_strdup (req->con.get.setting_name);
+		child->con.get.hints = g_strdupv (req->con.get.hints);
+		child->con.get.flags = req->con.get.flags;
+		child->con.get.callback = _con_get_parallel_child_done;
+		child->con.get.callback_data = req;
+		child->con.get.parent = req;
+
+		/* the child takes over the reference of the agent */
+		child->pending = g_slist_prepend (NULL, iter->data);
+
+		if (!nm_g_hash_table_add (priv->requests, child))
+			g_assert_not_reached ();
+		req->con.get.children = g_slist_append (req->con.get.children, child);
+
+		/* start each child from its own idle handler, so that no child
+		 * completes the parent while the others are still being set up. */
+		child->idle_id = g_idle_add (request_start, child);
+	}
+	g_slist_free (agents);
+}
+
 /**
  * nm_agent_manager_get_secrets:
  * @self:
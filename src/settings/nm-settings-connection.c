@@ -36,6 +36,7 @@
 #include "NetworkManagerUtils.h"
 #include "nm-core-internal.h"
 #include "nm-audit-manager.h"
+#include "nm-trace.h"
 
 #include "introspection/org.freedesktop.NetworkManager.Settings.Connection.h"
 
@@ -47,6 +48,10 @@
 #define AUTOCONNECT_RETRIES_DEFAULT      4
 #define AUTOCONNECT_RESET_RETRIES_TIMER 300
 
+/* how long changes to the timestamps and seen-bssids databases are kept
+ * in memory before they are written. */
+#define STATE_DB_FLUSH_DELAY_SEC 10
+
 /*****************************************************************************/
 
 static void nm_settings_connection_connection_interface_init (NMConnectionInterface *iface);
@@ -63,6 +68,7 @@ enum {
 	UPDATED,
 	REMOVED,
 	UPDATED_INTERNAL,
+	TIMESTAMP_CHANGED,
 	LAST_SIGNAL
 };
 
@@ -108,6 +114,10 @@ typedef struct _NMSettingsConnectionPrivate {
 	guint64 timestamp;   /* Up-to-date timestamp of connection use */
 	GHashTable *seen_bssids; /* Up-to-date BSSIDs that's been seen for the connection */
 
+	/* The reply of GetSettings(), rebuilt only after the settings, the
+	 * timestamp or the seen BSSIDs changed. */
+	GVariant *getsettings_cached;
+
 	int autoconnect_retries;
 	gint32 autoconnect_retry_time;
 
@@ -145,9 +155,112 @@ G_DEFINE_TYPE_WITH_CODE (NMSettingsConnection, nm_settings_connection, NM_TYPE_E
 
 /*****************************************************************************/
 
+/* The timestamps and seen-bssids databases are read once and kept in
+ * memory. Changes are written behind, batched for STATE_DB_FLUSH_DELAY_SEC
+ * and at shutdown via nm_settings_connection_flush_state_dbs(). */
+typedef struct {
+	const char *group;
+	const char *filename;
+	GKeyFile *keyfile;
+	guint flush_id;
+} StateDb;
+
+static StateDb state_db_timestamps = {
+	.group = "timestamps",
+	.filename = SETTINGS_TIMESTAMPS_FILE,
+};
+
+static StateDb state_db_seen_bssids = {
+	.group = "seen-bssids",
+	.filename = SETTINGS_SEEN_BSSIDS_FILE,
+};
+
+static GKeyFile *
+_state_db_get (StateDb *db)
+{
+	GError *error = NULL;
+
+	if (G_LIKELY (db->keyfile))
+		return db->keyfile;
+
+	db->keyfile = g_key_file_new ();
+	g_key_file_set_list_separator (db->keyfile, ',');
+	if (!g_key_file_load_from_file (db->keyfile, db->filename, G_KEY_FILE_KEEP_COMMENTS, &error)) {
+		if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
+			nm_log_warn (LOGD_SETTINGS, "settings-connection: error parsing %s file '%s': %s",
+			             db->group, db->filename, error->message);
+		}
+		g_clear_error (&error);
+	}
+	return db->keyfile;
+}
+
+static void
+_state_db_flush (StateDb *db)
+{
+	gs_free char *data = NULL;
+	gsize len;
+	GError *error = NULL;
+
+	nm_clear_g_source (&db->flush_id);
+
+	/* g_file_set_contents() replaces the file atomically. */
+	data = g_key_file_to_data (db->keyfile, &len, &error);
+	if (data)
+		g_file_set_contents (db->filename, data, len, &error);
+	if (error) {
+		nm_log_warn (LOGD_SETTINGS, "settings-connection: error writing %s file '%s': %s",
+		             db->group, db->filename, error->message);
+		g_error_free (error);
+	}
+}
+
+static gboolean
+_state_db_flush_cb (gpointer user_data)
+{
+	StateDb *db = user_data;
+
+	db->flush_id = 0;
+	_state_db_flush (db);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+_state_db_changed (StateDb *db)
+{
+	nm_assert (db->keyfile);
+
+	if (!db->flush_id)
+		db->flush_id = g_timeout_add_seconds (STATE_DB_FLUSH_DELAY_SEC, _state_db_flush_cb, db);
+}
+
+/**
+ * nm_settings_connection_flush_state_dbs:
+ *
+ * Writes pending changes of the timestamps and seen-bssids databases
+ * right away. To be called on shutdown.
+ */
+void
+nm_settings_connection_flush_state_dbs (void)
+{
+	if (state_db_timestamps.flush_id)
+		_state_db_flush (&state_db_timestamps);
+	if (state_db_seen_bssids.flush_id)
+		_state_db_flush (&state_db_seen_bssids);
+}
+
+/*****************************************************************************/
+
+static void
+_getsettings_cached_clear (NMSettingsConnectionPrivate *priv)
+{
+	g_clear_pointer (&priv->getsettings_cached, g_variant_unref);
+}
+
 static void
 _emit_updated (NMSettingsConnection *self, gboolean by_user)
 {
+	_getsettings_cached_clear (NM_SETTINGS_CONNECTION_GET_PRIVATE (self));
 	g_signal_emit (self, signals[UPDATED], 0);
 	g_signal_emit (self, signals[UPDATED_INTERNAL], 0, by_user);
 }
@@ -512,13 +625,18 @@ connection_changed_cb (NMSettingsConnection *self, gpointer unused)
 
 /* Update the settings of this connection to match that of 'new_connection',
  * taking care to make a private copy of secrets.
+ *
+ * If @prepare_new_connection is %FALSE, the caller guarantees that
+ * @new_connection was already normalized (for example, by the plugin's
+ * reader) and the repeated normalization and verification is skipped.
  */
 gboolean
-nm_settings_connection_replace_settings (NMSettingsConnection *self,
-                                         NMConnection *new_connection,
-                                         gboolean update_unsaved,
-                                         const char *log_diff_name,
-                                         GError **error)
+nm_settings_connection_replace_settings_full (NMSettingsConnection *self,
+                                              NMConnection *new_connection,
+                                              gboolean prepare_new_connection,
+                                              gboolean update_unsaved,
+                                              const char *log_diff_name,
+                                              GError **error)
 {
 	NMSettingsConnectionPrivate *priv;
 	gboolean success = FALSE;
@@ -528,8 +646,11 @@ nm_settings_connection_replace_settings (NMSettingsConnection *self,
 
 	priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
 
-	if (!nm_connection_normalize (new_connection, NULL, NULL, error))
-		return FALSE;
+	if (prepare_new_connection) {
+		if (!nm_connection_normalize (new_connection, NULL, NULL, error))
+			return FALSE;
+	} else
+		nm_assert (_nm_connection_verify_cached (new_connection, NULL) == NM_SETTING_VERIFY_SUCCESS);
 
 	if (   nm_connection_get_path (NM_CONNECTION (self))
 	    && g_strcmp0 (nm_settings_connection_get_uuid (self), nm_connection_get_uuid (new_connection)) != 0) {
@@ -597,6 +718,21 @@ nm_settings_connection_replace_settings (NMSettingsConnection *self,
 	return success;
 }
 
+gboolean
+nm_settings_connection_replace_settings (NMSettingsConnection *self,
+                                         NMConnection *new_connection,
+                                         gboolean update_unsaved,
+                                         const char *log_diff_name,
+                                         GError **error)
+{
+	return nm_settings_connection_replace_settings_full (self,
+	                                                     new_connection,
+	                                                     TRUE,
+	                                                     update_unsaved,
+	                                                     log_diff_name,
+	                                                     error);
+}
+
 static void
 ignore_cb (NMSettingsConnection *self,
            GError *error,
@@ -668,6 +804,8 @@ nm_settings_connection_commit_changes (NMSettingsConnection *self,
 {
 	g_return_if_fail (NM_IS_SETTINGS_CONNECTION (self));
 
+	NM_TRACE2 (settings__commit, nm_connection_get_uuid (NM_CONNECTION (self)), (int) commit_reason);
+
 	if (NM_SETTINGS_CONNECTION_GET_CLASS (self)->commit_changes) {
 		NM_SETTINGS_CONNECTION_GET_CLASS (self)->commit_changes (self,
 		                                                         commit_reason,
@@ -705,39 +843,10 @@ nm_settings_connection_delete (NMSettingsConnection *self,
 }
 
 static void
-remove_entry_from_db (NMSettingsConnection *self, const char* db_name)
+remove_entry_from_db (NMSettingsConnection *self, StateDb *db)
 {
-	GKeyFile *key_file;
-	const char *db_file;
-
-	if (strcmp (db_name, "timestamps") == 0)
-		db_file = SETTINGS_TIMESTAMPS_FILE;
-	else if (strcmp (db_name, "seen-bssids") == 0)
-		db_file = SETTINGS_SEEN_BSSIDS_FILE;
-	else
-		return;
-
-	key_file = g_key_file_new ();
-	if (g_key_file_load_from_file (key_file, db_file, G_KEY_FILE_KEEP_COMMENTS, NULL)) {
-		const char *connection_uuid;
-		char *data;
-		gsize len;
-		GError *error = NULL;
-
-		connection_uuid = nm_settings_connection_get_uuid (self);
-
-		g_key_file_remove_key (key_file, db_name, connection_uuid, NULL);
-		data = g_key_file_to_data (key_file, &len, &error);
-		if (data) {
-			g_file_set_contents (db_file, data, len, &error);
-			g_free (data);
-		}
-		if (error) {
-			_LOGW ("error writing %s file '%s': %s", db_name, db_file, error->message);
-			g_error_free (error);
-		}
-	}
-	g_key_file_free (key_file);
+	if (g_key_file_remove_key (_state_db_get (db), db->group, nm_settings_connection_get_uuid (self), NULL))
+		_state_db_changed (db);
 }
 
 static void
@@ -760,10 +869,10 @@ do_delete (NMSettingsConnection *self,
 	g_object_unref (for_agents);
 
 	/* Remove timestamp from timestamps database file */
-	remove_entry_from_db (self, "timestamps");
+	remove_entry_from_db (self, &state_db_timestamps);
 
 	/* Remove connection from seen-bssids database file */
-	remove_entry_from_db (self, "seen-bssids");
+	remove_entry_from_db (self, &state_db_seen_bssids);
 
 	nm_settings_connection_signal_remove (self, FALSE);
 
@@ -1467,8 +1576,77 @@ check_writable (NMConnection *self, GError **error)
 	return TRUE;
 }
 
+gboolean
+nm_settings_connection_check_writable (NMSettingsConnection *self, GError **error)
+{
+	g_return_val_if_fail (NM_IS_SETTINGS_CONNECTION (self), FALSE);
+
+	return check_writable (NM_CONNECTION (self), error);
+}
+
+/**
+ * nm_settings_connection_get_settings_dbus:
+ * @self: the #NMSettingsConnection
+ *
+ * Returns: (transfer none): the settings of @self as returned by
+ *   GetSettings(), without secrets but with the up-to-date timestamp and
+ *   seen BSSIDs. The variant is cached until one of them changes.
+ */
+GVariant *
+nm_settings_connection_get_settings_dbus (NMSettingsConnection *self)
+{
+	NMSettingsConnectionPrivate *priv;
+	NMConnection *dupl_con;
+	NMSettingConnection *s_con;
+	NMSettingWireless *s_wifi;
+	guint64 timestamp = 0;
+	char **bssids;
+
+	g_return_val_if_fail (NM_IS_SETTINGS_CONNECTION (self), NULL);
+
+	priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
+	if (priv->getsettings_cached)
+		return priv->getsettings_cached;
+
+	dupl_con = nm_simple_connection_new_clone (NM_CONNECTION (self));
+	g_assert (dupl_con);
+
+	/* Timestamp is not updated in connection's 'timestamp' property,
+	 * because it would force updating the connection and in turn
+	 * writing to /etc periodically, which we want to avoid. Rather real
+	 * timestamps are kept track of in a private variable. So, substitute
+	 * timestamp property with the real one here before returning the settings.
+	 */
+	nm_settings_connection_get_timestamp (self, &timestamp);
+	if (timestamp) {
+		s_con = nm_connection_get_setting_connection (NM_CONNECTION (dupl_con));
+		g_assert (s_con);
+		g_object_set (s_con, NM_SETTING_CONNECTION_TIMESTAMP, timestamp, NULL);
+	}
+	/* Seen BSSIDs are not updated in 802-11-wireless 'seen-bssids' property
+	 * from the same reason as timestamp. Thus we put it here to GetSettings()
+	 * return settings too.
+	 */
+	bssids = nm_settings_connection_get_seen_bssids (self);
+	s_wifi = nm_connection_get_setting_wireless (NM_CONNECTION (dupl_con));
+	if (bssids && bssids[0] && s_wifi)
+		g_object_set (s_wifi, NM_SETTING_WIRELESS_SEEN_BSSIDS, bssids, NULL);
+	g_free (bssids);
+
+	/* Secrets should *never* be returned by the GetSettings method, they
+	 * get returned by the GetSecrets method which can be better
+	 * protected against leakage of secrets to unprivileged callers.
+	 */
+	priv->getsettings_cached = nm_connection_to_dbus (NM_CONNECTION (dupl_con), NM_CONNECTION_SERIALIZE_NO_SECRETS);
+	g_assert (priv->getsettings_cached);
+	g_variant_ref_sink (priv->getsettings_cached);
+	g_object_unref (dupl_con);
+
+	return priv->getsettings_cached;
+}
+
 static void
-get_settings_auth_cb (NMSettingsConnection *self, 
+get_settings_auth_cb (NMSettingsConnection *self,
                       GDBusMethodInvocation *context,
                       NMAuthSubject *subject,
                       GError *error,
@@ -1477,47 +1655,9 @@ get_settings_auth_cb (NMSettingsConnection *self,
 	if (error)
 		g_dbus_method_invocation_return_gerror (context, error);
 	else {
-		GVariant *settings;
-		NMConnection *dupl_con;
-		NMSettingConnection *s_con;
-		NMSettingWireless *s_wifi;
-		guint64 timestamp = 0;
-		char **bssids;
-
-		dupl_con = nm_simple_connection_new_clone (NM_CONNECTION (self));
-		g_assert (dupl_con);
-
-		/* Timestamp is not updated in connection's 'timestamp' property,
-		 * because it would force updating the connection and in turn
-		 * writing to /etc periodically, which we want to avoid. Rather real
-		 * timestamps are kept track of in a private variable. So, substitute
-		 * timestamp property with the real one here before returning the settings.
-		 */
-		nm_settings_connection_get_timestamp (self, &timestamp);
-		if (timestamp) {
-			s_con = nm_connection_get_setting_connection (NM_CONNECTION (dupl_con));
-			g_assert (s_con);
-			g_object_set (s_con, NM_SETTING_CONNECTION_TIMESTAMP, timestamp, NULL);
-		}
-		/* Seen BSSIDs are not updated in 802-11-wireless 'seen-bssids' property
-		 * from the same reason as timestamp. Thus we put it here to GetSettings()
-		 * return settings too.
-		 */
-		bssids = nm_settings_connection_get_seen_bssids (self);
-		s_wifi = nm_connection_get_setting_wireless (NM_CONNECTION (dupl_con));
-		if (bssids && bssids[0] && s_wifi)
-			g_object_set (s_wifi, NM_SETTING_WIRELESS_SEEN_BSSIDS, bssids, NULL);
-		g_free (bssids);
-
-		/* Secrets should *never* be returned by the GetSettings method, they
-		 * get returned by the GetSecrets method which can be better
-		 * protected against leakage of secrets to unprivileged callers.
-		 */
-		settings = nm_connection_to_dbus (NM_CONNECTION (dupl_con), NM_CONNECTION_SERIALIZE_NO_SECRETS);
-		g_assert (settings);
 		g_dbus_method_invocation_return_value (context,
-		                                       g_variant_new ("(@a{sa{sv}})", settings));
-		g_object_unref (dupl_con);
+		                                       g_variant_new ("(@a{sa{sv}})",
+		                                                      nm_settings_connection_get_settings_dbus (self)));
 	}
 }
 
@@ -1604,6 +1744,58 @@ cached_secrets_to_connection (NMSettingsConnection *self, NMConnection *connecti
 	}
 }
 
+/**
+ * nm_settings_connection_update:
+ * @self: the #NMSettingsConnection
+ * @new_connection: the new settings, already authorized
+ * @save_to_disk: whether to write the settings out through the plugin
+ * @callback: called with the result
+ * @user_data: data for @callback
+ *
+ * Replaces the settings of @self like the Update() and UpdateUnsaved() D-Bus
+ * methods do, after the caller has been authorized. Secrets that are missing
+ * from @new_connection are kept from the current settings.
+ */
+void
+nm_settings_connection_update (NMSettingsConnection *self,
+                               NMConnection *new_connection,
+                               gboolean save_to_disk,
+                               NMSettingsConnectionCommitFunc callback,
+                               gpointer user_data)
+{
+	GError *local = NULL;
+
+	g_return_if_fail (NM_IS_SETTINGS_CONNECTION (self));
+	g_return_if_fail (NM_IS_CONNECTION (new_connection));
+	g_return_if_fail (callback);
+
+	if (!any_secrets_present (new_connection)) {
+		/* If the new connection has no secrets, we do not want to remove all
+		 * secrets, rather we keep all the existing ones. Do that by merging
+		 * them in to the new connection.
+		 */
+		cached_secrets_to_connection (self, new_connection);
+	} else {
+		/* Cache the new secrets from the agent, as stuff like inotify-triggered
+		 * changes to connection's backing config files will blow them away if
+		 * they're in the main connection.
+		 */
+		update_agent_secrets_cache (self, new_connection);
+	}
+
+	if (save_to_disk) {
+		nm_settings_connection_replace_and_commit (self,
+		                                           new_connection,
+		                                           callback,
+		                                           user_data);
+	} else {
+		if (!nm_settings_connection_replace_settings (self, new_connection, TRUE, "replace-and-commit-memory", &local))
+			g_assert (local);
+		callback (self, local, user_data);
+		g_clear_error (&local);
+	}
+}
+
 static void
 update_complete (NMSettingsConnection *self,
                  UpdateInfo *info,
@@ -1660,7 +1852,6 @@ update_auth_cb (NMSettingsConnection *self,
                 gpointer data)
 {
 	UpdateInfo *info = data;
-	GError *local = NULL;
 
 	if (error) {
 		update_complete (self, info, error);
@@ -1678,20 +1869,6 @@ update_auth_cb (NMSettingsConnection *self,
 		return;
 	}
 
-	if (!any_secrets_present (info->new_settings)) {
-		/* If the new connection has no secrets, we do not want to remove all
-		 * secrets, rather we keep all the existing ones. Do that by merging
-		 * them in to the new connection.
-		 */
-		cached_secrets_to_connection (self, info->new_settings);
-	} else {
-		/* Cache the new secrets from the agent, as stuff like inotify-triggered
-		 * changes to connection's backing config files will blow them away if
-		 * they're in the main connection.
-		 */
-		update_agent_secrets_cache (self, info->new_settings);
-	}
-
 	if (nm_audit_manager_audit_enabled (nm_audit_manager_get ())) {
 		gs_unref_hashtable GHashTable *diff = NULL;
 		gboolean same;
@@ -1704,17 +1881,11 @@ update_auth_cb (NMSettingsConnection *self,
 			info->audit_args = nm_utils_format_con_diff_for_audit (diff);
 	}
 
-	if (info->save_to_disk) {
-		nm_settings_connection_replace_and_commit (self,
-		                                           info->new_settings,
-		                                           con_update_cb,
-		                                           info);
-	} else {
-		if (!nm_settings_connection_replace_settings (self, info->new_settings, TRUE, "replace-and-commit-memory", &local))
-			g_assert (local);
-		con_update_cb (self, local, info);
-		g_clear_error (&local);
-	}
+	nm_settings_connection_update (self,
+	                               info->new_settings,
+	                               info->save_to_disk,
+	                               con_update_cb,
+	                               info);
 }
 
 static const char *
@@ -2255,7 +2426,8 @@ nm_settings_connection_get_timestamp (NMSettingsConnection *self,
  * @self: the #NMSettingsConnection
  * @timestamp: timestamp to set into the connection and to store into
  * the timestamps database
- * @flush_to_disk: if %TRUE, commit timestamp update to persistent storage
+ * @flush_to_disk: if %TRUE, commit timestamp update to persistent storage.
+ *   The write is deferred and batched with other updates.
  *
  * Updates the connection and timestamps database with the provided timestamp.
  **/
@@ -2265,44 +2437,29 @@ nm_settings_connection_update_timestamp (NMSettingsConnection *self,
                                          gboolean flush_to_disk)
 {
 	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
-	const char *connection_uuid;
-	GKeyFile *timestamps_file;
-	char *data, *tmp;
-	gsize len;
-	GError *error = NULL;
+	char tmp[30];
 
 	g_return_if_fail (NM_IS_SETTINGS_CONNECTION (self));
 
 	/* Update timestamp in private storage */
-	priv->timestamp = timestamp;
-	priv->timestamp_set = TRUE;
+	if (   !priv->timestamp_set
+	    || priv->timestamp != timestamp) {
+		priv->timestamp = timestamp;
+		priv->timestamp_set = TRUE;
+		_getsettings_cached_clear (priv);
+		g_signal_emit (self, signals[TIMESTAMP_CHANGED], 0);
+	}
 
 	if (flush_to_disk == FALSE)
 		return;
 
 	/* Save timestamp to timestamps database file */
-	timestamps_file = g_key_file_new ();
-	if (!g_key_file_load_from_file (timestamps_file, SETTINGS_TIMESTAMPS_FILE, G_KEY_FILE_KEEP_COMMENTS, &error)) {
-		if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
-			_LOGW ("error parsing timestamps file '%s': %s", SETTINGS_TIMESTAMPS_FILE, error->message);
-		g_clear_error (&error);
-	}
-
-	connection_uuid = nm_settings_connection_get_uuid (self);
-	tmp = g_strdup_printf ("%" G_GUINT64_FORMAT, timestamp);
-	g_key_file_set_value (timestamps_file, "timestamps", connection_uuid, tmp);
-	g_free (tmp);
-
-	data = g_key_file_to_data (timestamps_file, &len, &error);
-	if (data) {
-		g_file_set_contents (SETTINGS_TIMESTAMPS_FILE, data, len, &error);
-		g_free (data);
-	}
-	if (error) {
-		_LOGW ("error saving timestamp to file '%s': %s", SETTINGS_TIMESTAMPS_FILE, error->message);
-		g_error_free (error);
-	}
-	g_key_file_free (timestamps_file);
+	nm_sprintf_buf (tmp, "%" G_GUINT64_FORMAT, timestamp);
+	g_key_file_set_value (_state_db_get (&state_db_timestamps),
+	                      state_db_timestamps.group,
+	                      nm_settings_connection_get_uuid (self),
+	                      tmp);
+	_state_db_changed (&state_db_timestamps);
 }
 
 /**
@@ -2316,19 +2473,17 @@ void
 nm_settings_connection_read_and_fill_timestamp (NMSettingsConnection *self)
 {
 	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
-	const char *connection_uuid;
 	guint64 timestamp = 0;
-	GKeyFile *timestamps_file;
 	GError *err = NULL;
 	char *tmp_str;
 
 	g_return_if_fail (NM_IS_SETTINGS_CONNECTION (self));
 
 	/* Get timestamp from database file */
-	timestamps_file = g_key_file_new ();
-	g_key_file_load_from_file (timestamps_file, SETTINGS_TIMESTAMPS_FILE, G_KEY_FILE_KEEP_COMMENTS, NULL);
-	connection_uuid = nm_settings_connection_get_uuid (self);
-	tmp_str = g_key_file_get_value (timestamps_file, "timestamps", connection_uuid, &err);
+	tmp_str = g_key_file_get_value (_state_db_get (&state_db_timestamps),
+	                                state_db_timestamps.group,
+	                                nm_settings_connection_get_uuid (self),
+	                                &err);
 	if (tmp_str) {
 		timestamp = g_ascii_strtoull (tmp_str, NULL, 10);
 		g_free (tmp_str);
@@ -2338,11 +2493,11 @@ nm_settings_connection_read_and_fill_timestamp (NMSettingsConnection *self)
 	if (!err) {
 		priv->timestamp = timestamp;
 		priv->timestamp_set = TRUE;
+		_getsettings_cached_clear (priv);
 	} else {
 		_LOGD ("failed to read connection timestamp: %s", err->message);
 		g_clear_error (&err);
 	}
-	g_key_file_free (timestamps_file);
 }
 
 /**
@@ -2405,12 +2560,8 @@ nm_settings_connection_add_seen_bssid (NMSettingsConnection *self,
                                        const char *seen_bssid)
 {
 	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
-	const char *connection_uuid;
-	GKeyFile *seen_bssids_file;
-	char *data, *bssid_str;
+	char *bssid_str;
 	const char **list;
-	gsize len;
-	GError *error = NULL;
 	GHashTableIter iter;
 	guint n;
 
@@ -2422,6 +2573,7 @@ nm_settings_connection_add_seen_bssid (NMSettingsConnection *self,
 	/* Add the new BSSID; let the hash take ownership of the allocated BSSID string */
 	bssid_str = g_strdup (seen_bssid);
 	g_hash_table_insert (priv->seen_bssids, bssid_str, bssid_str);
+	_getsettings_cached_clear (priv);
 
 	/* Build up a list of all the BSSIDs in string form */
 	n = 0;
@@ -2431,32 +2583,12 @@ nm_settings_connection_add_seen_bssid (NMSettingsConnection *self,
 		list[n++] = bssid_str;
 
 	/* Save BSSID to seen-bssids file */
-	seen_bssids_file = g_key_file_new ();
-	g_key_file_set_list_separator (seen_bssids_file, ',');
-	if (!g_key_file_load_from_file (seen_bssids_file, SETTINGS_SEEN_BSSIDS_FILE, G_KEY_FILE_KEEP_COMMENTS, &error)) {
-		if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
-			_LOGW ("error parsing seen-bssids file '%s': %s",
-			       SETTINGS_SEEN_BSSIDS_FILE, error->message);
-		}
-		g_clear_error (&error);
-	}
-
-	connection_uuid = nm_settings_connection_get_uuid (self);
-	g_key_file_set_string_list (seen_bssids_file, "seen-bssids", connection_uuid, list, n);
+	g_key_file_set_string_list (_state_db_get (&state_db_seen_bssids),
+	                            state_db_seen_bssids.group,
+	                            nm_settings_connection_get_uuid (self),
+	                            list, n);
 	g_free (list);
-
-	data = g_key_file_to_data (seen_bssids_file, &len, &error);
-	if (data) {
-		g_file_set_contents (SETTINGS_SEEN_BSSIDS_FILE, data, len, &error);
-		g_free (data);
-	}
-	g_key_file_free (seen_bssids_file);
-
-	if (error) {
-		_LOGW ("error saving seen-bssids to file '%s': %s",
-		       SETTINGS_SEEN_BSSIDS_FILE, error->message);
-		g_error_free (error);
-	}
+	_state_db_changed (&state_db_seen_bssids);
 }
 
 /**
@@ -2470,20 +2602,17 @@ void
 nm_settings_connection_read_and_fill_seen_bssids (NMSettingsConnection *self)
 {
 	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
-	const char *connection_uuid;
-	GKeyFile *seen_bssids_file;
-	char **tmp_strv = NULL;
+	char **tmp_strv;
 	gsize i, len = 0;
 	NMSettingWireless *s_wifi;
 
 	/* Get seen BSSIDs from database file */
-	seen_bssids_file = g_key_file_new ();
-	g_key_file_set_list_separator (seen_bssids_file, ',');
-	if (g_key_file_load_from_file (seen_bssids_file, SETTINGS_SEEN_BSSIDS_FILE, G_KEY_FILE_KEEP_COMMENTS, NULL)) {
-		connection_uuid = nm_settings_connection_get_uuid (self);
-		tmp_strv = g_key_file_get_string_list (seen_bssids_file, "seen-bssids", connection_uuid, &len, NULL);
-	}
-	g_key_file_free (seen_bssids_file);
+	tmp_strv = g_key_file_get_string_list (_state_db_get (&state_db_seen_bssids),
+	                                       state_db_seen_bssids.group,
+	                                       nm_settings_connection_get_uuid (self),
+	                                       &len, NULL);
+
+	_getsettings_cached_clear (priv);
 
 	/* Update connection's seen-bssids */
 	if (tmp_strv) {
@@ -2796,6 +2925,7 @@ dispose (GObject *object)
 	priv->pending_auths = NULL;
 
 	g_clear_pointer (&priv->seen_bssids, (GDestroyNotify) g_hash_table_destroy);
+	_getsettings_cached_clear (priv);
 
 	set_visible (self, FALSE);
 
@@ -2929,6 +3059,16 @@ nm_settings_connection_class_init (NMSettingsConnectionClass *class)
 	                  g_cclosure_marshal_VOID__BOOLEAN,
 	                  G_TYPE_NONE, 1, G_TYPE_BOOLEAN);
 
+	/* internal signal, the timestamp affects the autoconnect order. */
+	signals[TIMESTAMP_CHANGED] =
+	    g_signal_new (NM_SETTINGS_CONNECTION_TIMESTAMP_CHANGED,
+	                  G_TYPE_FROM_CLASS (class),
+	                  G_SIGNAL_RUN_FIRST,
+	                  0,
+	                  NULL, NULL,
+	                  g_cclosure_marshal_VOID__VOID,
+	                  G_TYPE_NONE, 0);
+
 	signals[REMOVED] =
 	    g_signal_new (NM_SETTINGS_CONNECTION_REMOVED,
 	                  G_TYPE_FROM_CLASS (class),
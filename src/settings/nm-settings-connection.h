@@ -42,6 +42,7 @@
 
 /* Internal signals */
 #define NM_SETTINGS_CONNECTION_UPDATED_INTERNAL "updated-internal"
+#define NM_SETTINGS_CONNECTION_TIMESTAMP_CHANGED "timestamp-changed"
 
 /* Properties */
 #define NM_SETTINGS_CONNECTION_VISIBLE  "visible"
@@ -141,6 +142,13 @@ void nm_settings_connection_commit_changes (NMSettingsConnection *self,
                                             NMSettingsConnectionCommitFunc callback,
                                             gpointer user_data);
 
+gboolean nm_settings_connection_replace_settings_full (NMSettingsConnection *self,
+                                                       NMConnection *new_connection,
+                                                       gboolean prepare_new_connection,
+                                                       gboolean update_unsaved,
+                                                       const char *log_diff_name,
+                                                       GError **error);
+
 gboolean nm_settings_connection_replace_settings (NMSettingsConnection *self,
                                                   NMConnection *new_connection,
                                                   gboolean update_unsaved,
@@ -152,6 +160,15 @@ void nm_settings_connection_replace_and_commit (NMSettingsConnection *self,
                                                 NMSettingsConnectionCommitFunc callback,
                                                 gpointer user_data);
 
+void nm_settings_connection_update (NMSettingsConnection *self,
+                                    NMConnection *new_connection,
+                                    gboolean save_to_disk,
+                                    NMSettingsConnectionCommitFunc callback,
+                                    gpointer user_data);
+
+gboolean nm_settings_connection_check_writable (NMSettingsConnection *self,
+                                                GError **error);
+
 void nm_settings_connection_delete (NMSettingsConnection *self,
                                     NMSettingsConnectionDeleteFunc callback,
                                     gpointer user_data);
@@ -206,6 +223,8 @@ void nm_settings_connection_read_and_fill_timestamp (NMSettingsConnection *self)
 
 char **nm_settings_connection_get_seen_bssids (NMSettingsConnection *self);
 
+GVariant *nm_settings_connection_get_settings_dbus (NMSettingsConnection *self);
+
 gboolean nm_settings_connection_has_seen_bssid (NMSettingsConnection *self,
                                                 const char *bssid);
 
@@ -214,6 +233,8 @@ void nm_settings_connection_add_seen_bssid (NMSettingsConnection *self,
 
 void nm_settings_connection_read_and_fill_seen_bssids (NMSettingsConnection *self);
 
+void nm_settings_connection_flush_state_dbs (void);
+
 int nm_settings_connection_get_autoconnect_retries (NMSettingsConnection *self);
 void nm_settings_connection_set_autoconnect_retries (NMSettingsConnection *self,
                                                      int retries);
@@ -0,0 +1,187 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager system settings service
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright 2017 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "nm-settings-dir-monitor.h"
+
+#include "NetworkManagerUtils.h"
+
+/*****************************************************************************/
+
+/* Wait this long after the last event before dispatching the batch... */
+#define DISPATCH_DELAY_MSEC  200
+
+/* ... but don't delay a batch for longer than this after its first event. */
+#define DISPATCH_DELAY_MAX_MSEC  2000
+
+struct _NMSettingsDirMonitor {
+	GFileMonitor *monitor;
+	gulong monitor_id;
+
+	NMSettingsDirMonitorCallback callback;
+	gpointer user_data;
+
+	/* set of paths (owned) with events since the last dispatch. */
+	GHashTable *pending;
+	gint64 pending_since_ms;
+	guint dispatch_id;
+};
+
+/*****************************************************************************/
+
+static gboolean
+_dispatch_cb (gpointer user_data)
+{
+	NMSettingsDirMonitor *self = user_data;
+	gs_unref_hashtable GHashTable *pending = NULL;
+	gs_free const char **paths = NULL;
+
+	self->dispatch_id = 0;
+
+	/* the callback may queue new paths, they go into the next batch. */
+	pending = self->pending;
+	self->pending = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	paths = (const char **) g_hash_table_get_keys_as_array (pending, NULL);
+	if (paths[0]) {
+		g_qsort_with_data (paths,
+		                   g_hash_table_size (pending),
+		                   sizeof (const char *),
+		                   nm_strcmp_p_with_data,
+		                   NULL);
+		self->callback (self, paths, self->user_data);
+	}
+
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * nm_settings_dir_monitor_queue:
+ * @self: the #NMSettingsDirMonitor
+ * @path: the path that changed
+ *
+ * Adds @path to the current batch as if the directory monitor reported
+ * an event for it. This lets callers merge change notifications they
+ * get from elsewhere, for example from inotify watches on single files.
+ */
+void
+nm_settings_dir_monitor_queue (NMSettingsDirMonitor *self, const char *path)
+{
+	gint64 now_ms;
+	gint64 delay_ms;
+
+	g_return_if_fail (self);
+	g_return_if_fail (path);
+
+	now_ms = nm_utils_get_monotonic_timestamp_ms ();
+
+	if (!self->dispatch_id)
+		self->pending_since_ms = now_ms;
+
+	if (!g_hash_table_contains (self->pending, path))
+		g_hash_table_add (self->pending, g_strdup (path));
+
+	/* restart the timer, so that a burst of events results in one batch. */
+	delay_ms = MIN (DISPATCH_DELAY_MSEC,
+	                MAX (self->pending_since_ms + DISPATCH_DELAY_MAX_MSEC - now_ms, 0));
+	nm_clear_g_source (&self->dispatch_id);
+	self->dispatch_id = g_timeout_add (delay_ms, _dispatch_cb, self);
+}
+
+static void
+_monitor_changed_cb (GFileMonitor *monitor,
+                     GFile *file,
+                     GFile *other_file,
+                     GFileMonitorEvent event_type,
+                     gpointer user_data)
+{
+	NMSettingsDirMonitor *self = user_data;
+	gs_free char *path = NULL;
+
+	switch (event_type) {
+	case G_FILE_MONITOR_EVENT_DELETED:
+	case G_FILE_MONITOR_EVENT_CREATED:
+	case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+		break;
+	default:
+		return;
+	}
+
+	path = g_file_get_path (file);
+	if (path)
+		nm_settings_dir_monitor_queue (self, path);
+}
+
+/*****************************************************************************/
+
+/**
+ * nm_settings_dir_monitor_new:
+ * @dirname: the directory to watch
+ * @callback: called with the batch of changed paths
+ * @user_data: user data for @callback
+ *
+ * Watches @dirname for created, deleted and changed files. Bursts of events
+ * are coalesced and reported via @callback as one batch of distinct paths.
+ * Whether a path was deleted or changed is up to the callback to find out.
+ *
+ * Returns: the new monitor or %NULL if @dirname cannot be watched.
+ */
+NMSettingsDirMonitor *
+nm_settings_dir_monitor_new (const char *dirname,
+                             NMSettingsDirMonitorCallback callback,
+                             gpointer user_data)
+{
+	NMSettingsDirMonitor *self;
+	gs_unref_object GFile *file = NULL;
+	GFileMonitor *monitor;
+
+	g_return_val_if_fail (dirname, NULL);
+	g_return_val_if_fail (callback, NULL);
+
+	file = g_file_new_for_path (dirname);
+	monitor = g_file_monitor_directory (file, G_FILE_MONITOR_NONE, NULL, NULL);
+	if (!monitor)
+		return NULL;
+
+	self = g_slice_new0 (NMSettingsDirMonitor);
+	self->monitor = monitor;
+	self->callback = callback;
+	self->user_data = user_data;
+	self->pending = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	self->monitor_id = g_signal_connect (monitor, "changed",
+	                                     G_CALLBACK (_monitor_changed_cb), self);
+	return self;
+}
+
+void
+nm_settings_dir_monitor_free (NMSettingsDirMonitor *self)
+{
+	if (!self)
+		return;
+
+	nm_clear_g_signal_handler (self->monitor, &self->monitor_id);
+	g_file_monitor_cancel (self->monitor);
+	g_object_unref (self->monitor);
+
+	nm_clear_g_source (&self->dispatch_id);
+	g_hash_table_unref (self->pending);
+	g_slice_free (NMSettingsDirMonitor, self);
+}
@@ -0,0 +1,45 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager system settings service
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright 2017 Red Hat, Inc.
+ */
+
+#ifndef __NM_SETTINGS_DIR_MONITOR_H__
+#define __NM_SETTINGS_DIR_MONITOR_H__
+
+typedef struct _NMSettingsDirMonitor NMSettingsDirMonitor;
+
+/**
+ * NMSettingsDirMonitorCallback:
+ * @monitor: the #NMSettingsDirMonitor
+ * @paths: the sorted, %NULL terminated list of paths that changed. Each
+ *   path is reported once per batch, regardless of how many events it got.
+ * @user_data: user data
+ */
+typedef void (*NMSettingsDirMonitorCallback) (NMSettingsDirMonitor *monitor,
+                                              const char *const*paths,
+                                              gpointer user_data);
+
+NMSettingsDirMonitor *nm_settings_dir_monitor_new (const char *dirname,
+                                                   NMSettingsDirMonitorCallback callback,
+                                                   gpointer user_data);
+
+void nm_settings_dir_monitor_queue (NMSettingsDirMonitor *self, const char *path);
+
+void nm_settings_dir_monitor_free (NMSettingsDirMonitor *self);
+
+#endif /* __NM_SETTINGS_DIR_MONITOR_H__ */
@@ -65,6 +65,7 @@
 #include "devices/nm-device-ethernet.h"
 #include "nm-settings-connection.h"
 #include "nm-settings-plugin.h"
+#include "nm-settings-dir-monitor.h"
 #include "nm-bus-manager.h"
 #include "nm-auth-utils.h"
 #include "nm-auth-subject.h"
@@ -90,8 +91,13 @@ EXPORT(nm_inotify_helper_remove_watch)
 
 EXPORT(nm_settings_connection_get_type)
 EXPORT(nm_settings_connection_replace_settings)
+EXPORT(nm_settings_connection_replace_settings_full)
 EXPORT(nm_settings_connection_replace_and_commit)
 
+EXPORT(nm_settings_dir_monitor_new)
+EXPORT(nm_settings_dir_monitor_queue)
+EXPORT(nm_settings_dir_monitor_free)
+
 /*****************************************************************************/
 
 #define HOSTNAMED_SERVICE_NAME      "org.freedesktop.hostname1"
@@ -156,9 +162,27 @@ typedef struct {
 	gboolean connections_loaded;
 	GHashTable *connections;
 	NMSettingsConnection **connections_cached_list;
+
+	/* like @connections_cached_list, but sorted by autoconnect priority.
+	 * Dropped additionally when a connection gets updated or its
+	 * timestamp changes. */
+	NMSettingsConnection **connections_sorted_cached_list;
+
+	/* UUID to NMSettingsConnection. Like @connections, it is updated
+	 * in claim_connection() and connection_removed(). */
+	GHashTable *connections_by_uuid;
+
+	/* connection type to a NULL terminated GPtrArray of connections.
+	 * Built on demand and dropped together with @connections_cached_list
+	 * and whenever a connection gets updated. */
+	GHashTable *connections_by_type;
 	GSList *unmanaged_specs;
 	GSList *unrecognized_specs;
 
+	/* the specs parsed for matching devices, updated with them */
+	NMMatchSpecCompiled *unmanaged_specs_compiled;
+	NMMatchSpecCompiled *unrecognized_specs_compiled;
+
 	gboolean started;
 	gboolean startup_complete;
 
@@ -304,6 +328,14 @@ nm_settings_for_each_connection (NMSettings *self,
 		for_each_func (self, NM_SETTINGS_CONNECTION (data), user_data);
 }
 
+static void
+_connections_changed (NMSettingsPrivate *priv)
+{
+	g_clear_pointer (&priv->connections_cached_list, g_free);
+	g_clear_pointer (&priv->connections_sorted_cached_list, g_free);
+	g_clear_pointer (&priv->connections_by_type, g_hash_table_unref);
+}
+
 static void
 impl_settings_list_connections (NMSettings *self,
                                 GDBusMethodInvocation *context)
@@ -324,25 +356,72 @@ impl_settings_list_connections (NMSettings *self,
 	g_ptr_array_unref (connections);
 }
 
+static void
+impl_settings_list_connections_with_settings (NMSettings *self,
+                                              GDBusMethodInvocation *context,
+                                              const char *const*paths)
+{
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+	gs_unref_object NMAuthSubject *subject = NULL;
+	gs_unref_hashtable GHashTable *seen = NULL;
+	NMSettingsConnection *connection;
+	GVariantBuilder builder;
+	GHashTableIter iter;
+	guint i;
+
+	subject = nm_auth_subject_new_unix_process_from_context (context);
+	if (!subject) {
+		g_dbus_method_invocation_return_error_literal (context,
+		                                               NM_SETTINGS_ERROR,
+		                                               NM_SETTINGS_ERROR_PERMISSION_DENIED,
+		                                               "Unable to determine UID of request.");
+		return;
+	}
+
+	/* The same as GetSettings() on each connection, but in one reply.
+	 * Connections that the caller cannot view are skipped, like unknown
+	 * paths. */
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{oa{sa{sv}}}"));
+	if (paths && paths[0]) {
+		seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+		for (i = 0; paths[i]; i++) {
+			connection = g_hash_table_lookup (priv->connections, paths[i]);
+			if (   !connection
+			    || !nm_g_hash_table_add (seen, connection)
+			    || !nm_auth_is_subject_in_acl (NM_CONNECTION (connection), subject, NULL))
+				continue;
+			g_variant_builder_add (&builder, "{o@a{sa{sv}}}",
+			                       paths[i],
+			                       nm_settings_connection_get_settings_dbus (connection));
+		}
+	} else {
+		const char *path;
+
+		g_hash_table_iter_init (&iter, priv->connections);
+		while (g_hash_table_iter_next (&iter, (gpointer *) &path, (gpointer *) &connection)) {
+			if (!nm_auth_is_subject_in_acl (NM_CONNECTION (connection), subject, NULL))
+				continue;
+			g_variant_builder_add (&builder, "{o@a{sa{sv}}}",
+			                       path,
+			                       nm_settings_connection_get_settings_dbus (connection));
+		}
+	}
+
+	g_dbus_method_invocation_return_value (context,
+	                                       g_variant_new ("(a{oa{sa{sv}}})", &builder));
+}
+
 NMSettingsConnection *
 nm_settings_get_connection_by_uuid (NMSettings *self, const char *uuid)
 {
 	NMSettingsPrivate *priv;
-	NMSettingsConnection *candidate;
-	GHashTableIter iter;
 
 	g_return_val_if_fail (NM_IS_SETTINGS (self), NULL);
 	g_return_val_if_fail (uuid != NULL, NULL);
 
 	priv = NM_SETTINGS_GET_PRIVATE (self);
 
-	g_hash_table_iter_init (&iter, priv->connections);
-	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &candidate)) {
-		if (g_strcmp0 (uuid, nm_settings_connection_get_uuid (candidate)) == 0)
-			return candidate;
-	}
-
-	return NULL;
+	return g_hash_table_lookup (priv->connections_by_uuid, uuid);
 }
 
 static void
@@ -441,6 +520,66 @@ nm_settings_get_connections (NMSettings *self, guint *out_len)
 	return v;
 }
 
+/**
+ * nm_settings_get_connections_by_type:
+ * @self: the #NMSettings
+ * @type: the connection type, like %NM_SETTING_WIRELESS_SETTING_NAME
+ * @out_len: (out): (allow-none): returns the number of returned
+ *   connections.
+ *
+ * Returns: (transfer-none): like nm_settings_get_connections(), but
+ * only the connections of type @type. The list is unsorted, NULL
+ * terminated and never %NULL.
+ * The returned list is cached internally, only valid until the next
+ * NMSettings operation.
+ */
+NMSettingsConnection *const*
+nm_settings_get_connections_by_type (NMSettings *self, const char *type, guint *out_len)
+{
+	static NMSettingsConnection *const empty[] = { NULL };
+	NMSettingsPrivate *priv;
+	GHashTableIter iter;
+	NMSettingsConnection *con;
+	const char *con_type;
+	GPtrArray *arr;
+
+	g_return_val_if_fail (NM_IS_SETTINGS (self), NULL);
+	g_return_val_if_fail (type, NULL);
+
+	priv = NM_SETTINGS_GET_PRIVATE (self);
+
+	if (G_UNLIKELY (!priv->connections_by_type)) {
+		priv->connections_by_type = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+		                                                   (GDestroyNotify) g_ptr_array_unref);
+		g_hash_table_iter_init (&iter, priv->connections);
+		while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &con)) {
+			con_type = nm_connection_get_connection_type (NM_CONNECTION (con));
+			if (!con_type)
+				continue;
+			arr = g_hash_table_lookup (priv->connections_by_type, con_type);
+			if (!arr) {
+				arr = g_ptr_array_new ();
+				g_hash_table_insert (priv->connections_by_type, g_strdup (con_type), arr);
+			}
+			g_ptr_array_add (arr, con);
+		}
+
+		/* NULL terminate the lists. */
+		g_hash_table_iter_init (&iter, priv->connections_by_type);
+		while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &arr))
+			g_ptr_array_add (arr, NULL);
+	}
+
+	arr = g_hash_table_lookup (priv->connections_by_type, type);
+	if (!arr) {
+		NM_SET_OUT (out_len, 0);
+		return empty;
+	}
+
+	NM_SET_OUT (out_len, arr->len - 1);
+	return (NMSettingsConnection *const*) arr->pdata;
+}
+
 /**
  * nm_settings_get_connections_clone:
  * @self: the #NMSetting
@@ -491,25 +630,68 @@ nm_settings_get_connections_clone (NMSettings *self,
 	return list;
 }
 
-/* Returns a list of NMSettingsConnections.
- * The list is sorted in the order suitable for auto-connecting, i.e.
- * first go connections with autoconnect=yes and most recent timestamp.
- * Caller must free the list with g_free(), but not the list items.
+/**
+ * nm_settings_get_connections_sorted_filtered:
+ * @self: the #NMSettings
+ * @out_len: (allow-none): optional output argument
+ * @func: (allow-none): caller-supplied function for filtering connections
+ * @func_data: caller-supplied data passed to @func
+ *
+ * Returns: (transfer container) (element-type NMSettingsConnection):
+ *   like nm_settings_get_connections_clone(), but the list is sorted
+ *   in the order suitable for auto-connecting, i.e. first go connections
+ *   with autoconnect=yes and most recent timestamp.
+ *   The sorted order is cached and only recomputed after connections
+ *   were added, removed or updated, or after a timestamp changed.
  */
 NMSettingsConnection **
-nm_settings_get_connections_sorted (NMSettings *self, guint *out_len)
+nm_settings_get_connections_sorted_filtered (NMSettings *self,
+                                             guint *out_len,
+                                             NMSettingsConnectionFilterFunc func,
+                                             gpointer func_data)
 {
-	NMSettingsConnection **connections;
-	guint len;
+	NMSettingsPrivate *priv;
+	NMSettingsConnection **list;
+	guint len, i, j;
 
 	g_return_val_if_fail (NM_IS_SETTINGS (self), NULL);
 
-	connections = nm_settings_get_connections_clone (self, &len, NULL, NULL);
-	if (len > 1)
-		g_qsort_with_data (connections, len, sizeof (NMSettingsConnection *), nm_settings_connection_cmp_autoconnect_priority_p_with_data, NULL);
+	priv = NM_SETTINGS_GET_PRIVATE (self);
+
+	if (G_UNLIKELY (!priv->connections_sorted_cached_list)) {
+		list = nm_settings_get_connections_clone (self, &len, NULL, NULL);
+		if (len > 1)
+			g_qsort_with_data (list, len, sizeof (NMSettingsConnection *), nm_settings_connection_cmp_autoconnect_priority_p_with_data, NULL);
+		priv->connections_sorted_cached_list = list;
+	} else
+		len = g_hash_table_size (priv->connections);
+
+	/* copy the list first, @func must not iterate over a list that
+	 * might get invalidated. */
+	list = g_new (NMSettingsConnection *, ((gsize) len + 1));
+	memcpy (list, priv->connections_sorted_cached_list, sizeof (list[0]) * ((gsize) len + 1));
+	if (func) {
+		for (i = 0, j = 0; i < len; i++) {
+			if (func (self, list[i], func_data))
+				list[j++] = list[i];
+		}
+		list[j] = NULL;
+		len = j;
+	}
 
 	NM_SET_OUT (out_len, len);
-	return connections;
+	return list;
+}
+
+/* Returns a list of NMSettingsConnections.
+ * The list is sorted in the order suitable for auto-connecting, i.e.
+ * first go connections with autoconnect=yes and most recent timestamp.
+ * Caller must free the list with g_free(), but not the list items.
+ */
+NMSettingsConnection **
+nm_settings_get_connections_sorted (NMSettings *self, guint *out_len)
+{
+	return nm_settings_get_connections_sorted_filtered (self, out_len, NULL, NULL);
 }
 
 NMSettingsConnection *
@@ -529,15 +711,11 @@ gboolean
 nm_settings_has_connection (NMSettings *self, NMSettingsConnection *connection)
 {
 	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
-	GHashTableIter iter;
-	gpointer data;
-
-	g_hash_table_iter_init (&iter, priv->connections);
-	while (g_hash_table_iter_next (&iter, NULL, &data))
-		if (data == connection)
-			return TRUE;
+	const char *path;
 
-	return FALSE;
+	path = nm_connection_get_path (NM_CONNECTION (connection));
+	return    path
+	       && g_hash_table_lookup (priv->connections, path) == connection;
 }
 
 const GSList *
@@ -548,6 +726,14 @@ nm_settings_get_unmanaged_specs (NMSettings *self)
 	return priv->unmanaged_specs;
 }
 
+const NMMatchSpecCompiled *
+nm_settings_get_unmanaged_specs_compiled (NMSettings *self)
+{
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+
+	return priv->unmanaged_specs_compiled;
+}
+
 static NMSettingsPlugin *
 get_plugin (NMSettings *self, guint32 capability)
 {
@@ -739,6 +925,8 @@ unmanaged_specs_changed (NMSettingsPlugin *config,
 
 	update_specs (self, &priv->unmanaged_specs,
 	              nm_settings_plugin_get_unmanaged_specs);
+	nm_match_spec_compiled_free (priv->unmanaged_specs_compiled);
+	priv->unmanaged_specs_compiled = nm_match_spec_compile (priv->unmanaged_specs);
 	_notify (self, PROP_UNMANAGED_SPECS);
 }
 
@@ -751,6 +939,8 @@ unrecognized_specs_changed (NMSettingsPlugin *config,
 
 	update_specs (self, &priv->unrecognized_specs,
 	              nm_settings_plugin_get_unrecognized_specs);
+	nm_match_spec_compiled_free (priv->unrecognized_specs_compiled);
+	priv->unrecognized_specs_compiled = nm_match_spec_compile (priv->unrecognized_specs);
 }
 
 static gboolean
@@ -971,6 +1161,16 @@ next:
 static void
 connection_updated (NMSettingsConnection *connection, gboolean by_user, gpointer user_data)
 {
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE ((NMSettings *) user_data);
+
+	/* the UUID of an exported connection cannot change. */
+	nm_assert (g_hash_table_lookup (priv->connections_by_uuid,
+	                                nm_settings_connection_get_uuid (connection)) == connection);
+
+	/* ... but the type and the autoconnect priority can. */
+	g_clear_pointer (&priv->connections_by_type, g_hash_table_unref);
+	g_clear_pointer (&priv->connections_sorted_cached_list, g_free);
+
 	g_signal_emit (NM_SETTINGS (user_data),
 	               signals[CONNECTION_UPDATED],
 	               0,
@@ -978,6 +1178,14 @@ connection_updated (NMSettingsConnection *connection, gboolean by_user, gpointer
 	               by_user);
 }
 
+static void
+connection_timestamp_changed (NMSettingsConnection *connection, gpointer user_data)
+{
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE ((NMSettings *) user_data);
+
+	g_clear_pointer (&priv->connections_sorted_cached_list, g_free);
+}
+
 static void
 connection_visibility_changed (NMSettingsConnection *connection,
                                GParamSpec *pspec,
@@ -1008,14 +1216,18 @@ connection_removed (NMSettingsConnection *connection, gpointer user_data)
 
 	g_signal_handlers_disconnect_by_func (connection, G_CALLBACK (connection_removed), self);
 	g_signal_handlers_disconnect_by_func (connection, G_CALLBACK (connection_updated), self);
+	g_signal_handlers_disconnect_by_func (connection, G_CALLBACK (connection_timestamp_changed), self);
 	g_signal_handlers_disconnect_by_func (connection, G_CALLBACK (connection_visibility_changed), self);
 	if (!priv->startup_complete)
 		g_signal_handlers_disconnect_by_func (connection, G_CALLBACK (connection_ready_changed), self);
 	g_object_unref (self);
 
 	/* Forget about the connection internally */
+	nm_assert (g_hash_table_lookup (priv->connections_by_uuid,
+	                                nm_settings_connection_get_uuid (connection)) == connection);
+	g_hash_table_remove (priv->connections_by_uuid, nm_settings_connection_get_uuid (connection));
 	g_hash_table_remove (priv->connections, (gpointer) cpath);
-	g_clear_pointer (&priv->connections_cached_list, g_free);
+	_connections_changed (priv);
 
 	/* Notify D-Bus */
 	g_signal_emit (self, signals[CONNECTION_REMOVED], 0, connection);
@@ -1087,20 +1299,15 @@ claim_connection (NMSettings *self, NMSettingsConnection *connection)
 {
 	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
 	GError *error = NULL;
-	GHashTableIter iter;
-	gpointer data;
 	const char *path;
 	NMSettingsConnection *existing;
 
 	g_return_if_fail (NM_IS_SETTINGS_CONNECTION (connection));
 	g_return_if_fail (nm_connection_get_path (NM_CONNECTION (connection)) == NULL);
 
-	g_hash_table_iter_init (&iter, priv->connections);
-	while (g_hash_table_iter_next (&iter, NULL, &data)) {
-		/* prevent duplicates */
-		if (data == connection)
-			return;
-	}
+	/* prevent duplicates */
+	if (nm_settings_has_connection (self, connection))
+		return;
 
 	if (!nm_connection_normalize (NM_CONNECTION (connection), NULL, NULL, &error)) {
 		_LOGW ("plugin provided invalid connection: %s", error->message);
@@ -1144,6 +1351,8 @@ claim_connection (NMSettings *self, NMSettingsConnection *connection)
 	                        G_CALLBACK (connection_removed), self);
 	g_signal_connect (connection, NM_SETTINGS_CONNECTION_UPDATED_INTERNAL,
 	                  G_CALLBACK (connection_updated), self);
+	g_signal_connect (connection, NM_SETTINGS_CONNECTION_TIMESTAMP_CHANGED,
+	                  G_CALLBACK (connection_timestamp_changed), self);
 	g_signal_connect (connection, "notify::" NM_SETTINGS_CONNECTION_VISIBLE,
 	                  G_CALLBACK (connection_visibility_changed),
 	                  self);
@@ -1161,7 +1370,10 @@ claim_connection (NMSettings *self, NMSettingsConnection *connection)
 	g_hash_table_insert (priv->connections,
 	                     (gpointer) nm_connection_get_path (NM_CONNECTION (connection)),
 	                     g_object_ref (connection));
-	g_clear_pointer (&priv->connections_cached_list, g_free);
+	g_hash_table_insert (priv->connections_by_uuid,
+	                     g_strdup (nm_settings_connection_get_uuid (connection)),
+	                     connection);
+	_connections_changed (priv);
 
 	nm_utils_log_connection_diff (NM_CONNECTION (connection), NULL, LOGL_DEBUG, LOGD_CORE, "new connection", "++ ");
 
@@ -1552,6 +1764,507 @@ impl_settings_add_connection_unsaved (NMSettings *self,
 	impl_settings_add_connection_helper (self, context, settings, FALSE);
 }
 
+/*****************************************************************************/
+
+typedef enum {
+	APPLY_OP_ADD,
+	APPLY_OP_UPDATE,
+	APPLY_OP_DELETE,
+} ApplyOpType;
+
+typedef struct {
+	ApplyOpType type;
+	char *path;
+	NMConnection *new_settings;
+
+	/* What the connection looked like before an update or delete, to
+	 * restore it if a later operation fails. */
+	NMConnection *old_settings;
+	gboolean old_unsaved;
+} ApplyOp;
+
+typedef struct {
+	NMSettings *self;
+	GDBusMethodInvocation *context;
+	NMAuthSubject *subject;
+	GArray *ops;
+	GPtrArray *result_paths;
+	gboolean save_to_disk;
+	guint current;
+
+	/* Set once an operation failed and the batch is being rolled back. */
+	GError *error;
+	guint failed;
+	guint rollback_failures;
+} ApplyInfo;
+
+static const char *
+_apply_op_to_audit (ApplyOpType type)
+{
+	switch (type) {
+	case APPLY_OP_ADD:    return NM_AUDIT_OP_CONN_ADD;
+	case APPLY_OP_UPDATE: return NM_AUDIT_OP_CONN_UPDATE;
+	case APPLY_OP_DELETE: return NM_AUDIT_OP_CONN_DELETE;
+	}
+	g_return_val_if_reached (NULL);
+}
+
+static void
+_apply_op_clear (gpointer data)
+{
+	ApplyOp *op = data;
+
+	g_free (op->path);
+	g_clear_object (&op->new_settings);
+	g_clear_object (&op->old_settings);
+}
+
+static void
+_apply_info_free (ApplyInfo *info)
+{
+	g_object_unref (info->self);
+	g_clear_object (&info->subject);
+	g_array_unref (info->ops);
+	g_ptr_array_unref (info->result_paths);
+	g_clear_error (&info->error);
+	g_slice_free (ApplyInfo, info);
+}
+
+static void
+_apply_fail_all (ApplyInfo *info, guint from, const char *message)
+{
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (info->self);
+	guint i;
+
+	for (i = from; i < info->ops->len; i++) {
+		ApplyOp *op = &g_array_index (info->ops, ApplyOp, i);
+
+		nm_audit_log_connection_op (_apply_op_to_audit (op->type),
+		                            op->path ? g_hash_table_lookup (priv->connections, op->path) : NULL,
+		                            FALSE, NULL, info->subject, message);
+	}
+}
+
+static void apply_next (ApplyInfo *info);
+static void apply_rollback_next (ApplyInfo *info);
+
+static void
+apply_op_done (NMSettingsConnection *connection,
+               GError *error,
+               gpointer user_data)
+{
+	ApplyInfo *info = user_data;
+	ApplyOp *op = &g_array_index (info->ops, ApplyOp, info->current);
+	NMSettings *self = info->self;
+
+	nm_audit_log_connection_op (_apply_op_to_audit (op->type), connection,
+	                            !error, NULL, info->subject, error ? error->message : NULL);
+
+	if (error) {
+		/* Undo what was done so far, newest first, then report. */
+		_apply_fail_all (info, info->current + 1, "a previous operation failed");
+		info->error = g_error_copy (error);
+		info->failed = info->current;
+		apply_rollback_next (info);
+		return;
+	}
+
+	if (   op->type != APPLY_OP_DELETE
+	    && nm_settings_has_connection (self, connection))
+		send_agent_owned_secrets (self, connection, info->subject);
+
+	g_ptr_array_add (info->result_paths,
+	                 g_strdup (op->path ? op->path : nm_connection_get_path (NM_CONNECTION (connection))));
+	info->current++;
+	apply_next (info);
+}
+
+static void
+apply_next (ApplyInfo *info)
+{
+	NMSettings *self = info->self;
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+	NMSettingsConnection *connection;
+	ApplyOp *op;
+	GError *error = NULL;
+
+	if (info->current >= info->ops->len) {
+		g_ptr_array_add (info->result_paths, NULL);
+		g_dbus_method_invocation_return_value (info->context,
+		                                       g_variant_new ("(^ao)", info->result_paths->pdata));
+		g_object_thaw_notify (G_OBJECT (self));
+		_apply_info_free (info);
+		return;
+	}
+
+	op = &g_array_index (info->ops, ApplyOp, info->current);
+	switch (op->type) {
+	case APPLY_OP_ADD:
+		connection = nm_settings_add_connection (self, op->new_settings, info->save_to_disk, &error);
+		apply_op_done (connection, error, info);
+		g_clear_error (&error);
+		break;
+	case APPLY_OP_UPDATE:
+		connection = g_hash_table_lookup (priv->connections, op->path);
+		op->old_settings = nm_simple_connection_new_clone (NM_CONNECTION (connection));
+		op->old_unsaved = nm_settings_connection_get_unsaved (connection);
+		nm_settings_connection_update (connection, op->new_settings, info->save_to_disk,
+		                               apply_op_done, info);
+		break;
+	case APPLY_OP_DELETE:
+		connection = g_hash_table_lookup (priv->connections, op->path);
+		op->old_settings = nm_simple_connection_new_clone (NM_CONNECTION (connection));
+		op->old_unsaved = nm_settings_connection_get_unsaved (connection);
+		nm_settings_connection_delete (connection, apply_op_done, info);
+		break;
+	}
+}
+
+static void
+apply_rollback_op_done (NMSettingsConnection *connection,
+                        GError *error,
+                        gpointer user_data)
+{
+	ApplyInfo *info = user_data;
+	ApplyOp *op = &g_array_index (info->ops, ApplyOp, info->current);
+	static const char *const undo_audit[] = {
+		[APPLY_OP_ADD]    = NM_AUDIT_OP_CONN_DELETE,
+		[APPLY_OP_UPDATE] = NM_AUDIT_OP_CONN_UPDATE,
+		[APPLY_OP_DELETE] = NM_AUDIT_OP_CONN_ADD,
+	};
+
+	nm_audit_log_connection_op (undo_audit[op->type], connection,
+	                            !error, NULL, info->subject, error ? error->message : NULL);
+
+	if (error) {
+		_LOGW ("apply: failed to roll back operation %u on %s: %s",
+		       info->current,
+		       connection ? nm_settings_connection_get_id (connection) : op->path,
+		       error->message);
+		info->rollback_failures++;
+	}
+
+	apply_rollback_next (info);
+}
+
+static void
+apply_rollback_next (ApplyInfo *info)
+{
+	NMSettings *self = info->self;
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+	NMSettingsConnection *connection;
+	ApplyOp *op;
+	GError *error = NULL;
+
+	if (info->current == 0) {
+		if (info->rollback_failures) {
+			g_dbus_method_invocation_return_error (info->context,
+			                                       info->error->domain,
+			                                       info->error->code,
+			                                       "operation %u failed and %u of the %u operation(s) before it could not be rolled back: %s",
+			                                       info->failed, info->rollback_failures,
+			                                       info->failed, info->error->message);
+		} else {
+			g_dbus_method_invocation_return_error (info->context,
+			                                       info->error->domain,
+			                                       info->error->code,
+			                                       "operation %u failed, the %u operation(s) before it were rolled back: %s",
+			                                       info->failed, info->failed, info->error->message);
+		}
+		g_object_thaw_notify (G_OBJECT (self));
+		_apply_info_free (info);
+		return;
+	}
+
+	info->current--;
+	op = &g_array_index (info->ops, ApplyOp, info->current);
+	switch (op->type) {
+	case APPLY_OP_ADD:
+		connection = g_hash_table_lookup (priv->connections, info->result_paths->pdata[info->current]);
+		if (!connection) {
+			/* Already gone, nothing to undo. */
+			apply_rollback_next (info);
+			return;
+		}
+		nm_settings_connection_delete (connection, apply_rollback_op_done, info);
+		break;
+	case APPLY_OP_UPDATE:
+		connection = g_hash_table_lookup (priv->connections, op->path);
+		if (!connection) {
+			g_set_error (&error, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_INVALID_CONNECTION,
+			             "connection was removed");
+			apply_rollback_op_done (NULL, error, info);
+			g_clear_error (&error);
+			return;
+		}
+		nm_settings_connection_update (connection, op->old_settings, !op->old_unsaved,
+		                               apply_rollback_op_done, info);
+		break;
+	case APPLY_OP_DELETE:
+		/* The restored connection gets a new object path. */
+		connection = nm_settings_add_connection (self, op->old_settings, !op->old_unsaved, &error);
+		apply_rollback_op_done (connection, error, info);
+		g_clear_error (&error);
+		break;
+	}
+}
+
+static void
+pk_apply_cb (NMAuthChain *chain,
+             GError *chain_error,
+             GDBusMethodInvocation *context,
+             gpointer user_data)
+{
+	NMSettings *self = NM_SETTINGS (user_data);
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+	ApplyInfo *info;
+	GError *error = NULL;
+	const char *perm;
+	guint i;
+
+	priv->auths = g_slist_remove (priv->auths, chain);
+
+	info = nm_auth_chain_steal_data (chain, "info");
+	g_assert (info);
+	perm = nm_auth_chain_get_data (chain, "perm");
+
+	if (chain_error) {
+		error = g_error_new (NM_SETTINGS_ERROR,
+		                     NM_SETTINGS_ERROR_FAILED,
+		                     "Error checking authorization: %s",
+		                     chain_error->message);
+	} else if (nm_auth_chain_get_result (chain, perm) != NM_AUTH_CALL_RESULT_YES) {
+		error = g_error_new_literal (NM_SETTINGS_ERROR,
+		                             NM_SETTINGS_ERROR_PERMISSION_DENIED,
+		                             "Insufficient privileges.");
+	} else {
+		/* The settings may have changed while we were waiting for polkit.
+		 * Re-check what the operations depend on, so that either all of
+		 * them are attempted or none. */
+		for (i = 0; i < info->ops->len && !error; i++) {
+			ApplyOp *op = &g_array_index (info->ops, ApplyOp, i);
+
+			if (op->type == APPLY_OP_ADD) {
+				if (nm_settings_get_connection_by_uuid (self, nm_connection_get_uuid (op->new_settings))) {
+					error = g_error_new (NM_SETTINGS_ERROR,
+					                     NM_SETTINGS_ERROR_UUID_EXISTS,
+					                     "operation %u: a connection with this UUID already exists", i);
+				}
+			} else if (!g_hash_table_lookup (priv->connections, op->path)) {
+				error = g_error_new (NM_SETTINGS_ERROR,
+				                     NM_SETTINGS_ERROR_INVALID_CONNECTION,
+				                     "operation %u: connection %s was removed", i, op->path);
+			}
+		}
+	}
+
+	nm_auth_chain_unref (chain);
+
+	if (error) {
+		_apply_fail_all (info, 0, error->message);
+		g_dbus_method_invocation_take_error (context, error);
+		_apply_info_free (info);
+		return;
+	}
+
+	/* Changes to the Connections property are collected into one
+	 * notification for the whole batch. */
+	g_object_freeze_notify (G_OBJECT (self));
+	apply_next (info);
+}
+
+static gboolean
+_apply_parse_op (NMSettings *self,
+                 guint idx,
+                 const char *op_name,
+                 const char *path,
+                 GVariant *settings,
+                 NMAuthSubject *subject,
+                 GHashTable *seen,
+                 ApplyOp *op,
+                 gboolean *out_system,
+                 GError **error)
+{
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+	NMSettingsConnection *existing = NULL;
+	NMSettingConnection *s_con;
+	GError *local = NULL;
+	char *error_desc = NULL;
+
+	if (nm_streq (op_name, "add"))
+		op->type = APPLY_OP_ADD;
+	else if (nm_streq (op_name, "update"))
+		op->type = APPLY_OP_UPDATE;
+	else if (nm_streq (op_name, "delete"))
+		op->type = APPLY_OP_DELETE;
+	else {
+		g_set_error (error, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_FAILED,
+		             "operation %u: unknown operation '%s'", idx, op_name);
+		return FALSE;
+	}
+
+	if (op->type != APPLY_OP_ADD) {
+		existing = g_hash_table_lookup (priv->connections, path);
+		if (!existing) {
+			g_set_error (error, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_INVALID_CONNECTION,
+			             "operation %u: no connection %s", idx, path);
+			return FALSE;
+		}
+		if (!nm_g_hash_table_add (seen, (gpointer) nm_settings_connection_get_uuid (existing))) {
+			g_set_error (error, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_FAILED,
+			             "operation %u: connection %s is modified more than once", idx, path);
+			return FALSE;
+		}
+		if (!nm_settings_connection_check_writable (existing, &local))
+			goto fail;
+		if (!nm_auth_is_subject_in_acl (NM_CONNECTION (existing), subject, &error_desc))
+			goto fail_acl;
+		op->path = g_strdup (path);
+
+		s_con = nm_connection_get_setting_connection (NM_CONNECTION (existing));
+		if (nm_setting_connection_get_num_permissions (s_con) != 1)
+			*out_system = TRUE;
+	}
+
+	if (op->type == APPLY_OP_DELETE)
+		return TRUE;
+
+	op->new_settings = _nm_simple_connection_new_from_dbus (settings,
+	                                                          NM_SETTING_PARSE_FLAGS_STRICT
+	                                                        | NM_SETTING_PARSE_FLAGS_NORMALIZE,
+	                                                        &local);
+	if (!op->new_settings)
+		goto fail;
+
+	if (op->type == APPLY_OP_ADD) {
+		if (!nm_connection_verify_secrets (op->new_settings, &local))
+			goto fail;
+		if (is_adhoc_wpa (op->new_settings)) {
+			g_set_error (error, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_INVALID_CONNECTION,
+			             "operation %u: WPA Ad-Hoc disabled due to kernel bugs", idx);
+			return FALSE;
+		}
+		if (   nm_settings_get_connection_by_uuid (self, nm_connection_get_uuid (op->new_settings))
+		    || !nm_g_hash_table_add (seen, (gpointer) nm_connection_get_uuid (op->new_settings))) {
+			g_set_error (error, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_UUID_EXISTS,
+			             "operation %u: a connection with this UUID already exists", idx);
+			return FALSE;
+		}
+	} else if (!nm_streq0 (nm_connection_get_uuid (op->new_settings),
+	                       nm_settings_connection_get_uuid (existing))) {
+		g_set_error (error, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_INVALID_CONNECTION,
+		             "operation %u: the UUID of connection %s cannot be changed", idx, path);
+		return FALSE;
+	}
+
+	/* You can't make a connection invisible to yourself. */
+	if (!nm_auth_is_subject_in_acl (op->new_settings, subject, &error_desc))
+		goto fail_acl;
+
+	s_con = nm_connection_get_setting_connection (op->new_settings);
+	if (nm_setting_connection_get_num_permissions (s_con) != 1)
+		*out_system = TRUE;
+	return TRUE;
+
+fail_acl:
+	g_set_error (error, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_PERMISSION_DENIED,
+	             "operation %u: %s", idx, error_desc);
+	g_free (error_desc);
+	return FALSE;
+
+fail:
+	g_set_error (error, local->domain, local->code,
+	             "operation %u: %s", idx, local->message);
+	g_error_free (local);
+	return FALSE;
+}
+
+static void
+impl_settings_apply_connections (NMSettings *self,
+                                 GDBusMethodInvocation *context,
+                                 GVariant *operations,
+                                 guint32 flags)
+{
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+	gs_unref_hashtable GHashTable *seen = NULL;
+	ApplyInfo *info;
+	NMAuthChain *chain;
+	GError *error = NULL;
+	GVariantIter iter;
+	const char *op_name, *path, *perm;
+	GVariant *settings;
+	gboolean need_system = FALSE;
+
+	info = g_slice_new0 (ApplyInfo);
+	info->self = g_object_ref (self);
+	info->context = context;
+	info->save_to_disk = !NM_FLAGS_HAS (flags, NM_SETTINGS_APPLY_FLAG_IN_MEMORY);
+	info->ops = g_array_new (FALSE, TRUE, sizeof (ApplyOp));
+	g_array_set_clear_func (info->ops, _apply_op_clear);
+	info->result_paths = g_ptr_array_new_with_free_func (g_free);
+
+	if (flags & ~NM_SETTINGS_APPLY_FLAG_IN_MEMORY) {
+		error = g_error_new_literal (NM_SETTINGS_ERROR,
+		                             NM_SETTINGS_ERROR_FAILED,
+		                             "Invalid flags");
+		goto fail;
+	}
+
+	if (!get_plugin (self, NM_SETTINGS_PLUGIN_CAP_MODIFY_CONNECTIONS)) {
+		error = g_error_new_literal (NM_SETTINGS_ERROR,
+		                             NM_SETTINGS_ERROR_NOT_SUPPORTED,
+		                             "None of the registered plugins support add.");
+		goto fail;
+	}
+
+	info->subject = nm_auth_subject_new_unix_process_from_context (context);
+	if (!info->subject) {
+		error = g_error_new_literal (NM_SETTINGS_ERROR,
+		                             NM_SETTINGS_ERROR_PERMISSION_DENIED,
+		                             "Unable to determine UID of request.");
+		goto fail;
+	}
+
+	/* Check every operation before touching anything, so that a bad entry
+	 * anywhere in the batch rejects the whole batch. */
+	seen = g_hash_table_new (g_str_hash, g_str_equal);
+	g_variant_iter_init (&iter, operations);
+	while (g_variant_iter_next (&iter, "(&s&o@a{sa{sv}})", &op_name, &path, &settings)) {
+		ApplyOp op = { 0 };
+		gboolean success;
+
+		success = _apply_parse_op (self, info->ops->len, op_name, path, settings,
+		                           info->subject, seen, &op, &need_system, &error);
+		g_variant_unref (settings);
+		g_array_append_val (info->ops, op);
+		if (!success)
+			goto fail;
+	}
+
+	/* One authorization for the whole batch. 'modify.own' is enough only if
+	 * every connection involved is private to the caller. */
+	perm = need_system ? NM_AUTH_PERMISSION_SETTINGS_MODIFY_SYSTEM : NM_AUTH_PERMISSION_SETTINGS_MODIFY_OWN;
+
+	chain = nm_auth_chain_new_subject (info->subject, context, pk_apply_cb, self);
+	if (!chain) {
+		error = g_error_new_literal (NM_SETTINGS_ERROR,
+		                             NM_SETTINGS_ERROR_PERMISSION_DENIED,
+		                             "Unable to authenticate the request.");
+		goto fail;
+	}
+
+	priv->auths = g_slist_append (priv->auths, chain);
+	nm_auth_chain_add_call (chain, perm, TRUE);
+	nm_auth_chain_set_data (chain, "perm", (gpointer) perm, NULL);
+	nm_auth_chain_set_data (chain, "info", info, (GDestroyNotify) _apply_info_free);
+	return;
+
+fail:
+	_apply_fail_all (info, 0, error->message);
+	g_dbus_method_invocation_take_error (context, error);
+	_apply_info_free (info);
+}
+
 static void
 impl_settings_load_connections (NMSettings *self,
                                 GDBusMethodInvocation *context,
@@ -1977,7 +2690,7 @@ have_connection_for_device (NMSettings *self, NMDevice *device)
 	}
 
 	/* See if there's a known non-NetworkManager configuration for the device */
-	if (nm_device_spec_match_list (device, priv->unrecognized_specs))
+	if (nm_device_spec_match_compiled (device, priv->unrecognized_specs_compiled))
 		return TRUE;
 
 	return FALSE;
@@ -2241,8 +2954,10 @@ nm_settings_start (NMSettings *self, GError **error)
 		g_object_unref (self);
 		return FALSE;
 	}
+	nm_utils_startup_trace_add ("settings-plugins-loaded");
 
 	load_connections (self);
+	nm_utils_startup_trace_add ("settings-connections-loaded");
 	check_startup_complete (self);
 
 	proxy = g_dbus_proxy_new_for_bus_sync (G_BUS_TYPE_SYSTEM, 0, NULL,
@@ -2332,6 +3047,7 @@ nm_settings_init (NMSettings *self)
 	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
 
 	priv->connections = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_object_unref);
+	priv->connections_by_uuid = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
 	/* Hold a reference to the agent manager so it stays alive; the only
 	 * other holders are NMSettingsConnection objects which are often
@@ -2397,11 +3113,14 @@ finalize (GObject *object)
 	NMSettings *self = NM_SETTINGS (object);
 	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
 
+	g_hash_table_destroy (priv->connections_by_uuid);
 	g_hash_table_destroy (priv->connections);
-	g_clear_pointer (&priv->connections_cached_list, g_free);
+	_connections_changed (priv);
 
 	g_slist_free_full (priv->unmanaged_specs, g_free);
 	g_slist_free_full (priv->unrecognized_specs, g_free);
+	g_clear_pointer (&priv->unmanaged_specs_compiled, nm_match_spec_compiled_free);
+	g_clear_pointer (&priv->unrecognized_specs_compiled, nm_match_spec_compiled_free);
 
 	g_slist_free_full (priv->plugins, g_object_unref);
 
@@ -2505,9 +3224,11 @@ nm_settings_class_init (NMSettingsClass *class)
 	nm_exported_object_class_add_interface (NM_EXPORTED_OBJECT_CLASS (class),
 	                                        NMDBUS_TYPE_SETTINGS_SKELETON,
 	                                        "ListConnections", impl_settings_list_connections,
+	                                        "ListConnectionsWithSettings", impl_settings_list_connections_with_settings,
 	                                        "GetConnectionByUuid", impl_settings_get_connection_by_uuid,
 	                                        "AddConnection", impl_settings_add_connection,
 	                                        "AddConnectionUnsaved", impl_settings_add_connection_unsaved,
+	                                        "ApplyConnections", impl_settings_apply_connections,
 	                                        "LoadConnections", impl_settings_load_connections,
 	                                        "ReloadConnections", impl_settings_reload_connections,
 	                                        "SaveHostname", impl_settings_save_hostname,
@@ -96,12 +96,19 @@ void nm_settings_add_connection_dbus (NMSettings *self,
                                       gpointer user_data);
 
 NMSettingsConnection *const* nm_settings_get_connections (NMSettings *settings, guint *out_len);
+NMSettingsConnection *const* nm_settings_get_connections_by_type (NMSettings *settings,
+                                                                  const char *type,
+                                                                  guint *out_len);
 
 NMSettingsConnection **nm_settings_get_connections_clone (NMSettings *self,
                                                           guint *out_len,
                                                           NMSettingsConnectionFilterFunc func,
                                                           gpointer func_data);
 
+NMSettingsConnection **nm_settings_get_connections_sorted_filtered (NMSettings *self,
+                                                                    guint *out_len,
+                                                                    NMSettingsConnectionFilterFunc func,
+                                                                    gpointer func_data);
 NMSettingsConnection **nm_settings_get_connections_sorted (NMSettings *self,
                                                            guint *out_len);
 
@@ -118,6 +125,7 @@ NMSettingsConnection *nm_settings_get_connection_by_uuid (NMSettings *settings,
 gboolean nm_settings_has_connection (NMSettings *self, NMSettingsConnection *connection);
 
 const GSList *nm_settings_get_unmanaged_specs (NMSettings *self);
+const NMMatchSpecCompiled *nm_settings_get_unmanaged_specs_compiled (NMSettings *self);
 
 char *nm_settings_get_hostname (NMSettings *self);
 
@@ -38,6 +38,7 @@
 
 typedef struct {
 	GHashTable *connections;  /* uuid::connection */
+	GCancellable *load_cancellable;
 	gboolean initialized;
 } NMSIbftPluginPrivate;
 
@@ -66,16 +67,61 @@ NM_DEFINE_SINGLETON_GETTER (NMSIbftPlugin, nms_ibft_plugin_get, NMS_TYPE_IBFT_PL
 
 /*****************************************************************************/
 
+#define IBFT_SYSFS_DIR "/sys/firmware/ibft"
+
 static void
-read_connections (NMSIbftPlugin *self)
+_blocks_free (gpointer blocks)
 {
-	NMSIbftPluginPrivate *priv = NMS_IBFT_PLUGIN_GET_PRIVATE (self);
-	GSList *blocks = NULL, *iter;
+	g_slist_free_full (blocks, (GDestroyNotify) g_ptr_array_unref);
+}
+
+static void
+load_blocks_thread (GTask *task,
+                    gpointer source_object,
+                    gpointer task_data,
+                    GCancellable *cancellable)
+{
+	GSList *blocks = NULL;
+	GError *error = NULL;
+	gboolean success;
+
+	/* Prefer the firmware table exposed by the kernel, which is cheap to
+	 * read. iscsiadm is only needed when the table is not there, for example
+	 * for offloading adapters that provide their boot information differently. */
+	if (g_file_test (IBFT_SYSFS_DIR, G_FILE_TEST_IS_DIR))
+		success = nms_ibft_reader_load_blocks_sysfs (IBFT_SYSFS_DIR, &blocks, &error);
+	else
+		success = nms_ibft_reader_load_blocks ("/sbin/iscsiadm", &blocks, &error);
+
+	if (!success)
+		g_task_return_error (task, error);
+	else
+		g_task_return_pointer (task, blocks, _blocks_free);
+}
+
+static void
+load_blocks_cb (GObject *source_object,
+                GAsyncResult *result,
+                gpointer user_data)
+{
+	NMSIbftPlugin *self;
+	NMSIbftPluginPrivate *priv;
+	GSList *blocks, *iter;
 	GError *error = NULL;
 	NMSIbftConnection *connection;
 
-	if (!nms_ibft_reader_load_blocks ("/sbin/iscsiadm", &blocks, &error)) {
-		nm_log_dbg (LOGD_SETTINGS, "ibft: failed to read iscsiadm records: %s", error->message);
+	blocks = g_task_propagate_pointer (G_TASK (result), &error);
+	if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_error_free (error);
+		return;
+	}
+
+	self = NMS_IBFT_PLUGIN (source_object);
+	priv = NMS_IBFT_PLUGIN_GET_PRIVATE (self);
+	g_clear_object (&priv->load_cancellable);
+
+	if (error) {
+		nm_log_dbg (LOGD_SETTINGS, "ibft: failed to read iBFT records: %s", error->message);
 		g_error_free (error);
 		return;
 	}
@@ -88,13 +134,32 @@ read_connections (NMSIbftPlugin *self)
 			g_hash_table_insert (priv->connections,
 			                     g_strdup (nm_connection_get_uuid (NM_CONNECTION (connection))),
 			                     connection);
+
+			/* if the settings already asked for our connections, announce
+			 * the late arrivals. */
+			if (priv->initialized)
+				g_signal_emit_by_name (self, NM_SETTINGS_PLUGIN_CONNECTION_ADDED, connection);
 		} else {
-			nm_log_warn (LOGD_SETTINGS, "ibft: failed to read iscsiadm record: %s", error->message);
+			nm_log_warn (LOGD_SETTINGS, "ibft: failed to read iBFT record: %s", error->message);
 			g_clear_error (&error);
 		}
 	}
 
-	g_slist_free_full (blocks, (GDestroyNotify) g_ptr_array_unref);
+	_blocks_free (blocks);
+}
+
+static void
+read_connections (NMSIbftPlugin *self)
+{
+	NMSIbftPluginPrivate *priv = NMS_IBFT_PLUGIN_GET_PRIVATE (self);
+	GTask *task;
+
+	/* Don't block the startup of the settings while the records are being
+	 * read; the connections are added once they are ready. */
+	priv->load_cancellable = g_cancellable_new ();
+	task = g_task_new (self, priv->load_cancellable, load_blocks_cb, NULL);
+	g_task_run_in_thread (task, load_blocks_thread);
+	g_object_unref (task);
 }
 
 static GSList *
@@ -106,10 +171,7 @@ get_connections (NMSettingsPlugin *config)
 	GHashTableIter iter;
 	NMSIbftConnection *connection;
 
-	if (!priv->initialized) {
-		read_connections (self);
-		priv->initialized = TRUE;
-	}
+	priv->initialized = TRUE;
 
 	g_hash_table_iter_init (&iter, priv->connections);
 	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &connection))
@@ -145,6 +207,7 @@ get_property (GObject *object, guint prop_id,
 static void
 init (NMSettingsPlugin *config)
 {
+	read_connections (NMS_IBFT_PLUGIN (config));
 }
 
 static void
@@ -161,6 +224,11 @@ dispose (GObject *object)
 	NMSIbftPlugin *self = NMS_IBFT_PLUGIN (object);
 	NMSIbftPluginPrivate *priv = NMS_IBFT_PLUGIN_GET_PRIVATE (self);
 
+	if (priv->load_cancellable) {
+		g_cancellable_cancel (priv->load_cancellable);
+		g_clear_object (&priv->load_cancellable);
+	}
+
 	if (priv->connections) {
 		g_hash_table_destroy (priv->connections);
 		priv->connections = NULL;
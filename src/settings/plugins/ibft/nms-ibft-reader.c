@@ -184,6 +184,146 @@ done:
 	return success;
 }
 
+static char *
+_sysfs_read_attr (const char *dirname, const char *attr)
+{
+	gs_free char *path = g_build_filename (dirname, attr, NULL);
+	char *contents = NULL;
+
+	if (!g_file_get_contents (path, &contents, NULL, NULL))
+		return NULL;
+	g_strstrip (contents);
+	if (!contents[0])
+		g_clear_pointer (&contents, g_free);
+	return contents;
+}
+
+static char *
+_sysfs_read_ifname (const char *dirname)
+{
+	gs_free char *path = g_build_filename (dirname, "device", "net", NULL);
+	GDir *dir;
+	const char *name;
+	char *ifname = NULL;
+
+	dir = g_dir_open (path, 0, NULL);
+	if (!dir)
+		return NULL;
+	while ((name = g_dir_read_name (dir))) {
+		if (nm_utils_iface_valid_name (name)) {
+			ifname = g_strdup (name);
+			break;
+		}
+	}
+	g_dir_close (dir);
+	return ifname;
+}
+
+/* The values of the "origin" attribute, as defined by the iBFT
+ * specification. */
+#define IBFT_ORIGIN_DHCP 3
+
+#define IBFT_FLAG_BLOCK_VALID 0x01
+
+/**
+ * nms_ibft_reader_load_blocks_sysfs:
+ * @sysfs_dir: the directory where the kernel exposes the firmware table,
+ *   usually "/sys/firmware/ibft"
+ * @out_blocks: on return if successful, a #GSList of #GPtrArray, or %NULL on
+ * failure
+ * @error: location for an error on failure
+ *
+ * Like nms_ibft_reader_load_blocks(), but reads the ethernet entries of the
+ * firmware table from sysfs instead of spawning iscsiadm. The returned blocks
+ * contain the same lines that iscsiadm would print for the entries, so that
+ * they can be passed on to nms_ibft_reader_get_connection_from_block().
+ *
+ * This function does not use any global state and can be called from a
+ * worker thread.
+ *
+ * Returns: %TRUE on success, %FALSE if @sysfs_dir can not be read
+ */
+gboolean
+nms_ibft_reader_load_blocks_sysfs (const char *sysfs_dir,
+                                   GSList **out_blocks,
+                                   GError **error)
+{
+	GDir *dir;
+	const char *name;
+	GPtrArray *names;
+	GSList *blocks = NULL;
+	guint i;
+
+	g_return_val_if_fail (sysfs_dir != NULL, FALSE);
+	g_return_val_if_fail (out_blocks != NULL && *out_blocks == NULL, FALSE);
+
+	dir = g_dir_open (sysfs_dir, 0, error);
+	if (!dir)
+		return FALSE;
+
+	names = g_ptr_array_new_with_free_func (g_free);
+	while ((name = g_dir_read_name (dir))) {
+		if (g_str_has_prefix (name, "ethernet"))
+			g_ptr_array_add (names, g_strdup (name));
+	}
+	g_dir_close (dir);
+	g_ptr_array_sort (names, nm_strcmp_p);
+
+	for (i = 0; i < names->len; i++) {
+		gs_free char *dirname = g_build_filename (sysfs_dir, names->pdata[i], NULL);
+		gs_free char *flags = NULL, *origin = NULL, *mac = NULL, *ifname = NULL;
+		gs_free char *ipaddr = NULL, *netmask = NULL, *gateway = NULL;
+		gs_free char *dns1 = NULL, *dns2 = NULL, *vlan = NULL;
+		GPtrArray *block_lines;
+
+		flags = _sysfs_read_attr (dirname, "flags");
+		if (   flags
+		    && !(_nm_utils_ascii_str_to_int64 (flags, 0, 0, G_MAXUINT8, 0) & IBFT_FLAG_BLOCK_VALID))
+			continue;
+
+		mac = _sysfs_read_attr (dirname, "mac");
+		if (!mac) {
+			PARSE_WARNING ("iBFT: missing mac address in %s.", dirname);
+			continue;
+		}
+
+		origin = _sysfs_read_attr (dirname, "origin");
+		ipaddr = _sysfs_read_attr (dirname, "ip-addr");
+		netmask = _sysfs_read_attr (dirname, "subnet-mask");
+		gateway = _sysfs_read_attr (dirname, "gateway");
+		dns1 = _sysfs_read_attr (dirname, "primary-dns");
+		dns2 = _sysfs_read_attr (dirname, "secondary-dns");
+		vlan = _sysfs_read_attr (dirname, "vlan");
+		ifname = _sysfs_read_ifname (dirname);
+
+		block_lines = g_ptr_array_new_full (10, g_free);
+		g_ptr_array_add (block_lines, g_strdup_printf ("iface.hwaddress=%s", mac));
+		g_ptr_array_add (block_lines, g_strdup_printf ("iface.bootproto=%s",
+		                                               _nm_utils_ascii_str_to_int64 (origin, 10, 0, G_MAXUINT8, -1) == IBFT_ORIGIN_DHCP
+		                                               ? "DHCP" : "STATIC"));
+		if (ipaddr)
+			g_ptr_array_add (block_lines, g_strdup_printf ("iface.ipaddress=%s", ipaddr));
+		if (netmask)
+			g_ptr_array_add (block_lines, g_strdup_printf ("iface.subnet_mask=%s", netmask));
+		if (gateway)
+			g_ptr_array_add (block_lines, g_strdup_printf ("iface.gateway=%s", gateway));
+		if (dns1)
+			g_ptr_array_add (block_lines, g_strdup_printf ("iface.primary_dns=%s", dns1));
+		if (dns2)
+			g_ptr_array_add (block_lines, g_strdup_printf ("iface.secondary_dns=%s", dns2));
+		if (vlan)
+			g_ptr_array_add (block_lines, g_strdup_printf ("iface.vlan_id=%s", vlan));
+		if (ifname)
+			g_ptr_array_add (block_lines, g_strdup_printf ("iface.net_ifacename=%s", ifname));
+
+		blocks = g_slist_prepend (blocks, block_lines);
+	}
+	g_ptr_array_unref (names);
+
+	*out_blocks = g_slist_reverse (blocks);
+	return TRUE;
+}
+
 #define ISCSI_HWADDR_TAG     "iface.hwaddress"
 #define ISCSI_BOOTPROTO_TAG  "iface.bootproto"
 #define ISCSI_IPADDR_TAG     "iface.ipaddress"
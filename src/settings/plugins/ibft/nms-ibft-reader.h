@@ -27,6 +27,10 @@ gboolean nms_ibft_reader_load_blocks (const char *iscsiadm_path,
                                       GSList **out_blocks,
                                       GError **error);
 
+gboolean nms_ibft_reader_load_blocks_sysfs (const char *sysfs_dir,
+                                            GSList **out_blocks,
+                                            GError **error);
+
 NMConnection *nms_ibft_reader_get_connection_from_block (const GPtrArray *block, GError **error);
 
 gboolean nms_ibft_reader_parse_block (const GPtrArray *block, GError **error, ...) G_GNUC_NULL_TERMINATED;
@@ -269,6 +269,46 @@ test_read_ibft_vlan (void)
 	g_ptr_array_unref (block);
 }
 
+static void
+test_read_ibft_sysfs (void)
+{
+	gs_unref_object NMConnection *connection = NULL;
+	NMSettingVlan *s_vlan;
+	NMSettingIPConfig *s_ip4;
+	NMIPAddress *ip4_addr;
+	GSList *blocks = NULL;
+	GError *error = NULL;
+	const char *s_iface = NULL;
+
+	/* ethernet1 is not flagged as valid and must be skipped */
+	g_assert (nms_ibft_reader_load_blocks_sysfs (TEST_IBFT_DIR "/sysfs-test-vlan", &blocks, &error));
+	g_assert_no_error (error);
+	g_assert_cmpint (g_slist_length (blocks), ==, 1);
+
+	g_assert (nms_ibft_reader_parse_block (blocks->data, NULL, "iface.net_ifacename", &s_iface, NULL));
+	g_assert_cmpstr (s_iface, ==, "eth0");
+
+	connection = nms_ibft_reader_get_connection_from_block (blocks->data, &error);
+	g_assert_no_error (error);
+	nmtst_assert_connection_verifies_without_normalization (connection);
+
+	s_vlan = nm_connection_get_setting_vlan (connection);
+	g_assert (s_vlan);
+	g_assert_cmpint (nm_setting_vlan_get_id (s_vlan), ==, 123);
+
+	s_ip4 = nm_connection_get_setting_ip4_config (connection);
+	g_assert (s_ip4);
+	g_assert_cmpstr (nm_setting_ip_config_get_method (s_ip4), ==, NM_SETTING_IP4_CONFIG_METHOD_MANUAL);
+	g_assert_cmpint (nm_setting_ip_config_get_num_addresses (s_ip4), ==, 1);
+	ip4_addr = nm_setting_ip_config_get_address (s_ip4, 0);
+	g_assert_cmpstr (nm_ip_address_get_address (ip4_addr), ==, "192.168.6.200");
+	g_assert_cmpint (nm_ip_address_get_prefix (ip4_addr), ==, 24);
+	g_assert_cmpstr (nm_setting_ip_config_get_gateway (s_ip4), ==, "192.168.6.1");
+	g_assert_cmpint (nm_setting_ip_config_get_num_dns (s_ip4), ==, 1);
+
+	g_slist_free_full (blocks, (GDestroyNotify) g_ptr_array_unref);
+}
+
 NMTST_DEFINE ();
 
 #define TPATH "/settings/plugins/ibft/"
@@ -280,6 +320,7 @@ int main (int argc, char **argv)
 	g_test_add_func (TPATH "ibft/dhcp", test_read_ibft_dhcp);
 	g_test_add_func (TPATH "ibft/static", test_read_ibft_static);
 	g_test_add_func (TPATH "ibft/vlan", test_read_ibft_vlan);
+	g_test_add_func (TPATH "ibft/sysfs", test_read_ibft_sysfs);
 	g_test_add_data_func (TPATH "ibft/bad-record-read", TEST_IBFT_DIR "/iscsiadm-test-bad-record", test_read_ibft_malformed);
 	g_test_add_data_func (TPATH "ibft/bad-entry-read", TEST_IBFT_DIR "/iscsiadm-test-bad-entry", test_read_ibft_malformed);
 	g_test_add_data_func (TPATH "ibft/bad-ipaddr-read", TEST_IBFT_DIR "/iscsiadm-test-bad-ipaddr", test_read_ibft_bad_address);
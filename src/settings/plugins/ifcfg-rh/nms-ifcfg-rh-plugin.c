@@ -35,6 +35,7 @@
 #include "nm-dbus-compat.h"
 #include "nm-setting-connection.h"
 #include "settings/nm-settings-plugin.h"
+#include "settings/nm-settings-dir-monitor.h"
 #include "nm-config.h"
 #include "NetworkManagerUtils.h"
 #include "nm-exported-object.h"
@@ -64,10 +65,10 @@ typedef struct {
 	} dbus;
 
 	GHashTable *connections;  /* uuid::connection */
+	GHashTable *paths;        /* filename::uuid, may contain stale entries */
 	gboolean initialized;
 
-	GFileMonitor *ifcfg_monitor;
-	gulong ifcfg_monitor_id;
+	NMSettingsDirMonitor *ifcfg_monitor;
 } SettingsPluginIfcfgPrivate;
 
 struct _SettingsPluginIfcfg {
@@ -126,7 +127,6 @@ connection_ifcfg_changed (NMIfcfgConnection *connection, gpointer user_data)
 	path = nm_settings_connection_get_filename (NM_SETTINGS_CONNECTION (connection));
 	g_return_if_fail (path != NULL);
 
-
 	if (!priv->ifcfg_monitor) {
 		_LOGD ("connection_ifcfg_changed("NM_IFCFG_CONNECTION_LOG_FMTD"): %s", NM_IFCFG_CONNECTION_LOG_ARGD (connection), "ignore event");
 		return;
@@ -134,7 +134,8 @@ connection_ifcfg_changed (NMIfcfgConnection *connection, gpointer user_data)
 
 	_LOGD ("connection_ifcfg_changed("NM_IFCFG_CONNECTION_LOG_FMTD"): %s", NM_IFCFG_CONNECTION_LOG_ARGD (connection), "reload");
 
-	update_connection (self, NULL, path, connection, TRUE, NULL, NULL);
+	/* merge with the events from the directory monitor. */
+	nm_settings_dir_monitor_queue (priv->ifcfg_monitor, path);
 }
 
 static void
@@ -144,6 +145,24 @@ connection_removed_cb (NMSettingsConnection *obj, gpointer user_data)
 	                     nm_connection_get_uuid (NM_CONNECTION (obj)));
 }
 
+static void
+paths_index_add (SettingsPluginIfcfg *self, NMSettingsConnection *connection)
+{
+	const char *path = nm_settings_connection_get_filename (connection);
+
+	if (path) {
+		g_hash_table_insert (SETTINGS_PLUGIN_IFCFG_GET_PRIVATE (self)->paths,
+		                     g_strdup (path),
+		                     g_strdup (nm_connection_get_uuid (NM_CONNECTION (connection))));
+	}
+}
+
+static void
+connection_filename_changed_cb (NMSettingsConnection *obj, GParamSpec *pspec, gpointer user_data)
+{
+	paths_index_add (user_data, obj);
+}
+
 static void
 remove_connection (SettingsPluginIfcfg *self, NMIfcfgConnection *connection)
 {
@@ -177,13 +196,28 @@ find_by_path (SettingsPluginIfcfg *self, const char *path)
 	SettingsPluginIfcfgPrivate *priv = SETTINGS_PLUGIN_IFCFG_GET_PRIVATE (self);
 	GHashTableIter iter;
 	NMSettingsConnection *candidate = NULL;
+	const char *uuid;
 
 	g_return_val_if_fail (path != NULL, NULL);
 
+	/* every filename a connection ever had is indexed, so a miss means
+	 * there is no such connection. */
+	uuid = g_hash_table_lookup (priv->paths, path);
+	if (!uuid)
+		return NULL;
+
+	candidate = g_hash_table_lookup (priv->connections, uuid);
+	if (candidate && nm_streq0 (path, nm_settings_connection_get_filename (candidate)))
+		return NM_IFCFG_CONNECTION (candidate);
+
+	/* stale entry of a renamed or removed connection. */
+	g_hash_table_remove (priv->paths, path);
 	g_hash_table_iter_init (&iter, priv->connections);
 	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &candidate)) {
-		if (g_strcmp0 (path, nm_settings_connection_get_filename (candidate)) == 0)
+		if (g_strcmp0 (path, nm_settings_connection_get_filename (candidate)) == 0) {
+			paths_index_add (self, candidate);
 			return NM_IFCFG_CONNECTION (candidate);
+		}
 	}
 	return NULL;
 }
@@ -373,10 +407,14 @@ update_connection (SettingsPluginIfcfg *self,
 		else
 			_LOGI ("new connection "NM_IFCFG_CONNECTION_LOG_FMT, NM_IFCFG_CONNECTION_LOG_ARG (connection_new));
 		g_hash_table_insert (priv->connections, g_strdup (uuid), connection_new);
+		paths_index_add (self, NM_SETTINGS_CONNECTION (connection_new));
 
 		g_signal_connect (connection_new, NM_SETTINGS_CONNECTION_REMOVED,
 		                  G_CALLBACK (connection_removed_cb),
 		                  self);
+		g_signal_connect (connection_new, "notify::" NM_SETTINGS_CONNECTION_FILENAME,
+		                  G_CALLBACK (connection_filename_changed_cb),
+		                  self);
 
 		if (nm_ifcfg_connection_get_unmanaged_spec (connection_new)) {
 			_LOGI ("Ignoring connection "NM_IFCFG_CONNECTION_LOG_FMT" due to NM_CONTROLLED=no. Unmanaged: %s.",
@@ -404,56 +442,46 @@ update_connection (SettingsPluginIfcfg *self,
 }
 
 static void
-ifcfg_dir_changed (GFileMonitor *monitor,
-                   GFile *file,
-                   GFile *other_file,
-                   GFileMonitorEvent event_type,
+ifcfg_dir_changed (NMSettingsDirMonitor *monitor,
+                   const char *const*paths,
                    gpointer user_data)
 {
 	SettingsPluginIfcfg *plugin = SETTINGS_PLUGIN_IFCFG (user_data);
-	char *path, *ifcfg_path;
+	gs_unref_hashtable GHashTable *seen = NULL;
 	NMIfcfgConnection *connection;
+	char *ifcfg_path;
+	guint i;
 
-	path = g_file_get_path (file);
+	/* Several changed files (ifcfg-, keys-, route- files) may belong to
+	 * the same connection. Reload each connection only once. */
+	seen = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	for (i = 0; paths[i]; i++) {
+		ifcfg_path = utils_detect_ifcfg_path (paths[i], FALSE);
+		_LOGD ("ifcfg_dir_changed(%s) // %s", paths[i], ifcfg_path ? ifcfg_path : "(none)");
+		if (!ifcfg_path)
+			continue;
+		if (g_hash_table_contains (seen, ifcfg_path)) {
+			g_free (ifcfg_path);
+			continue;
+		}
+		g_hash_table_add (seen, ifcfg_path);
 
-	ifcfg_path = utils_detect_ifcfg_path (path, FALSE);
-	_LOGD ("ifcfg_dir_changed(%s) = %d // %s", path, event_type, ifcfg_path ? ifcfg_path : "(none)");
-	if (ifcfg_path) {
 		connection = find_by_path (plugin, ifcfg_path);
-		switch (event_type) {
-		case G_FILE_MONITOR_EVENT_DELETED:
-			if (connection)
-				remove_connection (plugin, connection);
-			break;
-		case G_FILE_MONITOR_EVENT_CREATED:
-		case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+		if (g_file_test (ifcfg_path, G_FILE_TEST_EXISTS)) {
 			/* Update or new */
 			update_connection (plugin, NULL, ifcfg_path, connection, TRUE, NULL, NULL);
-			break;
-		default:
-			break;
-		}
-		g_free (ifcfg_path);
+		} else if (connection)
+			remove_connection (plugin, connection);
 	}
-	g_free (path);
 }
 
 static void
 setup_ifcfg_monitoring (SettingsPluginIfcfg *plugin)
 {
 	SettingsPluginIfcfgPrivate *priv = SETTINGS_PLUGIN_IFCFG_GET_PRIVATE (plugin);
-	GFile *file;
-	GFileMonitor *monitor;
-
-	file = g_file_new_for_path (IFCFG_DIR "/");
-	monitor = g_file_monitor_directory (file, G_FILE_MONITOR_NONE, NULL, NULL);
-	g_object_unref (file);
 
-	if (monitor) {
-		priv->ifcfg_monitor_id = g_signal_connect (monitor, "changed",
-		                                           G_CALLBACK (ifcfg_dir_changed), plugin);
-		priv->ifcfg_monitor = monitor;
-	}
+	priv->ifcfg_monitor = nm_settings_dir_monitor_new (IFCFG_DIR "/", ifcfg_dir_changed, plugin);
 }
 
 static GHashTable *
@@ -507,6 +535,7 @@ read_connections (SettingsPluginIfcfg *plugin)
 	guint i;
 	GPtrArray *filenames;
 	GHashTable *paths;
+	GHashTable *names;
 
 	dir = g_dir_open (IFCFG_DIR, 0, &err);
 	if (!dir) {
@@ -518,9 +547,12 @@ read_connections (SettingsPluginIfcfg *plugin)
 	alive_connections = g_hash_table_new (NULL, NULL);
 
 	filenames = g_ptr_array_new_with_free_func (g_free);
+	names = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 	while ((item = g_dir_read_name (dir))) {
 		char *full_path, *real_path;
 
+		g_hash_table_add (names, g_strdup (item));
+
 		full_path = g_build_filename (IFCFG_DIR, item, NULL);
 		real_path = utils_detect_ifcfg_path (full_path, TRUE);
 
@@ -540,11 +572,15 @@ read_connections (SettingsPluginIfcfg *plugin)
 	g_ptr_array_sort_with_data (filenames, (GCompareDataFunc) _sort_paths, paths);
 	g_hash_table_destroy (paths);
 
+	/* let the reader look up the companion files of each ifcfg file in
+	 * the listing we just read, instead of probing for them. */
+	utils_dir_index_set (IFCFG_DIR, names);
 	for (i = 0; i < filenames->len; i++) {
 		connection = update_connection (plugin, NULL, filenames->pdata[i], NULL, FALSE, alive_connections, NULL);
 		if (connection)
 			g_hash_table_add (alive_connections, connection);
 	}
+	utils_dir_index_set (NULL, NULL);
 	g_ptr_array_free (filenames, TRUE);
 
 	g_hash_table_iter_init (&iter, priv->connections);
@@ -992,6 +1028,7 @@ settings_plugin_ifcfg_init (SettingsPluginIfcfg *plugin)
 	SettingsPluginIfcfgPrivate *priv = SETTINGS_PLUGIN_IFCFG_GET_PRIVATE ((SettingsPluginIfcfg *) plugin);
 
 	priv->connections = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+	priv->paths = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 }
 
 static void
@@ -1030,14 +1067,9 @@ dispose (GObject *object)
 		g_hash_table_destroy (priv->connections);
 		priv->connections = NULL;
 	}
+	g_clear_pointer (&priv->paths, g_hash_table_destroy);
 
-	if (priv->ifcfg_monitor) {
-		if (priv->ifcfg_monitor_id)
-			g_signal_handler_disconnect (priv->ifcfg_monitor, priv->ifcfg_monitor_id);
-
-		g_file_monitor_cancel (priv->ifcfg_monitor);
-		g_object_unref (priv->ifcfg_monitor);
-	}
+	g_clear_pointer (&priv->ifcfg_monitor, nm_settings_dir_monitor_free);
 
 	G_OBJECT_CLASS (settings_plugin_ifcfg_parent_class)->dispose (object);
 }
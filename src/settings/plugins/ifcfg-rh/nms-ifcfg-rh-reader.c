@@ -675,7 +675,9 @@ read_route_file_legacy (const char *filename, NMSettingIPConfig *s_ip4, GError *
 	g_return_val_if_fail (!error || !*error, FALSE);
 
 	/* Read the route file */
-	if (!g_file_get_contents (filename, &contents, &len, NULL) || !len) {
+	if (   !utils_file_exists (filename)
+	    || !g_file_get_contents (filename, &contents, &len, NULL)
+	    || !len) {
 		g_free (contents);
 		return TRUE;  /* missing/empty = success */
 	}
@@ -899,7 +901,9 @@ read_route6_file (const char *filename, NMSettingIPConfig *s_ip6, GError **error
 	g_return_val_if_fail (!error || !*error, FALSE);
 
 	/* Read the route file */
-	if (!g_file_get_contents (filename, &contents, &len, NULL) || !len) {
+	if (   !utils_file_exists (filename)
+	    || !g_file_get_contents (filename, &contents, &len, NULL)
+	    || !len) {
 		g_free (contents);
 		return TRUE;  /* missing/empty = success */
 	}
@@ -1080,6 +1084,59 @@ make_proxy_setting (shvarFile *ifcfg, GError **error)
 	return NM_SETTING (s_proxy);
 }
 
+static NMSetting *
+make_ethtool_setting (shvarFile *ifcfg)
+{
+	NMSettingEthtool *s_ethtool;
+	guint32 ring_rx, ring_tx, channels_combined;
+	gint32 coalesce_rx_usecs, coalesce_tx_usecs;
+	int offload_gro, offload_tso, offload_lro;
+	gs_free char *rps_cpus = NULL;
+	gs_free char *xps_cpus = NULL;
+	gs_free char *irq_affinity = NULL;
+
+	ring_rx = svGetValueInt64 (ifcfg, "ETHTOOL_RING_RX", 10, 0, G_MAXUINT32, 0);
+	ring_tx = svGetValueInt64 (ifcfg, "ETHTOOL_RING_TX", 10, 0, G_MAXUINT32, 0);
+	channels_combined = svGetValueInt64 (ifcfg, "ETHTOOL_CHANNELS_COMBINED", 10, 0, G_MAXUINT32, 0);
+	coalesce_rx_usecs = svGetValueInt64 (ifcfg, "ETHTOOL_COALESCE_RX_USECS", 10, 0, G_MAXINT32, -1);
+	coalesce_tx_usecs = svGetValueInt64 (ifcfg, "ETHTOOL_COALESCE_TX_USECS", 10, 0, G_MAXINT32, -1);
+	offload_gro = svGetValueBoolean (ifcfg, "ETHTOOL_OFFLOAD_GRO", -1);
+	offload_tso = svGetValueBoolean (ifcfg, "ETHTOOL_OFFLOAD_TSO", -1);
+	offload_lro = svGetValueBoolean (ifcfg, "ETHTOOL_OFFLOAD_LRO", -1);
+	rps_cpus = svGetValueStr_cp (ifcfg, "ETHTOOL_RPS_CPUS");
+	xps_cpus = svGetValueStr_cp (ifcfg, "ETHTOOL_XPS_CPUS");
+	irq_affinity = svGetValueStr_cp (ifcfg, "ETHTOOL_IRQ_AFFINITY");
+
+	if (   ring_rx == 0
+	    && ring_tx == 0
+	    && channels_combined == 0
+	    && coalesce_rx_usecs == -1
+	    && coalesce_tx_usecs == -1
+	    && offload_gro == -1
+	    && offload_tso == -1
+	    && offload_lro == -1
+	    && !rps_cpus
+	    && !xps_cpus
+	    && !irq_affinity)
+		return NULL;
+
+	s_ethtool = (NMSettingEthtool *) nm_setting_ethtool_new ();
+	g_object_set (s_ethtool,
+	              NM_SETTING_ETHTOOL_RING_RX, (guint) ring_rx,
+	              NM_SETTING_ETHTOOL_RING_TX, (guint) ring_tx,
+	              NM_SETTING_ETHTOOL_CHANNELS_COMBINED, (guint) channels_combined,
+	              NM_SETTING_ETHTOOL_COALESCE_RX_USECS, (int) coalesce_rx_usecs,
+	              NM_SETTING_ETHTOOL_COALESCE_TX_USECS, (int) coalesce_tx_usecs,
+	              NM_SETTING_ETHTOOL_OFFLOAD_GRO, offload_gro,
+	              NM_SETTING_ETHTOOL_OFFLOAD_TSO, offload_tso,
+	              NM_SETTING_ETHTOOL_OFFLOAD_LRO, offload_lro,
+	              NM_SETTING_ETHTOOL_RPS_CPUS, rps_cpus,
+	              NM_SETTING_ETHTOOL_XPS_CPUS, xps_cpus,
+	              NM_SETTING_ETHTOOL_IRQ_AFFINITY, irq_affinity,
+	              NULL);
+	return NM_SETTING (s_ethtool);
+}
+
 static NMSetting *
 make_ip4_setting (shvarFile *ifcfg,
                   const char *network_file,
@@ -3393,6 +3450,12 @@ make_wpa_setting (shvarFile *ifcfg,
 		g_object_set (wsec, NM_SETTING_WIRELESS_SECURITY_AUTH_ALG, value, NULL);
 
 	g_free (value);
+
+	g_object_set (wsec,
+	              NM_SETTING_WIRELESS_SECURITY_FT, svGetValueBoolean (ifcfg, "WPA_FT", -1),
+	              NM_SETTING_WIRELESS_SECURITY_OKC, svGetValueBoolean (ifcfg, "WPA_OKC", -1),
+	              NULL);
+
 	return (NMSetting *) wsec;
 
 error:
@@ -5183,7 +5246,7 @@ connection_from_file_full (const char *filename,
 	gs_unref_object NMConnection *connection = NULL;
 	gs_free char *type = NULL;
 	char *devtype, *bootproto;
-	NMSetting *s_ip4, *s_ip6, *s_proxy, *s_port, *s_dcb = NULL;
+	NMSetting *s_ip4, *s_ip6, *s_proxy, *s_ethtool, *s_port, *s_dcb = NULL;
 	const char *ifcfg_name = NULL;
 	gboolean has_ip4_defroute = FALSE;
 
@@ -5423,6 +5486,10 @@ connection_from_file_full (const char *filename,
 	if (s_proxy)
 		nm_connection_add_setting (connection, s_proxy);
 
+	s_ethtool = make_ethtool_setting (parsed);
+	if (s_ethtool)
+		nm_connection_add_setting (connection, s_ethtool);
+
 	/* Bridge port? */
 	s_port = make_bridge_port_setting (parsed);
 	if (s_port)
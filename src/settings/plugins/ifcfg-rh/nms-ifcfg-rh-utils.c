@@ -159,6 +159,59 @@ utils_get_ifcfg_name (const char *file, gboolean only_ifcfg)
 	return NULL;
 }
 
+/*****************************************************************************/
+
+static struct {
+	char *dirname;
+	GHashTable *names;
+} dir_index;
+
+/**
+ * utils_dir_index_set:
+ * @dirname: (allow-none): the directory that @names lists
+ * @names: (allow-none) (transfer full): the names of all files in
+ *   @dirname, as a set.
+ *
+ * While loading all connections, the reader asks for a handful of
+ * companion files (keys-, route-, rule-...) of each ifcfg file, most of
+ * which don't exist. With the listing of the directory set, utils_file_exists()
+ * answers from it instead of probing the file system. The listing
+ * is a snapshot and must be cleared again with %NULL once the load
+ * is done.
+ */
+void
+utils_dir_index_set (const char *dirname, GHashTable *names)
+{
+	g_return_if_fail (!dirname == !names);
+
+	nm_clear_g_free (&dir_index.dirname);
+	g_clear_pointer (&dir_index.names, g_hash_table_unref);
+	if (dirname) {
+		dir_index.dirname = g_strdup (dirname);
+		dir_index.names = names;
+	}
+}
+
+gboolean
+utils_file_exists (const char *path)
+{
+	gsize l;
+
+	g_return_val_if_fail (path, FALSE);
+
+	if (dir_index.dirname) {
+		l = strlen (dir_index.dirname);
+		if (   strncmp (path, dir_index.dirname, l) == 0
+		    && path[l] == '/'
+		    && path[l + 1]
+		    && !strchr (&path[l + 1], '/'))
+			return g_hash_table_contains (dir_index.names, &path[l + 1]);
+	}
+	return g_file_test (path, G_FILE_TEST_EXISTS);
+}
+
+/*****************************************************************************/
+
 /* Used to get any ifcfg/extra file path from any other ifcfg/extra path
  * in the form <tag><name>.
  */
@@ -221,10 +274,10 @@ utils_get_extra_ifcfg (const char *parent, const char *tag, gboolean should_crea
 	if (!path)
 		return NULL;
 
-	if (should_create && !g_file_test (path, G_FILE_TEST_EXISTS))
-		ifcfg = svCreateFile (path);
-
-	if (!ifcfg)
+	if (!utils_file_exists (path)) {
+		if (should_create)
+			ifcfg = svCreateFile (path);
+	} else
 		ifcfg = svOpenFile (path, NULL);
 
 	g_free (path);
@@ -263,7 +316,8 @@ utils_has_route_file_new_syntax (const char *filename)
 
 	g_return_val_if_fail (filename != NULL, TRUE);
 
-	if (!g_file_get_contents (filename, &contents, &len, NULL))
+	if (   !utils_file_exists (filename)
+	    || !g_file_get_contents (filename, &contents, &len, NULL))
 		return TRUE;
 
 	if (len <= 0) {
@@ -287,14 +341,14 @@ utils_has_complex_routes (const char *filename)
 	g_return_val_if_fail (filename != NULL, TRUE);
 
 	rules = utils_get_extra_path (filename, RULE_TAG);
-	if (g_file_test (rules, G_FILE_TEST_EXISTS)) {
+	if (utils_file_exists (rules)) {
 		g_free (rules);
 		return TRUE;
 	}
 	g_free (rules);
 
 	rules = utils_get_extra_path (filename, RULE6_TAG);
-	if (g_file_test (rules, G_FILE_TEST_EXISTS)) {
+	if (utils_file_exists (rules)) {
 		g_free (rules);
 		return TRUE;
 	}
@@ -37,6 +37,9 @@ const char *utils_get_ifcfg_name (const char *file, gboolean only_ifcfg);
 
 gboolean utils_should_ignore_file (const char *filename, gboolean only_ifcfg);
 
+void utils_dir_index_set (const char *dirname, GHashTable *names);
+gboolean utils_file_exists (const char *path);
+
 char *utils_get_ifcfg_path (const char *parent);
 char *utils_get_keys_path (const char *parent);
 char *utils_get_route_path (const char *parent);
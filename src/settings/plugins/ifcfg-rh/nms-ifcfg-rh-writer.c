@@ -661,6 +661,14 @@ write_wireless_security_setting (NMConnection *connection,
 			svSetValueStr (ifcfg, "WPA_ALLOW_WPA2", "yes");
 	}
 
+	/* Roaming */
+	svUnsetValue (ifcfg, "WPA_FT");
+	svUnsetValue (ifcfg, "WPA_OKC");
+	if (nm_setting_wireless_security_get_ft (s_wsec) != -1)
+		svSetValueBoolean (ifcfg, "WPA_FT", nm_setting_wireless_security_get_ft (s_wsec));
+	if (nm_setting_wireless_security_get_okc (s_wsec) != -1)
+		svSetValueBoolean (ifcfg, "WPA_OKC", nm_setting_wireless_security_get_okc (s_wsec));
+
 	/* WPA Pairwise ciphers */
 	svUnsetValue (ifcfg, "CIPHER_PAIRWISE");
 	str = g_string_new (NULL);
@@ -881,6 +889,8 @@ write_wireless_setting (NMConnection *connection,
 		svUnsetValue (ifcfg, "DEFAULTKEY");
 		svUnsetValue (ifcfg, "WPA_ALLOW_WPA");
 		svUnsetValue (ifcfg, "WPA_ALLOW_WPA2");
+		svUnsetValue (ifcfg, "WPA_FT");
+		svUnsetValue (ifcfg, "WPA_OKC");
 		svUnsetValue (ifcfg, "CIPHER_PAIRWISE");
 		svUnsetValue (ifcfg, "CIPHER_GROUP");
 		set_secret (ifcfg, "WPA_PSK", NULL, "WPA_PSK_FLAGS", NM_SETTING_SECRET_FLAG_NONE);
@@ -2021,6 +2031,53 @@ write_proxy_setting (NMConnection *connection, shvarFile *ifcfg, GError **error)
 	return TRUE;
 }
 
+static gboolean
+write_ethtool_setting (NMConnection *connection, shvarFile *ifcfg, GError **error)
+{
+	NMSettingEthtool *s_ethtool;
+	guint32 u;
+	gint32 i;
+
+	svUnsetValue (ifcfg, "ETHTOOL_RING_RX");
+	svUnsetValue (ifcfg, "ETHTOOL_RING_TX");
+	svUnsetValue (ifcfg, "ETHTOOL_CHANNELS_COMBINED");
+	svUnsetValue (ifcfg, "ETHTOOL_COALESCE_RX_USECS");
+	svUnsetValue (ifcfg, "ETHTOOL_COALESCE_TX_USECS");
+	svUnsetValue (ifcfg, "ETHTOOL_OFFLOAD_GRO");
+	svUnsetValue (ifcfg, "ETHTOOL_OFFLOAD_TSO");
+	svUnsetValue (ifcfg, "ETHTOOL_OFFLOAD_LRO");
+	svUnsetValue (ifcfg, "ETHTOOL_RPS_CPUS");
+	svUnsetValue (ifcfg, "ETHTOOL_XPS_CPUS");
+	svUnsetValue (ifcfg, "ETHTOOL_IRQ_AFFINITY");
+
+	s_ethtool = nm_connection_get_setting_ethtool (connection);
+	if (!s_ethtool)
+		return TRUE;
+
+	/* only the values that change the driver setting are written */
+	if ((u = nm_setting_ethtool_get_ring_rx (s_ethtool)))
+		svSetValueInt64 (ifcfg, "ETHTOOL_RING_RX", u);
+	if ((u = nm_setting_ethtool_get_ring_tx (s_ethtool)))
+		svSetValueInt64 (ifcfg, "ETHTOOL_RING_TX", u);
+	if ((u = nm_setting_ethtool_get_channels_combined (s_ethtool)))
+		svSetValueInt64 (ifcfg, "ETHTOOL_CHANNELS_COMBINED", u);
+	if ((i = nm_setting_ethtool_get_coalesce_rx_usecs (s_ethtool)) >= 0)
+		svSetValueInt64 (ifcfg, "ETHTOOL_COALESCE_RX_USECS", i);
+	if ((i = nm_setting_ethtool_get_coalesce_tx_usecs (s_ethtool)) >= 0)
+		svSetValueInt64 (ifcfg, "ETHTOOL_COALESCE_TX_USECS", i);
+	if ((i = nm_setting_ethtool_get_offload_gro (s_ethtool)) >= 0)
+		svSetValueBoolean (ifcfg, "ETHTOOL_OFFLOAD_GRO", i);
+	if ((i = nm_setting_ethtool_get_offload_tso (s_ethtool)) >= 0)
+		svSetValueBoolean (ifcfg, "ETHTOOL_OFFLOAD_TSO", i);
+	if ((i = nm_setting_ethtool_get_offload_lro (s_ethtool)) >= 0)
+		svSetValueBoolean (ifcfg, "ETHTOOL_OFFLOAD_LRO", i);
+	svSetValueStr (ifcfg, "ETHTOOL_RPS_CPUS", nm_setting_ethtool_get_rps_cpus (s_ethtool));
+	svSetValueStr (ifcfg, "ETHTOOL_XPS_CPUS", nm_setting_ethtool_get_xps_cpus (s_ethtool));
+	svSetValueStr (ifcfg, "ETHTOOL_IRQ_AFFINITY", nm_setting_ethtool_get_irq_affinity (s_ethtool));
+
+	return TRUE;
+}
+
 static gboolean
 write_ip4_setting (NMConnection *connection, shvarFile *ifcfg, GError **error)
 {
@@ -2787,7 +2844,7 @@ write_connection (NMConnection *connection,
 	gboolean wired = FALSE;
 
 	nm_assert (NM_IS_CONNECTION (connection));
-	nm_assert (_nm_connection_verify (connection, NULL) == NM_SETTING_VERIFY_SUCCESS);
+	nm_assert (_nm_connection_verify_cached (connection, NULL) == NM_SETTING_VERIFY_SUCCESS);
 	nm_assert (!out_reread || !*out_reread);
 
 	if (!writer_can_write_connection (connection, error))
@@ -2896,6 +2953,9 @@ write_connection (NMConnection *connection,
 	if (!write_proxy_setting (connection, ifcfg, error))
 		return FALSE;
 
+	if (!write_ethtool_setting (connection, ifcfg, error))
+		return FALSE;
+
 	svUnsetValue (ifcfg, "DHCP_HOSTNAME");
 	svUnsetValue (ifcfg, "DHCP_FQDN");
 
@@ -57,6 +57,10 @@ typedef struct {
 	 * 3) like 2, but if the value was deleted via svSetValue(), the entry is not removed,
 	 *   but only marked for deletion. That is done by clearing @line but preserving
 	 *   @key/@key_with_prefix.
+	 *
+	 * For lines read from the file, the strings point into the file's
+	 * arena and are not allocated separately. Only values set later
+	 * are allocated, see _line_str_free().
 	 * */
 	char *line;
 	const char *key;
@@ -66,7 +70,16 @@ typedef struct {
 struct _shvarFile {
 	char      *fileName;
 	int        fd;
-	GList     *lineList;
+	GQueue     lineList;
+	/* index of the lines by key, pointing to the list link of the last
+	 * line with that key, which is the one that counts. */
+	GHashTable *lineIdx;
+	/* the content of the file, split in place into the strings
+	 * of the lines read from it. */
+	char      *arena;
+	gsize      arena_len;
+	/* whether some key appeared more than once in the file. */
+	gboolean   has_duplicates;
 	gboolean   modified;
 };
 
@@ -625,6 +638,8 @@ svFile_new (const char *name)
 	s = g_slice_new0 (shvarFile);
 	s->fd = -1;
 	s->fileName = g_strdup (name);
+	g_queue_init (&s->lineList);
+	s->lineIdx = g_hash_table_new (g_str_hash, g_str_equal);
 	return s;
 }
 
@@ -677,12 +692,15 @@ ASSERT_shvarLine (const shvarLine *line)
 }
 
 static shvarLine *
-line_new_parse (const char *value, gsize len)
+line_new_parse (char *value, gsize len)
 {
 	shvarLine *line;
 	gsize k, e;
 
+	/* the line is split in place, so @value must be
+	 * NUL terminated at @len and stay alive with the line. */
 	nm_assert (value);
+	nm_assert (value[len] == '\0');
 
 	line = g_slice_new0 (shvarLine);
 
@@ -695,8 +713,9 @@ line_new_parse (const char *value, gsize len)
 			for (e = k + 1; e < len; e++) {
 				if (value[e] == '=') {
 					nm_assert (_shell_is_name (&value[k], e - k));
-					line->line = g_strndup (&value[e + 1], len - e - 1);
-					line->key_with_prefix = g_strndup (value, e);
+					value[e] = '\0';
+					line->line = &value[e + 1];
+					line->key_with_prefix = value;
 					line->key = &line->key_with_prefix[k];
 					ASSERT_shvarLine (line);
 					return line;
@@ -708,7 +727,7 @@ line_new_parse (const char *value, gsize len)
 		}
 		break;
 	}
-	line->line = g_strndup (value, len);
+	line->line = value;
 	ASSERT_shvarLine (line);
 	return line;
 }
@@ -729,8 +748,19 @@ line_new_build (const char *key, const char *value)
 	return line;
 }
 
+static void
+_line_str_free (const shvarFile *s, char *str)
+{
+	/* strings that point into the arena are not allocated. */
+	if (   s->arena
+	    && str >= s->arena
+	    && str < &s->arena[s->arena_len])
+		return;
+	g_free (str);
+}
+
 static gboolean
-line_set (shvarLine *line, const char *value)
+line_set (const shvarFile *s, shvarLine *line, const char *value)
 {
 	char *value_escaped = NULL;
 	gboolean changed = FALSE;
@@ -752,7 +782,7 @@ line_set (shvarLine *line, const char *value)
 			g_free (value_escaped);
 			return changed;
 		}
-		g_free (line->line);
+		_line_str_free (s, line->line);
 	}
 
 	line->line = value_escaped ?: g_strdup (value);
@@ -761,11 +791,11 @@ line_set (shvarLine *line, const char *value)
 }
 
 static void
-line_free (shvarLine *line)
+line_free (const shvarFile *s, shvarLine *line)
 {
 	ASSERT_shvarLine (line);
-	g_free (line->line);
-	g_free (line->key_with_prefix);
+	_line_str_free (s, line->line);
+	_line_str_free (s, line->key_with_prefix);
 	g_slice_free (shvarLine, line);
 }
 
@@ -782,10 +812,11 @@ svOpenFileInternal (const char *name, gboolean create, GError **error)
 	gboolean closefd = FALSE;
 	int errsv = 0;
 	char *arena;
-	const char *p, *q;
+	gsize arena_len;
+	char *p, *q;
+	GList *iter;
 	GError *local = NULL;
 	nm_auto_close int fd = -1;
-	GList *lineList = NULL;
 
 	if (create)
 		fd = open (name, O_RDWR | O_CLOEXEC); /* NOT O_CREAT */
@@ -811,7 +842,7 @@ svOpenFileInternal (const char *name, gboolean create, GError **error)
 	if (nm_utils_fd_get_contents (fd,
 	                              10 * 1024 * 1024,
 	                              &arena,
-	                              NULL,
+	                              &arena_len,
 	                              &local) < 0) {
 		g_set_error (error, G_FILE_ERROR,
 		             local->domain == G_FILE_ERROR ? local->code : G_FILE_ERROR_FAILED,
@@ -821,15 +852,28 @@ svOpenFileInternal (const char *name, gboolean create, GError **error)
 		return NULL;
 	}
 
-	for (p = arena; (q = strchr (p, '\n')) != NULL; p = q + 1)
-		lineList = g_list_prepend (lineList, line_new_parse (p, q - p));
+	s = svFile_new (name);
+	s->arena = arena;
+	s->arena_len = arena_len;
+
+	for (p = arena; (q = strchr (p, '\n')) != NULL; p = q + 1) {
+		q[0] = '\0';
+		g_queue_push_tail (&s->lineList, line_new_parse (p, q - p));
+	}
 	if (p[0])
-		lineList = g_list_prepend (lineList, line_new_parse (p, strlen (p)));
-	g_free (arena);
-	lineList = g_list_reverse (lineList);
+		g_queue_push_tail (&s->lineList, line_new_parse (p, strlen (p)));
 
-	s = svFile_new (name);
-	s->lineList = lineList;
+	for (iter = s->lineList.head; iter; iter = iter->next) {
+		const shvarLine *line = iter->data;
+
+		if (!line->key)
+			continue;
+		if (g_hash_table_contains (s->lineIdx, line->key))
+			s->has_duplicates = TRUE;
+		/* replace also the key, the one of the earlier line
+		 * might go away. */
+		g_hash_table_replace (s->lineIdx, (gpointer) line->key, iter);
+	}
 
 	/* closefd is set if we opened the file read-only, so go ahead and
 	 * close it, because we can't write to it anyway */
@@ -859,44 +903,20 @@ svCreateFile (const char *name)
 
 /*****************************************************************************/
 
-static const GList *
-shlist_find (const GList *current, const char *key)
-{
-	nm_assert (_shell_is_name (key, -1));
-
-	if (current) {
-		do {
-			shvarLine *line = current->data;
-
-			ASSERT_shvarLine (line);
-			if (line->key && nm_streq (line->key, key))
-				return current;
-			current = current->next;
-		} while (current);
-	}
-	return NULL;
-}
-
-/*****************************************************************************/
-
 static const char *
 _svGetValue (shvarFile *s, const char *key, char **to_free)
 {
-	const GList *current, *last;
+	const GList *last;
 	const shvarLine *line;
 
 	nm_assert (s);
 	nm_assert (_shell_is_name (key, -1));
 	nm_assert (to_free);
 
-	last = NULL;
-	current = s->lineList;
-	while ((current = shlist_find (current, key))) {
-		last = current;
-		current = current->next;
-	}
+	last = g_hash_table_lookup (s->lineIdx, key);
 	if (last) {
 		line = last->data;
+		ASSERT_shvarLine (line);
 		if (line->line)
 			return svUnescape (line->line, to_free);
 	}
@@ -1052,40 +1072,55 @@ svGetValueInt64 (shvarFile *s, const char *key, guint base, gint64 min, gint64 m
 void
 svSetValue (shvarFile *s, const char *key, const char *value)
 {
-	GList *current, *last;
+	GList *current, *next, *last;
+	shvarLine *line;
 
 	g_return_if_fail (s != NULL);
 	g_return_if_fail (key != NULL);
 
 	nm_assert (_shell_is_name (key, -1));
 
-	last = NULL;
-	current = s->lineList;
-	while ((current = (GList *) shlist_find (current, key))) {
-		if (last) {
-			/* if we find multiple entries for the same key, we can
-			 * delete all but the last. */
-			line_free (last->data);
-			s->lineList = g_list_delete_link (s->lineList, last);
-			s->modified = TRUE;
+	last = g_hash_table_lookup (s->lineIdx, key);
+
+	if (last && s->has_duplicates) {
+		/* if we find multiple entries for the same key, we can
+		 * delete all but the last. */
+		for (current = s->lineList.head; current != last; current = next) {
+			next = current->next;
+			line = current->data;
+			if (   line->key
+			    && nm_streq (line->key, key)) {
+				line_free (s, line);
+				g_queue_delete_link (&s->lineList, current);
+				s->modified = TRUE;
+			}
 		}
-		last = current;
-		current = current->next;
 	}
 
 	if (!value) {
 		if (last) {
-			shvarLine *line = last->data;
-
-			if (nm_clear_g_free (&line->line))
+			line = last->data;
+			if (line->line) {
+				_line_str_free (s, g_steal_pointer (&line->line));
 				s->modified = TRUE;
+			}
 		}
 	} else {
 		if (!last) {
-			s->lineList = g_list_append (s->lineList, line_new_build (key, value));
+			line = line_new_build (key, value);
+			g_queue_push_tail (&s->lineList, line);
+			g_hash_table_insert (s->lineIdx, (gpointer) line->key, s->lineList.tail);
 			s->modified = TRUE;
 		} else {
-			if (line_set (last->data, value))
+			line = last->data;
+			if (line->key != line->key_with_prefix) {
+				/* line_set() moves the key to drop the whitespace prefix,
+				 * which invalidates the key in the index. */
+				g_hash_table_remove (s->lineIdx, key);
+				if (line_set (s, line, value))
+					s->modified = TRUE;
+				g_hash_table_insert (s->lineIdx, (gpointer) line->key, last);
+			} else if (line_set (s, line, value))
 				s->modified = TRUE;
 		}
 	}
@@ -1168,7 +1203,7 @@ svWriteFile (shvarFile *s, int mode, GError **error)
 		}
 		f = fdopen (tmpfd, "w");
 		fseek (f, 0, SEEK_SET);
-		for (current = s->lineList; current; current = current->next) {
+		for (current = s->lineList.head; current; current = current->next) {
 			const shvarLine *line = current->data;
 			const char *str;
 			char *s_tmp;
@@ -1208,11 +1243,16 @@ svWriteFile (shvarFile *s, int mode, GError **error)
 void
 svCloseFile (shvarFile *s)
 {
+	shvarLine *line;
+
 	g_return_if_fail (s != NULL);
 
 	if (s->fd != -1)
 		close (s->fd);
 	g_free (s->fileName);
-	g_list_free_full (s->lineList, (GDestroyNotify) line_free);
+	g_hash_table_destroy (s->lineIdx);
+	while ((line = g_queue_pop_head (&s->lineList)))
+		line_free (s, line);
+	g_free (s->arena);
 	g_slice_free (shvarFile, s);
 }
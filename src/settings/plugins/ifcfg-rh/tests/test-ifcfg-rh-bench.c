@@ -0,0 +1,118 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright 2017 Red Hat, Inc.
+ */
+
+/* Read/write benchmark for the ifcfg-rh plugin, using the fixtures of
+ * test-ifcfg-rh.
+ *
+ * This is not run by "make check". Run it by hand. The fixtures that
+ * read fine are copied, with a new ID and UUID, to a scratch directory
+ *
+ *   NMTST_BENCH_COPIES     number of connections written (default 1000)
+ *   NMTST_BENCH_RELOADS    number of re-reads of a single file (default 1000)
+ *
+ * and the benchmark measures writing them, reading the whole directory
+ * like the plugin does on load, and reading a single file again. Each
+ * benchmark prints one line
+ *
+ *   bench<TAB>ifcfg-rh<TAB>operation<TAB>count<TAB>ns-per-op
+ *
+ * to stdout, see nmtst_settings_bench_run(). */
+
+#include "nm-default.h"
+
+#include <errno.h>
+
+#include "nm-core-internal.h"
+
+#include "settings/plugins/ifcfg-rh/nms-ifcfg-rh-common.h"
+#include "settings/plugins/ifcfg-rh/nms-ifcfg-rh-reader.h"
+#include "settings/plugins/ifcfg-rh/nms-ifcfg-rh-writer.h"
+#include "settings/plugins/ifcfg-rh/nms-ifcfg-rh-utils.h"
+
+#include "nm-test-utils-core.h"
+
+/*****************************************************************************/
+
+static gboolean
+_should_ignore_file (const char *filename)
+{
+	return utils_should_ignore_file (filename, TRUE);
+}
+
+static NMConnection *
+_read_fixture (const char *path)
+{
+	gs_free char *unhandled = NULL;
+	NMConnection *connection;
+
+	/* unmanaged fixtures, and those that lack the TYPE that test-ifcfg-rh
+	 * passes explicitly, are skipped too. */
+	connection = connection_from_file_test (path, NULL, TYPE_ETHERNET, &unhandled, NULL);
+	if (   connection
+	    && (   unhandled
+	        || !nm_connection_normalize (connection, NULL, NULL, NULL)
+	        || !writer_can_write_connection (connection, NULL)))
+		g_clear_object (&connection);
+	return connection;
+}
+
+static NMConnection *
+_read (const char *path)
+{
+	gs_free char *unhandled = NULL;
+
+	return connection_from_file (path, &unhandled, NULL, NULL);
+}
+
+static gboolean
+_write (NMConnection *connection, const char *dirname, char **out_path)
+{
+	return writer_new_connection (connection, dirname, out_path, NULL, NULL, NULL);
+}
+
+static void
+test_bench (void)
+{
+	static const NMTstSettingsBench bench = {
+		.profile = "ifcfg-rh",
+		.fixtures_dir = TEST_IFCFG_DIR "/network-scripts",
+		.should_ignore_file = _should_ignore_file,
+		.read_fixture = _read_fixture,
+		.read = _read,
+		.write = _write,
+	};
+
+	nmtst_settings_bench_run (&bench, TEST_SCRATCH_DIR);
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE ();
+
+int main (int argc, char **argv)
+{
+	nmtst_init_with_logging (&argc, &argv, "ERR", "DEFAULT");
+
+	if (g_mkdir_with_parents (TEST_SCRATCH_DIR, 0755) != 0)
+		g_error ("failure to create test directory \"%s\": %s", TEST_SCRATCH_DIR, g_strerror (errno));
+
+	g_test_add_func ("/ifcfg-rh-bench/read-write", test_bench);
+
+	return g_test_run ();
+}
@@ -5695,6 +5695,67 @@ test_write_wifi_wpa_psk (gconstpointer test_data)
 	nmtst_assert_connection_equals (connection, TRUE, reread, FALSE);
 }
 
+static void
+test_write_wifi_wpa_psk_roaming (void)
+{
+	nmtst_auto_unlinkfile char *testfile = NULL;
+	nmtst_auto_unlinkfile char *keyfile = NULL;
+	gs_unref_object NMConnection *connection = NULL;
+	gs_unref_object NMConnection *reread = NULL;
+	NMSettingConnection *s_con;
+	NMSettingWireless *s_wifi;
+	NMSettingWirelessSecurity *s_wsec;
+	GBytes *ssid;
+	const char *ssid_data = "blahblah";
+	shvarFile *f;
+
+	connection = nm_simple_connection_new ();
+
+	s_con = (NMSettingConnection *) nm_setting_connection_new ();
+	nm_connection_add_setting (connection, NM_SETTING (s_con));
+	g_object_set (s_con,
+	              NM_SETTING_CONNECTION_ID, "Test Write Wifi WPA PSK Roaming",
+	              NM_SETTING_CONNECTION_UUID, nm_utils_uuid_generate_a (),
+	              NM_SETTING_CONNECTION_TYPE, NM_SETTING_WIRELESS_SETTING_NAME,
+	              NULL);
+
+	s_wifi = (NMSettingWireless *) nm_setting_wireless_new ();
+	nm_connection_add_setting (connection, NM_SETTING (s_wifi));
+	ssid = g_bytes_new (ssid_data, strlen (ssid_data));
+	g_object_set (s_wifi,
+	              NM_SETTING_WIRELESS_SSID, ssid,
+	              NM_SETTING_WIRELESS_MODE, "infrastructure",
+	              NULL);
+	g_bytes_unref (ssid);
+
+	s_wsec = (NMSettingWirelessSecurity *) nm_setting_wireless_security_new ();
+	nm_connection_add_setting (connection, NM_SETTING (s_wsec));
+	g_object_set (s_wsec,
+	              NM_SETTING_WIRELESS_SECURITY_KEY_MGMT, "wpa-psk",
+	              NM_SETTING_WIRELESS_SECURITY_PSK, "7d308b11df1b4243b0f78e5f3fc68cdbb9a264ed0edf4c188edf329ff5b467f0",
+	              NM_SETTING_WIRELESS_SECURITY_FT, 1,
+	              NM_SETTING_WIRELESS_SECURITY_OKC, 0,
+	              NULL);
+	nm_setting_wireless_security_add_proto (s_wsec, "rsn");
+
+	nmtst_assert_connection_verifies (connection);
+
+	_writer_new_connection (connection,
+	                        TEST_SCRATCH_DIR "/network-scripts/",
+	                        &testfile);
+
+	f = _svOpenFile (testfile);
+	_svGetValue_check (f, "WPA_FT", "yes");
+	_svGetValue_check (f, "WPA_OKC", "no");
+	svCloseFile (f);
+
+	reread = _connection_from_file (testfile, NULL, TYPE_WIRELESS, NULL);
+
+	keyfile = utils_get_keys_path (testfile);
+
+	nmtst_assert_connection_equals (connection, TRUE, reread, FALSE);
+}
+
 static void
 test_write_wifi_wpa_psk_adhoc (void)
 {
@@ -8580,6 +8641,67 @@ test_write_proxy_basic (void)
 	nmtst_assert_connection_equals (connection, TRUE, reread, FALSE);
 }
 
+static void
+test_write_ethtool (void)
+{
+	nmtst_auto_unlinkfile char *testfile = NULL;
+	gs_unref_object NMConnection *connection = NULL;
+	gs_unref_object NMConnection *reread = NULL;
+	NMSettingConnection *s_con;
+	NMSettingWired *s_wired;
+	NMSettingEthtool *s_ethtool;
+	shvarFile *f;
+
+	connection = nm_simple_connection_new ();
+
+	s_con = (NMSettingConnection *) nm_setting_connection_new ();
+	nm_connection_add_setting (connection, NM_SETTING (s_con));
+	g_object_set (s_con,
+	              NM_SETTING_CONNECTION_ID, "Test Write Ethtool",
+	              NM_SETTING_CONNECTION_UUID, nm_utils_uuid_generate_a (),
+	              NM_SETTING_CONNECTION_TYPE, NM_SETTING_WIRED_SETTING_NAME,
+	              NULL);
+
+	s_wired = (NMSettingWired *) nm_setting_wired_new ();
+	nm_connection_add_setting (connection, NM_SETTING (s_wired));
+
+	s_ethtool = (NMSettingEthtool *) nm_setting_ethtool_new ();
+	nm_connection_add_setting (connection, NM_SETTING (s_ethtool));
+	g_object_set (s_ethtool,
+	              NM_SETTING_ETHTOOL_RING_RX, 4096,
+	              NM_SETTING_ETHTOOL_CHANNELS_COMBINED, 8,
+	              NM_SETTING_ETHTOOL_COALESCE_RX_USECS, 0,
+	              NM_SETTING_ETHTOOL_OFFLOAD_GRO, 0,
+	              NM_SETTING_ETHTOOL_OFFLOAD_LRO, 1,
+	              NM_SETTING_ETHTOOL_RPS_CPUS, "f0",
+	              NM_SETTING_ETHTOOL_IRQ_AFFINITY, NM_SETTING_ETHTOOL_CPUS_NUMA,
+	              NULL);
+
+	nmtst_assert_connection_verifies (connection);
+
+	_writer_new_connection (connection,
+	                        TEST_SCRATCH_DIR "/network-scripts/",
+	                        &testfile);
+
+	f = _svOpenFile (testfile);
+	_svGetValue_check (f, "ETHTOOL_RING_RX", "4096");
+	_svGetValue_check (f, "ETHTOOL_RING_TX", NULL);
+	_svGetValue_check (f, "ETHTOOL_CHANNELS_COMBINED", "8");
+	_svGetValue_check (f, "ETHTOOL_COALESCE_RX_USECS", "0");
+	_svGetValue_check (f, "ETHTOOL_COALESCE_TX_USECS", NULL);
+	_svGetValue_check (f, "ETHTOOL_OFFLOAD_GRO", "no");
+	_svGetValue_check (f, "ETHTOOL_OFFLOAD_TSO", NULL);
+	_svGetValue_check (f, "ETHTOOL_OFFLOAD_LRO", "yes");
+	_svGetValue_check (f, "ETHTOOL_RPS_CPUS", "f0");
+	_svGetValue_check (f, "ETHTOOL_XPS_CPUS", NULL);
+	_svGetValue_check (f, "ETHTOOL_IRQ_AFFINITY", "numa");
+	svCloseFile (f);
+
+	reread = _connection_from_file (testfile, NULL, TYPE_ETHERNET, NULL);
+
+	nmtst_assert_connection_equals (connection, TRUE, reread, FALSE);
+}
+
 /*****************************************************************************/
 
 static const char *
@@ -9118,6 +9240,34 @@ test_utils_ignore (void)
 
 /*****************************************************************************/
 
+static void
+test_utils_dir_index (void)
+{
+	GHashTable *names;
+
+	g_assert (utils_file_exists (TEST_IFCFG_DIR"/network-scripts/route-test-wired-static-routes"));
+	g_assert (!utils_file_exists (TEST_IFCFG_DIR"/network-scripts/rule-test-wired-static-routes"));
+
+	/* with the index set, files in the directory are looked up in it... */
+	names = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	g_hash_table_add (names, g_strdup ("rule-test-wired-static-routes"));
+	utils_dir_index_set (TEST_IFCFG_DIR"/network-scripts", names);
+
+	g_assert (!utils_file_exists (TEST_IFCFG_DIR"/network-scripts/route-test-wired-static-routes"));
+	g_assert (utils_file_exists (TEST_IFCFG_DIR"/network-scripts/rule-test-wired-static-routes"));
+	g_assert (utils_has_complex_routes (TEST_IFCFG_DIR"/network-scripts/ifcfg-test-wired-static-routes"));
+
+	/* ... while other paths are still checked on disk. */
+	g_assert (utils_file_exists (TEST_IFCFG_DIR"/network-scripts"));
+	g_assert (!utils_file_exists (TEST_IFCFG_DIR"/network-scripts/sub/rule-test-wired-static-routes"));
+
+	utils_dir_index_set (NULL, NULL);
+	g_assert (utils_file_exists (TEST_IFCFG_DIR"/network-scripts/route-test-wired-static-routes"));
+	g_assert (!utils_has_complex_routes (TEST_IFCFG_DIR"/network-scripts/ifcfg-test-wired-static-routes"));
+}
+
+/*****************************************************************************/
+
 #define TPATH "/settings/plugins/ifcfg-rh/"
 
 #define TEST_IFCFG_WIFI_OPEN_SSID_LONG_QUOTED TEST_IFCFG_DIR"/network-scripts/ifcfg-test-wifi-open-ssid-long-quoted"
@@ -9305,6 +9455,7 @@ int main (int argc, char **argv)
 	_add_test_write_wifi_wpa_psk (TPATH "wifi-wpa-psk/wep-wpa-wpa2-psk-write",                   "Test Write Wifi WEP WPA WPA2 PSK",                      TRUE,  TRUE,  TRUE,  DEFAULT_HEX_PSK);
 	_add_test_write_wifi_wpa_psk (TPATH "wifi-wpa-psk/wpa-wpa2-psk-passphrase-write",            "Test Write Wifi WPA WPA2 PSK Passphrase",               FALSE, TRUE,  TRUE,  "really insecure passphrase04!");
 	_add_test_write_wifi_wpa_psk (TPATH "wifi-wpa-psk/wpa-wpa2-psk-passphrase-write-spec-chars", "Test Write Wifi WPA WPA2 PSK Passphrase Special Chars", FALSE, TRUE,  TRUE,  "blah`oops\"grr'$*@~!%\\");
+	g_test_add_func (TPATH "wifi-wpa-psk/roaming-write", test_write_wifi_wpa_psk_roaming);
 
 	g_test_add_func (TPATH "wifi/write/wpa/psk/adhoc", test_write_wifi_wpa_psk_adhoc);
 	g_test_add_func (TPATH "wifi/write/wpa/eap/tls", test_write_wifi_wpa_eap_tls);
@@ -9376,6 +9527,7 @@ int main (int argc, char **argv)
 
 	g_test_add_func (TPATH "proxy/read-proxy-basic", test_read_proxy_basic);
 	g_test_add_func (TPATH "proxy/write-proxy-basic", test_write_proxy_basic);
+	g_test_add_func (TPATH "ethtool/write", test_write_ethtool);
 
 	g_test_add_func (TPATH "sit/read/ignore", test_sit_read_ignore);
 
@@ -9390,6 +9542,7 @@ int main (int argc, char **argv)
 	g_test_add_func (TPATH "utils/name", test_utils_name);
 	g_test_add_func (TPATH "utils/path", test_utils_path);
 	g_test_add_func (TPATH "utils/ignore", test_utils_ignore);
+	g_test_add_func (TPATH "utils/dir-index", test_utils_dir_index);
 
 	return g_test_run ();
 }
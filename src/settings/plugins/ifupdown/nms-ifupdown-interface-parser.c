@@ -29,6 +29,7 @@
 #include <string.h>
 #include <wordexp.h>
 #include <libgen.h>
+#include <sys/stat.h>
 
 #include "nm-utils.h"
 
@@ -37,6 +38,85 @@ if_block* last;
 
 if_data* last_data;
 
+/* name => first "iface" block of that name. The blocks are owned by the list. */
+static GHashTable *iface_index;
+static int num_blocks;
+
+/* The files and directories read by the last parse, so that a new
+ * ifparser_init() for the same file can tell whether anything changed. */
+typedef struct {
+	char *path;
+	gboolean exists;
+	dev_t dev;
+	ino_t ino;
+	off_t size;
+	struct timespec mtime;
+} FileStamp;
+
+static char *parsed_eni_file;
+static GArray *parsed_stamps;
+
+static void
+_file_stamp_get (const char *path, FileStamp *stamp)
+{
+	struct stat st;
+
+	memset (stamp, 0, sizeof (*stamp));
+	if (stat (path, &st) == 0) {
+		stamp->exists = TRUE;
+		stamp->dev = st.st_dev;
+		stamp->ino = st.st_ino;
+		stamp->size = st.st_size;
+		stamp->mtime = st.st_mtim;
+	}
+}
+
+static void
+_file_stamp_add (const char *path)
+{
+	FileStamp stamp;
+
+	_file_stamp_get (path, &stamp);
+	stamp.path = g_strdup (path);
+	g_array_append_val (parsed_stamps, stamp);
+}
+
+static gboolean
+_file_stamps_unchanged (void)
+{
+	guint i;
+
+	for (i = 0; i < parsed_stamps->len; i++) {
+		const FileStamp *old = &g_array_index (parsed_stamps, FileStamp, i);
+		FileStamp now;
+
+		_file_stamp_get (old->path, &now);
+		if (   old->exists != now.exists
+		    || old->dev != now.dev
+		    || old->ino != now.ino
+		    || old->size != now.size
+		    || old->mtime.tv_sec != now.mtime.tv_sec
+		    || old->mtime.tv_nsec != now.mtime.tv_nsec)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static void
+_file_stamp_clear (gpointer data)
+{
+	g_free (((FileStamp *) data)->path);
+}
+
+static void
+_parsed_state_reset (void)
+{
+	g_clear_pointer (&iface_index, g_hash_table_unref);
+	g_clear_pointer (&parsed_stamps, g_array_unref);
+	g_clear_pointer (&parsed_eni_file, g_free);
+	num_blocks = 0;
+}
+
 void add_block(const char *type, const char* name)
 {
 	if_block *ret = g_slice_new0 (struct _if_block);
@@ -50,6 +130,12 @@ void add_block(const char *type, const char* name)
 		last = ret;
 	}
 	last_data = NULL;
+	num_blocks++;
+
+	if (   iface_index
+	    && nm_streq (ret->type, "iface")
+	    && !g_hash_table_contains (iface_index, ret->name))
+		g_hash_table_insert (iface_index, ret->name, ret);
 }
 
 void add_data(const char *key,const char *data)
@@ -111,6 +197,9 @@ _recursive_ifparser (const char *eni_file, int quiet)
 	int skip_long_line = 0;
 	int offs = 0;
 
+	if (parsed_stamps)
+		_file_stamp_add (eni_file);
+
 	/* Check if interfaces file exists and open it */
 	if (!g_file_test (eni_file, G_FILE_TEST_EXISTS)) {
 		if (!quiet)
@@ -275,6 +364,14 @@ _ifparser_source (const char *path, const char *en_dir, int quiet, int dir)
 	if (!quiet)
 		nm_log_info (LOGD_SETTINGS, "      interface-parser: source line includes interfaces file(s) %s\n", abs_path);
 
+	/* a wildcard may match files that don't exist yet: watch the directory
+	 * they would be created in, too. */
+	if (parsed_stamps && !dir) {
+		gs_free char *abs_dir = g_path_get_dirname (abs_path);
+
+		_file_stamp_add (abs_dir);
+	}
+
 	/* ifupdown uses WRDE_NOCMD for wordexp. */
 	if (wordexp (abs_path, &we, WRDE_NOCMD)) {
 		if (!quiet)
@@ -282,6 +379,8 @@ _ifparser_source (const char *path, const char *en_dir, int quiet, int dir)
 	} else {
 		for (i = 0; i < we.we_wordc; i++) {
 			if (dir) {
+				if (parsed_stamps)
+					_file_stamp_add (we.we_wordv[i]);
 				source_dir = g_dir_open (we.we_wordv[i], 0, &error);
 				if (!source_dir) {
 					if (!quiet) {
@@ -302,10 +401,41 @@ _ifparser_source (const char *path, const char *en_dir, int quiet, int dir)
 	g_free (abs_path);
 }
 
-void ifparser_init (const char *eni_file, int quiet)
+/**
+ * ifparser_init:
+ * @eni_file: the interfaces file to parse
+ * @quiet: whether to suppress logging
+ *
+ * Parses @eni_file and the files it includes. If the same file was parsed
+ * before and neither it nor any of its includes changed since, the blocks
+ * of the previous parse are kept. Otherwise they are dropped, but not freed,
+ * as callers may still reference them; use ifparser_destroy() for that.
+ *
+ * Returns: %TRUE if the file was parsed, %FALSE if the previous result was
+ *   still up to date.
+ */
+gboolean
+ifparser_init (const char *eni_file, int quiet)
 {
+	if (   parsed_eni_file
+	    && nm_streq (parsed_eni_file, eni_file)
+	    && _file_stamps_unchanged ()) {
+		if (!quiet)
+			nm_log_info (LOGD_SETTINGS, "      interface-parser: %s and its includes are unchanged\n", eni_file);
+		return FALSE;
+	}
+
+	_parsed_state_reset ();
 	first = last = NULL;
+	last_data = NULL;
+
+	iface_index = g_hash_table_new (g_str_hash, g_str_equal);
+	parsed_stamps = g_array_new (FALSE, FALSE, sizeof (FileStamp));
+	g_array_set_clear_func (parsed_stamps, _file_stamp_clear);
+	parsed_eni_file = g_strdup (eni_file);
+
 	_recursive_ifparser (eni_file, quiet);
+	return TRUE;
 }
 
 void _destroy_data(if_data *ifd)
@@ -333,8 +463,10 @@ void _destroy_block(if_block* ifb)
 
 void ifparser_destroy(void)
 {
+	_parsed_state_reset ();
 	_destroy_block(first);
 	first = last = NULL;
+	last_data = NULL;
 }
 
 if_block *ifparser_getfirst(void)
@@ -344,19 +476,15 @@ if_block *ifparser_getfirst(void)
 
 int ifparser_get_num_blocks(void)
 {
-	int i = 0;
-	if_block *iter = first;
-
-	while (iter) {
-		i++;
-		iter = iter->next;
-	}
-	return i;
+	return num_blocks;
 }
 
 if_block *ifparser_getif(const char* iface)
 {
 	if_block *curr = first;
+
+	if (iface_index)
+		return g_hash_table_lookup (iface_index, iface);
 	while(curr!=NULL)
 	{
 		if (strcmp(curr->type,"iface")==0 && strcmp(curr->name,iface)==0)
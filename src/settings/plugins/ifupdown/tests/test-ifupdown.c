@@ -21,6 +21,8 @@
 #include "nm-default.h"
 
 #include <string.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
 
 #include "nm-core-internal.h"
 
@@ -649,6 +651,55 @@ test21_source_dir_stanza (const char *path)
 	expected_free (e);
 }
 
+static void
+test22_reparse_only_on_change (const char *path)
+{
+	gs_free char *dir = NULL;
+	gs_free char *subdir = NULL;
+	gs_free char *eni_file = NULL;
+	gs_free char *eth0_file = NULL;
+	if_block *block;
+	gboolean success;
+
+	dir = g_dir_make_tmp ("test-ifupdown-XXXXXX", NULL);
+	g_assert (dir);
+	subdir = g_build_filename (dir, "interfaces.d", NULL);
+	g_assert_cmpint (g_mkdir (subdir, 0755), ==, 0);
+	eni_file = g_build_filename (dir, "interfaces", NULL);
+	eth0_file = g_build_filename (subdir, "eth0", NULL);
+
+	success = g_file_set_contents (eni_file, "source interfaces.d/*\n", -1, NULL);
+	g_assert (success);
+	success = g_file_set_contents (eth0_file, "iface eth0 inet dhcp\n", -1, NULL);
+	g_assert (success);
+
+	g_assert (ifparser_init (eni_file, 1));
+	block = ifparser_getif ("eth0");
+	g_assert (block);
+	g_assert (!ifparser_haskey (block, "hostname"));
+
+	/* nothing changed: the blocks are kept. */
+	g_assert (!ifparser_init (eni_file, 1));
+	g_assert (ifparser_getif ("eth0") == block);
+
+	/* a change in an included file is noticed. */
+	success = g_file_set_contents (eth0_file, "iface eth0 inet dhcp\n\thostname foo\n", -1, NULL);
+	g_assert (success);
+	g_assert (ifparser_init (eni_file, 1));
+	block = ifparser_getif ("eth0");
+	g_assert (block);
+	g_assert_cmpstr (ifparser_getkey (block, "hostname"), ==, "foo");
+	g_assert_cmpint (ifparser_get_num_blocks (), ==, 1);
+	g_assert (!ifparser_getif ("eth1"));
+
+	ifparser_destroy ();
+
+	g_assert_cmpint (unlink (eth0_file), ==, 0);
+	g_assert_cmpint (rmdir (subdir), ==, 0);
+	g_assert_cmpint (unlink (eni_file), ==, 0);
+	g_assert_cmpint (rmdir (dir), ==, 0);
+}
+
 NMTST_DEFINE ();
 
 int
@@ -699,6 +750,8 @@ main (int argc, char **argv)
 	                      (GTestDataFunc) test20_source_stanza);
 	g_test_add_data_func ("/ifupdate/source_dir_stanza", TEST_ENI_DIR,
 	                      (GTestDataFunc) test21_source_dir_stanza);
+	g_test_add_data_func ("/ifupdate/reparse_only_on_change", TEST_ENI_DIR,
+	                      (GTestDataFunc) test22_reparse_only_on_change);
 
 	return g_test_run ();
 }
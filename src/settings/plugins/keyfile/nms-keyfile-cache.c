@@ -0,0 +1,297 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager system settings service
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright 2017 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "nms-keyfile-cache.h"
+
+#include "nm-core-internal.h"
+#include "nm-simple-connection.h"
+#include "NetworkManagerUtils.h"
+
+/*****************************************************************************/
+
+/* The cache is a serialized GVariant of type NMS_KEYFILE_CACHE_TYPE:
+ *
+ *   - the version of the cache format,
+ *   - the NetworkManager version that wrote it,
+ *   - the keyfile directory it describes,
+ *   - one entry per profile: the file path, st_dev, st_ino, st_size,
+ *     mtime and ctime in nanoseconds, and the connection in D-Bus form.
+ *
+ * A cached profile is only used if all stat values of the file are unchanged.
+ * The ctime is part of the key because chmod/chown don't touch the mtime, but
+ * the reader rejects files with insecure permissions or owner.
+ *
+ * Anything that doesn't match (a different version or directory) invalidates
+ * the whole cache. The file is not trusted: GVariant copes with malformed
+ * serialized data, and every cached connection is normalized and verified
+ * again when it is reconstructed. */
+
+#define NMS_KEYFILE_CACHE_FORMAT_VERSION  1
+
+#define NMS_KEYFILE_CACHE_ENTRY_TYPE_STR  "(sttttta{sa{sv}})"
+#define NMS_KEYFILE_CACHE_TYPE            G_VARIANT_TYPE ("(ussa" NMS_KEYFILE_CACHE_ENTRY_TYPE_STR ")")
+
+struct _NMSKeyfileCache {
+	GMappedFile *mapped;
+
+	/* the entries loaded from disk, of type "a" NMS_KEYFILE_CACHE_ENTRY_TYPE_STR */
+	GVariant *old_entries;
+
+	/* path (borrowed from @old_entries) to index+1 into @old_entries */
+	GHashTable *old_idx;
+
+	/* the entries that will be written by nms_keyfile_cache_save() */
+	GPtrArray *new_entries;
+};
+
+/*****************************************************************************/
+
+static guint64
+_timespec_to_ns (const struct timespec *ts)
+{
+	return ((guint64) ts->tv_sec) * NM_UTILS_NS_PER_SECOND + ts->tv_nsec;
+}
+
+/*****************************************************************************/
+
+NMSKeyfileCache *
+nms_keyfile_cache_new (void)
+{
+	NMSKeyfileCache *cache;
+
+	cache = g_slice_new0 (NMSKeyfileCache);
+	cache->new_entries = g_ptr_array_new_with_free_func ((GDestroyNotify) g_variant_unref);
+	return cache;
+}
+
+void
+nms_keyfile_cache_free (NMSKeyfileCache *cache)
+{
+	if (!cache)
+		return;
+
+	if (cache->old_idx)
+		g_hash_table_unref (cache->old_idx);
+	if (cache->old_entries)
+		g_variant_unref (cache->old_entries);
+	if (cache->mapped)
+		g_mapped_file_unref (cache->mapped);
+	g_ptr_array_unref (cache->new_entries);
+	g_slice_free (NMSKeyfileCache, cache);
+}
+
+/*****************************************************************************/
+
+/**
+ * nms_keyfile_cache_load:
+ * @cache: the #NMSKeyfileCache
+ * @filename: the cache file
+ * @keyfile_dir: the keyfile directory the cache is expected to describe
+ *
+ * Maps @filename and indexes its entries for nms_keyfile_cache_lookup().
+ *
+ * Returns: %TRUE if a valid cache was loaded.
+ */
+gboolean
+nms_keyfile_cache_load (NMSKeyfileCache *cache,
+                        const char *filename,
+                        const char *keyfile_dir)
+{
+	gs_unref_bytes GBytes *bytes = NULL;
+	gs_unref_variant GVariant *variant = NULL;
+	const char *version;
+	const char *dir;
+	guint32 format_version;
+	GVariantIter iter;
+	const char *path;
+	guint i;
+
+	g_return_val_if_fail (cache, FALSE);
+	g_return_val_if_fail (!cache->mapped, FALSE);
+
+	cache->mapped = g_mapped_file_new (filename, FALSE, NULL);
+	if (!cache->mapped)
+		return FALSE;
+
+	bytes = g_mapped_file_get_bytes (cache->mapped);
+	variant = g_variant_ref_sink (g_variant_new_from_bytes (NMS_KEYFILE_CACHE_TYPE, bytes, FALSE));
+
+	g_variant_get (variant, "(u&s&s@a" NMS_KEYFILE_CACHE_ENTRY_TYPE_STR ")",
+	               &format_version, &version, &dir, &cache->old_entries);
+	if (   format_version != NMS_KEYFILE_CACHE_FORMAT_VERSION
+	    || !nm_streq (version, VERSION)
+	    || !nm_streq (dir, keyfile_dir)) {
+		g_clear_pointer (&cache->old_entries, g_variant_unref);
+		g_clear_pointer (&cache->mapped, g_mapped_file_unref);
+		return FALSE;
+	}
+
+	cache->old_idx = g_hash_table_new (g_str_hash, g_str_equal);
+	g_variant_iter_init (&iter, cache->old_entries);
+	for (i = 0; g_variant_iter_next (&iter, "(&sttttt@a{sa{sv}})", &path, NULL, NULL, NULL, NULL, NULL, NULL); i++)
+		g_hash_table_insert (cache->old_idx, (gpointer) path, GUINT_TO_POINTER (i + 1));
+
+	return TRUE;
+}
+
+/**
+ * nms_keyfile_cache_lookup:
+ * @cache: the #NMSKeyfileCache
+ * @path: the keyfile path
+ * @st: the current stat of @path
+ *
+ * Returns: (transfer full): the normalized connection cached for @path
+ *   or %NULL if there is no entry or the file changed since.
+ */
+NMConnection *
+nms_keyfile_cache_lookup (NMSKeyfileCache *cache,
+                          const char *path,
+                          const struct stat *st)
+{
+	gs_unref_variant GVariant *entry = NULL;
+	gs_unref_variant GVariant *settings = NULL;
+	guint64 dev, ino, size, mtime_ns, ctime_ns;
+	guint idx;
+
+	g_return_val_if_fail (cache, NULL);
+	g_return_val_if_fail (path, NULL);
+	g_return_val_if_fail (st, NULL);
+
+	if (!cache->old_idx)
+		return NULL;
+
+	idx = GPOINTER_TO_UINT (g_hash_table_lookup (cache->old_idx, path));
+	if (!idx)
+		return NULL;
+
+	entry = g_variant_get_child_value (cache->old_entries, idx - 1);
+	g_variant_get (entry, "(&sttttt@a{sa{sv}})",
+	               NULL, &dev, &ino, &size, &mtime_ns, &ctime_ns, &settings);
+
+	if (   dev != (guint64) st->st_dev
+	    || ino != (guint64) st->st_ino
+	    || size != (guint64) st->st_size
+	    || mtime_ns != _timespec_to_ns (&st->st_mtim)
+	    || ctime_ns != _timespec_to_ns (&st->st_ctim))
+		return NULL;
+
+	return nm_simple_connection_new_from_dbus (settings, NULL);
+}
+
+static gboolean
+_secrets_filter_system_owned (NMSetting *setting,
+                              const char *secret,
+                              NMSettingSecretFlags flags,
+                              gpointer user_data)
+{
+	/* Returns TRUE to remove the secret */
+	return flags != NM_SETTING_SECRET_FLAG_NONE;
+}
+
+/**
+ * nms_keyfile_cache_add:
+ * @cache: the #NMSKeyfileCache
+ * @path: the keyfile path
+ * @st: the stat of @path, taken before the file was read
+ * @connection: the connection read from @path
+ *
+ * Remembers @connection for the next nms_keyfile_cache_save(). Only
+ * system-owned secrets are kept.
+ */
+void
+nms_keyfile_cache_add (NMSKeyfileCache *cache,
+                       const char *path,
+                       const struct stat *st,
+                       NMConnection *connection)
+{
+	gs_unref_object NMConnection *copy = NULL;
+	GVariant *settings;
+
+	g_return_if_fail (cache);
+	g_return_if_fail (path);
+	g_return_if_fail (st);
+	g_return_if_fail (NM_IS_CONNECTION (connection));
+
+	/* A settings connection may carry agent-owned secrets in addition to
+	 * what was read from the file. Only cache what the reader would return. */
+	copy = nm_simple_connection_new_clone (connection);
+	nm_connection_clear_secrets_with_flags (copy, _secrets_filter_system_owned, NULL);
+
+	settings = nm_connection_to_dbus (copy, NM_CONNECTION_SERIALIZE_ALL);
+	if (!settings)
+		return;
+
+	g_ptr_array_add (cache->new_entries,
+	                 g_variant_ref_sink (g_variant_new ("(sttttt@a{sa{sv}})",
+	                                                    path,
+	                                                    (guint64) st->st_dev,
+	                                                    (guint64) st->st_ino,
+	                                                    (guint64) st->st_size,
+	                                                    _timespec_to_ns (&st->st_mtim),
+	                                                    _timespec_to_ns (&st->st_ctim),
+	                                                    settings)));
+}
+
+/**
+ * nms_keyfile_cache_save:
+ * @cache: the #NMSKeyfileCache
+ * @filename: the cache file
+ * @keyfile_dir: the keyfile directory the entries were read from
+ * @error: return location for a #GError
+ *
+ * Atomically replaces @filename with the entries added via
+ * nms_keyfile_cache_add(). The file contains secrets and is only
+ * readable by root.
+ *
+ * Returns: %TRUE on success
+ */
+gboolean
+nms_keyfile_cache_save (NMSKeyfileCache *cache,
+                        const char *filename,
+                        const char *keyfile_dir,
+                        GError **error)
+{
+	GVariantBuilder builder;
+	gs_unref_variant GVariant *variant = NULL;
+	gs_unref_bytes GBytes *bytes = NULL;
+	gsize len;
+	guint i;
+
+	g_return_val_if_fail (cache, FALSE);
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a" NMS_KEYFILE_CACHE_ENTRY_TYPE_STR));
+	for (i = 0; i < cache->new_entries->len; i++)
+		g_variant_builder_add_value (&builder, cache->new_entries->pdata[i]);
+
+	variant = g_variant_ref_sink (g_variant_new ("(uss@a" NMS_KEYFILE_CACHE_ENTRY_TYPE_STR ")",
+	                                             (guint32) NMS_KEYFILE_CACHE_FORMAT_VERSION,
+	                                             VERSION,
+	                                             keyfile_dir,
+	                                             g_variant_builder_end (&builder)));
+
+	bytes = g_variant_get_data_as_bytes (variant);
+	return nm_utils_file_set_contents (filename,
+	                                   g_bytes_get_data (bytes, &len),
+	                                   len,
+	                                   0600,
+	                                   error);
+}
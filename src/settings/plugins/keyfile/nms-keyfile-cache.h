@@ -0,0 +1,51 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager system settings service
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright 2017 Red Hat, Inc.
+ */
+
+#ifndef __NMS_KEYFILE_CACHE_H__
+#define __NMS_KEYFILE_CACHE_H__
+
+#include <sys/stat.h>
+
+#define NMS_KEYFILE_CACHE_FILE NMRUNDIR "/keyfile-cache"
+
+typedef struct _NMSKeyfileCache NMSKeyfileCache;
+
+NMSKeyfileCache *nms_keyfile_cache_new (void);
+void nms_keyfile_cache_free (NMSKeyfileCache *cache);
+
+gboolean nms_keyfile_cache_load (NMSKeyfileCache *cache,
+                                 const char *filename,
+                                 const char *keyfile_dir);
+
+NMConnection *nms_keyfile_cache_lookup (NMSKeyfileCache *cache,
+                                        const char *path,
+                                        const struct stat *st);
+
+void nms_keyfile_cache_add (NMSKeyfileCache *cache,
+                            const char *path,
+                            const struct stat *st,
+                            NMConnection *connection);
+
+gboolean nms_keyfile_cache_save (NMSKeyfileCache *cache,
+                                 const char *filename,
+                                 const char *keyfile_dir,
+                                 GError **error);
+
+#endif /* __NMS_KEYFILE_CACHE_H__ */
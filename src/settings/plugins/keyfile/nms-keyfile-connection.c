@@ -50,6 +50,56 @@ G_DEFINE_TYPE (NMSKeyfileConnection, nms_keyfile_connection, NM_TYPE_SETTINGS_CO
 
 /*****************************************************************************/
 
+typedef struct {
+	NMSettingsConnection *connection;
+	NMConnection *reread;
+	NMSettingsConnectionCommitReason commit_reason;
+	NMSettingsConnectionCommitFunc callback;
+	gpointer user_data;
+} CommitData;
+
+static void
+commit_data_free (CommitData *data)
+{
+	g_object_unref (data->connection);
+	if (data->reread)
+		g_object_unref (data->reread);
+	g_slice_free (CommitData, data);
+}
+
+static void
+commit_synced_cb (const char *filename, GError *error, gpointer user_data)
+{
+	CommitData *data = user_data;
+	NMSettingsConnection *connection = data->connection;
+
+	if (error) {
+		nm_log_warn (LOGD_SETTINGS, "keyfile: update "NMS_KEYFILE_CONNECTION_LOG_FMT" failed to write to disk: %s",
+		             NMS_KEYFILE_CONNECTION_LOG_ARG (connection), error->message);
+		data->callback (connection, error, data->user_data);
+		commit_data_free (data);
+		return;
+	}
+
+	if (data->reread) {
+		gs_free_error GError *local = NULL;
+
+		if (!nm_settings_connection_replace_settings (connection, data->reread, FALSE, "update-during-write", &local)) {
+			nm_log_warn (LOGD_SETTINGS, "keyfile: update "NMS_KEYFILE_CONNECTION_LOG_FMT" after persisting connection failed: %s",
+			             NMS_KEYFILE_CONNECTION_LOG_ARG (connection), local->message);
+		} else {
+			nm_log_info (LOGD_SETTINGS, "keyfile: update "NMS_KEYFILE_CONNECTION_LOG_FMT" after persisting connection",
+			             NMS_KEYFILE_CONNECTION_LOG_ARG (connection));
+		}
+	}
+
+	NM_SETTINGS_CONNECTION_CLASS (nms_keyfile_connection_parent_class)->commit_changes (connection,
+	                                                                                    data->commit_reason,
+	                                                                                    data->callback,
+	                                                                                    data->user_data);
+	commit_data_free (data);
+}
+
 static void
 commit_changes (NMSettingsConnection *connection,
                 NMSettingsConnectionCommitReason commit_reason,
@@ -60,21 +110,37 @@ commit_changes (NMSettingsConnection *connection,
 	GError *error = NULL;
 	gs_unref_object NMConnection *reread = NULL;
 	gboolean reread_same = FALSE;
+	CommitData *data;
+
+	/* The file is written, synced and renamed over the old one on a
+	 * worker thread, followed by syncing its directory. The settings are
+	 * updated from the re-read content and the commit is reported once
+	 * all of that is done. */
+	data = g_slice_new0 (CommitData);
+	data->connection = g_object_ref (connection);
+	data->commit_reason = commit_reason;
+	data->callback = callback;
+	data->user_data = user_data;
 
 	if (!nms_keyfile_writer_connection (NM_CONNECTION (connection),
 	                                    nm_settings_connection_get_filename (connection),
 	                                    NM_FLAGS_ALL (commit_reason,   NM_SETTINGS_CONNECTION_COMMIT_REASON_USER_ACTION
 	                                                                 | NM_SETTINGS_CONNECTION_COMMIT_REASON_ID_CHANGED),
+	                                    commit_synced_cb,
+	                                    data,
 	                                    &path,
 	                                    &reread,
 	                                    &reread_same,
 	                                    &error)) {
+		commit_data_free (data);
 		callback (connection, error, user_data);
 		g_clear_error (&error);
 		return;
 	}
 
-	/* Update the filename if it changed */
+	/* Update the filename if it changed. This can't wait for the write,
+	 * further commits must use the new name. They are queued after this
+	 * one. */
 	if (   path
 	    && g_strcmp0 (path, nm_settings_connection_get_filename (connection)) != 0) {
 		gs_free char *old_path = g_strdup (nm_settings_connection_get_filename (connection));
@@ -93,24 +159,10 @@ commit_changes (NMSettingsConnection *connection,
 		             NMS_KEYFILE_CONNECTION_LOG_ARG (connection));
 	}
 
-	if (reread && !reread_same) {
-		gs_free_error GError *local = NULL;
-
-		if (!nm_settings_connection_replace_settings (connection, reread, FALSE, "update-during-write", &local)) {
-			nm_log_warn (LOGD_SETTINGS, "keyfile: update "NMS_KEYFILE_CONNECTION_LOG_FMT" after persisting connection failed: %s",
-			             NMS_KEYFILE_CONNECTION_LOG_ARG (connection), local->message);
-		} else {
-			nm_log_info (LOGD_SETTINGS, "keyfile: update "NMS_KEYFILE_CONNECTION_LOG_FMT" after persisting connection",
-			             NMS_KEYFILE_CONNECTION_LOG_ARG (connection));
-		}
-	}
+	if (reread && !reread_same)
+		data->reread = g_steal_pointer (&reread);
 
 	g_free (path);
-
-	NM_SETTINGS_CONNECTION_CLASS (nms_keyfile_connection_parent_class)->commit_changes (connection,
-	                                                                                    commit_reason,
-	                                                                                    callback,
-	                                                                                    user_data);
 }
 
 static void
@@ -139,6 +191,7 @@ nms_keyfile_connection_init (NMSKeyfileConnection *connection)
 NMSKeyfileConnection *
 nms_keyfile_connection_new (NMConnection *source,
                             const char *full_path,
+                            NMConnection *cached,
                             GError **error)
 {
 	GObject *object;
@@ -152,9 +205,15 @@ nms_keyfile_connection_new (NMConnection *source,
 	if (source)
 		tmp = g_object_ref (source);
 	else {
-		tmp = nms_keyfile_reader_from_file (full_path, error);
-		if (!tmp)
-			return NULL;
+		/* @cached is what the reader returned for @full_path earlier,
+		 * and the file didn't change since. */
+		if (cached)
+			tmp = g_object_ref (cached);
+		else {
+			tmp = nms_keyfile_reader_from_file (full_path, error);
+			if (!tmp)
+				return NULL;
+		}
 
 		uuid = nm_connection_get_uuid (NM_CONNECTION (tmp));
 		if (!uuid) {
@@ -172,12 +231,14 @@ nms_keyfile_connection_new (NMConnection *source,
 	                                   NM_SETTINGS_CONNECTION_FILENAME, full_path,
 	                                   NULL);
 
-	/* Update our settings with what was read from the file */
-	if (!nm_settings_connection_replace_settings (NM_SETTINGS_CONNECTION (object),
-	                                              tmp,
-	                                              update_unsaved,
-	                                              NULL,
-	                                              error)) {
+	/* Update our settings with what was read from the file. The reader
+	 * already normalized the connection, so don't verify it a second time. */
+	if (!nm_settings_connection_replace_settings_full (NM_SETTINGS_CONNECTION (object),
+	                                                   tmp,
+	                                                   !!source,
+	                                                   update_unsaved,
+	                                                   NULL,
+	                                                   error)) {
 		g_object_unref (object);
 		object = NULL;
 	}
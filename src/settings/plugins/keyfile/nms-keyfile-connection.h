@@ -38,6 +38,7 @@ GType nms_keyfile_connection_get_type (void);
 
 NMSKeyfileConnection *nms_keyfile_connection_new (NMConnection *source,
                                                   const char *filename,
+                                                  NMConnection *cached,
                                                   GError **error);
 
 #endif /* __NMS_KEYFILE_CONNECTION_H__ */
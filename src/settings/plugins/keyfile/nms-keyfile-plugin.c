@@ -38,8 +38,11 @@
 #include "nm-core-internal.h"
 
 #include "settings/nm-settings-plugin.h"
+#include "settings/nm-settings-dir-monitor.h"
 
 #include "nms-keyfile-connection.h"
+#include "nms-keyfile-cache.h"
+#include "nms-keyfile-reader.h"
 #include "nms-keyfile-writer.h"
 #include "nms-keyfile-utils.h"
 
@@ -47,10 +50,10 @@
 
 typedef struct {
 	GHashTable *connections;  /* uuid::connection */
+	GHashTable *paths;        /* filename::uuid, may contain stale entries */
 
 	gboolean initialized;
-	GFileMonitor *monitor;
-	gulong monitor_id;
+	NMSettingsDirMonitor *monitor;
 
 	NMConfig *config;
 } NMSKeyfilePluginPrivate;
@@ -91,6 +94,24 @@ connection_removed_cb (NMSettingsConnection *obj, gpointer user_data)
 	                     nm_connection_get_uuid (NM_CONNECTION (obj)));
 }
 
+static void
+paths_index_add (NMSKeyfilePlugin *self, NMSettingsConnection *connection)
+{
+	const char *path = nm_settings_connection_get_filename (connection);
+
+	if (path) {
+		g_hash_table_insert (NMS_KEYFILE_PLUGIN_GET_PRIVATE (self)->paths,
+		                     g_strdup (path),
+		                     g_strdup (nm_connection_get_uuid (NM_CONNECTION (connection))));
+	}
+}
+
+static void
+connection_filename_changed_cb (NMSettingsConnection *obj, GParamSpec *pspec, gpointer user_data)
+{
+	paths_index_add (user_data, obj);
+}
+
 /* Monitoring */
 
 static void
@@ -105,6 +126,7 @@ remove_connection (NMSKeyfilePlugin *self, NMSKeyfileConnection *connection)
 	/* Removing from the hash table should drop the last reference */
 	g_object_ref (connection);
 	g_signal_handlers_disconnect_by_func (connection, connection_removed_cb, self);
+	g_signal_handlers_disconnect_by_func (connection, connection_filename_changed_cb, self);
 	removed = g_hash_table_remove (NMS_KEYFILE_PLUGIN_GET_PRIVATE (self)->connections,
 	                               nm_connection_get_uuid (NM_CONNECTION (connection)));
 	nm_settings_connection_signal_remove (NM_SETTINGS_CONNECTION (connection), FALSE);
@@ -119,13 +141,30 @@ find_by_path (NMSKeyfilePlugin *self, const char *path)
 	NMSKeyfilePluginPrivate *priv = NMS_KEYFILE_PLUGIN_GET_PRIVATE (self);
 	GHashTableIter iter;
 	NMSettingsConnection *candidate = NULL;
+	const char *uuid;
 
 	g_return_val_if_fail (path != NULL, NULL);
 
+	/* every filename a connection ever had is indexed, so a miss means
+	 * there is no such connection. */
+	uuid = g_hash_table_lookup (priv->paths, path);
+	if (!uuid)
+		return NULL;
+
+	candidate = g_hash_table_lookup (priv->connections, uuid);
+	if (candidate && nm_streq0 (path, nm_settings_connection_get_filename (candidate)))
+		return NMS_KEYFILE_CONNECTION (candidate);
+
+	/* the entry is stale: the connection was renamed or removed. Another
+	 * connection might still use the file, which is rare enough to
+	 * look for it the slow way. */
+	g_hash_table_remove (priv->paths, path);
 	g_hash_table_iter_init (&iter, priv->connections);
 	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &candidate)) {
-		if (g_strcmp0 (path, nm_settings_connection_get_filename (candidate)) == 0)
+		if (g_strcmp0 (path, nm_settings_connection_get_filename (candidate)) == 0) {
+			paths_index_add (self, candidate);
 			return NMS_KEYFILE_CONNECTION (candidate);
+		}
 	}
 	return NULL;
 }
@@ -165,6 +204,7 @@ static NMSKeyfileConnection *
 update_connection (NMSKeyfilePlugin *self,
                    NMConnection *source,
                    const char *full_path,
+                   NMConnection *cached,
                    NMSKeyfileConnection *connection,
                    gboolean protect_existing_connection,
                    GHashTable *protected_connections,
@@ -180,9 +220,9 @@ update_connection (NMSKeyfilePlugin *self,
 	g_return_val_if_fail (full_path || source, NULL);
 
 	if (full_path)
-		_LOGD ("loading from file \"%s\"...", full_path);
+		_LOGD ("loading from file \"%s\"%s...", full_path, cached ? " (cached)" : "");
 
-	connection_new = nms_keyfile_connection_new (source, full_path, &local);
+	connection_new = nms_keyfile_connection_new (source, full_path, cached, &local);
 	if (!connection_new) {
 		/* Error; remove the connection */
 		if (source)
@@ -278,10 +318,14 @@ update_connection (NMSKeyfilePlugin *self,
 		else
 			_LOGI ("new connection "NMS_KEYFILE_CONNECTION_LOG_FMT, NMS_KEYFILE_CONNECTION_LOG_ARG (connection_new));
 		g_hash_table_insert (priv->connections, g_strdup (uuid), connection_new);
+		paths_index_add (self, NM_SETTINGS_CONNECTION (connection_new));
 
 		g_signal_connect (connection_new, NM_SETTINGS_CONNECTION_REMOVED,
 		                  G_CALLBACK (connection_removed_cb),
 		                  self);
+		g_signal_connect (connection_new, "notify::" NM_SETTINGS_CONNECTION_FILENAME,
+		                  G_CALLBACK (connection_filename_changed_cb),
+		                  self);
 
 		if (!source) {
 			/* Only raise the signal if we were called without source, i.e. if we read the connection from file.
@@ -293,44 +337,31 @@ update_connection (NMSKeyfilePlugin *self,
 }
 
 static void
-dir_changed (GFileMonitor *monitor,
-             GFile *file,
-             GFile *other_file,
-             GFileMonitorEvent event_type,
+dir_changed (NMSettingsDirMonitor *monitor,
+             const char *const*paths,
              gpointer user_data)
 {
-	NMSettingsPlugin *config = NM_SETTINGS_PLUGIN (user_data);
-	NMSKeyfilePlugin *self = NMS_KEYFILE_PLUGIN (config);
+	NMSKeyfilePlugin *self = NMS_KEYFILE_PLUGIN (user_data);
 	NMSKeyfileConnection *connection;
-	char *full_path;
+	const char *full_path;
 	gboolean exists;
+	guint i;
 
-	full_path = g_file_get_path (file);
-	if (nms_keyfile_utils_should_ignore_file (full_path)) {
-		g_free (full_path);
-		return;
-	}
-	exists = g_file_test (full_path, G_FILE_TEST_EXISTS);
+	for (i = 0; paths[i]; i++) {
+		full_path = paths[i];
+		if (nms_keyfile_utils_should_ignore_file (full_path))
+			continue;
 
-	_LOGD ("dir_changed(%s) = %d; file %s", full_path, event_type, exists ? "exists" : "does not exist");
+		exists = g_file_test (full_path, G_FILE_TEST_EXISTS);
 
-	connection = find_by_path (self, full_path);
+		_LOGD ("dir_changed(%s): file %s", full_path, exists ? "exists" : "does not exist");
 
-	switch (event_type) {
-	case G_FILE_MONITOR_EVENT_DELETED:
-		if (!exists && connection)
-			remove_connection (NMS_KEYFILE_PLUGIN (config), connection);
-		break;
-	case G_FILE_MONITOR_EVENT_CREATED:
-	case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+		connection = find_by_path (self, full_path);
 		if (exists)
-			update_connection (NMS_KEYFILE_PLUGIN (config), NULL, full_path, connection, TRUE, NULL, NULL);
-		break;
-	default:
-		break;
+			update_connection (self, NULL, full_path, NULL, connection, TRUE, NULL, NULL);
+		else if (connection)
+			remove_connection (self, connection);
 	}
-
-	g_free (full_path);
 }
 
 static void
@@ -353,19 +384,9 @@ static void
 setup_monitoring (NMSettingsPlugin *config)
 {
 	NMSKeyfilePluginPrivate *priv = NMS_KEYFILE_PLUGIN_GET_PRIVATE ((NMSKeyfilePlugin *) config);
-	GFile *file;
-	GFileMonitor *monitor;
-
-	if (nm_config_get_monitor_connection_files (priv->config)) {
-		file = g_file_new_for_path (nms_keyfile_utils_get_path ());
-		monitor = g_file_monitor_directory (file, G_FILE_MONITOR_NONE, NULL, NULL);
-		g_object_unref (file);
 
-		if (monitor) {
-			priv->monitor_id = g_signal_connect (monitor, "changed", G_CALLBACK (dir_changed), config);
-			priv->monitor = monitor;
-		}
-	}
+	if (nm_config_get_monitor_connection_files (priv->config))
+		priv->monitor = nm_settings_dir_monitor_new (nms_keyfile_utils_get_path (), dir_changed, config);
 
 	g_signal_connect (G_OBJECT (priv->config),
 	                  NM_CONFIG_SIGNAL_CONFIG_CHANGED,
@@ -390,24 +411,54 @@ _paths_from_connections (GHashTable *connections)
 	return paths;
 }
 
+typedef struct {
+	char *path;
+	struct stat st;
+	gint64 mtime;
+	bool st_valid;
+	bool loaded;
+} ReadDirEntry;
+
+static void
+_read_dir_entry_clear (gpointer data)
+{
+	g_free (((ReadDirEntry *) data)->path);
+}
+
 static int
-_sort_paths (const char **f1, const char **f2, GHashTable *paths)
+_sort_paths (gconstpointer a, gconstpointer b)
 {
-	struct stat st;
-	gboolean c1, c2;
-	gint64 m1, m2;
+	const ReadDirEntry *e1 = a;
+	const ReadDirEntry *e2 = b;
+
+	if (e1->loaded != e2->loaded)
+		return e1->loaded ? -1 : 1;
+
+	if (e1->mtime != e2->mtime)
+		return e1->mtime > e2->mtime ? -1 : 1;
+
+	return strcmp (e1->path, e2->path);
+}
 
-	c1 = !!g_hash_table_contains (paths, *f1);
-	c2 = !!g_hash_table_contains (paths, *f2);
-	if (c1 != c2)
-		return c1 ? -1 : 1;
+/* parsing fewer files than this on worker threads isn't worth it. */
+#define PARSE_PARALLEL_MIN 8
 
-	m1 = stat (*f1, &st) == 0 ? (gint64) st.st_mtime : G_MININT64;
-	m2 = stat (*f2, &st) == 0 ? (gint64) st.st_mtime : G_MININT64;
-	if (m1 != m2)
-		return m1 > m2 ? -1 : 1;
+typedef struct {
+	GArray *filenames;
+	GArray *todo;
+	NMConnection **parsed;
+} ParseData;
 
-	return strcmp (*f1, *f2);
+static void
+_parse_one (guint idx, gpointer user_data)
+{
+	const ParseData *data = user_data;
+	guint i = g_array_index (data->todo, guint, idx);
+
+	/* Errors are discarded: the file then goes through update_connection()
+	 * like before, which reads it again and reports the failure. */
+	data->parsed[i] = nms_keyfile_reader_from_file (g_array_index (data->filenames, ReadDirEntry, i).path,
+	                                                NULL);
 }
 
 static void
@@ -423,8 +474,10 @@ read_connections (NMSettingsPlugin *config)
 	NMSKeyfileConnection *connection;
 	GPtrArray *dead_connections = NULL;
 	guint i;
-	GPtrArray *filenames;
+	GArray *filenames;
 	GHashTable *paths;
+	NMSKeyfileCache *cache = NULL;
+	ParseData parse_data = { 0 };
 
 	dir = g_dir_open (nms_keyfile_utils_get_path (), 0, &error);
 	if (!dir) {
@@ -437,30 +490,85 @@ read_connections (NMSettingsPlugin *config)
 
 	alive_connections = g_hash_table_new (NULL, NULL);
 
-	filenames = g_ptr_array_new_with_free_func (g_free);
-	while ((item = g_dir_read_name (dir))) {
-		if (nms_keyfile_utils_should_ignore_file (item))
-			continue;
-		g_ptr_array_add (filenames, g_build_filename (nms_keyfile_utils_get_path (), item, NULL));
-	}
-	g_dir_close (dir);
-
 	/* While reloading, we don't replace connections that we already loaded while
 	 * iterating over the files.
 	 *
 	 * To have sensible, reproducible behavior, sort the paths by last modification
-	 * time prefering older files.
+	 * time prefering older files. Stat each file only once up front instead of
+	 * on every comparison, it matters with thousands of profiles.
 	 */
 	paths = _paths_from_connections (priv->connections);
-	g_ptr_array_sort_with_data (filenames, (GCompareDataFunc) _sort_paths, paths);
+	filenames = g_array_new (FALSE, FALSE, sizeof (ReadDirEntry));
+	g_array_set_clear_func (filenames, _read_dir_entry_clear);
+	while ((item = g_dir_read_name (dir))) {
+		ReadDirEntry entry;
+
+		if (nms_keyfile_utils_should_ignore_file (item))
+			continue;
+		entry.path = g_build_filename (nms_keyfile_utils_get_path (), item, NULL);
+		entry.st_valid = stat (entry.path, &entry.st) == 0;
+		entry.mtime = entry.st_valid ? (gint64) entry.st.st_mtime : G_MININT64;
+		entry.loaded = g_hash_table_contains (paths, entry.path);
+		g_array_append_val (filenames, entry);
+	}
+	g_dir_close (dir);
 	g_hash_table_destroy (paths);
 
+	g_array_sort (filenames, _sort_paths);
+
+	/* Profiles whose file didn't change since the last time we read the
+	 * directory are taken from the cache instead of parsing them again. */
+	if (!nm_utils_get_testing ()) {
+		cache = nms_keyfile_cache_new ();
+		if (!nms_keyfile_cache_load (cache, NMS_KEYFILE_CACHE_FILE, nms_keyfile_utils_get_path ()))
+			_LOGD ("no valid cache in \"%s\"", NMS_KEYFILE_CACHE_FILE);
+	}
+
+	/* Parsing the files is independent of each other and of the state of
+	 * the plugin, so the files that are not in the cache are parsed on
+	 * worker threads first. The connections are then claimed in the sorted
+	 * order on the main thread, as if they came from the cache. */
+	parse_data.filenames = filenames;
+	parse_data.parsed = g_new0 (NMConnection *, filenames->len);
+	parse_data.todo = g_array_new (FALSE, FALSE, sizeof (guint));
 	for (i = 0; i < filenames->len; i++) {
-		connection = update_connection (self, NULL, filenames->pdata[i], NULL, FALSE, alive_connections, NULL);
-		if (connection)
-			g_hash_table_add (alive_connections, connection);
+		const ReadDirEntry *entry = &g_array_index (filenames, ReadDirEntry, i);
+
+		if (cache && entry->st_valid)
+			parse_data.parsed[i] = nms_keyfile_cache_lookup (cache, entry->path, &entry->st);
+		if (   !parse_data.parsed[i]
+		    && entry->st_valid
+		    && S_ISREG (entry->st.st_mode))
+			g_array_append_val (parse_data.todo, i);
+	}
+	if (parse_data.todo->len >= PARSE_PARALLEL_MIN)
+		nm_utils_run_parallel (parse_data.todo->len, _parse_one, &parse_data);
+	g_array_free (parse_data.todo, TRUE);
+
+	for (i = 0; i < filenames->len; i++) {
+		const ReadDirEntry *entry = &g_array_index (filenames, ReadDirEntry, i);
+		gs_unref_object NMConnection *cached = g_steal_pointer (&parse_data.parsed[i]);
+
+		connection = update_connection (self, NULL, entry->path, cached, NULL, FALSE, alive_connections, NULL);
+		if (!connection)
+			continue;
+
+		g_hash_table_add (alive_connections, connection);
+		if (   cache
+		    && entry->st_valid
+		    && nm_streq0 (nm_settings_connection_get_filename (NM_SETTINGS_CONNECTION (connection)), entry->path))
+			nms_keyfile_cache_add (cache, entry->path, &entry->st, NM_CONNECTION (connection));
+	}
+	g_array_free (filenames, TRUE);
+	g_free (parse_data.parsed);
+
+	if (cache) {
+		if (!nms_keyfile_cache_save (cache, NMS_KEYFILE_CACHE_FILE, nms_keyfile_utils_get_path (), &error)) {
+			_LOGD ("failed to write cache \"%s\": %s", NMS_KEYFILE_CACHE_FILE, error->message);
+			g_clear_error (&error);
+		}
+		nms_keyfile_cache_free (cache);
 	}
-	g_ptr_array_free (filenames, TRUE);
 
 	g_hash_table_iter_init (&iter, priv->connections);
 	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &connection)) {
@@ -511,7 +619,7 @@ load_connection (NMSettingsPlugin *config,
 	if (nms_keyfile_utils_should_ignore_file (filename + dir_len + 1))
 		return FALSE;
 
-	connection = update_connection (self, NULL, filename, find_by_path (self, filename), TRUE, NULL, NULL);
+	connection = update_connection (self, NULL, filename, NULL, find_by_path (self, filename), TRUE, NULL, NULL);
 
 	return (connection != NULL);
 }
@@ -536,13 +644,15 @@ add_connection (NMSettingsPlugin *config,
 		if (!nms_keyfile_writer_connection (connection,
 		                                    NULL,
 		                                    FALSE,
+		                                    NULL,
+		                                    NULL,
 		                                    &path,
 		                                    &reread,
 		                                    NULL,
 		                                    error))
 			return NULL;
 	}
-	return NM_SETTINGS_CONNECTION (update_connection (self, reread ?: connection, path, NULL, FALSE, NULL, error));
+	return NM_SETTINGS_CONNECTION (update_connection (self, reread ?: connection, path, NULL, NULL, FALSE, NULL, error));
 }
 
 static GSList *
@@ -589,6 +699,7 @@ nms_keyfile_plugin_init (NMSKeyfilePlugin *plugin)
 
 	priv->config = g_object_ref (nm_config_get ());
 	priv->connections = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+	priv->paths = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 }
 
 static void
@@ -616,17 +727,13 @@ dispose (GObject *object)
 {
 	NMSKeyfilePluginPrivate *priv = NMS_KEYFILE_PLUGIN_GET_PRIVATE ((NMSKeyfilePlugin *) object);
 
-	if (priv->monitor) {
-		nm_clear_g_signal_handler (priv->monitor, &priv->monitor_id);
-
-		g_file_monitor_cancel (priv->monitor);
-		g_clear_object (&priv->monitor);
-	}
+	g_clear_pointer (&priv->monitor, nm_settings_dir_monitor_free);
 
 	if (priv->connections) {
 		g_hash_table_destroy (priv->connections);
 		priv->connections = NULL;
 	}
+	g_clear_pointer (&priv->paths, g_hash_table_destroy);
 
 	if (priv->config) {
 		g_signal_handlers_disconnect_by_func (priv->config, config_changed_cb, object);
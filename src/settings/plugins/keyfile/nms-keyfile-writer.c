@@ -167,6 +167,36 @@ _handler_write (NMConnection *connection,
 	return FALSE;
 }
 
+typedef struct {
+	uid_t owner_uid;
+	pid_t owner_grp;
+	NMUtilsFileSyncCallback callback;
+	gpointer user_data;
+} WriteQueuedData;
+
+static void
+_write_queued_cb (const char *filename, GError *error, gpointer user_data)
+{
+	WriteQueuedData *data = user_data;
+	gs_free_error GError *local = NULL;
+	int errsv;
+
+	if (error) {
+		g_set_error (&local, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_FAILED,
+		             "error writing to file '%s': %s",
+		             filename, error->message);
+	} else if (chown (filename, data->owner_uid, data->owner_grp) < 0) {
+		errsv = errno;
+		g_set_error (&local, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_FAILED,
+		             "error chowning '%s': %s (%d)",
+		             filename, g_strerror (errsv), errsv);
+		unlink (filename);
+	}
+
+	data->callback (filename, local, data->user_data);
+	g_slice_free (WriteQueuedData, data);
+}
+
 static gboolean
 _internal_write_connection (NMConnection *connection,
                             const char *keyfile_dir,
@@ -174,6 +204,9 @@ _internal_write_connection (NMConnection *connection,
                             pid_t owner_grp,
                             const char *existing_path,
                             gboolean force_rename,
+                            gboolean sync_to_disk,
+                            NMUtilsFileSyncCallback sync_callback,
+                            gpointer sync_user_data,
                             char **out_path,
                             NMConnection **out_reread,
                             gboolean *out_reread_same,
@@ -191,7 +224,7 @@ _internal_write_connection (NMConnection *connection,
 	g_return_val_if_fail (!out_path || !*out_path, FALSE);
 	g_return_val_if_fail (keyfile_dir && keyfile_dir[0] == '/', FALSE);
 
-	switch (_nm_connection_verify (connection, error)) {
+	switch (_nm_connection_verify_cached (connection, error)) {
 	case NM_SETTING_VERIFY_NORMALIZABLE:
 		nm_assert_not_reached ();
 		/* fall-through */
@@ -276,22 +309,40 @@ _internal_write_connection (NMConnection *connection,
 	if (existing_path != NULL && strcmp (path, existing_path) != 0)
 		unlink (existing_path);
 
-	nm_utils_file_set_contents (path, data, len, 0600, &local_err);
-	if (local_err) {
-		g_set_error (error, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_FAILED,
-		             "error writing to file '%s': %s",
-		             path, local_err->message);
-		g_error_free (local_err);
-		return FALSE;
-	}
+	if (sync_to_disk && sync_callback) {
+		WriteQueuedData *queued;
+
+		/* writing, syncing and renaming the file all happen on a worker
+		 * thread. @sync_callback tells whether that succeeded. */
+		queued = g_slice_new (WriteQueuedData);
+		queued->owner_uid = owner_uid;
+		queued->owner_grp = owner_grp;
+		queued->callback = sync_callback;
+		queued->user_data = sync_user_data;
+		nm_utils_file_set_contents_queue (path, data, len, 0600, _write_queued_cb, queued);
+	} else {
+		/* the data is synced before the file replaces the old one, only
+		 * syncing the directory is deferred. */
+		nm_utils_file_set_contents_full (path, data, len, 0600, sync_to_disk, &local_err);
+		if (local_err) {
+			g_set_error (error, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_FAILED,
+			             "error writing to file '%s': %s",
+			             path, local_err->message);
+			g_error_free (local_err);
+			return FALSE;
+		}
 
-	if (chown (path, owner_uid, owner_grp) < 0) {
-		errsv = errno;
-		g_set_error (error, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_FAILED,
-		             "error chowning '%s': %s (%d)",
-		             path, g_strerror (errsv), errsv);
-		unlink (path);
-		return FALSE;
+		if (chown (path, owner_uid, owner_grp) < 0) {
+			errsv = errno;
+			g_set_error (error, NM_SETTINGS_ERROR, NM_SETTINGS_ERROR_FAILED,
+			             "error chowning '%s': %s (%d)",
+			             path, g_strerror (errsv), errsv);
+			unlink (path);
+			return FALSE;
+		}
+
+		if (sync_to_disk)
+			nm_utils_file_sync_dir_queue (path, NULL, NULL);
 	}
 
 	if (out_path && g_strcmp0 (existing_path, path)) {
@@ -337,6 +388,8 @@ gboolean
 nms_keyfile_writer_connection (NMConnection *connection,
                                const char *existing_path,
                                gboolean force_rename,
+                               NMUtilsFileSyncCallback sync_callback,
+                               gpointer sync_user_data,
                                char **out_path,
                                NMConnection **out_reread,
                                gboolean *out_reread_same,
@@ -347,6 +400,9 @@ nms_keyfile_writer_connection (NMConnection *connection,
 	                                   0, 0,
 	                                   existing_path,
 	                                   force_rename,
+	                                   TRUE,
+	                                   sync_callback,
+	                                   sync_user_data,
 	                                   out_path,
 	                                   out_reread,
 	                                   out_reread_same,
@@ -368,6 +424,9 @@ nms_keyfile_writer_test_connection (NMConnection *connection,
 	                                   owner_uid, owner_grp,
 	                                   NULL,
 	                                   FALSE,
+	                                   FALSE,
+	                                   NULL,
+	                                   NULL,
 	                                   out_path,
 	                                   out_reread,
 	                                   out_reread_same,
@@ -23,10 +23,13 @@
 #define __NMS_KEYFILE_WRITER_H__
 
 #include "nm-connection.h"
+#include "nm-core-utils.h"
 
 gboolean nms_keyfile_writer_connection (NMConnection *connection,
                                         const char *existing_path,
                                         gboolean force_rename,
+                                        NMUtilsFileSyncCallback sync_callback,
+                                        gpointer sync_user_data,
                                         char **out_path,
                                         NMConnection **out_reread,
                                         gboolean *out_reread_same,
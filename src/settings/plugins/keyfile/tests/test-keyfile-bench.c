@@ -0,0 +1,107 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright 2017 Red Hat, Inc.
+ */
+
+/* Read/write benchmark for the keyfile plugin, using the fixtures of
+ * test-keyfile.
+ *
+ * This is not run by "make check". Run it by hand. The fixtures that
+ * read fine are copied, with a new ID and UUID, to a scratch directory
+ *
+ *   NMTST_BENCH_COPIES     number of connections written (default 1000)
+ *   NMTST_BENCH_RELOADS    number of re-reads of a single file (default 1000)
+ *
+ * and the benchmark measures writing them, reading the whole directory
+ * like the plugin does on load, and reading a single file again. Each
+ * benchmark prints one line
+ *
+ *   bench<TAB>keyfile<TAB>operation<TAB>count<TAB>ns-per-op
+ *
+ * to stdout, see nmtst_settings_bench_run(). */
+
+#include "nm-default.h"
+
+#include <errno.h>
+#include <unistd.h>
+
+#include "nm-core-internal.h"
+
+#include "settings/plugins/keyfile/nms-keyfile-reader.h"
+#include "settings/plugins/keyfile/nms-keyfile-writer.h"
+#include "settings/plugins/keyfile/nms-keyfile-utils.h"
+
+#include "nm-test-utils-core.h"
+
+/*****************************************************************************/
+
+static NMConnection *
+_read_fixture (const char *path)
+{
+	NMConnection *connection;
+
+	connection = nms_keyfile_reader_from_file (path, NULL);
+	if (   connection
+	    && !nm_connection_normalize (connection, NULL, NULL, NULL))
+		g_clear_object (&connection);
+	return connection;
+}
+
+static NMConnection *
+_read (const char *path)
+{
+	return nms_keyfile_reader_from_file (path, NULL);
+}
+
+static gboolean
+_write (NMConnection *connection, const char *dirname, char **out_path)
+{
+	return nms_keyfile_writer_test_connection (connection, dirname, geteuid (), getegid (),
+	                                           out_path, NULL, NULL, NULL);
+}
+
+static void
+test_bench (void)
+{
+	static const NMTstSettingsBench bench = {
+		.profile = "keyfile",
+		.fixtures_dir = TEST_KEYFILES_DIR,
+		.should_ignore_file = nms_keyfile_utils_should_ignore_file,
+		.read_fixture = _read_fixture,
+		.read = _read,
+		.write = _write,
+	};
+
+	nmtst_settings_bench_run (&bench, TEST_SCRATCH_DIR);
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE ();
+
+int main (int argc, char **argv)
+{
+	_nm_utils_set_testing (NM_UTILS_TEST_NO_KEYFILE_OWNER_CHECK);
+	nmtst_init_with_logging (&argc, &argv, "ERR", "DEFAULT");
+
+	if (g_mkdir_with_parents (TEST_SCRATCH_DIR, 0755) != 0)
+		g_error ("failure to create test directory \"%s\": %s", TEST_SCRATCH_DIR, g_strerror (errno));
+
+	g_test_add_func ("/keyfile-bench/read-write", test_bench);
+
+	return g_test_run ();
+}
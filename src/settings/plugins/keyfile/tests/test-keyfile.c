@@ -33,6 +33,7 @@
 #include "settings/plugins/keyfile/nms-keyfile-reader.h"
 #include "settings/plugins/keyfile/nms-keyfile-writer.h"
 #include "settings/plugins/keyfile/nms-keyfile-utils.h"
+#include "settings/plugins/keyfile/nms-keyfile-cache.h"
 
 #include "nm-test-utils-core.h"
 
@@ -2671,6 +2672,183 @@ test_nm_keyfile_plugin_utils_escape_filename (void)
 
 /*****************************************************************************/
 
+#define TEST_CACHE_FILE    TEST_SCRATCH_DIR "/keyfile-cache"
+#define TEST_CACHE_PROFILE TEST_SCRATCH_DIR "/Test_Cached_Profile"
+
+static NMConnection *
+_cache_create_profile (struct stat *st)
+{
+	NMConnection *connection;
+	GError *error = NULL;
+
+	connection = nmtst_create_minimal_connection ("Test Cached Profile", NULL,
+	                                              NM_SETTING_WIRED_SETTING_NAME, NULL);
+	nmtst_connection_normalize (connection);
+
+	/* the cache only looks at the stat of the file */
+	g_file_set_contents (TEST_CACHE_PROFILE, "[connection]\n", -1, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (stat (TEST_CACHE_PROFILE, st), ==, 0);
+	return connection;
+}
+
+static void
+_cache_save (NMConnection *connection, const struct stat *st)
+{
+	NMSKeyfileCache *cache;
+	GError *error = NULL;
+
+	cache = nms_keyfile_cache_new ();
+	nms_keyfile_cache_add (cache, TEST_CACHE_PROFILE, st, connection);
+	nms_keyfile_cache_save (cache, TEST_CACHE_FILE, TEST_SCRATCH_DIR, &error);
+	g_assert_no_error (error);
+	nms_keyfile_cache_free (cache);
+}
+
+static void
+test_keyfile_cache_roundtrip (void)
+{
+	gs_unref_object NMConnection *connection = NULL;
+	gs_unref_object NMConnection *cached = NULL;
+	NMSKeyfileCache *cache;
+	struct stat st;
+
+	connection = _cache_create_profile (&st);
+	_cache_save (connection, &st);
+
+	cache = nms_keyfile_cache_new ();
+	g_assert (nms_keyfile_cache_load (cache, TEST_CACHE_FILE, TEST_SCRATCH_DIR));
+	cached = nms_keyfile_cache_lookup (cache, TEST_CACHE_PROFILE, &st);
+	g_assert (cached);
+	nmtst_assert_connection_equals (connection, FALSE, cached, FALSE);
+	g_assert (!nms_keyfile_cache_lookup (cache, TEST_SCRATCH_DIR "/Test_Not_Cached", &st));
+	nms_keyfile_cache_free (cache);
+
+	/* the cache describes another directory */
+	cache = nms_keyfile_cache_new ();
+	g_assert (!nms_keyfile_cache_load (cache, TEST_CACHE_FILE, TEST_KEYFILES_DIR));
+	g_assert (!nms_keyfile_cache_lookup (cache, TEST_CACHE_PROFILE, &st));
+	nms_keyfile_cache_free (cache);
+
+	unlink (TEST_CACHE_FILE);
+	unlink (TEST_CACHE_PROFILE);
+}
+
+static void
+test_keyfile_cache_invalidate (void)
+{
+	gs_unref_object NMConnection *connection = NULL;
+	gs_unref_object NMConnection *cached = NULL;
+	NMSKeyfileCache *cache;
+	GError *error = NULL;
+	struct stat st, st2;
+
+	connection = _cache_create_profile (&st);
+	_cache_save (connection, &st);
+
+	cache = nms_keyfile_cache_new ();
+	g_assert (nms_keyfile_cache_load (cache, TEST_CACHE_FILE, TEST_SCRATCH_DIR));
+
+	st2 = st;
+	st2.st_mtim.tv_nsec = (st2.st_mtim.tv_nsec + 1) % NM_UTILS_NS_PER_SECOND;
+	g_assert (!nms_keyfile_cache_lookup (cache, TEST_CACHE_PROFILE, &st2));
+
+	st2 = st;
+	st2.st_ctim.tv_sec++;
+	g_assert (!nms_keyfile_cache_lookup (cache, TEST_CACHE_PROFILE, &st2));
+
+	st2 = st;
+	st2.st_size++;
+	g_assert (!nms_keyfile_cache_lookup (cache, TEST_CACHE_PROFILE, &st2));
+
+	st2 = st;
+	st2.st_ino++;
+	g_assert (!nms_keyfile_cache_lookup (cache, TEST_CACHE_PROFILE, &st2));
+
+	st2 = st;
+	st2.st_dev++;
+	g_assert (!nms_keyfile_cache_lookup (cache, TEST_CACHE_PROFILE, &st2));
+
+	/* the file is really rewritten */
+	g_file_set_contents (TEST_CACHE_PROFILE, "[connection]\nid=changed\n", -1, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (stat (TEST_CACHE_PROFILE, &st2), ==, 0);
+	g_assert (!nms_keyfile_cache_lookup (cache, TEST_CACHE_PROFILE, &st2));
+
+	cached = nms_keyfile_cache_lookup (cache, TEST_CACHE_PROFILE, &st);
+	g_assert (cached);
+	nms_keyfile_cache_free (cache);
+
+	unlink (TEST_CACHE_FILE);
+	unlink (TEST_CACHE_PROFILE);
+}
+
+static void
+_cache_write_variant (guint32 format_version, const char *version)
+{
+	gs_unref_variant GVariant *variant = NULL;
+	GError *error = NULL;
+
+	variant = g_variant_ref_sink (g_variant_new ("(ussa(sttttta{sa{sv}}))",
+	                                             format_version,
+	                                             version,
+	                                             TEST_SCRATCH_DIR,
+	                                             NULL));
+	g_file_set_contents (TEST_CACHE_FILE,
+	                     (const char *) g_variant_get_data (variant),
+	                     g_variant_get_size (variant),
+	                     &error);
+	g_assert_no_error (error);
+}
+
+static gboolean
+_cache_load (void)
+{
+	NMSKeyfileCache *cache;
+	gboolean success;
+
+	cache = nms_keyfile_cache_new ();
+	success = nms_keyfile_cache_load (cache, TEST_CACHE_FILE, TEST_SCRATCH_DIR);
+	nms_keyfile_cache_free (cache);
+	return success;
+}
+
+static void
+test_keyfile_cache_invalid_file (void)
+{
+	GError *error = NULL;
+
+	unlink (TEST_CACHE_FILE);
+	g_assert (!_cache_load ());
+
+	g_file_set_contents (TEST_CACHE_FILE, "", 0, &error);
+	g_assert_no_error (error);
+	g_assert (!_cache_load ());
+
+	g_file_set_contents (TEST_CACHE_FILE, "\x01\xFFnot a cache\x00\x17", 15, &error);
+	g_assert_no_error (error);
+	g_assert (!_cache_load ());
+
+	/* the current format, to make sure the ones below only fail
+	 * because of the version */
+	_cache_write_variant (1, VERSION);
+	g_assert (_cache_load ());
+
+	_cache_write_variant (0, VERSION);
+	g_assert (!_cache_load ());
+
+	_cache_write_variant (2, VERSION);
+	g_assert (!_cache_load ());
+
+	/* written by another NetworkManager version */
+	_cache_write_variant (1, "0.9.10.0");
+	g_assert (!_cache_load ());
+
+	unlink (TEST_CACHE_FILE);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE ();
 
 int main (int argc, char **argv)
@@ -2750,6 +2928,10 @@ int main (int argc, char **argv)
 
 	g_test_add_func ("/keyfile/test_nm_keyfile_plugin_utils_escape_filename", test_nm_keyfile_plugin_utils_escape_filename);
 
+	g_test_add_func ("/keyfile/cache/roundtrip", test_keyfile_cache_roundtrip);
+	g_test_add_func ("/keyfile/cache/invalidate", test_keyfile_cache_invalidate);
+	g_test_add_func ("/keyfile/cache/invalid-file", test_keyfile_cache_invalid_file);
+
 	return g_test_run ();
 }
 
@@ -695,7 +695,16 @@ nm_supplicant_config_add_setting_wireless_security (NMSupplicantConfig *self,
 	g_return_val_if_fail (!error || !*error, FALSE);
 
 	key_mgmt = nm_setting_wireless_security_get_key_mgmt (setting);
-	if (!add_string_val (self, key_mgmt, "key_mgmt", TRUE, NULL, error))
+	if (   nm_setting_wireless_security_get_ft (setting) == 1
+	    && NM_IN_STRSET (key_mgmt, "wpa-psk", "wpa-eap")) {
+		gs_free char *value = NULL;
+
+		/* Offer 802.11r Fast BSS Transition next to the plain key management,
+		 * so that APs which don't support it remain usable. */
+		value = g_strdup_printf ("%s ft-%s", key_mgmt, &key_mgmt[4]);
+		if (!add_string_val (self, value, "key_mgmt", TRUE, NULL, error))
+			return FALSE;
+	} else if (!add_string_val (self, key_mgmt, "key_mgmt", TRUE, NULL, error))
 		return FALSE;
 
 	auth_alg = nm_setting_wireless_security_get_auth_alg (setting);
@@ -819,9 +828,12 @@ nm_supplicant_config_add_setting_wireless_security (NMSupplicantConfig *self,
 
 			/* When using WPA-Enterprise, we want to use Proactive Key Caching (also
 			 * called Opportunistic Key Caching) to avoid full EAP exchanges when
-			 * roaming between access points in the same mobility group.
+			 * roaming between access points in the same mobility group, unless
+			 * the connection disables it.
 			 */
-			if (!nm_supplicant_config_add_option (self, "proactive_key_caching", "1", -1, NULL, error))
+			if (!nm_supplicant_config_add_option (self, "proactive_key_caching",
+			                                      nm_setting_wireless_security_get_okc (setting) == 0 ? "0" : "1",
+			                                      -1, NULL, error))
 				return FALSE;
 		}
 	}
@@ -25,6 +25,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <net/ethernet.h>
 
 #include "NetworkManagerUtils.h"
 #include "nm-supplicant-config.h"
@@ -40,10 +41,19 @@
 /*****************************************************************************/
 
 typedef struct {
-	GDBusProxy *proxy;
-	gulong change_id;
+	/* the object path, also the key in the bss_hash. */
+	char *path;
+
+	/* the cached a{sv} properties of the BSS, or %NULL while
+	 * they are still fetched. */
+	GVariant *props;
 } BssData;
 
+typedef struct {
+	NMSupplicantInterface *self;
+	char *path;
+} BssGetAllData;
+
 struct _AddNetworkData;
 
 typedef struct {
@@ -54,6 +64,7 @@ typedef struct {
 	gpointer user_data;
 	guint fail_on_idle_id;
 	guint blobs_left;
+	char *net_checksum;
 	struct _AddNetworkData *add_network_data;
 } AssocData;
 
@@ -88,6 +99,7 @@ typedef struct {
 	gboolean       has_credreq;  /* Whether querying 802.1x credentials is supported */
 	NMSupplicantFeature fast_support;
 	NMSupplicantFeature ap_support;   /* Lightweight AP mode support */
+	NMSupplicantFeature scan_rand_mac_support; /* MAC address randomization for scans */
 	guint32        max_scan_ssids;
 	guint32        ready_count;
 
@@ -100,6 +112,8 @@ typedef struct {
 	bool           scan_done_pending:1;
 	bool           scan_done_success:1;
 
+	bool           scan_rand_mac:1;
+
 	GDBusProxy *   wpas_proxy;
 	GCancellable * init_cancellable;
 	GDBusProxy *   iface_proxy;
@@ -107,8 +121,17 @@ typedef struct {
 
 	AssocData *    assoc_data;
 
+	/* the network added by the last association. It is kept, but disabled,
+	 * after disconnecting, and selected again if the next association has
+	 * the same configuration, identified by @net_checksum. */
 	char *         net_path;
-	GHashTable *   bss_proxies;
+	char *         net_checksum;
+
+	/* blob name -> checksum of the data that was added to the supplicant */
+	GHashTable *   blobs;
+
+	GHashTable *   bss_hash;
+	guint          bss_props_changed_id;
 	char *         current_bss;
 
 	gint32         last_scan; /* timestamp as returned by nm_utils_get_monotonic_timestamp_s() */
@@ -147,6 +170,7 @@ G_DEFINE_TYPE (NMSupplicantInterface, nm_supplicant_interface, G_TYPE_OBJECT)
 /*****************************************************************************/
 
 static void scan_done_emit_signal (NMSupplicantInterface *self);
+static void log_result_cb (GDBusProxy *proxy, GAsyncResult *result, gpointer user_data);
 
 /*****************************************************************************/
 
@@ -176,119 +200,146 @@ bss_data_destroy (gpointer user_data)
 {
 	BssData *bss_data = user_data;
 
-	nm_clear_g_signal_handler (bss_data->proxy, &bss_data->change_id);
-	g_object_unref (bss_data->proxy);
+	if (bss_data->props)
+		g_variant_unref (bss_data->props);
+	g_free (bss_data->path);
 	g_slice_free (BssData, bss_data);
 }
 
 static void
-bss_proxy_properties_changed_cb (GDBusProxy *proxy,
-                                 GVariant *changed_properties,
-                                 char **invalidated_properties,
-                                 gpointer user_data)
+bss_data_set_props (NMSupplicantInterface *self,
+                    BssData *bss_data,
+                    GVariant *props)
 {
-	NMSupplicantInterface *self = NM_SUPPLICANT_INTERFACE (user_data);
-	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
-
-	if (priv->scanning)
-		priv->last_scan = nm_utils_get_monotonic_timestamp_s ();
+	GVariantDict dict;
+	GVariantIter iter;
+	const char *name;
+	GVariant *value;
+
+	/* merge the changed properties into the cached ones. */
+	if (bss_data->props) {
+		g_variant_dict_init (&dict, bss_data->props);
+		g_variant_iter_init (&iter, props);
+		while (g_variant_iter_next (&iter, "{&sv}", &name, &value)) {
+			g_variant_dict_insert_value (&dict, name, value);
+			g_variant_unref (value);
+		}
+		g_variant_unref (bss_data->props);
+		bss_data->props = g_variant_ref_sink (g_variant_dict_end (&dict));
+	} else
+		bss_data->props = g_variant_ref (props);
 
 	g_signal_emit (self, signals[BSS_UPDATED], 0,
-	               g_dbus_proxy_get_object_path (proxy),
-	               changed_properties);
+	               bss_data->path,
+	               props);
 }
 
-static GVariant *
-bss_proxy_get_properties (NMSupplicantInterface *self, GDBusProxy *proxy)
+static void
+bss_properties_changed_cb (GDBusConnection *connection,
+                           const char *sender_name,
+                           const char *object_path,
+                           const char *interface_name,
+                           const char *signal_name,
+                           GVariant *parameters,
+                           gpointer user_data)
 {
-	gs_strfreev char **properties = NULL;
-	GVariantBuilder builder;
-	char **iter;
+	NMSupplicantInterface *self = NM_SUPPLICANT_INTERFACE (user_data);
+	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
+	gs_unref_variant GVariant *changed_properties = NULL;
+	BssData *bss_data;
 
-	iter = properties = g_dbus_proxy_get_cached_property_names (proxy);
+	if (!g_variant_is_of_type (parameters, G_VARIANT_TYPE ("(sa{sv}as)")))
+		return;
 
-	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
-	if (iter) {
-		while (*iter) {
-			GVariant *copy = g_dbus_proxy_get_cached_property (proxy, *iter);
+	/* we get the changes of the BSS of all interfaces. Also ignore
+	 * changes while the properties are fetched, the reply to GetAll
+	 * already contains them. */
+	bss_data = g_hash_table_lookup (priv->bss_hash, object_path);
+	if (!bss_data || !bss_data->props)
+		return;
 
-			g_variant_builder_add (&builder, "{sv}", *iter++, copy);
-			g_variant_unref (copy);
-		}
-	}
-	return g_variant_builder_end (&builder);
+	if (priv->scanning)
+		priv->last_scan = nm_utils_get_monotonic_timestamp_s ();
+
+	g_variant_get (parameters, "(&s@a{sv}^a&s)", NULL, &changed_properties, NULL);
+	bss_data_set_props (self, bss_data, changed_properties);
 }
 
 static void
-bss_proxy_acquired_cb (GDBusProxy *proxy, GAsyncResult *result, gpointer user_data)
+bss_get_all_cb (GObject *source, GAsyncResult *result, gpointer user_data)
 {
-	NMSupplicantInterface *self;
+	BssGetAllData *data = user_data;
+	NMSupplicantInterface *self = data->self;
 	NMSupplicantInterfacePrivate *priv;
 	gs_free_error GError *error = NULL;
-	GVariant *props = NULL;
-	const char *object_path;
+	gs_unref_variant GVariant *variant = NULL;
+	gs_unref_variant GVariant *props = NULL;
+	gs_free char *path = data->path;
 	BssData *bss_data;
 
-	g_async_initable_init_finish (G_ASYNC_INITABLE (proxy), result, &error);
+	g_slice_free (BssGetAllData, data);
+
+	variant = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source), result, &error);
 	if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
 		return;
 
-	self = NM_SUPPLICANT_INTERFACE (user_data);
 	priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
 
-	if (error) {
-		_LOGD ("failed to acquire BSS proxy: (%s)", error->message);
-		g_hash_table_remove (priv->bss_proxies,
-		                     g_dbus_proxy_get_object_path (proxy));
+	bss_data = g_hash_table_lookup (priv->bss_hash, path);
+	if (!bss_data || bss_data->props)
 		return;
-	}
 
-	object_path = g_dbus_proxy_get_object_path (proxy);
-	bss_data = g_hash_table_lookup (priv->bss_proxies, object_path);
-	if (!bss_data)
+	if (!variant) {
+		_LOGD ("failed to get BSS properties: (%s)", error->message);
+		g_hash_table_remove (priv->bss_hash, path);
 		return;
+	}
 
-	bss_data->change_id = g_signal_connect (proxy, "g-properties-changed", G_CALLBACK (bss_proxy_properties_changed_cb), self);
-
-	props = bss_proxy_get_properties (self, proxy);
-	g_signal_emit (self, signals[BSS_UPDATED], 0,
-	               g_dbus_proxy_get_object_path (proxy),
-	               g_variant_ref_sink (props));
-	g_variant_unref (props);
+	g_variant_get (variant, "(@a{sv})", &props);
+	bss_data_set_props (self, bss_data, props);
 
 	if (priv->scan_done_pending)
 		scan_done_emit_signal (self);
 }
 
 static void
-bss_add_new (NMSupplicantInterface *self, const char *object_path)
+bss_add_new (NMSupplicantInterface *self, const char *object_path, GVariant *props)
 {
 	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
-	GDBusProxy *bss_proxy;
+	BssGetAllData *data;
 	BssData *bss_data;
 
 	g_return_if_fail (object_path != NULL);
 
-	if (g_hash_table_lookup (priv->bss_proxies, object_path))
+	if (g_hash_table_lookup (priv->bss_hash, object_path))
 		return;
 
-	bss_proxy = g_object_new (G_TYPE_DBUS_PROXY,
-	                          "g-bus-type", G_BUS_TYPE_SYSTEM,
-	                          "g-flags", G_DBUS_PROXY_FLAGS_NONE,
-	                          "g-name", WPAS_DBUS_SERVICE,
-	                          "g-object-path", object_path,
-	                          "g-interface-name", WPAS_DBUS_IFACE_BSS,
-	                          NULL);
 	bss_data = g_slice_new0 (BssData);
-	bss_data->proxy = bss_proxy;
-	g_hash_table_insert (priv->bss_proxies,
-	                     (char *) g_dbus_proxy_get_object_path (bss_proxy),
-	                     bss_data);
-	g_async_initable_init_async (G_ASYNC_INITABLE (bss_proxy),
-	                             G_PRIORITY_DEFAULT,
-	                             priv->other_cancellable,
-	                             (GAsyncReadyCallback) bss_proxy_acquired_cb,
-	                             self);
+	bss_data->path = g_strdup (object_path);
+	g_hash_table_insert (priv->bss_hash, bss_data->path, bss_data);
+
+	/* The BSSAdded signal already has the properties. Only the BSS
+	 * from the BSSs property of the interface need a GetAll call. */
+	if (props) {
+		bss_data_set_props (self, bss_data, props);
+		return;
+	}
+
+	data = g_slice_new (BssGetAllData);
+	data->self = self;
+	data->path = g_strdup (object_path);
+	g_dbus_connection_call (g_dbus_proxy_get_connection (priv->iface_proxy),
+	                        WPAS_DBUS_SERVICE,
+	                        object_path,
+	                        DBUS_INTERFACE_PROPERTIES,
+	                        "GetAll",
+	                        g_variant_new ("(s)", WPAS_DBUS_IFACE_BSS),
+	                        G_VARIANT_TYPE ("(a{sv})"),
+	                        G_DBUS_CALL_FLAGS_NONE,
+	                        -1,
+	                        priv->other_cancellable,
+	                        bss_get_all_cb,
+	                        data);
 }
 
 /*****************************************************************************/
@@ -563,6 +614,97 @@ nm_supplicant_interface_set_fast_support (NMSupplicantInterface *self,
 	priv->fast_support = fast_support;
 }
 
+static GVariant *
+scan_rand_mac_mask_new (gboolean enable)
+{
+	static const guint8 mask[ETH_ALEN] = { 0 };
+	GVariantBuilder builder;
+
+	/* a mask without any bit set lets the supplicant randomize the whole
+	 * address; it takes care of the unicast and locally administered bits
+	 * on its own. An empty dictionary disables the randomization. */
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{say}"));
+	if (enable) {
+		g_variant_builder_add (&builder, "{s@ay}", "scan",
+		                       g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE,
+		                                                  mask, ETH_ALEN, 1));
+	}
+	return g_variant_new ("(ssv)",
+	                      WPAS_DBUS_IFACE_INTERFACE,
+	                      "MACAddressRandomizationMask",
+	                      g_variant_builder_end (&builder));
+}
+
+static void
+iface_check_scan_rand_mac_cb (GDBusProxy *proxy, GAsyncResult *result, gpointer user_data)
+{
+	NMSupplicantInterface *self;
+	NMSupplicantInterfacePrivate *priv;
+	gs_unref_variant GVariant *variant = NULL;
+	gs_free_error GError *error = NULL;
+
+	/* Setting the mask fails both when the supplicant doesn't know the
+	 * property and when the driver can't randomize the address for scans. */
+	variant = g_dbus_proxy_call_finish (proxy, result, &error);
+	if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+		return;
+
+	self = NM_SUPPLICANT_INTERFACE (user_data);
+	priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
+
+	if (variant) {
+		priv->scan_rand_mac_support = NM_SUPPLICANT_FEATURE_YES;
+		priv->scan_rand_mac = TRUE;
+	} else
+		priv->scan_rand_mac_support = NM_SUPPLICANT_FEATURE_NO;
+
+	_LOGD ("supplicant %s MAC address randomization for scans",
+	       variant ? "supports" : "does not support");
+
+	iface_check_ready (self);
+}
+
+NMSupplicantFeature
+nm_supplicant_interface_get_scan_rand_mac_support (NMSupplicantInterface *self)
+{
+	return NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self)->scan_rand_mac_support;
+}
+
+/**
+ * nm_supplicant_interface_set_scan_rand_mac:
+ * @self: the #NMSupplicantInterface
+ * @enable: whether scans should use a random MAC address
+ *
+ * Let the supplicant pick a random MAC address for each scan while not
+ * associated. Unlike changing the address of the link, this doesn't
+ * require taking the interface down. Does nothing if the feature is not
+ * supported, see nm_supplicant_interface_get_scan_rand_mac_support().
+ */
+void
+nm_supplicant_interface_set_scan_rand_mac (NMSupplicantInterface *self,
+                                           gboolean enable)
+{
+	NMSupplicantInterfacePrivate *priv;
+
+	g_return_if_fail (NM_IS_SUPPLICANT_INTERFACE (self));
+
+	priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
+
+	if (   priv->scan_rand_mac_support != NM_SUPPLICANT_FEATURE_YES
+	    || priv->scan_rand_mac == !!enable)
+		return;
+
+	priv->scan_rand_mac = !!enable;
+	g_dbus_proxy_call (priv->iface_proxy,
+	                   DBUS_INTERFACE_PROPERTIES ".Set",
+	                   scan_rand_mac_mask_new (enable),
+	                   G_DBUS_CALL_FLAGS_NONE,
+	                   -1,
+	                   priv->other_cancellable,
+	                   (GAsyncReadyCallback) log_result_cb,
+	                   "set MAC address randomization");
+}
+
 static void
 iface_introspect_cb (GDBusProxy *proxy, GAsyncResult *result, gpointer user_data)
 {
@@ -601,25 +743,22 @@ scan_done_emit_signal (NMSupplicantInterface *self)
 	gboolean success;
 	GHashTableIter iter;
 
-	g_hash_table_iter_init (&iter, priv->bss_proxies);
+	g_hash_table_iter_init (&iter, priv->bss_hash);
 	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &bss_data)) {
 		/* we have some BSS' that need to be initialized first. Delay
 		 * emitting signal. */
-		if (!bss_data->change_id) {
+		if (!bss_data->props) {
 			priv->scan_done_pending = TRUE;
 			return;
 		}
 	}
 
 	/* Emit BSS_UPDATED so that wifi device has the APs (in case it removed them) */
-	g_hash_table_iter_init (&iter, priv->bss_proxies);
+	g_hash_table_iter_init (&iter, priv->bss_hash);
 	while (g_hash_table_iter_next (&iter, (gpointer *) &object_path, (gpointer *) &bss_data)) {
-		gs_unref_variant GVariant *props = NULL;
-
-		props = bss_proxy_get_properties (self, bss_data->proxy);
 		g_signal_emit (self, signals[BSS_UPDATED], 0,
 		               object_path,
-		               g_variant_ref_sink (props));
+		               bss_data->props);
 	}
 
 	success = priv->scan_done_success;
@@ -654,7 +793,7 @@ wpas_iface_bss_added (GDBusProxy *proxy,
 	if (priv->scanning)
 		priv->last_scan = nm_utils_get_monotonic_timestamp_s ();
 
-	bss_add_new (self, path);
+	bss_add_new (self, path, props);
 }
 
 static void
@@ -666,10 +805,10 @@ wpas_iface_bss_removed (GDBusProxy *proxy,
 	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
 	BssData *bss_data;
 
-	bss_data = g_hash_table_lookup (priv->bss_proxies, path);
+	bss_data = g_hash_table_lookup (priv->bss_hash, path);
 	if (!bss_data)
 		return;
-	g_hash_table_steal (priv->bss_proxies, path);
+	g_hash_table_steal (priv->bss_hash, path);
 	g_signal_emit (self, signals[BSS_REMOVED], 0, path);
 	bss_data_destroy (bss_data);
 }
@@ -719,7 +858,7 @@ props_changed_cb (GDBusProxy *proxy,
 	if (g_variant_lookup (changed_properties, "BSSs", "^a&o", &array)) {
 		iter = array;
 		while (*iter)
-			bss_add_new (self, *iter++);
+			bss_add_new (self, *iter++, NULL);
 		g_free (array);
 	}
 
@@ -782,6 +921,20 @@ on_iface_proxy_acquired (GDBusProxy *proxy, GAsyncResult *result, gpointer user_
 	_nm_dbus_signal_connect (priv->iface_proxy, "NetworkRequest", G_VARIANT_TYPE ("(oss)"),
 	                         G_CALLBACK (wpas_iface_network_request), self);
 
+	/* a single subscription for the property changes of all BSS, instead of
+	 * a GDBusProxy per BSS. */
+	priv->bss_props_changed_id =
+	    g_dbus_connection_signal_subscribe (g_dbus_proxy_get_connection (priv->iface_proxy),
+	                                        WPAS_DBUS_SERVICE,
+	                                        DBUS_INTERFACE_PROPERTIES,
+	                                        "PropertiesChanged",
+	                                        NULL,
+	                                        WPAS_DBUS_IFACE_BSS,
+	                                        G_DBUS_SIGNAL_FLAGS_NONE,
+	                                        bss_properties_changed_cb,
+	                                        self,
+	                                        NULL);
+
 	/* Scan result aging parameters */
 	g_dbus_proxy_call (priv->iface_proxy,
 	                   "org.freedesktop.DBus.Properties.Set",
@@ -820,6 +973,18 @@ on_iface_proxy_acquired (GDBusProxy *proxy, GAsyncResult *result, gpointer user_
 	                   (GAsyncReadyCallback) iface_check_netreply_cb,
 	                   self);
 
+	/* Enable MAC address randomization for scans if possible. The device
+	 * disables it again when the configuration asks so. */
+	priv->ready_count++;
+	g_dbus_proxy_call (priv->iface_proxy,
+	                   DBUS_INTERFACE_PROPERTIES ".Set",
+	                   scan_rand_mac_mask_new (TRUE),
+	                   G_DBUS_CALL_FLAGS_NONE,
+	                   -1,
+	                   priv->init_cancellable,
+	                   (GAsyncReadyCallback) iface_check_scan_rand_mac_cb,
+	                   self);
+
 	if (priv->ap_support == NM_SUPPLICANT_FEATURE_UNKNOWN) {
 		/* If the global supplicant capabilities property is not present, we can
 		 * fall back to checking whether the ProbeRequest method is supported.  If
@@ -1106,9 +1271,30 @@ assoc_return (NMSupplicantInterface *self, GError *error, const char *message)
 		assoc_data->callback (self, error, assoc_data->user_data);
 
 	g_object_unref (assoc_data->cfg);
+	g_free (assoc_data->net_checksum);
 	g_slice_free (AssocData, assoc_data);
 }
 
+static void
+network_remove (NMSupplicantInterface *self)
+{
+	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
+
+	if (!priv->net_path)
+		return;
+
+	g_dbus_proxy_call (priv->iface_proxy,
+	                   "RemoveNetwork",
+	                   g_variant_new ("(o)", priv->net_path),
+	                   G_DBUS_CALL_FLAGS_NONE,
+	                   -1,
+	                   priv->other_cancellable,
+	                   (GAsyncReadyCallback) log_result_cb,
+	                   "remove network");
+	g_clear_pointer (&priv->net_path, g_free);
+	g_clear_pointer (&priv->net_checksum, g_free);
+}
+
 void
 nm_supplicant_interface_disconnect (NMSupplicantInterface * self)
 {
@@ -1143,19 +1329,31 @@ nm_supplicant_interface_disconnect (NMSupplicantInterface * self)
 		                   "disconnect");
 	}
 
-	/* Remove any network that was added by NetworkManager */
-	if (priv->net_path) {
-		g_dbus_proxy_call (priv->iface_proxy,
-		                   "RemoveNetwork",
-		                   g_variant_new ("(o)", priv->net_path),
-		                   G_DBUS_CALL_FLAGS_NONE,
-		                   -1,
-		                   priv->other_cancellable,
-		                   (GAsyncReadyCallback) log_result_cb,
-		                   "remove network");
-		g_free (priv->net_path);
-		priv->net_path = NULL;
+	if (!priv->net_path)
+		return;
+
+	if (!priv->net_checksum) {
+		network_remove (self);
+		return;
 	}
+
+	/* Keep the network for reconnecting, but disable it, so that the
+	 * supplicant doesn't connect to it on its own. */
+	g_dbus_connection_call (g_dbus_proxy_get_connection (priv->iface_proxy),
+	                        g_dbus_proxy_get_name (priv->iface_proxy),
+	                        priv->net_path,
+	                        DBUS_INTERFACE_PROPERTIES,
+	                        "Set",
+	                        g_variant_new ("(ssv)",
+	                                       WPAS_DBUS_IFACE_NETWORK,
+	                                       "Enabled",
+	                                       g_variant_new_boolean (FALSE)),
+	                        NULL,
+	                        G_DBUS_CALL_FLAGS_NONE,
+	                        -1,
+	                        priv->other_cancellable,
+	                        NULL,
+	                        NULL);
 }
 
 static void
@@ -1207,6 +1405,8 @@ assoc_add_blob_cb (GDBusProxy *proxy, GAsyncResult *result, gpointer user_data)
 	priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
 
 	if (error) {
+		/* we don't know which blobs made it. Send all of them next time. */
+		g_hash_table_remove_all (priv->blobs);
 		assoc_return (self, error, "failure to set network certificates");
 		return;
 	}
@@ -1217,6 +1417,62 @@ assoc_add_blob_cb (GDBusProxy *proxy, GAsyncResult *result, gpointer user_data)
 		assoc_call_select_network (self);
 }
 
+static void
+assoc_add_blobs (NMSupplicantInterface *self)
+{
+	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
+	GHashTable *blobs;
+	GHashTableIter iter;
+	const char *blob_name;
+	GByteArray *blob_data;
+
+	/* Send blobs first; otherwise jump to selecting the network. Blobs
+	 * that the supplicant already has with the same data are skipped. */
+	blobs = nm_supplicant_config_get_blobs (priv->assoc_data->cfg);
+	priv->assoc_data->blobs_left = 0;
+
+	g_hash_table_iter_init (&iter, blobs);
+	while (g_hash_table_iter_next (&iter, (gpointer) &blob_name, (gpointer) &blob_data)) {
+		char *checksum;
+
+		checksum = g_compute_checksum_for_data (G_CHECKSUM_SHA256, blob_data->data, blob_data->len);
+		if (nm_streq0 (g_hash_table_lookup (priv->blobs, blob_name), checksum)) {
+			g_free (checksum);
+			continue;
+		}
+
+		/* the supplicant refuses to overwrite an existing blob. */
+		if (g_hash_table_contains (priv->blobs, blob_name)) {
+			g_dbus_proxy_call (priv->iface_proxy,
+			                   "RemoveBlob",
+			                   g_variant_new ("(s)", blob_name),
+			                   G_DBUS_CALL_FLAGS_NONE,
+			                   -1,
+			                   NULL,
+			                   NULL,
+			                   NULL);
+		}
+		g_dbus_proxy_call (priv->iface_proxy,
+		                   "AddBlob",
+		                   g_variant_new ("(s@ay)",
+		                                  blob_name,
+		                                  g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE,
+		                                                             blob_data->data, blob_data->len, 1)),
+		                   G_DBUS_CALL_FLAGS_NONE,
+		                   -1,
+		                   priv->assoc_data->cancellable,
+		                   (GAsyncReadyCallback) assoc_add_blob_cb,
+		                   self);
+		g_hash_table_insert (priv->blobs, g_strdup (blob_name), checksum);
+		priv->assoc_data->blobs_left++;
+	}
+
+	_LOGT ("assoc[%p]: %u blobs left", priv->assoc_data, priv->assoc_data->blobs_left);
+
+	if (priv->assoc_data->blobs_left == 0)
+		assoc_call_select_network (self);
+}
+
 static void
 assoc_add_network_cb (GDBusProxy *proxy, GAsyncResult *result, gpointer user_data)
 {
@@ -1226,10 +1482,6 @@ assoc_add_network_cb (GDBusProxy *proxy, GAsyncResult *result, gpointer user_dat
 	NMSupplicantInterfacePrivate *priv;
 	gs_unref_variant GVariant *reply = NULL;
 	gs_free_error GError *error = NULL;
-	GHashTable *blobs;
-	GHashTableIter iter;
-	const char *blob_name;
-	GByteArray *blob_data;
 
 	assoc_data = add_network_data->assoc_data;
 	if (assoc_data)
@@ -1271,31 +1523,11 @@ assoc_add_network_cb (GDBusProxy *proxy, GAsyncResult *result, gpointer user_dat
 	}
 
 	g_variant_get (reply, "(o)", &priv->net_path);
+	priv->net_checksum = g_strdup (assoc_data->net_checksum);
 
-	/* Send blobs first; otherwise jump to selecting the network */
-	blobs = nm_supplicant_config_get_blobs (priv->assoc_data->cfg);
-	priv->assoc_data->blobs_left = g_hash_table_size (blobs);
-
-	_LOGT ("assoc[%p]: network added (%s) (%u blobs left)", priv->assoc_data, priv->net_path, priv->assoc_data->blobs_left);
+	_LOGT ("assoc[%p]: network added (%s)", priv->assoc_data, priv->net_path);
 
-	if (priv->assoc_data->blobs_left == 0)
-		assoc_call_select_network (self);
-	else {
-		g_hash_table_iter_init (&iter, blobs);
-		while (g_hash_table_iter_next (&iter, (gpointer) &blob_name, (gpointer) &blob_data)) {
-			g_dbus_proxy_call (priv->iface_proxy,
-			                   "AddBlob",
-			                   g_variant_new ("(s@ay)",
-			                                  blob_name,
-			                                  g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE,
-			                                                             blob_data->data, blob_data->len, 1)),
-			                   G_DBUS_CALL_FLAGS_NONE,
-			                   -1,
-			                   priv->assoc_data->cancellable,
-			                   (GAsyncReadyCallback) assoc_add_blob_cb,
-			                   self);
-		}
-	}
+	assoc_add_blobs (self);
 }
 
 static void
@@ -1352,6 +1584,25 @@ assoc_fail_on_idle_cb (gpointer user_data)
 	return G_SOURCE_REMOVE;
 }
 
+static char *
+assoc_config_checksum (NMSupplicantConfig *cfg)
+{
+	gs_unref_variant GVariant *variant = NULL;
+	GChecksum *sum;
+	guint32 ap_scan;
+	char *result;
+
+	variant = g_variant_ref_sink (nm_supplicant_config_to_variant (cfg));
+	ap_scan = nm_supplicant_config_get_ap_scan (cfg);
+
+	sum = g_checksum_new (G_CHECKSUM_SHA256);
+	g_checksum_update (sum, (const guchar *) &ap_scan, sizeof (ap_scan));
+	g_checksum_update (sum, g_variant_get_data (variant), g_variant_get_size (variant));
+	result = g_strdup (g_checksum_get_string (sum));
+	g_checksum_free (sum);
+	return result;
+}
+
 /**
  * nm_supplicant_interface_assoc:
  * @self: the supplicant interface instance
@@ -1402,6 +1653,17 @@ nm_supplicant_interface_assoc (NMSupplicantInterface *self,
 	}
 
 	assoc_data->cancellable = g_cancellable_new();
+	assoc_data->net_checksum = assoc_config_checksum (cfg);
+
+	if (   priv->net_path
+	    && nm_streq0 (priv->net_checksum, assoc_data->net_checksum)) {
+		_LOGD ("assoc[%p]: reuse network %s", assoc_data, priv->net_path);
+		assoc_add_blobs (self);
+		return;
+	}
+
+	network_remove (self);
+
 	g_dbus_proxy_call (priv->iface_proxy,
 	                   DBUS_INTERFACE_PROPERTIES ".Set",
 	                   g_variant_new ("(ssv)",
@@ -1439,8 +1701,17 @@ scan_request_cb (GDBusProxy *proxy, GAsyncResult *result, gpointer user_data)
 	}
 }
 
+/**
+ * nm_supplicant_interface_request_scan:
+ * @self: the #NMSupplicantInterface
+ * @ssids: (allow-none): the SSIDs to probe for
+ * @freqs: (allow-none): a zero-terminated list of frequencies in MHz.
+ *   If given, only these channels are scanned.
+ */
 void
-nm_supplicant_interface_request_scan (NMSupplicantInterface *self, const GPtrArray *ssids)
+nm_supplicant_interface_request_scan (NMSupplicantInterface *self,
+                                      const GPtrArray *ssids,
+                                      const guint32 *freqs)
 {
 	NMSupplicantInterfacePrivate *priv;
 	GVariantBuilder builder;
@@ -1465,6 +1736,14 @@ nm_supplicant_interface_request_scan (NMSupplicantInterface *self, const GPtrArr
 		}
 		g_variant_builder_add (&builder, "{sv}", "SSIDs", g_variant_builder_end (&ssids_builder));
 	}
+	if (freqs && freqs[0]) {
+		GVariantBuilder channels_builder;
+
+		g_variant_builder_init (&channels_builder, G_VARIANT_TYPE ("a(uu)"));
+		for (i = 0; freqs[i]; i++)
+			g_variant_builder_add (&channels_builder, "(uu)", freqs[i], (guint32) 20);
+		g_variant_builder_add (&builder, "{sv}", "Channels", g_variant_builder_end (&channels_builder));
+	}
 
 	g_dbus_proxy_call (priv->iface_proxy,
 	                   "Scan",
@@ -1571,7 +1850,8 @@ nm_supplicant_interface_init (NMSupplicantInterface * self)
 	NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE (self);
 
 	priv->state = NM_SUPPLICANT_INTERFACE_STATE_INIT;
-	priv->bss_proxies = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, bss_data_destroy);
+	priv->bss_hash = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, bss_data_destroy);
+	priv->blobs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 }
 
 NMSupplicantInterface *
@@ -1603,17 +1883,25 @@ dispose (GObject *object)
 		assoc_return (self, error, "cancelled due to dispose of supplicant interface");
 	}
 
-	if (priv->iface_proxy)
+	if (priv->iface_proxy) {
 		g_signal_handlers_disconnect_by_data (priv->iface_proxy, object);
+		if (priv->bss_props_changed_id) {
+			g_dbus_connection_signal_unsubscribe (g_dbus_proxy_get_connection (priv->iface_proxy),
+			                                      priv->bss_props_changed_id);
+			priv->bss_props_changed_id = 0;
+		}
+	}
 	g_clear_object (&priv->iface_proxy);
 
 	nm_clear_g_cancellable (&priv->init_cancellable);
 	nm_clear_g_cancellable (&priv->other_cancellable);
 
 	g_clear_object (&priv->wpas_proxy);
-	g_clear_pointer (&priv->bss_proxies, (GDestroyNotify) g_hash_table_destroy);
+	g_clear_pointer (&priv->bss_hash, (GDestroyNotify) g_hash_table_destroy);
 
 	g_clear_pointer (&priv->net_path, g_free);
+	g_clear_pointer (&priv->net_checksum, g_free);
+	g_clear_pointer (&priv->blobs, g_hash_table_unref);
 	g_clear_pointer (&priv->dev, g_free);
 	g_clear_pointer (&priv->object_path, g_free);
 	g_clear_pointer (&priv->current_bss, g_free);
@@ -95,7 +95,9 @@ void nm_supplicant_interface_disconnect (NMSupplicantInterface * iface);
 
 const char *nm_supplicant_interface_get_object_path (NMSupplicantInterface * iface);
 
-void nm_supplicant_interface_request_scan (NMSupplicantInterface * self, const GPtrArray *ssids);
+void nm_supplicant_interface_request_scan (NMSupplicantInterface * self,
+                                           const GPtrArray *ssids,
+                                           const guint32 *freqs);
 
 NMSupplicantInterfaceState nm_supplicant_interface_get_state (NMSupplicantInterface * self);
 
@@ -126,4 +128,9 @@ void nm_supplicant_interface_set_ap_support (NMSupplicantInterface *self,
 void nm_supplicant_interface_set_fast_support (NMSupplicantInterface *self,
                                                NMSupplicantFeature fast_support);
 
+NMSupplicantFeature nm_supplicant_interface_get_scan_rand_mac_support (NMSupplicantInterface *self);
+
+void nm_supplicant_interface_set_scan_rand_mac (NMSupplicantInterface *self,
+                                                gboolean enable);
+
 #endif /* __NM_SUPPLICANT_INTERFACE_H__ */
@@ -321,7 +321,8 @@ test_wifi_wpa_psk (const char *detail,
                    OptType key_type,
                    const char *key_data,
                    const unsigned char *expected,
-                   size_t expected_size)
+                   size_t expected_size,
+                   int ft)
 {
 	gs_unref_object NMConnection *connection = NULL;
 	gs_unref_object NMSupplicantConfig *config = NULL;
@@ -374,6 +375,7 @@ test_wifi_wpa_psk (const char *detail,
 	g_object_set (s_wsec,
 	              NM_SETTING_WIRELESS_SECURITY_KEY_MGMT, "wpa-psk",
 	              NM_SETTING_WIRELESS_SECURITY_PSK, key_data,
+	              NM_SETTING_WIRELESS_SECURITY_FT, ft,
 	              NULL);
 
 	nm_setting_wireless_security_add_proto (s_wsec, "wpa");
@@ -411,7 +413,9 @@ test_wifi_wpa_psk (const char *detail,
 	g_test_assert_expected_messages ();
 
 	g_test_expect_message ("NetworkManager", G_LOG_LEVEL_INFO,
-	                       "*added 'key_mgmt' value 'WPA-PSK'");
+	                       ft == 1
+	                         ? "*added 'key_mgmt' value 'WPA-PSK FT-PSK'"
+	                         : "*added 'key_mgmt' value 'WPA-PSK'");
 	g_test_expect_message ("NetworkManager", G_LOG_LEVEL_INFO,
 	                       "*added 'psk' value *");
 	g_test_expect_message ("NetworkManager", G_LOG_LEVEL_INFO,
@@ -435,7 +439,8 @@ test_wifi_wpa_psk (const char *detail,
 	validate_opt (detail, config_dict, "scan_ssid", TYPE_INT, GINT_TO_POINTER (1), -1);
 	validate_opt (detail, config_dict, "ssid", TYPE_BYTES, ssid_data, sizeof (ssid_data));
 	validate_opt (detail, config_dict, "bssid", TYPE_KEYWORD, bssid_str, -1);
-	validate_opt (detail, config_dict, "key_mgmt", TYPE_KEYWORD, "WPA-PSK", -1);
+	validate_opt (detail, config_dict, "key_mgmt", TYPE_KEYWORD,
+	              ft == 1 ? "WPA-PSK FT-PSK" : "WPA-PSK", -1);
 	validate_opt (detail, config_dict, "proto", TYPE_KEYWORD, "WPA RSN", -1);
 	validate_opt (detail, config_dict, "pairwise", TYPE_KEYWORD, "TKIP CCMP", -1);
 	validate_opt (detail, config_dict, "group", TYPE_KEYWORD, "TKIP CCMP", -1);
@@ -452,8 +457,9 @@ test_wifi_wpa_psk_types (void)
 	                                        0x6c, 0x2f, 0x11, 0x60, 0x5a, 0x16, 0x08, 0x93 };
 	const char *key2 = "r34lly l33t wp4 p4ssphr4s3 for t3st1ng";
 
-	test_wifi_wpa_psk ("wifi-wpa-psk-hex", TYPE_BYTES, key1, key1_expected, sizeof (key1_expected));
-	test_wifi_wpa_psk ("wifi-wep-psk-passphrase", TYPE_STRING, key2, (gconstpointer) key2, strlen (key2));
+	test_wifi_wpa_psk ("wifi-wpa-psk-hex", TYPE_BYTES, key1, key1_expected, sizeof (key1_expected), -1);
+	test_wifi_wpa_psk ("wifi-wep-psk-passphrase", TYPE_STRING, key2, (gconstpointer) key2, strlen (key2), -1);
+	test_wifi_wpa_psk ("wifi-wpa-psk-ft", TYPE_STRING, key2, (gconstpointer) key2, strlen (key2), 1);
 }
 
 static void
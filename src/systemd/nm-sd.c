@@ -25,6 +25,17 @@
 /*****************************************************************************
  * Integrating sd_event into glib. Taken and adjusted from
  * https://www.freedesktop.org/software/systemd/man/sd_event_get_fd.html
+ *
+ * All internal clients (DHCP, IPv4LL, LLDP) share the default event, so
+ * there is a single source no matter how many clients run. Its fd is the
+ * epoll fd of sd_event, which contains the fds and one timerfd per clock
+ * of all sd_event sources, so glib's poll() already waits on them.
+ *
+ * The cost per main loop iteration is one sd_event_prepare() and one
+ * sd_event_wait() with zero timeout. Neither can be skipped when the fd
+ * is not ready: sd_event only re-arms its timerfds in sd_event_prepare(),
+ * which is how timers added by the clients from glib callbacks take
+ * effect, and it only leaves the armed state via sd_event_wait().
  *****************************************************************************/
 
 typedef struct SDEventSource {
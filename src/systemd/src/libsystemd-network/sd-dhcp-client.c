@@ -1187,11 +1187,22 @@ static int client_timeout_t2(sd_event_source *s, uint64_t usec, void *userdata)
 static int client_timeout_t1(sd_event_source *s, uint64_t usec, void *userdata) {
         sd_dhcp_client *client = userdata;
         DHCP_CLIENT_DONT_DESTROY(client);
+        int r;
+
+        /* The UDP socket is only needed while renewing. Not keeping it
+         * open while bound saves a socket per bound lease. If the socket
+         * can't be bound, stay bound and rebind at T2. */
+        r = dhcp_network_bind_udp_socket(client->ifindex, client->lease->address, client->port);
+        if (r < 0) {
+                log_dhcp_client(client, "could not bind UDP socket");
+                return 0;
+        }
+        client->fd = r;
 
         client->state = DHCP_STATE_RENEWING;
         client->attempt = 1;
 
-        return client_initialize_time_events(client);
+        return client_initialize_events(client, client_receive_message_udp);
 }
 
 static int client_handle_offer(sd_dhcp_client *client, DHCPMessage *offer, size_t len) {
@@ -1245,18 +1256,6 @@ static int client_handle_offer(sd_dhcp_client *client, DHCPMessage *offer, size_
         return 0;
 }
 
-static int client_handle_forcerenew(sd_dhcp_client *client, DHCPMessage *force, size_t len) {
-        int r;
-
-        r = dhcp_option_parse(force, len, NULL, NULL, NULL);
-        if (r != DHCP_FORCERENEW)
-                return -ENOMSG;
-
-        log_dhcp_client(client, "FORCERENEW");
-
-        return 0;
-}
-
 static int client_handle_ack(sd_dhcp_client *client, DHCPMessage *ack, size_t len) {
         _cleanup_(sd_dhcp_lease_unrefp) sd_dhcp_lease *lease = NULL;
         _cleanup_free_ char *error_message = NULL;
@@ -1559,16 +1558,6 @@ static int client_handle_message(sd_dhcp_client *client, DHCPMessage *message, i
                                 goto error;
                         }
 
-                        r = dhcp_network_bind_udp_socket(client->ifindex, client->lease->address, client->port);
-                        if (r < 0) {
-                                log_dhcp_client(client, "could not bind UDP socket");
-                                goto error;
-                        }
-
-                        client->fd = r;
-
-                        client_initialize_io_events(client, client_receive_message_udp);
-
                         if (notify_event) {
                                 client_notify(client, notify_event);
                                 if (client->state == DHCP_STATE_STOPPED)
@@ -1602,17 +1591,8 @@ static int client_handle_message(sd_dhcp_client *client, DHCPMessage *message, i
                 break;
 
         case DHCP_STATE_BOUND:
-                r = client_handle_forcerenew(client, message, len);
-                if (r >= 0) {
-                        r = client_timeout_t1(NULL, 0, client);
-                        if (r < 0)
-                                goto error;
-                } else if (r == -ENOMSG)
-                        /* invalid message, let's ignore it */
-                        return 0;
-
-                break;
-
+                /* no socket is open while bound. FORCERENEW is not
+                 * supported, it is unauthenticated (CVE-2020-13529). */
         case DHCP_STATE_INIT:
         case DHCP_STATE_INIT_REBOOT:
 
@@ -1700,10 +1680,7 @@ static int client_receive_message_udp(
                 return 0;
         }
 
-        if (client->state != DHCP_STATE_BOUND &&
-            be32toh(message->xid) != client->xid) {
-                /* in BOUND state, we may receive FORCERENEW with xid set by server,
-                   so ignore the xid in this case */
+        if (be32toh(message->xid) != client->xid) {
                 log_dhcp_client(client, "Received xid (%u) does not match expected (%u): ignoring",
                                 be32toh(message->xid), client->xid);
                 return 0;
@@ -727,8 +727,12 @@ _set_values_user_atomic_section_2_set (NMConfig *config, gboolean set_user, GKey
 static void
 _set_values_user_atomic_section_2_check (NMConfig *config, NMConfigData *config_data, gboolean is_change_event, NMConfigChangeFlags changes, NMConfigData *old_data)
 {
-	if (is_change_event)
+	if (is_change_event) {
 		g_assert (changes == (NM_CONFIG_CHANGE_VALUES | NM_CONFIG_CHANGE_VALUES_USER | NM_CONFIG_CHANGE_VALUES_INTERN));
+		g_assert ( nm_config_data_is_value_changed (old_data, config_data, "atomic-prefix-1.section-a", "key1"));
+		g_assert ( nm_config_data_is_value_changed (old_data, config_data, "atomic-prefix-1.section-a", "key2"));
+		g_assert (!nm_config_data_is_value_changed (old_data, config_data, "non-atomic-prefix-1.section-a", "nap1-key3"));
+	}
 	assert_config_value (config_data, "atomic-prefix-1.section-a", "key1", "user-value1-x");
 	assert_config_value (config_data, "atomic-prefix-1.section-a", "key2", "user-value2");
 	assert_config_value (config_data, "non-atomic-prefix-1.section-a", "nap1-key1", "user-value1-x");
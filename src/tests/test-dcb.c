@@ -57,8 +57,7 @@ static void
 test_dcb_fcoe (void)
 {
 	static DcbExpected expected = { 0,
-		{ "dcbtool sc eth0 app:fcoe e:1 a:1 w:1",
-		  "dcbtool sc eth0 app:fcoe appcfg:40",
+		{ "dcbtool sc eth0 app:fcoe e:1 a:1 w:1 appcfg:40",
 		  "dcbtool sc eth0 app:iscsi e:0 a:0 w:0",
 		  "dcbtool sc eth0 app:fip e:0 a:0 w:0",
 		  "dcbtool sc eth0 pfc e:0 a:0 w:0",
@@ -88,8 +87,7 @@ test_dcb_iscsi (void)
 {
 	static DcbExpected expected = { 0,
 		{ "dcbtool sc eth0 app:fcoe e:0 a:0 w:0",
-		  "dcbtool sc eth0 app:iscsi e:1 a:0 w:1",
-		  "dcbtool sc eth0 app:iscsi appcfg:08",
+		  "dcbtool sc eth0 app:iscsi e:1 a:0 w:1 appcfg:08",
 		  "dcbtool sc eth0 app:fip e:0 a:0 w:0",
 		  "dcbtool sc eth0 pfc e:0 a:0 w:0",
 		  "dcbtool sc eth0 pg e:0",
@@ -119,8 +117,7 @@ test_dcb_fip (void)
 	static DcbExpected expected = { 0,
 		{ "dcbtool sc eth0 app:fcoe e:0 a:0 w:0",
 		  "dcbtool sc eth0 app:iscsi e:0 a:0 w:0",
-		  "dcbtool sc eth0 app:fip e:1 a:1 w:0",
-		  "dcbtool sc eth0 app:fip appcfg:01",
+		  "dcbtool sc eth0 app:fip e:1 a:1 w:0 appcfg:01",
 		  "dcbtool sc eth0 pfc e:0 a:0 w:0",
 		  "dcbtool sc eth0 pg e:0",
 		  NULL },
@@ -179,8 +176,7 @@ test_dcb_pfc (void)
 		{ "dcbtool sc eth0 app:fcoe e:0 a:0 w:0",
 		  "dcbtool sc eth0 app:iscsi e:0 a:0 w:0",
 		  "dcbtool sc eth0 app:fip e:0 a:0 w:0",
-		  "dcbtool sc eth0 pfc e:1 a:1 w:1",
-		  "dcbtool sc eth0 pfc pfcup:01101100",
+		  "dcbtool sc eth0 pfc e:1 a:1 w:1 pfcup:01101100",
 		  "dcbtool sc eth0 pg e:0",
 		  NULL },
 	};
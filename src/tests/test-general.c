@@ -991,11 +991,16 @@ test_connection_sort_autoconnect_priority (void)
 #define MATCH_S390 "S390:"
 #define MATCH_DRIVER "DRIVER:"
 
+#define _MATCH_SPEC_DEVICE(specs, compiled, ...) \
+	((compiled) \
+	    ? nm_match_spec_compiled_match_device ((compiled), __VA_ARGS__) \
+	    : nm_match_spec_device ((specs), __VA_ARGS__))
+
 static NMMatchSpecMatchType
-_test_match_spec_device (const GSList *specs, const char *match_str)
+_test_match_spec_device_one (const GSList *specs, const NMMatchSpecCompiled *compiled, const char *match_str)
 {
 	if (match_str && g_str_has_prefix (match_str, MATCH_S390))
-		return nm_match_spec_device (specs, NULL, NULL, NULL, NULL, NULL, &match_str[NM_STRLEN (MATCH_S390)]);
+		return _MATCH_SPEC_DEVICE (specs, compiled, NULL, NULL, NULL, NULL, NULL, &match_str[NM_STRLEN (MATCH_S390)]);
 	if (match_str && g_str_has_prefix (match_str, MATCH_DRIVER)) {
 		gs_free char *s = g_strdup (&match_str[NM_STRLEN (MATCH_DRIVER)]);
 		char *t;
@@ -1005,9 +1010,26 @@ _test_match_spec_device (const GSList *specs, const char *match_str)
 			t[0] = '\0';
 			t++;
 		}
-		return nm_match_spec_device (specs, NULL, NULL, s, t, NULL, NULL);
+		return _MATCH_SPEC_DEVICE (specs, compiled, NULL, NULL, s, t, NULL, NULL);
+	}
+	return _MATCH_SPEC_DEVICE (specs, compiled, match_str, NULL, NULL, NULL, NULL, NULL);
+}
+
+static NMMatchSpecMatchType
+_test_match_spec_device (const GSList *specs, const char *match_str)
+{
+	NMMatchSpecCompiled *compiled;
+	NMMatchSpecMatchType m;
+
+	m = _test_match_spec_device_one (specs, NULL, match_str);
+
+	/* the compiled specs must give the same result */
+	compiled = nm_match_spec_compile (specs);
+	if (compiled) {
+		g_assert_cmpint (_test_match_spec_device_one (NULL, compiled, match_str), ==, m);
+		nm_match_spec_compiled_free (compiled);
 	}
-	return nm_match_spec_device (specs, match_str, NULL, NULL, NULL, NULL, NULL);
+	return m;
 }
 
 static void
@@ -262,6 +262,86 @@ test_add_route_with_source (void)
 	g_object_unref (a);
 }
 
+static void
+test_many_routes (void)
+{
+	gs_unref_object NMIP4Config *a = NULL;
+	gs_unref_object NMIP4Config *b = NULL;
+	NMPlatformIP4Route route;
+	guint i;
+
+	/* enough routes that the lookups use the hash index */
+	a = nm_ip4_config_new (1);
+	b = nm_ip4_config_new (1);
+	for (i = 0; i < 200; i++) {
+		route = *nmtst_platform_ip4_route ("10.0.0.0", 24, "192.168.1.1");
+		route.network = htonl (0x0a000000u + (i << 8));
+		nm_ip4_config_add_route (a, &route);
+		if (i % 2 == 0)
+			nm_ip4_config_add_route (b, &route);
+	}
+	g_assert_cmpuint (nm_ip4_config_get_num_routes (a), ==, 200);
+	g_assert_cmpuint (nm_ip4_config_get_num_routes (b), ==, 100);
+
+	/* adding a duplicate replaces the entry in place */
+	route = *nmtst_platform_ip4_route ("10.0.5.0", 24, "192.168.1.2");
+	nm_ip4_config_add_route (a, &route);
+	g_assert_cmpuint (nm_ip4_config_get_num_routes (a), ==, 200);
+	g_assert_cmpuint (nm_ip4_config_get_route (a, 5)->gateway, ==, nmtst_inet4_from_string ("192.168.1.2"));
+
+	/* deleting shifts the entries, which must not confuse later lookups */
+	nm_ip4_config_del_route (a, 0);
+	route = *nmtst_platform_ip4_route ("10.0.6.0", 24, "192.168.1.3");
+	nm_ip4_config_add_route (a, &route);
+	g_assert_cmpuint (nm_ip4_config_get_num_routes (a), ==, 199);
+	g_assert_cmpuint (nm_ip4_config_get_route (a, 5)->gateway, ==, nmtst_inet4_from_string ("192.168.1.3"));
+
+	nm_ip4_config_intersect (a, b);
+	g_assert_cmpuint (nm_ip4_config_get_num_routes (a), ==, 99);
+	for (i = 0; i < nm_ip4_config_get_num_routes (a); i++)
+		g_assert_cmpuint ((ntohl (nm_ip4_config_get_route (a, i)->network) >> 8) % 2, ==, 0);
+
+	nm_ip4_config_subtract (b, a);
+	g_assert_cmpuint (nm_ip4_config_get_num_routes (b), ==, 1);
+	g_assert_cmpuint (nm_ip4_config_get_route (b, 0)->network, ==, nmtst_inet4_from_string ("10.0.0.0"));
+}
+
+static void
+test_replace_shared (void)
+{
+	gs_unref_object NMIP4Config *src = NULL;
+	gs_unref_object NMIP4Config *dst = NULL;
+	gs_unref_object NMIP4Config *clone = NULL;
+	NMPlatformIP4Address addr;
+	NMPlatformIP4Route route;
+
+	src = build_test_config ();
+	dst = nm_ip4_config_new (1);
+	nm_ip4_config_replace (dst, src, NULL);
+	clone = nm_ip4_config_new (1);
+	nm_ip4_config_replace (clone, src, NULL);
+	g_assert (nm_ip4_config_equal (dst, src));
+	g_assert (nm_ip4_config_equal (clone, src));
+
+	/* the configs share their arrays, modifying one must not change the others */
+	addr = *nmtst_platform_ip4_address ("192.168.2.10", NULL, 24);
+	nm_ip4_config_add_address (dst, &addr);
+	nm_ip4_config_del_route (dst, 0);
+	g_assert_cmpuint (nm_ip4_config_get_num_addresses (dst), ==, 2);
+	g_assert_cmpuint (nm_ip4_config_get_num_routes (dst), ==, 1);
+	g_assert_cmpuint (nm_ip4_config_get_num_addresses (src), ==, 1);
+	g_assert_cmpuint (nm_ip4_config_get_num_routes (src), ==, 2);
+
+	route = *nmtst_platform_ip4_route ("10.0.0.0", 8, "192.168.1.2");
+	nm_ip4_config_add_route (src, &route);
+	g_assert_cmpuint (nm_ip4_config_get_route (src, 0)->gateway, ==, nmtst_inet4_from_string ("192.168.1.2"));
+	g_assert_cmpuint (nm_ip4_config_get_route (clone, 0)->gateway, ==, nmtst_inet4_from_string ("192.168.1.1"));
+
+	nm_ip4_config_reset_addresses (clone);
+	g_assert_cmpuint (nm_ip4_config_get_num_addresses (clone), ==, 0);
+	g_assert_cmpuint (nm_ip4_config_get_num_addresses (src), ==, 1);
+}
+
 static void
 test_merge_subtract_mss_mtu (void)
 {
@@ -335,6 +415,8 @@ main (int argc, char **argv)
 	g_test_add_func ("/ip4-config/compare-with-source", test_compare_with_source);
 	g_test_add_func ("/ip4-config/add-address-with-source", test_add_address_with_source);
 	g_test_add_func ("/ip4-config/add-route-with-source", test_add_route_with_source);
+	g_test_add_func ("/ip4-config/many-routes", test_many_routes);
+	g_test_add_func ("/ip4-config/replace-shared", test_replace_shared);
 	g_test_add_func ("/ip4-config/merge-subtract-mss-mtu", test_merge_subtract_mss_mtu);
 	g_test_add_func ("/ip4-config/strip-search-trailing-dot", test_strip_search_trailing_dot);
 
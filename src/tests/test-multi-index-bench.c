@@ -0,0 +1,182 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright 2017 Red Hat, Inc.
+ */
+
+/* Microbenchmark for NMMultiIndex.
+ *
+ * This is not run by "make check". Run it by hand, optionally with
+ * NMTST_BENCH_ITERATIONS set to the number of values. Each benchmark
+ * prints one line
+ *
+ *   bench<TAB>profile<TAB>operation<TAB>values<TAB>ns-per-op
+ *
+ * to stdout, like libnm-core/tests/test-bench. */
+
+#include "nm-default.h"
+
+#include "nm-multi-index.h"
+
+#include "nm-test-utils-core.h"
+
+/*****************************************************************************/
+
+typedef struct {
+	NMMultiIndexId id_base;
+	guint group;
+} BenchId;
+
+static guint
+_id_hash (const BenchId *id)
+{
+	return id->group;
+}
+
+static gboolean
+_id_equal (const BenchId *a, const BenchId *b)
+{
+	return a->group == b->group;
+}
+
+static BenchId *
+_id_clone (const BenchId *id)
+{
+	return g_slice_dup (BenchId, id);
+}
+
+static void
+_id_destroy (BenchId *id)
+{
+	g_slice_free (BenchId, id);
+}
+
+typedef struct {
+	const char *name;
+
+	/* how many values share one group. */
+	guint values_per_group;
+} BenchProfile;
+
+static const BenchProfile profiles[] = {
+	{ .name = "unique",  .values_per_group = 1,    },
+	{ .name = "small",   .values_per_group = 4,    },
+	{ .name = "medium",  .values_per_group = 64,   },
+	{ .name = "large",   .values_per_group = 4096, },
+};
+
+/*****************************************************************************/
+
+#define VALUE(i) GUINT_TO_POINTER ((i) + 1)
+
+#define BENCH(profile, op, num_values, stmt) \
+	G_STMT_START { \
+		const guint _num_values = (num_values); \
+		gint64 _start; \
+		guint i; \
+		\
+		_start = g_get_monotonic_time (); \
+		for (i = 0; i < _num_values; i++) { \
+			stmt; \
+		} \
+		nmtst_bench_report ((profile), (op), _num_values, _start); \
+	} G_STMT_END
+
+static void
+test_bench_profile (gconstpointer test_data)
+{
+	const BenchProfile *profile = test_data;
+	const guint num_values = nmtst_bench_iterations (100000, G_MAXINT32 / 2);
+	const guint per_group = profile->values_per_group;
+	NMMultiIndex *index;
+	NMMultiIndexIter iter;
+	guint n;
+
+	index = nm_multi_index_new ((NMMultiIndexFuncHash) _id_hash,
+	                            (NMMultiIndexFuncEqual) _id_equal,
+	                            (NMMultiIndexFuncClone) _id_clone,
+	                            (NMMultiIndexFuncDestroy) _id_destroy);
+
+	BENCH (profile->name, "add", num_values, ({
+		BenchId id = { .group = i / per_group };
+
+		g_assert (nm_multi_index_add (index, &id.id_base, VALUE (i)));
+	}));
+	g_assert_cmpint (nm_multi_index_get_num_groups (index), ==, (num_values + per_group - 1) / per_group);
+
+	BENCH (profile->name, "contains", num_values, ({
+		BenchId id = { .group = i / per_group };
+
+		g_assert (nm_multi_index_contains (index, &id.id_base, VALUE (i)));
+	}));
+
+	BENCH (profile->name, "lookup", num_values, ({
+		BenchId id = { .group = i / per_group };
+		guint len;
+
+		g_assert (nm_multi_index_lookup (index, &id.id_base, &len));
+		g_assert (len > 0);
+	}));
+
+	n = 0;
+	BENCH (profile->name, "iterate", 1, ({
+		void *const*values;
+		guint len;
+
+		nm_multi_index_iter_init (&iter, index, NULL);
+		while (nm_multi_index_iter_next (&iter, NULL, &values, &len))
+			n += len;
+	}));
+	g_assert_cmpint (n, ==, num_values);
+
+	/* move each value to the neighbouring group and back. */
+	BENCH (profile->name, "move", num_values, ({
+		BenchId id_old = { .group = i / per_group };
+		BenchId id_new = { .group = i / per_group + 1 };
+
+		g_assert (nm_multi_index_move (index, &id_old.id_base, &id_new.id_base, VALUE (i)));
+		g_assert (nm_multi_index_move (index, &id_new.id_base, &id_old.id_base, VALUE (i)));
+	}));
+
+	BENCH (profile->name, "remove", num_values, ({
+		BenchId id = { .group = i / per_group };
+
+		g_assert (nm_multi_index_remove (index, &id.id_base, VALUE (i)));
+	}));
+	g_assert_cmpint (nm_multi_index_get_num_groups (index), ==, 0);
+
+	nm_multi_index_free (index);
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE ();
+
+int
+main (int argc, char **argv)
+{
+	guint i;
+
+	nmtst_init_assert_logging (&argc, &argv, "WARN", "DEFAULT");
+
+	for (i = 0; i < G_N_ELEMENTS (profiles); i++) {
+		gs_free char *path = g_strdup_printf ("/general/multi-index-bench/%s", profiles[i].name);
+
+		g_test_add_data_func (path, &profiles[i], test_bench_profile);
+	}
+
+	return g_test_run ();
+}
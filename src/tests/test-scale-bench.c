@@ -0,0 +1,199 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright 2017 Red Hat, Inc.
+ */
+
+/* Scale benchmark for NMRouteManager, NMDefaultRouteManager and
+ * NMIP4Config on top of NMFakePlatform.
+ *
+ * This is not run by "make check". Run it by hand. The size of the
+ * setup is
+ *
+ *   NMTST_BENCH_LINKS          links (default 1000)
+ *   NMTST_BENCH_ADDRESSES      IPv4 addresses, spread over the links (default 10000)
+ *   NMTST_BENCH_ROUTES         IPv4 routes, spread over the links (default 100000)
+ *
+ * Set them to 10000, 100000 and 1000000 to simulate a large host. Each
+ * benchmark prints one line
+ *
+ *   bench<TAB>fake-platform<TAB>operation<TAB>count<TAB>ns-per-op
+ *
+ * to stdout, like libnm-core/tests/test-bench. */
+
+#include "nm-default.h"
+
+#include <arpa/inet.h>
+
+#include "platform/nm-platform.h"
+#include "platform/nm-platform-utils.h"
+#include "nm-route-manager.h"
+#include "nm-default-route-manager.h"
+#include "nm-ip4-config.h"
+
+#include "platform/tests/test-common.h"
+
+/*****************************************************************************/
+
+#define BENCH_SIZE_MAX (16 * 1024 * 1024)
+
+static GArray *
+_create_routes (int ifindex, guint first, guint n)
+{
+	GArray *routes = g_array_sized_new (FALSE, FALSE, sizeof (NMPlatformIP4Route), n);
+	NMPlatformIP4Route route = { 0 };
+	guint i;
+
+	route.ifindex = ifindex;
+	route.rt_source = nmp_utils_ip_config_source_round_trip_rtprot (NM_IP_CONFIG_SOURCE_USER);
+	route.plen = 32;
+	route.metric = 100;
+
+	/* device routes to distinct hosts in 10.0.0.0/8, so that the routes
+	 * of different links never replace each other. */
+	for (i = 0; i < n; i++) {
+		route.network = htonl (0x0a000000u + first + i);
+		g_array_append_val (routes, route);
+	}
+	return routes;
+}
+
+static void
+test_scale (void)
+{
+	const guint n_links = nmtst_bench_size ("NMTST_BENCH_LINKS", 1000, BENCH_SIZE_MAX);
+	const guint n_addresses = nmtst_bench_size ("NMTST_BENCH_ADDRESSES", 10000, BENCH_SIZE_MAX);
+	const guint n_routes = MIN (nmtst_bench_size ("NMTST_BENCH_ROUTES", 100000, BENCH_SIZE_MAX), 0xffffffu);
+	gs_free int *ifindexes = g_new0 (int, n_links);
+	gs_free GArray **routes = g_new0 (GArray *, n_links);
+	NMRouteManager *route_manager = nm_route_manager_get ();
+	NMDefaultRouteManager *default_route_manager = nm_default_route_manager_get ();
+	gint64 start;
+	guint i, n;
+
+	start = g_get_monotonic_time ();
+	for (i = 0; i < n_links; i++) {
+		char ifname[IFNAMSIZ];
+		const NMPlatformLink *plink = NULL;
+
+		nm_sprintf_buf (ifname, "nm-bench%u", i);
+		g_assert (nm_platform_link_dummy_add (NM_PLATFORM_GET, ifname, &plink) == NM_PLATFORM_ERROR_SUCCESS);
+		g_assert (plink);
+		ifindexes[i] = plink->ifindex;
+		g_assert (nm_platform_link_set_up (NM_PLATFORM_GET, ifindexes[i], NULL));
+	}
+	nmtst_bench_report ("fake-platform", "link-add", n_links, start);
+
+	start = g_get_monotonic_time ();
+	for (i = 0; i < n_links; i++) {
+		char ifname[IFNAMSIZ];
+
+		nm_sprintf_buf (ifname, "nm-bench%u", i);
+		g_assert_cmpint (nm_platform_link_get_ifindex (NM_PLATFORM_GET, ifname), ==, ifindexes[i]);
+	}
+	nmtst_bench_report ("fake-platform", "link-get-by-ifname", n_links, start);
+
+	start = g_get_monotonic_time ();
+	for (i = 0; i < n_addresses; i++) {
+		g_assert (nm_platform_ip4_address_add (NM_PLATFORM_GET,
+		                                       ifindexes[i % n_links],
+		                                       htonl (0xac100000u + i),
+		                                       32,
+		                                       0,
+		                                       NM_PLATFORM_LIFETIME_PERMANENT,
+		                                       NM_PLATFORM_LIFETIME_PERMANENT,
+		                                       0,
+		                                       NULL));
+	}
+	nmtst_bench_report ("fake-platform", "ip4-address-add", n_addresses, start);
+
+	for (i = 0, n = 0; i < n_links; i++) {
+		guint cnt = n_routes / n_links + (i < n_routes % n_links ? 1 : 0);
+
+		routes[i] = _create_routes (ifindexes[i], n, cnt);
+		n += cnt;
+	}
+	g_assert_cmpint (n, ==, n_routes);
+
+	start = g_get_monotonic_time ();
+	for (i = 0; i < n_links; i++)
+		nm_route_manager_ip4_route_sync (route_manager, ifindexes[i], routes[i], TRUE, TRUE);
+	nmtst_bench_report ("fake-platform", "ip4-route-sync-add", n_routes, start);
+
+	start = g_get_monotonic_time ();
+	for (i = 0; i < n_links; i++)
+		nm_route_manager_ip4_route_sync (route_manager, ifindexes[i], routes[i], TRUE, TRUE);
+	nmtst_bench_report ("fake-platform", "ip4-route-sync-unchanged", n_links, start);
+
+	/* the cost of a disabled trace message in the cache hooks. The
+	 * argument must not be formatted. */
+	start = g_get_monotonic_time ();
+	for (i = 0; i < n_routes; i++) {
+		nm_log (LOGL_TRACE, LOGD_PLATFORM, NULL, NULL, "bench: %s",
+		        nm_platform_ip4_route_to_string (&g_array_index (routes[0], NMPlatformIP4Route, i % routes[0]->len), NULL, 0));
+	}
+	nmtst_bench_report ("fake-platform", "log-trace-disabled", n_routes, start);
+
+	start = g_get_monotonic_time ();
+	for (i = 0; i < n_links; i++) {
+		gs_unref_object NMIP4Config *config = NULL;
+
+		config = nm_ip4_config_capture (ifindexes[i], FALSE);
+		g_assert (config);
+	}
+	nmtst_bench_report ("fake-platform", "ip4-config-capture", n_links, start);
+
+	n = MAX (n_links / 100, 10u);
+	start = g_get_monotonic_time ();
+	for (i = 0; i < n; i++)
+		nm_default_route_manager_resync (default_route_manager, AF_INET);
+	nmtst_bench_report ("fake-platform", "default-route-resync", n, start);
+
+	/* drop half of the routes of every link. */
+	start = g_get_monotonic_time ();
+	for (i = 0; i < n_links; i++) {
+		if (routes[i]->len > 1)
+			g_array_set_size (routes[i], routes[i]->len / 2);
+		nm_route_manager_ip4_route_sync (route_manager, ifindexes[i], routes[i], TRUE, TRUE);
+	}
+	nmtst_bench_report ("fake-platform", "ip4-route-sync-remove", n_links, start);
+
+	start = g_get_monotonic_time ();
+	for (i = 0; i < n_links; i++) {
+		nm_route_manager_route_flush (route_manager, ifindexes[i]);
+		g_assert (nm_platform_link_delete (NM_PLATFORM_GET, ifindexes[i]));
+	}
+	nmtst_bench_report ("fake-platform", "link-delete", n_links, start);
+
+	for (i = 0; i < n_links; i++)
+		g_array_unref (routes[i]);
+}
+
+/*****************************************************************************/
+
+NMTstpSetupFunc const _nmtstp_setup_platform_func = SETUP;
+
+void
+_nmtstp_init_tests (int *argc, char ***argv)
+{
+	nmtst_init_assert_logging (argc, argv, "WARN", "ALL");
+}
+
+void
+_nmtstp_setup_tests (void)
+{
+	g_test_add_func ("/scale-bench/fake", test_scale);
+}
@@ -45,7 +45,7 @@ nm_utils_get_monotonic_timestamp_s (void)
 	return 1;
 }
 
-NMLogDomain _nm_logging_enabled_state[_LOGL_N_REAL];
+NMLogDomain _nm_logging_check_state[_LOGL_N_REAL];
 
 void
 _nm_log_impl (const char *file,
@@ -146,6 +146,16 @@ typedef struct {
 	int ip_ifindex;
 	char *banner;
 	guint32 mtu;
+
+	/* With vpn-reconnect-cache, the secrets of an activated connection are
+	 * kept in memory and handed to the connection that policy starts to
+	 * reconnect after a failure. The tunnel interface of the failed
+	 * connection is left configured, so that the reconnect only has to
+	 * apply what changed. */
+	GVariant *reconnect_secrets;
+	char *reconnect_username;
+	int reconnect_ifindex;
+	gboolean reconnect_pending;
 } NMVpnConnectionPrivate;
 
 struct _NMVpnConnection {
@@ -179,6 +189,8 @@ G_DEFINE_TYPE (NMVpnConnection, nm_vpn_connection, NM_TYPE_ACTIVE_CONNECTION)
 static NMSettingsConnection *_get_settings_connection (NMVpnConnection *self,
                                                        gboolean allow_missing);
 
+static void reconnect_with_cached_secrets (NMVpnConnection *self);
+
 static void get_secrets (NMVpnConnection *self,
                          SecretsReq secrets_idx,
                          const char **hints);
@@ -400,15 +412,59 @@ remove_parent_device_config (NMVpnConnection *connection, NMDevice *device)
 	}
 }
 
+static gboolean
+_reconnect_cache_enabled (void)
+{
+	return nm_config_data_get_value_boolean (NM_CONFIG_GET_DATA,
+	                                         NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                                         NM_CONFIG_KEYFILE_KEY_MAIN_VPN_RECONNECT_CACHE,
+	                                         FALSE);
+}
+
+static void
+_flush_ifindex (NMVpnConnection *self, int ifindex)
+{
+	NMVpnConnectionPrivate *priv = NM_VPN_CONNECTION_GET_PRIVATE (self);
+
+	nm_platform_link_set_down (NM_PLATFORM_GET, ifindex);
+	nm_route_manager_route_flush (priv->route_manager, ifindex);
+	nm_platform_address_flush (NM_PLATFORM_GET, ifindex);
+}
+
+static void
+_reconnect_clear (NMVpnConnection *self)
+{
+	NMVpnConnectionPrivate *priv = NM_VPN_CONNECTION_GET_PRIVATE (self);
+
+	g_clear_pointer (&priv->reconnect_secrets, g_variant_unref);
+	g_clear_pointer (&priv->reconnect_username, g_free);
+
+	/* nobody took over the interface we left configured. */
+	if (priv->reconnect_ifindex > 0 && priv->route_manager) {
+		if (priv->reconnect_ifindex != priv->ip_ifindex)
+			_flush_ifindex (self, priv->reconnect_ifindex);
+		priv->reconnect_ifindex = 0;
+	}
+}
+
 static void
 vpn_cleanup (NMVpnConnection *self, NMDevice *parent_dev)
 {
 	NMVpnConnectionPrivate *priv = NM_VPN_CONNECTION_GET_PRIVATE (self);
 
+	if (priv->reconnect_ifindex > 0) {
+		if (priv->reconnect_ifindex != priv->ip_ifindex)
+			_flush_ifindex (self, priv->reconnect_ifindex);
+		priv->reconnect_ifindex = 0;
+	}
+
 	if (priv->ip_ifindex) {
-		nm_platform_link_set_down (NM_PLATFORM_GET, priv->ip_ifindex);
-		nm_route_manager_route_flush (priv->route_manager, priv->ip_ifindex);
-		nm_platform_address_flush (NM_PLATFORM_GET, priv->ip_ifindex);
+		if (priv->reconnect_pending) {
+			/* left configured for the reconnect, which flushes it if
+			 * it doesn't get the same interface again. */
+			priv->reconnect_ifindex = priv->ip_ifindex;
+		} else
+			_flush_ifindex (self, priv->ip_ifindex);
 	}
 
 	remove_parent_device_config (self, parent_dev);
@@ -552,6 +608,15 @@ _set_vpn_state (NMVpnConnection *self,
 		}
 		break;
 	case STATE_ACTIVATED:
+		if (_reconnect_cache_enabled ()) {
+			_reconnect_clear (self);
+			priv->reconnect_secrets = nm_connection_to_dbus (_get_applied_connection (self),
+			                                                 NM_CONNECTION_SERIALIZE_ONLY_SECRETS);
+			if (priv->reconnect_secrets)
+				g_variant_ref_sink (priv->reconnect_secrets);
+			priv->reconnect_username = g_strdup (priv->username);
+		}
+
 		/* Secrets no longer needed now that we're connected */
 		nm_active_connection_clear_secrets (NM_ACTIVE_CONNECTION (self));
 
@@ -638,6 +703,8 @@ _set_vpn_state (NMVpnConnection *self,
 		/* Tear down and clean up the connection */
 		call_plugin_disconnect (self);
 		vpn_cleanup (self, parent_dev);
+		if (!priv->reconnect_pending)
+			_reconnect_clear (self);
 		/* fall through */
 	default:
 		priv->secrets_idx = SECRETS_REQ_SYSTEM;
@@ -904,6 +971,10 @@ plugin_state_changed (NMVpnConnection *self, NMVpnServiceState new_service_state
 		if ((priv->vpn_state >= STATE_WAITING) && (priv->vpn_state <= STATE_ACTIVATED)) {
 			VpnState old_state = priv->vpn_state;
 
+			priv->reconnect_pending =    old_state == STATE_ACTIVATED
+			                          && _connection_only_can_persist (self)
+			                          && _reconnect_cache_enabled ();
+
 			_set_vpn_state (self, STATE_FAILED, priv->failure_reason, FALSE);
 
 			/* Reset the failure reason */
@@ -916,6 +987,10 @@ plugin_state_changed (NMVpnConnection *self, NMVpnServiceState new_service_state
 			    && priv->vpn_state == STATE_FAILED
 			    && _connection_only_can_persist (self))
 				g_signal_emit (self, signals[INTERNAL_RETRY_AFTER_FAILURE], 0);
+
+			/* whatever the reconnect didn't take over goes away now. */
+			priv->reconnect_pending = FALSE;
+			_reconnect_clear (self);
 		}
 	} else if (new_service_state == NM_VPN_SERVICE_STATE_STARTING &&
 	           old_service_state == NM_VPN_SERVICE_STATE_STARTED) {
@@ -1084,6 +1159,14 @@ nm_vpn_connection_apply_config (NMVpnConnection *self)
 {
 	NMVpnConnectionPrivate *priv = NM_VPN_CONNECTION_GET_PRIVATE (self);
 
+	if (priv->reconnect_ifindex > 0) {
+		/* the interface of the failed connection; if it is still ours, the
+		 * commit below only changes what differs. */
+		if (priv->reconnect_ifindex != priv->ip_ifindex)
+			_flush_ifindex (self, priv->reconnect_ifindex);
+		priv->reconnect_ifindex = 0;
+	}
+
 	if (priv->ip_ifindex > 0) {
 		nm_platform_link_set_up (NM_PLATFORM_GET, priv->ip_ifindex, NULL);
 
@@ -1993,7 +2076,10 @@ _name_owner_changed (GObject *object,
 		 * secrets from system and from user agents and ask the plugin again,
 		 * and last we ask the user for new secrets if required.
 		 */
-		get_secrets (self, SECRETS_REQ_SYSTEM, NULL);
+		if (priv->reconnect_secrets)
+			reconnect_with_cached_secrets (self);
+		else
+			get_secrets (self, SECRETS_REQ_SYSTEM, NULL);
 	} else if (!owner && priv->service_running) {
 		/* service went away */
 		priv->service_running = FALSE;
@@ -2052,10 +2138,24 @@ _get_log_level (void)
 	return LOG_EMERG;
 }
 
-static gboolean
-nm_vpn_service_daemon_exec (NMVpnConnection *self, GError **error)
+/**
+ * nm_vpn_service_spawn:
+ * @plugin_info: the plugin to start
+ * @bus_name: the bus name the plugin should request. Only used if the
+ *   plugin supports multiple connections.
+ * @out_pid: (allow-none): on return, the PID of the started service
+ * @error: location to store error, or %NULL
+ *
+ * Starts the service program of a VPN plugin.
+ *
+ * Returns: %TRUE if the program was started
+ */
+gboolean
+nm_vpn_service_spawn (NMVpnPluginInfo *plugin_info,
+                      const char *bus_name,
+                      GPid *out_pid,
+                      GError **error)
 {
-	NMVpnConnectionPrivate *priv;
 	GPid pid;
 	char *vpn_argv[4];
 	gboolean success = FALSE;
@@ -2067,16 +2167,15 @@ nm_vpn_service_daemon_exec (NMVpnConnection *self, GError **error)
 	const int N_ENVIRON_EXTRA = 3;
 	char **p_environ;
 
-	g_return_val_if_fail (NM_IS_VPN_CONNECTION (self), FALSE);
-
-	priv = NM_VPN_CONNECTION_GET_PRIVATE (self);
+	g_return_val_if_fail (NM_IS_VPN_PLUGIN_INFO (plugin_info), FALSE);
 
 	i = 0;
-	vpn_argv[i++] = (char *) nm_vpn_plugin_info_get_program (priv->plugin_info);
+	vpn_argv[i++] = (char *) nm_vpn_plugin_info_get_program (plugin_info);
 	g_return_val_if_fail (vpn_argv[0], FALSE);
-	if (nm_vpn_plugin_info_supports_multiple (priv->plugin_info)) {
+	if (nm_vpn_plugin_info_supports_multiple (plugin_info)) {
+		g_return_val_if_fail (bus_name, FALSE);
 		vpn_argv[i++] = "--bus-name";
-		vpn_argv[i++] = priv->bus_name;
+		vpn_argv[i++] = (char *) bus_name;
 	}
 	vpn_argv[i++] = NULL;
 
@@ -2105,10 +2204,9 @@ nm_vpn_service_daemon_exec (NMVpnConnection *self, GError **error)
 
 	success = g_spawn_async (NULL, vpn_argv, envp, 0, nm_utils_setpgid, NULL, &pid, &spawn_error);
 
-	if (success) {
-		_LOGI ("Started the VPN service, PID %ld", (long int) pid);
-		priv->start_timeout = g_timeout_add_seconds (5, _daemon_exec_timeout, self);
-	} else {
+	if (success)
+		NM_SET_OUT (out_pid, pid);
+	else {
 		g_set_error (error,
 		             NM_MANAGER_ERROR, NM_MANAGER_ERROR_FAILED,
 		             "%s", spawn_error ? spawn_error->message : "unknown g_spawn_async() error");
@@ -2120,6 +2218,24 @@ nm_vpn_service_daemon_exec (NMVpnConnection *self, GError **error)
 	return success;
 }
 
+static gboolean
+nm_vpn_service_daemon_exec (NMVpnConnection *self, GError **error)
+{
+	NMVpnConnectionPrivate *priv;
+	GPid pid;
+
+	g_return_val_if_fail (NM_IS_VPN_CONNECTION (self), FALSE);
+
+	priv = NM_VPN_CONNECTION_GET_PRIVATE (self);
+
+	if (!nm_vpn_service_spawn (priv->plugin_info, priv->bus_name, &pid, error))
+		return FALSE;
+
+	_LOGI ("Started the VPN service, PID %ld", (long int) pid);
+	priv->start_timeout = g_timeout_add_seconds (5, _daemon_exec_timeout, self);
+	return TRUE;
+}
+
 static void
 on_proxy_acquired (GObject *object, GAsyncResult *result, gpointer user_data)
 {
@@ -2164,7 +2280,8 @@ on_proxy_acquired (GObject *object, GAsyncResult *result, gpointer user_data)
 
 void
 nm_vpn_connection_activate (NMVpnConnection *self,
-                            NMVpnPluginInfo *plugin_info)
+                            NMVpnPluginInfo *plugin_info,
+                            const char *bus_name)
 {
 	NMVpnConnectionPrivate *priv;
 	NMSettingVpn *s_vpn;
@@ -2182,7 +2299,10 @@ nm_vpn_connection_activate (NMVpnConnection *self,
 	service = nm_vpn_plugin_info_get_service (plugin_info);
 	nm_assert (service);
 
-	if (nm_vpn_plugin_info_supports_multiple (plugin_info)) {
+	if (nm_vpn_plugin_info_supports_multiple (plugin_info) && bus_name) {
+		/* a service started in advance by the VPN manager. */
+		priv->bus_name = g_strdup (bus_name);
+	} else if (nm_vpn_plugin_info_supports_multiple (plugin_info)) {
 		const char *path;
 
 		path = nm_exported_object_get_path (NM_EXPORTED_OBJECT (self));
@@ -2211,6 +2331,37 @@ nm_vpn_connection_activate (NMVpnConnection *self,
 	_set_vpn_state (self, STATE_PREPARE, NM_ACTIVE_CONNECTION_STATE_REASON_NONE, FALSE);
 }
 
+/**
+ * nm_vpn_connection_reconnect_from:
+ * @self: the new #NMVpnConnection
+ * @failed: the #NMVpnConnection that failed and that @self reconnects
+ *
+ * Moves what @failed kept for the reconnect (see vpn-reconnect-cache in
+ * NetworkManager.conf) to @self. Must be called right after activating
+ * @self, before it asks for secrets.
+ */
+void
+nm_vpn_connection_reconnect_from (NMVpnConnection *self, NMVpnConnection *failed)
+{
+	NMVpnConnectionPrivate *priv, *failed_priv;
+
+	g_return_if_fail (NM_IS_VPN_CONNECTION (self));
+	g_return_if_fail (NM_IS_VPN_CONNECTION (failed));
+
+	priv = NM_VPN_CONNECTION_GET_PRIVATE (self);
+	failed_priv = NM_VPN_CONNECTION_GET_PRIVATE (failed);
+
+	if (   !failed_priv->reconnect_pending
+	    || _get_settings_connection (self, TRUE) != _get_settings_connection (failed, TRUE))
+		return;
+
+	_reconnect_clear (self);
+	priv->reconnect_secrets = g_steal_pointer (&failed_priv->reconnect_secrets);
+	priv->reconnect_username = g_steal_pointer (&failed_priv->reconnect_username);
+	priv->reconnect_ifindex = failed_priv->reconnect_ifindex;
+	failed_priv->reconnect_ifindex = 0;
+}
+
 NMVpnConnectionState
 nm_vpn_connection_get_vpn_state (NMVpnConnection *self)
 {
@@ -2539,6 +2690,39 @@ get_secrets (NMVpnConnection *self,
 	g_return_if_fail (priv->secrets_id);
 }
 
+static void
+reconnect_with_cached_secrets (NMVpnConnection *self)
+{
+	NMVpnConnectionPrivate *priv = NM_VPN_CONNECTION_GET_PRIVATE (self);
+	gs_unref_variant GVariant *secrets = g_steal_pointer (&priv->reconnect_secrets);
+	gs_free_error GError *error = NULL;
+	GVariant *dict;
+
+	/* The secrets are used once. If the plugin wants more, the usual
+	 * requests follow, starting with the agents. */
+	priv->secrets_idx = SECRETS_REQ_SYSTEM;
+	if (!nm_connection_update_secrets (_get_applied_connection (self), NULL, secrets, &error)) {
+		_LOGD ("cannot reuse the secrets of the previous connection: %s", error->message);
+		get_secrets (self, SECRETS_REQ_SYSTEM, NULL);
+		return;
+	}
+
+	g_free (priv->username);
+	priv->username = g_steal_pointer (&priv->reconnect_username);
+
+	_LOGD ("reconnecting with the secrets of the previous connection");
+
+	dict = _hash_with_username (_get_applied_connection (self), priv->username);
+	g_dbus_proxy_call (priv->proxy,
+	                   "NeedSecrets",
+	                   g_variant_new ("(@a{sa{sv}})", dict),
+	                   G_DBUS_CALL_FLAGS_NONE,
+	                   -1,
+	                   priv->cancellable,
+	                   (GAsyncReadyCallback) plugin_need_secrets_cb,
+	                   self);
+}
+
 static void
 plugin_interactive_secrets_required (NMVpnConnection *self,
                                      const char *message,
@@ -2629,6 +2813,9 @@ dispose (GObject *object)
 
 	cancel_get_secrets (self);
 
+	priv->reconnect_pending = FALSE;
+	_reconnect_clear (self);
+
 	nm_clear_g_cancellable (&priv->cancellable);
 
 	g_clear_object (&priv->proxy_config);
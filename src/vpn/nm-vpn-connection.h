@@ -56,7 +56,10 @@ NMVpnConnection * nm_vpn_connection_new (NMSettingsConnection *settings_connecti
                                          NMAuthSubject *subject);
 
 void                 nm_vpn_connection_activate        (NMVpnConnection *self,
-                                                        NMVpnPluginInfo *plugin_info);
+                                                        NMVpnPluginInfo *plugin_info,
+                                                        const char *bus_name);
+void                 nm_vpn_connection_reconnect_from  (NMVpnConnection *self,
+                                                        NMVpnConnection *failed);
 NMVpnConnectionState nm_vpn_connection_get_vpn_state   (NMVpnConnection *self);
 const char *         nm_vpn_connection_get_banner      (NMVpnConnection *self);
 const gchar *        nm_vpn_connection_get_service     (NMVpnConnection *self);
@@ -70,6 +73,11 @@ void                 nm_vpn_connection_disconnect      (NMVpnConnection *self,
 
 NMProxyConfig *      nm_vpn_connection_get_proxy_config (NMVpnConnection *self);
 
+gboolean             nm_vpn_service_spawn              (NMVpnPluginInfo *plugin_info,
+                                                        const char *bus_name,
+                                                        GPid *out_pid,
+                                                        GError **error);
+
 NMIP4Config *        nm_vpn_connection_get_ip4_config  (NMVpnConnection *self);
 NMIP6Config *        nm_vpn_connection_get_ip6_config  (NMVpnConnection *self);
 const char *         nm_vpn_connection_get_ip_iface    (NMVpnConnection *self, gboolean fallback_device);
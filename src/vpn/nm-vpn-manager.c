@@ -24,12 +24,22 @@
 #include "nm-vpn-manager.h"
 
 #include <string.h>
+#include <signal.h>
 
 #include "nm-vpn-plugin-info.h"
 #include "nm-vpn-connection.h"
 #include "nm-setting-vpn.h"
 #include "nm-vpn-dbus-interface.h"
 #include "nm-core-internal.h"
+#include "nm-config.h"
+
+typedef struct {
+	NMVpnManager *self;
+	char *service;
+	char *bus_name;
+	GPid pid;
+	guint idle_id;
+} PoolEntry;
 
 typedef struct {
 	GSList *plugins;
@@ -41,6 +51,16 @@ typedef struct {
 	/* This is only used for services that don't support multiple
 	 * connections, to guard access to them. */
 	GHashTable *active_services;
+
+	/* services started in advance, ready to take a connection. See
+	 * pool_fill(). */
+	GSList *pool;
+	guint pool_fill_id;
+
+	/* the contents of the name files of all plugins, as served to
+	 * clients. Built on demand and dropped whenever the plugins
+	 * change. See nm_vpn_manager_get_plugin_index(). */
+	GVariant *plugin_index;
 } NMVpnManagerPrivate;
 
 struct _NMVpnManager {
@@ -58,6 +78,141 @@ G_DEFINE_TYPE (NMVpnManager, nm_vpn_manager, G_TYPE_OBJECT)
 
 /*****************************************************************************/
 
+static guint
+pool_get_size (void)
+{
+	return nm_config_data_get_value_int64 (NM_CONFIG_GET_DATA,
+	                                       NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                                       NM_CONFIG_KEYFILE_KEY_MAIN_VPN_PLUGIN_POOL_SIZE,
+	                                       0, 16, 0);
+}
+
+static void
+pool_entry_free (PoolEntry *entry)
+{
+	nm_clear_g_source (&entry->idle_id);
+	g_free (entry->service);
+	g_free (entry->bus_name);
+	g_slice_free (PoolEntry, entry);
+}
+
+static void
+pool_entry_kill (PoolEntry *entry)
+{
+	/* the service never got a connection. Plugins also quit by themselves
+	 * after a while without one, so it might be gone already. */
+	nm_log_dbg (LOGD_VPN, "vpn: stop unused service %s (%s, PID %ld)",
+	            entry->service, entry->bus_name, (long int) entry->pid);
+	if (entry->pid > 0)
+		kill (entry->pid, SIGTERM);
+	pool_entry_free (entry);
+}
+
+static gboolean
+pool_entry_idle_cb (gpointer user_data)
+{
+	PoolEntry *entry = user_data;
+	NMVpnManagerPrivate *priv = NM_VPN_MANAGER_GET_PRIVATE (entry->self);
+
+	entry->idle_id = 0;
+	priv->pool = g_slist_remove (priv->pool, entry);
+	pool_entry_kill (entry);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+pool_fill (NMVpnManager *self, NMVpnPluginInfo *plugin_info)
+{
+	NMVpnManagerPrivate *priv = NM_VPN_MANAGER_GET_PRIVATE (self);
+	static guint pool_id = 0;
+	const char *service;
+	guint size, n = 0;
+	GSList *iter;
+	guint timeout;
+
+	/* only services that support multiple connections take their bus name
+	 * from the command line. Others own the well known name and are simply
+	 * found running by the first connection. */
+	if (!nm_vpn_plugin_info_supports_multiple (plugin_info))
+		return;
+
+	size = pool_get_size ();
+	if (!size)
+		return;
+
+	service = nm_vpn_plugin_info_get_service (plugin_info);
+	for (iter = priv->pool; iter; iter = iter->next) {
+		if (nm_streq (((PoolEntry *) iter->data)->service, service))
+			n++;
+	}
+
+	timeout = nm_config_data_get_value_int64 (NM_CONFIG_GET_DATA,
+	                                          NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                                          NM_CONFIG_KEYFILE_KEY_MAIN_VPN_PLUGIN_POOL_TIMEOUT,
+	                                          1, G_MAXINT32, 120);
+
+	for (; n < size; n++) {
+		gs_free_error GError *error = NULL;
+		PoolEntry *entry;
+
+		entry = g_slice_new0 (PoolEntry);
+		entry->self = self;
+		entry->service = g_strdup (service);
+		entry->bus_name = g_strdup_printf ("%s.Pool_%u", service, ++pool_id);
+
+		if (!nm_vpn_service_spawn (plugin_info, entry->bus_name, &entry->pid, &error)) {
+			nm_log_warn (LOGD_VPN, "vpn: could not start service %s in advance: %s",
+			             service, error->message);
+			pool_entry_free (entry);
+			return;
+		}
+
+		nm_log_dbg (LOGD_VPN, "vpn: started service %s in advance (%s, PID %ld)",
+		            service, entry->bus_name, (long int) entry->pid);
+		entry->idle_id = g_timeout_add_seconds (timeout, pool_entry_idle_cb, entry);
+		priv->pool = g_slist_append (priv->pool, entry);
+	}
+}
+
+static char *
+pool_take (NMVpnManager *self, NMVpnPluginInfo *plugin_info)
+{
+	NMVpnManagerPrivate *priv = NM_VPN_MANAGER_GET_PRIVATE (self);
+	const char *service = nm_vpn_plugin_info_get_service (plugin_info);
+	char *bus_name = NULL;
+	GSList *iter;
+
+	for (iter = priv->pool; iter; iter = iter->next) {
+		PoolEntry *entry = iter->data;
+
+		if (nm_streq (entry->service, service)) {
+			priv->pool = g_slist_delete_link (priv->pool, iter);
+			bus_name = g_steal_pointer (&entry->bus_name);
+			pool_entry_free (entry);
+			break;
+		}
+	}
+
+	/* replace the taken service, or start one for the next time. */
+	pool_fill (self, plugin_info);
+	return bus_name;
+}
+
+static gboolean
+pool_fill_all_cb (gpointer user_data)
+{
+	NMVpnManager *self = user_data;
+	NMVpnManagerPrivate *priv = NM_VPN_MANAGER_GET_PRIVATE (self);
+	GSList *iter;
+
+	priv->pool_fill_id = 0;
+	for (iter = priv->plugins; iter; iter = iter->next)
+		pool_fill (self, iter->data);
+	return G_SOURCE_REMOVE;
+}
+
+/*****************************************************************************/
+
 static void
 vpn_state_changed (NMVpnConnection *vpn,
                    GParamSpec *pspec,
@@ -83,6 +238,7 @@ nm_vpn_manager_activate_connection (NMVpnManager *manager,
 	NMVpnPluginInfo *plugin_info;
 	const char *service_name;
 	NMDevice *device;
+	gs_free char *bus_name = NULL;
 
 	g_return_val_if_fail (NM_IS_VPN_MANAGER (manager), FALSE);
 	g_return_val_if_fail (NM_IS_VPN_CONNECTION (vpn), FALSE);
@@ -116,7 +272,12 @@ nm_vpn_manager_activate_connection (NMVpnManager *manager,
 		return FALSE;
 	}
 
-	nm_vpn_connection_activate (vpn, plugin_info);
+	bus_name = pool_take (manager, plugin_info);
+	if (bus_name) {
+		nm_log_dbg (LOGD_VPN, "vpn: use service %s started in advance (%s)",
+		            service_name, bus_name);
+	}
+	nm_vpn_connection_activate (vpn, plugin_info, bus_name);
 
 	if (!nm_vpn_plugin_info_supports_multiple (plugin_info)) {
 		/* Block activations of the connections of the same service type. */
@@ -149,6 +310,8 @@ try_add_plugin (NMVpnManager *self, NMVpnPluginInfo *plugin_info)
 		return;
 	if (!nm_vpn_plugin_info_list_add (&priv->plugins, plugin_info, NULL))
 		return;
+
+	g_clear_pointer (&priv->plugin_index, g_variant_unref);
 }
 
 static void
@@ -176,6 +339,7 @@ vpn_dir_changed (GFileMonitor *monitor,
 
 		nm_log_dbg (LOGD_VPN, "vpn: service file %s deleted", path);
 		nm_vpn_plugin_info_list_remove (&priv->plugins, plugin_info);
+		g_clear_pointer (&priv->plugin_index, g_variant_unref);
 		break;
 	case G_FILE_MONITOR_EVENT_CREATED:
 	case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
@@ -211,6 +375,57 @@ vpn_dir_changed (GFileMonitor *monitor,
 	}
 }
 
+/**
+ * nm_vpn_manager_get_plugin_index:
+ * @self: the #NMVpnManager
+ *
+ * Returns: (transfer none): a variant of type "a(ss)" with the file name
+ *   and the content of the name file of each known plugin, in the order
+ *   in which the plugins are preferred. Clients can recreate the plugin
+ *   infos from it with nm_vpn_plugin_info_new_with_data() instead of
+ *   scanning and parsing the plugin directories themselves. The index
+ *   is cached until the plugin directories change.
+ */
+GVariant *
+nm_vpn_manager_get_plugin_index (NMVpnManager *self)
+{
+	NMVpnManagerPrivate *priv;
+	GVariantBuilder builder;
+	GSList *iter;
+
+	g_return_val_if_fail (NM_IS_VPN_MANAGER (self), NULL);
+
+	priv = NM_VPN_MANAGER_GET_PRIVATE (self);
+
+	if (priv->plugin_index)
+		return priv->plugin_index;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(ss)"));
+	for (iter = priv->plugins; iter; iter = iter->next) {
+		const char *filename = nm_vpn_plugin_info_get_filename (iter->data);
+		gs_free char *contents = NULL;
+		GError *error = NULL;
+
+		/* The file was validated when the plugin was added. Should it
+		 * since have disappeared, the monitor will soon tell us. */
+		if (!g_file_get_contents (filename, &contents, NULL, &error)) {
+			nm_log_dbg (LOGD_VPN, "vpn: cannot read service file %s for the plugin index (%s)",
+			            filename, error->message);
+			g_clear_error (&error);
+			continue;
+		}
+		if (!g_utf8_validate (contents, -1, NULL)) {
+			nm_log_dbg (LOGD_VPN, "vpn: service file %s is not valid UTF-8, skip it in the plugin index",
+			            filename);
+			continue;
+		}
+		g_variant_builder_add (&builder, "(ss)", filename, contents);
+	}
+
+	priv->plugin_index = g_variant_ref_sink (g_variant_builder_end (&builder));
+	return priv->plugin_index;
+}
+
 /*****************************************************************************/
 
 NM_DEFINE_SINGLETON_GETTER (NMVpnManager, nm_vpn_manager_get, NM_TYPE_VPN_MANAGER);
@@ -256,6 +471,9 @@ nm_vpn_manager_init (NMVpnManager *self)
 	g_slist_free_full (infos, g_object_unref);
 
 	priv->active_services = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	if (pool_get_size ())
+		priv->pool_fill_id = g_idle_add (pool_fill_all_cb, self);
 }
 
 static void
@@ -279,6 +497,11 @@ dispose (GObject *object)
 
 	while (priv->plugins)
 		nm_vpn_plugin_info_list_remove (&priv->plugins, priv->plugins->data);
+	g_clear_pointer (&priv->plugin_index, g_variant_unref);
+
+	nm_clear_g_source (&priv->pool_fill_id);
+	g_slist_free_full (priv->pool, (GDestroyNotify) pool_entry_kill);
+	priv->pool = NULL;
 
 	g_hash_table_unref (priv->active_services);
 
@@ -42,4 +42,6 @@ gboolean nm_vpn_manager_activate_connection (NMVpnManager *manager,
                                              NMVpnConnection *vpn,
                                              GError **error);
 
+GVariant *nm_vpn_manager_get_plugin_index (NMVpnManager *self);
+
 #endif /* __NM_VPN_MANAGER_H__ */
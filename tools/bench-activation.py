@@ -0,0 +1,384 @@
+#!/usr/bin/env python
+# -*- Mode: python; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+
+# Activation latency benchmark.
+#
+# Runs NetworkManager in throwaway network and mount namespaces, with its
+# own system bus, on N veth pairs whose peers live in a second namespace
+# with dnsmasq serving DHCPv4 and router advertisements. It then activates
+# static, DHCPv4 and SLAAC profiles on 1, 100 and 1000 devices at once and
+# reports, per stage of the device state machine and in total, the latency
+# distribution from ActivateConnection() to ACTIVATED.
+#
+# Needs root, iproute2 and dnsmasq, and dbus-python. Run it as
+#
+#   sudo tools/bench-activation.py --nm ./src/NetworkManager
+#
+# Each result is printed as
+#
+#   bench<TAB>activation<TAB>mode<TAB>devices<TAB>stage<TAB>count<TAB>p50-ms<TAB>p90-ms<TAB>p99-ms<TAB>max-ms
+#
+# where the stages are the time spent in each device state, "total" is
+# the time from the activation request to ACTIVATED and "failed" counts
+# the activations that did not get there.
+
+from __future__ import print_function
+
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+import uuid
+
+from gi.repository import GLib
+import dbus
+import dbus.mainloop.glib
+
+NM_DEVICE_STATE_DISCONNECTED = 30
+NM_DEVICE_STATE_PREPARE      = 40
+NM_DEVICE_STATE_CONFIG       = 50
+NM_DEVICE_STATE_IP_CONFIG    = 70
+NM_DEVICE_STATE_IP_CHECK     = 80
+NM_DEVICE_STATE_SECONDARIES  = 90
+NM_DEVICE_STATE_ACTIVATED    = 100
+NM_DEVICE_STATE_FAILED       = 120
+
+STAGES = [
+    ('prepare',     NM_DEVICE_STATE_PREPARE),
+    ('config',      NM_DEVICE_STATE_CONFIG),
+    ('ip-config',   NM_DEVICE_STATE_IP_CONFIG),
+    ('ip-check',    NM_DEVICE_STATE_IP_CHECK),
+    ('secondaries', NM_DEVICE_STATE_SECONDARIES),
+]
+
+MODES = ['static', 'dhcp4', 'slaac']
+
+IFACE_PREFIX = 'nmb'
+PEER_PREFIX = 'nmbp'
+PEER_NETNS = 'nmbench-peer'
+
+NM_SERVICE = 'org.freedesktop.NetworkManager'
+NM_PATH = '/org/freedesktop/NetworkManager'
+NM_IFACE = 'org.freedesktop.NetworkManager'
+NM_DEVICE_IFACE = NM_IFACE + '.Device'
+NM_SETTINGS_PATH = NM_PATH + '/Settings'
+NM_SETTINGS_IFACE = NM_IFACE + '.Settings'
+
+BUS_CONF = '''<!DOCTYPE busconfig PUBLIC "-//freedesktop//DTD D-Bus Bus Configuration 1.0//EN"
+ "http://www.freedesktop.org/standards/dbus/1.0/busconfig.dtd">
+<busconfig>
+  <type>system</type>
+  <listen>unix:path=%s</listen>
+  <auth>EXTERNAL</auth>
+  <policy context="default">
+    <allow user="*"/>
+    <allow own="*"/>
+    <allow send_destination="*" eavesdrop="true"/>
+    <allow eavesdrop="true"/>
+  </policy>
+</busconfig>
+'''
+
+NM_CONF = '''[main]
+plugins=keyfile
+auth-polkit=false
+no-auto-default=*
+dhcp=internal
+dns=none
+
+[keyfile]
+path=%s
+unmanaged-devices=except:interface-name:%s*
+
+[logging]
+level=%s
+'''
+
+try:
+    now = time.monotonic
+except AttributeError:
+    now = time.time
+
+def run(*args, **kwargs):
+    subprocess.check_call(args, **kwargs)
+
+def peer_run(*args):
+    run('ip', 'netns', 'exec', PEER_NETNS, *args)
+
+def subnet(i):
+    return (i // 256, i % 256)
+
+###############################################################################
+
+def setup_namespace():
+    # the whole benchmark runs in private namespaces, so that nothing has to
+    # be cleaned up afterwards.
+    if os.environ.get('NMBENCH_IN_NAMESPACE') != '1':
+        env = dict(os.environ, NMBENCH_IN_NAMESPACE='1')
+        os.execvpe('unshare', ['unshare', '--net', '--mount', '--propagation', 'private',
+                               sys.executable] + sys.argv, env)
+
+    for d in ['/run', '/var/lib/NetworkManager']:
+        run('mount', '-t', 'tmpfs', 'tmpfs', d)
+    os.makedirs('/run/NetworkManager')
+    run('ip', 'link', 'set', 'lo', 'up')
+    run('ip', 'netns', 'add', PEER_NETNS)
+    peer_run('ip', 'link', 'set', 'lo', 'up')
+
+def setup_links(n):
+    batch = []
+    for i in range(n):
+        batch.append('link add %s%d type veth peer name %s%d netns %s'
+                     % (IFACE_PREFIX, i, PEER_PREFIX, i, PEER_NETNS))
+    run('ip', '-batch', '-', stdin=_batch_file(batch))
+
+    batch = []
+    for i in range(n):
+        x, y = subnet(i)
+        batch.append('address add 10.%d.%d.1/24 dev %s%d' % (x, y, PEER_PREFIX, i))
+        batch.append('address add fd00:%x:%x::1/64 dev %s%d' % (x, y, PEER_PREFIX, i))
+        batch.append('link set %s%d up' % (PEER_PREFIX, i))
+    peer_run('ip', '-batch', '-', stdin=_batch_file(batch))
+
+def _batch_file(lines):
+    f = tempfile.TemporaryFile(mode='w+')
+    f.write('\n'.join(lines) + '\n')
+    f.seek(0)
+    return f
+
+def start_dnsmasq(n, tmpdir):
+    args = ['ip', 'netns', 'exec', PEER_NETNS, 'dnsmasq',
+            '--keep-in-foreground', '--conf-file=/dev/null', '--port=0',
+            '--leasefile-ro', '--bind-interfaces', '--enable-ra',
+            '--pid-file=%s/dnsmasq.pid' % (tmpdir),
+            '--dhcp-range=::,constructor:%s*,ra-only,64' % (PEER_PREFIX)]
+    for i in range(n):
+        x, y = subnet(i)
+        args.append('--interface=%s%d' % (PEER_PREFIX, i))
+        args.append('--dhcp-range=10.%d.%d.100,10.%d.%d.200,255.255.255.0' % (x, y, x, y))
+    return subprocess.Popen(args)
+
+def start_bus(tmpdir):
+    socket = os.path.join(tmpdir, 'system_bus_socket')
+    conf = os.path.join(tmpdir, 'bus.conf')
+    with open(conf, 'w') as f:
+        f.write(BUS_CONF % (socket))
+    proc = subprocess.Popen(['dbus-daemon', '--nofork', '--config-file=' + conf])
+    while not os.path.exists(socket):
+        time.sleep(0.05)
+    os.environ['DBUS_SYSTEM_BUS_ADDRESS'] = 'unix:path=' + socket
+    return proc
+
+def write_profiles(n, profiles_dir):
+    uuids = {}
+    for mode in MODES:
+        for i in range(n):
+            x, y = subnet(i)
+            u = str(uuid.uuid4())
+            uuids[(mode, i)] = u
+            if mode == 'static':
+                ip4 = 'method=manual\naddress1=10.%d.%d.2/24\n' % (x, y)
+                ip6 = 'method=ignore\n'
+            elif mode == 'dhcp4':
+                ip4 = 'method=auto\n'
+                ip6 = 'method=ignore\n'
+            else:
+                ip4 = 'method=disabled\n'
+                ip6 = 'method=auto\n'
+            path = os.path.join(profiles_dir, 'bench-%s-%d' % (mode, i))
+            with open(path, 'w') as f:
+                f.write('[connection]\nid=bench-%s-%d\nuuid=%s\ntype=ethernet\n'
+                        'interface-name=%s%d\nautoconnect=false\n\n'
+                        '[ipv4]\n%s\n[ipv6]\n%s'
+                        % (mode, i, u, IFACE_PREFIX, i, ip4, ip6))
+            os.chmod(path, 0o600)
+    return uuids
+
+def start_nm(nm_binary, tmpdir, log_level):
+    profiles_dir = os.path.join(tmpdir, 'profiles')
+    conf = os.path.join(tmpdir, 'NetworkManager.conf')
+    with open(conf, 'w') as f:
+        f.write(NM_CONF % (profiles_dir, IFACE_PREFIX, log_level))
+    return subprocess.Popen([nm_binary, '--no-daemon',
+                             '--config=' + conf,
+                             '--config-dir=' + os.path.join(tmpdir, 'conf.d'),
+                             '--state-file=' + os.path.join(tmpdir, 'NetworkManager.state')])
+
+###############################################################################
+
+class Bench(object):
+
+    def __init__(self, bus, n_devices, timeout):
+        self.bus = bus
+        self.timeout = timeout
+        self.loop = GLib.MainLoop()
+        self.nm = dbus.Interface(bus.get_object(NM_SERVICE, NM_PATH), NM_IFACE)
+        self.settings = dbus.Interface(bus.get_object(NM_SERVICE, NM_SETTINGS_PATH), NM_SETTINGS_IFACE)
+        self.devices = self._wait_devices(n_devices)
+        self.states = {}
+        self.pending = set()
+        self.waiting_for = None
+        bus.add_signal_receiver(self._state_changed,
+                                signal_name='StateChanged',
+                                dbus_interface=NM_DEVICE_IFACE,
+                                path_keyword='path')
+
+    def _wait_devices(self, n):
+        deadline = now() + self.timeout
+        devices = []
+        while len(devices) < n:
+            try:
+                path = self.nm.GetDeviceByIpIface('%s%d' % (IFACE_PREFIX, len(devices)))
+                props = dbus.Interface(self.bus.get_object(NM_SERVICE, path),
+                                       'org.freedesktop.DBus.Properties')
+                if props.Get(NM_DEVICE_IFACE, 'State') == NM_DEVICE_STATE_DISCONNECTED:
+                    devices.append(path)
+                    continue
+            except dbus.exceptions.DBusException:
+                pass
+            if now() > deadline:
+                raise Exception('timeout waiting for %d devices (got %d)' % (n, len(devices)))
+            time.sleep(0.1)
+        return devices
+
+    def _state_changed(self, new_state, old_state, reason, path=None):
+        if path not in self.pending:
+            return
+        self.states[path].append((int(new_state), now()))
+        if new_state in (NM_DEVICE_STATE_ACTIVATED, NM_DEVICE_STATE_FAILED):
+            self.pending.discard(path)
+        elif new_state == NM_DEVICE_STATE_DISCONNECTED and self.waiting_for == 'disconnect':
+            self.pending.discard(path)
+        if not self.pending:
+            self.loop.quit()
+
+    def _run_loop(self):
+        def _timeout():
+            self.loop.quit()
+            return False
+        source = GLib.timeout_add(int(self.timeout * 1000), _timeout)
+        self.loop.run()
+        GLib.source_remove(source)
+
+    def activate(self, mode, n, uuids):
+        connections = [self.settings.GetConnectionByUuid(uuids[(mode, i)]) for i in range(n)]
+
+        self.states = dict((path, []) for path in self.devices[:n])
+        self.pending = set(self.devices[:n])
+        self.waiting_for = 'activate'
+        for i in range(n):
+            path = self.devices[i]
+            self.states[path].append((0, now()))
+            self.nm.ActivateConnection(connections[i], path, '/',
+                                       reply_handler=lambda *args: None,
+                                       error_handler=lambda e: None)
+        self._run_loop()
+        results = self.states
+
+        self.pending = set(self.devices[:n])
+        self.waiting_for = 'disconnect'
+        for path in self.devices[:n]:
+            dbus.Interface(self.bus.get_object(NM_SERVICE, path), NM_DEVICE_IFACE).Disconnect(
+                reply_handler=lambda *args: None,
+                error_handler=lambda e, path=path: self.pending.discard(path))
+        self._run_loop()
+
+        return results
+
+###############################################################################
+
+def percentile(values, p):
+    if not values:
+        return 0.0
+    return values[min(int(len(values) * p), len(values) - 1)]
+
+def report(mode, n, results):
+    durations = dict((name, []) for name, state in STAGES)
+    total = []
+    failed = 0
+
+    for path, transitions in results.items():
+        start = transitions[0][1]
+        states = dict(transitions[1:])
+        if NM_DEVICE_STATE_ACTIVATED not in states:
+            failed += 1
+            continue
+        total.append((states[NM_DEVICE_STATE_ACTIVATED] - start) * 1000.0)
+        for idx, (name, state) in enumerate(STAGES):
+            if state not in states:
+                continue
+            # the time spent in a state is until the next one entered.
+            later = [t for s, t in transitions[1:] if s > state]
+            if later:
+                durations[name].append((min(later) - states[state]) * 1000.0)
+
+    def line(stage, values):
+        values = sorted(values)
+        print('bench\tactivation\t%s\t%d\t%s\t%d\t%.1f\t%.1f\t%.1f\t%.1f'
+              % (mode, n, stage, len(values),
+                 percentile(values, 0.5), percentile(values, 0.9),
+                 percentile(values, 0.99), values[-1] if values else 0.0))
+        sys.stdout.flush()
+
+    for name, state in STAGES:
+        line(name, durations[name])
+    line('total', total)
+    print('bench\tactivation\t%s\t%d\tfailed\t%d' % (mode, n, failed))
+
+def main():
+    parser = argparse.ArgumentParser(description='Measure the activation latency of NetworkManager in throwaway namespaces.')
+    parser.add_argument('--nm', default='NetworkManager', help='the NetworkManager binary')
+    parser.add_argument('--scales', default='1,100,1000', help='comma separated numbers of devices')
+    parser.add_argument('--modes', default=','.join(MODES), help='comma separated modes: ' + ', '.join(MODES))
+    parser.add_argument('--timeout', type=float, default=120.0, help='seconds to wait for each round')
+    parser.add_argument('--log-level', default='WARN', help='the log level of the daemon')
+    args = parser.parse_args()
+
+    scales = [int(s) for s in args.scales.split(',')]
+    modes = args.modes.split(',')
+    for mode in modes:
+        if mode not in MODES:
+            parser.error('unknown mode "%s"' % (mode))
+
+    if os.geteuid() != 0:
+        print('needs root privileges', file=sys.stderr)
+        sys.exit(77)
+
+    setup_namespace()
+
+    n = max(scales)
+    tmpdir = tempfile.mkdtemp(prefix='nm-bench-activation-')
+    procs = []
+    try:
+        os.makedirs(os.path.join(tmpdir, 'profiles'))
+        os.makedirs(os.path.join(tmpdir, 'conf.d'))
+
+        setup_links(n)
+        uuids = write_profiles(n, os.path.join(tmpdir, 'profiles'))
+        procs.append(start_dnsmasq(n, tmpdir))
+        procs.append(start_bus(tmpdir))
+        procs.append(start_nm(args.nm, tmpdir, args.log_level))
+
+        dbus.mainloop.glib.DBusGMainLoop(set_as_default=True)
+        bus = dbus.SystemBus()
+        deadline = now() + args.timeout
+        while not bus.name_has_owner(NM_SERVICE):
+            if now() > deadline:
+                raise Exception('NetworkManager did not show up on the bus')
+            time.sleep(0.1)
+
+        bench = Bench(bus, n, args.timeout)
+        for mode in modes:
+            for scale in scales:
+                report(mode, scale, bench.activate(mode, scale, uuids))
+    finally:
+        for proc in reversed(procs):
+            proc.terminate()
+            proc.wait()
+        shutil.rmtree(tmpdir, ignore_errors=True)
+
+if __name__ == '__main__':
+    main()
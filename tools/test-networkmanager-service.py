@@ -1102,6 +1102,17 @@ class Settings(ExportedObj):
     def ListConnections(self):
         return self.connections.keys()
 
+    @dbus.service.method(dbus_interface=IFACE_SETTINGS, in_signature='ao', out_signature='a{oa{sa{sv}}}')
+    def ListConnectionsWithSettings(self, paths):
+        if len(paths) == 0:
+            paths = self.connections.keys()
+        result = dbus.Dictionary({}, signature='oa{sa{sv}}')
+        for path in paths:
+            con = self.connections.get(path)
+            if con is not None and con.visible:
+                result[path] = con.settings
+        return result
+
     @dbus.service.method(dbus_interface=IFACE_SETTINGS, in_signature='a{sa{sv}}', out_signature='o')
     def AddConnection(self, settings):
         return self.add_connection(settings)